@@ -205,6 +205,10 @@ if(WITH_PSCORE)
   add_definitions(-DPADDLE_WITH_PSCORE)
 endif()
 
+if(WITH_BRPC_RDMA)
+  add_definitions(-DPADDLE_WITH_BRPC_RDMA)
+endif()
+
 if(WITH_RPC)
   add_definitions(-DPADDLE_WITH_RPC)
 endif()
@@ -26,6 +26,7 @@
 #include "paddle/cinn/ir/op/ir_operators.h"
 #include "paddle/cinn/ir/utils/ir_verify.h"
 #include "paddle/cinn/optim/ir_simplify.h"
+#include "paddle/cinn/utils/profiler.h"
 #include "paddle/common/enforce.h"
 #include "paddle/common/errors.h"
 namespace cinn {
@@ -139,6 +140,7 @@ std::vector<Expr> FilterDeallocTempBuffers(const std::vector<Expr> &frees) {
 void CodeGenGpuDev::Visit(const ir::_LoweredFunc_ *op) {
   // clear names valid within scope when enter a new function
   vectorized_tensor_names_.clear();
+  shared_memory_plan_ = optim::PlanSharedMemory(op);
   str_ += "__global__\n";
 
   PrintFunctionDeclaration(op);
@@ -322,7 +324,7 @@ void CodeGenGpuDev::PrintTempBufferCreation(const ir::Buffer &buffer) {
     if (MathEqual(dyn_shared_mem_offset_, Expr(-1))) {
       // The first shared memory buffer, uint8_t as a byte
       str_ += "extern __shared__ uint8_t dyn_shared_buffer[];\n  ";
-      dyn_shared_mem_offset_ = Expr(0);
+      dyn_shared_mem_offset_ = shared_memory_plan_.total_bytes;
     }
     std::string type_name = GetTypeRepr(buffer->dtype);
     str_ += type_name;
@@ -331,13 +333,18 @@ void CodeGenGpuDev::PrintTempBufferCreation(const ir::Buffer &buffer) {
     str_ += " = (";
     str_ += type_name;
     str_ += "*)&dyn_shared_buffer[ ";
-    IrPrinter::Visit(dyn_shared_mem_offset_);
+    auto planned_offset = shared_memory_plan_.offsets.find(buffer->name);
+    if (planned_offset != shared_memory_plan_.offsets.end()) {
+      IrPrinter::Visit(planned_offset->second);
+    } else {
+      // The buffers not in the temp buffers follow the planned ones.
+      IrPrinter::Visit(dyn_shared_mem_offset_);
+      int type_bytes = buffer->dtype.bytes();
+      dyn_shared_mem_offset_ =
+          dyn_shared_mem_offset_ + buffer_size * Expr(type_bytes);
+      optim::Simplify(&dyn_shared_mem_offset_);
+    }
     str_ += " ]";
-
-    int type_bytes = buffer->dtype.bytes();
-    dyn_shared_mem_offset_ =
-        dyn_shared_mem_offset_ + buffer_size * Expr(type_bytes);
-    optim::Simplify(&dyn_shared_mem_offset_);
     VLOG(6) << "dyn_shared_mem_offset_ = " << dyn_shared_mem_offset_;
   } else if (buffer->memory_type == ir::MemoryType::GPULocal) {
     // print func of static allocation
@@ -513,35 +520,19 @@ void CodeGenGpuDev::Visit(const ir::Store *op) {
   }
 }
 
-ir::Expr CalculateSharedMemory(const ir::Buffer &buffer) {
-  Expr buffer_size(1);
-  for (int i = 0; i < buffer->shape.size(); i++) {
-    buffer_size = buffer_size * buffer->shape[i];
-  }
-  int type_bytes = buffer->dtype.bytes();
-  return buffer_size * Expr(type_bytes);
-}
-
 ir::Expr CalculateSharedMemory(const ir::Expr &func_expr) {
   auto func = func_expr.as_lowered_func();
   PADDLE_ENFORCE_NOT_NULL(
       func, ::common::errors::InvalidType("expr is not a lowered_func"));
-  auto alloc_temp_buffers = func->PrepareAllocTempBufferExprs();
-  ir::Expr shm_size{0};
-  for (const auto &alloc : alloc_temp_buffers) {
-    PADDLE_ENFORCE_NOT_NULL(
-        alloc.As<ir::Alloc>(),
-        ::common::errors::InvalidType("expr is not a Alloc node"));
-    PADDLE_ENFORCE_NOT_NULL(
-        alloc.As<ir::Alloc>()->destination.as_buffer(),
-        ::common::errors::InvalidType("expr is not a Buffer node"));
-
-    auto buffer = alloc.As<ir::Alloc>()->destination.as_buffer_ref();
-    if (buffer->memory_type == ir::MemoryType::GPUShared) {
-      shm_size = shm_size + CalculateSharedMemory(buffer);
-    }
+  auto plan = optim::PlanSharedMemory(func);
+  if (plan.unshared_bytes > plan.planned_bytes) {
+    VLOG(3) << "The shared memory buffers of " << func->name << " reuse "
+            << plan.unshared_bytes - plan.planned_bytes << " of "
+            << plan.unshared_bytes << " bytes";
+    utils::RecordCount("shared_memory_bytes_reused",
+                       plan.unshared_bytes - plan.planned_bytes);
   }
-  return common::AutoSimplify(shm_size);
+  return common::AutoSimplify(plan.total_bytes);
 }
 
 }  // namespace backends
@@ -25,6 +25,7 @@
 #include "paddle/cinn/ir/lowered_func.h"
 #include "paddle/cinn/ir/module.h"
 #include "paddle/cinn/lang/packed_func.h"
+#include "paddle/cinn/optim/plan_shared_memory.h"
 #include "paddle/cinn/runtime/cinn_runtime.h"
 
 namespace cinn::ir {
@@ -121,6 +122,7 @@ class CodeGenGpuDev : public CodeGenC {
   std::unordered_set<std::string> vectorized_tensor_names_;
 
   ir::Expr dyn_shared_mem_offset_{-1};
+  optim::SharedMemoryPlan shared_memory_plan_;
   std::vector<ir::Buffer> dynamic_alloc_buffers_;
 };
 
@@ -23,6 +23,7 @@
 #include "paddle/cinn/hlir/framework/graph_compiler_util.h"
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/runtime/backend_api.h"
+#include "paddle/cinn/utils/profiler.h"
 #ifdef CINN_WITH_CUDA
 #include "paddle/cinn/backends/codegen_cuda_dev.h"
 #include "paddle/cinn/backends/nvrtc/nvrtc_util.h"
@@ -256,6 +257,33 @@ void Compiler::EndCompile() {
   engine_->AddSelfModule();
 }
 
+CompiledArtifacts Compiler::ExportArtifacts() const {
+  CompiledArtifacts artifacts;
+  artifacts.host_objects = engine_->GetObjects();
+  artifacts.device_code = device_code_;
+  artifacts.device_code_is_cubin = device_code_is_cubin_;
+  artifacts.device_fn_names = device_fn_name_;
+  return artifacts;
+}
+
+void Compiler::Load(const CompiledArtifacts& artifacts) {
+  PADDLE_ENFORCE_EQ(artifacts.host_objects.empty(),
+                    false,
+                    ::common::errors::InvalidArgument(
+                        "The compiled artifacts to load have no host object."));
+  device_fn_name_ = artifacts.device_fn_names;
+  device_code_ = artifacts.device_code;
+  device_code_is_cubin_ = artifacts.device_code_is_cubin;
+  LoadDeviceModule();
+  for (const auto& object : artifacts.host_objects) {
+    PADDLE_ENFORCE_EQ(
+        engine_->AddObject(object),
+        true,
+        ::common::errors::InvalidArgument(
+            "Failed to load the host object of the compiled artifacts."));
+  }
+}
+
 std::string Compiler::GetSourceCode(const ir::Module& module) {
   return target_.arch.Match(
       [&](common::UnknownArch) -> std::string { CINN_NOT_IMPLEMENTED; },
@@ -327,18 +355,32 @@ void Compiler::RegisterDeviceModuleSymbol() {
 
 void Compiler::RegisterCudaModuleSymbol() {
 #ifdef CINN_WITH_CUDA
-  nvrtc::Compiler compiler;
-  std::string source_code = CodeGenCudaDev::GetSourceHeader() + device_fn_code_;
-  auto ptx = compiler(source_code);
-  PADDLE_ENFORCE_EQ(!ptx.empty(),
-                    true,
-                    ::common::errors::InvalidArgument(
-                        "Compile PTX failed from source code\n"));
+  utils::RecordEvent record_nvrtc("NVRTC Compile",
+                                  utils::EventType::kCompile);
+  // The code may contain the kernels of the other compilers of the batch.
+  auto batch = nvrtc::BatchCompiler::Global().Compile(
+      CodeGenCudaDev::GetSourceHeader(), device_fn_code_);
+  record_nvrtc.End();
+  device_code_ = batch->code;
+  device_code_is_cubin_ = batch->is_cubin;
+  cuda_module_ = batch->module;
+  LoadCudaModule();
+#else
+  CINN_NOT_IMPLEMENTED
+#endif
+}
+
+void Compiler::LoadCudaModule() {
+#ifdef CINN_WITH_CUDA
+  utils::RecordEvent record_load("Load CUDA Module",
+                                 utils::EventType::kCompile);
   using runtime::cuda::CUDAModule;
-  cuda_module_.reset(new CUDAModule(ptx,
-                                    compiler.compile_to_cubin()
-                                        ? CUDAModule::Kind::CUBIN
-                                        : CUDAModule::Kind::PTX));
+  if (cuda_module_ == nullptr) {
+    cuda_module_ = std::make_shared<CUDAModule>(
+        device_code_,
+        device_code_is_cubin_ ? CUDAModule::Kind::CUBIN
+                              : CUDAModule::Kind::PTX);
+  }
 
   RuntimeSymbols symbols;
   for (const auto& kernel_fn_name : device_fn_name_) {
@@ -358,17 +400,31 @@ void Compiler::RegisterCudaModuleSymbol() {
 
 void Compiler::RegisterHipModuleSymbol() {
 #ifdef CINN_WITH_HIP
+  utils::RecordEvent record_hiprtc("HIPRTC Compile",
+                                   utils::EventType::kCompile);
   hiprtc::Compiler compiler;
   std::string source_code =
       hip::CodeGenHipDevice::GetSourceHeader() + device_fn_code_;
   std::string hsaco = compiler(source_code);
+  record_hiprtc.End();
   PADDLE_ENFORCE_EQ(
       !hsaco.empty(),
       true,
       ::common::errors::Fatal("Compile hsaco failed from source code:\n%s",
                               source_code));
+  device_code_ = std::move(hsaco);
+  LoadHipModule();
+#else
+  CINN_NOT_IMPLEMENTED
+#endif
+}
+
+void Compiler::LoadHipModule() {
+#ifdef CINN_WITH_HIP
+  utils::RecordEvent record_load("Load HIP Module",
+                                 utils::EventType::kCompile);
   using runtime::hip::HIPModule;
-  hip_module_.reset(new HIPModule(hsaco));
+  hip_module_.reset(new HIPModule(device_code_));
   // get device id
   using cinn::runtime::BackendAPI;
   int device_id = BackendAPI::get_backend(target_)->get_device();
@@ -389,6 +445,15 @@ void Compiler::RegisterHipModuleSymbol() {
 #endif
 }
 
+void Compiler::LoadDeviceModule() {
+  return target_.arch.Match(
+      [&](common::UnknownArch) { CINN_NOT_IMPLEMENTED; },
+      [&](common::X86Arch) { return; },
+      [&](common::ARMArch) { return; },
+      [&](common::NVGPUArch) { LoadCudaModule(); },
+      [&](common::HygonDCUArchHIP) { LoadHipModule(); });
+}
+
 void Compiler::CompileCudaModule(const Module& module,
                                  const std::string& code) {
 #ifdef CINN_WITH_CUDA
@@ -405,6 +470,8 @@ void Compiler::CompileCudaModule(const Module& module,
     std::string file_path = FLAGS_cinn_debug_custom_code_path;
     source_code = GetFileContent(file_path);
   } else if (code.empty()) {
+    utils::RecordEvent record_codegen("CodeGenCudaDev",
+                                      utils::EventType::kCodeGen);
     CodeGenCudaDev codegen(target_);
     source_code = codegen.Compile(device_module);
   } else {
@@ -423,6 +490,7 @@ void Compiler::CompileCudaModule(const Module& module,
     std::string kernel_fn_name = fn->name;
     device_fn_name_.emplace_back(kernel_fn_name);
   }
+  utils::RecordCount("device_kernels", device_module.functions().size());
   engine_->Link<CodeGenGpuHost>(host_module);
 
 #else
@@ -443,6 +511,8 @@ void Compiler::CompileHipModule(const Module& module, const std::string& code) {
     std::string file_path = FLAGS_cinn_debug_custom_code_path;
     source_code = GetFileContent(file_path);
   } else if (code.empty()) {
+    utils::RecordEvent record_codegen("CodeGenHipDevice",
+                                      utils::EventType::kCodeGen);
     hip::CodeGenHipDevice codegen(target_);
     source_code = codegen.Compile(device_module);
   } else {
@@ -460,6 +530,7 @@ void Compiler::CompileHipModule(const Module& module, const std::string& code) {
     std::string kernel_fn_name = fn->name;
     device_fn_name_.emplace_back(kernel_fn_name);
   }
+  utils::RecordCount("device_kernels", device_module.functions().size());
   engine_->Link<CodeGenGpuHost>(host_module);
 #else
   CINN_NOT_IMPLEMENTED
@@ -97,6 +97,20 @@ class SourceCodePrint {
   std::mutex mtx_;
 };
 
+/**
+ * The backend outputs of a Compiler, i.e. the object files of the host modules
+ * and the binary of the device modules. They can be saved and loaded into
+ * another Compiler by Compiler::Load without generating and compiling the code
+ * again.
+ */
+struct CompiledArtifacts {
+  std::vector<std::string> host_objects;
+  // PTX or CUBIN for CUDA, hsaco for HIP, empty for X86.
+  std::string device_code;
+  bool device_code_is_cubin{false};
+  std::vector<std::string> device_fn_names;
+};
+
 class Compiler final {
  public:
   static std::unique_ptr<Compiler> Create(const Target& target) {
@@ -114,6 +128,18 @@ class Compiler final {
 
   void EndCompile();
 
+  /**
+   * Export the compiled code, which is complete only after EndCompile() and
+   * a function is looked up.
+   */
+  CompiledArtifacts ExportArtifacts() const;
+
+  /**
+   * Load the code exported by ExportArtifacts(), instead of Build() and
+   * EndCompile().
+   */
+  void Load(const CompiledArtifacts& artifacts);
+
   void ExportObject(const std::string& path);
 
   std::string GetSourceCode(const ir::Module& module);
@@ -136,6 +162,13 @@ class Compiler final {
 
   void RegisterHipModuleSymbol();
 
+  // create the device module from device_code_ and register its kernels
+  void LoadDeviceModule();
+
+  void LoadCudaModule();
+
+  void LoadHipModule();
+
   void CompileCudaModule(const ir::Module& module,
                          const std::string& code = "");
 
@@ -156,8 +189,12 @@ class Compiler final {
   // only heterogeneous systems need to record device func and module
   std::vector<std::string> device_fn_name_;
   std::string device_fn_code_;
+  // the compiled device_fn_code_
+  std::string device_code_;
+  bool device_code_is_cubin_{false};
 #ifdef CINN_WITH_CUDA
-  std::unique_ptr<runtime::cuda::CUDAModule> cuda_module_;
+  // shared by the compilers whose device code is compiled in a batch
+  std::shared_ptr<runtime::cuda::CUDAModule> cuda_module_;
 #endif
 #ifdef CINN_WITH_HIP
   std::unique_ptr<runtime::hip::HIPModule> hip_module_;
@@ -107,6 +107,14 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
   return llvm::MemoryBuffer::getMemBuffer(it->second->getMemBufferRef());
 }
 
+std::vector<std::string> NaiveObjectCache::GetObjects() const {
+  std::vector<std::string> objects;
+  for (const auto &it : cached_objects_) {
+    objects.emplace_back(it.second->getBuffer().str());
+  }
+  return objects;
+}
+
 /*static*/ std::unique_ptr<ExecutionEngine> ExecutionEngine::Create(
     const ExecutionOptions &config) {
   VLOG(1) << "===================== Create CINN ExecutionEngine begin "
@@ -171,7 +179,8 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
 
 template <typename CodeGenT>
 void ExecutionEngine::Link(const ir::Module &module) {
-  utils::RecordEvent("ExecutionEngine Link", utils::EventType::kOrdinary);
+  utils::RecordEvent record_link("ExecutionEngine Link",
+                                 utils::EventType::kOrdinary);
 
   auto ir_emitter = std::make_unique<CodeGenT>(m.get(), b.get());
   VLOG(3) << "ir_emitter->Compile(module) Begin";
@@ -213,7 +222,8 @@ void ExecutionEngine::Link(const ir::Module &module) {
 
 bool ExecutionEngine::AddModule(std::unique_ptr<llvm::Module> module,
                                 std::unique_ptr<llvm::LLVMContext> context) {
-  utils::RecordEvent("ExecutionEngine AddModule", utils::EventType::kOrdinary);
+  utils::RecordEvent record_add_module("ExecutionEngine AddModule",
+                                       utils::EventType::kOrdinary);
   module->setDataLayout(jit_->getDataLayout());
   if (VLOG_IS_ON(5)) {
     VLOG(5) << "======= dump jit lib ==========";
@@ -247,6 +257,24 @@ bool ExecutionEngine::AddSelfModule() {
   return AddModule(std::move(m), std::move(ctx));
 }
 
+std::vector<std::string> ExecutionEngine::GetObjects() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return cache_->GetObjects();
+}
+
+bool ExecutionEngine::AddObject(const std::string &object) {
+  utils::RecordEvent record_add_object("ExecutionEngine AddObject",
+                                       utils::EventType::kOrdinary);
+  std::lock_guard<std::mutex> lock(mu_);
+  if (auto error = jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(
+          AsStringRef(object), "cinn_cached_object"))) {
+    LOG(WARNING) << "Failed to add object file: "
+                 << llvm::toString(std::move(error));
+    return false;
+  }
+  return true;
+}
+
 void ExecutionEngine::ExportObject(const std::string &path) {
   FILE *of = fopen(path.c_str(), "w");
   fwrite(buffer_.data(), 1, buffer_.size(), of);
@@ -254,7 +282,8 @@ void ExecutionEngine::ExportObject(const std::string &path) {
 }
 
 void *ExecutionEngine::Lookup(absl::string_view name) {
-  utils::RecordEvent("ExecutionEngine Lookup", utils::EventType::kOrdinary);
+  utils::RecordEvent record_lookup("ExecutionEngine Lookup",
+                                   utils::EventType::kOrdinary);
   std::lock_guard<std::mutex> lock(mu_);
   if (auto symbol = jit_->lookup(AsStringRef(name))) {
     return reinterpret_cast<void *>(symbol->getAddress());
@@ -265,8 +294,9 @@ void *ExecutionEngine::Lookup(absl::string_view name) {
 }
 
 void ExecutionEngine::RegisterGlobalRuntimeSymbols() {
-  utils::RecordEvent("ExecutionEngine RegisterGlobalRuntimeSymbols",
-                     utils::EventType::kOrdinary);
+  utils::RecordEvent record_register(
+      "ExecutionEngine RegisterGlobalRuntimeSymbols",
+      utils::EventType::kOrdinary);
   const auto &registry = GlobalSymbolRegistry::Global();
   auto *session = &jit_->getExecutionSession();
   for (const auto &sym : registry.All()) {
@@ -56,6 +56,8 @@ class NaiveObjectCache : public llvm::ObjectCache {
                             llvm::MemoryBufferRef) override;
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override;
 
+  std::vector<std::string> GetObjects() const;
+
  private:
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cached_objects_;
 };
@@ -87,6 +89,14 @@ class ExecutionEngine {
 
   bool AddSelfModule();
 
+  // The object files compiled from the added modules. They are complete only
+  // after the modules are materialized, i.e. after a symbol is looked up.
+  std::vector<std::string> GetObjects() const;
+
+  // Add an object file from GetObjects of another engine, so that the modules
+  // are not generated and compiled again.
+  bool AddObject(const std::string &object);
+
  protected:
   explicit ExecutionEngine(bool enable_object_cache)
       : cache_(std::make_unique<NaiveObjectCache>()),
@@ -21,8 +21,13 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "paddle/cinn/backends/cuda_util.h"
 #include "paddle/cinn/backends/nvrtc/header_generator.h"
@@ -30,10 +35,13 @@
 #include "paddle/cinn/runtime/flags.h"
 #include "paddle/cinn/utils/string.h"
 #include "paddle/common/enforce.h"
+#include "paddle/common/stable_hash.h"
 PD_DECLARE_string(cinn_nvcc_cmd_path);
 PD_DECLARE_string(nvidia_package_dir);
 PD_DECLARE_bool(nvrtc_compile_to_cubin);
 PD_DECLARE_bool(cinn_nvrtc_cubin_with_fmad);
+PD_DECLARE_int32(cinn_nvrtc_batch_size);
+PD_DECLARE_string(cinn_nvcc_cache_dir);
 
 namespace cinn {
 namespace backends {
@@ -154,16 +162,20 @@ std::string Compiler::CompileCudaSource(const std::string& code,
   compile_options.push_back("-default-device");
 
   if (include_headers) {  // prepare include headers
-    auto cuda_headers = FindCUDAIncludePaths();
-    auto cinn_headers = FindCINNRuntimeIncludePaths();
-    std::vector<std::string> include_paths;
-    for (auto& header : cuda_headers) {
-      VLOG(5) << "add include-path: " << header;
-      include_paths.push_back("--include-path=" + header);
-    }
-    for (auto& header : cinn_headers) {
-      include_paths.push_back("--include-path=" + header);
-    }
+    // The paths are found once, instead of for every program.
+    static const std::vector<std::string> include_paths = [this] {
+      auto cuda_headers = FindCUDAIncludePaths();
+      auto cinn_headers = FindCINNRuntimeIncludePaths();
+      std::vector<std::string> include_paths;
+      for (auto& header : cuda_headers) {
+        VLOG(5) << "add include-path: " << header;
+        include_paths.push_back("--include-path=" + header);
+      }
+      for (auto& header : cinn_headers) {
+        include_paths.push_back("--include-path=" + header);
+      }
+      return include_paths;
+    }();
     compile_options.insert(
         std::end(compile_options), include_paths.begin(), include_paths.end());
   }
@@ -211,6 +223,9 @@ std::string Compiler::CompileCudaSource(const std::string& code,
 }
 
 std::string Compiler::CompileWithNvcc(const std::string& cuda_c) {
+  if (!FLAGS_cinn_nvcc_cache_dir.empty()) {
+    return CompileWithNvccCache(cuda_c);
+  }
   // read dir source
   std::string dir = "./source";
   if (access(dir.c_str(), 0) == -1) {
@@ -242,6 +257,52 @@ std::string Compiler::CompileWithNvcc(const std::string& cuda_c) {
   return prefix_name_ + ".cubin";
 }
 
+std::string Compiler::CompileWithNvccCache(const std::string& cuda_c) {
+  const std::string& dir = FLAGS_cinn_nvcc_cache_dir;
+  PADDLE_ENFORCE_EQ(
+      mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST,
+      true,
+      ::common::errors::PermissionDenied(
+          "Failed to create directory %s. Please check the permissions.",
+          dir.c_str()));
+
+  std::stringstream key;
+  key << std::hex << ::common::StableHash(GetDeviceArch() + "\n" + cuda_c);
+  std::string cubin_file = dir + "/cinn_" + key.str() + ".cubin";
+  if (TryLocatePath(cubin_file)) {
+    VLOG(4) << "Reuse the cubin compiled by nvcc: " << cubin_file;
+    return cubin_file;
+  }
+
+  // Compiled under a name unique to the process and renamed, so that the
+  // other processes never read a partial cubin.
+  prefix_name_ = dir + "/" +
+                 cinn::common::UniqName("rtc_tmp_" + key.str() + "_" +
+                                        std::to_string(getpid()));
+  auto cuda_c_file = prefix_name_ + ".cu";
+  std::ofstream ofs(cuda_c_file, std::ios::out);
+  PADDLE_ENFORCE_EQ(ofs.is_open(),
+                    true,
+                    ::common::errors::Unavailable(
+                        "Failed to open file %s. Please check if the file path "
+                        "is correct and the file is accessible.",
+                        cuda_c_file.c_str()));
+  ofs << cuda_c;
+  ofs.close();
+
+  CompileToPtx();
+  CompileToCubin();
+
+  PADDLE_ENFORCE_EQ(
+      std::rename((prefix_name_ + ".cubin").c_str(), cubin_file.c_str()),
+      0,
+      ::common::errors::Unavailable("Failed to move the cubin to %s.",
+                                    cubin_file.c_str()));
+  std::remove(cuda_c_file.c_str());
+  std::remove((prefix_name_ + ".ptx").c_str());
+  return cubin_file;
+}
+
 // std::string Compiler::GetPtx() { return ReadFile(prefix_name_ + ".ptx",
 // std::ios::in); }
 
@@ -323,6 +384,95 @@ std::string Compiler::ReadFile(const std::string& file_name,
   return std::move(file_data);
 }
 
+namespace {
+// How long the first source of a batch waits for the others.
+constexpr auto kBatchWaitTime = std::chrono::milliseconds(10);
+}  // namespace
+
+BatchCompiler& BatchCompiler::Global() {
+  static BatchCompiler compiler;
+  return compiler;
+}
+
+std::shared_ptr<const CompiledBatch> BatchCompiler::CompileSource(
+    const std::string& source) {
+  Compiler compiler;
+  auto result = std::make_shared<CompiledBatch>();
+  result->code = compiler(source);
+  PADDLE_ENFORCE_EQ(!result->code.empty(),
+                    true,
+                    ::common::errors::InvalidArgument(
+                        "Compile PTX failed from source code\n"));
+  result->is_cubin = compiler.compile_to_cubin();
+  using runtime::cuda::CUDAModule;
+  result->module = std::make_shared<CUDAModule>(
+      result->code,
+      result->is_cubin ? CUDAModule::Kind::CUBIN : CUDAModule::Kind::PTX);
+  return result;
+}
+
+std::shared_ptr<const CompiledBatch> BatchCompiler::Compile(
+    const std::string& header, const std::string& source) {
+  const size_t batch_size = std::max(FLAGS_cinn_nvrtc_batch_size, 1);
+  if (batch_size == 1) {
+    return CompileSource(header + source);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_ptr<Batch> batch = pending_;
+  const bool is_first = batch == nullptr || batch->header != header;
+  if (is_first) {
+    batch = std::make_shared<Batch>();
+    batch->header = header;
+    pending_ = batch;
+  }
+  batch->sources.push_back(source);
+  if (batch->sources.size() >= batch_size) {
+    pending_.reset();
+    cv_.notify_all();
+  }
+
+  if (!is_first) {
+    cv_.wait(lock, [&] { return batch->done; });
+    if (batch->result != nullptr) {
+      return batch->result;
+    }
+    lock.unlock();
+    return CompileSource(header + source);
+  }
+
+  // The first source compiles the batch once it is full or the wait is over.
+  cv_.wait_for(lock, kBatchWaitTime, [&] { return pending_ != batch; });
+  if (pending_ == batch) {
+    pending_.reset();
+  }
+  lock.unlock();
+  if (batch->sources.size() == 1) {
+    return CompileSource(header + source);
+  }
+
+  VLOG(4) << "Compile a batch of " << batch->sources.size()
+          << " CUDA sources as one program";
+  std::string batch_source = header;
+  for (const auto& batch_member : batch->sources) {
+    batch_source += batch_member;
+  }
+  std::shared_ptr<const CompiledBatch> result;
+  try {
+    result = CompileSource(batch_source);
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to compile a batch of " << batch->sources.size()
+                 << " CUDA sources, which are compiled alone: " << e.what();
+  }
+
+  lock.lock();
+  batch->result = result;
+  batch->done = true;
+  cv_.notify_all();
+  lock.unlock();
+  return result != nullptr ? result : CompileSource(header + source);
+}
+
 }  // namespace nvrtc
 }  // namespace backends
 }  // namespace cinn
@@ -19,9 +19,14 @@
 #endif
 #include <glog/logging.h>
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "paddle/cinn/runtime/cuda/cuda_module.h"
+
 namespace cinn {
 namespace backends {
 namespace nvrtc {
@@ -76,6 +81,10 @@ class Compiler {
   // compile with nvcc
   std::string CompileWithNvcc(const std::string&);
 
+  // compile with nvcc, or reuse the cubin of the same source in
+  // FLAGS_cinn_nvcc_cache_dir
+  std::string CompileWithNvccCache(const std::string&);
+
   // compile to ptx
   void CompileToPtx();
   // compile to cubin
@@ -87,6 +96,59 @@ class Compiler {
   std::string prefix_name_{""};
 };
 
+/**
+ * The device code of a batch of CUDA sources compiled as one program, and the
+ * module loaded from it, which is shared by the compilers of the sources.
+ */
+struct CompiledBatch {
+  std::string code;
+  bool is_cubin{false};
+  std::shared_ptr<runtime::cuda::CUDAModule> module;
+};
+
+/**
+ * BatchCompiler compiles the CUDA sources submitted by the threads compiling
+ * groups concurrently, see PirCompiler::Build, as one program of up to
+ * FLAGS_cinn_nvrtc_batch_size sources, so the headers are parsed and the
+ * program is created once per batch, and the batches are still compiled in
+ * parallel by the threads.
+ *
+ * The first source of a batch waits a few milliseconds for the others. The
+ * sources of a batch that fails to compile, e.g. because of the conflicting
+ * definitions, are compiled alone.
+ */
+class BatchCompiler {
+ public:
+  static BatchCompiler& Global();
+
+  /**
+   * Compile \p source with \p header, which is shared by the sources of a
+   * batch.
+   * @return The batch containing the kernels of \p source.
+   */
+  std::shared_ptr<const CompiledBatch> Compile(const std::string& header,
+                                               const std::string& source);
+
+ private:
+  struct Batch {
+    std::string header;
+    std::vector<std::string> sources;
+    bool done{false};
+    // Null if the batch fails to compile.
+    std::shared_ptr<const CompiledBatch> result;
+  };
+
+  BatchCompiler() = default;
+
+  static std::shared_ptr<const CompiledBatch> CompileSource(
+      const std::string& source);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // The batch accepting the sources.
+  std::shared_ptr<Batch> pending_;
+};
+
 }  // namespace nvrtc
 }  // namespace backends
 }  // namespace cinn
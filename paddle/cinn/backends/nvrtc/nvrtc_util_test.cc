@@ -16,6 +16,12 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
+#include "paddle/common/flags.h"
+
+PD_DECLARE_int32(cinn_nvrtc_batch_size);
+
 namespace cinn {
 namespace backends {
 namespace nvrtc {
@@ -85,6 +91,54 @@ void cast_fp32_to_bf16_cuda_kernel(const float* input, const int num, bfloat16*
   LOG(INFO) << "ptx:\n" << ptx;
 }
 
+// Compiles the sources from concurrent threads, and checks that each batch
+// has the kernel of its source.
+static void CompileConcurrently(const std::vector<std::string>& sources,
+                                const std::vector<std::string>& kernels) {
+  std::vector<std::shared_ptr<const CompiledBatch>> batches(sources.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    threads.emplace_back([&, i] {
+      batches[i] = BatchCompiler::Global().Compile("#include <cstdint>\n",
+                                                   sources[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < sources.size(); ++i) {
+    ASSERT_NE(batches[i], nullptr);
+    EXPECT_NE(batches[i]->module->GetFunction(0, kernels[i]), nullptr);
+  }
+}
+
+TEST(BatchCompiler, batch) {
+  FLAGS_cinn_nvrtc_batch_size = 4;
+  std::vector<std::string> sources;
+  std::vector<std::string> kernels;
+  for (int i = 0; i < 4; ++i) {
+    kernels.push_back("scale_kernel_" + std::to_string(i));
+    sources.push_back("extern \"C\" __global__ void " + kernels.back() +
+                      "(float* x, int64_t n) {\n"
+                      "  int64_t idx = blockIdx.x * blockDim.x + threadIdx.x;\n"
+                      "  if (idx < n) x[idx] *= " +
+                      std::to_string(i + 2) + ";\n}\n");
+  }
+  CompileConcurrently(sources, kernels);
+  FLAGS_cinn_nvrtc_batch_size = 1;
+}
+
+TEST(BatchCompiler, conflict) {
+  // The kernels of the same name conflict in a batch, so they are compiled
+  // alone.
+  FLAGS_cinn_nvrtc_batch_size = 2;
+  std::string source = R"(
+extern "C" __global__ void conflict_kernel(float* x) { x[threadIdx.x] = 0; }
+)";
+  CompileConcurrently({source, source}, {"conflict_kernel", "conflict_kernel"});
+  FLAGS_cinn_nvrtc_batch_size = 1;
+}
+
 }  // namespace nvrtc
 }  // namespace backends
 }  // namespace cinn
@@ -130,11 +130,16 @@ struct CINNKernelInfoAttributeStorage : public pir::AttributeStorage {
   }
 
   static std::size_t HashValue(const ParamKey& key) {
+    // the function pointers of a pending kernel are null
+    if (key.pending_result != nullptr) {
+      return std::hash<const void*>()(key.pending_result.get());
+    }
     return std::hash<int64_t>()(*(reinterpret_cast<int64_t*>(key.fn_ptr)));
   }
 
   bool operator==(const ParamKey& key) const {
-    return data_.fn_ptr == key.fn_ptr;
+    return data_.fn_ptr == key.fn_ptr &&
+           data_.pending_result == key.pending_result;
   }
 
   const ParamKey& GetAsKey() const { return data_; }
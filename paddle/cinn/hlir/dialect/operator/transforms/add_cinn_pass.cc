@@ -23,6 +23,7 @@
 #include "paddle/pir/include/core/program.h"
 #include "paddle/pir/include/dialect/shape/ir/shape_dialect.h"
 #include "paddle/pir/include/dialect/shape/transforms/shape_optimization_pass.h"
+#include "paddle/pir/include/pass/pass_instrumentation.h"
 #include "paddle/pir/include/pass/pass_manager.h"
 
 #include "paddle/cinn/hlir/dialect/operator/ir/manual_op.h"
@@ -54,6 +55,7 @@
 #include "paddle/cinn/hlir/dialect/operator/transforms/shape_ops_fallback_to_phi_pass.h"
 #include "paddle/cinn/hlir/dialect/operator/transforms/specify_input_dynamic_dim_util.h"
 #include "paddle/cinn/hlir/dialect/operator/transforms/split_generate_shape_into_shape_ops_pass.h"
+#include "paddle/cinn/utils/profiler.h"
 #include "paddle/fluid/pir/transforms/build_cinn_pass.h"
 #include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/gpu/fused_gemm_epilogue_pass.h"
@@ -68,10 +70,27 @@ COMMON_DECLARE_bool(enable_fuse_parallel_matmul_pass);
 COMMON_DECLARE_bool(enable_fusion_fallback);
 COMMON_DECLARE_bool(logging_pir_py_code_dump_symbolic_dims);
 PD_DECLARE_bool(group_schedule_tiling_first);
+PD_DECLARE_string(cinn_compile_report_dir);
 
 namespace cinn::dialect::ir {
 
 namespace {
+// Records the time of each pass as an event of the compile report.
+class CompileReportInstrumentation : public pir::PassInstrumentation {
+ public:
+  void RunBeforePass(pir::Pass* pass, pir::Operation* op) override {
+    events_.push_back(std::make_unique<utils::RecordEvent>(
+        pass->name(), utils::EventType::kFusePass));
+  }
+
+  void RunAfterPass(pir::Pass* pass, pir::Operation* op) override {
+    if (!events_.empty()) events_.pop_back();
+  }
+
+ private:
+  std::vector<std::unique_ptr<utils::RecordEvent>> events_;
+};
+
 bool HasDynamicShape(const pir::Program& program) {
   if (FLAGS_disable_dyshape_in_train) {
     return false;
@@ -258,7 +277,16 @@ int64_t GetOpCount(const ::pir::Operation* op) {
 
 void ApplyCinnPass(::pir::Program* program,
                    const std::function<std::shared_ptr<pir::PassManager>()>&
-                       CreatePassManager) {
+                       CreateOriginPassManager) {
+  const bool enable_compile_report = !FLAGS_cinn_compile_report_dir.empty();
+  const auto CreatePassManager = [&]() -> std::shared_ptr<pir::PassManager> {
+    std::shared_ptr<pir::PassManager> pass_manager = CreateOriginPassManager();
+    if (enable_compile_report) {
+      pass_manager->AddInstrumentation(
+          std::make_unique<CompileReportInstrumentation>());
+    }
+    return pass_manager;
+  };
   const uint32_t origin_num_ops = program->num_ops();
   PirToPyCodeConverter(program)
       .file_name("original_programs.py")
@@ -287,7 +315,11 @@ void ApplyCinnPass(::pir::Program* program,
   }
 
   auto start = std::chrono::high_resolution_clock::now();
-  ApplyCinnLowerPass(program, CreatePassManager);
+  {
+    utils::RecordEvent record_lower("ApplyCinnLowerPass",
+                                    utils::EventType::kOrdinary);
+    ApplyCinnLowerPass(program, CreatePassManager);
+  }
   auto end = std::chrono::high_resolution_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - start);
   LOG(INFO) << "Time of lowering and compiling program: ***** [ "
@@ -298,6 +330,10 @@ void ApplyCinnPass(::pir::Program* program,
             << ", after lowering it becomes: " << new_num_ops
             << ". (compression ratio: " << new_num_ops << "/" << origin_num_ops
             << " = " << static_cast<float>(new_num_ops) / origin_num_ops << ")";
+  if (enable_compile_report) {
+    utils::HostEventRecorder::Dump(FLAGS_cinn_compile_report_dir);
+    utils::HostEventRecorder::GetInstance().Clear();
+  }
 }
 
 }  // namespace cinn::dialect::ir
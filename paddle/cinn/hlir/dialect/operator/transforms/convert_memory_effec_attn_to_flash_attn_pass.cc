@@ -14,6 +14,8 @@
 
 #include "paddle/cinn/hlir/dialect/operator/transforms/convert_memory_effec_attn_to_flash_attn_pass.h"
 
+#include <optional>
+
 #include "paddle/cinn/hlir/dialect/operator/ir/cinn_op.h"
 #include "paddle/cinn/hlir/dialect/operator/ir/manual_op.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
@@ -33,6 +35,92 @@ namespace cinn {
 namespace dialect {
 namespace ir {
 
+// Folds a scale op on the query or the key, e.g. the q * (1 / sqrt(d)) of
+// a model with the softmax scale applied outside of the attention, into the
+// scale of the attention, as the scores are linear in each of them. The
+// scale kernel is removed, and the attention may be converted to flash
+// attention once its scale is the default one.
+class FoldScaleIntoMEAPattern
+    : public pir::OpRewritePattern<
+          paddle::dialect::MemoryEfficientAttentionOp> {
+ public:
+  using pir::OpRewritePattern<
+      paddle::dialect::MemoryEfficientAttentionOp>::OpRewritePattern;
+
+  bool MatchAndRewrite(paddle::dialect::MemoryEfficientAttentionOp op,
+                       pir::PatternRewriter& rewriter) const override {
+    bool is_test =
+        op->attribute("is_test").dyn_cast<pir::BoolAttribute>().data();
+    if (!is_test) {
+      return false;
+    }
+    // The query and the key.
+    for (uint32_t idx = 0; idx < 2; ++idx) {
+      auto scale_op = op->operand_source(idx)
+                          .defining_op<paddle::dialect::ScaleOp>();
+      if (!scale_op || !scale_op.result(0).HasOneUse()) {
+        continue;
+      }
+      auto factor = GetScaleFactor(scale_op);
+      if (!factor.has_value() || factor.value() <= 0) {
+        continue;
+      }
+      auto scale = GetAttentionScale(op);
+      if (!scale.has_value()) {
+        return false;
+      }
+      float new_scale = static_cast<float>(scale.value() * factor.value());
+      pir::Value input = scale_op->operand_source(0);
+      rewriter.UpdateRootInplace(op, [&]() {
+        op->operand(idx).set_source(input);
+        op->set_attribute(
+            "scale",
+            pir::FloatAttribute::get(rewriter.ir_context(), new_scale));
+      });
+      rewriter.EraseOp(scale_op);
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  // The factor of a scale op without bias, whose scale is a full op.
+  static std::optional<double> GetScaleFactor(paddle::dialect::ScaleOp op) {
+    if (op->attribute("bias").dyn_cast<pir::FloatAttribute>().data() != 0.0f) {
+      return std::nullopt;
+    }
+    auto full_op =
+        op->operand_source(1).defining_op<paddle::dialect::FullOp>();
+    if (!full_op) {
+      return std::nullopt;
+    }
+    return full_op.attribute("value")
+        .dyn_cast<paddle::dialect::ScalarAttribute>()
+        .data()
+        .to<double>();
+  }
+
+  // A negative scale means 1 / sqrt(head_dim), which needs a static head
+  // dim to be folded.
+  static std::optional<double> GetAttentionScale(
+      paddle::dialect::MemoryEfficientAttentionOp op) {
+    float scale = op->attribute("scale").dyn_cast<pir::FloatAttribute>().data();
+    if (scale >= 0) {
+      return scale;
+    }
+    auto head_dim =
+        phi::vectorize(op->operand_source(0)
+                           .type()
+                           .dyn_cast<paddle::dialect::DenseTensorType>()
+                           .dims())
+            .back();
+    if (head_dim <= 0) {
+      return std::nullopt;
+    }
+    return 1.0 / std::sqrt(head_dim);
+  }
+};
+
 class ConvertMEA2FAPattern : public pir::OpRewritePattern<
                                  paddle::dialect::MemoryEfficientAttentionOp> {
  public:
@@ -122,6 +210,7 @@ class ConvertMEA2FAPass : public pir::PatternRewritePass {
 
   pir::RewritePatternSet InitializePatterns(pir::IrContext* context) override {
     pir::RewritePatternSet ps(context);
+    ps.Add<FoldScaleIntoMEAPattern>(context, 2);
     ps.Add<ConvertMEA2FAPattern>(context);
     return ps;
   }
@@ -28,6 +28,7 @@ void FusionOpAnalysis::GatherGroup(pir::Operation* fusion_op) {
   VLOG(6) << "Gather Group " << group_ptr->FuncName()
           << " for fusion_op : " << fusion_op->id();
   group_infos_->insert({fusion_op, group_ptr});
+  fusion_ops_.push_back(fusion_op);
 }
 
 void FusionOpAnalysis::RunImpl(pir::Operation* op) {
@@ -50,8 +51,8 @@ void FusionOpAnalysis::PreCompileGroup() {
   if (!FLAGS_enable_cinn_compile_cache) return;
 
   std::vector<OpLoweringGroupPtr> groups;
-  for (auto& group_info : *group_infos_) {
-    groups.push_back(group_info.second);
+  for (auto* fusion_op : fusion_ops_) {
+    groups.push_back(group_infos_->at(fusion_op));
   }
   // Build and trigger compilaion cache.
   VLOG(4) << "Parallel Pre-Compile for Group with size: " << groups.size();
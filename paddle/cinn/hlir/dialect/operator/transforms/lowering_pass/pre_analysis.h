@@ -37,6 +37,8 @@ class FusionOpAnalysis final {
 
  private:
   GroupInfoMap* group_infos_;  // not_owned
+  // in the order of the program, which is the order to compile the groups
+  std::vector<pir::Operation*> fusion_ops_;
   bool is_dy_shape_;
 };
 }  // namespace cinn::dialect::ir::details
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "paddle/cinn/common/macros.h"
+
+namespace cinn::hlir::framework::pir {
+
+// The threads to compile the lowered groups in background, in the order of
+// submission. The groups are submitted in the order of the program, so that
+// the kernels run earlier are ready earlier.
+class AsyncCompilationPool final {
+ public:
+  explicit AsyncCompilationPool(size_t thread_num) {
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads_.emplace_back([this] { Loop(); });
+    }
+  }
+
+  // Runs the submitted tasks and joins the threads.
+  ~AsyncCompilationPool() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      tasks_.emplace_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  CINN_DISALLOW_COPY_AND_ASSIGN(AsyncCompilationPool);
+
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace cinn::hlir::framework::pir
@@ -0,0 +1,51 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/async_compilation_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace cinn::hlir::framework::pir {
+
+TEST(AsyncCompilationPool, RunsTasksBeforeJoining) {
+  std::atomic<int> num_done{0};
+  auto pool = std::make_unique<AsyncCompilationPool>(2);
+  for (int i = 0; i < 8; ++i) {
+    pool->Submit([&num_done] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      ++num_done;
+    });
+  }
+  // the destructor waits for the queued tasks and joins the threads, so
+  // nothing touches num_done once it returns
+  pool.reset();
+  EXPECT_EQ(num_done.load(), 8);
+}
+
+TEST(AsyncCompilationPool, RunsInSubmissionOrder) {
+  std::vector<int> order;
+  {
+    AsyncCompilationPool pool(1);
+    for (int i = 0; i < 4; ++i) {
+      pool.Submit([&order, i] { order.push_back(i); });
+    }
+  }
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3}));
+}
+
+}  // namespace cinn::hlir::framework::pir
@@ -13,7 +13,32 @@
 // limitations under the License.
 
 #include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Host.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef CINN_WITH_CUDA
+#include <cuda.h>
+#include <cuda_runtime_api.h>
+#endif
+
 #include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/cinn/hlir/framework/visualize_helper.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/stable_hash.h"
+
+PD_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(cinn_compile_cache_dir);
+PD_DECLARE_string(cinn_debug_custom_code_path);
 
 namespace cinn::hlir::framework {
 
@@ -57,6 +82,60 @@ pir::CINNKernelInfo BackendResource::GenerateKernelInfo() const {
   kernel_info.temp_space_sizes = GetTempSpaceSizes();
   return kernel_info;
 }
+
+void CompilationResult::SetBackendResourceFuture(
+    const pir::CINNKernelInfo& pending_kernel_info,
+    const std::shared_future<std::shared_ptr<BackendResource>>& future) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  pending_kernel_info_ = pending_kernel_info;
+  pending_kernel_info_.fn_ptr = nullptr;
+  pending_kernel_info_.infer_shape_fn_ptr = nullptr;
+  pending_kernel_info_.CX86_fn_ptr = nullptr;
+  backend_resource_future_ = future;
+}
+
+bool CompilationResult::IsReady() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return !backend_resource_future_.valid() ||
+         backend_resource_future_.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+}
+
+void CompilationResult::WaitBackendResource() const {
+  std::shared_future<std::shared_ptr<BackendResource>> future;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!backend_resource_future_.valid()) {
+      return;
+    }
+    future = backend_resource_future_;
+  }
+  // rethrows the exception of the compilation
+  const auto& backend_resource = future.get();
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (backend_resource_future_.valid()) {
+    backend_resource_ = backend_resource;
+    backend_resource_future_ = {};
+  }
+}
+
+pir::CINNKernelInfo CompilationResult::GetKernelInfo() {
+  if (!IsReady()) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pir::CINNKernelInfo kernel_info = pending_kernel_info_;
+    kernel_info.pending_result = shared_from_this();
+    return kernel_info;
+  }
+  return WaitKernelInfo();
+}
+
+pir::CINNKernelInfo CompilationResult::WaitKernelInfo() {
+  PADDLE_ENFORCE_NOT_NULL(GetBackendResource(),
+                          ::common::errors::PreconditionNotMet(
+                              "Found backend_resource_ is nullptr, please "
+                              "call SetBackendResource first."));
+  return backend_resource_->GenerateKernelInfo();
+}
 }  // namespace pir
 
 bool CompilationCache::Has(const CacheKey& key) const {
@@ -92,4 +171,351 @@ void CompilationCache::Insert(const CacheKey& key, const CacheValue& value) {
 
 void CompilationCache::Clear() { cache_.clear(); }
 
+namespace {
+// Bump it when the layout of the entry files or the generated code changes.
+constexpr uint32_t kEntryVersion = 1;
+constexpr char kEntryMagic[8] = {'C', 'I', 'N', 'N', 'C', 'C', 'H', 'E'};
+
+using SymbolArgBindInfo = pir::CINNKernelInfo::SymbolArgBindInfo;
+
+std::string CacheKey(const pir::FusionInfo& info, const Target& target) {
+  std::ostringstream os;
+  os << "version: " << kEntryVersion << "\n";
+  os << target << "\n";
+  os << "llvm: " << LLVM_VERSION_STRING
+     << ", host cpu: " << llvm::sys::getHostCPUName().str() << "\n";
+#ifdef CINN_WITH_CUDA
+  if (std::holds_alternative<common::NVGPUArch>(target.arch)) {
+    int device_id = 0;
+    int major = 0;
+    int minor = 0;
+    cudaGetDevice(&device_id);
+    cudaDeviceGetAttribute(
+        &major, cudaDevAttrComputeCapabilityMajor, device_id);
+    cudaDeviceGetAttribute(
+        &minor, cudaDevAttrComputeCapabilityMinor, device_id);
+    os << "cuda: " << CUDA_VERSION << ", device: " << target.device_name_str()
+       << ", sm_" << major << minor << "\n";
+  }
+#endif
+  os << info.Fingerprint();
+  return os.str();
+}
+
+class EntryWriter {
+ public:
+  explicit EntryWriter(std::ostream* os) : os_(os) {}
+
+  template <typename T>
+  void Write(const T& value) {
+    os_->write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteString(const std::string& str) {
+    Write<uint64_t>(str.size());
+    os_->write(str.data(), str.size());
+  }
+
+  void WriteStrings(const std::vector<std::string>& strs) {
+    Write<uint64_t>(strs.size());
+    for (const auto& str : strs) {
+      WriteString(str);
+    }
+  }
+
+ private:
+  std::ostream* os_;
+};
+
+// All reads return false on truncated or corrupted files.
+class EntryReader {
+ public:
+  EntryReader(std::istream* is, uint64_t size) : is_(is), remaining_(size) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    if (remaining_ < sizeof(T)) {
+      return false;
+    }
+    remaining_ -= sizeof(T);
+    return static_cast<bool>(
+        is_->read(reinterpret_cast<char*>(value), sizeof(T)));
+  }
+
+  bool ReadString(std::string* str) {
+    uint64_t size = 0;
+    if (!Read(&size) || size > remaining_) {
+      return false;
+    }
+    remaining_ -= size;
+    str->resize(size);
+    return size == 0 || static_cast<bool>(is_->read(&(*str)[0], size));
+  }
+
+  bool ReadStrings(std::vector<std::string>* strs) {
+    uint64_t num = 0;
+    if (!Read(&num) || num > remaining_) {
+      return false;
+    }
+    strs->resize(num);
+    for (auto& str : *strs) {
+      if (!ReadString(&str)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool AtEnd() const { return remaining_ == 0; }
+
+ private:
+  std::istream* is_;
+  uint64_t remaining_;
+};
+}  // namespace
+
+bool PersistentCompilationCache::Enabled() const {
+  // Without FLAGS_enable_cinn_compile_cache the FusionInfo of each group is
+  // unique, and custom code is for debugging only, neither should be cached.
+  return FLAGS_enable_cinn_compile_cache &&
+         !FLAGS_cinn_compile_cache_dir.empty() &&
+         FLAGS_cinn_debug_custom_code_path.empty();
+}
+
+std::shared_ptr<pir::CompilationResult> PersistentCompilationCache::Load(
+    const pir::FusionInfo& info, const Target& target) {
+  if (!Enabled()) {
+    return nullptr;
+  }
+  const std::string key = CacheKey(info, target);
+  std::shared_ptr<const Entry> entry;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      entry = it->second;
+    }
+  }
+  if (entry == nullptr) {
+    entry = ReadEntry(key);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_.emplace(key, entry);
+  }
+
+  try {
+    auto backend_resource =
+        std::make_shared<pir::BackendResource>(target,
+                                               entry->host_fn_name,
+                                               entry->infer_fn_name,
+                                               entry->symbol_args_map,
+                                               entry->temp_space_sizes);
+    backend_resource->GetBackendCompiler()->Load(entry->artifacts);
+    auto compilation_result = std::make_shared<pir::CompilationResult>(target);
+    compilation_result->SetBackendResource(backend_resource);
+    // Resolve the symbols in this thread, like PirCompiler::Compile does.
+    compilation_result->GetKernelInfo();
+    VLOG(4) << "Load " << info << " from " << EntryPath(key)
+            << ", host func name: " << entry->host_fn_name;
+    return compilation_result;
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Failed to load " << EntryPath(key)
+                 << " of the compilation cache, the group will be compiled "
+                    "again: "
+                 << e.what();
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_.erase(key);
+    return nullptr;
+  }
+}
+
+void PersistentCompilationCache::Save(const pir::FusionInfo& info,
+                                      const Target& target,
+                                      const pir::CompilationResult& result) {
+  if (!Enabled()) {
+    return;
+  }
+  const auto& backend_resource = result.GetBackendResource();
+  PADDLE_ENFORCE_NOT_NULL(backend_resource,
+                          ::common::errors::PreconditionNotMet(
+                              "Found backend_resource_ is nullptr, please "
+                              "call SetBackendResource first."));
+  auto entry = std::make_shared<Entry>();
+  entry->key = CacheKey(info, target);
+  entry->host_fn_name = backend_resource->GetHostFuncName();
+  entry->infer_fn_name = backend_resource->GetInferFuncName();
+  entry->symbol_args_map = backend_resource->GetSymbolArgsMap();
+  entry->temp_space_sizes = backend_resource->GetTempSpaceSizes();
+  entry->artifacts = backend_resource->GetBackendCompiler()->ExportArtifacts();
+  if (entry->artifacts.host_objects.empty()) {
+    VLOG(4) << "Skip saving " << info
+            << " into the compilation cache, its host module is not "
+               "compiled yet.";
+    return;
+  }
+  WriteEntry(*entry);
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.emplace(entry->key, entry);
+}
+
+void PersistentCompilationCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+}
+
+std::string PersistentCompilationCache::EntryPath(
+    const std::string& key) const {
+  std::ostringstream os;
+  os << FLAGS_cinn_compile_cache_dir << "/" << std::hex
+     << ::common::StableHash(key) << ".cinn";
+  return os.str();
+}
+
+std::shared_ptr<const PersistentCompilationCache::Entry>
+PersistentCompilationCache::ReadEntry(const std::string& key) const {
+  const std::string path = EntryPath(key);
+  std::ifstream is(path, std::ios::binary | std::ios::ate);
+  if (!is.is_open()) {
+    VLOG(6) << "No compilation cache file " << path;
+    return nullptr;
+  }
+  const uint64_t size = is.tellg();
+  is.seekg(0);
+  EntryReader reader(&is, size);
+
+  auto entry = std::make_shared<Entry>();
+  char magic[sizeof(kEntryMagic)];
+  uint32_t version = 0;
+  const auto ReadHeader = [&]() -> bool {
+    return reader.Read(&magic) &&
+           std::equal(magic, magic + sizeof(magic), kEntryMagic) &&
+           reader.Read(&version) && version == kEntryVersion &&
+           reader.ReadString(&entry->key);
+  };
+  if (!ReadHeader()) {
+    LOG(WARNING) << "Ignore " << path
+                 << ", which is not a compilation cache file of version "
+                 << kEntryVersion;
+    return nullptr;
+  }
+  if (entry->key != key) {
+    VLOG(4) << "Ignore " << path << " whose key collides with the group.";
+    return nullptr;
+  }
+
+  const auto ReadSymbolArgs = [&]() -> bool {
+    uint64_t num = 0;
+    if (!reader.Read(&num)) return false;
+    for (uint64_t i = 0; i < num; ++i) {
+      int32_t arg_pos = 0;
+      uint8_t kind = 0;
+      int32_t arg_idx = 0;
+      int32_t sub_idx = 0;
+      if (!(reader.Read(&arg_pos) && reader.Read(&kind) &&
+            reader.Read(&arg_idx) && reader.Read(&sub_idx))) {
+        return false;
+      }
+      if (kind == 0) {
+        entry->symbol_args_map[arg_pos] =
+            pir::CINNKernelInfo::ArgDimIdx{arg_idx, sub_idx};
+      } else if (kind == 1) {
+        entry->symbol_args_map[arg_pos] =
+            pir::CINNKernelInfo::ArgValueIdx{arg_idx, sub_idx};
+      } else {
+        return false;
+      }
+    }
+    return true;
+  };
+  const auto ReadTempSpaceSizes = [&]() -> bool {
+    uint64_t num = 0;
+    if (!reader.Read(&num)) return false;
+    entry->temp_space_sizes.resize(num);
+    for (auto& temp_space_size : entry->temp_space_sizes) {
+      if (!reader.Read(&temp_space_size)) return false;
+    }
+    return true;
+  };
+  auto& artifacts = entry->artifacts;
+  uint8_t is_cubin = 0;
+  const bool success =
+      reader.ReadString(&entry->host_fn_name) &&
+      reader.ReadString(&entry->infer_fn_name) && ReadSymbolArgs() &&
+      ReadTempSpaceSizes() && reader.ReadStrings(&artifacts.host_objects) &&
+      reader.ReadString(&artifacts.device_code) && reader.Read(&is_cubin) &&
+      reader.ReadStrings(&artifacts.device_fn_names) && reader.AtEnd();
+  if (!success) {
+    LOG(WARNING) << "Ignore the corrupted compilation cache file " << path;
+    return nullptr;
+  }
+  artifacts.device_code_is_cubin = is_cubin != 0;
+  return entry;
+}
+
+void PersistentCompilationCache::WriteEntry(const Entry& entry) const {
+  if (!MakeDirectory(FLAGS_cinn_compile_cache_dir,
+                     S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) {
+    return;
+  }
+  const std::string path = EntryPath(entry.key);
+  // Write a temporary file and rename it, so that the processes sharing the
+  // directory never read a partial file.
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp." << getpid() << "."
+           << std::hash<std::thread::id>()(std::this_thread::get_id());
+  {
+    std::ofstream os(tmp_path.str(), std::ios::binary | std::ios::trunc);
+    if (!os.is_open()) {
+      LOG(WARNING) << "Failed to open " << tmp_path.str()
+                   << " to save the compilation cache.";
+      return;
+    }
+    EntryWriter writer(&os);
+    writer.Write(kEntryMagic);
+    writer.Write(kEntryVersion);
+    writer.WriteString(entry.key);
+    writer.WriteString(entry.host_fn_name);
+    writer.WriteString(entry.infer_fn_name);
+    writer.Write<uint64_t>(entry.symbol_args_map.size());
+    for (const auto& [arg_pos, bind_info] : entry.symbol_args_map) {
+      writer.Write<int32_t>(arg_pos);
+      writer.Write<uint8_t>(bind_info.index());
+      std::visit(
+          [&](const auto& idx) {
+            writer.Write<int32_t>(idx.arg_idx);
+            using T = std::decay_t<decltype(idx)>;
+            if constexpr (std::is_same_v<T, pir::CINNKernelInfo::ArgDimIdx>) {
+              writer.Write<int32_t>(idx.dim_idx);
+            } else {
+              writer.Write<int32_t>(idx.value_idx);
+            }
+          },
+          bind_info);
+    }
+    writer.Write<uint64_t>(entry.temp_space_sizes.size());
+    for (int64_t temp_space_size : entry.temp_space_sizes) {
+      writer.Write(temp_space_size);
+    }
+    writer.WriteStrings(entry.artifacts.host_objects);
+    writer.WriteString(entry.artifacts.device_code);
+    writer.Write<uint8_t>(entry.artifacts.device_code_is_cubin);
+    writer.WriteStrings(entry.artifacts.device_fn_names);
+    if (!os.good()) {
+      LOG(WARNING) << "Failed to write " << tmp_path.str()
+                   << " to save the compilation cache.";
+      os.close();
+      std::remove(tmp_path.str().c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to rename " << tmp_path.str() << " to " << path;
+    std::remove(tmp_path.str().c_str());
+    return;
+  }
+  VLOG(4) << "Save compilation cache file " << path;
+}
+
 }  // namespace cinn::hlir::framework
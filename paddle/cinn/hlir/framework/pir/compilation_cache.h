@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "paddle/cinn/backends/compiler.h"
 #include "paddle/cinn/common/macros.h"
@@ -57,6 +59,7 @@ class BackendResource final {
   }
   pir::CINNKernelInfo GenerateKernelInfo() const;
   const std::string& GetHostFuncName() const { return host_fn_name_; }
+  const std::string& GetInferFuncName() const { return infer_fn_name_; }
 
  private:
   std::string host_fn_name_;
@@ -67,10 +70,14 @@ class BackendResource final {
   std::shared_ptr<backends::Compiler> backend_compiler_{nullptr};
 };
 
-class CompilationResult final {
+class CompilationResult final
+    : public std::enable_shared_from_this<CompilationResult> {
  public:
   explicit CompilationResult(const Target& target) : target_(target) {}
+
+  // Waits for the backend resource if it is compiled asynchronously.
   const std::shared_ptr<BackendResource>& GetBackendResource() const {
+    WaitBackendResource();
     return backend_resource_;
   }
 
@@ -78,6 +85,15 @@ class CompilationResult final {
     backend_resource_ = other;
   }
 
+  // For the asynchronous compilation, the backend resource is given by the
+  // compiling thread through future later, while pending_kernel_info, which
+  // has no function pointers, is available at once.
+  void SetBackendResourceFuture(
+      const pir::CINNKernelInfo& pending_kernel_info,
+      const std::shared_future<std::shared_ptr<BackendResource>>& future);
+
+  bool IsReady() const;
+
   const std::string& GetHostFuncName() const {
     PADDLE_ENFORCE_NOT_NULL(GetBackendResource(),
                             ::common::errors::PreconditionNotMet(
@@ -86,17 +102,22 @@ class CompilationResult final {
     return GetBackendResource()->GetHostFuncName();
   }
 
-  pir::CINNKernelInfo GetKernelInfo() {
-    PADDLE_ENFORCE_NOT_NULL(backend_resource_,
-                            ::common::errors::PreconditionNotMet(
-                                "Found backend_resource_ is nullptr, please "
-                                "call SetBackendResource first."));
-    return backend_resource_->GenerateKernelInfo();
-  }
+  // Returns the pending kernel info without waiting if the compilation is not
+  // done yet, see CINNKernelInfo::pending_result.
+  pir::CINNKernelInfo GetKernelInfo();
+
+  pir::CINNKernelInfo WaitKernelInfo();
 
  private:
+  void WaitBackendResource() const;
+
   Target target_;
-  std::shared_ptr<BackendResource> backend_resource_{nullptr};
+  mutable std::shared_ptr<BackendResource> backend_resource_{nullptr};
+
+  mutable std::mutex mutex_;
+  mutable std::shared_future<std::shared_ptr<BackendResource>>
+      backend_resource_future_;
+  pir::CINNKernelInfo pending_kernel_info_;
 };
 
 }  // namespace pir
@@ -126,4 +147,57 @@ class CompilationCache {
   std::unordered_map<CacheKey, CacheValue> cache_;
 };
 
+/**
+ * PersistentCompilationCache saves the compiled code of fusion groups into
+ * FLAGS_cinn_compile_cache_dir, so that the later processes load them instead
+ * of lowering and compiling the groups again. The entries are keyed by
+ * FusionInfo::Fingerprint() together with the versions of the compilers and
+ * the device.
+ *
+ * Unlike CompilationCache, it is shared by all threads: the loaded entries are
+ * kept in memory, and every Load creates a new CompilationResult whose device
+ * module is bound to the device of the calling thread.
+ */
+class PersistentCompilationCache {
+ public:
+  static PersistentCompilationCache& Instance() {
+    static PersistentCompilationCache instance;
+    return instance;
+  }
+
+  bool Enabled() const;
+
+  // Returns nullptr if the group is not cached or fails to load.
+  std::shared_ptr<pir::CompilationResult> Load(const pir::FusionInfo& info,
+                                               const Target& target);
+
+  // The symbols of result must be looked up, see Compiler::ExportArtifacts.
+  void Save(const pir::FusionInfo& info,
+            const Target& target,
+            const pir::CompilationResult& result);
+
+  // Drops the entries kept in memory, the later Loads read the files again.
+  void Clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string host_fn_name;
+    std::string infer_fn_name;
+    std::map<int, pir::CINNKernelInfo::SymbolArgBindInfo> symbol_args_map;
+    std::vector<int64_t> temp_space_sizes;
+    backends::CompiledArtifacts artifacts;
+  };
+
+  PersistentCompilationCache() = default;
+  CINN_DISALLOW_COPY_AND_ASSIGN(PersistentCompilationCache);
+
+  std::string EntryPath(const std::string& key) const;
+  std::shared_ptr<const Entry> ReadEntry(const std::string& key) const;
+  void WriteEntry(const Entry& entry) const;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const Entry>> entries_;
+};
+
 }  // namespace cinn::hlir::framework
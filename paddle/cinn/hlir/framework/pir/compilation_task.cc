@@ -22,6 +22,7 @@
 #include "paddle/cinn/hlir/framework/op_lowering.h"
 #include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/utils/profiler.h"
 #include "paddle/common/enforce.h"
 namespace cinn {
 namespace hlir {
@@ -153,6 +154,8 @@ std::shared_ptr<pir::CompilationResult> CompilationTask::operator()() {
 }
 
 void CompilationTask::Lowering() {
+  utils::RecordEvent record_lowering("CompilationTask::Lowering",
+                                     utils::EventType::kCompute);
   VLOG(5) << "Begin to lowering group: " << *context_->group_;
   auto op_lowerer = CreateOpLowerer<pir::OpLoweringGroupPtr>(context_->target_);
   context_->SetLoweredFuncs(op_lowerer.BucketLower(context_->group_));
@@ -202,6 +205,8 @@ void CompilationTask::Lowering() {
 }
 
 std::shared_ptr<pir::CompilationResult> CompilationTask::CodegenAndJit() {
+  utils::RecordEvent record_codegen("CompilationTask::CodegenAndJit",
+                                    utils::EventType::kCodeGen);
   context_->PrepareModuleBuilder();
   ir::Module ir_module = context_->module_builder_.Build();
   ir::Module ir_moduleCX86 = context_->CX86_module_builder_.Build();
@@ -231,6 +236,8 @@ std::shared_ptr<pir::CompilationResult>
 CompilationTask::CompileBroadcastModules(
     std::vector<GroupCompilationContext>* leaf_group_contexts,
     const std::unordered_map<int, ir::Var>& symbolic_shape_var_index) {
+  utils::RecordEvent record_codegen("CompilationTask::CompileBroadcastModules",
+                                    utils::EventType::kCodeGen);
   auto compilation_result =
       std::make_shared<pir::CompilationResult>(context_->target_);
   auto backend_resource = std::make_shared<pir::BackendResource>(
@@ -36,6 +36,7 @@ class GroupCompilationContext {
         CX86_module_builder_(cinn::common::UniqName("module"),
                              common::DefaultHostTarget()) {}
 
+  const Target& GetTarget() const { return target_; }
   const pir::OpLoweringGroupPtr& GetGroup() const { return group_; }
   void SetLoweredFuncs(BucketLoweredFuncsWrapper&& funcs);
   void PrepareModuleBuilder();
@@ -66,13 +67,17 @@ class CompilationTask {
       : context_(context) {}
 
   std::shared_ptr<pir::CompilationResult> operator()();
+  // Lowering() works on the pir::Operation of the group, while the code
+  // generation and compilation after it only need the lowered functions, so
+  // that they can run after the program is changed, see
+  // FLAGS_cinn_async_compile.
   void Lowering();
+  std::shared_ptr<pir::CompilationResult> CodegenAndJit();
   std::shared_ptr<pir::CompilationResult> CompileBroadcastModules(
       std::vector<GroupCompilationContext>* leaf_group_contexts,
       const std::unordered_map<int, ir::Var>& symbolic_shape_var_index);
 
  private:
-  std::shared_ptr<pir::CompilationResult> CodegenAndJit();
   std::shared_ptr<pir::CompilationResult> BuildPirCINNKernelInfo(
       const ir::Module& module, const ir::Module& CX86module);
 
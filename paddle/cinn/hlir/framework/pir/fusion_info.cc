@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/cinn/hlir/framework/pir/fusion_info.h"
+#include <sstream>
 #include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
 #include "paddle/pir/include/core/ir_printer.h"
@@ -26,6 +27,11 @@ constexpr static char* kSymShapeStr = "sym_shape_str";
 
 std::size_t AttributeInfo::hash() const { return attr_.hash(); }
 
+void AttributeInfo::PrintFingerprint(std::ostream& os) const {
+  os << name_ << "=";
+  ::pir::IrPrinter(os).PrintAttribute(attr_);
+}
+
 std::ostream& operator<<(std::ostream& os, const AttributeInfo& attr_info) {
   os << "AttributeInfo - " << attr_info.name_ << ", " << attr_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -38,6 +44,10 @@ std::ostream& operator<<(std::ostream& os, const AttributeInfo& attr_info) {
 
 std::size_t ValueInfo::hash() const { return type_.hash(); }
 
+void ValueInfo::PrintFingerprint(std::ostream& os) const {
+  ::pir::IrPrinter(os).PrintType(type_);
+}
+
 std::ostream& operator<<(std::ostream& os, const ValueInfo& value_info) {
   os << "ValueInfo - " << value_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -81,6 +91,21 @@ std::size_t OperationInfo::hash() const {
   return seed;
 }
 
+void OperationInfo::PrintFingerprint(std::ostream& os) const {
+  const auto PrintInfos = [&](const auto& infos) {
+    os << "(";
+    for (const auto& info : infos) {
+      info.PrintFingerprint(os);
+      os << ";";
+    }
+    os << ")";
+  };
+  os << name_;
+  PrintInfos(input_infos_);
+  PrintInfos(output_infos_);
+  PrintInfos(attr_infos_);
+}
+
 std::ostream& operator<<(std::ostream& os, const OperationInfo& op_info) {
   os << op_info.name_ << " - " << op_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -99,6 +124,12 @@ std::ostream& operator<<(std::ostream& os, const OpDepInfo& info) {
   return os;
 }
 
+void OpDepInfo::PrintFingerprint(std::ostream& os) const {
+  // upstream_hash_ is not stable, and the upstream op is identified by its
+  // index already.
+  os << upstream_index_;
+}
+
 std::size_t OpDepInfo::hash() const {
   std::size_t seed = 1789;
   hash_combine(seed, upstream_index_);
@@ -115,6 +146,17 @@ std::size_t FusionOpInfo::hash() const {
   return seed;
 }
 
+void FusionOpInfo::PrintFingerprint(std::ostream& os) const {
+  op_info_.PrintFingerprint(os);
+  os << " deps{";
+  for (const auto& [value_index, dep_info] : inner_deps_) {
+    os << value_index << ":";
+    dep_info.PrintFingerprint(os);
+    os << ";";
+  }
+  os << "}";
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionOpInfo& info) {
   os << info.op_info_ << ", inner_deps:{";
   for (const auto& [value_index, op_info_hash] : info.inner_deps_) {
@@ -203,6 +245,18 @@ std::size_t FusionInfo::hash() const {
   return seed;
 }
 
+std::string FusionInfo::Fingerprint() const {
+  std::ostringstream os;
+  if (!FLAGS_enable_cinn_compile_cache) os << unique_fn_name_ << "\n";
+  for (const auto& info : op_infos_) {
+    info.PrintFingerprint(os);
+    os << "\n";
+  }
+  os << "input_dim_exprs:";
+  for (const auto& dim_expr : input_dim_exprs_) os << " " << dim_expr;
+  return os.str();
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionInfo& fusion_info) {
   os << "FusionInfo - " << fusion_info.hash();
   if (VLOG_IS_ON(5)) {
@@ -41,6 +41,7 @@
 #include "paddle/cinn/optim/rearrange_load_instruction.h"
 #include "paddle/cinn/optim/schedule_block_dce.h"
 #include "paddle/cinn/optim/transform_gpu_forloop.h"
+#include "paddle/cinn/utils/profiler.h"
 #include "paddle/common/ddim.h"
 #include "paddle/common/enforce.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
@@ -103,8 +104,11 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   std::unordered_map<::pir::Value, ir::Tensor> tensor_map;
   // for some op, it will output more tmp value and regard as
   // XX_0, XX_1, so we log them in tmp_tensor_info;
+  utils::RecordEvent record_lower_ops("OpLowererImpl::LowerOps",
+                                      utils::EventType::kCompute);
   std::vector<ir::Expr> func_bodies =
       LowerOps(group, ops, &group_func_arg_tensors, &tensor_map);
+  record_lower_ops.End();
 
   if (FLAGS_cinn_check_tensor_buffer_map) {
     optim::CheckTensorBufferMap(func_bodies, "BucketLower LowerOps");
@@ -114,9 +118,12 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   // =========== OpFusion ============
 
   // VLOG(4) << "Bucket Lower output values is : " << group->output_values();
+  utils::RecordEvent record_fusion("OpLowererImpl::OperationFusion",
+                                   utils::EventType::kCompute);
   func_bodies = OperationFusion(ops, func_bodies, group->fusion_tracker_ptr);
   std::shared_ptr<FusionGroupInfo> fusion_group_info =
       GetFusionGroupInfo(func_bodies);
+  record_fusion.End();
   // TODO(liangshuhao): grid reduce is disabled for broadcast-leaf group now,
   // because grid reduce introduces extra func args that currently cannot be
   // unified with other broadcast-leaf groups.
@@ -151,6 +158,8 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
     output_tensor_names.insert(ValueName(value));
   }
 
+  utils::RecordEvent record_schedule("OpLowererImpl::GroupSchedule",
+                                     utils::EventType::kSchedule);
   std::unique_ptr<ir::GroupScheduler> group_scheduler =
       ir::GroupScheduler::Make(&ir_sch,
                                output_tensor_names,
@@ -161,6 +170,7 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   VLOG(4) << "Start apply group_scheduler->Schedule()";
   group_scheduler->Schedule();
   VLOG(4) << "End   apply group_scheduler->Schedule()";
+  record_schedule.End();
 
   cond2func_bodies = group_scheduler->GetIRs();
   VLOG(4) << "End   group_scheduler->GetIRs";
@@ -190,12 +200,16 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   std::vector<ir::Tensor> group_func_arg_tensors_copy = group_func_arg_tensors;
   std::vector<ir::Argument> group_func_args;
   std::vector<ir::Tensor> infer_shape_tensor_args;
+  utils::RecordEvent record_post_process("OpLowererImpl::PostProcess",
+                                         utils::EventType::kOptimize);
   std::vector<ir::LoweredFunc> funcs = PostProcess(group,
                                                    tensor_map,
                                                    {scheduled_func_bodies},
                                                    &group_func_arg_tensors_copy,
                                                    &group_func_args,
                                                    &infer_shape_tensor_args);
+  record_post_process.End();
+  utils::RecordCount("bucket_kernels", funcs.size());
   if (FLAGS_cinn_check_tensor_buffer_map) {
     for (ir::LoweredFunc& func : funcs) {
       optim::CheckTensorBufferMap(Expr(func), "BucketLower PostProcess");
@@ -29,12 +29,19 @@ namespace hlir {
 namespace framework {
 
 namespace pir {
+class CompilationResult;
+
 struct CINNKernelInfo {
   std::string fn_name;
   void* fn_ptr;
   void* infer_shape_fn_ptr;
   void* CX86_fn_ptr;
 
+  // Not null if the kernel is being compiled in background, see
+  // FLAGS_cinn_async_compile. The function pointers are null then, and
+  // CompilationResult::WaitKernelInfo() gives the complete kernel info.
+  std::shared_ptr<CompilationResult> pending_result{nullptr};
+
   struct ArgDimIdx {
     int arg_idx;
     int dim_idx;
@@ -13,6 +13,11 @@
 // limitations under the License.
 
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "paddle/cinn/hlir/framework/pir/async_compilation_pool.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 
 #include "paddle/cinn/hlir/dialect/operator/transforms/lowering_pass/utils.h"
@@ -20,11 +25,13 @@
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/runtime/arch_device.h"
 #include "paddle/cinn/utils/multi_threading.h"
+#include "paddle/cinn/utils/profiler.h"
 #include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
 
 PD_DECLARE_bool(enable_cinn_compile_cache);
 PD_DECLARE_int64(cinn_compile_thread_num);
+PD_DECLARE_bool(cinn_async_compile);
 
 namespace cinn::hlir::framework {
 class CompilationContextMapper {
@@ -41,6 +48,10 @@ class CompilationContextMapper {
     return compilation_results_;
   }
 
+  const pir::FusionInfo& UniqueFusionInfo(size_t index) const {
+    return fusion_infos_.at(mapper_index_.at(index));
+  }
+
   std::vector<pir::CINNKernelInfo> RecoverKernelInfos();
   void UpdateGlobalCache();
   void SetFinalize(bool val) { is_finalized_ = val; }
@@ -68,6 +79,11 @@ static size_t GetThreadNum(size_t task_size) {
 
 std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     const std::vector<pir::OpLoweringGroupPtr>& groups) {
+  if (FLAGS_cinn_async_compile) {
+    return BuildAsync(groups);
+  }
+  utils::RecordEvent record_build("PirCompiler::Build",
+                                  utils::EventType::kOrdinary);
   CompilationContextMapper ctx_mapper(target_, groups);
   auto& group_compilation_contexts = ctx_mapper.UniqueCompilationContexts();
   auto& compilation_results = ctx_mapper.MutableCompilationResult();
@@ -76,15 +92,25 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
   const size_t thread_size = GetThreadNum(task_size);
   VLOG(5) << "Found " << task_size << " new groups parsed from "
           << groups.size() << " and compiles with " << thread_size;
+  utils::RecordCount("compilation_cache_hit", groups.size() - task_size);
   cinn::ir::InitScheduleConfig();
   if (task_size > 0) {
     // See
     // https://developer.nvidia.com/blog/cuda-pro-tip-always-set-current-device-avoid-multithreading-bugs/
     // for details.
     const auto device_id = runtime::GetArchDevice(target_);
+    auto& persistent_cache = PersistentCompilationCache::Instance();
     auto worker_fn = [&](int index) {
       runtime::SetArchDevice(target_, device_id);
-      compilation_results[index] = Compile(&group_compilation_contexts[index]);
+      const auto& fusion_info = ctx_mapper.UniqueFusionInfo(index);
+      auto compilation_result = persistent_cache.Load(fusion_info, target_);
+      if (compilation_result == nullptr) {
+        compilation_result = Compile(&group_compilation_contexts[index]);
+        persistent_cache.Save(fusion_info, target_, *compilation_result);
+      } else {
+        utils::RecordCount("persistent_cache_hit");
+      }
+      compilation_results[index] = compilation_result;
     };
     utils::parallel_run(worker_fn,
                         utils::SequenceDispatcher(0, task_size),
@@ -96,25 +122,35 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
   return ctx_mapper.RecoverKernelInfos();
 }
 
-std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
-    GroupCompilationContext* ctx) {
-  std::shared_ptr<pir::CompilationResult> compile_result;
-  CompilationTask task(ctx);
+namespace {
+// The contexts of the leaf groups of a broadcast tree, which are compiled into
+// one kernel with the switch of the broadcast conditions.
+struct BroadcastSwitchGroups {
+  std::vector<pir::OpLoweringGroupPtr> groups;
+  std::vector<GroupCompilationContext> contexts;
+  std::unordered_map<int, ir::Var> symbolic_shape_var_index;
+};
+}  // namespace
 
+PirCompiler::CodegenFunc PirCompiler::Lower(GroupCompilationContext* ctx) {
+  const std::string group_name = ctx->GetGroup()->FuncName();
+  utils::ScopedEventGroup event_group(group_name);
+  utils::RecordCount("compiled_groups");
   const auto& optional_broadcast_optimize_groups =
       pir::GetBroadcastGroupListForOptimize(ctx->GetGroup());
 
   if (optional_broadcast_optimize_groups.has_value()) {
-    const auto& broadcast_switch_case_groups =
-        optional_broadcast_optimize_groups.value();
-    std::vector<GroupCompilationContext> switch_group_ctxs;
-    for (const auto& group : broadcast_switch_case_groups) {
-      switch_group_ctxs.emplace_back(target_, group);
+    auto switch_groups = std::make_shared<BroadcastSwitchGroups>();
+    switch_groups->groups = optional_broadcast_optimize_groups.value();
+    auto& switch_group_ctxs = switch_groups->contexts;
+    for (const auto& group : switch_groups->groups) {
+      switch_group_ctxs.emplace_back(ctx->GetTarget(), group);
     }
 
     const auto& ParallelLowering = [&]() {
       const size_t task_size = switch_group_ctxs.size();
       auto worker_fn = [&](int index) {
+        utils::ScopedEventGroup event_group(group_name);
         CompilationTask lowering_task(&switch_group_ctxs[index]);
         lowering_task.Lowering();
       };
@@ -125,15 +161,28 @@ std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
     };
 
     ParallelLowering();
-    std::unordered_map<int, ir::Var> symbolic_shape_var_index;
-    UnifyBroadcastGroupFuncArgs(
-        &switch_group_ctxs, ctx->GetGroup(), &symbolic_shape_var_index);
-    compile_result = task.CompileBroadcastModules(&switch_group_ctxs,
-                                                  symbolic_shape_var_index);
-  } else {
-    compile_result = task();
+    UnifyBroadcastGroupFuncArgs(&switch_group_ctxs,
+                                ctx->GetGroup(),
+                                &switch_groups->symbolic_shape_var_index);
+    return [ctx, switch_groups, group_name]() {
+      utils::ScopedEventGroup event_group(group_name);
+      CompilationTask task(ctx);
+      return task.CompileBroadcastModules(
+          &switch_groups->contexts, switch_groups->symbolic_shape_var_index);
+    };
   }
+  CompilationTask(ctx).Lowering();
+  return [ctx, group_name]() {
+    utils::ScopedEventGroup event_group(group_name);
+    return CompilationTask(ctx).CodegenAndJit();
+  };
+}
 
+std::shared_ptr<pir::CompilationResult> PirCompiler::Compile(
+    GroupCompilationContext* ctx) {
+  std::shared_ptr<pir::CompilationResult> compile_result = Lower(ctx)();
+  utils::ScopedEventGroup event_group(ctx->GetGroup()->FuncName());
+  utils::RecordEvent record_jit("GetKernelInfo", utils::EventType::kCompile);
   // Triggering llvm compilation in thread
   compile_result->GetKernelInfo();
   return compile_result;
@@ -166,6 +215,101 @@ void CompilationContextMapper::Construct(
   }
 }
 
+namespace {
+pir::AsyncCompilationPool& GetAsyncCompilationPool() {
+  // Destroyed at exit after the running compilations finish.
+  static pir::AsyncCompilationPool pool(
+      FLAGS_cinn_compile_thread_num > 0
+          ? FLAGS_cinn_compile_thread_num
+          : std::max(1u, std::thread::hardware_concurrency()));
+  return pool;
+}
+
+// Everything the contexts of an asynchronous compilation refer to, which is
+// kept alive until all its groups are compiled.
+struct AsyncCompilationJob {
+  AsyncCompilationJob(const Target& target,
+                      const std::vector<pir::OpLoweringGroupPtr>& groups)
+      : target(target), groups(groups), ctx_mapper(this->target, this->groups) {}
+
+  Target target;
+  std::vector<pir::OpLoweringGroupPtr> groups;
+  CompilationContextMapper ctx_mapper;
+};
+}  // namespace
+
+std::vector<pir::CINNKernelInfo> PirCompiler::BuildAsync(
+    const std::vector<pir::OpLoweringGroupPtr>& groups) {
+  auto job = std::make_shared<AsyncCompilationJob>(target_, groups);
+  auto& ctx_mapper = job->ctx_mapper;
+  auto& group_compilation_contexts = ctx_mapper.UniqueCompilationContexts();
+  auto& compilation_results = ctx_mapper.MutableCompilationResult();
+
+  const size_t task_size = group_compilation_contexts.size();
+  const size_t thread_size = GetThreadNum(task_size);
+  VLOG(5) << "Found " << task_size << " new groups parsed from "
+          << groups.size() << " and lowers with " << thread_size;
+  utils::RecordCount("compilation_cache_hit", groups.size() - task_size);
+  cinn::ir::InitScheduleConfig();
+  const auto device_id = runtime::GetArchDevice(target_);
+  auto& persistent_cache = PersistentCompilationCache::Instance();
+  // Lowering works on the program, which is changed after Build returns, so
+  // it is done in this call, and only the codegen runs in background.
+  std::vector<CodegenFunc> codegen_funcs(task_size);
+  auto worker_fn = [&](int index) {
+    runtime::SetArchDevice(target_, device_id);
+    auto compilation_result =
+        persistent_cache.Load(ctx_mapper.UniqueFusionInfo(index), job->target);
+    if (compilation_result != nullptr) {
+      utils::RecordCount("persistent_cache_hit");
+      compilation_results[index] = compilation_result;
+    } else {
+      codegen_funcs[index] = Lower(&group_compilation_contexts[index]);
+    }
+  };
+  if (task_size > 0) {
+    utils::parallel_run(worker_fn,
+                        utils::SequenceDispatcher(0, task_size),
+                        /*thread_num=*/thread_size);
+  }
+
+  for (size_t i = 0; i < task_size; ++i) {
+    if (!codegen_funcs[i]) {
+      continue;
+    }
+    const auto& group = group_compilation_contexts[i].GetGroup();
+    pir::CINNKernelInfo pending_kernel_info;
+    pending_kernel_info.fn_name = group->FuncName();
+    pending_kernel_info.symbol_args_map = group->symbol_args_map();
+    pending_kernel_info.temp_space_sizes = group->temp_space_sizes();
+    auto promise =
+        std::make_shared<std::promise<std::shared_ptr<pir::BackendResource>>>();
+    compilation_results[i]->SetBackendResourceFuture(
+        pending_kernel_info, promise->get_future().share());
+    GetAsyncCompilationPool().Submit(
+        [job, i, device_id, promise, codegen = std::move(codegen_funcs[i])]() {
+          runtime::SetArchDevice(job->target, device_id);
+          try {
+            auto compilation_result = codegen();
+            // Triggering llvm compilation in thread
+            compilation_result->GetKernelInfo();
+            PersistentCompilationCache::Instance().Save(
+                job->ctx_mapper.UniqueFusionInfo(i),
+                job->target,
+                *compilation_result);
+            promise->set_value(compilation_result->GetBackendResource());
+          } catch (...) {
+            promise->set_exception(std::current_exception());
+          }
+          VLOG(5) << "Finished compiling "
+                  << job->ctx_mapper.UniqueFusionInfo(i) << " in background.";
+        });
+  }
+  ctx_mapper.SetFinalize(true);
+  ctx_mapper.UpdateGlobalCache();
+  return ctx_mapper.RecoverKernelInfos();
+}
+
 std::vector<pir::CINNKernelInfo>
 CompilationContextMapper::RecoverKernelInfos() {
   PADDLE_ENFORCE_EQ(
@@ -205,7 +349,9 @@ void CompilationContextMapper::UpdateGlobalCache() {
     VLOG(4) << "============== Insert new compiled result into cache, "
                "fusion_info: ==============\n"
             << fusion_info << ", host func name: "
-            << compilation_results_[i]->GetHostFuncName();
+            << (compilation_results_[i]->IsReady()
+                    ? compilation_results_[i]->GetHostFuncName()
+                    : "(compiling)");
     CompilationCache::Instance().Insert(fusion_info, compilation_results_[i]);
   }
 }
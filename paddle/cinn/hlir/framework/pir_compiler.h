@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include "paddle/cinn/common/macros.h"
 #include "paddle/cinn/hlir/framework/pir/compilation_task.h"
@@ -30,8 +31,19 @@ class PirCompiler final {
  private:
   CINN_DISALLOW_COPY_AND_ASSIGN(PirCompiler);
 
+  using CodegenFunc = std::function<std::shared_ptr<pir::CompilationResult>()>;
+
+  // Lower the group, and return the function to generate and compile the
+  // code, which doesn't depend on the pir::Program any more.
+  CodegenFunc Lower(GroupCompilationContext* ctx);
+
   std::shared_ptr<pir::CompilationResult> Compile(GroupCompilationContext* ctx);
 
+  // Lower the groups and compile them in background, the kernel infos are
+  // pending until the compilation is done, see FLAGS_cinn_async_compile.
+  std::vector<pir::CINNKernelInfo> BuildAsync(
+      const std::vector<pir::OpLoweringGroupPtr>& groups);
+
   Target target_;
 };
 
@@ -19,6 +19,17 @@
 namespace cinn {
 namespace ir {
 
+// Converts the configs to a tile data, the map holds a single config.
+bool TileConfigToProto(group_schedule::config::proto::TileData* tile_data,
+                       const TileConfigMap& tile_config_map,
+                       const int& priority);
+
+std::vector<std::string> ReadLinesFromFile(const std::string& file_path);
+
+void JsonStringToMessageOfTileConfig(
+    std::vector<group_schedule::config::proto::TileData>* tile_database,
+    const std::vector<std::string>& json_lines);
+
 class FileTileConfigDatabase final : public TileConfigDatabase {
  public:
   void AddConfig(const common::Target& target,
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+
+#include <algorithm>
+
 #include "paddle/cinn/hlir/framework/pir/op_lowering_impl.h"
 
 namespace cinn {
@@ -142,6 +145,133 @@ std::shared_ptr<ScheduleConfig::BaseInfo> InitBasicInfo(
   return base_info;
 }
 
+namespace {
+
+// The reduce sizes where the reduction methods of a dynamic reduce switch.
+struct ReduceThresholds {
+  // Up to 8 elements per lane of a warp.
+  int64_t warp_reduce_max{256};
+  // Up to 8 elements per thread of a block of 128 threads.
+  int64_t small_block_reduce_max{2048};
+  // The grid reduce is used above this reduce size, if the spatial size is
+  // at most grid_reduce_max_spatial.
+  int64_t grid_reduce_min{65536};
+  int64_t grid_reduce_max_spatial{256};
+};
+
+// A grid reduce splits the reduce of each spatial row to several blocks,
+// which pays off while the spatial rows alone fill at most about two waves of
+// one block per SM.
+ReduceThresholds GetReduceThresholds(const common::Target& target) {
+  ReduceThresholds thresholds;
+  int sm_count = target.arch.Match(
+      [&](std::variant<common::UnknownArch,
+                       common::X86Arch,
+                       common::ARMArch>) { return 0; },
+      [&](std::variant<common::NVGPUArch, common::HygonDCUArchHIP>) {
+        return target.get_multi_processor_count();
+      });
+  if (sm_count > 0) {
+    thresholds.grid_reduce_max_spatial =
+        std::min<int64_t>(std::max<int64_t>(Next2Power(sm_count) * 2, 64),
+                          1024);
+  }
+  return thresholds;
+}
+
+// Returns the buckets of the reduce sizes for a dynamic reduce, so the
+// kernel of each bucket uses the reduction method that fits its size, which
+// is chosen by the actual reduce size at run time.
+std::unordered_map<BucketInfo, ScheduleConfig::TileConfig, BucketInfoHash>
+BuildDynamicReduceConfig(
+    const std::shared_ptr<ScheduleConfig::BaseInfo>& base_info,
+    const common::Target& target,
+    bool sp_is_dynamic) {
+  const ReduceThresholds thresholds = GetReduceThresholds(target);
+  std::unordered_map<BucketInfo, ScheduleConfig::TileConfig, BucketInfoHash>
+      configs;
+  const auto AddBucket = [&](int sp_lower_bound,
+                             int sp_upper_bound,
+                             int rb_lower_bound,
+                             int rb_upper_bound,
+                             const ScheduleConfig::TileConfig& tile_config) {
+    BucketInfo bucket_info{sp_lower_bound,
+                           sp_upper_bound,
+                           rb_lower_bound,
+                           rb_upper_bound,
+                           sp_is_dynamic,
+                           /* rb_is_dynamic = */ true};
+    configs.insert({bucket_info, tile_config});
+  };
+
+  ScheduleConfig::TileConfig warp_reduce_config{
+      /* warp_num = */ 8,
+      /* tree_reduce_num = */ 32,
+      /* spatial_inner_num = */ 1,
+      /* reduce_method = */ WarpReduceMethod()};
+  ScheduleConfig::TileConfig small_block_reduce_config{
+      /* warp_num = */ 8,
+      /* tree_reduce_num = */ 128,
+      /* spatial_inner_num = */ 1,
+      /* reduce_method = */ BlockReduceMethod()};
+  ScheduleConfig::TileConfig block_reduce_config{
+      /* warp_num = */ 8,
+      /* tree_reduce_num = */ 256,
+      /* spatial_inner_num = */ 1,
+      /* reduce_method = */ BlockReduceMethod()};
+  ScheduleConfig::TileConfig grid_reduce_config{
+      /* warp_num = */ 32,
+      /* tree_reduce_num = */ 1024,
+      /* spatial_inner_num = */ 1,
+      /* reduce_method = */ BlockReduceMethod(),
+      /* grid_reduce_num = */ 8};
+
+  AddBucket(1, kMaxNumel, 1, thresholds.warp_reduce_max, warp_reduce_config);
+  AddBucket(1,
+            kMaxNumel,
+            thresholds.warp_reduce_max + 1,
+            thresholds.small_block_reduce_max,
+            small_block_reduce_config);
+  const bool may_grid_reduce =
+      base_info->can_apply_grid_reduce &&
+      (sp_is_dynamic ||
+       base_info->spatial_numel <= thresholds.grid_reduce_max_spatial);
+  if (!may_grid_reduce) {
+    AddBucket(1,
+              kMaxNumel,
+              thresholds.small_block_reduce_max + 1,
+              kMaxNumel,
+              block_reduce_config);
+    return configs;
+  }
+  AddBucket(1,
+            kMaxNumel,
+            thresholds.small_block_reduce_max + 1,
+            thresholds.grid_reduce_min,
+            block_reduce_config);
+  if (sp_is_dynamic) {
+    AddBucket(1,
+              thresholds.grid_reduce_max_spatial,
+              thresholds.grid_reduce_min + 1,
+              kMaxNumel,
+              grid_reduce_config);
+    AddBucket(thresholds.grid_reduce_max_spatial + 1,
+              kMaxNumel,
+              thresholds.grid_reduce_min + 1,
+              kMaxNumel,
+              block_reduce_config);
+  } else {
+    AddBucket(1,
+              kMaxNumel,
+              thresholds.grid_reduce_min + 1,
+              kMaxNumel,
+              grid_reduce_config);
+  }
+  return configs;
+}
+
+}  // namespace
+
 std::unordered_map<BucketInfo, ScheduleConfig::TileConfig, BucketInfoHash>
 BuildPureStaticShapeConfig(
     const std::shared_ptr<ScheduleConfig::BaseInfo>& base_info,
@@ -307,45 +437,8 @@ BuildStaticSpatialConfig(
         /* reduce_method = */ BlockReduceMethod()};
     return {{bucket_info, tile_config}};
   } else {
-    BucketInfo bucket_info_1_256{/* sp_lower_bound = */ 1,
-                                 /* sp_upper_bound = */ kMaxNumel,
-                                 /* rb_lower_bound = */ 1,
-                                 /* rb_upper_bound = */ 256,
-                                 /* sp_is_dynamic = */ false,
-                                 /* rb_is_dynamic = */ true};
-    ScheduleConfig::TileConfig tile_config_1_256{
-        /* warp_num = */ 8,
-        /* tree_reduce_num = */ 32,
-        /* spatial_inner_num = */ 1,
-        /* reduce_method = */ WarpReduceMethod()};
-
-    BucketInfo bucket_info_257_2048{/* sp_lower_bound = */ 1,
-                                    /* sp_upper_bound = */ kMaxNumel,
-                                    /* rb_lower_bound = */ 257,
-                                    /* rb_upper_bound = */ 2048,
-                                    /* sp_is_dynamic = */ false,
-                                    /* rb_is_dynamic = */ true};
-    ScheduleConfig::TileConfig tile_config_257_2048{
-        /* warp_num = */ 8,
-        /* tree_reduce_num = */ 128,
-        /* spatial_inner_num = */ 1,
-        /* reduce_method = */ BlockReduceMethod()};
-
-    BucketInfo bucket_info_2049_INF{/* sp_lower_bound = */ 1,
-                                    /* sp_upper_bound = */ kMaxNumel,
-                                    /* rb_lower_bound = */ 2049,
-                                    /* rb_upper_bound = */ kMaxNumel,
-                                    /* sp_is_dynamic = */ false,
-                                    /* rb_is_dynamic = */ true};
-    ScheduleConfig::TileConfig tile_config_2049_INF{
-        /* warp_num = */ 8,
-        /* tree_reduce_num = */ 256,
-        /* spatial_inner_num = */ 1,
-        /* reduce_method = */ BlockReduceMethod()};
-
-    return {{bucket_info_1_256, tile_config_1_256},
-            {bucket_info_257_2048, tile_config_257_2048},
-            {bucket_info_2049_INF, tile_config_2049_INF}};
+    return BuildDynamicReduceConfig(
+        base_info, target, /* sp_is_dynamic = */ false);
   }
 }
 
@@ -445,21 +538,8 @@ std::unordered_map<BucketInfo, ScheduleConfig::TileConfig, BucketInfoHash>
 BuildDynamicShapeConfig(
     const std::shared_ptr<ScheduleConfig::BaseInfo>& base_info,
     const common::Target& target) {
-  int64_t warp_num = 8;
-  int64_t spatial_inner_num = 1;
-  int64_t tree_reduce_num = warp_num * 32;
-  BucketInfo bucket_info{/* sp_lower_bound = */ 1,
-                         /* sp_upper_bound = */ kMaxNumel,
-                         /* rb_lower_bound = */ 1,
-                         /* rb_upper_bound = */ kMaxNumel,
-                         /* sp_is_dynamic = */ true,
-                         /* rb_is_dynamic = */ true};
-  ScheduleConfig::TileConfig tile_config{
-      /* warp_num = */ warp_num,
-      /* tree_reduce_num = */ tree_reduce_num,
-      /* spatial_inner_num = */ spatial_inner_num,
-      /* reduce_method = */ BlockReduceMethod()};
-  return {{bucket_info, tile_config}};
+  return BuildDynamicReduceConfig(
+      base_info, target, /* sp_is_dynamic = */ true);
 }
 
 std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
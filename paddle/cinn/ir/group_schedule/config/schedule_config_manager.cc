@@ -14,8 +14,12 @@
 
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 #include "paddle/cinn/ir/group_schedule/config/file_database.h"
+#include "paddle/cinn/ir/group_schedule/config/shared_database.h"
 
 PD_DECLARE_string(tile_config_policy);
+PD_DECLARE_string(cinn_tile_config_shared_dir);
+PD_DECLARE_string(cinn_tile_config_shared_version);
+PD_DECLARE_bool(cinn_tile_config_shared_readonly);
 
 namespace cinn {
 namespace ir {
@@ -42,7 +46,16 @@ ScheduleConfigMap ScheduleConfigManager::ExtractConfigs(
     return CombineBaseInfoAndConfig(tile_config_map, base_info);
   };
 
-  if (policy_ == "default" || tile_config_data_.count(policy_) == 0) {
+  if (policy_ == "model") {
+    ScheduleConfigMap predicted_map =
+        PredictConfigs(BuildScheduleConfig(group_info, target));
+    if (tile_config_data_.count(policy_) == 0) {
+      return predicted_map;
+    }
+    ScheduleConfigMap stored_map = ReadConfigs(policy_);
+    stored_map.insert(predicted_map.begin(), predicted_map.end());
+    return stored_map;
+  } else if (policy_ == "default" || tile_config_data_.count(policy_) == 0) {
     return BuildScheduleConfig(group_info, target);
   } else if (policy_ == "hybrid") {
     ScheduleConfigMap default_map = BuildScheduleConfig(group_info, target);
@@ -59,14 +72,60 @@ void ScheduleConfigManager::SetPolicy(const std::string& policy) {
   policy_ = policy;
 }
 
+void ScheduleConfigManager::SetCostModel(
+    const std::shared_ptr<TileConfigCostModel>& cost_model) {
+  cost_model_ = cost_model;
+}
+
+ScheduleConfigMap ScheduleConfigManager::PredictConfigs(
+    ScheduleConfigMap config_map) const {
+  if (cost_model_ == nullptr) {
+    return config_map;
+  }
+  for (auto& [bucket_info, config] : config_map) {
+    auto& tile_config = config.tile_config;
+    // The grid reduction is not modeled.
+    if (tile_config.grid_reduce_num > 1) {
+      continue;
+    }
+    double best_cost = cost_model_->Predict(bucket_info, tile_config);
+    for (const auto& candidate : GenerateTileConfigCandidates(bucket_info)) {
+      double cost = cost_model_->Predict(bucket_info, candidate);
+      if (cost < best_cost) {
+        best_cost = cost;
+        tile_config = candidate;
+      }
+    }
+    VLOG(4) << "Predicted tile config of " << bucket_info.ToString()
+            << ": warp_num = " << tile_config.warp_num
+            << ", tree_reduce_num = " << tile_config.tree_reduce_num
+            << ", spatial_inner_num = " << tile_config.spatial_inner_num;
+  }
+  return config_map;
+}
+
 void InitScheduleConfig() {
   auto& schedule_config_manager = cinn::ir::ScheduleConfigManager::Instance();
   std::string policy;
   policy = FLAGS_tile_config_policy;
   schedule_config_manager.SetPolicy(policy);
-  if (policy == "optimal" || policy == "hybrid") {
-    std::shared_ptr<cinn::ir::TileConfigDatabase> tile_config_database =
-        std::make_shared<cinn::ir::FileTileConfigDatabase>();
+  if (policy == "model") {
+    schedule_config_manager.SetCostModel(
+        std::make_shared<cinn::ir::OnlineTileConfigCostModel>(
+            cinn::ir::TileConfigDeviceSpec(common::DefaultDeviceTarget())));
+  }
+  if (policy == "optimal" || policy == "hybrid" || policy == "model") {
+    std::shared_ptr<cinn::ir::TileConfigDatabase> tile_config_database;
+    if (FLAGS_cinn_tile_config_shared_dir.empty()) {
+      tile_config_database =
+          std::make_shared<cinn::ir::FileTileConfigDatabase>();
+    } else {
+      tile_config_database =
+          std::make_shared<cinn::ir::SharedTileConfigDatabase>(
+              FLAGS_cinn_tile_config_shared_dir,
+              FLAGS_cinn_tile_config_shared_version,
+              FLAGS_cinn_tile_config_shared_readonly);
+    }
     schedule_config_manager.AddConfigDatabase(policy, tile_config_database);
   }
 }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/cinn/ir/group_schedule/config/database.h"
+#include "paddle/cinn/ir/group_schedule/config/tile_config_cost_model.h"
 
 namespace cinn {
 namespace ir {
@@ -32,6 +33,17 @@ class ScheduleConfigManager {
 
   void SetPolicy(const std::string& policy);
 
+  // The "model" policy predicts the configs of the buckets without a stored
+  // config with the cost model.
+  void SetCostModel(const std::shared_ptr<TileConfigCostModel>& cost_model);
+
+  const std::shared_ptr<TileConfigCostModel>& cost_model() const {
+    return cost_model_;
+  }
+
+ private:
+  ScheduleConfigMap PredictConfigs(ScheduleConfigMap config_map) const;
+
  private:
   ScheduleConfigManager() = default;
   ~ScheduleConfigManager() = default;
@@ -42,6 +54,7 @@ class ScheduleConfigManager {
   std::unordered_map<std::string, std::shared_ptr<TileConfigDatabase>>
       tile_config_data_;
   std::string policy_ = "default";
+  std::shared_ptr<TileConfigCostModel> cost_model_;
 };
 
 void InitScheduleConfig();
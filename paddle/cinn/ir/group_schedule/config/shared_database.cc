@@ -0,0 +1,234 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/config/shared_database.h"
+
+#include <dirent.h>
+#include <google/protobuf/util/json_util.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <tuple>
+
+#include "paddle/cinn/ir/group_schedule/config/file_database.h"
+#include "paddle/common/enforce.h"
+
+namespace cinn {
+namespace ir {
+
+namespace {
+
+// The priority of the configs read, see FileTileConfigDatabase.
+constexpr int kPriorityOfBestConfig = 0;
+constexpr char kEntrySuffix[] = ".json";
+
+void MakeDirs(const std::string& path) {
+  for (size_t pos = path.find('/', 1); pos != std::string::npos;
+       pos = path.find('/', pos + 1)) {
+    mkdir(path.substr(0, pos).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  }
+  int ret = mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  PADDLE_ENFORCE_EQ(ret == 0 || errno == EEXIST,
+                    true,
+                    ::common::errors::PreconditionNotMet(
+                        "Can not create directory: %s, Make sure you have "
+                        "permission to write",
+                        path));
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// The entries are named <milliseconds>-<worker>-<index>.json.
+int64_t EntryTimestamp(const std::string& name) {
+  return std::strtoll(name.c_str(), nullptr, 10);
+}
+
+std::string WorkerId() {
+  char hostname[256] = {0};
+  if (gethostname(hostname, sizeof(hostname) - 1) != 0) {
+    snprintf(hostname, sizeof(hostname), "unknown");
+  }
+  return std::string(hostname) + "-" + std::to_string(getpid());
+}
+
+BucketInfo ProtoToBucketInfo(
+    const group_schedule::config::proto::BucketInfo& proto) {
+  std::vector<BucketInfo::Dimension> dims(proto.dimension_size());
+  for (int i = 0; i < proto.dimension_size(); ++i) {
+    dims[i].lower_bound = proto.dimension(i).lower_bound();
+    dims[i].upper_bound = proto.dimension(i).upper_bound();
+    dims[i].iter_type = proto.dimension(i).iter_type();
+    dims[i].is_dynamic = proto.dimension(i).is_dynamic();
+  }
+  BucketInfo bucket_info(dims);
+  bucket_info.bucket_priority = kPriorityOfBestConfig;
+  return bucket_info;
+}
+
+}  // namespace
+
+SharedTileConfigDatabase::SharedTileConfigDatabase(const std::string& root_dir,
+                                                   const std::string& version,
+                                                   bool read_only)
+    : root_dir_(root_dir),
+      version_(version),
+      read_only_(read_only),
+      worker_id_(WorkerId()) {
+  PADDLE_ENFORCE_EQ(root_dir_.empty(),
+                    false,
+                    ::common::errors::InvalidArgument(
+                        "The directory of the shared tile config database "
+                        "should not be empty."));
+  PADDLE_ENFORCE_EQ(version_.empty() || version_.find('/') != std::string::npos,
+                    false,
+                    ::common::errors::InvalidArgument(
+                        "The version of the shared tile config database "
+                        "should be a nonempty name, but received \"%s\".",
+                        version_));
+}
+
+std::string SharedTileConfigDatabase::SignatureDir(
+    const common::Target& target, const IterSpaceType& iter_space_type) const {
+  std::string signature;
+  for (const auto& [iter_type, dynamic] : iter_space_type) {
+    if (!signature.empty()) signature += "_";
+    signature += iter_type + dynamic;
+  }
+  return root_dir_ + "/" + target.arch_str() + "_" +
+         target.device_name_str() + "/" + version_ + "/" + signature;
+}
+
+void SharedTileConfigDatabase::AddConfig(
+    const common::Target& target,
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config,
+    int priority) {
+  if (read_only_) {
+    VLOG(3) << "Drop the tile config of " << bucket_info.ToString()
+            << " added to the read only database";
+    return;
+  }
+  group_schedule::config::proto::TileData tile_data;
+  TileConfigToProto(&tile_data, {{bucket_info, config}}, priority);
+  std::string json_string;
+  auto status =
+      google::protobuf::util::MessageToJsonString(tile_data, &json_string);
+  PADDLE_ENFORCE_EQ(status.ok(),
+                    true,
+                    ::common::errors::InvalidArgument(
+                        "Failed to serialize the tile config of %s to JSON.",
+                        bucket_info.ToString()));
+
+  IterSpaceType iter_space_type;
+  for (const auto& dim : bucket_info.space) {
+    iter_space_type.emplace_back(dim.iter_type,
+                                 dim.is_dynamic ? "dynamic" : "static");
+  }
+  std::string dir = SignatureDir(target, iter_space_type);
+  MakeDirs(dir);
+  int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  std::string name = std::to_string(now_ms) + "-" + worker_id_ + "-" +
+                     std::to_string(num_entries_++) + kEntrySuffix;
+  // The readers skip the hidden file until it is renamed.
+  std::string tmp_path = dir + "/." + name + ".tmp";
+  {
+    std::ofstream os(tmp_path);
+    PADDLE_ENFORCE_EQ(os.good(),
+                      true,
+                      ::common::errors::InvalidArgument(
+                          "Cannot open the file to write: %s", tmp_path));
+    os << json_string << std::endl;
+  }
+  PADDLE_ENFORCE_EQ(
+      std::rename(tmp_path.c_str(), (dir + "/" + name).c_str()),
+      0,
+      ::common::errors::Unavailable(
+          "Can't add the tile config to the shared database: %s", dir));
+  VLOG(3) << "Add tile config " << dir << "/" << name;
+}
+
+TileConfigMap SharedTileConfigDatabase::ReadConfigs(
+    const std::string& dir) const {
+  std::vector<std::string> names;
+  if (DIR* dirp = opendir(dir.c_str())) {
+    while (struct dirent* entry = readdir(dirp)) {
+      std::string name = entry->d_name;
+      if (name[0] != '.' && EndsWith(name, kEntrySuffix)) {
+        names.push_back(name);
+      }
+    }
+    closedir(dirp);
+  } else {
+    VLOG(3) << "Directory doesn't exist: " << dir;
+    return {};
+  }
+
+  // The priority and the negative timestamp of the config kept.
+  using Rank = std::pair<int, int64_t>;
+  std::unordered_map<BucketInfo,
+                     std::pair<Rank, ScheduleConfig::TileConfig>,
+                     BucketInfoHash>
+      merged;
+  for (const auto& name : names) {
+    auto json_lines = ReadLinesFromFile(dir + "/" + name);
+    std::vector<group_schedule::config::proto::TileData> tile_database(
+        json_lines.size());
+    JsonStringToMessageOfTileConfig(&tile_database, json_lines);
+    Rank rank{0, -EntryTimestamp(name)};
+    for (const auto& tile_data : tile_database) {
+      rank.first = tile_data.priority();
+      BucketInfo bucket_info = ProtoToBucketInfo(tile_data.bucket_info());
+      ScheduleConfig::TileConfig config;
+      config.warp_num = tile_data.tile_config().warp_num();
+      config.tree_reduce_num = tile_data.tile_config().tree_reduce_num();
+      config.spatial_inner_num = tile_data.tile_config().spatial_inner_num();
+      auto it = merged.find(bucket_info);
+      if (it == merged.end() || rank < it->second.first) {
+        merged[bucket_info] = {rank, config};
+      }
+    }
+  }
+  TileConfigMap tile_config_map;
+  for (const auto& [bucket_info, ranked_config] : merged) {
+    tile_config_map[bucket_info] = ranked_config.second;
+  }
+  VLOG(3) << "Merged " << tile_config_map.size() << " tile configs from "
+          << names.size() << " entries of " << dir;
+  return tile_config_map;
+}
+
+TileConfigMap SharedTileConfigDatabase::GetConfigs(
+    const common::Target& target, const IterSpaceType& iter_space_type) const {
+  std::string dir = SignatureDir(target, iter_space_type);
+  if (!read_only_) {
+    return ReadConfigs(dir);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = cache_.find(dir);
+  if (it == cache_.end()) {
+    it = cache_.emplace(dir, ReadConfigs(dir)).first;
+  }
+  return it->second;
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "paddle/cinn/ir/group_schedule/config/database.h"
+
+namespace cinn {
+namespace ir {
+
+//
+// A tile config database shared by the tuning workers and the production
+// nodes through a directory, e.g. on network storage. The configs are keyed
+// by the device, a version label and the iteration space signature of the
+// fusion group:
+//
+//   <root>/<arch>_<device>/<version>/<signature>/<entry>.json
+//
+// Each AddConfig writes a new entry atomically, so the workers never
+// overwrite each other, and GetConfigs merges the entries of a signature:
+// the config with the lowest priority value wins, and the newest one on a
+// tie. A read only database drops the added configs and reads each
+// signature once.
+//
+class SharedTileConfigDatabase final : public TileConfigDatabase {
+ public:
+  SharedTileConfigDatabase(const std::string& root_dir,
+                           const std::string& version,
+                           bool read_only);
+
+  void AddConfig(const common::Target& target,
+                 const BucketInfo& bucket_info,
+                 const ScheduleConfig::TileConfig& config,
+                 int priority) override;
+
+  TileConfigMap GetConfigs(const common::Target& target,
+                           const IterSpaceType& iter_space_type) const override;
+
+  bool read_only() const { return read_only_; }
+
+ private:
+  std::string SignatureDir(const common::Target& target,
+                           const IterSpaceType& iter_space_type) const;
+
+  TileConfigMap ReadConfigs(const std::string& dir) const;
+
+  std::string root_dir_;
+  std::string version_;
+  bool read_only_;
+  // Names the entries written by this process.
+  std::string worker_id_;
+  std::atomic<int64_t> num_entries_{0};
+
+  mutable std::mutex mutex_;
+  mutable std::map<std::string, TileConfigMap> cache_;
+};
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,272 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/config/tile_config_cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "paddle/common/enforce.h"
+
+namespace cinn {
+namespace ir {
+
+namespace {
+
+constexpr int kThreadsPerWarp = 32;
+constexpr int kMaxThreadsPerBlock = 1024;
+// The dynamic dimensions are unbounded, so their sizes are capped.
+constexpr double kMaxRepresentativeSize = 65536;
+
+// The costs in cycles of the analytical model.
+constexpr double kLoadCost = 4.0;
+constexpr double kShuffleCost = 8.0;
+constexpr double kBlockSyncCost = 40.0;
+constexpr double kBlockCost = 50.0;
+constexpr double kLaunchCost = 2000.0;
+constexpr double kMinOccupancy = 1.0 / 64;
+
+// The prior variance of the weights of the online model.
+constexpr double kPriorVariance = 10.0;
+
+double RepresentativeSize(const BucketInfo::Dimension& dim) {
+  double lower = std::max(dim.lower_bound, 1);
+  double upper = std::min<double>(dim.upper_bound, kMaxRepresentativeSize);
+  if (upper <= lower) return lower;
+  return std::sqrt(lower * upper);
+}
+
+bool HasReduce(const BucketInfo& bucket_info) {
+  return std::any_of(bucket_info.space.begin(),
+                     bucket_info.space.end(),
+                     [](const auto& dim) { return dim.iter_type == "R"; });
+}
+
+ReduceMethod ReduceMethodOf(int64_t tree_reduce_num) {
+  if (tree_reduce_num <= 1) return NoneReduceMethod();
+  if (tree_reduce_num <= kThreadsPerWarp) return WarpReduceMethod();
+  return BlockReduceMethod();
+}
+
+}  // namespace
+
+TileConfigDeviceSpec::TileConfigDeviceSpec(const common::Target& target)
+    : multi_processor_count(target.get_multi_processor_count()),
+      max_threads_per_sm(target.get_max_threads_per_sm()),
+      max_blocks_per_sm(target.get_max_blocks_per_sm()) {}
+
+std::pair<double, double> RepresentativeShape(const BucketInfo& bucket_info) {
+  double spatial_size = 1.0;
+  double reduce_size = 1.0;
+  for (const auto& dim : bucket_info.space) {
+    if (dim.iter_type == "R") {
+      reduce_size *= RepresentativeSize(dim);
+    } else {
+      spatial_size *= RepresentativeSize(dim);
+    }
+  }
+  return {spatial_size, reduce_size};
+}
+
+TileConfigFeature TileConfigFeature::Extract(
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config,
+    const TileConfigDeviceSpec& device) {
+  auto [spatial_size, reduce_size] = RepresentativeShape(bucket_info);
+  TileConfigFeature feature;
+  feature.spatial_size = spatial_size;
+  feature.reduce_size = reduce_size;
+  feature.threads_per_block =
+      static_cast<double>(std::max<int64_t>(config.warp_num, 1)) *
+      kThreadsPerWarp;
+  feature.tree_reduce_num = std::max<int64_t>(config.tree_reduce_num, 1);
+  feature.spatial_inner_num = std::max<int64_t>(config.spatial_inner_num, 1);
+
+  double rows_per_block =
+      std::max(1.0, feature.threads_per_block / feature.tree_reduce_num) *
+      feature.spatial_inner_num;
+  feature.num_blocks = std::ceil(spatial_size / rows_per_block);
+  feature.reduce_inner_num = std::ceil(reduce_size / feature.tree_reduce_num);
+
+  double blocks_per_sm =
+      std::max(1.0,
+               std::min<double>(
+                   device.max_blocks_per_sm,
+                   std::floor(device.max_threads_per_sm /
+                              feature.threads_per_block)));
+  double resident_blocks = blocks_per_sm * device.multi_processor_count;
+  feature.waves = std::ceil(feature.num_blocks / resident_blocks);
+  feature.occupancy =
+      std::min(feature.num_blocks, resident_blocks) *
+      feature.threads_per_block /
+      (static_cast<double>(device.multi_processor_count) *
+       device.max_threads_per_sm);
+  return feature;
+}
+
+std::vector<ScheduleConfig::TileConfig> GenerateTileConfigCandidates(
+    const BucketInfo& bucket_info) {
+  bool has_reduce = HasReduce(bucket_info);
+  auto [spatial_size, reduce_size] = RepresentativeShape(bucket_info);
+  std::vector<ScheduleConfig::TileConfig> candidates;
+  for (int64_t warp_num = 1; warp_num * kThreadsPerWarp <= kMaxThreadsPerBlock;
+       warp_num *= 2) {
+    int64_t threads = warp_num * kThreadsPerWarp;
+    std::vector<int64_t> tree_reduce_nums;
+    if (has_reduce) {
+      // More threads than the elements to reduce only wait.
+      for (int64_t num = kThreadsPerWarp; num <= threads; num *= 2) {
+        if (num > kThreadsPerWarp && num > reduce_size) break;
+        tree_reduce_nums.push_back(num);
+      }
+    } else {
+      tree_reduce_nums.push_back(1);
+    }
+    for (int64_t tree_reduce_num : tree_reduce_nums) {
+      for (int64_t spatial_inner_num = 1; spatial_inner_num <= 8;
+           spatial_inner_num *= 2) {
+        int64_t rows_per_block = threads / tree_reduce_num * spatial_inner_num;
+        if (spatial_inner_num > 1 && rows_per_block > spatial_size) break;
+        ScheduleConfig::TileConfig config;
+        config.warp_num = warp_num;
+        config.tree_reduce_num = tree_reduce_num;
+        config.spatial_inner_num = spatial_inner_num;
+        config.reduce_method = ReduceMethodOf(tree_reduce_num);
+        candidates.push_back(config);
+      }
+    }
+  }
+  return candidates;
+}
+
+std::vector<size_t> TileConfigCostModel::TopK(
+    const BucketInfo& bucket_info,
+    const std::vector<ScheduleConfig::TileConfig>& candidates,
+    size_t k) const {
+  std::vector<double> costs;
+  costs.reserve(candidates.size());
+  for (const auto& candidate : candidates) {
+    costs.push_back(Predict(bucket_info, candidate));
+  }
+  std::vector<size_t> indices(candidates.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  k = std::min(k, indices.size());
+  std::partial_sort(
+      indices.begin(),
+      indices.begin() + k,
+      indices.end(),
+      [&](size_t lhs, size_t rhs) { return costs[lhs] < costs[rhs]; });
+  indices.resize(k);
+  return indices;
+}
+
+double AnalyticalTileConfigCostModel::Predict(
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config) const {
+  auto feature = TileConfigFeature::Extract(bucket_info, config, device_);
+  // The loads are latency bound when few warps are resident.
+  double load_cost =
+      kLoadCost / std::sqrt(std::max(feature.occupancy, kMinOccupancy));
+  double reduce_steps = std::log2(feature.tree_reduce_num);
+  double warp_steps = std::min(reduce_steps, std::log2(kThreadsPerWarp));
+  double block_cost =
+      feature.reduce_inner_num * feature.spatial_inner_num * load_cost +
+      warp_steps * kShuffleCost +
+      (reduce_steps - warp_steps) * kBlockSyncCost + kBlockCost;
+  return feature.waves * block_cost + kLaunchCost;
+}
+
+OnlineTileConfigCostModel::OnlineTileConfigCostModel(
+    const TileConfigDeviceSpec& device, double forgetting_factor)
+    : TileConfigCostModel(device),
+      analytical_(device),
+      forgetting_factor_(forgetting_factor) {
+  PADDLE_ENFORCE_EQ(
+      forgetting_factor > 0 && forgetting_factor <= 1,
+      true,
+      ::common::errors::InvalidArgument(
+          "The forgetting factor should be in (0, 1], but received %f.",
+          forgetting_factor));
+  size_t num_features = Features(BucketInfo(1), {}).size();
+  weights_.assign(num_features, 0.0);
+  // Starts from the analytical estimate.
+  weights_[1] = 1.0;
+  covariance_.assign(num_features * num_features, 0.0);
+  for (size_t i = 0; i < num_features; ++i) {
+    covariance_[i * num_features + i] = kPriorVariance;
+  }
+}
+
+std::vector<double> OnlineTileConfigCostModel::Features(
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config) const {
+  auto feature = TileConfigFeature::Extract(bucket_info, config, device_);
+  return {1.0,
+          std::log(analytical_.Predict(bucket_info, config)),
+          std::log(feature.reduce_inner_num),
+          std::log(feature.spatial_inner_num),
+          std::log(feature.threads_per_block),
+          feature.occupancy};
+}
+
+double OnlineTileConfigCostModel::Predict(
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config) const {
+  auto features = Features(bucket_info, config);
+  std::lock_guard<std::mutex> guard(mutex_);
+  return std::exp(std::inner_product(
+      features.begin(), features.end(), weights_.begin(), 0.0));
+}
+
+void OnlineTileConfigCostModel::Update(
+    const BucketInfo& bucket_info,
+    const ScheduleConfig::TileConfig& config,
+    double kernel_time) {
+  if (kernel_time <= 0) return;
+  auto x = Features(bucket_info, config);
+  size_t n = x.size();
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<double> px(n, 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      px[i] += covariance_[i * n + j] * x[j];
+    }
+  }
+  double denominator =
+      forgetting_factor_ +
+      std::inner_product(x.begin(), x.end(), px.begin(), 0.0);
+  double error = std::log(kernel_time) -
+                 std::inner_product(x.begin(), x.end(), weights_.begin(), 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    weights_[i] += px[i] / denominator * error;
+  }
+  // The covariance is symmetric, so x^T P is px^T.
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      covariance_[i * n + j] =
+          (covariance_[i * n + j] - px[i] * px[j] / denominator) /
+          forgetting_factor_;
+    }
+  }
+  ++num_samples_;
+}
+
+int OnlineTileConfigCostModel::num_samples() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return num_samples_;
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,144 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+
+namespace cinn {
+namespace ir {
+
+// The limits of a GPU that bound the occupancy of a tile config.
+struct TileConfigDeviceSpec {
+  int multi_processor_count{80};
+  int max_threads_per_sm{2048};
+  int max_blocks_per_sm{32};
+
+  TileConfigDeviceSpec() = default;
+  explicit TileConfigDeviceSpec(const common::Target& target);
+};
+
+// The features of a tile config applied to the representative shape of a
+// bucket.
+struct TileConfigFeature {
+  double spatial_size;
+  double reduce_size;
+  double threads_per_block;
+  double tree_reduce_num;
+  double spatial_inner_num;
+  double num_blocks;
+  // The reduction loop length of a thread.
+  double reduce_inner_num;
+  // The fraction of the resident blocks of all SMs used by a wave.
+  double occupancy;
+  double waves;
+
+  static TileConfigFeature Extract(const BucketInfo& bucket_info,
+                                   const ScheduleConfig::TileConfig& config,
+                                   const TileConfigDeviceSpec& device);
+};
+
+// Returns the representative spatial and reduce sizes of a bucket, the
+// geometric mean of the bounds of each dynamic dimension.
+std::pair<double, double> RepresentativeShape(const BucketInfo& bucket_info);
+
+// Returns the valid configs of the warp, tree reduce and spatial inner
+// numbers for a bucket, with the reduce method derived from the tree reduce
+// number.
+std::vector<ScheduleConfig::TileConfig> GenerateTileConfigCandidates(
+    const BucketInfo& bucket_info);
+
+//
+// Predicts the relative kernel time of a tile config for a bucket, so the
+// config search measures the promising candidates only and the buckets
+// without a searched config get a predicted one.
+//
+class TileConfigCostModel {
+ public:
+  explicit TileConfigCostModel(const TileConfigDeviceSpec& device)
+      : device_(device) {}
+  virtual ~TileConfigCostModel() = default;
+
+  virtual double Predict(const BucketInfo& bucket_info,
+                         const ScheduleConfig::TileConfig& config) const = 0;
+
+  // Trains the model with the measured kernel time of a config.
+  virtual void Update(const BucketInfo& bucket_info,
+                      const ScheduleConfig::TileConfig& config,
+                      double kernel_time) {}
+
+  // Returns the indices of the k candidates with the lowest predicted cost,
+  // in ascending order of the cost.
+  std::vector<size_t> TopK(
+      const BucketInfo& bucket_info,
+      const std::vector<ScheduleConfig::TileConfig>& candidates,
+      size_t k) const;
+
+  const TileConfigDeviceSpec& device() const { return device_; }
+
+ protected:
+  TileConfigDeviceSpec device_;
+};
+
+//
+// Estimates the kernel time from the waves of blocks and the work of a
+// block: the loads of the reduction loop, which the inner spatial tiling
+// amortizes, and the steps of the tree reduction.
+//
+class AnalyticalTileConfigCostModel : public TileConfigCostModel {
+ public:
+  using TileConfigCostModel::TileConfigCostModel;
+
+  double Predict(const BucketInfo& bucket_info,
+                 const ScheduleConfig::TileConfig& config) const override;
+};
+
+//
+// Learns a linear correction of the log analytical estimate from the
+// measured kernel times by recursive least squares, so it predicts the
+// analytical estimate until trained.
+//
+class OnlineTileConfigCostModel : public TileConfigCostModel {
+ public:
+  explicit OnlineTileConfigCostModel(const TileConfigDeviceSpec& device,
+                                     double forgetting_factor = 1.0);
+
+  double Predict(const BucketInfo& bucket_info,
+                 const ScheduleConfig::TileConfig& config) const override;
+
+  void Update(const BucketInfo& bucket_info,
+              const ScheduleConfig::TileConfig& config,
+              double kernel_time) override;
+
+  int num_samples() const;
+
+ private:
+  std::vector<double> Features(const BucketInfo& bucket_info,
+                               const ScheduleConfig::TileConfig& config) const;
+
+  AnalyticalTileConfigCostModel analytical_;
+  double forgetting_factor_;
+  mutable std::mutex mutex_;
+  std::vector<double> weights_;
+  // The inverse covariance of the features, row major.
+  std::vector<double> covariance_;
+  int num_samples_{0};
+};
+
+}  // namespace ir
+}  // namespace cinn
@@ -13,27 +13,85 @@
 // limitations under the License.
 
 #include "paddle/cinn/ir/group_schedule/dy_shape_group_scheduler.h"
+#include <optional>
 #include "paddle/cinn/common/cas.h"
+#include "paddle/cinn/common/ir_util.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 #include "paddle/cinn/ir/group_schedule/tactic/compute_inline_tactic.h"
+#include "paddle/cinn/ir/group_schedule/tactic/tile_first_cpu_tactic.h"
 #include "paddle/cinn/ir/group_schedule/tactic/tile_first_general_tactic.h"
 #include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
+#include "paddle/cinn/ir/ir_mutator.h"
 #include "paddle/cinn/ir/op/ir_operators.h"
+#include "paddle/cinn/ir/utils/ir_copy.h"
+#include "paddle/cinn/ir/utils/ir_replace.h"
+#include "paddle/cinn/utils/string.h"
 #include "paddle/common/enforce.h"
 
 PD_DECLARE_bool(cinn_bucket_compile);
+PD_DECLARE_string(cinn_bucket_specialize_values);
 
 namespace cinn {
 namespace ir {
 
+namespace {
+
+// Bounds the compile time of the specialized kernels of a group.
+constexpr int kMaxSpecializedBuckets = 8;
+
+std::vector<int> GetSpecializeValues() {
+  std::vector<int> values;
+  for (const std::string& item :
+       utils::Split(FLAGS_cinn_bucket_specialize_values, ",")) {
+    std::string value = utils::Trim(item);
+    if (value.empty()) continue;
+    values.push_back(std::stoi(value));
+  }
+  return values;
+}
+
+// Replaces a symbol in the loop extents with its value, so the tactics see
+// the constant extents of a specialized bucket.
+class LoopExtentSpecializer : public ir::IRMutator<> {
+ public:
+  LoopExtentSpecializer(const ir::Var& symbol, int value)
+      : symbol_(symbol), value_(common::make_const(symbol->type(), value)) {}
+
+  void operator()(ir::Expr* expr) { ir::IRMutator<>::Visit(expr, expr); }
+
+ private:
+  void Visit(const ir::For* op, ir::Expr* expr) override {
+    ir::For* node = expr->As<ir::For>();
+    ir::Expr extent = ir::ir_utils::IRCopy(node->extent);
+    ir::ir_utils::IrReplaceVarBroadcast(&extent, symbol_, value_);
+    node->extent = common::AutoSimplify(extent);
+    ir::IRMutator<>::Visit(op, expr);
+  }
+
+  ir::Var symbol_;
+  ir::Expr value_;
+};
+
+}  // namespace
+
 void DynamicShapeGroupScheduler::Init() {
   VLOG(4) << "=============================Start group "
              "schedule==============================";
   VLOG(4) << "original group func body: \n"
           << ir_sch_->GetModule().GetExprs()[0];
   InitBuckets();
-  tactics_.emplace_back(CreateTileFirstGeneralTactic());
-  VLOG(4) << "CreateTileFirstGeneralTactic End";
+  target_.arch.Match(
+      [&](common::X86Arch) {
+        tactics_.emplace_back(CreateTileFirstCpuTactic());
+        VLOG(4) << "CreateTileFirstCpuTactic End";
+      },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) {
+        tactics_.emplace_back(CreateTileFirstGeneralTactic());
+        VLOG(4) << "CreateTileFirstGeneralTactic End";
+      });
   tactics_.emplace_back(CreateComputeInlineTactic());
   VLOG(4) << "CreateTileCreateComputeInlineTactic End";
 }
@@ -54,9 +112,21 @@ void DynamicShapeGroupScheduler::InitBuckets() {
     return false;
   };
 
-  auto InitBucket = [&](BucketInfo&& bucket_info, ScheduleConfig&& config) {
+  // The symbol of a dimension specialized to a value.
+  using Specialization = std::optional<std::pair<ir::Var, int>>;
+
+  auto InitBucket = [&](BucketInfo&& bucket_info,
+                        ScheduleConfig&& config,
+                        const Specialization& specialization) {
     std::unique_ptr<ir::IRSchedule> ir_sch =
         std::make_unique<ir::IRSchedule>(*ir_sch_);
+    if (specialization.has_value()) {
+      LoopExtentSpecializer specializer(specialization->first,
+                                        specialization->second);
+      for (ir::Expr expr : ir_sch->GetModule().GetExprs()) {
+        specializer(&expr);
+      }
+    }
     std::unique_ptr<ir::ScheduleBlockGraph> schedule_block_graph =
         std::make_unique<ir::ScheduleBlockGraph>(*ir_sch);
     ir::ScheduleBlockNode* global_master =
@@ -109,6 +179,12 @@ void DynamicShapeGroupScheduler::InitBuckets() {
           ir::And::Make(lower_bound_predicate, upper_bound_predicate);
       predicate = ir::And::Make(predicate, curr_predicate);
     }
+    if (specialization.has_value()) {
+      predicate = ir::And::Make(
+          predicate,
+          ir::EQ::Make(specialization->first,
+                       ir::Expr(specialization->second)));
+    }
     ScheduleContext schedule_context{output_names,
                                      target_,
                                      std::move(iter_space_info),
@@ -127,8 +203,46 @@ void DynamicShapeGroupScheduler::InitBuckets() {
       ScheduleConfigManager::Instance();
   std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash> configs =
       schedule_config_manager.ExtractConfigs(target_, group_info_);
+  // Each value in the range of a dimension of a single symbol adds a bucket
+  // with the dimension specialized to it, which is dispatched before the
+  // generic buckets as its predicate is narrower.
+  std::vector<int> specialize_values = GetSpecializeValues();
+  if (!specialize_values.empty()) {
+    std::unique_ptr<ir::ScheduleBlockGraph> schedule_block_graph =
+        std::make_unique<ir::ScheduleBlockGraph>(*ir_sch_);
+    IterativeSpaceInfo iter_space_info =
+        ConstructIterSpaceInfo(FindGlobalMasterNode(schedule_block_graph));
+    const auto& space =
+        iter_space_info.memory_consistent_order_homogeneous_merged_space;
+    int max_priority = 0;
+    for (const auto& config : configs) {
+      max_priority = std::max(max_priority, config.first.bucket_priority);
+    }
+    int num_specialized = 0;
+    for (const auto& [bucket_info, config] : configs) {
+      for (int i = 0; i < space.size() && i < bucket_info.space.size(); ++i) {
+        if (!space[i].second.as_var()) continue;
+        for (int value : specialize_values) {
+          if (num_specialized >= kMaxSpecializedBuckets) break;
+          if (value < bucket_info.space[i].lower_bound ||
+              value > bucket_info.space[i].upper_bound) {
+            continue;
+          }
+          VLOG(4) << "Specialize " << space[i].second << " to " << value;
+          BucketInfo specialized_info = bucket_info;
+          specialized_info.space[i].lower_bound = value;
+          specialized_info.space[i].upper_bound = value;
+          specialized_info.bucket_priority = max_priority + 1;
+          InitBucket(std::move(specialized_info),
+                     ScheduleConfig(config),
+                     std::make_pair(space[i].second.as_var_ref(), value));
+          ++num_specialized;
+        }
+      }
+    }
+  }
   for (std::pair<BucketInfo, ScheduleConfig>&& config : configs) {
-    InitBucket(std::move(config.first), std::move(config.second));
+    InitBucket(std::move(config.first), std::move(config.second), {});
   }
 }
 
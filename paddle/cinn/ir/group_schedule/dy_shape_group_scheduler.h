@@ -21,7 +21,7 @@ namespace ir {
 
 /**
  * The class used for scheduling fusion groups with dynamic shape.
- * Note: Currently only CUDA backend is supported.
+ * Note: Currently the CUDA and x86 backends are supported.
  */
 class DynamicShapeGroupScheduler : public GroupScheduler {
  public:
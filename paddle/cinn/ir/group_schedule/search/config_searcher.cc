@@ -197,6 +197,15 @@ bool CandidateGenerator::IsValid(const CandidateType& candidate) const {
   return true;
 }
 
+namespace {
+
+ScheduleConfig::TileConfig ToTileConfig(const CandidateType& candidate) {
+  return ScheduleConfig::TileConfig{
+      candidate[0], candidate[1], candidate[2], NoneReduceMethod()};
+}
+
+}  // namespace
+
 ScheduleConfigSearcher::ScheduleConfigSearcher(
     std::vector<std::unique_ptr<BaseObjectiveFunc>> objective_funcs,
     const std::vector<std::pair<int, int>>& candidate_range,
@@ -211,11 +220,18 @@ std::pair<ScoreType, CandidateType> ScheduleConfigSearcher::Search(
   CandidateGenerator candidate_generator(candidate_range_, contraints_);
   std::vector<CandidateType> candidates = candidate_generator.Candidates();
   VLOG(6) << "Candidate num = " << candidates.size();
+  if (cost_model_ != nullptr) {
+    candidates = PruneCandidates(candidates);
+    VLOG(6) << "Candidate num after pruning = " << candidates.size();
+  }
   for (const auto& candidate : candidates) {
     ScoreType score = 0;
     for (auto& objective_func_ : objective_funcs_) {
       score += (*objective_func_)(candidate);
     }
+    if (cost_model_ != nullptr) {
+      cost_model_->Update(bucket_info_, ToTileConfig(candidate), score);
+    }
     VLOG(6) << "Candidate: [" << utils::Join<int64_t>(candidate, ", ") << "]";
     VLOG(6) << "Score = " << score;
     records_[score] = candidate;
@@ -223,6 +239,35 @@ std::pair<ScoreType, CandidateType> ScheduleConfigSearcher::Search(
   return is_search_minimun ? *records_.begin() : *(records_.end()--);
 }
 
+void ScheduleConfigSearcher::SetCostModel(
+    const std::shared_ptr<TileConfigCostModel>& cost_model,
+    const BucketInfo& bucket_info,
+    int num_measured) {
+  PADDLE_ENFORCE_GT(num_measured,
+                    0,
+                    ::common::errors::InvalidArgument(
+                        "The number of the measured candidates should be "
+                        "greater than 0, but received %d.",
+                        num_measured));
+  cost_model_ = cost_model;
+  bucket_info_ = bucket_info;
+  num_measured_ = num_measured;
+}
+
+std::vector<CandidateType> ScheduleConfigSearcher::PruneCandidates(
+    const std::vector<CandidateType>& candidates) const {
+  std::vector<ScheduleConfig::TileConfig> configs;
+  for (const auto& candidate : candidates) {
+    configs.push_back(ToTileConfig(candidate));
+  }
+  std::vector<CandidateType> pruned;
+  for (size_t index :
+       cost_model_->TopK(bucket_info_, configs, num_measured_)) {
+    pruned.push_back(candidates[index]);
+  }
+  return pruned;
+}
+
 }  // namespace search
 }  // namespace ir
 }  // namespace cinn
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+#include "paddle/cinn/ir/group_schedule/config/tile_config_cost_model.h"
 #include "paddle/cinn/ir/group_schedule/search/measurer.h"
 #include "paddle/cinn/utils/random_engine.h"
 #include "paddle/pir/include/core/program.h"
@@ -89,12 +90,26 @@ class ScheduleConfigSearcher {
 
   std::pair<ScoreType, CandidateType> Search(bool is_search_minimun = true);
 
+  // Measures only the num_measured candidates with the lowest cost predicted
+  // for the bucket, and trains the cost model with the measured scores. The
+  // candidates are the warp, tree reduce and spatial inner numbers.
+  void SetCostModel(const std::shared_ptr<TileConfigCostModel>& cost_model,
+                    const BucketInfo& bucket_info,
+                    int num_measured);
+
  private:
+  std::vector<CandidateType> PruneCandidates(
+      const std::vector<CandidateType>& candidates) const;
+
   std::vector<std::unique_ptr<BaseObjectiveFunc>> objective_funcs_;
   std::vector<ConstraintFunc> contraints_;
   std::vector<std::pair<int, int>> candidate_range_;
 
   std::map<ScoreType, CandidateType> records_;
+
+  std::shared_ptr<TileConfigCostModel> cost_model_;
+  BucketInfo bucket_info_;
+  int num_measured_{0};
 };
 
 }  // namespace search
@@ -0,0 +1,201 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/tactic/tile_first_cpu_tactic.h"
+#include <algorithm>
+#include "paddle/cinn/ir/group_schedule/tactic/tile_first_general_tactic.h"
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
+#include "paddle/cinn/ir/schedule/ir_schedule_util.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_int32(cinn_cpu_vector_bits);
+
+namespace cinn {
+namespace ir {
+
+using cinn::ir::analyzer::IsReductionSBlock;
+
+namespace {
+
+constexpr int kCacheLineBytes = 64;
+// The loops of fewer elements are not worth the launch of the threads.
+constexpr int64_t kMinParallelNumel = 4096;
+
+int64_t ConstantExtent(const ir::Expr& loop) {
+  const ir::Expr& extent = loop.As<ir::For>()->extent;
+  return extent.is_constant() ? static_cast<int64_t>(extent.get_constant())
+                              : -1;
+}
+
+}  // namespace
+
+int GetCpuVectorBits() {
+  if (FLAGS_cinn_cpu_vector_bits > 0) {
+    return FLAGS_cinn_cpu_vector_bits;
+  }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  static const int vector_bits = [] {
+    if (__builtin_cpu_supports("avx512f")) return 512;
+    if (__builtin_cpu_supports("avx2")) return 256;
+    return 128;
+  }();
+  return vector_bits;
+#else
+  return 128;
+#endif
+}
+
+class TileFirstCpuTactic final : public ScheduleTactic {
+ public:
+  void Init(ScheduleContext* context) override;
+
+  void Apply(ir::IRSchedule* sch, const std::string& block_id) override;
+
+  std::string TacticName() const override { return "TileFirstCpuTactic"; }
+
+ private:
+  void MergeAxis(ir::IRSchedule* sch, const std::string& block_id);
+  // Splits the loop to [S(-1), S(lanes)] and vectorizes the inner one if
+  // the constant extent is a multiple of the lanes, returns the outer loop.
+  ir::Expr SplitVectorize(ir::IRSchedule* sch,
+                          const std::string& block_id,
+                          int loop_idx);
+  void ParallelOuterLoop(ir::IRSchedule* sch, const std::string& block_id);
+
+  int Lanes(ir::IRSchedule* sch, const std::string& block_id) const;
+
+ private:
+  ScheduleContext* context_;
+  std::vector<int32_t> vec_flatten_axis_;
+  std::vector<int32_t> vec_reduce_axis_;
+};
+
+void TileFirstCpuTactic::Init(ScheduleContext* context) {
+  context_ = context;
+
+  // reduce axes have been re-ordered to the last
+  vec_flatten_axis_.clear();
+  vec_reduce_axis_.clear();
+  int32_t reduce_start_idx = context_->config.base_info->data_rank -
+                             context_->config.base_info->reduce_axis.size();
+  for (int32_t i = 0; i < context_->config.base_info->data_rank; ++i) {
+    if (i >= reduce_start_idx) {
+      vec_reduce_axis_.push_back(i);
+    } else {
+      vec_flatten_axis_.push_back(i);
+    }
+  }
+}
+
+void TileFirstCpuTactic::Apply(ir::IRSchedule* sch,
+                               const std::string& block_id) {
+  if (ir::IsReduceInitTensorName(block_id)) return;
+
+  AlignToReduceInput(context_->config, sch, block_id);
+  MergeAxis(sch, block_id);
+  VLOG(6) << "After MergeAxis on block: [" << block_id << "], loop nest:\n"
+          << sch->GetLoops(block_id)[0];
+
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  bool is_reduce = IsReductionSBlock(sch->GetBlock(block_id));
+  if (vec_reduce_axis_.empty() || loops.size() == 1) {
+    // [S] => [S(-1), S(lanes)]
+    if (!is_reduce) SplitVectorize(sch, block_id, loops.size() - 1);
+  } else if (UseContinuousDataTile(context_->config)) {
+    // [S, R] => [S, R(-1), R(lanes)], the reduction stays serial.
+    if (!is_reduce) SplitVectorize(sch, block_id, 1);
+  } else if (is_reduce) {
+    // The reduction reads a column of the input, so each task reduces the
+    // columns of a cache line: [S, R] => [S(-1), S(cache line), R]
+    ir::Tensor tensor =
+        analyzer::GetStoreTensorOfSBlock(sch->GetBlock(block_id));
+    int64_t tile = kCacheLineBytes / std::max(1, tensor->type().bytes());
+    int64_t extent = ConstantExtent(loops[0]);
+    if (tile > 1 && (extent < 0 || extent > tile)) {
+      sch->Split(loops[0], std::vector<int>{-1, static_cast<int>(tile)});
+    }
+  }
+  ParallelOuterLoop(sch, block_id);
+  VLOG(6) << "After TileFirstCpuTactic on block: [" << block_id
+          << "], loop nest:\n"
+          << sch->GetLoops(block_id)[0];
+}
+
+void TileFirstCpuTactic::MergeAxis(ir::IRSchedule* sch,
+                                   const std::string& block_id) {
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  if (vec_reduce_axis_.size() >= 2 && vec_reduce_axis_.back() < loops.size()) {
+    sch->Fuse(block_id, vec_reduce_axis_);
+  }
+  if (vec_flatten_axis_.size() >= 2) {
+    sch->Fuse(block_id, vec_flatten_axis_);
+  }
+}
+
+int TileFirstCpuTactic::Lanes(ir::IRSchedule* sch,
+                              const std::string& block_id) const {
+  ir::Tensor tensor =
+      analyzer::GetStoreTensorOfSBlock(sch->GetBlock(block_id));
+  const Type& type = tensor->type();
+  if (!type.is_float(32) && !type.is_float(64)) return 1;
+  return GetCpuVectorBits() / type.bits();
+}
+
+ir::Expr TileFirstCpuTactic::SplitVectorize(ir::IRSchedule* sch,
+                                            const std::string& block_id,
+                                            int loop_idx) {
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  int lanes = Lanes(sch, block_id);
+  int64_t extent = ConstantExtent(loops[loop_idx]);
+  // The vectorizer leaves the tail of a dynamic loop to LLVM.
+  if (lanes <= 1 || extent < lanes || extent % lanes != 0) {
+    return loops[loop_idx];
+  }
+  if (extent == lanes) {
+    sch->Vectorize(loops[loop_idx], lanes);
+    return loops[loop_idx];
+  }
+  std::vector<ir::Expr> split_loops =
+      sch->Split(loops[loop_idx], std::vector<int>{-1, lanes});
+  sch->Vectorize(split_loops[1], lanes);
+  return split_loops[0];
+}
+
+void TileFirstCpuTactic::ParallelOuterLoop(ir::IRSchedule* sch,
+                                           const std::string& block_id) {
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  int64_t numel = 1;
+  for (const auto& loop : loops) {
+    int64_t extent = ConstantExtent(loop);
+    if (extent < 0) {
+      numel = -1;
+      break;
+    }
+    numel *= extent;
+  }
+  int64_t outer_extent = ConstantExtent(loops[0]);
+  if ((numel >= 0 && numel < kMinParallelNumel) || outer_extent == 1 ||
+      loops[0].As<ir::For>()->is_vectorized()) {
+    return;
+  }
+  sch->Parallel(loops[0]);
+}
+
+std::unique_ptr<ScheduleTactic> CreateTileFirstCpuTactic() {
+  return std::make_unique<TileFirstCpuTactic>();
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,34 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/cinn/ir/group_schedule/tactic/schedule_tactic.h"
+
+namespace cinn {
+namespace ir {
+
+// Returns the vector width in bits of the host, 512 with AVX-512, 256 with
+// AVX2 and 128 otherwise, unless FLAGS_cinn_cpu_vector_bits is set.
+int GetCpuVectorBits();
+
+// Schedules the fusion groups on the CPU: the outer spatial loop runs on the
+// threads of the runtime, the inner continuous loop is vectorized, and the
+// spatial loop of a reduction over discontinuous data is tiled to the cache
+// lines.
+std::unique_ptr<ScheduleTactic> CreateTileFirstCpuTactic();
+
+}  // namespace ir
+}  // namespace cinn
@@ -289,9 +289,10 @@ void TileFirstGeneralTactic::ApplyContinuousDataTile(
   SetReduceType(sch, block_id);
 }
 
-void TileFirstGeneralTactic::AlignToReduceInput(ir::IRSchedule* sch,
-                                                const std::string& block_id) {
-  const auto& loop_strides = context_->config.base_info->loop_strides;
+void AlignToReduceInput(const ScheduleConfig& config,
+                        ir::IRSchedule* sch,
+                        const std::string& block_id) {
+  const auto& loop_strides = config.base_info->loop_strides;
   if (loop_strides.empty()) {
     return;
   }
@@ -301,7 +302,7 @@ void TileFirstGeneralTactic::AlignToReduceInput(ir::IRSchedule* sch,
   std::iota(loop_perm.begin(), loop_perm.end(), 0);
 
   const auto IsReduce = [&](int64_t axis) {
-    auto& reduce_axis = context_->config.base_info->reduce_axis;
+    auto& reduce_axis = config.base_info->reduce_axis;
     return std::find(reduce_axis.begin(), reduce_axis.end(), axis) !=
            reduce_axis.end();
   };
@@ -327,6 +328,11 @@ void TileFirstGeneralTactic::AlignToReduceInput(ir::IRSchedule* sch,
   sch->Reorder(rd_loops);
 }
 
+void TileFirstGeneralTactic::AlignToReduceInput(ir::IRSchedule* sch,
+                                                const std::string& block_id) {
+  ir::AlignToReduceInput(context_->config, sch, block_id);
+}
+
 void TileFirstGeneralTactic::MergeFlattenAxis(ir::IRSchedule* sch,
                                               const std::string& block_id) {
   if (vec_flatten_axis_.size() >= 2) {
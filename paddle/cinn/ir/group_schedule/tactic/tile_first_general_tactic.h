@@ -20,6 +20,17 @@
 namespace cinn {
 namespace ir {
 
+// Whether the innermost spatial and reduce axes are the same in memory, that
+// is the reduction reads continuous data.
+bool UseContinuousDataTile(const ScheduleConfig& config);
+
+// Reorders the loops of a block with the spatial loops first and the reduce
+// loops last, each in the descending order of the strides of the reduce
+// input.
+void AlignToReduceInput(const ScheduleConfig& config,
+                        ir::IRSchedule* sch,
+                        const std::string& block_id);
+
 std::unique_ptr<ScheduleTactic> CreateTileFirstGeneralTactic();
 
 }  // namespace ir
@@ -14,6 +14,9 @@
 
 #pragma once
 #include "paddle/cinn/operator_fusion/pattern_graph.h"
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_int64(cinn_horizontal_fusion_max_registers);
 
 namespace cinn::fusion {
 // Matcher
@@ -315,6 +318,52 @@ struct InputOutputMaximumConstrain {
   }
 };
 
+/*
+ * The horizontally fused patterns run in the same threads, so a thread holds
+ * the registers of all of them. We estimate the 32-bit registers of the
+ * elements a thread loads, stores and reduces, and do not fuse the patterns
+ * when the estimate exceeds FLAGS_cinn_horizontal_fusion_max_registers, as
+ * the lower occupancy or the spills would cost more than the saved launch.
+ */
+struct HorizontalFusionCostConstrain {
+  // The accumulator and the value exchanged by the tree reduction.
+  const int64_t REGISTERS_PER_REDUCE_ELEMENT = 2;
+  int64_t RegistersOf(const pir::Value& value) {
+    auto type = value.type().dyn_cast<pir::DenseTensorType>();
+    if (!type) return 1;
+    int bytes =
+        hlir::framework::pir::CompatibleInfo::ConvertIRType(type.dtype())
+            .bytes();
+    return std::max(1, (bytes + 3) / 4);
+  }
+  int64_t EstimateRegisters(const std::vector<pir::Operation*>& ops) {
+    int64_t registers = 0;
+    for (const auto& value : InputOutputMaximumConstrain()
+                                 .GetInputValuesExceptMiddle(ops)) {
+      registers += RegistersOf(value);
+    }
+    for (const auto& value : InputOutputMaximumConstrain()
+                                 .GetOutputValuesExceptMiddle(ops)) {
+      registers += RegistersOf(value);
+    }
+    for (const auto& op : ops) {
+      if (GetOpPatternKind(op) == hlir::framework::kReduction) {
+        registers += REGISTERS_PER_REDUCE_ELEMENT * RegistersOf(op->result(0));
+      }
+    }
+    return registers;
+  }
+  bool operator()(const PatternGraph& graph,
+                  const PatternNodePtr& lhs,
+                  const PatternNodePtr& rhs) {
+    if (FLAGS_cinn_horizontal_fusion_max_registers <= 0) return true;
+    const auto& all_ops = InputOutputMaximumConstrain().GetAllOps(lhs, rhs);
+    int64_t registers = EstimateRegisters(all_ops);
+    VLOG(4) << "Estimated registers of horizontal fusion: " << registers;
+    return registers <= FLAGS_cinn_horizontal_fusion_max_registers;
+  }
+};
+
 struct HorizontalCheckMiddleOutputVar {
   bool DontHaveMiddleVariable(const PatternGraph& graph,
                               const PatternNodePtr& lhs,
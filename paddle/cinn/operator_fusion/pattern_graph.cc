@@ -161,10 +161,10 @@ void PatternGraph::HorizontalFusion() {
 
   GraphTransformer<NodePairPattern,
                    And<HorizontalFusionConstrain,
+                       // Avoid two many inputs and outputs.
                        InputOutputMaximumConstrain,
-                       HorizontalCheckMiddleOutputVar>,  // Avoid two many
-                                                         // inputs and
-                                                         // outputs.
+                       HorizontalCheckMiddleOutputVar,
+                       HorizontalFusionCostConstrain>,
                    HorizontalFusionOperation>(this);
 }
 
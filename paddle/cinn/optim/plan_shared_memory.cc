@@ -0,0 +1,243 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/optim/plan_shared_memory.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/cinn/ir/ir_mutator.h"
+#include "paddle/cinn/ir/utils/ir_nodes_collector.h"
+#include "paddle/cinn/optim/ir_simplify.h"
+#include "paddle/cinn/utils/string.h"
+
+namespace cinn {
+namespace optim {
+
+namespace {
+
+// The alignment of the planned buffers, which fits the vectorized accesses.
+constexpr int64_t kSharedMemoryAlignment = 16;
+
+int64_t AlignUp(int64_t bytes) {
+  return (bytes + kSharedMemoryAlignment - 1) / kSharedMemoryAlignment *
+         kSharedMemoryAlignment;
+}
+
+ir::Expr BufferBytes(const ir::Buffer& buffer) {
+  ir::Expr bytes(1);
+  for (const auto& dim : buffer->shape) {
+    bytes = bytes * dim;
+  }
+  bytes = bytes * ir::Expr(buffer->dtype.bytes());
+  optim::Simplify(&bytes);
+  return bytes;
+}
+
+// Whether all threads of a block take the same branch of the condition.
+bool IsBlockUniform(const ir::Expr& condition) {
+  return ir::ir_utils::CollectIRNodes(condition, [](const ir::Expr* x) {
+           if (x->As<ir::Load>()) return true;
+           return x->as_var() &&
+                  utils::StartsWith(x->as_var()->name, "threadIdx");
+         }).empty();
+}
+
+// Numbers the uses of the shared memory buffers and the `__syncthreads` in
+// the order of execution, with a loop extending the uses in it to the loop.
+class SharedMemoryLivenessCollector : public ir::IRMutator<const ir::Expr*> {
+ public:
+  using Range = std::pair<int, int>;
+
+  // Maps the names of the buffers and of the tensors on them to the buffers.
+  explicit SharedMemoryLivenessCollector(
+      const std::unordered_map<std::string, std::string>& buffer_of_name)
+      : buffer_of_name_(buffer_of_name) {}
+
+  void operator()(const ir::Expr* expr) { IRMutator::Visit(expr, expr); }
+
+  const std::unordered_map<std::string, Range>& ranges() const {
+    return ranges_;
+  }
+
+  // Whether a barrier is executed after the position first and before last.
+  bool HasBarrierBetween(int first, int last) const {
+    auto it = std::upper_bound(barriers_.begin(), barriers_.end(), first);
+    return it != barriers_.end() && *it < last;
+  }
+
+ private:
+  void Use(const std::string& name) {
+    auto buffer = buffer_of_name_.find(name);
+    if (buffer == buffer_of_name_.end()) return;
+    int position = ++position_;
+    auto range = ranges_.emplace(buffer->second, Range{position, position});
+    range.first->second.second = position;
+    for (auto& loop_buffers : loop_buffers_) {
+      loop_buffers.insert(buffer->second);
+    }
+  }
+
+  void Visit(const ir::_Var_* op, const ir::Expr* expr) override {
+    Use(op->name);
+    IRMutator::Visit(op, expr);
+  }
+
+  void Visit(const ir::_Tensor_* op, const ir::Expr* expr) override {
+    Use(op->name);
+    if (op->buffer.defined()) Use(op->buffer->name);
+    IRMutator::Visit(op, expr);
+  }
+
+  void Visit(const ir::_Buffer_* op, const ir::Expr* expr) override {
+    Use(op->name);
+    IRMutator::Visit(op, expr);
+  }
+
+  void Visit(const ir::Call* op, const ir::Expr* expr) override {
+    IRMutator::Visit(op, expr);
+    if (op->name == "__syncthreads") {
+      int position = ++position_;
+      if (divergent_depth_ == 0) barriers_.push_back(position);
+    }
+  }
+
+  void Visit(const ir::IfThenElse* op, const ir::Expr* expr) override {
+    bool divergent = !IsBlockUniform(op->condition);
+    divergent_depth_ += divergent;
+    IRMutator::Visit(op, expr);
+    divergent_depth_ -= divergent;
+  }
+
+  void Visit(const ir::For* op, const ir::Expr* expr) override {
+    // A loop that may not run skips its barriers.
+    bool divergent = !op->extent.is_constant() ||
+                     op->extent.get_constant() <= 0 ||
+                     !IsBlockUniform(op->min);
+    int start = ++position_;
+    divergent_depth_ += divergent;
+    loop_buffers_.emplace_back();
+    IRMutator::Visit(op, expr);
+    int end = ++position_;
+    for (const auto& buffer : loop_buffers_.back()) {
+      auto& range = ranges_.at(buffer);
+      range.first = std::min(range.first, start);
+      range.second = std::max(range.second, end);
+    }
+    loop_buffers_.pop_back();
+    divergent_depth_ -= divergent;
+  }
+
+  const std::unordered_map<std::string, std::string>& buffer_of_name_;
+  std::unordered_map<std::string, Range> ranges_;
+  std::vector<int> barriers_;
+  std::vector<std::unordered_set<std::string>> loop_buffers_;
+  int position_{0};
+  int divergent_depth_{0};
+};
+
+}  // namespace
+
+SharedMemoryPlan PlanSharedMemory(const ir::_LoweredFunc_* func) {
+  std::vector<ir::Buffer> buffers;
+  std::set<std::string> buffer_names;
+  for (const auto& buffer : func->temp_bufs) {
+    if (buffer->memory_type == ir::MemoryType::GPUShared &&
+        buffer_names.insert(buffer->name).second) {
+      buffers.push_back(buffer);
+    }
+  }
+  SharedMemoryPlan plan;
+  if (buffers.empty()) return plan;
+
+  std::unordered_map<std::string, std::string> buffer_of_name;
+  for (const auto& name : buffer_names) {
+    buffer_of_name[name] = name;
+  }
+  ir::ir_utils::CollectIRNodes(func->body, [&](const ir::Expr* x) {
+    auto* tensor = x->as_tensor();
+    if (tensor && tensor->buffer.defined() &&
+        buffer_names.count(tensor->buffer->name)) {
+      buffer_of_name[tensor->name] = tensor->buffer->name;
+    }
+    return false;
+  });
+  SharedMemoryLivenessCollector collector(buffer_of_name);
+  collector(&func->body);
+  const auto& ranges = collector.ranges();
+
+  struct Placed {
+    int64_t offset;
+    int64_t bytes;
+    SharedMemoryLivenessCollector::Range range;
+  };
+  std::vector<std::pair<ir::Buffer, int64_t>> planned;
+  std::vector<ir::Buffer> unplanned;
+  for (const auto& buffer : buffers) {
+    ir::Expr bytes = BufferBytes(buffer);
+    if (bytes.is_constant() && ranges.count(buffer->name)) {
+      planned.emplace_back(buffer,
+                           static_cast<int64_t>(bytes.get_constant()));
+    } else {
+      unplanned.push_back(buffer);
+    }
+  }
+  std::stable_sort(planned.begin(), planned.end(), [&](auto& a, auto& b) {
+    return ranges.at(a.first->name).first < ranges.at(b.first->name).first;
+  });
+
+  // First fit below the buffers whose bytes may not be reused.
+  std::vector<Placed> placed;
+  int64_t planned_bytes = 0;
+  for (const auto& [buffer, bytes] : planned) {
+    const auto& range = ranges.at(buffer->name);
+    std::vector<const Placed*> conflicts;
+    for (const auto& other : placed) {
+      if (!collector.HasBarrierBetween(other.range.second, range.first)) {
+        conflicts.push_back(&other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [](auto* a, auto* b) {
+      return a->offset < b->offset;
+    });
+    int64_t offset = 0;
+    for (const auto* conflict : conflicts) {
+      if (offset + bytes <= conflict->offset) break;
+      offset = std::max(offset, AlignUp(conflict->offset + conflict->bytes));
+    }
+    placed.push_back(Placed{offset, bytes, range});
+    plan.offsets[buffer->name] = ir::Expr(static_cast<int32_t>(offset));
+    plan.unshared_bytes += bytes;
+    planned_bytes = std::max(planned_bytes, offset + bytes);
+    VLOG(6) << "Plan shared memory buffer " << buffer->name << " of " << bytes
+            << " bytes at " << offset << ", live in [" << range.first << ", "
+            << range.second << "]";
+  }
+
+  plan.planned_bytes = planned_bytes;
+  ir::Expr total_bytes(static_cast<int32_t>(
+      unplanned.empty() ? planned_bytes : AlignUp(planned_bytes)));
+  for (const auto& buffer : unplanned) {
+    plan.offsets[buffer->name] = total_bytes;
+    total_bytes = total_bytes + BufferBytes(buffer);
+    optim::Simplify(&total_bytes);
+  }
+  plan.total_bytes = total_bytes;
+  return plan;
+}
+
+}  // namespace optim
+}  // namespace cinn
@@ -0,0 +1,52 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/lowered_func.h"
+
+namespace cinn {
+namespace optim {
+
+/**
+ * The layout of the shared memory buffers of a kernel in its dynamic shared
+ * memory.
+ */
+struct SharedMemoryPlan {
+  // The byte offset of each shared memory buffer by name.
+  std::unordered_map<std::string, ir::Expr> offsets;
+  // The bytes of the dynamic shared memory of the kernel.
+  ir::Expr total_bytes{0};
+  // The bytes of the planned buffers, and the bytes they would take without
+  // any reuse.
+  int64_t planned_bytes{0};
+  int64_t unshared_bytes{0};
+};
+
+/**
+ * Lay out the shared memory buffers of \p func by their liveness. The buffers
+ * of static sizes share the bytes if the uses of one end before the uses of
+ * the other start, with a `__syncthreads` executed by the whole block in
+ * between. The uses in a loop are live in the whole loop.
+ *
+ * The buffers of dynamic sizes or without any use found follow the planned
+ * ones, in the order of \p func->temp_bufs.
+ */
+SharedMemoryPlan PlanSharedMemory(const ir::_LoweredFunc_* func);
+
+}  // namespace optim
+}  // namespace cinn
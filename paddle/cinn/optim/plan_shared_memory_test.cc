@@ -0,0 +1,102 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/optim/plan_shared_memory.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/lowered_func.h"
+#include "paddle/cinn/runtime/intrinsic.h"
+
+namespace cinn {
+namespace optim {
+
+namespace {
+
+ir::Buffer SharedBuffer(const std::string& name, int size) {
+  auto buffer = ir::_Buffer_::Make(name, {ir::Expr(size)});
+  buffer->dtype = Float(32);
+  buffer->memory_type = ir::MemoryType::GPUShared;
+  return buffer;
+}
+
+ir::Expr UseBuffer(const ir::Buffer& buffer) {
+  return ir::Call::Make(
+      Void(), "use_buffer", {ir::Expr(buffer)}, {}, ir::CallType::Extern);
+}
+
+ir::Expr SyncThreads() {
+  return runtime::IntrinsicCall(Void(), "__syncthreads", {});
+}
+
+int64_t Offset(const SharedMemoryPlan& plan, const std::string& name) {
+  return plan.offsets.at(name).as_int32();
+}
+
+}  // namespace
+
+TEST(PlanSharedMemory, reuse_after_barrier) {
+  auto a = SharedBuffer("shm_a", 64);
+  auto b = SharedBuffer("shm_b", 32);
+  auto body = ir::Block::Make({UseBuffer(a), SyncThreads(), UseBuffer(b)});
+  auto func = ir::_LoweredFunc_::Make("fn", {}, body, {a, b});
+
+  auto plan = PlanSharedMemory(func.As<ir::_LoweredFunc_>());
+  EXPECT_EQ(Offset(plan, "shm_a"), 0);
+  EXPECT_EQ(Offset(plan, "shm_b"), 0);
+  EXPECT_EQ(plan.planned_bytes, 256);
+  EXPECT_EQ(plan.unshared_bytes, 384);
+  EXPECT_EQ(plan.total_bytes.as_int32(), 256);
+}
+
+TEST(PlanSharedMemory, no_reuse_without_barrier) {
+  auto a = SharedBuffer("shm_a", 3);
+  auto b = SharedBuffer("shm_b", 4);
+  auto body = ir::Block::Make({UseBuffer(a), UseBuffer(b)});
+  auto func = ir::_LoweredFunc_::Make("fn", {}, body, {a, b});
+
+  auto plan = PlanSharedMemory(func.As<ir::_LoweredFunc_>());
+  EXPECT_EQ(Offset(plan, "shm_a"), 0);
+  // Aligned after the 12 bytes of shm_a.
+  EXPECT_EQ(Offset(plan, "shm_b"), 16);
+  EXPECT_EQ(plan.planned_bytes, 32);
+}
+
+TEST(PlanSharedMemory, no_reuse_in_loop) {
+  // shm_a is read again by the next iteration after shm_b is written.
+  auto a = SharedBuffer("shm_a", 32);
+  auto b = SharedBuffer("shm_b", 32);
+  ir::Var i("i");
+  auto loop_body =
+      ir::Block::Make({UseBuffer(a), SyncThreads(), UseBuffer(b)});
+  auto body = ir::For::Make(i,
+                            ir::Expr(0),
+                            ir::Expr(4),
+                            ir::ForType::Serial,
+                            ir::DeviceAPI::CUDA,
+                            loop_body);
+  auto func = ir::_LoweredFunc_::Make(
+      "fn", {}, ir::Block::Make({body}), {a, b});
+
+  auto plan = PlanSharedMemory(func.As<ir::_LoweredFunc_>());
+  EXPECT_NE(Offset(plan, "shm_a"), Offset(plan, "shm_b"));
+  EXPECT_EQ(plan.planned_bytes, 256);
+}
+
+}  // namespace optim
+}  // namespace cinn
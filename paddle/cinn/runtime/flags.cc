@@ -49,6 +49,12 @@ PD_DEFINE_string(cinn_nvcc_cmd_path,
                                "/usr/local/cuda/bin"),
                  "Setting nvcc default path!");
 
+PD_DEFINE_string(cinn_nvcc_cache_dir,
+                 StringFromEnv("FLAGS_cinn_nvcc_cache_dir", ""),
+                 "The directory of the cubins compiled by nvcc, keyed by the "
+                 "hash of the source and the arch, so the same source is "
+                 "compiled once across processes. Empty disables the cache.");
+
 PD_DEFINE_string(cinn_kernel_execution_label,
                  StringFromEnv("FLAGS_cinn_kernel_execution_label",
                                "CINN KERNEL EXECUTE"),
@@ -58,10 +64,29 @@ PD_DEFINE_string(cinn_tile_config_filename_label,
                  StringFromEnv("FLAGS_cinn_tile_config_filename_label", ""),
                  "Label used to name file of tile config database");
 
+PD_DEFINE_string(cinn_tile_config_shared_dir,
+                 StringFromEnv("FLAGS_cinn_tile_config_shared_dir", ""),
+                 "The directory of the tile config database shared by the "
+                 "machines, e.g. on network storage. The local files are used "
+                 "if empty.");
+
+PD_DEFINE_string(cinn_tile_config_shared_version,
+                 StringFromEnv("FLAGS_cinn_tile_config_shared_version",
+                               "default"),
+                 "The version label of the configs in the shared tile config "
+                 "database, e.g. the CINN version the configs are tuned with.");
+
+PD_DEFINE_bool(cinn_tile_config_shared_readonly,
+               BoolFromEnv("FLAGS_cinn_tile_config_shared_readonly", false),
+               "Whether the shared tile config database is read only, as on "
+               "the production nodes.");
+
 PD_DEFINE_string(
     tile_config_policy,
     StringFromEnv("FLAGS_tile_config_policy", "default"),
-    "Which config does the compiler use, optimal, custom or default");
+    "Which config does the compiler use, optimal, hybrid, model, search or "
+    "default. The model policy predicts the configs of the buckets without an "
+    "optimal config with a cost model.");
 
 PD_DEFINE_int32(cinn_parallel_compile_thread,
                 Int32FromEnv("FLAGS_cinn_parallel_compile_thread",
@@ -97,6 +122,13 @@ PD_DEFINE_bool(cinn_bucket_compile,
                BoolFromEnv("FLAGS_cinn_bucket_compile", true),
                "Whether to enable bucket compile for dynamic shape.");
 
+PD_DEFINE_string(cinn_bucket_specialize_values,
+                 StringFromEnv("FLAGS_cinn_bucket_specialize_values", ""),
+                 "The comma separated values a dynamic dimension of a bucket "
+                 "is specialized to, e.g. \"128,4096\". Each value in the "
+                 "range of a bucket adds a kernel with the dimension as a "
+                 "constant, dispatched before the generic one.");
+
 PD_DEFINE_bool(group_schedule_tiling_first,
                BoolFromEnv("FLAGS_group_schedule_tiling_first", true),
                "Whether to enable new group scheduler tiling first strategy.");
@@ -146,6 +178,12 @@ PD_DEFINE_string(cinn_check_fusion_accuracy_pass,
                  "satisfied 'allclose(rtol=1e-05f, atol=1e-08f)', "
                  "report error and exited.");
 
+PD_DEFINE_int32(cinn_cpu_vector_bits,
+                Int32FromEnv("FLAGS_cinn_cpu_vector_bits", 0),
+                "The vector width in bits the x86 schedule vectorizes the "
+                "loops to, e.g. 256 for AVX2 and 512 for AVX-512. It is "
+                "detected from the host if 0.");
+
 PD_DEFINE_bool(cinn_use_cuda_vectorize,
                BoolFromEnv("FLAGS_cinn_use_cuda_vectorize", false),
                "Whether use cuda vectorize on schedule config");
@@ -176,6 +214,13 @@ PD_DEFINE_bool(
     "technique which contract fp multiplication and addition/subtraction into "
     "multiply-add operation. It may result in different fp precision.");
 
+PD_DEFINE_int32(
+    cinn_nvrtc_batch_size,
+    Int32FromEnv("FLAGS_cinn_nvrtc_batch_size", 1),
+    "The most CUDA sources of the groups compiled concurrently that are "
+    "compiled as one NVRTC program, so the headers are parsed once for them. "
+    "1 compiles every group alone.");
+
 PD_DEFINE_bool(
     cinn_compile_with_hiprtc,
     BoolFromEnv("FLAGS_cinn_compile_with_hiprtc", false),
@@ -271,6 +316,14 @@ PD_DEFINE_int32(
     "Specify the ProfilerState by Int in CINN, 0 for kDisabled, 1 for "
     "kCPU, 2 for kCUDA, 3 for kAll, default 0.");
 
+PD_DEFINE_string(cinn_compile_report_dir,
+                 StringFromEnv("FLAGS_cinn_compile_report_dir", ""),
+                 "The directory to save the CINN compile report to after "
+                 "each program is compiled: the time of the passes, the "
+                 "lowering, scheduling, codegen and compilation stages of "
+                 "each group and the cache counters as JSON, and the events "
+                 "as a Chrome trace. Empty means no report.");
+
 PD_DEFINE_int32(cinn_error_message_level,
                 Int32FromEnv("FLAGS_cinn_error_message_level", 0),
                 "Specify the level of printing error message in the schedule."
@@ -15,11 +15,65 @@
 #include "paddle/cinn/utils/event.h"
 
 #include <glog/logging.h>  // for GLog
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <unordered_map>
 
 #include "paddle/common/enforce.h"
 namespace cinn {
 namespace utils {
+
+namespace {
+
+std::string JsonString(const std::string &str) {
+  std::ostringstream os;
+  os << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+             << static_cast<int>(c) << std::dec;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+  return os.str();
+}
+
+// Writes the {"key": value} pairs of a map.
+template <typename Map>
+void WriteJsonObject(const Map &map, std::ostream *os) {
+  *os << "{";
+  bool first = true;
+  for (const auto &[key, value] : map) {
+    *os << (first ? "" : ", ") << JsonString(key) << ": " << value;
+    first = false;
+  }
+  *os << "}";
+}
+
+}  // namespace
 inline std::string EventTypeToString(const EventType &type) {
   switch (type) {
     case EventType::kOrdinary:
@@ -127,5 +181,108 @@ std::string Summary::AsStr(const std::vector<Item> &items, int data_width) {
   return os.str();
 }
 
+std::string HostEventRecorder::Json() {
+  struct Total {
+    double duration{0.0};
+    int64_t count{0};
+  };
+  auto &recorder = GetInstance();
+  std::lock_guard<std::mutex> guard(recorder.mutex_);
+  // The nested events overlap, so the totals of the categories sum up the
+  // time of the parent events and their children.
+  std::map<std::string, double> category_cost;
+  std::map<std::pair<std::string, std::string>, Total> event_cost;
+  std::map<std::string, std::map<std::string, double>> group_cost;
+  double begin = std::numeric_limits<double>::max();
+  double end = 0.0;
+  for (const auto &e : recorder.events_) {
+    category_cost[EventTypeToString(e.type_)] += e.duration_;
+    auto &total = event_cost[{e.annotation_, EventTypeToString(e.type_)}];
+    total.duration += e.duration_;
+    ++total.count;
+    if (!e.group_.empty()) {
+      group_cost[e.group_][e.annotation_] += e.duration_;
+    }
+    begin = std::min(begin, e.start_);
+    end = std::max(end, e.start_ + e.duration_ * 1e3);
+  }
+
+  std::ostringstream os;
+  os << "{\n  \"wall_time_ms\": "
+     << (recorder.events_.empty() ? 0.0 : (end - begin) / 1e3);
+  os << ",\n  \"categories_ms\": ";
+  WriteJsonObject(category_cost, &os);
+  os << ",\n  \"counters\": ";
+  WriteJsonObject(recorder.counters_, &os);
+
+  std::vector<std::pair<std::pair<std::string, std::string>, Total>> events(
+      event_cost.begin(), event_cost.end());
+  std::sort(events.begin(), events.end(), [](const auto &a, const auto &b) {
+    return a.second.duration > b.second.duration;
+  });
+  os << ",\n  \"events\": [";
+  for (size_t i = 0; i < events.size(); ++i) {
+    os << (i == 0 ? "\n" : ",\n") << "    {\"name\": "
+       << JsonString(events[i].first.first)
+       << ", \"category\": " << JsonString(events[i].first.second)
+       << ", \"count\": " << events[i].second.count
+       << ", \"total_ms\": " << events[i].second.duration << "}";
+  }
+  os << "\n  ]";
+
+  os << ",\n  \"groups\": {";
+  bool first = true;
+  for (const auto &[group, stages] : group_cost) {
+    os << (first ? "\n" : ",\n") << "    " << JsonString(group) << ": ";
+    WriteJsonObject(stages, &os);
+    first = false;
+  }
+  os << "\n  }\n}\n";
+  return os.str();
+}
+
+std::string HostEventRecorder::ChromeTrace() {
+  auto &recorder = GetInstance();
+  std::lock_guard<std::mutex> guard(recorder.mutex_);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"traceEvents\": [";
+  bool first = true;
+  for (const auto &e : recorder.events_) {
+    os << (first ? "\n" : ",\n") << "  {\"name\": "
+       << JsonString(e.annotation_)
+       << ", \"cat\": " << JsonString(EventTypeToString(e.type_))
+       << ", \"ph\": \"X\", \"ts\": " << e.start_
+       << ", \"dur\": " << e.duration_ * 1e3 << ", \"pid\": " << getpid()
+       << ", \"tid\": " << e.thread_id_;
+    if (!e.group_.empty()) {
+      os << ", \"args\": {\"group\": " << JsonString(e.group_) << "}";
+    }
+    os << "}";
+    first = false;
+  }
+  os << "\n], \"otherData\": ";
+  WriteJsonObject(recorder.counters_, &os);
+  os << "}\n";
+  return os.str();
+}
+
+void HostEventRecorder::Dump(const std::string &dir) {
+  static std::atomic<int> report_id{0};
+  if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    LOG(WARNING) << "Cannot create the directory of CINN compile report: "
+                 << dir;
+    return;
+  }
+  std::string prefix = dir + "/cinn_compile_" + std::to_string(getpid()) +
+                       "_" + std::to_string(report_id++);
+  std::ofstream report(prefix + "_report.json");
+  report << Json();
+  std::ofstream trace(prefix + "_trace.json");
+  trace << ChromeTrace();
+  LOG(INFO) << "CINN compile report is saved to " << prefix
+            << "_report.json and " << prefix << "_trace.json";
+}
+
 }  // namespace utils
 }  // namespace cinn
@@ -15,7 +15,10 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -60,6 +63,10 @@ struct HostEvent {
   std::string annotation_;
   double duration_;  // ms
   EventType type_;
+  double start_{0.0};  // us since the first event
+  uint64_t thread_id_{0};
+  // The group being compiled, empty if none.
+  std::string group_;
 
   HostEvent(const std::string& annotation, double duration, EventType type)
       : annotation_(annotation), duration_(duration), type_(type) {}
@@ -99,18 +106,47 @@ class HostEventRecorder {
 
   static std::string Table() { return Summary::Format(GetInstance().Events()); }
 
-  void Clear() { events_.clear(); }
+  // The total time of each category, event and group, and the counters.
+  static std::string Json();
+
+  // The events in the Chrome trace event format, for chrome://tracing.
+  static std::string ChromeTrace();
+
+  // Writes Json() and ChromeTrace() to the files of a report in dir.
+  static void Dump(const std::string& dir);
+
+  void Clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    events_.clear();
+    counters_.clear();
+  }
 
   std::vector<HostEvent>& Events() { return events_; }
 
+  const std::map<std::string, int64_t>& Counters() const { return counters_; }
+
   void RecordEvent(const std::string& annotation,
                    double duration,
                    EventType type) {
-    GetInstance().Events().emplace_back(annotation, duration, type);
+    std::lock_guard<std::mutex> guard(mutex_);
+    events_.emplace_back(annotation, duration, type);
+  }
+
+  void RecordEvent(HostEvent&& event) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    events_.emplace_back(std::move(event));
+  }
+
+  // Adds to a counter, e.g. of the cache hits or the compiled kernels.
+  void AddCount(const std::string& name, int64_t value = 1) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    counters_[name] += value;
   }
 
  private:
+  std::mutex mutex_;
   std::vector<HostEvent> events_;
+  std::map<std::string, int64_t> counters_;
 };
 
 }  // namespace utils
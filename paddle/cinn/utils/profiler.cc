@@ -26,16 +26,36 @@
 #include "paddle/cinn/backends/cuda_util.h"
 #endif
 #include <chrono>
+#include <thread>
 
 PD_DECLARE_int32(cinn_profiler_state);
+PD_DECLARE_string(cinn_compile_report_dir);
 
 namespace cinn {
 namespace utils {
 
 ProfilerState ProfilerHelper::g_state = ProfilerState::kDisabled;
 
+namespace {
+
+thread_local std::string current_event_group;
+
+// The time of the events is relative to the first one.
+std::chrono::steady_clock::time_point EventOrigin() {
+  static const auto origin = std::chrono::steady_clock::now();
+  return origin;
+}
+
+}  // namespace
+
 void ProfilerHelper::UpdateState() {
-  if (FLAGS_cinn_profiler_state < 0) return;
+  // The compile report records the CPU events unless the state is set.
+  if (FLAGS_cinn_profiler_state < 0) {
+    if (!FLAGS_cinn_compile_report_dir.empty()) {
+      g_state = ProfilerState::kCPU;
+    }
+    return;
+  }
 
   switch (FLAGS_cinn_profiler_state) {
     case 0:
@@ -60,14 +80,21 @@ RecordEvent::RecordEvent(const std::string& name, EventType type) {
   if (!ProfilerHelper::IsEnable()) return;
 
   if (ProfilerHelper::IsEnableCPU()) {
+    auto origin = EventOrigin();
     call_back_ = [this,
+                  origin,
                   tik = std::chrono::steady_clock::now(),
                   annotation = std::move(name),
                   type]() {
       auto tok = std::chrono::steady_clock::now();
       std::chrono::duration<double> duration = (tok - tik) * 1e3;  // ms
-      HostEventRecorder::GetInstance().RecordEvent(
-          annotation, duration.count(), type);
+      std::chrono::duration<double, std::micro> start = tik - origin;
+      HostEvent event(annotation, duration.count(), type);
+      event.start_ = start.count();
+      event.thread_id_ =
+          std::hash<std::thread::id>()(std::this_thread::get_id());
+      event.group_ = ScopedEventGroup::Current();
+      HostEventRecorder::GetInstance().RecordEvent(std::move(event));
     };
   }
 
@@ -77,7 +104,8 @@ RecordEvent::RecordEvent(const std::string& name, EventType type) {
 }
 
 void RecordEvent::End() {
-  if (!ProfilerHelper::IsEnable()) return;
+  if (!ProfilerHelper::IsEnable() || ended_) return;
+  ended_ = true;
 
   if (ProfilerHelper::IsEnableCPU() && call_back_ != nullptr) {
     call_back_();
@@ -88,6 +116,20 @@ void RecordEvent::End() {
   }
 }
 
+ScopedEventGroup::ScopedEventGroup(const std::string& group)
+    : previous_(current_event_group) {
+  current_event_group = group;
+}
+
+ScopedEventGroup::~ScopedEventGroup() { current_event_group = previous_; }
+
+const std::string& ScopedEventGroup::Current() { return current_event_group; }
+
+void RecordCount(const std::string& name, int64_t value) {
+  if (!ProfilerHelper::IsEnableCPU()) return;
+  HostEventRecorder::GetInstance().AddCount(name, value);
+}
+
 void SynchronizeAllDevice() {
 #ifdef CINN_WITH_CUDA
   int current_device_id;
@@ -62,6 +62,19 @@ class ProfilerHelper {
   static void UpdateState();
 };
 
+// Tags the events recorded by the thread in the scope with a group, e.g.
+// the fusion group being compiled.
+class ScopedEventGroup {
+ public:
+  explicit ScopedEventGroup(const std::string& group);
+  ~ScopedEventGroup();
+
+  static const std::string& Current();
+
+ private:
+  std::string previous_;
+};
+
 class RecordEvent {
   using CallBack = std::function<void()>;
 
@@ -69,14 +82,20 @@ class RecordEvent {
   explicit RecordEvent(const std::string& name,
                        EventType type = EventType::kOrdinary);
 
+  // Records the event, which is done once even if called before the
+  // destructor.
   void End();
 
   ~RecordEvent() { End(); }
 
  private:
   CallBack call_back_;
+  bool ended_{false};
 };
 
+// Adds to a counter of the HostEventRecorder if the CPU profiling is enabled.
+void RecordCount(const std::string& name, int64_t value = 1);
+
 void SynchronizeAllDevice();
 
 void ProfilerStart();
@@ -16,6 +16,9 @@
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
 
 TEST(RecordEvent, HOST) {
   using cinn::utils::EventType;
@@ -78,3 +81,73 @@ TEST(RecordEvent, HOST) {
   }
   EXPECT_EQ(events.size(), 8U);
 }
+
+TEST(HostEventRecorder, CompileReport) {
+  using cinn::utils::EventType;
+  using cinn::utils::HostEventRecorder;
+  using cinn::utils::ProfilerHelper;
+  using cinn::utils::RecordCount;
+  using cinn::utils::RecordEvent;
+  using cinn::utils::ScopedEventGroup;
+
+  ProfilerHelper::EnableCPU();
+  auto &recorder = HostEventRecorder::GetInstance();
+  recorder.Clear();
+
+  {
+    ScopedEventGroup group("group_a");
+    RecordEvent lower("Lower", EventType::kOrdinary);
+    // closed once, before the scope ends
+    lower.End();
+    lower.End();
+    {
+      ScopedEventGroup nested_group("group_b");
+      RecordEvent codegen("Codegen", EventType::kCompile);
+    }
+    RecordEvent quoted("a\"b", EventType::kCompile);
+  }
+  RecordEvent("Ungrouped", EventType::kOrdinary).End();
+  RecordCount("cache_hit", 2);
+  RecordCount("cache_hit");
+
+  auto &events = recorder.Events();
+  ASSERT_EQ(events.size(), 4U);
+  EXPECT_EQ(events[0].annotation_, "Lower");
+  EXPECT_EQ(events[0].group_, "group_a");
+  EXPECT_EQ(events[1].annotation_, "Codegen");
+  EXPECT_EQ(events[1].group_, "group_b");
+  EXPECT_EQ(events[2].group_, "group_a");
+  EXPECT_EQ(events[3].group_, "");
+  EXPECT_LE(events[0].start_, events[1].start_);
+  EXPECT_EQ(recorder.Counters().at("cache_hit"), 3);
+
+  std::string json = HostEventRecorder::Json();
+  LOG(INFO) << json;
+  EXPECT_NE(json.find("\"wall_time_ms\": "), std::string::npos);
+  EXPECT_NE(json.find("\"counters\": {\"cache_hit\": 3}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"group_a\": {\"Lower\": "), std::string::npos);
+  EXPECT_NE(json.find("\"group_b\": {\"Codegen\": "), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"a\\\"b\""), std::string::npos);
+
+  std::string trace = HostEventRecorder::ChromeTrace();
+  EXPECT_NE(trace.find("\"traceEvents\": ["), std::string::npos);
+  EXPECT_NE(trace.find("\"name\": \"Ungrouped\", \"cat\": \"Ordinary\", "
+                       "\"ph\": \"X\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"args\": {\"group\": \"group_b\"}"),
+            std::string::npos);
+
+  const std::string dir = "./cinn_compile_report_test";
+  std::filesystem::remove_all(dir);
+  HostEventRecorder::Dump(dir);
+  const std::string prefix =
+      dir + "/cinn_compile_" + std::to_string(getpid()) + "_0";
+  EXPECT_TRUE(std::filesystem::exists(prefix + "_report.json"));
+  EXPECT_TRUE(std::filesystem::exists(prefix + "_trace.json"));
+  std::filesystem::remove_all(dir);
+
+  recorder.Clear();
+  EXPECT_EQ(events.size(), 0U);
+  EXPECT_TRUE(recorder.Counters().empty());
+}
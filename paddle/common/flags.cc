@@ -50,6 +50,22 @@ PHI_DEFINE_EXPORTED_int32(paddle_num_threads,
                           1,
                           "Number of threads for each paddle instance.");
 
+/**
+ * Paddle initialization related FLAG
+ * Name: FLAGS_intra_op_threadpool_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_intra_op_threadpool_size=8, run the parallel loops of the
+ * CPU kernels with at most 8 threads in total.
+ * Note: The number of threads each instance uses is still limited by its
+ *       paddle_num_threads or cpu_math_library_num_threads. 0 sets it to
+ *       the number of hardware threads.
+ */
+PHI_DEFINE_EXPORTED_int32(intra_op_threadpool_size,
+                          0,
+                          "Number of threads shared by the parallel loops of "
+                          "the CPU kernels.");
+
 /**
  * Low Precision Op related FLAG
  * Name: FLAGS_low_precision_op_list
@@ -102,6 +118,25 @@ PHI_DEFINE_EXPORTED_int32(
     0,
     "Setting the check and print level when FLAGS_check_nan_inf is set.");
 
+/**
+ * Operator related FLAG
+ * Name: FLAGS_check_nan_inf_deferred_steps
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_check_nan_inf_deferred_steps=100
+ * Note: Used to debug. If > 0 when FLAGS_check_nan_inf is set, the tensors on
+ * GPU are checked with no sync of the device, recording the first tensor
+ * holding NAN/INF on the device. The records are checked on the host every
+ * FLAGS_check_nan_inf_deferred_steps runs of the executor, and by
+ * paddle.amp.debugging.check_deferred_nan_inf(), reported by
+ * FLAGS_check_nan_inf_level like the checks of the tensors.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    check_nan_inf_deferred_steps,
+    0,
+    "The number of steps between the checks of the NAN/INF recorded on GPU "
+    "when FLAGS_check_nan_inf is set, 0 means to check every tensor at once.");
+
 /**
  * Operator related FLAG
  * Name: FLAGS_check_nan_inf
@@ -213,6 +248,21 @@ PHI_DEFINE_EXPORTED_bool(
     true,
     "Whether enable api kernel fallback to CPU one when not found");
 
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_enable_kernel_selection_cache
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_enable_kernel_selection_cache=false would select the kernel
+ * by KernelFactory in every call of the generated apis
+ * Note: The generated apis keep the last selected kernels of a thread, and
+ * reuse them while the kernel key is unchanged.
+ */
+PHI_DEFINE_EXPORTED_bool(enable_kernel_selection_cache,
+                         true,
+                         "Whether the generated apis cache the kernels they "
+                         "select.");
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 /**
  * CUDNN related FLAG
@@ -374,6 +424,48 @@ PHI_DEFINE_EXPORTED_bool(
 PHI_DEFINE_EXPORTED_int32(communicator_send_queue_size,
                           20,
                           "queue size to recv gradient before send");
+
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_adaptive_sync
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_communicator_geo_adaptive_sync=true
+ * Note: In geo mode, adapt the number of merged sparse gradients before each
+ *       send, which is communicator_max_merge_var_num otherwise. It grows when
+ *       the parameters change little compared with
+ *       FLAGS_communicator_geo_target_delta_ratio or the sends get slower than
+ *       the fastest one, and shrinks otherwise, within
+ *       [FLAGS_communicator_geo_min_merge_var_num,
+ *        FLAGS_communicator_geo_max_merge_var_num].
+ */
+PHI_DEFINE_EXPORTED_bool(communicator_geo_adaptive_sync,
+                         false,
+                         "adapt the merge num of geo sparse send");
+PHI_DEFINE_EXPORTED_int32(communicator_geo_min_merge_var_num,
+                          1,
+                          "min merge num of adaptive geo sparse send");
+PHI_DEFINE_EXPORTED_int32(communicator_geo_max_merge_var_num,
+                          200,
+                          "max merge num of adaptive geo sparse send");
+PHI_DEFINE_EXPORTED_double(
+    communicator_geo_target_delta_ratio,
+    0.01,
+    "target ratio of the delta norm to the param norm of a geo sparse send");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_skip_delta_ratio
+ * Since Version: 3.0.0
+ * Value Range: double, default=0.0
+ * Example: FLAGS_communicator_geo_skip_delta_ratio=0.001
+ * Note: In geo mode, a sparse row whose delta norm is at most this ratio of
+ *       its param norm is not sent. Its delta keeps accumulating and is sent
+ *       when the row is updated again and the delta is large enough. 0 sends
+ *       all the updated rows.
+ */
+PHI_DEFINE_EXPORTED_double(communicator_geo_skip_delta_ratio,
+                           0.0,
+                           "skip the geo sparse rows of small delta");
 #endif
 
 /**
@@ -879,6 +971,36 @@ PHI_DEFINE_EXPORTED_bool(graph_load_in_parallel,
                          "It controls whether load graph node and edge with "
                          "multi threads parallelly.");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_graph_compress_edges
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Control whether to keep the edges of each node sorted and delta
+ *       encoded after they are loaded, if it takes less memory. The edges
+ *       are sampled from the encoded form.
+ */
+PHI_DEFINE_EXPORTED_bool(graph_compress_edges,
+                         false,
+                         "It controls whether compress the loaded edges of "
+                         "each node by delta encoding.");
+
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_graph_sample_cache_memory_limit
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=0
+ * Example:
+ * Note: The bytes of the sample results kept by the neighbor sample cache of
+ *       the graph table, which then evicts them by CLOCK without locks.
+ *       If it is 0, the cache is bounded by cache_size_limit of the config.
+ */
+PHI_DEFINE_EXPORTED_uint64(graph_sample_cache_memory_limit,
+                           0,
+                           "The bytes of the neighbor sample cache of the "
+                           "graph table, 0 means it is bounded by count.");
+
 /**
  * Distributed related FLAG
  * Name: FLAGS_enable_neighbor_list_use_uva
@@ -891,6 +1013,21 @@ PHI_DEFINE_EXPORTED_bool(enable_neighbor_list_use_uva,
                          false,
                          "It controls whether store neighbor_list with UVA");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_graph_weighted_sample_by_prefix_sum
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Control whether to keep the cumulative edge weights of each node in
+ * gpu graph mode, with which the weighted sampling of one neighbor, as in the
+ * random walks, is a binary search instead of a block top-k
+ */
+PHI_DEFINE_EXPORTED_bool(graph_weighted_sample_by_prefix_sum,
+                         false,
+                         "It controls whether to sample one weighted neighbor "
+                         "by the binary search of the cumulative weights");
+
 /**
  * Distributed related FLAG
  * Name: FLAGS_graph_neighbor_size_percent
@@ -1063,6 +1200,33 @@ PHI_DEFINE_EXPORTED_int64(
     cinn_compile_thread_num,
     -1,
     "It controls how many thread numbers applying compilation cache.");
+/*
+ * CINN related FLAG
+ * Name: FLAGS_cinn_compile_cache_dir
+ * Since Version: 3.0
+ * Value Range: string, default=""
+ * Example: FLAGS_cinn_compile_cache_dir="/tmp/cinn_cache" would save the
+ * compiled kernels into /tmp/cinn_cache and load them in the later processes,
+ * instead of compiling them again.
+ */
+PHI_DEFINE_EXPORTED_string(
+    cinn_compile_cache_dir,
+    "",
+    "The directory of the persistent cinn compilation cache, which is "
+    "disabled if it is empty.");
+/*
+ * CINN related FLAG
+ * Name: FLAGS_cinn_async_compile
+ * Since Version: 3.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_cinn_async_compile=true would generate and compile the code
+ * of the lowered fusion groups in background threads, and a cinn kernel waits
+ * for its compilation only when it is run for the first time.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    cinn_async_compile,
+    false,
+    "It controls whether to compile cinn kernels asynchronously.");
 /*
  * CINN related FLAG
  * Name: FLAGS_enable_interpretercore_launch_cinn
@@ -1178,6 +1342,52 @@ PHI_DEFINE_EXPORTED_double(
     "memory capacity while also attempting to minimize performance degradation "
     "caused by frequent memory synchronization.");
 
+/*
+ * CUDAMallocAsyncAllocator related FLAG
+ * Name: FLAGS_cuda_malloc_async_pool_release_threshold_mb
+ * Since Version: 3.0
+ * Value Range: int64, default=-1
+ * Note: The memory in MB freed into the cudaMallocAsync pool of a device that
+ * the pool keeps at the synchronizations, instead of returning it to the
+ * driver. A negative value leaves the threshold of the pool unchanged. The
+ * memory above it is still returned by paddle.device.cuda.empty_cache and
+ * by the predictors trimming the pool when idle.
+ */
+PHI_DEFINE_EXPORTED_int64(
+    cuda_malloc_async_pool_release_threshold_mb,
+    -1,
+    "The release threshold in MB of the cudaMallocAsync pool of each device, "
+    "a negative value leaves it unchanged.");
+
+/*
+ * CUDAMallocAsyncAllocator related FLAG
+ * Name: FLAGS_cuda_malloc_async_pool_peer_access
+ * Since Version: 3.0
+ * Value Range: bool, default=false
+ * Note: If true, the cudaMallocAsync pool of each device is mapped to the
+ * peer devices that can access it, so the tensors allocated from it can be
+ * read by the kernels on the other GPUs.
+ */
+PHI_DEFINE_EXPORTED_bool(cuda_malloc_async_pool_peer_access,
+                         false,
+                         "Whether to map the cudaMallocAsync pool of each "
+                         "device to its peer devices.");
+
+/*
+ * CUDA Graph / Allocator related FLAG
+ * Name: FLAGS_cuda_graph_use_cuda_malloc_async_allocator
+ * Since Version: 3.0
+ * Value Range: bool, default=false
+ * Note: If true and FLAGS_use_cuda_malloc_async_allocator is false, the
+ * allocations during the CUDA Graph capturing use the CUDAMallocAsyncAllocator,
+ * so they become the memory nodes of the graph sharing the pool of the device,
+ * instead of a private memory pool kept for each graph.
+ */
+PHI_DEFINE_EXPORTED_bool(cuda_graph_use_cuda_malloc_async_allocator,
+                         false,
+                         "Whether to use CUDAMallocAsyncAllocator during the "
+                         "CUDA Graph capturing.");
+
 /*
  * CUDA Graph / Allocator related FLAG
  * Name: FLAGS_auto_free_cudagraph_allocations_on_launch
@@ -1221,10 +1431,105 @@ PD_DEFINE_bool(enable_slotrecord_reset_shrink,  // NOLINT
 PD_DEFINE_bool(enable_ins_parser_file,  // NOLINT
                false,
                "enable parser ins file, default false");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_dataset_channel_shard_num
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_dataset_channel_shard_num=16 splits the input channel of
+ * the dataset and the channel of the SlotObjPool into 16 shards.
+ * Note: The sharded channel lets many reader and parser threads write and
+ * read it without contending on one mutex, the data is in order only within
+ * a shard. 1 uses the channel guarded by one mutex.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    dataset_channel_shard_num,
+    1,
+    "The shard num of the input channel of the dataset and the channel of "
+    "the SlotObjPool, 1 for the channel guarded by one mutex.");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_dataset_global_shuffle_max_inflight_msgs
+ * Since Version: 3.0.0
+ * Value Range: int32, default=4
+ * Example: FLAGS_dataset_global_shuffle_max_inflight_msgs=8 lets every
+ * global shuffle thread have 8 messages in flight to each trainer.
+ * Note: A thread waits for a trainer only when it has so many messages not
+ * yet received by the trainer, which bounds the memory of the messages.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    dataset_global_shuffle_max_inflight_msgs,
+    4,
+    "The max number of the messages of a global shuffle thread in flight to "
+    "a trainer.");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_hdfs_native_read
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_hdfs_native_read=true reads the hdfs files by the library of
+ * FLAGS_hdfs_native_lib.
+ * Note: The files with a converter other than cat, or with a customized
+ * download command, are still read by the hadoop command, as are all the
+ * files if the library can not be loaded.
+ */
+PHI_DEFINE_EXPORTED_bool(hdfs_native_read,
+                         false,
+                         "Read the hdfs files by the C api of libhdfs instead "
+                         "of the pipes of the hadoop command.");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_hdfs_native_lib
+ * Since Version: 3.0.0
+ * Value Range: string, default=libhdfs.so
+ * Example: FLAGS_hdfs_native_lib=/opt/libhdfs3/lib/libhdfs3.so
+ * Note: Any library exporting the C api of hdfs.h, such as libhdfs, libhdfs3
+ * or an afs sdk.
+ */
+PHI_DEFINE_EXPORTED_string(hdfs_native_lib,
+                           "libhdfs.so",
+                           "The library of FLAGS_hdfs_native_read.");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_hdfs_native_read_thread_num
+ * Since Version: 3.0.0
+ * Value Range: int32, default=4
+ * Example: FLAGS_hdfs_native_read_thread_num=8 reads every file by 8 threads.
+ * Note: The threads read two chunks each ahead of the reader of the file, so
+ * an open file holds up to 2 * thread_num * chunk_size bytes.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    hdfs_native_read_thread_num,
+    4,
+    "The number of the threads reading a file by FLAGS_hdfs_native_read.");
+
+/**
+ * Dataset related FLAG
+ * Name: FLAGS_hdfs_native_read_chunk_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=4194304
+ * Example: FLAGS_hdfs_native_read_chunk_size=8388608 reads a file by chunks of
+ * 8MB.
+ * Note: The size of a ranged read of FLAGS_hdfs_native_read.
+ */
+PHI_DEFINE_EXPORTED_int64(
+    hdfs_native_read_chunk_size,
+    4 * 1024 * 1024,
+    "The size in bytes of a read of a file by FLAGS_hdfs_native_read.");
 PHI_DEFINE_EXPORTED_bool(
     gpugraph_enable_hbm_table_collision_stat,
     false,
     "enable hash collisions stat for hbm table, default false");
+PHI_DEFINE_EXPORTED_bool(
+    gpugraph_enable_bucket_hbm_table,
+    false,
+    "use the bucketed open addressing hbm table, which probes by warp tiles, "
+    "supports erase and a load factor up to 0.9, default false");
 PHI_DEFINE_EXPORTED_bool(
     cache_inference_while_scope,
     false,
@@ -1273,6 +1578,11 @@ PHI_DEFINE_EXPORTED_bool(enable_all2all_use_fp16,
 PHI_DEFINE_EXPORTED_bool(enable_sparse_inner_gather,
                          false,
                          "enable sparse inner gather, default false");
+PHI_DEFINE_EXPORTED_int32(
+    gpugraph_inner_all2all_mode,
+    0,
+    "transport of the sparse inner gather, 0: peer copy, 1: nccl "
+    "all2all, 2: nccl all2all when not all gpus link by nvlink, default 0");
 PHI_DEFINE_EXPORTED_bool(gpugraph_debug_gpu_memory,
                          false,
                          "enable debug gpu memory, default false");
@@ -1291,6 +1601,30 @@ PHI_DEFINE_EXPORTED_bool(multi_node_sample_use_gpu_table,
                          true,
                          "Control whether to use gpu table in sample multi "
                          "machine in gpu graph mode");
+PHI_DEFINE_EXPORTED_int32(
+    gpugraph_pass_pipeline_depth,
+    1,
+    "the max number of passes waiting between the pull, the prepare and the "
+    "build stages of the pass pipeline, default 1");
+PHI_DEFINE_EXPORTED_uint64(
+    gpugraph_pass_pipeline_max_feasign,
+    0,
+    "the max number of feasigns of the passes from the pull stage to the end "
+    "of pass, which bounds the host memory of the pass pipeline, a pass is "
+    "pulled anyway if no other pass is in flight, default 0 for no limit");
+PHI_DEFINE_EXPORTED_bool(
+    gpugraph_incremental_pass_build,
+    false,
+    "build the keys surviving from the last pass with the values dumped from "
+    "hbm instead of the cpu table, and write the values back to the cpu "
+    "table asynchronously at the end of pass, default false");
+PHI_DEFINE_EXPORTED_uint64(
+    gpugraph_host_cache_capacity,
+    0,
+    "with gpugraph_incremental_pass_build, the max number of feasigns per "
+    "device and mf dim kept in host memory after they leave hbm, so that "
+    "they are built from host memory when they come back, default 0 keeps "
+    "the last pass only");
 
 /**
  * ProcessGroupNCCL related FLAG
@@ -1311,6 +1645,39 @@ PHI_DEFINE_EXPORTED_bool(benchmark_nccl,
                          "enable nccl debug mode to synchronize nccl comm");
 #endif
 
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: nccl_hierarchical_allreduce
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Run allreduce of ProcessGroupNCCL in two levels when the ranks of
+ * the group are on more than one node: reduce-scatter inside the node,
+ * allreduce across the nodes, then allgather inside the node. It is used
+ * for the messages whose size is in [nccl_hierarchical_allreduce_min_bytes,
+ * nccl_hierarchical_allreduce_max_bytes], other messages use the flat
+ * allreduce. With nccl_hierarchical_allreduce_local_size > 0, each run of
+ * that many consecutive ranks is seen as one node instead of the ranks
+ * with the same host name.
+ */
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+PHI_DEFINE_EXPORTED_bool(nccl_hierarchical_allreduce,
+                         false,
+                         "Whether to use the hierarchical allreduce of "
+                         "ProcessGroupNCCL on multiple nodes.");
+PHI_DEFINE_EXPORTED_int64(nccl_hierarchical_allreduce_min_bytes,
+                          1 << 20,
+                          "The min message size of hierarchical allreduce.");
+PHI_DEFINE_EXPORTED_int64(nccl_hierarchical_allreduce_max_bytes,
+                          64 << 20,
+                          "The max message size of hierarchical allreduce.");
+PHI_DEFINE_EXPORTED_int32(
+    nccl_hierarchical_allreduce_local_size,
+    0,
+    "The number of ranks on each node for hierarchical allreduce, 0 means "
+    "to find the nodes by the host names of the ranks.");
+#endif
+
 PHI_DEFINE_EXPORTED_bool(
     benchmark,
     false,
@@ -1323,6 +1690,158 @@ PHI_DEFINE_EXPORTED_bool(eager_communication_connection,
                          false,
                          "enable eager to create nccl comm");
 
+/**
+ * Parallel eager backward FLAG
+ * Name: FLAGS_eager_backward_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_eager_backward_num_threads=4
+ * Note: If > 1, the grad nodes of a backward whose dependencies are done run
+ * on a pool of this number of threads instead of one by one on the calling
+ * thread. The kernels of a device still run on its stream, so only the host
+ * side work of the nodes overlaps. The order the grads of a tensor are summed
+ * in is not fixed, so the results may differ in rounding between runs. Not
+ * used by paddle.grad, create_graph, nested backward and the backward with
+ * force sequential nodes. 0 or 1 means disabled.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_backward_num_threads,
+                          0,
+                          "The number of threads running the grad nodes of "
+                          "an eager backward, 0 or 1 means sequential.");
+
+/**
+ * Selective recompute of eager FLAG
+ * Name: FLAGS_eager_recompute_ops
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_eager_recompute_ops="softmax,silu", FLAGS_eager_recompute_ops
+ * ="all"
+ * Note: The ops whose saved forward outputs are dropped after the forward and
+ * recomputed from their saved inputs by the backward, separated by comma.
+ * "all" selects all the ops supporting it, i.e. the cheap elementwise ops and
+ * activations, the outputs of other ops like matmul are always kept. The
+ * memory is saved when the inputs are kept alive by the backward anyway.
+ * Empty means disabled.
+ */
+PHI_DEFINE_EXPORTED_string(eager_recompute_ops,
+                           "",
+                           "The ops whose saved outputs are recomputed by "
+                           "the eager backward, 'all' for all the supported "
+                           "ones.");
+
+/**
+ * Selective recompute of eager FLAG
+ * Name: FLAGS_eager_recompute_min_bytes
+ * Since Version: 3.0.0
+ * Value Range: int64, default=1048576
+ * Example: FLAGS_eager_recompute_min_bytes=0, recompute all the outputs of the
+ * ops selected by FLAGS_eager_recompute_ops
+ * Note: The saved outputs smaller than this are kept even if their ops are
+ * selected by FLAGS_eager_recompute_ops.
+ */
+PHI_DEFINE_EXPORTED_int64(eager_recompute_min_bytes,
+                          1 << 20,
+                          "The min bytes of a saved output recomputed by the "
+                          "eager backward.");
+
+/**
+ * Activation offload of eager FLAG
+ * Name: FLAGS_eager_activation_offload_budget_mb
+ * Since Version: 3.0.0
+ * Value Range: int64, default=-1
+ * Example: FLAGS_eager_activation_offload_budget_mb=4096, the first 4GB of
+ * the activations saved by a forward stay on the GPU, the later ones are
+ * offloaded
+ * Note: If >= 0, the activations saved for the backward beyond this budget are
+ * copied to pinned host memory on a side stream, so their GPU memory is freed
+ * once the forward does not use them anymore. They are prefetched back during
+ * the backward, see FLAGS_eager_activation_offload_prefetch_num. The budget is
+ * reset at the end of each backward. -1 means disabled.
+ */
+PHI_DEFINE_EXPORTED_int64(eager_activation_offload_budget_mb,
+                          -1,
+                          "The MB of saved activations kept on the GPU by a "
+                          "forward, the others are offloaded to pinned host "
+                          "memory, -1 means disabled.");
+
+/**
+ * Activation offload of eager FLAG
+ * Name: FLAGS_eager_activation_offload_prefetch_num
+ * Since Version: 3.0.0
+ * Value Range: int32, default=2
+ * Example:
+ * Note: The number of offloaded activations being copied back ahead of the
+ * grad nodes needing them, larger value hides more copy time at the cost of
+ * GPU memory.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_activation_offload_prefetch_num,
+                          2,
+                          "The number of offloaded activations prefetched "
+                          "by the eager backward.");
+
+/**
+ * Tensor eviction of eager FLAG
+ * Name: FLAGS_eager_evict_tensors_on_oom
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If true, when a GPU allocation fails, the least recently used
+ * evictable tensors, i.e. the activations saved for the backward and the
+ * tensors marked by Tensor._set_evictable, are evicted to pinned host memory
+ * before the allocation is retried. They are paged back once a kernel takes
+ * them as inputs.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_evict_tensors_on_oom,
+                         false,
+                         "Whether to evict the evictable tensors to pinned "
+                         "host memory when the GPU runs out of memory.");
+
+/**
+ * Lazy mode of eager FLAG
+ * Name: FLAGS_eager_lazy_mode
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If true, the eager ops without grad supported by egr::LazyRecorder
+ * are recorded into a PIR program instead of being run one by one. The
+ * program is compiled, cached by its structure and run by the PIR
+ * interpreter at the next sync point, e.g. Tensor.numpy(), an op that is not
+ * recorded or FLAGS_eager_lazy_mode_max_ops recorded ops.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_lazy_mode,
+                         false,
+                         "Whether to record the eager ops into PIR programs "
+                         "run at the sync points.");
+
+/**
+ * Lazy mode of eager FLAG
+ * Name: FLAGS_eager_lazy_mode_max_ops
+ * Since Version: 3.0.0
+ * Value Range: int64, default=256
+ * Example:
+ * Note: The number of ops recorded by the lazy mode of eager before they are
+ * run, which bounds the memory held by the pending inputs.
+ */
+PHI_DEFINE_EXPORTED_int64(eager_lazy_mode_max_ops,
+                          256,
+                          "The max number of eager ops recorded before they "
+                          "are run.");
+
+/**
+ * Managed memory placement FLAG
+ * Name: FLAGS_managed_memory_prefetch_limit_mb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=4096
+ * Example:
+ * Note: The tensors placed in managed memory up to this size are preferred
+ * on the device and prefetched before the instructions reading them. The
+ * larger ones are preferred on the host and read remotely by the device.
+ */
+PHI_DEFINE_EXPORTED_uint64(managed_memory_prefetch_limit_mb,
+                           4096,
+                           "The max size in MB of the tensors in managed "
+                           "memory prefetched to the device.");
+
 /**
  * Autotune related FLAG
  * Name: FLAGS_use_autotune
@@ -1332,6 +1851,50 @@ PHI_DEFINE_EXPORTED_bool(eager_communication_connection,
  */
 PHI_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
 
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_file
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_autotune_cache_file=/path/to/autotune.cache
+ * Note: If set, the algorithms of cuBLASLt matmul, cuDNN conv and the
+ * autotuned CUTLASS kernels searched by autotune are loaded from the file at
+ * startup, and written back to it at the end of the tuning range. The file
+ * is only loaded on the same GPU model with the same CUDA and cuDNN versions
+ * it was written on, and can be shared between training and inference.
+ */
+PHI_DEFINE_EXPORTED_string(autotune_cache_file,
+                           "",
+                           "The file to persist the autotune results in.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_read_only
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_autotune_cache_read_only=true
+ * Note: If true, the algorithms are only taken from FLAGS_autotune_cache_file,
+ * none is searched in the tuning range and the file is never written, e.g.
+ * for the production jobs sharing a file tuned before.
+ */
+PHI_DEFINE_EXPORTED_bool(autotune_cache_read_only,
+                         false,
+                         "Whether to only use the autotune cache file.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_share_cache
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_autotune_share_cache=true
+ * Note: If true in a job of several trainers, only the trainer of rank 0
+ * searches the algorithms in the tuning range, and sends them to the others
+ * through the global TCP store at the end of the range.
+ */
+PHI_DEFINE_EXPORTED_bool(autotune_share_cache,
+                         false,
+                         "Whether rank 0 autotunes for all the ranks.");
+
 /**
  * CINN training related FLAG
  * Name: FLAGS_disable_dyshape_in_train
@@ -1406,6 +1969,22 @@ PHI_DEFINE_EXPORTED_bool(
     true,
     "Whether enable use append iters transform in cinn fusion.");
 
+/**
+ * CINN horizontal fusion cost FLAG
+ * Name: FLAGS_cinn_horizontal_fusion_max_registers
+ * Since Version: 3.0 beta
+ * Value Range: int64, default=128
+ * Example: FLAGS_cinn_horizontal_fusion_max_registers=64 would not fuse the
+ * independent patterns horizontally when the fused kernel is estimated to
+ * need more than 64 registers per thread. A non-positive value disables the
+ * estimate.
+ */
+PHI_DEFINE_EXPORTED_int64(
+    cinn_horizontal_fusion_max_registers,
+    128,
+    "The estimated registers per thread of a horizontally fused kernel "
+    "in cinn, above which the patterns are not fused.");
+
 /**
  * Conv Search cache max number related FLAG
  * Name: FLAGS_search_cache_max_number
@@ -1506,6 +2085,36 @@ PHI_DEFINE_EXPORTED_bool(trt_ibuilder_cache,
                          false,
                          "Add a persistent ibuilder.");
 
+/**
+ * TensorRT related FLAG
+ * Name: trt_async_engine_build
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the TensorRT engines which are not loaded from the
+ * serialized cache are built in a background thread after the predictor is
+ * created, and the subgraphs run on the native kernels until their engines
+ * are ready.
+ */
+PHI_DEFINE_EXPORTED_bool(trt_async_engine_build,
+                         false,
+                         "Build the TensorRT engines in the background.");
+
+/**
+ * TensorRT related FLAG
+ * Name: trt_cuda_graph_cache_capacity
+ * Since Version: 3.0.0
+ * Value Range: int32, default=8
+ * Example:
+ * Note: The max number of the CUDA graphs of a TensorRT engine, each of which
+ * is captured for a different shape of the inputs, and the least recently
+ * used one is destroyed to capture a new one.
+ */
+PHI_DEFINE_EXPORTED_int32(trt_cuda_graph_cache_capacity,
+                          8,
+                          "The max number of the CUDA graphs captured for "
+                          "the input shapes of a TensorRT engine.");
+
 /**
  * mmap_allocator related FLAG
  * Name: use_shm_cache
@@ -1532,6 +2141,21 @@ PHI_DEFINE_EXPORTED_bool(dataloader_use_file_descriptor,
                          false,
                          "Use file descriptor in mmap_allocator.");
 
+/**
+ * cuda_ipc_allocator related FLAG
+ * Name: cuda_ipc_arena_size_mb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=0
+ * Example: FLAGS_cuda_ipc_arena_size_mb=1024
+ * Note: If greater than 0, the GPU tensors passed to other processes are
+ * copied into an arena of this size exported once, and sent as offsets in
+ * it, instead of opening an IPC handle for each tensor.
+ */
+PHI_DEFINE_EXPORTED_uint64(cuda_ipc_arena_size_mb,
+                           0,
+                           "The size of the CUDA IPC arena in MB, 0 disables "
+                           "it.");
+
 /**
  * Tensor operants related FLAG
  * Name: tensor_operants_mode
@@ -1628,10 +2252,123 @@ PHI_DEFINE_EXPORTED_bool(pir_apply_inplace_pass,
                          "Whether to apply inplace pass on lowering "
                          "::pir::Program to Kernel Dialect");
 
+/**
+ * Remove the redundant transfer ops of PIR FLAG
+ * Name: pir_remove_redundant_transfer
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: If True, the duplicated transfers of a value and the round trips of
+ * memcpy and cast are removed after lowering ::pir::Program to Kernel Dialect.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_remove_redundant_transfer,
+                         true,
+                         "Whether to remove the redundant transfer ops after "
+                         "lowering ::pir::Program to Kernel Dialect");
+
+/**
+ * Hoist the loop invariant ops of the while ops of PIR FLAG
+ * Name: pir_while_hoist_invariant
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the ops of the body of a while op computing the same tensors
+ * in every iteration are moved before the while op after lowering
+ * ::pir::Program to Kernel Dialect, so that they run once per loop.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_while_hoist_invariant,
+                         false,
+                         "Whether to hoist the loop invariant ops out of the "
+                         "while ops after lowering ::pir::Program to Kernel "
+                         "Dialect");
+
+/**
+ * Keep the buffers of the body of a while op FLAG
+ * Name: while_reuse_body_buffers
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the intermediate tensors of the body of a while op, neither
+ * carried to the next iteration nor aliased by another tensor, are not
+ * garbage collected, and their memory is reused by the next iteration.
+ */
+PHI_DEFINE_EXPORTED_bool(while_reuse_body_buffers,
+                         false,
+                         "Whether to keep the intermediate tensors of the body "
+                         "of a while op allocated across the iterations");
+
 PHI_DEFINE_EXPORTED_string(
     ir_inplace_kernel_blacklist,
     "",
     "It controls the ir inplace kernel subset do not use.");
+
+/**
+ * Static memory plan of PirInterpreter FLAG
+ * Name: pir_static_memory_plan_buckets
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_pir_static_memory_plan_buckets=4
+ * Note: If > 0, the PirInterpreter running in trace mode plans the
+ * intermediate dense tensors of the kernel program into one preallocated
+ * arena per shape bucket of its inputs, at most this number of buckets are
+ * planned. 0 means disabled.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_static_memory_plan_buckets,
+                          0,
+                          "The max number of input shape buckets planned "
+                          "into static arenas by PirInterpreter, 0 means "
+                          "disabled.");
+
+/**
+ * Managed memory prefetch of PirInterpreter FLAG
+ * Name: pir_managed_prefetch_lookahead
+ * Since Version: 3.0.0
+ * Value Range: int32, default=2
+ * Example: FLAGS_pir_managed_prefetch_lookahead=4
+ * Note: The PirInterpreter running in trace mode prefetches the inputs in
+ * managed memory of the instruction this number of instructions ahead of the
+ * running one, see ManagedMemoryAdvisor. 0 means disabled.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_managed_prefetch_lookahead,
+                          2,
+                          "The number of instructions ahead whose inputs in "
+                          "managed memory are prefetched by PirInterpreter, "
+                          "0 means disabled.");
+
+/**
+ * Critical path scheduling of PirInterpreter FLAG
+ * Name: pir_critical_path_scheduling
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the ready instructions of the same scheduling priority are
+ * dispatched by their bottom level, i.e. the latency of their longest path to
+ * a sink in the dependency graph, the latency of every instruction is
+ * profiled in the run after the build one.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_critical_path_scheduling,
+                         false,
+                         "Whether PirInterpreter dispatches the instructions "
+                         "on the critical path first.");
+
+/**
+ * Automatic CUDA Graph of PirInterpreter FLAG
+ * Name: pir_auto_cuda_graph_max_graphs
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_pir_auto_cuda_graph_max_graphs=8
+ * Note: If > 0, after a warm-up run of every distinct shape signature of the
+ * feeds, PirInterpreter captures its instructions into a CUDA Graph and
+ * replays it for the later runs of the same signature, at most this number of
+ * the most recently used graphs are kept. Only works when all the feeds are on
+ * the GPU and all the instructions launch on its default stream, the shapes
+ * and the host side work of the instructions must not depend on the values of
+ * the feeds. 0 means disabled.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_auto_cuda_graph_max_graphs,
+                          0,
+                          "The max number of CUDA Graphs automatically "
+                          "captured by PirInterpreter, 0 means disabled.");
 /**
  * Specify the directory of saving PIR subgraph from @to_static
  * Name: pir_subgraph_saving_dir
@@ -1671,6 +2408,20 @@ PHI_DEFINE_EXPORTED_bool(print_ir, false, "Whether print ir debug str.");
 PHI_DEFINE_EXPORTED_bool(pir_debug,
                          false,
                          "Whether print more pir debug info.");
+
+/**
+ * PIR related FLAG
+ * Name: FLAGS_pir_pass_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_pir_pass_num_threads=8
+ * Note: The number of threads a pir::PassManager runs the nested pipeline on
+ *       the sibling ops of a block, only used when all its passes are op
+ *       local. 1 runs the passes sequentially.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_pass_num_threads,
+                          1,
+                          "Number of threads to run the op local pir passes.");
 PHI_DEFINE_EXPORTED_bool(
     prim_skip_dynamic,
     true,
@@ -1724,6 +2475,49 @@ PHI_DEFINE_EXPORTED_bool(enable_async_trace,
 
 PHI_DEFINE_EXPORTED_int32(async_trace_count, 5, "collective async trace count");
 
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: enable_comm_perf_trace
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Record the device time, message size and bandwidth of each
+ * collective of ProcessGroupNCCL. The collectives are exported to the
+ * profiler when it is enabled. The mean time of the collectives of every
+ * comm_perf_trace_window collectives is compared across the ranks of the
+ * group to find the straggler ranks, a rank that arrives late at the
+ * collectives waits less than the others in them. A rank whose mean time is
+ * less than comm_perf_straggler_ratio of the median of the group is
+ * reported as a straggler.
+ */
+PHI_DEFINE_EXPORTED_bool(enable_comm_perf_trace,
+                         false,
+                         "enable collective performance trace");
+
+PHI_DEFINE_EXPORTED_int32(comm_perf_trace_window,
+                          200,
+                          "number of collectives in a window of the "
+                          "collective performance trace");
+
+PHI_DEFINE_EXPORTED_double(comm_perf_straggler_ratio,
+                           0.5,
+                           "ratio of the mean collective time to the median "
+                           "of the group under which a rank is a straggler");
+
+/**
+ * TCPStore related FLAG
+ * Name: tcp_store_server_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=4
+ * Example:
+ * Note: Number of the worker threads of the TCPStore master that serve the
+ * connected sockets, the listen socket is served by another thread. Only
+ * used on Linux.
+ */
+PHI_DEFINE_EXPORTED_int32(tcp_store_server_threads,
+                          4,
+                          "number of the worker threads of TCPStore master");
+
 PHI_DEFINE_EXPORTED_bool(
     use_auto_growth_pinned_allocator,
     false,
@@ -1986,6 +2780,98 @@ PHI_DEFINE_EXPORTED_bool(enable_auto_parallel_align_mode,
                          false,
                          "Enable align mode for auto parallel");
 
+/**
+ * Auto parallel related FLAG
+ * Name: enable_chunked_reshard
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_enable_chunked_reshard=true
+ * Note: Reshard from shard to replicated and from partial to shard on GPU in
+ * chunks, so that the collective of a chunk overlaps the concat or transpose
+ * of the previous chunk. The number of chunks is chosen by a cost model.
+ */
+PHI_DEFINE_EXPORTED_bool(enable_chunked_reshard,
+                         false,
+                         "Enable chunked reshard in auto parallel");
+
+/**
+ * Auto parallel related FLAG
+ * Name: chunked_reshard_max_chunks
+ * Since Version: 3.0.0
+ * Value Range: int32, default=4
+ * Example: FLAGS_chunked_reshard_max_chunks=8
+ * Note: The max number of chunks of the chunked reshard.
+ */
+PHI_DEFINE_EXPORTED_int32(chunked_reshard_max_chunks,
+                          4,
+                          "The max number of chunks of the chunked reshard");
+
+/**
+ * Auto parallel related FLAG
+ * Name: param_prefetch_depth
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_param_prefetch_depth=2
+ * Note: The number of the reshards of the sharded parameters, registered by
+ * sharding stage 3, launched on the comm stream ahead of their use, in the
+ * order of the last step. 0 means no prefetch.
+ */
+PHI_DEFINE_EXPORTED_int32(param_prefetch_depth,
+                          0,
+                          "The number of parameter reshards prefetched");
+
+/**
+ * Auto parallel related FLAG
+ * Name: param_prefetch_max_mb
+ * Since Version: 3.0.0
+ * Value Range: int64, default=2048
+ * Example: FLAGS_param_prefetch_max_mb=1024
+ * Note: The max MB of the prefetched parameters not used yet.
+ */
+PHI_DEFINE_EXPORTED_int64(param_prefetch_max_mb,
+                          2048,
+                          "The max MB of the prefetched parameters");
+
+/**
+ * Collective related FLAG
+ * Name: gloo_allreduce_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_gloo_allreduce_threads=4
+ * Note: The number of chunks of a large allreduce of ProcessGroupGloo run in
+ * parallel, each by a thread on its own gloo context and sockets. 1 means
+ * the allreduce of gloo as is.
+ */
+PHI_DEFINE_EXPORTED_int32(gloo_allreduce_threads,
+                          1,
+                          "The number of threads of a gloo allreduce");
+
+/**
+ * Collective related FLAG
+ * Name: gloo_shm_allreduce
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_gloo_shm_allreduce=true
+ * Note: If all the ranks of a ProcessGroupGloo are on one host, reduce
+ * through a shared memory segment instead of the sockets of gloo.
+ */
+PHI_DEFINE_EXPORTED_bool(gloo_shm_allreduce,
+                         false,
+                         "Allreduce through shared memory on one host");
+
+/**
+ * Collective related FLAG
+ * Name: gloo_shm_buffer_mb
+ * Since Version: 3.0.0
+ * Value Range: int32, default=32
+ * Example: FLAGS_gloo_shm_buffer_mb=64
+ * Note: The MB of the shared memory of a rank for FLAGS_gloo_shm_allreduce,
+ * a tensor larger than it is reduced piece by piece.
+ */
+PHI_DEFINE_EXPORTED_int32(gloo_shm_buffer_mb,
+                          32,
+                          "The MB of the shared memory of a rank");
+
 /**
  * fused_multi_transformer_op related FLAG
  * Name: fused_multi_transformer_op_use_mbfmha
@@ -2006,3 +2892,163 @@ PHI_DEFINE_EXPORTED_int64(multi_block_attention_min_partition_size,
 PHI_DEFINE_EXPORTED_bool(save_cf_stack_op,
                          false,
                          "Save cf stack op for higher-order derivatives.");
+
+/**
+ * IO related FLAG
+ * Name: param_file_load_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=8
+ * Example: FLAGS_param_file_load_threads=16
+ * Note: The number of threads reading the tensors of a parameter file, saved
+ * by save_param_file, to their places.
+ */
+PHI_DEFINE_EXPORTED_int32(param_file_load_threads,
+                          8,
+                          "The number of threads loading a parameter file");
+
+/**
+ * Sparse conv related FLAG
+ * Name: sparse_conv_rulebook_cache_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_sparse_conv_rulebook_cache_size=64
+ * Note: The number of rulebooks of the sparse convs without a key kept on
+ * GPU, found again by the indices tensor and the config of a conv, so that
+ * the convs on the same indices build the rulebook once. The indices are
+ * assumed not to be written in place. 0 means no cache.
+ */
+PHI_DEFINE_EXPORTED_int32(sparse_conv_rulebook_cache_size,
+                          0,
+                          "The number of rulebooks of the sparse convs kept "
+                          "for the convs on the same indices");
+
+/**
+ * Dropout related FLAG
+ * Name: use_device_rng_state_dropout
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_device_rng_state_dropout=true
+ * Note: Whether fused_bias_dropout_residual_layer_norm draws with the seed and
+ * the offset kept on the device of each stream and advanced by the kernel,
+ * instead of the offset of the generator advanced on the host, so that the
+ * dropout captured in a CUDA graph draws new numbers on every replay.
+ */
+PHI_DEFINE_EXPORTED_bool(use_device_rng_state_dropout,
+                         false,
+                         "Whether the fused dropout draws with the RNG state "
+                         "kept on the device");
+
+/**
+ * oneDNN related FLAG
+ * Name: onednn_primitive_cache_capacity
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_onednn_primitive_cache_capacity=1024
+ * Note: The number of the oneDNN primitives and primitive descriptors of the
+ * caching handlers kept in a process-wide cache, shared by all the threads and
+ * the cloned predictors, with the least recently used ones evicted. 0 keeps
+ * them in the per-thread blob map of OneDNNContext.
+ */
+PHI_DEFINE_EXPORTED_int32(onednn_primitive_cache_capacity,
+                          0,
+                          "The number of the oneDNN primitives kept in the "
+                          "process-wide cache shared by the threads");
+
+/**
+ * Executor related FLAG
+ * Name: interpretercore_shared_build_capacity
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_interpretercore_shared_build_capacity=64
+ * Note: The number of the programs of to_static, with the same ops and
+ * attributes whatever the dims of their values, whose instruction dependencies
+ * and stream events are shared by the interpreters built for the programs of
+ * the other input shapes, with the least recently used ones evicted. 0 builds
+ * them for every program.
+ */
+PHI_DEFINE_EXPORTED_int32(interpretercore_shared_build_capacity,
+                          0,
+                          "The number of the programs of to_static whose "
+                          "build results are shared across input shapes");
+
+/**
+ * AMP related FLAG
+ * Name: eager_amp_cast_cache
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_eager_amp_cast_cache=true
+ * Note: Whether the auto cast of the eager mode reuses the cast of a tensor to
+ * a dtype made for another op, while neither the tensor nor its cast has been
+ * changed in place, instead of casting it again for every op. The casts are
+ * kept until the outermost paddle.amp.auto_cast exits.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_amp_cast_cache,
+                         false,
+                         "Whether the auto cast of the eager mode reuses the "
+                         "cast of a tensor made for another op");
+
+/**
+ * Executor related FLAG
+ * Name: xpu_enable_multi_stream
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_xpu_enable_multi_stream=true
+ * Note: Whether the executor runs the XPU ops on the streams of their
+ * execution_stream, and the communications of BKCL on the stream of their
+ * communicator, synchronized by events as on GPU. Otherwise all of them run
+ * on the default stream of the XPU.
+ */
+PHI_DEFINE_EXPORTED_bool(xpu_enable_multi_stream,
+                         false,
+                         "Whether the executor runs the XPU ops and the BKCL "
+                         "communications on multiple streams");
+
+/**
+ * FFT related FLAG
+ * Name: fft_plan_reuse_across_batch
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_fft_plan_reuse_across_batch=true
+ * Note: Whether an FFT on GPU splits its batch into batches of powers of two,
+ * e.g. 13 into 8, 4 and 1, each executed by the cached plan of that batch.
+ * The plans are then shared by all the batch sizes of a signal instead of
+ * being created for each of them, at the cost of up to one execution per
+ * bit of the batch size.
+ */
+PHI_DEFINE_EXPORTED_bool(fft_plan_reuse_across_batch,
+                         false,
+                         "Whether an FFT on GPU reuses the cached plans of "
+                         "batches of powers of two for any batch size");
+
+/**
+ * Executor related FLAG
+ * Name: pir_build_instruction_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_pir_build_instruction_threads=8
+ * Note: The number of threads the PirInterpreter builds the phi kernel
+ * instructions of a program on, selecting their kernels and setting up their
+ * contexts. Each instruction is built into its own slot, so the instruction
+ * list is the same for any number of threads. 1 builds them on the calling
+ * thread.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_build_instruction_threads,
+                          1,
+                          "The number of threads the PirInterpreter builds "
+                          "the phi kernel instructions on");
+
+/**
+ * Executor related FLAG
+ * Name: tensor_array_contiguous_storage
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_tensor_array_contiguous_storage=true
+ * Note: Whether array_write appends the tensors of the same dims to the rows
+ * of one buffer of a TensorArray, doubled when it is full, instead of
+ * allocating each of them. array_to_tensor on axis 0 then copies the rows at
+ * once instead of stacking the tensors.
+ */
+PHI_DEFINE_EXPORTED_bool(tensor_array_contiguous_storage,
+                         false,
+                         "Whether array_write appends the tensors of the "
+                         "same dims to one buffer of a TensorArray");
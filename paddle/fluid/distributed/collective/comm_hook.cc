@@ -0,0 +1,317 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/comm_hook.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <tuple>
+
+namespace paddle {
+namespace distributed {
+
+static phi::DenseTensor *GetDenseTensor(const Tensor &tensor) {
+  return std::dynamic_pointer_cast<phi::DenseTensor>(tensor.impl()).get();
+}
+
+static std::shared_ptr<ProcessGroup::Task> AllReduceInPlace(
+    const Tensor &tensor, ProcessGroup *process_group) {
+  distributed::AllreduceOptions opts;
+  opts.reduce_op = ReduceOp::SUM;
+  auto *dense_tensor = GetDenseTensor(tensor);
+  return process_group->AllReduce(
+      dense_tensor, *dense_tensor, opts, /*sync_op=*/false);
+}
+
+static std::shared_ptr<ProcessGroup::Task> AllGather(
+    const Tensor &in, Tensor *out, ProcessGroup *process_group) {
+  return process_group->AllGather(
+      GetDenseTensor(*out), *GetDenseTensor(in), /*sync_op=*/false);
+}
+
+// Allreduce in float16 or bfloat16, which halves the traffic of float32
+// gradients.
+class CastCommHook : public EagerCommHook {
+ public:
+  explicit CastCommHook(phi::DataType comm_dtype) : comm_dtype_(comm_dtype) {}
+
+  std::shared_ptr<ProcessGroup::Task> Run(
+      EagerGroup *group, ProcessGroup *process_group) override {
+    if (group->dtype_ != phi::DataType::FLOAT32) {
+      return AllReduceInPlace(group->dense_contents_, process_group);
+    }
+    // The gradient has been divided by nranks, so the sum of float16 can
+    // hardly overflow.
+    comm_contents_ =
+        paddle::experimental::cast(group->dense_contents_, comm_dtype_);
+    group->dense_contents_.reset();
+    return AllReduceInPlace(comm_contents_, process_group);
+  }
+
+  void Finalize(EagerGroup *group) override {
+    if (!comm_contents_.initialized()) {
+      return;
+    }
+    group->dense_contents_ =
+        paddle::experimental::cast(comm_contents_, group->dtype_);
+    comm_contents_.reset();
+  }
+
+  std::string Type() const override {
+    return comm_dtype_ == phi::DataType::FLOAT16 ? "fp16" : "bf16";
+  }
+
+ private:
+  phi::DataType comm_dtype_;
+  Tensor comm_contents_;
+};
+
+// PowerSGD (Vogels et al., 2019) on the whole group. The fused gradient of
+// n elements is viewed as a matrix M of rows x cols, rows = ceil(sqrt(n)),
+// padded with zeros, and approximated by P * Q^T of the given rank:
+//   P = allreduce(M * Q), P = orthogonalize(P), Q = allreduce(M^T * P).
+// Q is reused by the next iteration, so one power iteration per step is
+// enough. Only (rows + cols) * rank elements are sent instead of n.
+class PowerSGDCommHook : public EagerCommHook {
+ public:
+  PowerSGDCommHook(int64_t rank, int64_t start_iter)
+      : rank_(rank), start_iter_(start_iter) {}
+
+  std::shared_ptr<ProcessGroup::Task> Run(
+      EagerGroup *group, ProcessGroup *process_group) override {
+    const int64_t numel = group->all_length_;
+    if (rows_ == 0) {
+      rows_ = static_cast<int64_t>(std::ceil(std::sqrt(numel)));
+      cols_ = (numel + rows_ - 1) / rows_;
+    }
+    ++iter_;
+    compressed_ = iter_ > start_iter_ && (rows_ + cols_) * rank_ < numel;
+    if (!compressed_) {
+      return AllReduceInPlace(group->dense_contents_, process_group);
+    }
+
+    auto place = group->dense_contents_.place();
+    Tensor input = group->dense_contents_;
+    if (input.dtype() != phi::DataType::FLOAT32) {
+      input = paddle::experimental::cast(input, phi::DataType::FLOAT32);
+    }
+    if (error_.initialized()) {
+      input = paddle::experimental::add(input, error_);
+    }
+    input_ = input;
+    group->dense_contents_.reset();
+
+    Tensor matrix = input;
+    if (rows_ * cols_ > numel) {
+      matrix = paddle::experimental::pad(
+          matrix, {0, static_cast<int>(rows_ * cols_ - numel)}, 0.0f);
+    }
+    matrix = paddle::experimental::reshape(matrix, IntArray({rows_, cols_}));
+
+    if (!q_.initialized()) {
+      // The same seed on all ranks gives the same initial Q.
+      q_ = paddle::experimental::gaussian(IntArray({cols_, rank_}),
+                                          0.0f,
+                                          1.0f,
+                                          kSeed,
+                                          phi::DataType::FLOAT32,
+                                          place);
+    }
+    p_ = paddle::experimental::matmul(matrix, q_, false, false);
+    // Synchronize only makes the calculation stream wait for the
+    // communication, the host is not blocked.
+    AllReduceInPlace(p_, process_group)->Synchronize();
+    p_ = std::get<0>(paddle::experimental::qr(p_, "reduced"));
+    q_ = paddle::experimental::matmul(matrix, p_, true, false);
+    return AllReduceInPlace(q_, process_group);
+  }
+
+  void Finalize(EagerGroup *group) override {
+    if (!compressed_) {
+      return;
+    }
+    const int64_t numel = group->all_length_;
+    Tensor approx = paddle::experimental::matmul(p_, q_, false, true);
+    approx = paddle::experimental::reshape(approx, IntArray({rows_ * cols_}));
+    if (rows_ * cols_ > numel) {
+      approx = paddle::experimental::slice(
+          approx, {0}, IntArray({0}), IntArray({numel}), {1}, {});
+    }
+    error_ = paddle::experimental::subtract(input_, approx);
+    input_.reset();
+    if (approx.dtype() != group->dtype_) {
+      approx = paddle::experimental::cast(approx, group->dtype_);
+    }
+    group->dense_contents_ = approx;
+  }
+
+  std::string Type() const override { return "powersgd"; }
+
+ private:
+  static constexpr int kSeed = 2019;
+
+  int64_t rank_;
+  int64_t start_iter_;
+  int64_t iter_{0};
+  int64_t rows_{0};
+  int64_t cols_{0};
+  bool compressed_{false};
+
+  Tensor input_;
+  Tensor error_;
+  Tensor p_;
+  Tensor q_;
+};
+
+// Each rank sends the k elements of largest magnitude and their indices,
+// the gathered elements are summed into a dense gradient.
+class TopKCommHook : public EagerCommHook {
+ public:
+  explicit TopKCommHook(double ratio) : ratio_(ratio) {}
+
+  std::shared_ptr<ProcessGroup::Task> Run(
+      EagerGroup *group, ProcessGroup *process_group) override {
+    const int64_t numel = group->all_length_;
+    const int64_t k =
+        std::max<int64_t>(1, static_cast<int64_t>(numel * ratio_));
+    // Indices are int64, so top-k sends more than the dense gradient when
+    // the ratio is large.
+    const auto value_size = static_cast<int64_t>(phi::SizeOf(group->dtype_));
+    compressed_ = k * (value_size + static_cast<int64_t>(sizeof(int64_t))) <
+                  numel * value_size;
+    if (!compressed_) {
+      return AllReduceInPlace(group->dense_contents_, process_group);
+    }
+
+    auto place = group->dense_contents_.place();
+    Tensor input = group->dense_contents_;
+    if (error_.initialized()) {
+      input = paddle::experimental::add(input, error_);
+    }
+    group->dense_contents_.reset();
+
+    indices_ = std::get<1>(paddle::experimental::topk(
+        paddle::experimental::abs(input), k, 0, true, false));
+    values_ = paddle::experimental::take_along_axis(input, indices_, 0);
+    error_ = paddle::experimental::put_along_axis(
+        input,
+        indices_,
+        paddle::experimental::full(IntArray({k}), 0, group->dtype_, place),
+        0);
+
+    const int64_t nranks = process_group->GetSize();
+    gathered_values_ = paddle::experimental::empty(
+        IntArray({nranks * k}), group->dtype_, place);
+    gathered_indices_ = paddle::experimental::empty(
+        IntArray({nranks * k}), phi::DataType::INT64, place);
+    values_task_ = AllGather(values_, &gathered_values_, process_group);
+    return AllGather(indices_, &gathered_indices_, process_group);
+  }
+
+  void Finalize(EagerGroup *group) override {
+    if (!compressed_) {
+      return;
+    }
+    values_task_->Synchronize();
+    values_task_.reset();
+    Tensor dense = paddle::experimental::full(IntArray({group->all_length_}),
+                                              0,
+                                              group->dtype_,
+                                              gathered_values_.place());
+    // The same index from different ranks is accumulated.
+    group->dense_contents_ = paddle::experimental::index_add(
+        dense, gathered_indices_, gathered_values_, 0);
+    values_.reset();
+    indices_.reset();
+    gathered_values_.reset();
+    gathered_indices_.reset();
+  }
+
+  std::string Type() const override { return "topk"; }
+
+ private:
+  double ratio_;
+  bool compressed_{false};
+
+  Tensor error_;
+  Tensor values_;
+  Tensor indices_;
+  Tensor gathered_values_;
+  Tensor gathered_indices_;
+  std::shared_ptr<ProcessGroup::Task> values_task_;
+};
+
+std::shared_ptr<EagerCommHook> CreateEagerCommHook(
+    const std::string &type, const std::map<std::string, double> &options) {
+  static const std::map<std::string, std::set<std::string>> valid_options = {
+      {"fp16", {}},
+      {"bf16", {}},
+      {"powersgd", {"rank", "start_iter"}},
+      {"topk", {"ratio"}},
+  };
+  auto it = valid_options.find(type);
+  PADDLE_ENFORCE_NE(
+      it,
+      valid_options.end(),
+      common::errors::InvalidArgument("The comm hook type must be one of "
+                                      "fp16, bf16, powersgd and topk, "
+                                      "but got %s.",
+                                      type));
+  for (const auto &option : options) {
+    PADDLE_ENFORCE_GT(it->second.count(option.first),
+                      0,
+                      common::errors::InvalidArgument(
+                          "Unknown option %s of comm hook %s.",
+                          option.first,
+                          type));
+  }
+  auto get_option = [&](const std::string &name, double default_value) {
+    auto option = options.find(name);
+    return option == options.end() ? default_value : option->second;
+  };
+
+  if (type == "fp16") {
+    return std::make_shared<CastCommHook>(phi::DataType::FLOAT16);
+  } else if (type == "bf16") {
+    return std::make_shared<CastCommHook>(phi::DataType::BFLOAT16);
+  } else if (type == "powersgd") {
+    auto rank = static_cast<int64_t>(get_option("rank", 1));
+    auto start_iter = static_cast<int64_t>(get_option("start_iter", 10));
+    PADDLE_ENFORCE_GE(rank,
+                      1,
+                      common::errors::InvalidArgument(
+                          "The rank of powersgd must be at least 1, "
+                          "but got %d.",
+                          rank));
+    PADDLE_ENFORCE_GE(start_iter,
+                      0,
+                      common::errors::InvalidArgument(
+                          "The start_iter of powersgd must be non-negative, "
+                          "but got %d.",
+                          start_iter));
+    return std::make_shared<PowerSGDCommHook>(rank, start_iter);
+  } else {
+    auto ratio = get_option("ratio", 0.01);
+    PADDLE_ENFORCE_EQ(
+        ratio > 0 && ratio <= 1,
+        true,
+        common::errors::InvalidArgument(
+            "The ratio of topk must be in (0, 1], but got %f.", ratio));
+    return std::make_shared<TopKCommHook>(ratio);
+  }
+}
+
+}  //  namespace distributed
+}  //  namespace paddle
@@ -0,0 +1,63 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "paddle/fluid/distributed/collective/reducer.h"
+
+namespace paddle {
+namespace distributed {
+
+// Communication hook of a dense EagerGroup, it replaces the allreduce of the
+// fused gradient of the group, e.g. to compress the gradient before it is
+// sent. A hook instance belongs to one group and may keep state of the group
+// across iterations, like the residual of error feedback.
+//
+// Run is called when the gradients of the group are ready. At this time
+// group->dense_contents_ holds the fused gradient, which has been divided by
+// the number of ranks already. Run launches the communication and returns
+// its task. Finalize is called after the task is synchronized, it must leave
+// the averaged gradient with the dtype and length of the group in
+// group->dense_contents_, which is then split to the gradients.
+class EagerCommHook {
+ public:
+  virtual ~EagerCommHook() = default;
+
+  virtual std::shared_ptr<ProcessGroup::Task> Run(
+      EagerGroup *group, ProcessGroup *process_group) = 0;
+
+  virtual void Finalize(EagerGroup *group UNUSED) {}
+
+  virtual std::string Type() const = 0;
+};
+
+// Built-in hooks, the options of each type are:
+//   "fp16", "bf16": no option, the gradient is cast to float16 or bfloat16
+//     for the allreduce. Groups that are not float32 use plain allreduce.
+//   "powersgd": "rank" (default 1), the rank of the low-rank approximation;
+//     "start_iter" (default 10), the number of iterations that use plain
+//     allreduce before compression starts.
+//   "topk": "ratio" (default 0.01), the ratio of the elements sent by each
+//     rank.
+// "powersgd" and "topk" keep the compression error of a rank and add it to
+// the gradient of the next iteration.
+std::shared_ptr<EagerCommHook> CreateEagerCommHook(
+    const std::string &type, const std::map<std::string, double> &options);
+
+}  //  namespace distributed
+}  //  namespace paddle
@@ -25,15 +25,26 @@
 #endif
 
 #include <gloo/reduce.h>
+#include <gloo/rendezvous/prefix_store.h>
+
+#include <algorithm>
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/collective/common.h"
 #include "paddle/fluid/distributed/collective/process_group_gloo.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/enforce.h"
 
+COMMON_DECLARE_int32(gloo_allreduce_threads);
+COMMON_DECLARE_bool(gloo_shm_allreduce);
+COMMON_DECLARE_int32(gloo_shm_buffer_mb);
+
 namespace paddle::distributed {
 
+// the least bytes of a chunk of an allreduce run in parallel
+constexpr int64_t kMinChunkBytes = 1 << 20;
+
 #ifdef _WIN32
 #define GENERATE_FUNC(type, func, ...)       \
   switch (type) {                            \
@@ -163,6 +174,76 @@ ProcessGroupGloo::ProcessGroupGloo(
       _store(new GlooStore(store)) {
   _context = std::make_shared<gloo::rendezvous::Context>(rank, world_size);
   _context->connectFullMesh(*_store, options->device);
+  if (world_size <= 1) {
+    return;
+  }
+  if (FLAGS_gloo_shm_allreduce) {
+    _shm_allreducer = ShmAllReducer::Create(
+        store,
+        rank,
+        world_size,
+        gid,
+        static_cast<int64_t>(FLAGS_gloo_shm_buffer_mb) << 20);
+  }
+  if (FLAGS_gloo_allreduce_threads > 1) {
+    for (int i = 0; i < FLAGS_gloo_allreduce_threads; ++i) {
+      auto chunk_store = std::make_shared<gloo::rendezvous::PrefixStore>(
+          "gloo_chunk/" + std::to_string(gid) + "/" + std::to_string(i),
+          *_store);
+      auto device = static_cast<size_t>(i) < options->chunk_devices.size()
+                        ? options->chunk_devices[i]
+                        : options->device;
+      _chunk_contexts.emplace_back(
+          std::make_unique<phi::distributed::GlooCommContext>(
+              rank, world_size, chunk_store, device));
+    }
+    _chunk_pool =
+        std::make_unique<phi::ThreadPool>(FLAGS_gloo_allreduce_threads);
+  }
+}
+
+bool ProcessGroupGloo::PerfAllReduce(phi::DenseTensor* out_tensor,
+                                     const phi::DenseTensor& in_tensor,
+                                     ReduceOp reduce_op,
+                                     uint32_t tag) {
+  // the same on all the ranks, which reduce the same tensors
+  if (_shm_allreducer &&
+      _shm_allreducer->AllReduce(out_tensor, in_tensor, reduce_op)) {
+    return true;
+  }
+  int64_t bytes =
+      in_tensor.numel() * static_cast<int64_t>(phi::SizeOf(in_tensor.dtype()));
+  int64_t num_chunks = std::min(static_cast<int64_t>(_chunk_contexts.size()),
+                                bytes / kMinChunkBytes);
+  if (num_chunks <= 1) {
+    return false;
+  }
+
+  int64_t numel = in_tensor.numel();
+  int64_t chunk_numel = (numel + num_chunks - 1) / num_chunks;
+  std::vector<phi::DenseTensor> in_chunks;
+  std::vector<phi::DenseTensor> out_chunks;
+  for (int64_t begin = 0; begin < numel; begin += chunk_numel) {
+    int64_t count = std::min(chunk_numel, numel - begin);
+    in_chunks.push_back(GetPartialTensor(in_tensor, begin, count));
+    out_chunks.push_back(GetPartialTensor(*out_tensor, begin, count));
+  }
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < in_chunks.size(); ++i) {
+    auto* comm_context = _chunk_contexts[i].get();
+    auto* in_chunk = &in_chunks[i];
+    auto* out_chunk = &out_chunks[i];
+    futures.emplace_back(_chunk_pool->Run([=]() {
+      comm_context->AllReduce(
+          out_chunk, *in_chunk, static_cast<int>(reduce_op), tag);
+    }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  VLOG(6) << "Allreduce " << bytes << " bytes in " << in_chunks.size()
+          << " chunks";
+  return true;
 }
 
 class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
@@ -380,7 +461,9 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
   auto comm_context = this->GetCommContext();
   task = std::make_shared<AllreduceGlooTask>(
       rank_, comm_context, inputs, outputs, opts.reduce_op, tag);
-  task->Run();
+  if (!PerfAllReduce(&outputs[0], inputs[0], opts.reduce_op, tag)) {
+    task->Run();
+  }
   return task;
 }
 
@@ -711,6 +794,15 @@ std::shared_ptr<ProcessGroupGloo> ProcessGroupGloo::CreateProcessGroupGloo(
   } else {
     opts->device = ProcessGroupGloo::createDefaultDevice();
   }
+  if (size > 1 && FLAGS_gloo_allreduce_threads > 1) {
+    // an event loop of its own for each chunk of an allreduce
+    for (int i = 0; i < FLAGS_gloo_allreduce_threads; ++i) {
+      opts->chunk_devices.push_back(
+          ifname && strlen(ifname) > 1
+              ? ProcessGroupGloo::createDeviceForInterface(std::string(ifname))
+              : ProcessGroupGloo::createDefaultDevice());
+    }
+  }
   phi::distributed::CommContextManager::CreateGlooCommContext(
       store, std::to_string(gid), rank, size);
   auto process_group =
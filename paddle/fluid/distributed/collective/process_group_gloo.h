@@ -17,13 +17,16 @@
 #include <future>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "paddle/fluid/distributed/collective/process_group.h"
 #include "paddle/fluid/distributed/collective/process_group_without_stream.h"
+#include "paddle/fluid/distributed/collective/shm_allreduce.h"
 #include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/core/distributed/gloo_comm_context.h"
 #include "paddle/phi/core/distributed/store/store.h"
 #include "paddle/phi/core/distributed/store/tcp_store.h"
+#include "paddle/phi/core/threadpool.h"
 
 namespace paddle {
 namespace distributed {
@@ -75,6 +78,9 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
       return std::make_shared<GlooOptions>();
     }
     std::shared_ptr<::gloo::transport::Device> device;
+    // of the contexts of the chunks of FLAGS_gloo_allreduce_threads, device
+    // if empty
+    std::vector<std::shared_ptr<::gloo::transport::Device>> chunk_devices;
   };
 
   ProcessGroupGloo(const std::shared_ptr<phi::distributed::Store>& store,
@@ -213,9 +219,22 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
   static std::shared_ptr<::gloo::transport::Device> createDefaultDevice();
 
  private:
+  // The allreduce through the shared memory of FLAGS_gloo_shm_allreduce, or
+  // the one of the chunks in parallel of FLAGS_gloo_allreduce_threads. False
+  // if neither applies.
+  bool PerfAllReduce(phi::DenseTensor* out_tensor,
+                     const phi::DenseTensor& in_tensor,
+                     ReduceOp reduce_op,
+                     uint32_t tag);
+
   uint32_t _tag;
   std::shared_ptr<gloo::rendezvous::Context> _context;
   std::shared_ptr<::gloo::rendezvous::Store> _store;
+  std::unique_ptr<ShmAllReducer> _shm_allreducer;
+  // each of its own sockets, for a chunk of an allreduce
+  std::vector<std::unique_ptr<phi::distributed::GlooCommContext>>
+      _chunk_contexts;
+  std::unique_ptr<phi::ThreadPool> _chunk_pool;
 };
 
 }  // namespace distributed
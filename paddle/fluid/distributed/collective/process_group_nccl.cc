@@ -13,6 +13,12 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/collective/process_group_nccl.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/collective/common.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
@@ -36,7 +42,12 @@ COMMON_DECLARE_bool(nccl_blocking_wait);
 COMMON_DECLARE_bool(use_stream_safe_cuda_allocator);
 COMMON_DECLARE_bool(use_cuda_malloc_async_allocator);
 COMMON_DECLARE_bool(enable_async_trace);
+COMMON_DECLARE_bool(enable_comm_perf_trace);
 COMMON_DECLARE_bool(eager_communication_connection);
+COMMON_DECLARE_bool(nccl_hierarchical_allreduce);
+COMMON_DECLARE_int64(nccl_hierarchical_allreduce_min_bytes);
+COMMON_DECLARE_int64(nccl_hierarchical_allreduce_max_bytes);
+COMMON_DECLARE_int32(nccl_hierarchical_allreduce_local_size);
 
 // set this flag to `true` and recompile to enable dynamic checks
 constexpr bool FLAGS_enable_nccl_dynamic_check = false;
@@ -53,6 +64,12 @@ using phi::distributed::ToNCCLRedType;
 
 uint64_t ProcessGroupNCCL::s_group_call_counter = 0;
 
+// comm tasks are traced by CommTaskManager for the async trace and the
+// performance trace
+static bool CommTaskEnabled() {
+  return FLAGS_enable_async_trace || FLAGS_enable_comm_perf_trace;
+}
+
 ProcessGroupNCCL::NCCLTask::NCCLTask(const Place& place,
                                      int rank,
                                      CommType comm_type,
@@ -157,7 +174,7 @@ ProcessGroupNCCL::ProcessGroupNCCL(
 }
 ProcessGroupNCCL::~ProcessGroupNCCL() {
   LOG(INFO) << "ProcessGroupNCCL destruct ";
-  if (FLAGS_enable_async_trace) {
+  if (CommTaskEnabled()) {
     auto& comm_task_manager = phi::distributed::CommTaskManager::GetInstance();
     comm_task_manager.Stop();
   }
@@ -273,6 +290,16 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::AllReduce(
   CheckTensorContiguous(in_tensor);
   CheckTensorContiguous(*out_tensor);
 
+  const auto* hierarchical_comm = GetHierarchicalComm(in_tensor);
+  if (hierarchical_comm != nullptr) {
+    return HierarchicalAllReduce(out_tensor,
+                                 in_tensor,
+                                 opts,
+                                 *hierarchical_comm,
+                                 sync_op,
+                                 use_calc_stream);
+  }
+
   return Collective(
       [&](phi::distributed::NCCLCommContext* comm_context, gpuStream_t stream) {
         VLOG(3) << "[ncclAllReduce] "
@@ -779,7 +806,7 @@ void ProcessGroupNCCL::CreateNCCLEnvCache(const Place& place,
   auto comm_ctx = std::make_unique<phi::GPUContext>(place);
   comm_ctx->set_nccl_comm(nccl_comm_ctx->GetNcclComm());
 
-  if (FLAGS_enable_async_trace) {
+  if (CommTaskEnabled()) {
     // gather global ranks in current group
     size_t gpu_global_rank_size = sizeof(int);
     auto gpu_global_rank = phi::memory_utils::Alloc(
@@ -837,6 +864,181 @@ void ProcessGroupNCCL::CreateNCCLEnvCache(const Place& place,
   }
 }
 
+const ProcessGroupNCCL::HierarchicalComm*
+ProcessGroupNCCL::GetHierarchicalComm(const phi::DenseTensor& tensor) {
+  // The three steps of the hierarchical allreduce must run in order, so it
+  // can't be used inside a NCCL group.
+  if (!FLAGS_nccl_hierarchical_allreduce || s_group_call_counter > 0 ||
+      is_coalescing_) {
+    return nullptr;
+  }
+  const int64_t bytes =
+      tensor.numel() * static_cast<int64_t>(phi::SizeOf(tensor.dtype()));
+  if (bytes < FLAGS_nccl_hierarchical_allreduce_min_bytes ||
+      bytes > FLAGS_nccl_hierarchical_allreduce_max_bytes) {
+    return nullptr;
+  }
+  const auto& place = tensor.place();
+  const auto& comm = GetOrCreateHierarchicalComm(place, GetKeyFromPlace(place));
+  if (!comm.enabled || tensor.numel() < comm.local_size) {
+    return nullptr;
+  }
+  return &comm;
+}
+
+const ProcessGroupNCCL::HierarchicalComm&
+ProcessGroupNCCL::GetOrCreateHierarchicalComm(const Place& place,
+                                              const std::string& place_key) {
+  auto iter = place_to_hierarchical_comm_.find(place_key);
+  if (iter != place_to_hierarchical_comm_.end()) {
+    return iter->second;
+  }
+
+  std::vector<std::string> hosts(size_);
+  const int local_size = FLAGS_nccl_hierarchical_allreduce_local_size;
+  if (local_size > 0) {
+    // Consecutive ranks of the given number are seen as one node.
+    for (int i = 0; i < size_; ++i) {
+      hosts[i] = std::to_string(i / local_size);
+    }
+  } else {
+    // Find the ranks on the same node by the host names in the store.
+    const std::string prefix =
+        "hierarchical_comm/" + std::to_string(gid_) + "/" + place_key + "/";
+    char hostname[256] = {0};
+    PADDLE_ENFORCE_EQ(gethostname(hostname, sizeof(hostname) - 1),
+                      0,
+                      common::errors::Unavailable("Failed to get host name."));
+    store_->set(prefix + std::to_string(rank_),
+                std::vector<uint8_t>(hostname, hostname + strlen(hostname)));
+    std::vector<std::string> host_keys;
+    host_keys.reserve(size_);
+    for (int i = 0; i < size_; ++i) {
+      host_keys.push_back(prefix + std::to_string(i));
+    }
+    const auto& host_values = store_->multi_get(host_keys);
+    for (int i = 0; i < size_; ++i) {
+      hosts[i].assign(host_values[i].begin(), host_values[i].end());
+    }
+  }
+
+  std::vector<std::string> nodes;
+  std::unordered_map<std::string, int> node_sizes;
+  for (const auto& host : hosts) {
+    if (node_sizes[host]++ == 0) {
+      nodes.push_back(host);
+    }
+  }
+  HierarchicalComm comm;
+  comm.local_size = node_sizes[hosts[rank_]];
+  comm.local_rank = static_cast<int>(
+      std::count(hosts.begin(), hosts.begin() + rank_, hosts[rank_]));
+  const int node_rank = static_cast<int>(
+      std::find(nodes.begin(), nodes.end(), hosts[rank_]) - nodes.begin());
+  comm.enabled = nodes.size() > 1 && comm.local_size > 1 &&
+                 std::all_of(nodes.begin(),
+                             nodes.end(),
+                             [&](const std::string& node) {
+                               return node_sizes[node] == comm.local_size;
+                             });
+  VLOG(3) << "hierarchical comm of gid: " << gid_ << ", rank: " << rank_
+          << ", nodes: " << nodes.size() << ", node_rank: " << node_rank
+          << ", local_rank: " << comm.local_rank
+          << ", local_size: " << comm.local_size
+          << ", enabled: " << comm.enabled;
+
+  if (comm.enabled) {
+    platform::CUDADeviceGuard cuda_guard(place);
+    const std::string intra_key =
+        "nccl_ids/" + std::to_string(gid_) + "/" + place_key + "/intra/" +
+        std::to_string(node_rank);
+    const std::string inter_key =
+        "nccl_ids/" + std::to_string(gid_) + "/" + place_key + "/inter/" +
+        std::to_string(comm.local_rank);
+    NCCL_CHECK(phi::dynload::ncclGroupStart());
+    phi::distributed::CommContextManager::CreateNCCLCommContext(
+        store_,
+        intra_key,
+        comm.local_rank,
+        comm.local_size,
+        "",
+        nullptr,
+        nccl_comm_init_option_);
+    phi::distributed::CommContextManager::CreateNCCLCommContext(
+        store_,
+        inter_key,
+        node_rank,
+        static_cast<int>(nodes.size()),
+        "",
+        nullptr,
+        nccl_comm_init_option_);
+    NCCL_CHECK(phi::dynload::ncclGroupEnd());
+    comm.intra_comm = GetCommContext(&intra_key);
+    comm.inter_comm = GetCommContext(&inter_key);
+  }
+  return place_to_hierarchical_comm_.emplace(place_key, comm).first->second;
+}
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::HierarchicalAllReduce(
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    const AllreduceOptions& opts,
+    const HierarchicalComm& comm,
+    bool sync_op,
+    bool use_calc_stream) {
+  return Collective(
+      [&](phi::distributed::NCCLCommContext* comm_context, gpuStream_t stream) {
+        const int64_t numel = in_tensor.numel();
+        const int64_t shard_numel = numel / comm.local_size;
+        const int64_t aligned_numel = shard_numel * comm.local_size;
+        const auto reduce_type = ToNCCLRedType(opts.reduce_op);
+        VLOG(3) << "[HierarchicalAllReduce] "
+                << "sendbuff: " << in_tensor.data()
+                << ", recvbuff: " << out_tensor->data()
+                << ", count: " << numel << ", datatype: "
+                << NCCLDTypeToString(phi::ToNCCLDataType(in_tensor.dtype()))
+                << ", redop: "
+                << NCCLRedTypeToString(ToNCCLRedType(opts.reduce_op))
+                << ", local_rank: " << comm.local_rank
+                << ", local_size: " << comm.local_size
+                << ", stream: " << stream << ", rank_in_group: " << rank_
+                << ", nranks: " << size_ << ", sync_op: " << sync_op
+                << ", use_calc_stream: " << use_calc_stream << ", "
+                << GetGroupMessage();
+
+        // 1. reduce-scatter inside the node, the shard of the local rank is
+        //    reduced to its place in out_tensor;
+        // 2. allreduce the shard across the nodes;
+        // 3. allgather the shards inside the node, in place.
+        phi::DenseTensor shard = GetPartialTensor(
+            *out_tensor, comm.local_rank * shard_numel, shard_numel);
+        comm.intra_comm->ReduceScatter(
+            &shard,
+            GetPartialTensor(in_tensor, 0, aligned_numel),
+            reduce_type,
+            stream);
+        comm.inter_comm->AllReduce(&shard, shard, reduce_type, stream);
+        phi::DenseTensor aligned_out =
+            GetPartialTensor(*out_tensor, 0, aligned_numel);
+        comm.intra_comm->AllGather(&aligned_out, shard, stream);
+
+        // the remainder of less than local_size elements
+        if (aligned_numel < numel) {
+          phi::DenseTensor tail_out = GetPartialTensor(
+              *out_tensor, aligned_numel, numel - aligned_numel);
+          comm_context->AllReduce(
+              &tail_out,
+              GetPartialTensor(in_tensor, aligned_numel, numel - aligned_numel),
+              reduce_type,
+              stream);
+        }
+      },
+      in_tensor,
+      CommType::ALLREDUCE,
+      sync_op,
+      use_calc_stream);
+}
+
 void ProcessGroupNCCL::SyncCalcStream(const Place& place,
                                       const std::string& place_key) {
   auto& calc_event = place_to_calc_event_.at(place_key);
@@ -934,7 +1136,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::Collective(
 
   auto nccl_comm_ctx = this->GetCommContext(&store_key);
 
-  if (!FLAGS_enable_async_trace) {
+  if (!CommTaskEnabled()) {
     fn(nccl_comm_ctx, nccl_stream);
   } else {
     std::string group_key = place_to_group_key_.at(key);
@@ -951,7 +1153,8 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::Collective(
                                                          nccl_comm,
                                                          nccl_stream,
                                                          comm_type,
-                                                         pg_timeout_);
+                                                         pg_timeout_,
+                                                         tensor.dtype());
     comm_task->StartRecord();
     fn(nccl_comm_ctx, nccl_stream);
     comm_task->EndRecord();
@@ -1067,11 +1270,12 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::Point2Point(
                                                        nccl_comm,
                                                        nccl_stream,
                                                        comm_type,
-                                                       pg_timeout_);
+                                                       pg_timeout_,
+                                                       tensor.dtype());
 
   auto nccl_comm_ctx = this->GetCommContext(&store_key);
 
-  if (!FLAGS_enable_async_trace) {
+  if (!CommTaskEnabled()) {
     fn(nccl_comm_ctx, nccl_stream, p2p_target_rank);
   } else {
     comm_task->StartRecord();
@@ -204,6 +204,31 @@ class ProcessGroupNCCL final : public ProcessGroupWithStream {
 
   void SyncCalcStream(const Place& place, const std::string& place_key);
 
+  // Sub-communicators of the hierarchical allreduce: intra_comm connects the
+  // ranks of the same node, inter_comm connects the ranks of the same local
+  // rank on different nodes. It is disabled if the group is on one node or
+  // the nodes have different numbers of ranks.
+  struct HierarchicalComm {
+    bool enabled{false};
+    int local_rank{0};
+    int local_size{1};
+    phi::distributed::NCCLCommContext* intra_comm{nullptr};
+    phi::distributed::NCCLCommContext* inter_comm{nullptr};
+  };
+
+  const HierarchicalComm* GetHierarchicalComm(const phi::DenseTensor& tensor);
+
+  const HierarchicalComm& GetOrCreateHierarchicalComm(
+      const Place& place, const std::string& place_key);
+
+  std::shared_ptr<ProcessGroup::Task> HierarchicalAllReduce(
+      phi::DenseTensor* out_tensor,
+      const phi::DenseTensor& in_tensor,
+      const AllreduceOptions& opts,
+      const HierarchicalComm& comm,
+      bool sync_op,
+      bool use_calc_stream);
+
   std::shared_ptr<ProcessGroup::Task> Collective(
       std::function<void(phi::distributed::NCCLCommContext*, gpuStream_t)> fn,
       const phi::DenseTensor& tensor,
@@ -258,6 +283,8 @@ class ProcessGroupNCCL final : public ProcessGroupWithStream {
   uint64_t comm_seq_{0};
   std::unordered_map<std::string, uint64_t> p2p_comm_seq_;
   std::unordered_map<std::string, std::string> place_to_group_key_;
+  std::unordered_map<std::string, HierarchicalComm>
+      place_to_hierarchical_comm_;
 
   // TODO(sunyilun): attrs below will be removed later
   std::mutex mutex_;
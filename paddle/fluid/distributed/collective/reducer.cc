@@ -13,7 +13,13 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/collective/reducer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
 #include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/collective/comm_hook.h"
 #include "paddle/phi/api/lib/data_transform.h"
 #include "paddle/phi/backends/device_guard.h"
 #include "paddle/phi/backends/device_manager.h"
@@ -482,7 +488,8 @@ EagerReducer::EagerReducer(
     const std::vector<bool> &is_sparse_gradient,
     std::shared_ptr<distributed::ProcessGroup> process_group,
     const std::vector<size_t> &group_size_limits,
-    bool find_unused_parameters)
+    bool find_unused_parameters,
+    bool rebuild_groups)
     : tensors_(tensors),
       group_indices_(group_indices),
       is_sparse_gradient_(is_sparse_gradient),
@@ -494,7 +501,8 @@ EagerReducer::EagerReducer(
       local_used_vars_(),
       unused_vars_(),
       gradnode_index_map_(),
-      find_unused_vars_each_step_(find_unused_parameters) {
+      find_unused_vars_each_step_(find_unused_parameters),
+      rebuild_groups_(rebuild_groups) {
   VLOG(3) << "Start construct the Reducer ...";
 
   nranks_ = process_group_->GetSize();
@@ -830,6 +838,9 @@ void EagerReducer::MarkVarReady(const size_t var_index,
                       common::errors::PreconditionNotMet(error_info));
   } else {
     vars_marked_ready_[var_index] = true;
+    if (NeedRebuildGroups()) {
+      rebuild_var_indices_.push_back(var_index);
+    }
   }
   groups_need_finalize_ = true;
 
@@ -1065,7 +1076,10 @@ void EagerReducer::FinalizeBackward() {
   for (auto &group : groups_) {
     if (!group.is_sparse_) {
       group.task->Synchronize();
-      if (!IsStreamSafeAllocator()) {
+      if (group.comm_hook_ != nullptr) {
+        group.comm_hook_->Finalize(&group);
+      }
+      if (!IsStreamSafeAllocator() || group.comm_hook_ != nullptr) {
         auto *default_ctx =
             phi::DeviceContextPool::Instance().Get(inner_place_);
         group.SplitTensors(*default_ctx);
@@ -1080,9 +1094,198 @@ void EagerReducer::FinalizeBackward() {
     VLOG(3) << "ProcessUnusedDenseVars is finished.";
   }
 
+  if (NeedRebuildGroups()) {
+    RebuildGroups();
+  }
+
   VLOG(3) << "In the batch, Reducer is finished.";
 }
 
+void EagerReducer::RegisterCommHook(
+    const std::string &type,
+    const std::vector<size_t> &group_indices,
+    const std::map<std::string, double> &options) {
+  PADDLE_ENFORCE_EQ(groups_need_finalize_,
+                    false,
+                    common::errors::PreconditionNotMet(
+                        "The comm hook can't be registered during backward."));
+  std::vector<size_t> indices = group_indices;
+  if (indices.empty()) {
+    for (size_t i = 0; i < groups_.size(); ++i) {
+      if (!groups_[i].is_sparse_) {
+        indices.push_back(i);
+      }
+    }
+  }
+  for (const auto group_index : indices) {
+    PADDLE_ENFORCE_LT(
+        group_index,
+        groups_.size(),
+        common::errors::OutOfRange("The group index must be less than %d, "
+                                   "but it is %d.",
+                                   groups_.size(),
+                                   group_index));
+    auto &group = groups_[group_index];
+    PADDLE_ENFORCE_EQ(group.is_sparse_,
+                      false,
+                      common::errors::InvalidArgument(
+                          "The comm hook can't be registered to the sparse "
+                          "group[%d].",
+                          group_index));
+    // Each group has its own hook, since hooks keep the state of the group.
+    group.comm_hook_ =
+        type == "allreduce" ? nullptr : CreateEagerCommHook(type, options);
+    VLOG(3) << "Register comm hook " << type << " to group[" << group_index
+            << "]";
+  }
+
+  if (group_indices.empty()) {
+    if (type == "allreduce") {
+      comm_hooks_.clear();
+    } else {
+      comm_hooks_.emplace_back(type, options);
+    }
+  } else if (NeedRebuildGroups()) {
+    LOG(WARNING) << "The comm hook " << type << " registered to group "
+                 << string::join_strings(group_indices, ',')
+                 << " will be dropped when the groups are rebuilt, register "
+                    "it without group indices to keep it.";
+  }
+}
+
+size_t EagerReducer::EstimateGroupSize() {
+  // Fit t = latency + bytes / bandwidth by timing allreduce of two sizes,
+  // and choose the size whose latency is 10% of its time. Smaller groups
+  // start the communication earlier, but each group pays the latency.
+  constexpr int64_t kSmallBytes = 256 * 1024;
+  constexpr int64_t kLargeBytes = 16 * 1024 * 1024;
+  constexpr int kRepeat = 3;
+  constexpr double kLatencyRatio = 0.1;
+  constexpr size_t kMinGroupSize = 1024 * 1024;
+
+  auto *dev_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+  auto time_allreduce = [&](int64_t bytes) {
+    Tensor tensor = paddle::experimental::full(
+        IntArray({bytes / static_cast<int64_t>(sizeof(float))}),
+        0,
+        DataType::FLOAT32,
+        inner_place_);
+    std::vector<phi::DenseTensor> in_out = {
+        *std::dynamic_pointer_cast<phi::DenseTensor>(tensor.impl())};
+    distributed::AllreduceOptions opts;
+    opts.reduce_op = ReduceOp::SUM;
+    double best = std::numeric_limits<double>::max();
+    // the first run is a warmup
+    for (int i = 0; i <= kRepeat; ++i) {
+      dev_ctx->Wait();
+      auto start = std::chrono::steady_clock::now();
+      process_group_->AllReduce(in_out, in_out, opts)->Synchronize();
+      dev_ctx->Wait();
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (i > 0) {
+        best = std::min(best, elapsed.count());
+      }
+    }
+    return best;
+  };
+
+  const double small_time = time_allreduce(kSmallBytes);
+  const double large_time = time_allreduce(kLargeBytes);
+  const size_t max_group_size = group_size_limits_.back();
+  if (large_time <= small_time) {
+    return max_group_size;
+  }
+  const double bandwidth =
+      (kLargeBytes - kSmallBytes) / (large_time - small_time);
+  const double latency = small_time - kSmallBytes / bandwidth;
+  if (latency <= 0) {
+    return max_group_size;
+  }
+  const double size = latency * bandwidth * (1 - kLatencyRatio) / kLatencyRatio;
+  VLOG(3) << "Allreduce latency: " << latency * 1e6
+          << " us, bandwidth: " << bandwidth / 1e9
+          << " GB/s, estimated group size: " << size;
+  return std::max(kMinGroupSize,
+                  std::min(max_group_size, static_cast<size_t>(size)));
+}
+
+void EagerReducer::RebuildGroups() {
+  PADDLE_ENFORCE_EQ(
+      rebuild_var_indices_.size(),
+      tensors_.size(),
+      common::errors::PreconditionNotMet(
+          "Rebuild vars's number should be equal to original vars'number, "
+          "expect it to be %d, but got %d.",
+          tensors_.size(),
+          rebuild_var_indices_.size()));
+  VLOG(3) << "The order of tensor arrival: "
+          << string::join_strings(rebuild_var_indices_, ',');
+
+  // All ranks must build the same groups, so the group size and the order of
+  // rank 0 are broadcast, in the layout of [group size, order...].
+  std::vector<int64_t> rebuild_info;
+  rebuild_info.reserve(tensors_.size() + 1);
+  rebuild_info.push_back(static_cast<int64_t>(EstimateGroupSize()));
+  rebuild_info.insert(rebuild_info.end(),
+                      rebuild_var_indices_.begin(),
+                      rebuild_var_indices_.end());
+
+  auto *dev_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+  Tensor rebuild_info_tensor = paddle::experimental::empty(
+      IntArray({static_cast<int64_t>(rebuild_info.size())}),
+      DataType::INT64,
+      inner_place_);
+  auto *rebuild_info_dense_tensor =
+      std::dynamic_pointer_cast<phi::DenseTensor>(rebuild_info_tensor.impl())
+          .get();
+  framework::TensorFromVector<int64_t>(
+      rebuild_info, *dev_ctx, rebuild_info_dense_tensor);
+  std::vector<phi::DenseTensor> in_out = {*rebuild_info_dense_tensor};
+  BroadcastOptions opts;
+  opts.source_rank = 0;
+  process_group_->Broadcast(in_out, in_out, opts)->Synchronize();
+  framework::TensorToVector<int64_t>(
+      *rebuild_info_dense_tensor, *dev_ctx, &rebuild_info);
+  dev_ctx->Wait();
+
+  const auto group_size = static_cast<size_t>(rebuild_info.front());
+  std::vector<size_t> group_size_limits = group_size_limits_;
+  for (auto &limit : group_size_limits) {
+    limit = std::min(limit, group_size);
+  }
+
+  // Same as the initial groups, the groups are assigned in the reversed
+  // order, so that the small group of group_size_limits.front() is the last
+  // one, and then reversed.
+  std::vector<Tensor> rebuild_tensors;
+  std::vector<int64_t> rebuild_tensor_indices;
+  rebuild_tensors.reserve(tensors_.size());
+  rebuild_tensor_indices.reserve(tensors_.size());
+  for (auto it = rebuild_info.rbegin(); it + 1 != rebuild_info.rend(); ++it) {
+    rebuild_tensors.push_back(tensors_[*it]);
+    rebuild_tensor_indices.push_back(*it);
+  }
+  auto group_indices = Eager_AssignGroupBySize(rebuild_tensors,
+                                               is_sparse_gradient_,
+                                               group_size_limits,
+                                               rebuild_tensor_indices);
+  std::reverse(group_indices.begin(), group_indices.end());
+
+  group_indices_ = std::move(group_indices);
+  InitializeGroups(group_indices_);
+  has_rebuilt_groups_ = true;
+  rebuild_var_indices_.clear();
+  VLOG(3) << "Rebuild " << groups_.size()
+          << " groups with group size limit: " << group_size;
+
+  auto comm_hooks = std::move(comm_hooks_);
+  comm_hooks_.clear();
+  for (const auto &comm_hook : comm_hooks) {
+    RegisterCommHook(comm_hook.first, {}, comm_hook.second);
+  }
+}
+
 void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
                                           const int curr_group_index) {
   // The overall timeline: concat > div_nranks > allreduce > split
@@ -1098,6 +1301,15 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   paddle::experimental::scale_(
       group->dense_contents_, 1.0 / nranks_, 0.0, false);  // NOLINT
 
+  if (group->comm_hook_ != nullptr) {
+    // The hook result is split in FinalizeBackward, after Finalize of the
+    // hook.
+    VLOG(3) << "group [" << curr_group_index << "] runs comm hook "
+            << group->comm_hook_->Type();
+    group->task = group->comm_hook_->Run(group, process_group_.get());
+    return;
+  }
+
   // all_reduce
   std::vector<Tensor> reduce_tensors = {group->dense_contents_};
   std::vector<phi::DenseTensor> in_out;
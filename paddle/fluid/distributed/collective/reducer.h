@@ -15,6 +15,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include "paddle/fluid/distributed/collective/process_group.h"
@@ -44,6 +45,8 @@ std::vector<std::vector<size_t>> Eager_AssignGroupBySize(
     const std::vector<size_t> &group_size_limits,
     const std::vector<int64_t> &tensor_indices = {});
 
+class EagerCommHook;
+
 class EagerGroup {
  public:
   Tensor dense_contents_;
@@ -69,6 +72,9 @@ class EagerGroup {
   // help to sync
   std::shared_ptr<ProcessGroup::Task> task;
 
+  // replaces the allreduce of dense_contents_ if it is set
+  std::shared_ptr<EagerCommHook> comm_hook_;
+
   // context is used to select the stream for concat
   void ConcatTensors(const phi::Place &);
 
@@ -93,7 +99,8 @@ class EagerReducer {
       const std::vector<bool> &is_sparse_gradient,
       std::shared_ptr<distributed::ProcessGroup> process_group,
       const std::vector<size_t> &group_size_limits,
-      bool find_unused_parameters);
+      bool find_unused_parameters,
+      bool rebuild_groups = false);
 
   virtual ~EagerReducer() {}
 
@@ -113,6 +120,18 @@ class EagerReducer {
   void ProcessUnusedDenseVars();
   bool HasGrad(size_t var_index);
 
+  // Set the comm hook of the given dense groups, all dense groups if
+  // group_indices is empty. "allreduce" restores the default allreduce.
+  void RegisterCommHook(const std::string &type,
+                        const std::vector<size_t> &group_indices,
+                        const std::map<std::string, double> &options);
+
+  // Rebuild the groups by the order in which the gradients are ready in the
+  // first iteration, with the group size fitted to the measured allreduce
+  // latency and bandwidth.
+  void RebuildGroups();
+  size_t EstimateGroupSize();
+
  private:
   std::vector<Tensor> tensors_;
   std::vector<std::vector<size_t>> group_indices_;
@@ -139,6 +158,19 @@ class EagerReducer {
   bool find_unused_vars_once_{true};
   bool groups_need_finalize_{false};
   Tensor global_used_vars_;
+
+  // Following variables are to help rebuild groups
+  bool rebuild_groups_{false};
+  bool has_rebuilt_groups_{false};
+  std::vector<size_t> rebuild_var_indices_;
+  // registered comm hooks, which are registered again after rebuilding
+  std::vector<std::pair<std::string, std::map<std::string, double>>>
+      comm_hooks_;
+
+  bool NeedRebuildGroups() const {
+    return rebuild_groups_ && !has_rebuilt_groups_ &&
+           !find_unused_vars_each_step_;
+  }
 };
 
 }  //  namespace distributed
@@ -0,0 +1,283 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/shm_allreduce.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/place.h"
+
+namespace paddle::distributed {
+
+using phi::distributed::ReduceOp;
+
+namespace {
+
+constexpr size_t kHeaderBytes = 64;
+
+template <typename T>
+void ReduceInto(char* dst_bytes,
+                const char* src_bytes,
+                int64_t numel,
+                ReduceOp reduce_op) {
+  auto* dst = reinterpret_cast<T*>(dst_bytes);
+  const auto* src = reinterpret_cast<const T*>(src_bytes);
+  switch (reduce_op) {
+    case ReduceOp::SUM:
+      for (int64_t i = 0; i < numel; ++i) {
+        dst[i] = dst[i] + src[i];
+      }
+      break;
+    case ReduceOp::MAX:
+      for (int64_t i = 0; i < numel; ++i) {
+        dst[i] = dst[i] < src[i] ? src[i] : dst[i];
+      }
+      break;
+    case ReduceOp::MIN:
+      for (int64_t i = 0; i < numel; ++i) {
+        dst[i] = src[i] < dst[i] ? src[i] : dst[i];
+      }
+      break;
+    case ReduceOp::PRODUCT:
+      for (int64_t i = 0; i < numel; ++i) {
+        dst[i] = dst[i] * src[i];
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+using ReduceFunc = void (*)(char*, const char*, int64_t, ReduceOp);
+
+ReduceFunc GetReduceFunc(phi::DataType dtype) {
+  switch (dtype) {
+    case phi::DataType::FLOAT32:
+      return ReduceInto<float>;
+    case phi::DataType::FLOAT64:
+      return ReduceInto<double>;
+    case phi::DataType::INT32:
+      return ReduceInto<int32_t>;
+    case phi::DataType::INT64:
+      return ReduceInto<int64_t>;
+    case phi::DataType::FLOAT16:
+      return ReduceInto<phi::dtype::float16>;
+    case phi::DataType::BFLOAT16:
+      return ReduceInto<phi::dtype::bfloat16>;
+    default:
+      return nullptr;
+  }
+}
+
+std::string ToString(const std::vector<uint8_t>& value) {
+  return std::string(value.begin(), value.end());
+}
+
+std::vector<uint8_t> ToBytes(const std::string& value) {
+  return std::vector<uint8_t>(value.begin(), value.end());
+}
+
+// Whether all the ranks have set ok, each setting its own.
+bool AllOk(const std::shared_ptr<phi::distributed::Store>& store,
+           const std::string& prefix,
+           int rank,
+           int world_size,
+           bool ok) {
+  store->set(prefix + std::to_string(rank), ToBytes(ok ? "1" : "0"));
+  bool all_ok = true;
+  for (int i = 0; i < world_size; ++i) {
+    std::string key = prefix + std::to_string(i);
+    store->wait(key);
+    all_ok = all_ok && ToString(store->get(key)) == "1";
+  }
+  return all_ok;
+}
+
+}  // namespace
+
+struct ShmAllReducer::Header {
+  std::atomic<int64_t> arrived;
+  std::atomic<int64_t> generation;
+};
+
+std::unique_ptr<ShmAllReducer> ShmAllReducer::Create(
+    const std::shared_ptr<phi::distributed::Store>& store,
+    int rank,
+    int world_size,
+    int gid,
+    int64_t slot_bytes) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  static_assert(std::atomic<int64_t>::is_always_lock_free,
+                "The barrier in shared memory needs lock-free atomics.");
+  std::string prefix = "gloo_shm/" + std::to_string(gid) + "/";
+  char hostname[256] = {0};
+  ::gethostname(hostname, sizeof(hostname) - 1);
+  store->set(prefix + "host/" + std::to_string(rank), ToBytes(hostname));
+  for (int i = 0; i < world_size; ++i) {
+    std::string key = prefix + "host/" + std::to_string(i);
+    store->wait(key);
+    if (ToString(store->get(key)) != hostname) {
+      VLOG(3) << "The ranks of group " << gid << " are not on one host";
+      return nullptr;
+    }
+  }
+
+  slot_bytes = (slot_bytes + 63) / 64 * 64;
+  size_t size = kHeaderBytes + static_cast<size_t>(slot_bytes) * world_size;
+  std::string name;
+  int fd = -1;
+  if (rank == 0) {
+    name = "/paddle_gloo_" + std::to_string(::getpid()) + "_" +
+           std::to_string(gid);
+    fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    // zeroed by ftruncate, so is the header
+    if (fd >= 0 && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      fd = -1;
+    }
+    store->set(prefix + "name", ToBytes(fd >= 0 ? name : ""));
+  } else {
+    store->wait(prefix + "name");
+    name = ToString(store->get(prefix + "name"));
+    if (!name.empty()) {
+      fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    }
+  }
+  void* base = MAP_FAILED;
+  if (fd >= 0) {
+    base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+  }
+  bool ok = AllOk(store, prefix + "ok/", rank, world_size, base != MAP_FAILED);
+  if (rank == 0 && !name.empty()) {
+    // the segment lives until the last rank unmaps it
+    ::shm_unlink(name.c_str());
+  }
+  if (!ok) {
+    if (base != MAP_FAILED) {
+      ::munmap(base, size);
+    }
+    LOG(WARNING) << "Failed to map the shared memory of group " << gid
+                 << ", the allreduce of gloo is used";
+    return nullptr;
+  }
+  VLOG(3) << "Allreduce of group " << gid << " through " << name;
+  return std::unique_ptr<ShmAllReducer>(
+      new ShmAllReducer(rank, world_size, slot_bytes, base, size));
+#endif
+}
+
+ShmAllReducer::ShmAllReducer(
+    int rank, int world_size, int64_t slot_bytes, void* base, size_t size)
+    : rank_(rank),
+      world_size_(world_size),
+      slot_bytes_(slot_bytes),
+      base_(base),
+      size_(size),
+      header_(reinterpret_cast<Header*>(base)) {
+  static_assert(sizeof(Header) <= kHeaderBytes,
+                "The header of the shared memory is too large.");
+}
+
+ShmAllReducer::~ShmAllReducer() {
+#ifndef _WIN32
+  ::munmap(base_, size_);
+#endif
+}
+
+char* ShmAllReducer::Slot(int rank) const {
+  return reinterpret_cast<char*>(base_) + kHeaderBytes + rank * slot_bytes_;
+}
+
+void ShmAllReducer::Barrier() {
+  int64_t generation = header_->generation.load(std::memory_order_acquire);
+  if (header_->arrived.fetch_add(1, std::memory_order_acq_rel) ==
+      world_size_ - 1) {
+    header_->arrived.store(0, std::memory_order_relaxed);
+    header_->generation.store(generation + 1, std::memory_order_release);
+    return;
+  }
+  while (header_->generation.load(std::memory_order_acquire) == generation) {
+    std::this_thread::yield();
+  }
+}
+
+bool ShmAllReducer::AllReduce(phi::DenseTensor* out_tensor,
+                              const phi::DenseTensor& in_tensor,
+                              ReduceOp reduce_op) {
+  auto reduce = GetReduceFunc(in_tensor.dtype());
+  if (reduce == nullptr || reduce_op == ReduceOp::AVG ||
+      in_tensor.place().GetType() != phi::AllocationType::CPU ||
+      out_tensor->place().GetType() != phi::AllocationType::CPU) {
+    return false;
+  }
+  int64_t elem_bytes = static_cast<int64_t>(phi::SizeOf(in_tensor.dtype()));
+  int64_t piece = slot_bytes_ / elem_bytes;
+  int64_t numel = in_tensor.numel();
+  const char* in = reinterpret_cast<const char*>(in_tensor.data());
+  char* out = reinterpret_cast<char*>(out_tensor->data());
+
+  for (int64_t offset = 0; offset < numel; offset += piece) {
+    int64_t count = std::min(piece, numel - offset);
+    int64_t part = (count + world_size_ - 1) / world_size_;
+    auto part_begin = [&](int rank) {
+      return std::min(count, part * rank);
+    };
+
+    std::memcpy(Slot(rank_), in + offset * elem_bytes, count * elem_bytes);
+    Barrier();
+
+    int64_t begin = part_begin(rank_);
+    int64_t end = part_begin(rank_ + 1);
+    for (int i = 0; i < world_size_; ++i) {
+      if (i != rank_ && begin < end) {
+        reduce(Slot(rank_) + begin * elem_bytes,
+               Slot(i) + begin * elem_bytes,
+               end - begin,
+               reduce_op);
+      }
+    }
+    Barrier();
+
+    for (int i = 0; i < world_size_; ++i) {
+      int64_t i_begin = part_begin(i);
+      int64_t i_end = part_begin(i + 1);
+      std::memcpy(out + (offset + i_begin) * elem_bytes,
+                  Slot(i) + i_begin * elem_bytes,
+                  (i_end - i_begin) * elem_bytes);
+    }
+    // the slots are written again by the next piece
+    Barrier();
+  }
+  return true;
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/distributed/store/store.h"
+#include "paddle/phi/core/distributed/types.h"
+
+namespace paddle {
+namespace distributed {
+
+/**
+ * Allreduce of the CPU tensors of the ranks of a group on one host through
+ * a shared memory segment of a slot per rank. A tensor is reduced a slot at
+ * a time: each rank copies its piece into its slot, reduces its part of the
+ * piece over all the slots into its own one, and copies the reduced parts
+ * of all the slots out, with a barrier in the segment after each step.
+ **/
+class ShmAllReducer {
+ public:
+  // nullptr if the ranks are not all on this host or the segment cannot be
+  // mapped by one of them. Called by all the ranks of the group.
+  static std::unique_ptr<ShmAllReducer> Create(
+      const std::shared_ptr<phi::distributed::Store>& store,
+      int rank,
+      int world_size,
+      int gid,
+      int64_t slot_bytes);
+
+  ~ShmAllReducer();
+
+  // false, with nothing done, if the tensors or the reduce op are not
+  // supported. in_tensor may be out_tensor.
+  bool AllReduce(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 phi::distributed::ReduceOp reduce_op);
+
+ private:
+  struct Header;
+
+  ShmAllReducer(
+      int rank, int world_size, int64_t slot_bytes, void* base, size_t size);
+
+  void Barrier();
+  char* Slot(int rank) const;
+
+  int rank_;
+  int world_size_;
+  int64_t slot_bytes_;
+  void* base_;
+  size_t size_;
+  Header* header_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -47,6 +47,20 @@ void ComputeInterceptor::PrepareDeps() {
   }
 }
 
+framework::VariableSlotTable& ComputeInterceptor::VarSlotsOf(
+    int64_t scope_id) {
+  if (scope_var_slots_.size() != microbatch_scopes_.size()) {
+    scope_var_slots_.clear();
+    scope_var_slots_.resize(microbatch_scopes_.size());
+  }
+  auto* scope = microbatch_scopes_[scope_id];
+  auto& var_slots = scope_var_slots_[scope_id];
+  if (!var_slots.IsBuiltFor(scope)) {
+    var_slots = framework::VariableSlotTable(*scope, {});
+  }
+  return var_slots;
+}
+
 void ComputeInterceptor::DecodeMsgVars(const InterceptorMessage& msg) {
   int64_t scope_id = msg.scope_idx();
   PADDLE_ENFORCE_LT(scope_id,
@@ -57,12 +71,18 @@ void ComputeInterceptor::DecodeMsgVars(const InterceptorMessage& msg) {
                         microbatch_scopes_.size(),
                         scope_id));
   auto* scope = microbatch_scopes_[scope_id];
+  auto& var_slots = VarSlotsOf(scope_id);
   phi::DeviceContextPool& pool = phi::DeviceContextPool::Instance();
   for (const auto& var_iter : msg.vars_list()) {
     const std::string& name = var_iter.name();
     auto& dev_ctx = *pool.Get(place_);
     std::istringstream ss(var_iter.stensor());
-    auto* var = scope->Var(name);
+    // The variables are created in the microbatch scope itself.
+    int slot = var_slots.Slot(name);
+    if (slot == framework::VariableSlotTable::kInvalidSlot) {
+      slot = var_slots.Bind(name, scope->Var(name));
+    }
+    auto* var = var_slots.Var(slot);
     auto* tensor = var->GetMutable<phi::DenseTensor>();
     framework::DeserializeFromStream(ss, tensor, dev_ctx);
 
@@ -80,7 +100,7 @@ InterceptorMessage ComputeInterceptor::PrepareVarsMsg() {
                         "microbatch_scopes, but receive scope index %ld",
                         microbatch_scopes_.size(),
                         cur_scope_id_));
-  auto* scope = microbatch_scopes_[cur_scope_id_];
+  auto& var_slots = VarSlotsOf(cur_scope_id_);
 
   InterceptorMessage ready_msg;
   ready_msg.set_message_type(DATA_WITH_VARS);
@@ -92,12 +112,13 @@ InterceptorMessage ComputeInterceptor::PrepareVarsMsg() {
     vars->set_name(var_name);
     std::ostringstream ss;
     auto& dev_ctx = *pool.Get(place_);
-    auto* var = scope->FindVar(var_name);
-    PADDLE_ENFORCE(
-        var,
+    int slot = var_slots.Resolve(var_name);
+    PADDLE_ENFORCE_NE(
+        slot,
+        framework::VariableSlotTable::kInvalidSlot,
         common::errors::NotFound(
             "Variable %s not exists in scope %ld", var_name, cur_scope_id_));
-    const auto& tensor = var->Get<phi::DenseTensor>();
+    const auto& tensor = var_slots.Var(slot)->Get<phi::DenseTensor>();
     framework::SerializeToStream(ss, tensor, dev_ctx);
     vars->set_stensor(ss.str());
     VLOG(3) << "Prepare vars msg " << var_name << " with dimension "
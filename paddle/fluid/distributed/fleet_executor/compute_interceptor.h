@@ -18,6 +18,7 @@
 #include <utility>
 
 #include "paddle/fluid/distributed/fleet_executor/interceptor.h"
+#include "paddle/fluid/framework/variable_slot_table.h"
 
 namespace paddle {
 namespace distributed {
@@ -49,6 +50,8 @@ class ComputeInterceptor : public Interceptor {
   void PrepareDeps();
   InterceptorMessage PrepareVarsMsg();
   void DecodeMsgVars(const InterceptorMessage& msg);
+  // The variables resolved in the microbatch scope of scope_id.
+  framework::VariableSlotTable& VarSlotsOf(int64_t scope_id);
 
   bool IsInputReady();
   bool CanWriteOutput();
@@ -56,6 +59,7 @@ class ComputeInterceptor : public Interceptor {
       gen_step_to_scope_id_to_finish_flag_;
   int64_t start_micro_step_{-1};
   int64_t num_micro_step_{-1};
+  std::vector<framework::VariableSlotTable> scope_var_slots_;
 };
 
 }  // namespace distributed
@@ -661,6 +661,7 @@ bool DistModel::FetchResult(const phi::DenseTensor &fetch,
 bool DistModel::Run(const std::vector<DistModelTensor> &input_data,
                     std::vector<DistModelTensor> *output_data) {
   VLOG(3) << "DistModel run for once.";
+  std::lock_guard<std::mutex> lock(run_mutex_);
 
   DistModelTimer timer;
   timer.tic();
@@ -704,5 +705,56 @@ bool DistModel::Run(const std::vector<DistModelTensor> &input_data,
   return true;
 }
 
+void DistModel::RunAsync(const std::vector<DistModelTensor> &input_data,
+                         DistModelCallback callback) {
+  std::lock_guard<std::mutex> lock(request_mutex_);
+  if (!request_thread_.joinable()) {
+    request_thread_ = std::thread(&DistModel::RunRequests, this);
+  }
+  requests_.push_back({input_data, std::move(callback)});
+  ++running_requests_;
+  request_cv_.notify_one();
+}
+
+void DistModel::RunRequests() {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(request_mutex_);
+      request_cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+      if (requests_.empty()) return;
+      request = std::move(requests_.front());
+      requests_.pop_front();
+    }
+    std::vector<DistModelTensor> output_data;
+    bool ok = Run(request.input_data, &output_data);
+    if (request.callback) {
+      request.callback(ok, &output_data);
+    }
+    {
+      std::lock_guard<std::mutex> lock(request_mutex_);
+      --running_requests_;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+void DistModel::Wait() {
+  std::unique_lock<std::mutex> lock(request_mutex_);
+  done_cv_.wait(lock, [this] { return running_requests_ == 0; });
+}
+
+DistModel::~DistModel() {
+  {
+    std::lock_guard<std::mutex> lock(request_mutex_);
+    stop_ = true;
+  }
+  request_cv_.notify_one();
+  // the queued requests are run before the thread stops
+  if (request_thread_.joinable()) {
+    request_thread_.join();
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
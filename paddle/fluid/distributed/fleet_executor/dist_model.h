@@ -13,9 +13,14 @@
 // limitations under the License.
 
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "paddle/common/macros.h"
@@ -54,17 +59,38 @@ struct DistModelConfig {
   std::map<int64_t, std::vector<int64_t>> rank_to_ring_ids_{};
 };
 
+// Called with whether the request succeeded and its outputs.
+using DistModelCallback =
+    std::function<void(bool, std::vector<DistModelTensor>*)>;
+
 class DistModel {
  public:
   explicit DistModel(const DistModelConfig& config) : config_(config) {}
   bool Init();
   bool Run(const std::vector<DistModelTensor>& input_data,
            std::vector<DistModelTensor>* output_data);
-  ~DistModel() = default;
+  // Queues a request, which is run after the ones queued before it by a
+  // thread of the model, and calls callback with its outputs. The rank takes
+  // the next request as soon as it has sent this one to the next stage, so
+  // the requests in flight fill the stages of a pipeline. The ranks of a
+  // stage must be given the requests in the same order. The input data that
+  // does not own its memory must be kept until the callback.
+  void RunAsync(const std::vector<DistModelTensor>& input_data,
+                DistModelCallback callback);
+  // Waits until the requests queued by RunAsync are done.
+  void Wait();
+  ~DistModel();
 
  private:
   DISABLE_COPY_AND_ASSIGN(DistModel);
 
+  struct Request {
+    std::vector<DistModelTensor> input_data;
+    DistModelCallback callback;
+  };
+
+  void RunRequests();
+
   bool PrepareScope();
   bool PrepareProgram();
   bool LoadProgram();
@@ -101,6 +127,16 @@ class DistModel {
   std::shared_ptr<framework::Scope> scope_;
   phi::Place place_;
   std::shared_ptr<framework::ProgramDesc> program_;
+
+  // Run and the thread of the requests share the scope and feed tensors
+  std::mutex run_mutex_;
+  std::mutex request_mutex_;
+  std::condition_variable request_cv_;
+  std::condition_variable done_cv_;
+  std::deque<Request> requests_;
+  int64_t running_requests_{0};
+  bool stop_{false};
+  std::thread request_thread_;
 };
 
 }  // namespace distributed
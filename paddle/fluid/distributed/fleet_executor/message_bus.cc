@@ -14,17 +14,36 @@
 
 #include "paddle/fluid/distributed/fleet_executor/message_bus.h"
 
+#include <cctype>
 #include <chrono>
 #include <memory>
 #include <set>
 #include <thread>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/global.h"
 #include "paddle/phi/core/platform/gen_comm_id_helper.h"
 
+PHI_DEFINE_EXPORTED_bool(
+    fleet_executor_shm_transport,
+    true,
+    "Send the interceptor messages to the ranks on the same host through "
+    "shared memory instead of brpc.");
+
 namespace paddle::distributed {
 
+#if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
+namespace {
+// The listen thread of the shm inbox wakes up at least once per timeout.
+constexpr int64_t kShmConsumeTimeoutUs = 1000;
+
+std::string GetHost(const std::string& addr) {
+  return addr.substr(0, addr.rfind(':'));
+}
+}  // namespace
+#endif
+
 void MessageBus::Init(
     int64_t rank,
     const std::unordered_map<int64_t, std::string>& rank_to_addr,
@@ -66,6 +85,9 @@ void MessageBus::Init(
 #endif
 
   ListenPort();
+#if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
+  InitShmInbox();
+#endif
 }
 
 bool MessageBus::IsInit() const { return is_init_; }
@@ -75,6 +97,12 @@ MessageBus::~MessageBus() {
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   server_.Stop(1000);
   server_.Join();
+  if (shm_listen_thread_.joinable()) {
+    shm_stop_ = true;
+    shm_listen_thread_.join();
+  }
+  shm_inbox_.reset();
+  shm_peers_.clear();
 #endif
 }
 
@@ -94,6 +122,10 @@ bool MessageBus::Send(int64_t dst_rank,
       common::errors::PreconditionNotMet(
           "Using message bus since it has not been initialized."));
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
+  if (SendIntraHost(dst_rank, interceptor_message)) {
+    VLOG(3) << "Message bus sends intra host successfully.";
+    return true;
+  }
   int retry_time = 0;  // message bus will retry sending for 10 times
   while (retry_time < 10) {
     ++retry_time;
@@ -247,6 +279,96 @@ bool MessageBus::SendInterRank(int64_t dst_rank,
   }
 }
 
+bool MessageBus::SendIntraHost(int64_t dst_rank,
+                               const InterceptorMessage& interceptor_message) {
+  // the barrier is rare and goes through brpc
+  if (interceptor_message.ctrl_message()) {
+    return false;
+  }
+  ShmMessageChannel* peer = GetShmPeer(dst_rank);
+  if (peer == nullptr) {
+    return false;
+  }
+  if (peer->Push(interceptor_message)) {
+    return true;
+  }
+  // The message is too large for a slot. Wait for the messages in the shm
+  // inbox, otherwise brpc may deliver this one before them.
+  VLOG(3) << "Message bus sends the message to rank " << dst_rank
+          << " by brpc since it does not fit the shm inbox.";
+  peer->WaitConsumed();
+  return false;
+}
+
+void MessageBus::InitShmInbox() {
+  if (!FLAGS_fleet_executor_shm_transport || addr_.empty()) {
+    return;
+  }
+  shm_inbox_ = ShmMessageChannel::Create(GetShmInboxName(rank_));
+  if (shm_inbox_ == nullptr) {
+    LOG(WARNING) << "Message bus can not create the shm inbox, the messages "
+                    "from the same host will go through brpc.";
+    return;
+  }
+  shm_listen_thread_ = std::thread([this] {
+    auto handler = [this](const InterceptorMessage& interceptor_message) {
+      VLOG(3) << "Message bus receives a message from interceptor "
+              << interceptor_message.src_id() << " to interceptor "
+              << interceptor_message.dst_id() << " by shm, with the message: "
+              << interceptor_message.message_type();
+      try {
+        if (!DispatchMsgToCarrier(interceptor_message)) {
+          LOG(ERROR) << "Message bus fails to dispatch the message from "
+                     << interceptor_message.src_id() << " to "
+                     << interceptor_message.dst_id() << ".";
+        }
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Message bus fails to dispatch the message from "
+                   << interceptor_message.src_id() << " to "
+                   << interceptor_message.dst_id() << ": " << e.what();
+      }
+    };
+    while (!shm_stop_) {
+      shm_inbox_->Consume(handler, kShmConsumeTimeoutUs);
+    }
+  });
+  LOG(INFO) << "Message bus's shm inbox " << shm_inbox_->name()
+            << " starts successful.";
+}
+
+ShmMessageChannel* MessageBus::GetShmPeer(int64_t dst_rank) {
+  std::lock_guard<std::mutex> lock(shm_peers_mutex_);
+  auto it = shm_peers_.find(dst_rank);
+  if (it == shm_peers_.end()) {
+    // The inboxes are created in Init, which all the ranks have finished
+    // after the barrier, so a failure is not retried.
+    std::unique_ptr<ShmMessageChannel> peer;
+    if (FLAGS_fleet_executor_shm_transport && IsSameHost(dst_rank)) {
+      peer = ShmMessageChannel::Open(GetShmInboxName(dst_rank));
+      VLOG(3) << "Message bus " << (peer ? "sends" : "can not send")
+              << " the messages to rank " << dst_rank << " by shm.";
+    }
+    it = shm_peers_.emplace(dst_rank, std::move(peer)).first;
+  }
+  return it->second.get();
+}
+
+std::string MessageBus::GetShmInboxName(int64_t rank) const {
+  // The address of rank 0 tells the jobs apart.
+  const auto& job_addr =
+      rank_to_addr_.count(0) > 0 ? rank_to_addr_.at(0) : addr_;
+  std::string name = "/paddle_fleet_executor_";
+  for (char c : job_addr) {
+    name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+  }
+  name += "_" + std::to_string(rank);
+  return name;
+}
+
+bool MessageBus::IsSameHost(int64_t rank) const {
+  return !addr_.empty() && GetHost(GetAddr(rank)) == GetHost(addr_);
+}
+
 #endif
 
 }  // namespace paddle::distributed
@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -24,6 +26,7 @@
 #include "brpc/channel.h"
 #include "brpc/server.h"
 #include "paddle/fluid/distributed/fleet_executor/message_service.h"
+#include "paddle/fluid/distributed/fleet_executor/shm_message_channel.h"
 #endif
 
 #include "paddle/common/errors.h"
@@ -67,6 +70,16 @@ class MessageBus final {
   // send the message inter rank (dst is different rank with src)
   bool SendInterRank(int64_t dst_rank,
                      const InterceptorMessage& interceptor_message);
+
+  // send the message to a rank on the same host through its shm inbox,
+  // returns false if the message should go through brpc
+  bool SendIntraHost(int64_t dst_rank,
+                     const InterceptorMessage& interceptor_message);
+
+  void InitShmInbox();
+  ShmMessageChannel* GetShmPeer(int64_t dst_rank);
+  std::string GetShmInboxName(int64_t rank) const;
+  bool IsSameHost(int64_t rank) const;
 #endif
 
   bool is_init_{false};
@@ -83,6 +96,14 @@ class MessageBus final {
   MessageServiceImpl message_service_;
   // brpc server
   brpc::Server server_;
+
+  // the inbox of the messages from the ranks on the same host
+  std::unique_ptr<ShmMessageChannel> shm_inbox_;
+  std::thread shm_listen_thread_;
+  std::atomic<bool> shm_stop_{false};
+  // the inboxes of other ranks, nullptr if the rank is not reachable by shm
+  std::mutex shm_peers_mutex_;
+  std::unordered_map<int64_t, std::unique_ptr<ShmMessageChannel>> shm_peers_;
 #endif
 
   // for barrier
@@ -15,9 +15,65 @@
 #include "paddle/fluid/distributed/fleet_executor/runtime_graph.h"
 
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
+#include "paddle/fluid/framework/op_desc.h"
 
 namespace paddle::distributed {
 
+namespace {
+
+// Same as the default buffer size of the python side task node.
+constexpr int64_t kDefaultBuffSize = 2;
+
+const char* PipelineScheduleName(PipelineSchedule schedule) {
+  switch (schedule) {
+    case PipelineSchedule::k1F1B:
+      return "1F1B";
+    case PipelineSchedule::kInterleaved1F1B:
+      return "Interleaved1F1B";
+    case PipelineSchedule::kZeroBubble:
+      return "ZeroBubble";
+  }
+  return "Unknown";
+}
+
+void CheckPipelineScheduleOptions(const PipelineScheduleOptions& options) {
+  int64_t num_stages = static_cast<int64_t>(options.stage_ranks.size());
+  PADDLE_ENFORCE_GT(num_stages,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The stage ranks of the pipeline can not be empty."));
+  PADDLE_ENFORCE_EQ(
+      options.stage_id >= 0 && options.stage_id < num_stages,
+      true,
+      common::errors::InvalidArgument(
+          "The stage id must be in [0, %ld), but received %ld.",
+          num_stages,
+          options.stage_id));
+  PADDLE_ENFORCE_GE(options.num_micro_batches,
+                    1,
+                    common::errors::InvalidArgument(
+                        "num_micro_batches must >= 1, but received %ld",
+                        options.num_micro_batches));
+  PADDLE_ENFORCE_GE(options.num_virtual_stages,
+                    1,
+                    common::errors::InvalidArgument(
+                        "num_virtual_stages must >= 1, but received %ld",
+                        options.num_virtual_stages));
+  if (options.schedule == PipelineSchedule::k1F1B) {
+    PADDLE_ENFORCE_EQ(options.num_virtual_stages,
+                      1,
+                      common::errors::InvalidArgument(
+                          "The 1F1B schedule has only one model chunk per "
+                          "stage, but received num_virtual_stages=%ld. "
+                          "Use the Interleaved1F1B schedule instead.",
+                          options.num_virtual_stages));
+  }
+}
+
+}  // namespace
+
+RuntimeGraph::~RuntimeGraph() = default;
+
 std::string RuntimeGraph::DebugString() const {
   std::ostringstream os;
   os << "\nRuntime Graph Debug: \n";
@@ -28,4 +84,185 @@ std::string RuntimeGraph::DebugString() const {
   return os.str();
 }
 
+double RuntimeGraph::PredictBubbleRatio(
+    const PipelineScheduleOptions& options) {
+  CheckPipelineScheduleOptions(options);
+  auto num_stages = static_cast<double>(options.stage_ranks.size());
+  auto num_micro_batches = static_cast<double>(options.num_micro_batches);
+  auto num_virtual_stages = static_cast<double>(options.num_virtual_stages);
+  double work = num_micro_batches * num_virtual_stages;
+  if (options.schedule == PipelineSchedule::kZeroBubble) {
+    work *= 3;
+  }
+  return (num_stages - 1) / (work + num_stages - 1);
+}
+
+void RuntimeGraph::BuildPipelineGraph(const PipelineScheduleOptions& options,
+                                      const PipelineStageOps& ops) {
+  CheckPipelineScheduleOptions(options);
+  const bool split_bwd = options.schedule == PipelineSchedule::kZeroBubble;
+  const int64_t num_stages = static_cast<int64_t>(options.stage_ranks.size());
+  const int64_t num_chunks = options.num_virtual_stages;
+  const int64_t num_virtual_stages = num_stages * num_chunks;
+  const int64_t num_micro_batches = options.num_micro_batches;
+  const int64_t stage_id = options.stage_id;
+  const int64_t rank = options.stage_ranks[stage_id];
+  PADDLE_ENFORCE_EQ(
+      ops.fwd.size() == static_cast<size_t>(num_chunks) &&
+          ops.bwd.size() == static_cast<size_t>(num_chunks),
+      true,
+      common::errors::InvalidArgument(
+          "There must be %ld lists of forward and backward ops, one for each "
+          "model chunk, but received %d and %d.",
+          num_chunks,
+          ops.fwd.size(),
+          ops.bwd.size()));
+  if (split_bwd) {
+    PADDLE_ENFORCE_EQ(ops.bwd_weight.size(),
+                      static_cast<size_t>(num_chunks),
+                      common::errors::InvalidArgument(
+                          "There must be %ld lists of backward weight ops for "
+                          "the ZeroBubble schedule, but received %d.",
+                          num_chunks,
+                          ops.bwd_weight.size()));
+  }
+
+  // The task ids of a stage start from rank * num_tasks, in the order of
+  // lr, fwd of each chunk, bwd of each chunk, bwd_weight of each chunk, opt.
+  const int64_t num_tasks = 2 + num_chunks * (split_bwd ? 3 : 2);
+  auto task_id = [&](int64_t stage, int64_t offset) {
+    return options.stage_ranks[stage] * num_tasks + offset;
+  };
+  auto lr_id = [&](int64_t stage) { return task_id(stage, 0); };
+  auto fwd_id = [&](int64_t stage, int64_t chunk) {
+    return task_id(stage, 1 + chunk);
+  };
+  auto bwd_id = [&](int64_t stage, int64_t chunk) {
+    return task_id(stage, 1 + num_chunks + chunk);
+  };
+  auto bwd_weight_id = [&](int64_t stage, int64_t chunk) {
+    return task_id(stage, 1 + 2 * num_chunks + chunk);
+  };
+  auto opt_id = [&](int64_t stage) { return task_id(stage, num_tasks - 1); };
+
+  interceptor_id_to_node_.clear();
+  interceptor_id_to_rank_.clear();
+  task_nodes_.clear();
+  owned_task_nodes_.clear();
+  for (int64_t stage = 0; stage < num_stages; ++stage) {
+    for (int64_t offset = 0; offset < num_tasks; ++offset) {
+      interceptor_id_to_rank_.emplace(task_id(stage, offset),
+                                      options.stage_ranks[stage]);
+    }
+  }
+
+  auto create_node = [&](framework::OpRole role,
+                         const std::vector<framework::OpDesc*>& op_descs,
+                         int64_t id,
+                         const std::string& type) {
+    owned_task_nodes_.emplace_back(std::make_unique<TaskNode>(
+        static_cast<int32_t>(role), op_descs, rank, id, num_micro_batches));
+    TaskNode* node = owned_task_nodes_.back().get();
+    node->SetType(type);
+    interceptor_id_to_node_.emplace(id, node);
+    return node;
+  };
+
+  TaskNode* lr = create_node(
+      framework::OpRole::kLRSched, ops.lr, lr_id(stage_id), "Amplifier");
+  lr->SetRunPerSteps(num_micro_batches);
+  std::vector<TaskNode*> fwd(num_chunks);
+  std::vector<TaskNode*> bwd(num_chunks);
+  std::vector<TaskNode*> bwd_weight(num_chunks, nullptr);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    fwd[chunk] = create_node(framework::OpRole::kForward,
+                             ops.fwd[chunk],
+                             fwd_id(stage_id, chunk),
+                             "Compute");
+  }
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    bwd[chunk] = create_node(framework::OpRole::kBackward,
+                             ops.bwd[chunk],
+                             bwd_id(stage_id, chunk),
+                             "Compute");
+    if (split_bwd) {
+      bwd_weight[chunk] = create_node(framework::OpRole::kBackward,
+                                      ops.bwd_weight[chunk],
+                                      bwd_weight_id(stage_id, chunk),
+                                      "Compute");
+    }
+  }
+  TaskNode* opt = create_node(
+      framework::OpRole::kOptimize, ops.opt, opt_id(stage_id), "Amplifier");
+  opt->SetRunPerSteps(num_micro_batches);
+  opt->SetRunAtOffset(num_micro_batches - 1);
+
+  // Micro batch i runs the forward of the virtual stages 0, 1, ...,
+  // num_virtual_stages - 1, where virtual stage chunk * num_stages + stage
+  // is the chunk of that stage, and the backward in the reverse order.
+  auto stage_of = [&](int64_t virtual_stage) {
+    return virtual_stage % num_stages;
+  };
+  auto chunk_of = [&](int64_t virtual_stage) {
+    return virtual_stage / num_stages;
+  };
+
+  lr->AddDownstreamTask(fwd_id(stage_id, 0), kDefaultBuffSize);
+  fwd[0]->AddUpstreamTask(lr_id(stage_id), kDefaultBuffSize);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    int64_t virtual_stage = chunk * num_stages + stage_id;
+    int64_t in_flight = num_virtual_stages - virtual_stage;
+    fwd[chunk]->AddDownstreamTask(bwd_id(stage_id, chunk), in_flight);
+    bwd[chunk]->AddUpstreamTask(fwd_id(stage_id, chunk), in_flight);
+    if (virtual_stage > 0) {
+      int64_t prev_stage = stage_of(virtual_stage - 1);
+      int64_t prev_chunk = chunk_of(virtual_stage - 1);
+      fwd[chunk]->AddUpstreamTask(fwd_id(prev_stage, prev_chunk),
+                                  kDefaultBuffSize);
+      bwd[chunk]->AddDownstreamTask(bwd_id(prev_stage, prev_chunk),
+                                    kDefaultBuffSize);
+    }
+    if (virtual_stage < num_virtual_stages - 1) {
+      int64_t next_stage = stage_of(virtual_stage + 1);
+      int64_t next_chunk = chunk_of(virtual_stage + 1);
+      fwd[chunk]->AddDownstreamTask(fwd_id(next_stage, next_chunk),
+                                    kDefaultBuffSize);
+      bwd[chunk]->AddUpstreamTask(bwd_id(next_stage, next_chunk),
+                                  kDefaultBuffSize);
+    }
+    if (split_bwd) {
+      // The weight gradients of up to in_flight micro batches are deferred,
+      // which are the ones that 1F1B leaves the cooldown bubble for.
+      bwd[chunk]->AddDownstreamTask(bwd_weight_id(stage_id, chunk),
+                                    in_flight);
+      bwd_weight[chunk]->AddUpstreamTask(bwd_id(stage_id, chunk), in_flight);
+      bwd_weight[chunk]->AddDownstreamTask(opt_id(stage_id), kDefaultBuffSize);
+      opt->AddUpstreamTask(bwd_weight_id(stage_id, chunk), kDefaultBuffSize);
+    } else {
+      bwd[chunk]->AddDownstreamTask(opt_id(stage_id), kDefaultBuffSize);
+      opt->AddUpstreamTask(bwd_id(stage_id, chunk), kDefaultBuffSize);
+    }
+  }
+
+  task_nodes_.emplace_back(lr);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    task_nodes_.emplace_back(fwd[chunk]);
+  }
+  for (int64_t chunk = num_chunks - 1; chunk >= 0; --chunk) {
+    task_nodes_.emplace_back(bwd[chunk]);
+    if (split_bwd) {
+      task_nodes_.emplace_back(bwd_weight[chunk]);
+    }
+  }
+  task_nodes_.emplace_back(opt);
+
+  predicted_bubble_ratio_ = PredictBubbleRatio(options);
+  LOG(INFO) << "Build the " << PipelineScheduleName(options.schedule)
+            << " pipeline graph of stage " << stage_id << " with "
+            << num_stages << " stages, " << num_chunks
+            << " model chunks per stage and " << num_micro_batches
+            << " micro batches, the predicted bubble ratio is "
+            << predicted_bubble_ratio_ << ".";
+}
+
 }  // namespace paddle::distributed
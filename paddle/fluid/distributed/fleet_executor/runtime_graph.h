@@ -23,13 +23,39 @@
 #include "paddle/fluid/framework/op_proto_maker.h"
 
 namespace paddle {
+namespace framework {
+class OpDesc;
+}  // namespace framework
 namespace distributed {
 class TaskNode;
 
+enum class PipelineSchedule { k1F1B, kInterleaved1F1B, kZeroBubble };
+
+struct PipelineScheduleOptions {
+  PipelineSchedule schedule{PipelineSchedule::k1F1B};
+  // rank of each pipeline stage
+  std::vector<int64_t> stage_ranks;
+  int64_t stage_id{0};
+  int64_t num_micro_batches{1};
+  // number of model chunks per stage, must be 1 for k1F1B
+  int64_t num_virtual_stages{1};
+};
+
+// The ops of the current stage. fwd and bwd hold one list per model chunk.
+// For kZeroBubble, bwd computes the input gradients and bwd_weight the
+// weight gradients of each chunk, which must only read the vars of its chunk.
+struct PipelineStageOps {
+  std::vector<framework::OpDesc*> lr;
+  std::vector<std::vector<framework::OpDesc*>> fwd;
+  std::vector<std::vector<framework::OpDesc*>> bwd;
+  std::vector<std::vector<framework::OpDesc*>> bwd_weight;
+  std::vector<framework::OpDesc*> opt;
+};
+
 class RuntimeGraph final {
  public:
   RuntimeGraph() = default;
-  ~RuntimeGraph() = default;
+  ~RuntimeGraph();
   const std::unordered_map<int64_t, TaskNode*>& interceptor_id_to_node() const {
     return interceptor_id_to_node_;
   }
@@ -46,10 +72,35 @@ class RuntimeGraph final {
   }
   std::string DebugString() const;
 
+  // Generates the task nodes of the current stage and the ranks of the task
+  // nodes of all the stages. The stages of micro batch i run in the order of
+  // the virtual stages chunk * num_stages + stage_id, and the buffers between
+  // the forward and the backward of a virtual stage bound its in-flight
+  // micro batches like 1F1B does on a pipeline of all the virtual stages.
+  // kZeroBubble splits the backward so that the weight gradients, which no
+  // other stage waits for, can be deferred into the bubbles.
+  void BuildPipelineGraph(const PipelineScheduleOptions& options,
+                          const PipelineStageOps& ops);
+  // The task nodes generated by BuildPipelineGraph in the order of a micro
+  // batch, which is the order for the analysis of the unused vars.
+  const std::vector<TaskNode*>& task_nodes() const { return task_nodes_; }
+  double predicted_bubble_ratio() const { return predicted_bubble_ratio_; }
+
+  // Idle fraction of a stage with equal forward, backward input and backward
+  // weight time and no communication cost:
+  //   1F1B:        (p - 1) / (m + p - 1)
+  //   Interleaved: (p - 1) / (v * m + p - 1)
+  //   ZeroBubble:  (p - 1) / (3 * v * m + p - 1), the deferred weight
+  //                gradients fill two thirds of the 1F1B bubble
+  static double PredictBubbleRatio(const PipelineScheduleOptions& options);
+
  private:
   DISABLE_COPY_AND_ASSIGN(RuntimeGraph);
   std::unordered_map<int64_t, TaskNode*> interceptor_id_to_node_;
   std::unordered_map<int64_t, int64_t> interceptor_id_to_rank_;
+  std::vector<TaskNode*> task_nodes_;
+  std::vector<std::unique_ptr<TaskNode>> owned_task_nodes_;
+  double predicted_bubble_ratio_{0.0};
 };
 
 }  // namespace distributed
@@ -0,0 +1,381 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/fleet_executor/shm_message_channel.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+#endif
+
+#include "glog/logging.h"
+
+namespace paddle::distributed {
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint64_t kShmRingMagic = 0x5044464553484d31;  // PDFESHM1
+constexpr uint64_t kShmRingCapacity = 1024;
+constexpr size_t kShmSlotSize = 4096;
+// The owner polls the inbox at least once per timeout of Consume, it is
+// considered dead after so long without polling.
+constexpr uint64_t kShmOwnerTimeoutNs = 5000000000ULL;
+constexpr int kShmSpinCount = 2000;
+
+enum ShmSlotKind : uint32_t { kShmSlotFields = 0, kShmSlotProto = 1 };
+
+struct ShmSlotHeader {
+  std::atomic<uint64_t> sequence;
+  uint32_t kind;
+  uint32_t size;
+  int64_t src_id;
+  int64_t dst_id;
+  int64_t scope_idx;
+  int64_t gen_step;
+  int64_t start_micro_step;
+  int64_t num_micro_step;
+  int32_t message_type;
+};
+
+constexpr size_t kShmSlotPayloadSize = kShmSlotSize - sizeof(ShmSlotHeader);
+
+struct ShmSlot {
+  ShmSlotHeader header;
+  char payload[kShmSlotPayloadSize];
+};
+
+static_assert(sizeof(ShmSlot) == kShmSlotSize,
+              "The slot of the shm ring must be of kShmSlotSize.");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The shm ring requires lock free 64 bits atomics.");
+
+uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+}  // namespace
+
+// A bounded multi-producer queue (Vyukov), the sequence of a slot is its
+// position when it is free, and the position plus one when it holds a
+// message.
+struct ShmRing {
+  std::atomic<uint64_t> magic;
+  std::atomic<uint64_t> heartbeat_ns;
+  alignas(64) std::atomic<uint64_t> enqueue_pos;
+  alignas(64) std::atomic<uint64_t> dequeue_pos;
+  // bumped by every push, the owner sleeps on it with futex
+  alignas(64) std::atomic<uint32_t> futex_word;
+  std::atomic<uint32_t> sleeping;
+  alignas(64) ShmSlot slots[kShmRingCapacity];
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex requires a plain 32 bits word.");
+
+std::unique_ptr<ShmMessageChannel> ShmMessageChannel::Create(
+    const std::string& name) {
+  // the inbox of a crashed job with the same name
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "Failed to create the shm inbox " << name << ": "
+                 << std::strerror(errno);
+    return nullptr;
+  }
+  // reserve the pages, a sparse file in a full /dev/shm raises SIGBUS
+  int ret = posix_fallocate(fd, 0, sizeof(ShmRing));
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to allocate the shm inbox " << name << ": "
+                 << std::strerror(ret);
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  void* addr = mmap(
+      nullptr, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map the shm inbox " << name << ": "
+                 << std::strerror(errno);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  auto* ring = new (addr) ShmRing;
+  for (uint64_t i = 0; i < kShmRingCapacity; ++i) {
+    ring->slots[i].header.sequence.store(i, std::memory_order_relaxed);
+  }
+  ring->enqueue_pos.store(0, std::memory_order_relaxed);
+  ring->dequeue_pos.store(0, std::memory_order_relaxed);
+  ring->futex_word.store(0, std::memory_order_relaxed);
+  ring->sleeping.store(0, std::memory_order_relaxed);
+  ring->heartbeat_ns.store(NowNs(), std::memory_order_relaxed);
+  ring->magic.store(kShmRingMagic, std::memory_order_release);
+  return std::unique_ptr<ShmMessageChannel>(
+      new ShmMessageChannel(name, ring, /*is_owner=*/true));
+}
+
+std::unique_ptr<ShmMessageChannel> ShmMessageChannel::Open(
+    const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    VLOG(3) << "Failed to open the shm inbox " << name << ": "
+            << std::strerror(errno);
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(ShmRing)) {
+    close(fd);
+    return nullptr;
+  }
+  void* addr = mmap(
+      nullptr, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+  auto* ring = static_cast<ShmRing*>(addr);
+  if (ring->magic.load(std::memory_order_acquire) != kShmRingMagic) {
+    munmap(addr, sizeof(ShmRing));
+    return nullptr;
+  }
+  std::unique_ptr<ShmMessageChannel> channel(
+      new ShmMessageChannel(name, ring, /*is_owner=*/false));
+  if (!channel->IsOwnerAlive()) {
+    VLOG(3) << "The owner of the shm inbox " << name << " is not alive.";
+    return nullptr;
+  }
+  return channel;
+}
+
+ShmMessageChannel::ShmMessageChannel(const std::string& name,
+                                     ShmRing* ring,
+                                     bool is_owner)
+    : name_(name), ring_(ring), is_owner_(is_owner) {}
+
+ShmMessageChannel::~ShmMessageChannel() {
+  munmap(ring_, sizeof(ShmRing));
+  if (is_owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool ShmMessageChannel::IsOwnerAlive() const {
+  uint64_t heartbeat = ring_->heartbeat_ns.load(std::memory_order_relaxed);
+  uint64_t now = NowNs();
+  return now < heartbeat || now - heartbeat < kShmOwnerTimeoutNs;
+}
+
+bool ShmMessageChannel::Push(const InterceptorMessage& interceptor_message) {
+  const bool with_fields = !interceptor_message.ctrl_message() &&
+                           interceptor_message.vars_list_size() == 0;
+  size_t proto_size = 0;
+  if (!with_fields) {
+    proto_size = interceptor_message.ByteSizeLong();
+    if (proto_size > kShmSlotPayloadSize) {
+      return false;
+    }
+  }
+
+  uint64_t pos = ring_->enqueue_pos.load(std::memory_order_relaxed);
+  ShmSlot* slot = nullptr;
+  int spins = 0;
+  while (true) {
+    slot = &ring_->slots[pos % kShmRingCapacity];
+    uint64_t sequence = slot->header.sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<int64_t>(sequence - pos);
+    if (diff == 0) {
+      if (ring_->enqueue_pos.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the inbox is full
+      if (++spins % kShmSpinCount == 0 && !IsOwnerAlive()) {
+        return false;
+      }
+      std::this_thread::yield();
+      pos = ring_->enqueue_pos.load(std::memory_order_relaxed);
+    } else {
+      pos = ring_->enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  auto& header = slot->header;
+  header.src_id = interceptor_message.src_id();
+  header.dst_id = interceptor_message.dst_id();
+  if (with_fields) {
+    header.kind = kShmSlotFields;
+    header.size = 0;
+    header.message_type = interceptor_message.message_type();
+    header.scope_idx = interceptor_message.scope_idx();
+    header.gen_step = interceptor_message.gen_step();
+    header.start_micro_step = interceptor_message.start_micro_step();
+    header.num_micro_step = interceptor_message.num_micro_step();
+  } else {
+    header.kind = kShmSlotProto;
+    header.size = static_cast<uint32_t>(proto_size);
+    interceptor_message.SerializeToArray(slot->payload,
+                                         static_cast<int>(proto_size));
+  }
+  header.sequence.store(pos + 1, std::memory_order_release);
+
+  uint64_t pushed_end = pushed_end_.load(std::memory_order_relaxed);
+  while (pushed_end < pos + 1 &&
+         !pushed_end_.compare_exchange_weak(pushed_end, pos + 1)) {
+  }
+
+  ring_->futex_word.fetch_add(1);
+  if (ring_->sleeping.load() != 0) {
+    syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(&ring_->futex_word),
+            FUTEX_WAKE,
+            1,
+            nullptr,
+            nullptr,
+            0);
+  }
+  return true;
+}
+
+void ShmMessageChannel::WaitConsumed() const {
+  uint64_t pushed_end = pushed_end_.load(std::memory_order_acquire);
+  int spins = 0;
+  while (ring_->dequeue_pos.load(std::memory_order_acquire) < pushed_end) {
+    if (++spins % kShmSpinCount == 0 && !IsOwnerAlive()) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+int64_t ShmMessageChannel::Consume(
+    const std::function<void(const InterceptorMessage&)>& handler,
+    int64_t timeout_us) {
+  ring_->heartbeat_ns.store(NowNs(), std::memory_order_relaxed);
+  int64_t num_consumed = 0;
+  int spins = 0;
+  while (true) {
+    uint64_t pos = ring_->dequeue_pos.load(std::memory_order_relaxed);
+    ShmSlot* slot = &ring_->slots[pos % kShmRingCapacity];
+    auto& header = slot->header;
+    if (header.sequence.load(std::memory_order_acquire) == pos + 1) {
+      InterceptorMessage interceptor_message;
+      if (header.kind == kShmSlotFields) {
+        interceptor_message.set_src_id(header.src_id);
+        interceptor_message.set_dst_id(header.dst_id);
+        interceptor_message.set_message_type(
+            static_cast<MessageType>(header.message_type));
+        interceptor_message.set_scope_idx(header.scope_idx);
+        interceptor_message.set_gen_step(header.gen_step);
+        interceptor_message.set_start_micro_step(header.start_micro_step);
+        interceptor_message.set_num_micro_step(header.num_micro_step);
+      } else if (!interceptor_message.ParseFromArray(
+                     slot->payload, static_cast<int>(header.size))) {
+        LOG(ERROR) << "Failed to parse the message from " << header.src_id
+                   << " to " << header.dst_id << " in the shm inbox "
+                   << name_ << ".";
+      }
+      // the slot is released after the handler, so WaitConsumed of the
+      // senders covers the dispatch of the message
+      handler(interceptor_message);
+      header.sequence.store(pos + kShmRingCapacity, std::memory_order_release);
+      ring_->dequeue_pos.store(pos + 1, std::memory_order_release);
+      ++num_consumed;
+      spins = 0;
+      continue;
+    }
+    if (num_consumed > 0) {
+      return num_consumed;
+    }
+    if (++spins < kShmSpinCount) {
+      std::this_thread::yield();
+      continue;
+    }
+    // A push after reading the word changes it, so the wait returns
+    // immediately instead of missing the wake up.
+    uint32_t word = ring_->futex_word.load();
+    ring_->sleeping.store(1);
+    if (header.sequence.load(std::memory_order_acquire) != pos + 1) {
+      timespec ts;
+      ts.tv_sec = static_cast<time_t>(timeout_us / 1000000);
+      ts.tv_nsec = static_cast<long>((timeout_us % 1000000) * 1000);  // NOLINT
+      syscall(SYS_futex,
+              reinterpret_cast<uint32_t*>(&ring_->futex_word),
+              FUTEX_WAIT,
+              word,
+              &ts,
+              nullptr,
+              0);
+    }
+    ring_->sleeping.store(0);
+    return 0;
+  }
+}
+
+#else
+
+struct ShmRing {};
+
+std::unique_ptr<ShmMessageChannel> ShmMessageChannel::Create(
+    const std::string& name UNUSED) {
+  VLOG(3) << "The shm inbox is only available on Linux.";
+  return nullptr;
+}
+
+std::unique_ptr<ShmMessageChannel> ShmMessageChannel::Open(
+    const std::string& name UNUSED) {
+  return nullptr;
+}
+
+ShmMessageChannel::ShmMessageChannel(const std::string& name,
+                                     ShmRing* ring,
+                                     bool is_owner)
+    : name_(name), ring_(ring), is_owner_(is_owner) {}
+
+ShmMessageChannel::~ShmMessageChannel() = default;
+
+bool ShmMessageChannel::IsOwnerAlive() const { return false; }
+
+bool ShmMessageChannel::Push(
+    const InterceptorMessage& interceptor_message UNUSED) {
+  return false;
+}
+
+void ShmMessageChannel::WaitConsumed() const {}
+
+int64_t ShmMessageChannel::Consume(
+    const std::function<void(const InterceptorMessage&)>& handler UNUSED,
+    int64_t timeout_us UNUSED) {
+  return 0;
+}
+
+#endif
+
+}  // namespace paddle::distributed
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+struct ShmRing;
+
+// The inbox of a rank for the messages from the ranks on the same host, a
+// bounded ring of fixed size slots in POSIX shared memory. Any process can
+// push to the inbox, only the owner consumes it. The messages without vars
+// are copied field by field, the others are serialized into the slot if
+// they fit. Only available on Linux.
+class ShmMessageChannel final {
+ public:
+  // Creates the inbox of the current rank, returns nullptr on failure.
+  static std::unique_ptr<ShmMessageChannel> Create(const std::string& name);
+  // Opens the inbox of another rank, returns nullptr if it does not exist
+  // or its owner is not alive.
+  static std::unique_ptr<ShmMessageChannel> Open(const std::string& name);
+
+  ~ShmMessageChannel();
+
+  // Returns false if the message does not fit a slot, or the owner is not
+  // alive while the inbox is full.
+  bool Push(const InterceptorMessage& interceptor_message);
+
+  // Waits until the owner has consumed all the messages pushed by this
+  // process, so that a message sent by another transport is not reordered
+  // before them.
+  void WaitConsumed() const;
+
+  // Called by the owner, passes the messages to handler in the order they
+  // are pushed. Waits for at most timeout_us when the inbox is empty.
+  // Returns the number of consumed messages.
+  int64_t Consume(
+      const std::function<void(const InterceptorMessage&)>& handler,
+      int64_t timeout_us);
+
+  bool IsOwnerAlive() const;
+
+  const std::string& name() const { return name_; }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ShmMessageChannel);
+  ShmMessageChannel(const std::string& name, ShmRing* ring, bool is_owner);
+
+  std::string name_;
+  ShmRing* ring_;
+  bool is_owner_;
+  // position of the last message pushed by this process plus one
+  std::atomic<uint64_t> pushed_end_{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
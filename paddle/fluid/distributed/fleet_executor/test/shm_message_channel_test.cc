@@ -0,0 +1,126 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/fleet_executor/shm_message_channel.h"
+
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+std::string InboxName(const std::string& test) {
+  return "/pd_shm_message_channel_test_" + test + "_" +
+         std::to_string(getpid());
+}
+
+}  // namespace
+
+TEST(ShmMessageChannel, PushAndConsume) {
+  auto inbox = ShmMessageChannel::Create(InboxName("push"));
+  ASSERT_NE(inbox, nullptr);
+  EXPECT_TRUE(inbox->IsOwnerAlive());
+  EXPECT_EQ(ShmMessageChannel::Open(InboxName("none")), nullptr);
+  auto peer = ShmMessageChannel::Open(InboxName("push"));
+  ASSERT_NE(peer, nullptr);
+
+  // copied field by field
+  InterceptorMessage ready;
+  ready.set_src_id(1);
+  ready.set_dst_id(2);
+  ready.set_message_type(DATA_IS_READY);
+  ready.set_scope_idx(3);
+  ready.set_gen_step(4);
+  ready.set_start_micro_step(5);
+  ready.set_num_micro_step(6);
+  EXPECT_TRUE(peer->Push(ready));
+  // serialized into the slot
+  InterceptorMessage with_vars;
+  with_vars.set_src_id(2);
+  with_vars.set_dst_id(1);
+  with_vars.set_message_type(DATA_WITH_VARS);
+  auto* var = with_vars.add_vars_list();
+  var->set_name("x");
+  var->set_stensor(std::string(1000, 'a'));
+  EXPECT_TRUE(peer->Push(with_vars));
+  // larger than a slot
+  InterceptorMessage too_large = with_vars;
+  too_large.mutable_vars_list(0)->set_stensor(std::string(8192, 'b'));
+  EXPECT_FALSE(peer->Push(too_large));
+
+  std::vector<InterceptorMessage> received;
+  auto handler = [&](const InterceptorMessage& msg) {
+    received.push_back(msg);
+  };
+  EXPECT_EQ(inbox->Consume(handler, 1000), 2);
+  ASSERT_EQ(received.size(), 2UL);
+  EXPECT_EQ(received[0].SerializeAsString(), ready.SerializeAsString());
+  EXPECT_EQ(received[1].SerializeAsString(), with_vars.SerializeAsString());
+  peer->WaitConsumed();
+
+  // an empty inbox returns after the timeout
+  EXPECT_EQ(inbox->Consume(handler, 1000), 0);
+}
+
+TEST(ShmMessageChannel, MultipleProducers) {
+  auto inbox = ShmMessageChannel::Create(InboxName("producers"));
+  ASSERT_NE(inbox, nullptr);
+  // more messages than the slots of the ring, the producers wait for the
+  // owner when it is full
+  const int num_producers = 4;
+  const int num_messages = 2000;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([p] {
+      auto peer = ShmMessageChannel::Open(InboxName("producers"));
+      ASSERT_NE(peer, nullptr);
+      for (int i = 0; i < num_messages; ++i) {
+        InterceptorMessage msg;
+        msg.set_src_id(p);
+        msg.set_scope_idx(i);
+        msg.set_message_type(DATA_IS_USELESS);
+        ASSERT_TRUE(peer->Push(msg));
+      }
+      peer->WaitConsumed();
+    });
+  }
+
+  // the messages of each producer are received in the order of its pushes
+  std::vector<int64_t> next(num_producers, 0);
+  int64_t total = 0;
+  while (total < num_producers * num_messages) {
+    total += inbox->Consume(
+        [&](const InterceptorMessage& msg) {
+          ASSERT_EQ(msg.scope_idx(), next[msg.src_id()]);
+          ++next[msg.src_id()];
+        },
+        1000);
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  for (int p = 0; p < num_producers; ++p) {
+    EXPECT_EQ(next[p], num_messages);
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -14,6 +14,11 @@
 
 #include "paddle/fluid/distributed/index_dataset/index_sampler.h"
 
+#include <algorithm>
+#include <exception>
+#include <random>
+#include <thread>
+
 #include "paddle/fluid/framework/data_feed.h"
 
 namespace paddle {
@@ -72,6 +77,163 @@ std::vector<std::vector<uint64_t>> LayerWiseSampler::sample(
   }
   return outputs;
 }
+void LayerWiseSampler::BuildFlatLayers() {
+  layer_offsets_.assign(1, 0);
+  layer_codes_.clear();
+  layer_node_ids_.clear();
+  int level = tree_->Height() - 1;
+  for (size_t j = 0; j < layer_ids_.size(); ++j, --level) {
+    auto layer_codes = tree_->GetLayerCodes(level);
+    for (size_t k = 0; k < layer_codes.size(); ++k) {
+      layer_codes_.push_back(layer_codes[k]);
+      layer_node_ids_.push_back(layer_ids_[j][k].id());
+    }
+    layer_offsets_.push_back(layer_codes_.size());
+  }
+}
+
+int64_t LayerWiseSampler::FindInLayer(size_t j, uint64_t code) const {
+  auto begin = layer_codes_.begin() + layer_offsets_[j];
+  auto end = layer_codes_.begin() + layer_offsets_[j + 1];
+  auto it = std::lower_bound(begin, end, code);
+  if (it == end || *it != code) return -1;
+  return it - begin;
+}
+
+void LayerWiseSampler::SampleRange(const std::vector<uint64_t>& user_inputs,
+                                   const std::vector<uint64_t>& target_ids,
+                                   size_t user_feature_num,
+                                   bool with_hierarchy,
+                                   size_t begin,
+                                   size_t end,
+                                   uint64_t seed,
+                                   uint64_t* outputs) const {
+  const size_t row_size = user_feature_num + 2;
+  const uint64_t branch = tree_->Branch();
+  const auto& id_codes = tree_->id_codes_map_;
+  std::mt19937_64 engine(seed);
+  std::vector<uint64_t> user_codes(user_feature_num);
+  std::vector<bool> user_in_tree(user_feature_num);
+  uint64_t* row = outputs + begin * layer_counts_sum_ * row_size;
+  for (size_t i = begin; i < end; ++i) {
+    const uint64_t* user = user_inputs.data() + i * user_feature_num;
+    auto code_it = id_codes.find(target_ids[i]);
+    PADDLE_ENFORCE_NE(code_it,
+                      id_codes.end(),
+                      common::errors::InvalidArgument(
+                          "id = %d doesn't exist in Tree.", target_ids[i]));
+    uint64_t code = code_it->second;
+    if (with_hierarchy) {
+      for (size_t k = 0; k < user_feature_num; ++k) {
+        auto it = id_codes.find(user[k]);
+        user_in_tree[k] = it != id_codes.end();
+        user_codes[k] = user_in_tree[k] ? it->second : 0;
+      }
+    }
+    for (size_t j = 0; j < layer_ids_.size(); ++j) {
+      if (j > 0) {
+        code = (code - 1) / branch;
+        for (size_t k = 0; with_hierarchy && k < user_feature_num; ++k) {
+          user_codes[k] = (user_codes[k] - 1) / branch;
+        }
+      }
+      const uint64_t* layer_ids = layer_node_ids_.data() + layer_offsets_[j];
+      for (int r = 0; r <= layer_counts_[j]; ++r) {
+        uint64_t* cur = row + r * row_size;
+        for (size_t k = 0; k < user_feature_num; ++k) {
+          if (j > 0 && with_hierarchy) {
+            // the ids out of the tree are the fake node
+            int64_t pos = user_in_tree[k] ? FindInLayer(j, user_codes[k]) : -1;
+            cur[k] = pos < 0 ? tree_->fake_node_.id() : layer_ids[pos];
+          } else {
+            cur[k] = user[k];
+          }
+        }
+      }
+
+      int64_t positive = FindInLayer(j, code);
+      row[user_feature_num] =
+          positive < 0 ? tree_->fake_node_.id() : layer_ids[positive];
+      row[user_feature_num + 1] = 1;
+      row += row_size;
+      if (layer_counts_[j] == 0) continue;
+      const uint64_t layer_size = layer_offsets_[j + 1] - layer_offsets_[j];
+      const uint64_t num_candidates = layer_size - (positive < 0 ? 0 : 1);
+      std::uniform_int_distribution<uint64_t> dist(0, num_candidates - 1);
+      for (int r = 0; r < layer_counts_[j]; ++r) {
+        uint64_t sample_res = dist(engine);
+        if (positive >= 0 && sample_res >= static_cast<uint64_t>(positive)) {
+          ++sample_res;
+        }
+        row[user_feature_num] = layer_ids[sample_res];
+        row[user_feature_num + 1] = 0;
+        row += row_size;
+      }
+    }
+  }
+}
+
+std::vector<uint64_t> LayerWiseSampler::sample_batch(
+    const std::vector<uint64_t>& user_inputs,
+    const std::vector<uint64_t>& target_ids,
+    bool with_hierarchy,
+    int thread_num) {
+  size_t input_num = target_ids.size();
+  if (input_num == 0) return {};
+  PADDLE_ENFORCE_EQ(
+      user_inputs.size() % input_num,
+      0,
+      common::errors::InvalidArgument(
+          "The size of user_inputs = [%d] should be a multiple of the number "
+          "of targets = [%d].",
+          user_inputs.size(),
+          input_num));
+  for (size_t j = 0; j < layer_ids_.size(); ++j) {
+    PADDLE_ENFORCE_GT(
+        layer_offsets_[j + 1] - layer_offsets_[j],
+        static_cast<size_t>(layer_counts_[j] > 0 ? 1 : 0),
+        common::errors::InvalidArgument(
+            "The layer %d of the tree has no node to sample the negatives.",
+            tree_->Height() - 1 - j));
+  }
+  size_t user_feature_num = user_inputs.size() / input_num;
+  std::vector<uint64_t> outputs(input_num * layer_counts_sum_ *
+                                (user_feature_num + 2));
+
+  size_t num_threads = std::max(1, std::min<int>(thread_num, input_num));
+  size_t chunk = (input_num + num_threads - 1) / num_threads;
+  // the engines of the calls differ, and so do the ones of the threads
+  uint64_t seed = (batch_count_++ * num_threads) ^
+                  (static_cast<uint64_t>(seed_) << 32);
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto sample_chunk = [&](size_t t) {
+    try {
+      SampleRange(user_inputs,
+                  target_ids,
+                  user_feature_num,
+                  with_hierarchy,
+                  std::min(input_num, t * chunk),
+                  std::min(input_num, (t + 1) * chunk),
+                  seed + t,
+                  outputs.data());
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(sample_chunk, t);
+  }
+  sample_chunk(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+  return outputs;
+}
+
 void LayerWiseSampler::sample_from_dataset(
     const uint16_t sample_slot,
     std::vector<paddle::framework::Record>* src_datas,
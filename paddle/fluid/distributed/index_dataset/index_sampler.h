@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <atomic>
 #include <vector>
 
 #include "paddle/fluid/distributed/index_dataset/index_wrapper.h"
@@ -46,6 +47,16 @@ class IndexSampler {
       const std::vector<uint64_t>& input_targets,
       bool with_hierarchy = false) = 0;
 
+  // The rows of sample() in one flat vector, the user inputs are flat too.
+  virtual std::vector<uint64_t> sample_batch(
+      const std::vector<uint64_t>& user_inputs UNUSED,
+      const std::vector<uint64_t>& target_ids UNUSED,
+      bool with_hierarchy UNUSED = false,
+      int thread_num UNUSED = 1) {
+    PADDLE_THROW(common::errors::Unimplemented(
+        "sample_batch is not supported by this IndexSampler."));
+  }
+
   virtual void sample_from_dataset(
       const uint16_t sample_slot,
       std::vector<paddle::framework::Record>* src_datas,
@@ -113,12 +124,21 @@ class LayerWiseSampler : public IndexSampler {
       layer_index--;
       idx++;
     }
+    BuildFlatLayers();
   }
   std::vector<std::vector<uint64_t>> sample(
       const std::vector<std::vector<uint64_t>>& user_inputs,
       const std::vector<uint64_t>& target_ids,
       bool with_hierarchy) override;
 
+  // Samples the targets on thread_num threads, each drawing the negatives
+  // of its inputs by its own engine. A negative is drawn from the nodes of
+  // its layer but the positive, so there is no retry.
+  std::vector<uint64_t> sample_batch(const std::vector<uint64_t>& user_inputs,
+                                     const std::vector<uint64_t>& target_ids,
+                                     bool with_hierarchy,
+                                     int thread_num) override;
+
   void sample_from_dataset(
       const uint16_t sample_slot,
       std::vector<paddle::framework::Record>* src_datas,
@@ -132,6 +152,26 @@ class LayerWiseSampler : public IndexSampler {
   int start_sample_layer_{1};
   std::vector<std::shared_ptr<phi::math::Sampler>> sampler_vec_;
   std::vector<std::vector<IndexNode>> layer_ids_;
+
+  // The sampled layers in the order of layer_ids_, the codes and the ids
+  // of layer j in [layer_offsets_[j], layer_offsets_[j + 1]), the codes
+  // ascending.
+  void BuildFlatLayers();
+  // The position of code in layer j, -1 if it is not a node.
+  int64_t FindInLayer(size_t j, uint64_t code) const;
+  void SampleRange(const std::vector<uint64_t>& user_inputs,
+                   const std::vector<uint64_t>& target_ids,
+                   size_t user_feature_num,
+                   bool with_hierarchy,
+                   size_t begin,
+                   size_t end,
+                   uint64_t seed,
+                   uint64_t* outputs) const;
+
+  std::vector<size_t> layer_offsets_;
+  std::vector<uint64_t> layer_codes_;
+  std::vector<uint64_t> layer_node_ids_;
+  std::atomic<uint64_t> batch_count_{0};
 };
 
 }  // end namespace distributed
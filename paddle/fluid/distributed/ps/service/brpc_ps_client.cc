@@ -82,15 +82,6 @@ PD_DEFINE_int32(pserver_sparse_table_shard_num,
                 1000,
                 "sparse table shard for save & load");
 
-inline size_t get_sparse_shard(uint32_t shard_num,
-                               uint32_t server_num,
-                               uint64_t key) {
-  size_t remind = shard_num % server_num;
-  size_t local_shard_num =
-      remind == 0 ? shard_num / server_num : shard_num / server_num + 1;
-  return (key % shard_num) / local_shard_num;
-}
-
 void DownpourPsClientService::service(
     ::google::protobuf::RpcController *controller,
     const PsRequestMessage *request,
@@ -290,6 +281,42 @@ std::string BrpcPsClient::PullFlStrategy() {
   return _service._fl_strategy;
 }
 
+int32_t BrpcPsClient::ConnectServer(const PSHost &host) {
+  std::string server_ip_port = host.ip;
+  server_ip_port.append(":");
+  server_ip_port.append(std::to_string(host.port));
+  _server_channels.emplace_back();
+  auto &channels = _server_channels.back();
+  for (size_t j = 0; j < channels.size(); ++j) {
+    channels[j].reset(new brpc::Channel());
+    if (channels[j]->Init(server_ip_port.c_str(), "", &_channel_options) !=
+        0) {
+      VLOG(0) << "BrpcPSclient connect to Server:" << server_ip_port
+              << " Failed! Try again.";
+      std::string int_ip_port = GetIntTypeEndpoint(host.ip, host.port);
+      if (channels[j]->Init(int_ip_port.c_str(), "", &_channel_options) !=
+          0) {
+        LOG(ERROR) << "BrpcPSclient connect to Server:" << int_ip_port
+                   << " Failed!";
+        return -1;
+      }
+    }
+  }
+  _server_endpoints.push_back(server_ip_port);
+  if (_rdma_tables.empty()) {
+    return 0;
+  }
+  server_ip_port = GetIntTypeEndpoint(host.ip, host.port);
+  _rdma_server_channels.emplace_back(new brpc::Channel());
+  if (_rdma_server_channels.back()->Init(
+          server_ip_port.c_str(), "", &_rdma_channel_options) != 0) {
+    LOG(ERROR) << "BrpcPSclient connect to Server:" << server_ip_port
+               << " over RDMA Failed!";
+    return -1;
+  }
+  return 0;
+}
+
 int32_t BrpcPsClient::Initialize() {
   _async_call_num = 0;
 
@@ -300,34 +327,36 @@ int32_t BrpcPsClient::Initialize() {
   options.connect_timeout_ms = FLAGS_pserver_connect_timeout_ms;
   options.max_retry = 3;
 
-  std::ostringstream os;
-  std::string server_ip_port;
   std::string client_ip(butil::my_ip_cstr());
 
+  // the sparse tables sent over RDMA have their own channels
+  const auto &table_params = _config.worker_param().downpour_worker_param();
+  for (int i = 0; i < table_params.downpour_table_param_size(); ++i) {
+    if (table_params.downpour_table_param(i).use_rdma()) {
+      _rdma_tables.insert(table_params.downpour_table_param(i).table_id());
+    }
+  }
+  _channel_options = options;
+  _rdma_channel_options = options;
+  if (!_rdma_tables.empty() && !UseBrpcRdma(&_rdma_channel_options)) {
+    _rdma_tables.clear();
+  }
   // 获取server列表，并连接
   std::vector<PSHost> server_list = _env->GetPsServers();
-  _server_channels.resize(server_list.size());
-  for (size_t i = 0; i < server_list.size(); ++i) {
-    server_ip_port.assign(server_list[i].ip.c_str());
-    server_ip_port.append(":");
-    server_ip_port.append(std::to_string(server_list[i].port));
-    for (size_t j = 0; j < _server_channels[i].size(); ++j) {
-      _server_channels[i][j].reset(new brpc::Channel());
-      if (_server_channels[i][j]->Init(server_ip_port.c_str(), "", &options) !=
-          0) {
-        VLOG(0) << "BrpcPSclient connect to Server:" << server_ip_port
-                << " Failed! Try again.";
-        std::string int_ip_port =
-            GetIntTypeEndpoint(server_list[i].ip, server_list[i].port);
-        if (_server_channels[i][j]->Init(int_ip_port.c_str(), "", &options) !=
-            0) {
-          LOG(ERROR) << "BrpcPSclient connect to Server:" << int_ip_port
-                     << " Failed!";
-          return -1;
-        }
-      }
+  for (const auto &host : server_list) {
+    if (ConnectServer(host) != 0) {
+      return -1;
+    }
+  }
+  _start_server_num = server_list.size();
+  const auto &server_param = _config.server_param().downpour_server_param();
+  for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
+    const auto &table_param = server_param.downpour_table_param(i);
+    if (table_param.type() == PS_SPARSE_TABLE) {
+      _sparse_routers[table_param.table_id()] =
+          std::make_shared<SparseShardRouter>(table_param.shard_num(),
+                                              server_list.size());
     }
-    os << server_ip_port << ",";
   }
   // 启动client探听接口, 并相互建立连接
   StartClientService();
@@ -340,11 +369,28 @@ int32_t BrpcPsClient::Initialize() {
     if (type == PS_DENSE_TABLE) {
       _push_dense_task_queue_map[table_id] =
           ::paddle::framework::MakeChannel<DenseAsyncTask *>();
+      auto codec =
+          DenseTransportCodec::Create(worker_param.downpour_table_param(i));
+      if (codec != nullptr) {
+        _dense_codecs[table_id] = codec;
+      }
     }
     if (type == PS_SPARSE_TABLE) {
       _push_sparse_task_queue_map[table_id] =
           ::paddle::framework::MakeChannel<SparseAsyncTask *>();
       _push_sparse_merge_count_map[table_id] = 0;
+      auto codec = SparseTransportCodec::Create(
+          worker_param.downpour_table_param(i),
+          GetTableAccessor(table_id)->GetAccessorInfo());
+      if (codec != nullptr) {
+        _sparse_codecs[table_id] = codec;
+      }
+      auto cache = SparseWorkerCache::Create(
+          worker_param.downpour_table_param(i),
+          GetTableAccessor(table_id)->GetAccessorInfo());
+      if (cache != nullptr) {
+        _sparse_caches[table_id] = cache;
+      }
     }
   }
 
@@ -557,18 +603,29 @@ std::future<int32_t> BrpcPsClient::SendSaveCmd(
   return fut;
 }
 
+void BrpcPsClient::ClearSparseCache(int table_id) {
+  for (auto &itr : _sparse_caches) {
+    if (table_id == -1 || itr.first == static_cast<uint32_t>(table_id)) {
+      itr.second->Clear();
+    }
+  }
+}
+
 std::future<int32_t> BrpcPsClient::Shrink(uint32_t table_id,
                                           const std::string threshold) {
+  ClearSparseCache(table_id);
   return SendCmd(table_id, PS_SHRINK_TABLE, {threshold});
 }
 
 std::future<int32_t> BrpcPsClient::Load(const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparseCache(-1);
   return SendCmd(-1, PS_LOAD_ALL_TABLE, {epoch, mode});
 }
 std::future<int32_t> BrpcPsClient::Load(uint32_t table_id,
                                         const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparseCache(table_id);
   return SendCmd(table_id, PS_LOAD_ONE_TABLE, {epoch, mode});
 }
 
@@ -666,13 +723,16 @@ std::future<int32_t> BrpcPsClient::GetCacheThreshold(uint32_t table_id,
 }
 
 std::future<int32_t> BrpcPsClient::Clear() {
+  ClearSparseCache(-1);
   return SendCmd(-1, PS_CLEAR_ALL_TABLE, {});
 }
 std::future<int32_t> BrpcPsClient::Clear(uint32_t table_id) {
+  ClearSparseCache(table_id);
   return SendCmd(table_id, PS_CLEAR_ONE_TABLE, {});
 }
 
 std::future<int32_t> BrpcPsClient::Revert() {
+  ClearSparseCache(-1);
   return SendCmd(-1, PS_REVERT, {});
 }
 
@@ -798,12 +858,16 @@ std::future<int32_t> BrpcPsClient::PushSparseParam(size_t table_id,
                                                    size_t num,
                                                    void *done) {
   auto *accessor = GetTableAccessor(table_id);
+  auto *cache = GetSparseCache(table_id);
+  if (cache != nullptr) {
+    cache->Erase(keys, num);
+  }
   // 发送RPC请求
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
   std::future<int> fut = promise->get_future();
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   std::vector<std::vector<uint64_t>> ids;
   std::vector<std::vector<const float *>> value_ptrs;
   ids.resize(request_call_num);
@@ -834,7 +898,7 @@ std::future<int32_t> BrpcPsClient::PushSparseParam(size_t table_id,
       memcpy(push_data_ptr, value_ptr[i], value_size);
       push_data_ptr += value_size;
     }
-    PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
+    PsService_Stub rpc_stub(GetSparseChannel(shard_idx, table_id));
     closure->cntl(shard_idx)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     rpc_stub.service(closure->cntl(shard_idx),
@@ -848,10 +912,14 @@ std::future<int32_t> BrpcPsClient::PushSparseParam(size_t table_id,
 std::future<int32_t> BrpcPsClient::PullDense(Region *regions,
                                              size_t region_num,
                                              size_t table_id) {
+  auto *codec = GetDenseCodec(table_id);
+  if (codec != nullptr) {
+    return PullDenseChunks(regions, region_num, table_id, codec);
+  }
   auto timer = std::make_shared<CostTimer>("pserver_client_pull_dense");
   auto *accessor = GetTableAccessor(table_id);
   auto fea_dim = accessor->GetAccessorInfo().fea_dim;
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   uint32_t num_per_shard = DenseDimPerShard(fea_dim, request_call_num);
   // callback 将各shard结果，顺序填入region
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
@@ -923,12 +991,111 @@ std::future<int32_t> BrpcPsClient::PullDense(Region *regions,
   return fut;
 }
 
+// Copies size bytes of data to the regions, at offset of their bytes.
+static void FillDenseRegions(const char *data,
+                             size_t offset,
+                             size_t size,
+                             Region *regions,
+                             size_t region_num) {
+  for (size_t i = 0; i < region_num && size > 0; ++i) {
+    if (offset >= regions[i].size) {
+      offset -= regions[i].size;
+      continue;
+    }
+    size_t copy_size = std::min(size, regions[i].size - offset);
+    memcpy(regions[i].data + offset, data, copy_size);
+    data += copy_size;
+    size -= copy_size;
+    offset = 0;
+  }
+}
+
+// The chunks of a dense pull, each copied to the regions once received.
+struct DenseChunkPull {
+  std::atomic<size_t> waiting_num{0};
+  std::atomic<int32_t> ret{0};
+  std::promise<int32_t> promise;
+};
+
+std::future<int32_t> BrpcPsClient::PullDenseChunks(Region *regions,
+                                                   size_t region_num,
+                                                   size_t table_id,
+                                                   DenseTransportCodec *codec) {
+  auto timer = std::make_shared<CostTimer>("pserver_client_pull_dense");
+  auto *accessor = GetTableAccessor(table_id);
+  size_t select_dim = accessor->GetAccessorInfo().select_size / sizeof(float);
+  size_t server_num = _start_server_num;
+  uint32_t num_per_shard =
+      DenseDimPerShard(accessor->GetAccessorInfo().fea_dim, server_num);
+  uint32_t chunk_size = codec->ChunkSize(num_per_shard);
+  uint32_t chunk_num = (num_per_shard + chunk_size - 1) / chunk_size;
+
+  auto pull = std::make_shared<DenseChunkPull>();
+  pull->waiting_num = server_num * chunk_num;
+  std::future<int32_t> fut = pull->promise.get_future();
+  // the chunks of all the servers are in flight together
+  for (uint32_t c = 0; c < chunk_num; ++c) {
+    for (size_t i = 0; i < server_num; ++i) {
+      uint32_t offset = c * chunk_size;
+      uint32_t num = std::min(chunk_size, num_per_shard - offset);
+      size_t value_num = num * select_dim;
+      size_t region_offset =
+          (i * num_per_shard + offset) * select_dim * sizeof(float);
+      DownpourBrpcClosure *closure = new DownpourBrpcClosure(
+          1,
+          [pull, codec, regions, region_num, value_num, region_offset](
+              void *done) {
+            auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+            if (closure->check_response(0, PS_PULL_DENSE_TABLE) != 0) {
+              pull->ret = -1;
+            } else {
+              auto &res_io_buffer = closure->cntl(0)->response_attachment();
+              size_t res_size = codec->PullValueSize(value_num);
+              if (res_io_buffer.size() != res_size) {
+                LOG(ERROR) << "expect res_size:" << res_size
+                           << ", but size:" << res_io_buffer.size()
+                           << ", ignore this response";
+                pull->ret = -1;
+              } else {
+                thread_local std::vector<char> encoded;
+                thread_local std::vector<float> values;
+                encoded.resize(res_size);
+                values.resize(value_num);
+                res_io_buffer.copy_to(encoded.data(), res_size);
+                codec->DecodePullValues(
+                    encoded.data(), value_num, values.data());
+                FillDenseRegions(reinterpret_cast<char *>(values.data()),
+                                 region_offset,
+                                 value_num * sizeof(float),
+                                 regions,
+                                 region_num);
+              }
+            }
+            if (pull->waiting_num.fetch_sub(1) == 1) {
+              pull->promise.set_value(pull->ret);
+            }
+          });
+      closure->add_timer(timer);
+      closure->request(0)->set_cmd_id(PS_PULL_DENSE_TABLE);
+      closure->request(0)->set_table_id(table_id);
+      closure->request(0)->set_client_id(_client_id);
+      closure->request(0)->add_params((char *)&num, sizeof(num));  // NOLINT
+      closure->request(0)->add_params((char *)&offset,             // NOLINT
+                                      sizeof(offset));
+      PsService_Stub rpc_stub(GetDenseChannel(i));
+      rpc_stub.service(
+          closure->cntl(0), closure->request(0), closure->response(0), closure);
+    }
+  }
+  return fut;
+}
+
 std::future<int32_t> BrpcPsClient::PushDenseParam(const Region *regions,
                                                   size_t region_num,
                                                   size_t table_id) {
   auto *accessor = GetTableAccessor(table_id);
   auto accessor_info = accessor->GetAccessorInfo();
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   // 1.拆分Region数据到shard中，后续多shard并行拷贝数据
   std::vector<std::vector<Region>> regions_partition(request_call_num);
   uint32_t num_per_shard =
@@ -1010,7 +1177,6 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     const float **update_values,
     size_t num,
     void *done) {
-  auto *accessor = GetTableAccessor(table_id);
   // 发送RPC请求
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
@@ -1023,18 +1189,10 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   ids.resize(request_call_num);
   value_ptrs.resize(request_call_num);
 
-  const auto &server_param = _config.server_param().downpour_server_param();
-  uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
-  for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
-    const auto &table_param = server_param.downpour_table_param(i);
-    if (table_param.table_id() == table_id) {
-      shard_num = table_param.shard_num();
-      break;
-    }
-  }
+  auto routing = GetSparseRouting(table_id);
 
   for (size_t i = 0; i < num; ++i) {
-    size_t pserver_idx = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    size_t pserver_idx = routing->ServerOf(keys[i]);
     ids[pserver_idx].push_back(keys[i]);
     value_ptrs[pserver_idx].push_back(update_values[i]);
   }
@@ -1044,7 +1202,6 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     auto value_ptr = value_ptrs[shard_idx];
 
     size_t kv_size = kvs.size();
-    uint32_t value_size = accessor->GetAccessorInfo().update_size;
 
     // 发送RPC请求
     auto *push_request = closure->request(shard_idx);
@@ -1052,19 +1209,13 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
     push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
-    auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
-    push_data_ptr += kv_size * sizeof(uint64_t);
-
-    for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
-      push_data_ptr += value_size;
-    }
-    PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
-    closure->cntl(shard_idx)->set_request_compress_type(
-        (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+    SerializePushSparseGrad(table_id,
+                            kvs.data(),
+                            value_ptr.data(),
+                            kv_size,
+                            push_request->mutable_data(),
+                            closure->cntl(shard_idx));
+    PsService_Stub rpc_stub(GetSparseChannel(shard_idx, table_id));
     rpc_stub.service(closure->cntl(shard_idx),
                      closure->request(shard_idx),
                      closure->response(shard_idx),
@@ -1078,7 +1229,7 @@ std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     float *total_send_data,
     size_t total_send_data_size,
     void *done) {
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
@@ -1110,7 +1261,7 @@ std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
 std::future<int32_t> BrpcPsClient::PushGlobalStep(int table_id,
                                                   int64_t *total_send_data,
                                                   void *done) {
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
@@ -1136,6 +1287,61 @@ std::future<int32_t> BrpcPsClient::PushGlobalStep(int table_id,
   return fut;
 }
 
+// Copies the pulled values of the sorted keys of each shard from the response
+// attachments, the same keys share the value of the first of them.
+static int FillPulledSparseValues(
+    DownpourBrpcClosure *closure,
+    const std::vector<std::vector<std::pair<uint64_t, float *>>>
+        &shard_sorted_kvs,
+    size_t value_size,
+    SparseTransportCodec *codec) {
+  size_t row_size = codec == nullptr ? value_size : codec->PullValueSize();
+  std::vector<char> row(row_size);
+  for (size_t i = 0; i < shard_sorted_kvs.size(); ++i) {
+    if (closure->check_response(i, PS_PULL_SPARSE_TABLE) != 0) {
+      return -1;
+    }
+
+    auto &request_kvs = shard_sorted_kvs.at(i);
+    butil::IOBuf decompressed;
+    const butil::IOBuf *res_io_buffer =
+        &closure->cntl(i)->response_attachment();
+    if (codec != nullptr && codec->CompressAttachment() &&
+        !request_kvs.empty()) {
+      if (!SparseTransportCodec::Decompress(*res_io_buffer, &decompressed)) {
+        LOG(WARNING) << "res data is not in snappy format";
+        return -1;
+      }
+      res_io_buffer = &decompressed;
+    }
+    butil::IOBufBytesIterator io_buffer_itr(*res_io_buffer);
+    uint64_t last_key = UINT64_MAX;
+    float *last_value_data = NULL;
+
+    for (auto &kv_pair : request_kvs) {
+      if (kv_pair.first == last_key) {
+        memcpy(reinterpret_cast<void *>(kv_pair.second),
+               reinterpret_cast<void *>(last_value_data),
+               value_size);
+      } else {
+        last_key = kv_pair.first;
+        last_value_data = kv_pair.second;
+        void *dst = codec == nullptr
+                        ? reinterpret_cast<void *>(last_value_data)
+                        : reinterpret_cast<void *>(row.data());
+        if (row_size != io_buffer_itr.copy_and_forward(dst, row_size)) {
+          LOG(WARNING) << "res data is lack or not in format";
+          return -1;
+        }
+        if (codec != nullptr) {
+          codec->DecodePullValue(row.data(), last_value_data);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
 std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                                               size_t table_id,
                                               const uint64_t *keys,
@@ -1150,55 +1356,35 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       std::vector<std::vector<std::pair<uint64_t, float *>>>>();
   shard_sorted_kvs->resize(request_call_num);
 
-  const auto &server_param = _config.server_param().downpour_server_param();
-  uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
-  for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
-    const auto &table_param = server_param.downpour_table_param(i);
-    if (table_param.table_id() == table_id) {
-      shard_num = table_param.shard_num();
-      break;
-    }
-  }
+  auto routing = GetSparseRouting(table_id);
 
+  // the fresh cached values are not pulled
+  auto *cache = GetSparseCache(table_id);
+  uint64_t pull_id = cache == nullptr ? 0 : cache->NextPull();
   for (size_t i = 0; i < num; ++i) {
-    size_t shard_id = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    if (cache != nullptr && cache->Get(keys[i], pull_id, select_values[i])) {
+      continue;
+    }
+    size_t shard_id = routing->ServerOf(keys[i]);
     shard_sorted_kvs->at(shard_id).push_back({keys[i], select_values[i]});
   }
 
   auto *accessor = GetTableAccessor(table_id);
 
   size_t value_size = accessor->GetAccessorInfo().select_size;
+  auto *codec = GetSparseCodec(table_id);
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
-        int ret = 0;
+      request_call_num,
+      [shard_sorted_kvs, value_size, codec, cache, pull_id](void *done) {
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
-        for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
-          if (closure->check_response(i, PS_PULL_SPARSE_TABLE) != 0) {
-            ret = -1;
-            break;
-          }
-
-          auto &request_kvs = shard_sorted_kvs->at(i);
-          auto &res_io_buffer = closure->cntl(i)->response_attachment();
-          butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
-          uint64_t last_key = UINT64_MAX;
-          float *last_value_data = NULL;
-
-          for (auto &kv_pair : request_kvs) {
-            if (kv_pair.first == last_key) {
-              memcpy(reinterpret_cast<void *>(kv_pair.second),
-                     reinterpret_cast<void *>(last_value_data),
-                     value_size);
-            } else {
-              last_key = kv_pair.first;
-              last_value_data = kv_pair.second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
-                LOG(WARNING) << "res data is lack or not in format";
-                ret = -1;
-                break;
+        int ret = FillPulledSparseValues(
+            closure, *shard_sorted_kvs, value_size, codec);
+        if (ret == 0 && cache != nullptr) {
+          for (auto &sorted_kvs : *shard_sorted_kvs) {
+            for (size_t i = 0; i < sorted_kvs.size(); ++i) {
+              if (i == 0 || sorted_kvs[i].first != sorted_kvs[i - 1].first) {
+                cache->Put(sorted_kvs[i].first, pull_id, sorted_kvs[i].second);
               }
             }
           }
@@ -1253,7 +1439,7 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
-      PsService_Stub rpc_stub(GetCmdChannel(i));
+      PsService_Stub rpc_stub(GetTableChannel(i, table_id, GetCmdChannel(i)));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
           closure->cntl(i), closure->request(i), closure->response(i), closure);
@@ -1269,7 +1455,7 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
                                                    size_t num,
                                                    bool is_training) {
   auto timer = std::make_shared<CostTimer>("pserver_client_pull_sparse_param");
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
 
   auto shard_sorted_kvs = std::make_shared<
       std::vector<std::vector<std::pair<uint64_t, float *>>>>();
@@ -1282,41 +1468,12 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
 
   auto *accessor = GetTableAccessor(table_id);
   size_t value_size = accessor->GetAccessorInfo().select_size;
+  auto *codec = GetSparseCodec(table_id);
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
-        int ret = 0;
+      request_call_num, [shard_sorted_kvs, value_size, codec](void *done) {
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
-        for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
-          if (closure->check_response(i, PS_PULL_SPARSE_TABLE) != 0) {
-            ret = -1;
-            break;
-          }
-
-          auto &request_kvs = shard_sorted_kvs->at(i);
-          auto &res_io_buffer = closure->cntl(i)->response_attachment();
-          butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
-          uint64_t last_key = UINT64_MAX;
-          float *last_value_data = NULL;
-
-          // can remove sort&unique
-          for (auto &kv_pair : request_kvs) {
-            if (kv_pair.first == last_key) {
-              memcpy(reinterpret_cast<void *>(kv_pair.second),
-                     reinterpret_cast<void *>(last_value_data),
-                     value_size);
-            } else {
-              last_key = kv_pair.first;
-              last_value_data = kv_pair.second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
-                LOG(WARNING) << "res data is lack or not in format";
-                ret = -1;
-                break;
-              }
-            }
-          }
-        }
+        int ret = FillPulledSparseValues(
+            closure, *shard_sorted_kvs, value_size, codec);
         closure->set_promise_value(ret);
       });
 
@@ -1368,7 +1525,7 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
-      PsService_Stub rpc_stub(GetCmdChannel(i));
+      PsService_Stub rpc_stub(GetTableChannel(i, table_id, GetCmdChannel(i)));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
           closure->cntl(i), closure->request(i), closure->response(i), closure);
@@ -1403,6 +1560,42 @@ std::future<int32_t> BrpcPsClient::SendClient2ClientMsg(
   return fut;
 }
 
+void BrpcPsClient::SerializePushSparseGrad(size_t table_id,
+                                           const uint64_t *keys,
+                                           const float *const *grads,
+                                           size_t num,
+                                           std::string *push_data,
+                                           brpc::Controller *cntl) {
+  /*
+  Push Content:
+  |---keysData---|---gradsData: in the wire format of the table---|
+  |---8*{num}B---|------------------------------------------------|
+  */
+  auto *codec = GetSparseCodec(table_id);
+  size_t grad_size =
+      codec == nullptr
+          ? GetTableAccessor(table_id)->GetAccessorInfo().update_size
+          : codec->PushGradSize();
+  push_data->resize(num * (sizeof(uint64_t) + grad_size));
+  char *push_data_ptr = const_cast<char *>(push_data->data());
+  memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
+  push_data_ptr += num * sizeof(uint64_t);
+  for (size_t i = 0; i < num; ++i) {
+    if (codec == nullptr) {
+      memcpy(push_data_ptr, grads[i], grad_size);
+    } else {
+      codec->EncodePushGrad(keys[i], grads[i], push_data_ptr);
+    }
+    push_data_ptr += grad_size;
+  }
+  if (codec != nullptr && codec->CompressAttachment()) {
+    cntl->set_request_compress_type(brpc::COMPRESS_TYPE_SNAPPY);
+  } else {
+    cntl->set_request_compress_type(
+        (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+  }
+}
+
 std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
     size_t table_id,
     const uint64_t *keys,
@@ -1410,8 +1603,6 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
     uint32_t num,
     void *done,
     int pserver_idx) {
-  auto *accessor = GetTableAccessor(table_id);
-  size_t value_size = accessor->GetAccessorInfo().update_size;
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
@@ -1423,18 +1614,13 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
   push_request->add_params((char *)&num, sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  push_data->resize(num * (sizeof(uint64_t) + value_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
-  push_data_ptr += num * sizeof(uint64_t);
-  for (uint32_t i = 0; i < num; ++i) {
-    memcpy(push_data_ptr, update_values[i], value_size);
-    push_data_ptr += value_size;
-  }
-  PsService_Stub rpc_stub(GetSparseChannel(pserver_idx));
-  closure->cntl(0)->set_request_compress_type(
-      (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+  SerializePushSparseGrad(table_id,
+                          keys,
+                          update_values,
+                          num,
+                          push_request->mutable_data(),
+                          closure->cntl(0));
+  PsService_Stub rpc_stub(GetSparseChannel(pserver_idx, table_id));
   rpc_stub.service(
       closure->cntl(0), closure->request(0), closure->response(0), closure);
   return fut;
@@ -1550,17 +1736,9 @@ std::future<int32_t> BrpcPsClient::PushSparse(size_t table_id,
   for (auto &x : shard_sorted_kv_list) {
     x.clear();
   }
-  const auto &server_param = _config.server_param().downpour_server_param();
-  uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
-  for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
-    const auto &table_param = server_param.downpour_table_param(i);
-    if (table_param.table_id() == table_id) {
-      shard_num = table_param.shard_num();
-      break;
-    }
-  }
+  auto routing = GetSparseRouting(table_id);
   for (size_t i = 0; i < num; ++i) {
-    size_t shard_id = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    size_t shard_id = routing->ServerOf(keys[i]);
     shard_sorted_kv_list[shard_id].push_back({keys[i], update_values[i]});
   }
   auto sparse_task_data = _sparse_task_pool.get();
@@ -1595,7 +1773,6 @@ std::future<int32_t> BrpcPsClient::PushSparse(size_t table_id,
 void BrpcPsClient::PushSparseTaskConsume() {
   uint64_t merge_size = FLAGS_pserver_push_sparse_merge_limit;
   std::vector<std::shared_ptr<SparseAsyncTask>> task_list;
-  size_t request_call_num = _server_channels.size();
   ::ThreadPool async_push_sparse_shard_threads(
       FLAGS_pserver_sparse_merge_thread);
   while (_running) {
@@ -1603,6 +1780,8 @@ void BrpcPsClient::PushSparseTaskConsume() {
     // 所有sparseTable的pushTask 进行处理
     for (auto &push_sparse_task_itr : _push_sparse_task_queue_map) {
       auto table_id = push_sparse_task_itr.first;
+      // grows once servers join, see AddPsServers
+      size_t request_call_num = _server_channels.size();
       auto *accessor = GetTableAccessor(table_id);
       auto &task_queue = push_sparse_task_itr.second;
       auto queue_size = task_queue->Size();
@@ -1857,25 +2036,18 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   push_request->set_client_id(_client_id);
   push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
                            sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  int update_size = accessor->GetAccessorInfo().update_size;
-  push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr,
-         merged_key_list.data(),
-         merged_kv_count * sizeof(uint64_t));
-  push_data_ptr += merged_kv_count * sizeof(uint64_t);
+  std::vector<const float *> merged_values(merged_kv_count);
   for (size_t i = 0; i < merged_kv_count; ++i) {
-    const char *task_data_ptr = merged_value_list[i].data();
-
-    memcpy(push_data_ptr,
-           (float *)(task_data_ptr),  // NOLINT
-           update_size);
-    push_data_ptr += update_size;
+    merged_values[i] =
+        reinterpret_cast<const float *>(merged_value_list[i].data());
   }
-  PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
-  closure->cntl(shard_idx)->set_request_compress_type(
-      (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+  SerializePushSparseGrad(table_id,
+                          merged_key_list.data(),
+                          merged_values.data(),
+                          merged_kv_count,
+                          push_request->mutable_data(),
+                          closure->cntl(shard_idx));
+  PsService_Stub rpc_stub(GetSparseChannel(shard_idx, table_id));
   rpc_stub.service(closure->cntl(shard_idx),
                    closure->request(shard_idx),
                    closure->response(shard_idx),
@@ -1906,7 +2078,7 @@ std::future<int32_t> BrpcPsClient::PushDense(const Region *regions,
   // auto dense_data = _dense_matrix_obj_pool.get();
   auto dense_data = std::make_shared<std::vector<float>>();
   auto async_task = new DenseAsyncTask(dense_data, table_id, push_timer);
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   uint32_t num_per_shard = DenseDimPerShard(fea_dim, request_call_num);
   // 将region数据拷贝到转置矩阵中
   async_task->data()->resize(num_per_shard * request_call_num * update_dim);
@@ -1955,7 +2127,11 @@ void BrpcPsClient::PushDenseTaskConsume() {
       task_queue->Get(task);
       auto *accessor = GetTableAccessor(task->table_id());
       // 设置请求回调
-      size_t request_call_num = _server_channels.size();
+      uint32_t num_per_shard = DenseDimPerShard(
+          accessor->GetAccessorInfo().fea_dim, _start_server_num);
+      uint32_t chunk_size = DenseChunkSize(task->table_id(), num_per_shard);
+      size_t request_call_num = _start_server_num *
+                                ((num_per_shard + chunk_size - 1) / chunk_size);
 
       DownpourBrpcClosure *closure = new DownpourBrpcClosure(
           request_call_num, [this, request_call_num](void *done) {
@@ -2046,7 +2222,7 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
                                         size_t total_send_data_size,
                                         DownpourBrpcClosure *closure) {
   auto *accessor = GetTableAccessor(task->table_id());
-  size_t request_call_num = _server_channels.size();
+  size_t request_call_num = _start_server_num;
   // 将数据拷贝到请求buffer区
   auto timer = std::make_shared<CostTimer>("pserver_client_push_dense_rpc");
   closure->add_timer(timer);
@@ -2054,6 +2230,41 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
       DenseDimPerShard(accessor->GetAccessorInfo().fea_dim, request_call_num);
   auto send_timer =
       std::make_shared<CostTimer>("pserver_client_push_dense_send");
+  auto *codec = GetDenseCodec(task->table_id());
+  if (codec != nullptr) {
+    uint32_t chunk_size = codec->ChunkSize(num_per_shard);
+    uint32_t chunk_num = (num_per_shard + chunk_size - 1) / chunk_size;
+    for (size_t i = 0; i < request_call_num; ++i) {
+      for (uint32_t c = 0; c < chunk_num; ++c) {
+        size_t idx = i * chunk_num + c;
+        uint32_t offset = c * chunk_size;
+        uint32_t num = std::min(chunk_size, num_per_shard - offset);
+        size_t grad_offset = i * num_per_shard + offset;
+        closure->request(idx)->set_cmd_id(PS_PUSH_DENSE_TABLE);
+        closure->request(idx)->set_table_id(task->table_id());
+        closure->request(idx)->set_client_id(_client_id);
+        closure->request(idx)->add_params((char *)&offset,  // NOLINT
+                                          sizeof(offset));
+        auto *push_data = closure->request(idx)->mutable_data();
+        push_data->clear();
+        push_data->resize(sizeof(uint32_t) + codec->PushGradSize(num));
+        char *push_data_ptr = const_cast<char *>(push_data->data());
+        memcpy(push_data_ptr, &num, sizeof(uint32_t));
+        codec->EncodePushGrads(grad_offset,
+                               total_send_data + grad_offset,
+                               num,
+                               push_data_ptr + sizeof(uint32_t));
+        closure->cntl(idx)->set_request_compress_type(
+            (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+        PsService_Stub rpc_stub(GetDenseChannel(i));
+        rpc_stub.service(closure->cntl(idx),
+                         closure->request(idx),
+                         closure->response(idx),
+                         closure);
+      }
+    }
+    return;
+  }
   for (size_t i = 0; i < request_call_num; ++i) {
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(task->table_id());
@@ -2074,5 +2285,109 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
   }
 }
 
+std::shared_ptr<const SparseShardRouting> BrpcPsClient::GetSparseRouting(
+    size_t table_id) {
+  auto itr = _sparse_routers.find(table_id);
+  if (itr != _sparse_routers.end()) {
+    return itr->second->Routing();
+  }
+  return std::make_shared<SparseShardRouting>(
+      FLAGS_pserver_sparse_table_shard_num, _start_server_num);
+}
+
+int32_t BrpcPsClient::AddPsServers(const std::vector<PSHost> &hosts) {
+  size_t server_num = _server_channels.size();
+  size_t rdma_server_num = _rdma_server_channels.size();
+  for (const auto &host : hosts) {
+    if (ConnectServer(host) != 0) {
+      _server_channels.resize(server_num);
+      _server_endpoints.resize(server_num);
+      _rdma_server_channels.resize(rdma_server_num);
+      return -1;
+    }
+  }
+  VLOG(0) << "BrpcPsClient add " << hosts.size() << " servers, "
+          << _server_channels.size() << " servers in all";
+  return 0;
+}
+
+std::future<int32_t> BrpcPsClient::MigrateSparseShards(
+    uint32_t table_id,
+    uint32_t from_server,
+    uint32_t to_server,
+    const std::vector<uint32_t> &shards,
+    bool final_pass) {
+  DownpourBrpcClosure *closure = new DownpourBrpcClosure(1, [](void *done) {
+    auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+    int ret = closure->check_response(0, PS_MIGRATE_SPARSE_SHARD);
+    closure->set_promise_value(ret);
+  });
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  closure->add_promise(promise);
+  std::future<int> fut = promise->get_future();
+  closure->request(0)->set_cmd_id(PS_MIGRATE_SPARSE_SHARD);
+  closure->request(0)->set_table_id(table_id);
+  closure->request(0)->set_client_id(_client_id);
+  closure->request(0)->add_params(_server_endpoints[to_server]);
+  closure->request(0)->add_params(final_pass ? "1" : "0");
+  for (auto shard_id : shards) {
+    closure->request(0)->add_params(std::to_string(shard_id));
+  }
+  PsService_Stub rpc_stub(GetCmdChannel(from_server));
+  closure->cntl(0)->set_timeout_ms(10800000);
+  rpc_stub.service(
+      closure->cntl(0), closure->request(0), closure->response(0), closure);
+  return fut;
+}
+
+int32_t BrpcPsClient::ReshardSparseTable(
+    uint32_t table_id, bool final_pass, std::vector<uint32_t> *shard_servers) {
+  // the plan is the same in both passes, as the routing switches after them
+  auto routing = GetSparseRouting(table_id);
+  std::vector<SparseShardMove> moves;
+  auto target = routing->PlanScaleOut(_server_channels.size(), &moves);
+  std::vector<std::future<int32_t>> rets;
+  for (const auto &move : moves) {
+    rets.push_back(MigrateSparseShards(
+        table_id, move.from, move.to, move.shards, final_pass));
+  }
+  int32_t ret = 0;
+  for (auto &fut : rets) {
+    if (fut.get() != 0) {
+      ret = -1;
+    }
+  }
+  if (ret != 0) {
+    LOG(ERROR) << "BrpcPsClient reshard table " << table_id
+               << (final_pass ? " final pass" : "") << " failed";
+    return -1;
+  }
+  VLOG(0) << "BrpcPsClient reshard table " << table_id
+          << (final_pass ? " final pass" : "") << ", " << moves.size()
+          << " moves to " << _server_channels.size() << " servers";
+  *shard_servers = target->ShardServers();
+  return 0;
+}
+
+int32_t BrpcPsClient::SwitchSparseRouting(
+    uint32_t table_id, const std::vector<uint32_t> &shard_servers) {
+  auto itr = _sparse_routers.find(table_id);
+  if (itr == _sparse_routers.end() ||
+      shard_servers.size() != itr->second->Routing()->ShardNum()) {
+    LOG(ERROR) << "BrpcPsClient switch routing of table " << table_id
+               << " failed, not a sparse table of the shards";
+    return -1;
+  }
+  for (auto server : shard_servers) {
+    if (server >= _server_channels.size()) {
+      LOG(ERROR) << "BrpcPsClient switch routing of table " << table_id
+                 << " failed, server " << server << " is not connected";
+      return -1;
+    }
+  }
+  itr->second->Switch(std::make_shared<SparseShardRouting>(shard_servers));
+  return 0;
+}
+
 }  // namespace distributed
 }  // namespace paddle
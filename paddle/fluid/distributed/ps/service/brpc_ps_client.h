@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "brpc/channel.h"
@@ -25,8 +26,12 @@
 #include "brpc/server.h"
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
+#include "paddle/fluid/distributed/ps/service/dense_transport.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/service/sparse_shard_router.h"
+#include "paddle/fluid/distributed/ps/service/sparse_transport.h"
+#include "paddle/fluid/distributed/ps/service/sparse_worker_cache.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -316,6 +321,31 @@ class BrpcPsClient : public PSClient {
   void PrintQueueSize();
   void PrintQueueSizeThread();
 
+  // Online resharding of the sparse tables, see SparseShardMigrator:
+  //  1. every client calls AddPsServers with the servers joining the job,
+  //     which serve only the resharded sparse tables;
+  //  2. one client calls ReshardSparseTable to stream the shards of a table
+  //     to the new servers while the training goes on;
+  //  3. once every client has flushed its pushes and waits at a barrier, the
+  //     same client calls ReshardSparseTable with final_pass, and every
+  //     client calls SwitchSparseRouting with the returned shard servers
+  //     before leaving the barrier.
+  // AddPsServers and SwitchSparseRouting are called when no request of the
+  // client is in flight.
+  int32_t AddPsServers(const std::vector<PSHost> &hosts);
+  int32_t ReshardSparseTable(uint32_t table_id,
+                             bool final_pass,
+                             std::vector<uint32_t> *shard_servers);
+  std::future<int32_t> MigrateSparseShards(uint32_t table_id,
+                                           uint32_t from_server,
+                                           uint32_t to_server,
+                                           const std::vector<uint32_t> &shards,
+                                           bool final_pass);
+  int32_t SwitchSparseRouting(uint32_t table_id,
+                              const std::vector<uint32_t> &shard_servers);
+
+  size_t GetStartServerNums() override { return _start_server_num; }
+
  protected:
   virtual size_t GetServerNums() { return _server_channels.size(); }
   inline brpc::Channel *GetSparseChannel(size_t server_id) {
@@ -327,6 +357,19 @@ class BrpcPsClient : public PSClient {
   inline brpc::Channel *GetCmdChannel(size_t server_id) {
     return _server_channels[server_id][2].get();
   }
+  // the RDMA channel to the server for the tables sent over RDMA, or the
+  // given channel
+  inline brpc::Channel *GetTableChannel(size_t server_id,
+                                        size_t table_id,
+                                        brpc::Channel *channel) {
+    if (_rdma_tables.empty() || _rdma_tables.count(table_id) == 0) {
+      return channel;
+    }
+    return _rdma_server_channels[server_id].get();
+  }
+  inline brpc::Channel *GetSparseChannel(size_t server_id, size_t table_id) {
+    return GetTableChannel(server_id, table_id, GetSparseChannel(server_id));
+  }
   int32_t Initialize() override;
 
   // for fl
@@ -366,6 +409,51 @@ class BrpcPsClient : public PSClient {
   std::unordered_map<uint32_t, paddle::framework::Channel<SparseAsyncTask *>>
       _push_sparse_task_queue_map;
   std::unordered_map<uint32_t, uint32_t> _push_sparse_merge_count_map;
+  // the wire format of the sparse tables not sent in raw fp32
+  std::unordered_map<uint32_t, std::shared_ptr<SparseTransportCodec>>
+      _sparse_codecs;
+
+  inline SparseTransportCodec *GetSparseCodec(size_t table_id) {
+    auto itr = _sparse_codecs.find(table_id);
+    return itr == _sparse_codecs.end() ? nullptr : itr->second.get();
+  }
+  // the wire format of the dense tables not sent in one raw fp32 request
+  std::unordered_map<uint32_t, std::shared_ptr<DenseTransportCodec>>
+      _dense_codecs;
+
+  inline DenseTransportCodec *GetDenseCodec(size_t table_id) {
+    auto itr = _dense_codecs.find(table_id);
+    return itr == _dense_codecs.end() ? nullptr : itr->second.get();
+  }
+  // the floats of the requests of the shard of a server of a dense table
+  inline uint32_t DenseChunkSize(size_t table_id, uint32_t num_per_shard) {
+    auto *codec = GetDenseCodec(table_id);
+    return codec == nullptr ? num_per_shard : codec->ChunkSize(num_per_shard);
+  }
+  // the servers of the shards of the sparse tables, the dense tables and the
+  // sparse params stay on the _start_server_num servers the job started with
+  std::unordered_map<uint32_t, std::shared_ptr<SparseShardRouter>>
+      _sparse_routers;
+  size_t _start_server_num = 0;
+  std::vector<std::string> _server_endpoints;
+
+  std::shared_ptr<const SparseShardRouting> GetSparseRouting(size_t table_id);
+  // appends the channels to the server
+  int32_t ConnectServer(const PSHost &host);
+  brpc::ChannelOptions _channel_options;
+  brpc::ChannelOptions _rdma_channel_options;
+
+  // the pulled values of the sparse tables cached on the worker
+  std::unordered_map<uint32_t, std::shared_ptr<SparseWorkerCache>>
+      _sparse_caches;
+
+  inline SparseWorkerCache *GetSparseCache(size_t table_id) {
+    auto itr = _sparse_caches.find(table_id);
+    return itr == _sparse_caches.end() ? nullptr : itr->second.get();
+  }
+  // drops the cached values of the table, or of all the tables if table_id
+  // is -1, before the table is written on the servers
+  void ClearSparseCache(int table_id);
 
   std::thread _print_thread;
 
@@ -384,12 +472,23 @@ class BrpcPsClient : public PSClient {
       DownpourBrpcClosure *closure,
       ValueAccessor *accessor);
 
+  // Fills push_data with |keys|gradients| of a PS_PUSH_SPARSE_TABLE request,
+  // in the wire format of the table.
+  void SerializePushSparseGrad(size_t table_id,
+                               const uint64_t *keys,
+                               const float *const *grads,
+                               size_t num,
+                               std::string *push_data,
+                               brpc::Controller *cntl);
+
   SparseTaskPool _sparse_task_pool;
 
   std::vector<std::shared_ptr<brpc::Channel>>
       _client_channels;  // client2client
   std::vector<std::array<std::shared_ptr<brpc::Channel>, 3>>
       _server_channels;  // client2server
+  std::unordered_set<uint32_t> _rdma_tables;
+  std::vector<std::shared_ptr<brpc::Channel>> _rdma_server_channels;
   std::vector<std::array<std::shared_ptr<brpc::Channel>, 1>>
       _coordinator_channels;  // client2coordinator
   std::future<int32_t> PushDenseRawGradient(int table_id,
@@ -424,6 +523,10 @@ class BrpcPsClient : public PSClient {
  private:
   int32_t StartClientService();
 
+  std::future<int32_t> PullDenseChunks(Region *regions,
+                                       size_t region_num,
+                                       size_t table_id,
+                                       DenseTransportCodec *codec);
   void PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,  // NOLINT
                             float *total_send_data,
                             size_t total_send_data_size,
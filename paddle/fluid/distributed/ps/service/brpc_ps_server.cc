@@ -79,6 +79,14 @@ uint64_t BrpcPsServer::Start(const std::string &ip, uint32_t port) {
   int num_threads = std::thread::hardware_concurrency();
   auto trainers = _environment->GetTrainers();
   options.num_threads = trainers > num_threads ? trainers : num_threads;
+  // the tables not over RDMA are still served over TCP
+  const auto &downpour_param = _config.downpour_server_param();
+  for (int i = 0; i < downpour_param.downpour_table_param_size(); ++i) {
+    if (downpour_param.downpour_table_param(i).use_rdma()) {
+      UseBrpcRdma(&options);
+      break;
+    }
+  }
 
   if (_server.Start(ip_port.c_str(), &options) != 0) {
     VLOG(0) << "BrpcPsServer start failed, ip_port= " << ip_port
@@ -221,6 +229,10 @@ int32_t BrpcPsService::Initialize() {
   _service_handler_map[PS_REVERT] = &BrpcPsService::Revert;
   _service_handler_map[PS_CHECK_SAVE_PRE_PATCH_DONE] =
       &BrpcPsService::CheckSavePrePatchDone;
+  _service_handler_map[PS_MIGRATE_SPARSE_SHARD] =
+      &BrpcPsService::MigrateSparseShard;
+  _service_handler_map[PS_IMPORT_SPARSE_VALUES] =
+      &BrpcPsService::ImportSparseValues;
 
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_server_pull_dense");
@@ -228,6 +240,36 @@ int32_t BrpcPsService::Initialize() {
   profiler.register_profiler("pserver_server_pull_sparse");
   profiler.register_profiler("pserver_server_push_sparse");
 
+  const auto &downpour_param = _config->downpour_server_param();
+  for (int i = 0; i < downpour_param.downpour_table_param_size(); ++i) {
+    const auto &table_param = downpour_param.downpour_table_param(i);
+    auto *table = _server->GetTable(table_param.table_id());
+    if (table == nullptr) {
+      continue;
+    }
+    if (table_param.type() == PS_DENSE_TABLE) {
+      auto codec = DenseTransportCodec::Create(table_param);
+      if (codec != nullptr) {
+        _dense_codecs[table_param.table_id()] = codec;
+      }
+      continue;
+    }
+    if (table_param.type() != PS_SPARSE_TABLE) {
+      continue;
+    }
+    auto codec = SparseTransportCodec::Create(
+        table_param, table->GetValueAccessor()->GetAccessorInfo());
+    if (codec != nullptr) {
+      _sparse_codecs[table_param.table_id()] = codec;
+    }
+    auto coalescer = SparsePullCoalescer::Create(table_param, table);
+    if (coalescer != nullptr) {
+      _pull_coalescers[table] = coalescer;
+    }
+    _shard_migrators[table] =
+        std::make_shared<SparseShardMigrator>(table_param, table);
+  }
+
   // shard初始化,server启动后才可从env获取到server_list的shard信息
   InitializeShardInfo();
 
@@ -242,6 +284,22 @@ int32_t BrpcPsService::Initialize() {
     return -1;                                             \
   }
 
+void BrpcPsService::InvalidatePullCache(Table *table) {
+  auto itr = _pull_coalescers.find(table);
+  if (itr != _pull_coalescers.end()) {
+    itr->second->InvalidateAll();
+  }
+}
+
+void BrpcPsService::TouchMigratingKeys(Table *table,
+                                       const uint64_t *keys,
+                                       size_t num) {
+  auto itr = _shard_migrators.find(table);
+  if (itr != _shard_migrators.end()) {
+    itr->second->Touch(keys, num);
+  }
+}
+
 int32_t BrpcPsService::InitializeShardInfo() {
   if (!_is_initialize_shard_info) {
     std::lock_guard<std::mutex> guard(_initialize_shard_mutex);
@@ -315,6 +373,13 @@ int32_t BrpcPsService::PullDense(Table *table,
   }
   CostTimer timer("pserver_server_pull_dense");
   uint32_t num = *(const uint32_t *)request.params(0).c_str();
+  // a chunk of the shard is pulled at its offset, in the dense_transport of
+  // the table
+  bool chunked = request.params_size() > 1;
+  uint32_t offset = 0;
+  if (chunked) {
+    offset = *(const uint32_t *)request.params(1).c_str();
+  }
 
   auto res_data = butil::get_object<std::vector<float>>();
   res_data->resize(num *
@@ -325,10 +390,21 @@ int32_t BrpcPsService::PullDense(Table *table,
   table_context.value_type = Dense;
   table_context.pull_context.values = res_data->data();
   table_context.num = num;
+  table_context.offset = offset;
   table->Pull(table_context);
 
-  cntl->response_attachment().append(reinterpret_cast<char *>(res_data->data()),
-                                     res_data->size() * sizeof(float));
+  auto codec_itr = _dense_codecs.find(request.table_id());
+  if (!chunked || codec_itr == _dense_codecs.end()) {
+    cntl->response_attachment().append(
+        reinterpret_cast<char *>(res_data->data()),
+        res_data->size() * sizeof(float));
+  } else {
+    auto *codec = codec_itr->second.get();
+    thread_local std::vector<char> encoded;
+    encoded.resize(codec->PullValueSize(res_data->size()));
+    codec->EncodePullValues(res_data->data(), res_data->size(), encoded.data());
+    cntl->response_attachment().append(encoded.data(), encoded.size());
+  }
   butil::return_object(res_data);
 
   return 0;
@@ -386,6 +462,8 @@ int32_t BrpcPsService::PushDense(Table *table,
   Push Content:
   |--num--|---valuesData---|
   |--4B---|----------------|
+  a chunk of the shard has its offset in params(0), and is in the
+  dense_transport of the table
   */
   uint32_t num = *(const uint32_t *)(request.data().data());
   TableContext table_context;
@@ -393,6 +471,23 @@ int32_t BrpcPsService::PushDense(Table *table,
   table_context.push_context.values =
       (const float *)(request.data().data() + sizeof(uint32_t));
   table_context.num = num;
+  bool chunked = request.params_size() > 0;
+  if (chunked) {
+    table_context.offset = *(const uint32_t *)request.params(0).c_str();
+  }
+  auto codec_itr = _dense_codecs.find(request.table_id());
+  if (chunked && codec_itr != _dense_codecs.end()) {
+    auto *codec = codec_itr->second.get();
+    if (req_buffer_size < sizeof(uint32_t) + codec->PushGradSize(num)) {
+      set_response_code(response, -1, "PushDense data is truncated");
+      return 0;
+    }
+    thread_local std::vector<float> grads;
+    grads.resize(num);
+    codec->DecodePushGrads(
+        request.data().data() + sizeof(uint32_t), num, grads.data());
+    table_context.push_context.values = grads.data();
+  }
   // const float *values = (const float *)(request.data().data() +
   // sizeof(uint32_t));
   if (table->Push(table_context) != 0) {
@@ -463,6 +558,11 @@ int32_t BrpcPsService::PushSparseParam(Table *table,
   if (table->Push(table_context) != 0) {
     set_response_code(response, -1, "PushSparseParam error");
   }
+  auto coalescer_itr = _pull_coalescers.find(table);
+  if (coalescer_itr != _pull_coalescers.end()) {
+    coalescer_itr->second->Invalidate(keys, num);
+  }
+  TouchMigratingKeys(table, keys, num);
   return 0;
 }
 
@@ -539,16 +639,44 @@ int32_t BrpcPsService::PullSparse(Table *table,
 
   auto res_data = butil::get_object<std::vector<float>>();
   res_data->resize(num * dim);
-  TableContext table_context;
-  table_context.value_type = Sparse;
-  table_context.pull_context.pull_value = value;
-  table_context.pull_context.values = res_data->data();
-  table->Pull(table_context);
-  // table->PullSparse(res_data->data(), value);
+  auto coalescer_itr = _pull_coalescers.find(table);
+  if (coalescer_itr != _pull_coalescers.end()) {
+    coalescer_itr->second->Pull(value, res_data->data());
+  } else {
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.pull_context.pull_value = value;
+    table_context.pull_context.values = res_data->data();
+    table->Pull(table_context);
+    // table->PullSparse(res_data->data(), value);
+  }
+  // the training pulls create the missing keys
+  if (value.is_training_) {
+    TouchMigratingKeys(table, value.feasigns_, num);
+  }
 
-  cntl->response_attachment().append(reinterpret_cast<char *>(res_data->data()),
-                                     res_data->size() * sizeof(float));
+  auto codec_itr = _sparse_codecs.find(request.table_id());
+  if (codec_itr == _sparse_codecs.end()) {
+    cntl->response_attachment().append(
+        reinterpret_cast<char *>(res_data->data()),
+        res_data->size() * sizeof(float));
+    butil::return_object(res_data);
+    return 0;
+  }
+  auto *codec = codec_itr->second.get();
+  thread_local std::vector<char> encoded;
+  encoded.resize(num * codec->PullValueSize());
+  codec->EncodePullValues(res_data->data(), num, encoded.data());
   butil::return_object(res_data);
+  if (codec->CompressAttachment()) {
+    butil::IOBuf raw;
+    raw.append(encoded.data(), encoded.size());
+    if (!SparseTransportCodec::Compress(raw, &cntl->response_attachment())) {
+      set_response_code(response, -1, "compress sparse values failed");
+    }
+  } else {
+    cntl->response_attachment().append(encoded.data(), encoded.size());
+  }
   return 0;
 }
 
@@ -585,6 +713,21 @@ int32_t BrpcPsService::PushSparse(Table *table,
   table_context.push_context.values =
       (const float *)(push_data.data() + sizeof(uint64_t) * num);
   table_context.num = num;
+  // the gradients in the wire format of the table are decoded to fp32
+  auto codec_itr = _sparse_codecs.find(request.table_id());
+  thread_local std::vector<float> decoded;
+  if (codec_itr != _sparse_codecs.end()) {
+    auto *codec = codec_itr->second.get();
+    if (push_data.size() != num * (sizeof(uint64_t) + codec->PushGradSize())) {
+      set_response_code(response, -1, "push sparse data is not in format");
+      return 0;
+    }
+    decoded.resize(num *
+                   table->GetValueAccessor()->GetAccessorInfo().update_dim);
+    codec->DecodePushGrads(
+        push_data.data() + sizeof(uint64_t) * num, num, decoded.data());
+    table_context.push_context.values = decoded.data();
+  }
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
   // num);
@@ -592,6 +735,11 @@ int32_t BrpcPsService::PushSparse(Table *table,
     // if (table->PushSparse(keys, values, num) != 0) {
     set_response_code(response, -1, "PushSparse error");
   }
+  auto coalescer_itr = _pull_coalescers.find(table);
+  if (coalescer_itr != _pull_coalescers.end()) {
+    coalescer_itr->second->Invalidate(table_context.push_context.keys, num);
+  }
+  TouchMigratingKeys(table, table_context.push_context.keys, num);
   return 0;
 }
 
@@ -621,7 +769,9 @@ int32_t BrpcPsService::LoadOneTable(Table *table,
         "PsRequestMessage.datas is required at least 2 for path & load_param");
     return -1;
   }
-  if (table->Load(request.params(0), request.params(1)) != 0) {
+  int32_t ret = table->Load(request.params(0), request.params(1));
+  InvalidatePullCache(table);
+  if (ret != 0) {
     set_response_code(response, -1, "table load failed");
     return -1;
   }
@@ -660,6 +810,8 @@ int32_t BrpcPsService::SaveOneTable(Table *table,
 
   VLOG(3) << "save table " << request.params(0) << " " << request.params(1);
   feasign_size = table->Save(request.params(0), request.params(1));
+  // the save may update the stats of the values
+  InvalidatePullCache(table);
   if (feasign_size < 0) {
     set_response_code(response, -1, "table save failed");
     return -1;
@@ -783,6 +935,7 @@ int32_t BrpcPsService::Revert(Table *table,
   for (auto &itr : table_map) {
     itr.second->Flush();
     itr.second->Revert();
+    InvalidatePullCache(itr.second.get());
   }
   return 0;
 }
@@ -798,6 +951,91 @@ int32_t BrpcPsService::CheckSavePrePatchDone(Table *table,
   return 0;
 }
 
+int32_t BrpcPsService::MigrateSparseShard(Table *table,
+                                          const PsRequestMessage &request,
+                                          PsResponseMessage &response,
+                                          brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  auto itr = _shard_migrators.find(table);
+  if (itr == _shard_migrators.end()) {
+    set_response_code(response, -1, "table is not a sparse table");
+    return -1;
+  }
+  if (request.params_size() < 3) {
+    set_response_code(response,
+                      -1,
+                      "PsRequestMessage.params is required at least 3, "
+                      "endpoint, final and shard ids");
+    return -1;
+  }
+  const auto &endpoint = request.params(0);
+  bool final_pass = request.params(1) == "1";
+  std::vector<uint32_t> shards;
+  for (int i = 2; i < request.params_size(); ++i) {
+    shards.push_back(std::stoul(request.params(i)));
+  }
+  int32_t ret = final_pass ? itr->second->Finish(shards, endpoint)
+                           : itr->second->Stream(shards, endpoint);
+  if (final_pass) {
+    InvalidatePullCache(table);
+  }
+  if (ret != 0) {
+    set_response_code(response, -1, "migrate sparse shard failed");
+    return -1;
+  }
+  return 0;
+}
+
+int32_t BrpcPsService::ImportSparseValues(Table *table,
+                                          const PsRequestMessage &request,
+                                          PsResponseMessage &response,
+                                          brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 1) {
+    set_response_code(response,
+                      -1,
+                      "PsRequestMessage.params is required at "
+                      "least 1 for num of sparse_key");
+    return -1;
+  }
+  const uint32_t num =
+      *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
+  /*
+  Import Content:
+  |---keysData---|---dimsData---|---valuesData---|
+  |---8*{num}B---|---4*{num}B---|----------------|
+  */
+  std::string data;
+  cntl->request_attachment().copy_to(&data);
+  if (data.size() < num * (sizeof(uint64_t) + sizeof(uint32_t))) {
+    set_response_code(response, -1, "import sparse data is not in format");
+    return -1;
+  }
+  const auto *keys = reinterpret_cast<const uint64_t *>(data.data());
+  const auto *dims = reinterpret_cast<const uint32_t *>(
+      data.data() + num * sizeof(uint64_t));
+  size_t value_num = 0;
+  for (uint32_t i = 0; i < num; ++i) {
+    value_num += dims[i];
+  }
+  if (data.size() !=
+      num * (sizeof(uint64_t) + sizeof(uint32_t)) + value_num * sizeof(float)) {
+    set_response_code(response, -1, "import sparse data is not in format");
+    return -1;
+  }
+  const auto *values = reinterpret_cast<const float *>(
+      data.data() + num * (sizeof(uint64_t) + sizeof(uint32_t)));
+  if (table->ImportValues(keys, dims, values, num) != 0) {
+    set_response_code(response, -1, "import sparse values failed");
+    return -1;
+  }
+  auto coalescer_itr = _pull_coalescers.find(table);
+  if (coalescer_itr != _pull_coalescers.end()) {
+    coalescer_itr->second->Invalidate(keys, num);
+  }
+  return 0;
+}
+
 int32_t BrpcPsService::ShrinkTable(Table *table,
                                    const PsRequestMessage &request,
                                    PsResponseMessage &response,
@@ -811,7 +1049,9 @@ int32_t BrpcPsService::ShrinkTable(Table *table,
     return -1;
   }
   table->Flush();
-  if (table->Shrink(request.params(0)) != 0) {
+  int32_t ret = table->Shrink(request.params(0));
+  InvalidatePullCache(table);
+  if (ret != 0) {
     set_response_code(response, -1, "table shrink failed");
     return -1;
   }
@@ -826,6 +1066,7 @@ int32_t BrpcPsService::ClearOneTable(Table *table,
   CHECK_TABLE_EXIST(table, request, response)
   table->Flush();
   table->Clear();
+  InvalidatePullCache(table);
   return 0;
 }
 
@@ -18,7 +18,11 @@
 #include "brpc/controller.h"
 #include "brpc/server.h"
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
+#include "paddle/fluid/distributed/ps/service/dense_transport.h"
 #include "paddle/fluid/distributed/ps/service/server.h"
+#include "paddle/fluid/distributed/ps/service/sparse_pull_coalescer.h"
+#include "paddle/fluid/distributed/ps/service/sparse_shard_migrator.h"
+#include "paddle/fluid/distributed/ps/service/sparse_transport.h"
 
 namespace brpc {
 class Controller;
@@ -89,6 +93,8 @@ class BrpcPsService : public PsBaseService {
 
  private:
   int32_t InitializeShardInfo();
+  // drops the cached values of the table, after it is written in bulk
+  void InvalidatePullCache(Table *table);
   int32_t PullDense(Table *table,
                     const PsRequestMessage &request,
                     PsResponseMessage &response,  // NOLINT
@@ -197,11 +203,35 @@ class BrpcPsService : public PsBaseService {
                                 PsResponseMessage &response,  // NOLINT
                                 brpc::Controller *cntl);
 
+  int32_t MigrateSparseShard(Table *table,
+                             const PsRequestMessage &request,
+                             PsResponseMessage &response,  // NOLINT
+                             brpc::Controller *cntl);
+
+  int32_t ImportSparseValues(Table *table,
+                             const PsRequestMessage &request,
+                             PsResponseMessage &response,  // NOLINT
+                             brpc::Controller *cntl);
+
+  // records the written keys of the shards being migrated
+  void TouchMigratingKeys(Table *table, const uint64_t *keys, size_t num);
+
   bool _is_initialize_shard_info;
   std::mutex _initialize_shard_mutex;
   std::unordered_map<int32_t, serviceHandlerFunc> _service_handler_map;
   std::unordered_map<int32_t, serviceHandlerFunc> _msg_handler_map;
   std::vector<float> _ori_values;
+  // the wire format of the sparse tables not sent in raw fp32
+  std::unordered_map<uint32_t, std::shared_ptr<SparseTransportCodec>>
+      _sparse_codecs;
+  // the wire format of the dense tables not sent in one raw fp32 request
+  std::unordered_map<uint32_t, std::shared_ptr<DenseTransportCodec>>
+      _dense_codecs;
+  // the sparse tables merging their concurrent pulls
+  std::unordered_map<Table *, std::shared_ptr<SparsePullCoalescer>>
+      _pull_coalescers;
+  std::unordered_map<Table *, std::shared_ptr<SparseShardMigrator>>
+      _shard_migrators;
 };
 
 class DownpourPServerBrpcClosure : public PServerClosure {
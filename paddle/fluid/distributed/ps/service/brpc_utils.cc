@@ -338,4 +338,25 @@ std::string GetIntTypeEndpoint(const std::string& ip, const uint32_t& port) {
   return int_ip_port;
 }
 
+bool UseBrpcRdma(brpc::ChannelOptions* options) {
+#ifdef PADDLE_WITH_BRPC_RDMA
+  options->use_rdma = true;
+  return true;
+#else
+  LOG(WARNING) << "brpc is not built with RDMA, the channel uses TCP";
+  return false;
+#endif
+}
+
+bool UseBrpcRdma(brpc::ServerOptions* options) {
+#ifdef PADDLE_WITH_BRPC_RDMA
+  // the server still accepts the clients over TCP
+  options->use_rdma = true;
+  return true;
+#else
+  LOG(WARNING) << "brpc is not built with RDMA, the server uses TCP";
+  return false;
+#endif
+}
+
 }  // namespace paddle::distributed
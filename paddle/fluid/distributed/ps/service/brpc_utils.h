@@ -21,6 +21,7 @@ limitations under the License. */
 #include <vector>
 
 #include "brpc/channel.h"
+#include "brpc/server.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -94,5 +95,11 @@ void DeserializeSelectedRows(framework::Variable* var,
 
 std::string GetIntTypeEndpoint(const std::string& ip, const uint32_t& port);
 
+// Sends the messages over RDMA, whose attachments are in the memory
+// registered by brpc. Returns false and keeps TCP if brpc is not built with
+// RDMA, i.e. WITH_BRPC_RDMA=OFF.
+bool UseBrpcRdma(brpc::ChannelOptions* options);
+bool UseBrpcRdma(brpc::ServerOptions* options);
+
 }  // namespace distributed
 }  // namespace paddle
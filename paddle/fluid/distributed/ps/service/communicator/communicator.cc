@@ -16,6 +16,9 @@ limitations under the License. */
 
 #include <google/protobuf/text_format.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
 #include "paddle/fluid/distributed/ps/wrapper/fleet.h"
@@ -202,7 +205,7 @@ void Communicator::RpcSendDense(const CommContext &ctx,
   auto &var_names = ctx.origin_varnames;
   auto &table_id = ctx.table_id;
   auto dense_data = std::make_shared<std::vector<float>>();
-  size_t request_call_num = _worker_ptr->GetServerNums();
+  size_t request_call_num = _worker_ptr->GetStartServerNums();
   uint32_t num_per_shard =
       DenseDimPerShard(ctx.height_sections[0], request_call_num);
   dense_data->resize(num_per_shard *
@@ -251,7 +254,7 @@ void Communicator::RpcSendSparseParam(const std::string &varname,
   phi::RecordEvent record_event("Communicator->RpcSendSparseParam",
                                 phi::TracerEventType::Communication,
                                 1);
-  size_t request_call_num = _worker_ptr->GetServerNums();
+  size_t request_call_num = _worker_ptr->GetStartServerNums();
   std::vector<float *> push_g_vec;
 
   auto *send_var = scope.FindVar(varname);
@@ -423,7 +426,7 @@ void Communicator::SendGlobalStep(const CommContext &ctx,
   phi::RecordEvent record_event(
       "Communicator->SendGlobalStep", phi::TracerEventType::Communication, 1);
   auto &table_id = ctx.table_id;
-  size_t request_call_num = _worker_ptr->GetServerNums();
+  size_t request_call_num = _worker_ptr->GetStartServerNums();
 
   auto &var_name = STEP_COUNTER;
   auto *out_var = send_scope->Var(var_name);
@@ -1151,6 +1154,11 @@ void GeoCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
               splited_var,
               ::paddle::framework::MakeChannel<
                   std::shared_ptr<std::vector<int64_t>>>(send_queue_size_)));
+      // filled before the send tasks start, so that they need no lock
+      geo_sync_states_[splited_var].merge_num = std::min<int64_t>(
+          std::max<int64_t>(max_merge_var_num_,
+                            FLAGS_communicator_geo_min_merge_var_num),
+          FLAGS_communicator_geo_max_merge_var_num);
     }
   }
   send_threadpool_ = std::make_unique<ThreadPool>(thread_pool_size_);
@@ -1340,7 +1348,7 @@ std::vector<int64_t> GeoCommunicator::MergeSparseIds(
   size_t merge_num = 0, wait_times = 0;
   std::unordered_set<int64_t> sparse_ids;
   while (merge_num <
-         static_cast<size_t>(max_merge_var_num_)) {  // -> geo_step: 100
+         static_cast<size_t>(GetMergeNum(send_varname))) {  // -> geo_step: 100
     VLOG(3) << "Merge Number of " << send_varname << " = " << merge_num;
     if (sparse_id_queues_.at(send_varname)->Size() > 0) {
       wait_times = 0;
@@ -1404,28 +1412,54 @@ void GeoCommunicator::SendSparse(const std::string &varname,
   var_t_value->Resize({static_cast<int64_t>(sparse_ids.size()), dims1});
   auto *t_value = var_t_value->mutable_data<float>(cpu_ctx.GetPlace());
 
-  t_delta->set_rows(sparse_ids);
-  t_delta->set_height(t_latest.dims()[0]);
-
   auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(cpu_ctx);
   float coefficient = 1.0 / static_cast<float>(trainers_);
-
+  bool need_norm = FLAGS_communicator_geo_adaptive_sync ||
+                   FLAGS_communicator_geo_skip_delta_ratio > 0.0;
+  double skip_ratio2 = FLAGS_communicator_geo_skip_delta_ratio *
+                       FLAGS_communicator_geo_skip_delta_ratio;
+  double delta_norm2 = 0.0, old_norm2 = 0.0;
+
+  // the delta rows are compacted, a row of small delta is not sent and its
+  // old value is kept, so that the delta accumulates until it is sent
+  std::vector<int64_t> send_ids;
+  send_ids.reserve(sparse_ids.size());
   std::vector<float *> push_g_vec;
   for (auto j = 0; j < static_cast<int>(sparse_ids.size()); ++j) {
-    blas.VSUB(dims1,
-              t_latest.data<float>() + sparse_ids[j] * dims1,
-              t_old->data<float>() + sparse_ids[j] * dims1,
-              t_value + j * dims1);
-    blas.SCAL(dims1, coefficient, t_value + j * dims1);
-    blas.VADD(dims1,
-              t_old->data<float>() + sparse_ids[j] * dims1,
-              t_value + j * dims1,
-              t_old->data<float>() + sparse_ids[j] * dims1);
-    push_g_vec.push_back(t_value + j * dims1);
+    auto *value = t_value + send_ids.size() * dims1;
+    auto *old = t_old->data<float>() + sparse_ids[j] * dims1;
+    blas.VSUB(
+        dims1, t_latest.data<float>() + sparse_ids[j] * dims1, old, value);
+    blas.SCAL(dims1, coefficient, value);
+    if (need_norm) {
+      double row_delta2 = blas.DOT(dims1, value, value);
+      double row_old2 = blas.DOT(dims1, old, old);
+      delta_norm2 += row_delta2;
+      old_norm2 += row_old2;
+      if (row_delta2 <= skip_ratio2 * row_old2) {
+        continue;
+      }
+    }
+    blas.VADD(dims1, old, value, old);
+    send_ids.push_back(sparse_ids[j]);
+    push_g_vec.push_back(value);
 
     VLOG(5) << "DEBUG GeoCommunicator::SendSparse send sparse key "
-            << sparse_ids[j] << " value[0] " << push_g_vec[j][0]
-            << " value[-1] " << push_g_vec[j][dims1 - 1];
+            << sparse_ids[j] << " value[0] " << value[0] << " value[-1] "
+            << value[dims1 - 1];
+  }
+  var_t_value->Resize({static_cast<int64_t>(send_ids.size()), dims1});
+  t_delta->set_rows(send_ids);
+  t_delta->set_height(t_latest.dims()[0]);
+  // a param of zero is all delta
+  double delta_ratio = old_norm2 > 0.0   ? std::sqrt(delta_norm2 / old_norm2)
+                       : delta_norm2 > 0.0 ? 1.0
+                                           : 0.0;
+  if (send_ids.empty()) {
+    VLOG(1) << "Skip Send Sparse " << varname << ", all the "
+            << sparse_ids.size() << " ids are of small delta";
+    UpdateMergeNum(varname, delta_ratio, 0.0);
+    return;
   }
 
   ++_async_call_num;
@@ -1438,20 +1472,67 @@ void GeoCommunicator::SendSparse(const std::string &varname,
     closure->set_promise_value(ret);
     --_async_call_num;
   });
+  double start_us = GetCurrentUS();
   auto status = _worker_ptr->PushSparseRawGradientPartial(
       table_id,
-      (const uint64_t *)sparse_ids.data(),
+      (const uint64_t *)send_ids.data(),
       (const float **)push_g_vec.data(),
-      sparse_ids.size(),
+      send_ids.size(),
       closure,
       ep_idx);
   status.wait();
+  UpdateMergeNum(varname, delta_ratio, GetCurrentUS() - start_us);
 
   VLOG(1) << "Finish Send Sparse " << varname
-          << ", ids.size = " << sparse_ids.size() << ", table_id: " << table_id;
+          << ", ids.size = " << send_ids.size() << " of " << sparse_ids.size()
+          << ", table_id: " << table_id;
   return;
 }
 
+int64_t GeoCommunicator::GetMergeNum(const std::string &varname) const {
+  if (!FLAGS_communicator_geo_adaptive_sync) {
+    return max_merge_var_num_;
+  }
+  return geo_sync_states_.at(varname).merge_num;
+}
+
+void GeoCommunicator::UpdateMergeNum(const std::string &varname,
+                                     double delta_ratio,
+                                     double send_us) {
+  if (!FLAGS_communicator_geo_adaptive_sync) {
+    return;
+  }
+  auto &state = geo_sync_states_.at(varname);
+  // the delta norm grows about linearly with the merge num, while a send
+  // slower than the fastest one means that the network is backlogged and the
+  // sends should be fewer and larger
+  double scale = 2.0;
+  if (delta_ratio > 0.0) {
+    scale = std::sqrt(FLAGS_communicator_geo_target_delta_ratio / delta_ratio);
+  }
+  if (send_us > 0.0) {
+    if (state.best_send_us <= 0.0 || send_us < state.best_send_us) {
+      state.best_send_us = send_us;
+    }
+    scale *= std::sqrt(send_us / state.best_send_us);
+  }
+  // at most double or halve at a time to avoid oscillation
+  scale = std::min(2.0, std::max(0.5, scale));
+  int64_t merge_num =
+      std::llround(static_cast<double>(state.merge_num) * scale);
+  merge_num =
+      std::max<int64_t>(merge_num, FLAGS_communicator_geo_min_merge_var_num);
+  merge_num =
+      std::min<int64_t>(merge_num, FLAGS_communicator_geo_max_merge_var_num);
+  merge_num = std::max<int64_t>(merge_num, 1);
+  if (merge_num != state.merge_num) {
+    VLOG(1) << "GeoCommunicator merge num of " << varname << ": "
+            << state.merge_num << " -> " << merge_num
+            << ", delta_ratio: " << delta_ratio << ", send_us: " << send_us;
+    state.merge_num = merge_num;
+  }
+}
+
 void GeoCommunicator::RecvSparse(const std::string &varname,
                                  int table_id,
                                  int ep_idx) {
@@ -53,6 +53,11 @@ struct CommContext;
 }  // namespace paddle
 
 COMMON_DECLARE_bool(communicator_is_sgd_optimizer);
+COMMON_DECLARE_bool(communicator_geo_adaptive_sync);
+COMMON_DECLARE_int32(communicator_geo_min_merge_var_num);
+COMMON_DECLARE_int32(communicator_geo_max_merge_var_num);
+COMMON_DECLARE_double(communicator_geo_target_delta_ratio);
+COMMON_DECLARE_double(communicator_geo_skip_delta_ratio);
 
 namespace paddle {
 namespace distributed {
@@ -611,6 +616,11 @@ class GeoCommunicator : public AsyncCommunicator {
                   std::vector<int64_t> &sparse_ids,  // NOLINT
                   int table_id,
                   int ep_idx);
+  // the number of gradients merged before the next send of the splited var
+  int64_t GetMergeNum(const std::string &varname) const;
+  void UpdateMergeNum(const std::string &varname,
+                      double delta_ratio,
+                      double send_us);
   void RecvSparse(const std::string &varname, int table_id, int ep_idx);
 
   void MainThread() override;
@@ -623,6 +633,11 @@ class GeoCommunicator : public AsyncCommunicator {
     // id_queue's size
     max_merge_var_num_ = std::stoi(envs.at("communicator_max_merge_var_num"));
     send_queue_size_ = max_merge_var_num_;
+    if (FLAGS_communicator_geo_adaptive_sync) {
+      // the trainer must not block on the queue before it is merged
+      send_queue_size_ =
+          std::max(send_queue_size_, FLAGS_communicator_geo_max_merge_var_num);
+    }
     VLOG(1) << "GeoCommunicator Initialized";
   }
 
@@ -661,6 +676,15 @@ class GeoCommunicator : public AsyncCommunicator {
       std::string,
       ::paddle::framework::Channel<std::shared_ptr<std::vector<int64_t>>>>
       sparse_id_queues_;
+
+  // state of the adaptive geo sync of a splited var, only accessed by the
+  // send task of that var
+  struct GeoSyncState {
+    int64_t merge_num{0};
+    // the fastest send, which is taken as the one without network backlog
+    double best_send_us{0.0};
+  };
+  std::unordered_map<std::string, GeoSyncState> geo_sync_states_;
 };
 
 class FLCommunicator : public GeoCommunicator {
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/dense_transport.h"
+
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_quant.h"
+
+namespace paddle {
+namespace distributed {
+
+std::shared_ptr<DenseTransportCodec> DenseTransportCodec::Create(
+    const TableParameter &table_param) {
+  const auto &param = table_param.dense_transport();
+  if (param.chunk_size() == 0 && param.pull_value_type() == SPARSE_VALUE_FP32 &&
+      param.push_grad_type() == SPARSE_VALUE_FP32) {
+    return nullptr;
+  }
+  VLOG(0) << "table " << table_param.table_id() << " dense transport: chunk "
+          << param.chunk_size() << ", pull "
+          << SparseValueCompressType_Name(param.pull_value_type()) << ", push "
+          << SparseValueCompressType_Name(param.push_grad_type());
+  return std::make_shared<DenseTransportCodec>(param);
+}
+
+DenseTransportCodec::DenseTransportCodec(const DenseTransportParameter &param)
+    : _chunk_size(param.chunk_size()),
+      _pull_type(param.pull_value_type()),
+      _push_type(param.push_grad_type()) {}
+
+uint32_t DenseTransportCodec::ChunkSize(uint32_t num_per_shard) const {
+  if (_chunk_size == 0 || _chunk_size > num_per_shard) {
+    return num_per_shard;
+  }
+  return _chunk_size;
+}
+
+size_t DenseTransportCodec::PullValueSize(size_t num) const {
+  return SparseQuantSize(_pull_type, num);
+}
+
+void DenseTransportCodec::EncodePullValues(const float *values,
+                                           size_t num,
+                                           char *out) const {
+  SparseQuantize(_pull_type, values, num, out);
+}
+
+void DenseTransportCodec::DecodePullValues(const char *data,
+                                           size_t num,
+                                           float *values) const {
+  SparseDequantize(_pull_type, data, num, values);
+}
+
+size_t DenseTransportCodec::PushGradSize(size_t num) const {
+  return SparseQuantSize(_push_type, num);
+}
+
+void DenseTransportCodec::EncodePushGrads(size_t offset,
+                                          const float *grads,
+                                          size_t num,
+                                          char *out) {
+  if (_push_type == SPARSE_VALUE_FP32) {
+    SparseQuantize(_push_type, grads, num, out);
+    return;
+  }
+  thread_local std::vector<float> compensated;
+  thread_local std::vector<float> decoded;
+  compensated.resize(num);
+  decoded.resize(num);
+
+  std::lock_guard<std::mutex> guard(_residual_mutex);
+  if (_residuals.size() < offset + num) {
+    _residuals.resize(offset + num, 0.0f);
+  }
+  float *residual = _residuals.data() + offset;
+  for (size_t i = 0; i < num; ++i) {
+    compensated[i] = grads[i] + residual[i];
+  }
+  SparseQuantize(_push_type, compensated.data(), num, out);
+  SparseDequantize(_push_type, out, num, decoded.data());
+  for (size_t i = 0; i < num; ++i) {
+    residual[i] = compensated[i] - decoded[i];
+  }
+}
+
+void DenseTransportCodec::DecodePushGrads(const char *data,
+                                          size_t num,
+                                          float *grads) const {
+  SparseDequantize(_push_type, data, num, grads);
+}
+
+}  // namespace distributed
+}  // namespace paddle
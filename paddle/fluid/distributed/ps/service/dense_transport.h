@@ -0,0 +1,70 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+/**
+ * The wire format of a dense table, set by the dense_transport of its
+ * TableParameter, which the client and the server share.
+ *
+ * The shard of a server is pulled and pushed in chunks of ChunkSize floats
+ * at their offsets in the shard, so that the requests of all the chunks of
+ * all the servers are in flight together and none of them is a message of
+ * the whole shard. A chunk is sent as its values encoded by the compress
+ * type, and the client adds the rounding error of the last gradients of
+ * each value to the next ones.
+ **/
+class DenseTransportCodec {
+ public:
+  // Returns nullptr if the table is sent in one raw fp32 request per server.
+  static std::shared_ptr<DenseTransportCodec> Create(
+      const TableParameter &table_param);
+
+  explicit DenseTransportCodec(const DenseTransportParameter &param);
+
+  // the floats of a chunk of a shard of num_per_shard floats
+  uint32_t ChunkSize(uint32_t num_per_shard) const;
+
+  size_t PullValueSize(size_t num) const;
+  void EncodePullValues(const float *values, size_t num, char *out) const;
+  void DecodePullValues(const char *data, size_t num, float *values) const;
+
+  size_t PushGradSize(size_t num) const;
+  // offset is the index of grads[0] in all the gradients of the table
+  void EncodePushGrads(size_t offset,
+                       const float *grads,
+                       size_t num,
+                       char *out);
+  void DecodePushGrads(const char *data, size_t num, float *grads) const;
+
+ private:
+  uint32_t _chunk_size;
+  SparseValueCompressType _pull_type;
+  SparseValueCompressType _push_type;
+
+  std::mutex _residual_mutex;
+  std::vector<float> _residuals;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -21,6 +21,16 @@ namespace paddle {
 namespace distributed {
 PD_DEFINE_int32(heter_world_size, 100, "group size");  // group max size
 PD_DEFINE_int32(switch_send_recv_timeout_s, 600, "switch_send_recv_timeout_s");
+PD_DEFINE_bool(heter_use_rdma,
+               false,
+               "heter service is sent over RDMA, which needs brpc built with "
+               "WITH_BRPC_RDMA");
+PD_DEFINE_bool(heter_flow_control,
+               false,
+               "the micro-batches are routed to the least loaded heter server "
+               "and kept in flight by a window adapted to their round trips "
+               "instead of a barrier per minibatch, only for the pipelines "
+               "whose next stage of the trainers is the last one");
 
 std::shared_ptr<HeterClient> HeterClient::s_instance_ = nullptr;
 std::mutex HeterClient::mtx_;
@@ -78,6 +88,9 @@ void HeterClient::CreateClient2XpuConnection() {
   options.protocol = "baidu_std";
   options.connection_type = "single";
   options.timeout_ms = FLAGS_pserver_timeout_ms;
+  if (FLAGS_heter_use_rdma) {
+    UseBrpcRdma(&options);
+  }
 
   xpu_channels_.resize(xpu_list_.size());
   for (size_t i = 0; i < xpu_list_.size(); ++i) {
@@ -152,7 +165,9 @@ void HeterClient::SendAndRecvAsync(
   VLOG(4) << "micro_id: " << micro_id;
   // select channel according to micro id
   if (mode == "forward") {
-    int num = minibatch_id % xpu_channels_.size();
+    int num = FLAGS_heter_flow_control
+                  ? RouteMicroBatch(micro_id)
+                  : static_cast<int>(minibatch_id % xpu_channels_.size());
     channel = xpu_channels_[num].get();
   } else if (mode == "backward") {
     int num = minibatch_id % previous_xpu_channels_.size();
@@ -176,6 +191,56 @@ void HeterClient::SendAndRecvAsync(
       &closure->cntl, &request, &closure->response, closure);
 }
 
+int HeterClient::RouteMicroBatch(int micro_id) {
+  std::lock_guard<std::mutex> lock(route_mutex_);
+  server_loads_.resize(xpu_channels_.size());
+  // a micro-batch sent again before its backward came back is not counted
+  auto it = routed_micro_batches_.find(micro_id);
+  if (it != routed_micro_batches_.end()) {
+    --server_loads_[it->second.server].in_flight;
+    routed_micro_batches_.erase(it);
+  }
+  // the servers without a service time yet are tried first
+  int server = 0;
+  double best_cost = 0.0;
+  for (size_t i = 0; i < server_loads_.size(); ++i) {
+    const auto& load = server_loads_[i];
+    double cost = (load.in_flight + 1) * load.service_ms;
+    const auto& best = server_loads_[server];
+    if (i == 0 || cost < best_cost ||
+        (cost == best_cost && load.in_flight < best.in_flight)) {
+      server = static_cast<int>(i);
+      best_cost = cost;
+    }
+  }
+  routed_micro_batches_[micro_id] = {server,
+                                     server_loads_[server].in_flight,
+                                     std::chrono::steady_clock::now()};
+  ++server_loads_[server].in_flight;
+  VLOG(4) << "micro_id " << micro_id << " is routed to heter server "
+          << server << " with " << server_loads_[server].in_flight
+          << " micro-batches in flight";
+  return server;
+}
+
+void HeterClient::FinishMicroBatch(int micro_id) {
+  std::lock_guard<std::mutex> lock(route_mutex_);
+  auto it = routed_micro_batches_.find(micro_id);
+  if (it == routed_micro_batches_.end()) return;
+  auto& load = server_loads_[it->second.server];
+  --load.in_flight;
+  // the round trip waited for the micro-batches queued before this one
+  double round_trip_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() -
+                             it->second.sent)
+                             .count();
+  double service_ms = round_trip_ms / (it->second.depth + 1);
+  load.service_ms = load.service_ms == 0.0
+                        ? service_ms
+                        : 0.8 * load.service_ms + 0.2 * service_ms;
+  routed_micro_batches_.erase(it);
+}
+
 std::future<int32_t> HeterClient::SendCmd(
     uint32_t table_id, int cmd_id, const std::vector<std::string>& params) {
   size_t request_call_num = xpu_channels_.size();
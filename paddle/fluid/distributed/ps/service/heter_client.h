@@ -14,9 +14,11 @@ limitations under the License. */
 
 #pragma once
 #include <atomic>
+#include <chrono>
 #include <ctime>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <unordered_map>
@@ -43,6 +45,8 @@ class Scope;
 namespace paddle {
 namespace distributed {
 PD_DECLARE_int32(pserver_timeout_ms);
+PD_DECLARE_bool(heter_use_rdma);
+PD_DECLARE_bool(heter_flow_control);
 using MultiVarMsg = ::paddle::distributed::MultiVariableMessage;
 using VarMsg = ::paddle::distributed::VariableMessage;
 
@@ -91,6 +95,10 @@ class HeterClient {
     options.protocol = "baidu_std";
     options.connection_type = "single";
     options.timeout_ms = FLAGS_pserver_timeout_ms;
+    // over TCP when encrypted
+    if (FLAGS_heter_use_rdma && !need_encrypt) {
+      UseBrpcRdma(&options);
+    }
     std::vector<std::shared_ptr<brpc::Channel>>* client_channels = nullptr;
     if (peer_role == PEER_ROLE_IS_SWITCH) {
 #ifdef PADDLE_WITH_ARM_BRPC
@@ -175,6 +183,17 @@ class HeterClient {
     return s_instance_;
   }
 
+  // the HeterClient singleton if it has been created, or nullptr
+  static std::shared_ptr<HeterClient> GetInstance() { return s_instance_; }
+
+  // Returns the index of the heter server which is expected to finish the
+  // micro-batch first, from its micro-batches in flight and service time.
+  int RouteMicroBatch(int micro_id);
+
+  // Called by the trainer when the backward of a micro-batch it sent forward
+  // has come back, which ends the service of the micro-batch on its server.
+  void FinishMicroBatch(int micro_id);
+
   // switch client singleton
   static std::shared_ptr<HeterClient> GetSwitchInstance(
       const std::vector<std::string>& peer_endpoints, int32_t peer_role) {
@@ -240,6 +259,18 @@ class HeterClient {
   HeterClient& operator=(const HeterClient&);
   HeterClient(const HeterClient&);
 
+  struct ServerLoad {
+    int in_flight{0};
+    // the moving average of the time of a micro-batch in the server
+    double service_ms{0.0};
+  };
+
+  struct RoutedMicroBatch {
+    int server;
+    int depth;
+    std::chrono::steady_clock::time_point sent;
+  };
+
   static std::shared_ptr<HeterClient> s_instance_;
   static std::mutex mtx_;
   static std::shared_ptr<HeterClient> switch_s_instance_;
@@ -250,6 +281,10 @@ class HeterClient {
   std::vector<std::string> xpu_list_;
   std::vector<std::string> previous_xpu_list_;
 
+  std::mutex route_mutex_;
+  std::vector<ServerLoad> server_loads_;
+  std::unordered_map<int, RoutedMicroBatch> routed_micro_batches_;
+
   int trainer_id_;
 };
 
@@ -34,6 +34,8 @@ void HeterServer::StartHeterService(bool need_encrypt) {
   if (need_encrypt) {
     options.mutable_ssl_options()->default_cert.certificate = "/cert.pem";
     options.mutable_ssl_options()->default_cert.private_key = "/key.pem";
+  } else if (FLAGS_heter_use_rdma) {
+    UseBrpcRdma(&options);
   }
   if (server_.Start(endpoint_.c_str(), &options) != 0) {
     VLOG(0) << "HeterServer start fail. Try again.";
@@ -69,6 +71,8 @@ void HeterServer::StartHeterInterService(bool need_encrypt) {
   if (need_encrypt) {
     options.mutable_ssl_options()->default_cert.certificate = "/cert.pem";
     options.mutable_ssl_options()->default_cert.private_key = "/key.pem";
+  } else if (FLAGS_heter_use_rdma) {
+    UseBrpcRdma(&options);
   }
   if (server_inter_.Start(endpoint_inter_.c_str(), &options) != 0) {
     VLOG(4) << "switch inter server start fail. Try again.";
@@ -259,6 +259,10 @@ class PSClient {
   }
 
   virtual size_t GetServerNums() = 0;
+  // the servers the job started with, which hold the dense tables and the
+  // sparse params, while the sparse tables may be resharded to the servers
+  // joining later
+  virtual size_t GetStartServerNums() { return GetServerNums(); }
 
   virtual std::future<int32_t> PushDenseRawGradient(int table_id,
                                                     float *total_send_data,
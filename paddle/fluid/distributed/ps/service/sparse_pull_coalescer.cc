@@ -0,0 +1,302 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_coalescer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+
+namespace paddle {
+namespace distributed {
+
+std::shared_ptr<SparsePullCoalescer> SparsePullCoalescer::Create(
+    const TableParameter &table_param, Table *table) {
+  const auto &param = table_param.sparse_pull_coalesce();
+  if (param.window_us() == 0 && param.hot_key_cache_size() == 0) {
+    return nullptr;
+  }
+  auto coalescer = std::make_shared<SparsePullCoalescer>(
+      param, table, table->GetValueAccessor()->GetAccessorInfo().select_dim);
+  VLOG(0) << "table " << table_param.table_id()
+          << " sparse pull coalesce: window_us " << param.window_us()
+          << ", max_batch_keys " << param.max_batch_keys()
+          << ", hot_key_cache_size " << param.hot_key_cache_size()
+          << ", hot_key_threshold " << param.hot_key_threshold();
+  return coalescer;
+}
+
+SparsePullCoalescer::SparsePullCoalescer(
+    const SparsePullCoalesceParameter &param, Table *table, size_t select_dim)
+    : _table(table),
+      _select_dim(select_dim),
+      _window_us(param.window_us()),
+      _max_batch_keys(param.max_batch_keys()),
+      _stripe_capacity((param.hot_key_cache_size() + kStripeNum - 1) /
+                       kStripeNum),
+      _hot_key_threshold(std::min<uint32_t>(param.hot_key_threshold(),
+                                            UINT8_MAX)),
+      _stripes(kStripeNum) {
+  bthread_mutex_init(&_batch_mutex, NULL);
+  bthread_cond_init(&_batch_cond, NULL);
+}
+
+SparsePullCoalescer::~SparsePullCoalescer() {
+  bthread_cond_destroy(&_batch_cond);
+  bthread_mutex_destroy(&_batch_mutex);
+}
+
+uint64_t SparsePullCoalescer::Mix(uint64_t key) {
+  // the keys of a server share their low bits, which select the server
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+int32_t SparsePullCoalescer::Pull(const PullSparseValue &pull_value,
+                                  float *values) {
+  PullRequest request;
+  request.is_training = pull_value.is_training_;
+  request.num = pull_value.numel_;
+  request.values = values;
+  Lookup(pull_value, values, &request);
+  if (request.keys.empty()) {
+    return 0;
+  }
+  if (_window_us == 0) {
+    Batch batch;
+    batch.is_training = request.is_training;
+    batch.num_keys = request.keys.size();
+    batch.requests.push_back(&request);
+    return PullBatch(batch);
+  }
+  return Merge(&request);
+}
+
+void SparsePullCoalescer::Lookup(const PullSparseValue &pull_value,
+                                 float *values,
+                                 PullRequest *request) {
+  size_t num = pull_value.numel_;
+  request->keys.reserve(num);
+  request->frequencies.reserve(num);
+  request->offsets.reserve(num);
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t key = pull_value.feasigns_[i];
+    if (_stripe_capacity > 0) {
+      uint64_t mixed = Mix(key);
+      auto &stripe = StripeOf(mixed);
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      stripe.sketch.Touch(key);
+      auto itr = stripe.values.find(key);
+      if (itr != stripe.values.end()) {
+        memcpy(values + i * _select_dim,
+               itr->second.data(),
+               _select_dim * sizeof(float));
+        continue;
+      }
+      request->versions.push_back(stripe.versions[VersionOf(mixed)]);
+    }
+    request->keys.push_back(key);
+    request->frequencies.push_back(
+        pull_value.frequencies_ == nullptr ? 1 : pull_value.frequencies_[i]);
+    request->offsets.push_back(i);
+  }
+}
+
+void SparsePullCoalescer::Cache(const uint64_t *keys,
+                                const uint64_t *versions,
+                                const float *values,
+                                size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t mixed = Mix(keys[i]);
+    auto &stripe = StripeOf(mixed);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    // pushed after the pull missed, the value may be older than the push
+    if (stripe.versions[VersionOf(mixed)] != versions[i] ||
+        stripe.sketch.Estimate(keys[i]) < _hot_key_threshold ||
+        stripe.values.size() >= _stripe_capacity) {
+      continue;
+    }
+    stripe.values[keys[i]].assign(values + i * _select_dim,
+                                  values + (i + 1) * _select_dim);
+  }
+}
+
+void SparsePullCoalescer::Invalidate(const uint64_t *keys, size_t num) {
+  if (_stripe_capacity == 0) {
+    return;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t mixed = Mix(keys[i]);
+    auto &stripe = StripeOf(mixed);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    ++stripe.versions[VersionOf(mixed)];
+    stripe.values.erase(keys[i]);
+  }
+}
+
+void SparsePullCoalescer::InvalidateAll() {
+  if (_stripe_capacity == 0) {
+    return;
+  }
+  for (auto &stripe : _stripes) {
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    for (auto &version : stripe.versions) {
+      ++version;
+    }
+    stripe.values.clear();
+  }
+}
+
+int32_t SparsePullCoalescer::Merge(PullRequest *request) {
+  bthread_mutex_lock(&_batch_mutex);
+  auto &open_batch = _open_batches[request->is_training ? 1 : 0];
+  bool leader = open_batch == nullptr;
+  if (leader) {
+    open_batch = std::make_shared<Batch>();
+    open_batch->is_training = request->is_training;
+  }
+  std::shared_ptr<Batch> batch = open_batch;
+  batch->requests.push_back(request);
+  batch->num_keys += request->keys.size();
+  bool full = batch->num_keys >= _max_batch_keys;
+  if (full) {
+    open_batch.reset();
+  }
+  if (!leader) {
+    while (!batch->done) {
+      bthread_cond_wait(&_batch_cond, &_batch_mutex);
+    }
+    int32_t ret = batch->ret;
+    bthread_mutex_unlock(&_batch_mutex);
+    return ret;
+  }
+  bthread_mutex_unlock(&_batch_mutex);
+
+  if (!full) {
+    bthread_usleep(_window_us);
+    bthread_mutex_lock(&_batch_mutex);
+    if (open_batch == batch) {
+      open_batch.reset();
+    }
+    bthread_mutex_unlock(&_batch_mutex);
+  }
+  int32_t ret = -1;
+  try {
+    ret = PullBatch(*batch);
+  } catch (...) {
+    // the others of the batch are waiting
+    bthread_mutex_lock(&_batch_mutex);
+    batch->ret = -1;
+    batch->done = true;
+    bthread_cond_broadcast(&_batch_cond);
+    bthread_mutex_unlock(&_batch_mutex);
+    throw;
+  }
+  bthread_mutex_lock(&_batch_mutex);
+  batch->ret = ret;
+  batch->done = true;
+  bthread_cond_broadcast(&_batch_cond);
+  bthread_mutex_unlock(&_batch_mutex);
+  return ret;
+}
+
+int32_t SparsePullCoalescer::PullBatch(const Batch &batch) {
+  bool cache = _stripe_capacity > 0;
+  if (batch.requests.size() == 1) {
+    auto *request = batch.requests[0];
+    // none of the keys is cached, pulls into the values of the request
+    if (request->keys.size() == request->num) {
+      int32_t ret = PullTable(&request->keys,
+                              &request->frequencies,
+                              batch.is_training,
+                              request->values);
+      if (cache) {
+        Cache(request->keys.data(),
+              request->versions.data(),
+              request->values,
+              request->num);
+      }
+      return ret;
+    }
+  }
+
+  // the distinct keys of the batch, with the earliest versions they are
+  // missed at
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> frequencies;
+  std::vector<uint64_t> versions;
+  std::vector<uint32_t> rows;
+  keys.reserve(batch.num_keys);
+  frequencies.reserve(batch.num_keys);
+  versions.reserve(cache ? batch.num_keys : 0);
+  rows.reserve(batch.num_keys);
+  std::unordered_map<uint64_t, uint32_t> index;
+  index.reserve(batch.num_keys);
+  for (auto *request : batch.requests) {
+    for (size_t i = 0; i < request->keys.size(); ++i) {
+      auto res = index.emplace(request->keys[i], keys.size());
+      uint32_t row = res.first->second;
+      if (res.second) {
+        keys.push_back(request->keys[i]);
+        frequencies.push_back(request->frequencies[i]);
+        if (cache) {
+          versions.push_back(request->versions[i]);
+        }
+      } else {
+        frequencies[row] += request->frequencies[i];
+        if (cache) {
+          versions[row] = std::min(versions[row], request->versions[i]);
+        }
+      }
+      rows.push_back(row);
+    }
+  }
+
+  std::vector<float> values(keys.size() * _select_dim);
+  int32_t ret =
+      PullTable(&keys, &frequencies, batch.is_training, values.data());
+  size_t row_idx = 0;
+  for (auto *request : batch.requests) {
+    for (size_t i = 0; i < request->offsets.size(); ++i) {
+      memcpy(request->values + request->offsets[i] * _select_dim,
+             values.data() + rows[row_idx++] * _select_dim,
+             _select_dim * sizeof(float));
+    }
+  }
+  VLOG(3) << "merged " << batch.requests.size() << " sparse pulls of "
+          << batch.num_keys << " keys into " << keys.size() << " keys";
+  if (cache) {
+    Cache(keys.data(), versions.data(), values.data(), keys.size());
+  }
+  return ret;
+}
+
+int32_t SparsePullCoalescer::PullTable(std::vector<uint64_t> *keys,
+                                       std::vector<uint32_t> *frequencies,
+                                       bool is_training,
+                                       float *values) {
+  PullSparseValue pull_value(*keys, *frequencies, _select_dim);
+  pull_value.is_training_ = is_training;
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = pull_value;
+  table_context.pull_context.values = values;
+  return _table->Pull(table_context);
+}
+
+}  // namespace distributed
+}  // namespace paddle
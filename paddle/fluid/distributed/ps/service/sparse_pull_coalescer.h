@@ -0,0 +1,135 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "paddle/fluid/distributed/ps/table/depends/hot_key_sketch.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+class Table;
+
+/**
+ * Merges the concurrent pulls of a sparse table on the server, set by the
+ * sparse_pull_coalesce of its TableParameter.
+ *
+ * The first pull of a batch waits window_us for the others, then pulls the
+ * distinct keys of all of them from the table once and copies the values
+ * back to each pull. The select values of the keys pulled often are kept in
+ * a cache of kStripeNum stripes, each with the versions of its keys. A push
+ * of a key bumps its version and drops its cached values, and a pulled
+ * value is cached only if no push of the key happened since the pull
+ * missed, so that the cache never returns a value older than the last push
+ * served by the service.
+ *
+ * The tables must be written through the service only, i.e. push, load,
+ * shrink, clear and revert call Invalidate or InvalidateAll.
+ **/
+class SparsePullCoalescer {
+ public:
+  // Returns nullptr if neither the merge nor the cache is enabled.
+  static std::shared_ptr<SparsePullCoalescer> Create(
+      const TableParameter &table_param, Table *table);
+
+  SparsePullCoalescer(const SparsePullCoalesceParameter &param,
+                      Table *table,
+                      size_t select_dim);
+  ~SparsePullCoalescer();
+
+  // Same as the Pull of the table with pull_value, the keys of pull_value
+  // are copied before waiting for the other pulls.
+  int32_t Pull(const PullSparseValue &pull_value, float *values);
+
+  // called after the keys are pushed
+  void Invalidate(const uint64_t *keys, size_t num);
+  void InvalidateAll();
+
+ private:
+  static constexpr size_t kStripeNum = 64;
+  static constexpr size_t kVersionNum = 64;
+
+  struct PullRequest {
+    bool is_training = true;
+    size_t num = 0;
+    float *values = nullptr;
+    // the keys not in the cache, and their offsets in the pull
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> frequencies;
+    std::vector<uint32_t> offsets;
+    std::vector<uint64_t> versions;
+  };
+
+  struct Batch {
+    bool is_training = true;
+    size_t num_keys = 0;
+    bool done = false;
+    int32_t ret = 0;
+    std::vector<PullRequest *> requests;
+  };
+
+  struct Stripe {
+    std::mutex mutex;
+    uint64_t versions[kVersionNum] = {0};
+    HotKeySketch sketch{1 << 14};
+    std::unordered_map<uint64_t, std::vector<float>> values;
+  };
+
+  static uint64_t Mix(uint64_t key);
+  Stripe &StripeOf(uint64_t mixed) { return _stripes[mixed % kStripeNum]; }
+  static size_t VersionOf(uint64_t mixed) {
+    return (mixed / kStripeNum) % kVersionNum;
+  }
+
+  // copies the cached values into values, and collects the other keys
+  void Lookup(const PullSparseValue &pull_value,
+              float *values,
+              PullRequest *request);
+  void Cache(const uint64_t *keys,
+             const uint64_t *versions,
+             const float *values,
+             size_t num);
+  // joins or starts the batch, and waits until it is pulled
+  int32_t Merge(PullRequest *request);
+  int32_t PullBatch(const Batch &batch);
+  int32_t PullTable(std::vector<uint64_t> *keys,
+                    std::vector<uint32_t> *frequencies,
+                    bool is_training,
+                    float *values);
+
+  Table *_table;
+  size_t _select_dim;
+  uint32_t _window_us;
+  size_t _max_batch_keys;
+  size_t _stripe_capacity;
+  uint32_t _hot_key_threshold;
+
+  std::vector<Stripe> _stripes;
+
+  // the batch open to new pulls, for inference and for training
+  bthread_mutex_t _batch_mutex;
+  bthread_cond_t _batch_cond;
+  std::shared_ptr<Batch> _open_batches[2];
+};
+
+}  // namespace distributed
+}  // namespace paddle
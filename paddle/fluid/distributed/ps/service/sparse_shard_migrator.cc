@@ -0,0 +1,181 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_shard_migrator.h"
+
+#include <algorithm>
+
+#include "brpc/controller.h"
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+
+PD_DECLARE_int32(pserver_timeout_ms_s2s);
+PD_DECLARE_int32(pserver_connect_timeout_ms_s2s);
+PD_DECLARE_string(pserver_connection_type_s2s);
+
+namespace paddle {
+namespace distributed {
+
+SparseShardMigrator::SparseShardMigrator(const TableParameter &table_param,
+                                         Table *table)
+    : _table_id(table_param.table_id()),
+      _table(table),
+      _shard_num(table_param.shard_num()) {}
+
+int32_t SparseShardMigrator::Stream(const std::vector<uint32_t> &shards,
+                                    const std::string &endpoint) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shards.insert(shards.begin(), shards.end());
+    _streaming = true;
+  }
+  size_t key_num = 0;
+  for (auto shard_id : shards) {
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> dims;
+    std::vector<float> values;
+    if (_table->ExportShard(shard_id, &keys, &dims, &values) != 0 ||
+        Send(endpoint, keys, dims, values) != 0) {
+      LOG(ERROR) << "table " << _table_id << " stream shard " << shard_id
+                 << " to " << endpoint << " failed";
+      return -1;
+    }
+    key_num += keys.size();
+  }
+  VLOG(0) << "table " << _table_id << " streamed " << shards.size()
+          << " shards of " << key_num << " keys to " << endpoint;
+  return 0;
+}
+
+int32_t SparseShardMigrator::Finish(const std::vector<uint32_t> &shards,
+                                    const std::string &endpoint) {
+  std::vector<uint64_t> dirty_keys;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::unordered_set<uint32_t> finished(shards.begin(), shards.end());
+    for (auto itr = _dirty_keys.begin(); itr != _dirty_keys.end();) {
+      if (finished.count(*itr % _shard_num) > 0) {
+        dirty_keys.push_back(*itr);
+        itr = _dirty_keys.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+    for (auto shard_id : shards) {
+      _shards.erase(shard_id);
+    }
+    _streaming = !_shards.empty();
+  }
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> dims;
+  std::vector<float> values;
+  if (_table->ExportValues(
+          dirty_keys.data(), dirty_keys.size(), &keys, &dims, &values) != 0 ||
+      Send(endpoint, keys, dims, values) != 0) {
+    LOG(ERROR) << "table " << _table_id << " send the written keys to "
+               << endpoint << " failed";
+    return -1;
+  }
+  for (auto shard_id : shards) {
+    if (_table->DropShard(shard_id) != 0) {
+      LOG(ERROR) << "table " << _table_id << " drop shard " << shard_id
+                 << " failed";
+      return -1;
+    }
+  }
+  VLOG(0) << "table " << _table_id << " moved " << shards.size()
+          << " shards to " << endpoint << ", " << keys.size()
+          << " keys written while streaming";
+  return 0;
+}
+
+void SparseShardMigrator::Touch(const uint64_t *keys, size_t num) {
+  if (!_streaming.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (size_t i = 0; i < num; ++i) {
+    if (_shards.count(keys[i] % _shard_num) > 0) {
+      _dirty_keys.insert(keys[i]);
+    }
+  }
+}
+
+int32_t SparseShardMigrator::Send(const std::string &endpoint,
+                                  const std::vector<uint64_t> &keys,
+                                  const std::vector<uint32_t> &dims,
+                                  const std::vector<float> &values) {
+  auto *channel = ChannelOf(endpoint);
+  if (channel == nullptr) {
+    return -1;
+  }
+  /*
+  Import Content:
+  |---keysData---|---dimsData---|---valuesData---|
+  |---8*{num}B---|---4*{num}B---|----------------|
+  */
+  size_t value_offset = 0;
+  for (size_t begin = 0; begin < keys.size(); begin += kBatchKeys) {
+    uint32_t num = std::min(kBatchKeys, keys.size() - begin);
+    size_t value_num = 0;
+    for (size_t i = begin; i < begin + num; ++i) {
+      value_num += dims[i];
+    }
+    brpc::Controller cntl;
+    PsRequestMessage request;
+    PsResponseMessage response;
+    request.set_cmd_id(PS_IMPORT_SPARSE_VALUES);
+    request.set_table_id(_table_id);
+    request.add_params(reinterpret_cast<char *>(&num), sizeof(uint32_t));
+    auto &attachment = cntl.request_attachment();
+    attachment.append(keys.data() + begin, num * sizeof(uint64_t));
+    attachment.append(dims.data() + begin, num * sizeof(uint32_t));
+    attachment.append(values.data() + value_offset,
+                      value_num * sizeof(float));
+    value_offset += value_num;
+    PsService_Stub rpc_stub(channel);
+    rpc_stub.service(&cntl, &request, &response, nullptr);
+    if (cntl.Failed() || response.err_code() != 0) {
+      LOG(ERROR) << "import sparse values to " << endpoint << " failed, "
+                 << (cntl.Failed() ? cntl.ErrorText() : response.err_msg());
+      return -1;
+    }
+  }
+  return 0;
+}
+
+brpc::Channel *SparseShardMigrator::ChannelOf(const std::string &endpoint) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &channel = _channels[endpoint];
+  if (channel == nullptr) {
+    brpc::ChannelOptions options;
+    options.protocol = "baidu_std";
+    options.timeout_ms = FLAGS_pserver_timeout_ms_s2s;
+    options.connection_type = FLAGS_pserver_connection_type_s2s;
+    options.connect_timeout_ms = FLAGS_pserver_connect_timeout_ms_s2s;
+    options.max_retry = 3;
+    channel = std::make_shared<brpc::Channel>();
+    if (channel->Init(endpoint.c_str(), "", &options) != 0) {
+      LOG(ERROR) << "pserver connect to pserver:" << endpoint << " Failed!";
+      channel.reset();
+      return nullptr;
+    }
+  }
+  return channel.get();
+}
+
+}  // namespace distributed
+}  // namespace paddle
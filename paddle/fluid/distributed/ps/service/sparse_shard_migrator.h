@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "brpc/channel.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+class Table;
+
+/**
+ * Moves global shards of a sparse table from this server to another one
+ * while the training goes on, for the online resharding of the servers.
+ *
+ * A resharding is driven by one client, see BrpcPsClient::AddPsServers:
+ *  1. Stream, for PS_MIGRATE_SPARSE_SHARD, starts recording the keys of the
+ *     shards written by the pushes and the training pulls, then sends the
+ *     values of the shards to the PS_IMPORT_SPARSE_VALUES of the target
+ *     server, one shard at a time;
+ *  2. once all the clients have flushed their pushes and wait at a barrier,
+ *     Finish, for the final PS_MIGRATE_SPARSE_SHARD, sends the values of the
+ *     recorded keys again and drops the shards;
+ *  3. the clients switch the routing of the table before leaving the
+ *     barrier.
+ **/
+class SparseShardMigrator {
+ public:
+  SparseShardMigrator(const TableParameter &table_param, Table *table);
+
+  int32_t Stream(const std::vector<uint32_t> &shards,
+                 const std::string &endpoint);
+  int32_t Finish(const std::vector<uint32_t> &shards,
+                 const std::string &endpoint);
+
+  // called after the keys are written, does nothing unless streaming
+  void Touch(const uint64_t *keys, size_t num);
+
+ private:
+  static constexpr size_t kBatchKeys = 100000;
+
+  // sends the values to the server at endpoint in batches of kBatchKeys
+  int32_t Send(const std::string &endpoint,
+               const std::vector<uint64_t> &keys,
+               const std::vector<uint32_t> &dims,
+               const std::vector<float> &values);
+  brpc::Channel *ChannelOf(const std::string &endpoint);
+
+  uint32_t _table_id;
+  Table *_table;
+  uint32_t _shard_num;
+  std::atomic<bool> _streaming{false};
+  std::mutex _mutex;
+  // the shards being moved, and their keys written since
+  std::unordered_set<uint32_t> _shards;
+  std::unordered_set<uint64_t> _dirty_keys;
+  std::unordered_map<std::string, std::shared_ptr<brpc::Channel>> _channels;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_shard_router.h"
+
+#include <algorithm>
+#include <map>
+
+namespace paddle {
+namespace distributed {
+
+SparseShardRouting::SparseShardRouting(uint32_t shard_num,
+                                       uint32_t server_num)
+    : _shard_servers(shard_num) {
+  uint32_t local_shard_num = shard_num % server_num == 0
+                                 ? shard_num / server_num
+                                 : shard_num / server_num + 1;
+  for (uint32_t shard_id = 0; shard_id < shard_num; ++shard_id) {
+    _shard_servers[shard_id] = shard_id / local_shard_num;
+  }
+}
+
+SparseShardRouting::SparseShardRouting(std::vector<uint32_t> shard_servers)
+    : _shard_servers(std::move(shard_servers)) {}
+
+std::shared_ptr<SparseShardRouting> SparseShardRouting::PlanScaleOut(
+    uint32_t server_num, std::vector<SparseShardMove> *moves) const {
+  uint32_t shard_num = ShardNum();
+  uint32_t max_server = server_num;
+  for (auto server : _shard_servers) {
+    max_server = std::max(max_server, server + 1);
+  }
+  // the servers out of server_num keep no shard
+  std::vector<uint32_t> counts(max_server, 0);
+  std::vector<uint32_t> quotas(max_server, 0);
+  for (auto server : _shard_servers) {
+    ++counts[server];
+  }
+  for (uint32_t server = 0; server < server_num; ++server) {
+    quotas[server] =
+        shard_num / server_num + (server < shard_num % server_num ? 1 : 0);
+  }
+
+  std::vector<uint32_t> shard_servers = _shard_servers;
+  std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> groups;
+  uint32_t to = 0;
+  for (uint32_t shard_id = 0; shard_id < shard_num; ++shard_id) {
+    uint32_t from = shard_servers[shard_id];
+    if (counts[from] <= quotas[from]) {
+      continue;
+    }
+    while (counts[to] >= quotas[to]) {
+      ++to;
+    }
+    --counts[from];
+    ++counts[to];
+    shard_servers[shard_id] = to;
+    groups[{from, to}].push_back(shard_id);
+  }
+  moves->clear();
+  for (auto &group : groups) {
+    moves->push_back(
+        {group.first.first, group.first.second, std::move(group.second)});
+  }
+  return std::make_shared<SparseShardRouting>(std::move(shard_servers));
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// the global shards of a sparse table moved from a server to another one
+struct SparseShardMove {
+  uint32_t from;
+  uint32_t to;
+  std::vector<uint32_t> shards;
+};
+
+/**
+ * The server of each global shard key % shard_num of a sparse table. At
+ * start every server holds a contiguous range of the shards, as laid out by
+ * the tables. A routing is never changed once made, so a request routes all
+ * its keys with the same one.
+ **/
+class SparseShardRouting {
+ public:
+  SparseShardRouting(uint32_t shard_num, uint32_t server_num);
+  explicit SparseShardRouting(std::vector<uint32_t> shard_servers);
+
+  size_t ServerOf(uint64_t key) const {
+    return _shard_servers[key % _shard_servers.size()];
+  }
+  uint32_t ShardNum() const { return _shard_servers.size(); }
+  const std::vector<uint32_t> &ShardServers() const { return _shard_servers; }
+
+  // Spreads the shards evenly over server_num servers, moving only the
+  // shards of the servers holding more than their share. Returns the
+  // routing after the moves.
+  std::shared_ptr<SparseShardRouting> PlanScaleOut(
+      uint32_t server_num, std::vector<SparseShardMove> *moves) const;
+
+ private:
+  std::vector<uint32_t> _shard_servers;
+};
+
+// The routing of a sparse table on the client, switched atomically.
+class SparseShardRouter {
+ public:
+  SparseShardRouter(uint32_t shard_num, uint32_t server_num)
+      : _routing(std::make_shared<SparseShardRouting>(shard_num, server_num)) {
+  }
+
+  std::shared_ptr<const SparseShardRouting> Routing() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _routing;
+  }
+  void Switch(std::shared_ptr<const SparseShardRouting> routing) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _routing = std::move(routing);
+  }
+
+ private:
+  mutable std::mutex _mutex;
+  std::shared_ptr<const SparseShardRouting> _routing;
+};
+
+}  // namespace distributed
+}  // namespace paddle
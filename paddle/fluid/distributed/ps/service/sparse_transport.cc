@@ -0,0 +1,146 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_transport.h"
+
+#include <cstring>
+
+#include "brpc/policy/snappy_compress.h"
+#include "butil/iobuf.h"
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_quant.h"
+
+namespace paddle {
+namespace distributed {
+
+std::shared_ptr<SparseTransportCodec> SparseTransportCodec::Create(
+    const TableParameter &table_param, const AccessorInfo &info) {
+  const auto &param = table_param.sparse_transport();
+  if (param.pull_value_type() == SPARSE_VALUE_FP32 &&
+      param.push_grad_type() == SPARSE_VALUE_FP32 &&
+      !param.compress_attachment()) {
+    return nullptr;
+  }
+  auto codec = std::make_shared<SparseTransportCodec>();
+  size_t embedx_dim = table_param.accessor().embedx_dim();
+  // the accessors without a trailing embedx part send the rows in fp32
+  if (embedx_dim > info.select_dim || embedx_dim > info.update_dim) {
+    LOG(WARNING) << "table " << table_param.table_id()
+                 << " has no embedx part to encode, sends it in fp32";
+    embedx_dim = 0;
+  }
+  codec->_pull.type = param.pull_value_type();
+  codec->_pull.head_dim = info.select_dim - embedx_dim;
+  codec->_pull.embedx_dim = embedx_dim;
+  codec->_push.type = param.push_grad_type();
+  codec->_push.head_dim = info.update_dim - embedx_dim;
+  codec->_push.embedx_dim = embedx_dim;
+  codec->_compress_attachment = param.compress_attachment();
+  codec->_max_residual_keys = param.max_residual_keys();
+  VLOG(0) << "table " << table_param.table_id() << " sparse transport: pull "
+          << SparseValueCompressType_Name(param.pull_value_type()) << ", push "
+          << SparseValueCompressType_Name(param.push_grad_type())
+          << ", compress_attachment " << param.compress_attachment();
+  return codec;
+}
+
+size_t SparseTransportCodec::RowFormat::Size() const {
+  return head_dim * sizeof(float) + SparseQuantSize(type, embedx_dim);
+}
+
+void SparseTransportCodec::RowFormat::Encode(const float *value,
+                                             char *out) const {
+  memcpy(out, value, head_dim * sizeof(float));
+  SparseQuantize(
+      type, value + head_dim, embedx_dim, out + head_dim * sizeof(float));
+}
+
+void SparseTransportCodec::RowFormat::Decode(const char *data,
+                                             float *value) const {
+  memcpy(value, data, head_dim * sizeof(float));
+  SparseDequantize(
+      type, data + head_dim * sizeof(float), embedx_dim, value + head_dim);
+}
+
+void SparseTransportCodec::EncodePullValues(const float *values,
+                                            size_t num,
+                                            char *out) const {
+  size_t dim = _pull.head_dim + _pull.embedx_dim;
+  size_t row_size = _pull.Size();
+  for (size_t i = 0; i < num; ++i) {
+    _pull.Encode(values + i * dim, out + i * row_size);
+  }
+}
+
+void SparseTransportCodec::DecodePullValue(const char *data,
+                                           float *value) const {
+  _pull.Decode(data, value);
+}
+
+void SparseTransportCodec::EncodePushGrad(uint64_t key,
+                                          const float *grad,
+                                          char *out) {
+  if (_push.type == SPARSE_VALUE_FP32 || _push.embedx_dim == 0) {
+    _push.Encode(grad, out);
+    return;
+  }
+  size_t dim = _push.head_dim + _push.embedx_dim;
+  thread_local std::vector<float> compensated;
+  thread_local std::vector<float> decoded;
+  compensated.assign(grad, grad + dim);
+  decoded.resize(dim);
+
+  std::lock_guard<std::mutex> guard(_residual_mutex);
+  auto itr = _residuals.find(key);
+  if (itr == _residuals.end()) {
+    if (_residuals.size() >= _max_residual_keys) {
+      _residuals.clear();
+    }
+    itr = _residuals.emplace(key, std::vector<float>(_push.embedx_dim, 0.0f))
+              .first;
+  }
+  auto &residual = itr->second;
+  float *embedx = compensated.data() + _push.head_dim;
+  for (size_t i = 0; i < _push.embedx_dim; ++i) {
+    embedx[i] += residual[i];
+  }
+  _push.Encode(compensated.data(), out);
+  _push.Decode(out, decoded.data());
+  for (size_t i = 0; i < _push.embedx_dim; ++i) {
+    residual[i] = embedx[i] - decoded[_push.head_dim + i];
+  }
+}
+
+void SparseTransportCodec::DecodePushGrads(const char *data,
+                                           size_t num,
+                                           float *grads) const {
+  size_t dim = _push.head_dim + _push.embedx_dim;
+  size_t row_size = _push.Size();
+  for (size_t i = 0; i < num; ++i) {
+    _push.Decode(data + i * row_size, grads + i * dim);
+  }
+}
+
+bool SparseTransportCodec::Compress(const butil::IOBuf &in,
+                                    butil::IOBuf *out) {
+  return brpc::policy::SnappyCompress(in, out);
+}
+
+bool SparseTransportCodec::Decompress(const butil::IOBuf &in,
+                                      butil::IOBuf *out) {
+  return brpc::policy::SnappyDecompress(in, out);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace butil {
+class IOBuf;
+}  // namespace butil
+
+namespace paddle {
+namespace distributed {
+
+/**
+ * The wire format of the rows of a sparse table, set by the
+ * sparse_transport of its TableParameter, which the client and the server
+ * share. A row is sent as its leading (dim - embedx_dim) floats, e.g.
+ * show/click/embed_w, and its embedx part encoded by the compress type:
+ *
+ *   |---head: fp32---|---[int8 scale: fp32]---|---embedx: fp16/bf16/int8---|
+ *
+ * The pulled rows are encoded by the server and the pushed gradients by the
+ * client, which adds the rounding error of the last gradients of each key to
+ * the next ones, so that no update is lost over the steps.
+ **/
+class SparseTransportCodec {
+ public:
+  // Returns nullptr if the table sends its rows in raw fp32.
+  static std::shared_ptr<SparseTransportCodec> Create(
+      const TableParameter &table_param, const AccessorInfo &info);
+
+  // bytes of an encoded pulled row, of select_dim floats
+  size_t PullValueSize() const { return _pull.Size(); }
+  void EncodePullValues(const float *values, size_t num, char *out) const;
+  void DecodePullValue(const char *data, float *value) const;
+
+  // bytes of an encoded pushed gradient, of update_dim floats
+  size_t PushGradSize() const { return _push.Size(); }
+  void EncodePushGrad(uint64_t key, const float *grad, char *out);
+  void DecodePushGrads(const char *data, size_t num, float *grads) const;
+
+  bool CompressAttachment() const { return _compress_attachment; }
+  // snappy of the pulled rows, the pushed gradients are in the request
+  // message and are compressed by brpc
+  static bool Compress(const butil::IOBuf &in, butil::IOBuf *out);
+  static bool Decompress(const butil::IOBuf &in, butil::IOBuf *out);
+
+ private:
+  struct RowFormat {
+    SparseValueCompressType type = SPARSE_VALUE_FP32;
+    size_t head_dim = 0;
+    size_t embedx_dim = 0;
+
+    size_t Size() const;
+    void Encode(const float *value, char *out) const;
+    void Decode(const char *data, float *value) const;
+  };
+
+  RowFormat _pull;
+  RowFormat _push;
+  bool _compress_attachment = false;
+  size_t _max_residual_keys = 0;
+
+  std::mutex _residual_mutex;
+  std::unordered_map<uint64_t, std::vector<float>> _residuals;
+};
+
+}  // namespace distributed
+}  // namespace paddle
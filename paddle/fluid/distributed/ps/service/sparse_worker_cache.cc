@@ -0,0 +1,130 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_worker_cache.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace distributed {
+
+std::shared_ptr<SparseWorkerCache> SparseWorkerCache::Create(
+    const TableParameter &table_param, const AccessorInfo &info) {
+  const auto &param = table_param.sparse_worker_cache();
+  if (param.capacity() == 0 || param.max_staleness() == 0) {
+    return nullptr;
+  }
+  VLOG(0) << "table " << table_param.table_id() << " sparse worker cache: "
+          << "capacity " << param.capacity() << ", max_staleness "
+          << param.max_staleness();
+  return std::make_shared<SparseWorkerCache>(
+      param.capacity(), param.max_staleness(), info.select_dim);
+}
+
+SparseWorkerCache::SparseWorkerCache(size_t capacity,
+                                     uint32_t max_staleness,
+                                     size_t dim)
+    : _shard_capacity((capacity + kShardNum - 1) / kShardNum),
+      _max_staleness(max_staleness),
+      _dim(dim),
+      _shards(kShardNum) {}
+
+SparseWorkerCache::Shard &SparseWorkerCache::ShardOf(uint64_t key) {
+  // the low bits of the keys of a table select its servers
+  key = (key ^ (key >> 33)) * 0xff51afd7ed558ccdULL;
+  return _shards[(key ^ (key >> 33)) % kShardNum];
+}
+
+bool SparseWorkerCache::Get(uint64_t key, uint64_t pull_id, float *value) {
+  auto &shard = ShardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto itr = shard.index.find(key);
+  if (itr == shard.index.end()) {
+    return false;
+  }
+  auto entry = itr->second;
+  if (pull_id > entry->pull_id + _max_staleness) {
+    shard.entries.erase(entry);
+    shard.index.erase(itr);
+    return false;
+  }
+  memcpy(value, entry->value.data(), _dim * sizeof(float));
+  shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+  return true;
+}
+
+void SparseWorkerCache::Put(uint64_t key,
+                            uint64_t pull_id,
+                            const float *value) {
+  // started before the values were dropped
+  if (pull_id <= _min_put_pull.load()) {
+    return;
+  }
+  auto &shard = ShardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto itr = shard.index.find(key);
+  if (itr != shard.index.end()) {
+    auto entry = itr->second;
+    // fetched by an older pull finishing late
+    if (entry->pull_id > pull_id) {
+      return;
+    }
+    entry->pull_id = pull_id;
+    memcpy(entry->value.data(), value, _dim * sizeof(float));
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    return;
+  }
+  if (shard.index.size() >= _shard_capacity) {
+    // reuses the least recently used entry
+    shard.index.erase(shard.entries.back().key);
+    shard.entries.splice(
+        shard.entries.begin(), shard.entries, std::prev(shard.entries.end()));
+  } else {
+    shard.entries.emplace_front();
+    shard.entries.front().value.resize(_dim);
+  }
+  auto &entry = shard.entries.front();
+  entry.key = key;
+  entry.pull_id = pull_id;
+  memcpy(entry.value.data(), value, _dim * sizeof(float));
+  shard.index[key] = shard.entries.begin();
+}
+
+void SparseWorkerCache::Erase(const uint64_t *keys, size_t num) {
+  _min_put_pull = _pull_num.load();
+  for (size_t i = 0; i < num; ++i) {
+    auto &shard = ShardOf(keys[i]);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto itr = shard.index.find(keys[i]);
+    if (itr != shard.index.end()) {
+      shard.entries.erase(itr->second);
+      shard.index.erase(itr);
+    }
+  }
+}
+
+void SparseWorkerCache::Clear() {
+  _min_put_pull = _pull_num.load();
+  for (auto &shard : _shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.clear();
+    shard.index.clear();
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
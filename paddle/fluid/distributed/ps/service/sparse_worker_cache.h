@@ -0,0 +1,85 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+/**
+ * The pulled values of a sparse table cached on the worker, set by the
+ * sparse_worker_cache of its TableParameter. Each pull of the table gets the
+ * next pull id, and a value fetched by a pull is reused by the pulls whose
+ * ids are at most max_staleness larger, so that in async training a hot key
+ * is fetched once in max_staleness pulls. The pushed gradients do not drop
+ * the cached values, they are merged by key and sent by the push thread of
+ * the client as before.
+ *
+ * It is thread safe, the keys are spread over kShardNum LRU lists.
+ **/
+class SparseWorkerCache {
+ public:
+  // Returns nullptr if the table is not cached.
+  static std::shared_ptr<SparseWorkerCache> Create(
+      const TableParameter &table_param, const AccessorInfo &info);
+
+  SparseWorkerCache(size_t capacity, uint32_t max_staleness, size_t dim);
+
+  uint64_t NextPull() { return _pull_num.fetch_add(1) + 1; }
+  // copies the value of key into value if it is fresh for the pull
+  bool Get(uint64_t key, uint64_t pull_id, float *value);
+  void Put(uint64_t key, uint64_t pull_id, const float *value);
+
+  void Erase(const uint64_t *keys, size_t num);
+  void Clear();
+
+ private:
+  static constexpr size_t kShardNum = 64;
+
+  struct Entry {
+    uint64_t key;
+    uint64_t pull_id;
+    std::vector<float> value;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // the recently used entries first
+    std::list<Entry> entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+  };
+
+  Shard &ShardOf(uint64_t key);
+
+  size_t _shard_capacity;
+  uint32_t _max_staleness;
+  size_t _dim;
+  std::atomic<uint64_t> _pull_num{0};
+  // the pulls up to it may not put their values
+  std::atomic<uint64_t> _min_put_pull{0};
+  std::vector<Shard> _shards;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -42,6 +42,7 @@ COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_uint64(gpugraph_slot_feasign_max_num);
 COMMON_DECLARE_bool(graph_metapath_split_opt);
 COMMON_DECLARE_double(graph_neighbor_size_percent);
+COMMON_DECLARE_bool(graph_compress_edges);
 
 PHI_DEFINE_EXPORTED_bool(graph_edges_split_only_by_src_id,
                          false,
@@ -50,6 +51,12 @@ PHI_DEFINE_EXPORTED_string(
     graph_edges_split_mode,
     "hard",
     "graph split split, optional: [dbh,hard,fennel,none], default:hard");
+PHI_DEFINE_EXPORTED_string(
+    graph_edges_split_rank_path,
+    "",
+    "the directory of the node ranks of fennel split, which are loaded "
+    "instead of being computed if the directory has them, or saved there by "
+    "node 0 after being computed, default empty");
 PHI_DEFINE_EXPORTED_bool(graph_edges_split_debug,
                          false,
                          "graph split by debug");
@@ -741,6 +748,17 @@ void GraphTable::feature_shrink_to_fit() {
   for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
 }
 
+void GraphTable::compress_edges(int idx) {
+  std::vector<std::future<int>> tasks;
+  for (auto &shard : edge_shards[idx]) {
+    tasks.push_back(load_node_edge_task_pool->enqueue([&shard]() -> int {
+      shard->compress_edges();
+      return 0;
+    }));
+  }
+  for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
+}
+
 void GraphTable::merge_feature_shard() {
   VLOG(0) << "begin merge_feature_shard";
   std::vector<std::future<int>> tasks;
@@ -920,7 +938,15 @@ void GraphTable::graph_partition(bool is_edge) {
     }
   } else if (strncasecmp(mode.c_str(), "fennel", 6) == 0) {
     if (is_edge) {
-      fennel_graph_edge_partition();
+      const std::string &rank_path = FLAGS_graph_edges_split_rank_path;
+      if (!rank_path.empty() && load_node_rank(rank_path)) {
+        filter_graph_edge_nodes();
+      } else {
+        fennel_graph_edge_partition();
+        if (!rank_path.empty() && node_id_ == 0) {
+          save_node_rank(rank_path);
+        }
+      }
     } else {
       fennel_graph_feature_partition();
     }
@@ -1398,6 +1424,118 @@ void GraphTable::fennel_graph_edge_partition() {
   filter_graph_edge_nodes();
   VLOG(0) << "end to process fennel new edge shard";
 }
+std::string GraphTable::node_rank_file(const std::string &path,
+                                       size_t part_id) {
+  std::string file_path = path;
+  if (file_path[file_path.size() - 1] != '/') {
+    file_path += "/";
+  }
+  return file_path + "node_rank_" + std::to_string(part_id);
+}
+
+void GraphTable::save_node_rank(const std::string &path) {
+  VLOG(0) << "begin save node rank to " << path;
+  std::vector<std::future<size_t>> tasks;
+  for (size_t part_id = 0; part_id < shard_num_per_server; ++part_id) {
+    tasks.push_back(
+        load_node_edge_task_pool->enqueue([this, &path, part_id]() -> size_t {
+          // writes to a temporary file first, which is never loaded
+          std::string output_path = node_rank_file(path, part_id);
+          std::string tmp_path = output_path + ".tmp";
+          std::ofstream ofs(tmp_path);
+          if (ofs.fail()) {
+            VLOG(0) << "creating " << tmp_path << " failed";
+            return 0;
+          }
+          size_t cnt = 0;
+          for (int rank = 0; rank < node_num_; ++rank) {
+            for (auto &key : edge_node_rank_.get_shard_nodes(rank, part_id)) {
+              ofs << key << '\t' << rank << '\n';
+              ++cnt;
+            }
+          }
+          ofs.close();
+          PADDLE_ENFORCE_EQ(
+              std::rename(tmp_path.c_str(), output_path.c_str()),
+              0,
+              common::errors::Unavailable(
+                  "Renaming %s to %s failed.", tmp_path, output_path));
+          return cnt;
+        }));
+  }
+  size_t total = 0;
+  for (auto &t : tasks) {
+    total += t.get();
+  }
+  VLOG(0) << "end save node rank, node count=" << total;
+}
+
+bool GraphTable::load_node_rank(const std::string &path) {
+  for (size_t part_id = 0; part_id < shard_num_per_server; ++part_id) {
+    std::ifstream file(node_rank_file(path, part_id));
+    if (!file.good()) {
+      VLOG(0) << "node rank is not found in " << path
+              << ", it is computed by fennel";
+      return false;
+    }
+  }
+  VLOG(0) << "begin load node rank from " << path;
+  edge_node_rank_.clear();
+  edge_node_rank_.init(node_num_, shard_num_per_server);
+  std::vector<std::future<std::vector<size_t>>> tasks;
+  for (size_t part_id = 0; part_id < shard_num_per_server; ++part_id) {
+    tasks.push_back(load_node_edge_task_pool->enqueue(
+        [this, &path, part_id]() -> std::vector<size_t> {
+          std::vector<size_t> counts(node_num_, 0);
+          std::ifstream file(node_rank_file(path, part_id));
+          uint64_t key = 0;
+          int rank = 0;
+          while (file >> key >> rank) {
+            PADDLE_ENFORCE_EQ(
+                rank >= 0 && rank < node_num_,
+                true,
+                common::errors::InvalidArgument(
+                    "The rank %d of node %lu in %s is out of [0, %d), the "
+                    "node ranks should be saved by as many nodes.",
+                    rank,
+                    key,
+                    node_rank_file(path, part_id),
+                    node_num_));
+            PADDLE_ENFORCE_EQ(key % shard_num_per_server,
+                              part_id,
+                              common::errors::InvalidArgument(
+                                  "The node %lu should not be in %s.",
+                                  key,
+                                  node_rank_file(path, part_id)));
+            edge_node_rank_.insert_shard_node(key, rank);
+            ++counts[rank];
+          }
+          // the nodes that are new to the saved ranks are split by hash
+          for (size_t idx = 0; idx < edge_shards.size(); ++idx) {
+            for (auto &node : edge_shards[idx][part_id]->get_bucket()) {
+              uint64_t id = node->get_id();
+              if (edge_node_rank_.find(id) < 0) {
+                int hash_rank = partition_key_for_rank(id);
+                edge_node_rank_.insert_shard_node(id, hash_rank);
+                ++counts[hash_rank];
+              }
+            }
+          }
+          return counts;
+        }));
+  }
+  for (auto &t : tasks) {
+    auto counts = t.get();
+    for (int rank = 0; rank < node_num_; ++rank) {
+      edge_node_rank_.add_nodes_num(rank, counts[rank]);
+    }
+  }
+  for (int i = 0; i < node_num_; i++) {
+    VLOG(0) << " edge_node_ids[" << i << "] :" << edge_node_rank_.nodes_num(i);
+  }
+  return true;
+}
+
 void GraphTable::filter_graph_edge_nodes() {
   VLOG(0) << "begin filter graph edge nodes";
   // 过滤不属于自己边表信息
@@ -2646,6 +2784,11 @@ std::pair<uint64_t, uint64_t> GraphTable::load_edges(
   }
 #endif
 
+  if (FLAGS_graph_compress_edges) {
+    VLOG(0) << "compress edges of edge_type[" << edge_type << "] ... ";
+    compress_edges(idx);
+  }
+
   if (!build_sampler_on_cpu) {
     // To reduce memory overhead, CPU samplers won't be created in gpugraph.
     // In order not to affect the sampler function of other scenario,
@@ -2821,7 +2964,11 @@ int32_t GraphTable::random_sample_neighbors(
       LRUResponse response = LRUResponse::blocked;
       if (use_cache) {
         response =
-            scaled_lru->query(i, id_list[i].data(), id_list[i].size(), r);
+            clock_cache != nullptr
+                ? clock_cache->query(
+                      i, id_list[i].data(), id_list[i].size(), r)
+                : scaled_lru->query(
+                      i, id_list[i].data(), id_list[i].size(), r);
       }
       size_t index = 0;
       std::vector<SampleResult> sample_res;
@@ -2889,8 +3036,13 @@ int32_t GraphTable::random_sample_neighbors(
         }
       }
       if (!sample_res.empty()) {
-        scaled_lru->insert(
-            i, sample_keys.data(), sample_res.data(), sample_keys.size());
+        if (clock_cache != nullptr) {
+          clock_cache->insert(
+              i, sample_keys.data(), sample_res.data(), sample_keys.size());
+        } else {
+          scaled_lru->insert(
+              i, sample_keys.data(), sample_res.data(), sample_keys.size());
+        }
       }
       return 0;
     }));
@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
@@ -51,6 +52,9 @@
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/framework/fleet/heter_ps/gpu_graph_node.h"
 #endif
+
+COMMON_DECLARE_uint64(graph_sample_cache_memory_limit);
+
 namespace paddle {
 namespace distributed {
 class GraphShard {
@@ -141,6 +145,12 @@ class GraphShard {
     }
   }
 
+  void compress_edges() {
+    for (size_t i = 0; i < bucket.size(); i++) {
+      bucket[i]->compress_edges();
+    }
+  }
+
   void merge_shard(GraphShard *&shard) {  // NOLINT
     bucket.reserve(bucket.size() + shard->bucket.size());
     for (size_t i = 0; i < shard->bucket.size(); i++) {
@@ -441,6 +451,125 @@ class ScaledLRU {
   std::shared_ptr<::ThreadPool> thread_pool;
   friend class RandomSampleLRU<K, V>;
 };
+// A CLOCK cache of the sample results, bounded by the bytes of the cached
+// buffers instead of their count. Each shard is only accessed by the thread
+// of its task pool, so neither query nor insert takes a lock, and no thread
+// is needed to shrink the shards. The entries live in a slab reused through
+// a free list, and the clock hand of the shard evicts the entries that are
+// not referenced since its last round, when an insert exceeds the memory of
+// the shard. As ScaledLRU, an entry is removed after it is returned ttl times.
+template <typename K, typename V>
+class ClockSampleCache {
+ public:
+  ClockSampleCache(size_t shard_num, size_t memory_limit, size_t ttl)
+      : ttl(ttl),
+        shard_memory_limit(memory_limit / std::max<size_t>(shard_num, 1)),
+        shards(shard_num) {}
+
+  LRUResponse query(size_t index,
+                    K *keys,
+                    size_t length,
+                    std::vector<std::pair<K, V>> &res) {  // NOLINT
+    Shard &shard = shards[index];
+    for (size_t i = 0; i < length; i++) {
+      auto iter = shard.key_map.find(keys[i]);
+      if (iter == shard.key_map.end()) {
+        continue;
+      }
+      Entry &entry = shard.slab[iter->second];
+      res.emplace_back(keys[i], entry.data);
+      entry.referenced = true;
+      if (--entry.ttl == 0) {
+        remove(&shard, iter->second);
+      }
+    }
+    return LRUResponse::ok;
+  }
+
+  LRUResponse insert(size_t index, K *keys, V *data, size_t length) {
+    Shard &shard = shards[index];
+    for (size_t i = 0; i < length; i++) {
+      auto iter = shard.key_map.find(keys[i]);
+      if (iter != shard.key_map.end()) {
+        remove(&shard, iter->second);
+      }
+      size_t bytes = data[i].actual_size;
+      if (bytes > shard_memory_limit) {
+        continue;
+      }
+      while (shard.bytes + bytes > shard_memory_limit) {
+        evict(&shard);
+      }
+      uint32_t pos;
+      if (shard.free_list.empty()) {
+        pos = shard.slab.size();
+        shard.slab.emplace_back(keys[i], data[i], ttl);
+      } else {
+        pos = shard.free_list.back();
+        shard.free_list.pop_back();
+        shard.slab[pos] = Entry(keys[i], data[i], ttl);
+      }
+      shard.key_map[keys[i]] = pos;
+      shard.bytes += bytes;
+    }
+    return LRUResponse::ok;
+  }
+
+  size_t get_ttl() { return ttl; }
+
+ private:
+  struct Entry {
+    Entry(const K &_key, const V &_data, size_t _ttl)
+        : key(_key), data(_data), ttl(_ttl), referenced(false), used(true) {}
+    K key;
+    V data;
+    size_t ttl;
+    bool referenced;
+    bool used;
+  };
+  struct Shard {
+    robin_hood::unordered_flat_map<K, uint32_t> key_map;
+    std::vector<Entry> slab;
+    std::vector<uint32_t> free_list;
+    size_t hand = 0;
+    size_t bytes = 0;
+  };
+
+  void remove(Shard *shard, uint32_t pos) {
+    Entry &entry = shard->slab[pos];
+    shard->key_map.erase(entry.key);
+    shard->bytes -= entry.data.actual_size;
+    // releases the buffer, which is shared with the sample results
+    entry.data.buffer.reset();
+    entry.used = false;
+    shard->free_list.push_back(pos);
+  }
+
+  // the caller makes sure that the shard is not empty
+  void evict(Shard *shard) {
+    while (true) {
+      if (shard->hand >= shard->slab.size()) {
+        shard->hand = 0;
+      }
+      uint32_t pos = shard->hand++;
+      Entry &entry = shard->slab[pos];
+      if (!entry.used) {
+        continue;
+      }
+      if (entry.referenced) {
+        entry.referenced = false;
+        continue;
+      }
+      remove(shard, pos);
+      return;
+    }
+  }
+
+  size_t ttl;
+  size_t shard_memory_limit;
+  std::vector<Shard> shards;
+};
+
 enum GraphTableType { EDGE_TABLE, FEATURE_TABLE, NODE_TABLE };
 class GraphTable : public Table {
   class GraphNodeRank {
@@ -459,6 +588,7 @@ class GraphTable : public Table {
     void clear(void) {
       rank_nodes_.clear();
       rank_nodes_.shrink_to_fit();
+      rank_sizes_.clear();
     }
     void rehash(const int &shard_id, const size_t count) {
       size_t per_count = (count + node_num_ - 1) / node_num_;
@@ -482,6 +612,18 @@ class GraphTable : public Table {
       rank_nodes_[rank][key % shard_num_].insert(key);
       ++rank_sizes_[rank];
     }
+    // inserts without counting, so that the keys of different shards can be
+    // inserted by different threads, which count them by add_nodes_num
+    void insert_shard_node(const uint64_t &key, const int &rank) {
+      rank_nodes_[rank][key % shard_num_].insert(key);
+    }
+    void add_nodes_num(const int &rank, const size_t &num) {
+      rank_sizes_[rank] += num;
+    }
+    const robin_hood::unordered_set<uint64_t> &get_shard_nodes(
+        const int &rank, const size_t &shard_id) {
+      return rank_nodes_[rank][shard_id];
+    }
     int find(const uint64_t &key) {
       int shard_id = key % shard_num_;
       for (int i = 0; i < node_num_; ++i) {
@@ -700,6 +842,7 @@ class GraphTable : public Table {
   void clear_feature_shard();
   void clear_node_shard();
   void feature_shrink_to_fit();
+  void compress_edges(int idx);
   void merge_feature_shard();
   void release_graph();
   void release_graph_edge();
@@ -708,8 +851,13 @@ class GraphTable : public Table {
     {
       std::unique_lock<std::mutex> lock(mutex_);
       if (use_cache == false) {
-        scaled_lru.reset(new ScaledLRU<SampleKey, SampleResult>(
-            task_pool_size_, size_limit, ttl));
+        if (FLAGS_graph_sample_cache_memory_limit > 0) {
+          clock_cache.reset(new ClockSampleCache<SampleKey, SampleResult>(
+              task_pool_size_, FLAGS_graph_sample_cache_memory_limit, ttl));
+        } else {
+          scaled_lru.reset(new ScaledLRU<SampleKey, SampleResult>(
+              task_pool_size_, size_limit, ttl));
+        }
         use_cache = true;
       }
     }
@@ -760,6 +908,10 @@ class GraphTable : public Table {
   void dbh_graph_edge_partition();
   void dbh_graph_feature_partition();
   void fennel_graph_edge_partition();
+  // the node ranks of fennel split, by the shards of the server
+  std::string node_rank_file(const std::string &path, size_t part_id);
+  void save_node_rank(const std::string &path);
+  bool load_node_rank(const std::string &path);
   void filter_graph_edge_nodes();
   void fennel_graph_feature_partition();
 
@@ -827,6 +979,8 @@ class GraphTable : public Table {
   std::vector<std::shared_ptr<std::mt19937_64>> _shards_task_rng_pool;
   std::shared_ptr<::ThreadPool> load_node_edge_task_pool;
   std::shared_ptr<ScaledLRU<SampleKey, SampleResult>> scaled_lru;
+  // replaces scaled_lru with FLAGS_graph_sample_cache_memory_limit
+  std::shared_ptr<ClockSampleCache<SampleKey, SampleResult>> clock_cache;
   std::unordered_set<uint64_t> extra_nodes;
   std::unordered_map<uint64_t, size_t> extra_nodes_to_thread_index;
   bool use_cache, use_duplicate_nodes;
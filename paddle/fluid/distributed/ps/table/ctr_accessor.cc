@@ -246,6 +246,16 @@ int32_t CtrCommonAccessor::Merge(float** update_values,
 int32_t CtrCommonAccessor::Update(float** update_values,
                                   const float** push_values,
                                   size_t num) {
+  // the sgd rules update the embed and the embedx parts of all the values in
+  // one UpdateValueBatch call each
+  thread_local std::vector<float*> w;
+  thread_local std::vector<float*> sgd;
+  thread_local std::vector<const float*> grads;
+  thread_local std::vector<float> scales;
+  w.resize(num);
+  sgd.resize(num);
+  grads.resize(num);
+  scales.resize(num);
   for (size_t value_item = 0; value_item < num; ++value_item) {
     float* update_value = update_values[value_item];
     const float* push_value = push_values[value_item];
@@ -265,17 +275,22 @@ int32_t CtrCommonAccessor::Update(float** update_values,
     }
     VLOG(3) << "accessor show scale:" << _show_scale
             << ", push_show:" << push_show;
-    _embed_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedWIndex(),
-        update_value + common_feature_value.EmbedG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedGIndex(),
-        push_show);
-    _embedx_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedxWIndex(),
-        update_value + common_feature_value.EmbedxG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedxGIndex(),
-        push_show);
+    scales[value_item] = push_show;
+    w[value_item] = update_value + common_feature_value.EmbedWIndex();
+    sgd[value_item] = update_value + common_feature_value.EmbedG2SumIndex();
+    grads[value_item] = push_value + CtrCommonPushValue::EmbedGIndex();
   }
+  _embed_sgd_rule->UpdateValueBatch(
+      w.data(), sgd.data(), grads.data(), scales.data(), num);
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    float* update_value = update_values[value_item];
+    w[value_item] = update_value + common_feature_value.EmbedxWIndex();
+    sgd[value_item] = update_value + common_feature_value.EmbedxG2SumIndex();
+    grads[value_item] =
+        push_values[value_item] + CtrCommonPushValue::EmbedxGIndex();
+  }
+  _embedx_sgd_rule->UpdateValueBatch(
+      w.data(), sgd.data(), grads.data(), scales.data(), num);
   return 0;
 }
 
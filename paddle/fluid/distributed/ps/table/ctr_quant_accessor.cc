@@ -0,0 +1,176 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/ctr_quant_accessor.h"
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_quant.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+int QuantFloats(SparseValueCompressType type, size_t n) {
+  if (n == 0) {
+    return 0;
+  }
+  return (SparseQuantSize(type, n) + sizeof(float) - 1) / sizeof(float);
+}
+
+}  // namespace
+
+void CtrQuantAccessor::InitAccessorInfo() {
+  // called by CtrCommonAccessor::Initialize once the sgd rules are created
+  _embedx_w_type = _config.ctr_accessor_param().embedx_storage_type();
+  _embedx_sgd_type = _config.ctr_accessor_param().embedx_sgd_storage_type();
+  size_t embedx_dim = common_feature_value.embedx_dim;
+  size_t embedx_sgd_dim = common_feature_value.embedx_sgd_dim;
+  if (dynamic_cast<StdAdaGradSGDRule*>(_embedx_sgd_rule) != nullptr) {
+    _embedx_sgd_vector_dim = embedx_dim;
+  } else if (dynamic_cast<SparseAdamSGDRule*>(_embedx_sgd_rule) != nullptr) {
+    _embedx_sgd_vector_dim = embedx_dim * 2;
+  } else {
+    _embedx_sgd_vector_dim = 0;
+  }
+
+  quant_feature_value.head_dim = common_feature_value.EmbedxWIndex();
+  quant_feature_value.embedx_w_dim = QuantFloats(_embedx_w_type, embedx_dim);
+  quant_feature_value.embedx_sgd_dim =
+      QuantFloats(_embedx_sgd_type, _embedx_sgd_vector_dim) +
+      (embedx_sgd_dim - _embedx_sgd_vector_dim);
+
+  CtrCommonAccessor::InitAccessorInfo();
+  _accessor_info.dim = quant_feature_value.Dim();
+  _accessor_info.size = quant_feature_value.Size();
+  _accessor_info.mf_size = (quant_feature_value.embedx_w_dim +
+                            quant_feature_value.embedx_sgd_dim) *
+                           sizeof(float);
+  VLOG(0) << "CtrQuantAccessor embedx_w: "
+          << SparseValueCompressType_Name(_embedx_w_type)
+          << ", embedx_sgd: " << SparseValueCompressType_Name(_embedx_sgd_type)
+          << ", value dim: " << quant_feature_value.Dim()
+          << " vs fp32 dim: " << common_feature_value.Dim();
+}
+
+float* CtrQuantAccessor::CommonBuffer() {
+  thread_local std::vector<float> buffer;
+  buffer.resize(common_feature_value.Dim());
+  return buffer.data();
+}
+
+void CtrQuantAccessor::Dequantize(const float* value,
+                                  float* common_value,
+                                  bool with_mf) {
+  memcpy(common_value, value, quant_feature_value.head_dim * sizeof(float));
+  if (!with_mf) {
+    return;
+  }
+  SparseDequantize(
+      _embedx_w_type,
+      reinterpret_cast<const char*>(value + quant_feature_value.EmbedxWIndex()),
+      common_feature_value.embedx_dim,
+      common_value + common_feature_value.EmbedxWIndex());
+  const float* sgd = value + quant_feature_value.EmbedxG2SumIndex();
+  float* common_sgd = common_value + common_feature_value.EmbedxG2SumIndex();
+  SparseDequantize(_embedx_sgd_type,
+                   reinterpret_cast<const char*>(sgd),
+                   _embedx_sgd_vector_dim,
+                   common_sgd);
+  memcpy(common_sgd + _embedx_sgd_vector_dim,
+         sgd + QuantFloats(_embedx_sgd_type, _embedx_sgd_vector_dim),
+         (common_feature_value.embedx_sgd_dim - _embedx_sgd_vector_dim) *
+             sizeof(float));
+}
+
+void CtrQuantAccessor::Quantize(const float* common_value,
+                                float* value,
+                                bool with_mf) {
+  memcpy(value, common_value, quant_feature_value.head_dim * sizeof(float));
+  if (!with_mf) {
+    return;
+  }
+  SparseQuantize(
+      _embedx_w_type,
+      common_value + common_feature_value.EmbedxWIndex(),
+      common_feature_value.embedx_dim,
+      reinterpret_cast<char*>(value + quant_feature_value.EmbedxWIndex()));
+  const float* common_sgd =
+      common_value + common_feature_value.EmbedxG2SumIndex();
+  float* sgd = value + quant_feature_value.EmbedxG2SumIndex();
+  SparseQuantize(_embedx_sgd_type,
+                 common_sgd,
+                 _embedx_sgd_vector_dim,
+                 reinterpret_cast<char*>(sgd));
+  memcpy(sgd + QuantFloats(_embedx_sgd_type, _embedx_sgd_vector_dim),
+         common_sgd + _embedx_sgd_vector_dim,
+         (common_feature_value.embedx_sgd_dim - _embedx_sgd_vector_dim) *
+             sizeof(float));
+}
+
+bool CtrQuantAccessor::HasMF(int size) {
+  return size > quant_feature_value.EmbedxWIndex();
+}
+
+int32_t CtrQuantAccessor::Create(float** values, size_t num) {
+  float* common_value = CommonBuffer();
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    CtrCommonAccessor::Create(&common_value, 1);
+    Quantize(common_value, values[value_item], true);
+  }
+  return 0;
+}
+
+int32_t CtrQuantAccessor::Select(float** select_values,
+                                 const float** values,
+                                 size_t num) {
+  float* common_value = CommonBuffer();
+  const float* common_value_ptr = common_value;
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    Dequantize(values[value_item], common_value, true);
+    CtrCommonAccessor::Select(
+        select_values + value_item, &common_value_ptr, 1);
+  }
+  return 0;
+}
+
+int32_t CtrQuantAccessor::Update(float** values,
+                                 const float** update_values,
+                                 size_t num) {
+  float* common_value = CommonBuffer();
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    Dequantize(values[value_item], common_value, true);
+    CtrCommonAccessor::Update(&common_value, update_values + value_item, 1);
+    Quantize(common_value, values[value_item], true);
+  }
+  return 0;
+}
+
+std::string CtrQuantAccessor::ParseToString(const float* v, int param) {
+  float* common_value = CommonBuffer();
+  bool with_mf = HasMF(param);
+  Dequantize(v, common_value, with_mf);
+  return CtrCommonAccessor::ParseToString(
+      common_value, with_mf ? common_feature_value.Dim() : param);
+}
+
+int CtrQuantAccessor::ParseFromString(const std::string& str, float* value) {
+  float* common_value = CommonBuffer();
+  int ret = CtrCommonAccessor::ParseFromString(str, common_value);
+  // the value may be allocated for the fields in the text only
+  bool with_mf = ret > quant_feature_value.head_dim;
+  Quantize(common_value, value, with_mf);
+  return with_mf ? quant_feature_value.Dim() : ret;
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/ctr_accessor.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// CtrCommonAccessor storing embedx_w and the per-dim embedx optimizer state
+// (the g2sum of StdAdaGradSGDRule, the moments of SparseAdamSGDRule) in
+// reduced precision, set by embedx_storage_type and embedx_sgd_storage_type
+// of ctr_accessor_param. The scalar state, e.g. the shared g2sum of
+// SparseAdaGradSGDRule and the beta pows, stays fp32. The values are
+// dequantized to the CtrCommonAccessor layout in Select/Update, and are
+// saved and loaded in its text format.
+class CtrQuantAccessor : public CtrCommonAccessor {
+ public:
+  struct CtrQuantFeatureValue {
+    /*
+       float slot;
+       float unseen_days;
+       float delta_score;
+       float show;
+       float click;
+       float embed_w;
+       std::vector<float> embed_g2sum;
+       embedx_w in embedx_storage_type, padded to floats;
+       the per-dim embedx_g2sum in embedx_sgd_storage_type, padded to floats;
+       the rest of embedx_g2sum in fp32;
+       */
+
+    int Dim() { return head_dim + embedx_w_dim + embedx_sgd_dim; }
+    int Size() { return Dim() * sizeof(float); }
+    int EmbedxWIndex() { return head_dim; }
+    int EmbedxG2SumIndex() { return EmbedxWIndex() + embedx_w_dim; }
+
+    // the floats of the fields before embedx_w
+    int head_dim;
+    // the floats embedx_w and embedx_g2sum are stored in
+    int embedx_w_dim;
+    int embedx_sgd_dim;
+  };
+
+  CtrQuantAccessor() {}
+  virtual ~CtrQuantAccessor() {}
+  void InitAccessorInfo() override;
+  bool HasMF(int size) override;
+  int32_t Create(float** value, size_t num) override;
+  int32_t Select(float** select_values,
+                 const float** values,
+                 size_t num) override;
+  int32_t Update(float** values,
+                 const float** update_values,
+                 size_t num) override;
+  std::string ParseToString(const float* value, int param) override;
+  int32_t ParseFromString(const std::string& str, float* v) override;
+
+  // between a value and a value in the CtrCommonAccessor layout, the embedx
+  // part is converted only if with_mf
+  void Dequantize(const float* value, float* common_value, bool with_mf);
+  void Quantize(const float* common_value, float* value, bool with_mf);
+
+  CtrQuantFeatureValue quant_feature_value;
+
+ private:
+  float* CommonBuffer();
+
+  SparseValueCompressType _embedx_w_type;
+  SparseValueCompressType _embedx_sgd_type;
+  // the leading per-dim part of embedx_g2sum
+  size_t _embedx_sgd_vector_dim;
+};
+
+}  // namespace distributed
+}  // namespace paddle
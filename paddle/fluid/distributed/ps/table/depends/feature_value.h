@@ -14,12 +14,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
 #include <mct/hash-map.hpp>
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/chunk_allocator.h"
+#include "paddle/fluid/distributed/ps/table/depends/feature_value_arena.h"
 
 namespace paddle {
 namespace distributed {
@@ -28,24 +33,213 @@ static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
 
+// The float storage of a feature. Values bound to a FeatureValueArena (see
+// SparseTableShard::enable_value_arena) live in the slabs of the arena, the
+// others are allocated on the heap. Like std::vector<float>, resize keeps the
+// prefix and zero-fills the new tail.
 class FixedFeatureValue {
  public:
   FixedFeatureValue() {}
-  ~FixedFeatureValue() {}
-  float* data() { return _data.data(); }
-  size_t size() { return _data.size(); }
-  void resize(size_t size) { _data.resize(size); }
-  void shrink_to_fit() { _data.shrink_to_fit(); }
+  FixedFeatureValue(const FixedFeatureValue& other) { assign(other); }
+  FixedFeatureValue(FixedFeatureValue&& other) noexcept { steal(&other); }
+  FixedFeatureValue& operator=(const FixedFeatureValue& other) {
+    if (this != &other) {
+      assign(other);
+    }
+    return *this;
+  }
+  FixedFeatureValue& operator=(FixedFeatureValue&& other) noexcept {
+    if (this != &other) {
+      release();
+      steal(&other);
+    }
+    return *this;
+  }
+  ~FixedFeatureValue() { release(); }
+
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  void resize(size_t size) {
+    if (size == _size) {
+      return;
+    }
+    FeatureValueArena* arena = this->arena();
+    if (arena != nullptr && size > 0 &&
+        size <= FeatureValueArena::kMaxValueSize) {
+      // keep the slot unless it would waste more than half of it
+      if (_capacity != 0 && size <= _capacity && size * 2 >= _capacity) {
+        set_size(size);
+        return;
+      }
+      uint32_t slot_size = FeatureValueArena::SlotSize(size);
+      float* data = arena->Allocate(slot_size);
+      move_data(data, size);
+      _data = data;
+      _capacity = static_cast<uint16_t>(slot_size);
+      return;
+    }
+    if (size == 0) {
+      release();
+      return;
+    }
+    if (_capacity == 0) {
+      float* data = reinterpret_cast<float*>(
+          realloc(_data, size * sizeof(float)));  // NOLINT
+      PADDLE_ENFORCE_NOT_NULL(
+          data,
+          common::errors::ResourceExhausted(
+              "Fail to alloc memory of %ld size.", size * sizeof(float)));
+      _data = data;
+      set_size(size);
+    } else {
+      float* data =
+          reinterpret_cast<float*>(malloc(size * sizeof(float)));  // NOLINT
+      PADDLE_ENFORCE_NOT_NULL(
+          data,
+          common::errors::ResourceExhausted(
+              "Fail to alloc memory of %ld size.", size * sizeof(float)));
+      move_data(data, size);
+      _data = data;
+      _capacity = 0;
+    }
+  }
+  void shrink_to_fit() {
+    if (_capacity != 0 && _capacity != FeatureValueArena::SlotSize(_size)) {
+      size_t size = _size;
+      FeatureValueArena* arena = this->arena();
+      uint32_t slot_size = FeatureValueArena::SlotSize(size);
+      float* data = arena->Allocate(slot_size);
+      memcpy(data, _data, size * sizeof(float));
+      arena->Free(_data, _capacity);
+      _data = data;
+      _capacity = static_cast<uint16_t>(slot_size);
+    }
+  }
+
+  // Move the storage into arena, nullptr moves it back to the heap.
+  void bind_arena(FeatureValueArena* arena) {
+    uint16_t id = arena == nullptr ? 0 : arena->id();
+    if (id == _arena_id) {
+      return;
+    }
+    FixedFeatureValue tmp(std::move(*this));
+    _arena_id = id;
+    resize(tmp.size());
+    if (_size > 0) {
+      memcpy(_data, tmp.data(), _size * sizeof(float));
+    }
+  }
+  FeatureValueArena* arena() const {
+    return _arena_id == 0 ? nullptr : FeatureValueArena::Get(_arena_id);
+  }
+  bool in_arena() const { return _capacity != 0; }
+  // Only used by arena compaction, the old slot is released with its slab.
+  void relocate() {
+    FeatureValueArena* arena = this->arena();
+    float* data = arena->Allocate(_capacity);
+    memcpy(data, _data, _size * sizeof(float));
+    _data = data;
+  }
+  uint32_t capacity() const { return _capacity; }
 
  private:
-  std::vector<float> _data;
+  void set_size(size_t size) {
+    if (size > _size) {
+      memset(_data + _size, 0, (size - _size) * sizeof(float));
+    }
+    _size = static_cast<uint32_t>(size);
+  }
+
+  // copy the prefix to data, which holds at least size floats, and release
+  // the old storage
+  void move_data(float* data, size_t size) {
+    size_t keep = std::min<size_t>(size, _size);
+    if (keep > 0) {
+      memcpy(data, _data, keep * sizeof(float));
+    }
+    if (size > keep) {
+      memset(data + keep, 0, (size - keep) * sizeof(float));
+    }
+    release_storage();
+    _size = static_cast<uint32_t>(size);
+  }
+
+  void assign(const FixedFeatureValue& other) {
+    resize(other._size);
+    if (_size > 0) {
+      memcpy(_data, other._data, _size * sizeof(float));
+    }
+  }
+
+  void steal(FixedFeatureValue* other) {
+    _data = other->_data;
+    _size = other->_size;
+    _capacity = other->_capacity;
+    _arena_id = other->_arena_id;
+    other->_data = nullptr;
+    other->_size = 0;
+    other->_capacity = 0;
+  }
+
+  void release_storage() {
+    if (_data == nullptr) {
+      return;
+    }
+    if (_capacity != 0) {
+      arena()->Free(_data, _capacity);
+    } else {
+      free(_data);  // NOLINT
+    }
+    _data = nullptr;
+    _capacity = 0;
+  }
+
+  void release() {
+    release_storage();
+    _size = 0;
+  }
+
+  float* _data{nullptr};
+  uint32_t _size{0};
+  // slot size in the arena, 0 if the storage is on the heap
+  uint16_t _capacity{0};
+  uint16_t _arena_id{0};
 };
 
+inline void PrefetchForRead(const void* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr, 0, 3);
+#endif
+}
+
+template <class VALUE>
+inline void BindValueArena(VALUE* value, FeatureValueArena* arena) {}
+
+template <class VALUE>
+inline void PrefetchValueData(VALUE* value) {}
+
+inline void PrefetchValueData(FixedFeatureValue* value) {
+  // a value usually spans one or two cache lines
+  const char* data = reinterpret_cast<const char*>(value->data());
+  if (data != nullptr) {
+    PrefetchForRead(data);
+    if (value->size() * sizeof(float) > 64) {
+      PrefetchForRead(data + 64);
+    }
+  }
+}
+
+inline void BindValueArena(FixedFeatureValue* value, FeatureValueArena* arena) {
+  value->bind_arena(arena);
+}
+
 template <class KEY, class VALUE>
 struct alignas(64) SparseTableShard {
  public:
   typedef typename mct::closed_hash_map<KEY, mct::Pointer, std::hash<KEY>>
       map_type;
+  // number of keys whose lookups are overlapped by find_batch
+  static constexpr size_t kFindBatchBlockSize = 16;
   struct iterator {
     typename map_type::iterator it;
     size_t bucket;
@@ -136,6 +330,53 @@ struct alignas(64) SparseTableShard {
     }
     return {it, bucket, _buckets};
   }
+  // Software-pipelined lookup of num keys. values[i] is set to the value of
+  // keys[i], or nullptr if the key does not exist. Keys are processed in
+  // blocks: the hashes of a block are computed and its hash maps prefetched,
+  // then the block is resolved and the headers of its values are prefetched,
+  // and the data of the values is prefetched one block later, so that the
+  // cache misses of neighbouring keys overlap instead of being serialized.
+  // The returned pointers stay valid until the values are erased.
+  void find_batch(const KEY* keys,
+                  size_t num,
+                  VALUE** values,
+                  size_t block_size = kFindBatchBlockSize) {
+    block_size =
+        std::max<size_t>(std::min(block_size, kFindBatchBlockSize), 1);
+    size_t hashes[kFindBatchBlockSize];
+    size_t buckets[kFindBatchBlockSize];
+    size_t prev_begin = 0, prev_end = 0;
+    for (size_t begin = 0; begin < num; begin += block_size) {
+      size_t end = std::min(begin + block_size, num);
+      for (size_t i = begin; i < end; ++i) {
+        hashes[i - begin] = _hasher(keys[i]);
+        buckets[i - begin] = compute_bucket(hashes[i - begin]);
+        PrefetchForRead(&_buckets[buckets[i - begin]]);
+      }
+      for (size_t i = begin; i < end; ++i) {
+        map_type& map = _buckets[buckets[i - begin]];
+        auto it = map.find_with_hash(keys[i], hashes[i - begin]);
+        if (it == map.end()) {
+          values[i] = nullptr;
+        } else {
+          values[i] = (VALUE*)(void*)it->second;  // NOLINT
+          PrefetchForRead(values[i]);
+        }
+      }
+      for (size_t i = prev_begin; i < prev_end; ++i) {
+        if (values[i] != nullptr) {
+          PrefetchValueData(values[i]);
+        }
+      }
+      prev_begin = begin;
+      prev_end = end;
+    }
+    for (size_t i = prev_begin; i < prev_end; ++i) {
+      if (values[i] != nullptr) {
+        PrefetchValueData(values[i]);
+      }
+    }
+  }
   VALUE& operator[](const KEY& key) { return emplace(key).first.value(); }
   std::pair<iterator, bool> insert(const KEY& key, const VALUE& val) {
     return emplace(key, val);
@@ -150,7 +391,11 @@ struct alignas(64) SparseTableShard {
     auto res = _buckets[bucket].insert_with_hash({key, NULL}, hash);
 
     if (res.second) {
-      res.first->second = _alloc.acquire(std::forward<ARGS>(args)...);
+      VALUE* value = acquire_value(std::forward<ARGS>(args)...);
+      if (_value_arena != nullptr) {
+        BindValueArena(value, _value_arena.get());
+      }
+      res.first->second = value;
     }
 
     return {{res.first, bucket, _buckets}, res.second};
@@ -185,6 +430,46 @@ struct alignas(64) SparseTableShard {
     quick_erase(it);
     return 1;
   }
+  // Store the values of this shard in a slab arena grouped by value size,
+  // see FeatureValueArena. Existing values are moved into the arena.
+  void enable_value_arena() {
+    if (_value_arena != nullptr) {
+      return;
+    }
+    _value_arena = std::make_unique<FeatureValueArena>();
+    for (auto it = begin(); it != end(); ++it) {
+      BindValueArena(it.value_ptr(), _value_arena.get());
+    }
+  }
+  FeatureValueArena* value_arena() { return _value_arena.get(); }
+  // Move the values out of slabs with an occupancy lower than min_occupancy
+  // and release those slabs. Returns the released bytes.
+  size_t compact_values(float min_occupancy = 0.5f) {
+    if (_value_arena == nullptr) {
+      return 0;
+    }
+    _value_arena->BeginCompaction();
+    for (auto it = begin(); it != end(); ++it) {
+      FixedFeatureValue* value = it.value_ptr();
+      if (value->in_arena()) {
+        _value_arena->MarkLive(value->data(), value->capacity());
+      }
+    }
+    if (_value_arena->PlanCompaction(min_occupancy) > 0) {
+      for (auto it = begin(); it != end(); ++it) {
+        FixedFeatureValue* value = it.value_ptr();
+        if (value->in_arena() &&
+            _value_arena->NeedRelocate(value->data(), value->capacity())) {
+          value->relocate();
+        }
+      }
+    }
+    return _value_arena->EndCompaction();
+  }
+  // Lets several threads emplace keys of disjoint buckets at the same time,
+  // the allocator of the values is shared by the buckets.
+  void enable_concurrent_emplace() { _concurrent_emplace = true; }
+  size_t bucket_of(const KEY& key) { return compute_bucket(_hasher(key)); }
   size_t compute_bucket(size_t hash) {
     if (CTR_SPARSE_SHARD_BUCKET_NUM == 1) {
       return 0;
@@ -194,9 +479,21 @@ struct alignas(64) SparseTableShard {
   }
 
  private:
+  template <class... ARGS>
+  VALUE* acquire_value(ARGS&&... args) {
+    if (!_concurrent_emplace) {
+      return _alloc.acquire(std::forward<ARGS>(args)...);
+    }
+    std::lock_guard<std::mutex> guard(_alloc_mutex);
+    return _alloc.acquire(std::forward<ARGS>(args)...);
+  }
+
   map_type _buckets[CTR_SPARSE_SHARD_BUCKET_NUM];
+  std::unique_ptr<FeatureValueArena> _value_arena;
   ChunkAllocator<VALUE> _alloc;
   std::hash<KEY> _hasher;
+  bool _concurrent_emplace{false};
+  std::mutex _alloc_mutex;
 };
 
 }  // namespace distributed
@@ -0,0 +1,334 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+// Slab arena for the float storage of FixedFeatureValue. Values with the same
+// number of floats (i.e. values of the same accessor layout) share slabs, so
+// that they are stored contiguously without one heap allocation per feature.
+//
+// An arena belongs to one SparseTableShard and, like the shard itself, is not
+// thread safe. Values refer to their arena by a 16-bit id instead of a pointer
+// to keep FixedFeatureValue small.
+class FeatureValueArena {
+ public:
+  static constexpr size_t kSlabBytes = 1 << 20;
+  // Values larger than this are kept on the heap.
+  static constexpr uint32_t kMaxValueSize = 65535;
+  static constexpr uint32_t kMinValueSize = 2;  // room for a free list node
+  static constexpr size_t kMaxArenaNum = 65536;
+
+  FeatureValueArena() {
+    auto* registry = Registry();
+    std::lock_guard<std::mutex> guard(RegistryMutex());
+    // id 0 means "no arena"
+    for (size_t i = 1; i < kMaxArenaNum; ++i) {
+      FeatureValueArena* expected = nullptr;
+      if (registry[i].compare_exchange_strong(expected, this)) {
+        _id = static_cast<uint16_t>(i);
+        break;
+      }
+    }
+    PADDLE_ENFORCE_NE(_id,
+                      0,
+                      common::errors::ResourceExhausted(
+                          "Too many FeatureValueArena, at most %d arenas "
+                          "can be alive at the same time.",
+                          kMaxArenaNum - 1));
+  }
+
+  FeatureValueArena(const FeatureValueArena&) = delete;
+  FeatureValueArena& operator=(const FeatureValueArena&) = delete;
+
+  ~FeatureValueArena() {
+    for (auto& size_class : _classes) {
+      if (size_class == nullptr) {
+        continue;
+      }
+      for (auto& slab : size_class->slabs) {
+        free(slab.base);  // NOLINT
+      }
+    }
+    Registry()[_id].store(nullptr);
+  }
+
+  uint16_t id() const { return _id; }
+
+  static FeatureValueArena* Get(uint16_t id) {
+    return Registry()[id].load(std::memory_order_relaxed);
+  }
+
+  static uint32_t SlotSize(size_t size) {
+    return std::max<uint32_t>(static_cast<uint32_t>(size), kMinValueSize);
+  }
+
+  // n must come from SlotSize.
+  float* Allocate(uint32_t n) {
+    SizeClass* size_class = GetSizeClass(n);
+    if (size_class->free_list == nullptr) {
+      NewSlab(size_class);
+    }
+    char* slot = size_class->free_list;
+    size_class->free_list = NextFree(slot);
+    ++size_class->num_used;
+    return reinterpret_cast<float*>(slot);
+  }
+
+  void Free(float* ptr, uint32_t n) {
+    SizeClass* size_class = GetSizeClass(n);
+    PushFree(size_class, reinterpret_cast<char*>(ptr));
+    --size_class->num_used;
+  }
+
+  // Bytes held by slabs, used or not.
+  size_t ReservedBytes() const {
+    size_t bytes = 0;
+    for (auto& size_class : _classes) {
+      if (size_class != nullptr) {
+        bytes += size_class->slabs.size() * size_class->slab_bytes;
+      }
+    }
+    return bytes;
+  }
+
+  // Compaction moves values out of sparsely used slabs, so that these slabs
+  // can be released. The protocol is:
+  //   BeginCompaction();
+  //   MarkLive(...) for every value stored in the arena;
+  //   PlanCompaction(...);
+  //   relocate every value for which NeedRelocate(...) is true, by copying it
+  //   to a slot of Allocate(...) without calling Free(...) on the old slot;
+  //   EndCompaction();
+  // No other arena call is allowed in between.
+  void BeginCompaction() {
+    for (auto& size_class : _classes) {
+      if (size_class == nullptr) {
+        continue;
+      }
+      std::sort(size_class->slabs.begin(),
+                size_class->slabs.end(),
+                [](const Slab& a, const Slab& b) { return a.base < b.base; });
+      for (auto& slab : size_class->slabs) {
+        slab.live.assign(slab.num_slots, false);
+        slab.live_count = 0;
+        slab.evacuate = false;
+      }
+    }
+  }
+
+  void MarkLive(const float* ptr, uint32_t n) {
+    SizeClass* size_class = GetSizeClass(n);
+    Slab* slab = FindSlab(size_class, ptr);
+    size_t slot = (reinterpret_cast<const char*>(ptr) - slab->base) /
+                  (n * sizeof(float));
+    if (!slab->live[slot]) {
+      slab->live[slot] = true;
+      ++slab->live_count;
+    }
+  }
+
+  // Evacuate the slabs whose occupancy is lower than min_occupancy, as long as
+  // their values fit in the free slots of the remaining slabs, and rebuild the
+  // free lists in address order. Returns the number of evacuated slabs.
+  size_t PlanCompaction(float min_occupancy) {
+    size_t num_evacuated = 0;
+    for (auto& size_class : _classes) {
+      if (size_class == nullptr || size_class->slabs.size() < 2) {
+        continue;
+      }
+      auto& slabs = size_class->slabs;
+      std::vector<Slab*> candidates;
+      size_t free_slots = 0;
+      for (auto& slab : slabs) {
+        free_slots += slab.num_slots - slab.live_count;
+        if (slab.live_count < slab.num_slots * min_occupancy) {
+          candidates.push_back(&slab);
+        }
+      }
+      std::sort(candidates.begin(),
+                candidates.end(),
+                [](const Slab* a, const Slab* b) {
+                  return a->live_count < b->live_count;
+                });
+      for (Slab* slab : candidates) {
+        // The free slots of the slab are lost and its live values take free
+        // slots of the kept slabs.
+        if (free_slots < slab->num_slots) {
+          break;
+        }
+        free_slots -= slab->num_slots;
+        slab->evacuate = true;
+        ++num_evacuated;
+      }
+      // Rebuild the free list from the kept slabs, lowest address first.
+      size_class->free_list = nullptr;
+      size_t slot_bytes = size_class->n * sizeof(float);
+      for (auto slab_it = slabs.rbegin(); slab_it != slabs.rend(); ++slab_it) {
+        if (slab_it->evacuate) {
+          continue;
+        }
+        for (size_t i = slab_it->num_slots; i > 0; --i) {
+          if (!slab_it->live[i - 1]) {
+            PushFree(size_class.get(), slab_it->base + (i - 1) * slot_bytes);
+          }
+        }
+      }
+    }
+    return num_evacuated;
+  }
+
+  bool NeedRelocate(const float* ptr, uint32_t n) {
+    if (n >= _classes.size() || _classes[n] == nullptr) {
+      return false;
+    }
+    return FindSlab(_classes[n].get(), ptr)->evacuate;
+  }
+
+  // Release the evacuated slabs, returns the released bytes.
+  size_t EndCompaction() {
+    size_t released = 0;
+    for (auto& size_class : _classes) {
+      if (size_class == nullptr) {
+        continue;
+      }
+      auto& slabs = size_class->slabs;
+      for (auto it = slabs.begin(); it != slabs.end();) {
+        if (it->evacuate) {
+          // the relocated values were counted again by Allocate
+          size_class->num_used -= it->live_count;
+          released += size_class->slab_bytes;
+          free(it->base);  // NOLINT
+          it = slabs.erase(it);
+        } else {
+          it->live.clear();
+          it->live.shrink_to_fit();
+          ++it;
+        }
+      }
+    }
+    return released;
+  }
+
+ private:
+  struct Slab {
+    char* base{nullptr};
+    size_t num_slots{0};
+    // only valid during compaction
+    std::vector<bool> live;
+    size_t live_count{0};
+    bool evacuate{false};
+  };
+
+  struct SizeClass {
+    uint32_t n{0};
+    size_t slots_per_slab{0};
+    size_t slab_bytes{0};
+    std::vector<Slab> slabs;
+    // Free slots are linked through their first bytes. Slots of odd sizes
+    // are not pointer aligned, so the links are accessed with memcpy.
+    char* free_list{nullptr};
+    size_t num_used{0};
+  };
+
+  static std::atomic<FeatureValueArena*>* Registry() {
+    static std::unique_ptr<std::atomic<FeatureValueArena*>[]> registry(
+        new std::atomic<FeatureValueArena*>[kMaxArenaNum]());
+    return registry.get();
+  }
+
+  static std::mutex& RegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  SizeClass* GetSizeClass(uint32_t n) {
+    if (n >= _classes.size()) {
+      _classes.resize(n + 1);
+    }
+    auto& size_class = _classes[n];
+    if (size_class == nullptr) {
+      size_class = std::make_unique<SizeClass>();
+      size_class->n = n;
+      size_class->slots_per_slab =
+          std::max<size_t>(1, kSlabBytes / (n * sizeof(float)));
+      size_class->slab_bytes = size_class->slots_per_slab * n * sizeof(float);
+    }
+    return size_class.get();
+  }
+
+  void NewSlab(SizeClass* size_class) {
+    Slab slab;
+    slab.num_slots = size_class->slots_per_slab;
+    void* base = nullptr;
+    int error = posix_memalign(&base, 64, size_class->slab_bytes);
+    PADDLE_ENFORCE_EQ(error,
+                      0,
+                      common::errors::ResourceExhausted(
+                          "Fail to alloc memory of %ld size, error code is %d.",
+                          size_class->slab_bytes,
+                          error));
+    slab.base = reinterpret_cast<char*>(base);
+    size_t slot_bytes = size_class->n * sizeof(float);
+    // push in reverse order so that slots are handed out in address order
+    for (size_t i = slab.num_slots; i > 0; --i) {
+      PushFree(size_class, slab.base + (i - 1) * slot_bytes);
+    }
+    size_class->slabs.emplace_back(std::move(slab));
+  }
+
+  static char* NextFree(const char* slot) {
+    char* next = nullptr;
+    memcpy(&next, slot, sizeof(next));
+    return next;
+  }
+
+  static void PushFree(SizeClass* size_class, char* slot) {
+    memcpy(slot, &size_class->free_list, sizeof(size_class->free_list));
+    size_class->free_list = slot;
+  }
+
+  // slabs must be sorted by base, see BeginCompaction
+  Slab* FindSlab(SizeClass* size_class, const float* ptr) {
+    const char* p = reinterpret_cast<const char*>(ptr);
+    auto& slabs = size_class->slabs;
+    auto it = std::upper_bound(
+        slabs.begin(), slabs.end(), p, [](const char* p, const Slab& slab) {
+          return p < slab.base;
+        });
+    PADDLE_ENFORCE_NE(
+        it,
+        slabs.begin(),
+        common::errors::NotFound("The value is not allocated by this arena."));
+    return &(*(--it));
+  }
+
+  uint16_t _id{0};
+  std::vector<std::unique_ptr<SizeClass>> _classes;
+};
+
+}  // namespace distributed
+}  // namespace paddle
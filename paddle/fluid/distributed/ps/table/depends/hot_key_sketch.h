@@ -0,0 +1,98 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// Approximate access frequency of sparse keys, used to decide which keys of a
+// shard stay in memory. It is a count-min sketch with saturating 8-bit
+// counters. All counters are halved after every 8 * width accesses, so that
+// the estimate decays with the age of the accesses and old hot keys become
+// cold when they are not accessed any more.
+//
+// Like SparseTableShard, it is not thread safe.
+class HotKeySketch {
+ public:
+  static constexpr int kDepth = 4;
+
+  explicit HotKeySketch(size_t width = 1 << 20) {
+    _width = 1;
+    while (_width < width) {
+      _width <<= 1;
+    }
+    _counters.assign(kDepth * _width, 0);
+    _reset_interval = 8 * _width;
+  }
+
+  void Touch(uint64_t key) {
+    size_t index[kDepth];
+    uint8_t min_count = UINT8_MAX;
+    for (int i = 0; i < kDepth; ++i) {
+      index[i] = Index(key, i);
+      min_count = std::min(min_count, _counters[index[i]]);
+    }
+    // conservative update: only the smallest counters are increased
+    if (min_count < UINT8_MAX) {
+      for (int i = 0; i < kDepth; ++i) {
+        if (_counters[index[i]] == min_count) {
+          ++_counters[index[i]];
+        }
+      }
+    }
+    if (++_num_touched >= _reset_interval) {
+      Age();
+    }
+  }
+
+  uint8_t Estimate(uint64_t key) const {
+    uint8_t min_count = UINT8_MAX;
+    for (int i = 0; i < kDepth; ++i) {
+      min_count = std::min(min_count, _counters[Index(key, i)]);
+    }
+    return min_count;
+  }
+
+  void Age() {
+    for (auto& counter : _counters) {
+      counter >>= 1;
+    }
+    _num_touched = 0;
+  }
+
+  size_t width() const { return _width; }
+
+ private:
+  size_t Index(uint64_t key, int row) const {
+    // splitmix64 finalizer with a different seed for each row
+    uint64_t x = key + 0x9e3779b97f4a7c15ULL * (row + 1);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return row * _width + (x & (_width - 1));
+  }
+
+  size_t _width;
+  size_t _reset_interval;
+  size_t _num_touched{0};
+  std::vector<uint8_t> _counters;
+};
+
+}  // namespace distributed
+}  // namespace paddle
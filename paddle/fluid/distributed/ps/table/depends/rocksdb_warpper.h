@@ -20,13 +20,16 @@
 #include <rocksdb/options.h>
 #include <rocksdb/perf_context.h>
 #include <rocksdb/perf_level.h>
+#include <rocksdb/rate_limiter.h>
 #include <rocksdb/slice.h>
 #include <rocksdb/slice_transform.h>
 #include <rocksdb/table.h>
 #include <rocksdb/write_batch.h>
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace paddle {
 namespace distributed {
@@ -90,9 +93,22 @@ class RocksDBHandler {
     return &handler;
   }
 
-  int initialize(const std::string& db_path, const int colnum) {
-    VLOG(0) << "db path: " << db_path << " colnum: " << colnum;
+  // compaction_bytes_per_sec > 0 throttles the background flush and
+  // compaction writes of all columns, so that compaction does not take the
+  // disk bandwidth needed by the reads of online pulls.
+  int initialize(const std::string& db_path,
+                 const int colnum,
+                 int64_t compaction_bytes_per_sec = 0) {
+    VLOG(0) << "db path: " << db_path << " colnum: " << colnum
+            << " compaction_bytes_per_sec: " << compaction_bytes_per_sec;
     _dbs.resize(colnum);
+    if (compaction_bytes_per_sec > 0) {
+      _rate_limiter.reset(rocksdb::NewGenericRateLimiter(
+          compaction_bytes_per_sec,
+          100 * 1000 /* refill_period_us */,
+          10 /* fairness */,
+          rocksdb::RateLimiter::Mode::kWritesOnly));
+    }
     for (int i = 0; i < colnum; i++) {
       rocksdb::Options options;
       options.comparator = &_comparator;
@@ -133,6 +149,11 @@ class RocksDBHandler {
       options.memtable_prefix_bloom_size_ratio = 0.02;
       options.num_levels = 4;
       options.max_open_files = -1;
+      if (_rate_limiter != nullptr) {
+        options.rate_limiter = _rate_limiter;
+        // flush in small steps so that the limited bandwidth is shared
+        options.bytes_per_sync = 1024 * 1024;
+      }
 
       options.compression = rocksdb::kNoCompression;
       // options.compaction_options_fifo = rocksdb::CompactionOptionsFIFO();
@@ -207,6 +228,35 @@ class RocksDBHandler {
         read_opt, handle, num_keys, keys, values, status, sorted_input);
   }
 
+  int del_batch(int id, const std::vector<rocksdb::Slice>& keys) {
+    rocksdb::WriteOptions options;
+    options.disableWAL = true;
+    rocksdb::WriteBatch batch(keys.size() * 32);
+    for (auto& key : keys) {
+      batch.Delete(key);
+    }
+    rocksdb::Status s = _dbs[id]->Write(options, &batch);
+    assert(s.ok());
+    return 0;
+  }
+
+  // Stop or restart the automatic compaction of a column, e.g. to keep it
+  // out of a latency critical phase and to compact with compact() later.
+  int set_auto_compaction(int id, bool enable) {
+    rocksdb::Status s = _dbs[id]->SetOptions(
+        {{"disable_auto_compactions", enable ? "false" : "true"}});
+    assert(s.ok());
+    return 0;
+  }
+
+  int compact(int id) {
+    rocksdb::CompactRangeOptions options;
+    options.exclusive_manual_compaction = false;
+    rocksdb::Status s = _dbs[id]->CompactRange(options, nullptr, nullptr);
+    assert(s.ok());
+    return 0;
+  }
+
   int del_data(int id, const char* key, int key_len) {
     rocksdb::WriteOptions options;
     options.disableWAL = true;
@@ -251,6 +301,7 @@ class RocksDBHandler {
   // rocksdb::DB* _db;
   std::vector<rocksdb::DB*> _dbs;
   Uint64Comparator _comparator;
+  std::shared_ptr<rocksdb::RateLimiter> _rate_limiter;
 };
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,187 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// Counts the sightings of the missing keys of a shard and admits a key once
+// it was seen threshold times, see SparseAdmissionParameter. The counters
+// are saturating 8-bit ones, halved after every 8 * width sightings so that
+// the keys seen long ago are forgotten.
+//
+// The parts of a split shard may count their keys at the same time, so the
+// counters are relaxed atomics. A lost increment only delays an admission.
+class SparseAdmissionFilter {
+ public:
+  static constexpr int kHashNum = 4;
+
+  // Returns nullptr if param admits all keys or names no filter.
+  static std::unique_ptr<SparseAdmissionFilter> Create(
+      const SparseAdmissionParameter& param);
+
+  SparseAdmissionFilter(size_t width, uint32_t threshold)
+      : _threshold(std::min<uint32_t>(std::max<uint32_t>(threshold, 1),
+                                      UINT8_MAX)) {
+    _width = kHashNum;
+    while (_width < width) {
+      _width <<= 1;
+    }
+    _counters.reset(new std::atomic<uint8_t>[_width]());
+    _reset_interval = 8 * _width;
+  }
+  virtual ~SparseAdmissionFilter() = default;
+
+  // Counts a sighting of key, returns whether key is admitted.
+  bool Admit(uint64_t key) {
+    size_t index[kHashNum];
+    Indexes(key, index);
+    uint8_t count = Increase(index);
+    if (_num_sighted.fetch_add(1, std::memory_order_relaxed) + 1 >=
+        _reset_interval) {
+      Age();
+    }
+    return count >= _threshold;
+  }
+
+  uint8_t Estimate(uint64_t key) const {
+    size_t index[kHashNum];
+    Indexes(key, index);
+    uint8_t min_count = UINT8_MAX;
+    for (int i = 0; i < kHashNum; ++i) {
+      min_count = std::min(min_count, Load(index[i]));
+    }
+    return min_count;
+  }
+
+  void Age() {
+    for (size_t i = 0; i < _width; ++i) {
+      Store(i, Load(i) >> 1);
+    }
+    _num_sighted.store(0, std::memory_order_relaxed);
+  }
+
+  size_t width() const { return _width; }
+
+ protected:
+  // the kHashNum counters of key
+  virtual void Indexes(uint64_t key, size_t* index) const = 0;
+  // increases the counters of a sighting, returns the estimate after it
+  virtual uint8_t Increase(const size_t* index) = 0;
+
+  static uint64_t Hash(uint64_t key, int seed) {
+    // splitmix64 finalizer with a different seed for each hash
+    uint64_t x = key + 0x9e3779b97f4a7c15ULL * (seed + 1);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+  uint8_t Load(size_t i) const {
+    return _counters[i].load(std::memory_order_relaxed);
+  }
+  void Store(size_t i, uint8_t count) {
+    _counters[i].store(count, std::memory_order_relaxed);
+  }
+
+  size_t _width;
+
+ private:
+  uint8_t _threshold;
+  size_t _reset_interval;
+  std::atomic<size_t> _num_sighted{0};
+  std::unique_ptr<std::atomic<uint8_t>[]> _counters;
+};
+
+// A count-min sketch of kHashNum rows of width / kHashNum counters with
+// conservative updates, only the smallest counters of a key are increased.
+class CountMinAdmissionFilter : public SparseAdmissionFilter {
+ public:
+  using SparseAdmissionFilter::SparseAdmissionFilter;
+
+ protected:
+  void Indexes(uint64_t key, size_t* index) const override {
+    size_t row_width = _width / kHashNum;
+    for (int i = 0; i < kHashNum; ++i) {
+      index[i] = i * row_width + (Hash(key, i) & (row_width - 1));
+    }
+  }
+  uint8_t Increase(const size_t* index) override {
+    uint8_t min_count = UINT8_MAX;
+    for (int i = 0; i < kHashNum; ++i) {
+      min_count = std::min(min_count, Load(index[i]));
+    }
+    if (min_count == UINT8_MAX) {
+      return min_count;
+    }
+    for (int i = 0; i < kHashNum; ++i) {
+      if (Load(index[i]) == min_count) {
+        Store(index[i], min_count + 1);
+      }
+    }
+    return min_count + 1;
+  }
+};
+
+// A counting Bloom filter, the kHashNum counters of a key are taken from all
+// the width counters and are all increased.
+class CountingBloomAdmissionFilter : public SparseAdmissionFilter {
+ public:
+  using SparseAdmissionFilter::SparseAdmissionFilter;
+
+ protected:
+  void Indexes(uint64_t key, size_t* index) const override {
+    // double hashing, the second hash is odd so that the indexes of a key
+    // are distinct
+    uint64_t h1 = Hash(key, 0);
+    uint64_t h2 = Hash(key, 1) | 1;
+    for (int i = 0; i < kHashNum; ++i) {
+      index[i] = (h1 + i * h2) & (_width - 1);
+    }
+  }
+  uint8_t Increase(const size_t* index) override {
+    uint8_t min_count = UINT8_MAX;
+    for (int i = 0; i < kHashNum; ++i) {
+      uint8_t count = Load(index[i]);
+      if (count < UINT8_MAX) {
+        Store(index[i], ++count);
+      }
+      min_count = std::min(min_count, count);
+    }
+    return min_count;
+  }
+};
+
+inline std::unique_ptr<SparseAdmissionFilter> SparseAdmissionFilter::Create(
+    const SparseAdmissionParameter& param) {
+  if (param.filter() == "count_min") {
+    return std::make_unique<CountMinAdmissionFilter>(param.width(),
+                                                     param.threshold());
+  }
+  if (param.filter() == "counting_bloom") {
+    return std::make_unique<CountingBloomAdmissionFilter>(param.width(),
+                                                          param.threshold());
+  }
+  return nullptr;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+// The reduced precision encodings of the float vectors of the sparse values,
+// shared by the wire format and the storage of the accessors. An int8 vector
+// is led by its fp32 scale, max(|x|) / 127.
+
+// bytes of n floats encoded as type
+inline size_t SparseQuantSize(SparseValueCompressType type, size_t n) {
+  switch (type) {
+    case SPARSE_VALUE_FP16:
+    case SPARSE_VALUE_BF16:
+      return n * sizeof(uint16_t);
+    case SPARSE_VALUE_INT8:
+      return sizeof(float) + n * sizeof(int8_t);
+    default:
+      return n * sizeof(float);
+  }
+}
+
+template <typename T>
+inline void SparseQuantHalf(const float *x, size_t n, char *out) {
+  for (size_t i = 0; i < n; ++i) {
+    T v(x[i]);
+    memcpy(out + i * sizeof(T), &v, sizeof(T));
+  }
+}
+
+template <typename T>
+inline void SparseDequantHalf(const char *data, size_t n, float *x) {
+  for (size_t i = 0; i < n; ++i) {
+    T v;
+    memcpy(&v, data + i * sizeof(T), sizeof(T));
+    x[i] = static_cast<float>(v);
+  }
+}
+
+inline void SparseQuantize(SparseValueCompressType type,
+                           const float *x,
+                           size_t n,
+                           char *out) {
+  switch (type) {
+    case SPARSE_VALUE_FP16:
+      SparseQuantHalf<phi::dtype::float16>(x, n, out);
+      break;
+    case SPARSE_VALUE_BF16:
+      SparseQuantHalf<phi::dtype::bfloat16>(x, n, out);
+      break;
+    case SPARSE_VALUE_INT8: {
+      float max_abs = 0.0f;
+      for (size_t i = 0; i < n; ++i) {
+        max_abs = std::max(max_abs, std::fabs(x[i]));
+      }
+      float scale = max_abs / 127.0f;
+      memcpy(out, &scale, sizeof(float));
+      auto *q = reinterpret_cast<int8_t *>(out + sizeof(float));
+      float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+      for (size_t i = 0; i < n; ++i) {
+        float v = std::round(x[i] * inv_scale);
+        q[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, v)));
+      }
+      break;
+    }
+    default:
+      memcpy(out, x, n * sizeof(float));
+  }
+}
+
+inline void SparseDequantize(SparseValueCompressType type,
+                             const char *data,
+                             size_t n,
+                             float *x) {
+  switch (type) {
+    case SPARSE_VALUE_FP16:
+      SparseDequantHalf<phi::dtype::float16>(data, n, x);
+      break;
+    case SPARSE_VALUE_BF16:
+      SparseDequantHalf<phi::dtype::bfloat16>(data, n, x);
+      break;
+    case SPARSE_VALUE_INT8: {
+      float scale = 0.0f;
+      memcpy(&scale, data, sizeof(float));
+      const auto *q = reinterpret_cast<const int8_t *>(data + sizeof(float));
+      for (size_t i = 0; i < n; ++i) {
+        x[i] = q[i] * scale;
+      }
+      break;
+    }
+    default:
+      memcpy(x, data, n * sizeof(float));
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
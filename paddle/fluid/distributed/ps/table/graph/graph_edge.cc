@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/ps/table/graph/graph_edge.h"
+#include <algorithm>
 #include <cstring>
+#include <numeric>
+#include <stdexcept>
 namespace paddle::distributed {
 
 void GraphEdgeBlob::add_edge(int64_t id, float weight = 1) {
@@ -26,4 +29,87 @@ void WeightedGraphEdgeBlob::add_edge(int64_t id, float weight = 1) {
   weight_arr.push_back((half)weight);
 #endif
 }
+
+CompressedGraphEdgeBlob* CompressedGraphEdgeBlob::compress(
+    GraphEdgeBlob* blob) {
+  size_t n = blob->size();
+#ifdef PADDLE_WITH_CUDA
+  bool weighted = blob->is_weighted();
+#else
+  // the weights are only kept with cuda, as in WeightedGraphEdgeBlob
+  bool weighted = false;
+#endif
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [blob](int a, int b) {
+    return static_cast<uint64_t>(blob->get_id(a)) <
+           static_cast<uint64_t>(blob->get_id(b));
+  });
+
+  auto* res = new CompressedGraphEdgeBlob();
+  res->edge_size = n;
+  res->weighted = weighted;
+  size_t block_num = (n + kBlockSize - 1) / kBlockSize;
+  res->block_id_arr.reserve(block_num);
+  res->block_offset_arr.reserve(block_num);
+  if (weighted) {
+    res->weight_arr.reserve(n);
+  }
+  uint64_t last_id = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t id = static_cast<uint64_t>(blob->get_id(order[i]));
+    if (i % kBlockSize == 0) {
+      res->block_id_arr.push_back(static_cast<int64_t>(id));
+      res->block_offset_arr.push_back(res->delta_arr.size());
+    } else {
+      uint64_t delta = id - last_id;
+      while (delta >= 0x80) {
+        res->delta_arr.push_back(static_cast<uint8_t>(delta | 0x80));
+        delta >>= 7;
+      }
+      res->delta_arr.push_back(static_cast<uint8_t>(delta));
+    }
+    last_id = id;
+    if (weighted) {
+      res->weight_arr.push_back(blob->get_weight(order[i]));
+    }
+  }
+  res->delta_arr.shrink_to_fit();
+  if (res->memory_size() >= blob->memory_size()) {
+    delete res;
+    return nullptr;
+  }
+  return res;
+}
+
+GraphEdgeBlob* CompressedGraphEdgeBlob::decompress() {
+  GraphEdgeBlob* blob =
+      weighted ? new WeightedGraphEdgeBlob() : new GraphEdgeBlob();
+  for (size_t i = 0; i < edge_size; i++) {
+    blob->add_edge(get_id(i), static_cast<float>(get_weight(i)));
+  }
+  return blob;
+}
+
+void CompressedGraphEdgeBlob::add_edge(int64_t id, float weight) {
+  throw std::runtime_error(
+      "Failed to add an edge to the compressed edges, decompress them first");
+}
+
+int64_t CompressedGraphEdgeBlob::get_id(int idx) {
+  int block = idx / kBlockSize;
+  uint64_t id = static_cast<uint64_t>(block_id_arr[block]);
+  const uint8_t* p = delta_arr.data() + block_offset_arr[block];
+  for (int i = block * kBlockSize; i < idx; i++) {
+    uint64_t delta = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+      delta |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+      shift += 7;
+    }
+    delta |= static_cast<uint64_t>(*p++) << shift;
+    id += delta;
+  }
+  return static_cast<int64_t>(id);
+}
 }  // namespace paddle::distributed
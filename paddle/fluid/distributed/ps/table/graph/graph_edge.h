@@ -27,14 +27,19 @@ class GraphEdgeBlob {
  public:
   GraphEdgeBlob() {}
   virtual ~GraphEdgeBlob() {}
-  size_t size() { return id_arr.size(); }
+  virtual size_t size() { return id_arr.size(); }
   virtual void add_edge(int64_t id, float weight);
-  int64_t get_id(int idx) { return id_arr[idx]; }
+  virtual int64_t get_id(int idx) { return id_arr[idx]; }
 #ifdef PADDLE_WITH_CUDA
   virtual half get_weight(int idx UNUSED) { return (half)(1.0); }
 #else
   virtual float get_weight(int idx UNUSED) { return 1.0; }
 #endif
+  virtual bool is_weighted() { return false; }
+  virtual bool is_compressed() { return false; }
+  virtual size_t memory_size() {
+    return sizeof(*this) + id_arr.capacity() * sizeof(int64_t);
+  }
   std::vector<int64_t>& export_id_array() { return id_arr; }
 
  protected:
@@ -51,6 +56,11 @@ class WeightedGraphEdgeBlob : public GraphEdgeBlob {
 #else
   virtual float get_weight(int idx) { return weight_arr[idx]; }
 #endif
+  virtual bool is_weighted() { return true; }
+  virtual size_t memory_size() {
+    return GraphEdgeBlob::memory_size() +
+           weight_arr.capacity() * sizeof(weight_arr[0]);
+  }
 
  protected:
 #ifdef PADDLE_WITH_CUDA
@@ -59,5 +69,48 @@ class WeightedGraphEdgeBlob : public GraphEdgeBlob {
   std::vector<float> weight_arr;
 #endif
 };
+
+// The read only edges of a node sorted by id, whose ids are stored as the
+// varint encoded deltas from the first id of each block of kBlockSize edges,
+// so that an id is decoded from at most kBlockSize - 1 deltas.
+class CompressedGraphEdgeBlob : public WeightedGraphEdgeBlob {
+ public:
+  static constexpr int kBlockSize = 16;
+  virtual ~CompressedGraphEdgeBlob() {}
+  // Returns the compressed edges of blob, or nullptr if they do not take less
+  // memory than blob.
+  static CompressedGraphEdgeBlob* compress(GraphEdgeBlob* blob);
+  // Returns the edges decoded to a blob to add edges to.
+  GraphEdgeBlob* decompress();
+  virtual size_t size() { return edge_size; }
+  virtual void add_edge(int64_t id, float weight);
+  virtual int64_t get_id(int idx);
+#ifdef PADDLE_WITH_CUDA
+  virtual half get_weight(int idx) {
+    return weighted ? weight_arr[idx] : (half)(1.0);
+  }
+#else
+  virtual float get_weight(int idx) {
+    return weighted ? weight_arr[idx] : 1.0;
+  }
+#endif
+  virtual bool is_weighted() { return weighted; }
+  virtual bool is_compressed() { return true; }
+  virtual size_t memory_size() {
+    return WeightedGraphEdgeBlob::memory_size() + delta_arr.capacity() +
+           block_id_arr.capacity() * sizeof(int64_t) +
+           block_offset_arr.capacity() * sizeof(uint32_t);
+  }
+
+ protected:
+  CompressedGraphEdgeBlob() {}
+
+  size_t edge_size = 0;
+  bool weighted = false;
+  std::vector<uint8_t> delta_arr;
+  // the first id and the offset in delta_arr of each block
+  std::vector<int64_t> block_id_arr;
+  std::vector<uint32_t> block_offset_arr;
+};
 }  // namespace distributed
 }  // namespace paddle
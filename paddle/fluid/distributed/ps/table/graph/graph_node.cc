@@ -64,6 +64,26 @@ void GraphNode::build_edges(bool is_weighted) {
     }
   }
 }
+void GraphNode::compress_edges() {
+  if (edges == nullptr || edges->is_compressed()) {
+    return;
+  }
+  GraphEdgeBlob* compressed = CompressedGraphEdgeBlob::compress(edges);
+  if (compressed != nullptr) {
+    reset_edges(compressed);
+  }
+}
+void GraphNode::decompress_edges() {
+  reset_edges(static_cast<CompressedGraphEdgeBlob*>(edges)->decompress());
+}
+void GraphNode::reset_edges(GraphEdgeBlob* new_edges) {
+  delete edges;
+  edges = new_edges;
+  // the samplers refer to the edges
+  if (sampler != nullptr) {
+    sampler->build(edges);
+  }
+}
 void GraphNode::build_sampler(std::string sample_type) {
   if (sampler != nullptr) {
     return;
@@ -80,6 +80,7 @@ class Node {
   virtual void set_feature(int idx UNUSED, const std::string &str UNUSED) {}
   virtual void set_feature_size(int size UNUSED) {}
   virtual void shrink_to_fit() {}
+  virtual void compress_edges() {}
   virtual int get_feature_size() { return 0; }
   virtual size_t get_neighbor_size() { return 0; }
   virtual bool get_is_weighted() { return is_weighted; }
@@ -98,8 +99,14 @@ class GraphNode : public Node {
   virtual void build_edges(bool is_weighted);
   virtual void build_sampler(std::string sample_type);
   virtual void add_edge(uint64_t id, float weight) {
+    if (edges->is_compressed()) {
+      decompress_edges();
+    }
     edges->add_edge(id, weight);
   }
+  // Replaces the edges with CompressedGraphEdgeBlob if it takes less memory,
+  // the edges are decompressed again if an edge is added.
+  virtual void compress_edges();
   virtual std::vector<int> sample_k(
       int k, const std::shared_ptr<std::mt19937_64> rng) {
     return sampler->sample_k(k, rng);
@@ -113,6 +120,9 @@ class GraphNode : public Node {
   virtual size_t get_neighbor_size() { return edges->size(); }
 
  protected:
+  void decompress_edges();
+  void reset_edges(GraphEdgeBlob *new_edges);
+
   Sampler *sampler;
   GraphEdgeBlob *edges;
 };
@@ -135,6 +135,9 @@ int32_t MemoryDenseTable::Pull(TableContext &context) {
       Dense,
       common::errors::InvalidArgument("Context value type must be 'Dense'."));
   float *pull_values = context.pull_context.values;
+  if (context.offset > 0 || context.num < static_cast<size_t>(param_dim_)) {
+    return PullDenseRange(pull_values, context.offset, context.num);
+  }
   return PullDense(pull_values, context.num);
 }
 
@@ -145,6 +148,11 @@ int32_t MemoryDenseTable::Push(TableContext &context) {
       common::errors::InvalidArgument("Context value type must be 'Dense'."));
   if (context.push_context.values != nullptr) {
     if (!context.push_context.is_param) {
+      if (context.offset > 0 ||
+          context.num < static_cast<size_t>(param_dim_)) {
+        return PushDenseRange(
+            context.push_context.values, context.offset, context.num);
+      }
       return PushDense(context.push_context.values, context.num);
     } else {
       return PushDenseParam(context.push_context.values, context.num);
@@ -159,6 +167,18 @@ int32_t MemoryDenseTable::PullDense(float *pull_values, size_t num) {
   return 0;
 }
 
+int32_t MemoryDenseTable::PullDenseRange(float *pull_values,
+                                         size_t offset,
+                                         size_t num) {
+  const auto &param = values_[param_idx_];
+  // the shard of the last server is padded
+  if (offset < param.size()) {
+    size_t end = std::min(offset + num, param.size());
+    std::copy(param.begin() + offset, param.begin() + end, pull_values);
+  }
+  return 0;
+}
+
 int32_t MemoryDenseTable::PushDenseParam(const float *values, size_t num) {
   PADDLE_ENFORCE_GE(
       num,
@@ -190,6 +210,32 @@ int32_t MemoryDenseTable::PushDense(const float *values, size_t num) {
   return 0;
 }
 
+int32_t MemoryDenseTable::PushDenseRange(const float *values,
+                                         size_t offset,
+                                         size_t num) {
+  size_t param_dim = static_cast<size_t>(param_dim_);
+  if (offset >= param_dim) {
+    return 0;
+  }
+  size_t end = std::min(offset + num, param_dim);
+  if (sync) {
+    std::future<int> task =
+        _shards_task_pool[0]->enqueue([this, values, offset, end]() -> int {
+          float *reservoir = pull_reservoir_.values.data() + offset;
+          GetBlas<float>().VADD(end - offset, reservoir, values, reservoir);
+          // each push has a chunk at 0
+          if (offset == 0) {
+            ++pull_reservoir_.counter;
+          }
+          return 0;
+        });
+    task.wait();
+  } else {
+    _PushDenseRange(values, offset, end);
+  }
+  return 0;
+}
+
 int32_t MemoryDenseTable::_PushDense(const float *values, size_t num) {
   PADDLE_ENFORCE_GE(
       num,
@@ -217,6 +263,29 @@ int32_t MemoryDenseTable::_PushDense(const float *values, size_t num) {
   return 0;
 }
 
+int32_t MemoryDenseTable::_PushDenseRange(const float *values,
+                                          size_t begin,
+                                          size_t end) {
+  std::vector<int> buckets = bucket(end - begin, task_pool_size_);
+  std::vector<std::future<int>> tasks(task_pool_size_);
+  // the optimizers index the gradients by the index of the param
+  const float *grads = values - begin;
+  for (int shard_id = 0; shard_id < task_pool_size_; ++shard_id) {
+    tasks[shard_id] = _shards_task_pool[shard_id]->enqueue(
+        [this, shard_id, begin, &buckets, grads]() -> int {
+          optimizer_->Update(grads,
+                             param_dim_,
+                             begin + buckets[shard_id],
+                             begin + buckets[shard_id + 1]);
+          return 0;
+        });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  return 0;
+}
+
 int32_t MemoryDenseTable::Load(const std::string &path,
                                const std::string &param) {
   if (param_dim_ <= 0) {
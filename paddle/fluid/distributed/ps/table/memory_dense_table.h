@@ -48,6 +48,9 @@ class MemoryDenseTable : public Table {
   int32_t PullDense(float* pull_values, size_t num);
   int32_t PushDenseParam(const float* values, size_t num);
   int32_t PushDense(const float* values, size_t num);
+  // the params [offset, offset + num), for the chunks of the shard
+  int32_t PullDenseRange(float* pull_values, size_t offset, size_t num);
+  int32_t PushDenseRange(const float* values, size_t offset, size_t num);
   int32_t Pour() override;
   int32_t SetGlobalLR(float* lr) override;
 
@@ -66,6 +69,7 @@ class MemoryDenseTable : public Table {
 
  protected:
   int32_t _PushDense(const float* values, size_t num);
+  int32_t _PushDenseRange(const float* values, size_t begin, size_t end);
 
  private:
   const int task_pool_size_ = 10;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <omp.h>
+#include <algorithm>
 #include <sstream>
 
 #include "glog/logging.h"
@@ -38,9 +39,30 @@ PD_DEFINE_bool(pserver_enable_create_feasign_randomly,
 PD_DEFINE_int32(pserver_table_save_max_retry,
                 3,
                 "pserver_table_save_max_retry");
+PD_DEFINE_bool(pserver_sparse_value_arena,
+               false,
+               "pserver stores sparse values in per-shard slab arenas grouped "
+               "by value size instead of one heap allocation per feasign");
+PD_DEFINE_bool(pserver_async_save,
+               false,
+               "pserver saves a snapshot of the sparse table in the background "
+               "while the pushes go on, check_save_pre_patch_done waits for "
+               "the files to be written");
+PD_DEFINE_int32(pserver_sparse_shard_split_num,
+                1,
+                "pserver splits the pull or push keys of one sparse shard by "
+                "bucket across this many threads, so that hot shards do not "
+                "wait on one task pool, 1 disables the split");
+PD_DEFINE_int32(pserver_sparse_shard_split_min_keys,
+                4096,
+                "the pull or push keys of a sparse shard are split only if "
+                "there are at least this many");
 
 namespace paddle::distributed {
 
+// keys looked up by one SparseTableShard::find_batch call in PullSparse
+static constexpr size_t kPullSparseBatchSize = 256;
+
 int32_t MemorySparseTable::Initialize() {
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_sparse_update_all");
@@ -50,6 +72,9 @@ int32_t MemorySparseTable::Initialize() {
   for (auto &shards_task : _shards_task_pool) {
     shards_task.reset(new ::ThreadPool(1));
   }
+  if (_shard_split_num > 1) {
+    _shard_split_pool.reset(new ::ThreadPool(_task_pool_size));
+  }
   VLOG(0) << "initalize MemorySparseTable succ";
   return 0;
 }
@@ -77,6 +102,39 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _use_gpu_graph:" << _use_gpu_graph;
 
   _local_shards.reset(new shard_type[_real_local_shard_num]);
+  if (FLAGS_pserver_sparse_value_arena) {
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _local_shards[i].enable_value_arena();
+    }
+  }
+  _shard_split_num = std::min<int>(FLAGS_pserver_sparse_shard_split_num,
+                                   CTR_SPARSE_SHARD_BUCKET_NUM);
+  if (_shard_split_num > 1 &&
+      (FLAGS_pserver_sparse_value_arena || _config.enable_revert())) {
+    // the arenas and the shards of revert are not shared by threads
+    LOG(WARNING) << "pserver_sparse_shard_split_num is ignored with "
+                    "pserver_sparse_value_arena or enable_revert";
+    _shard_split_num = 1;
+  }
+  if (_shard_split_num > 1) {
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _local_shards[i].enable_concurrent_emplace();
+    }
+  }
+
+  const auto &admission = _config.sparse_admission();
+  if (!admission.filter().empty()) {
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      auto filter = SparseAdmissionFilter::Create(admission);
+      PADDLE_ENFORCE_NOT_NULL(
+          filter,
+          common::errors::InvalidArgument(
+              "Unknown sparse admission filter '%s', which should be "
+              "'count_min' or 'counting_bloom'.",
+              admission.filter()));
+      _admission_filters.push_back(std::move(filter));
+    }
+  }
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -122,6 +180,7 @@ int32_t MemorySparseTable::InitializeValue() {
 
 int32_t MemorySparseTable::Load(const std::string &path,
                                 const std::string &param) {
+  WaitAsyncSave();
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
 
@@ -325,7 +384,17 @@ void MemorySparseTable::Revert() {
 }
 
 void MemorySparseTable::CheckSavePrePatchDone() {
-  _save_patch_model_thread.join();
+  if (_save_patch_model_thread.joinable()) {
+    _save_patch_model_thread.join();
+  }
+  WaitAsyncSave();
+}
+
+void MemorySparseTable::WaitAsyncSave() {
+  std::lock_guard<std::mutex> lock(_async_save_mutex);
+  if (_async_save_thread.joinable()) {
+    _async_save_thread.join();
+  }
 }
 
 int32_t MemorySparseTable::Save(const std::string &dirname,
@@ -357,6 +426,14 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
     return 0;
   }
 
+  WaitAsyncSave();
+#ifndef PADDLE_WITH_HETERPS
+  // the values pulled by PullSparsePtr are updated out of the task pools
+  if (FLAGS_pserver_async_save) {
+    return SaveAsync(dirname, save_param);
+  }
+#endif
+
   // cache model
   int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
   TopkCalculator tk(_real_local_shard_num, tk_size);
@@ -468,6 +545,162 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   return 0;
 }
 
+int32_t MemorySparseTable::SaveAsync(const std::string &dirname,
+                                     int save_param) {
+  int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
+  _async_save_tk =
+      std::make_unique<TopkCalculator>(_real_local_shard_num, tk_size);
+  _async_save_param = save_param;
+  _shard_snapshots.reset(new ShardSnapshot[_real_local_shard_num]);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _shard_snapshots[i].pending.assign(_local_shards[i].bucket_count(), 0);
+  }
+
+  std::string table_path = TableDir(dirname);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+
+  // the buckets become pending in the task pools, after the pushes before
+  _async_save_running.store(true, std::memory_order_release);
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    tasks[i] = _shards_task_pool[i % _task_pool_size]->enqueue([this, i]() {
+      auto &pending = _shard_snapshots[i].pending;
+      std::fill(pending.begin(), pending.end(), 1);
+      return 0;
+    });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+
+  _async_save_thread = std::thread([this, table_path, save_param]() {
+    WriteSnapshot(table_path, save_param);
+  });
+  VLOG(0) << "MemorySparseTable::save async begin, table path: " << table_path;
+  return 0;
+}
+
+void MemorySparseTable::SerializeSnapshotBucket(int shard_id, size_t bucket) {
+  auto &snapshot = _shard_snapshots[shard_id];
+  if (!snapshot.pending[bucket]) {
+    return;
+  }
+  snapshot.pending[bucket] = 0;
+
+  int save_param = _async_save_param;
+  auto &shard = _local_shards[shard_id];
+  std::string block;
+  int feasign_size = 0;
+  for (auto it = shard.begin(bucket); it != shard.end(bucket); ++it) {
+    float *value = it.value().data();
+    if (_config.enable_sparse_table_cache() &&
+        (save_param == 1 || save_param == 2) &&
+        _value_accessor->Save(value, 4)) {
+      _async_save_tk->push(shard_id, _value_accessor->GetField(value, "show"));
+    }
+    if (_value_accessor->Save(value, save_param)) {
+      std::string format_value =
+          _value_accessor->ParseToString(value, it.value().size());
+      block.append(std::to_string(it.key()))
+          .append(" ")
+          .append(format_value)
+          .append("\n");
+      ++feasign_size;
+    }
+  }
+  for (auto it = shard.begin(bucket); it != shard.end(bucket); ++it) {
+    _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
+  }
+  snapshot.feasign_size += feasign_size;
+  if (!block.empty()) {
+    std::lock_guard<std::mutex> lock(snapshot.mutex);
+    snapshot.blocks.push_back(std::move(block));
+  }
+}
+
+void MemorySparseTable::WriteSnapshot(const std::string &table_path,
+                                      int save_param) {
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  std::atomic<uint64_t> feasign_size_all{0};
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
+      channel_config.path =
+          ::paddle::string::format_string("%s/part-%03d-%05d.gz",
+                                          table_path.c_str(),
+                                          _shard_idx,
+                                          file_start_idx + i);
+    } else {
+      channel_config.path = ::paddle::string::format_string("%s/part-%03d-%05d",
+                                                            table_path.c_str(),
+                                                            _shard_idx,
+                                                            file_start_idx + i);
+    }
+    channel_config.converter = _value_accessor->Converter(save_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(save_param).deconverter;
+
+    auto &snapshot = _shard_snapshots[i];
+    auto &task_pool = _shards_task_pool[i % _task_pool_size];
+    int err_no = 0;
+    bool is_write_failed = false;
+    auto write_channel =
+        _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+    std::deque<std::string> blocks;
+    for (size_t bucket = 0; bucket < snapshot.pending.size(); ++bucket) {
+      // also gets the buckets serialized by the pushes
+      task_pool
+          ->enqueue([this, i, bucket]() {
+            SerializeSnapshotBucket(i, bucket);
+            return 0;
+          })
+          .wait();
+      {
+        std::lock_guard<std::mutex> lock(snapshot.mutex);
+        blocks.swap(snapshot.blocks);
+      }
+      for (auto &block : blocks) {
+        if (!is_write_failed &&
+            0 != write_channel->write(block.data(), block.size())) {
+          is_write_failed = true;
+        }
+      }
+      blocks.clear();
+    }
+    write_channel->close();
+    // the snapshot is not kept after it is written, so it can not be retried
+    if (is_write_failed || err_no == -1) {
+      LOG(ERROR) << "MemorySparseTable async save failed, path:"
+                 << channel_config.path;
+      _afs_client.remove(channel_config.path);
+      exit(-1);
+    }
+    feasign_size_all += snapshot.feasign_size;
+    LOG(INFO) << "MemorySparseTable async save prefix success, path: "
+              << channel_config.path
+              << " feasign_size: " << snapshot.feasign_size;
+  }
+  _local_show_threshold = _async_save_tk->top();
+
+  // the pushes seeing the save running are done before the snapshots go
+  _async_save_running.store(false, std::memory_order_release);
+  std::vector<std::future<int>> tasks;
+  for (auto &task_pool : _shards_task_pool) {
+    tasks.push_back(task_pool->enqueue([]() { return 0; }));
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  _shard_snapshots.reset();
+  _async_save_tk.reset();
+  LOG(INFO) << "MemorySparseTable async save success, table path: "
+            << table_path << ", feasign size: " << feasign_size_all;
+}
+
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
 int32_t MemorySparseTable::Save_v2(const std::string &dirname,
                                    const std::string &param) {
@@ -768,6 +1001,7 @@ int64_t MemorySparseTable::CacheShuffle(
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>
         &shuffled_channel,
     const std::vector<Table *> &table_ptrs) {
+  WaitAsyncSave();
   LOG(INFO) << "cache shuffle with cache threshold: " << cache_threshold;
   int save_param = atoi(param.c_str());  // batch_model:0  xbox:1
   if (!_config.enable_sparse_table_cache() || cache_threshold < 0) {
@@ -1015,57 +1249,77 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
       _real_local_shard_num);
   size_t num = pull_value.numel_;
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (pull_value.feasigns_[i] % _sparse_table_shard_num) %
-                   _avg_local_shard_num;
+    int shard_id = LocalShardOf(pull_value.feasigns_[i]);
     task_keys[shard_id].push_back({pull_value.feasigns_[i], i});
   }
+  auto process = [this,
+                  value_size,
+                  pull_values,
+                  mf_value_size,
+                  select_value_size](int shard_id,
+                                     const ShardKeys &keys) -> int {
+    auto &local_shard = _local_shards[shard_id];
+    float data_buffer[value_size];  // NOLINT
+    float *data_buffer_ptr = data_buffer;
+
+    uint64_t batch_keys[kPullSparseBatchSize];
+    FixedFeatureValue *batch_values[kPullSparseBatchSize];
+    for (size_t begin = 0; begin < keys.size();
+         begin += kPullSparseBatchSize) {
+      size_t batch_num = std::min(kPullSparseBatchSize, keys.size() - begin);
+      for (size_t i = 0; i < batch_num; ++i) {
+        batch_keys[i] = keys[begin + i].first;
+      }
+      local_shard.find_batch(batch_keys, batch_num, batch_values);
+      for (size_t i = 0; i < batch_num; ++i) {
+        size_t data_size = value_size - mf_value_size;
+        if (batch_values[i] == nullptr) {
+          // ++missed_keys;
+          if (FLAGS_pserver_create_value_when_push ||
+              !_admission_filters.empty()) {
+            // created by the push, zeros till then
+            memset(data_buffer, 0, sizeof(float) * data_size);
+          } else {
+            // the key may be created by a former duplicate
+            SnapshotBeforeWrite(shard_id, batch_keys[i]);
+            auto res = local_shard.emplace(batch_keys[i]);
+            auto &feature_value = res.first.value();
+            if (res.second) {
+              feature_value.resize(data_size);
+              _value_accessor->Create(&data_buffer_ptr, 1);
+              memcpy(feature_value.data(),
+                     data_buffer_ptr,
+                     data_size * sizeof(float));
+            } else {
+              data_size = feature_value.size();
+              memcpy(data_buffer_ptr,
+                     feature_value.data(),
+                     data_size * sizeof(float));
+            }
+          }
+        } else {
+          data_size = batch_values[i]->size();
+          memcpy(data_buffer_ptr,
+                 batch_values[i]->data(),
+                 data_size * sizeof(float));
+        }
+        for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+          data_buffer[mf_idx] = 0.0;
+        }
+        auto offset = keys[begin + i].second;
+        float *select_data = pull_values + select_value_size * offset;
+        _value_accessor->Select(
+            &select_data, (const float **)&data_buffer_ptr, 1);
+      }
+    }
+
+    return 0;
+  };
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
     tasks[shard_id] =
         _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
-            [this,
-             shard_id,
-             &task_keys,
-             value_size,
-             pull_values,
-             mf_value_size,
-             select_value_size]() -> int {
-              auto &local_shard = _local_shards[shard_id];
-              float data_buffer[value_size];  // NOLINT
-              float *data_buffer_ptr = data_buffer;
-
-              auto &keys = task_keys[shard_id];
-              for (auto &item : keys) {
-                uint64_t key = item.first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  if (FLAGS_pserver_create_value_when_push) {
-                    memset(data_buffer, 0, sizeof(float) * data_size);
-                  } else {
-                    auto &feature_value = local_shard[key];
-                    feature_value.resize(data_size);
-                    float *data_ptr = feature_value.data();
-                    _value_accessor->Create(&data_buffer_ptr, 1);
-                    memcpy(
-                        data_ptr, data_buffer_ptr, data_size * sizeof(float));
-                  }
-                } else {
-                  data_size = itr.value().size();
-                  memcpy(data_buffer_ptr,
-                         itr.value().data(),
-                         data_size * sizeof(float));
-                }
-                for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
-                  data_buffer[mf_idx] = 0.0;
-                }
-                auto offset = item.second;
-                float *select_data = pull_values + select_value_size * offset;
-                _value_accessor->Select(
-                    &select_data, (const float **)&data_buffer_ptr, 1);
-              }
-
-              return 0;
+            [this, shard_id, &task_keys, &process]() -> int {
+              return RunShardKeys(shard_id, task_keys[shard_id], process);
             });
   }
 
@@ -1089,7 +1343,7 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardOf(keys[i]);
     task_keys[shard_id].push_back({keys[i], i});
   }
   // std::atomic<uint32_t> missed_keys{0};
@@ -1106,24 +1360,36 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
               auto &local_shard = _local_shards[shard_id];
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
-              for (auto &item : keys) {
-                uint64_t key = item.first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                FixedFeatureValue *ret = NULL;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  auto &feature_value = local_shard[key];
-                  feature_value.resize(data_size);
-                  float *data_ptr = feature_value.data();
-                  _value_accessor->Create(&data_buffer_ptr, 1);
-                  memcpy(data_ptr, data_buffer_ptr, data_size * sizeof(float));
-                  ret = &feature_value;
-                } else {
-                  ret = itr.value_ptr();
+              uint64_t batch_keys[kPullSparseBatchSize];
+              FixedFeatureValue *batch_values[kPullSparseBatchSize];
+              for (size_t begin = 0; begin < keys.size();
+                   begin += kPullSparseBatchSize) {
+                size_t batch_num =
+                    std::min(kPullSparseBatchSize, keys.size() - begin);
+                for (size_t i = 0; i < batch_num; ++i) {
+                  batch_keys[i] = keys[begin + i].first;
+                }
+                local_shard.find_batch(batch_keys, batch_num, batch_values);
+                for (size_t i = 0; i < batch_num; ++i) {
+                  size_t data_size = value_size - mf_value_size;
+                  FixedFeatureValue *ret = batch_values[i];
+                  if (ret == nullptr) {
+                    // ++missed_keys;
+                    // the key may be created by a former duplicate
+                    SnapshotBeforeWrite(shard_id, batch_keys[i]);
+                    auto res = local_shard.emplace(batch_keys[i]);
+                    ret = res.first.value_ptr();
+                    if (res.second) {
+                      ret->resize(data_size);
+                      _value_accessor->Create(&data_buffer_ptr, 1);
+                      memcpy(ret->data(),
+                             data_buffer_ptr,
+                             data_size * sizeof(float));
+                    }
+                  }
+                  int pull_data_idx = keys[begin + i].second;
+                  pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
                 }
-                int pull_data_idx = item.second;
-                pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
               }
               return 0;
             });
@@ -1142,7 +1408,7 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardOf(keys[i]);
     task_keys[shard_id].push_back({keys[i], i});
   }
 
@@ -1153,69 +1419,71 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   size_t update_value_col =
       _value_accessor->GetAccessorInfo().update_size / sizeof(float);
 
-  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
-    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
-        [this,
-         shard_id,
-         value_col,
-         mf_value_col,
-         update_value_col,
-         values,
-         &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
-          auto &local_shard_new = _local_shards_new[shard_id];
-          float data_buffer[value_col];  // NOLINT
-          float *data_buffer_ptr = data_buffer;
-          for (auto &item : keys) {
-            uint64_t key = item.first;
-            uint64_t push_data_idx = item.second;
-            const float *update_data =
-                values + push_data_idx * update_value_col;
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
-              if (FLAGS_pserver_enable_create_feasign_randomly &&
-                  !_value_accessor->CreateValue(1, update_data)) {
-                continue;
-              }
-              auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
-              _value_accessor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
-                     data_buffer_ptr,
-                     value_size * sizeof(float));
-              itr = local_shard.find(key);
-            }
+  auto process = [this, value_col, mf_value_col, update_value_col, values](
+                     int shard_id, const ShardKeys &keys) -> int {
+    auto &local_shard = _local_shards[shard_id];
+    auto &local_shard_new = _local_shards_new[shard_id];
+    float data_buffer[value_col];  // NOLINT
+    float *data_buffer_ptr = data_buffer;
+    PushSparseBatch batch;
+    bool revert = _config.enable_revert();
+    for (auto &item : keys) {
+      uint64_t key = item.first;
+      uint64_t push_data_idx = item.second;
+      SnapshotBeforeWrite(shard_id, key);
+      const float *update_data = values + push_data_idx * update_value_col;
+      auto itr = local_shard.find(key);
+      if (itr == local_shard.end()) {
+        if ((FLAGS_pserver_enable_create_feasign_randomly &&
+             !_value_accessor->CreateValue(1, update_data)) ||
+            !AdmitKey(shard_id, key)) {
+          continue;
+        }
+        auto value_size = value_col - mf_value_col;
+        auto &feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        _value_accessor->Create(&data_buffer_ptr, 1);
+        memcpy(
+            feature_value.data(), data_buffer_ptr, value_size * sizeof(float));
+        itr = local_shard.find(key);
+      }
 
-            auto &feature_value = itr.value();
-            float *value_data = feature_value.data();
-            size_t value_size = feature_value.size();
+      auto &feature_value = itr.value();
+      float *value_data = feature_value.data();
+      size_t value_size = feature_value.size();
 
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
-
-              if (_value_accessor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accessor->Create(&value_data, 1);
-              }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
-            }
-            if (_config.enable_revert()) {
-              FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
-              auto new_size = feature_value.size();
-              feature_value_new->resize(new_size);
-              memcpy(feature_value_new->data(),
-                     value_data,
-                     new_size * sizeof(float));
-            }
-          }
-          return 0;
+      if (value_size == value_col) {  // 已拓展到最大size, 则就地update
+        // copied to _local_shards_new by the flush of the batch
+        if (batch.Add(key, &feature_value, update_data)) {
+          FlushPushSparseBatch(shard_id, &batch, revert);
+        }
+        continue;
+      }
+      // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+      memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+      _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+
+      if (_value_accessor->NeedExtendMF(data_buffer)) {
+        feature_value.resize(value_col);
+        value_data = feature_value.data();
+        _value_accessor->Create(&value_data, 1);
+      }
+      memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+      if (revert) {
+        FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
+        auto new_size = feature_value.size();
+        feature_value_new->resize(new_size);
+        memcpy(
+            feature_value_new->data(), value_data, new_size * sizeof(float));
+      }
+    }
+    FlushPushSparseBatch(shard_id, &batch, revert);
+    return 0;
+  };
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
+        [this, shard_id, &task_keys, &process]() -> int {
+          return RunShardKeys(shard_id, task_keys[shard_id], process);
         });
   }
 
@@ -1232,7 +1500,7 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardOf(keys[i]);
     task_keys[shard_id].push_back({keys[i], i});
   }
 
@@ -1240,50 +1508,58 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   size_t mf_value_col =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
 
+  auto process = [this, value_col, mf_value_col, values](
+                     int shard_id, const ShardKeys &keys) -> int {
+    auto &local_shard = _local_shards[shard_id];
+    float data_buffer[value_col];  // NOLINT
+    float *data_buffer_ptr = data_buffer;
+    PushSparseBatch batch;
+    for (auto &item : keys) {
+      uint64_t key = item.first;
+      uint64_t push_data_idx = item.second;
+      SnapshotBeforeWrite(shard_id, key);
+      const float *update_data = values[push_data_idx];
+      auto itr = local_shard.find(key);
+      if (itr == local_shard.end()) {
+        if ((FLAGS_pserver_enable_create_feasign_randomly &&
+             !_value_accessor->CreateValue(1, update_data)) ||
+            !AdmitKey(shard_id, key)) {
+          continue;
+        }
+        auto value_size = value_col - mf_value_col;
+        auto &feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        _value_accessor->Create(&data_buffer_ptr, 1);
+        memcpy(
+            feature_value.data(), data_buffer_ptr, value_size * sizeof(float));
+        itr = local_shard.find(key);
+      }
+      auto &feature_value = itr.value();
+      float *value_data = feature_value.data();
+      size_t value_size = feature_value.size();
+      if (value_size == value_col) {  // 已拓展到最大size, 则就地update
+        if (batch.Add(key, &feature_value, update_data)) {
+          FlushPushSparseBatch(shard_id, &batch, false);
+        }
+      } else {
+        // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+        memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+        _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+        if (_value_accessor->NeedExtendMF(data_buffer)) {
+          feature_value.resize(value_col);
+          value_data = feature_value.data();
+          _value_accessor->Create(&value_data, 1);
+        }
+        memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+      }
+    }
+    FlushPushSparseBatch(shard_id, &batch, false);
+    return 0;
+  };
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
     tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
-        [this, shard_id, value_col, mf_value_col, values, &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
-          float data_buffer[value_col];  // NOLINT
-          float *data_buffer_ptr = data_buffer;
-          for (auto &item : keys) {
-            uint64_t key = item.first;
-            uint64_t push_data_idx = item.second;
-            const float *update_data = values[push_data_idx];
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
-              if (FLAGS_pserver_enable_create_feasign_randomly &&
-                  !_value_accessor->CreateValue(1, update_data)) {
-                continue;
-              }
-              auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
-              _value_accessor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
-                     data_buffer_ptr,
-                     value_size * sizeof(float));
-              itr = local_shard.find(key);
-            }
-            auto &feature_value = itr.value();
-            float *value_data = feature_value.data();
-            size_t value_size = feature_value.size();
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
-              if (_value_accessor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accessor->Create(&value_data, 1);
-              }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
-            }
-          }
-          return 0;
+        [this, shard_id, &task_keys, &process]() -> int {
+          return RunShardKeys(shard_id, task_keys[shard_id], process);
         });
   }
 
@@ -1293,11 +1569,80 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
+void MemorySparseTable::FlushPushSparseBatch(int shard_id,
+                                             PushSparseBatch *batch,
+                                             bool revert) {
+  if (batch->num == 0) {
+    return;
+  }
+  _value_accessor->Update(batch->values, batch->grads, batch->num);
+  if (revert) {
+    auto &local_shard_new = _local_shards_new[shard_id];
+    for (size_t i = 0; i < batch->num; ++i) {
+      FixedFeatureValue *feature_value_new = &(local_shard_new[batch->keys[i]]);
+      auto new_size = batch->feature_values[i]->size();
+      feature_value_new->resize(new_size);
+      memcpy(feature_value_new->data(),
+             batch->feature_values[i]->data(),
+             new_size * sizeof(float));
+    }
+  }
+  batch->num = 0;
+}
+
+int32_t MemorySparseTable::RunShardKeys(
+    int shard_id,
+    const ShardKeys &keys,
+    const std::function<int32_t(int, const ShardKeys &)> &process) {
+  // the buckets written by an async save are serialized by the task pool
+  if (_shard_split_pool == nullptr ||
+      keys.size() <
+          static_cast<size_t>(FLAGS_pserver_sparse_shard_split_min_keys) ||
+      _async_save_running.load(std::memory_order_acquire)) {
+    return process(shard_id, keys);
+  }
+  // the keys of a bucket keep their order in its part
+  auto &local_shard = _local_shards[shard_id];
+  size_t bucket_num = local_shard.bucket_count();
+  std::vector<ShardKeys> parts(_shard_split_num);
+  for (auto &item : keys) {
+    size_t bucket = local_shard.bucket_of(item.first);
+    parts[bucket * _shard_split_num / bucket_num].push_back(item);
+  }
+  std::vector<std::future<int32_t>> tasks;
+  for (int i = 1; i < _shard_split_num; ++i) {
+    if (!parts[i].empty()) {
+      tasks.push_back(_shard_split_pool->enqueue(
+          [&process, &parts, shard_id, i]() -> int32_t {
+            return process(shard_id, parts[i]);
+          }));
+    }
+  }
+  int32_t ret = 0;
+  try {
+    ret = process(shard_id, parts[0]);
+  } catch (...) {
+    for (auto &task : tasks) {
+      task.wait();
+    }
+    throw;
+  }
+  for (auto &task : tasks) {
+    int32_t part_ret = task.get();
+    if (ret == 0) {
+      ret = part_ret;
+    }
+  }
+  return ret;
+}
+
 int32_t MemorySparseTable::Flush() { return 0; }
 
 int32_t MemorySparseTable::Shrink(const std::string &param) {
   VLOG(0) << "MemorySparseTable::Shrink";
+  WaitAsyncSave();
   std::atomic<uint32_t> shrink_size_all{0};
+  std::atomic<uint64_t> released_bytes_all{0};
   int thread_num = _real_local_shard_num;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -1314,12 +1659,166 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
       }
     }
     shrink_size_all += feasign_size;
+    // release the slabs left sparse by the erased values
+    released_bytes_all += shard.compact_values();
   }
   VLOG(0) << "MemorySparseTable::Shrink success, shrink size:"
-          << shrink_size_all;
+          << shrink_size_all << ", released arena bytes:" << released_bytes_all;
+  return 0;
+}
+
+int32_t MemorySparseTable::ExportShard(uint32_t shard_id,
+                                       std::vector<uint64_t> *keys,
+                                       std::vector<uint32_t> *dims,
+                                       std::vector<float> *values) {
+  if (_real_local_shard_num == 0 ||
+      shard_id >= static_cast<uint32_t>(_sparse_table_shard_num)) {
+    return -1;
+  }
+  int local_shard_id = LocalShardOf(shard_id);
+  return _shards_task_pool[local_shard_id % _shards_task_pool.size()]
+      ->enqueue([this, shard_id, local_shard_id, keys, dims, values]() -> int {
+        auto &shard = _local_shards[local_shard_id];
+        for (auto it = shard.begin(); it != shard.end(); ++it) {
+          if (it.key() % _sparse_table_shard_num != shard_id) {
+            continue;
+          }
+          auto &value = it.value();
+          keys->push_back(it.key());
+          dims->push_back(value.size());
+          values->insert(
+              values->end(), value.data(), value.data() + value.size());
+        }
+        return 0;
+      })
+      .get();
+}
+
+int32_t MemorySparseTable::ExportValues(const uint64_t *keys,
+                                        size_t num,
+                                        std::vector<uint64_t> *exported_keys,
+                                        std::vector<uint32_t> *dims,
+                                        std::vector<float> *values) {
+  if (_real_local_shard_num == 0) {
+    return num == 0 ? 0 : -1;
+  }
+  std::vector<std::vector<uint64_t>> task_keys(_real_local_shard_num);
+  for (size_t i = 0; i < num; ++i) {
+    task_keys[LocalShardOf(keys[i])].push_back(keys[i]);
+  }
+  std::vector<std::vector<uint64_t>> shard_keys(_real_local_shard_num);
+  std::vector<std::vector<uint32_t>> shard_dims(_real_local_shard_num);
+  std::vector<std::vector<float>> shard_values(_real_local_shard_num);
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] =
+        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+            [&, shard_id]() -> int {
+              auto &local_shard = _local_shards[shard_id];
+              for (auto key : task_keys[shard_id]) {
+                auto itr = local_shard.find(key);
+                if (itr == local_shard.end()) {
+                  continue;
+                }
+                auto &value = itr.value();
+                shard_keys[shard_id].push_back(key);
+                shard_dims[shard_id].push_back(value.size());
+                shard_values[shard_id].insert(shard_values[shard_id].end(),
+                                              value.data(),
+                                              value.data() + value.size());
+              }
+              return 0;
+            });
+  }
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id].wait();
+    exported_keys->insert(exported_keys->end(),
+                          shard_keys[shard_id].begin(),
+                          shard_keys[shard_id].end());
+    dims->insert(
+        dims->end(), shard_dims[shard_id].begin(), shard_dims[shard_id].end());
+    values->insert(values->end(),
+                   shard_values[shard_id].begin(),
+                   shard_values[shard_id].end());
+  }
   return 0;
 }
 
+int32_t MemorySparseTable::ImportValues(const uint64_t *keys,
+                                        const uint32_t *dims,
+                                        const float *values,
+                                        size_t num) {
+  if (_real_local_shard_num == 0) {
+    return num == 0 ? 0 : -1;
+  }
+  std::vector<std::vector<std::pair<uint64_t, size_t>>> task_keys(
+      _real_local_shard_num);
+  std::vector<std::vector<uint32_t>> task_dims(_real_local_shard_num);
+  size_t offset = 0;
+  for (size_t i = 0; i < num; ++i) {
+    int shard_id = LocalShardOf(keys[i]);
+    task_keys[shard_id].push_back({keys[i], offset});
+    task_dims[shard_id].push_back(dims[i]);
+    offset += dims[i];
+  }
+  std::vector<std::future<int>> tasks(_real_local_shard_num);
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] =
+        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+            [&, shard_id]() -> int {
+              auto &local_shard = _local_shards[shard_id];
+              for (size_t i = 0; i < task_keys[shard_id].size(); ++i) {
+                uint64_t key = task_keys[shard_id][i].first;
+                uint32_t dim = task_dims[shard_id][i];
+                SnapshotBeforeWrite(shard_id, key);
+                auto &value = local_shard[key];
+                value.resize(dim);
+                memcpy(value.data(),
+                       values + task_keys[shard_id][i].second,
+                       dim * sizeof(float));
+              }
+              return 0;
+            });
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  return 0;
+}
+
+int32_t MemorySparseTable::DropShard(uint32_t shard_id) {
+  if (_real_local_shard_num == 0 ||
+      shard_id >= static_cast<uint32_t>(_sparse_table_shard_num)) {
+    return -1;
+  }
+  int local_shard_id = LocalShardOf(shard_id);
+  auto drop = [this, shard_id, local_shard_id](shard_type *shard) {
+    size_t drop_size = 0;
+    for (auto it = shard->begin(); it != shard->end();) {
+      if (it.key() % _sparse_table_shard_num == shard_id) {
+        SnapshotBeforeWrite(local_shard_id, it.key());
+        it = shard->erase(it);
+        ++drop_size;
+      } else {
+        ++it;
+      }
+    }
+    shard->compact_values();
+    return drop_size;
+  };
+  return _shards_task_pool[local_shard_id % _shards_task_pool.size()]
+      ->enqueue([this, shard_id, local_shard_id, &drop]() -> int {
+        size_t drop_size = drop(&_local_shards[local_shard_id]);
+        if (_config.enable_revert()) {
+          drop(&_local_shards_new[local_shard_id]);
+        }
+        VLOG(1) << "MemorySparseTable::DropShard shard " << shard_id
+                << ", drop size: " << drop_size;
+        return 0;
+      })
+      .get();
+}
+
 void MemorySparseTable::Clear() { VLOG(0) << "clear coming soon"; }
 
 }  // namespace paddle::distributed
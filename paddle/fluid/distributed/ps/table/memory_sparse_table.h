@@ -18,6 +18,9 @@
 #include <assert.h>
 #include <pthread.h>
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -26,9 +29,11 @@
 #include <vector>
 
 #include "Eigen/Dense"
+#include "paddle/fluid/distributed/common/topk_calculator.h"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_admission_filter.h"
 #include "paddle/utils/string/string_helper.h"
 
 #define PSERVER_SAVE_SUFFIX ".shard"
@@ -40,7 +45,7 @@ class MemorySparseTable : public Table {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   MemorySparseTable() {}
-  virtual ~MemorySparseTable() {}
+  virtual ~MemorySparseTable() { WaitAsyncSave(); }
 
   // unused method end
   static int32_t sparse_local_shard_num(uint32_t shard_num,
@@ -77,7 +82,10 @@ class MemorySparseTable : public Table {
       const std::string& param,
       paddle::framework::Channel<std::pair<uint64_t, std::string>>&
           shuffled_channel) override;
-  virtual double GetCacheThreshold() { return _local_show_threshold; }
+  virtual double GetCacheThreshold() {
+    WaitAsyncSave();
+    return _local_show_threshold;
+  }
   int64_t CacheShuffle(
       const std::string& path,
       const std::string& param,
@@ -107,24 +115,128 @@ class MemorySparseTable : public Table {
   int32_t Shrink(const std::string& param) override;
   void Clear() override;
 
+  // for the online resharding, run by the task pools of the shards
+  int32_t ExportShard(uint32_t shard_id,
+                      std::vector<uint64_t>* keys,
+                      std::vector<uint32_t>* dims,
+                      std::vector<float>* values) override;
+  int32_t ExportValues(const uint64_t* keys,
+                       size_t num,
+                       std::vector<uint64_t>* exported_keys,
+                       std::vector<uint32_t>* dims,
+                       std::vector<float>* values) override;
+  int32_t ImportValues(const uint64_t* keys,
+                       const uint32_t* dims,
+                       const float* values,
+                       size_t num) override;
+  int32_t DropShard(uint32_t shard_id) override;
+
   void* GetShard(size_t shard_idx) override {
     return &_local_shards[shard_idx];
   }
 
   virtual void Revert();
+  // waits for the patch model and the snapshot of an async save
   virtual void CheckSavePrePatchDone();
 
+  // Waits for the files of an async save to be written.
+  void WaitAsyncSave();
+
  protected:
+  typedef std::vector<std::pair<uint64_t, int>> ShardKeys;
+
+  // The local shard of key. The global shards of a server are the ones of
+  // its range at start, or any others imported by a resharding, which share
+  // the local shards modulo _real_local_shard_num.
+  int LocalShardOf(uint64_t key) const {
+    return static_cast<int>(
+        ((key % _sparse_table_shard_num) % _avg_local_shard_num) %
+        _real_local_shard_num);
+  }
+
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
 
+  // Saves a snapshot of the shards without stopping the pushes, see
+  // FLAGS_pserver_async_save. Every bucket of every shard is pending when the
+  // save begins. The buckets are serialized one after another by the task
+  // pools and written by the writer threads of the save. A push or a pull
+  // creating a key in a pending bucket in the meantime serializes the bucket
+  // first, so the snapshot is the one of the shard when the save began.
+  int32_t SaveAsync(const std::string& dirname, int save_param);
+  void WriteSnapshot(const std::string& table_path, int save_param);
+  // Called by the task pool of the shard before changing the bucket of key.
+  void SnapshotBeforeWrite(int shard_id, uint64_t key) {
+    if (_async_save_running.load(std::memory_order_acquire)) {
+      SerializeSnapshotBucket(shard_id, _local_shards[shard_id].bucket_of(key));
+    }
+  }
+  void SerializeSnapshotBucket(int shard_id, size_t bucket);
+
+  // The in place updates of the values already extended to the full size in
+  // a push task, applied by one ValueAccessor::Update call per kSize values.
+  // The later pushes of such a key are in place too, so deferring them keeps
+  // the order of the updates of every value.
+  struct PushSparseBatch {
+    static constexpr size_t kSize = 64;
+    // returns whether the batch is full
+    bool Add(uint64_t key, FixedFeatureValue* value, const float* grad) {
+      keys[num] = key;
+      feature_values[num] = value;
+      values[num] = value->data();
+      grads[num] = grad;
+      return ++num == kSize;
+    }
+    size_t num{0};
+    uint64_t keys[kSize];
+    FixedFeatureValue* feature_values[kSize];
+    float* values[kSize];
+    const float* grads[kSize];
+  };
+  // Updates the values of batch and empties it, the updated values are
+  // copied to _local_shards_new if revert.
+  void FlushPushSparseBatch(int shard_id, PushSparseBatch* batch, bool revert);
+
+  // Called by the task pool of the shard to run process on the keys of a
+  // pull or a push. With FLAGS_pserver_sparse_shard_split_num > 1, enough
+  // keys are split by ranges of buckets, the parts after the first run on
+  // _shard_split_pool while this thread runs the first one and waits for
+  // them. The shard stays exclusive to the task and the parts touch disjoint
+  // buckets, so only the allocator of the shard is shared by the parts.
+  int32_t RunShardKeys(
+      int shard_id,
+      const ShardKeys& keys,
+      const std::function<int32_t(int, const ShardKeys&)>& process);
+
+  // Called by the push of a missing key, whether the key gets a value, see
+  // SparseAdmissionParameter.
+  bool AdmitKey(int shard_id, uint64_t key) {
+    return _admission_filters.empty() ||
+           _admission_filters[shard_id]->Admit(key);
+  }
+
+  struct ShardSnapshot {
+    // whether a bucket is not serialized yet, only used by the task pool of
+    // the shard
+    std::vector<uint8_t> pending;
+    int feasign_size{0};
+    // the serialized buckets not written yet
+    std::mutex mutex;
+    std::deque<std::string> blocks;
+  };
+
   int _task_pool_size = 24;
   int _avg_local_shard_num;
   int _real_local_shard_num;
   int _sparse_table_shard_num;
   std::vector<std::shared_ptr<::ThreadPool>> _shards_task_pool;
   std::unique_ptr<shard_type[]> _local_shards;
+  // see RunShardKeys
+  int _shard_split_num{1};
+  std::unique_ptr<::ThreadPool> _shard_split_pool;
+  // one for each local shard, empty if all the keys are admitted
+  std::vector<std::unique_ptr<SparseAdmissionFilter>> _admission_filters;
 
   // for patch model
   int _m_avg_local_shard_num;
@@ -137,6 +249,14 @@ class MemorySparseTable : public Table {
   std::unique_ptr<shard_type[]> _local_shards_patch_model;
   std::thread _save_patch_model_thread;
   bool _use_gpu_graph = false;
+
+  // for async save
+  std::atomic<bool> _async_save_running{false};
+  int _async_save_param{0};
+  std::unique_ptr<ShardSnapshot[]> _shard_snapshots;
+  std::unique_ptr<TopkCalculator> _async_save_tk;
+  std::thread _async_save_thread;
+  std::mutex _async_save_mutex;
 };
 
 }  // namespace distributed
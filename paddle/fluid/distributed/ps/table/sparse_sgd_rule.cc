@@ -24,6 +24,63 @@ PD_DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
 
 namespace paddle::distributed {
 
+namespace {
+
+// how many values ahead UpdateValueBatch prefetches
+constexpr size_t kUpdatePrefetchDistance = 2;
+
+inline void PrefetchForUpdate(float *w, float *sgd, const float *push_value) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(w, 1, 3);
+  __builtin_prefetch(sgd, 1, 3);
+  __builtin_prefetch(push_value, 0, 3);
+#endif
+}
+
+// the members are kept in locals by the update loops, the stores to w may
+// alias them otherwise
+inline void BoundTo(float *w, float min_bound, float max_bound) {
+  if (!(*w >= min_bound)) {
+    *w = min_bound;
+  } else if (!(*w <= max_bound)) {
+    *w = max_bound;
+  }
+}
+
+// calls Rule::UpdateValueWork without the virtual dispatch, so that it is
+// inlined into the loop over the values
+template <class Rule>
+void UpdateValueBatchOf(Rule *rule,
+                        float **w,
+                        float **sgd,
+                        const float **push_values,
+                        const float *scales,
+                        size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    if (i + kUpdatePrefetchDistance < num) {
+      size_t next = i + kUpdatePrefetchDistance;
+      PrefetchForUpdate(w[next], sgd[next], push_values[next]);
+    }
+    rule->Rule::UpdateValueWork(w[i], sgd[i], push_values[i], scales[i]);
+  }
+}
+
+}  // namespace
+
+void SparseValueSGDRule::UpdateValueBatchWork(float **w,
+                                              float **sgd,
+                                              const float **push_values,
+                                              const float *scales,
+                                              size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    if (i + kUpdatePrefetchDistance < num) {
+      size_t next = i + kUpdatePrefetchDistance;
+      PrefetchForUpdate(w[next], sgd[next], push_values[next]);
+    }
+    UpdateValueWork(w[i], sgd[i], push_values[i], scales[i]);
+  }
+}
+
 void SparseNaiveSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
                                     size_t emb_dim) {
   _embedding_dim = emb_dim;
@@ -98,17 +155,34 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
                                            const float *grad,
                                            float scale) {
   float &g2sum = sgd[G2SumIndex()];
+  const size_t dim = _embedding_dim;
+  const float learning_rate = learning_rate_;
+  const float min_bound = _min_bound;
+  const float max_bound = _max_bound;
+  const auto ratio = sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
+
+  // the weights are updated apart from the ordered sum, so that the loop can
+  // be vectorized
+  for (size_t i = 0; i < dim; i++) {
+    double scaled_grad = grad[i] / scale;
+    w[i] -= learning_rate * scaled_grad * ratio;
+    BoundTo(w + i, min_bound, max_bound);
+  }
   double add_g2sum = 0;
-
-  for (size_t i = 0; i < _embedding_dim; i++) {
+  for (size_t i = 0; i < dim; i++) {
     double scaled_grad = grad[i] / scale;
-    w[i] -= learning_rate_ * scaled_grad *
-            sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
-    BoundValue(w[i]);
     add_g2sum += scaled_grad * scaled_grad;
   }
 
-  g2sum += add_g2sum / _embedding_dim;
+  g2sum += add_g2sum / dim;
+}
+
+void SparseAdaGradSGDRule::UpdateValueBatchWork(float **w,
+                                                float **sgd,
+                                                const float **push_values,
+                                                const float *scales,
+                                                size_t num) {
+  UpdateValueBatchOf(this, w, sgd, push_values, scales, num);
 }
 
 void SparseAdaGradSGDRule::InitValueWork(float *value,
@@ -156,16 +230,29 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
                                         float *sgd,
                                         const float *grad,
                                         float scale) {
-  for (size_t i = 0; i < _embedding_dim; i++) {
-    float &g2sum = sgd[G2SumIndex() + i];
+  float *g2sum = sgd + G2SumIndex();
+  const size_t dim = _embedding_dim;
+  const float learning_rate = learning_rate_;
+  const float initial_g2sum = _initial_g2sum;
+  const float min_bound = _min_bound;
+  const float max_bound = _max_bound;
+  for (size_t i = 0; i < dim; i++) {
     double scaled_grad = grad[i] / scale;
-    w[i] -= learning_rate_ * scaled_grad *
-            sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
-    BoundValue(w[i]);
-    g2sum += scaled_grad * scaled_grad;
+    w[i] -= learning_rate * scaled_grad *
+            sqrt(initial_g2sum / (initial_g2sum + g2sum[i]));
+    BoundTo(w + i, min_bound, max_bound);
+    g2sum[i] += scaled_grad * scaled_grad;
   }
 }
 
+void StdAdaGradSGDRule::UpdateValueBatchWork(float **w,
+                                             float **sgd,
+                                             const float **push_values,
+                                             const float *scales,
+                                             size_t num) {
+  UpdateValueBatchOf(this, w, sgd, push_values, scales, num);
+}
+
 void StdAdaGradSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -223,17 +310,31 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   float beta2_pow_ = *beta2_pow;
 
   lr *= sqrt(1 - beta2_pow_) / (1 - beta1_pow_);
-  for (size_t i = 0; i < _embedding_dim; i++) {
+  const size_t dim = _embedding_dim;
+  const float beta1_decay_rate = _beta1_decay_rate;
+  const float beta2_decay_rate = _beta2_decay_rate;
+  const float ada_epsilon = _ada_epsilon;
+  const float min_bound = _min_bound;
+  const float max_bound = _max_bound;
+  for (size_t i = 0; i < dim; i++) {
     // Calculation
-    gsum[i] = _beta1_decay_rate * gsum[i] + (1 - _beta1_decay_rate) * g[i];
+    gsum[i] = beta1_decay_rate * gsum[i] + (1 - beta1_decay_rate) * g[i];
     g2sum[i] =
-        _beta2_decay_rate * g2sum[i] + (1 - _beta2_decay_rate) * g[i] * g[i];
-    w[i] = w[i] - lr * (gsum[i] / (sqrt(g2sum[i]) + _ada_epsilon));
-    BoundValue(w[i]);
+        beta2_decay_rate * g2sum[i] + (1 - beta2_decay_rate) * g[i] * g[i];
+    w[i] = w[i] - lr * (gsum[i] / (sqrt(g2sum[i]) + ada_epsilon));
+    BoundTo(w + i, min_bound, max_bound);
   }
   // update beta_pow_decay
-  (*beta1_pow) *= _beta1_decay_rate;
-  (*beta2_pow) *= _beta2_decay_rate;
+  (*beta1_pow) *= beta1_decay_rate;
+  (*beta2_pow) *= beta2_decay_rate;
+}
+
+void SparseAdamSGDRule::UpdateValueBatchWork(float **w,
+                                             float **sgd,
+                                             const float **push_values,
+                                             const float *scales,
+                                             size_t num) {
+  UpdateValueBatchOf(this, w, sgd, push_values, scales, num);
 }
 
 void SparseAdamSGDRule::InitValueWork(float *value,
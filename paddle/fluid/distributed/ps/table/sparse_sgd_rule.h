@@ -51,6 +51,20 @@ class SparseValueSGDRule {
                    float scale = 1) {
     UpdateValueWork(w, sgd, push_value, scale);
   }
+  // Updates num values in order, the i-th one by push_values[i] with
+  // scales[i], as one UpdateValue call per value would.
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num);
+  void UpdateValueBatch(float** w,
+                        float** sgd,
+                        const float** push_values,
+                        const float* scales,
+                        size_t num) {
+    UpdateValueBatchWork(w, sgd, push_values, scales, num);
+  }
   template <class T>
   void BoundValue(T& w) {  // NOLINT
     if (!(w >= _min_bound)) {
@@ -97,6 +111,11 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  void UpdateValueBatchWork(float** w,
+                            float** sgd,
+                            const float** push_values,
+                            const float* scales,
+                            size_t num) override;
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -134,6 +153,11 @@ class StdAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  void UpdateValueBatchWork(float** w,
+                            float** sgd,
+                            const float** push_values,
+                            const float* scales,
+                            size_t num) override;
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim; }
   size_t G2SumIndex() { return 0; }
@@ -151,6 +175,11 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  void UpdateValueBatchWork(float** w,
+                            float** sgd,
+                            const float** push_values,
+                            const float* scales,
+                            size_t num) override;
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim * 2 + 2; }
   size_t GSumIndex() { return 0; }
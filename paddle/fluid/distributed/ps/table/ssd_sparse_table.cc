@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
@@ -28,6 +30,25 @@ PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
+PD_DEFINE_int64(pserver_ssd_mem_capacity_per_shard,
+                0,
+                "max number of feasigns kept in memory by each shard of ssd "
+                "table, the least frequently accessed ones are moved to "
+                "rocksdb during training, 0 means no limit. Not for the "
+                "PullSparsePtr path of gpups, whose values are pinned");
+PD_DEFINE_double(pserver_ssd_evict_ratio,
+                 0.1,
+                 "ratio of pserver_ssd_mem_capacity_per_shard moved to "
+                 "rocksdb once a shard exceeds its memory capacity");
+PD_DEFINE_int32(rocksdb_compaction_rate_limit_mb,
+                0,
+                "limit of the flush and compaction write rate of sparse table "
+                "rocksdb in MB/s, 0 means no limit");
+
+namespace {
+// number of keys read or written by one rocksdb batch
+constexpr size_t kSSDBatchSize = 1024;
+}  // namespace
 
 namespace paddle {
 namespace distributed {
@@ -35,7 +56,25 @@ namespace distributed {
 int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = ::paddle::distributed::RocksDBHandler::GetInstance();
-  _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  _db->initialize(
+      FLAGS_rocksdb_path,
+      _real_local_shard_num,
+      static_cast<int64_t>(FLAGS_rocksdb_compaction_rate_limit_mb) << 20);
+  if (FLAGS_pserver_ssd_mem_capacity_per_shard > 0) {
+    _mem_capacity_per_shard = FLAGS_pserver_ssd_mem_capacity_per_shard;
+    // about one counter per key kept in memory
+    size_t sketch_width = std::min<size_t>(
+        std::max<size_t>(_mem_capacity_per_shard, 4096), 1 << 22);
+    _hot_key_sketches.assign(_real_local_shard_num, HotKeySketch(sketch_width));
+    _evict_cursors.assign(_real_local_shard_num, 0);
+    _evict_pending.reset(new std::atomic<bool>[_real_local_shard_num]);
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _evict_pending[i].store(false);
+    }
+    VLOG(0) << "SSDSparseTable online tiering, mem capacity per shard:"
+            << _mem_capacity_per_shard
+            << " evict ratio:" << FLAGS_pserver_ssd_evict_ratio;
+  }
   VLOG(0) << "initialize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
@@ -125,44 +164,25 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_size];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
+                TouchKeys(shard_id, keys);
+                // from rocksdb to mem, the keys missed afterwards are new
+                LoadFromSSD(shard_id, keys);
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
                   auto itr = local_shard.find(key);
                   size_t data_size = value_size - mf_value_size;
                   if (itr == local_shard.end()) {
-                    // pull rocksdb
-                    std::string tmp_string("");
-                    if (_db->get(shard_id,
-                                 reinterpret_cast<char*>(&key),
-                                 sizeof(uint64_t),
-                                 tmp_string) > 0) {
-                      ++missed_keys;
-                      if (FLAGS_pserver_create_value_when_push) {
-                        memset(data_buffer, 0, sizeof(float) * data_size);
-                      } else {
-                        auto& feature_value = local_shard[key];
-                        feature_value.resize(data_size);
-                        float* data_ptr =
-                            const_cast<float*>(feature_value.data());
-                        _value_accessor->Create(&data_buffer_ptr, 1);
-                        memcpy(data_ptr,
-                               data_buffer_ptr,
-                               data_size * sizeof(float));
-                      }
+                    ++missed_keys;
+                    if (FLAGS_pserver_create_value_when_push) {
+                      memset(data_buffer, 0, sizeof(float) * data_size);
                     } else {
-                      data_size = tmp_string.size() / sizeof(float);
-                      memcpy(data_buffer_ptr,
-                             ::paddle::string::str_to_float(tmp_string),
-                             data_size * sizeof(float));
-                      // from rocksdb to mem
                       auto& feature_value = local_shard[key];
                       feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
-                             data_buffer_ptr,
-                             data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
+                      float* data_ptr =
+                          const_cast<float*>(feature_value.data());
+                      _value_accessor->Create(&data_buffer_ptr, 1);
+                      memcpy(
+                          data_ptr, data_buffer_ptr, data_size * sizeof(float));
                     }
                   } else {
                     data_size = itr.value().size();
@@ -180,6 +200,7 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                   _value_accessor->Select(
                       &select_data, (const float**)&data_buffer_ptr, 1);
                 }
+                ScheduleEviction(shard_id);
                 return 0;
               });
     }
@@ -377,6 +398,12 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
+                PushSparseBatch batch;
+                if (OnlineTiering()) {
+                  // evicted keys must not be created again
+                  TouchKeys(shard_id, keys);
+                  LoadFromSSD(shard_id, keys);
+                }
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
                   uint64_t push_data_idx = keys[i].second;
@@ -403,7 +430,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
 
                   if (value_size ==
                       value_col) {  // 已拓展到最大size, 则就地update
-                    _value_accessor->Update(&value_data, &update_data, 1);
+                    if (batch.Add(key, &feature_value, update_data)) {
+                      FlushPushSparseBatch(shard_id, &batch, false);
+                    }
                   } else {
                     // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
                     memcpy(data_buffer_ptr,
@@ -420,6 +449,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                FlushPushSparseBatch(shard_id, &batch, false);
+                ScheduleEviction(shard_id);
                 return 0;
               });
     }
@@ -478,6 +509,12 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
+                PushSparseBatch batch;
+                if (OnlineTiering()) {
+                  // evicted keys must not be created again
+                  TouchKeys(shard_id, keys);
+                  LoadFromSSD(shard_id, keys);
+                }
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
                   uint64_t push_data_idx = keys[i].second;
@@ -503,7 +540,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
 
                   if (value_size ==
                       value_col) {  // 已拓展到最大size, 则就地update
-                    _value_accessor->Update(&value_data, &update_data, 1);
+                    if (batch.Add(key, &feature_value, update_data)) {
+                      FlushPushSparseBatch(shard_id, &batch, false);
+                    }
                   } else {
                     // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
                     memcpy(data_buffer_ptr,
@@ -520,6 +559,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                FlushPushSparseBatch(shard_id, &batch, false);
+                ScheduleEviction(shard_id);
                 return 0;
               });
     }
@@ -530,7 +571,165 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
   return 0;
 }
 
+void SSDSparseTable::TouchKeys(
+    int shard_id, const std::vector<std::pair<uint64_t, int>>& keys) {
+  if (!OnlineTiering()) {
+    return;
+  }
+  auto& sketch = _hot_key_sketches[shard_id];
+  for (auto& item : keys) {
+    sketch.Touch(item.first);
+  }
+}
+
+size_t SSDSparseTable::LoadFromSSD(
+    int shard_id, const std::vector<std::pair<uint64_t, int>>& keys) {
+  auto& local_shard = _local_shards[shard_id];
+  std::vector<uint64_t> missed_keys;
+  for (auto& item : keys) {
+    if (local_shard.find(item.first) == local_shard.end()) {
+      missed_keys.push_back(item.first);
+    }
+  }
+  if (missed_keys.empty()) {
+    return 0;
+  }
+  // sorted as the keys of rocksdb, see Uint64Comparator
+  std::sort(missed_keys.begin(), missed_keys.end());
+  missed_keys.erase(std::unique(missed_keys.begin(), missed_keys.end()),
+                    missed_keys.end());
+
+  size_t loaded = 0;
+  RocksDBItem batch;
+  std::vector<rocksdb::Slice> loaded_keys;
+  for (size_t begin = 0; begin < missed_keys.size(); begin += kSSDBatchSize) {
+    size_t end = std::min(begin + kSSDBatchSize, missed_keys.size());
+    batch.reset();
+    for (size_t i = begin; i < end; ++i) {
+      batch.batch_keys.emplace_back(
+          reinterpret_cast<const char*>(&missed_keys[i]), sizeof(uint64_t));
+    }
+    batch.batch_values.resize(batch.batch_keys.size());
+    batch.status.resize(batch.batch_keys.size());
+    _db->multi_get(shard_id,
+                   batch.batch_keys.size(),
+                   batch.batch_keys.data(),
+                   batch.batch_values.data(),
+                   batch.status.data());
+    loaded_keys.clear();
+    for (size_t idx = 0; idx < batch.status.size(); ++idx) {
+      if (!batch.status[idx].ok()) {
+        continue;
+      }
+      auto& feature_value = local_shard[missed_keys[begin + idx]];
+      size_t data_size = batch.batch_values[idx].size() / sizeof(float);
+      feature_value.resize(data_size);
+      memcpy(feature_value.data(),
+             batch.batch_values[idx].data(),
+             data_size * sizeof(float));
+      loaded_keys.push_back(batch.batch_keys[idx]);
+    }
+    if (!loaded_keys.empty()) {
+      _db->del_batch(shard_id, loaded_keys);
+      loaded += loaded_keys.size();
+    }
+  }
+  _loaded_keys += loaded;
+  return loaded;
+}
+
+void SSDSparseTable::ScheduleEviction(int shard_id) {
+  if (!OnlineTiering() ||
+      _local_shards[shard_id].size() <= _mem_capacity_per_shard ||
+      _evict_pending[shard_id].exchange(true)) {
+    return;
+  }
+  // queued after the current request, which does not wait for it
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id]() -> int {
+        EvictColdKeys(shard_id);
+        _evict_pending[shard_id].store(false);
+        return 0;
+      });
+}
+
+size_t SSDSparseTable::EvictColdKeys(int shard_id) {
+  auto& local_shard = _local_shards[shard_id];
+  if (local_shard.size() <= _mem_capacity_per_shard) {
+    return 0;
+  }
+  size_t target_size = static_cast<size_t>(
+      _mem_capacity_per_shard * (1.0 - FLAGS_pserver_ssd_evict_ratio));
+  size_t num_evict = local_shard.size() - target_size;
+  // Examine the buckets after the ones examined by the former eviction, so
+  // that every key is compared with others once in a while.
+  auto& sketch = _hot_key_sketches[shard_id];
+  size_t& cursor = _evict_cursors[shard_id];
+  size_t num_examine = std::min(local_shard.size(), num_evict * 4);
+  std::vector<std::pair<uint8_t, uint64_t>> candidates;
+  candidates.reserve(num_examine);
+  for (size_t n = 0;
+       n < CTR_SPARSE_SHARD_BUCKET_NUM && candidates.size() < num_examine;
+       ++n) {
+    for (auto it = local_shard.begin(cursor); it != local_shard.end(cursor);
+         ++it) {
+      candidates.emplace_back(sketch.Estimate(it.key()), it.key());
+    }
+    cursor = (cursor + 1) % CTR_SPARSE_SHARD_BUCKET_NUM;
+  }
+  num_evict = std::min(num_evict, candidates.size());
+  std::nth_element(candidates.begin(),
+                   candidates.begin() + num_evict,
+                   candidates.end());
+  candidates.resize(num_evict);
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](const std::pair<uint8_t, uint64_t>& a,
+               const std::pair<uint8_t, uint64_t>& b) {
+              return a.second < b.second;
+            });
+
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  for (size_t begin = 0; begin < num_evict; begin += kSSDBatchSize) {
+    size_t end = std::min(begin + kSSDBatchSize, num_evict);
+    ssd_keys.clear();
+    ssd_values.clear();
+    for (size_t i = begin; i < end; ++i) {
+      auto it = local_shard.find(candidates[i].second);
+      ssd_keys.emplace_back(reinterpret_cast<char*>(&candidates[i].second),
+                            sizeof(uint64_t));
+      ssd_values.emplace_back(reinterpret_cast<char*>(it.value().data()),
+                              it.value().size() * sizeof(float));
+    }
+    _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+    for (size_t i = begin; i < end; ++i) {
+      local_shard.quick_erase(local_shard.find(candidates[i].second));
+    }
+  }
+  _evicted_keys += num_evict;
+  VLOG(3) << "SSDSparseTable evict shard:" << shard_id
+          << " evicted:" << num_evict << " mem size:" << local_shard.size()
+          << " total evicted:" << _evicted_keys.load()
+          << " total loaded:" << _loaded_keys.load();
+  return num_evict;
+}
+
+void SSDSparseTable::WaitShardTasks() {
+  if (!OnlineTiering()) {
+    return;
+  }
+  std::vector<std::future<int>> tasks;
+  for (auto& shards_task : _shards_task_pool) {
+    tasks.push_back(shards_task->enqueue([]() -> int { return 0; }));
+  }
+  for (auto& task : tasks) {
+    task.wait();
+  }
+}
+
 int32_t SSDSparseTable::Shrink(const std::string& param) {
+  WaitShardTasks();
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -571,6 +770,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
 }
 
 int32_t SSDSparseTable::UpdateTable() {
+  WaitShardTasks();
   int count = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     auto& shard = _local_shards[i];
@@ -604,6 +804,7 @@ int64_t SSDSparseTable::LocalSize() {
 
 int32_t SSDSparseTable::Save(const std::string& path,
                              const std::string& param) {
+  WaitShardTasks();
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -633,6 +834,7 @@ int32_t SSDSparseTable::Save(const std::string& path,
 int32_t SSDSparseTable::Save_v2(const std::string& path,
                                 const std::string& param) {
   std::lock_guard<std::mutex> guard(_table_mutex);
+  WaitShardTasks();
 #ifdef PADDLE_WITH_HETERPS
   int save_param = atoi(param.c_str());
   int32_t ret = 0;
@@ -2423,6 +2625,7 @@ int64_t SSDSparseTable::CacheShuffle(
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>&
         shuffled_channel,
     const std::vector<Table*>& table_ptrs) {
+  WaitShardTasks();
   LOG(INFO) << "cache shuffle with cache threshold: " << cache_threshold
             << " param:" << param;
   int save_param = atoi(param.c_str());  // batch_model:0  xbox:1
@@ -2535,6 +2738,7 @@ int32_t SSDSparseTable::SaveCache(
     const std::string& param,
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>&
         shuffled_channel) {
+  WaitShardTasks();
   if (_shard_idx >= _config.sparse_table_cache_file_num()) {
     return 0;
   }
@@ -2581,6 +2785,7 @@ int32_t SSDSparseTable::SaveCache(
 
 int32_t SSDSparseTable::Load(const std::string& path,
                              const std::string& param) {
+  WaitShardTasks();
   VLOG(0) << "LOAD FLAGS_rocksdb_path:" << FLAGS_rocksdb_path;
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(::paddle::string::format_string(
@@ -3052,6 +3257,7 @@ std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
 
 int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
   std::lock_guard<std::mutex> guard(_table_mutex);
+  WaitShardTasks();
   VLOG(0) << "cache_table";
   std::atomic<uint32_t> count{0};
   std::vector<std::future<int>> tasks;
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/depends/hot_key_sketch.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 
@@ -88,6 +89,7 @@ class SSDSparseTable : public MemorySparseTable {
   int32_t Flush() override { return 0; }
   int32_t Shrink(const std::string& param) override;
   void Clear() override {
+    WaitShardTasks();
     for (int i = 0; i < _real_local_shard_num; ++i) {
       _local_shards[i].clear();
     }
@@ -135,6 +137,22 @@ class SSDSparseTable : public MemorySparseTable {
   void SetDayId(int day_id) override;
 
  private:
+  // Online tiering: the keys of a shard which are not in memory are moved
+  // from rocksdb to memory in batches before they are pulled or pushed, and
+  // when a shard holds more keys than its memory capacity, the keys with the
+  // lowest decayed access frequency are moved to rocksdb by a task running
+  // on the shard thread after the current request.
+  bool OnlineTiering() const { return !_hot_key_sketches.empty(); }
+  // run on the shard thread
+  size_t LoadFromSSD(int shard_id,
+                     const std::vector<std::pair<uint64_t, int>>& keys);
+  void TouchKeys(int shard_id,
+                 const std::vector<std::pair<uint64_t, int>>& keys);
+  void ScheduleEviction(int shard_id);
+  size_t EvictColdKeys(int shard_id);
+  // wait the tasks queued on the shard threads, e.g. the evictions
+  void WaitShardTasks();
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
@@ -145,6 +163,14 @@ class SSDSparseTable : public MemorySparseTable {
   paddle::framework::AfsWrapper _afs_wrapper;  // afs api wrapper
 #endif
   bool _use_afs_api = false;
+
+  size_t _mem_capacity_per_shard{0};
+  std::vector<HotKeySketch> _hot_key_sketches;
+  // next bucket examined by the eviction of each shard
+  std::vector<size_t> _evict_cursors;
+  std::unique_ptr<std::atomic<bool>[]> _evict_pending;
+  std::atomic<uint64_t> _evicted_keys{0};
+  std::atomic<uint64_t> _loaded_keys{0};
 };
 
 }  // namespace distributed
@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/common/afs_warpper.h"
@@ -61,6 +62,7 @@ struct TableContext {
   TablePullContext pull_context;
   TablePushContext push_context;
   size_t num;
+  size_t offset = 0;  // for dense, the index of the first of the num values
   bool use_ptr = false;
   uint32_t trainer_id;  // for GEO and global step
   int shard_id;         // for gpups
@@ -145,6 +147,32 @@ class Table {
 
   virtual double GetCacheThreshold() { return 0.0; }
 
+  // for the online resharding of the sparse tables, shard_id is the global
+  // shard key % shard_num of the keys. The values are exported as the keys,
+  // the size of each value and the values one after another.
+  virtual int32_t ExportShard(uint32_t shard_id UNUSED,
+                              std::vector<uint64_t> *keys UNUSED,
+                              std::vector<uint32_t> *dims UNUSED,
+                              std::vector<float> *values UNUSED) {
+    return -1;
+  }
+  // exports the values of the existing keys of keys
+  virtual int32_t ExportValues(const uint64_t *keys UNUSED,
+                               size_t num UNUSED,
+                               std::vector<uint64_t> *exported_keys UNUSED,
+                               std::vector<uint32_t> *dims UNUSED,
+                               std::vector<float> *values UNUSED) {
+    return -1;
+  }
+  // creates or overwrites the values of keys
+  virtual int32_t ImportValues(const uint64_t *keys UNUSED,
+                               const uint32_t *dims UNUSED,
+                               const float *values UNUSED,
+                               size_t num UNUSED) {
+    return -1;
+  }
+  virtual int32_t DropShard(uint32_t shard_id UNUSED) { return -1; }
+
   virtual int32_t SetShard(size_t shard_idx, size_t shard_num) {
     _shard_idx = shard_idx;
     _shard_num = shard_num;
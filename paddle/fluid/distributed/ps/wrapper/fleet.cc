@@ -18,10 +18,27 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/service/communicator/communicator.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/framework/fleet/feasign_dedup.h"
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+#include "paddle/fluid/framework/fleet/ps_gpu_wrapper.h"
+#endif
 
 namespace paddle {
 namespace distributed {
 
+namespace {
+// The values of the last pass are written back to the cpu tables in
+// background with FLAGS_gpugraph_incremental_pass_build, which must be done
+// before the tables are saved. They are released if the tables are to be
+// shrunk or cleared, for they keep the pointers of the values.
+void WaitGpuEndPass(bool release_values) {
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+  framework::PSGPUWrapper::GetInstance()->WaitEndPass(release_values);
+#endif
+}
+}  // namespace
+
+using framework::FeasignDedup;
 using framework::ProgramDesc;
 using framework::VarDesc;
 using framework::Variable;
@@ -306,21 +323,26 @@ void FleetWrapper::PullSparseVarsSync(
     pull_result_ptr.push_back(t.data());
   }
   bool training = true;
-  auto status = pserver_ptr_->_worker_ptr->PullSparse(pull_result_ptr.data(),
-                                                      table_id,
-                                                      fea_keys->data(),
-                                                      fea_keys->size(),
-                                                      training);
-  pull_sparse_status.push_back(std::move(status));
-  for (auto& t : pull_sparse_status) {
-    t.wait();
-    auto status = t.get();
-    if (status != 0) {
-      LOG(ERROR) << "fleet pull sparse failed, status[" << status << "]";
-      sleep(sleep_seconds_before_fail_exit_);
-      exit(-1);
-    }
-  }
+  FeasignDedup::Pull(
+      fea_keys->data(),
+      pull_result_ptr.data(),
+      fea_keys->size(),
+      fea_value_dim,
+      [&](float** values, const uint64_t* keys, size_t num) {
+        auto status = pserver_ptr_->_worker_ptr->PullSparse(
+            values, table_id, keys, num, training);
+        pull_sparse_status.push_back(std::move(status));
+        for (auto& t : pull_sparse_status) {
+          t.wait();
+          auto status = t.get();
+          if (status != 0) {
+            LOG(ERROR) << "fleet pull sparse failed, status[" << status << "]";
+            sleep(sleep_seconds_before_fail_exit_);
+            exit(-1);
+          }
+        }
+        return 0;
+      });
 }
 
 // is_training is true means training, false means inference, the behavior is
@@ -385,13 +407,17 @@ void FleetWrapper::PullSparseToTensorSync(
     }
   }
 
-  auto status = worker_ptr_->PullSparse(pull_result_ptr.data(),
-                                        table_id,
-                                        fea_keys.data(),
-                                        fea_keys.size(),
-                                        is_training);
-  status.wait();
-  auto ret = status.get();
+  auto ret = FeasignDedup::Pull(
+      fea_keys.data(),
+      pull_result_ptr.data(),
+      fea_keys.size(),
+      fea_dim,
+      [&](float** values, const uint64_t* keys, size_t num) {
+        auto status =
+            worker_ptr_->PullSparse(values, table_id, keys, num, is_training);
+        status.wait();
+        return status.get();
+      });
   if (ret != 0) {
     LOG(ERROR) << "fleet pull sparse failed, status[" << ret << "]";
     sleep(sleep_seconds_before_fail_exit_);
@@ -762,6 +788,7 @@ void FleetWrapper::LoadModelOneTable(const uint64_t table_id,
 }
 
 void FleetWrapper::SaveModel(const std::string& path, const int mode) {
+  WaitGpuEndPass(false);
   auto ret = worker_ptr_->Save(path, std::to_string(mode));
   ret.wait();
   int32_t feasign_cnt = ret.get();
@@ -773,6 +800,7 @@ void FleetWrapper::SaveModel(const std::string& path, const int mode) {
 void FleetWrapper::SaveModelOneTable(const uint64_t table_id,
                                      const std::string& path,
                                      const int mode) {
+  WaitGpuEndPass(false);
   auto ret = worker_ptr_->Save(table_id, path, std::to_string(mode));
   ret.wait();
   if (ret.get() != 0) {
@@ -802,6 +830,7 @@ void FleetWrapper::PrintTableStat(const uint64_t table_id) {
 void FleetWrapper::SaveCacheTable(const uint64_t table_id,
                                   uint16_t pass_id,
                                   size_t threshold) {
+  WaitGpuEndPass(false);
   auto ret = worker_ptr_->SaveCacheTable(table_id, pass_id, threshold);
   ret.wait();
   int32_t err_code = ret.get();
@@ -811,6 +840,7 @@ void FleetWrapper::SaveCacheTable(const uint64_t table_id,
 }
 
 void FleetWrapper::ShrinkSparseTable(int table_id, int threshold) {
+  WaitGpuEndPass(true);
   auto ret = worker_ptr_->Shrink(table_id, std::to_string(threshold));
   ret.wait();
   int32_t err_code = ret.get();
@@ -820,11 +850,13 @@ void FleetWrapper::ShrinkSparseTable(int table_id, int threshold) {
 }
 
 void FleetWrapper::ClearModel() {
+  WaitGpuEndPass(true);
   auto ret = pserver_ptr_->_worker_ptr->Clear();
   ret.wait();
 }
 
 void FleetWrapper::ClearOneTable(const uint64_t table_id) {
+  WaitGpuEndPass(true);
   auto ret = pserver_ptr_->_worker_ptr->Clear(table_id);
   ret.wait();
 }
@@ -941,6 +973,7 @@ void FleetWrapper::CacheShuffle(int table_id,
 int32_t FleetWrapper::SaveCache(int table_id,
                                 const std::string& path,
                                 const int mode) {
+  WaitGpuEndPass(false);
   auto ret = worker_ptr_->SaveCache(table_id, path, std::to_string(mode));
   ret.wait();
   int32_t feasign_cnt = ret.get();
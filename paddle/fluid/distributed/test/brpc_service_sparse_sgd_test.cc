@@ -67,9 +67,13 @@ void InitTensorsOnClient(framework::Scope* scope,
   for (int64_t i = 0; i < g_size; ++i) x_g_ptr[i] = 1.0;
 }
 
+bool use_rdma_ = false;
+
 void GetDownpourSparseTableProto(
     ::paddle::distributed::TableParameter* sparse_table_proto) {
   sparse_table_proto->set_table_id(0);
+  // falls back to TCP if brpc is not built with RDMA
+  sparse_table_proto->set_use_rdma(use_rdma_);
   sparse_table_proto->set_table_class("MemorySparseTable");
   sparse_table_proto->set_shard_num(10);
   ::paddle::distributed::TableAccessorParameter* accessor_config =
@@ -195,6 +199,7 @@ void RunClient(std::map<uint64_t, std::vector<paddle::distributed::Region>>&
 void RunBrpcPushSparse() {
   setenv("http_proxy", "", 1);
   setenv("https_proxy", "", 1);
+  host_sign_list_.clear();
   auto ph_host = paddle::distributed::PSHost(ip_, port_, 0);
   host_sign_list_.push_back(ph_host.SerializeToString());
 
@@ -309,3 +314,10 @@ void RunBrpcPushSparse() {
 }
 
 TEST(RunBrpcPushSparse, Run) { RunBrpcPushSparse(); }
+
+TEST(RunBrpcPushSparse, RunOverRdma) {
+  use_rdma_ = true;
+  port_ = 4210;
+  RunBrpcPushSparse();
+  use_rdma_ = false;
+}
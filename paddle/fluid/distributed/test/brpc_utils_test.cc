@@ -135,3 +135,18 @@ TEST(MultiVarMsgCPU, Run) {
 //   RunMultiVarMsg(place);
 // }
 // #endif
+
+TEST(UseBrpcRdma, Run) {
+  brpc::ChannelOptions channel_options;
+  brpc::ServerOptions server_options;
+#ifdef PADDLE_WITH_BRPC_RDMA
+  EXPECT_TRUE(paddle::distributed::UseBrpcRdma(&channel_options));
+  EXPECT_TRUE(channel_options.use_rdma);
+  EXPECT_TRUE(paddle::distributed::UseBrpcRdma(&server_options));
+  EXPECT_TRUE(server_options.use_rdma);
+#else
+  // keeps TCP
+  EXPECT_FALSE(paddle::distributed::UseBrpcRdma(&channel_options));
+  EXPECT_FALSE(paddle::distributed::UseBrpcRdma(&server_options));
+#endif
+}
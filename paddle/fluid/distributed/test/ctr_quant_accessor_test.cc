@@ -0,0 +1,150 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ctr_quant_accessor.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle::distributed {
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdaGradSGDRule);
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, StdAdaGradSGDRule);
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdamSGDRule);
+
+TableAccessorParameter gen_quant_param(const std::string& embedx_sgd_rule,
+                                       SparseValueCompressType embedx_type) {
+  TableAccessorParameter param;
+  param.set_accessor_class("CtrQuantAccessor");
+  param.set_embedx_dim(8);
+  param.set_embedx_threshold(0);
+  param.mutable_ctr_accessor_param()->set_embedx_storage_type(embedx_type);
+  param.mutable_ctr_accessor_param()->set_embedx_sgd_storage_type(
+      SPARSE_VALUE_BF16);
+
+  param.mutable_embed_sgd_param()->set_name("SparseAdaGradSGDRule");
+  auto* embed_param = param.mutable_embed_sgd_param()->mutable_adagrad();
+  embed_param->set_learning_rate(0.1);
+  embed_param->set_initial_range(0.3);
+  embed_param->set_initial_g2sum(0.0);
+  embed_param->add_weight_bounds(-10.0);
+  embed_param->add_weight_bounds(10.0);
+
+  param.mutable_embedx_sgd_param()->set_name(embedx_sgd_rule);
+  if (embedx_sgd_rule == "SparseAdamSGDRule") {
+    auto* adam_param = param.mutable_embedx_sgd_param()->mutable_adam();
+    adam_param->set_learning_rate(0.001);
+    adam_param->set_initial_range(0.3);
+    adam_param->set_beta1_decay_rate(0.9);
+    adam_param->set_beta2_decay_rate(0.999);
+    adam_param->set_ada_epsilon(1e-8);
+    adam_param->add_weight_bounds(-10.0);
+    adam_param->add_weight_bounds(10.0);
+  } else {
+    auto* adagrad_param = param.mutable_embedx_sgd_param()->mutable_adagrad();
+    adagrad_param->set_learning_rate(0.1);
+    adagrad_param->set_initial_range(0.3);
+    adagrad_param->set_initial_g2sum(0.0);
+    adagrad_param->add_weight_bounds(-10.0);
+    adagrad_param->add_weight_bounds(10.0);
+  }
+  return param;
+}
+
+// runs the same pushes on a CtrCommonAccessor and a CtrQuantAccessor, and
+// compares the pulled values
+void CheckAgainstCommon(const std::string& embedx_sgd_rule,
+                        SparseValueCompressType embedx_type,
+                        float tolerance) {
+  auto param = gen_quant_param(embedx_sgd_rule, embedx_type);
+  CtrQuantAccessor quant;
+  ASSERT_EQ(quant.Configure(param), 0);
+  ASSERT_EQ(quant.Initialize(), 0);
+  // embedx and its per-dim state take less memory
+  ASSERT_LT(quant.GetAccessorInfo().size,
+            quant.common_feature_value.Size() * 3 / 4);
+
+  CtrCommonAccessor common;
+  param.set_accessor_class("CtrCommonAccessor");
+  ASSERT_EQ(common.Configure(param), 0);
+  ASSERT_EQ(common.Initialize(), 0);
+  ASSERT_EQ(quant.GetAccessorInfo().select_dim,
+            common.GetAccessorInfo().select_dim);
+
+  std::vector<float> quant_value(quant.GetAccessorInfo().dim);
+  std::vector<float> common_value(common.GetAccessorInfo().dim);
+  float* quant_ptr = quant_value.data();
+  float* common_ptr = common_value.data();
+  ASSERT_EQ(quant.Create(&quant_ptr, 1), 0);
+  // start from the same weights
+  quant.Dequantize(quant_ptr, common_ptr, true);
+
+  std::vector<float> push(quant.GetAccessorInfo().update_dim);
+  const float* push_ptr = push.data();
+  for (int step = 0; step < 10; ++step) {
+    for (size_t i = 0; i < push.size(); ++i) {
+      push[i] = 0.1f * std::sin(static_cast<float>(step * 7 + i));
+    }
+    push[CtrCommonAccessor::CtrCommonPushValue::ShowIndex()] = 1;
+    push[CtrCommonAccessor::CtrCommonPushValue::ClickIndex()] = step % 2;
+    ASSERT_EQ(quant.Update(&quant_ptr, &push_ptr, 1), 0);
+    ASSERT_EQ(common.Update(&common_ptr, &push_ptr, 1), 0);
+  }
+
+  std::vector<float> quant_pull(quant.GetAccessorInfo().select_dim);
+  std::vector<float> common_pull(common.GetAccessorInfo().select_dim);
+  float* quant_pull_ptr = quant_pull.data();
+  float* common_pull_ptr = common_pull.data();
+  const float* quant_cptr = quant_ptr;
+  const float* common_cptr = common_ptr;
+  ASSERT_EQ(quant.Select(&quant_pull_ptr, &quant_cptr, 1), 0);
+  ASSERT_EQ(common.Select(&common_pull_ptr, &common_cptr, 1), 0);
+  for (int i = 0; i < CtrCommonAccessor::CtrCommonPullValue::EmbedxWIndex();
+       ++i) {
+    ASSERT_FLOAT_EQ(quant_pull[i], common_pull[i]);
+  }
+  for (size_t i = CtrCommonAccessor::CtrCommonPullValue::EmbedxWIndex();
+       i < quant_pull.size();
+       ++i) {
+    ASSERT_NEAR(quant_pull[i], common_pull[i], tolerance);
+  }
+
+  // saved in the text format of CtrCommonAccessor
+  std::string text = quant.ParseToString(quant_ptr, quant_value.size());
+  std::vector<float> loaded(common.GetAccessorInfo().dim);
+  ASSERT_EQ(common.ParseFromString(text, loaded.data()),
+            static_cast<int>(loaded.size()));
+  std::vector<float> reloaded(quant.GetAccessorInfo().dim);
+  ASSERT_EQ(quant.ParseFromString(text, reloaded.data()),
+            static_cast<int>(reloaded.size()));
+  ASSERT_EQ(quant.ParseToString(reloaded.data(), reloaded.size()), text);
+}
+
+TEST(CtrQuantAccessor, adagrad_fp16) {
+  CheckAgainstCommon("StdAdaGradSGDRule", SPARSE_VALUE_FP16, 2e-2);
+}
+
+TEST(CtrQuantAccessor, shared_adagrad_int8) {
+  CheckAgainstCommon("SparseAdaGradSGDRule", SPARSE_VALUE_INT8, 5e-2);
+}
+
+TEST(CtrQuantAccessor, adam_bf16) {
+  CheckAgainstCommon("SparseAdamSGDRule", SPARSE_VALUE_BF16, 2e-2);
+}
+
+}  // namespace paddle::distributed
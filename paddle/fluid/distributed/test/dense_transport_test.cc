@@ -0,0 +1,103 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/dense_transport.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TableParameter gen_table_param(uint32_t chunk_size,
+                               SparseValueCompressType pull_type,
+                               SparseValueCompressType push_type) {
+  TableParameter param;
+  param.set_table_id(0);
+  param.set_type(PS_DENSE_TABLE);
+  param.mutable_dense_transport()->set_chunk_size(chunk_size);
+  param.mutable_dense_transport()->set_pull_value_type(pull_type);
+  param.mutable_dense_transport()->set_push_grad_type(push_type);
+  return param;
+}
+
+TEST(DenseTransportCodec, fp32_is_raw) {
+  auto codec = DenseTransportCodec::Create(
+      gen_table_param(0, SPARSE_VALUE_FP32, SPARSE_VALUE_FP32));
+  ASSERT_EQ(codec, nullptr);
+}
+
+TEST(DenseTransportCodec, chunk_size) {
+  auto codec = DenseTransportCodec::Create(
+      gen_table_param(1000, SPARSE_VALUE_FP32, SPARSE_VALUE_FP32));
+  ASSERT_NE(codec, nullptr);
+  ASSERT_EQ(codec->ChunkSize(2500), 1000u);
+  // a shard smaller than a chunk is sent in one request
+  ASSERT_EQ(codec->ChunkSize(600), 600u);
+  ASSERT_EQ(codec->PullValueSize(10), 10 * sizeof(float));
+
+  codec = DenseTransportCodec::Create(
+      gen_table_param(0, SPARSE_VALUE_FP16, SPARSE_VALUE_FP32));
+  ASSERT_EQ(codec->ChunkSize(2500), 2500u);
+}
+
+TEST(DenseTransportCodec, pull_values) {
+  std::vector<float> values(100);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 0.37f * static_cast<float>(i) - 1.5f;
+  }
+  for (auto type : {SPARSE_VALUE_FP16, SPARSE_VALUE_BF16}) {
+    auto codec = DenseTransportCodec::Create(
+        gen_table_param(0, type, SPARSE_VALUE_FP32));
+    ASSERT_NE(codec, nullptr);
+    ASSERT_EQ(codec->PullValueSize(values.size()),
+              values.size() * sizeof(uint16_t));
+    std::vector<char> encoded(codec->PullValueSize(values.size()));
+    std::vector<float> decoded(values.size());
+    codec->EncodePullValues(values.data(), values.size(), encoded.data());
+    codec->DecodePullValues(encoded.data(), values.size(), decoded.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_NEAR(decoded[i], values[i], 0.25);
+    }
+  }
+}
+
+TEST(DenseTransportCodec, push_grads_error_feedback) {
+  auto codec = DenseTransportCodec::Create(
+      gen_table_param(4, SPARSE_VALUE_FP32, SPARSE_VALUE_FP16));
+  ASSERT_NE(codec, nullptr);
+
+  const size_t dim = 8;
+  std::vector<float> grads(dim, 1e-4f + 1e-8f);
+  std::vector<double> sum(dim, 0.0);
+  std::vector<char> encoded(codec->PushGradSize(4));
+  std::vector<float> decoded(4);
+  const int steps = 1000;
+  for (int step = 0; step < steps; ++step) {
+    // the two chunks keep their own rounding errors
+    for (size_t offset = 0; offset < dim; offset += 4) {
+      codec->EncodePushGrads(
+          offset, grads.data() + offset, 4, encoded.data());
+      codec->DecodePushGrads(encoded.data(), 4, decoded.data());
+      for (size_t i = 0; i < 4; ++i) {
+        sum[offset + i] += decoded[i];
+      }
+    }
+  }
+  for (size_t i = 0; i < dim; ++i) {
+    ASSERT_NEAR(sum[i], static_cast<double>(grads[i]) * steps, 1e-6);
+  }
+}
+
+}  // namespace paddle::distributed
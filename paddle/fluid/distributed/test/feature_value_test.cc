@@ -45,4 +45,84 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(FeatureValueArena, ShardValueArena) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  shard.enable_value_arena();
+  ASSERT_TRUE(shard.value_arena() != nullptr);
+
+  const size_t value_size = 9;
+  const uint64_t key_num = 100000;
+  for (uint64_t key = 0; key < key_num; ++key) {
+    auto& feature_value = shard[key];
+    feature_value.resize(value_size);
+    ASSERT_TRUE(feature_value.in_arena());
+    for (size_t i = 0; i < value_size; ++i) {
+      feature_value.data()[i] = static_cast<float>(key + i);
+    }
+  }
+  // resize keeps the prefix and zero-fills the tail, like std::vector
+  auto& extended = shard[0];
+  extended.resize(value_size * 2);
+  ASSERT_EQ(extended.size(), value_size * 2);
+  ASSERT_FLOAT_EQ(extended.data()[value_size - 1], value_size - 1);
+  ASSERT_FLOAT_EQ(extended.data()[value_size], 0.0);
+  extended.resize(value_size);
+
+  size_t reserved = shard.value_arena()->ReservedBytes();
+  for (uint64_t key = 0; key < key_num; ++key) {
+    if (key % 10 != 0) {
+      shard.erase(key);
+    }
+  }
+  size_t released = shard.compact_values();
+  ASSERT_GT(released, 0UL);
+  ASSERT_EQ(shard.value_arena()->ReservedBytes(), reserved - released);
+
+  ASSERT_EQ(shard.size(), key_num / 10);
+  for (uint64_t key = 0; key < key_num; key += 10) {
+    auto itr = shard.find(key);
+    ASSERT_TRUE(itr != shard.end());
+    ASSERT_EQ(itr.value().size(), value_size);
+    for (size_t i = 0; i < value_size; ++i) {
+      ASSERT_FLOAT_EQ(itr.value().data()[i], static_cast<float>(key + i));
+    }
+  }
+}
+
+TEST(BENCHMARK, FindBatch) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  const size_t num = 100;
+  for (uint64_t key = 0; key < num; key += 2) {
+    auto& feature_value = shard[key];
+    feature_value.resize(3);
+    feature_value.data()[0] = static_cast<float>(key);
+  }
+
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < num; ++key) {
+    keys.push_back(key);
+  }
+  // duplicated keys in one batch
+  keys.push_back(4);
+  keys.push_back(4);
+  std::vector<FixedFeatureValue*> values(keys.size());
+  shard.find_batch(keys.data(), keys.size(), values.data());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] % 2 == 1) {
+      ASSERT_TRUE(values[i] == nullptr);
+    } else {
+      ASSERT_TRUE(values[i] == shard.find(keys[i]).value_ptr());
+      ASSERT_FLOAT_EQ(values[i]->data()[0], static_cast<float>(keys[i]));
+    }
+  }
+
+  // block sizes not dividing the number of keys
+  std::vector<FixedFeatureValue*> values2(keys.size());
+  shard.find_batch(keys.data(), keys.size(), values2.data(), 3);
+  ASSERT_TRUE(values == values2);
+  shard.find_batch(keys.data(), 0, values2.data());
+}
+
 }  // namespace paddle::distributed
@@ -0,0 +1,156 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/communicator/communicator.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+// Sets the members that InitImpl would set, without a ps client.
+class TestGeoCommunicator : public GeoCommunicator {
+ public:
+  TestGeoCommunicator(framework::Scope *recv_scope, int max_merge_var_num) {
+    recv_scope_ = recv_scope;
+    trainers_ = 1;
+    max_merge_var_num_ = max_merge_var_num;
+    old_scope_ = std::make_shared<framework::Scope>();
+    delta_scope_ = std::make_shared<framework::Scope>();
+  }
+};
+
+struct GeoSyncFlagsGuard {
+  GeoSyncFlagsGuard()
+      : adaptive_sync(FLAGS_communicator_geo_adaptive_sync),
+        min_merge_var_num(FLAGS_communicator_geo_min_merge_var_num),
+        max_merge_var_num(FLAGS_communicator_geo_max_merge_var_num),
+        target_delta_ratio(FLAGS_communicator_geo_target_delta_ratio),
+        skip_delta_ratio(FLAGS_communicator_geo_skip_delta_ratio) {}
+  ~GeoSyncFlagsGuard() {
+    FLAGS_communicator_geo_adaptive_sync = adaptive_sync;
+    FLAGS_communicator_geo_min_merge_var_num = min_merge_var_num;
+    FLAGS_communicator_geo_max_merge_var_num = max_merge_var_num;
+    FLAGS_communicator_geo_target_delta_ratio = target_delta_ratio;
+    FLAGS_communicator_geo_skip_delta_ratio = skip_delta_ratio;
+  }
+
+  bool adaptive_sync;
+  int32_t min_merge_var_num;
+  int32_t max_merge_var_num;
+  double target_delta_ratio;
+  double skip_delta_ratio;
+};
+
+phi::DenseTensor *InitParam(framework::Scope *scope,
+                            const std::string &name,
+                            const std::vector<float> &values,
+                            int64_t dim) {
+  auto *tensor = scope->Var(name)->GetMutable<phi::DenseTensor>();
+  tensor->Resize({static_cast<int64_t>(values.size()) / dim, dim});
+  auto *data = tensor->mutable_data<float>(phi::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+  return tensor;
+}
+
+}  // namespace
+
+TEST(GeoCommunicator, UpdateMergeNum) {
+  GeoSyncFlagsGuard guard;
+  framework::Scope recv_scope;
+  TestGeoCommunicator communicator(&recv_scope, 8);
+  const std::string varname = "emb.block0";
+
+  // the fixed merge num without the adaptive sync
+  FLAGS_communicator_geo_adaptive_sync = false;
+  EXPECT_EQ(communicator.GetMergeNum(varname), 8);
+
+  FLAGS_communicator_geo_adaptive_sync = true;
+  FLAGS_communicator_geo_min_merge_var_num = 2;
+  FLAGS_communicator_geo_max_merge_var_num = 64;
+  FLAGS_communicator_geo_target_delta_ratio = 0.01;
+  communicator.geo_sync_states_[varname].merge_num = 8;
+  EXPECT_EQ(communicator.GetMergeNum(varname), 8);
+
+  // at most doubles for a small delta
+  communicator.UpdateMergeNum(varname, 0.0001, 0.0);
+  EXPECT_EQ(communicator.GetMergeNum(varname), 16);
+  // sqrt(0.01 / 0.04) for a large delta
+  communicator.UpdateMergeNum(varname, 0.04, 0.0);
+  EXPECT_EQ(communicator.GetMergeNum(varname), 8);
+  // the first send is the fastest one
+  communicator.UpdateMergeNum(varname, 0.01, 100.0);
+  EXPECT_EQ(communicator.GetMergeNum(varname), 8);
+  // a send 4 times slower than the fastest one is backlogged
+  communicator.UpdateMergeNum(varname, 0.01, 400.0);
+  EXPECT_EQ(communicator.GetMergeNum(varname), 16);
+  communicator.UpdateMergeNum(varname, 0.01, 100.0);
+  EXPECT_EQ(communicator.GetMergeNum(varname), 16);
+
+  // within the min and max merge num
+  for (int i = 0; i < 10; ++i) {
+    communicator.UpdateMergeNum(varname, 0.0, 0.0);
+  }
+  EXPECT_EQ(communicator.GetMergeNum(varname), 64);
+  for (int i = 0; i < 10; ++i) {
+    communicator.UpdateMergeNum(varname, 1.0, 0.0);
+  }
+  EXPECT_EQ(communicator.GetMergeNum(varname), 2);
+}
+
+TEST(GeoCommunicator, SkipSmallDelta) {
+  GeoSyncFlagsGuard guard;
+  FLAGS_communicator_geo_adaptive_sync = true;
+  FLAGS_communicator_geo_min_merge_var_num = 1;
+  FLAGS_communicator_geo_max_merge_var_num = 64;
+  FLAGS_communicator_geo_target_delta_ratio = 0.04;
+  FLAGS_communicator_geo_skip_delta_ratio = 0.1;
+
+  framework::Scope recv_scope;
+  TestGeoCommunicator communicator(&recv_scope, 8);
+  const std::string varname = "emb.block0";
+  communicator.geo_sync_states_[varname].merge_num = 8;
+
+  const std::vector<float> old_values = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<float> latest_values = old_values;
+  for (auto &value : latest_values) {
+    value *= 1.01f;
+  }
+  InitParam(&recv_scope, "emb", latest_values, 2);
+  auto *old = InitParam(communicator.old_scope_.get(), "emb", old_values, 2);
+
+  // All the rows have a delta of 1% of the param, below the skip ratio, so
+  // nothing is pushed and the ps client is not used.
+  std::vector<int64_t> ids = {0, 2, 3};
+  communicator.SendSparse(varname, ids, 0, 0);
+
+  // the old values are kept to accumulate the delta for a later send
+  const float *old_data = old->data<float>();
+  for (size_t i = 0; i < old_values.size(); ++i) {
+    EXPECT_FLOAT_EQ(old_data[i], old_values[i]);
+  }
+  auto &delta = communicator.delta_scope_->FindVar(varname)
+                    ->Get<phi::SelectedRows>();
+  EXPECT_TRUE(delta.rows().empty());
+  EXPECT_EQ(delta.value().dims()[0], 0);
+  // the merge num still adapts to the delta ratio of the skipped send,
+  // sqrt(0.04 / 0.01) = 2
+  EXPECT_EQ(communicator.GetMergeNum(varname), 16);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,76 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_edge.h"
+
+namespace distributed = paddle::distributed;
+
+std::vector<int64_t> get_ids(distributed::GraphEdgeBlob* blob) {
+  std::vector<int64_t> ids;
+  for (size_t i = 0; i < blob->size(); i++) {
+    ids.push_back(blob->get_id(i));
+  }
+  return ids;
+}
+
+TEST(CompressedGraphEdgeBlob, Run) {
+  std::mt19937_64 rng(2024);
+  distributed::GraphEdgeBlob blob;
+  std::vector<int64_t> ids;
+  // dense ids with duplicates, and a few far away ones
+  for (int i = 0; i < 1000; i++) {
+    ids.push_back(100000 + rng() % 5000);
+  }
+  ids.push_back(0);
+  ids.push_back(-1);
+  ids.push_back(int64_t(1) << 62);
+  for (auto id : ids) {
+    blob.add_edge(id, 1.0);
+  }
+
+  std::unique_ptr<distributed::CompressedGraphEdgeBlob> compressed(
+      distributed::CompressedGraphEdgeBlob::compress(&blob));
+  ASSERT_NE(compressed, nullptr);
+  ASSERT_TRUE(compressed->is_compressed());
+  ASSERT_FALSE(compressed->is_weighted());
+  ASSERT_LT(compressed->memory_size(), blob.memory_size());
+  ASSERT_EQ(compressed->size(), ids.size());
+
+  // the ids are sorted as unsigned
+  std::vector<uint64_t> expected(ids.begin(), ids.end());
+  std::sort(expected.begin(), expected.end());
+  auto res = get_ids(compressed.get());
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(static_cast<uint64_t>(res[i]), expected[i]);
+  }
+
+  std::unique_ptr<distributed::GraphEdgeBlob> decompressed(
+      compressed->decompress());
+  ASSERT_FALSE(decompressed->is_compressed());
+  ASSERT_EQ(get_ids(decompressed.get()), res);
+}
+
+TEST(CompressedGraphEdgeBlob, NotSmaller) {
+  // a few sparse ids take more memory after being encoded
+  distributed::GraphEdgeBlob blob;
+  blob.add_edge(int64_t(1) << 40, 1.0);
+  blob.add_edge(int64_t(1) << 60, 1.0);
+  ASSERT_EQ(distributed::CompressedGraphEdgeBlob::compress(&blob), nullptr);
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+
+namespace paddle {
+namespace distributed {
+
+using Cache = ClockSampleCache<SampleKey, SampleResult>;
+using CacheResult = std::vector<std::pair<SampleKey, SampleResult>>;
+
+SampleResult MakeResult(const std::string &str) {
+  char *buffer = new char[str.size()];
+  memcpy(buffer, str.data(), str.size());
+  return SampleResult(str.size(), buffer);
+}
+
+std::string ResultString(const SampleResult &result) {
+  return std::string(result.buffer.get(), result.actual_size);
+}
+
+bool Hit(Cache *cache, SampleKey key, std::string *str = nullptr) {
+  CacheResult res;
+  cache->query(0, &key, 1, res);
+  if (res.empty()) {
+    return false;
+  }
+  if (str != nullptr) {
+    *str = ResultString(res[0].second);
+  }
+  return true;
+}
+
+void Insert(Cache *cache, SampleKey key, const std::string &str) {
+  SampleResult result = MakeResult(str);
+  cache->insert(0, &key, &result, 1);
+}
+
+TEST(ClockSampleCache, RemoveAfterTtl) {
+  Cache cache(1, 100, 3);
+  SampleKey key(0, 1, 5, false);
+  ASSERT_FALSE(Hit(&cache, key));
+  Insert(&cache, key, "54321");
+  for (size_t i = 0; i < cache.get_ttl(); i++) {
+    std::string str;
+    ASSERT_TRUE(Hit(&cache, key, &str));
+    ASSERT_EQ(str, "54321");
+  }
+  ASSERT_FALSE(Hit(&cache, key));
+}
+
+TEST(ClockSampleCache, ReinsertReplaces) {
+  Cache cache(1, 10, 100);
+  SampleKey a(0, 1, 5, false);
+  SampleKey b(0, 2, 5, false);
+  // the bytes of a replaced entry are released, so both entries still fit
+  for (int i = 0; i < 5; i++) {
+    Insert(&cache, a, std::to_string(1000 + i));
+  }
+  Insert(&cache, b, "bbbb");
+  std::string str;
+  ASSERT_TRUE(Hit(&cache, a, &str));
+  ASSERT_EQ(str, "1004");
+  ASSERT_TRUE(Hit(&cache, b, &str));
+  ASSERT_EQ(str, "bbbb");
+}
+
+TEST(ClockSampleCache, SkipOversized) {
+  Cache cache(2, 20, 100);
+  SampleKey a(0, 1, 5, false);
+  SampleKey b(0, 2, 5, false);
+  Insert(&cache, a, "aaaa");
+  // larger than the memory of a shard
+  Insert(&cache, b, std::string(11, 'b'));
+  ASSERT_FALSE(Hit(&cache, b));
+  ASSERT_TRUE(Hit(&cache, a));
+}
+
+TEST(ClockSampleCache, SecondChance) {
+  Cache cache(1, 10, 100);
+  SampleKey a(0, 1, 5, false);
+  SampleKey b(0, 2, 5, false);
+  SampleKey c(0, 3, 5, false);
+  Insert(&cache, a, "aaaa");
+  Insert(&cache, b, "bbbb");
+  // a is referenced, so the clock hand passes it and evicts b
+  ASSERT_TRUE(Hit(&cache, a));
+  Insert(&cache, c, "cccc");
+  ASSERT_FALSE(Hit(&cache, b));
+  ASSERT_TRUE(Hit(&cache, c));
+  ASSERT_TRUE(Hit(&cache, a));
+
+  // the evicted buffers are released while the returned results hold theirs
+  CacheResult res;
+  cache.query(0, &a, 1, res);
+  ASSERT_EQ(res.size(), 1UL);
+  for (int i = 0; i < 4; i++) {
+    Insert(&cache, SampleKey(0, 10 + i, 5, false), "dddd");
+  }
+  ASSERT_FALSE(Hit(&cache, a));
+  ASSERT_EQ(ResultString(res[0].second), "aaaa");
+  ASSERT_EQ(res[0].second.buffer.use_count(), 1);
+}
+
+}  // namespace distributed
+}  // namespace paddle
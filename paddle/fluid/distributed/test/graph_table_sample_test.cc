@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <condition_variable>  // NOLINT
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <string>
@@ -83,3 +84,54 @@ void testGraphSample() {
 }
 
 TEST(testGraphSample, Run) { testGraphSample(); }
+
+TEST(testGraphSample, SaveLoadNodeRank) {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.set_shard_num(4);
+  table_proto.add_node_types("u");
+  table_proto.add_edge_types("u2u");
+  table_proto.add_graph_feature();
+  distributed::GraphTable graph_table;
+  graph_table.Initialize(table_proto);
+  const int node_num = 3;
+  graph_table.node_num_ = node_num;
+  size_t shard_num = graph_table.shard_num_per_server;
+  ASSERT_EQ(shard_num, 4UL);
+
+  char dir_template[] = "/tmp/graph_node_rank_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  std::string dir(dir_template);
+  // no rank is saved yet
+  ASSERT_FALSE(graph_table.load_node_rank(dir));
+
+  auto &node_rank = graph_table.edge_node_rank_;
+  node_rank.init(node_num, shard_num);
+  for (uint64_t key = 0; key < 20; ++key) {
+    node_rank.insert(key, static_cast<int>(key % node_num));
+  }
+  graph_table.save_node_rank(dir);
+  for (size_t part_id = 0; part_id < shard_num; ++part_id) {
+    std::string file = graph_table.node_rank_file(dir, part_id);
+    ASSERT_TRUE(std::filesystem::exists(file));
+    ASSERT_FALSE(std::filesystem::exists(file + ".tmp"));
+  }
+
+  // a node of the edges that is not in the saved ranks
+  uint64_t new_key = 101;
+  graph_table.edge_shards[0][new_key % shard_num]->add_graph_node(new_key);
+  graph_table.edge_shards[0][5 % shard_num]->add_graph_node(5);
+  node_rank.clear();
+  ASSERT_TRUE(graph_table.load_node_rank(dir));
+  std::vector<size_t> counts(node_num, 0);
+  for (uint64_t key = 0; key < 20; ++key) {
+    ASSERT_EQ(node_rank.find(key), static_cast<int>(key % node_num));
+    ++counts[key % node_num];
+  }
+  int new_rank = graph_table.partition_key_for_rank(new_key);
+  ASSERT_EQ(node_rank.find(new_key), new_rank);
+  ++counts[new_rank];
+  for (int rank = 0; rank < node_num; ++rank) {
+    ASSERT_EQ(node_rank.nodes_num(rank), counts[rank]);
+  }
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,59 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/hot_key_sketch.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(HotKeySketch, Estimate) {
+  HotKeySketch sketch(1000);
+  ASSERT_EQ(sketch.width(), 1024UL);
+  for (int i = 0; i < 100; ++i) {
+    sketch.Touch(1);
+  }
+  for (uint64_t key = 100; key < 400; ++key) {
+    sketch.Touch(key);
+  }
+  // count-min never underestimates
+  ASSERT_GE(sketch.Estimate(1), 100);
+  ASSERT_GE(sketch.Estimate(100), 1);
+  ASSERT_LT(sketch.Estimate(100), sketch.Estimate(1));
+  ASSERT_EQ(sketch.Estimate(100000), 0);
+
+  // saturated counters
+  for (int i = 0; i < 1000; ++i) {
+    sketch.Touch(2);
+  }
+  ASSERT_EQ(sketch.Estimate(2), 255);
+}
+
+TEST(HotKeySketch, Age) {
+  HotKeySketch sketch(4096);
+  for (int i = 0; i < 64; ++i) {
+    sketch.Touch(1);
+  }
+  uint8_t before = sketch.Estimate(1);
+  sketch.Age();
+  ASSERT_EQ(sketch.Estimate(1), before / 2);
+
+  // old hot keys get colder than the keys accessed recently
+  for (size_t i = 0; i < 8 * sketch.width(); ++i) {
+    sketch.Touch(2 + i % 16);
+  }
+  ASSERT_LT(sketch.Estimate(1), sketch.Estimate(2));
+}
+
+}  // namespace paddle::distributed
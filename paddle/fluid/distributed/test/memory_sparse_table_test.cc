@@ -17,14 +17,26 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <random>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
+PD_DECLARE_int32(pserver_sparse_shard_split_num);
+PD_DECLARE_int32(pserver_sparse_shard_split_min_keys);
+PD_DECLARE_bool(pserver_async_save);
+
 namespace paddle {
 namespace distributed {
 
@@ -152,5 +164,203 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+std::unique_ptr<Table> CreateZipfTable(int shard_num, int split_num) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(shard_num);
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(8);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseAdaGradSGDRule");
+    auto *adagrad_param = sgd_param->mutable_adagrad();
+    adagrad_param->set_learning_rate(0.05);
+    // the values of both tables are created the same
+    adagrad_param->set_initial_range(0);
+    adagrad_param->set_initial_g2sum(3.0);
+    adagrad_param->add_weight_bounds(-10.0);
+    adagrad_param->add_weight_bounds(10.0);
+  }
+
+  FLAGS_pserver_sparse_shard_split_num = split_num;
+  auto ret = table->Initialize(table_config, fs_config);
+  FLAGS_pserver_sparse_shard_split_num = 1;
+  EXPECT_EQ(ret, 0);
+  return table;
+}
+
+// Pushes keys of a zipf distribution, with the hot keys in one shard, to a
+// table splitting the keys of a shard and to one that does not. Both must
+// end with the same values, the push rates are logged.
+TEST(MemorySparseTable, ZipfSplitShard) {
+  const int kShardNum = 8;
+  const int kEmbDim = 8;
+  const size_t kKeyNum = 200000;
+  const size_t kHotKeyNum = 2000;
+  const size_t kBatchSize = 100000;
+  const int kPushNum = 10;
+  FLAGS_pserver_sparse_shard_split_min_keys = 1024;
+  auto table = CreateZipfTable(kShardNum, 1);
+  auto split_table = CreateZipfTable(kShardNum, 4);
+
+  std::vector<double> cdf(kKeyNum);
+  double sum = 0;
+  for (size_t rank = 0; rank < kKeyNum; ++rank) {
+    sum += 1.0 / std::pow(rank + 1, 1.1);
+    cdf[rank] = sum;
+  }
+  std::mt19937 engine(2024);
+  std::uniform_real_distribution<double> uniform(0, sum);
+  auto zipf_key = [&]() -> uint64_t {
+    uint64_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(engine)) -
+                    cdf.begin();
+    return rank < kHotKeyNum ? rank * kShardNum : rank;
+  };
+
+  const int push_dim = kEmbDim + 4;
+  std::vector<uint64_t> keys(kBatchSize);
+  std::vector<float> grads(kBatchSize * push_dim);
+  double seconds = 0, split_seconds = 0;
+  for (int step = 0; step < kPushNum; ++step) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      keys[i] = zipf_key();
+      float *grad = grads.data() + i * push_dim;
+      grad[0] = 0;  // slot
+      grad[1] = 1;  // show
+      grad[2] = (keys[i] + step) % 3 == 0 ? 1 : 0;
+      for (int k = 3; k < push_dim; ++k) {
+        grad[k] = std::sin(static_cast<float>(keys[i] + k + step)) * 0.1f;
+      }
+    }
+    for (auto *target : {table.get(), split_table.get()}) {
+      TableContext context;
+      context.value_type = Sparse;
+      context.push_context.keys = keys.data();
+      context.push_context.values = grads.data();
+      context.num = keys.size();
+      auto begin = std::chrono::steady_clock::now();
+      ASSERT_EQ(target->Push(context), 0);
+      std::chrono::duration<double> cost =
+          std::chrono::steady_clock::now() - begin;
+      (target == table.get() ? seconds : split_seconds) += cost.count();
+    }
+  }
+  LOG(INFO) << "zipf push keys per second, one thread per shard: "
+            << kBatchSize * kPushNum / seconds
+            << ", split shards: " << kBatchSize * kPushNum / split_seconds;
+
+  std::vector<uint64_t> pull_keys;
+  for (size_t rank = 0; rank < kKeyNum; rank += 7) {
+    pull_keys.push_back(rank < kHotKeyNum ? rank * kShardNum : rank);
+  }
+  std::vector<uint32_t> pull_fres(pull_keys.size(), 1);
+  auto pull_value = PullSparseValue(pull_keys, pull_fres, kEmbDim);
+  std::vector<float> values(pull_keys.size() * (kEmbDim + 3));
+  std::vector<float> split_values(values.size());
+  for (auto *target : {table.get(), split_table.get()}) {
+    TableContext context;
+    context.value_type = Sparse;
+    context.pull_context.pull_value = pull_value;
+    context.pull_context.values =
+        target == table.get() ? values.data() : split_values.data();
+    ASSERT_EQ(target->Pull(context), 0);
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_FLOAT_EQ(values[i], split_values[i]) << "i is " << i;
+  }
+}
+
+void PushStep(Table *table, const std::vector<uint64_t> &keys, int step) {
+  const int push_dim = 8 + 4;
+  std::vector<float> grads(keys.size() * push_dim);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float *grad = grads.data() + i * push_dim;
+    grad[0] = 0;  // slot
+    grad[1] = 1;  // show
+    grad[2] = (keys[i] + step) % 3 == 0 ? 1 : 0;
+    for (int k = 3; k < push_dim; ++k) {
+      grad[k] = std::sin(static_cast<float>(keys[i] + k + step)) * 0.1f;
+    }
+  }
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  ASSERT_EQ(table->Push(context), 0);
+}
+
+std::vector<float> PullValues(Table *table, std::vector<uint64_t> keys) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto pull_value = PullSparseValue(keys, fres, 8);
+  std::vector<float> values(keys.size() * (8 + 3));
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value = pull_value;
+  context.pull_context.values = values.data();
+  EXPECT_EQ(table->Pull(context), 0);
+  return values;
+}
+
+// The async save must write the table as it was when the save began, while
+// the pushes go on. It is compared with a synchronous save of the same
+// state, both loaded back through the text format.
+TEST(MemorySparseTable, AsyncSave) {
+  const int kShardNum = 4;
+  std::vector<uint64_t> keys(5000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = i;
+  }
+  auto table = CreateZipfTable(kShardNum, 1);
+  PushStep(table.get(), keys, 0);
+  PushStep(table.get(), keys, 1);
+  auto saved_values = PullValues(table.get(), keys);
+
+  char dir_template[] = "/tmp/memory_sparse_table_async_save_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  const std::string dir = dir_template;
+  const std::string sync_dir = dir + "/sync";
+  const std::string async_dir = dir + "/async";
+
+  FLAGS_pserver_async_save = false;
+  ASSERT_EQ(table->Save(sync_dir, "0"), 0);
+  FLAGS_pserver_async_save = true;
+  ASSERT_EQ(table->Save(async_dir, "0"), 0);
+  // the pushes change the buckets while they are written
+  for (int step = 2; step < 6; ++step) {
+    PushStep(table.get(), keys, step);
+  }
+  table->CheckSavePrePatchDone();
+  FLAGS_pserver_async_save = false;
+
+  auto sync_table = CreateZipfTable(kShardNum, 1);
+  auto async_table = CreateZipfTable(kShardNum, 1);
+  ASSERT_EQ(sync_table->Load(sync_dir, "0"), 0);
+  ASSERT_EQ(async_table->Load(async_dir, "0"), 0);
+  auto sync_values = PullValues(sync_table.get(), keys);
+  auto async_values = PullValues(async_table.get(), keys);
+  for (size_t i = 0; i < sync_values.size(); ++i) {
+    ASSERT_FLOAT_EQ(async_values[i], sync_values[i]) << "i is " << i;
+  }
+  // the pushes after the save are applied to the table
+  auto values = PullValues(table.get(), keys);
+  int changed = 0;
+  for (size_t i = 0; i < values.size(); ++i) {
+    changed += values[i] != saved_values[i];
+  }
+  EXPECT_GT(changed, 0);
+
+  std::filesystem::remove_all(dir);
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,61 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_admission_filter.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+static void CheckAdmission(const std::string &name) {
+  SparseAdmissionParameter param;
+  param.set_filter(name);
+  param.set_threshold(3);
+  param.set_width(1 << 16);
+  auto filter = SparseAdmissionFilter::Create(param);
+  ASSERT_NE(filter, nullptr);
+
+  // a key is admitted at its third sighting
+  size_t admitted = 0;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    ASSERT_FALSE(filter->Admit(key * 7919));
+    if (filter->Admit(key * 7919)) {
+      ++admitted;
+    }
+    ASSERT_TRUE(filter->Admit(key * 7919));
+  }
+  // at most a few keys share all their counters with the former ones
+  ASSERT_LT(admitted, 10u);
+
+  // the old sightings are forgotten
+  filter->Age();
+  ASSERT_EQ(filter->Estimate(7919), 1u);
+  filter->Age();
+  ASSERT_FALSE(filter->Admit(7919));
+}
+
+TEST(SparseAdmissionFilter, count_min) { CheckAdmission("count_min"); }
+
+TEST(SparseAdmissionFilter, counting_bloom) {
+  CheckAdmission("counting_bloom");
+}
+
+TEST(SparseAdmissionFilter, disabled) {
+  SparseAdmissionParameter param;
+  ASSERT_EQ(SparseAdmissionFilter::Create(param), nullptr);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,181 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_coalescer.h"
+
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+
+namespace paddle::distributed {
+
+const size_t kSelectDim = 4;
+
+// the values of a key are its key and the times it is pushed
+class FakeSparseTable : public Table {
+ public:
+  int32_t Pull(TableContext &context) override {
+    const auto &pull_value = context.pull_context.pull_value;
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_pull_num;
+    _pulled_key_num += pull_value.numel_;
+    for (int i = 0; i < pull_value.numel_; ++i) {
+      uint64_t key = pull_value.feasigns_[i];
+      float *value = context.pull_context.values + i * kSelectDim;
+      for (size_t j = 0; j < kSelectDim; ++j) {
+        value[j] = static_cast<float>(key * 10 + j + _pushes[key]);
+      }
+    }
+    return 0;
+  }
+  int32_t Push(TableContext &context) override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < context.num; ++i) {
+      ++_pushes[context.push_context.keys[i]];
+    }
+    return 0;
+  }
+  void Clear() override {}
+  int32_t Flush() override { return 0; }
+  int32_t Shrink(const std::string &param) override { return 0; }
+  int32_t Load(const std::string &path,
+               const std::string &converter) override {
+    return 0;
+  }
+  int32_t Save(const std::string &path,
+               const std::string &converter) override {
+    return 0;
+  }
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+  int32_t Save_v2(const std::string &path,
+                  const std::string &converter) override {
+    return 0;
+  }
+#endif
+  void *GetShard(size_t shard_idx) override { return nullptr; }
+
+  int pull_num() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pull_num;
+  }
+  int pulled_key_num() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pulled_key_num;
+  }
+
+ protected:
+  int32_t Initialize() override { return 0; }
+  int32_t InitializeShard() override { return 0; }
+
+ private:
+  std::mutex _mutex;
+  int _pull_num = 0;
+  int _pulled_key_num = 0;
+  std::unordered_map<uint64_t, int> _pushes;
+};
+
+void CheckValues(const std::vector<uint64_t> &keys,
+                 const std::vector<float> &values,
+                 int pushes) {
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (size_t j = 0; j < kSelectDim; ++j) {
+      ASSERT_FLOAT_EQ(values[i * kSelectDim + j],
+                      static_cast<float>(keys[i] * 10 + j + pushes));
+    }
+  }
+}
+
+void Push(FakeSparseTable *table,
+          SparsePullCoalescer *coalescer,
+          std::vector<uint64_t> keys) {
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.num = keys.size();
+  table->Push(context);
+  coalescer->Invalidate(keys.data(), keys.size());
+}
+
+std::vector<float> Pull(SparsePullCoalescer *coalescer,
+                        std::vector<uint64_t> keys) {
+  std::vector<uint32_t> frequencies(keys.size(), 1);
+  PullSparseValue pull_value(keys, frequencies, kSelectDim);
+  std::vector<float> values(keys.size() * kSelectDim);
+  EXPECT_EQ(coalescer->Pull(pull_value, values.data()), 0);
+  return values;
+}
+
+TEST(SparsePullCoalescer, merge_pulls) {
+  FakeSparseTable table;
+  SparsePullCoalesceParameter param;
+  param.set_window_us(200000);
+  SparsePullCoalescer coalescer(param, &table, kSelectDim);
+
+  const int thread_num = 8;
+  std::vector<std::vector<uint64_t>> keys(thread_num);
+  std::vector<std::vector<float>> values(thread_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    // the hot keys 0..9 are pulled by every thread
+    for (uint64_t key = 0; key < 10; ++key) {
+      keys[i].push_back(key);
+      keys[i].push_back(100 + i * 10 + key);
+    }
+    threads.emplace_back(
+        [&, i]() { values[i] = Pull(&coalescer, keys[i]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < thread_num; ++i) {
+    CheckValues(keys[i], values[i], 0);
+  }
+  ASSERT_LT(table.pull_num(), thread_num);
+  // the hot keys are pulled once in each batch
+  ASSERT_LE(table.pulled_key_num(), 10 * table.pull_num() + 10 * thread_num);
+}
+
+TEST(SparsePullCoalescer, hot_key_cache) {
+  FakeSparseTable table;
+  SparsePullCoalesceParameter param;
+  param.set_hot_key_cache_size(1024);
+  param.set_hot_key_threshold(2);
+  SparsePullCoalescer coalescer(param, &table, kSelectDim);
+
+  std::vector<uint64_t> keys = {1, 2, 3};
+  CheckValues(keys, Pull(&coalescer, keys), 0);
+  CheckValues(keys, Pull(&coalescer, keys), 0);
+  ASSERT_EQ(table.pulled_key_num(), 6);
+  // cached once pulled twice
+  CheckValues(keys, Pull(&coalescer, keys), 0);
+  ASSERT_EQ(table.pulled_key_num(), 6);
+
+  Push(&table, &coalescer, {1, 2, 3});
+  CheckValues(keys, Pull(&coalescer, keys), 1);
+  ASSERT_EQ(table.pulled_key_num(), 9);
+  // cached again, as the pull after the push missed at its version
+  auto values = Pull(&coalescer, {1, 4});
+  CheckValues({1}, {values.begin(), values.begin() + kSelectDim}, 1);
+  CheckValues({4}, {values.begin() + kSelectDim, values.end()}, 0);
+  ASSERT_EQ(table.pulled_key_num(), 10);
+
+  coalescer.InvalidateAll();
+  CheckValues(keys, Pull(&coalescer, keys), 1);
+  ASSERT_EQ(table.pulled_key_num(), 13);
+}
+
+}  // namespace paddle::distributed
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +206,81 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// UpdateValueBatch matches one UpdateValue call per value, including the
+// repeated values of a batch
+void CheckUpdateValueBatch(SparseValueSGDRule* rule, size_t embed_dim) {
+  const size_t kValueNum = 7;
+  size_t value_dim = embed_dim + rule->Dim();
+  std::vector<float> batch_values(kValueNum * value_dim);
+  std::vector<float> grads(kValueNum * embed_dim);
+  for (size_t i = 0; i < kValueNum; ++i) {
+    rule->InitValue(batch_values.data() + i * value_dim,
+                    batch_values.data() + i * value_dim + embed_dim,
+                    false);
+  }
+  for (size_t i = 0; i < grads.size(); ++i) {
+    grads[i] = std::sin(static_cast<float>(i));
+  }
+  std::vector<float> values = batch_values;
+
+  const size_t kPushNum = 10;
+  std::vector<float*> w(kPushNum);
+  std::vector<float*> sgd(kPushNum);
+  std::vector<const float*> push_values(kPushNum);
+  std::vector<float> scales(kPushNum);
+  for (size_t i = 0; i < kPushNum; ++i) {
+    size_t item = i % kValueNum;
+    w[i] = batch_values.data() + item * value_dim;
+    sgd[i] = w[i] + embed_dim;
+    push_values[i] = grads.data() + item * embed_dim;
+    scales[i] = static_cast<float>(i + 1);
+    rule->UpdateValue(values.data() + item * value_dim,
+                      values.data() + item * value_dim + embed_dim,
+                      push_values[i],
+                      scales[i]);
+  }
+  rule->UpdateValueBatch(
+      w.data(), sgd.data(), push_values.data(), scales.data(), kPushNum);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_FLOAT_EQ(batch_values[i], values[i]) << "i is " << i;
+  }
+}
+
+TEST(sparse_value_sgd_rule_test, update_value_batch) {
+  const size_t kEmbedDim = 19;
+  SparseCommonSGDRuleParameter adagrad_param;
+  auto* adagrad = adagrad_param.mutable_adagrad();
+  adagrad->set_learning_rate(0.1);
+  adagrad->set_initial_range(0.3);
+  adagrad->set_initial_g2sum(3.0);
+  adagrad->add_weight_bounds(-0.5);
+  adagrad->add_weight_bounds(0.5);
+  SparseCommonSGDRuleParameter adam_param;
+  auto* adam = adam_param.mutable_adam();
+  adam->set_learning_rate(0.1);
+  adam->set_initial_range(0.3);
+  adam->set_beta1_decay_rate(0.9);
+  adam->set_beta2_decay_rate(0.999);
+  adam->set_ada_epsilon(1e-08);
+  adam->add_weight_bounds(-0.5);
+  adam->add_weight_bounds(0.5);
+
+  SparseAdaGradSGDRule adagrad_rule;
+  adagrad_rule.LoadConfig(adagrad_param, kEmbedDim);
+  CheckUpdateValueBatch(&adagrad_rule, kEmbedDim);
+  StdAdaGradSGDRule std_adagrad_rule;
+  std_adagrad_rule.LoadConfig(adagrad_param, kEmbedDim);
+  CheckUpdateValueBatch(&std_adagrad_rule, kEmbedDim);
+  SparseAdaGradV2SGDRule adagrad_v2_rule;
+  adagrad_v2_rule.LoadConfig(adagrad_param, kEmbedDim);
+  CheckUpdateValueBatch(&adagrad_v2_rule, kEmbedDim);
+  SparseAdamSGDRule adam_rule;
+  adam_rule.LoadConfig(adam_param, kEmbedDim);
+  CheckUpdateValueBatch(&adam_rule, kEmbedDim);
+  SparseSharedAdamSGDRule shared_adam_rule;
+  shared_adam_rule.LoadConfig(adam_param, kEmbedDim);
+  CheckUpdateValueBatch(&shared_adam_rule, kEmbedDim);
+}
 }  // namespace distributed
 }  // namespace paddle
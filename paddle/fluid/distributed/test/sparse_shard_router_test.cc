@@ -0,0 +1,79 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_shard_router.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(SparseShardRouting, default_layout) {
+  // 334 shards on each server, as the tables lay them out
+  SparseShardRouting routing(1000, 3);
+  ASSERT_EQ(routing.ShardNum(), 1000u);
+  for (uint64_t key = 0; key < 5000; key += 7) {
+    ASSERT_EQ(routing.ServerOf(key), (key % 1000) / 334);
+  }
+}
+
+TEST(SparseShardRouting, plan_scale_out) {
+  SparseShardRouting routing(1000, 2);
+  std::vector<SparseShardMove> moves;
+  auto target = routing.PlanScaleOut(4, &moves);
+
+  std::vector<uint32_t> counts(4, 0);
+  for (uint32_t shard_id = 0; shard_id < 1000; ++shard_id) {
+    uint32_t server = target->ShardServers()[shard_id];
+    ++counts[server];
+    // the kept shards stay where they are
+    if (server < 2) {
+      ASSERT_EQ(server, routing.ShardServers()[shard_id]);
+    }
+  }
+  for (auto count : counts) {
+    ASSERT_EQ(count, 250u);
+  }
+
+  size_t moved = 0;
+  for (const auto &move : moves) {
+    ASSERT_LT(move.from, 2u);
+    ASSERT_GE(move.to, 2u);
+    for (auto shard_id : move.shards) {
+      ASSERT_EQ(routing.ShardServers()[shard_id], move.from);
+      ASSERT_EQ(target->ShardServers()[shard_id], move.to);
+    }
+    moved += move.shards.size();
+  }
+  ASSERT_EQ(moved, 500u);
+
+  // balanced already
+  target->PlanScaleOut(4, &moves);
+  ASSERT_TRUE(moves.empty());
+}
+
+TEST(SparseShardRouter, switch_routing) {
+  SparseShardRouter router(10, 2);
+  auto before = router.Routing();
+  std::vector<uint32_t> shard_servers(10, 2);
+  router.Switch(std::make_shared<SparseShardRouting>(shard_servers));
+  // a request keeps the routing it got
+  ASSERT_EQ(before->ServerOf(3), 0u);
+  ASSERT_EQ(before->ServerOf(7), 1u);
+  ASSERT_EQ(router.Routing()->ServerOf(3), 2u);
+  ASSERT_EQ(router.Routing()->ServerOf(7), 2u);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,119 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_transport.h"
+
+#include <cmath>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+const size_t kEmbedxDim = 8;
+
+TableParameter gen_table_param(SparseValueCompressType pull_type,
+                               SparseValueCompressType push_type) {
+  TableParameter param;
+  param.set_table_id(0);
+  param.mutable_accessor()->set_accessor_class("CtrCommonAccessor");
+  param.mutable_accessor()->set_embedx_dim(kEmbedxDim);
+  param.mutable_sparse_transport()->set_pull_value_type(pull_type);
+  param.mutable_sparse_transport()->set_push_grad_type(push_type);
+  return param;
+}
+
+AccessorInfo gen_accessor_info() {
+  AccessorInfo info;
+  info.select_dim = 3 + kEmbedxDim;
+  info.select_size = info.select_dim * sizeof(float);
+  info.update_dim = 4 + kEmbedxDim;
+  info.update_size = info.update_dim * sizeof(float);
+  return info;
+}
+
+TEST(SparseTransportCodec, fp32_is_raw) {
+  auto codec = SparseTransportCodec::Create(
+      gen_table_param(SPARSE_VALUE_FP32, SPARSE_VALUE_FP32),
+      gen_accessor_info());
+  ASSERT_EQ(codec, nullptr);
+}
+
+TEST(SparseTransportCodec, pull_values) {
+  auto info = gen_accessor_info();
+  std::vector<float> values(2 * info.select_dim);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 0.37f * static_cast<float>(i) - 1.5f;
+  }
+  for (auto type : {SPARSE_VALUE_FP16, SPARSE_VALUE_BF16, SPARSE_VALUE_INT8}) {
+    auto codec = SparseTransportCodec::Create(
+        gen_table_param(type, SPARSE_VALUE_FP32), info);
+    ASSERT_NE(codec, nullptr);
+    ASSERT_LT(codec->PullValueSize(), info.select_size);
+    std::vector<char> encoded(2 * codec->PullValueSize());
+    codec->EncodePullValues(values.data(), 2, encoded.data());
+    for (size_t row = 0; row < 2; ++row) {
+      std::vector<float> decoded(info.select_dim);
+      codec->DecodePullValue(encoded.data() + row * codec->PullValueSize(),
+                             decoded.data());
+      const float *value = values.data() + row * info.select_dim;
+      // show, click and embed_w are sent in fp32
+      for (size_t i = 0; i < 3; ++i) {
+        ASSERT_FLOAT_EQ(decoded[i], value[i]);
+      }
+      for (size_t i = 3; i < info.select_dim; ++i) {
+        ASSERT_NEAR(decoded[i], value[i], 0.05);
+      }
+    }
+  }
+}
+
+TEST(SparseTransportCodec, push_grads_error_feedback) {
+  auto info = gen_accessor_info();
+  auto codec = SparseTransportCodec::Create(
+      gen_table_param(SPARSE_VALUE_FP32, SPARSE_VALUE_FP16), info);
+  ASSERT_NE(codec, nullptr);
+  ASSERT_EQ(codec->PullValueSize(), info.select_size);
+
+  std::vector<float> grad(info.update_dim, 1e-4f + 1e-8f);
+  std::vector<double> sum(info.update_dim, 0.0);
+  std::vector<char> encoded(codec->PushGradSize());
+  std::vector<float> decoded(info.update_dim);
+  const int steps = 1000;
+  for (int step = 0; step < steps; ++step) {
+    codec->EncodePushGrad(42, grad.data(), encoded.data());
+    codec->DecodePushGrads(encoded.data(), 1, decoded.data());
+    for (size_t i = 0; i < info.update_dim; ++i) {
+      sum[i] += decoded[i];
+    }
+  }
+  // the rounding error is carried over, so the sum of the decoded
+  // gradients is as precise as one fp16 rounding
+  for (size_t i = 4; i < info.update_dim; ++i) {
+    ASSERT_NEAR(sum[i], static_cast<double>(grad[i]) * steps, 1e-6);
+  }
+}
+
+TEST(SparseTransportCodec, compress) {
+  std::vector<float> values(1024, 0.5f);
+  butil::IOBuf raw, compressed, decompressed;
+  raw.append(values.data(), values.size() * sizeof(float));
+  ASSERT_TRUE(SparseTransportCodec::Compress(raw, &compressed));
+  ASSERT_LT(compressed.size(), raw.size());
+  ASSERT_TRUE(SparseTransportCodec::Decompress(compressed, &decompressed));
+  ASSERT_EQ(decompressed.to_string(), raw.to_string());
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,97 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_worker_cache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+const size_t kDim = 4;
+
+std::vector<float> gen_value(float v) { return std::vector<float>(kDim, v); }
+
+TEST(SparseWorkerCache, disabled) {
+  TableParameter param;
+  AccessorInfo info;
+  info.select_dim = kDim;
+  ASSERT_EQ(SparseWorkerCache::Create(param, info), nullptr);
+  param.mutable_sparse_worker_cache()->set_capacity(128);
+  ASSERT_NE(SparseWorkerCache::Create(param, info), nullptr);
+}
+
+TEST(SparseWorkerCache, staleness) {
+  SparseWorkerCache cache(128, 2, kDim);
+  std::vector<float> value(kDim);
+  uint64_t pull_id = cache.NextPull();
+  ASSERT_FALSE(cache.Get(1, pull_id, value.data()));
+  cache.Put(1, pull_id, gen_value(1.0f).data());
+  // reused by the next 2 pulls
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(cache.Get(1, cache.NextPull(), value.data()));
+    ASSERT_EQ(value, gen_value(1.0f));
+  }
+  pull_id = cache.NextPull();
+  ASSERT_FALSE(cache.Get(1, pull_id, value.data()));
+  cache.Put(1, pull_id, gen_value(2.0f).data());
+  // an older pull finishing late keeps the newer value
+  cache.Put(1, pull_id - 1, gen_value(3.0f).data());
+  ASSERT_TRUE(cache.Get(1, cache.NextPull(), value.data()));
+  ASSERT_EQ(value, gen_value(2.0f));
+}
+
+TEST(SparseWorkerCache, lru) {
+  // one key in each of the 64 lists
+  SparseWorkerCache cache(64, 100, kDim);
+  std::vector<float> value(kDim);
+  uint64_t pull_id = cache.NextPull();
+  cache.Put(0, pull_id, gen_value(0.0f).data());
+  // puts keys until one evicts key 0 from their list
+  uint64_t key = 1;
+  for (; key < 100000; ++key) {
+    cache.Put(key, pull_id, gen_value(key).data());
+    if (!cache.Get(0, pull_id, value.data())) {
+      break;
+    }
+  }
+  ASSERT_LT(key, 100000UL);
+  ASSERT_TRUE(cache.Get(key, pull_id, value.data()));
+  ASSERT_EQ(value, gen_value(key));
+}
+
+TEST(SparseWorkerCache, clear) {
+  SparseWorkerCache cache(128, 10, kDim);
+  std::vector<float> value(kDim);
+  uint64_t pull_id = cache.NextPull();
+  cache.Put(1, pull_id, gen_value(1.0f).data());
+  cache.Put(2, pull_id, gen_value(2.0f).data());
+  uint64_t running_pull_id = cache.NextPull();
+  cache.Erase(std::vector<uint64_t>{1}.data(), 1);
+  ASSERT_FALSE(cache.Get(1, cache.NextPull(), value.data()));
+  ASSERT_TRUE(cache.Get(2, cache.NextPull(), value.data()));
+  // the pull started before the erase may fetch the old value
+  cache.Put(1, running_pull_id, gen_value(1.0f).data());
+  ASSERT_FALSE(cache.Get(1, cache.NextPull(), value.data()));
+
+  cache.Clear();
+  ASSERT_FALSE(cache.Get(2, cache.NextPull(), value.data()));
+  pull_id = cache.NextPull();
+  cache.Put(2, pull_id, gen_value(3.0f).data());
+  ASSERT_TRUE(cache.Get(2, cache.NextPull(), value.data()));
+  ASSERT_EQ(value, gen_value(3.0f));
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,168 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+COMMON_DECLARE_string(rocksdb_path);
+PD_DECLARE_int64(pserver_ssd_mem_capacity_per_shard);
+PD_DECLARE_double(pserver_ssd_evict_ratio);
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+const int kEmbDim = 8;
+
+std::unique_ptr<Table> CreateTable(const std::string &table_class,
+                                   Table *table) {
+  TableParameter table_config;
+  table_config.set_table_class(table_class);
+  table_config.set_shard_num(1);
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> result(table);
+  result->SetShard(0, 1);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbDim + 3);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseAdaGradSGDRule");
+    auto *adagrad_param = sgd_param->mutable_adagrad();
+    adagrad_param->set_learning_rate(0.05);
+    // the values of both tables are created the same
+    adagrad_param->set_initial_range(0);
+    adagrad_param->set_initial_g2sum(3.0);
+    adagrad_param->add_weight_bounds(-10.0);
+    adagrad_param->add_weight_bounds(10.0);
+  }
+
+  EXPECT_EQ(result->Initialize(table_config, fs_config), 0);
+  return result;
+}
+
+void PushKeys(const std::vector<Table *> &tables,
+              std::vector<uint64_t> keys,
+              int step) {
+  const int push_dim = kEmbDim + 4;
+  std::vector<float> grads(keys.size() * push_dim);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float *grad = grads.data() + i * push_dim;
+    grad[0] = 0;  // slot
+    grad[1] = 1;  // show
+    grad[2] = (keys[i] + step) % 3 == 0 ? 1 : 0;
+    for (int k = 3; k < push_dim; ++k) {
+      grad[k] = std::sin(static_cast<float>(keys[i] + k + step)) * 0.1f;
+    }
+  }
+  for (auto *table : tables) {
+    TableContext context;
+    context.value_type = Sparse;
+    context.push_context.keys = keys.data();
+    context.push_context.values = grads.data();
+    context.num = keys.size();
+    ASSERT_EQ(table->Push(context), 0);
+  }
+}
+
+std::vector<float> PullKeys(Table *table, std::vector<uint64_t> keys) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto pull_value = PullSparseValue(keys, fres, kEmbDim);
+  std::vector<float> values(keys.size() * (kEmbDim + 3));
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value = pull_value;
+  context.pull_context.values = values.data();
+  EXPECT_EQ(table->Pull(context), 0);
+  return values;
+}
+
+bool InSSD(uint64_t key) {
+  std::string value;
+  return RocksDBHandler::GetInstance()->get(
+             0, reinterpret_cast<const char *>(&key), sizeof(key), value) ==
+         0;
+}
+
+}  // namespace
+
+// Pushes more keys than the memory capacity of the shard, the cold ones are
+// moved to rocksdb and loaded back when they are pulled or pushed again. The
+// values must be the same as the ones of a memory table.
+TEST(SSDSparseTable, EvictAndReload) {
+  const size_t kKeyNum = 300;
+  const size_t kHotKeyNum = 20;
+  FLAGS_rocksdb_path = "ssd_sparse_table_test_db";
+  FLAGS_pserver_ssd_mem_capacity_per_shard = 100;
+  FLAGS_pserver_ssd_evict_ratio = 0.5;
+  auto ssd_table = CreateTable("SSDSparseTable", new SSDSparseTable());
+  FLAGS_pserver_ssd_mem_capacity_per_shard = 0;
+  auto mem_table = CreateTable("MemorySparseTable", new MemorySparseTable());
+  auto *ssd = dynamic_cast<SSDSparseTable *>(ssd_table.get());
+  std::vector<Table *> tables = {ssd_table.get(), mem_table.get()};
+
+  std::vector<uint64_t> hot_keys, all_keys;
+  for (uint64_t key = 0; key < kKeyNum; ++key) {
+    (key < kHotKeyNum ? hot_keys : all_keys).push_back(key);
+  }
+  for (int step = 0; step < 10; ++step) {
+    PushKeys(tables, hot_keys, step);
+  }
+  EXPECT_EQ(ssd->LocalSize(), static_cast<int64_t>(kHotKeyNum));
+  all_keys.insert(all_keys.begin(), hot_keys.begin(), hot_keys.end());
+  PushKeys(tables, all_keys, 10);
+
+  // the eviction runs on the shard thread after the push, and finishes
+  // before the next request of the shard
+  PullKeys(ssd, {0});
+  EXPECT_EQ(ssd->LocalSize(), 50);
+  size_t num_in_ssd = 0;
+  for (auto key : all_keys) {
+    if (key < kHotKeyNum) {
+      EXPECT_FALSE(InSSD(key)) << "hot key " << key << " is evicted";
+    } else {
+      num_in_ssd += InSSD(key);
+    }
+  }
+  EXPECT_EQ(num_in_ssd, kKeyNum - 50);
+
+  // the pulls and the pushes load the evicted keys instead of creating them
+  // again
+  for (int step = 11; step < 13; ++step) {
+    auto values = PullKeys(ssd, all_keys);
+    auto expected = PullKeys(mem_table.get(), all_keys);
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_FLOAT_EQ(values[i], expected[i]) << "i is " << i;
+    }
+    PushKeys(tables, all_keys, step);
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,202 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/activation_offloader.h"
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/memory/malloc.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_int64(eager_activation_offload_budget_mb);
+COMMON_DECLARE_int32(eager_activation_offload_prefetch_num);
+
+namespace egr {
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+namespace {
+
+#ifdef PADDLE_WITH_HIP
+constexpr unsigned int kEventFlags = hipEventDisableTiming;
+constexpr gpuMemcpyKind kDeviceToHost = hipMemcpyDeviceToHost;
+constexpr gpuMemcpyKind kHostToDevice = hipMemcpyHostToDevice;
+#else
+constexpr unsigned int kEventFlags = cudaEventDisableTiming;
+constexpr gpuMemcpyKind kDeviceToHost = cudaMemcpyDeviceToHost;
+constexpr gpuMemcpyKind kHostToDevice = cudaMemcpyHostToDevice;
+#endif
+
+void StreamWaitEvent(gpuStream_t stream, phi::CudaEvent* event) {
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      hipStreamWaitEvent(stream, event->GetRawCudaEvent(), 0));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaStreamWaitEvent(stream, event->GetRawCudaEvent(), 0));
+#endif
+}
+
+// Orders the work of to_stream after the work launched on from_stream so far
+void StreamWaitStream(gpuStream_t to_stream, gpuStream_t from_stream) {
+  phi::CudaEvent event(kEventFlags);
+  event.Record(from_stream);
+  StreamWaitEvent(to_stream, &event);
+}
+
+}  // namespace
+#endif
+
+OffloadedTensor::~OffloadedTensor() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // The copies may still use the buffers
+  if (offloaded_event_) offloaded_event_->Synchronize();
+  if (loaded_event_) loaded_event_->Synchronize();
+#endif
+}
+
+void OffloadedTensor::CopyBack() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  device_buffer_ = paddle::memory::AllocShared(place_, size_);
+  // The kernels launched before may still use the memory of device_buffer_
+  StreamWaitStream(offload_stream_, compute_stream_);
+  paddle::platform::GpuMemcpyAsync(device_buffer_->ptr(),
+                                   host_buffer_->ptr(),
+                                   size_,
+                                   kHostToDevice,
+                                   offload_stream_);
+  loaded_event_ = std::make_unique<phi::CudaEvent>(kEventFlags);
+  loaded_event_->Record(offload_stream_);
+#endif
+}
+
+std::shared_ptr<phi::Allocation> OffloadedTensor::Load() {
+  bool prefetched = false;
+  std::shared_ptr<phi::Allocation> device_buffer;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!device_buffer_) {
+      VLOG(6) << "Load " << size_ << " bytes of activation on demand";
+      CopyBack();
+    }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    StreamWaitEvent(compute_stream_, loaded_event_.get());
+#endif
+    prefetched = prefetched_;
+    prefetched_ = false;
+    device_buffer = device_buffer_;
+  }
+  if (prefetched) {
+    ActivationOffloader::Instance().OnPrefetchedLoaded();
+  }
+  return device_buffer;
+}
+
+ActivationOffloader& ActivationOffloader::Instance() {
+  static ActivationOffloader offloader;
+  return offloader;
+}
+
+std::shared_ptr<OffloadedTensor> ActivationOffloader::Offload(
+    const phi::DenseTensor& tensor) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (FLAGS_eager_activation_offload_budget_mb < 0) {
+    return nullptr;
+  }
+  if (!tensor.initialized() || !phi::is_gpu_place(tensor.place())) {
+    return nullptr;
+  }
+  const std::shared_ptr<phi::Allocation>& holder = tensor.Holder();
+  size_t size = holder->size();
+  std::lock_guard<std::mutex> guard(mutex_);
+  saved_bytes_ += static_cast<int64_t>(size);
+  if (saved_bytes_ <= (FLAGS_eager_activation_offload_budget_mb << 20)) {
+    return nullptr;
+  }
+
+  phi::Place place = tensor.place();
+  auto& offload_stream = offload_streams_[place.GetDeviceId()];
+  if (!offload_stream) {
+    offload_stream = std::make_unique<phi::CUDAStream>(
+        place, 0, phi::CUDAStream::StreamFlag::kStreamNonBlocking);
+  }
+
+  std::shared_ptr<OffloadedTensor> offloaded(new OffloadedTensor());
+  offloaded->place_ = place;
+  offloaded->size_ = size;
+  offloaded->compute_stream_ =
+      static_cast<phi::GPUContext*>(
+          phi::DeviceContextPool::Instance().Get(place))
+          ->stream();
+  offloaded->offload_stream_ = offload_stream->raw_stream();
+  offloaded->host_buffer_ =
+      paddle::memory::AllocShared(phi::GPUPinnedPlace(), size);
+  // Copies out once the kernel producing the tensor is done
+  StreamWaitStream(offloaded->offload_stream_, offloaded->compute_stream_);
+  paddle::platform::GpuMemcpyAsync(offloaded->host_buffer_->ptr(),
+                                   holder->ptr(),
+                                   size,
+                                   kDeviceToHost,
+                                   offloaded->offload_stream_);
+  offloaded->offloaded_event_ = std::make_unique<phi::CudaEvent>(kEventFlags);
+  offloaded->offloaded_event_->Record(offloaded->offload_stream_);
+  // The memory of the tensor is not reused before the copy is done
+  paddle::memory::RecordStream(holder, offloaded->offload_stream_);
+
+  offloaded_tensors_.emplace_back(offloaded);
+  VLOG(6) << "Offload " << size << " bytes of activation to pinned memory";
+  return offloaded;
+#else
+  return nullptr;
+#endif
+}
+
+void ActivationOffloader::Prefetch() {
+  if (FLAGS_eager_activation_offload_budget_mb < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  while (num_prefetching_ < FLAGS_eager_activation_offload_prefetch_num &&
+         !offloaded_tensors_.empty()) {
+    std::shared_ptr<OffloadedTensor> offloaded =
+        offloaded_tensors_.back().lock();
+    offloaded_tensors_.pop_back();
+    if (!offloaded) continue;
+    std::lock_guard<std::mutex> tensor_guard(offloaded->mutex_);
+    // Skip the ones loaded on demand
+    if (offloaded->device_buffer_) continue;
+    offloaded->CopyBack();
+    offloaded->prefetched_ = true;
+    ++num_prefetching_;
+  }
+}
+
+void ActivationOffloader::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  saved_bytes_ = 0;
+  offloaded_tensors_.clear();
+  num_prefetching_ = 0;
+}
+
+void ActivationOffloader::OnPrefetchedLoaded() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (num_prefetching_ > 0) {
+    --num_prefetching_;
+  }
+}
+
+}  // namespace egr
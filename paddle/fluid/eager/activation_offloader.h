@@ -0,0 +1,115 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/test_macros.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/api/profiler/event.h"
+#include "paddle/phi/core/cuda_stream.h"
+#endif
+
+namespace egr {
+
+/**
+ * The buffer of a saved activation kept in pinned host memory between the
+ * forward and the backward. It is copied out on the side stream of its
+ * device once the kernel producing it is done, and copied back on the same
+ * stream by Prefetch. The compute stream only waits for the copies by
+ * events, the host never blocks on them.
+ **/
+class OffloadedTensor {
+ public:
+  ~OffloadedTensor();
+
+  // Returns the buffer on the device, the kernels launched on the compute
+  // stream after it see the copied back data.
+  TEST_API std::shared_ptr<phi::Allocation> Load();
+
+ private:
+  friend class ActivationOffloader;
+  OffloadedTensor() = default;
+  DISABLE_COPY_AND_ASSIGN(OffloadedTensor);
+
+  // Issues the copy back to the device, requires mutex_ to be held.
+  void CopyBack();
+
+  std::mutex mutex_;
+  phi::Place place_;
+  size_t size_{0};
+  // whether the copy back is issued by ActivationOffloader::Prefetch and not
+  // loaded yet
+  bool prefetched_{false};
+  std::shared_ptr<phi::Allocation> host_buffer_;
+  std::shared_ptr<phi::Allocation> device_buffer_;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  gpuStream_t compute_stream_{nullptr};
+  gpuStream_t offload_stream_{nullptr};
+  std::unique_ptr<phi::CudaEvent> offloaded_event_;
+  std::unique_ptr<phi::CudaEvent> loaded_event_;
+#endif
+};
+
+/**
+ * ActivationOffloader moves the activations saved by TensorWrapper to pinned
+ * host memory, see FLAGS_eager_activation_offload_budget_mb. The ones saved
+ * within the budget of a forward stay on the device, the later ones are
+ * offloaded.
+ *
+ * The backward needs the activations about in the reverse order they are
+ * saved, so before each grad node runs, the latest offloaded activations are
+ * prefetched, keeping FLAGS_eager_activation_offload_prefetch_num of them in
+ * flight. An activation needed before its prefetch is copied back on demand.
+ **/
+class ActivationOffloader {
+ public:
+  TEST_API static ActivationOffloader& Instance();
+
+  // Returns nullptr if the buffer of tensor stays on the device.
+  TEST_API std::shared_ptr<OffloadedTensor> Offload(
+      const phi::DenseTensor& tensor);
+
+  // Called before a grad node runs.
+  TEST_API void Prefetch();
+
+  // Called at the end of a backward, the next forward starts a new budget.
+  TEST_API void Reset();
+
+ private:
+  ActivationOffloader() = default;
+  DISABLE_COPY_AND_ASSIGN(ActivationOffloader);
+
+  friend class OffloadedTensor;
+  void OnPrefetchedLoaded();
+
+  std::mutex mutex_;
+  int64_t saved_bytes_{0};
+  // the offloaded tensors in the order they are saved
+  std::vector<std::weak_ptr<OffloadedTensor>> offloaded_tensors_;
+  int64_t num_prefetching_{0};
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // device id -> the side stream of the copies
+  std::map<int, std::unique_ptr<phi::CUDAStream>> offload_streams_;
+#endif
+};
+
+}  // namespace egr
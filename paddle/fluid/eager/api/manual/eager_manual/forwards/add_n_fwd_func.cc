@@ -16,6 +16,7 @@
 #include "paddle/fluid/eager/api/manual/eager_manual/dygraph_forward_api.h"
 #include "paddle/fluid/eager/api/manual/eager_manual/nodes/nodes.h"
 #include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/eager/lazy_recorder.h"
 #include "paddle/fluid/eager/nan_inf_utils.h"
 #include "paddle/fluid/imperative/amp_utils.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
@@ -23,6 +24,10 @@
 COMMON_DECLARE_bool(check_nan_inf);
 
 paddle::Tensor add_n_ad_func(const std::vector<paddle::Tensor>& x) {
+  // Lazy mode
+  if (UNLIKELY(egr::LazyRecorder::IsActive())) {
+    egr::LazyRecorder::Instance().Flush();
+  }
   // Dygraph Record Event
   phi::RecordEvent dygraph_entrance_record_event(
       "add_n dygraph", phi::TracerEventType::Operator, 1);
@@ -17,6 +17,7 @@
 #include "paddle/fluid/eager/api/manual/eager_manual/nodes/nodes.h"
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/eager_layout_auto_tune.h"
+#include "paddle/fluid/eager/lazy_recorder.h"
 #include "paddle/fluid/eager/nan_inf_utils.h"
 #include "paddle/fluid/imperative/amp_utils.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
@@ -31,6 +32,10 @@ paddle::Tensor conv2d_ad_func(const paddle::Tensor& input,
                               std::vector<int> dilations,
                               int groups,
                               std::string data_format) {
+  // Lazy mode
+  if (UNLIKELY(egr::LazyRecorder::IsActive())) {
+    egr::LazyRecorder::Instance().Flush();
+  }
   // Dygraph Record Event
   phi::RecordEvent dygraph_entrance_record_event(
       "conv2d dygraph", phi::TracerEventType::Operator, 1);
@@ -17,9 +17,11 @@
 #include "paddle/fluid/eager/api/manual/eager_manual/nodes/nodes.h"
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/eager_layout_auto_tune.h"
+#include "paddle/fluid/eager/lazy_recorder.h"
 #include "paddle/fluid/eager/nan_inf_utils.h"
 #include "paddle/fluid/eager/type_promotion_utils.h"
 #include "paddle/fluid/imperative/amp_utils.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_api.h"
 #include "paddle/phi/api/include/sparse_api.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/common/type_promotion.h"
@@ -41,6 +43,17 @@ paddle::Tensor multiply_ad_func(const paddle::Tensor& x,
   FLAGS_tensor_operants_mode = "eager";
   VLOG(3) << "Running AD API: "
           << "multiply";
+  // Lazy mode
+  if (UNLIKELY(egr::LazyRecorder::IsActive())) {
+    auto& lazy_recorder = egr::LazyRecorder::Instance();
+    if (lazy_recorder.CanRecord({&x, &y})) {
+      return lazy_recorder.Record([&]() {
+        return paddle::dialect::multiply(lazy_recorder.Input(x),
+                                         lazy_recorder.Input(y));
+      });
+    }
+    lazy_recorder.Flush();
+  }
   // Dygraph Record Event
   phi::RecordEvent dygraph_entrance_record_event(
       "multiply dygraph", phi::TracerEventType::Operator, 1);
@@ -239,6 +252,10 @@ paddle::Tensor& multiply__ad_func(paddle::Tensor& x,  // NOLINT
   FLAGS_tensor_operants_mode = "eager";
   VLOG(3) << "Running AD API: "
           << "multiply_";
+  // Lazy mode
+  if (UNLIKELY(egr::LazyRecorder::IsActive())) {
+    egr::LazyRecorder::Instance().Flush();
+  }
   // Dygraph Record Event
   phi::RecordEvent dygraph_entrance_record_event(
       "multiply_ dygraph", phi::TracerEventType::Operator, 1);
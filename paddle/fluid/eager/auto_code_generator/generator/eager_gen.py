@@ -155,6 +155,44 @@ strided_op_list = {
     "view_dtype",
 }
 
+# ops whose saved outputs can be dropped after the forward and recomputed
+# from their saved inputs by the backward, see egr::RecomputePolicy
+recompute_op_list = {
+    "elu",
+    "exp",
+    "relu",
+    "relu6",
+    "sigmoid",
+    "silu",
+    "softmax",
+    "sqrt",
+    "rsqrt",
+    "tanh",
+}
+
+# ops which can be recorded into the PIR programs of the lazy mode, see
+# egr::LazyRecorder. Their attributes are passed to the paddle::dialect api
+# as they are
+lazy_op_list = {
+    "abs",
+    "add",
+    "divide",
+    "exp",
+    "gelu",
+    "leaky_relu",
+    "log",
+    "matmul",
+    "maximum",
+    "minimum",
+    "relu",
+    "sigmoid",
+    "silu",
+    "softmax",
+    "sqrt",
+    "subtract",
+    "tanh",
+}
+
 strided_op_need_flags_check_list = {
     "as_complex_",
     "as_real_",
@@ -206,6 +244,11 @@ SET_VECTOR_TENSOR_WRAPPER_TEMPLATE = """  void SetTensorWrapper_{}(const std::ve
   }}
 """
 
+SET_RECOMPUTE_FUNCTION_TEMPLATE = """  void SetRecomputeFunction_{}(egr::RecomputeFunction fn) {{
+    {}.SetRecomputeFunction(std::move(fn));
+  }}
+"""
+
 PLAIN_TENSOR_MEMBER_TEMPLATE = """  egr::TensorWrapper {};
 """
 
@@ -317,6 +360,8 @@ FORWARD_FUNCTION_TEMPLATE = """
 TEST_API {} {}({}) {{
   FLAGS_tensor_operants_mode = "eager";
   VLOG(3) << \"Running AD API: \" << \"{}\";
+{}
+  // Lazy mode
 {}
   // Dygraph Record Event
 {}
@@ -394,6 +439,8 @@ FORWARD_ONLY_FUNCTION_TEMPLATE = """
 TEST_API {} {}({}) {{
   FLAGS_tensor_operants_mode = "eager";
   VLOG(3) << \"Running AD API: \" << \"{}\";
+{}
+  // Lazy mode
 {}
   // Dygraph Record Event
 {}
@@ -531,6 +578,8 @@ FORWARD_CC_FILE_TEMPLATE = """
 #include "paddle/common/flags.h"
 #include "paddle/phi/api/lib/data_transform.h"
 #include "paddle/fluid/eager/type_promotion_utils.h"
+#include "paddle/fluid/eager/lazy_recorder.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_api.h"
 #include "paddle/phi/common/type_promotion.h"
 #include "paddle/fluid/imperative/amp_utils.h"
 
@@ -1093,6 +1142,87 @@ class DygraphFunctionGeneratorBase(FunctionGeneratorBase):
         pass_stop_gradient_args_str = ",".join(pass_stop_gradient_args_list)
         return pass_stop_gradient_args_str
 
+    def IsRecomputable(self):
+        if self.forward_api_name not in recompute_op_list:
+            return False
+        if self.namespace != "" or len(self.intermediate_outputs) > 0:
+            return False
+        if len(self.forward_outputs_position_map) != 1:
+            return False
+        for name, (ttype, _) in self.forward_inputs_position_map.items():
+            if not IsPlainTensorType(ttype) or name in self.optional_inputs:
+                return False
+        return True
+
+    def GenerateRecomputeCode(self, output_name, indent):
+        # The recompute function saves the inputs in TensorWrappers to check
+        # their inplace versions, and copies the attributes
+        num_args = len(self.forward_inputs_position_map) + len(
+            self.forward_attrs_list
+        )
+        captures = []
+        call_args = ["" for i in range(num_args)]
+        for name, (_, pos) in self.forward_inputs_position_map.items():
+            captures.append(f"{name}_saved = egr::TensorWrapper({name})")
+            call_args[pos] = f"{name}_saved.recover()"
+        for name, _, _, pos in self.forward_attrs_list:
+            captures.append(name)
+            call_args[pos] = name
+        captures_str = ", ".join(captures)
+        call_args_str = ", ".join(call_args)
+        return (
+            f"{indent}if (egr::RecomputePolicy::Instance().ShouldRecompute(\"{self.forward_api_name}\", {output_name})) {{\n"
+            f"{indent}  grad_node->SetRecomputeFunction_{output_name}([{captures_str}]() mutable {{\n"
+            f"{indent}    return paddle::experimental::{self.forward_api_name}({call_args_str});\n"
+            f"{indent}  }});\n"
+            f"{indent}}}"
+        )
+
+    def IsLazyRecordable(self, is_inplaced):
+        if is_inplaced or self.forward_api_name not in lazy_op_list:
+            return False
+        if self.namespace != "" or len(self.intermediate_outputs) > 0:
+            return False
+        if len(self.forward_outputs_position_map) != 1:
+            return False
+        for name, (ttype, _) in self.forward_inputs_position_map.items():
+            if not IsPlainTensorType(ttype) or name in self.optional_inputs:
+                return False
+        return True
+
+    def GenerateLazyModeCode(self, is_inplaced, indent):
+        # The ops not recorded run the ones recorded before them, which may
+        # produce their inputs
+        if not self.IsLazyRecordable(is_inplaced):
+            return (
+                f"{indent}if (UNLIKELY(egr::LazyRecorder::IsActive())) {{\n"
+                f"{indent}  egr::LazyRecorder::Instance().Flush();\n"
+                f"{indent}}}"
+            )
+        num_args = len(self.forward_inputs_position_map) + len(
+            self.forward_attrs_list
+        )
+        inputs = ["" for i in range(len(self.forward_inputs_position_map))]
+        call_args = ["" for i in range(num_args)]
+        for name, (_, pos) in self.forward_inputs_position_map.items():
+            inputs[pos] = f"&{name}"
+            call_args[pos] = f"lazy_recorder.Input({name})"
+        for name, _, _, pos in self.forward_attrs_list:
+            call_args[pos] = name
+        inputs_str = ", ".join(inputs)
+        call_args_str = ", ".join(call_args)
+        return (
+            f"{indent}if (UNLIKELY(egr::LazyRecorder::IsActive())) {{\n"
+            f"{indent}  auto& lazy_recorder = egr::LazyRecorder::Instance();\n"
+            f"{indent}  if (lazy_recorder.CanRecord({{{inputs_str}}})) {{\n"
+            f"{indent}    return lazy_recorder.Record([&]() {{\n"
+            f"{indent}      return paddle::dialect::{self.forward_api_name}({call_args_str});\n"
+            f"{indent}    }});\n"
+            f"{indent}  }}\n"
+            f"{indent}  lazy_recorder.Flush();\n"
+            f"{indent}}}"
+        )
+
     def GenerateNodeCreationCodes(self, for_backward=False, is_inplaced=False):
         forward_api_name = self.forward_api_name
         forward_inputs_position_map = self.forward_inputs_position_map
@@ -1205,6 +1335,10 @@ class DygraphFunctionGeneratorBase(FunctionGeneratorBase):
                 set_tensor_wrappers = (
                     f"{indent}grad_node->SetTensorWrapper_{name}({name});"
                 )
+                if not for_backward and not is_inplaced and self.IsRecomputable():
+                    set_tensor_wrappers += "\n" + self.GenerateRecomputeCode(
+                        name, indent
+                    )
                 set_output_tensor_wrappers_list.append(set_tensor_wrappers)
         set_input_tensor_wrappers_str = "\n".join(
             set_input_tensor_wrappers_list
@@ -2002,6 +2136,7 @@ class DygraphForwardFunctionGenerator(DygraphFunctionGeneratorBase):
             forward_api_name in strided_op_need_flags_check_list
         ):
             strided_flags_check = STRIDED_FLAGS_CHECK_TEMPLATE
+        lazy_mode_str = self.GenerateLazyModeCode(is_inplaced, indent)
         # Generate forward_definition_str and forward_declaration_str
         if self.is_forward_only:
             if len(amp_tensors_vector_list) == 0:
@@ -2013,6 +2148,7 @@ class DygraphForwardFunctionGenerator(DygraphFunctionGeneratorBase):
                     inputs_args_definition_str,
                     forward_api_name,
                     strided_flags_check,
+                    lazy_mode_str,
                     dygraph_event_str,
                     amp_logic_str,
                     type_promotion_logic_str,
@@ -2037,6 +2173,7 @@ class DygraphForwardFunctionGenerator(DygraphFunctionGeneratorBase):
                 inputs_args_definition_str,
                 forward_api_name,
                 strided_flags_check,
+                lazy_mode_str,
                 dygraph_event_str,
                 amp_logic_str,
                 type_promotion_logic_str,
@@ -2305,6 +2442,12 @@ class DygraphNodeGenerator(DygraphFunctionGeneratorBase):
                         tname, tname, tensor_wrapper_name, tname, no_need_buffer
                     )
                 )
+                if not is_fwd_input and self.IsRecomputable():
+                    set_tensor_wrapper_methods_str += (
+                        SET_RECOMPUTE_FUNCTION_TEMPLATE.format(
+                            tname, tensor_wrapper_name
+                        )
+                    )
 
                 tensor_wrapper_members_str += (
                     PLAIN_TENSOR_MEMBER_TEMPLATE.format(tensor_wrapper_name)
@@ -14,9 +14,22 @@
 
 #include "paddle/fluid/eager/backward.h"
 
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <mutex>  // NOLINT
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/activation_offloader.h"
 #include "paddle/fluid/eager/general_grad.h"
+#include "paddle/phi/core/memory/allocation/step_replay_allocator.h"
 #include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_int32(eager_backward_num_threads);
 
 namespace egr {
 
@@ -102,6 +115,211 @@ void DuplicateCheck(const std::vector<paddle::Tensor>& inputs, bool is_input) {
 
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
+namespace {
+
+// Runs the grad nodes of a backward on a thread pool, a node is dispatched
+// once all the nodes it depends on have run, see
+// FLAGS_eager_backward_num_threads. The nodes run on the pool threads with the
+// tracer and the grad mode of the calling thread.
+class ParallelGradNodeRunner {
+ public:
+  ParallelGradNodeRunner(
+      std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+      std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+          node_input_buffers_dict,
+      bool retain_graph,
+      const phi::Place& place)
+      : node_in_degree_map_(node_in_degree_map),
+        node_input_buffers_dict_(node_input_buffers_dict),
+        retain_graph_(retain_graph),
+        place_(place),
+        tracer_(egr::Controller::Instance().GetCurrentTracer()),
+        has_grad_(egr::Controller::Instance().HasGrad()) {}
+
+  // Runs until all the nodes reachable from startup_nodes are done, rethrows
+  // the first exception thrown by a node.
+  void Run(const std::deque<GradNodeBase*>& startup_nodes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (GradNodeBase* node : startup_nodes) {
+      Schedule(node);
+    }
+    done_cv_.wait(lock, [this] { return num_pending_nodes_ == 0; });
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+ private:
+  static phi::ThreadPool* Pool() {
+    static std::unique_ptr<phi::ThreadPool> pool =
+        std::make_unique<phi::ThreadPool>(FLAGS_eager_backward_num_threads);
+    return pool.get();
+  }
+
+  // Requires mutex_ to be held.
+  void Schedule(GradNodeBase* node) {
+    ++num_pending_nodes_;
+    Pool()->Run([this, node] {
+      try {
+        RunNode(node);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!exception_) exception_ = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (--num_pending_nodes_ == 0) done_cv_.notify_all();
+    });
+  }
+
+  std::mutex* HolderMutex(GradNodeBase* node) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& holder_mutex = holder_mutexes_[node];
+    if (!holder_mutex) holder_mutex = std::make_unique<std::mutex>();
+    return holder_mutex.get();
+  }
+
+  void RunNode(GradNodeBase* node) {
+    std::unique_ptr<GradTensorHolder> node_input_buffer;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      // Skip the rest of the graph once a node failed
+      if (exception_) return;
+      auto node_input_buffer_iter = node_input_buffers_dict_->find(node);
+      PADDLE_ENFORCE_NE(
+          node_input_buffer_iter,
+          node_input_buffers_dict_->end(),
+          common::errors::Fatal(
+              "Unable to find next node in the GradTensorHolder \n"
+              "Trying to run Node without configuring its GradTensorHolder."));
+      node_input_buffer = std::move(node_input_buffer_iter->second);
+      node_input_buffers_dict_->erase(node_input_buffer_iter);
+    }
+
+    if (egr::Controller::Instance().GetCurrentTracer() != tracer_) {
+      egr::Controller::Instance().SetCurrentTracer(tracer_);
+    }
+    egr::Controller::Instance().SetHasGrad(has_grad_);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (phi::is_gpu_place(place_)) {
+      phi::backends::gpu::SetDeviceId(place_.GetDeviceId());
+    }
+#endif
+
+    EnforceGradNodeHasInput(node);
+    egr::ActivationOffloader::Instance().Prefetch();
+
+    phi::RecordEvent grad_node_record_event(
+        "Global_" + std::string((*node).name()),
+        phi::TracerEventType::Operator,
+        1);
+
+    // The hooks of the leaf tensors, e.g. the ones of the reducer of data
+    // parallel, are not thread safe, so the accumulation nodes run one by one.
+    std::unique_lock<std::mutex> accumulation_lock(accumulation_mutex_,
+                                                   std::defer_lock);
+    if (dynamic_cast<egr::GradNodeAccumulation*>(node)) {
+      accumulation_lock.lock();
+    }
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
+        grad_output_tensors = (*node)(node_input_buffer->Buffers(),
+                                      /*create_graph=*/false,
+                                      /*is_new_grad=*/false);
+    if (accumulation_lock.owns_lock()) {
+      accumulation_lock.unlock();
+    }
+
+    if (!retain_graph_) {
+      node->ClearTensorWrappers();
+    }
+
+    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+        metas = node->OutputMeta();
+    PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
+                   common::errors::Fatal(
+                       "Number of edges should be either empty ( for leaf node "
+                       ") or the same as number of output grad tensors, but we "
+                       "got edges size is: %d, grad_output size is: %d",
+                       metas.size(),
+                       grad_output_tensors.size()));
+
+    for (size_t i = 0; i < metas.size(); i++) {
+      for (size_t j = 0; j < metas[i].size(); j++) {
+        const Edge& edge = metas[i][j].GetEdge();
+        if (!edge.IsInitialized()) {
+          continue;
+        }
+        auto edge_rank = edge.GetEdgeRankInfo();
+        auto next_node_shared = edge.GetMutableGradNode();
+        if (!next_node_shared || !next_node_shared.get() ||
+            grad_output_tensors[i].empty()) {
+          continue;
+        }
+        PADDLE_ENFORCE_LT(
+            j,
+            grad_output_tensors[i].size(),
+            common::errors::Fatal(
+                "Rank of grad_output_tensors should be less than "
+                "grad_output_tensors[i].size(), which is: %d. This error may "
+                "indicate autoprune or autograd api error. ",
+                grad_output_tensors.size()));
+        auto* next_node = next_node_shared.get();
+
+        GradTensorHolder* next_node_input_buffer = nullptr;
+        {
+          std::lock_guard<std::mutex> guard(mutex_);
+          auto& holder = (*node_input_buffers_dict_)[next_node];
+          if (!holder) {
+            holder = std::make_unique<GradTensorHolder>(next_node->InputMeta());
+          }
+          next_node_input_buffer = holder.get();
+        }
+        // The grads of the inputs of different nodes are summed concurrently,
+        // the ones of the same node one by one.
+        {
+          std::lock_guard<std::mutex> guard(*HolderMutex(next_node));
+          next_node_input_buffer->add(edge_rank.first,
+                                      edge_rank.second,
+                                      grad_output_tensors[i][j],
+                                      /*create_graph=*/false);
+        }
+
+        std::lock_guard<std::mutex> guard(mutex_);
+        int& in_degree = (*node_in_degree_map_)[next_node];
+        --in_degree;
+        PADDLE_ENFORCE(
+            in_degree >= 0,
+            common::errors::Fatal(
+                "Detected in-degree value smaller than zero. For Node: %s"
+                "Node's in-degree cannot be negative.",
+                next_node->name()));
+        if (in_degree == 0) {
+          Schedule(next_node);
+        }
+      }
+    }
+    paddle::memory::LogDeviceMemoryStats(place_, std::string((*node).name()));
+  }
+
+  std::unordered_map<GradNodeBase*, int>* node_in_degree_map_;
+  std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+      node_input_buffers_dict_;
+  const bool retain_graph_;
+  const phi::Place place_;
+  const std::shared_ptr<paddle::imperative::Tracer> tracer_;
+  const bool has_grad_;
+
+  // guards the maps, the counter and the exception
+  std::mutex mutex_;
+  std::condition_variable done_cv_;
+  size_t num_pending_nodes_{0};
+  std::exception_ptr exception_;
+  std::unordered_map<GradNodeBase*, std::unique_ptr<std::mutex>>
+      holder_mutexes_;
+  std::mutex accumulation_mutex_;
+};
+
+}  // namespace
+
 std::vector<paddle::Tensor> RunBackward(
     const std::vector<paddle::Tensor>& tensors,  // output
     const std::vector<paddle::Tensor>& grad_tensors,
@@ -112,6 +330,7 @@ std::vector<paddle::Tensor> RunBackward(
     const std::vector<paddle::Tensor>& no_grad_vars = {}) {
   VLOG(3) << "Start Backward";
 
+  bool is_nested_backward = egr::Controller::Instance().GetIsInBackward();
   egr::EagerBackwardStateGuard guard;
   auto place = egr::Controller::Instance().GetExpectedPlace();
 
@@ -243,6 +462,24 @@ std::vector<paddle::Tensor> RunBackward(
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
+  bool run_in_parallel = FLAGS_eager_backward_num_threads > 1 &&
+                         !is_general_grad && !create_graph &&
+                         !is_nested_backward &&
+                         force_sequential_nodes_set.empty();
+  // The startup nodes depending on each other are left to the sequential
+  // visit, which runs them in the order they are given
+  for (size_t i = 0; run_in_parallel && i < queue.size(); ++i) {
+    run_in_parallel = node_in_degree_map[queue[i]] == 0;
+  }
+  if (run_in_parallel) {
+    VLOG(3) << "Run backward on " << FLAGS_eager_backward_num_threads
+            << " threads";
+    ParallelGradNodeRunner(
+        &node_in_degree_map, &node_input_buffers_dict, retain_graph, place)
+        .Run(queue);
+    queue.clear();
+  }
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
@@ -275,6 +512,9 @@ std::vector<paddle::Tensor> RunBackward(
     // Check input
     EnforceGradNodeHasInput(node);
 
+    // Copy back the offloaded activations the next nodes need
+    egr::ActivationOffloader::Instance().Prefetch();
+
     VLOG(7) << "Run Backward Kernel with GradTensorHolder.";
 
     // This 'Global_XXXGradNode' record event is different with
@@ -431,6 +671,9 @@ std::vector<paddle::Tensor> RunBackward(
     (*hook)();
   }
   egr::Controller::Instance().ClearFinalBackwardHooks();
+  if (!is_nested_backward) {
+    egr::ActivationOffloader::Instance().Reset();
+  }
   if (!is_general_grad) return {};
   VLOG(3) << "Finish Backward";
   return GeneralGrad::Instance().GetResults(inputs, allow_unused, create_graph);
@@ -445,6 +688,7 @@ void Backward(const std::vector<paddle::Tensor>& tensors,  // outputs
   RunBackward(tensors, grad_tensors, retain_graph);
   egr::Controller::Instance().ClearForceSequentialNodes();
   phi::autotune::AutoTuneStatus::Instance().Update();
+  paddle::memory::allocation::StepReplayAllocator::MarkStep();
 }
 
 std::vector<paddle::Tensor> Grad(
@@ -0,0 +1,355 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/lazy_recorder.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/eager/autograd_meta.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/imperative/amp_auto_cast.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/api_builder.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/platform/profiler/event_tracing.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/builtin_type.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/pass/pass_manager.h"
+#ifdef PADDLE_WITH_CINN
+#include "paddle/cinn/hlir/dialect/operator/ir/op_dialect.h"
+#include "paddle/cinn/hlir/dialect/operator/transforms/add_cinn_pass.h"
+#include "paddle/pir/include/dialect/shape/ir/shape_dialect.h"
+#endif
+
+COMMON_DECLARE_bool(eager_lazy_mode);
+COMMON_DECLARE_int64(eager_lazy_mode_max_ops);
+COMMON_DECLARE_bool(check_nan_inf);
+#ifdef PADDLE_WITH_CINN
+COMMON_DECLARE_bool(use_cinn);
+#endif
+
+namespace egr {
+
+namespace {
+
+constexpr char kInputPrefix[] = "lazy_input_";
+constexpr char kOutputPrefix[] = "lazy_output_";
+// The compiled programs of a thread are dropped all together beyond it, which
+// only happens to the ops recorded with ever changing shapes.
+constexpr size_t kMaxCompiledPrograms = 256;
+
+std::string InputName(size_t i) { return kInputPrefix + std::to_string(i); }
+std::string OutputName(size_t i) { return kOutputPrefix + std::to_string(i); }
+
+// A recorded program lowered to the kernels, with the scope its inputs are
+// fed into and its outputs are taken from.
+struct CompiledProgram {
+  std::unique_ptr<pir::Program> kernel_program;
+  paddle::framework::Scope scope;
+  std::unique_ptr<paddle::framework::InterpreterCore> executor;
+};
+
+// The key of the structure of a recorded program, i.e. the names and the
+// attributes of its ops, the results their operands are and the types of
+// their results. The attributes and the types are uniqued by the IrContext,
+// so that their storages tell them apart.
+std::string StructureKey(pir::Program* program) {
+  std::string key;
+  auto append = [&key](size_t n) {
+    key.append(reinterpret_cast<const char*>(&n), sizeof(n));
+  };
+  std::unordered_map<pir::Value, size_t> value_ids;
+  for (auto& op : *program->block()) {
+    key.append(op.name());
+    key.push_back('\0');
+    std::vector<std::pair<std::string, pir::Attribute>> attrs(
+        op.attributes().begin(), op.attributes().end());
+    std::sort(attrs.begin(), attrs.end(), [](const auto& a, const auto& b) {
+      return a.first < b.first;
+    });
+    for (auto& [name, attr] : attrs) {
+      key.append(name);
+      key.push_back('\0');
+      append(std::hash<pir::Attribute>()(attr));
+    }
+    for (size_t i = 0; i < op.num_operands(); ++i) {
+      append(value_ids.at(op.operand_source(i)));
+    }
+    for (size_t i = 0; i < op.num_results(); ++i) {
+      append(std::hash<pir::Type>()(op.result(i).type()));
+      value_ids.emplace(op.result(i), value_ids.size());
+    }
+  }
+  return key;
+}
+
+#ifdef PADDLE_WITH_CINN
+std::shared_ptr<pir::PassManager> CreateCinnPassManager() {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<cinn::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::shape::ShapeDialect>();
+  return std::make_shared<pir::PassManager>(ctx);
+}
+#endif
+
+std::unique_ptr<CompiledProgram> Compile(pir::Program* program,
+                                         const phi::Place& place,
+                                         size_t num_inputs,
+                                         size_t num_outputs) {
+  pir::PassManager pm(pir::IrContext::Instance());
+  pm.AddPass(pir::CreateDeadCodeEliminationPass());
+  pm.Run(program);
+#ifdef PADDLE_WITH_CINN
+  if (FLAGS_use_cinn && phi::is_gpu_place(place)) {
+    cinn::dialect::ir::ApplyCinnPass(program, CreateCinnPassManager);
+  }
+#endif
+
+  auto compiled = std::make_unique<CompiledProgram>();
+  compiled->kernel_program =
+      paddle::dialect::PdOpLowerToKernelPass(program, place);
+
+  paddle::framework::interpreter::ExecutionConfig config;
+  config.create_local_scope = false;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    compiled->scope.Var(InputName(i))->GetMutable<phi::DenseTensor>();
+    config.skip_gc_vars.insert(InputName(i));
+  }
+  for (size_t i = 0; i < num_outputs; ++i) {
+    config.skip_gc_vars.insert(OutputName(i));
+  }
+  compiled->executor = std::make_unique<paddle::framework::InterpreterCore>(
+      place,
+      std::vector<std::string>{},
+      compiled->kernel_program->block(),
+      &compiled->scope,
+      config);
+  return compiled;
+}
+
+std::unordered_map<std::string, std::unique_ptr<CompiledProgram>>&
+CompiledPrograms() {
+  thread_local std::unordered_map<std::string,
+                                  std::unique_ptr<CompiledProgram>>
+      programs;
+  return programs;
+}
+
+}  // namespace
+
+LazyRecorder& LazyRecorder::Instance() {
+  thread_local LazyRecorder recorder;
+  return recorder;
+}
+
+bool LazyRecorder::IsActive() {
+  return FLAGS_eager_lazy_mode || Instance().HasPendingOps();
+}
+
+const LazyRecorder::RecordedValue* LazyRecorder::FindRecorded(
+    const paddle::Tensor& tensor) const {
+  auto it = recorded_.find(tensor.impl().get());
+  if (it == recorded_.end() || it->second.tensor.expired()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+bool LazyRecorder::CanRecord(
+    std::initializer_list<const paddle::Tensor*> inputs) {
+  if (!FLAGS_eager_lazy_mode || FLAGS_check_nan_inf || inputs.size() == 0) {
+    return false;
+  }
+  auto& controller = Controller::Instance();
+  if (controller.GetAMPLevel() != paddle::imperative::AmpLevel::O0 ||
+      controller.UseLayoutAutoTune()) {
+    return false;
+  }
+  const bool trace_backward = controller.HasGrad();
+  bool has_place = program_ != nullptr;
+  phi::Place place = place_;
+  phi::DataType dtype = phi::DataType::UNDEFINED;
+  for (const paddle::Tensor* input : inputs) {
+    if (!input->defined() || !input->is_dense_tensor()) {
+      return false;
+    }
+    auto* meta = static_cast<AutogradMeta*>(input->get_autograd_meta());
+    if (trace_backward && meta && !meta->StopGradient()) {
+      return false;
+    }
+    auto* dense = static_cast<phi::DenseTensor*>(input->impl().get());
+    if (!dense->meta().is_contiguous() ||
+        (dtype != phi::DataType::UNDEFINED && dense->dtype() != dtype)) {
+      return false;
+    }
+    dtype = dense->dtype();
+    if (FindRecorded(*input)) {
+      continue;
+    }
+    if (!dense->initialized()) {
+      return false;
+    }
+    if (!has_place) {
+      place = dense->place();
+      has_place = true;
+    } else if (dense->place() != place) {
+      return false;
+    }
+  }
+  if (!phi::is_cpu_place(place) && !phi::is_gpu_place(place)) {
+    return false;
+  }
+  if (!program_) {
+    pir::IrContext* ctx = pir::IrContext::Instance();
+    ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+    ctx->GetOrRegisterDialect<paddle::dialect::KernelDialect>();
+    program_ = std::make_unique<pir::Program>(ctx);
+    place_ = place;
+  }
+  return true;
+}
+
+pir::Value LazyRecorder::Input(const paddle::Tensor& tensor) {
+  if (const RecordedValue* recorded = FindRecorded(tensor)) {
+    return recorded->value;
+  }
+  auto dense = std::static_pointer_cast<phi::DenseTensor>(tensor.impl());
+  pir::Builder builder(pir::IrContext::Instance(), program_->block());
+  pir::Value value = builder
+                         .Build<paddle::dialect::DataOp>(
+                             InputName(inputs_.size()),
+                             common::vectorize<int64_t>(dense->dims()),
+                             dense->dtype(),
+                             place_)
+                         .out();
+  recorded_[dense.get()] = RecordedValue{value, dense};
+  inputs_.push_back(std::move(dense));
+  return value;
+}
+
+paddle::Tensor LazyRecorder::Record(const std::function<pir::Value()>& build) {
+  auto& api_builder = paddle::dialect::ApiBuilder::Instance();
+  api_builder.PushInsertionPoint();
+  api_builder.SetInsertionPointToBlockEnd(program_->block());
+  pir::Value value;
+  try {
+    value = build();
+  } catch (...) {
+    api_builder.LoadInsertionPoint();
+    throw;
+  }
+  api_builder.LoadInsertionPoint();
+
+  auto type = value.type().dyn_cast<pir::DenseTensorType>();
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(type),
+      true,
+      common::errors::InvalidArgument(
+          "The ops recorded by the lazy mode should output a DenseTensor."));
+  auto out = std::make_shared<phi::DenseTensor>();
+  out->set_meta(
+      phi::DenseTensorMeta(paddle::dialect::TransToPhiDataType(type.dtype()),
+                           type.dims(),
+                           type.data_layout()));
+  recorded_[out.get()] = RecordedValue{value, out};
+  outputs_.emplace_back(value, out);
+  paddle::Tensor result(out);
+  if (++num_ops_ >= FLAGS_eager_lazy_mode_max_ops) {
+    Flush();
+  }
+  return result;
+}
+
+void LazyRecorder::Flush() {
+  if (!program_) {
+    return;
+  }
+  std::unique_ptr<pir::Program> program = std::move(program_);
+  std::vector<std::shared_ptr<phi::DenseTensor>> inputs;
+  inputs_.swap(inputs);
+  std::vector<std::pair<pir::Value, std::weak_ptr<phi::DenseTensor>>> outputs;
+  outputs_.swap(outputs);
+  recorded_.clear();
+  const int64_t num_ops = num_ops_;
+  num_ops_ = 0;
+
+  // Only the outputs still alive are computed, the ops of the others are
+  // eliminated as dead code.
+  std::vector<std::shared_ptr<phi::DenseTensor>> alive_outputs;
+  pir::Builder builder(pir::IrContext::Instance(), program->block());
+  for (auto& [value, weak_out] : outputs) {
+    if (auto out = weak_out.lock()) {
+      builder.Build<pir::ShadowOutputOp>(value,
+                                         OutputName(alive_outputs.size()));
+      alive_outputs.push_back(std::move(out));
+    }
+  }
+  if (alive_outputs.empty()) {
+    return;
+  }
+
+  phi::RecordEvent record_event(
+      "LazyRecorder::Flush", phi::TracerEventType::UserDefined, 1);
+  auto& programs = CompiledPrograms();
+  std::string key = StructureKey(program.get());
+  auto it = programs.find(key);
+  if (it == programs.end()) {
+    VLOG(4) << "Compile the " << num_ops << " ops recorded by the lazy mode";
+    if (programs.size() >= kMaxCompiledPrograms) {
+      programs.clear();
+    }
+    auto compiled =
+        Compile(program.get(), place_, inputs.size(), alive_outputs.size());
+    it = programs.emplace(std::move(key), std::move(compiled)).first;
+  }
+  CompiledProgram* compiled = it->second.get();
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    compiled->scope.FindVar(InputName(i))
+        ->GetMutable<phi::DenseTensor>()
+        ->ShareDataWith(*inputs[i]);
+  }
+  compiled->executor->Run({}, false);
+  for (size_t i = 0; i < alive_outputs.size(); ++i) {
+    auto* var = compiled->scope.FindVar(OutputName(i));
+    PADDLE_ENFORCE_NOT_NULL(
+        var,
+        common::errors::NotFound("The output %s of the lazy mode is not found.",
+                                 OutputName(i)));
+    auto* result = var->GetMutable<phi::DenseTensor>();
+    alive_outputs[i]->ShareDataWith(*result);
+    // The next run allocates new buffers rather than writing to the ones
+    // handed out.
+    result->clear();
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    compiled->scope.FindVar(InputName(i))
+        ->GetMutable<phi::DenseTensor>()
+        ->clear();
+  }
+}
+
+}  // namespace egr
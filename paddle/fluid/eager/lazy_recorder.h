@@ -0,0 +1,100 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/core/value.h"
+#include "paddle/utils/test_macros.h"
+
+namespace egr {
+
+/**
+ * LazyRecorder records the eager ops into a PIR program instead of running
+ * them one by one, when FLAGS_eager_lazy_mode is on. The outputs of the
+ * recorded ops are pending tensors holding only their meta. At the next sync
+ * point the program is compiled by the PIR passes, and CINN if enabled, and
+ * is run by the PIR interpreter, which fills the buffers of the pending
+ * tensors still alive. The compiled programs are cached by the structure of
+ * the recorded programs, so a loop recording the same ops compiles them once.
+ *
+ * The sync points are:
+ *  - an eager op which is not recorded, e.g. an inplace op, an op with grad
+ *    or an op the code generator emits no record code for;
+ *  - the Tensor methods reading the buffer, e.g. numpy(), and the backward;
+ *  - FLAGS_eager_lazy_mode_max_ops recorded ops, or Flush() on purpose.
+ *
+ * The recorder is per thread, as the eager mode is.
+ **/
+class LazyRecorder {
+ public:
+  TEST_API static LazyRecorder& Instance();
+
+  // Whether the dygraph functions have to check the recorder, i.e. the lazy
+  // mode is on or there are ops recorded before it was turned off.
+  TEST_API static bool IsActive();
+
+  // Whether an op of the inputs can be recorded, i.e. no AMP, layout
+  // autotune or NaN/Inf check applies, no grad is required and the inputs
+  // are contiguous dense tensors of the same dtype, on the place of the ops
+  // recorded so far.
+  TEST_API bool CanRecord(std::initializer_list<const paddle::Tensor*> inputs);
+
+  // The value of the recorded program for the input, a pd_op.data fed by
+  // the buffer of the input at the sync point, or the value of the op the
+  // pending input is an output of.
+  TEST_API pir::Value Input(const paddle::Tensor& tensor);
+
+  // Records the op built by build with the paddle::dialect api into the
+  // program, and returns its pending output.
+  TEST_API paddle::Tensor Record(const std::function<pir::Value()>& build);
+
+  bool HasPendingOps() const { return num_ops_ > 0; }
+
+  // Runs the ops recorded so far.
+  TEST_API void Flush();
+
+ private:
+  LazyRecorder() = default;
+  DISABLE_COPY_AND_ASSIGN(LazyRecorder);
+
+  // The value of a recorded tensor, whose address may be reused once the
+  // tensor is dead.
+  struct RecordedValue {
+    pir::Value value;
+    std::weak_ptr<phi::TensorBase> tensor;
+  };
+
+  const RecordedValue* FindRecorded(const paddle::Tensor& tensor) const;
+
+  std::unique_ptr<pir::Program> program_;
+  phi::Place place_;
+  int64_t num_ops_{0};
+  std::unordered_map<const phi::TensorBase*, RecordedValue> recorded_;
+  // the tensors fed to the pd_op.data, in the order of their names
+  std::vector<std::shared_ptr<phi::DenseTensor>> inputs_;
+  std::vector<std::pair<pir::Value, std::weak_ptr<phi::DenseTensor>>>
+      outputs_;
+};
+
+}  // namespace egr
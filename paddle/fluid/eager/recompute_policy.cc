@@ -0,0 +1,66 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/recompute_policy.h"
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/string/split.h"
+
+COMMON_DECLARE_string(eager_recompute_ops);
+COMMON_DECLARE_int64(eager_recompute_min_bytes);
+
+namespace egr {
+
+RecomputePolicy& RecomputePolicy::Instance() {
+  static RecomputePolicy policy;
+  return policy;
+}
+
+bool RecomputePolicy::ShouldRecompute(const std::string& op_name,
+                                      const paddle::Tensor& out) {
+  if (FLAGS_eager_recompute_ops.empty()) {
+    return false;
+  }
+  // The dist tensors and the ones with a custom buffer, e.g. the views, are
+  // always kept
+  if (!out.initialized() || !out.is_dense_tensor() ||
+      !static_cast<phi::DenseTensor*>(out.impl().get())
+           ->meta()
+           .is_contiguous()) {
+    return false;
+  }
+  int64_t bytes = out.numel() * static_cast<int64_t>(phi::SizeOf(out.dtype()));
+  if (bytes < FLAGS_eager_recompute_min_bytes) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (parsed_flag_ != FLAGS_eager_recompute_ops) {
+    parsed_flag_ = FLAGS_eager_recompute_ops;
+    all_ops_ = false;
+    op_names_.clear();
+    for (auto& name : paddle::string::Split(parsed_flag_, ',')) {
+      if (name == "all") {
+        all_ops_ = true;
+      } else {
+        op_names_.insert(name);
+      }
+    }
+  }
+  return all_ops_ || op_names_.count(op_name) > 0;
+}
+
+}  // namespace egr
@@ -0,0 +1,61 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/utils/test_macros.h"
+
+namespace egr {
+
+// Regenerates the buffer of a saved forward output from the saved inputs of
+// its op, see TensorWrapper::SetRecomputeFunction.
+using RecomputeFunction = std::function<paddle::Tensor()>;
+
+/**
+ * RecomputePolicy decides which saved forward outputs are dropped after the
+ * forward and recomputed by the backward, instead of being kept alive
+ * between them. Only the cheap ops the code generator emits a recompute
+ * function for can be selected, e.g. the activations, while the outputs of
+ * the expensive ops like matmul are always kept.
+ *
+ * The ops are selected by FLAGS_eager_recompute_ops, and only the outputs of
+ * at least FLAGS_eager_recompute_min_bytes are dropped.
+ **/
+class RecomputePolicy {
+ public:
+  TEST_API static RecomputePolicy& Instance();
+
+  // Whether the saved output `out` of op_name should be recomputed.
+  TEST_API bool ShouldRecompute(const std::string& op_name,
+                                const paddle::Tensor& out);
+
+ private:
+  RecomputePolicy() = default;
+  DISABLE_COPY_AND_ASSIGN(RecomputePolicy);
+
+  std::mutex mutex_;
+  // the value of FLAGS_eager_recompute_ops op_names_ is parsed from
+  std::string parsed_flag_;
+  bool all_ops_{false};
+  std::unordered_set<std::string> op_names_;
+};
+
+}  // namespace egr
@@ -25,10 +25,14 @@
  * with no grad **/
 
 #pragma once
+#include "paddle/fluid/eager/accumulation/accumulation_node.h"
+#include "paddle/fluid/eager/activation_offloader.h"
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/grad_node_info.h"
+#include "paddle/fluid/eager/recompute_policy.h"
 #include "paddle/fluid/eager/utils.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/core/memory/tensor_evictor.h"
 #ifndef PADDLE_NO_PYTHON
 #include "paddle/fluid/eager/hooks.h"
 #endif
@@ -123,6 +127,8 @@ class TensorWrapper {
       } else {
 #endif
         intermidiate_tensor_.set_impl(tensor.impl());
+        offload_buffer(tensor_autograd_meta);
+        register_evictable_buffer(tensor_autograd_meta);
 #ifndef PADDLE_NO_PYTHON
       }
 #endif
@@ -190,6 +196,13 @@ class TensorWrapper {
     }
 #endif
 
+    if (offloaded_tensor_) {
+      load_offloaded_buffer();
+    }
+    if (recompute_fn_) {
+      recompute_buffer();
+    }
+
     paddle::Tensor recovered_tensor = intermidiate_tensor_;
 
     std::shared_ptr<GradNodeBase> new_grad_node = weak_grad_node_.lock();
@@ -216,15 +229,121 @@ class TensorWrapper {
 
   paddle::Tensor get_intermidiate_tensor() { return intermidiate_tensor_; }
 
-  void clear() { intermidiate_tensor_.reset(); }
+  void clear() {
+    intermidiate_tensor_.reset();
+    recompute_fn_ = nullptr;
+    offloaded_tensor_.reset();
+  }
+
+  /**
+   * Drops the buffer of the saved tensor, only its meta is kept and fn
+   * regenerates the buffer when the tensor is first recovered. fn must
+   * compute the tensor from the saved inputs of its forward op, the inplace
+   * version of the saved tensor is not checked anymore, the ones of the
+   * inputs are checked by their own wrappers in fn.
+   * **/
+  void SetRecomputeFunction(RecomputeFunction fn) {
+    if (no_need_buffer_ || packed_value_ || offloaded_tensor_ ||
+        !intermidiate_tensor_.initialized() ||
+        !intermidiate_tensor_.is_dense_tensor()) {
+      return;
+    }
+    phi::DenseTensor* dense_tensor =
+        static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get());
+    intermidiate_tensor_.set_impl(std::make_shared<phi::DenseTensor>(
+        std::make_shared<phi::Allocation>(
+            nullptr, 0, intermidiate_tensor_.place()),
+        dense_tensor->meta()));
+    recompute_fn_ = std::move(fn);
+  }
 
  private:
+  // Keeps the buffer of the saved tensor in pinned host memory if the
+  // ActivationOffloader selects it. Only the activations, i.e. the non-leaf
+  // tensors produced by a grad node, are offloaded. The parameters and the
+  // other leaf tensors, whose grad node is a GradNodeAccumulation, stay on the
+  // device anyway.
+  void offload_buffer(AutogradMeta* tensor_autograd_meta) {
+    if (!tensor_autograd_meta || !tensor_autograd_meta->GetMutableGradNode() ||
+        tensor_autograd_meta->Persistable() ||
+        std::dynamic_pointer_cast<GradNodeAccumulation>(
+            tensor_autograd_meta->GetMutableGradNode()) ||
+        !intermidiate_tensor_.is_dense_tensor() ||
+        !intermidiate_tensor_.initialized()) {
+      return;
+    }
+    phi::DenseTensor* dense_tensor =
+        static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get());
+    offloaded_tensor_ = ActivationOffloader::Instance().Offload(*dense_tensor);
+    if (offloaded_tensor_) {
+      auto no_buffer_tensor = std::make_shared<phi::DenseTensor>(
+          std::make_shared<phi::Allocation>(
+              nullptr, 0, intermidiate_tensor_.place()),
+          dense_tensor->meta());
+      // The inplace version of the saved tensor is still checked
+      no_buffer_tensor->ShareInplaceVersionCounterWith(*dense_tensor);
+      intermidiate_tensor_.set_impl(no_buffer_tensor);
+    }
+  }
+
+  // Lets the TensorEvictor evict the activation kept on the device when the
+  // memory runs out, the grad kernels page it back.
+  void register_evictable_buffer(AutogradMeta* tensor_autograd_meta) {
+    if (offloaded_tensor_ || !tensor_autograd_meta ||
+        !tensor_autograd_meta->GetMutableGradNode() ||
+        !intermidiate_tensor_.is_dense_tensor() ||
+        !intermidiate_tensor_.initialized()) {
+      return;
+    }
+    paddle::memory::TensorEvictor::Instance().Register(
+        std::static_pointer_cast<phi::DenseTensor>(
+            intermidiate_tensor_.impl()));
+  }
+
+  void load_offloaded_buffer() {
+    phi::DenseTensor* dense_tensor =
+        static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get());
+    if (!dense_tensor->Holder() || !dense_tensor->Holder()->ptr()) {
+      dense_tensor->ResetHolder(offloaded_tensor_->Load());
+    }
+  }
+
+  void recompute_buffer() {
+    phi::DenseTensor* dense_tensor =
+        static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get());
+    // Already recomputed by a former backward with retain_graph
+    if (dense_tensor->Holder() && dense_tensor->Holder()->ptr()) {
+      return;
+    }
+    VLOG(6) << "Recompute tensor: " << intermidiate_tensor_.name()
+            << " for wrapper";
+    paddle::Tensor recomputed_tensor = recompute_fn_();
+    PADDLE_ENFORCE_EQ(
+        recomputed_tensor.is_dense_tensor() &&
+            recomputed_tensor.dims() == dense_tensor->dims() &&
+            recomputed_tensor.dtype() == dense_tensor->dtype(),
+        true,
+        common::errors::PreconditionNotMet(
+            "The recomputed tensor of '%s' does not match the saved one, "
+            "expect a DenseTensor with dims [%s].",
+            intermidiate_tensor_.name(),
+            dense_tensor->dims()));
+    dense_tensor->ResetHolder(
+        static_cast<phi::DenseTensor*>(recomputed_tensor.impl().get())
+            ->MoveMemoryHolder());
+  }
+
   void check_inplace_version() {
     if (no_need_buffer_) {
       VLOG(7) << "There's no need to check inplace_version because "
                  "no_need_buffer_ is true.";
       return;
     }
+    if (recompute_fn_) {
+      VLOG(7) << "There's no need to check inplace_version because "
+                 "the tensor is recomputed.";
+      return;
+    }
     if (intermidiate_tensor_.impl()) {
       phi::DenseTensor* dense_tensor = nullptr;
       if (phi::DenseTensor::classof(intermidiate_tensor_.impl().get())) {
@@ -270,6 +389,8 @@ class TensorWrapper {
   paddle::Tensor intermidiate_tensor_;
   std::weak_ptr<egr::GradNodeBase> weak_grad_node_;
   uint32_t inplace_version_snapshot_ = 0;
+  RecomputeFunction recompute_fn_;
+  std::shared_ptr<OffloadedTensor> offloaded_tensor_;
 #ifndef PADDLE_NO_PYTHON
   std::shared_ptr<egr::PyObjectHolderBase> packed_value_;
   std::shared_ptr<egr::UnPackHookBase> unpack_hook_;
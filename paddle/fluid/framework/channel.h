@@ -22,8 +22,10 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -46,8 +48,10 @@ class ChannelObject {
     capacity_ = (std::min)(MaxCapacity(), capacity);
   }
 
-  const std::deque<T>& GetData() const { return data_; }
-  void Clear() {
+  virtual ~ChannelObject() = default;
+
+  virtual const std::deque<T>& GetData() const { return data_; }
+  virtual void Clear() {
     std::unique_lock<std::mutex> lock(mutex_);
     data_.clear();
     data_.shrink_to_fit();
@@ -57,7 +61,7 @@ class ChannelObject {
     return capacity_;  // atomic
   }
 
-  void SetCapacity(size_t x) {  // capacity can be zero
+  virtual void SetCapacity(size_t x) {  // capacity can be zero
     std::lock_guard<std::mutex> lock(mutex_);
     capacity_ = std::min(MaxCapacity(), x);
     Notify();
@@ -89,26 +93,28 @@ class ChannelObject {
     return closed_;  // atomic
   }
 
+  virtual size_t ShardNum() const { return 1; }
+
   // open channel, then data can be write() to channel
-  void Open() {
+  virtual void Open() {
     std::lock_guard<std::mutex> lock(mutex_);
     closed_ = false;
     Notify();
   }
 
   // close channel, then no more data can be write() to channel
-  void Close() {
+  virtual void Close() {
     std::lock_guard<std::mutex> lock(mutex_);
     closed_ = true;
     Notify();
   }
 
-  size_t Size() {
+  virtual size_t Size() {
     std::lock_guard<std::mutex> lock(mutex_);
     return data_.size();
   }
 
-  bool Empty() {
+  virtual bool Empty() {
     std::lock_guard<std::mutex> lock(mutex_);
     return EmptyUnlocked();
   }
@@ -118,13 +124,13 @@ class ChannelObject {
 
   // blocking operation
   // returns 0 if the channel is closed and empty
-  size_t Read(size_t n, T* p) {
+  virtual size_t Read(size_t n, T* p) {
     if (n == 0) {
       return 0;
     }
 
     std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Read(n, p, lock);
+    size_t finished = ReadLocked(n, p, lock);
     Notify();
     return finished;
   }
@@ -137,23 +143,23 @@ class ChannelObject {
 
   // blocking operation
   // returns value less than n if the channel is closed
-  size_t Write(size_t n, const T* p) {
+  virtual size_t Write(size_t n, const T* p) {
     if (n == 0) {
       return 0;
     }
     std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Write(n, p, lock);
+    size_t finished = WriteLocked(n, p, lock);
     Notify();
     return finished;
   }
 
   // WriteMove() will clear original contents of input array
-  size_t WriteMove(size_t n, T* p) {
+  virtual size_t WriteMove(size_t n, T* p) {
     if (n == 0) {
       return 0;
     }
     std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = WriteMove(n, p, lock);
+    size_t finished = WriteMoveLocked(n, p, lock);
     Notify();
     return finished;
   }
@@ -166,13 +172,13 @@ class ChannelObject {
     return finished;
   }
   // read once only
-  size_t ReadOnce(std::vector<T>& p, size_t size) {  // NOLINT
+  virtual size_t ReadOnce(std::vector<T>& p, size_t size) {  // NOLINT
     if (size == 0) {
       return 0;
     }
     std::unique_lock<std::mutex> lock(mutex_);
     p.resize(size);
-    size_t finished = Read(size, &p[0], lock, true);
+    size_t finished = ReadLocked(size, &p[0], lock, true);
     p.resize(finished);
     Notify();
 
@@ -199,10 +205,16 @@ class ChannelObject {
   // write data from vector to channel
   size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), &p[0]); }
 
- private:
+ protected:
+  static constexpr size_t MaxCapacity() {
+    return (std::numeric_limits<size_t>::max)() / 2;
+  }
+
   size_t capacity_ = MaxCapacity();
   size_t block_size_ = 1024;
-  bool closed_ = false;
+  std::atomic<bool> closed_{false};
+
+ private:
   std::mutex mutex_;
   // use deque to store data
   std::deque<T> data_;
@@ -212,10 +224,6 @@ class ChannelObject {
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
 
-  static constexpr size_t MaxCapacity() {
-    return (std::numeric_limits<size_t>::max)() / 2;
-  }
-
   void Notify() {
     if (empty_waiters_ != 0 && (!EmptyUnlocked() || closed_)) {
       empty_cond_.notify_one();
@@ -261,10 +269,10 @@ class ChannelObject {
     return !closed_;
   }
 
-  size_t Read(size_t n,
-              T* p,
-              std::unique_lock<std::mutex>& lock,  // NOLINT
-              bool once = false) {                 // NOLINT
+  size_t ReadLocked(size_t n,
+                    T* p,
+                    std::unique_lock<std::mutex>& lock,  // NOLINT
+                    bool once = false) {                 // NOLINT
     size_t finished = 0;
     PADDLE_ENFORCE_LE(
         n,
@@ -289,9 +297,9 @@ class ChannelObject {
     return finished;
   }
 
-  size_t Write(size_t n,
-               const T* p,                            // NOLINT
-               std::unique_lock<std::mutex>& lock) {  // NOLINT
+  size_t WriteLocked(size_t n,
+                     const T* p,                            // NOLINT
+                     std::unique_lock<std::mutex>& lock) {  // NOLINT
     size_t finished = 0;
     while (finished < n && WaitForWrite(lock)) {
       size_t m =
@@ -303,9 +311,9 @@ class ChannelObject {
     return finished;
   }
 
-  size_t WriteMove(size_t n,
-                   T* p,                                  // NOLINT
-                   std::unique_lock<std::mutex>& lock) {  // NOLINT
+  size_t WriteMoveLocked(size_t n,
+                         T* p,                                  // NOLINT
+                         std::unique_lock<std::mutex>& lock) {  // NOLINT
     size_t finished = 0;
     while (finished < n && WaitForWrite(lock)) {
       size_t m =
@@ -318,21 +326,281 @@ class ChannelObject {
   }
 };  // NOLINT
 
+// index of the current thread, used to pick its shard of a channel
+inline size_t ChannelThreadIndex() {
+  static std::atomic<size_t> thread_num{0};
+  static thread_local size_t index = thread_num++;
+  return index;
+}
+
+// A channel split into shards, each being a deque guarded by its own mutex,
+// for the channels written and read by many threads at the same time. A
+// thread writes to its own shard, and reads from its own shard first before
+// taking from the others, so that the threads rarely contend on one mutex.
+// The size of the channel is kept by atomics, and a thread only takes the
+// channel mutex to wait while the channel is empty or full. The data is in
+// order only within a shard.
+template <class T>
+class ShardedChannelObject final : public ChannelObject<T> {
+ public:
+  ShardedChannelObject(size_t capacity, size_t shard_num)
+      : ChannelObject<T>(capacity) {
+    PADDLE_ENFORCE_GE(
+        shard_num,
+        1,
+        common::errors::InvalidArgument(
+            "The shard num must be greater than or equal to 1, but got %d.",
+            shard_num));
+    shards_.reserve(shard_num);
+    for (size_t i = 0; i < shard_num; ++i) {
+      shards_.emplace_back(new Shard());
+    }
+  }
+
+  using ChannelObject<T>::Read;
+  using ChannelObject<T>::Write;
+
+  // Gathers the data of all the shards into the first one, can not be called
+  // with the other operations at the same time.
+  const std::deque<T>& GetData() const override {
+    Shard& first = *shards_[0];
+    std::lock_guard<std::mutex> first_lock(first.mutex);
+    for (size_t i = 1; i < shards_.size(); ++i) {
+      Shard& shard = *shards_[i];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      std::move(
+          shard.data.begin(), shard.data.end(), std::back_inserter(first.data));
+      shard.data.clear();
+      shard.size = 0;
+    }
+    first.size = first.data.size();
+    return first.data;
+  }
+
+  void Clear() override {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      size_t cleared = shard->data.size();
+      shard->data.clear();
+      shard->data.shrink_to_fit();
+      shard->size = 0;
+      size_ -= cleared;
+      reserved_ -= cleared;
+    }
+    NotifyWriters();
+  }
+
+  void SetCapacity(size_t x) override {
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      this->capacity_ = (std::min)(ChannelObject<T>::MaxCapacity(), x);
+    }
+    full_cond_.notify_all();
+  }
+
+  size_t ShardNum() const override { return shards_.size(); }
+
+  void Open() override {
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      this->closed_ = false;
+    }
+    empty_cond_.notify_all();
+    full_cond_.notify_all();
+  }
+
+  void Close() override {
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      this->closed_ = true;
+    }
+    empty_cond_.notify_all();
+    full_cond_.notify_all();
+  }
+
+  size_t Size() override { return size_; }
+
+  bool Empty() override { return size_ == 0; }
+
+  size_t Read(size_t n, T* p) override { return ReadShards(n, p, false); }
+
+  size_t Write(size_t n, const T* p) override {
+    return WriteShard(n, p, [](const T& val) -> const T& { return val; });
+  }
+
+  size_t WriteMove(size_t n, T* p) override {
+    return WriteShard(n, p, [](T& val) -> T&& { return std::move(val); });
+  }
+
+  size_t ReadOnce(std::vector<T>& p, size_t size) override {  // NOLINT
+    if (size == 0) {
+      return 0;
+    }
+    p.resize(size);
+    size_t finished = ReadShards(size, &p[0], true);
+    p.resize(finished);
+    return finished;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::deque<T> data;
+    // size of data, read without the mutex to skip the empty shards
+    std::atomic<size_t> size{0};
+  };
+
+  size_t ReadShards(size_t n, T* p, bool once) {
+    if (n == 0) {
+      return 0;
+    }
+    // the pending reads make room for the writers, as in ChannelObject
+    reading_count_ += n;
+    NotifyWriters();
+    size_t finished = 0;
+    size_t start = ChannelThreadIndex();
+    while (finished < n) {
+      size_t m = 0;
+      for (size_t i = 0; i < shards_.size() && finished + m < n; ++i) {
+        Shard& shard = *shards_[(start + i) % shards_.size()];
+        if (shard.size.load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t k = (std::min)(n - finished - m, shard.data.size());
+        for (size_t j = 0; j < k; ++j) {
+          p[finished + m++] = std::move(shard.data.front());
+          shard.data.pop_front();
+        }
+        shard.size.store(shard.data.size(), std::memory_order_relaxed);
+      }
+      if (m > 0) {
+        size_ -= m;
+        reserved_ -= m;
+        reading_count_ -= m;
+        finished += m;
+        NotifyWriters();
+        if (once) {
+          break;
+        }
+      } else if (!WaitForRead()) {
+        break;
+      }
+    }
+    reading_count_ -= n - finished;
+    return finished;
+  }
+
+  template <class P, class Func>
+  size_t WriteShard(size_t n, P* p, Func&& get) {
+    size_t finished = 0;
+    Shard& shard = *shards_[ChannelThreadIndex() % shards_.size()];
+    while (finished < n) {
+      size_t m = Reserve(n - finished);
+      if (m == 0) {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < m; ++i) {
+          shard.data.push_back(get(p[finished++]));
+        }
+        shard.size.store(shard.data.size(), std::memory_order_relaxed);
+        // before the data can be read, so that size_ never goes below zero
+        size_ += m;
+      }
+      NotifyReaders();
+    }
+    return finished;
+  }
+
+  // Reserves the room of at most n data, waits while the channel is full.
+  // Returns 0 if the channel is closed.
+  size_t Reserve(size_t n) {
+    while (!this->closed_) {
+      size_t reserved = reserved_;
+      size_t bound = this->capacity_ + reading_count_;
+      if (reserved < bound) {
+        size_t m = (std::min)(n, bound - reserved);
+        if (reserved_.compare_exchange_weak(reserved, reserved + m)) {
+          return m;
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(wait_mutex_);
+      ++full_waiters_;
+      while (reserved_ >= this->capacity_ + reading_count_ && !this->closed_) {
+        full_cond_.wait(lock);
+      }
+      --full_waiters_;
+    }
+    return 0;
+  }
+
+  // Waits while the channel is empty and not closed. Returns false if the
+  // channel is closed and empty.
+  bool WaitForRead() {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    ++empty_waiters_;
+    while (size_ == 0 && !this->closed_) {
+      empty_cond_.wait(lock);
+    }
+    --empty_waiters_;
+    return size_ != 0;
+  }
+
+  // The waiters are counted before they check the size under wait_mutex_,
+  // so they are either notified here or see the new size.
+  void NotifyReaders() {
+    if (empty_waiters_ != 0) {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      empty_cond_.notify_all();
+    }
+  }
+
+  void NotifyWriters() {
+    if (full_waiters_ != 0) {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      full_cond_.notify_all();
+    }
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  // data in the shards
+  std::atomic<size_t> size_{0};
+  // data in the shards and being written
+  std::atomic<size_t> reserved_{0};
+  std::atomic<size_t> reading_count_{0};
+
+  std::mutex wait_mutex_;
+  std::atomic<int> empty_waiters_{0};
+  std::atomic<int> full_waiters_{0};
+  std::condition_variable empty_cond_;
+  std::condition_variable full_cond_;
+};  // NOLINT
+
 template <class T>
 using Channel = std::shared_ptr<ChannelObject<T>>;
 
+// shard_num > 1 makes a ShardedChannelObject
 template <class T>
-Channel<T> MakeChannel(size_t capacity = (std::numeric_limits<size_t>::max)()) {
+Channel<T> MakeChannel(size_t capacity = (std::numeric_limits<size_t>::max)(),
+                       size_t shard_num = 1) {
+  if (shard_num > 1) {
+    return std::make_shared<ShardedChannelObject<T>>(capacity, shard_num);
+  }
   return std::make_shared<ChannelObject<T>>(capacity);
 }
 
+// the new channel has the same shard num as other
 template <class T, class U>
 Channel<T> MakeChannel(const Channel<U>& other) {
   PADDLE_ENFORCE_NE(
       other,
       nullptr,
       common::errors::InvalidArgument("The channel can not be NULL!"));
-  Channel<T> chan = std::make_shared<ChannelObject<T>>();
+  Channel<T> chan =
+      MakeChannel<T>((std::numeric_limits<size_t>::max)(), other->ShardNum());
   chan->InheritFrom(other);
   return chan;
 }
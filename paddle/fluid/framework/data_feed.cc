@@ -27,8 +27,10 @@ limitations under the License. */
 #endif
 #include "io/fs.h"
 #include "paddle/common/enforce.h"
+#include "paddle/fluid/framework/io/slot_columnar_file.h"
 #include "paddle/phi/core/platform/monitor.h"
 #include "paddle/phi/core/platform/timer.h"
+#include "paddle/utils/string/number_parser.h"
 
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
 COMMON_DECLARE_bool(enable_ins_parser_file);
@@ -268,11 +270,23 @@ void DataFeed::CheckStart() {
 
 void DataFeed::AssignFeedVar(const Scope& scope) {
   CheckInit();
+  if (!feed_var_slots_.IsBuiltFor(&scope)) {
+    feed_var_slots_ = VariableSlotTable(scope, use_slots_);
+  }
   for (size_t i = 0; i < use_slots_.size(); ++i) {
-    feed_vec_[i] = scope.FindVar(use_slots_[i])->GetMutable<phi::DenseTensor>();
+    feed_vec_[i] = GetFeedVar(use_slots_[i])->GetMutable<phi::DenseTensor>();
   }
 }
 
+Variable* DataFeed::GetFeedVar(const std::string& name) const {
+  Variable* var = feed_var_slots_.FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(
+      var,
+      common::errors::NotFound("The feed variable %s is not found in scope.",
+                               name));
+  return var;
+}
+
 void DataFeed::CopyToFeedTensor(void* dst, const void* src, size_t size) {
   if (phi::is_cpu_place(this->place_)) {
     memcpy(dst, src, size);
@@ -923,23 +937,19 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = string::fast_strtof(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = string::fast_strtoull(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        endptr = const_cast<char*>(string::skip_tokens(endptr, num));
+        pos = endptr - str;
       }
     }
     return true;
@@ -983,20 +993,19 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = string::fast_strtof(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = string::fast_strtoull(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        endptr = const_cast<char*>(string::skip_tokens(endptr, num));
+        pos = endptr - str;
       }
     }
   } else {
@@ -1263,14 +1272,14 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
                            str));
 
         char* uidptr = endptr;
-        uint64_t feasign = (uint64_t)strtoull(uidptr, &uidptr, 10);
+        uint64_t feasign = string::fast_strtoull(uidptr, &uidptr);
         instance->uid_ = feasign;
       }
 #endif
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = string::fast_strtof(endptr, &endptr);
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
             if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
@@ -1282,7 +1291,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = string::fast_strtoull(endptr, &endptr);
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -1295,12 +1304,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        endptr = const_cast<char*>(string::skip_tokens(endptr, num));
+        pos = endptr - str;
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -1345,7 +1350,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = string::fast_strtof(endptr, &endptr);
             if (fabs(feasign) < 1e-6) {
               continue;
             }
@@ -1355,7 +1360,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = string::fast_strtoull(endptr, &endptr);
             if (feasign == 0) {
               continue;
             }
@@ -1366,9 +1371,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        endptr = const_cast<char*>(string::skip_tokens(endptr, num));
+        pos = endptr - str;
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -2170,6 +2174,7 @@ void SlotRecordInMemoryDataFeed::Init(const DataFeedDesc& data_feed_desc) {
   pipe_command_ = data_feed_desc.pipe_command();
   finish_init_ = true;
   input_type_ = data_feed_desc.input_type();
+  columnar_format_ = (data_feed_desc.data_format() == "columnar");
   size_t pos = pipe_command_.find(".so");
   if (pos != std::string::npos) {  // NOLINT
     pos = pipe_command_.rfind('|');
@@ -2212,7 +2217,9 @@ void SlotRecordInMemoryDataFeed::InitGraphTrainResource() {
 
 void SlotRecordInMemoryDataFeed::LoadIntoMemory() {
   VLOG(3) << "SlotRecord LoadIntoMemory() begin, thread_id=" << thread_id_;
-  if (!so_parser_name_.empty()) {
+  if (columnar_format_) {
+    LoadIntoMemoryByColumnar();
+  } else if (!so_parser_name_.empty()) {
     LoadIntoMemoryByLib();
   } else {
     LoadIntoMemoryByCommand();
@@ -2496,6 +2503,169 @@ static void parser_log_key(const std::string& log_key,
   *rank = static_cast<uint32_t>(strtoul(rank_str.c_str(), nullptr, 16));
 }
 
+void SlotRecordInMemoryDataFeed::LoadIntoMemoryByColumnar() {
+#ifdef _LINUX
+  std::unordered_map<std::string, int> slot_name_to_idx;
+  for (size_t i = 0; i < all_slots_info_.size(); ++i) {
+    slot_name_to_idx[all_slots_info_[i].slot] = static_cast<int>(i);
+  }
+  std::default_random_engine random_engine(std::random_device{}());
+  std::uniform_real_distribution<float> uniform_distribution(0.0f, 1.0f);
+  bool need_sample = std::abs(sample_rate_ - 1.0f) >= 1e-5f;
+
+  std::string filename;
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    platform::Timer timeline;
+    timeline.Start();
+    int err_no = 0;
+    this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
+    PADDLE_ENFORCE_EQ(this->fp_ != nullptr,
+                      true,
+                      common::errors::InvalidArgument(
+                          "This fp should not be null, please check!"));
+    __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+    SlotColumnarReader reader(this->fp_);
+    PADDLE_ENFORCE_EQ(
+        reader.with_ins_id() || !(parse_ins_id_ || parse_logkey_),
+        true,
+        common::errors::InvalidArgument(
+            "The columnar file %s has no ins_id, which is required by "
+            "parse_ins_id or parse_logkey.",
+            filename));
+
+    // column of every slot of the data feed in the file, -1 if not used
+    std::vector<int> slot_columns(all_slots_info_.size(), -1);
+    for (size_t j = 0; j < reader.slots().size(); ++j) {
+      auto& slot = reader.slots()[j];
+      auto iter = slot_name_to_idx.find(slot.name);
+      if (iter == slot_name_to_idx.end()) {
+        continue;
+      }
+      auto& info = all_slots_info_[iter->second];
+      PADDLE_ENFORCE_EQ(info.type,
+                        slot.type,
+                        common::errors::InvalidArgument(
+                            "The type of slot %s is %s in the columnar file %s "
+                            "but %s in the data feed.",
+                            slot.name,
+                            slot.type,
+                            filename,
+                            info.type));
+      if (info.used_idx != -1) {
+        slot_columns[iter->second] = static_cast<int>(j);
+      }
+    }
+    for (size_t i = 0; i < all_slots_info_.size(); ++i) {
+      PADDLE_ENFORCE_EQ(
+          all_slots_info_[i].used_idx == -1 || slot_columns[i] != -1,
+          true,
+          common::errors::NotFound("The used slot %s is not in the columnar "
+                                   "file %s.",
+                                   all_slots_info_[i].slot,
+                                   filename));
+    }
+
+    int lines = 0;
+    int offset = 0;
+    std::vector<SlotRecord> record_vec;
+    std::vector<uint64_t> search_ids;
+    std::vector<uint32_t> cmatchs;
+    std::vector<uint32_t> ranks;
+    while (reader.NextBlock()) {
+      int ins_num = static_cast<int>(reader.ins_num());
+      if (ins_num == 0) {
+        continue;
+      }
+      // the logkeys repeated in the block are parsed once
+      if (parse_logkey_) {
+        size_t dict_size = reader.ins_id_dict_size();
+        search_ids.resize(dict_size);
+        cmatchs.resize(dict_size);
+        ranks.resize(dict_size);
+        for (size_t k = 0; k < dict_size; ++k) {
+          parser_log_key(reader.ins_id_dict_entry(static_cast<uint32_t>(k)),
+                         &search_ids[k],
+                         &cmatchs[k],
+                         &ranks[k]);
+        }
+      }
+      SlotRecordPool().get(&record_vec, ins_num);
+      offset = 0;
+      for (int i = 0; i < ins_num; ++i) {
+        if (need_sample &&
+            uniform_distribution(random_engine) >= sample_rate_) {
+          continue;
+        }
+        SlotRecord rec = record_vec[offset];
+        if (parse_ins_id_ || parse_logkey_) {
+          uint32_t index = reader.ins_id_index(i);
+          rec->ins_id_ = reader.ins_id_dict_entry(index);
+          if (parse_logkey_) {
+            rec->search_id = search_ids[index];
+            rec->cmatch = cmatchs[index];
+            rec->rank = ranks[index];
+          }
+        }
+        size_t uint64_total_slot_num = 0;
+        for (size_t k = 0; k < all_slots_info_.size(); ++k) {
+          int column = slot_columns[k];
+          if (column == -1) {
+            continue;
+          }
+          auto& info = all_slots_info_[k];
+          const uint32_t* offsets = reader.slot_offsets(column);
+          uint32_t begin = offsets[i];
+          uint32_t num = offsets[i + 1] - begin;
+          if (info.type[0] == 'u') {
+            rec->slot_uint64_feasigns_.add_values(
+                reader.uint64_values(column) + begin, num);
+            uint64_total_slot_num += num;
+          } else if (used_slots_info_[info.used_idx].dense) {
+            rec->slot_float_feasigns_.add_values(
+                reader.float_values(column) + begin, num);
+          } else {
+            // drops the zeros of the sparse float slots as ParseOneInstance
+            auto& values = rec->slot_float_feasigns_.slot_values;
+            auto& slot_offsets = rec->slot_float_feasigns_.slot_offsets;
+            if (slot_offsets.empty()) {
+              slot_offsets.push_back(0);
+            }
+            const float* src = reader.float_values(column) + begin;
+            for (uint32_t j = 0; j < num; ++j) {
+              if (fabs(src[j]) >= 1e-6) {
+                values.push_back(src[j]);
+              }
+            }
+            slot_offsets.push_back(static_cast<uint32_t>(values.size()));
+          }
+        }
+        if (uint64_total_slot_num > 0) {
+          ++offset;
+        } else {
+          // the record is reused by the next instance
+          rec->reset();
+        }
+      }
+      if (offset > 0) {
+        input_channel_->WriteMove(offset, &record_vec[0]);
+      }
+      if (offset < ins_num) {
+        SlotRecordPool().put(&record_vec[offset], (ins_num - offset));
+      }
+      record_vec.clear();
+      lines += ins_num;
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemoryByColumnar() read all blocks, file=" << filename
+            << ", lines=" << lines << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemoryByColumnar() end, thread_id=" << thread_id_;
+#endif
+}
+
 bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
                                                   SlotRecord* ins) {
   SlotRecord& rec = (*ins);
@@ -2564,7 +2734,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+          float feasign = string::fast_strtof(endptr, &endptr);
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2575,20 +2745,15 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+          uint64_t feasign = string::fast_strtoull(endptr, &endptr);
           slot_fea.push_back(feasign);
           ++uint64_total_slot_num;
         }
       }
       pos = static_cast<int>(endptr - str);
     } else {
-      for (int j = 0; j <= num; ++j) {
-        // pos = line.find_first_of(' ', pos + 1);
-        while (line[pos + 1] != ' ') {
-          pos++;
-        }
-      }
+      endptr = const_cast<char*>(string::skip_tokens(endptr, num));
+      pos = static_cast<int>(endptr - str);
     }
   }
   rec->slot_float_feasigns_.add_slot_feasigns(slot_float_feasigns,
@@ -2612,9 +2777,17 @@ void SlotRecordInMemoryDataFeed::AssignFeedVar(const Scope& scope) {
         scope.FindVar(used_slots_info_[i].slot)->GetMutable<phi::DenseTensor>();
   }
 #else
+  if (!feed_var_slots_.IsBuiltFor(&scope)) {
+    std::vector<std::string> slot_names;
+    slot_names.reserve(use_slot_size_);
+    for (int i = 0; i < use_slot_size_; ++i) {
+      slot_names.push_back(used_slots_info_[i].slot);
+    }
+    feed_var_slots_ = VariableSlotTable(scope, slot_names);
+  }
   for (int i = 0; i < use_slot_size_; ++i) {
     feed_vec_[i] =
-        scope.FindVar(used_slots_info_[i].slot)->GetMutable<phi::DenseTensor>();
+        GetFeedVar(used_slots_info_[i].slot)->GetMutable<phi::DenseTensor>();
   }
 #endif
 }
@@ -2972,11 +3145,14 @@ void SlotRecordInMemoryDataFeed::BuildSlotBatchGPU(const int ins_num,
   size_t float_zero_slot_index = 0;
   size_t uint64_zero_slot_index = 0;
 
-  // copy index
-  CUDA_CHECK(cudaMemcpy(offsets.data(),
-                        d_slot_offsets,
-                        slot_total_num * sizeof(size_t),
-                        cudaMemcpyDeviceToHost));
+  // copy index on the stream of the pack, a cudaMemcpy on the default stream
+  // would also wait for the training on the other streams of the device
+  CUDA_CHECK(cudaMemcpyAsync(offsets.data(),
+                             d_slot_offsets,
+                             slot_total_num * sizeof(size_t),
+                             cudaMemcpyDeviceToHost,
+                             pack->get_stream()));
+  CUDA_CHECK(cudaStreamSynchronize(pack->get_stream()));
   auto* dev_ctx = static_cast<phi::GPUContext*>(
       phi::DeviceContextPool::Instance().Get(this->place_));
   for (int j = 0; j < use_slot_size_; ++j) {
@@ -3050,6 +3226,8 @@ void SlotRecordInMemoryDataFeed::BuildSlotBatchGPU(const int ins_num,
                 float_use_slot_size_,
                 used_slot_gpu_types,
                 pack->get_stream());
+  // the tensors are read by the training stream once the pack is queued
+  CUDA_CHECK(cudaStreamSynchronize(pack->get_stream()));
 }
 
 void SlotRecordInMemoryDataFeed::PackToScope(MiniBatchGpuPack* pack,
@@ -3374,7 +3552,8 @@ void MiniBatchGpuPack::transfer_to_gpu() {
   copy_host2device(&value_.d_float_lens, buf_.h_float_lens);
   copy_host2device(&value_.d_float_keys, buf_.h_float_keys);
   copy_host2device(&value_.d_float_offset, buf_.h_float_offset);
-  CUDA_CHECK(cudaStreamSynchronize(stream_));
+  // the kernels of BuildSlotBatchGPU follow on the same stream, and the host
+  // buffers are not refilled until the pack is given back
 }
 #endif
 
@@ -38,6 +38,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/framework/variable_slot_table.h"
 #include "paddle/phi/core/framework/data_feed.pb.h"
 #include "paddle/phi/core/framework/reader.h"
 #include "paddle/phi/core/platform/timer.h"
@@ -52,6 +53,7 @@ limitations under the License. */
 
 COMMON_DECLARE_int32(record_pool_max_size);
 COMMON_DECLARE_int32(slotpool_thread_num);
+COMMON_DECLARE_int32(dataset_channel_shard_num);
 COMMON_DECLARE_bool(enable_slotpool_wait_release);
 COMMON_DECLARE_bool(enable_slotrecord_reset_shrink);
 
@@ -269,7 +271,8 @@ class SlotObjPool {
  public:
   SlotObjPool()
       : max_capacity_(FLAGS_record_pool_max_size), alloc_(free_slotrecord) {
-    ins_chan_ = MakeChannel<SlotRecord>();
+    ins_chan_ = MakeChannel<SlotRecord>((std::numeric_limits<size_t>::max)(),
+                                        FLAGS_dataset_channel_shard_num);
     ins_chan_->SetBlockSize(OBJPOOL_BLOCK_SIZE);
     for (int i = 0; i < FLAGS_slotpool_thread_num; ++i) {
       threads_.push_back(std::thread([this]() { run(); }));
@@ -1429,6 +1432,8 @@ class DataFeed {
   virtual void CheckStart();
   virtual void SetBatchSize(
       int batch);  // batch size will be set in Init() function
+  // Get a feed variable of the scope fed last by its slot.
+  Variable* GetFeedVar(const std::string& name) const;
   // This function is used to pick one file from the global filelist(thread
   // safe).
   virtual bool PickOneFile(std::string* filename);
@@ -1460,6 +1465,8 @@ class DataFeed {
 
   // The data read by DataFeed will be stored here
   std::vector<phi::DenseTensor*> feed_vec_;
+  // The feed variables resolved in the scope fed last.
+  VariableSlotTable feed_var_slots_;
   phi::DenseTensor* rank_offset_;
 
   // the batch size defined by user
@@ -1988,6 +1995,8 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   virtual void LoadIntoMemoryByLib(void);
   virtual void LoadIntoMemoryByLine(void);
   virtual void LoadIntoMemoryByFile(void);
+  // loads the files written by SlotColumnarWriter without parsing text
+  virtual void LoadIntoMemoryByColumnar(void);
   void SetInputChannel(void* channel) override {
     input_channel_ = static_cast<ChannelObject<SlotRecord>*>(channel);
   }
@@ -2053,6 +2062,8 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   void DumpSampleNeighbors(std::string dump_path) override;
 
   float sample_rate_ = 1.0f;
+  // data_format of the data feed desc is "columnar"
+  bool columnar_format_ = false;
   int use_slot_size_ = 0;
   int float_use_slot_size_ = 0;
   int uint64_use_slot_size_ = 0;
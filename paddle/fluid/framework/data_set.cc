@@ -39,6 +39,8 @@
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
 USE_INT_STAT(STAT_epoch_finish);
 COMMON_DECLARE_bool(graph_get_neighbor_id);
+COMMON_DECLARE_int32(dataset_channel_shard_num);
+COMMON_DECLARE_int32(dataset_global_shuffle_max_inflight_msgs);
 COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_string(graph_edges_split_mode);
 COMMON_DECLARE_bool(query_dest_rank_by_multi_node);
@@ -249,7 +251,8 @@ std::vector<paddle::framework::DataFeed*> DatasetImpl<T>::GetReaders() {
 template <typename T>
 void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<T>();
+    input_channel_ = paddle::framework::MakeChannel<T>(
+        (std::numeric_limits<size_t>::max)(), FLAGS_dataset_channel_shard_num);
   }
   if (multi_output_channel_.empty()) {
     multi_output_channel_.reserve(channel_num_);
@@ -490,6 +493,7 @@ inline std::vector<std::shared_ptr<phi::ThreadPool>>& GetReadThreadPool(
 template <typename T>
 void DatasetImpl<T>::LoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::LoadIntoMemory() begin";
+  std::vector<std::vector<uint64_t>>().swap(unique_feasigns_);
   platform::Timer timeline;
   timeline.Start();
   if (gpu_graph_mode_) {
@@ -601,6 +605,7 @@ void DatasetImpl<T>::LoadIntoMemory() {
 template <typename T>
 void DatasetImpl<T>::PreLoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() begin";
+  std::vector<std::vector<uint64_t>>().swap(unique_feasigns_);
   if (preload_thread_num_ != 0) {
     PADDLE_ENFORCE_EQ(static_cast<size_t>(preload_thread_num_),
                       preload_readers_.size(),
@@ -653,6 +658,7 @@ void DatasetImpl<T>::ReleaseMemory() {
 template <typename T>
 void DatasetImpl<T>::ReleaseMemoryFun() {
   VLOG(3) << "DatasetImpl<T>::ReleaseMemory() begin";
+  std::vector<std::vector<uint64_t>>().swap(unique_feasigns_);
   if (input_channel_) {
     input_channel_->Clear();
     input_channel_ = nullptr;
@@ -899,43 +905,47 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
     }
   };
 
+  // Every thread serializes the records into one buffer per trainer and
+  // sends a buffer once it holds fleet_send_batch_size_ records, so that
+  // the messages do not shrink with the number of trainers. At most
+  // FLAGS_dataset_global_shuffle_max_inflight_msgs messages of a thread are
+  // in flight to a trainer, a thread only waits for a trainer which has not
+  // received its previous messages, while it keeps serializing the records
+  // of the others.
   auto global_shuffle_func = [this, get_client_id]() {
 #ifdef PADDLE_WITH_PSCORE
     auto fleet_ptr = distributed::FleetWrapper::GetInstance();
 #else
     auto fleet_ptr = framework::FleetWrapper::GetInstance();
 #endif
-    // auto fleet_ptr = framework::FleetWrapper::GetInstance();
+    size_t max_inflight_msgs = static_cast<size_t>(
+        std::max(FLAGS_dataset_global_shuffle_max_inflight_msgs, 1));
+    std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
+    std::vector<int64_t> ins_nums(this->trainer_num_, 0);
+    std::vector<std::deque<std::future<int32_t>>> inflight_msgs(
+        this->trainer_num_);
+    auto send = [&](int i) {
+      auto& msgs = inflight_msgs[i];
+      while (msgs.size() >= max_inflight_msgs) {
+        msgs.front().wait();
+        msgs.pop_front();
+      }
+      std::string msg(ars[i].Buffer(), ars[i].Length());
+      msgs.push_back(fleet_ptr->SendClientToClientMsg(0, i, msg));
+      ars[i].Clear();
+      ins_nums[i] = 0;
+    };
+
     std::vector<Record> data;
     while (this->input_channel_->Read(data)) {
-      std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
       for (auto& t : data) {
         auto client_id = get_client_id(t);
         ars[client_id] << t;
-      }
-      std::vector<std::future<int32_t>> total_status;
-      std::vector<int> send_index(this->trainer_num_);
-      for (int i = 0; i < this->trainer_num_; ++i) {
-        send_index[i] = i;
-      }
-      std::shuffle(
-          send_index.begin(), send_index.end(), fleet_ptr->LocalRandomEngine());
-      for (int index = 0; index < this->trainer_num_; ++index) {
-        int i = send_index[index];
-        if (ars[i].Length() == 0) {
-          continue;
+        if (++ins_nums[client_id] >= this->fleet_send_batch_size_) {
+          send(static_cast<int>(client_id));
         }
-        std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
-        total_status.push_back(std::move(ret));
       }
-      for (auto& t : total_status) {
-        t.wait();
-      }
-      ars.clear();
-      ars.shrink_to_fit();
       data.clear();
-      data.shrink_to_fit();
       // currently we find bottleneck is server not able to handle large data
       // in time, so we can remove this sleep and set fleet_send_batch_size to
       // 1024, and set server thread to 24.
@@ -943,6 +953,17 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
         sleep(this->fleet_send_sleep_seconds_);
       }
     }
+    data.shrink_to_fit();
+    for (int i = 0; i < this->trainer_num_; ++i) {
+      if (ars[i].Length() != 0) {
+        send(i);
+      }
+    }
+    for (auto& msgs : inflight_msgs) {
+      for (auto& t : msgs) {
+        t.wait();
+      }
+    }
   };
 
   std::vector<std::thread> global_shuffle_threads;
@@ -1454,11 +1475,22 @@ void MultiSlotDataset::PreprocessInstance() {
   }
   if (!enable_pv_merge_) {  // means to use Record
     this->LocalShuffle();
+    if (gen_uni_feasigns_) {
+      std::vector<Record> data;
+      input_channel_->ReadAll(data);
+      GenerateUniqueFeasigns(data);
+      input_channel_->Open();
+      input_channel_->Write(std::move(data));
+      input_channel_->Close();
+    }
   } else {  // means to use Pv
     auto fleet_ptr = framework::FleetWrapper::GetInstance();
     input_channel_->Close();
     std::vector<PvInstance> pv_data;
     input_channel_->ReadAll(input_records_);
+    if (gen_uni_feasigns_) {
+      GenerateUniqueFeasigns(input_records_);
+    }
     int all_records_num = static_cast<int>(input_records_.size());
     std::vector<Record*> all_records;
     all_records.reserve(all_records_num);
@@ -1504,6 +1536,67 @@ void MultiSlotDataset::PreprocessInstance() {
   }
 }
 
+void MultiSlotDataset::GenerateUniqueFeasigns(
+    const std::vector<Record>& records) {
+  VLOG(3) << "MultiSlotDataset::GenerateUniqueFeasigns begin";
+  platform::Timer timeline;
+  timeline.Start();
+  // every thread shards the feasigns of its records, then every shard is
+  // sorted and deduped by a thread
+  int thread_num = std::max(thread_num_, 1);
+  std::vector<std::vector<std::vector<uint64_t>>> thread_keys(
+      thread_num, std::vector<std::vector<uint64_t>>(thread_num));
+  std::vector<std::thread> threads;
+  size_t records_num = records.size();
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&, i]() {
+      auto& keys = thread_keys[i];
+      size_t begin = records_num * i / thread_num;
+      size_t end = records_num * (i + 1) / thread_num;
+      for (size_t j = begin; j < end; ++j) {
+        for (auto& feature : records[j].uint64_feasigns_) {
+          uint64_t key = feature.sign().uint64_feasign_;
+          keys[key % thread_num].push_back(key);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  threads.clear();
+  unique_feasigns_.clear();
+  unique_feasigns_.resize(thread_num);
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&, i]() {
+      auto& shard = unique_feasigns_[i];
+      size_t size = 0;
+      for (auto& keys : thread_keys) {
+        size += keys[i].size();
+      }
+      shard.reserve(size);
+      for (auto& keys : thread_keys) {
+        shard.insert(shard.end(), keys[i].begin(), keys[i].end());
+        std::vector<uint64_t>().swap(keys[i]);
+      }
+      std::sort(shard.begin(), shard.end());
+      shard.erase(std::unique(shard.begin(), shard.end()), shard.end());
+      shard.shrink_to_fit();
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  size_t unique_num = 0;
+  for (auto& shard : unique_feasigns_) {
+    unique_num += shard.size();
+  }
+  timeline.Pause();
+  VLOG(3) << "MultiSlotDataset::GenerateUniqueFeasigns end, unique feasign "
+          << "num=" << unique_num << ", cost time=" << timeline.ElapsedSec()
+          << " seconds";
+}
+
 void MultiSlotDataset::GenerateLocalTablesUnlock(int table_id,
                                                  int feadim,
                                                  int read_thread_num,
@@ -1526,8 +1619,11 @@ void MultiSlotDataset::GenerateLocalTablesUnlock(int table_id,
   std::vector<std::unordered_map<uint64_t, std::vector<float>>>&
       local_map_tables = fleet_ptr_->GetLocalTable();
   local_map_tables.resize(shard_num);
-  // read thread
-  int channel_num = static_cast<int>(multi_output_channel_.size());
+  // read thread, one per shard of the unique feasigns if PreprocessInstance
+  // generated them, else one per channel
+  bool use_unique = !unique_feasigns_.empty();
+  int channel_num = use_unique ? static_cast<int>(unique_feasigns_.size())
+                               : static_cast<int>(multi_output_channel_.size());
   if (read_thread_num < channel_num) {
     read_thread_num = channel_num;
   }
@@ -1546,17 +1642,26 @@ void MultiSlotDataset::GenerateLocalTablesUnlock(int table_id,
       }
     }
   };
-  auto gen_func = [this, &shard_num, &feadim, &consume_func](int i) {
+  auto gen_func = [this, use_unique, &shard_num, &feadim, &consume_func](
+                      int i) {
     std::vector<Record> vec_data;
     std::vector<std::vector<uint64_t>> task_keys(shard_num);
     std::vector<std::future<void>> task_futures;
-    this->multi_output_channel_[i]->Close();
-    this->multi_output_channel_[i]->ReadAll(vec_data);
-    for (auto& item : vec_data) {
-      for (auto& feature : item.uint64_feasigns_) {
-        int shard =
-            static_cast<int>(feature.sign().uint64_feasign_ % shard_num);
-        task_keys[shard].push_back(feature.sign().uint64_feasign_);
+    if (use_unique) {
+      if (static_cast<size_t>(i) < unique_feasigns_.size()) {
+        for (auto key : unique_feasigns_[i]) {
+          task_keys[key % shard_num].push_back(key);
+        }
+      }
+    } else if (static_cast<size_t>(i) < multi_output_channel_.size()) {
+      this->multi_output_channel_[i]->Close();
+      this->multi_output_channel_[i]->ReadAll(vec_data);
+      for (auto& item : vec_data) {
+        for (auto& feature : item.uint64_feasigns_) {
+          int shard =
+              static_cast<int>(feature.sign().uint64_feasign_ % shard_num);
+          task_keys[shard].push_back(feature.sign().uint64_feasign_);
+        }
       }
     }
 
@@ -1565,8 +1670,10 @@ void MultiSlotDataset::GenerateLocalTablesUnlock(int table_id,
           consume_func, shard_id, feadim, task_keys[shard_id]));
     }
 
-    multi_output_channel_[i]->Open();
-    multi_output_channel_[i]->Write(std::move(vec_data));
+    if (!use_unique && static_cast<size_t>(i) < multi_output_channel_.size()) {
+      multi_output_channel_[i]->Open();
+      multi_output_channel_[i]->Write(std::move(vec_data));
+    }
     vec_data.clear();
     vec_data.shrink_to_fit();
     for (auto& tk : task_keys) {
@@ -1963,6 +2070,8 @@ void MultiSlotDataset::SlotsShuffle(
                         "fea eval mode off, need to set on for slots shuffle"));
   platform::Timer timeline;
   timeline.Start();
+  // the feasigns of the shuffled slots change
+  std::vector<std::vector<uint64_t>>().swap(unique_feasigns_);
   std::unordered_set<uint16_t> index_slots;
   PreprocessChannel(slots_to_replace, index_slots);
 
@@ -1986,7 +2095,8 @@ void MultiSlotDataset::SlotsShuffle(
 template class DatasetImpl<SlotRecord>;
 void SlotRecordDataset::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<SlotRecord>();
+    input_channel_ = paddle::framework::MakeChannel<SlotRecord>(
+        (std::numeric_limits<size_t>::max)(), FLAGS_dataset_channel_shard_num);
   }
 }
 void SlotRecordDataset::CreateReaders() {
@@ -327,6 +327,8 @@ class DatasetImpl : public Dataset {
   std::vector<paddle::framework::Channel<T>> multi_output_channel_;
   std::vector<paddle::framework::Channel<T>> multi_consume_channel_;
   std::vector<std::unordered_set<uint64_t>> local_tables_;
+  // the unique feasigns of the pass, see MultiSlotDataset::PreprocessInstance
+  std::vector<std::vector<uint64_t>> unique_feasigns_;
   // when read ins, we put ins from one channel to the other,
   // and when finish reading, we set cur_channel = 1 - cur_channel,
   // so if cur_channel=0, all data are in output_channel, else consume_channel
@@ -406,6 +408,13 @@ class MultiSlotDataset : public DatasetImpl<Record> {
       std::unordered_set<uint64_t>().swap(t);
     }
     std::vector<std::unordered_set<uint64_t>>().swap(local_tables_);
+    std::vector<std::vector<uint64_t>>().swap(unique_feasigns_);
+  }
+  // The unique uint64 feasigns of the pass, generated by PreprocessInstance
+  // when generate_unique_feasigns is set. They are sharded by feasign %
+  // shard number, and every shard is sorted.
+  virtual const std::vector<std::vector<uint64_t>>& GetUniqueFeasigns() {
+    return unique_feasigns_;
   }
   virtual void PreprocessChannel(
       const std::set<std::string>& slots_to_replace,
@@ -423,6 +432,7 @@ class MultiSlotDataset : public DatasetImpl<Record> {
   virtual int ReceiveFromClient(int msg_type,
                                 int client_id,
                                 const std::string& msg);
+  void GenerateUniqueFeasigns(const std::vector<Record>& records);
 };
 class SlotRecordDataset : public DatasetImpl<SlotRecord> {
  public:
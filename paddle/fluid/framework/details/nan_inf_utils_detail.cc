@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/framework/details/nan_inf_utils_detail.h"
 
+#include <atomic>
+
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/scope.h"
@@ -52,6 +54,27 @@ void SetNanInfStackLimit(const int& stack_limit) {
 
 int GetNanInfStackLimit() { return debug_nan_inf.stack_limit; }
 
+void CheckDeferredNanInf() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  std::string report = phi::funcs::CheckNanInfRecords();
+  if (report.empty()) return;
+  if (FLAGS_check_nan_inf_level == 0) {
+    PADDLE_THROW(common::errors::PreconditionNotMet("%s", report));
+  }
+  LOG(WARNING) << report;
+#endif
+}
+
+void StepDeferredNanInf() {
+  if (!FLAGS_check_nan_inf || FLAGS_check_nan_inf_deferred_steps <= 0) {
+    return;
+  }
+  static std::atomic<int64_t> num_steps{0};
+  if (++num_steps % FLAGS_check_nan_inf_deferred_steps == 0) {
+    CheckDeferredNanInf();
+  }
+}
+
 static std::once_flag white_list_init_flag;
 
 static int op_role_nan_inf_white_list = 0;
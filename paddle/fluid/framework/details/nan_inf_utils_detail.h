@@ -22,8 +22,11 @@
 #include "paddle/phi/core/platform/device_context.h"
 #include "paddle/phi/kernels/check_numerics_kernel.h"
 #include "paddle/phi/kernels/funcs/eigen/extensions.h"
+#include "paddle/phi/kernels/funcs/nan_inf_recorder.h"
 
+COMMON_DECLARE_bool(check_nan_inf);
 COMMON_DECLARE_int32(check_nan_inf_level);
+COMMON_DECLARE_int32(check_nan_inf_deferred_steps);
 
 namespace paddle {
 namespace framework {
@@ -37,6 +40,14 @@ void SetNanInfStackLimit(const int& stack_limit);
 
 int GetNanInfStackLimit();
 
+// Reports the tensors recorded holding NaN or Inf, by an error at
+// FLAGS_check_nan_inf_level 0 and by a warning at the others.
+void CheckDeferredNanInf();
+
+// The end of a step, the records are checked every
+// FLAGS_check_nan_inf_deferred_steps steps.
+void StepDeferredNanInf();
+
 template <typename Context>
 struct TensorCheckerVisitor {
   TensorCheckerVisitor(const std::string& o,
@@ -59,6 +70,14 @@ struct TensorCheckerVisitor {
                  0) const {
     auto* dev_ctx = reinterpret_cast<Context*>(
         phi::DeviceContextPool::Instance().Get(tensor.place()));
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if constexpr (std::is_same<Context, phi::GPUContext>::value) {
+      if (FLAGS_check_nan_inf_deferred_steps > 0) {
+        phi::funcs::RecordNanInf(*dev_ctx, tensor, op_type, var_name);
+        return;
+      }
+    }
+#endif
 
     phi::DenseTensor stats;
     phi::DenseTensor values;
@@ -14,8 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <gtest/gtest_prod.h>
+
 #include <atomic>
 #include <fstream>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -38,6 +41,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/common/port.h"
@@ -120,6 +124,7 @@ class PullDenseWorker {
   PullDenseWorker() : root_scope_(NULL) {}
   void Run();
   bool CheckUpdateParam(uint64_t table_id);
+  void SwapDenseBuffer(uint64_t table_id);
 
  private:
 #if defined(PADDLE_WITH_PSCORE)
@@ -145,6 +150,8 @@ class PullDenseWorker {
   int threshold_;
 
   std::vector<::std::future<int32_t>> pull_dense_status_;
+  bool double_buffer_ = false;
+  std::vector<uint64_t> pulled_tables_;
   uint32_t pull_dense_fail_times_ = 0;
   std::vector<float> base_norm_param_;
   std::vector<float> mean_;
@@ -476,6 +483,39 @@ class DownpourLiteWorker : public HogwildWorker {
   std::set<uint64_t> condvalue_set_;
   bool flag_partial_push_;
 
+  // Prefetch with FLAGS_downpour_lite_worker_sparse_prefetch: while a batch
+  // computes, the next batch is read into prefetch_scope_ and the
+  // distributed_lookup_table ops of its feed ids are pulled there, both are
+  // swapped into thread_scope_ before the batch computes and the lookup ops
+  // are skipped.
+  struct SparsePrefetchOp {
+    const OperatorBase* op;
+    std::vector<std::string> ids;
+    std::vector<std::string> outputs;
+    uint64_t table_id;
+    int64_t emb_dim;
+    uint64_t padding_id;
+    bool is_training;
+    bool lookup_table_v2;
+  };
+  void InitSparsePrefetch();
+  // returns the size of the prefetched batch, 0 at the end of the data
+  int PrefetchNextBatch();
+  int NextBatch();
+  bool sparse_prefetch_ = false;
+  std::unique_ptr<Scope> prefetch_scope_;
+  std::vector<std::string> prefetch_var_names_;
+  std::vector<SparsePrefetchOp> prefetch_ops_;
+  std::unordered_set<const OperatorBase*> prefetched_ops_;
+  std::unique_ptr<ThreadPool> prefetch_pool_;
+  std::future<void> prefetch_future_;
+  int prefetched_batch_ = 0;
+  // the ins ids and the size of the batch computing, as the reader holds the
+  // next batch by then
+  std::vector<std::string> batch_ins_ids_;
+  int batch_size_ = 0;
+  FRIEND_TEST(DownpourLiteWorkerTest, ins_ids_of_prefetched_batch);
+
  private:
   // std::vector<std::string> dump_param_;
   // just save the value in param_ for easy access
@@ -840,6 +880,7 @@ class HeterSectionWorker : public DeviceWorker {
   void RunBackward(int micro_id);
   void RunListen();
   void MiniBatchBarrier();
+  void RunFlowControlled();
   void Run();
   void BatchPostProcess();
   void SetDebug(bool debug) { debug_ = debug; }
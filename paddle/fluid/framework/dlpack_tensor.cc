@@ -16,7 +16,11 @@
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/phi/common/place.h"
+#include "paddle/phi/core/platform/device_context.h"
 #include "paddle/phi/core/utils/visit_place.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/core/platform/cuda_device_guard.h"
+#endif
 
 namespace paddle {
 namespace framework {
@@ -30,6 +34,10 @@ static ::DLDataType GetDLDataTypeCode() {
     dtype.code = kDLComplex;
   } else if (std::is_same<T, phi::dtype::bfloat16>::value) {
     dtype.code = kDLBfloat;
+  } else if (std::is_same<T, phi::dtype::float8_e4m3fn>::value) {
+    dtype.code = kDLFloat8E4M3FN;
+  } else if (std::is_same<T, phi::dtype::float8_e5m2>::value) {
+    dtype.code = kDLFloat8E5M2;
   } else if (std::is_same<T, phi::dtype::float16>::value ||
              std::is_floating_point<T>::value) {
     dtype.code = kDLFloat;
@@ -103,7 +111,11 @@ struct DLDeviceVisitor {
   inline ::DLDevice operator()(const phi::GPUPlace &place) const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
     ::DLDevice device;
+#ifdef PADDLE_WITH_HIP
+    device.device_type = kDLROCM;
+#else
     device.device_type = kDLCUDA;
+#endif
     device.device_id = place.device;  // NOLINT
     return device;
 #else
@@ -115,7 +127,11 @@ struct DLDeviceVisitor {
   inline ::DLDevice operator()(const phi::GPUPinnedPlace &place) const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
     ::DLDevice device;
+#ifdef PADDLE_WITH_HIP
+    device.device_type = kDLROCMHost;
+#else
     device.device_type = kDLCUDAHost;
+#endif
     device.device_id = 0;
     return device;
 #else
@@ -213,6 +229,51 @@ DLPackTensor::DLPackTensor(const phi::DenseTensor &tensor, LaneType lanes)
   t_.byte_offset = 0;
 }
 
+void DLPackStreamWait(const phi::Place &place [[maybe_unused]],
+                      int64_t stream [[maybe_unused]]) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!phi::is_gpu_place(place) || stream == -1) {
+    return;
+  }
+  auto *ctx = static_cast<phi::GPUContext *>(
+      phi::DeviceContextPool::Instance().Get(place));
+  gpuStream_t producer = ctx->stream();
+  gpuStream_t consumer = reinterpret_cast<gpuStream_t>(stream);
+#ifndef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_NE(stream,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The CUDA stream of __dlpack__ can not be 0, use 1 "
+                        "for the legacy default stream."));
+  if (stream == 1) {
+    consumer = cudaStreamLegacy;
+  } else if (stream == 2) {
+    consumer = cudaStreamPerThread;
+  }
+#endif
+  if (consumer == producer) {
+    return;
+  }
+  // the event can be destroyed once the wait is queued
+  platform::CUDADeviceGuard guard(place.device);
+#ifdef PADDLE_WITH_HIP
+  hipEvent_t event;
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      hipEventCreateWithFlags(&event, hipEventDisableTiming));
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(event, producer));
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamWaitEvent(consumer, event, 0));
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(event));
+#else
+  cudaEvent_t event;
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(event, producer));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamWaitEvent(consumer, event, 0));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(event));
+#endif
+#endif
+}
+
 ::DLManagedTensor *DLPackTensor::ToDLManagedTensor() {
   // init shape
   auto shape = new int64_t[t_.ndim];
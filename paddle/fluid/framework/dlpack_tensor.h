@@ -21,6 +21,11 @@
 namespace paddle {
 namespace framework {
 
+// The codes of the float8 types in DLPack 1.1, which the v0.8 header does not
+// have yet.
+constexpr uint8_t kDLFloat8E4M3FN = 10;
+constexpr uint8_t kDLFloat8E5M2 = 12;
+
 class DLPackTensor {
  public:
   using LaneType = decltype(::DLTensor::dtype.lanes);  // uint16_t
@@ -47,5 +52,20 @@ class DLPackTensor {
 
 DLManagedTensor* toDLPack(const phi::DenseTensor& src);
 
+// Makes the stream of the consumer of a DLPack tensor on place wait for the
+// work queued on the current stream of place, see the stream argument of
+// __dlpack__ in the Python array API. stream is a gpuStream_t, or -1 for no
+// synchronization. On CUDA 1 is the legacy default stream and 2 the
+// per-thread one, on ROCm 0 is the default stream. Does nothing for the
+// places other than GPUPlace.
+void DLPackStreamWait(const phi::Place& place, int64_t stream);
+
+// the stream of __dlpack__(stream=None), the default stream of the device
+#ifdef PADDLE_WITH_HIP
+constexpr int64_t kDLPackDefaultStream = 0;
+#else
+constexpr int64_t kDLPackDefaultStream = 1;
+#endif
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #if defined(PADDLE_WITH_PSCORE)
 #include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/fleet/metrics.h"
 #include "paddle/fluid/operators/isfinite_op.h"
@@ -34,6 +35,12 @@ class Variable;
 #define _LINUX
 #endif
 
+PHI_DEFINE_EXPORTED_bool(
+    downpour_lite_worker_sparse_prefetch,
+    false,
+    "read the next batch and pull its sparse params while a batch computes, "
+    "only on cpu. The pull of a batch may miss the push of the previous one.");
+
 namespace paddle {
 namespace framework {
 void DownpourLiteWorker::Initialize(const TrainerDesc& desc) {
@@ -452,13 +459,138 @@ inline void AddAucMonitor(const Scope* scope, const phi::Place& place) {
 }
 #endif
 
+void DownpourLiteWorker::InitSparsePrefetch() {
+  sparse_prefetch_ = FLAGS_downpour_lite_worker_sparse_prefetch &&
+                     phi::is_cpu_place(place_) && !need_dump_field_;
+  if (!sparse_prefetch_ || prefetch_scope_ != nullptr) {
+    return;
+  }
+  prefetch_scope_ = std::make_unique<Scope>();
+  std::unordered_set<std::string> feed_names;
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    prefetch_scope_->Var(name)->GetMutable<phi::DenseTensor>();
+    prefetch_var_names_.push_back(name);
+    feed_names.insert(name);
+  }
+  for (auto& op : ops_) {
+    if (op->Type() != "distributed_lookup_table") {
+      continue;
+    }
+    SparsePrefetchOp prefetch_op;
+    prefetch_op.op = op.get();
+    prefetch_op.ids = op->Inputs("Ids");
+    prefetch_op.outputs = op->Outputs("Outputs");
+    // only the lookups of the feed ids can run before the batch
+    bool is_feed = prefetch_op.ids.size() == prefetch_op.outputs.size();
+    for (auto& name : prefetch_op.ids) {
+      is_feed = is_feed && feed_names.count(name) > 0;
+    }
+    auto* w = thread_scope_->FindVar(op->Input("W"));
+    if (!is_feed || w == nullptr) {
+      continue;
+    }
+    if (w->IsType<phi::DenseTensor>()) {
+      prefetch_op.emb_dim = w->Get<phi::DenseTensor>().dims()[1];
+    } else if (w->IsType<phi::SelectedRows>()) {
+      prefetch_op.emb_dim = w->Get<phi::SelectedRows>().value().dims()[1];
+    } else {
+      continue;
+    }
+    prefetch_op.table_id = static_cast<uint64_t>(op->Attr<int>("table_id"));
+    prefetch_op.padding_id =
+        static_cast<uint64_t>(op->Attr<int64_t>("padding_idx"));
+    prefetch_op.is_training = !op->Attr<bool>("is_test");
+    prefetch_op.lookup_table_v2 =
+        op->Attr<std::string>("lookup_table_version") == "lookup_table_v2";
+    for (auto& name : prefetch_op.outputs) {
+      prefetch_scope_->Var(name)->GetMutable<phi::DenseTensor>();
+      prefetch_var_names_.push_back(name);
+    }
+    prefetched_ops_.insert(prefetch_op.op);
+    prefetch_ops_.push_back(std::move(prefetch_op));
+  }
+  VLOG(1) << "DownpourLiteWorker " << thread_id_ << " prefetches "
+          << prefetch_ops_.size() << " sparse lookups";
+  device_reader_->AssignFeedVar(*prefetch_scope_);
+  prefetch_pool_ = std::make_unique<ThreadPool>(1);
+}
+
+int DownpourLiteWorker::PrefetchNextBatch() {
+  // the tensors hold the buffers of an earlier batch, which ops may still
+  // share, never write into them
+  for (auto& name : prefetch_var_names_) {
+    prefetch_scope_->FindVar(name)->GetMutable<phi::DenseTensor>()->clear();
+  }
+  int batch = device_reader_->Next();
+  if (batch <= 0) {
+    return batch;
+  }
+  for (auto& prefetch_op : prefetch_ops_) {
+    std::vector<const phi::DenseTensor*> inputs;
+    std::vector<phi::DenseTensor*> outputs;
+    for (size_t i = 0; i < prefetch_op.ids.size(); ++i) {
+      auto& ids =
+          prefetch_scope_->FindVar(prefetch_op.ids[i])->Get<phi::DenseTensor>();
+      auto* out = prefetch_scope_->FindVar(prefetch_op.outputs[i])
+                      ->GetMutable<phi::DenseTensor>();
+      // the same shape as DistributedLookupTableOp::InferShape
+      if (prefetch_op.lookup_table_v2) {
+        out->Resize(common::make_ddim(
+            {ids.dims()[0], ids.dims()[1], prefetch_op.emb_dim}));
+      } else {
+        out->Resize(common::make_ddim({ids.dims()[0], prefetch_op.emb_dim}));
+      }
+      inputs.push_back(&ids);
+      outputs.push_back(out);
+    }
+    fleet_ptr_->PullSparseToTensorSync(prefetch_op.table_id,
+                                       static_cast<int>(prefetch_op.emb_dim),
+                                       prefetch_op.padding_id,
+                                       place_,
+                                       prefetch_op.is_training,
+                                       &inputs,
+                                       &outputs);
+  }
+  return batch;
+}
+
+int DownpourLiteWorker::NextBatch() {
+  if (!sparse_prefetch_) {
+    return device_reader_->Next();
+  }
+  if (!prefetch_future_.valid()) {
+    // the first batch
+    prefetch_future_ = prefetch_pool_->Run(
+        [this] { prefetched_batch_ = PrefetchNextBatch(); });
+  }
+  prefetch_future_.get();
+  int batch = prefetched_batch_;
+  if (batch <= 0) {
+    return batch;
+  }
+  batch_ins_ids_ = device_reader_->GetInsIdVec();
+  batch_size_ = device_reader_->GetCurBatchSize();
+  for (auto& name : prefetch_var_names_) {
+    auto* var = thread_scope_->FindLocalVar(name);
+    if (var == nullptr) {
+      var = thread_scope_->Var(name);
+    }
+    std::swap(*var->GetMutable<phi::DenseTensor>(),
+              *prefetch_scope_->FindVar(name)->GetMutable<phi::DenseTensor>());
+  }
+  prefetch_future_ = prefetch_pool_->Run(
+      [this] { prefetched_batch_ = PrefetchNextBatch(); });
+  return batch;
+}
+
 void DownpourLiteWorker::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
   device_reader_->Start();
+  InitSparsePrefetch();
   int batch_cnt = 0;
   int cur_batch;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = NextBatch()) > 0) {
     if (copy_table_config_.need_copy()) {
       VLOG(3) << "Begin to copy table";
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
@@ -477,14 +609,22 @@ void DownpourLiteWorker::TrainFiles() {
           break;
         }
       }
+      if (sparse_prefetch_ && prefetched_ops_.count(op.get()) > 0) {
+        need_skip = true;
+      }
       if (!need_skip) {
 #if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_PSCORE)
         try {
           op->Run(*thread_scope_, place_);
         } catch (std::exception& e) {
           fprintf(stderr, "error message: %s\n", e.what());
-          auto& ins_id_vec = device_reader_->GetInsIdVec();
-          size_t batch_size = device_reader_->GetCurBatchSize();
+          // the reader may hold the prefetched next batch already
+          const auto& ins_id_vec = sparse_prefetch_
+                                       ? batch_ins_ids_
+                                       : device_reader_->GetInsIdVec();
+          size_t batch_size = sparse_prefetch_
+                                  ? batch_size_
+                                  : device_reader_->GetCurBatchSize();
           std::string s = "";
           for (auto& ins_id : ins_id_vec) {
             if (!s.empty()) s += ",";
@@ -569,25 +569,37 @@ void Executor::RunPreparedContext(
       common::errors::PreconditionNotMet(
           "Program in the prepared context should has fetch_ops."));
 
-  // map the data of feed_targets to feed_holder
+  // map the data of feed_targets to feed_holder, which is resolved once for
+  // all the feeds
+  Variable* feed_holder = nullptr;
   for (auto* op : global_block.AllOps()) {
     if (op->Type() == kFeedOpType) {
-      std::string feed_target_name = op->Output("Out")[0];
+      if (feed_holder == nullptr) {
+        feed_holder = scope->Var(feed_holder_name);
+      }
+      const std::string& feed_target_name = op->Output("Out")[0];
       int idx = PADDLE_GET_CONST(int, op->GetAttr("col"));
-      SetFeedVariable(
-          scope, *(*feed_targets)[feed_target_name], feed_holder_name, idx);
+      SetFeedVariable(feed_holder, *(*feed_targets)[feed_target_name], idx);
     }
   }
 
   RunPreparedContext(ctx, scope, create_local_scope, create_vars);
 
   // obtain the data of fetch_targets from fetch_holder
+  Variable* fetch_holder = nullptr;
   for (auto* op : global_block.AllOps()) {
     if (op->Type() == kFetchOpType) {
-      std::string fetch_target_name = op->Input("X")[0];
+      if (fetch_holder == nullptr) {
+        fetch_holder = scope->FindVar(fetch_holder_name);
+        PADDLE_ENFORCE_NOT_NULL(
+            fetch_holder,
+            common::errors::NotFound("Variable %s is not found in scope.",
+                                     fetch_holder_name));
+      }
+      const std::string& fetch_target_name = op->Input("X")[0];
       int idx = PADDLE_GET_CONST(int, op->GetAttr("col"));
       *(*fetch_targets)[fetch_target_name] =
-          GetFetchVariable(*scope, fetch_holder_name, idx);
+          GetFetchVariable(fetch_holder, idx);
     }
   }
 }
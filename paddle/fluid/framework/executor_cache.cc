@@ -14,15 +14,22 @@
 
 #include "paddle/fluid/framework/executor_cache.h"
 
+#include <algorithm>
+
 #include "paddle/common/flags.h"
 #include "paddle/common/macros.h"
 #include "paddle/fluid/framework/new_executor/interpretercore.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/ir_adaptor/translator/translate.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/remove_redundant_transfer_pass.h"
 #include "paddle/fluid/pir/transforms/general/remove_shadow_feed_pass.h"
+#include "paddle/fluid/pir/transforms/general/while_loop_invariant_code_motion_pass.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/core/utils.h"
 #include "paddle/pir/include/core/value.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_manager.h"
@@ -30,7 +37,10 @@
 DECLARE_FILE_SYMBOLS(print_statistics);
 
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_remove_redundant_transfer);
+COMMON_DECLARE_bool(pir_while_hoist_invariant);
 COMMON_DECLARE_bool(print_ir);
+COMMON_DECLARE_int32(interpretercore_shared_build_capacity);
 
 namespace paddle::framework {
 class ProgramDesc;
@@ -104,11 +114,122 @@ int64_t hash_with_seed(int64_t value, int64_t seed) {
   return value + 0x9e3779b9 + (value << 6) + (seed >> 2);
 }
 
+namespace {
+
+// The hash of a type without the dims, which are inferred again by the
+// instructions on every run.
+size_t TypeStructureHash(pir::Type type) {
+  auto hash_dense = [](size_t seed, pir::Type dtype, phi::DataLayout layout) {
+    seed = pir::detail::hash_combine(seed, std::hash<pir::Type>()(dtype));
+    return pir::detail::hash_combine(seed, static_cast<size_t>(layout));
+  };
+  if (auto allocated = type.dyn_cast<dialect::AllocatedDenseTensorType>()) {
+    size_t seed = allocated.place().HashValue();
+    return hash_dense(seed, allocated.dtype(), allocated.data_layout());
+  }
+  if (auto dense = type.dyn_cast<pir::DenseTensorType>()) {
+    return hash_dense(0, dense.dtype(), dense.data_layout());
+  }
+  return std::hash<pir::Type>()(type);
+}
+
+class ProgramStructureHasher {
+ public:
+  size_t Hash(const pir::Block &block) {
+    size_t seed = block.args_size();
+    for (auto arg : block.args()) {
+      seed = pir::detail::hash_combine(seed, Define(arg));
+    }
+    std::vector<std::string> keywords;
+    for (auto &[keyword, _] : block.kwargs()) keywords.push_back(keyword);
+    std::sort(keywords.begin(), keywords.end());
+    for (auto &keyword : keywords) {
+      seed = pir::detail::hash_combine(seed, std::hash<std::string>()(keyword));
+      seed = pir::detail::hash_combine(seed, Define(block.kwarg(keyword)));
+    }
+    for (auto &op : block) {
+      seed = pir::detail::hash_combine(seed, Hash(op));
+    }
+    return seed;
+  }
+
+ private:
+  size_t Hash(const pir::Operation &op) {
+    size_t seed = std::hash<std::string>()(op.name());
+    // the pairs are added up as the attribute map is not ordered
+    size_t attrs = 0;
+    for (auto &[name, attr] : op.attributes()) {
+      if (name == "origin_id" || name == "op_callstack") continue;
+      attrs += pir::detail::hash_combine(std::hash<std::string>()(name),
+                                         std::hash<pir::Attribute>()(attr));
+    }
+    seed = pir::detail::hash_combine(seed, attrs);
+    for (uint32_t i = 0; i < op.num_operands(); ++i) {
+      auto value = op.operand_source(i);
+      auto it = value ? ids_.find(value) : ids_.end();
+      size_t id = it == ids_.end() ? static_cast<size_t>(-1) : it->second;
+      seed = pir::detail::hash_combine(seed, id);
+    }
+    for (uint32_t i = 0; i < op.num_results(); ++i) {
+      seed = pir::detail::hash_combine(seed, Define(op.result(i)));
+    }
+    for (auto &region : op) {
+      for (auto &block : region) {
+        seed = pir::detail::hash_combine(seed, Hash(block));
+      }
+    }
+    return seed;
+  }
+
+  size_t Define(pir::Value value) {
+    ids_.emplace(value, ids_.size());
+    return value && value.type() ? TypeStructureHash(value.type()) : 0;
+  }
+
+  std::unordered_map<pir::Value, size_t> ids_;
+};
+
+}  // namespace
+
+int64_t ProgramStructureHash(const ::pir::Program &program) {
+  return static_cast<int64_t>(ProgramStructureHasher().Hash(*program.block()));
+}
+
 InterpreterCoreInfoCache &InterpreterCoreInfoCache::Instance() {
   static InterpreterCoreInfoCache g_info_cache;
   return g_info_cache;
 }
 
+std::shared_ptr<InterpreterCore> InterpreterCoreInfoCache::GetSharedBuild(
+    int64_t structure_key) {
+  auto it = shared_build_index_.find(structure_key);
+  if (it == shared_build_index_.end()) {
+    ++shared_build_misses_;
+    return nullptr;
+  }
+  ++shared_build_hits_;
+  shared_builds_.splice(shared_builds_.begin(), shared_builds_, it->second);
+  return it->second->second;
+}
+
+void InterpreterCoreInfoCache::SetSharedBuild(
+    int64_t structure_key, std::shared_ptr<InterpreterCore> core) {
+  auto it = shared_build_index_.find(structure_key);
+  if (it != shared_build_index_.end()) {
+    shared_builds_.erase(it->second);
+  }
+  shared_builds_.emplace_front(structure_key, std::move(core));
+  shared_build_index_[structure_key] = shared_builds_.begin();
+  auto capacity = static_cast<size_t>(
+      std::max(FLAGS_interpretercore_shared_build_capacity, 0));
+  while (shared_builds_.size() > capacity) {
+    VLOG(4) << "Evict the shared build of the program structure "
+            << shared_builds_.back().first;
+    shared_build_index_.erase(shared_builds_.back().first);
+    shared_builds_.pop_back();
+  }
+}
+
 std::shared_ptr<InterpreterCore> CreateProgramInterpreterCoreInfoToCache(
     const ProgramDesc &program_desc,
     const phi::Place &place,
@@ -161,6 +282,23 @@ std::shared_ptr<InterpreterCore> CreatePirInterpreterCoreInfoToCache(
   core.reset(new InterpreterCore(
       place, {}, ir_program->block(), scope, execution_config));
 
+  // NOTE: The programs traced for other input shapes differ only in the dims,
+  // which the instructions infer again on every run, so the dependencies and
+  // the stream events of the instructions built for one of them are shared.
+  if (FLAGS_interpretercore_shared_build_capacity > 0) {
+    int64_t structure_key = ProgramStructureHash(*ir_program);
+    structure_key = hash_with_seed(structure_key, place_hash_key);
+    structure_key = hash_with_seed(structure_key, is_grad);
+    auto shared_core = cache.GetSharedBuild(structure_key);
+    if (shared_core != nullptr) {
+      VLOG(4) << "Share the build results for program " << program_id;
+      core->ShareBuildResultsFrom(shared_core);
+      core->ShareWorkQueueFrom(shared_core);
+    } else {
+      cache.SetSharedBuild(structure_key, core);
+    }
+  }
+
   auto &cached_value = cache.GetMutable(
       program_id, scope, place_hash_key, is_grad, /*in_pir_mode=*/true);
   cached_value.core_ = core;
@@ -176,6 +314,18 @@ std::unique_ptr<::pir::Program> ApplyIrPass(::pir::Program *program,
                                             phi::Place place) {
   auto ir_res = paddle::dialect::PdOpLowerToKernelPass(program, place);
 
+  if (FLAGS_pir_while_hoist_invariant) {
+    ::pir::PassManager pm(::pir::IrContext::Instance(), 3);
+    pm.AddPass(::pir::CreateWhileLoopInvariantCodeMotionPass());
+    pm.Run(ir_res.get());
+  }
+
+  if (FLAGS_pir_remove_redundant_transfer) {
+    ::pir::PassManager pm(::pir::IrContext::Instance(), 3);
+    pm.AddPass(::pir::CreateRemoveRedundantTransferPass());
+    pm.Run(ir_res.get());
+  }
+
   if (FLAGS_pir_apply_inplace_pass) {
     ::pir::PassManager pm(::pir::IrContext::Instance(), 3);
     pm.AddPass(::pir::CreateInplacePass());
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -28,6 +29,7 @@
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/utils/string/string_helper.h"
+#include "paddle/utils/test_macros.h"
 
 #include "paddle/fluid/ir_adaptor/translator/program_translator.h"
 #include "paddle/pir/include/core/dialect.h"
@@ -58,6 +60,11 @@ std::set<std::string> ParseSafeEagerDeletionSkipVarsSet(
 
 int64_t hash_with_seed(int64_t value, int64_t seed);
 
+// The hash of the ops, attributes, operands and value types of a program
+// without the dims of the dense tensors, equal for the programs of to_static
+// traced with different input shapes.
+TEST_API int64_t ProgramStructureHash(const ::pir::Program& program);
+
 class InterpreterCoreInfo {
  public:
   struct CacheValue {
@@ -134,15 +141,39 @@ class InterpreterCoreInfoCache {
 
   size_t Size() const { return info_map_.size(); }
 
+  // The interpreter built for a program of the same structure hash, whose
+  // build results are shared by the interpreters of the other input shapes,
+  // or nullptr if not found.
+  std::shared_ptr<InterpreterCore> GetSharedBuild(int64_t structure_key);
+
+  // Keeps at most FLAGS_interpretercore_shared_build_capacity of them, with
+  // the least recently used ones evicted.
+  void SetSharedBuild(int64_t structure_key,
+                      std::shared_ptr<InterpreterCore> core);
+
+  size_t SharedBuildSize() const { return shared_builds_.size(); }
+  int64_t SharedBuildHits() const { return shared_build_hits_; }
+  int64_t SharedBuildMisses() const { return shared_build_misses_; }
+
   void Finalize() {
     // NOTE(Aurelius84): DO NOT perform finalize in destructor
     // to avoid problems caused by destructor order of static
     // object.
     info_map_.clear();
+    shared_builds_.clear();
+    shared_build_index_.clear();
   }
 
  private:
+  using SharedBuild = std::pair<int64_t, std::shared_ptr<InterpreterCore>>;
+
   std::unordered_map<int64_t, InterpreterCoreInfo> info_map_;
+  // the most recently used first
+  std::list<SharedBuild> shared_builds_;
+  std::unordered_map<int64_t, std::list<SharedBuild>::iterator>
+      shared_build_index_;
+  int64_t shared_build_hits_{0};
+  int64_t shared_build_misses_{0};
 };
 
 std::shared_ptr<InterpreterCore> CreateProgramInterpreterCoreInfoToCache(
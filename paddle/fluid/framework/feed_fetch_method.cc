@@ -51,20 +51,27 @@ void SetFeedVariable(Scope* scope,
   // If var_name Variable is not found in GlobalScope, a new variable will
   // be created.
   VLOG(3) << "SetFeedVariable name=" << var_name << " index=" << index;
+  SetFeedVariable(scope->Var(var_name), input, index);
+}
+
+void SetFeedVariable(Variable* feed_holder,
+                     const phi::DenseTensor& input,
+                     size_t index) {
+  PADDLE_ENFORCE_NOT_NULL(
+      feed_holder,
+      common::errors::InvalidArgument("The feed holder should not be null."));
   if (FLAGS_enable_pir_in_executor) {
     // shared data with input tensor
-    auto feed_ele = scope->Var(var_name);
-    if (!feed_ele->IsType<phi::DenseTensor>()) {
-      VLOG(3) << "Reset " << var_name << " to phi::DenseTensor";
-      feed_ele->Clear();
+    if (!feed_holder->IsType<phi::DenseTensor>()) {
+      VLOG(3) << "Reset the feed holder to phi::DenseTensor";
+      feed_holder->Clear();
     }
-    auto val = feed_ele->GetMutable<phi::DenseTensor>();
+    auto val = feed_holder->GetMutable<phi::DenseTensor>();
     val->ShareDataWith(input);
     // set lod
     val->set_lod(input.lod());
   } else {
-    Variable* g_feed_value = scope->Var(var_name);
-    auto& feed_inputs = *(g_feed_value->GetMutable<FeedList>());
+    auto& feed_inputs = *(feed_holder->GetMutable<FeedList>());
     if (index >= feed_inputs.size()) {
       feed_inputs.resize(index + 1);
     }
@@ -85,19 +92,25 @@ FetchType& GetFetchVariable(const Scope& scope,
   PADDLE_ENFORCE_NOT_NULL(
       g_fetch_value,
       common::errors::NotFound("Variable %s is not found in scope.", var_name));
-  PADDLE_ENFORCE_EQ(g_fetch_value->IsType<FetchList>(),
+  VLOG(3) << "Fetch " << var_name << " with index " << index;
+  return GetFetchVariable(g_fetch_value, index);
+}
+
+FetchType& GetFetchVariable(Variable* fetch_holder, size_t index) {
+  PADDLE_ENFORCE_NOT_NULL(
+      fetch_holder,
+      common::errors::InvalidArgument("The fetch holder should not be null."));
+  PADDLE_ENFORCE_EQ(fetch_holder->IsType<FetchList>(),
                     true,
                     common::errors::InvalidArgument(
                         "Only %s can be invoked by GetFetchVariable",
                         typeid(FetchList).name()));
-  auto& fetch_outputs = *g_fetch_value->GetMutable<FetchList>();
-  auto& tensor = fetch_outputs[index];
-  VLOG(3) << "Fetch " << var_name << " with index " << index;
+  auto& fetch_outputs = *fetch_holder->GetMutable<FetchList>();
   PADDLE_ENFORCE_LT(index,
                     fetch_outputs.size(),
                     common::errors::InvalidArgument(
                         "index must less than fetch_outputs size."));
-  return tensor;
+  return fetch_outputs[index];
 }
 
 phi::DenseTensor& GetVariableTensor(const Scope& scope,
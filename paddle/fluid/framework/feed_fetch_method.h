@@ -28,6 +28,7 @@ namespace paddle {
 namespace framework {
 
 class Scope;
+class Variable;
 
 void SetVariable(Scope* scope,
                  const phi::DenseTensor& input,
@@ -38,10 +39,18 @@ void SetFeedVariable(Scope* scope,
                      const std::string& var_name,
                      size_t index);
 
+// Set the feed of index in a feed holder resolved before, so the feeds of a
+// prepared program skip the lookups of the holder by name.
+void SetFeedVariable(Variable* feed_holder,
+                     const phi::DenseTensor& input,
+                     size_t index);
+
 FetchType& GetFetchVariable(const Scope& scope,
                             const std::string& var_name,
                             size_t index);
 
+FetchType& GetFetchVariable(Variable* fetch_holder, size_t index);
+
 phi::DenseTensor& GetVariableTensor(const Scope& scope,
                                     const std::string& var_name);
 
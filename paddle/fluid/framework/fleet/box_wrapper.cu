@@ -18,6 +18,12 @@
 #include <memory>
 #include <numeric>
 
+#include <thrust/copy.h>
+#include <thrust/execution_policy.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
 #include "paddle/fluid/framework/fleet/box_wrapper.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
@@ -28,7 +34,8 @@ namespace framework {
 template <size_t EMBEDX_DIM, size_t EXPAND_EMBED_DIM>
 __global__ void PullCopy(
     float** dest,
-    const boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>* src,
+    const boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>* values,
+    const int* key_index,
     const int64_t* len,
     int hidden,
     int expand_dim,
@@ -36,6 +43,8 @@ __global__ void PullCopy(
     int total_len,
     uint64_t** keys) {
   CUDA_KERNEL_LOOP(i, total_len) {
+    // the value of the distinct key is expanded to every slot using it
+    const auto* src = values + key_index[i];
     int low = 0;
     int high = slot_num - 1;
     while (low < high) {
@@ -52,35 +61,59 @@ __global__ void PullCopy(
       *(dest[x] + y * hidden + 1) = 0;
       *(dest[x] + y * hidden + 2) = 0;
     } else {
-      *(dest[x] + y * hidden) = (src + i)->show;
-      *(dest[x] + y * hidden + 1) = (src + i)->clk;
-      *(dest[x] + y * hidden + 2) = (src + i)->embed_w;
+      *(dest[x] + y * hidden) = src->show;
+      *(dest[x] + y * hidden + 1) = src->clk;
+      *(dest[x] + y * hidden + 2) = src->embed_w;
     }
-    if ((src + i)->embedding_size == 0 || *(keys[x] + y) == 0) {
+    if (src->embedding_size == 0 || *(keys[x] + y) == 0) {
       for (int j = 0; j < hidden - 3; j++) {
         *(dest[x] + y * hidden + 3 + j) = 0;
       }
     } else {
       for (int j = 0; j < hidden - 3; j++) {
-        *(dest[x] + y * hidden + 3 + j) = (src + i)->embedx[1 + j];
+        *(dest[x] + y * hidden + 3 + j) = src->embedx[1 + j];
       }
     }
     // process embed_expand
     if (expand_dim > 0) {
       int z = x + slot_num;
-      if ((src + i)->embed_expand_size[0] == 0 || *(keys[x] + y) == 0) {
+      if (src->embed_expand_size[0] == 0 || *(keys[x] + y) == 0) {
         for (int j = 0; j < expand_dim; j++) {
           *(dest[z] + y * expand_dim + j) = 0;
         }
       } else {
         for (int j = 0; j < expand_dim; j++) {
-          *(dest[z] + y * expand_dim + j) = (src + i)->embed_expand[1 + j];
+          *(dest[z] + y * expand_dim + j) = src->embed_expand[1 + j];
         }
       }
     }
   }  // end kernel loop
 }
 
+__global__ void MarkKeyHeadsKernel(const uint64_t* sorted_keys,
+                                   int* heads,
+                                   int total_len) {
+  CUDA_KERNEL_LOOP(i, total_len) {
+    heads[i] = (i == 0 || sorted_keys[i] != sorted_keys[i - 1]) ? 1 : 0;
+  }
+}
+
+__global__ void ScatterUniqueKeysKernel(const uint64_t* sorted_keys,
+                                        const int* order,
+                                        const int* key_ids,
+                                        uint64_t* unique_keys,
+                                        int* key_index,
+                                        int total_len) {
+  CUDA_KERNEL_LOOP(i, total_len) {
+    // key_ids is the inclusive scan of the heads of the sorted keys
+    int id = key_ids[i] - 1;
+    key_index[order[i]] = id;
+    if (i == 0 || sorted_keys[i] != sorted_keys[i - 1]) {
+      unique_keys[id] = sorted_keys[i];
+    }
+  }
+}
+
 __global__ void CopyKeysKernel(uint64_t** src_keys,
                                uint64_t* dest_total_keys,
                                const int64_t* len,
@@ -146,6 +179,7 @@ void BoxWrapper::CopyForPull(const phi::Place& place,
                              uint64_t** gpu_keys,
                              const std::vector<float*>& values,
                              void* total_values_gpu,
+                             const int* gpu_key_index,
                              const int64_t* gpu_len,
                              const int slot_num,
                              const int hidden_size,
@@ -191,6 +225,7 @@ void BoxWrapper::CopyForPull(const phi::Place& place,
         gpu_values,                                                      \
         reinterpret_cast<boxps::FeatureValueGpu<EmbedxDim, ExpandDim>*>( \
             total_values_gpu),                                           \
+        gpu_key_index,                                                   \
         gpu_len,                                                         \
         hidden_size,                                                     \
         expand_embed_dim,                                                \
@@ -207,6 +242,7 @@ void BoxWrapper::CopyForPull(const phi::Place& place,
             gpu_values,                                                      \
             reinterpret_cast<boxps::FeatureValueGpu<EmbedxDim, ExpandDim>*>( \
                 total_values_gpu),                                           \
+            gpu_key_index,                                                   \
             gpu_len,                                                         \
             hidden_size,                                                     \
             expand_embed_dim,                                                \
@@ -257,6 +293,76 @@ void BoxWrapper::CopyKeys(const phi::Place& place,
 #endif
 }
 
+int BoxWrapper::DedupKeys(const phi::Place& place,
+                          const uint64_t* total_keys,
+                          uint64_t* unique_keys,
+                          int* key_index,
+                          int total_len) {
+  if (total_len == 0) {
+    return 0;
+  }
+  auto stream = dynamic_cast<phi::GPUContext*>(
+                    phi::DeviceContextPool::Instance().Get(place))
+                    ->stream();
+  auto buf_sorted_key = memory::Alloc(place, total_len * sizeof(uint64_t));
+  auto buf_order = memory::Alloc(place, total_len * sizeof(int));
+  auto buf_key_id = memory::Alloc(place, total_len * sizeof(int));
+  uint64_t* sorted_keys = reinterpret_cast<uint64_t*>(buf_sorted_key->ptr());
+  int* order = reinterpret_cast<int*>(buf_order->ptr());
+  int* key_ids = reinterpret_cast<int*>(buf_key_id->ptr());
+#ifdef PADDLE_WITH_HIP
+  const auto& exec_policy = thrust::hip::par.on(stream);
+#else
+  const auto& exec_policy = thrust::cuda::par.on(stream);
+#endif
+  thrust::copy(exec_policy, total_keys, total_keys + total_len, sorted_keys);
+  thrust::sequence(exec_policy, order, order + total_len);
+  thrust::sort_by_key(exec_policy, sorted_keys, sorted_keys + total_len, order);
+#ifdef PADDLE_WITH_HIP
+  hipLaunchKernelGGL(MarkKeyHeadsKernel,
+                     dim3((total_len + 512 - 1) / 512),
+                     dim3(512),
+                     0,
+                     stream,
+                     sorted_keys,
+                     key_ids,
+                     total_len);
+#else
+  MarkKeyHeadsKernel<<<(total_len + 512 - 1) / 512, 512, 0, stream>>>(
+      sorted_keys, key_ids, total_len);
+#endif
+  thrust::inclusive_scan(exec_policy, key_ids, key_ids + total_len, key_ids);
+#ifdef PADDLE_WITH_HIP
+  hipLaunchKernelGGL(ScatterUniqueKeysKernel,
+                     dim3((total_len + 512 - 1) / 512),
+                     dim3(512),
+                     0,
+                     stream,
+                     sorted_keys,
+                     order,
+                     key_ids,
+                     unique_keys,
+                     key_index,
+                     total_len);
+  hipStreamSynchronize(stream);
+#else
+  ScatterUniqueKeysKernel<<<(total_len + 512 - 1) / 512, 512, 0, stream>>>(
+      sorted_keys, order, key_ids, unique_keys, key_index, total_len);
+  cudaStreamSynchronize(stream);
+#endif
+  int unique_len = 0;
+#ifdef PADDLE_WITH_HIP
+  hipMemcpy(
+      &unique_len, key_ids + total_len - 1, sizeof(int), hipMemcpyDeviceToHost);
+#else
+  cudaMemcpy(&unique_len,
+             key_ids + total_len - 1,
+             sizeof(int),
+             cudaMemcpyDeviceToHost);
+#endif
+  return unique_len;
+}
+
 void BoxWrapper::CopyForPush(const phi::Place& place,
                              const std::vector<const float*>& grad_values,
                              void* total_grad_values_gpu,
@@ -405,6 +405,7 @@ class BoxWrapper {
                    uint64_t** gpu_keys,
                    const std::vector<float*>& values,
                    void* total_values_gpu,
+                   const int* gpu_key_index,
                    const int64_t* gpu_len,
                    const int slot_num,
                    const int hidden_size,
@@ -427,6 +428,15 @@ class BoxWrapper {
                 int slot_num,
                 int total_len);
 
+  // Sorts the keys to write the distinct ones to unique_keys, and the index
+  // of total_keys[i] in them to key_index[i]. Returns the number of the
+  // distinct keys.
+  int DedupKeys(const phi::Place& place,
+                const uint64_t* total_keys,
+                uint64_t* unique_keys,
+                int* key_index,
+                int total_len);
+
   void CheckEmbedSizeIsValid(int embedx_dim, int expand_embed_dim);
 
   boxps::PSAgentBase* GetAgent() { return p_agent_; }
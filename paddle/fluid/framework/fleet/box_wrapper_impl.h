@@ -32,13 +32,6 @@ void BoxWrapper::PullSparseCase(const phi::Place& place,
 
   int64_t total_length =
       std::accumulate(slot_lengths.begin(), slot_lengths.end(), 0UL);
-  auto buf = memory::Alloc(
-      place,
-      total_length *
-          sizeof(boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>));
-  boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>* total_values_gpu =
-      reinterpret_cast<boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>*>(
-          buf->ptr());
 
   if (phi::is_cpu_place(place)) {
     PADDLE_THROW(common::errors::Unimplemented(
@@ -86,12 +79,30 @@ void BoxWrapper::PullSparseCase(const phi::Place& place,
                    gpu_len,
                    static_cast<int>(slot_lengths.size()),
                    static_cast<int>(total_length));
-    VLOG(3) << "Begin call PullSparseGPU in BoxPS";
+    // the keys repeated in and across the slots are pulled once
+    auto buf_unique_key = memory::Alloc(place, total_length * sizeof(uint64_t));
+    auto buf_key_index = memory::Alloc(place, total_length * sizeof(int));
+    uint64_t* unique_keys = reinterpret_cast<uint64_t*>(buf_unique_key->ptr());
+    int* gpu_key_index = reinterpret_cast<int*>(buf_key_index->ptr());
+    int unique_length = this->DedupKeys(place,
+                                        total_keys,
+                                        unique_keys,
+                                        gpu_key_index,
+                                        static_cast<int>(total_length));
+    auto buf = memory::Alloc(
+        place,
+        unique_length *
+            sizeof(boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>));
+    boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>* total_values_gpu =
+        reinterpret_cast<
+            boxps::FeatureValueGpu<EMBEDX_DIM, EXPAND_EMBED_DIM>*>(buf->ptr());
+    VLOG(3) << "Begin call PullSparseGPU in BoxPS, unique key_num["
+            << unique_length << "]";
     pull_boxps_timer.Start();
     int ret =
-        boxps_ptr_->PullSparseGPU(total_keys,
+        boxps_ptr_->PullSparseGPU(unique_keys,
                                   reinterpret_cast<void*>(total_values_gpu),
-                                  static_cast<int>(total_length),
+                                  unique_length,
                                   device_id);
     PADDLE_ENFORCE_EQ(
         ret,
@@ -105,6 +116,7 @@ void BoxWrapper::PullSparseCase(const phi::Place& place,
                       gpu_keys,
                       values,
                       reinterpret_cast<void*>(total_values_gpu),
+                      gpu_key_index,
                       gpu_len,
                       static_cast<int>(slot_lengths.size()),
                       hidden_size,
@@ -0,0 +1,125 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// Dedups the feasigns of a mini-batch, so that a pull sends every key once
+// however many times it occurs in the batch, as the frequent keys of the
+// power-law features do.
+//
+// unique_keys() are the distinct keys in the order of their first
+// occurrence, and inverse()[i] is the index of the i-th key in unique_keys().
+// An instance is meant to be kept by a worker thread and reused from batch to
+// batch, its buffers being kept.
+class FeasignDedup {
+ public:
+  // Pulls the values of the keys into values, value_size floats each, by
+  // pulling every unique key once with the dedup of the calling thread.
+  // pull_fn(unique_values, unique_keys, num) pulls num keys into their value
+  // pointers and returns the status of the pull, which is returned.
+  template <typename PullFn>
+  static int32_t Pull(const uint64_t* keys,
+                      float* const* values,
+                      size_t num,
+                      size_t value_size,
+                      PullFn&& pull_fn) {
+    thread_local FeasignDedup dedup;
+    dedup.Build(keys, num);
+    auto& unique_values = dedup.UniqueValues(values);
+    int32_t ret = pull_fn(unique_values.data(),
+                          dedup.unique_keys().data(),
+                          dedup.unique_keys().size());
+    dedup.CopyToDuplicates(values, value_size);
+    return ret;
+  }
+
+  void Build(const uint64_t* keys, size_t num) {
+    size_t capacity = 16;
+    while (capacity < num * 2) {
+      capacity <<= 1;
+    }
+    int shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      --shift;
+    }
+    table_keys_.resize(capacity);
+    table_index_.assign(capacity, kEmpty);
+    unique_keys_.clear();
+    first_.clear();
+    inverse_.resize(num);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < num; ++i) {
+      uint64_t key = keys[i];
+      size_t slot =
+          static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift) & mask;
+      while (table_index_[slot] != kEmpty && table_keys_[slot] != key) {
+        slot = (slot + 1) & mask;
+      }
+      if (table_index_[slot] == kEmpty) {
+        table_keys_[slot] = key;
+        table_index_[slot] = static_cast<uint32_t>(unique_keys_.size());
+        unique_keys_.push_back(key);
+        first_.push_back(static_cast<uint32_t>(i));
+      }
+      inverse_[i] = table_index_[slot];
+    }
+  }
+
+  // The value pointers of the first occurrences of the unique keys, given
+  // the value pointers of all the keys, to pull the unique keys into.
+  std::vector<float*>& UniqueValues(float* const* values) {
+    unique_values_.resize(first_.size());
+    for (size_t i = 0; i < first_.size(); ++i) {
+      unique_values_[i] = values[first_[i]];
+    }
+    return unique_values_;
+  }
+
+  // Copies the values pulled into UniqueValues() to the other occurrences of
+  // the keys, value_size floats each.
+  void CopyToDuplicates(float* const* values, size_t value_size) const {
+    for (size_t i = 0; i < inverse_.size(); ++i) {
+      uint32_t first = first_[inverse_[i]];
+      if (first != i) {
+        memcpy(values[i], values[first], sizeof(float) * value_size);
+      }
+    }
+  }
+
+  const std::vector<uint64_t>& unique_keys() const { return unique_keys_; }
+  const std::vector<uint32_t>& inverse() const { return inverse_; }
+
+ private:
+  static constexpr uint32_t kEmpty = UINT32_MAX;
+
+  // open addressing table of the keys to their index in unique_keys_
+  std::vector<uint64_t> table_keys_;
+  std::vector<uint32_t> table_index_;
+  std::vector<uint64_t> unique_keys_;
+  // the position of the first occurrence of every unique key
+  std::vector<uint32_t> first_;
+  std::vector<uint32_t> inverse_;
+  std::vector<float*> unique_values_;
+};
+
+}  // namespace framework
+}  // namespace paddle
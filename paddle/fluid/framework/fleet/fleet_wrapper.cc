@@ -29,6 +29,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/fleet/feasign_dedup.h"
 #include "paddle/fluid/framework/op_registry.h"
 
 namespace paddle {
@@ -643,37 +644,44 @@ void FleetWrapper::PullSparseVarsSync(
     pull_result_ptr.push_back(t.data());
   }
 
-  int32_t cnt = 0;
-  while (true) {
-    pull_sparse_status.clear();
-    auto status = pslib_ptr_->_worker_ptr->pull_sparse(
-        pull_result_ptr.data(), table_id, fea_keys->data(), fea_keys->size());
-    pull_sparse_status.push_back(std::move(status));
-    bool flag = true;
-    for (auto& t : pull_sparse_status) {
-      t.wait();
-      int32_t status = -1;
-      try {
-        status = t.get();
-      } catch (const std::future_error& e) {
-        VLOG(0) << "Caught a future_error with code" << e.code()
-                << ", Message:" << e.what();
-      }
-      if (status != 0) {
-        VLOG(0) << "fleet pull sparse failed, status[" << status << "]";
-        sleep(sleep_seconds_before_fail_exit_);
-        flag = false;
-        cnt++;
-      }
-      if (cnt > 3) {
-        VLOG(0) << "fleet pull sparse failed, retry 3 times";
-        exit(-1);
-      }
-    }
-    if (flag) {
-      break;
-    }
-  }
+  FeasignDedup::Pull(
+      fea_keys->data(),
+      pull_result_ptr.data(),
+      fea_keys->size(),
+      fea_value_dim,
+      [&](float** values, const uint64_t* keys, size_t num) {
+        int32_t cnt = 0;
+        while (true) {
+          pull_sparse_status.clear();
+          auto status = pslib_ptr_->_worker_ptr->pull_sparse(
+              values, table_id, keys, num);
+          pull_sparse_status.push_back(std::move(status));
+          bool flag = true;
+          for (auto& t : pull_sparse_status) {
+            t.wait();
+            int32_t status = -1;
+            try {
+              status = t.get();
+            } catch (const std::future_error& e) {
+              VLOG(0) << "Caught a future_error with code" << e.code()
+                      << ", Message:" << e.what();
+            }
+            if (status != 0) {
+              VLOG(0) << "fleet pull sparse failed, status[" << status << "]";
+              sleep(sleep_seconds_before_fail_exit_);
+              flag = false;
+              cnt++;
+            }
+            if (cnt > 3) {
+              VLOG(0) << "fleet pull sparse failed, retry 3 times";
+              exit(-1);
+            }
+          }
+          if (flag) {
+            return 0;
+          }
+        }
+      });
 #endif
 }
 
@@ -737,10 +745,17 @@ void FleetWrapper::PullSparseToTensorSync(
       pull_result_ptr.push_back(output_data + output_len);
     }
   }
-  auto status = pslib_ptr_->_worker_ptr->pull_sparse(
-      pull_result_ptr.data(), table_id, fea_keys.data(), fea_keys.size());
-  status.wait();
-  auto ret = status.get();
+  auto ret = FeasignDedup::Pull(
+      fea_keys.data(),
+      pull_result_ptr.data(),
+      fea_keys.size(),
+      fea_dim,
+      [&](float** values, const uint64_t* keys, size_t num) {
+        auto status =
+            pslib_ptr_->_worker_ptr->pull_sparse(values, table_id, keys, num);
+        status.wait();
+        return status.get();
+      });
   if (ret != 0) {
     LOG(ERROR) << "fleet pull sparse failed, status[" << ret << "]";
     sleep(sleep_seconds_before_fail_exit_);
@@ -106,6 +106,10 @@ class HeterContext {
   void* sub_graph_float_feas = NULL;
   uint32_t shard_num_ = 37;
   uint16_t pass_id_ = 0;
+  // the feasigns held against the budget of the pass pipeline
+  uint64_t pipeline_feasign_num_ = 0;
+  // whether the keys are divided to the devices before BeginPass
+  bool prepared_ = false;
   uint64_t size() {
     uint64_t total_size = 0;
     for (auto& keys : feature_keys_) {
@@ -200,6 +204,7 @@ class HeterContext {
       item.clear();
     }
     keys2rank_map_vec_.clear();
+    prepared_ = false;
   }
   void batch_add_keys(
       const std::vector<std::unordered_set<uint64_t>>& thread_keys) {
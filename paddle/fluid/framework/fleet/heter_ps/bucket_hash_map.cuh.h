@@ -0,0 +1,358 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#ifdef PADDLE_WITH_HETERPS
+#if defined(PADDLE_WITH_CUDA)
+#include <cooperative_groups.h>
+#include <thrust/pair.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/fleet/heter_ps/cudf/concurrent_unordered_map.cuh.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * An open addressing hash map whose slots are grouped by buckets of one cache
+ * line. The kBucketSize threads of a tile probe a bucket together, each of
+ * them compares one slot, and a key goes on to the next bucket only when its
+ * bucket is full, which keeps the probing short at the load factor of 0.9.
+ *
+ * Every bucket has an overflow flag, set once a key went on from it, and the
+ * probing of a key ends at the first bucket without the flag. So erase just
+ * empties the slot of the key, no key value is reserved to mark it, and the
+ * later inserts reuse the slot. Erase should not run together with insert or
+ * find.
+ *
+ * The device methods are called by all threads of a tile, each with its own
+ * key, and the inactive threads only help the probing.
+ */
+template <typename Key,
+          typename Element,
+          Key unused_key,
+          typename Hasher = default_hash<Key>,
+          typename Allocator = managed_allocator<thrust::pair<Key, Element>>>
+class BucketHashMap : public managed {
+ public:
+  using size_type = size_t;
+  using hasher = Hasher;
+  using allocator_type = Allocator;
+  using key_type = Key;
+  using value_type = thrust::pair<Key, Element>;
+  using mapped_type = Element;
+
+  static_assert(sizeof(value_type) == 8 || sizeof(value_type) == 16,
+                "the slots of a bucket should fill a cache line");
+  static constexpr int kBucketSize = 128 / sizeof(value_type);
+
+  BucketHashMap(const BucketHashMap&) = delete;
+  BucketHashMap& operator=(const BucketHashMap&) = delete;
+  BucketHashMap(cudaStream_t stream,
+                size_type n,
+                const mapped_type unused_element,
+                const Hasher& hf = hasher(),
+                const allocator_type& a = allocator_type())
+      : m_hf(hf),
+        m_unused_element(unused_element),
+        m_allocator(a),
+        m_num_buckets(
+            std::max<size_type>((n + kBucketSize - 1) / kBucketSize, 1)),
+        m_hashtbl_size(m_num_buckets * kBucketSize),
+        m_enable_collision_stat(false),
+        m_insert_times(0),
+        m_insert_collisions(0),
+        m_query_times(0),
+        m_query_collisions(0) {
+    m_hashtbl_values = m_allocator.allocate(m_hashtbl_size);
+    m_overflowed = flag_allocator_type(m_allocator).allocate(m_num_buckets);
+    int dev_id = 0;
+    CUDA_RT_CALL(cudaGetDevice(&dev_id));
+    prefetch_values(dev_id, stream);
+    clear_async(stream);
+    CUDA_RT_CALL(cudaStreamSynchronize(stream));
+    CUDA_RT_CALL(cudaGetLastError());
+    m_enable_collision_stat = FLAGS_gpugraph_enable_hbm_table_collision_stat;
+  }
+
+  ~BucketHashMap() {
+    m_allocator.deallocate(m_hashtbl_values, m_hashtbl_size);
+    flag_allocator_type(m_allocator).deallocate(m_overflowed, m_num_buckets);
+  }
+
+  __host__ __device__ size_type size() const { return m_hashtbl_size; }
+  __host__ __device__ value_type* data() const { return m_hashtbl_values; }
+
+  // Returns the slot of the key of each active thread, or nullptr if missing.
+  template <typename Tile>
+  __forceinline__ __device__ value_type* find(const Tile& tile,
+                                              const key_type& k,
+                                              bool active) {
+    value_type* result = nullptr;
+    unsigned int pending = tile.ballot(active);
+    while (pending) {
+      const int src = __ffs(pending) - 1;
+      pending &= pending - 1;
+      value_type* slot = find_one(tile, tile.shfl(k, src));
+      if (static_cast<int>(tile.thread_rank()) == src) {
+        result = slot;
+      }
+    }
+    return result;
+  }
+
+  // Inserts or replaces the pair of each active thread and returns its slot,
+  // or nullptr if the map is full. local_count counts the new keys.
+  template <typename Tile>
+  __forceinline__ __device__ value_type* insert(const Tile& tile,
+                                                const value_type& x,
+                                                bool active,
+                                                uint64_t* local_count = NULL) {
+    value_type* result = nullptr;
+    unsigned int pending = tile.ballot(active);
+    while (pending) {
+      const int src = __ffs(pending) - 1;
+      pending &= pending - 1;
+      value_type* slot = insert_one(tile,
+                                    tile.shfl(x.first, src),
+                                    tile.shfl(x.second, src),
+                                    local_count);
+      if (static_cast<int>(tile.thread_rank()) == src) {
+        result = slot;
+      }
+    }
+    return result;
+  }
+
+  // Erases the key of each active thread, returns whether it was found.
+  template <typename Tile>
+  __forceinline__ __device__ bool erase(const Tile& tile,
+                                        const key_type& k,
+                                        bool active) {
+    bool result = false;
+    unsigned int pending = tile.ballot(active);
+    while (pending) {
+      const int src = __ffs(pending) - 1;
+      pending &= pending - 1;
+      const key_type key = tile.shfl(k, src);
+      value_type* slot = find_one(tile, key);
+      bool erased = false;
+      if (slot != nullptr && tile.thread_rank() == 0) {
+        erased = atomicCAS(&(slot->first), key, unused_key) == key;
+      }
+      erased = tile.shfl(erased, 0);
+      if (static_cast<int>(tile.thread_rank()) == src) {
+        result = erased;
+      }
+    }
+    return result;
+  }
+
+  void clear_async(cudaStream_t stream = 0) {
+    constexpr int block_size = 128;
+    init_hashtbl<<<((m_hashtbl_size - 1) / block_size) + 1,
+                   block_size,
+                   0,
+                   stream>>>(
+        m_hashtbl_values, m_hashtbl_size, unused_key, m_unused_element);
+    CUDA_RT_CALL(cudaMemsetAsync(
+        m_overflowed, 0, m_num_buckets * sizeof(unsigned int), stream));
+    if (m_enable_collision_stat) {
+      m_insert_times = 0;
+      m_insert_collisions = 0;
+      m_query_times = 0;
+      m_query_collisions = 0;
+    }
+  }
+
+  void print() {
+    for (size_type i = 0; i < 5; ++i) {
+      VLOG(1) << i << ": " << m_hashtbl_values[i].first << ","
+              << m_hashtbl_values[i].second;
+    }
+  }
+
+  int prefetch(const int dev_id, cudaStream_t stream = 0) {
+    prefetch_values(dev_id, stream);
+    CUDA_RT_CALL(cudaMemPrefetchAsync(this, sizeof(*this), dev_id, stream));
+    return 0;
+  }
+
+  __host__ void print_collision(int id) {
+    if (m_enable_collision_stat) {
+      VLOG(1) << "collision stat for bucket hbm table " << id << ", insert("
+              << m_insert_times << ":" << m_insert_collisions << ":"
+              << m_insert_collisions / static_cast<double>(m_insert_times)
+              << "), query(" << m_query_times << ":" << m_query_collisions
+              << ":" << m_query_collisions / static_cast<double>(m_query_times)
+              << ")";
+    }
+  }
+
+ private:
+  using flag_allocator_type = typename std::allocator_traits<
+      allocator_type>::template rebind_alloc<unsigned int>;
+
+  __forceinline__ __device__ key_type load_key(const value_type* slot) const {
+    return *reinterpret_cast<const volatile key_type*>(&(slot->first));
+  }
+
+  __forceinline__ __device__ bool overflowed(size_type bucket) const {
+    return *reinterpret_cast<const volatile unsigned int*>(m_overflowed +
+                                                           bucket) != 0;
+  }
+
+  __forceinline__ __device__ size_type next_bucket(size_type bucket) const {
+    return bucket + 1 == m_num_buckets ? 0 : bucket + 1;
+  }
+
+  template <typename Tile>
+  __forceinline__ __device__ value_type* find_one(const Tile& tile,
+                                                  const key_type& k) {
+    size_type bucket = m_hf(k) % m_num_buckets;
+    value_type* result = nullptr;
+    size_type counter = 0;
+    while (counter++ < m_num_buckets) {
+      value_type* slots = m_hashtbl_values + bucket * kBucketSize;
+      const key_type cur = load_key(slots + tile.thread_rank());
+      const unsigned int hit = tile.ballot(cur == k);
+      if (hit) {
+        result = slots + __ffs(hit) - 1;
+        break;
+      }
+      // no key went on from a bucket without the overflow flag
+      if (!overflowed(bucket)) {
+        break;
+      }
+      bucket = next_bucket(bucket);
+    }
+    if (m_enable_collision_stat && tile.thread_rank() == 0) {
+      atomicAdd(&m_query_times, 1);
+      atomicAdd(&m_query_collisions, (uint64_t)counter);
+    }
+    return result;
+  }
+
+  template <typename Tile>
+  __forceinline__ __device__ value_type* insert_one(const Tile& tile,
+                                                    const key_type& k,
+                                                    const mapped_type& v,
+                                                    uint64_t* local_count) {
+    const size_type home = m_hf(k) % m_num_buckets;
+    size_type counter = 0;
+    while (true) {
+      // look for the key along the whole probing sequence first, and claim
+      // the first empty slot of it, so that the threads inserting the same key
+      // always race for the same slot
+      value_type* target = nullptr;
+      bool exists = false;
+      size_type bucket = home;
+      for (size_type i = 0; i < m_num_buckets; ++i) {
+        ++counter;
+        value_type* slots = m_hashtbl_values + bucket * kBucketSize;
+        const key_type cur = load_key(slots + tile.thread_rank());
+        const unsigned int hit = tile.ballot(cur == k);
+        if (hit) {
+          target = slots + __ffs(hit) - 1;
+          exists = true;
+          break;
+        }
+        const unsigned int empty = tile.ballot(cur == unused_key);
+        if (target == nullptr && empty) {
+          target = slots + __ffs(empty) - 1;
+        }
+        if (!overflowed(bucket)) {
+          if (target != nullptr) {
+            break;
+          }
+          // the sequence is full, extend it by the next bucket
+          if (tile.thread_rank() == 0) {
+            atomicExch(m_overflowed + bucket, 1u);
+          }
+          tile.sync();
+        }
+        bucket = next_bucket(bucket);
+      }
+      if (target == nullptr) {
+        return nullptr;
+      }
+      bool success = exists;
+      if (!exists && tile.thread_rank() == 0) {
+        success = atomicCAS(&(target->first), unused_key, k) == unused_key;
+      }
+      success = tile.shfl(success, 0);
+      if (success) {
+        if (tile.thread_rank() == 0) {
+          target->second = v;
+          if (local_count != NULL && !exists) {
+            atomicAdd(local_count, 1);
+          }
+          if (m_enable_collision_stat) {
+            atomicAdd(&m_insert_times, 1);
+            atomicAdd(&m_insert_collisions, (uint64_t)counter);
+          }
+        }
+        return target;
+      }
+      // the slot is taken by another thread, which may have inserted the key
+    }
+  }
+
+  void prefetch_values(const int dev_id, cudaStream_t stream) {
+    cudaPointerAttributes hashtbl_values_ptr_attributes;
+    cudaError_t status = cudaPointerGetAttributes(
+        &hashtbl_values_ptr_attributes, m_hashtbl_values);
+
+#if CUDART_VERSION >= 10000
+    if (cudaSuccess == status &&
+        hashtbl_values_ptr_attributes.type == cudaMemoryTypeManaged)
+#else
+    if (cudaSuccess == status && hashtbl_values_ptr_attributes.isManaged)
+#endif
+    {
+      CUDA_RT_CALL(cudaMemPrefetchAsync(m_hashtbl_values,
+                                        m_hashtbl_size * sizeof(value_type),
+                                        dev_id,
+                                        stream));
+      CUDA_RT_CALL(cudaMemPrefetchAsync(m_overflowed,
+                                        m_num_buckets * sizeof(unsigned int),
+                                        dev_id,
+                                        stream));
+    }
+  }
+
+  const hasher m_hf;
+  const mapped_type m_unused_element;
+  allocator_type m_allocator;
+
+  size_type m_num_buckets;
+  size_type m_hashtbl_size;
+  value_type* m_hashtbl_values;
+  // the buckets some keys went on from
+  unsigned int* m_overflowed;
+
+  bool m_enable_collision_stat;
+  uint64_t m_insert_times;
+  uint64_t m_insert_collisions;
+  uint64_t m_query_times;
+  uint64_t m_query_collisions;
+};
+
+}  // end namespace framework
+}  // end namespace paddle
+#endif
+#endif
@@ -894,6 +894,8 @@ class VirtualAccessor {
                            const size_t grad_value_size) = 0;
 
   virtual std::string ParseToString(const float* v, int param_size) = 0;
+
+  virtual uint64_t GetCpuPtr(float* gpu_val) = 0;
 };
 
 template <typename GPUAccessor>
@@ -1165,6 +1167,10 @@ class AccessorWrapper : public VirtualAccessor {
     return gpu_accessor_.ParseToString(v, param_size);
   }
 
+  virtual uint64_t GetCpuPtr(float* gpu_val) {
+    return gpu_accessor_.common_feature_value.CpuPtr(gpu_val);
+  }
+
   GPUAccessor gpu_accessor_;
 };
 
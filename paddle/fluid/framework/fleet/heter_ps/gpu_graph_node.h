@@ -46,6 +46,9 @@ struct GpuPsCommGraph {
   half *weight_list;  // locate on both side, which length is the same as
                       // neighbor_list
   bool is_weighted;
+  // only locate on gpu side with FLAGS_graph_weighted_sample_by_prefix_sum,
+  // the inclusive prefix sum of the weights of each node's neighbors
+  float *weight_prefix_list = nullptr;
   GpuPsCommGraph()
       : node_list(nullptr),
         node_size(0),
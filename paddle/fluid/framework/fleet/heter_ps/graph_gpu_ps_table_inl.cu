@@ -25,6 +25,7 @@
 #include "paddle/common/flags.h"
 #include "paddle/fluid/framework/fleet/heter_ps/gpu_graph_utils.h"
 #include "paddle/fluid/framework/fleet/heter_ps/graph_gpu_ps_table.h"
+#include "paddle/fluid/framework/fleet/heter_ps/graph_weight_prefix.cuh.h"
 
 #define ALIGN_INT64(LEN) (uint64_t((LEN) + 7) & uint64_t(~7))
 #define HBMPS_MAX_BUFF 1024 * 1024
@@ -32,6 +33,7 @@
 
 COMMON_DECLARE_bool(enable_neighbor_list_use_uva);
 COMMON_DECLARE_bool(enable_graph_multi_node_sampling);
+COMMON_DECLARE_bool(graph_weighted_sample_by_prefix_sum);
 
 namespace paddle {
 namespace framework {
@@ -492,6 +494,33 @@ __launch_bounds__(BLOCK_SIZE) __global__
   }
 }
 
+// samples one neighbor by weight, which is what A-RES gives for one neighbor
+__global__ void weighted_sample_one_kernel(GpuPsCommGraph graph,
+                                           GpuPsNodeInfo* node_info_list,
+                                           uint64_t* res,
+                                           int n,
+                                           uint64_t random_seed,
+                                           float* weight_array,
+                                           bool return_weight) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= n) return;
+  const uint32_t neighbor_len = node_info_list[i].neighbor_size;
+  if (neighbor_len == 0) return;
+  const uint32_t data_offset = node_info_list[i].neighbor_offset;
+  const float* prefix = graph.weight_prefix_list + data_offset;
+  uint32_t target = 0;
+  if (neighbor_len > 1) {
+    RandomNumGen rng(i, random_seed);
+    const float u = rng.RandomUniformFloat(prefix[neighbor_len - 1]);
+    target = search_weight_prefix(prefix, neighbor_len, u);
+  }
+  res[i] = graph.neighbor_list[data_offset + target];
+  if (return_weight) {
+    weight_array[i] =
+        static_cast<float>(graph.weight_list[data_offset + target]);
+  }
+}
+
 // A-RES algorithm
 template <unsigned int ITEMS_PER_THREAD, unsigned int BLOCK_SIZE>
 __launch_bounds__(BLOCK_SIZE) __global__
@@ -810,7 +839,17 @@ void GpuPsGraphTable::weighted_sample(GpuPsCommGraph& graph,
   CUDA_CHECK(cudaStreamSynchronize(cur_stream));
 
   paddle::memory::ThrustAllocator<cudaStream_t> allocator(place, cur_stream);
-  if (sample_size > SAMPLE_SIZE_THRESHOLD) {
+  if (sample_size == 1 && graph.weight_prefix_list != nullptr) {
+    weighted_sample_one_kernel<<<grid_size, 128, 0, cur_stream>>>(
+        graph,
+        node_info_list,
+        sample_array,
+        shard_len,
+        random_seed,
+        weight_array,
+        return_weight);
+    CUDA_CHECK(cudaStreamSynchronize(cur_stream));
+  } else if (sample_size > SAMPLE_SIZE_THRESHOLD) {
     // to be optimized
     thrust::exclusive_scan(thrust::cuda::par(allocator).on(cur_stream),
                            neighbor_count_ptr,
@@ -1605,6 +1644,10 @@ void GpuPsGraphTable::clear_graph_info(int gpu_id, int idx) {
     cudaFree(graph.node_list);
     graph.node_list = nullptr;
   }
+  if (graph.weight_prefix_list != NULL) {
+    cudaFree(graph.weight_prefix_list);
+    graph.weight_prefix_list = nullptr;
+  }
 }
 void GpuPsGraphTable::clear_graph_info(int idx) {
   for (int i = 0; i < gpu_num; i++) clear_graph_info(i, idx);
@@ -1918,6 +1961,35 @@ void GpuPsGraphTable::build_graph_on_single_gpu(const GpuPsCommGraph& g,
                                  g.neighbor_size * sizeof(half),
                                  cudaMemcpyHostToDevice,
                                  stream));
+      if (FLAGS_graph_weighted_sample_by_prefix_sum && g.node_size > 0) {
+        cudaStatus = cudaMalloc(&gpu_graph_list_[offset].weight_prefix_list,
+                                g.neighbor_size * sizeof(float));
+        PADDLE_ENFORCE_EQ(
+            cudaStatus,
+            cudaSuccess,
+            common::errors::InvalidArgument(
+                "failed to allocate memory for graph edge weight prefix sum "
+                "on gpu %d",
+                resource_->dev_id(gpu_id)));
+        auto node_info_buf = memory::Alloc(
+            phi::GPUPlace(resource_->dev_id(gpu_id)),
+            g.node_size * sizeof(GpuPsNodeInfo),
+            phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+        GpuPsNodeInfo* node_info_ptr =
+            reinterpret_cast<GpuPsNodeInfo*>(node_info_buf->ptr());
+        CUDA_CHECK(cudaMemcpyAsync(node_info_ptr,
+                                   g.node_info_list,
+                                   g.node_size * sizeof(GpuPsNodeInfo),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        const int grid_size = (g.node_size * 32 + 127) / 128;
+        build_weight_prefix_kernel<<<grid_size, 128, 0, stream>>>(
+            node_info_ptr,
+            gpu_graph_list_[offset].weight_list,
+            gpu_graph_list_[offset].weight_prefix_list,
+            g.node_size);
+        CUDA_CHECK(cudaStreamSynchronize(stream));
+      }
     }
 
   } else {
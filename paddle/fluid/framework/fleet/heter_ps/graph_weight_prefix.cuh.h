@@ -0,0 +1,75 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda_fp16.h>
+#include <stdint.h>
+
+#include "paddle/fluid/framework/fleet/heter_ps/gpu_graph_node.h"
+
+namespace paddle {
+namespace framework {
+
+// One warp per node, writes the inclusive prefix sum of the weights of the
+// node's neighbors. The sums are accumulated in double and stored as float,
+// so that the prefix of a node of many neighbors does not drift.
+template <typename WeightT>
+__global__ void build_weight_prefix_kernel(const GpuPsNodeInfo* node_info_list,
+                                           const WeightT* weight,
+                                           float* weight_prefix,
+                                           int64_t n) {
+  const int64_t i =
+      (static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x) / 32;
+  const int lane = threadIdx.x % 32;
+  if (i >= n) return;
+  const uint32_t neighbor_len = node_info_list[i].neighbor_size;
+  const uint32_t data_offset = node_info_list[i].neighbor_offset;
+  double carry = 0;
+  for (uint32_t j = 0; j < neighbor_len; j += 32) {
+    double sum = 0;
+    if (j + lane < neighbor_len) {
+      sum = static_cast<float>(weight[data_offset + j + lane]);
+    }
+#pragma unroll
+    for (int delta = 1; delta < 32; delta <<= 1) {
+      double up = __shfl_up_sync(0xffffffff, sum, delta);
+      if (lane >= delta) sum += up;
+    }
+    if (j + lane < neighbor_len) {
+      weight_prefix[data_offset + j + lane] = static_cast<float>(carry + sum);
+    }
+    carry += __shfl_sync(0xffffffff, sum, 31);
+  }
+}
+
+// The position of the first of the len prefix sums that is greater than u,
+// or the last one if there is none.
+__device__ __forceinline__ uint32_t search_weight_prefix(const float* prefix,
+                                                         uint32_t len,
+                                                         float u) {
+  uint32_t low = 0, high = len - 1;
+  while (low < high) {
+    const uint32_t mid = (low + high) / 2;
+    if (prefix[mid] > u) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return low;
+}
+
+}  // namespace framework
+}  // namespace paddle
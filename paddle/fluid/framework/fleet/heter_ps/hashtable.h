@@ -31,6 +31,7 @@ limitations under the License. */
 #include "paddle/phi/core/utils/rw_lock.h"
 
 #if defined(PADDLE_WITH_CUDA)
+#include "paddle/fluid/framework/fleet/heter_ps/bucket_hash_map.cuh.h"
 #include "paddle/fluid/framework/fleet/heter_ps/cudf/concurrent_unordered_map.cuh.h"
 #include "paddle/fluid/framework/fleet/heter_ps/mem_pool.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_types.h"
@@ -61,6 +62,17 @@ class TableContainer
                                  std::numeric_limits<KeyType>::max()>(
             stream, capacity, ValType()) {}
 };
+
+template <typename KeyType, typename ValType>
+class BucketTableContainer
+    : public BucketHashMap<KeyType,
+                           ValType,
+                           std::numeric_limits<KeyType>::max()> {
+ public:
+  BucketTableContainer(size_t capacity, cudaStream_t stream)
+      : BucketHashMap<KeyType, ValType, std::numeric_limits<KeyType>::max()>(
+            stream, capacity, ValType()) {}
+};
 #elif defined(PADDLE_WITH_XPU_KP)
 template <typename KeyType, typename ValType>
 class XPUCacheArray {
@@ -163,6 +175,10 @@ class HashTable {
            StreamType stream,
            const GPUAccessor& fv_accessor);
 
+  // erase the keys in place, only the bucket table supports it
+  template <typename StreamType>
+  void erase(const KeyType* d_keys, size_t len, StreamType stream);
+
   template <typename StreamType>
   void get_ranks(const KeyType* d_keys,
                  ValType* d_vals,
@@ -217,8 +233,22 @@ class HashTable {
 
 #endif
 
-  int size() { return container_->size(); }
-  thrust::pair<KeyType, ValType>* data() { return container_->data(); }
+  int size() {
+#if defined(PADDLE_WITH_CUDA)
+    if (bucket_container_ != nullptr) {
+      return bucket_container_->size();
+    }
+#endif
+    return container_->size();
+  }
+  thrust::pair<KeyType, ValType>* data() {
+#if defined(PADDLE_WITH_CUDA)
+    if (bucket_container_ != nullptr) {
+      return bucket_container_->data();
+    }
+#endif
+    return container_->data();
+  }
   void set_feature_value_size(size_t pull_feature_value_size,
                               size_t push_grad_value_size) {
     pull_feature_value_size_ = pull_feature_value_size;
@@ -228,12 +258,32 @@ class HashTable {
   }
 
   int prefetch(const int dev_id, cudaStream_t stream = 0) {
+#if defined(PADDLE_WITH_CUDA)
+    if (bucket_container_ != nullptr) {
+      return bucket_container_->prefetch(dev_id, stream);
+    }
+#endif
     return container_->prefetch(dev_id, stream);
   }
 
-  void clear(cudaStream_t stream = 0) { container_->clear_async(stream); }
+  void clear(cudaStream_t stream = 0) {
+#if defined(PADDLE_WITH_CUDA)
+    if (bucket_container_ != nullptr) {
+      bucket_container_->clear_async(stream);
+      return;
+    }
+#endif
+    container_->clear_async(stream);
+  }
 
-  void show_collision(int id) { return container_->print_collision(id); }
+  void show_collision(int id) {
+#if defined(PADDLE_WITH_CUDA)
+    if (bucket_container_ != nullptr) {
+      return bucket_container_->print_collision(id);
+    }
+#endif
+    return container_->print_collision(id);
+  }
   // infer mode
   void set_mode(bool infer_mode) { infer_mode_ = infer_mode; }
 
@@ -241,7 +291,9 @@ class HashTable {
 
  private:
 #if defined(PADDLE_WITH_CUDA)
-  TableContainer<KeyType, ValType>* container_;
+  TableContainer<KeyType, ValType>* container_ = nullptr;
+  // replaces container_ with FLAGS_gpugraph_enable_bucket_hbm_table
+  BucketTableContainer<KeyType, ValType>* bucket_container_ = nullptr;
   cudaStream_t stream_ = 0;
 #elif defined(PADDLE_WITH_XPU_KP)
   XPUCacheArray<KeyType, ValType>* container_;
@@ -13,10 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #ifdef PADDLE_WITH_HETERPS
+#include <cooperative_groups.h>
+
 #include <thread>
 
 #include "paddle/fluid/framework/fleet/heter_ps/hashtable.h"
 #include "paddle/fluid/framework/fleet/heter_ps/optimizer.cuh.h"
+
+COMMON_DECLARE_bool(gpugraph_enable_bucket_hbm_table);
+
 namespace paddle {
 namespace framework {
 
@@ -236,6 +241,170 @@ __global__ void dy_mf_update_kernel(Table* table,
   }
 }
 
+// The kernels of the bucket table, each thread owns a key as above and the
+// threads of a tile probe the buckets of their keys together, so no thread
+// returns before the probing.
+template <typename Table>
+__device__ __forceinline__ auto bucket_tile() {
+  return cooperative_groups::tiled_partition<Table::kBucketSize>(
+      cooperative_groups::this_thread_block());
+}
+
+template <typename Table>
+__global__ void bucket_insert_kernel(
+    Table* table,
+    const typename Table::key_type* const keys,
+    const typename Table::mapped_type* const vals,
+    size_t len,
+    typename Table::mapped_type dft_val,
+    uint64_t* global_num) {
+  auto tile = bucket_tile<Table>();
+  thrust::pair<typename Table::key_type, typename Table::mapped_type> kv;
+
+  __shared__ uint64_t local_num;
+
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (threadIdx.x == 0) {
+    local_num = 0;
+  }
+  __syncthreads();
+
+  const bool active = i < len;
+  if (active) {
+    kv.first = keys[i];
+    kv.second = (vals == nullptr) ? dft_val : vals[i];
+  }
+  auto slot = table->insert(
+      tile, kv, active, (global_num == nullptr) ? nullptr : &local_num);
+  if (active) {
+    assert(slot != nullptr && "error: insert fails: table is full");
+  }
+  __syncthreads();
+
+  if (threadIdx.x == 0 && global_num != nullptr) {
+    atomicAdd(global_num, local_num);
+  }
+}
+
+template <typename Table>
+__global__ void bucket_insert_kernel(Table* table,
+                                     const typename Table::key_type* const keys,
+                                     size_t len,
+                                     char* pool,
+                                     size_t feature_value_size,
+                                     int start_index) {
+  auto tile = bucket_tile<Table>();
+  thrust::pair<typename Table::key_type, typename Table::mapped_type> kv;
+
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  if (active) {
+    kv.first = keys[i];
+    uint64_t offset = uint64_t(start_index + i) * feature_value_size;
+    kv.second = (typename Table::mapped_type)(pool + offset);
+  }
+  auto slot = table->insert(tile, kv, active);
+  if (active) {
+    PADDLE_ENFORCE(slot != nullptr, "error: insert fails: table is full");
+  }
+}
+
+template <typename Table>
+__global__ void bucket_erase_kernel(Table* table,
+                                    const typename Table::key_type* const keys,
+                                    size_t len) {
+  auto tile = bucket_tile<Table>();
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  const typename Table::key_type key = active ? keys[i] : 0;
+  table->erase(tile, key, active);
+}
+
+template <typename Table>
+__global__ void bucket_search_kernel(Table* table,
+                                     const typename Table::key_type* const keys,
+                                     typename Table::mapped_type* const vals,
+                                     size_t len) {
+  auto tile = bucket_tile<Table>();
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  const typename Table::key_type key = active ? keys[i] : 0;
+  auto slot = table->find(tile, key, active);
+  if (active && slot != nullptr) {
+    vals[i] = slot->second;
+  }
+}
+
+template <typename Table, typename GPUAccessor>
+__global__ void bucket_dy_mf_search_kernel(
+    Table* table,
+    const typename Table::key_type* const keys,
+    char* vals,
+    size_t len,
+    size_t pull_feature_value_size,
+    GPUAccessor gpu_accessor,
+    bool zero_fill) {
+  auto tile = bucket_tile<Table>();
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  const typename Table::key_type key = active ? keys[i] : 0;
+  auto slot = table->find(tile, key, active);
+  if (!active) {
+    return;
+  }
+  float* cur = reinterpret_cast<float*>(vals + i * pull_feature_value_size);
+  if (slot != nullptr) {
+    gpu_accessor.PullValueFill(cur, slot->second);
+  } else if (zero_fill) {
+    gpu_accessor.PullZeroValue(cur);
+  } else {
+    PADDLE_ENFORCE(false, "warning: pull miss key: %lu", keys[i]);
+  }
+}
+
+template <typename Table, typename GradType, typename Sgd>
+__global__ void bucket_update_kernel(Table* table,
+                                     const OptimizerConfig& optimizer_config,
+                                     const typename Table::key_type* const keys,
+                                     const GradType* const grads,
+                                     size_t len,
+                                     Sgd sgd) {
+  auto tile = bucket_tile<Table>();
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  const typename Table::key_type key = active ? keys[i] : 0;
+  auto slot = table->find(tile, key, active);
+  if (active && slot != nullptr) {
+    sgd.update_value(optimizer_config, slot->second, grads[i]);
+  }
+}
+
+template <typename Table, typename Sgd>
+__global__ void bucket_dy_mf_update_kernel(
+    Table* table,
+    const OptimizerConfig& optimizer_config,
+    const typename Table::key_type* const keys,
+    const char* const grads,
+    size_t len,
+    Sgd sgd,
+    size_t grad_value_size) {
+  auto tile = bucket_tile<Table>();
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  const typename Table::key_type key = active ? keys[i] : 0;
+  auto slot = table->find(tile, key, active);
+  if (!active) {
+    return;
+  }
+  if (slot != nullptr) {
+    const float* cur =
+        reinterpret_cast<const float*>(grads + i * grad_value_size);
+    sgd.dy_mf_update_value(optimizer_config, slot->second, cur);
+  } else {
+    PADDLE_ENFORCE(false, "warning: push miss key: %lu", keys[i]);
+  }
+}
+
 template <typename Table>
 __global__ void get_keys_kernel(Table* table,
                                 typename Table::key_type* d_out,
@@ -313,7 +482,12 @@ __global__ void get_key_values_kernel(Table* table,
 template <typename KeyType, typename ValType>
 HashTable<KeyType, ValType>::HashTable(size_t capacity, cudaStream_t stream) {
   stream_ = stream;
-  container_ = new TableContainer<KeyType, ValType>(capacity, stream);
+  if (FLAGS_gpugraph_enable_bucket_hbm_table) {
+    bucket_container_ =
+        new BucketTableContainer<KeyType, ValType>(capacity, stream);
+  } else {
+    container_ = new TableContainer<KeyType, ValType>(capacity, stream);
+  }
   CUDA_RT_CALL(cudaMalloc(reinterpret_cast<void**>(&device_optimizer_config_),
                           sizeof(OptimizerConfig)));
   CUDA_RT_CALL(
@@ -329,6 +503,7 @@ HashTable<KeyType, ValType>::HashTable(size_t capacity, cudaStream_t stream) {
 template <typename KeyType, typename ValType>
 HashTable<KeyType, ValType>::~HashTable() {
   delete container_;
+  delete bucket_container_;
   cudaFree(device_optimizer_config_);
 }
 
@@ -358,6 +533,10 @@ void HashTable<KeyType, ValType>::set_embedx_sgd(
 
 template <typename KeyType, typename ValType>
 void HashTable<KeyType, ValType>::show() {
+  if (bucket_container_ != nullptr) {
+    bucket_container_->print();
+    return;
+  }
   container_->print();
 }
 
@@ -371,6 +550,11 @@ void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_search_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_, d_keys, d_vals, len);
+    return;
+  }
   search_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, d_vals, len);
 }
@@ -386,6 +570,17 @@ void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_dy_mf_search_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_,
+        d_keys,
+        d_vals,
+        len,
+        pull_feature_value_size_,
+        fv_accessor,
+        infer_mode_);
+    return;
+  }
   // infer need zero fill
   if (infer_mode_) {
     dy_mf_search_kernel_fill<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
@@ -406,6 +601,11 @@ void HashTable<KeyType, ValType>::get_ranks(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_search_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_, d_keys, d_vals, len);
+    return;
+  }
   search_ranks_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, d_vals, len);
 }
@@ -421,6 +621,16 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_,
+        d_keys,
+        nullptr,
+        len,
+        static_cast<ValType>(dft_val),
+        global_num);
+    return;
+  }
   insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, len, dft_val, global_num);
 }
@@ -436,6 +646,11 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_, d_keys, d_vals, len, ValType(), global_num);
+    return;
+  }
   insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, d_vals, len, global_num);
 }
@@ -450,6 +665,11 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_, d_keys, d_vals, len, ValType(), nullptr);
+    return;
+  }
   insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, d_vals, len);
 }
@@ -459,10 +679,18 @@ template <typename StreamType>
 void HashTable<KeyType, ValType>::get_keys(KeyType* d_out,
                                            uint64_t* global_cursor,
                                            StreamType stream) {
-  size_t len = container_->size();
+  size_t len = size();
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
   KeyType unuse_key = std::numeric_limits<KeyType>::max();
   size_t shared_mem_size = sizeof(KeyType) * BLOCK_SIZE_;
+  if (bucket_container_ != nullptr) {
+    get_keys_kernel<<<grid_size, BLOCK_SIZE_, shared_mem_size, stream>>>(
+        bucket_container_,
+        d_out,
+        global_cursor,
+        unuse_key);
+    return;
+  }
   get_keys_kernel<<<grid_size, BLOCK_SIZE_, shared_mem_size, stream>>>(
       container_, d_out, global_cursor, unuse_key);
 }
@@ -474,10 +702,19 @@ void HashTable<KeyType, ValType>::get_key_values(KeyType* d_keys,
                                                  uint64_t* global_cursor,
                                                  StreamType stream) {
   const int BLOCK_SIZE = 128;
-  size_t len = container_->size();
+  size_t len = size();
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
   KeyType unuse_key = std::numeric_limits<KeyType>::max();
   size_t shared_mem_size = (sizeof(KeyType) + sizeof(ValType)) * BLOCK_SIZE_;
+  if (bucket_container_ != nullptr) {
+    get_key_values_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_,
+        d_keys,
+        d_vals,
+        global_cursor,
+        unuse_key);
+    return;
+  }
   get_key_values_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, d_vals, global_cursor, unuse_key);
 }
@@ -497,14 +734,37 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_, d_keys, len, pool, feature_value_size, start_index);
+    return;
+  }
   insert_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, d_keys, len, pool, feature_value_size, start_index);
 }
 
+template <typename KeyType, typename ValType>
+template <typename StreamType>
+void HashTable<KeyType, ValType>::erase(const KeyType* d_keys,
+                                        size_t len,
+                                        StreamType stream) {
+  PADDLE_ENFORCE_NOT_NULL(
+      bucket_container_,
+      common::errors::Unimplemented(
+          "Only the bucket hbm table supports erase, please set "
+          "FLAGS_gpugraph_enable_bucket_hbm_table."));
+  if (len == 0) {
+    return;
+  }
+  const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  bucket_erase_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+      bucket_container_, d_keys, len);
+}
+
 template <typename KeyType, typename ValType>
 template <typename StreamType>
 void HashTable<KeyType, ValType>::dump_to_cpu(int devid, StreamType stream) {
-  container_->prefetch(cudaCpuDeviceId, stream);
+  prefetch(cudaCpuDeviceId, stream);
 }
 
 template <typename KeyType, typename ValType>
@@ -518,6 +778,16 @@ void HashTable<KeyType, ValType>::update(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_update_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_,
+        *device_optimizer_config_,
+        d_keys,
+        d_grads,
+        len,
+        sgd);
+    return;
+  }
   update_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_, *device_optimizer_config_, d_keys, d_grads, len, sgd);
 }
@@ -533,6 +803,17 @@ void HashTable<KeyType, ValType>::update(const KeyType* d_keys,
     return;
   }
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
+  if (bucket_container_ != nullptr) {
+    bucket_dy_mf_update_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
+        bucket_container_,
+        *device_optimizer_config_,
+        d_keys,
+        d_grads,
+        len,
+        sgd,
+        push_grad_value_size_);
+    return;
+  }
   dy_mf_update_kernel<<<grid_size, BLOCK_SIZE_, 0, stream>>>(
       container_,
       *device_optimizer_config_,
@@ -694,6 +975,9 @@ template void HashTable<uint64_t, uint64_t>::insert<cudaStream_t>(
 template void HashTable<uint64_t, float*>::dump_to_cpu<cudaStream_t>(
     int devid, cudaStream_t stream);
 
+template void HashTable<uint64_t, float*>::erase<cudaStream_t>(
+    const uint64_t* d_keys, size_t len, cudaStream_t stream);
+
 template void HashTable<uint64_t, float*>::update<
     SparseAdagradOptimizer<CommonFeatureValueAccessor>,
     cudaStream_t>(const uint64_t* d_keys,
@@ -29,6 +29,7 @@ limitations under the License. */
 #include "paddle/phi/backends/xpu/enforce_xpu.h"
 #endif
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/barrier.h"
 #include "paddle/fluid/framework/fleet/heter_ps/hashtable.h"
 #include "paddle/fluid/framework/fleet/heter_ps/heter_comm_kernel.h"
@@ -39,6 +40,8 @@ limitations under the License. */
 
 #ifdef PADDLE_WITH_HETERPS
 
+COMMON_DECLARE_int32(gpugraph_inner_all2all_mode);
+
 namespace paddle {
 namespace framework {
 
@@ -174,6 +177,12 @@ class HeterComm {
     nccl_inter_comms_ = inter_comms;
     node_size_ = comm_size;
     rank_id_ = rank_id;
+    // nccl routes the inner gather by itself, which is worth it when the
+    // peer copies have to be relayed by the transfer devices
+    inner_nccl_all2all_ =
+        !nccl_inner_comms_.empty() &&
+        (FLAGS_gpugraph_inner_all2all_mode == 1 ||
+         (FLAGS_gpugraph_inner_all2all_mode == 2 && topo_aware_));
   }
 
   void set_multi_mf_dim(int multi_mf_dim, int max_mf_dim) {
@@ -289,6 +298,7 @@ class HeterComm {
     void init(int device_num, int dev_id, phi::Stream stream) {
       place_ = phi::GPUPlace(dev_id);
       h_recv_offsets.resize(device_num);
+      h_recv_sizes.resize(device_num);
       h_fea_sizes.resize(device_num);
       stream_ = stream;
     }
@@ -422,6 +432,7 @@ class HeterComm {
     KeyType* d_merged_push_keys = nullptr;
     char* d_merged_push_vals = nullptr;
     std::vector<size_t> h_recv_offsets;
+    std::vector<size_t> h_recv_sizes;
     std::vector<size_t> h_fea_sizes;
     // inner trans comm and stream buffer
     size_t h_trans_size;
@@ -581,6 +592,15 @@ class HeterComm {
                               const char* d_send_buff,
                               char* d_rev_buff,
                               const cudaStream_t& stream);
+  void send_inner_data_by_nccl(const int& gpu_id,
+                               const size_t& value_bytes,
+                               const size_t* h_send_part_sizes,
+                               const size_t* h_send_part_offsets,
+                               const size_t* h_recv_part_sizes,
+                               const size_t* h_recv_part_offsets,
+                               const char* d_send_buff,
+                               char* d_recv_buff,
+                               const cudaStream_t& stream);
   size_t gather_inter_keys_by_all2all(const int& gpu_id,
                                       const size_t& fea_size,
                                       const KeyType* d_in_keys,
@@ -742,12 +762,14 @@ class HeterComm {
                                         const cudaStream_t& stream);
   // debug time
   void print_debug_time(const int& gpu_id, bool force = false);
-  // alloc temp memory
+  // alloc temp memory, the cache is thread_local at the callers, so a thread
+  // working on several devices must not get the buffer of another device
   template <typename T, typename TPlace>
   T* AllocCache(std::shared_ptr<memory::Allocation>* alloc,
                 const TPlace& place,
                 const size_t& byte_len) {
-    if (alloc->get() == nullptr || byte_len > (*alloc)->size()) {
+    if (alloc->get() == nullptr || byte_len > (*alloc)->size() ||
+        (*alloc)->place() != place) {
       alloc->reset();
       if (resource_->multi_mf()) {
         *alloc = memory::Alloc(place, byte_len);
@@ -806,6 +828,8 @@ class HeterComm {
   GpuRDMAChecker* rdma_checker_ = nullptr;
   std::vector<ncclComm_t> nccl_inner_comms_;
   std::vector<ncclComm_t> nccl_inter_comms_;
+  // exchange the inner keys and values by nccl instead of peer copies
+  bool inner_nccl_all2all_ = false;
   int multi_mf_dim_{8};
   int max_mf_dim_ = 8;
   std::vector<std::shared_ptr<cub::CachingDeviceAllocator>> allocators_;
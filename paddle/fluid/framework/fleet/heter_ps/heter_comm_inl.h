@@ -1076,25 +1076,28 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::dynamic_merge_grad(
   platform::CUDADeviceGuard guard(dev_id);
   auto stream = resource_->local_stream(gpu_num, 0);
 
-  size_t temp_storage_bytes;
   size_t grad_dim = max_mf_dim_;
   auto accessor_wrapper_ptr =
       GlobalAccessorFactory::GetInstance().GetAccessorWrapper();
   size_t grad_value_size = accessor_wrapper_ptr->GetPushValueSize(max_mf_dim_);
 
-  auto d_merge_keys = MemoryAlloc(place, len * sizeof(KeyType));
-  KeyType *d_merge_keys_ptr = reinterpret_cast<KeyType *>(d_merge_keys->ptr());
-  auto d_fea_num_info = MemoryAlloc(place, sizeof(uint32_t) * (len * 3 + 1));
-  uint32_t *d_fea_num_info_ptr =
-      reinterpret_cast<uint32_t *>(d_fea_num_info->ptr());
+  // the buffers of the sort, encode and merge are reused by the pushes of the
+  // device thread, only the temp storage of the cub calls grows with len
+  thread_local std::shared_ptr<memory::Allocation> d_merge_keys = nullptr;
+  KeyType *d_merge_keys_ptr =
+      AllocCache<KeyType>(&d_merge_keys, place, len * sizeof(KeyType));
+  thread_local std::shared_ptr<memory::Allocation> d_fea_num_info = nullptr;
+  uint32_t *d_fea_num_info_ptr = AllocCache<uint32_t>(
+      &d_fea_num_info, place, sizeof(uint32_t) * (len * 3 + 1));
   uint32_t *d_index = static_cast<uint32_t *>(&d_fea_num_info_ptr[len]);
   uint32_t *d_idx = reinterpret_cast<uint32_t *>(&d_index[len]);
   int *d_merged_size = reinterpret_cast<int *>(&d_idx[len]);
   heter_comm_kernel_->fill_idx(d_idx, len, stream, dev_id);
 
+  size_t sort_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(
       cub::DeviceRadixSort::SortPairs(NULL,
-                                      temp_storage_bytes,
+                                      sort_storage_bytes,
                                       d_keys,
                                       d_merge_keys_ptr,
                                       d_idx,
@@ -1103,10 +1106,24 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::dynamic_merge_grad(
                                       0,
                                       8 * sizeof(KeyType),
                                       stream));
-  auto d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
+  size_t encode_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceRadixSort::SortPairs(d_temp_storage->ptr(),
-                                      temp_storage_bytes,
+      cub::DeviceRunLengthEncode::Encode(NULL,
+                                         encode_storage_bytes,
+                                         d_merge_keys_ptr,
+                                         d_keys,
+                                         d_fea_num_info_ptr,
+                                         d_merged_size,
+                                         len,
+                                         stream));
+  thread_local std::shared_ptr<memory::Allocation> d_temp_storage = nullptr;
+  void *d_temp_storage_ptr = AllocCache<void>(
+      &d_temp_storage,
+      place,
+      std::max(sort_storage_bytes, encode_storage_bytes));
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(d_temp_storage_ptr,
+                                      sort_storage_bytes,
                                       d_keys,
                                       d_merge_keys_ptr,
                                       d_idx,
@@ -1115,25 +1132,10 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::dynamic_merge_grad(
                                       0,
                                       8 * sizeof(KeyType),
                                       stream));
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
-
-  temp_storage_bytes = 0;
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceRunLengthEncode::Encode(NULL,
-                                         temp_storage_bytes,
-                                         d_merge_keys_ptr,
-                                         d_keys,
-                                         d_fea_num_info_ptr,
-                                         d_merged_size,
-                                         len,
-                                         stream));
-  if (d_temp_storage->size() < temp_storage_bytes) {
-    d_temp_storage = NULL;
-    d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
-  }
+  // the unique keys are written back to d_keys
   PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceRunLengthEncode::Encode(d_temp_storage->ptr(),
-                                         temp_storage_bytes,
+      cub::DeviceRunLengthEncode::Encode(d_temp_storage_ptr,
+                                         encode_storage_bytes,
                                          d_merge_keys_ptr,
                                          d_keys,
                                          d_fea_num_info_ptr,
@@ -1148,27 +1150,22 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::dynamic_merge_grad(
                   stream);
   PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
-  assert(d_merged_size > 0);
   uint32_t *d_offset = reinterpret_cast<uint32_t *>(&d_index[len]);
-  temp_storage_bytes = 0;
+  size_t temp_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(NULL,
                                                            temp_storage_bytes,
                                                            d_fea_num_info_ptr,
                                                            d_offset,
                                                            uniq_len,
                                                            stream));
-  if (d_temp_storage->size() < temp_storage_bytes) {
-    d_temp_storage = NULL;
-    d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
-  }
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceScan::ExclusiveSum(d_temp_storage->ptr(),
-                                    temp_storage_bytes,
-                                    d_fea_num_info_ptr,
-                                    d_offset,
-                                    uniq_len,
-                                    stream));
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+  d_temp_storage_ptr =
+      AllocCache<void>(&d_temp_storage, place, temp_storage_bytes);
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(d_temp_storage_ptr,
+                                                           temp_storage_bytes,
+                                                           d_fea_num_info_ptr,
+                                                           d_offset,
+                                                           uniq_len,
+                                                           stream));
 
   if (enable_segment_merge_grad) {
     segment_merge_grad(gpu_num,
@@ -1186,14 +1183,9 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::dynamic_merge_grad(
                                                stream));
     PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
   } else {
-    auto d_merge_grads = MemoryAlloc(place, len * grad_value_size);
-    float *d_merge_grads_ptr = reinterpret_cast<float *>(d_merge_grads->ptr());
-    // copy merge keys to d_keys
-    PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(d_keys,
-                                               d_merge_keys_ptr,
-                                               sizeof(KeyType) * segment_len,
-                                               cudaMemcpyDeviceToDevice,
-                                               stream));
+    thread_local std::shared_ptr<memory::Allocation> d_merge_grads = nullptr;
+    float *d_merge_grads_ptr =
+        AllocCache<float>(&d_merge_grads, place, uniq_len * grad_value_size);
     heter_comm_kernel_->merge_gradient(
         d_keys,
         d_offset,
@@ -1243,17 +1235,13 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::segment_merge_grad(
       GlobalAccessorFactory::GetInstance().GetAccessorWrapper();
   size_t grad_value_size = accessor_wrapper_ptr->GetPushValueSize(max_mf_dim_);
 
-  auto d_buffer1 = MemoryAlloc(place, sizeof(uint32_t) * len);
-  auto d_segments = reinterpret_cast<uint32_t *>(d_buffer1->ptr());
-  auto d_buffer2 = MemoryAlloc(place, sizeof(uint32_t) * len);
-  auto d_segments_offset = reinterpret_cast<uint32_t *>(d_buffer2->ptr());
-  auto d_buffer3 = MemoryAlloc(place, sizeof(uint32_t) * len);
-  auto d_segments_fea_num_info = reinterpret_cast<uint32_t *>(d_buffer3->ptr());
-  auto d_buffer4 = MemoryAlloc(place, sizeof(uint32_t) * len);
-  auto d_segments_fea_num_offset =
-      reinterpret_cast<uint32_t *>(d_buffer4->ptr());
-  auto d_buffer5 = MemoryAlloc(place, sizeof(uint32_t));
-  auto d_segments_num = reinterpret_cast<uint32_t *>(d_buffer5->ptr());
+  thread_local std::shared_ptr<memory::Allocation> d_buffer = nullptr;
+  auto d_segments =
+      AllocCache<uint32_t>(&d_buffer, place, sizeof(uint32_t) * (len * 4 + 1));
+  auto d_segments_offset = &d_segments[len];
+  auto d_segments_fea_num_info = &d_segments_offset[len];
+  auto d_segments_fea_num_offset = &d_segments_fea_num_info[len];
+  auto d_segments_num = &d_segments_fea_num_offset[len];
   CUDA_CHECK(cudaMemsetAsync(d_segments_num, 0, sizeof(uint32_t), stream));
 
   uint32_t segment_size = FLAGS_gpugraph_merge_grads_segment_size;
@@ -1263,13 +1251,14 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::segment_merge_grad(
                                      d_segments_num,
                                      segment_size,
                                      stream);
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
   size_t temp_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceReduce::Sum(
       NULL, temp_storage_bytes, d_segments, d_segments_num, uniq_len, stream));
-  auto d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
-  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceReduce::Sum(d_temp_storage->ptr(),
+  thread_local std::shared_ptr<memory::Allocation> d_temp_storage = nullptr;
+  void *d_temp_storage_ptr =
+      AllocCache<void>(&d_temp_storage, place, temp_storage_bytes);
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceReduce::Sum(d_temp_storage_ptr,
                                                     temp_storage_bytes,
                                                     d_segments,
                                                     d_segments_num,
@@ -1282,25 +1271,33 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::segment_merge_grad(
                              stream));
   PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
-  temp_storage_bytes = 0;
+  // both scans are sized before the temp storage grows, since it must not be
+  // freed while the first scan is still queued
+  size_t offset_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(NULL,
-                                                           temp_storage_bytes,
+                                                           offset_storage_bytes,
                                                            d_segments,
                                                            d_segments_offset,
                                                            uniq_len,
                                                            stream));
-  if (d_temp_storage->size() < temp_storage_bytes) {
-    d_temp_storage = NULL;
-    d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
-  }
+  size_t fea_num_storage_bytes = 0;
   PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceScan::ExclusiveSum(d_temp_storage->ptr(),
-                                    temp_storage_bytes,
-                                    d_segments,
-                                    d_segments_offset,
-                                    uniq_len,
+      cub::DeviceScan::ExclusiveSum(NULL,
+                                    fea_num_storage_bytes,
+                                    d_segments_fea_num_info,
+                                    d_segments_fea_num_offset,
+                                    segments_num,
                                     stream));
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+  d_temp_storage_ptr = AllocCache<void>(
+      &d_temp_storage,
+      place,
+      std::max(offset_storage_bytes, fea_num_storage_bytes));
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(d_temp_storage_ptr,
+                                                           offset_storage_bytes,
+                                                           d_segments,
+                                                           d_segments_offset,
+                                                           uniq_len,
+                                                           stream));
 
   heter_comm_kernel_->expand_segments(d_fea_num_info,
                                       d_segments_offset,
@@ -1308,40 +1305,27 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::segment_merge_grad(
                                       d_segments_fea_num_info,
                                       segment_size,
                                       stream);
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
   PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceScan::ExclusiveSum(NULL,
-                                    temp_storage_bytes,
-                                    d_segments_fea_num_info,
-                                    d_segments_fea_num_offset,
-                                    segments_num,
-                                    stream));
-  if (d_temp_storage->size() < temp_storage_bytes) {
-    d_temp_storage = NULL;
-    d_temp_storage = MemoryAlloc(place, temp_storage_bytes);
-  }
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      cub::DeviceScan::ExclusiveSum(d_temp_storage->ptr(),
-                                    temp_storage_bytes,
+      cub::DeviceScan::ExclusiveSum(d_temp_storage_ptr,
+                                    fea_num_storage_bytes,
                                     d_segments_fea_num_info,
                                     d_segments_fea_num_offset,
                                     segments_num,
                                     stream));
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
-  auto d_segments_keys = MemoryAlloc(place, sizeof(KeyType) * segments_num);
-  auto d_segments_keys_ptr =
-      reinterpret_cast<KeyType *>(d_segments_keys->ptr());
+  thread_local std::shared_ptr<memory::Allocation> d_segments_keys = nullptr;
+  auto d_segments_keys_ptr = AllocCache<KeyType>(
+      &d_segments_keys, place, sizeof(KeyType) * segments_num);
   heter_comm_kernel_->shrink_keys(d_keys,
                                   d_segments_fea_num_offset,
                                   d_segments_keys_ptr,
                                   segments_num,
                                   stream);
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
-  auto d_segment_grads = MemoryAlloc(place, segments_num * grad_value_size);
-  auto d_segment_grads_ptr = reinterpret_cast<float *>(d_segment_grads->ptr());
+  thread_local std::shared_ptr<memory::Allocation> d_segment_grads = nullptr;
+  auto d_segment_grads_ptr = AllocCache<float>(
+      &d_segment_grads, place, segments_num * grad_value_size);
   heter_comm_kernel_->merge_gradient(
       d_segments_keys_ptr,
       d_segments_fea_num_offset,
@@ -1355,7 +1339,6 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::segment_merge_grad(
       merger_,
       stream,
       gpu_accessor_);
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 
   PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(d_keys,
                                              d_segments_keys_ptr,
@@ -2686,6 +2669,7 @@ HeterComm<KeyType, ValType, GradType, GPUAccessor>::gather_inner_keys_by_copy(
   for (int i = 0; i < device_num_; ++i) {
     auto &cache = storage_[i];
     my_cache.h_recv_offsets[i] = shard_recv_offset;
+    my_cache.h_recv_sizes[i] = cache.h_fea_sizes[gpu_id];
     shard_recv_offset += cache.h_fea_sizes[gpu_id];
     res.h_offsets[i] = shard_send_offset;
     shard_send_offset += res.h_part_sizes[i];
@@ -2704,7 +2688,7 @@ HeterComm<KeyType, ValType, GradType, GPUAccessor>::gather_inner_keys_by_copy(
   size_t trans_need_size =
       std::max(shard_recv_offset, static_cast<size_t>(fea_size));
   int trans_id = -1;
-  if (topo_aware_ && device_num_ > 4) {
+  if (topo_aware_ && device_num_ > 4 && !inner_nccl_all2all_) {
     trans_id = get_transfer_devid(gpu_id);
     storage_[trans_id].h_trans_size = max_part_size;
     // barrier wait all set trans length [0-4, 1-5, 3-7, 2-6]
@@ -2734,8 +2718,23 @@ HeterComm<KeyType, ValType, GradType, GPUAccessor>::gather_inner_keys_by_copy(
   // barrier wait set buffer ptr
   barrier_.wait();
   my_cache.inner_barrier_.Pause();
-  gather_inner_keys_p2p(
-      fea_size, d_keys, res, gpu_id, device_num_, trans_id, stream);
+  if (inner_nccl_all2all_) {
+    heter_comm_kernel_->gather_keys(
+        res.d_keys_parted, d_keys, res.d_idx, fea_size, stream, gpu_id);
+    send_inner_data_by_nccl(
+        gpu_id,
+        sizeof(KeyType),
+        res.h_part_sizes,
+        res.h_offsets.data(),
+        my_cache.h_recv_sizes.data(),
+        my_cache.h_recv_offsets.data(),
+        reinterpret_cast<const char *>(res.d_keys_parted),
+        reinterpret_cast<char *>(my_cache.d_merged_keys),
+        stream);
+  } else {
+    gather_inner_keys_p2p(
+        fea_size, d_keys, res, gpu_id, device_num_, trans_id, stream);
+  }
   // barrier wait all gpu aync memcpy data
   my_cache.inner_barrier_.Resume();
   barrier_.wait();
@@ -2924,6 +2923,67 @@ size_t HeterComm<KeyType, ValType, GradType, GPUAccessor>::send_data_by_all2all(
 
   return total_fea_num;
 }
+template <typename KeyType,
+          typename ValType,
+          typename GradType,
+          typename GPUAccessor>
+void HeterComm<KeyType, ValType, GradType, GPUAccessor>::
+    send_inner_data_by_nccl(const int &gpu_id,
+                            const size_t &value_bytes,
+                            const size_t *h_send_part_sizes,
+                            const size_t *h_send_part_offsets,
+                            const size_t *h_recv_part_sizes,
+                            const size_t *h_recv_part_offsets,
+                            const char *d_send_buff,
+                            char *d_recv_buff,
+                            const cudaStream_t &stream) {
+  AnyDeviceGuard guard(resource_->dev_id(gpu_id));
+  auto &comm = nccl_inner_comms_[gpu_id];
+  const size_t &local_size = h_send_part_sizes[gpu_id];
+  PADDLE_ENFORCE_EQ(local_size,
+                    h_recv_part_sizes[gpu_id],
+                    common::errors::InvalidArgument(
+                        "Param local_size should be equal to %d, but got %d.",
+                        h_recv_part_sizes[gpu_id],
+                        local_size));
+  if (local_size > 0) {
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(
+        &d_recv_buff[h_recv_part_offsets[gpu_id] * value_bytes],
+        &d_send_buff[h_send_part_offsets[gpu_id] * value_bytes],
+        local_size * value_bytes,
+        cudaMemcpyDeviceToDevice,
+        stream));
+  }
+  // the sizes are symmetric, the send of i to j is the recv of j from i
+  PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::ncclGroupStart());
+  for (int i = 0; i < device_num_; ++i) {
+    if (i == gpu_id) {
+      continue;
+    }
+    const size_t &send_size = h_send_part_sizes[i];
+    if (send_size > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::ncclSend(
+          &d_send_buff[h_send_part_offsets[i] * value_bytes],
+          send_size * value_bytes,
+          ncclInt8,
+          i,
+          comm,
+          stream));
+    }
+    const size_t &recv_size = h_recv_part_sizes[i];
+    if (recv_size > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::ncclRecv(
+          &d_recv_buff[h_recv_part_offsets[i] * value_bytes],
+          recv_size * value_bytes,
+          ncclInt8,
+          i,
+          comm,
+          stream));
+    }
+  }
+  PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::ncclGroupEnd());
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+}
 template <typename KeyType,
           typename ValType,
           typename GradType,
@@ -3279,7 +3339,7 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::
 
   auto &res = my_cache.inner_res;
   int trans_id = -1;
-  if (topo_aware_ && device_num_ > 4) {
+  if (topo_aware_ && device_num_ > 4 && !inner_nccl_all2all_) {
     trans_id = get_transfer_devid(gpu_id);
   }
   my_cache.inner_barrier_.Resume();
@@ -3304,15 +3364,37 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::
   // barrier wait set buffer ptr
   barrier_.wait();
   my_cache.inner_barrier_.Pause();
-  // recv all pull sparse vals
-  scatter_inner_vals_p2p(fea_size,
-                         d_out_vals,  // out
-                         res,
-                         gpu_id,
-                         device_num_,
-                         trans_id,
-                         value_bytes,
-                         stream);
+  if (!inner_nccl_all2all_) {
+    // recv all pull sparse vals
+    scatter_inner_vals_p2p(fea_size,
+                           d_out_vals,  // out
+                           res,
+                           gpu_id,
+                           device_num_,
+                           trans_id,
+                           value_bytes,
+                           stream);
+    return;
+  }
+  // send the vals back the reverse way of the keys
+  send_inner_data_by_nccl(gpu_id,
+                          value_bytes,
+                          my_cache.h_recv_sizes.data(),
+                          my_cache.h_recv_offsets.data(),
+                          res.h_part_sizes,
+                          res.h_offsets.data(),
+                          my_cache.d_merged_push_vals,
+                          res.d_vals_parted,
+                          stream);
+  // restore vals
+  heter_comm_kernel_->scatter_vals(
+      reinterpret_cast<const float *>(res.d_vals_parted),  // in
+      reinterpret_cast<float *>(d_out_vals),               // out
+      res.d_idx,
+      fea_size,
+      value_bytes,
+      stream);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 }
 template <typename KeyType,
           typename ValType,
@@ -3689,6 +3771,7 @@ size_t HeterComm<KeyType, ValType, GradType, GPUAccessor>::
   for (int i = 0; i < device_num_; ++i) {
     auto &cache = storage_[i];
     my_cache.h_recv_offsets[i] = shard_recv_offset;
+    my_cache.h_recv_sizes[i] = cache.h_fea_sizes[gpu_id];
     shard_recv_offset += cache.h_fea_sizes[gpu_id];
     res.h_offsets[i] = shard_send_offset;
     shard_send_offset += res.h_part_sizes[i];
@@ -3699,7 +3782,7 @@ size_t HeterComm<KeyType, ValType, GradType, GPUAccessor>::
 
   size_t trans_need_size = std::max(shard_recv_offset, push_size);
   int trans_id = -1;
-  if (topo_aware_ && device_num_ > 4) {
+  if (topo_aware_ && device_num_ > 4 && !inner_nccl_all2all_) {
     trans_id = get_transfer_devid(gpu_id);
     storage_[trans_id].h_trans_size = max_part_size;
     // barrier wait all set trans length [0-4, 1-5, 3-7, 2-6]
@@ -3732,15 +3815,46 @@ size_t HeterComm<KeyType, ValType, GradType, GPUAccessor>::
   // barrier wait set buffer ptr
   barrier_.wait();
   my_cache.inner_barrier_.Pause();
-  gather_inner_data_p2p(push_size,
-                        d_keys,
-                        d_push_vals,
-                        res,
-                        gpu_id,
-                        device_num_,
-                        trans_id,
-                        value_bytes,
-                        stream);
+  if (inner_nccl_all2all_) {
+    heter_comm_kernel_->gather_keys(
+        res.d_keys_parted, d_keys, res.d_idx, push_size, stream, gpu_id);
+    heter_comm_kernel_->gather_vals(
+        reinterpret_cast<float *>(res.d_vals_parted),
+        reinterpret_cast<const float *>(d_push_vals),
+        res.d_idx,
+        push_size,
+        value_bytes,
+        stream);
+    send_inner_data_by_nccl(
+        gpu_id,
+        sizeof(KeyType),
+        res.h_part_sizes,
+        res.h_offsets.data(),
+        my_cache.h_recv_sizes.data(),
+        my_cache.h_recv_offsets.data(),
+        reinterpret_cast<const char *>(res.d_keys_parted),
+        reinterpret_cast<char *>(my_cache.d_merged_keys),
+        stream);
+    send_inner_data_by_nccl(gpu_id,
+                            value_bytes,
+                            res.h_part_sizes,
+                            res.h_offsets.data(),
+                            my_cache.h_recv_sizes.data(),
+                            my_cache.h_recv_offsets.data(),
+                            res.d_vals_parted,
+                            my_cache.d_merged_vals,
+                            stream);
+  } else {
+    gather_inner_data_p2p(push_size,
+                          d_keys,
+                          d_push_vals,
+                          res,
+                          gpu_id,
+                          device_num_,
+                          trans_id,
+                          value_bytes,
+                          stream);
+  }
   // barrier wait all gpu aync memcpy data
   my_cache.inner_barrier_.Resume();
   barrier_.wait();
@@ -0,0 +1,185 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cooperative_groups.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "paddle/fluid/framework/fleet/heter_ps/bucket_hash_map.cuh.h"
+
+namespace paddle {
+namespace framework {
+
+namespace cg = cooperative_groups;
+
+using Table =
+    BucketHashMap<uint64_t, uint64_t, std::numeric_limits<uint64_t>::max()>;
+
+__global__ void insert_kernel(Table* table,
+                              const uint64_t* keys,
+                              size_t len,
+                              uint64_t* count) {
+  auto tile = cg::tiled_partition<Table::kBucketSize>(cg::this_thread_block());
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  Table::value_type kv;
+  if (active) {
+    kv.first = keys[i];
+    kv.second = i;
+  }
+  table->insert(tile, kv, active, count);
+}
+
+__global__ void find_kernel(Table* table,
+                            const uint64_t* keys,
+                            size_t len,
+                            uint64_t* vals) {
+  auto tile = cg::tiled_partition<Table::kBucketSize>(cg::this_thread_block());
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  auto slot = table->find(tile, active ? keys[i] : 0, active);
+  if (active) {
+    vals[i] = slot == nullptr ? Table::unused_key : slot->second;
+  }
+}
+
+__global__ void erase_kernel(Table* table,
+                             const uint64_t* keys,
+                             size_t len,
+                             bool* erased) {
+  auto tile = cg::tiled_partition<Table::kBucketSize>(cg::this_thread_block());
+  const size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+  const bool active = i < len;
+  bool result = table->erase(tile, active ? keys[i] : 0, active);
+  if (active) {
+    erased[i] = result;
+  }
+}
+
+class BucketHashMapTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kCapacity = 1024;
+  static constexpr int kBlock = 128;
+
+  void SetUp() override {
+    CUDA_RT_CALL(cudaStreamCreate(&stream_));
+    table_ = new Table(stream_, kCapacity, 0);
+    CUDA_RT_CALL(cudaMallocManaged(&keys_, kCapacity * sizeof(uint64_t)));
+    CUDA_RT_CALL(cudaMallocManaged(&vals_, kCapacity * sizeof(uint64_t)));
+    CUDA_RT_CALL(cudaMallocManaged(&erased_, kCapacity * sizeof(bool)));
+    CUDA_RT_CALL(cudaMallocManaged(&count_, sizeof(uint64_t)));
+    *count_ = 0;
+  }
+
+  void TearDown() override {
+    delete table_;
+    CUDA_RT_CALL(cudaFree(keys_));
+    CUDA_RT_CALL(cudaFree(vals_));
+    CUDA_RT_CALL(cudaFree(erased_));
+    CUDA_RT_CALL(cudaFree(count_));
+    CUDA_RT_CALL(cudaStreamDestroy(stream_));
+  }
+
+  int Grid(size_t len) const { return (len + kBlock - 1) / kBlock; }
+
+  void Insert(size_t len) {
+    insert_kernel<<<Grid(len), kBlock, 0, stream_>>>(
+        table_, keys_, len, count_);
+    CUDA_RT_CALL(cudaStreamSynchronize(stream_));
+  }
+
+  void Find(size_t len) {
+    find_kernel<<<Grid(len), kBlock, 0, stream_>>>(table_, keys_, len, vals_);
+    CUDA_RT_CALL(cudaStreamSynchronize(stream_));
+  }
+
+  void Erase(size_t len) {
+    erase_kernel<<<Grid(len), kBlock, 0, stream_>>>(
+        table_, keys_, len, erased_);
+    CUDA_RT_CALL(cudaStreamSynchronize(stream_));
+  }
+
+  cudaStream_t stream_;
+  Table* table_ = nullptr;
+  uint64_t* keys_ = nullptr;
+  uint64_t* vals_ = nullptr;
+  bool* erased_ = nullptr;
+  uint64_t* count_ = nullptr;
+};
+
+TEST_F(BucketHashMapTest, insert_find_erase) {
+  // fill the map up to the load factor of 0.9, so that many keys overflow
+  // their buckets, and include the largest legal key
+  const size_t len = kCapacity * 9 / 10;
+  for (size_t i = 0; i < len; ++i) {
+    keys_[i] = i * 7919 + 1;
+  }
+  keys_[len - 1] = Table::unused_key - 1;
+  Insert(len);
+  EXPECT_EQ(*count_, len);
+  Find(len);
+  for (size_t i = 0; i < len; ++i) {
+    ASSERT_EQ(vals_[i], i);
+  }
+
+  // erase the even keys, the odd keys are still found behind the emptied
+  // slots of their probing sequences
+  std::vector<uint64_t> odd;
+  for (size_t i = 1; i < len; i += 2) {
+    odd.push_back(keys_[i]);
+  }
+  size_t even = 0;
+  for (size_t i = 0; i < len; i += 2) {
+    keys_[even++] = keys_[i];
+  }
+  Erase(even);
+  for (size_t i = 0; i < even; ++i) {
+    ASSERT_TRUE(erased_[i]);
+  }
+  Erase(even);
+  for (size_t i = 0; i < even; ++i) {
+    ASSERT_FALSE(erased_[i]);
+  }
+  Find(even);
+  for (size_t i = 0; i < even; ++i) {
+    ASSERT_EQ(vals_[i], Table::unused_key);
+  }
+  for (size_t i = 0; i < odd.size(); ++i) {
+    keys_[i] = odd[i];
+  }
+  Find(odd.size());
+  for (size_t i = 0; i < odd.size(); ++i) {
+    ASSERT_EQ(vals_[i], 2 * i + 1);
+  }
+
+  // the inserts reuse the emptied slots, and an odd key inserted again is
+  // replaced in place instead of counted twice
+  for (size_t i = 0; i < even; ++i) {
+    keys_[i] = i * 6151 + 3;
+  }
+  keys_[even] = odd[0];
+  *count_ = 0;
+  Insert(even + 1);
+  EXPECT_EQ(*count_, even);
+  Find(even + 1);
+  for (size_t i = 0; i <= even; ++i) {
+    ASSERT_EQ(vals_[i], i);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
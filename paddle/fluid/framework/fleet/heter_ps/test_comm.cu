@@ -14,12 +14,19 @@ limitations under the License. */
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/fleet/heter_ps/feature_value.h"
 #include "paddle/fluid/framework/fleet/heter_ps/heter_comm.h"
 #include "paddle/fluid/framework/fleet/heter_ps/heter_resource.h"
 #include "paddle/fluid/framework/fleet/heter_ps/optimizer.cuh.h"
+#include "paddle/phi/backends/dynload/nccl.h"
 #include "paddle/phi/core/platform/cuda_device_guard.h"
 
 using paddle::framework;
@@ -112,3 +119,287 @@ TEST(TEST_FLEET, heter_comm) {
   cudaFree(push_keys);
   cudaFree(push_vals);
 }
+
+// Exchanges the keys and values of the inner gather among the gpus by the
+// nccl send/recv group, and checks them against the exchange by the peer
+// copies.
+TEST(TEST_FLEET, inner_all2all_exchange) {
+  int gpu_count = 0;
+  cudaGetDeviceCount(&gpu_count);
+  if (gpu_count < 2) {
+    return;
+  }
+  // the keys sent to every other gpu and the dim of their values
+  const size_t part_keys = 4096;
+  const size_t dim = 8;
+
+  std::vector<int> dev_ids;
+  for (int i = 0; i < gpu_count; ++i) {
+    dev_ids.push_back(i);
+  }
+  std::shared_ptr<HeterPsResource> resource =
+      std::make_shared<HeterPsResource>(dev_ids);
+  resource->enable_p2p();
+
+  std::vector<ncclComm_t> comms(gpu_count);
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      phi::dynload::ncclCommInitAll(comms.data(), gpu_count, dev_ids.data()));
+  std::vector<cudaStream_t> streams(gpu_count);
+
+  // send_bufs[i] holds the parts of gpu i to every gpu j at j * part_bytes,
+  // and a receive buffer of gpu i holds the part from gpu j at the same
+  // offset.
+  struct Buffers {
+    size_t part_bytes;
+    std::vector<char*> send_bufs;
+    std::vector<char*> peer_recv_bufs;
+    std::vector<char*> nccl_recv_bufs;
+  };
+  Buffers keys{part_keys * sizeof(FeatureKey)};
+  Buffers vals{part_keys * dim * sizeof(float)};
+  for (int i = 0; i < gpu_count; ++i) {
+    paddle::platform::CUDADeviceGuard guard(i);
+    cudaStreamCreate(&streams[i]);
+    std::vector<FeatureKey> h_keys(part_keys * gpu_count);
+    std::vector<float> h_vals(part_keys * dim * gpu_count);
+    for (size_t k = 0; k < h_keys.size(); ++k) {
+      h_keys[k] = static_cast<FeatureKey>(i) << 32 | k;
+      for (size_t d = 0; d < dim; ++d) {
+        h_vals[k * dim + d] = static_cast<float>(i * 1000000 + k * dim + d);
+      }
+    }
+    for (auto* bufs : {&keys, &vals}) {
+      size_t total_bytes = bufs->part_bytes * gpu_count;
+      for (auto* vec :
+           {&bufs->send_bufs, &bufs->peer_recv_bufs, &bufs->nccl_recv_bufs}) {
+        vec->resize(gpu_count);
+        cudaMalloc(&(*vec)[i], total_bytes);
+        cudaMemset((*vec)[i], 0, total_bytes);
+      }
+    }
+    cudaMemcpy(keys.send_bufs[i],
+               h_keys.data(),
+               h_keys.size() * sizeof(FeatureKey),
+               cudaMemcpyHostToDevice);
+    cudaMemcpy(vals.send_bufs[i],
+               h_vals.data(),
+               h_vals.size() * sizeof(float),
+               cudaMemcpyHostToDevice);
+  }
+
+  auto peer_copy = [&](const Buffers& bufs, int i) {
+    for (int j = 0; j < gpu_count; ++j) {
+      if (j == i) {
+        continue;
+      }
+      cudaMemcpyPeerAsync(&bufs.peer_recv_bufs[j][i * bufs.part_bytes],
+                          j,
+                          &bufs.send_bufs[i][j * bufs.part_bytes],
+                          i,
+                          bufs.part_bytes,
+                          streams[i]);
+    }
+  };
+  auto nccl_all2all = [&](const Buffers& bufs, int i) {
+    phi::dynload::ncclGroupStart();
+    for (int j = 0; j < gpu_count; ++j) {
+      if (j == i) {
+        continue;
+      }
+      phi::dynload::ncclSend(&bufs.send_bufs[i][j * bufs.part_bytes],
+                             bufs.part_bytes,
+                             ncclInt8,
+                             j,
+                             comms[i],
+                             streams[i]);
+      phi::dynload::ncclRecv(&bufs.nccl_recv_bufs[i][j * bufs.part_bytes],
+                             bufs.part_bytes,
+                             ncclInt8,
+                             j,
+                             comms[i],
+                             streams[i]);
+    }
+    phi::dynload::ncclGroupEnd();
+  };
+  // the gpus of the nccl group run in lock step, one thread each
+  auto run = [&](const std::function<void(const Buffers&, int)>& exchange) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < gpu_count; ++i) {
+      threads.emplace_back([&, i]() {
+        paddle::platform::CUDADeviceGuard guard(i);
+        exchange(keys, i);
+        exchange(vals, i);
+        cudaStreamSynchronize(streams[i]);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  };
+  run(peer_copy);
+  run(nccl_all2all);
+
+  auto to_host = [](const char* buf, size_t bytes) {
+    std::vector<char> h_buf(bytes);
+    cudaMemcpy(h_buf.data(), buf, bytes, cudaMemcpyDeviceToHost);
+    return h_buf;
+  };
+  for (int i = 0; i < gpu_count; ++i) {
+    paddle::platform::CUDADeviceGuard guard(i);
+    for (int j = 0; j < gpu_count; ++j) {
+      if (j == i) {
+        continue;
+      }
+      auto peer_keys = to_host(keys.peer_recv_bufs[i] + j * keys.part_bytes,
+                               keys.part_bytes);
+      auto nccl_keys = to_host(keys.nccl_recv_bufs[i] + j * keys.part_bytes,
+                               keys.part_bytes);
+      auto peer_vals = to_host(vals.peer_recv_bufs[i] + j * vals.part_bytes,
+                               vals.part_bytes);
+      auto nccl_vals = to_host(vals.nccl_recv_bufs[i] + j * vals.part_bytes,
+                               vals.part_bytes);
+      EXPECT_EQ(nccl_keys, peer_keys);
+      EXPECT_EQ(nccl_vals, peer_vals);
+      // the part of gpu j to gpu i
+      const FeatureKey* recv_keys =
+          reinterpret_cast<const FeatureKey*>(nccl_keys.data());
+      const float* recv_vals = reinterpret_cast<const float*>(nccl_vals.data());
+      for (size_t k = 0; k < part_keys; ++k) {
+        size_t src = i * part_keys + k;
+        EXPECT_EQ(recv_keys[k], static_cast<FeatureKey>(j) << 32 | src);
+        EXPECT_EQ(recv_vals[k * dim],
+                  static_cast<float>(j * 1000000 + src * dim));
+      }
+    }
+  }
+
+  for (int i = 0; i < gpu_count; ++i) {
+    paddle::platform::CUDADeviceGuard guard(i);
+    for (auto* bufs : {&keys, &vals}) {
+      cudaFree(bufs->send_bufs[i]);
+      cudaFree(bufs->peer_recv_bufs[i]);
+      cudaFree(bufs->nccl_recv_bufs[i]);
+    }
+    cudaStreamDestroy(streams[i]);
+    phi::dynload::ncclCommDestroy(comms[i]);
+  }
+}
+
+// Merges the push grads of growing and then shrinking key counts on two gpus
+// from one thread, so the cached merge buffers of the thread are reused
+// across sizes and devices, and checks the merged grads against the host.
+TEST(TEST_FLEET, dynamic_merge_grad_reuses_buffers) {
+  int gpu_count = 0;
+  cudaGetDeviceCount(&gpu_count);
+  if (gpu_count < 2) {
+    return;
+  }
+  int max_mf_dim = 8;
+  std::vector<int> dev_ids = {0, 1};
+  std::shared_ptr<HeterPsResource> resource =
+      std::make_shared<HeterPsResource>(dev_ids);
+  resource->set_multi_mf(1, max_mf_dim);
+
+  std::unordered_map<std::string, float> config = {
+      {"embedx_dim", static_cast<float>(max_mf_dim)}};
+  GlobalAccessorFactory::GetInstance().Init("CtrDymfAccessor");
+  GlobalAccessorFactory::GetInstance().GetAccessorWrapper()->Configure(config);
+  CommonFeatureValueAccessor accessor;
+  accessor.Configure(config);
+  auto heter_comm = std::make_shared<
+      HeterComm<FeatureKey, float*, float*, CommonFeatureValueAccessor>>(
+      1024, resource, accessor);
+
+  auto& push_value = accessor.common_push_value;
+  size_t grad_value_size = push_value.Size(max_mf_dim);
+  size_t grad_dim = grad_value_size / sizeof(float);
+  for (bool enable_segment_merge_grad : {false, true}) {
+    for (size_t len : {1000, 20000, 50000, 5000, 300}) {
+      // every key is pushed about three times, far below the segment size
+      size_t key_num = std::max<size_t>(len / 3, 1);
+      std::vector<FeatureKey> h_keys(len);
+      std::vector<float> h_grads(len * grad_dim, 0);
+      std::map<FeatureKey, std::vector<float>> expected;
+      for (size_t k = 0; k < len; ++k) {
+        // key 0 is not merged, so the keys start at 1
+        FeatureKey key = (k * 7919) % key_num + 1;
+        float* grad = &h_grads[k * grad_dim];
+        grad[push_value.SlotIndex()] = static_cast<float>(key % 7);
+        grad[push_value.ShowIndex()] = 1;
+        grad[push_value.ClickIndex()] = static_cast<float>(k % 2);
+        grad[push_value.MfDimIndex()] = static_cast<float>(max_mf_dim);
+        grad[push_value.EmbedGIndex()] = 0.5f * k;
+        for (int d = 0; d < max_mf_dim; ++d) {
+          grad[push_value.EmbedxGIndex() + d] = static_cast<float>(k + d);
+        }
+        h_keys[k] = key;
+        auto it = expected.find(key);
+        if (it == expected.end()) {
+          expected.emplace(key, std::vector<float>(grad, grad + grad_dim));
+          continue;
+        }
+        float* merged = it->second.data();
+        merged[push_value.ShowIndex()] += grad[push_value.ShowIndex()];
+        merged[push_value.ClickIndex()] += grad[push_value.ClickIndex()];
+        merged[push_value.EmbedGIndex()] += grad[push_value.EmbedGIndex()];
+        for (int d = 0; d < max_mf_dim; ++d) {
+          merged[push_value.EmbedxGIndex() + d] +=
+              grad[push_value.EmbedxGIndex() + d];
+        }
+      }
+
+      for (int gpu_num = 0; gpu_num < 2; ++gpu_num) {
+        paddle::platform::CUDADeviceGuard guard(gpu_num);
+        FeatureKey* d_keys;
+        float* d_grads;
+        cudaMalloc(&d_keys, len * sizeof(FeatureKey));
+        cudaMalloc(&d_grads, len * grad_value_size);
+        cudaMemcpy(d_keys,
+                   h_keys.data(),
+                   len * sizeof(FeatureKey),
+                   cudaMemcpyHostToDevice);
+        cudaMemcpy(d_grads,
+                   h_grads.data(),
+                   len * grad_value_size,
+                   cudaMemcpyHostToDevice);
+
+        int uniq_len = 0;
+        size_t segment_len = 0;
+        heter_comm->dynamic_merge_grad(gpu_num,
+                                       d_keys,
+                                       d_grads,
+                                       len,
+                                       uniq_len,
+                                       segment_len,
+                                       enable_segment_merge_grad);
+        size_t merged_len = enable_segment_merge_grad
+                                ? segment_len
+                                : static_cast<size_t>(uniq_len);
+        ASSERT_EQ(static_cast<size_t>(uniq_len), expected.size());
+        ASSERT_EQ(merged_len, expected.size());
+
+        std::vector<FeatureKey> merged_keys(merged_len);
+        std::vector<float> merged_grads(merged_len * grad_dim);
+        cudaMemcpy(merged_keys.data(),
+                   d_keys,
+                   merged_len * sizeof(FeatureKey),
+                   cudaMemcpyDeviceToHost);
+        cudaMemcpy(merged_grads.data(),
+                   d_grads,
+                   merged_len * grad_value_size,
+                   cudaMemcpyDeviceToHost);
+        size_t i = 0;
+        for (auto& [key, grad] : expected) {
+          ASSERT_EQ(merged_keys[i], key);
+          for (size_t d = 0; d < grad_dim; ++d) {
+            EXPECT_EQ(merged_grads[i * grad_dim + d], grad[d])
+                << "key " << key << " dim " << d << " on gpu " << gpu_num;
+          }
+          ++i;
+        }
+        cudaFree(d_keys);
+        cudaFree(d_grads);
+      }
+    }
+  }
+}
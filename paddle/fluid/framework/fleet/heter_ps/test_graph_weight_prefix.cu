@@ -0,0 +1,130 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/fluid/framework/fleet/heter_ps/graph_weight_prefix.cuh.h"
+
+namespace paddle {
+namespace framework {
+
+// Searches the prefix sums of one node with num points spread evenly on
+// [0, total), and counts the picks of each neighbor.
+__global__ void search_kernel(const float* prefix,
+                              uint32_t len,
+                              int num,
+                              unsigned int* counts) {
+  const int k = blockIdx.x * blockDim.x + threadIdx.x;
+  if (k >= num) return;
+  const float u = (k + 0.5f) * prefix[len - 1] / num;
+  atomicAdd(counts + search_weight_prefix(prefix, len, u), 1);
+}
+
+class GraphWeightPrefixTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // a warp, an empty node, more than a warp, zero weights, and a node of
+    // many neighbors whose prefix drifts when it is accumulated in float
+    std::vector<std::vector<float>> weights = {{1, 2, 1}, {}};
+    weights.emplace_back();
+    for (int j = 1; j <= 33; ++j) {
+      weights.back().push_back(j);
+    }
+    weights.push_back({0, 1, 0, 1});
+    weights.emplace_back(200000, 0.1f);
+
+    node_num_ = weights.size();
+    for (auto& node : weights) {
+      edge_num_ += node.size();
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMallocManaged(&node_info_, node_num_ * sizeof(GpuPsNodeInfo)));
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMallocManaged(&weight_, edge_num_ * sizeof(half)));
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMallocManaged(&prefix_, edge_num_ * sizeof(float)));
+    uint32_t offset = 0;
+    for (size_t i = 0; i < node_num_; ++i) {
+      node_info_[i].neighbor_offset = offset;
+      node_info_[i].neighbor_size = weights[i].size();
+      double sum = 0;
+      for (float w : weights[i]) {
+        weight_[offset] = __float2half(w);
+        // the sum of the weights as they are stored
+        sum += __half2float(weight_[offset]);
+        ref_prefix_.push_back(sum);
+        ++offset;
+      }
+    }
+
+    const int grid_size = (node_num_ * 32 + 127) / 128;
+    build_weight_prefix_kernel<<<grid_size, 128>>>(
+        node_info_, weight_, prefix_, node_num_);
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaDeviceSynchronize());
+  }
+
+  void TearDown() override {
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(node_info_));
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(weight_));
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(prefix_));
+  }
+
+  std::vector<unsigned int> Search(size_t node, int num) {
+    const auto& info = node_info_[node];
+    unsigned int* counts = nullptr;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaMallocManaged(
+        &counts, info.neighbor_size * sizeof(unsigned int)));
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMemset(counts, 0, info.neighbor_size * sizeof(unsigned int)));
+    search_kernel<<<(num + 127) / 128, 128>>>(
+        prefix_ + info.neighbor_offset, info.neighbor_size, num, counts);
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaDeviceSynchronize());
+    std::vector<unsigned int> result(counts, counts + info.neighbor_size);
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(counts));
+    return result;
+  }
+
+  size_t node_num_{0};
+  size_t edge_num_{0};
+  GpuPsNodeInfo* node_info_{nullptr};
+  half* weight_{nullptr};
+  float* prefix_{nullptr};
+  std::vector<double> ref_prefix_;
+};
+
+TEST_F(GraphWeightPrefixTest, PrefixSum) {
+  // each prefix sum is only rounded once to float
+  for (size_t k = 0; k < edge_num_; ++k) {
+    ASSERT_LE(std::fabs(prefix_[k] - ref_prefix_[k]), ref_prefix_[k] * 1e-6)
+        << "edge " << k;
+  }
+}
+
+TEST_F(GraphWeightPrefixTest, Search) {
+  // the picks of evenly spread points are proportional to the weights
+  EXPECT_EQ(Search(0, 4000), (std::vector<unsigned int>{1000, 2000, 1000}));
+  auto counts = Search(2, 561 * 8);
+  for (int j = 0; j < 33; ++j) {
+    EXPECT_EQ(counts[j], 8U * (j + 1)) << "neighbor " << j;
+  }
+  // neighbors of zero weight are never picked
+  EXPECT_EQ(Search(3, 1000), (std::vector<unsigned int>{0, 500, 0, 500}));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -28,6 +28,9 @@ std::shared_ptr<Metric> Metric::s_instance_ = nullptr;
 
 void BasicAucCalculator::init(int table_size) {
   set_table_size(table_size);
+#if defined(PADDLE_WITH_CUDA)
+  device_data_.clear();
+#endif
 
   // init CPU memory
   for (auto& item : _table) {
@@ -46,12 +49,21 @@ void BasicAucCalculator::reset() {
   _local_abserr = 0;
   _local_sqrerr = 0;
   _local_pred = 0;
+#if defined(PADDLE_WITH_CUDA)
+  reset_device_tables();
+#endif
 }
 
 void BasicAucCalculator::add_data(const float* d_pred,
                                   const int64_t* d_label,
                                   int batch_size,
                                   const phi::Place& place) {
+#if defined(PADDLE_WITH_CUDA)
+  if (phi::is_gpu_place(place)) {
+    add_device_data(d_pred, d_label, nullptr, batch_size, place);
+    return;
+  }
+#endif
   thread_local std::vector<float> h_pred;
   thread_local std::vector<int64_t> h_label;
   h_pred.resize(batch_size);
@@ -101,6 +113,12 @@ void BasicAucCalculator::add_mask_data(const float* d_pred,
                                        const int64_t* d_mask,
                                        int batch_size,
                                        const phi::Place& place) {
+#if defined(PADDLE_WITH_CUDA)
+  if (phi::is_gpu_place(place)) {
+    add_device_data(d_pred, d_label, d_mask, batch_size, place);
+    return;
+  }
+#endif
   thread_local std::vector<float> h_pred;
   thread_local std::vector<int64_t> h_label;
   thread_local std::vector<int64_t> h_mask;
@@ -121,6 +139,9 @@ void BasicAucCalculator::add_mask_data(const float* d_pred,
 }
 
 void BasicAucCalculator::compute() {
+#if defined(PADDLE_WITH_CUDA)
+  merge_device_data();
+#endif
 #if defined(PADDLE_WITH_GLOO)
   double area = 0;
   double fp = 0;
@@ -252,6 +273,11 @@ void BasicAucCalculator::calculate_bucket_error() {
 void BasicAucCalculator::reset_records() {
   // reset wuauc_records_
   wuauc_records_.clear();
+#if defined(PADDLE_WITH_CUDA)
+  for (auto& item : device_data_) {
+    item.second.record_num = 0;
+  }
+#endif
   _user_cnt = 0;
   _size = 0;
   _uauc = 0;
@@ -264,6 +290,12 @@ void BasicAucCalculator::add_uid_data(const float* d_pred,
                                       const int64_t* d_uid,
                                       int batch_size,
                                       const phi::Place& place) {
+#if defined(PADDLE_WITH_CUDA)
+  if (phi::is_gpu_place(place)) {
+    add_device_uid_data(d_pred, d_label, d_uid, batch_size, place);
+    return;
+  }
+#endif
   thread_local std::vector<float> h_pred;
   thread_local std::vector<int64_t> h_label;
   thread_local std::vector<uint64_t> h_uid;
@@ -305,7 +337,47 @@ void BasicAucCalculator::add_uid_unlock_data(double pred,
   wuauc_records_.emplace_back(std::move(record));
 }
 
+void BasicAucCalculator::shard_records_by_uid() {
+#if defined(PADDLE_WITH_GLOO)
+  auto gloo_wrapper = paddle::framework::GlooWrapper::GetInstance();
+  int nranks = gloo_wrapper->Size();
+  if (nranks <= 1) {
+    return;
+  }
+  std::vector<std::vector<WuaucRecord>> shards(nranks);
+  for (const auto& record : wuauc_records_) {
+    shards[record.uid_ % nranks].push_back(record);
+  }
+  wuauc_records_.clear();
+  // the shards of a rank are gathered one rank at a time, so only 1 / nranks
+  // of the records are gathered at once
+  for (int dst = 0; dst < nranks; ++dst) {
+    uint64_t record_num = shards[dst].size();
+    auto record_nums = gloo_wrapper->AllGather(record_num);
+    std::vector<size_t> byte_nums(nranks);
+    size_t total_num = 0;
+    for (int i = 0; i < nranks; ++i) {
+      byte_nums[i] = record_nums[i] * sizeof(WuaucRecord);
+      total_num += record_nums[i];
+    }
+    std::vector<WuaucRecord> records(total_num);
+    gloo_wrapper->AllGatherVector(reinterpret_cast<char*>(shards[dst].data()),
+                                  reinterpret_cast<char*>(records.data()),
+                                  byte_nums);
+    if (dst == gloo_wrapper->Rank()) {
+      wuauc_records_ = std::move(records);
+    }
+    std::vector<WuaucRecord>().swap(shards[dst]);
+  }
+#endif
+}
+
 void BasicAucCalculator::computeWuAuc() {
+#if defined(PADDLE_WITH_CUDA)
+  merge_device_data();
+#endif
+  // the auc of a user is of all its records
+  shard_records_by_uid();
   std::sort(wuauc_records_.begin(),
             wuauc_records_.end(),
             [](const WuaucRecord& lhs, const WuaucRecord& rhs) {
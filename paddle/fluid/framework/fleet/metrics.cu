@@ -0,0 +1,241 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/metrics.h"
+
+#if (defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_PSCORE)) && \
+    defined(PADDLE_WITH_CUDA)
+#include <algorithm>
+#include <vector>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_helper.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/core/memory/memory.h"
+#include "paddle/phi/core/platform/cuda_device_guard.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr int kNumThreads = 512;
+constexpr int kMaxBlocks = 256;
+// abserr, sqrerr, pred and the invalid instances, after the tables
+constexpr int kNumStats = 4;
+
+int NumBlocks(int batch_size) {
+  return std::max(
+      1, std::min(kMaxBlocks, (batch_size + kNumThreads - 1) / kNumThreads));
+}
+
+cudaStream_t GetStream(const phi::Place& place) {
+  return static_cast<phi::GPUContext*>(
+             phi::DeviceContextPool::Instance().Get(place))
+      ->stream();
+}
+
+phi::Stream ToStream(cudaStream_t stream) {
+  return phi::Stream(reinterpret_cast<phi::StreamId>(stream));
+}
+
+}  // namespace
+
+// The bucket of an instance is counted by an atomic, and the sums of a
+// thread are added to the stats once.
+__global__ void AddAucDataKernel(const float* pred,
+                                 const int64_t* label,
+                                 const int64_t* mask,
+                                 int batch_size,
+                                 int table_size,
+                                 double* table,
+                                 double* stats) {
+  double abserr = 0;
+  double sqrerr = 0;
+  double sum_pred = 0;
+  double invalid = 0;
+  CUDA_KERNEL_LOOP(i, batch_size) {
+    if (mask != nullptr && mask[i] == 0) {
+      continue;
+    }
+    double p = pred[i];
+    int64_t l = label[i];
+    if (!(p >= 0.0 && p <= 1.0) || (l != 0 && l != 1)) {
+      invalid += 1;
+      continue;
+    }
+    int pos = min(static_cast<int>(p * table_size), table_size - 1);
+    phi::CudaAtomicAdd(table + l * table_size + pos, 1.0);
+    abserr += fabs(p - l);
+    sqrerr += (p - l) * (p - l);
+    sum_pred += p;
+  }
+  if (abserr != 0 || sum_pred != 0 || invalid != 0) {
+    phi::CudaAtomicAdd(stats, abserr);
+    phi::CudaAtomicAdd(stats + 1, sqrerr);
+    phi::CudaAtomicAdd(stats + 2, sum_pred);
+    phi::CudaAtomicAdd(stats + 3, invalid);
+  }
+}
+
+__global__ void AddUidRecordsKernel(const float* pred,
+                                    const int64_t* label,
+                                    const int64_t* uid,
+                                    int batch_size,
+                                    BasicAucCalculator::WuaucRecord* records) {
+  CUDA_KERNEL_LOOP(i, batch_size) {
+    records[i].uid_ = static_cast<uint64_t>(uid[i]);
+    records[i].label_ = static_cast<int>(label[i]);
+    records[i].pred_ = pred[i];
+  }
+}
+
+BasicAucCalculator::DeviceData* BasicAucCalculator::device_data(
+    const phi::Place& place) {
+  auto& data = device_data_[place.GetDeviceId()];
+  data.place = place;
+  return &data;
+}
+
+void BasicAucCalculator::add_device_data(const float* d_pred,
+                                         const int64_t* d_label,
+                                         const int64_t* d_mask,
+                                         int batch_size,
+                                         const phi::Place& place) {
+  platform::CUDADeviceGuard guard(place.GetDeviceId());
+  auto stream = GetStream(place);
+  std::lock_guard<std::mutex> lock(_table_mutex);
+  auto* data = device_data(place);
+  if (!data->table) {
+    size_t bytes = (2 * _table_size + kNumStats) * sizeof(double);
+    data->table = memory::AllocShared(place, bytes, ToStream(stream));
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMemsetAsync(data->table->ptr(), 0, bytes, stream));
+  }
+  auto* table = reinterpret_cast<double*>(data->table->ptr());
+  AddAucDataKernel<<<NumBlocks(batch_size), kNumThreads, 0, stream>>>(
+      d_pred,
+      d_label,
+      d_mask,
+      batch_size,
+      _table_size,
+      table,
+      table + 2 * _table_size);
+}
+
+void BasicAucCalculator::add_device_uid_data(const float* d_pred,
+                                             const int64_t* d_label,
+                                             const int64_t* d_uid,
+                                             int batch_size,
+                                             const phi::Place& place) {
+  platform::CUDADeviceGuard guard(place.GetDeviceId());
+  auto stream = GetStream(place);
+  std::lock_guard<std::mutex> lock(_table_mutex);
+  auto* data = device_data(place);
+  size_t record_num = data->record_num + batch_size;
+  if (record_num > data->record_capacity) {
+    // freed in the order of the stream, after the copy
+    size_t capacity = std::max(record_num, 2 * data->record_capacity);
+    auto records = memory::AllocShared(
+        place, capacity * sizeof(WuaucRecord), ToStream(stream));
+    if (data->record_num > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          cudaMemcpyAsync(records->ptr(),
+                          data->records->ptr(),
+                          data->record_num * sizeof(WuaucRecord),
+                          cudaMemcpyDeviceToDevice,
+                          stream));
+    }
+    data->records = records;
+    data->record_capacity = capacity;
+  }
+  auto* records = reinterpret_cast<WuaucRecord*>(data->records->ptr());
+  AddUidRecordsKernel<<<NumBlocks(batch_size), kNumThreads, 0, stream>>>(
+      d_pred, d_label, d_uid, batch_size, records + data->record_num);
+  data->record_num = record_num;
+}
+
+void BasicAucCalculator::merge_device_data() {
+  std::lock_guard<std::mutex> lock(_table_mutex);
+  std::vector<double> h_table;
+  std::vector<WuaucRecord> h_records;
+  for (auto& item : device_data_) {
+    auto& data = item.second;
+    platform::CUDADeviceGuard guard(item.first);
+    auto stream = GetStream(data.place);
+    size_t bytes = (2 * _table_size + kNumStats) * sizeof(double);
+    // no table for the calculators of WuAuc
+    h_table.assign(data.table ? 2 * _table_size + kNumStats : 0, 0.0);
+    h_records.resize(data.record_num);
+    if (data.table) {
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(h_table.data(),
+                                                 data.table->ptr(),
+                                                 bytes,
+                                                 cudaMemcpyDeviceToHost,
+                                                 stream));
+    }
+    if (data.record_num > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          cudaMemcpyAsync(h_records.data(),
+                          data.records->ptr(),
+                          data.record_num * sizeof(WuaucRecord),
+                          cudaMemcpyDeviceToHost,
+                          stream));
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+    data.record_num = 0;
+    for (const auto& record : h_records) {
+      add_uid_unlock_data(record.pred_, record.label_, record.uid_);
+    }
+    if (!data.table) {
+      continue;
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMemsetAsync(data.table->ptr(), 0, bytes, stream));
+
+    const double* stats = h_table.data() + 2 * _table_size;
+    PADDLE_ENFORCE_EQ(
+        stats[3],
+        0.0,
+        common::errors::PreconditionNotMet(
+            "%d instances added on GPU %d have a pred out of [0, 1] or a "
+            "label not 0 or 1",
+            static_cast<int64_t>(stats[3]),
+            item.first));
+    for (int i = 0; i < _table_size; ++i) {
+      _table[0][i] += h_table[i];
+      _table[1][i] += h_table[_table_size + i];
+    }
+    _local_abserr += stats[0];
+    _local_sqrerr += stats[1];
+    _local_pred += stats[2];
+  }
+}
+
+void BasicAucCalculator::reset_device_tables() {
+  for (auto& item : device_data_) {
+    auto& data = item.second;
+    if (!data.table) {
+      continue;
+    }
+    platform::CUDADeviceGuard guard(item.first);
+    size_t bytes = (2 * _table_size + kNumStats) * sizeof(double);
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaMemsetAsync(
+        data.table->ptr(), 0, bytes, GetStream(data.place)));
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
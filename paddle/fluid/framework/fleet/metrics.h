@@ -104,6 +104,37 @@ class BasicAucCalculator {
 
  private:
   void calculate_bucket_error();
+  // the records of a uid are moved to the rank uid % the number of ranks
+  void shard_records_by_uid();
+#if defined(PADDLE_WITH_CUDA)
+  // The batches added on a GPU are accumulated on it by kernels, with no
+  // sync with the host, until compute or computeWuAuc.
+  struct DeviceData {
+    phi::Place place;
+    // the 2 tables, then the sums of abserr, sqrerr, pred and the number of
+    // the invalid instances
+    std::shared_ptr<phi::Allocation> table;
+    std::shared_ptr<phi::Allocation> records;
+    size_t record_num = 0;
+    size_t record_capacity = 0;
+  };
+  DeviceData* device_data(const phi::Place& place);
+  void add_device_data(const float* d_pred,
+                       const int64_t* d_label,
+                       const int64_t* d_mask,
+                       int batch_size,
+                       const phi::Place& place);
+  void add_device_uid_data(const float* d_pred,
+                           const int64_t* d_label,
+                           const int64_t* d_uid,
+                           int batch_size,
+                           const phi::Place& place);
+  // adds the data of the GPUs to the host tables and records
+  void merge_device_data();
+  void reset_device_tables();
+  // by device id
+  std::map<int, DeviceData> device_data_;
+#endif
 
  protected:
   double _local_abserr = 0;
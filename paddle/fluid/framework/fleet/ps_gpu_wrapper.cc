@@ -48,6 +48,9 @@ COMMON_DECLARE_int32(gpugraph_dedup_pull_push_mode);
 COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_bool(query_dest_rank_by_multi_node);
 COMMON_DECLARE_string(graph_edges_split_mode);
+COMMON_DECLARE_bool(gpugraph_incremental_pass_build);
+COMMON_DECLARE_uint64(gpugraph_host_cache_capacity);
+COMMON_DECLARE_uint64(gpugraph_pass_pipeline_max_feasign);
 
 namespace paddle {
 namespace framework {
@@ -1819,13 +1822,21 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
           << " s.";
   stagetime.Start();
 
+  // the keys of the last pass are sharded to the same devices, whose values
+  // dumped from hbm are newer than those of the cpu table being written
+  auto pass_values = pass_values_;
+  std::atomic<size_t> pass_value_hits{0};
   auto build_dynamic_mf_func =
-      [this, &gpu_task, &accessor_wrapper_ptr](
+      [this, &gpu_task, &accessor_wrapper_ptr, &pass_values, &pass_value_hits](
           const int i, const size_t tid, const size_t once_gpu_copy) {
         //    VLOG(0) << "begin build_dynamic_mf_func tid=" << tid << ", i=" <<
         //    i;
+        size_t hits = 0;
         for (int j = 0; j < multi_mf_dim_; j++) {
           auto& device_dim_ptrs = gpu_task->device_dim_ptr_[i][j];
+          auto& device_dim_keys = gpu_task->device_dim_keys_[i][j];
+          const robin_hood::unordered_map<uint64_t, size_t>* value_index =
+              pass_values ? &pass_values->index[i][j] : nullptr;
           int mf_dim = this->index_dim_vec_[j];
           size_t feature_value_size =
               accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
@@ -1840,6 +1851,24 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
                 [](char* p) { delete[] p; });
             char* test_build_values = build_values.get();
             for (size_t k = start; k < end; k++) {
+              if (value_index != nullptr) {
+                auto it = value_index->find(device_dim_keys[k]);
+                if (it != value_index->end()) {
+                  char* pass_val = pass_values->values[i][j].get() +
+                                   it->second * feature_value_size;
+                  uint64_t cpu_ptr = accessor_wrapper_ptr->GetCpuPtr(
+                      reinterpret_cast<float*>(pass_val));
+                  // the value is rebuilt if the cpu table recreated it
+                  if (cpu_ptr ==
+                      reinterpret_cast<uint64_t>(device_dim_ptrs[k])) {
+                    memcpy(test_build_values + (k - start) * feature_value_size,
+                           pass_val,
+                           feature_value_size);
+                    ++hits;
+                    continue;
+                  }
+                }
+              }
 #ifdef PADDLE_WITH_PSCORE
               void* val = reinterpret_cast<float*>(
                   test_build_values + (k - start) * feature_value_size);
@@ -1868,6 +1897,7 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
             start = start + (once_gpu_copy * cpu_device_thread_num_);
           }
         }
+        pass_value_hits += hits;
         //    VLOG(0) << "end build_dynamic_mf_func tid=" << tid << ", i=" << i;
       };
 
@@ -1998,7 +2028,8 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
   stagetime.Pause();
   VLOG(1) << "passid=" << gpu_task->pass_id_
           << ", BuildGPUTask build_dynamic_mf_func "
-          << " cost " << stagetime.ElapsedSec() << " s.";
+          << " cost " << stagetime.ElapsedSec()
+          << " s, feasigns built from last pass: " << pass_value_hits;
   for (int i = 0; i < device_num; i++) {
     cpu_reday_channels_[i]->Close();
   }
@@ -2070,6 +2101,7 @@ void PSGPUWrapper::start_build_thread() {
   running_ = true;
   VLOG(3) << "start build CPU ps thread.";
   buildpull_threads_ = std::thread([this] { build_pull_thread(); });
+  buildprepare_threads_ = std::thread([this] { build_prepare_thread(); });
 }
 
 void PSGPUWrapper::AddSparseKeys() {
@@ -2097,6 +2129,13 @@ void PSGPUWrapper::build_pull_thread() {
     VLOG(3) << "thread build pull start.";
     platform::Timer timer;
     timer.Start();
+    AcquirePipelineBudget(gpu_task);
+    timer.Pause();
+    VLOG(0) << "passid=" << gpu_task->pass_id_
+            << ", thread BuildPull wait budget cost time: "
+            << timer.ElapsedSec() << "s, feasign nums: "
+            << gpu_task->pipeline_feasign_num_;
+    timer.Start();
     if (slot_num_for_pull_feature_ > 0 || float_slot_num_ > 0) {
       PartitionKey(gpu_task);
     }
@@ -2111,23 +2150,83 @@ void PSGPUWrapper::build_pull_thread() {
   VLOG(3) << "build cpu thread end";
 }
 
+void PSGPUWrapper::build_prepare_thread() {
+  while (running_) {
+    std::shared_ptr<HeterContext> gpu_task = nullptr;
+    if (!buildpull_ready_channel_->Get(gpu_task)) {
+      continue;
+    }
+    // the merge pull of multi node graph waits at a barrier in BeginPass
+    if (!multi_node_ || !gpu_graph_mode_) {
+      platform::Timer timer;
+      timer.Start();
+      if (multi_mf_dim_) {
+        divide_to_device(gpu_task);
+      } else {
+        PrepareGPUTask(gpu_task);
+      }
+      gpu_task->prepared_ = true;
+      timer.Pause();
+      VLOG(0) << "passid=" << gpu_task->pass_id_
+              << ", thread PrepareGPUTask end, cost time: "
+              << timer.ElapsedSec() << "s";
+    }
+    buildprepare_ready_channel_->Put(gpu_task);
+  }
+  VLOG(3) << "build prepare thread end";
+}
+
+void PSGPUWrapper::AcquirePipelineBudget(
+    std::shared_ptr<HeterContext> gpu_task) {
+  uint64_t feasign_num = gpu_task->size();
+  for (auto& shard_keys : gpu_task->feature_dim_keys_) {
+    for (auto& keys : shard_keys) {
+      feasign_num += keys.size();
+    }
+  }
+  std::unique_lock<std::mutex> lock(pipeline_mutex_);
+  uint64_t max_feasign = FLAGS_gpugraph_pass_pipeline_max_feasign;
+  pipeline_cond_.wait(lock, [this, feasign_num, max_feasign] {
+    return !running_ || max_feasign == 0 || pipeline_feasign_num_ == 0 ||
+           pipeline_feasign_num_ + feasign_num <= max_feasign;
+  });
+  pipeline_feasign_num_ += feasign_num;
+  gpu_task->pipeline_feasign_num_ = feasign_num;
+}
+
+void PSGPUWrapper::ReleasePipelineBudget(
+    std::shared_ptr<HeterContext> gpu_task) {
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    pipeline_feasign_num_ -= gpu_task->pipeline_feasign_num_;
+    gpu_task->pipeline_feasign_num_ = 0;
+  }
+  pipeline_cond_.notify_all();
+}
+
 void PSGPUWrapper::build_task() {
   // build_task: build_pull + build_gputask
   std::shared_ptr<HeterContext> gpu_task = nullptr;
+  platform::Timer timer;
+  timer.Start();
   // ins and pre_build end
-  if (!buildpull_ready_channel_->Get(gpu_task)) {
+  if (!buildprepare_ready_channel_->Get(gpu_task)) {
     return;
   }
+  timer.Pause();
+  VLOG(1) << "passid=" << gpu_task->pass_id_
+          << ", wait pass pipeline cost time: " << timer.ElapsedSec() << "s";
 
   VLOG(1) << "passid=" << gpu_task->pass_id_ << ", PrepareGPUTask start.";
-  platform::Timer timer;
   timer.Start();
-  // merge pull
-  MergePull(gpu_task);
-  if (multi_mf_dim_) {
-    divide_to_device(gpu_task);
-  } else {
-    PrepareGPUTask(gpu_task);
+  if (!gpu_task->prepared_) {
+    // merge pull
+    MergePull(gpu_task);
+    if (multi_mf_dim_) {
+      divide_to_device(gpu_task);
+    } else {
+      PrepareGPUTask(gpu_task);
+    }
   }
   BuildGPUTask(gpu_task);
   timer.Pause();
@@ -2184,12 +2283,17 @@ void PSGPUWrapper::EndPass() {
   }
   platform::Timer stagetime;
   stagetime.Start();
-  HbmToSparseTable();
+  if (FLAGS_gpugraph_incremental_pass_build) {
+    HbmToPassValues();
+  } else {
+    HbmToSparseTable();
+  }
   stagetime.Pause();
   VLOG(0) << "passid=" << current_task_->pass_id_
           << ", EndPass HbmToSparseTable cost time: " << stagetime.ElapsedSec()
           << "s";
 
+  ReleasePipelineBudget(current_task_);
   gpu_task_pool_.Push(current_task_);
   current_task_ = nullptr;
   // fleet_ptr->pslib_ptr_->_worker_ptr->release_table_mutex(this->table_id_);
@@ -2237,6 +2341,7 @@ void PSGPUWrapper::SparseTableToHbm() {
 }
 
 void PSGPUWrapper::HbmToSparseTable() {
+  WaitEndPass(true);
   // hbm no update not need dump
   if (grad_push_count_ == 0) {
     return;
@@ -2384,6 +2489,192 @@ void PSGPUWrapper::HbmToSparseTable() {
   }
 }
 
+void PSGPUWrapper::HbmToPassValues() {
+  // the values of the last pass are written before those of this pass
+  size_t cache_capacity = FLAGS_gpugraph_host_cache_capacity;
+  WaitEndPass(cache_capacity == 0);
+  // hbm no update, the cpu table is up to date
+  if (grad_push_count_ == 0) {
+    return;
+  }
+  auto last_values = pass_values_;
+  grad_push_count_ = 0;
+
+  if (!current_task_) {
+    PADDLE_THROW(
+        common::errors::Fatal("[EndPass] current task has been ended."));
+  }
+  auto accessor_wrapper_ptr =
+      GlobalAccessorFactory::GetInstance().GetAccessorWrapper();
+  size_t device_num = heter_devices_.size();
+  auto pass_values = std::make_shared<PassValues>();
+  pass_values->values.resize(device_num);
+  pass_values->index.resize(device_num);
+  pass_values->freqs.resize(device_num);
+  pass_values->pass_lens.resize(device_num);
+
+  // copies the hbm pools to host while indexing the keys of the pools, the
+  // values of the earlier passes that are frequent enough are kept after them
+  auto dump_pool_func = [this,
+                         &accessor_wrapper_ptr,
+                         &pass_values,
+                         &last_values,
+                         cache_capacity](int i) {
+    platform::Timer tm;
+    tm.Start();
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaSetDevice(this->resource_->dev_id(i)));
+    auto stream = this->resource_->local_stream(i, 0);
+    auto& values = pass_values->values[i];
+    auto& index = pass_values->index[i];
+    auto& freqs = pass_values->freqs[i];
+    values.resize(this->multi_mf_dim_);
+    index.resize(this->multi_mf_dim_);
+    freqs.resize(this->multi_mf_dim_);
+    pass_values->pass_lens[i].resize(this->multi_mf_dim_);
+    size_t total_len = 0;
+    size_t total_cached = 0;
+    for (int j = 0; j < this->multi_mf_dim_; ++j) {
+      int mf_dim = this->index_dim_vec_[j];
+      size_t feature_value_size =
+          accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
+      auto& device_keys = this->current_task_->device_dim_keys_[i][j];
+      size_t len = device_keys.size();
+      uint64_t unuse_key = std::numeric_limits<uint64_t>::max();
+      index[j].reserve(len);
+      for (size_t k = 0; k < len; ++k) {
+        if (device_keys[k] != unuse_key) {
+          index[j][device_keys[k]] = k;
+        }
+      }
+      freqs[j].assign(len, 1);
+
+      // the values of the earlier passes that are not in this pass
+      std::vector<CachedValue> cached;
+      if (last_values != nullptr) {
+        cached = SelectCachedValues(last_values->index[i][j],
+                                    last_values->freqs[i][j],
+                                    index[j],
+                                    cache_capacity,
+                                    &freqs[j]);
+      }
+
+      values[j].reset(new char[feature_value_size * (len + cached.size())],
+                      [](char* p) { delete[] p; });
+      auto& hbm_pool = this->hbm_pools_[i * this->multi_mf_dim_ + j];
+      if (len > 0) {
+        PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(values[j].get(),
+                                                   hbm_pool->mem(),
+                                                   feature_value_size * len,
+                                                   cudaMemcpyDeviceToHost,
+                                                   stream));
+      }
+      if (!cached.empty()) {
+        char* last_vals = last_values->values[i][j].get();
+        index[j].reserve(len + cached.size());
+        freqs[j].resize(len + cached.size());
+        for (size_t k = 0; k < cached.size(); ++k) {
+          memcpy(values[j].get() + (len + k) * feature_value_size,
+                 last_vals + cached[k].pos * feature_value_size,
+                 feature_value_size);
+          index[j][cached[k].key] = len + k;
+          freqs[j][len + k] = cached[k].freq;
+        }
+      }
+      pass_values->pass_lens[i][j] = len;
+      total_len += len;
+      total_cached += cached.size();
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+    tm.Pause();
+    VLOG(1) << "dump_pool_func i=" << i << ", total len=" << total_len
+            << ", cached len=" << total_cached << ", span=" << tm.ElapsedSec();
+  };
+  std::vector<std::future<void>> gpu_task_futures;
+  for (size_t i = 0; i < device_num; i++) {
+    gpu_task_futures.emplace_back(
+        hbm_thread_pool_[i]->enqueue(dump_pool_func, i));
+  }
+  for (auto& f : gpu_task_futures) {
+    f.wait();
+  }
+  size_t keysize_max = 0;
+  for (size_t i = 0; i < device_num; i++) {
+    for (int j = 0; j < multi_mf_dim_; j++) {
+      keysize_max = std::max(keysize_max, pass_values->index[i][j].size());
+    }
+  }
+  if (keysize_max != 0) {
+    HeterPs_->end_pass();
+  }
+
+  // writes the values back while the next pass is built and trained
+  for (size_t i = 0; i < device_num; i++) {
+    for (int j = 0; j < multi_mf_dim_; j++) {
+      pass_dump_futures_.emplace_back(std::async(
+          std::launch::async,
+          [this, accessor_wrapper_ptr, pass_values, i, j]() {
+#ifdef PADDLE_WITH_PSCORE
+            int mf_dim = this->index_dim_vec_[j];
+            size_t feature_value_size =
+                accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
+            char* values = pass_values->values[i][j].get();
+            // the values kept from the earlier passes were written already
+            size_t pass_len = pass_values->pass_lens[i][j];
+            for (auto& it : pass_values->index[i][j]) {
+              if (it.second >= pass_len) {
+                continue;
+              }
+              float* gpu_val = reinterpret_cast<float*>(
+                  values + it.second * feature_value_size);
+              accessor_wrapper_ptr->DumpFill(
+                  gpu_val, this->cpu_table_accessor_, mf_dim);
+            }
+#endif
+          }));
+    }
+  }
+  pass_values_ = pass_values;
+}
+
+std::vector<PSGPUWrapper::CachedValue> PSGPUWrapper::SelectCachedValues(
+    const robin_hood::unordered_map<uint64_t, size_t>& last_index,
+    const std::vector<uint32_t>& last_freqs,
+    const robin_hood::unordered_map<uint64_t, size_t>& index,
+    size_t capacity,
+    std::vector<uint32_t>* freqs) {
+  std::vector<CachedValue> cached;
+  for (auto& it : last_index) {
+    uint32_t freq = last_freqs[it.second];
+    auto found = index.find(it.first);
+    if (found != index.end()) {
+      (*freqs)[found->second] =
+          std::min(freq, std::numeric_limits<uint32_t>::max() - 1) + 1;
+    } else if (freq > 1) {
+      cached.push_back({freq - 1, it.first, it.second});
+    }
+  }
+  if (cached.size() > capacity) {
+    std::nth_element(cached.begin(),
+                     cached.begin() + capacity,
+                     cached.end(),
+                     [](const CachedValue& a, const CachedValue& b) {
+                       return a.freq > b.freq;
+                     });
+    cached.resize(capacity);
+  }
+  return cached;
+}
+
+void PSGPUWrapper::WaitEndPass(bool release_values) {
+  for (auto& f : pass_dump_futures_) {
+    f.wait();
+  }
+  pass_dump_futures_.clear();
+  if (release_values) {
+    pass_values_ = nullptr;
+  }
+}
+
 void PSGPUWrapper::DumpToMem() {
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
   if (gpu_graph_mode_ &&
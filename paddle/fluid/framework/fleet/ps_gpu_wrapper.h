@@ -16,8 +16,12 @@ limitations under the License. */
 #ifdef PADDLE_WITH_HETERPS
 
 #include <google/protobuf/text_format.h>
+#include <gtest/gtest_prod.h>
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <ctime>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -70,6 +74,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/fleet/heter_ps/log_patch.h"
 
 COMMON_DECLARE_int32(gpugraph_storage_mode);
+COMMON_DECLARE_int32(gpugraph_pass_pipeline_depth);
 
 namespace paddle {
 namespace framework {
@@ -325,10 +330,18 @@ class PSGPUWrapper {
   void resize_gputask(std::shared_ptr<HeterContext> gpu_task);
   void SparseTableToHbm();
   void HbmToSparseTable();
+  void HbmToPassValues();
+  // Waits for the values of the last pass to be written back to the cpu
+  // table, which is asynchronous with FLAGS_gpugraph_incremental_pass_build.
+  // The values are released if the cpu table is to be shrunk.
+  void WaitEndPass(bool release_values = false);
   void start_build_thread();
   void AddSparseKeys();
   void build_pull_thread();
+  void build_prepare_thread();
   void build_task();
+  void AcquirePipelineBudget(std::shared_ptr<HeterContext> gpu_task);
+  void ReleasePipelineBudget(std::shared_ptr<HeterContext> gpu_task);
   void DumpToMem();
   void MergePull(std::shared_ptr<HeterContext> gpu_task);
   void MergeKeys(std::shared_ptr<HeterContext> gpu_task);
@@ -358,6 +371,7 @@ class PSGPUWrapper {
     if (s_instance_ == nullptr) {
       return;
     }
+    WaitEndPass(true);
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
     if (gpu_graph_mode_) {
       if (FLAGS_gpugraph_storage_mode == GpuGraphStorageMode::WHOLE_HBM) {
@@ -370,9 +384,15 @@ class PSGPUWrapper {
     }
     buildcpu_ready_channel_->Close();
     buildpull_ready_channel_->Close();
-    running_ = false;
+    buildprepare_ready_channel_->Close();
+    {
+      std::lock_guard<std::mutex> lock(pipeline_mutex_);
+      running_ = false;
+    }
+    pipeline_cond_.notify_all();
     VLOG(3) << "begin stop buildpull_threads_";
     buildpull_threads_.join();
+    buildprepare_threads_.join();
     s_instance_ = nullptr;
     VLOG(3) << "PSGPUWrapper Finalize Finished.";
     if (HeterPs_ != NULL) {
@@ -456,7 +476,11 @@ class PSGPUWrapper {
       buildcpu_ready_channel_->Open();
       buildcpu_ready_channel_->SetCapacity(3);
       buildpull_ready_channel_->Open();
-      buildpull_ready_channel_->SetCapacity(1);
+      buildpull_ready_channel_->SetCapacity(
+          std::max(FLAGS_gpugraph_pass_pipeline_depth, 1));
+      buildprepare_ready_channel_->Open();
+      buildprepare_ready_channel_->SetCapacity(
+          std::max(FLAGS_gpugraph_pass_pipeline_depth, 1));
 
       cpu_reday_channels_.resize(dev_ids.size());
       for (size_t i = 0; i < dev_ids.size(); i++) {
@@ -1084,6 +1108,10 @@ class PSGPUWrapper {
   }
 
  private:
+  FRIEND_TEST(PSGPUWrapper, WaitEndPass);
+  FRIEND_TEST(PSGPUWrapper, PipelineBudget);
+  FRIEND_TEST(PSGPUWrapper, SelectCachedValues);
+
   static std::shared_ptr<PSGPUWrapper> s_instance_;
   static std::mutex ins_mutex;
   Dataset* dataset_;
@@ -1175,11 +1203,56 @@ class PSGPUWrapper {
       paddle::framework::ChannelObject<std::shared_ptr<HeterContext>>>
       buildpull_ready_channel_ =
           paddle::framework::MakeChannel<std::shared_ptr<HeterContext>>();
+  std::shared_ptr<
+      paddle::framework::ChannelObject<std::shared_ptr<HeterContext>>>
+      buildprepare_ready_channel_ =
+          paddle::framework::MakeChannel<std::shared_ptr<HeterContext>>();
   std::vector<std::shared_ptr<paddle::framework::ChannelObject<task_info>>>
       cpu_reday_channels_;
   std::shared_ptr<HeterContext> current_task_ = nullptr;
+  // The values of the last pass dumped from hbm with
+  // FLAGS_gpugraph_incremental_pass_build, which are newer than those of the
+  // cpu table until they are written back. With
+  // FLAGS_gpugraph_host_cache_capacity the values of the earlier passes
+  // follow those of the last pass, and are kept by their frequency.
+  struct PassValues {
+    // [device][dim]
+    std::vector<std::vector<std::shared_ptr<char>>> values;
+    // [device][dim], key -> the position of the value
+    std::vector<std::vector<robin_hood::unordered_map<uint64_t, size_t>>>
+        index;
+    // [device][dim], the number of passes each value was trained in, which
+    // drops by one for each pass it is absent from
+    std::vector<std::vector<std::vector<uint32_t>>> freqs;
+    // [device][dim], the number of values dumped from hbm in the last pass
+    std::vector<std::vector<size_t>> pass_lens;
+  };
+  // A value of an earlier pass that is kept after the values of this pass.
+  struct CachedValue {
+    uint32_t freq;
+    uint64_t key;
+    // the position of the value in the last pass values
+    size_t pos;
+  };
+  // Counts in freqs, indexed as index, the values of this pass that were in
+  // the last pass values of last_index and last_freqs, and returns the most
+  // frequent values of the last pass that are absent from this pass, at most
+  // capacity of them, with their frequency dropped by one.
+  static std::vector<CachedValue> SelectCachedValues(
+      const robin_hood::unordered_map<uint64_t, size_t>& last_index,
+      const std::vector<uint32_t>& last_freqs,
+      const robin_hood::unordered_map<uint64_t, size_t>& index,
+      size_t capacity,
+      std::vector<uint32_t>* freqs);
+  std::shared_ptr<PassValues> pass_values_ = nullptr;
+  std::vector<std::future<void>> pass_dump_futures_;
   std::thread buildpull_threads_;
+  std::thread buildprepare_threads_;
   bool running_ = false;
+  // the feasigns of the passes from the pull stage to the end of pass
+  uint64_t pipeline_feasign_num_ = 0;
+  std::mutex pipeline_mutex_;
+  std::condition_variable pipeline_cond_;
   std::vector<std::shared_ptr<::ThreadPool>> pull_thread_pool_;
   std::vector<std::shared_ptr<::ThreadPool>> hbm_thread_pool_;
   std::vector<std::shared_ptr<::ThreadPool>> cpu_work_pool_;
@@ -0,0 +1,157 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <map>
+#include <thread>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/fleet/ps_gpu_wrapper.h"
+
+COMMON_DECLARE_uint64(gpugraph_pass_pipeline_max_feasign);
+
+namespace paddle {
+namespace framework {
+
+TEST(PSGPUWrapper, WaitEndPass) {
+  auto ps_wrapper = PSGPUWrapper::GetInstance();
+  std::atomic<int> written{0};
+  for (int i = 0; i < 4; ++i) {
+    ps_wrapper->pass_dump_futures_.emplace_back(
+        std::async(std::launch::async, [&written]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          ++written;
+        }));
+  }
+  ps_wrapper->pass_values_ = std::make_shared<PSGPUWrapper::PassValues>();
+
+  // the write-back is joined, and the values are kept for the next pass
+  ps_wrapper->WaitEndPass(false);
+  EXPECT_EQ(written.load(), 4);
+  EXPECT_TRUE(ps_wrapper->pass_dump_futures_.empty());
+  EXPECT_NE(ps_wrapper->pass_values_, nullptr);
+
+  // the values are released before the cpu table is shrunk
+  ps_wrapper->WaitEndPass(true);
+  EXPECT_EQ(ps_wrapper->pass_values_, nullptr);
+  // nothing to join
+  ps_wrapper->WaitEndPass(true);
+}
+
+std::shared_ptr<HeterContext> MakePipelineTask(size_t feasign_num) {
+  auto gpu_task = std::make_shared<HeterContext>();
+  gpu_task->feature_keys_.resize(1);
+  gpu_task->feature_keys_[0].resize(feasign_num);
+  return gpu_task;
+}
+
+TEST(PSGPUWrapper, PipelineBudget) {
+  auto ps_wrapper = PSGPUWrapper::GetInstance();
+  const bool running = ps_wrapper->running_;
+  const uint64_t max_feasign = FLAGS_gpugraph_pass_pipeline_max_feasign;
+  // the budget is only waited for while the wrapper is running
+  ps_wrapper->running_ = true;
+  FLAGS_gpugraph_pass_pipeline_max_feasign = 100;
+
+  auto a = MakePipelineTask(80);
+  ps_wrapper->AcquirePipelineBudget(a);
+  EXPECT_EQ(a->pipeline_feasign_num_, 80UL);
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 80UL);
+
+  // waits until the pass in flight has ended
+  auto b = MakePipelineTask(30);
+  auto acquire_b = std::async(std::launch::async, [&]() {
+    ps_wrapper->AcquirePipelineBudget(b);
+  });
+  EXPECT_EQ(acquire_b.wait_for(std::chrono::milliseconds(100)),
+            std::future_status::timeout);
+  ps_wrapper->ReleasePipelineBudget(a);
+  acquire_b.wait();
+  EXPECT_EQ(a->pipeline_feasign_num_, 0UL);
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 30UL);
+
+  // a pass larger than the budget is admitted once nothing is in flight
+  auto c = MakePipelineTask(500);
+  auto acquire_c = std::async(std::launch::async, [&]() {
+    ps_wrapper->AcquirePipelineBudget(c);
+  });
+  EXPECT_EQ(acquire_c.wait_for(std::chrono::milliseconds(100)),
+            std::future_status::timeout);
+  ps_wrapper->ReleasePipelineBudget(b);
+  acquire_c.wait();
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 500UL);
+  ps_wrapper->ReleasePipelineBudget(c);
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 0UL);
+
+  // no budget
+  FLAGS_gpugraph_pass_pipeline_max_feasign = 0;
+  auto d = MakePipelineTask(200);
+  auto e = MakePipelineTask(300);
+  ps_wrapper->AcquirePipelineBudget(d);
+  ps_wrapper->AcquirePipelineBudget(e);
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 500UL);
+  ps_wrapper->ReleasePipelineBudget(d);
+  ps_wrapper->ReleasePipelineBudget(e);
+  EXPECT_EQ(ps_wrapper->pipeline_feasign_num_, 0UL);
+
+  FLAGS_gpugraph_pass_pipeline_max_feasign = max_feasign;
+  ps_wrapper->running_ = running;
+}
+
+TEST(PSGPUWrapper, SelectCachedValues) {
+  // the key k of the last pass is at position k, with the frequency freq[k]
+  robin_hood::unordered_map<uint64_t, size_t> last_index;
+  std::vector<uint32_t> last_freqs = {1, 2, 3, 4, 5, 6, 7,
+                                      std::numeric_limits<uint32_t>::max()};
+  for (size_t k = 0; k < last_freqs.size(); ++k) {
+    last_index[k] = k;
+  }
+  // this pass trains the keys 1, 7 and 8
+  robin_hood::unordered_map<uint64_t, size_t> index = {{1, 0}, {7, 1}, {8, 2}};
+  std::vector<uint32_t> freqs(index.size(), 1);
+
+  auto cached = PSGPUWrapper::SelectCachedValues(
+      last_index, last_freqs, index, 3, &freqs);
+  // the keys of this pass count one more pass, without overflow
+  EXPECT_EQ(freqs[0], 3U);
+  EXPECT_EQ(freqs[1], std::numeric_limits<uint32_t>::max());
+  EXPECT_EQ(freqs[2], 1U);
+  // the key 0 drops to 0 and is evicted, the three most frequent of the
+  // others are kept
+  ASSERT_EQ(cached.size(), 3UL);
+  std::map<uint64_t, PSGPUWrapper::CachedValue> kept;
+  for (auto& value : cached) {
+    kept[value.key] = value;
+  }
+  for (uint64_t key : {4, 5, 6}) {
+    ASSERT_EQ(kept.count(key), 1UL) << "key " << key;
+    EXPECT_EQ(kept[key].pos, key);
+    EXPECT_EQ(kept[key].freq, last_freqs[key] - 1);
+  }
+
+  // nothing is kept without capacity
+  freqs.assign(index.size(), 1);
+  EXPECT_TRUE(PSGPUWrapper::SelectCachedValues(
+                  last_index, last_freqs, index, 0, &freqs)
+                  .empty());
+  EXPECT_EQ(freqs[0], 3U);
+}
+
+}  // namespace framework
+}  // namespace paddle
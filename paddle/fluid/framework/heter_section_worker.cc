@@ -10,7 +10,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #if defined(PADDLE_WITH_PSCORE)
+#include <algorithm>
 #include <cfloat>
+#include <chrono>
+#include <deque>
 
 #include "paddle/fluid/distributed/ps/service/heter_server.h"
 #include "paddle/fluid/framework/convert_utils.h"
@@ -225,6 +228,61 @@ void HeterSectionWorker::MiniBatchBarrier() {
   micro_ids_.clear();
 }
 
+// Keeps a window of micro-batches in flight, each sent forward again as soon
+// as its backward is done, instead of draining the pipeline per minibatch.
+// The window shrinks while the round trips are queued at the heter servers
+// and grows back otherwise, up to the micro-batch scopes.
+void HeterSectionWorker::RunFlowControlled() {
+  using Clock = std::chrono::steady_clock;
+  auto heter_client = paddle::distributed::HeterClient::GetInstance();
+  std::deque<int> free_micro_ids;
+  for (int i = 0; i < num_microbatches_; ++i) {
+    free_micro_ids.push_back(i);
+  }
+  std::vector<Clock::time_point> sent(num_microbatches_);
+  int window = num_microbatches_;
+  int in_flight = 0;
+  double min_round_trip_ms = DBL_MAX;
+  while (true) {
+    while (!epoch_finish_ && in_flight < window && !free_micro_ids.empty()) {
+      int micro_id = free_micro_ids.front();
+      RunForward(micro_id);
+      if (epoch_finish_) break;
+      free_micro_ids.pop_front();
+      sent[micro_id] = Clock::now();
+      ++in_flight;
+    }
+    if (in_flight == 0) break;
+
+    auto task = (*thread_queue_).Pop();
+    auto message_name = task.first;
+    auto micro_id = task.second;
+    PADDLE_ENFORCE_EQ(message_name.find("backward") != std::string::npos,
+                      true,
+                      common::errors::InvalidArgument(
+                          "cpu trainers only receive backward data"));
+    if (heter_client != nullptr) {
+      heter_client->FinishMicroBatch(thread_id_ * 10 + micro_id);
+    }
+    double round_trip_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - sent[micro_id])
+            .count();
+    min_round_trip_ms = std::min(min_round_trip_ms, round_trip_ms);
+    if (round_trip_ms > 2 * min_round_trip_ms) {
+      window = std::max(window - 1, 1);
+    } else {
+      window = std::min(window + 1, num_microbatches_);
+    }
+    RunBackward(micro_id);
+    batch_num_++;
+    BatchPostProcess();
+    free_micro_ids.push_back(micro_id);
+    --in_flight;
+    VLOG(4) << "micro-batch " << micro_id << " round trip " << round_trip_ms
+            << " ms, window " << window;
+  }
+}
+
 void HeterSectionWorker::RunListen() {
   VLOG(4) << ">>> run listen_op";
   listen_op_->Run(*root_scope_, place_);
@@ -379,7 +437,9 @@ void HeterSectionWorker::Run() {
   }
   bool is_first_stage = (pipeline_stage_ == 0);
   bool is_last_stage = (pipeline_stage_ + 1 == num_pipeline_stages_);
-  if (is_first_stage) {  // for cpu trainer
+  if (is_first_stage && ::paddle::distributed::FLAGS_heter_flow_control) {
+    RunFlowControlled();
+  } else if (is_first_stage) {  // for cpu trainer
     while (!epoch_finish_) {
       // forward
       for (int i = 0; i < num_microbatches_; i++) {
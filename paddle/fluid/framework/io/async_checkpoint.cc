@@ -0,0 +1,622 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/io/async_checkpoint.h"
+
+#include <xxhash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/phi/common/port.h"
+#include "paddle/phi/core/memory/malloc.h"
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/platform/cuda_device_guard.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_resource_pool.h"
+#include "paddle/phi/core/platform/device_context.h"
+#endif
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr char kMagic[] = "PDACKPT1";
+constexpr size_t kMagicSize = 8;
+// the bytes a thread writes at a time
+constexpr uint64_t kWriteChunkSize = 64ULL << 20;
+
+struct IndexEntry {
+  std::string name;
+  int32_t dtype;
+  std::vector<int64_t> dims;
+  // the shard holding the bytes, in the same directory, or this one if empty
+  std::string file;
+  uint64_t offset;
+  uint64_t nbytes;
+  uint64_t hash;
+};
+
+template <typename T>
+void PutPod(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void PutString(std::string* out, const std::string& value) {
+  PutPod<uint64_t>(out, value.size());
+  out->append(value);
+}
+
+std::string EncodeIndex(const std::vector<IndexEntry>& entries) {
+  std::string out;
+  PutPod<uint64_t>(&out, entries.size());
+  for (auto& entry : entries) {
+    PutString(&out, entry.name);
+    PutPod<int32_t>(&out, entry.dtype);
+    PutPod<uint64_t>(&out, entry.dims.size());
+    for (auto dim : entry.dims) {
+      PutPod<int64_t>(&out, dim);
+    }
+    PutString(&out, entry.file);
+    PutPod<uint64_t>(&out, entry.offset);
+    PutPod<uint64_t>(&out, entry.nbytes);
+    PutPod<uint64_t>(&out, entry.hash);
+  }
+  return out;
+}
+
+class IndexReader {
+ public:
+  IndexReader(const std::string& data, const std::string& path)
+      : _data(data), _path(path) {}
+
+  template <typename T>
+  T Get() {
+    T value;
+    Read(&value, sizeof(T));
+    return value;
+  }
+
+  std::string GetString() {
+    std::string value(Get<uint64_t>(), '\0');
+    Read(&value[0], value.size());
+    return value;
+  }
+
+ private:
+  void Read(void* out, size_t size) {
+    PADDLE_ENFORCE_LE(
+        _pos + size,
+        _data.size(),
+        common::errors::InvalidArgument(
+            "The index of checkpoint %s is truncated.", _path));
+    std::memcpy(out, _data.data() + _pos, size);
+    _pos += size;
+  }
+
+  const std::string& _data;
+  const std::string& _path;
+  size_t _pos = 0;
+};
+
+std::vector<IndexEntry> DecodeIndex(const std::string& data,
+                                    const std::string& path) {
+  IndexReader reader(data, path);
+  std::vector<IndexEntry> entries(reader.Get<uint64_t>());
+  for (auto& entry : entries) {
+    entry.name = reader.GetString();
+    entry.dtype = reader.Get<int32_t>();
+    entry.dims.resize(reader.Get<uint64_t>());
+    for (auto& dim : entry.dims) {
+      dim = reader.Get<int64_t>();
+    }
+    entry.file = reader.GetString();
+    entry.offset = reader.Get<uint64_t>();
+    entry.nbytes = reader.Get<uint64_t>();
+    entry.hash = reader.Get<uint64_t>();
+  }
+  return entries;
+}
+
+std::string BaseName(const std::string& path) {
+  auto pos = path.find_last_of('/');
+  return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+// Runs func(0), ..., func(num_tasks - 1) on up to num_threads threads, and
+// throws the first error of them.
+template <typename Func>
+void ParallelRun(size_t num_tasks, int num_threads, Func func) {
+  size_t num_workers =
+      std::min(num_tasks, static_cast<size_t>(std::max(num_threads, 1)));
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next(0);
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers);
+  for (size_t t = 0; t < num_workers; ++t) {
+    threads.emplace_back([&] {
+      try {
+        for (size_t i = next++; i < num_tasks; i = next++) {
+          func(i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// The stream copying the tensors of a device to host, apart from its
+// compute stream.
+gpuStream_t CopyStream(int device) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::shared_ptr<platform::CudaStreamObject>>
+      streams;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& stream = streams[device];
+  if (!stream) {
+    stream = platform::CudaStreamResourcePool::Instance().New(device);
+  }
+  return stream.get();
+}
+
+void RecordEvent(gpuEvent_t event, gpuStream_t stream) {
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(event, stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(event, stream));
+#endif
+}
+
+void StreamWaitEvent(gpuStream_t stream, gpuEvent_t event) {
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamWaitEvent(stream, event, 0));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamWaitEvent(stream, event, 0));
+#endif
+}
+
+void EventSynchronize(gpuEvent_t event) {
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventSynchronize(event));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventSynchronize(event));
+#endif
+}
+#endif
+
+#ifndef _WIN32
+void PWriteAll(int fd, const char* data, uint64_t size, uint64_t offset) {
+  while (size > 0) {
+    ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    PADDLE_ENFORCE_GT(n,
+                      0,
+                      common::errors::Unavailable(
+                          "Failed to write the checkpoint: %s.",
+                          std::strerror(errno)));
+    data += n;
+    size -= n;
+    offset += n;
+  }
+}
+#endif
+
+}  // namespace
+
+struct AsyncCheckpointWriter::Job {
+  std::string path;
+  bool dedup;
+  std::vector<std::string> names;
+  std::vector<phi::DataType> dtypes;
+  std::vector<phi::DDim> dims;
+  std::vector<memory::AllocationPtr> buffers;
+  std::vector<uint64_t> nbytes;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // the GPU tensors are kept until their copies are done
+  std::vector<phi::DenseTensor> sources;
+  std::vector<std::shared_ptr<platform::CudaEventObject>> copied;
+#endif
+};
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(int num_threads)
+    : _num_threads(std::max(num_threads, 1)) {
+  _worker = std::thread([this] { Run(); });
+}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cond.notify_all();
+  // the worker writes the jobs left before it stops
+  _worker.join();
+  if (_error) {
+    try {
+      std::rethrow_exception(_error);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "async checkpoint save failed: " << e.what();
+    }
+  }
+}
+
+void AsyncCheckpointWriter::Save(const std::vector<std::string>& names,
+                                 const std::vector<phi::DenseTensor>& tensors,
+                                 const std::string& path,
+                                 bool dedup) {
+  PADDLE_ENFORCE_EQ(
+      names.size(),
+      tensors.size(),
+      common::errors::InvalidArgument(
+          "The names and tensors of a checkpoint should be as many, but got "
+          "%d names and %d tensors.",
+          names.size(),
+          tensors.size()));
+  auto job = std::make_unique<Job>();
+  job->path = path;
+  job->dedup = dedup;
+  job->names = names;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // the compute stream of each device copied from
+  std::unordered_map<int, gpuStream_t> compute_streams;
+#endif
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    PADDLE_ENFORCE_EQ(tensor.initialized(),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The tensor %s to save is not initialized.",
+                          names[i]));
+    PADDLE_ENFORCE_EQ(tensor.meta().is_contiguous(),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The tensor %s to save should be contiguous.",
+                          names[i]));
+    const uint64_t nbytes = tensor.numel() * phi::SizeOf(tensor.dtype());
+    const auto& place = tensor.place();
+    memory::AllocationPtr buffer;
+    if (phi::is_gpu_place(place)) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+      const int device = place.GetDeviceId();
+      gpuStream_t copy_stream = CopyStream(device);
+      if (compute_streams.count(device) == 0) {
+        auto* dev_ctx = static_cast<phi::GPUContext*>(
+            phi::DeviceContextPool::Instance().Get(place));
+        compute_streams[device] = dev_ctx->stream();
+        // the copies start after the work queued so far
+        platform::CUDADeviceGuard guard(device);
+        auto ready = platform::CudaEventResourcePool::Instance().New(device);
+        RecordEvent(ready.get(), dev_ctx->stream());
+        StreamWaitEvent(copy_stream, ready.get());
+      }
+      buffer = memory::Alloc(phi::GPUPinnedPlace(), nbytes);
+      if (nbytes > 0) {
+        platform::GpuMemcpyAsync(buffer->ptr(),
+                                 tensor.data(),
+                                 nbytes,
+                                 gpuMemcpyDeviceToHost,
+                                 copy_stream);
+      }
+      job->sources.push_back(tensor);
+#else
+      PADDLE_THROW(common::errors::Unavailable(
+          "Cannot save the GPU tensor %s, since PaddlePaddle is not compiled "
+          "with GPU.",
+          names[i]));
+#endif
+    } else {
+      PADDLE_ENFORCE_EQ(
+          phi::is_cpu_place(place) || phi::is_cuda_pinned_place(place),
+          true,
+          common::errors::Unimplemented(
+              "Cannot save the tensor %s on %s asynchronously.",
+              names[i],
+              place.DebugString()));
+      buffer = memory::Alloc(phi::CPUPlace(), nbytes);
+      if (nbytes > 0) {
+        std::memcpy(buffer->ptr(), tensor.data(), nbytes);
+      }
+    }
+    job->dtypes.push_back(tensor.dtype());
+    job->dims.push_back(tensor.dims());
+    job->buffers.push_back(std::move(buffer));
+    job->nbytes.push_back(nbytes);
+  }
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  for (auto& item : compute_streams) {
+    const int device = item.first;
+    platform::CUDADeviceGuard guard(device);
+    auto copied = platform::CudaEventResourcePool::Instance().New(device);
+    RecordEvent(copied.get(), CopyStream(device));
+    // the work queued later, which may update the tensors in place, waits
+    // for the copies
+    StreamWaitEvent(item.second, copied.get());
+    job->copied.push_back(copied);
+  }
+#endif
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.push_back(std::move(job));
+    ++_num_pending;
+  }
+  _cond.notify_all();
+}
+
+void AsyncCheckpointWriter::Wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cond.wait(lock, [this] { return _num_pending == 0; });
+  if (_error) {
+    auto error = _error;
+    _error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncCheckpointWriter::Run() {
+  while (true) {
+    std::unique_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cond.wait(lock, [this] { return _stop || !_jobs.empty(); });
+      if (_jobs.empty()) {
+        return;
+      }
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+    }
+    try {
+      Write(job.get());
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_error) {
+        _error = std::current_exception();
+      }
+    }
+    // frees the staging memory
+    job.reset();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_num_pending;
+    }
+    _cond.notify_all();
+  }
+}
+
+void AsyncCheckpointWriter::Write(Job* job) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  for (auto& copied : job->copied) {
+    EventSynchronize(copied.get());
+  }
+  job->sources.clear();
+#endif
+  const size_t num_tensors = job->names.size();
+  std::vector<uint64_t> hashes(num_tensors);
+  ParallelRun(num_tensors, _num_threads, [&](size_t i) {
+    hashes[i] = XXH64(job->buffers[i]->ptr(), job->nbytes[i], 0);
+  });
+
+  const std::string dir = DirName(job->path);
+  const std::string file = BaseName(job->path);
+  auto& written = _written[dir];
+  std::vector<IndexEntry> entries(num_tensors);
+  // the pieces of the tensors written to this shard, as (tensor, begin, end)
+  std::vector<std::tuple<size_t, uint64_t, uint64_t>> pieces;
+  uint64_t offset = kMagicSize;
+  for (size_t i = 0; i < num_tensors; ++i) {
+    auto& entry = entries[i];
+    entry.name = job->names[i];
+    entry.dtype = static_cast<int32_t>(job->dtypes[i]);
+    entry.dims = common::vectorize(job->dims[i]);
+    entry.nbytes = job->nbytes[i];
+    entry.hash = hashes[i];
+    auto it = written.find(entry.name);
+    if (job->dedup && it != written.end() && it->second.hash == entry.hash &&
+        it->second.nbytes == entry.nbytes && it->second.file != file) {
+      entry.file = it->second.file;
+      entry.offset = it->second.offset;
+      continue;
+    }
+    entry.offset = offset;
+    for (uint64_t begin = 0; begin < entry.nbytes; begin += kWriteChunkSize) {
+      pieces.emplace_back(
+          i, begin, std::min(begin + kWriteChunkSize, entry.nbytes));
+    }
+    offset += entry.nbytes;
+  }
+  std::string index = EncodeIndex(entries);
+  PutPod<uint64_t>(&index, index.size());
+
+  const std::string tmp_path = job->path + ".tmp";
+  auto piece_data = [&](size_t p) {
+    return static_cast<const char*>(job->buffers[std::get<0>(pieces[p])]
+                                        ->ptr()) +
+           std::get<1>(pieces[p]);
+  };
+  auto piece_size = [&](size_t p) {
+    return std::get<2>(pieces[p]) - std::get<1>(pieces[p]);
+  };
+  if (!dir.empty() && fs_select_internal(job->path) == 0) {
+    MkDirRecursively(dir.c_str());
+  }
+#ifndef _WIN32
+  if (fs_select_internal(job->path) == 0) {
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    PADDLE_ENFORCE_GE(fd,
+                      0,
+                      common::errors::Unavailable(
+                          "Cannot open %s to save the checkpoint: %s.",
+                          tmp_path,
+                          std::strerror(errno)));
+    try {
+      PWriteAll(fd, kMagic, kMagicSize, 0);
+      ParallelRun(pieces.size(), _num_threads, [&](size_t p) {
+        auto& entry = entries[std::get<0>(pieces[p])];
+        PWriteAll(fd,
+                  piece_data(p),
+                  piece_size(p),
+                  entry.offset + std::get<1>(pieces[p]));
+      });
+      PWriteAll(fd, index.data(), index.size(), offset);
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+    PADDLE_ENFORCE_EQ(close(fd),
+                      0,
+                      common::errors::Unavailable(
+                          "Failed to write the checkpoint %s: %s.",
+                          tmp_path,
+                          std::strerror(errno)));
+    PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), job->path.c_str()),
+                      0,
+                      common::errors::Unavailable(
+                          "Cannot move the checkpoint %s to %s: %s.",
+                          tmp_path,
+                          job->path,
+                          std::strerror(errno)));
+  } else {  // NOLINT
+#endif
+    // the pieces are in the order of their offsets, so they are written
+    // one after another
+    int err_no = 0;
+    std::shared_ptr<FILE> fp = fs_open_write(tmp_path, &err_no, "");
+    PADDLE_ENFORCE_EQ(err_no == 0 && fp != nullptr,
+                      true,
+                      common::errors::Unavailable(
+                          "Cannot open %s to save the checkpoint.", tmp_path));
+    auto fwrite_all = [&](const char* data, uint64_t size) {
+      PADDLE_ENFORCE_EQ(
+          fwrite(data, 1, size, fp.get()),
+          size,
+          common::errors::Unavailable("Failed to write the checkpoint %s.",
+                                      tmp_path));
+    };
+    fwrite_all(kMagic, kMagicSize);
+    for (size_t p = 0; p < pieces.size(); ++p) {
+      fwrite_all(piece_data(p), piece_size(p));
+    }
+    fwrite_all(index.data(), index.size());
+    fp.reset();
+    fs_mv(tmp_path, job->path);
+#ifndef _WIN32
+  }
+#endif
+
+  for (auto& entry : entries) {
+    written[entry.name] = {entry.file.empty() ? file : entry.file,
+                           entry.offset,
+                           entry.nbytes,
+                           entry.hash};
+  }
+}
+
+bool IsAsyncCheckpointFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  char magic[kMagicSize];
+  fin.read(magic, kMagicSize);
+  return fin.gcount() == static_cast<std::streamsize>(kMagicSize) &&
+         std::memcmp(magic, kMagic, kMagicSize) == 0;
+}
+
+std::vector<std::pair<std::string, phi::DenseTensor>> LoadAsyncCheckpoint(
+    const std::string& path) {
+  std::ifstream fin(path, std::ios::binary | std::ios::ate);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin),
+      true,
+      common::errors::Unavailable("Cannot open checkpoint %s.", path));
+  const uint64_t file_size = fin.tellg();
+  PADDLE_ENFORCE_EQ(IsAsyncCheckpointFile(path) &&
+                        file_size >= kMagicSize + sizeof(uint64_t),
+                    true,
+                    common::errors::InvalidArgument(
+                        "%s is not an async checkpoint.", path));
+  uint64_t index_size = 0;
+  fin.seekg(file_size - sizeof(uint64_t));
+  fin.read(reinterpret_cast<char*>(&index_size), sizeof(uint64_t));
+  PADDLE_ENFORCE_LE(index_size,
+                    file_size - kMagicSize - sizeof(uint64_t),
+                    common::errors::InvalidArgument(
+                        "The index of checkpoint %s is truncated.", path));
+  std::string index(index_size, '\0');
+  fin.seekg(file_size - sizeof(uint64_t) - index_size);
+  fin.read(&index[0], index_size);
+
+  const std::string dir = DirName(path);
+  std::unordered_map<std::string, std::ifstream> others;
+  std::vector<std::pair<std::string, phi::DenseTensor>> tensors;
+  for (auto& entry : DecodeIndex(index, path)) {
+    phi::DenseTensor tensor;
+    tensor.Resize(common::make_ddim(entry.dims));
+    void* data = tensor.mutable_data(phi::CPUPlace(),
+                                     static_cast<phi::DataType>(entry.dtype));
+    std::ifstream* in = &fin;
+    std::string in_path = path;
+    if (!entry.file.empty()) {
+      in_path = dir.empty() ? entry.file : dir + "/" + entry.file;
+      auto& other = others[entry.file];
+      if (!other.is_open()) {
+        other.open(in_path, std::ios::binary);
+      }
+      in = &other;
+    }
+    in->seekg(entry.offset);
+    in->read(static_cast<char*>(data), entry.nbytes);
+    PADDLE_ENFORCE_EQ(
+        static_cast<bool>(*in),
+        true,
+        common::errors::Unavailable(
+            "Failed to read the tensor %s from %s.", entry.name, in_path));
+    tensors.emplace_back(entry.name, std::move(tensor));
+  }
+  return tensors;
+}
+
+}  // namespace framework
+}  // namespace paddle
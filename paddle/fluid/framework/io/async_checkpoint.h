@@ -0,0 +1,97 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * Writes the checkpoint shards of a rank in the background.
+ *
+ * Save snapshots the tensors and returns at once. A tensor on GPU is copied
+ * to pinned memory on a side stream of its device, after the work queued on
+ * its stream, and a tensor on CPU is copied at once, so the training loop
+ * may update them right away. A worker then hashes the tensors and writes
+ * the shard, splitting the bytes over num_threads threads for a local file,
+ * or through fs_open_write for hdfs: and afs: paths. The shards are written
+ * to a temporary file and moved to their path once complete, in the order
+ * of the saves.
+ *
+ * A shard is
+ *   "PDACKPT1" | the bytes of the tensors | index | index size (uint64)
+ * where the index holds the name, dtype, dims, offset, size and hash of
+ * each tensor. With dedup, a tensor of the same hash and size as in the
+ * last shard this writer wrote to the same directory is not written again,
+ * its entry refers to the shard holding its bytes instead.
+ **/
+class AsyncCheckpointWriter {
+ public:
+  explicit AsyncCheckpointWriter(int num_threads);
+  ~AsyncCheckpointWriter();
+
+  // The tensors should be contiguous.
+  void Save(const std::vector<std::string>& names,
+            const std::vector<phi::DenseTensor>& tensors,
+            const std::string& path,
+            bool dedup);
+  // Waits for the saves queued so far, and throws the error of the first
+  // one failed since the last Wait.
+  void Wait();
+
+  struct Job;
+
+ private:
+  // where the bytes of a tensor were written last
+  struct Written {
+    std::string file;
+    uint64_t offset;
+    uint64_t nbytes;
+    uint64_t hash;
+  };
+
+  void Run();
+  void Write(Job* job);
+
+  int _num_threads;
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::deque<std::unique_ptr<Job>> _jobs;
+  size_t _num_pending = 0;
+  bool _stop = false;
+  std::exception_ptr _error;
+  // of the last shard of each directory, touched by the worker only
+  std::unordered_map<std::string, std::unordered_map<std::string, Written>>
+      _written;
+  std::thread _worker;
+};
+
+bool IsAsyncCheckpointFile(const std::string& path);
+
+// Reads the tensors of a local shard to CPU, in the order they were saved.
+std::vector<std::pair<std::string, phi::DenseTensor>> LoadAsyncCheckpoint(
+    const std::string& path);
+
+}  // namespace framework
+}  // namespace paddle
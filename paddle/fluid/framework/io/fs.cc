@@ -17,8 +17,10 @@ limitations under the License. */
 #include <sys/stat.h>
 
 #include <memory>
+#include <utility>
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/io/hdfs_native.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -56,19 +58,8 @@ static void fs_add_write_converter_internal(std::string& path,  // NOLINT
   }
 }
 
-static std::shared_ptr<FILE> fs_open_internal(const std::string& path,
-                                              bool is_pipe,
-                                              const std::string& mode,
-                                              size_t buffer_size,
-                                              int* err_no = nullptr) {
-  std::shared_ptr<FILE> fp = nullptr;
-
-  if (!is_pipe) {
-    fp = shell_fopen(path, mode);
-  } else {
-    fp = shell_popen(path, mode, err_no);
-  }
-
+static std::shared_ptr<FILE> fs_set_buffer_internal(std::shared_ptr<FILE> fp,
+                                                    size_t buffer_size) {
   if (buffer_size > 0) {
     char* buffer = new char[buffer_size];
     PADDLE_ENFORCE_EQ(
@@ -88,6 +79,22 @@ static std::shared_ptr<FILE> fs_open_internal(const std::string& path,
   return fp;
 }
 
+static std::shared_ptr<FILE> fs_open_internal(const std::string& path,
+                                              bool is_pipe,
+                                              const std::string& mode,
+                                              size_t buffer_size,
+                                              int* err_no = nullptr) {
+  std::shared_ptr<FILE> fp = nullptr;
+
+  if (!is_pipe) {
+    fp = shell_fopen(path, mode);
+  } else {
+    fp = shell_popen(path, mode, err_no);
+  }
+
+  return fs_set_buffer_internal(std::move(fp), buffer_size);
+}
+
 static bool fs_begin_with_internal(const std::string& path,
                                    const std::string& str) {
   return strncmp(path.c_str(), str.c_str(), str.length()) == 0;
@@ -280,6 +287,17 @@ std::shared_ptr<FILE> hdfs_open_read(std::string path,
                                      int* err_no,
                                      const std::string& converter,
                                      bool read_data) {
+  // the native client reads the file without converting it
+  if (download_cmd().empty() &&
+      (converter.empty() || string::trim_spaces(converter) == "cat") &&
+      hdfs_native_available()) {
+    std::shared_ptr<FILE> fp = hdfs_native_open_read(
+        path, read_data ? dataset_hdfs_command() : hdfs_command(), err_no);
+    if (fp != nullptr) {
+      return fs_set_buffer_internal(std::move(fp), hdfs_buffer_size());
+    }
+  }
+
   if (!download_cmd().empty()) {  // use customized download command
     path = string::format_string(
         "%s \"%s\"", download_cmd().c_str(), path.c_str());
@@ -0,0 +1,495 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/hdfs_native.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <dlfcn.h>
+#include <zlib.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
+#include "paddle/utils/string/string_helper.h"
+
+COMMON_DECLARE_bool(hdfs_native_read);
+COMMON_DECLARE_string(hdfs_native_lib);
+COMMON_DECLARE_int32(hdfs_native_read_thread_num);
+COMMON_DECLARE_int64(hdfs_native_read_chunk_size);
+
+namespace paddle {
+namespace framework {
+
+#if defined(_WIN32) || defined(__APPLE__)
+
+bool hdfs_native_available() { return false; }
+
+std::shared_ptr<FILE> hdfs_native_open_read(
+    const std::string& path UNUSED,
+    const std::string& hadoop_command UNUSED,
+    int* err_no UNUSED) {
+  return nullptr;
+}
+
+#else
+
+namespace {
+
+// The part of the C api of hdfs.h used here.
+using hdfsFS = void*;
+using hdfsFile = void*;
+using tOffset = int64_t;
+using tSize = int32_t;
+struct hdfsBuilder;
+struct hdfsFileInfo {
+  int mKind;
+  char* mName;
+  time_t mLastMod;
+  tOffset mSize;
+  int16_t mReplication;
+  tOffset mBlockSize;
+  char* mOwner;
+  char* mGroup;
+  int16_t mPermissions;
+  time_t mLastAccess;
+};
+
+class HdfsLib {
+ public:
+  static HdfsLib* Instance() {
+    static HdfsLib lib(FLAGS_hdfs_native_lib);
+    return &lib;
+  }
+
+  bool loaded() const { return handle_ != nullptr; }
+
+  // Returns the cached connection of the name node, user and configurations,
+  // nullptr if it can not be made.
+  hdfsFS Connect(const std::string& name_node,
+                 const std::string& user,
+                 const std::vector<std::pair<std::string, std::string>>& confs);
+
+  hdfsFile (*open_file)(hdfsFS, const char*, int, int, int16_t, tSize){nullptr};
+  int (*close_file)(hdfsFS, hdfsFile){nullptr};
+  tSize (*pread)(hdfsFS, hdfsFile, tOffset, void*, tSize){nullptr};
+  hdfsFileInfo* (*get_path_info)(hdfsFS, const char*){nullptr};
+  void (*free_file_info)(hdfsFileInfo*, int){nullptr};
+
+ private:
+  explicit HdfsLib(const std::string& lib_path);
+
+  template <typename T>
+  bool Load(T* func, const char* name) {
+    *func = reinterpret_cast<T>(dlsym(handle_, name));
+    if (*func == nullptr) {
+      LOG(WARNING) << "Can not find " << name << " in " << FLAGS_hdfs_native_lib
+                   << ", hdfs files are read by the hadoop command.";
+      return false;
+    }
+    return true;
+  }
+
+  void* handle_{nullptr};
+  hdfsBuilder* (*new_builder_)(){nullptr};
+  void (*builder_set_name_node_)(hdfsBuilder*, const char*){nullptr};
+  void (*builder_set_user_name_)(hdfsBuilder*, const char*){nullptr};
+  int (*builder_conf_set_str_)(hdfsBuilder*, const char*, const char*){nullptr};
+  hdfsFS (*builder_connect_)(hdfsBuilder*){nullptr};
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, hdfsFS> connections_;
+};
+
+HdfsLib::HdfsLib(const std::string& lib_path) {
+  handle_ = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    LOG(WARNING) << "Can not load " << lib_path << ": " << dlerror()
+                 << ", hdfs files are read by the hadoop command.";
+    return;
+  }
+  bool ok = Load(&new_builder_, "hdfsNewBuilder") &&
+            Load(&builder_set_name_node_, "hdfsBuilderSetNameNode") &&
+            Load(&builder_set_user_name_, "hdfsBuilderSetUserName") &&
+            Load(&builder_conf_set_str_, "hdfsBuilderConfSetStr") &&
+            Load(&builder_connect_, "hdfsBuilderConnect") &&
+            Load(&open_file, "hdfsOpenFile") &&
+            Load(&close_file, "hdfsCloseFile") &&
+            Load(&pread, "hdfsPread") &&
+            Load(&get_path_info, "hdfsGetPathInfo") &&
+            Load(&free_file_info, "hdfsFreeFileInfo");
+  if (!ok) {
+    dlclose(handle_);
+    handle_ = nullptr;
+  }
+}
+
+hdfsFS HdfsLib::Connect(
+    const std::string& name_node,
+    const std::string& user,
+    const std::vector<std::pair<std::string, std::string>>& confs) {
+  std::string key = name_node + "\n" + user;
+  for (auto& conf : confs) {
+    key += "\n" + conf.first + "=" + conf.second;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = connections_.find(key);
+  if (it != connections_.end()) {
+    return it->second;
+  }
+  hdfsBuilder* builder = new_builder_();
+  if (builder == nullptr) {
+    return nullptr;
+  }
+  builder_set_name_node_(builder, name_node.c_str());
+  if (!user.empty()) {
+    builder_set_user_name_(builder, user.c_str());
+  }
+  for (auto& conf : confs) {
+    builder_conf_set_str_(builder, conf.first.c_str(), conf.second.c_str());
+  }
+  // the builder is freed by the connect
+  hdfsFS fs = builder_connect_(builder);
+  if (fs == nullptr) {
+    LOG(WARNING) << "Can not connect to " << name_node << " as " << user;
+    return nullptr;
+  }
+  VLOG(1) << "Connected to " << name_node << " as " << user;
+  // the connections are kept until the process exits
+  connections_[key] = fs;
+  return fs;
+}
+
+// Reads a file by chunks fetched by thread_num threads into slot_num
+// buffers, chunk i being in the buffer i % slot_num, so that the threads keep
+// fetching the chunks ahead of the reader.
+class HdfsRangedReader {
+ public:
+  HdfsRangedReader(HdfsLib* lib,
+                   hdfsFS fs,
+                   hdfsFile file,
+                   const std::string& path,
+                   int64_t file_size,
+                   int64_t chunk_size,
+                   int thread_num,
+                   bool gzip)
+      : lib_(lib),
+        fs_(fs),
+        file_(file),
+        path_(path),
+        file_size_(file_size),
+        chunk_size_(chunk_size),
+        chunk_num_((file_size + chunk_size - 1) / chunk_size),
+        gzip_(gzip) {
+    int64_t slot_num = std::min<int64_t>(2L * thread_num, chunk_num_);
+    thread_num = static_cast<int>(std::min<int64_t>(thread_num, slot_num));
+    slots_.resize(slot_num);
+    for (int i = 0; i < thread_num; ++i) {
+      threads_.emplace_back([this]() { FetchLoop(); });
+    }
+    if (gzip_) {
+      memset(&strm_, 0, sizeof(strm_));
+      inflateInit2(&strm_, 16 + MAX_WBITS);
+      gzip_buf_.resize(256 * 1024);
+    }
+  }
+
+  ~HdfsRangedReader() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    fetch_cv_.notify_all();
+    for (auto& t : threads_) {
+      t.join();
+    }
+    lib_->close_file(fs_, file_);
+    if (gzip_) {
+      inflateEnd(&strm_);
+    }
+  }
+
+  bool failed() const { return failed_; }
+
+  ssize_t Read(char* buf, size_t size) {
+    return gzip_ ? ReadGzip(buf, size) : ReadRaw(buf, size);
+  }
+
+ private:
+  struct Slot {
+    bool ready{false};
+    bool failed{false};
+    size_t size{0};
+    std::vector<char> data;
+  };
+
+  void FetchLoop() {
+    int64_t slot_num = static_cast<int64_t>(slots_.size());
+    while (true) {
+      int64_t chunk = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        fetch_cv_.wait(lock, [this, slot_num]() {
+          return stop_ || next_fetch_ >= chunk_num_ ||
+                 next_fetch_ < read_chunk_ + slot_num;
+        });
+        if (stop_ || next_fetch_ >= chunk_num_) {
+          return;
+        }
+        chunk = next_fetch_++;
+      }
+      // the slot is not used by the reader until it is ready
+      Slot& slot = slots_[chunk % slot_num];
+      int64_t offset = chunk * chunk_size_;
+      size_t size =
+          static_cast<size_t>(std::min(chunk_size_, file_size_ - offset));
+      slot.data.resize(size);
+      size_t done = 0;
+      while (done < size) {
+        tSize n = lib_->pread(
+            fs_,
+            file_,
+            offset + static_cast<int64_t>(done),
+            slot.data.data() + done,
+            static_cast<tSize>(std::min<size_t>(size - done, 1UL << 30)));
+        if (n <= 0) {
+          break;
+        }
+        done += n;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.size = done;
+        slot.failed = done != size;
+        slot.ready = true;
+      }
+      ready_cv_.notify_all();
+    }
+  }
+
+  ssize_t ReadRaw(char* buf, size_t size) {
+    int64_t slot_num = static_cast<int64_t>(slots_.size());
+    size_t done = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (done < size && read_chunk_ < chunk_num_) {
+      Slot& slot = slots_[read_chunk_ % slot_num];
+      ready_cv_.wait(lock, [&slot]() { return slot.ready; });
+      if (slot.failed) {
+        LOG(WARNING) << "Read " << path_ << " failed at offset "
+                     << read_chunk_ * chunk_size_ + slot.size;
+        failed_ = true;
+        errno = EIO;
+        return -1;
+      }
+      // the slot is not fetched again until the reader moves to the next
+      lock.unlock();
+      size_t n = std::min(size - done, slot.size - read_pos_);
+      memcpy(buf + done, slot.data.data() + read_pos_, n);
+      done += n;
+      read_pos_ += n;
+      lock.lock();
+      if (read_pos_ == slot.size) {
+        slot.ready = false;
+        read_pos_ = 0;
+        ++read_chunk_;
+        fetch_cv_.notify_all();
+      }
+    }
+    return static_cast<ssize_t>(done);
+  }
+
+  // Decompresses the gzip members of the file one after another, as
+  // "hadoop fs -text" does.
+  ssize_t ReadGzip(char* buf, size_t size) {
+    strm_.next_out = reinterpret_cast<Bytef*>(buf);
+    strm_.avail_out = static_cast<uInt>(size);
+    while (strm_.avail_out > 0) {
+      if (strm_.avail_in == 0 && !raw_eof_) {
+        ssize_t n = ReadRaw(gzip_buf_.data(), gzip_buf_.size());
+        if (n < 0) {
+          return -1;
+        }
+        raw_eof_ = n == 0;
+        strm_.next_in = reinterpret_cast<Bytef*>(gzip_buf_.data());
+        strm_.avail_in = static_cast<uInt>(n);
+      }
+      if (strm_.avail_in == 0) {
+        if (in_member_) {
+          LOG(WARNING) << "Read " << path_ << " failed: truncated gzip file";
+          failed_ = true;
+        }
+        break;
+      }
+      int ret = inflate(&strm_, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) {
+        inflateReset(&strm_);
+        in_member_ = false;
+      } else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+        in_member_ = true;
+      } else {
+        LOG(WARNING) << "Read " << path_ << " failed: broken gzip file, "
+                     << (strm_.msg ? strm_.msg : "");
+        failed_ = true;
+        errno = EIO;
+        return -1;
+      }
+    }
+    return static_cast<ssize_t>(size - strm_.avail_out);
+  }
+
+  HdfsLib* lib_;
+  hdfsFS fs_;
+  hdfsFile file_;
+  std::string path_;
+  int64_t file_size_;
+  int64_t chunk_size_;
+  int64_t chunk_num_;
+
+  std::mutex mutex_;
+  std::condition_variable fetch_cv_;
+  std::condition_variable ready_cv_;
+  std::vector<Slot> slots_;
+  std::vector<std::thread> threads_;
+  int64_t next_fetch_{0};
+  int64_t read_chunk_{0};
+  size_t read_pos_{0};
+  bool stop_{false};
+  bool failed_{false};
+
+  bool gzip_;
+  z_stream strm_;
+  std::vector<char> gzip_buf_;
+  bool raw_eof_{false};
+  bool in_member_{false};
+};
+
+// Gets the name node, the user and the -D configurations of a hadoop
+// command, such as the one set by AfsClient::initialize.
+void ParseHadoopCommand(
+    const std::string& hadoop_command,
+    std::string* name_node,
+    std::string* user,
+    std::vector<std::pair<std::string, std::string>>* confs) {
+  for (auto& token : string::split_string<std::string>(hadoop_command, " ")) {
+    if (token.size() <= 2 || token.compare(0, 2, "-D") != 0) {
+      continue;
+    }
+    size_t pos = token.find('=');
+    if (pos == std::string::npos) {
+      continue;
+    }
+    std::string key = token.substr(2, pos - 2);
+    std::string value = token.substr(pos + 1);
+    if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') &&
+        value.back() == value.front()) {
+      value = value.substr(1, value.size() - 2);
+    }
+    if (key == "fs.default.name" || key == "fs.defaultFS") {
+      *name_node = value;
+    } else if (key == "hadoop.job.ugi") {
+      *user = value.substr(0, value.find(','));
+    }
+    // the ugi is kept in the configurations for the password of afs
+    confs->emplace_back(key, value);
+  }
+}
+
+}  // namespace
+
+bool hdfs_native_available() {
+  return FLAGS_hdfs_native_read && HdfsLib::Instance()->loaded();
+}
+
+std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path,
+                                            const std::string& hadoop_command,
+                                            int* err_no) {
+  if (!hdfs_native_available()) {
+    return nullptr;
+  }
+  HdfsLib* lib = HdfsLib::Instance();
+
+  std::string name_node = "default";
+  std::string user;
+  std::vector<std::pair<std::string, std::string>> confs;
+  ParseHadoopCommand(hadoop_command, &name_node, &user, &confs);
+  size_t scheme_end = path.find("://");
+  if (scheme_end != std::string::npos) {
+    name_node = path.substr(0, path.find('/', scheme_end + 3));
+  }
+
+  hdfsFS fs = lib->Connect(name_node, user, confs);
+  if (fs == nullptr) {
+    return nullptr;
+  }
+  hdfsFileInfo* info = lib->get_path_info(fs, path.c_str());
+  if (info == nullptr) {
+    LOG(WARNING) << "Can not get the info of " << path;
+    return nullptr;
+  }
+  int64_t file_size = info->mSize;
+  lib->free_file_info(info, 1);
+  hdfsFile file = lib->open_file(fs, path.c_str(), O_RDONLY, 0, 0, 0);
+  if (file == nullptr) {
+    LOG(WARNING) << "Can not open " << path;
+    return nullptr;
+  }
+
+  bool gzip = path.size() >= 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+  auto* reader = new HdfsRangedReader(
+      lib,
+      fs,
+      file,
+      path,
+      file_size,
+      std::max<int64_t>(FLAGS_hdfs_native_read_chunk_size, 1),
+      std::max(FLAGS_hdfs_native_read_thread_num, 1),
+      gzip);
+  cookie_io_functions_t io = {};
+  io.read = [](void* cookie, char* buf, size_t size) -> ssize_t {
+    return static_cast<HdfsRangedReader*>(cookie)->Read(buf, size);
+  };
+  // the reader is deleted by the deleter, after the stream is closed
+  io.close = [](void*) -> int { return 0; };
+  FILE* fp = fopencookie(reader, "r", io);
+  if (fp == nullptr) {
+    delete reader;
+    return nullptr;
+  }
+  VLOG(3) << "Opened " << path << " of " << file_size
+          << " bytes by the native hdfs client";
+  return {fp, [reader, err_no](FILE* fp) {
+            fclose(fp);
+            if (reader->failed() && err_no != nullptr) {
+              *err_no = -1;
+            }
+            delete reader;
+          }};
+}
+
+#endif
+
+}  // namespace framework
+}  // namespace paddle
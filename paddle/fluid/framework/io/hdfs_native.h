@@ -0,0 +1,51 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace framework {
+
+// Reads hdfs and afs files through the C api of libhdfs, loaded at runtime
+// from FLAGS_hdfs_native_lib, instead of forking a "hadoop fs -cat" pipe for
+// every file. The api is the one of hdfs.h shared by libhdfs and libhdfs3,
+// so any of them, or an afs sdk exporting it, can be used.
+//
+// A file is read by FLAGS_hdfs_native_read_thread_num threads, each reading
+// a chunk of FLAGS_hdfs_native_read_chunk_size bytes at its offset by
+// hdfsPread, at most two chunks per thread ahead of the reader of the file.
+// The connections are made once per name node, user and configuration and
+// shared by all the files of the process. The ".gz" files are decompressed
+// by zlib.
+
+// Whether FLAGS_hdfs_native_read is set and the library can be loaded.
+bool hdfs_native_available();
+
+// Opens path for reading with the name node, the user and the -D
+// configurations given in hadoop_command, the command the file would be read
+// by otherwise. *err_no is set to -1 when the file is closed if a read
+// failed, as done for the pipes. Returns nullptr if the native client is not
+// available or the file can not be opened, in which case the caller should
+// read the file by the pipe.
+std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path,
+                                            const std::string& hadoop_command,
+                                            int* err_no);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,421 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/io/param_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+#include "paddle/phi/common/port.h"
+#include "paddle/phi/core/memory/memcpy.h"
+#include "paddle/phi/core/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr char kMagic[] = "PDPARAM1";
+constexpr size_t kMagicSize = 8;
+// the bytes a thread copies at a time
+constexpr uint64_t kCopyChunkSize = 16ULL << 20;
+
+uint64_t Align(uint64_t offset) {
+  return (offset + kParamFileAlignment - 1) / kParamFileAlignment *
+         kParamFileAlignment;
+}
+
+template <typename T>
+void PutPod(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::string EncodeIndex(const std::vector<std::string>& names,
+                        const std::vector<const phi::DenseTensor*>& tensors,
+                        const std::vector<uint64_t>& offsets) {
+  std::string out;
+  PutPod<uint64_t>(&out, names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    PutPod<uint64_t>(&out, names[i].size());
+    out.append(names[i]);
+    PutPod<int32_t>(&out, static_cast<int32_t>(tensors[i]->dtype()));
+    auto dims = common::vectorize(tensors[i]->dims());
+    PutPod<uint64_t>(&out, dims.size());
+    for (auto dim : dims) {
+      PutPod<int64_t>(&out, dim);
+    }
+    PutPod<uint64_t>(&out, offsets[i]);
+    PutPod<uint64_t>(
+        &out, tensors[i]->numel() * phi::SizeOf(tensors[i]->dtype()));
+  }
+  return out;
+}
+
+// Copies num bytes between host and place, synchronously.
+void SyncCopy(const phi::Place& dst_place,
+              void* dst,
+              const phi::Place& src_place,
+              const void* src,
+              size_t num) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(dst_place) || phi::is_gpu_place(src_place)) {
+    memory::Copy(dst_place, dst, src_place, src, num, nullptr);
+    return;
+  }
+#endif
+  memory::Copy(dst_place, dst, src_place, src, num);
+}
+
+// Runs func(0), ..., func(num_tasks - 1) on up to num_threads threads, and
+// throws the first error of them.
+template <typename Func>
+void ParallelRun(size_t num_tasks, int num_threads, Func func) {
+  size_t num_workers =
+      std::min(num_tasks, static_cast<size_t>(std::max(num_threads, 1)));
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next(0);
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers);
+  for (size_t t = 0; t < num_workers; ++t) {
+    threads.emplace_back([&] {
+      try {
+        for (size_t i = next++; i < num_tasks; i = next++) {
+          func(i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace
+
+bool IsParamFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  char magic[kMagicSize];
+  fin.read(magic, kMagicSize);
+  return fin.gcount() == static_cast<std::streamsize>(kMagicSize) &&
+         std::memcmp(magic, kMagic, kMagicSize) == 0;
+}
+
+void SaveParamFile(const std::string& path,
+                   const std::vector<std::string>& names,
+                   const std::vector<const phi::DenseTensor*>& tensors) {
+  PADDLE_ENFORCE_EQ(
+      names.size(),
+      tensors.size(),
+      common::errors::InvalidArgument(
+          "The names and tensors of a parameter file should be as many, but "
+          "got %d names and %d tensors.",
+          names.size(),
+          tensors.size()));
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    PADDLE_ENFORCE_EQ(tensors[i] != nullptr && tensors[i]->initialized(),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The tensor %s to save is not initialized.",
+                          names[i]));
+    PADDLE_ENFORCE_EQ(tensors[i]->meta().is_contiguous(),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The tensor %s to save should be contiguous.",
+                          names[i]));
+  }
+  // the index is as long whatever the offsets are
+  std::vector<uint64_t> offsets(tensors.size(), 0);
+  std::string index = EncodeIndex(names, tensors, offsets);
+  uint64_t offset = Align(kMagicSize + sizeof(uint64_t) + index.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    offsets[i] = offset;
+    offset = Align(offset +
+                   tensors[i]->numel() * phi::SizeOf(tensors[i]->dtype()));
+  }
+  index = EncodeIndex(names, tensors, offsets);
+
+  if (!DirName(path).empty()) {
+    MkDirRecursively(DirName(path).c_str());
+  }
+  std::ofstream fout(path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout),
+                    true,
+                    common::errors::Unavailable(
+                        "Cannot open %s to save the parameters.", path));
+  const uint64_t index_size = index.size();
+  fout.write(kMagic, kMagicSize);
+  fout.write(reinterpret_cast<const char*>(&index_size), sizeof(uint64_t));
+  fout.write(index.data(), index.size());
+  std::vector<char> buffer;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = *tensors[i];
+    const uint64_t nbytes = tensor.numel() * phi::SizeOf(tensor.dtype());
+    const std::string padding(offsets[i] - fout.tellp(), '\0');
+    fout.write(padding.data(), padding.size());
+    if (phi::is_cpu_place(tensor.place()) ||
+        phi::is_cuda_pinned_place(tensor.place())) {
+      fout.write(static_cast<const char*>(tensor.data()), nbytes);
+    } else {
+      buffer.resize(nbytes);
+      phi::DeviceContextPool::Instance().Get(tensor.place())->Wait();
+      SyncCopy(phi::CPUPlace(),
+               buffer.data(),
+               tensor.place(),
+               tensor.data(),
+               nbytes);
+      fout.write(buffer.data(), nbytes);
+    }
+  }
+  fout.close();
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fout),
+      true,
+      common::errors::Unavailable("Failed to save the parameters to %s.",
+                                  path));
+}
+
+ParamFileReader::ParamFileReader(const std::string& path) : _path(path) {
+#ifdef _WIN32
+  std::ifstream fin(path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin),
+      true,
+      common::errors::Unavailable("Cannot open parameter file %s.", path));
+  _buffer.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  _data = _buffer.data();
+  _size = _buffer.size();
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_GE(fd,
+                    0,
+                    common::errors::Unavailable(
+                        "Cannot open parameter file %s: %s.",
+                        path,
+                        std::strerror(errno)));
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Cannot stat parameter file %s: %s.", path, std::strerror(errno)));
+  }
+  _size = st.st_size;
+  if (_size > 0) {
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    PADDLE_ENFORCE_NE(data,
+                      MAP_FAILED,
+                      common::errors::Unavailable(
+                          "Cannot map parameter file %s: %s.",
+                          path,
+                          std::strerror(errno)));
+    _data = static_cast<const char*>(data);
+  } else {
+    close(fd);
+  }
+#endif
+  PADDLE_ENFORCE_EQ(_size >= kMagicSize + sizeof(uint64_t) &&
+                        std::memcmp(_data, kMagic, kMagicSize) == 0,
+                    true,
+                    common::errors::InvalidArgument(
+                        "%s is not a parameter file.", path));
+
+  uint64_t pos = kMagicSize;
+  auto read = [&](void* out, uint64_t size) {
+    PADDLE_ENFORCE_LE(pos + size,
+                      _size,
+                      common::errors::InvalidArgument(
+                          "The index of parameter file %s is truncated.",
+                          path));
+    std::memcpy(out, _data + pos, size);
+    pos += size;
+  };
+  auto read_u64 = [&]() {
+    uint64_t value;
+    read(&value, sizeof(uint64_t));
+    return value;
+  };
+  read_u64();  // the index size
+  const uint64_t num_tensors = read_u64();
+  for (uint64_t i = 0; i < num_tensors; ++i) {
+    std::string name(read_u64(), '\0');
+    read(&name[0], name.size());
+    Entry entry;
+    int32_t dtype;
+    read(&dtype, sizeof(int32_t));
+    entry.dtype = static_cast<phi::DataType>(dtype);
+    std::vector<int64_t> dims(read_u64());
+    for (auto& dim : dims) {
+      read(&dim, sizeof(int64_t));
+    }
+    entry.dims = common::make_ddim(dims);
+    entry.offset = read_u64();
+    entry.nbytes = read_u64();
+    PADDLE_ENFORCE_LE(entry.offset + entry.nbytes,
+                      _size,
+                      common::errors::InvalidArgument(
+                          "The tensor %s of parameter file %s is truncated.",
+                          name,
+                          path));
+    _names.push_back(name);
+    _entries[name] = entry;
+  }
+}
+
+ParamFileReader::~ParamFileReader() {
+#ifndef _WIN32
+  if (_data) {
+    munmap(const_cast<char*>(_data), _size);
+  }
+#endif
+}
+
+const ParamFileReader::Entry& ParamFileReader::Get(
+    const std::string& name) const {
+  auto it = _entries.find(name);
+  PADDLE_ENFORCE_NE(it,
+                    _entries.end(),
+                    common::errors::NotFound(
+                        "The tensor %s is not in parameter file %s.",
+                        name,
+                        _path));
+  return it->second;
+}
+
+void ParamFileReader::Read(const std::vector<std::string>& names,
+                           const phi::Place& place,
+                           const std::vector<phi::DenseTensor*>& out,
+                           int num_threads) const {
+  PADDLE_ENFORCE_EQ(names.size(),
+                    out.size(),
+                    common::errors::InvalidArgument(
+                        "The names and tensors to read should be as many, "
+                        "but got %d names and %d tensors.",
+                        names.size(),
+                        out.size()));
+  // the tensors are allocated here, and the chunks of them as
+  // (tensor, begin, end) copied by the threads
+  std::vector<char*> dst(names.size());
+  std::vector<std::tuple<size_t, uint64_t, uint64_t>> chunks;
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto& entry = Get(names[i]);
+    out[i]->Resize(entry.dims);
+    dst[i] = static_cast<char*>(out[i]->mutable_data(place, entry.dtype));
+    for (uint64_t begin = 0; begin < entry.nbytes; begin += kCopyChunkSize) {
+      chunks.emplace_back(
+          i, begin, std::min(begin + kCopyChunkSize, entry.nbytes));
+    }
+  }
+  VLOG(3) << "Read " << names.size() << " tensors of parameter file "
+          << _path << " in " << chunks.size() << " chunks";
+  ParallelRun(chunks.size(), num_threads, [&](size_t c) {
+    size_t i;
+    uint64_t begin, end;
+    std::tie(i, begin, end) = chunks[c];
+    SyncCopy(place,
+             dst[i] + begin,
+             phi::CPUPlace(),
+             _data + Get(names[i]).offset + begin,
+             end - begin);
+  });
+}
+
+void ParamFileReader::ReadSlice(const std::string& name,
+                                int axis,
+                                int64_t begin,
+                                int64_t end,
+                                const phi::Place& place,
+                                phi::DenseTensor* out) const {
+  const auto& entry = Get(name);
+  const int rank = entry.dims.size();
+  PADDLE_ENFORCE_EQ(axis >= 0 && axis < rank,
+                    true,
+                    common::errors::InvalidArgument(
+                        "The axis to slice tensor %s should be in [0, %d), "
+                        "but got %d.",
+                        name,
+                        rank,
+                        axis));
+  PADDLE_ENFORCE_EQ(0 <= begin && begin <= end && end <= entry.dims[axis],
+                    true,
+                    common::errors::InvalidArgument(
+                        "The slice [%d, %d) of tensor %s is out of [0, %d).",
+                        begin,
+                        end,
+                        name,
+                        entry.dims[axis]));
+  int64_t outer = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer *= entry.dims[i];
+  }
+  uint64_t inner = phi::SizeOf(entry.dtype);
+  for (int i = axis + 1; i < rank; ++i) {
+    inner *= entry.dims[i];
+  }
+  auto dims = entry.dims;
+  dims[axis] = end - begin;
+  out->Resize(dims);
+  char* dst = static_cast<char*>(out->mutable_data(place, entry.dtype));
+  const uint64_t row = entry.dims[axis] * inner;
+  const uint64_t slice = (end - begin) * inner;
+  const char* src = _data + entry.offset + begin * inner;
+  if (outer == 1) {
+    SyncCopy(place, dst, phi::CPUPlace(), src, slice);
+    return;
+  }
+  // the slice is gathered on host first, and then copied to place at once
+  std::vector<char> buffer;
+  char* host = dst;
+  if (!phi::is_cpu_place(place)) {
+    buffer.resize(outer * slice);
+    host = buffer.data();
+  }
+  for (int64_t i = 0; i < outer; ++i) {
+    std::memcpy(host + i * slice, src + i * row, slice);
+  }
+  if (host != dst) {
+    SyncCopy(place, dst, phi::CPUPlace(), host, buffer.size());
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
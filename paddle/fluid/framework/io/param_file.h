@@ -0,0 +1,87 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * A parameter file holds the tensors of a model with an index in front:
+ *   "PDPARAM1" | index size (uint64) | index | the bytes of the tensors
+ * where the index holds the name, dtype, dims and offset of each tensor,
+ * and each tensor starts at a multiple of kParamFileAlignment. The file is
+ * mapped by ParamFileReader, so its tensors are read by several threads at
+ * once, and a slice of a tensor is read without the rest of it.
+ **/
+constexpr uint64_t kParamFileAlignment = 4096;
+
+bool IsParamFile(const std::string& path);
+
+void SaveParamFile(const std::string& path,
+                   const std::vector<std::string>& names,
+                   const std::vector<const phi::DenseTensor*>& tensors);
+
+class ParamFileReader {
+ public:
+  struct Entry {
+    phi::DataType dtype;
+    phi::DDim dims;
+    uint64_t offset;
+    uint64_t nbytes;
+  };
+
+  explicit ParamFileReader(const std::string& path);
+  ~ParamFileReader();
+
+  ParamFileReader(const ParamFileReader&) = delete;
+  ParamFileReader& operator=(const ParamFileReader&) = delete;
+
+  // in the order they were saved
+  const std::vector<std::string>& Names() const { return _names; }
+  bool Has(const std::string& name) const { return _entries.count(name) > 0; }
+  const Entry& Get(const std::string& name) const;
+
+  // Reads the tensors of names to place, split over num_threads threads.
+  void Read(const std::vector<std::string>& names,
+            const phi::Place& place,
+            const std::vector<phi::DenseTensor*>& out,
+            int num_threads) const;
+
+  // Reads [begin, end) of a tensor along axis, e.g. the shard of a tensor
+  // parallel rank.
+  void ReadSlice(const std::string& name,
+                 int axis,
+                 int64_t begin,
+                 int64_t end,
+                 const phi::Place& place,
+                 phi::DenseTensor* out) const;
+
+ private:
+  std::string _path;
+  const char* _data = nullptr;
+  uint64_t _size = 0;
+#ifdef _WIN32
+  std::string _buffer;
+#endif
+  std::vector<std::string> _names;
+  std::unordered_map<std::string, Entry> _entries;
+};
+
+}  // namespace framework
+}  // namespace paddle
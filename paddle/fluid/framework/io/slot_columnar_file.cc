@@ -0,0 +1,469 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/slot_columnar_file.h"
+
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x46435350;   // "PSCF"
+constexpr uint32_t kBlockMagic = 0x4b4c4250;  // "PBLK"
+constexpr uint32_t kFileVersion = 1;
+constexpr uint32_t kWithInsIdFlag = 1;
+
+struct BlockHead {
+  uint32_t magic;
+  uint32_t ins_num;
+  uint32_t codec;
+  uint32_t crc;
+  uint64_t raw_size;
+  uint64_t stored_size;
+};
+
+size_t AlignedSize(size_t size) { return (size + 7) / 8 * 8; }
+
+template <typename T>
+void AppendScalar(T value, std::string* buf) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Appends the array and pads the buffer to 8 bytes.
+void AppendArray(const void* data, size_t size, std::string* buf) {
+  buf->append(static_cast<const char*>(data), size);
+  buf->resize(AlignedSize(buf->size()), '\0');
+}
+
+void WriteOrThrow(const void* data, size_t size, FILE* fp) {
+  PADDLE_ENFORCE_EQ(
+      fwrite(data, 1, size, fp),
+      size,
+      common::errors::Unavailable("Failed to write the slot columnar file."));
+}
+
+bool IsValidSlotType(const std::string& type) {
+  return type == "uint64" || type == "float";
+}
+
+}  // namespace
+
+SlotColumnarWriter::SlotColumnarWriter(
+    const std::string& path,
+    const std::vector<SlotColumnarSlot>& slots,
+    bool with_ins_id,
+    int block_ins_num,
+    int compress_level)
+    : slots_(slots),
+      with_ins_id_(with_ins_id),
+      block_ins_num_(block_ins_num),
+      compress_level_(compress_level) {
+  PADDLE_ENFORCE_GT(
+      block_ins_num,
+      0,
+      common::errors::InvalidArgument(
+          "The block_ins_num of the slot columnar file should be positive, "
+          "but received %d.",
+          block_ins_num));
+  PADDLE_ENFORCE_EQ(
+      compress_level >= 0 && compress_level <= 9,
+      true,
+      common::errors::InvalidArgument(
+          "The compress_level of the slot columnar file should be in [0, 9], "
+          "but received %d.",
+          compress_level));
+  slot_value_idx_.resize(slots_.size());
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    PADDLE_ENFORCE_EQ(IsValidSlotType(slots_[i].type),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The type of slot %s should be uint64 or float, but "
+                          "received %s.",
+                          slots_[i].name,
+                          slots_[i].type));
+    slot_value_idx_[i] = static_cast<int>(
+        slots_[i].type[0] == 'u' ? uint64_slot_num_++ : float_slot_num_++);
+  }
+  slot_offsets_.resize(slots_.size());
+  uint64_values_.resize(slots_.size());
+  float_values_.resize(slots_.size());
+  line_uint64_feasigns_.resize(uint64_slot_num_);
+  line_float_feasigns_.resize(float_slot_num_);
+
+  int err_no = 0;
+  fp_ = fs_open_write(path, &err_no, "");
+  PADDLE_ENFORCE_EQ(fp_ != nullptr,
+                    true,
+                    common::errors::Unavailable(
+                        "Failed to open the slot columnar file %s.", path));
+
+  std::string head;
+  AppendScalar(kFileMagic, &head);
+  AppendScalar(kFileVersion, &head);
+  AppendScalar(with_ins_id_ ? kWithInsIdFlag : 0U, &head);
+  AppendScalar(static_cast<uint32_t>(slots_.size()), &head);
+  for (auto& slot : slots_) {
+    AppendScalar(static_cast<uint32_t>(slot.name.size()), &head);
+    head.append(slot.name);
+    AppendScalar(static_cast<uint32_t>(slot.type.size()), &head);
+    head.append(slot.type);
+  }
+  WriteOrThrow(head.data(), head.size(), fp_.get());
+}
+
+SlotColumnarWriter::~SlotColumnarWriter() {
+  if (fp_ != nullptr) {
+    Close();
+  }
+}
+
+void SlotColumnarWriter::AddInstance(
+    const std::string& ins_id,
+    const std::vector<std::vector<uint64_t>>& uint64_feasigns,
+    const std::vector<std::vector<float>>& float_feasigns) {
+  PADDLE_ENFORCE_NOT_NULL(fp_,
+                          common::errors::PreconditionNotMet(
+                              "The slot columnar file has been closed."));
+  PADDLE_ENFORCE_EQ(uint64_feasigns.size() == uint64_slot_num_ &&
+                        float_feasigns.size() == float_slot_num_,
+                    true,
+                    common::errors::InvalidArgument(
+                        "The instance should have %d uint64 slots and %d "
+                        "float slots, but received %d and %d.",
+                        uint64_slot_num_,
+                        float_slot_num_,
+                        uint64_feasigns.size(),
+                        float_feasigns.size()));
+  if (with_ins_id_) {
+    auto iter = ins_id_to_index_.find(ins_id);
+    if (iter == ins_id_to_index_.end()) {
+      iter = ins_id_to_index_
+                 .emplace(ins_id, static_cast<uint32_t>(ins_id_dict_.size()))
+                 .first;
+      ins_id_dict_.push_back(ins_id);
+    }
+    ins_id_index_.push_back(iter->second);
+  }
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    auto& offsets = slot_offsets_[i];
+    if (offsets.empty()) {
+      offsets.push_back(0);
+    }
+    if (slots_[i].type[0] == 'u') {
+      auto& src = uint64_feasigns[slot_value_idx_[i]];
+      uint64_values_[i].insert(uint64_values_[i].end(), src.begin(), src.end());
+      offsets.push_back(static_cast<uint32_t>(uint64_values_[i].size()));
+    } else {
+      auto& src = float_feasigns[slot_value_idx_[i]];
+      float_values_[i].insert(float_values_[i].end(), src.begin(), src.end());
+      offsets.push_back(static_cast<uint32_t>(float_values_[i].size()));
+    }
+  }
+  ++ins_num_;
+  if (++block_size_ >= block_ins_num_) {
+    FlushBlock();
+  }
+}
+
+bool SlotColumnarWriter::AddTextLine(const char* line) {
+  const char* str = line;
+  char* endptr = nullptr;
+  std::string ins_id;
+  if (with_ins_id_) {
+    int64_t num = strtoll(str, &endptr, 10);
+    if (num != 1 || *endptr != ' ') {
+      return false;
+    }
+    const char* begin = endptr + 1;
+    const char* end = strchr(begin, ' ');
+    if (end == nullptr) {
+      return false;
+    }
+    ins_id.assign(begin, end - begin);
+    str = end;
+  }
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    int64_t num = strtoll(str, &endptr, 10);
+    if (endptr == str || num < 0) {
+      return false;
+    }
+    str = endptr;
+    if (slots_[i].type[0] == 'u') {
+      auto& values = line_uint64_feasigns_[slot_value_idx_[i]];
+      values.clear();
+      for (int64_t j = 0; j < num; ++j) {
+        uint64_t value = strtoull(str, &endptr, 10);
+        if (endptr == str) {
+          return false;
+        }
+        values.push_back(value);
+        str = endptr;
+      }
+    } else {
+      auto& values = line_float_feasigns_[slot_value_idx_[i]];
+      values.clear();
+      for (int64_t j = 0; j < num; ++j) {
+        float value = strtof(str, &endptr);
+        if (endptr == str) {
+          return false;
+        }
+        values.push_back(value);
+        str = endptr;
+      }
+    }
+  }
+  AddInstance(ins_id, line_uint64_feasigns_, line_float_feasigns_);
+  return true;
+}
+
+size_t SlotColumnarWriter::AddTextFile(const std::string& path,
+                                       const std::string& converter) {
+  int err_no = 0;
+  std::shared_ptr<FILE> fp = fs_open_read(path, &err_no, converter, true);
+  PADDLE_ENFORCE_EQ(
+      fp != nullptr,
+      true,
+      common::errors::Unavailable("Failed to open the text file %s.", path));
+  string::LineFileReader reader;
+  size_t ins_num = 0;
+  while (reader.getline(fp.get())) {
+    if (AddTextLine(reader.get())) {
+      ++ins_num;
+    } else {
+      LOG(WARNING) << "skip the broken line of file:[" << path << "], line:["
+                   << reader.get() << "]";
+    }
+  }
+  return ins_num;
+}
+
+void SlotColumnarWriter::FlushBlock() {
+  if (block_size_ == 0) {
+    return;
+  }
+  std::string payload;
+  if (with_ins_id_) {
+    std::vector<uint32_t> dict_offsets(1, 0);
+    std::string dict_chars;
+    for (auto& ins_id : ins_id_dict_) {
+      dict_chars.append(ins_id);
+      dict_offsets.push_back(static_cast<uint32_t>(dict_chars.size()));
+    }
+    uint32_t dict_size = static_cast<uint32_t>(ins_id_dict_.size());
+    AppendArray(&dict_size, sizeof(dict_size), &payload);
+    AppendArray(ins_id_index_.data(),
+                ins_id_index_.size() * sizeof(uint32_t),
+                &payload);
+    AppendArray(
+        dict_offsets.data(), dict_offsets.size() * sizeof(uint32_t), &payload);
+    AppendArray(dict_chars.data(), dict_chars.size(), &payload);
+  }
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    auto& offsets = slot_offsets_[i];
+    AppendArray(offsets.data(), offsets.size() * sizeof(uint32_t), &payload);
+    if (slots_[i].type[0] == 'u') {
+      AppendArray(uint64_values_[i].data(),
+                  uint64_values_[i].size() * sizeof(uint64_t),
+                  &payload);
+    } else {
+      AppendArray(float_values_[i].data(),
+                  float_values_[i].size() * sizeof(float),
+                  &payload);
+    }
+    offsets.clear();
+    uint64_values_[i].clear();
+    float_values_[i].clear();
+  }
+
+  BlockHead head;
+  head.magic = kBlockMagic;
+  head.ins_num = static_cast<uint32_t>(block_size_);
+  head.codec = static_cast<uint32_t>(SlotColumnarCodec::kNone);
+  head.crc = static_cast<uint32_t>(
+      crc32(0L, reinterpret_cast<const Bytef*>(payload.data()), payload.size()));
+  head.raw_size = payload.size();
+  head.stored_size = payload.size();
+
+  std::string compressed;
+  if (compress_level_ > 0) {
+    uLongf size = compressBound(payload.size());
+    compressed.resize(size);
+    if (compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                  &size,
+                  reinterpret_cast<const Bytef*>(payload.data()),
+                  payload.size(),
+                  compress_level_) == Z_OK &&
+        size < payload.size()) {
+      head.codec = static_cast<uint32_t>(SlotColumnarCodec::kZlib);
+      head.stored_size = size;
+    }
+  }
+  WriteOrThrow(&head, sizeof(head), fp_.get());
+  WriteOrThrow(head.codec == static_cast<uint32_t>(SlotColumnarCodec::kZlib)
+                   ? compressed.data()
+                   : payload.data(),
+               head.stored_size,
+               fp_.get());
+
+  ins_id_index_.clear();
+  ins_id_dict_.clear();
+  ins_id_to_index_.clear();
+  block_size_ = 0;
+}
+
+void SlotColumnarWriter::Close() {
+  FlushBlock();
+  fp_.reset();
+}
+
+SlotColumnarReader::SlotColumnarReader(std::shared_ptr<FILE> fp)
+    : fp_(std::move(fp)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      fp_,
+      common::errors::InvalidArgument(
+          "The file of the slot columnar reader should not be null."));
+  uint32_t head[4];
+  Read(head, sizeof(head));
+  PADDLE_ENFORCE_EQ(head[0],
+                    kFileMagic,
+                    common::errors::InvalidArgument(
+                        "The file is not a slot columnar file, please check "
+                        "the data_format of the dataset."));
+  PADDLE_ENFORCE_EQ(head[1],
+                    kFileVersion,
+                    common::errors::InvalidArgument(
+                        "The slot columnar file of version %d is not "
+                        "supported, expected version %d.",
+                        head[1],
+                        kFileVersion));
+  with_ins_id_ = (head[2] & kWithInsIdFlag) != 0;
+  slots_.resize(head[3]);
+  for (auto& slot : slots_) {
+    uint32_t size = 0;
+    Read(&size, sizeof(size));
+    slot.name.resize(size);
+    Read(&slot.name[0], size);
+    Read(&size, sizeof(size));
+    slot.type.resize(size);
+    Read(&slot.type[0], size);
+    PADDLE_ENFORCE_EQ(IsValidSlotType(slot.type),
+                      true,
+                      common::errors::InvalidArgument(
+                          "The type of slot %s in the slot columnar file "
+                          "should be uint64 or float, but received %s.",
+                          slot.name,
+                          slot.type));
+  }
+  columns_.resize(slots_.size());
+}
+
+void SlotColumnarReader::Read(void* buf, size_t size) {
+  PADDLE_ENFORCE_EQ(
+      fread(buf, 1, size, fp_.get()),
+      size,
+      common::errors::InvalidArgument("The slot columnar file is truncated."));
+}
+
+bool SlotColumnarReader::NextBlock() {
+  BlockHead head;
+  size_t size = fread(&head, 1, sizeof(head), fp_.get());
+  if (size == 0 && feof(fp_.get())) {
+    ins_num_ = 0;
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(
+      size == sizeof(head) && head.magic == kBlockMagic,
+      true,
+      common::errors::InvalidArgument(
+          "The block head of the slot columnar file is broken."));
+
+  payload_.resize(AlignedSize(head.raw_size) / sizeof(uint64_t));
+  Bytef* payload = reinterpret_cast<Bytef*>(payload_.data());
+  if (head.codec == static_cast<uint32_t>(SlotColumnarCodec::kZlib)) {
+    stored_.resize(head.stored_size);
+    Read(stored_.data(), head.stored_size);
+    uLongf raw_size = head.raw_size;
+    PADDLE_ENFORCE_EQ(
+        uncompress(payload,
+                   &raw_size,
+                   reinterpret_cast<const Bytef*>(stored_.data()),
+                   head.stored_size) == Z_OK &&
+            raw_size == head.raw_size,
+        true,
+        common::errors::InvalidArgument(
+            "Failed to decompress the block of the slot columnar file."));
+  } else {
+    PADDLE_ENFORCE_EQ(
+        head.codec == static_cast<uint32_t>(SlotColumnarCodec::kNone) &&
+            head.stored_size == head.raw_size,
+        true,
+        common::errors::InvalidArgument(
+            "The codec %d of the slot columnar file is not supported.",
+            head.codec));
+    Read(payload, head.raw_size);
+  }
+  PADDLE_ENFORCE_EQ(crc32(0L, payload, head.raw_size),
+                    head.crc,
+                    common::errors::InvalidArgument(
+                        "The crc of the block of the slot columnar file does "
+                        "not match, the file is broken."));
+  ins_num_ = head.ins_num;
+  ParsePayload(head.raw_size);
+  return true;
+}
+
+void SlotColumnarReader::ParsePayload(size_t size) {
+  const char* base = reinterpret_cast<const char*>(payload_.data());
+  size_t pos = 0;
+  auto take = [&](size_t bytes) {
+    PADDLE_ENFORCE_LE(pos + bytes,
+                      size,
+                      common::errors::InvalidArgument(
+                          "The block of the slot columnar file is broken."));
+    const char* ptr = base + pos;
+    pos += AlignedSize(bytes);
+    return ptr;
+  };
+
+  if (with_ins_id_) {
+    uint32_t dict_size = 0;
+    std::memcpy(&dict_size, take(sizeof(uint32_t)), sizeof(uint32_t));
+    ins_id_dict_size_ = dict_size;
+    ins_id_index_ =
+        reinterpret_cast<const uint32_t*>(take(ins_num_ * sizeof(uint32_t)));
+    ins_id_dict_offsets_ = reinterpret_cast<const uint32_t*>(
+        take((ins_id_dict_size_ + 1) * sizeof(uint32_t)));
+    ins_id_chars_ = take(ins_id_dict_offsets_[ins_id_dict_size_]);
+  }
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    auto& column = columns_[i];
+    column.offsets = reinterpret_cast<const uint32_t*>(
+        take((ins_num_ + 1) * sizeof(uint32_t)));
+    size_t value_size =
+        slots_[i].type[0] == 'u' ? sizeof(uint64_t) : sizeof(float);
+    column.values = take(column.offsets[ins_num_] * value_size);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
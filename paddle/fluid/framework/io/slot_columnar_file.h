@@ -0,0 +1,181 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/macros.h"
+
+namespace paddle {
+namespace framework {
+
+// A binary file of slot instances stored by column, so that the instances
+// can be loaded without parsing text.
+//
+// The file starts with a header holding the name and the type of every slot
+// and whether the instances have an ins_id, followed by blocks of at most
+// block_ins_num instances until the end of the file. Every block has a fixed
+// size head giving the number of instances, the codec and the size of its
+// payload, the payload being compressed by zlib if the codec is kZlib. The
+// uncompressed payload holds, in order, the ins_ids of the block encoded by a
+// dictionary of the distinct ids, then for every slot in the order of the
+// header the offsets of its values for each instance followed by the values.
+// Every array is aligned to 8 bytes in the payload. All the integers and the
+// values are in the byte order of the host, which is little endian on every
+// platform the dataset runs on.
+struct SlotColumnarSlot {
+  std::string name;
+  // "uint64" or "float", as in the data feed desc
+  std::string type;
+};
+
+enum class SlotColumnarCodec : uint32_t { kNone = 0, kZlib = 1 };
+
+class SlotColumnarWriter final {
+ public:
+  // compress_level is the zlib level from 1 to 9, 0 writes all the blocks
+  // uncompressed.
+  SlotColumnarWriter(const std::string& path,
+                     const std::vector<SlotColumnarSlot>& slots,
+                     bool with_ins_id,
+                     int block_ins_num = 4096,
+                     int compress_level = 1);
+
+  ~SlotColumnarWriter();
+
+  // uint64_feasigns and float_feasigns hold the values of the uint64 slots
+  // and of the float slots respectively, each in the order of the slots.
+  void AddInstance(const std::string& ins_id,
+                   const std::vector<std::vector<uint64_t>>& uint64_feasigns,
+                   const std::vector<std::vector<float>>& float_feasigns);
+
+  // Adds an instance in the text format read by SlotRecordInMemoryDataFeed,
+  // "1 <ins_id> " if the file has an ins_id, then "<num> <value>..." for
+  // every slot. Returns false if the line is broken.
+  bool AddTextLine(const std::string& line) {
+    return AddTextLine(line.c_str());
+  }
+  bool AddTextLine(const char* line);
+
+  // Adds every line of a text file opened by fs_open_read with converter,
+  // the broken lines are skipped with a warning. Returns the number of the
+  // added instances.
+  size_t AddTextFile(const std::string& path, const std::string& converter);
+
+  // Writes the pending instances and closes the file, called by the
+  // destructor if not called before.
+  void Close();
+
+  size_t ins_num() const { return ins_num_; }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(SlotColumnarWriter);
+
+  void FlushBlock();
+
+  std::shared_ptr<FILE> fp_;
+  std::vector<SlotColumnarSlot> slots_;
+  // index of every slot among the slots of the same type
+  std::vector<int> slot_value_idx_;
+  size_t uint64_slot_num_{0};
+  size_t float_slot_num_{0};
+  bool with_ins_id_;
+  int block_ins_num_;
+  int compress_level_;
+  size_t ins_num_{0};
+
+  // the instances of the pending block
+  std::vector<uint32_t> ins_id_index_;
+  std::vector<std::string> ins_id_dict_;
+  std::unordered_map<std::string, uint32_t> ins_id_to_index_;
+  std::vector<std::vector<uint32_t>> slot_offsets_;
+  std::vector<std::vector<uint64_t>> uint64_values_;
+  std::vector<std::vector<float>> float_values_;
+  int block_size_{0};
+
+  std::vector<std::vector<uint64_t>> line_uint64_feasigns_;
+  std::vector<std::vector<float>> line_float_feasigns_;
+};
+
+// Reads the blocks of a file written by SlotColumnarWriter. The arrays of a
+// block point into the payload buffer of the reader and stay valid until the
+// next block is read.
+class SlotColumnarReader final {
+ public:
+  explicit SlotColumnarReader(std::shared_ptr<FILE> fp);
+
+  const std::vector<SlotColumnarSlot>& slots() const { return slots_; }
+  bool with_ins_id() const { return with_ins_id_; }
+
+  // Returns false at the end of the file.
+  bool NextBlock();
+
+  size_t ins_num() const { return ins_num_; }
+
+  // The ins_id of instance i is the dictionary entry ins_id_index(i).
+  uint32_t ins_id_index(size_t i) const { return ins_id_index_[i]; }
+  size_t ins_id_dict_size() const { return ins_id_dict_size_; }
+  std::string ins_id_dict_entry(uint32_t index) const {
+    return std::string(ins_id_chars_ + ins_id_dict_offsets_[index],
+                       ins_id_dict_offsets_[index + 1] -
+                           ins_id_dict_offsets_[index]);
+  }
+
+  // ins_num() + 1 offsets, the values of instance i in the slot are the
+  // range [offsets[i], offsets[i + 1]).
+  const uint32_t* slot_offsets(size_t slot) const {
+    return columns_[slot].offsets;
+  }
+  const uint64_t* uint64_values(size_t slot) const {
+    return static_cast<const uint64_t*>(columns_[slot].values);
+  }
+  const float* float_values(size_t slot) const {
+    return static_cast<const float*>(columns_[slot].values);
+  }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(SlotColumnarReader);
+
+  struct Column {
+    const uint32_t* offsets;
+    const void* values;
+  };
+
+  void Read(void* buf, size_t size);
+  void ParsePayload(size_t size);
+
+  std::shared_ptr<FILE> fp_;
+  std::vector<SlotColumnarSlot> slots_;
+  bool with_ins_id_{false};
+
+  size_t ins_num_{0};
+  // uint64_t to keep the arrays in the payload aligned
+  std::vector<uint64_t> payload_;
+  std::vector<char> stored_;
+  const uint32_t* ins_id_index_{nullptr};
+  size_t ins_id_dict_size_{0};
+  const uint32_t* ins_id_dict_offsets_{nullptr};
+  const char* ins_id_chars_{nullptr};
+  std::vector<Column> columns_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -37,12 +37,13 @@ bool PhiKernelSupportPrecision(
     phi::Backend backend,
     phi::DataType data_type,
     phi::DataLayout layout = phi::DataLayout::ALL_LAYOUT) {
-  const auto& kernels = phi::KernelFactory::Instance().kernels();
+  const phi::KernelFactory& kernel_factory = phi::KernelFactory::Instance();
+  const auto& kernels = kernel_factory.kernels();
   if (kernels.count(op_type) == 0) {
     return false;
   }
   phi::KernelKey kernel_key(backend, layout, data_type);
-  return phi::KernelFactory::Instance().HasKernel(op_type, kernel_key);
+  return kernel_factory.HasKernel(op_type, kernel_key);
 }
 
 static phi::Backend ConvertPlaceToBackend(const phi::Place& place) {
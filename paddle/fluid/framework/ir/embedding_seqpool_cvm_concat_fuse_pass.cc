@@ -0,0 +1,180 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/op_version_registry.h"
+
+namespace paddle::framework::ir {
+
+class Graph;
+class Node;
+
+namespace {
+struct LookupTableNodes {
+  Node* ids = nullptr;
+  Node* w = nullptr;
+  Node* lookup_table = nullptr;
+  Node* out = nullptr;
+};
+
+int64_t GetPaddingIdx(const Node* lookup_table) {
+  const auto* op = lookup_table->Op();
+  return op->HasAttr("padding_idx")
+             ? PADDLE_GET_CONST(int64_t, op->GetAttr("padding_idx"))
+             : -1;
+}
+
+bool IsLocalLookupTable(Node* lookup_table) {
+  const auto* op = lookup_table->Op();
+  for (const char* attr : {"is_distributed", "remote_prefetch"}) {
+    if (op->HasAttr(attr) && PADDLE_GET_CONST(bool, op->GetAttr(attr))) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // anonymous namespace
+
+void EmbeddingSeqPoolCVMConcatFusePass::ApplyImpl(ir::Graph* graph) const {
+  FusePassBase::Init(name_scope_, graph);
+  const std::unordered_set<std::string> lookup_types(
+      {"lookup_table", "lookup_table_v2"});
+
+  GraphPatternDetector gpd;
+  auto* pattern = gpd.mutable_pattern();
+  PDNode* ids_var_node = pattern->NewNode("ids_var")
+                             ->assert_is_ops_input(lookup_types, "Ids")
+                             ->assert_var_dtype(proto::VarType::INT64);
+  PDNode* w_var_node = pattern->NewNode("w_var")
+                           ->assert_is_ops_input(lookup_types, "W")
+                           ->assert_is_persistable_var();
+  PDNode* lookup_op_node = pattern->NewNode("lookup_table_op")
+                               ->assert_is_ops(lookup_types)
+                               ->assert_more(IsLocalLookupTable);
+  PDNode* lookup_out_var_node =
+      pattern->NewNode("lookup_table_out_var")
+          ->assert_is_ops_output(lookup_types, "Out")
+          ->assert_is_op_input("fusion_seqpool_cvm_concat", "X")
+          ->assert_has_n_outputs(1)
+          ->AsIntermediate();
+  PDNode* fusion_op_node =
+      pattern->NewNode("fusion_op")->assert_is_op("fusion_seqpool_cvm_concat");
+  lookup_op_node->LinksFrom({ids_var_node, w_var_node})
+      .LinksTo({lookup_out_var_node});
+  fusion_op_node->LinksFrom({lookup_out_var_node});
+
+  // the LookupTables before every FusionSeqPoolCVMConcat, by their outputs
+  std::unordered_map<Node*, std::unordered_map<std::string, LookupTableNodes>>
+      fusion_ops;
+  std::vector<Node*> fusion_op_order;
+  GraphPatternDetector::handle_t handler =
+      [&](const GraphPatternDetector::subgraph_t& subgraph, Graph* graph) {
+        LookupTableNodes nodes;
+        nodes.ids = subgraph.at(ids_var_node);
+        nodes.w = subgraph.at(w_var_node);
+        nodes.lookup_table = subgraph.at(lookup_op_node);
+        nodes.out = subgraph.at(lookup_out_var_node);
+        Node* fusion_op = subgraph.at(fusion_op_node);
+        if (fusion_ops.count(fusion_op) == 0) {
+          fusion_op_order.push_back(fusion_op);
+        }
+        fusion_ops[fusion_op][nodes.out->Name()] = nodes;
+      };
+  gpd(graph, handler);
+
+  int count = 0;
+  for (auto* fusion_op : fusion_op_order) {
+    const auto& lookup_tables = fusion_ops.at(fusion_op);
+    const auto& x_names = fusion_op->Op()->Input("X");
+    // all the inputs should be looked up from the same table
+    bool can_fuse = true;
+    const LookupTableNodes* first = nullptr;
+    for (const auto& x_name : x_names) {
+      auto iter = lookup_tables.find(x_name);
+      if (iter == lookup_tables.end()) {
+        can_fuse = false;
+        break;
+      }
+      if (first == nullptr) {
+        first = &iter->second;
+      } else if (iter->second.w != first->w ||
+                 GetPaddingIdx(iter->second.lookup_table) !=
+                     GetPaddingIdx(first->lookup_table)) {
+        can_fuse = false;
+        break;
+      }
+    }
+    if (!can_fuse || first == nullptr) {
+      continue;
+    }
+
+    std::vector<std::string> ids_names;
+    std::unordered_set<Node*> ids_nodes;
+    std::unordered_set<const Node*> marked_nodes({fusion_op});
+    for (const auto& x_name : x_names) {
+      const auto& nodes = lookup_tables.at(x_name);
+      ids_names.push_back(nodes.ids->Name());
+      ids_nodes.insert(nodes.ids);
+      marked_nodes.insert(nodes.lookup_table);
+      marked_nodes.insert(nodes.out);
+    }
+
+    auto* fusion_desc = fusion_op->Op();
+    OpDesc op_desc;
+    op_desc.SetType("fusion_emb_seqpool_cvm_concat");
+    op_desc.SetInput("Ids", ids_names);
+    op_desc.SetInput("W", {first->w->Name()});
+    op_desc.SetInput("CVM", fusion_desc->Input("CVM"));
+    op_desc.SetAttr("pooltype", fusion_desc->GetAttr("pooltype"));
+    op_desc.SetAttr("use_cvm", fusion_desc->GetAttr("use_cvm"));
+    op_desc.SetAttr("axis", fusion_desc->GetAttr("axis"));
+    op_desc.SetAttr("padding_idx", GetPaddingIdx(first->lookup_table));
+    op_desc.SetOutput("Out", fusion_desc->Output("Out"));
+    auto* op = graph->CreateOpNode(&op_desc);
+
+    for (auto* ids : ids_nodes) {
+      IR_NODE_LINK_TO(ids, op);
+    }
+    IR_NODE_LINK_TO(first->w, op);
+    for (auto* in : fusion_op->inputs) {
+      if (in->Name() == fusion_desc->Input("CVM")[0]) {
+        IR_NODE_LINK_TO(in, op);
+      }
+    }
+    for (auto* out : fusion_op->outputs) {
+      IR_NODE_LINK_TO(op, out);
+    }
+
+    GraphSafeRemoveNodes(graph, marked_nodes);
+    count++;
+  }
+  AddStatis(count);
+}
+
+}  // namespace paddle::framework::ir
+
+REGISTER_PASS(embedding_seqpool_cvm_concat_fuse_pass,
+              paddle::framework::ir::EmbeddingSeqPoolCVMConcatFusePass);
+REGISTER_PASS_CAPABILITY(embedding_seqpool_cvm_concat_fuse_pass)
+    .AddCombination(
+        paddle::framework::compatible::OpVersionComparatorCombination()
+            .EQ("lookup_table", 0)
+            .LE("lookup_table_v2", 1));
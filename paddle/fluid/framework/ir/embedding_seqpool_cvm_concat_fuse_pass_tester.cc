@@ -0,0 +1,154 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle::framework::ir {
+
+void SetOp(ProgramDesc* prog,
+           const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "lookup_table") {
+    op->SetInput("Ids", {inputs[0]});
+    op->SetInput("W", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("padding_idx", static_cast<int64_t>(-1));
+    op->SetAttr("is_distributed", false);
+    op->SetAttr("remote_prefetch", false);
+  } else if (type == "sequence_pool") {
+    op->SetInput("X", {inputs[0]});
+    std::string pooltype = "SUM";
+    op->SetAttr("pooltype", pooltype);
+    op->SetOutput("MaxIndex", {outputs[0]});
+    op->SetOutput("Out", {outputs[1]});
+  } else if (type == "concat") {
+    op->SetInput("X", inputs);
+    op->SetAttr("axis", 1);
+    op->SetOutput("Out", {outputs[0]});
+  } else if (type == "cvm") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("CVM", {inputs[1]});
+    op->SetOutput("Y", {outputs[0]});
+    op->SetAttr("use_cvm", true);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+int CountOpType(const ir::Graph* graph, const std::string& op_type) {
+  int count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == op_type) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::unique_ptr<ir::Graph> ApplyPasses(std::unique_ptr<ir::Graph> graph) {
+  for (const char* pass_type : {"seqpool_cvm_concat_fuse_pass",
+                                "embedding_seqpool_cvm_concat_fuse_pass"}) {
+    auto pass = PassRegistry::Instance().Get(pass_type);
+    graph.reset(pass->Apply(graph.release()));
+  }
+  return graph;
+}
+
+// Builds lookup_table -> sequence_pool -> cvm for every ids and W, and concats
+// them into "out".
+ProgramDesc BuildProgram(const std::vector<std::string>& ids,
+                         const std::vector<std::string>& ws) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  block->Var("cvm_in")->SetType(proto::VarType::LOD_TENSOR);
+  block->Var("out")->SetType(proto::VarType::LOD_TENSOR);
+  std::vector<std::string> concat_ins;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto* ids_var = block->Var(ids[i]);
+    ids_var->SetType(proto::VarType::LOD_TENSOR);
+    ids_var->SetDataType(proto::VarType::INT64);
+    auto* w_var = block->Var(ws[i]);
+    w_var->SetType(proto::VarType::LOD_TENSOR);
+    w_var->SetPersistable(true);
+    std::string suffix = std::to_string(i);
+    for (const auto& name : {"emb", "idx", "pool", "cvm"}) {
+      block->Var(name + suffix)->SetType(proto::VarType::LOD_TENSOR);
+    }
+    SetOp(&prog, "lookup_table", {ids[i], ws[i]}, {"emb" + suffix});
+    SetOp(&prog,
+          "sequence_pool",
+          {"emb" + suffix},
+          {"idx" + suffix, "pool" + suffix});
+    SetOp(&prog, "cvm", {"pool" + suffix, "cvm_in"}, {"cvm" + suffix});
+    concat_ins.push_back("cvm" + suffix);
+  }
+  SetOp(&prog, "concat", concat_ins, {"out"});
+  return prog;
+}
+
+/*
+ * Before fuse:
+ *    a   w      b   w      c   w
+ *     \ /        \ /        \ /
+ *   lookup_table, lookup_table, lookup_table
+ *      |            |            |
+ *   seq_pool     seq_pool     seq_pool
+ *      |            |            |
+ *     cvm          cvm          cvm
+ *       \           |           /
+ *                 concat
+ *                   |
+ *                  out
+ *
+ * After fuse:
+ *    a    b    c    w    cvm_in
+ *     \   |    |    |    /
+ *  fusion_emb_seqpool_cvm_concat
+ *               |
+ *              out
+ */
+TEST(EmbeddingSeqPoolCVMConcatFusePass, basic) {
+  ProgramDesc prog = BuildProgram({"a", "b", "c"}, {"w", "w", "w"});
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph = ApplyPasses(std::move(graph));
+  EXPECT_EQ(CountOpType(graph.get(), "fusion_emb_seqpool_cvm_concat"), 1);
+  EXPECT_EQ(CountOpType(graph.get(), "fusion_seqpool_cvm_concat"), 0);
+  EXPECT_EQ(CountOpType(graph.get(), "lookup_table"), 0);
+  // a, b, c, w, cvm_in, out and the fused op
+  EXPECT_EQ(graph->Nodes().size(), 7UL);
+}
+
+// The lookup_tables of different tables are not fused.
+TEST(EmbeddingSeqPoolCVMConcatFusePass, different_tables) {
+  ProgramDesc prog = BuildProgram({"a", "b"}, {"w0", "w1"});
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph = ApplyPasses(std::move(graph));
+  EXPECT_EQ(CountOpType(graph.get(), "fusion_emb_seqpool_cvm_concat"), 0);
+  EXPECT_EQ(CountOpType(graph.get(), "fusion_seqpool_cvm_concat"), 1);
+  EXPECT_EQ(CountOpType(graph.get(), "lookup_table"), 2);
+}
+
+}  // namespace paddle::framework::ir
+
+USE_PASS(seqpool_cvm_concat_fuse_pass);
+USE_PASS(embedding_seqpool_cvm_concat_fuse_pass);
@@ -0,0 +1,255 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fp8_gemm_quant_pass.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/ir/auto_mixed_precision_pass.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_version_registry.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/float8_e4m3fn.h"
+
+namespace paddle::framework::ir {
+
+namespace {
+
+// the max finite value of float8_e4m3fn
+constexpr float kFp8E4M3Max = 448.0f;
+
+template <typename T>
+float QuantizeWeight(const phi::DenseTensor& weight,
+                     phi::dtype::float8_e4m3fn* out) {
+  const T* data = weight.data<T>();
+  const int64_t numel = weight.numel();
+  float amax = 0.0f;
+  for (int64_t i = 0; i < numel; ++i) {
+    amax = std::max(amax, std::abs(static_cast<float>(data[i])));
+  }
+  const float scale = amax > 0.0f ? amax / kFp8E4M3Max : 1.0f;
+  for (int64_t i = 0; i < numel; ++i) {
+    out[i] = phi::dtype::float8_e4m3fn(static_cast<float>(data[i]) / scale);
+  }
+  return scale;
+}
+
+// Replaces the weight in the scope by its float8_e4m3fn quantization and
+// returns the scale to dequantize it.
+float QuantizeWeightToFp8(phi::DenseTensor* weight) {
+  phi::DenseTensor quantized;
+  quantized.Resize(weight->dims());
+  auto* out =
+      quantized.mutable_data<phi::dtype::float8_e4m3fn>(phi::CPUPlace());
+  float scale = 1.0f;
+  switch (weight->dtype()) {
+    case phi::DataType::FLOAT32:
+      scale = QuantizeWeight<float>(*weight, out);
+      break;
+    case phi::DataType::FLOAT16:
+      scale = QuantizeWeight<phi::dtype::float16>(*weight, out);
+      break;
+    case phi::DataType::BFLOAT16:
+      scale = QuantizeWeight<phi::dtype::bfloat16>(*weight, out);
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "The weight to quantize to fp8 should be of float32, float16 or "
+          "bfloat16, but got %s.",
+          phi::DataTypeToString(weight->dtype())));
+  }
+  *weight = quantized;
+  return scale;
+}
+
+// Inserts x * scale before op_node, and returns the var node of it.
+Node* InsertScaleOp(Graph* graph,
+                    Node* x,
+                    Node* op_node,
+                    float scale,
+                    BlockDesc* block,
+                    int* suffix) {
+  const std::string out_name =
+      x->Name() + "_fp8_scaled.tmp_" + std::to_string((*suffix)++);
+  auto* out_desc = block->Var(out_name);
+  out_desc->SetType(x->Var()->GetType());
+  out_desc->SetPersistable(false);
+  out_desc->SetDataType(x->Var()->GetDataType());
+  out_desc->SetShape(x->Var()->GetShape());
+  out_desc->Flush();
+  auto* out = graph->CreateVarNode(out_desc);
+
+  OpDesc desc(block);
+  desc.SetType("scale");
+  desc.SetInput("X", {x->Name()});
+  desc.SetOutput("Out", {out_name});
+  desc.SetAttr("scale", scale);
+  desc.SetAttr("bias", 0.0f);
+  desc.SetAttr("bias_after_scale", true);
+  desc.Flush();
+  auto* scale_op = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(x, scale_op);
+  IR_NODE_LINK_TO(scale_op, out);
+
+  op_node->Op()->RenameInput(x->Name(), out_name);
+  IR_NODE_UNLINK(x, op_node);
+  IR_NODE_LINK_TO(out, op_node);
+  return out;
+}
+
+Node* FindVarNode(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+void Fp8GemmQuantPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, common::errors::InvalidArgument("Graph cannot be nullptr."));
+  Init("fp8_gemm_quant_pass", graph);
+  auto* scope = param_scope();
+  PADDLE_ENFORCE_NOT_NULL(
+      scope,
+      common::errors::InvalidArgument(
+          "The scope of fp8_gemm_quant_pass should not be nullptr."));
+
+  const std::unordered_map<std::string, std::string> activations = {
+      {"none", "identity"}, {"relu", "relu"}, {"gelu", "gelu"}};
+  std::unordered_map<Node*, Node*> cast_cache;
+  std::unordered_set<const Node*> nodes2rm;
+  int suffix = 0;
+  int found_count = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    auto* op = node->Op();
+    const bool is_matmul = op->Type() == "matmul_v2";
+    if (!is_matmul && op->Type() != "fused_gemm_epilogue") {
+      continue;
+    }
+    if (PADDLE_GET_CONST(bool, op->GetAttr("trans_x"))) {
+      continue;
+    }
+    std::string activation = "identity";
+    if (!is_matmul) {
+      auto it = activations.find(
+          PADDLE_GET_CONST(std::string, op->GetAttr("activation")));
+      if (it == activations.end() || !op->Output("ReserveSpace").empty()) {
+        continue;
+      }
+      activation = it->second;
+    }
+    Node* x = FindVarNode(node->inputs, op->Input("X")[0]);
+    Node* w = FindVarNode(node->inputs, op->Input("Y")[0]);
+    Node* out = FindVarNode(node->outputs, op->Output("Out")[0]);
+    if (x == nullptr || w == nullptr || out == nullptr) {
+      continue;
+    }
+    // the fp8 gemm gives fp16 or bf16 from the fp16 or bf16 activations
+    auto x_dtype = x->Var()->GetDataType();
+    if (x_dtype != proto::VarType::FP16 && x_dtype != proto::VarType::BF16) {
+      continue;
+    }
+    if (x->Var()->GetShape().size() < 2 || !w->Var()->Persistable() ||
+        w->outputs.size() != 1) {
+      continue;
+    }
+    auto* w_var = scope->FindVar(w->Name());
+    if (w_var == nullptr) {
+      continue;
+    }
+    auto* w_tensor = w_var->GetMutable<phi::DenseTensor>();
+    const bool trans_y = PADDLE_GET_CONST(bool, op->GetAttr("trans_y"));
+    if (w_tensor->dims().size() != 2 ||
+        w_tensor->dims()[trans_y ? 1 : 0] % 16 != 0) {
+      continue;
+    }
+    Node* bias = nullptr;
+    if (!is_matmul && !op->Input("Bias").empty()) {
+      bias = FindVarNode(node->inputs, op->Input("Bias")[0]);
+      if (bias == nullptr || bias->Var()->GetDataType() != x_dtype) {
+        continue;
+      }
+    }
+
+    // the activations are scaled by their calibrated absolute max if the
+    // model has one, and cast as they are (saturating) otherwise
+    float x_amax = 0.0f;
+    const std::string x_scale_attr = "Input_scale_" + x->Name();
+    if (op->HasAttr(x_scale_attr)) {
+      x_amax = PADDLE_GET_CONST(float, op->GetAttr(x_scale_attr));
+    }
+
+    const float w_scale = QuantizeWeightToFp8(w_tensor);
+    w->Var()->SetDataType(proto::VarType::FP8_E4M3FN);
+
+    auto* block = op->Block();
+    OpDesc desc(block);
+    desc.SetType("fp8_fp8_half_gemm_fused");
+    desc.SetInput("x", {x->Name()});
+    desc.SetInput("y", {w->Name()});
+    if (bias != nullptr) {
+      desc.SetInput("bias", {bias->Name()});
+    }
+    desc.SetOutput("out", {out->Name()});
+    desc.SetAttr("transpose_x", false);
+    desc.SetAttr("transpose_y", trans_y);
+    desc.SetAttr("scale",
+                 x_amax > 0.0f ? w_scale * x_amax / kFp8E4M3Max : w_scale);
+    desc.SetAttr("output_dtype",
+                 std::string(x_dtype == proto::VarType::FP16 ? "float16"
+                                                             : "bfloat16"));
+    desc.SetAttr("activation_type", activation);
+    auto* gemm = graph->CreateOpNode(&desc);
+    IR_NODE_LINK_TO(x, gemm);
+    IR_NODE_LINK_TO(w, gemm);
+    if (bias != nullptr) {
+      IR_NODE_LINK_TO(bias, gemm);
+    }
+    IR_NODE_LINK_TO(gemm, out);
+    Node* gemm_x = x;
+    if (x_amax > 0.0f) {
+      gemm_x = InsertScaleOp(
+          graph, x, gemm, kFp8E4M3Max / x_amax, block, &suffix);
+    }
+    DoInsertCastOp(graph,
+                   gemm_x,
+                   gemm,
+                   x_dtype,
+                   proto::VarType::FP8_E4M3FN,
+                   block,
+                   &suffix,
+                   &cast_cache);
+    nodes2rm.insert(node);
+    ++found_count;
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+  AddStatis(found_count);
+}
+
+}  // namespace paddle::framework::ir
+
+REGISTER_PASS(fp8_gemm_quant_pass, paddle::framework::ir::Fp8GemmQuantPass);
+REGISTER_PASS_CAPABILITY(fp8_gemm_quant_pass)
+    .AddCombination(
+        paddle::framework::compatible::OpVersionComparatorCombination()
+            .EQ("matmul_v2", 0));
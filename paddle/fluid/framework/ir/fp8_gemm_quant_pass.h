@@ -0,0 +1,47 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Quantizes the 2-D weights of the fp16/bf16 matmul_v2 and
+ * fused_gemm_epilogue to float8_e4m3fn with a per-tensor scale calibrated
+ * from their absolute max, and runs them by fp8_fp8_half_gemm_fused:
+ *
+ *       x     w                cast(x)   w_fp8
+ *        \   /                      \    /
+ *       matmul_v2   --->   fp8_fp8_half_gemm_fused(scale = w_scale)
+ *          |                         |
+ *         out                       out
+ *
+ * The activations are scaled to the fp8 range first if the op has their
+ * calibrated absolute max in "Input_scale_" + x, as the quantized models
+ * have, and the scale of the gemm is w_scale * x_amax / 448 then. Otherwise
+ * they are cast as they are (saturating), which suits the normalized inputs
+ * of the linear layers of transformers.
+ */
+class Fp8GemmQuantPass : public FusePassBase {
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
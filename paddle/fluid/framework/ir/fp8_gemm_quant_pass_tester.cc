@@ -0,0 +1,148 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fp8_gemm_quant_pass.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/phi/common/float8_e4m3fn.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(Fp8GemmQuantPass, basic) {
+  Layers layers;
+  auto* x = layers.data("x", {1, 128, 64}, false, proto::VarType::FP16);
+  auto* weight = layers.data("weight", {64, 32}, true);
+  // k % 16 != 0 is not supported by the fp8 gemm
+  auto* x2 = layers.data("x2", {1, 128, 24}, false, proto::VarType::FP16);
+  auto* weight2 = layers.data("weight2", {24, 32}, true);
+  layers.matmul_v2(x, weight);
+  layers.matmul_v2(x2, weight2);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto* scope = new Scope();
+  auto* w = scope->Var("weight")->GetMutable<phi::DenseTensor>();
+  w->Resize({64, 32});
+  float* w_data = w->mutable_data<float>(phi::CPUPlace());
+  for (int i = 0; i < 64 * 32; ++i) {
+    w_data[i] = static_cast<float>(i % 7 - 3) * 0.5f;
+  }
+  auto* w2 = scope->Var("weight2")->GetMutable<phi::DenseTensor>();
+  w2->Resize({24, 32});
+  w2->mutable_data<float>(phi::CPUPlace());
+  graph->Set("__param_scope__", scope);
+
+  auto pass = PassRegistry::Instance().Get("fp8_gemm_quant_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "fp8_fp8_half_gemm_fused"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "matmul_v2"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "cast"), 1);
+  EXPECT_EQ(w->dtype(), phi::DataType::FLOAT8_E4M3FN);
+  EXPECT_EQ(w2->dtype(), phi::DataType::FLOAT32);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fp8_fp8_half_gemm_fused") {
+      // the amax 1.5 of the weight is scaled to the fp8 max 448
+      const float scale = PADDLE_GET_CONST(float, node->Op()->GetAttr("scale"));
+      EXPECT_FLOAT_EQ(scale, 1.5f / 448.0f);
+      const auto* q = w->data<phi::dtype::float8_e4m3fn>();
+      EXPECT_FLOAT_EQ(static_cast<float>(q[0]) * scale, -1.5f);
+      EXPECT_EQ(PADDLE_GET_CONST(std::string,
+                                 node->Op()->GetAttr("output_dtype")),
+                "float16");
+    }
+  }
+}
+
+// Runs the gemm of the pass on the host as the fp8 kernel does, and compares
+// it with the fp16 gemm of the model.
+TEST(Fp8GemmQuantPass, close_to_fp16_reference) {
+  constexpr int m = 4, k = 32, n = 16;
+  Layers layers;
+  auto* x = layers.data("x", {m, k}, false, proto::VarType::FP16);
+  auto* weight = layers.data("weight", {k, n}, true);
+  layers.matmul_v2(x, weight);
+  // the calibrated absolute max of x, as a quantized model has
+  constexpr float x_amax = 6.0f;
+  for (auto* op : layers.main_program()->MutableBlock(0)->AllOps()) {
+    op->SetAttr("Input_scale_x", x_amax);
+  }
+
+  std::vector<float> x_data(m * k);
+  for (int i = 0; i < m * k; ++i) {
+    x_data[i] = static_cast<float>(phi::dtype::float16(
+        std::sin(static_cast<float>(i)) * x_amax));
+  }
+  std::vector<float> w_data(k * n);
+  for (int i = 0; i < k * n; ++i) {
+    w_data[i] = static_cast<float>(phi::dtype::float16(
+        std::cos(static_cast<float>(i) * 0.7f) * 0.05f));
+  }
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto* scope = new Scope();
+  auto* w = scope->Var("weight")->GetMutable<phi::DenseTensor>();
+  w->Resize({k, n});
+  std::copy(w_data.begin(),
+            w_data.end(),
+            w->mutable_data<float>(phi::CPUPlace()));
+  graph->Set("__param_scope__", scope);
+
+  auto pass = PassRegistry::Instance().Get("fp8_gemm_quant_pass");
+  graph.reset(pass->Apply(graph.release()));
+  ASSERT_EQ(GetNumOpNodes(graph, "fp8_fp8_half_gemm_fused"), 1);
+  ASSERT_EQ(GetNumOpNodes(graph, "scale"), 1);
+
+  float x_scale = 0.0f, gemm_scale = 0.0f;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    if (node->Op()->Type() == "scale") {
+      x_scale = PADDLE_GET_CONST(float, node->Op()->GetAttr("scale"));
+    } else if (node->Op()->Type() == "fp8_fp8_half_gemm_fused") {
+      gemm_scale = PADDLE_GET_CONST(float, node->Op()->GetAttr("scale"));
+    }
+  }
+  EXPECT_FLOAT_EQ(x_scale, 448.0f / x_amax);
+
+  const auto* w_fp8 = w->data<phi::dtype::float8_e4m3fn>();
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      float ref = 0.0f, out = 0.0f, bound = 0.0f;
+      for (int l = 0; l < k; ++l) {
+        ref += x_data[i * k + l] * w_data[l * n + j];
+        bound += std::abs(x_data[i * k + l] * w_data[l * n + j]);
+        const float x_fp8 = static_cast<float>(
+            phi::dtype::float8_e4m3fn(x_data[i * k + l] * x_scale));
+        out += x_fp8 * static_cast<float>(w_fp8[l * n + j]);
+      }
+      out = static_cast<float>(phi::dtype::float16(out * gemm_scale));
+      // e4m3 rounds each operand by at most 2^-4 relatively, which is
+      // rarely reached for all the products of a sum
+      EXPECT_LE(std::abs(out - ref), 0.0625f * bound)
+          << "at (" << i << ", " << j << ")";
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fp8_gemm_quant_pass);
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/naive_executor.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -45,6 +46,14 @@ void NaiveExecutor::Prepare(Scope *scope,
 
   VLOG(3) << "NaiveExecutor init with scope " << scope;
   CreateOps(program_desc, block_id);
+
+  std::vector<std::string> var_names;
+  for (const auto *var : program_desc.Block(block_id).AllVars()) {
+    if (var->Name() != framework::kEmptyVarName) {
+      var_names.push_back(var->Name());
+    }
+  }
+  var_slots_ = VariableSlotTable(*scope_, var_names);
 }
 
 void NaiveExecutor::Prepare(Scope *scope) {
@@ -53,6 +62,7 @@ void NaiveExecutor::Prepare(Scope *scope) {
   } else {
     scope_ = scope;
   }
+  var_slots_.Clear();
 }
 
 void NaiveExecutor::PrepareInterpreterCore(
@@ -103,6 +113,15 @@ void NaiveExecutor::Run() {
             << op->DebugStringEx(scope_) << " on scope " << scope_;
     op->SetIsCalledByExecutor(false);
 
+    if (workspace_cache_.count(op.get())) {
+      for (auto &it : workspace_cache_[op.get()]) {
+        if (it.first->Holder() != it.second) {
+          it.first->clear();
+          it.first->ResetHolder(it.second);
+        }
+      }
+    }
+
     for (auto &func : input_hookfuncs_) {
       func(op.get(), scope_);
     }
@@ -213,13 +232,33 @@ void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id) {
 }
 
 phi::DenseTensor *NaiveExecutor::FindTensor(const std::string &name) {
+  int slot = FindVarSlot(name);
+  PADDLE_ENFORCE_NE(
+      slot,
+      VariableSlotTable::kInvalidSlot,
+      common::errors::NotFound("No variable [%s] in current scope.", name));
+  return FindTensor(slot);
+}
+
+int NaiveExecutor::FindVarSlot(const std::string &name) {
   PADDLE_ENFORCE_NOT_NULL(scope_,
                           common::errors::PreconditionNotMet(
                               "Need to init scope in NaiveExecutor firstly."));
-  auto *var = scope_->FindVar(name);
-  PADDLE_ENFORCE_NOT_NULL(
-      var,
-      common::errors::NotFound("No variable [%s] in current scope.", name));
+  if (!var_slots_.IsBuiltFor(scope_)) {
+    var_slots_ = VariableSlotTable(*scope_, {});
+  }
+  return var_slots_.Resolve(name);
+}
+
+phi::DenseTensor *NaiveExecutor::FindTensor(int slot) {
+  PADDLE_ENFORCE_EQ(
+      slot >= 0 && static_cast<size_t>(slot) < var_slots_.size(),
+      true,
+      common::errors::OutOfRange("The variable slot %d is out of range [0, "
+                                 "%d) of the slots of the executor.",
+                                 slot,
+                                 var_slots_.size()));
+  auto *var = var_slots_.Var(slot);
   auto *tensor = const_cast<phi::DenseTensor *>(&var->Get<phi::DenseTensor>());
   return tensor;
 }
@@ -291,6 +330,43 @@ void NaiveExecutor::MakeReusePlan(
   }
 }
 
+void NaiveExecutor::MakeWorkspacePlan(
+    const std::unordered_map<std::string, std::pair<int64_t, int64_t>>
+        &workspace_plan) {
+  int64_t workspace_size = 0;
+  for (auto &it : workspace_plan) {
+    workspace_size =
+        std::max(workspace_size, it.second.first + it.second.second);
+  }
+  if (workspace_size == 0) return;
+  workspace_ = memory::Alloc(place_, workspace_size);
+  auto *workspace_ptr = static_cast<uint8_t *>(workspace_->ptr());
+
+  std::unordered_map<std::string, std::shared_ptr<phi::Allocation>> views;
+  for (auto &op : ops_) {
+    const auto inputs = op->InputVars();
+    for (auto &name : op->OutputVars(true)) {
+      // the inplace outputs hold the inputs of the op
+      if (!workspace_plan.count(name) ||
+          std::find(inputs.begin(), inputs.end(), name) != inputs.end()) {
+        continue;
+      }
+      auto *var = scope_->FindVar(name);
+      if (var == nullptr || !var->IsType<phi::DenseTensor>()) continue;
+      auto &view = views[name];
+      if (view == nullptr) {
+        const auto &range = workspace_plan.at(name);
+        view = std::make_shared<phi::Allocation>(
+            workspace_ptr + range.first, range.second, place_);
+      }
+      workspace_cache_[op.get()].emplace_back(
+          var->GetMutable<phi::DenseTensor>(), view);
+    }
+  }
+  VLOG(3) << "Place " << views.size() << " tensors in the workspace of "
+          << workspace_size << " bytes.";
+}
+
 NaiveExecutor::~NaiveExecutor() {
 #ifdef PADDLE_WITH_DNNL
   // Clear mkl-dnn cache,
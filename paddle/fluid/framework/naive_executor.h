@@ -18,12 +18,15 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/variable_slot_table.h"
 #include "paddle/phi/common/place.h"
+#include "paddle/phi/core/memory/malloc.h"
 #include "paddle/phi/core/platform/device_context.h"
 
 #include "paddle/fluid/framework/new_executor/interpreter/execution_config.h"
@@ -88,11 +91,28 @@ class NaiveExecutor {
   // Get an tensor to operating directly, without the need for feed_ops.
   phi::DenseTensor* FindTensor(const std::string& name);
 
+  // Get the slot of a variable, so it is found by FindTensor(int) on every
+  // run without a lookup by name. Return VariableSlotTable::kInvalidSlot if
+  // there is no such variable in the scope.
+  int FindVarSlot(const std::string& name);
+
+  phi::DenseTensor* FindTensor(int slot);
+
+  // Drop the slots of the variables, which should be done once any variable
+  // of the scope is erased.
+  void ClearVarSlots() { var_slots_.Clear(); }
+
   Scope* GetScope() { return scope_; }
 
   void MakeReusePlan(
       const std::unordered_map<std::string, std::string>& reuse_table);
 
+  // Place the tensors of workspace_plan at the (offset, size) of it in one
+  // workspace. A tensor larger than its size at runtime is allocated alone.
+  void MakeWorkspacePlan(
+      const std::unordered_map<std::string, std::pair<int64_t, int64_t>>&
+          workspace_plan);
+
   void ResetTrtOps(int num);
 
   void RegisterOutputHook(const HookFunc& hookfunc);
@@ -108,6 +128,8 @@ class NaiveExecutor {
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_{nullptr};
+  // The variables of the prepared block resolved in scope_.
+  VariableSlotTable var_slots_;
 
   std::vector<HookFunc> output_hookfuncs_;
   std::vector<HookFunc> input_hookfuncs_;
@@ -120,6 +142,15 @@ class NaiveExecutor {
       reuse_cache_;
   std::vector<phi::DenseTensor*> cluster_buffer_;
 
+  // The output tensors of each op placed in the workspace, with their views
+  // of it, which are reset before the op runs.
+  std::unordered_map<
+      OperatorBase*,
+      std::vector<
+          std::pair<phi::DenseTensor*, std::shared_ptr<phi::Allocation>>>>
+      workspace_cache_;
+  phi::Allocator::AllocationPtr workspace_;
+
   std::unique_ptr<framework::InterpreterCore> interpreter_core_;
 };
 
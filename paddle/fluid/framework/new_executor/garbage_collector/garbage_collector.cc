@@ -40,17 +40,20 @@ CreateInterpreterCoreGarbageCollector(
           new InterpreterCoreEventGarbageCollector(vec_instruction));
     }
   } else if (phi::is_xpu_place(place)) {  // NOLINT
-    // Because there is no multi-stream on XPU device, fast GC can
-    // be used.
+    // Fast GC is used on XPU device. With FLAGS_xpu_enable_multi_stream,
+    // the PirInterpreter records the streams using the vars before they are
+    // freed (RecordStreamForGC), and StreamSafeXPUAllocator makes the owning
+    // stream wait for them before the memory is reused.
     // Previously, XPU used no_event GC. But `Wait` in no_event GC
     // may cause GC delayed, causing no enough memory problem.
-    // TODO(pangyoki): Multi-stream allocator and multi-stream GC
-    // are needed to be adapted for XPU.
     return std::unique_ptr<InterpreterCoreGarbageCollector>(
         new InterpreterCoreFastGarbageCollector());
   } else if (phi::is_ipu_place(place)) {
     return std::unique_ptr<InterpreterCoreGarbageCollector>(
         new InterpreterCoreNoEventGarbageCollector());
+  } else if (IsCustomDeviceFastGCEnabled(place)) {
+    return std::unique_ptr<InterpreterCoreGarbageCollector>(
+        new InterpreterCoreFastGarbageCollector());
   } else {
     return std::unique_ptr<InterpreterCoreGarbageCollector>(
         new InterpreterCoreEventGarbageCollector(vec_instruction));
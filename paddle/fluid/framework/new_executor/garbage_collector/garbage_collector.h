@@ -21,6 +21,9 @@
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/phi/core/memory/allocation/spin_lock.h"
 #include "paddle/phi/core/platform/device_event.h"
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+#include "paddle/phi/backends/device_manager.h"
+#endif
 
 COMMON_DECLARE_bool(fast_eager_deletion_mode);
 COMMON_DECLARE_bool(new_executor_use_cuda_graph);
@@ -78,6 +81,22 @@ inline bool IsInterpretercoreFastGCEnabled() {
          FLAGS_new_executor_use_cuda_graph;
 }
 
+// The custom devices ordering their streams by events free the vars in the
+// fast GC: the PirInterpreter records the streams using the vars, and
+// StreamSafeCustomDeviceAllocator waits for their events before the memory
+// is reused, instead of an event per instruction in the event GC.
+inline bool IsCustomDeviceFastGCEnabled(const phi::Place& place) {
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+  return phi::is_custom_place(place) && FLAGS_fast_eager_deletion_mode &&
+         memory::allocation::AllocatorFacade::Instance()
+             .IsStreamSafeCUDAAllocatorUsed() &&
+         (phi::DeviceManager::GetDeviceCapability(place) &
+          C_DEVICE_CAPABILITY_STREAM_EVENT) != 0;
+#else
+  return false;
+#endif
+}
+
 std::unique_ptr<InterpreterCoreGarbageCollector>
 CreateInterpreterCoreGarbageCollector(
     const phi::Place& place, const std::vector<Instruction>& vec_instruction);
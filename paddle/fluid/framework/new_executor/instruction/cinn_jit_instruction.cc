@@ -16,6 +16,7 @@
 
 #include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
 #include "paddle/cinn/hlir/dialect/runtime/ir/runtime_dialect.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/common/errors.h"
 #include "paddle/common/performance_statistician.h"
@@ -41,6 +42,18 @@ class CinnJitInstruction::FnPtrImpl {
   explicit FnPtrImpl(const CINNKernelInfo& cinn_kernel_info)
       : cinn_kernel_info_(cinn_kernel_info) {}
 
+  // A kernel compiled asynchronously is bound when it runs for the first
+  // time, which waits for the compilation if it is not done yet.
+  void BindKernel() {
+    if (cinn_kernel_info_.pending_result == nullptr) {
+      return;
+    }
+    auto pending_result = std::move(cinn_kernel_info_.pending_result);
+    VLOG(4) << "Wait for the asynchronous compilation of "
+            << cinn_kernel_info_.fn_name;
+    cinn_kernel_info_ = pending_result->WaitKernelInfo();
+  }
+
   void InitFuncArgs(const std::vector<phi::DenseTensor*>& kernel_tensor_args) {
     // 1. Create placeholders for tensor args
     for (size_t i = 0; i < kernel_tensor_args.size(); ++i) {
@@ -278,6 +291,7 @@ void CinnJitInstruction::Run() {
   }
 
   // 1. prepare kernel argmuments
+  fn_ptr_impl_->BindKernel();
   fn_ptr_impl_->InitFuncArgs(tensor_args_);
 
   if (FLAGS_cinn_bucket_compile && need_update_shape) {
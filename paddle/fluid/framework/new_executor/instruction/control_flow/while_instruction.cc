@@ -14,6 +14,10 @@
 
 #include "paddle/fluid/framework/new_executor/instruction/control_flow/while_instruction.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/stream_analyzer.h"
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
@@ -34,7 +38,10 @@
 #include "paddle/pir/include/core/value.h"
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_util.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/pir/include/core/op_trait.h"
 #include "paddle/fluid/pir/dialect/operator/ir/manual_op.h"
 #include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
 
@@ -42,9 +49,156 @@
 #include "paddle/fluid/platform/onednn_helper.h"
 #endif
 
+COMMON_DECLARE_bool(while_reuse_body_buffers);
+
 namespace paddle {
 namespace framework {
 
+namespace {
+
+// The ops sharing the buffer of their input without a view in their yaml.
+const std::unordered_set<std::string> kShareDataOps = {
+    "pd_op.share_data",
+    "pd_op.share_data_",
+};
+
+// Union-find of the values which may share a buffer.
+class AliasSets {
+ public:
+  pir::Value Find(pir::Value value) {
+    auto it = parent_.find(value);
+    if (it == parent_.end() || it->second == value) return value;
+    it->second = Find(it->second);
+    return it->second;
+  }
+
+  void Union(pir::Value lhs, pir::Value rhs) {
+    if (!lhs || !rhs) return;
+    lhs = Find(lhs);
+    rhs = Find(rhs);
+    if (lhs != rhs) parent_[lhs] = rhs;
+  }
+
+ private:
+  std::unordered_map<pir::Value, pir::Value> parent_;
+};
+
+void UnionAll(pir::Operation* op, AliasSets* alias_sets) {
+  for (auto result : op->results()) {
+    for (auto operand : op->operands_source()) {
+      alias_sets->Union(result, operand);
+    }
+  }
+}
+
+std::string OriginOpName(pir::Operation* op) {
+  if (op->attributes().count("op_name")) {
+    return op->attributes()
+        .at("op_name")
+        .dyn_cast<pir::StrAttribute>()
+        .AsString();
+  }
+  return op->name();
+}
+
+bool HasSideEffect(pir::Operation* op) {
+  if (op->HasTrait<pir::SideEffectTrait>()) return true;
+  pir::OpInfo op_info =
+      pir::IrContext::Instance()->GetRegisteredOpInfo(OriginOpName(op));
+  return op_info && op_info.HasTrait<pir::SideEffectTrait>();
+}
+
+void UnionInplaceAndView(pir::Operation* op, AliasSets* alias_sets) {
+  std::string op_name = OriginOpName(op);
+  pir::OpInfo op_info =
+      pir::IrContext::Instance()->GetRegisteredOpInfo(op_name);
+  auto* yaml_info_interface =
+      op_info ? op_info.GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>()
+              : nullptr;
+  if (!yaml_info_interface || paddle::dialect::IsLegacyOp(op_name) ||
+      kShareDataOps.count(op_name)) {
+    // e.g. builtin.combine, whose vector holds the tensors of its inputs
+    UnionAll(op, alias_sets);
+    return;
+  }
+  paddle::dialect::OpYamlInfoParser yaml_parser(
+      yaml_info_interface->get_op_info_(op_name), false);
+  const auto& output_names = yaml_parser.OutputNames();
+  for (size_t i = 0; i < op->num_results() && i < output_names.size(); ++i) {
+    const std::string& value_name = output_names[i];
+    if (yaml_parser.HasInplace(value_name)) {
+      alias_sets->Union(op->result(i),
+                        op->operand_source(yaml_parser.InputName2Id().at(
+                            yaml_parser.InplaceName(value_name))));
+    }
+    if (yaml_parser.HasView(value_name)) {
+      alias_sets->Union(op->result(i),
+                        op->operand_source(yaml_parser.InputName2Id().at(
+                            yaml_parser.ViewName(value_name))));
+    }
+  }
+}
+
+void CollectUsedValues(pir::Operation* op,
+                       std::vector<pir::Value>* used_values) {
+  for (size_t i = 0; i < op->num_regions(); ++i) {
+    for (auto& block : op->region(i)) {
+      for (auto& inner_op : block) {
+        for (auto operand : inner_op.operands_source()) {
+          used_values->push_back(operand);
+        }
+        CollectUsedValues(&inner_op, used_values);
+      }
+    }
+  }
+}
+
+// The dense tensors of the body whose buffers may be kept for the next
+// iteration: the results of the ops of the body which share no buffer with
+// the loop carried values, the external inputs, the tensors used by the
+// nested blocks or the ops with side effects.
+std::vector<pir::Value> GetReusableBodyValues(
+    pir::Block* body, const std::vector<pir::Value>& external_inputs) {
+  AliasSets alias_sets;
+  std::vector<pir::Value> pinned_values(external_inputs);
+  for (size_t i = 0; i < body->args_size(); ++i) {
+    pinned_values.push_back(body->arg(i));
+  }
+  for (auto& op : *body) {
+    if (op.isa<pir::YieldOp>() || HasSideEffect(&op)) {
+      for (auto operand : op.operands_source()) {
+        pinned_values.push_back(operand);
+      }
+    }
+    if (op.num_regions() > 0) {
+      CollectUsedValues(&op, &pinned_values);
+      for (auto result : op.results()) {
+        pinned_values.push_back(result);
+      }
+      continue;
+    }
+    UnionInplaceAndView(&op, &alias_sets);
+  }
+
+  std::unordered_set<pir::Value> pinned_sets;
+  for (auto value : pinned_values) {
+    if (value) pinned_sets.insert(alias_sets.Find(value));
+  }
+  std::vector<pir::Value> reusable_values;
+  for (auto& op : *body) {
+    for (auto result : op.results()) {
+      if (result && result.type() &&
+          result.type().isa<paddle::dialect::AllocatedDenseTensorType>() &&
+          !pinned_sets.count(alias_sets.Find(result))) {
+        reusable_values.push_back(result);
+      }
+    }
+  }
+  return reusable_values;
+}
+
+}  // namespace
+
 WhileInstruction::WhileInstruction(
     size_t id,
     const phi::Place& place,
@@ -143,6 +297,14 @@ WhileInstruction::WhileInstruction(
     external_input_names_.insert(name);
     skip_gc_vars.insert(name);
   }
+  if (FLAGS_while_reuse_body_buffers) {
+    // Kept allocated, each iteration writes its tensors to the buffers of
+    // the last one instead of allocating them again.
+    for (auto value :
+         GetReusableBodyValues(body_block_, body_outside_inputs)) {
+      skip_gc_vars.insert(body_inter_->GetNameByValue(value));
+    }
+  }
   body_inter_->SetSkipGcVars(skip_gc_vars);
 
   if (VLOG_IS_ON(6)) {
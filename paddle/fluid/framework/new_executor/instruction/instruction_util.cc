@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/new_executor/instruction/instruction_util.h"
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -42,6 +43,14 @@
 #include "paddle/phi/core/platform/collective_helper.h"
 COMMON_DECLARE_bool(dynamic_static_unified_comm);
 #endif
+#if defined(PADDLE_WITH_XPU)
+#include "paddle/common/flags.h"
+COMMON_DECLARE_bool(xpu_enable_multi_stream);
+#endif
+#if defined(PADDLE_WITH_XPU_BKCL)
+#include "paddle/phi/core/distributed/bkcl_comm_context.h"
+#include "paddle/phi/core/distributed/comm_context_manager.h"
+#endif
 
 namespace paddle::framework {
 
@@ -66,6 +75,10 @@ phi::DeviceContext* ParseDeviceContext(pir::Operation* op,
                                        const phi::Place& place,
                                        const std::string& execution_stream,
                                        const int stream_priority) {
+  // the instructions may be built on several threads, which set the comm
+  // contexts of the shared device contexts here
+  static std::mutex parse_mutex;
+  std::lock_guard<std::mutex> guard(parse_mutex);
   auto& op_attributes = op->attributes();
   auto op_name =
       op_attributes.at("op_name").dyn_cast<pir::StrAttribute>().AsString();
@@ -183,6 +196,49 @@ phi::DeviceContext* ParseDeviceContext(pir::Operation* op,
 #endif
   }
 
+#if defined(PADDLE_WITH_XPU)
+  if (phi::is_xpu_place(place) && FLAGS_xpu_enable_multi_stream) {
+    VLOG(6) << "Parse DeviceContext for " << op_name
+            << ", execution stream = " << execution_stream;
+    if (execution_stream != kDefaultStream) {
+      dev_ctx = ctx_manager
+                    .Get(std::string(kCustomStream) + "-" + execution_stream,
+                         place,
+                         stream_priority)
+                    .get()
+                    .get();
+      interpreter::SetDeviceCommContext(op, dev_ctx);
+      return dev_ctx;
+    }
+
+#if defined(PADDLE_WITH_XPU_BKCL)
+    // the comm ops not on the calc stream run on the stream of the
+    // communicator, which overlaps the computation
+    bool use_calc_stream =
+        op_attributes.count("use_calc_stream") != 0 &&
+        op_attributes.at("use_calc_stream")
+            .dyn_cast<pir::BoolAttribute>()
+            .data();
+    if (op_attributes.count("ring_id") != 0 && !use_calc_stream) {
+      int ring_id =
+          op_attributes.at("ring_id").dyn_cast<pir::Int32Attribute>().data();
+      const auto& comm_context_manager =
+          phi::distributed::CommContextManager::GetInstance();
+      if (comm_context_manager.Has(std::to_string(ring_id))) {
+        auto comm_context = comm_context_manager.Get(std::to_string(ring_id));
+        dev_ctx =
+            static_cast<phi::distributed::BKCLCommContext*>(comm_context)
+                ->GetDevContext();
+        if (dev_ctx != nullptr) {
+          dev_ctx->SetCommContext(comm_context);
+          return dev_ctx;
+        }
+      }
+    }
+#endif
+  }
+#endif
+
   if (origin_dev_ctx != nullptr) {
     interpreter::SetDeviceCommContext(op, origin_dev_ctx);
   }
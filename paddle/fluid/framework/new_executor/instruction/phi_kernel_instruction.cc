@@ -37,6 +37,18 @@
 PHI_DEFINE_EXPORTED_bool(print_kernel_run_info,
                          false,
                          "Whether print kernel run info.");
+PHI_DEFINE_EXPORTED_bool(
+    bind_kernel_call,
+    true,
+    "Whether the phi kernel instructions bind the arguments of their kernels "
+    "once at build time, so that each run calls the kernel on the bound "
+    "arguments instead of unpacking the kernel context.");
+PHI_DEFINE_EXPORTED_bool(
+    pir_infermeta_cache,
+    false,
+    "Whether the phi kernel instructions record the outputs meta of their "
+    "infer meta for the inputs meta, and set it again instead of running the "
+    "infer meta when the inputs meta is repeated.");
 
 namespace paddle {
 namespace framework {
@@ -130,8 +142,27 @@ PhiKernelInstruction::PhiKernelInstruction(
         paddle::small_vector<phi::MetaTensor, phi::kInputSmallVectorSize>,
         paddle::small_vector<phi::MetaTensor, phi::kInputSmallVectorSize>,
         false>(op, *value_exec_info_, yaml_info_parser, &infer_meta_context_);
+    infer_meta_cacheable_ = FLAGS_pir_infermeta_cache;
+    for (size_t i = 0; i < infer_meta_context_.AttrsSize(); ++i) {
+      const auto& attr = infer_meta_context_.AttrAt(i);
+      if (paddle::holds_alternative<phi::TensorRef>(attr) ||
+          paddle::holds_alternative<std::vector<phi::TensorRef>>(attr)) {
+        infer_meta_cacheable_ = false;
+      }
+    }
+    for (size_t i = 0; i < infer_meta_context_.InputsSize(); ++i) {
+      const auto& input = infer_meta_context_.InputAt(i);
+      if (input && !input.is_dense()) infer_meta_cacheable_ = false;
+    }
+    for (size_t i = 0; i < infer_meta_context_.OutputsSize(); ++i) {
+      auto* output = infer_meta_context_.MutableOutputAt(i);
+      if (output && *output && !output->is_dense()) {
+        infer_meta_cacheable_ = false;
+      }
+    }
   }
-  VLOG(6) << "finish process infer meta context";
+  VLOG(6) << "finish process infer meta context, cacheable: "
+          << infer_meta_cacheable_;
 
   auto kernel_name =
       op_attributes.at("kernel_name").dyn_cast<pir::StrAttribute>().AsString();
@@ -166,6 +197,19 @@ PhiKernelInstruction::PhiKernelInstruction(
 
   kernel_context_.SetDeviceContext(dev_ctx);
   VLOG(6) << "finish process kernel context";
+
+  // The kernels of the custom devices may be built without the binding, and
+  // would run instead.
+  if (FLAGS_bind_kernel_call &&
+      phi_kernel_->GetKernelRegisteredType() ==
+          phi::KernelRegisteredType::FUNCTION &&
+      kernel_key.backend() < phi::Backend::CUSTOM) {
+    kernel_context_.SetBindTarget(&bound_kernel_call_);
+    (*(phi_kernel_))(&(kernel_context_));
+    kernel_context_.SetBindTarget(nullptr);
+  }
+  VLOG(6) << "finish process bound kernel call: "
+          << static_cast<bool>(bound_kernel_call_);
   if (op->attributes().count("is_inplace") != 0 &&
       op->attributes().at("is_inplace").dyn_cast<pir::BoolAttribute>().data()) {
     HandleForInplaceOp(op, value_exec_info_, this);
@@ -216,7 +260,11 @@ void PhiKernelInstruction::Run() {
     phi::RecordEvent record_event("PhiKernelInstruction::infermeta",
                                   phi::TracerEventType::UserDefined,
                                   1);
-    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    bool cached = infer_meta_cacheable_ && BuildInferMetaKey();
+    if (!cached || !ReplayInferMeta()) {
+      infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+      if (cached) RecordInferMeta();
+    }
   }
   VLOG(6) << "End run op " << phi_op_name_ << " infer meta.";
   for (auto& pair : this->InplaceInfo()) {
@@ -227,11 +275,83 @@ void PhiKernelInstruction::Run() {
     phi::RecordEvent record_event(kernel_name_ + " kernel launch",
                                   phi::TracerEventType::StaticKernelLaunch,
                                   1);
-    (*(phi_kernel_))(&(kernel_context_));
+    if (bound_kernel_call_) {
+      bound_kernel_call_();
+    } else {
+      (*(phi_kernel_))(&(kernel_context_));
+    }
   }
 
   VLOG(6) << "End run op " << phi_op_name_ << " kernel.";
 }
 
+bool PhiKernelInstruction::BuildInferMetaKey() {
+  for (size_t i = 0; i < kernel_context_.InputsSize(); ++i) {
+    const auto* input = kernel_context_.MutableIutputAt(i);
+    if (input && phi::DenseTensor::classof(input) &&
+        !static_cast<const phi::DenseTensor*>(input)->lod().empty()) {
+      return false;
+    }
+  }
+  infer_meta_key_.clear();
+  for (size_t i = 0; i < infer_meta_context_.InputsSize(); ++i) {
+    const auto& input = infer_meta_context_.InputAt(i);
+    if (!input) {
+      infer_meta_key_.push_back(-1);
+      continue;
+    }
+    auto dims = input.dims();
+    infer_meta_key_.push_back(dims.size());
+    for (int d = 0; d < dims.size(); ++d) {
+      infer_meta_key_.push_back(dims[d]);
+    }
+    infer_meta_key_.push_back(static_cast<int64_t>(input.dtype()));
+    infer_meta_key_.push_back(static_cast<int64_t>(input.layout()));
+  }
+  return true;
+}
+
+bool PhiKernelInstruction::ReplayInferMeta() {
+  for (const auto& record : infer_meta_records_) {
+    if (record.key != infer_meta_key_) continue;
+    for (size_t i = 0; i < record.outputs.size(); ++i) {
+      const auto& meta = record.outputs[i];
+      if (meta.is_null) continue;
+      auto* output = infer_meta_context_.MutableOutputAt(i);
+      output->set_dims(meta.dims);
+      output->set_strides(meta.strides);
+      output->set_dtype(meta.dtype);
+      output->set_layout(meta.layout);
+    }
+    return true;
+  }
+  return false;
+}
+
+void PhiKernelInstruction::RecordInferMeta() {
+  // a few inputs meta are kept, e.g. those of the steps of a decoding loop
+  constexpr size_t kMaxInferMetaRecords = 8;
+  InferMetaRecord record;
+  record.key = infer_meta_key_;
+  record.outputs.resize(infer_meta_context_.OutputsSize());
+  for (size_t i = 0; i < record.outputs.size(); ++i) {
+    auto* output = infer_meta_context_.MutableOutputAt(i);
+    if (!output || !*output) continue;
+    auto& meta = record.outputs[i];
+    meta.is_null = false;
+    meta.dims = output->dims();
+    meta.strides = output->strides();
+    meta.dtype = output->dtype();
+    meta.layout = output->layout();
+  }
+  if (infer_meta_records_.size() < kMaxInferMetaRecords) {
+    infer_meta_records_.push_back(std::move(record));
+  } else {
+    infer_meta_records_[next_infer_meta_record_] = std::move(record);
+    next_infer_meta_record_ =
+        (next_infer_meta_record_ + 1) % kMaxInferMetaRecords;
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
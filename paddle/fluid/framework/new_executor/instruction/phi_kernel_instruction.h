@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
 
 namespace pir {
@@ -53,13 +56,51 @@ class PhiKernelInstruction : public InstructionBase {
   const std::string& Name() const override { return phi_op_name_; }
 
  private:
+  // Builds infer_meta_key_ from the meta of the inputs of infer meta, or
+  // returns false if an input has a LoD, which the key does not cover.
+  bool BuildInferMetaKey();
+
+  // Sets the meta of the outputs recorded for infer_meta_key_, or returns
+  // false if it has no record.
+  bool ReplayInferMeta();
+
+  void RecordInferMeta();
+
+  struct OutputMeta {
+    bool is_null{true};
+    phi::DDim dims;
+    phi::DDim strides;
+    phi::DataType dtype{phi::DataType::UNDEFINED};
+    phi::DataLayout layout{phi::DataLayout::UNDEFINED};
+  };
+
+  struct InferMetaRecord {
+    std::vector<int64_t> key;
+    std::vector<OutputMeta> outputs;
+  };
+
   paddle::dialect::InferMetaInterface::Concept* infer_meta_interface_{
       nullptr};  // not owned
 
+  // Whether the outputs meta only depends on the inputs meta, without the
+  // values of the tensors of the mutable attributes, see
+  // FLAGS_pir_infermeta_cache.
+  bool infer_meta_cacheable_{false};
+
+  std::vector<int64_t> infer_meta_key_;
+
+  std::vector<InferMetaRecord> infer_meta_records_;
+
+  size_t next_infer_meta_record_{0};
+
   phi::InferMetaContext infer_meta_context_;
 
   phi::KernelContext kernel_context_;
 
+  // The kernel bound to kernel_context_ at build time, or empty if its
+  // arguments are not bindable, see phi::KernelContext::SetBindTarget.
+  std::function<void()> bound_kernel_call_;
+
   phi::Kernel* phi_kernel_{nullptr};  // not owned
 
   std::string phi_op_name_;
@@ -53,6 +53,15 @@ COMMON_DECLARE_bool(check_nan_inf);
 COMMON_DECLARE_string(static_runtime_data_save_path);
 COMMON_DECLARE_bool(save_static_runtime_data);
 
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_numa_aware_workqueue,
+    false,
+    "Split the host threads of new executor into per-NUMA-node groups and "
+    "steal work from the local node first.");
+PHI_DEFINE_EXPORTED_bool(new_executor_bind_workqueue_threads,
+                         false,
+                         "Pin every host thread of new executor to one core.");
+
 namespace paddle::framework::interpreter {
 
 using VariableIdMap = std::map<std::string, std::vector<int>>;
@@ -100,6 +109,9 @@ const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
                              /*track_task*/ false,
                              /*detached*/ true,
                              /*events_waiter*/ waiter);
+  group_options.back().numa_aware = FLAGS_new_executor_numa_aware_workqueue;
+  group_options.back().bind_threads =
+      FLAGS_new_executor_bind_workqueue_threads;
   // for launch device Kernel
   group_options.emplace_back(/*name*/ "DeviceKernelLaunch",
                              /*num_threads*/ device_num_threads,
@@ -197,6 +209,16 @@ bool IsSupportedHeterPlace(const phi::Place& place) {
          phi::is_ipu_place(place) || phi::is_custom_place(place);
 }
 
+bool HasCustomDeviceCapability(const phi::Place& place, size_t capability) {
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+  if (phi::is_custom_place(place)) {
+    return (phi::DeviceManager::GetDeviceCapability(place) & capability) ==
+           capability;
+  }
+#endif
+  return false;
+}
+
 bool IsMemcpyD2H(const Instruction& instr) {
   return instr.OpBase()->Type() == kMemcpyD2H;
 }
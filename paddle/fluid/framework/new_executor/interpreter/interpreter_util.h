@@ -61,6 +61,10 @@ class AsyncWorkQueue {
     return queue_group_->QueueNumThreads(idx);
   }
 
+  std::vector<WorkQueueThreadStats> QueueThreadStats(size_t idx) const {
+    return queue_group_->QueueThreadStats(idx);
+  }
+
  private:
   size_t host_num_thread_;
   std::unique_ptr<WorkQueueGroup> queue_group_;
@@ -94,6 +98,10 @@ bool IsMemcpyOp(const Instruction& instr);
 
 bool IsSupportedHeterPlace(const phi::Place& place);
 
+// Whether the place is a custom device reporting all the bits of
+// `capability`, a mask of C_DeviceCapability.
+bool HasCustomDeviceCapability(const phi::Place& place, size_t capability);
+
 void AddFetch(const std::vector<std::string>& fetch_names,
               framework::BlockDesc* block);
 
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/managed_memory_prefetcher.h"
+
+#include <algorithm>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/memory/managed_memory_advisor.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#endif
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+ManagedMemoryPrefetcher::ManagedMemoryPrefetcher(size_t lookahead)
+    : lookahead_(lookahead) {}
+
+void ManagedMemoryPrefetcher::Analyze(
+    const std::vector<std::unique_ptr<InstructionBase>>& instrs,
+    const std::vector<size_t>& execute_order,
+    const std::vector<Variable*>& var_list) {
+  instrs_ = &instrs;
+  var_list_ = &var_list;
+  execute_order_ = execute_order;
+  position_.assign(instrs.size(), 0);
+  input_var_ids_.assign(execute_order.size(), {});
+  for (size_t pos = 0; pos < execute_order.size(); ++pos) {
+    size_t instr_id = execute_order[pos];
+    position_[instr_id] = pos;
+    auto& var_ids = input_var_ids_[pos];
+    for (auto& item : instrs[instr_id]->Inputs()) {
+      var_ids.insert(var_ids.end(), item.second.begin(), item.second.end());
+    }
+    std::sort(var_ids.begin(), var_ids.end());
+    var_ids.erase(std::unique(var_ids.begin(), var_ids.end()), var_ids.end());
+  }
+}
+
+void ManagedMemoryPrefetcher::BeginRun() {
+  prefetched_.clear();
+  skip_ = !memory::ManagedMemoryAdvisor::Instance().enabled();
+  if (skip_) {
+    return;
+  }
+  for (size_t pos = 0; pos < lookahead_; ++pos) {
+    PrefetchAt(pos);
+  }
+}
+
+void ManagedMemoryPrefetcher::BeforeRunInstruction(
+    const InstructionBase* instr) {
+  if (skip_) {
+    return;
+  }
+  PrefetchAt(position_[instr->Id()] + lookahead_);
+}
+
+void ManagedMemoryPrefetcher::PrefetchAt(size_t pos) {
+#ifdef PADDLE_WITH_CUDA
+  if (pos >= execute_order_.size()) {
+    return;
+  }
+  const InstructionBase* instr = (*instrs_)[execute_order_[pos]].get();
+  if (!phi::is_gpu_place(instr->DeviceContext().GetPlace())) {
+    return;
+  }
+  auto stream =
+      static_cast<const phi::GPUContext&>(instr->DeviceContext()).stream();
+  auto& advisor = memory::ManagedMemoryAdvisor::Instance();
+  for (auto var_id : input_var_ids_[pos]) {
+    const Variable* var = (*var_list_)[var_id];
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    const auto& tensor = var->Get<phi::DenseTensor>();
+    const phi::Allocation* holder = tensor.Holder().get();
+    if (holder != nullptr && memory::ManagedMemoryAdvisor::IsManaged(holder) &&
+        prefetched_.insert(holder).second) {
+      advisor.Prefetch(holder, stream);
+    }
+  }
+#endif
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,70 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/phi/core/allocator.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// Prefetches the inputs in managed memory of an instruction list run in a
+// fixed order, see memory::ManagedMemoryAdvisor. Before an instruction runs,
+// the inputs of the one lookahead positions after it are prefetched on a side
+// stream, which the stream of that instruction waits for. So the pages
+// migrate while the instructions in between run, and each holder is
+// prefetched once per run.
+class ManagedMemoryPrefetcher final {
+ public:
+  explicit ManagedMemoryPrefetcher(size_t lookahead);
+
+  void Analyze(const std::vector<std::unique_ptr<InstructionBase>>& instrs,
+               const std::vector<size_t>& execute_order,
+               const std::vector<Variable*>& var_list);
+
+  // Prefetches the inputs of the first instructions.
+  void BeginRun();
+
+  void BeforeRunInstruction(const InstructionBase* instr);
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ManagedMemoryPrefetcher);
+
+  void PrefetchAt(size_t pos);
+
+  const size_t lookahead_;
+  const std::vector<std::unique_ptr<InstructionBase>>* instrs_{nullptr};
+  const std::vector<Variable*>* var_list_{nullptr};
+  std::vector<size_t> execute_order_;
+  // instruction id -> position in the execute order
+  std::vector<size_t> position_;
+  // position -> input var ids of the instruction
+  std::vector<std::vector<size_t>> input_var_ids_;
+
+  // no tensor is in managed memory in the current run
+  bool skip_{true};
+  std::unordered_set<const phi::Allocation*> prefetched_;
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
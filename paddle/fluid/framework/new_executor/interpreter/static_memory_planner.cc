@@ -0,0 +1,343 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
+
+#include <algorithm>
+
+#include "paddle/fluid/framework/new_executor/instruction/phi_kernel_instruction.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/memory/malloc.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+namespace {
+
+constexpr size_t kArenaAlignment = 256;
+
+// A slice of the arena, keeps the arena alive and frees nothing by itself.
+class ArenaSliceAllocation : public phi::Allocation {
+ public:
+  ArenaSliceAllocation(std::shared_ptr<phi::Allocation> arena,
+                       size_t offset,
+                       size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+bool IsPhiKernel(const InstructionBase* instr) {
+  return dynamic_cast<const PhiKernelInstruction*>(instr) != nullptr;
+}
+
+const phi::Allocation* HolderOf(const Variable* var) {
+  if (!var->IsType<phi::DenseTensor>()) {
+    return nullptr;
+  }
+  const auto& tensor = var->Get<phi::DenseTensor>();
+  return tensor.IsInitialized() ? tensor.Holder().get() : nullptr;
+}
+
+}  // namespace
+
+StaticMemoryPlanner::StaticMemoryPlanner(const phi::Place& place,
+                                         size_t max_buckets)
+    : place_(place), max_buckets_(max_buckets) {}
+
+void StaticMemoryPlanner::Analyze(
+    const std::vector<std::unique_ptr<InstructionBase>>& instrs,
+    const std::vector<size_t>& execute_order,
+    const std::map<size_t, std::set<size_t>>& last_live_ops,
+    const std::vector<Variable*>& var_list,
+    const std::unordered_set<size_t>& parameter_var_ids,
+    const std::unordered_set<size_t>& skip_gc_var_ids) {
+  var_list_ = &var_list;
+  buffers_.clear();
+  var_to_buffer_.clear();
+  produced_buffers_.assign(instrs.size(), {});
+  input_var_ids_.clear();
+  plans_.clear();
+  current_plan_ = nullptr;
+  recording_ = false;
+
+  std::vector<size_t> position(instrs.size(), 0);
+  for (size_t pos = 0; pos < execute_order.size(); ++pos) {
+    position[execute_order[pos]] = pos;
+  }
+
+  std::unordered_map<size_t, std::vector<size_t>> producers;
+  std::unordered_map<size_t, std::vector<size_t>> readers;
+  for (size_t instr_id = 0; instr_id < instrs.size(); ++instr_id) {
+    for (auto& item : instrs[instr_id]->Outputs()) {
+      for (auto var_id : item.second) {
+        producers[var_id].push_back(instr_id);
+      }
+    }
+    for (auto& item : instrs[instr_id]->Inputs()) {
+      for (auto var_id : item.second) {
+        readers[var_id].push_back(instr_id);
+      }
+    }
+  }
+
+  for (auto& item : readers) {
+    size_t var_id = item.first;
+    if (!producers.count(var_id) && !parameter_var_ids.count(var_id) &&
+        var_list[var_id]->IsType<phi::DenseTensor>()) {
+      input_var_ids_.push_back(var_id);
+    }
+  }
+  std::sort(input_var_ids_.begin(), input_var_ids_.end());
+
+  // all the arena is used in the order of one stream
+  const phi::DeviceContext* planned_dev_ctx = nullptr;
+  auto is_plannable = [&](size_t var_id, size_t producer, size_t* last) {
+    if (producers[var_id].size() != 1 || parameter_var_ids.count(var_id) ||
+        skip_gc_var_ids.count(var_id) ||
+        !var_list[var_id]->IsType<phi::DenseTensor>()) {
+      return false;
+    }
+    auto live_iter = last_live_ops.find(var_id);
+    if (live_iter == last_live_ops.end() || live_iter->second.empty()) {
+      return false;
+    }
+    const InstructionBase* producer_instr = instrs[producer].get();
+    const phi::DeviceContext* dev_ctx = &producer_instr->DeviceContext();
+    if (!IsPhiKernel(producer_instr) || dev_ctx->GetPlace() != place_ ||
+        (planned_dev_ctx != nullptr && planned_dev_ctx != dev_ctx)) {
+      return false;
+    }
+    *last = position[producer];
+    for (auto reader : readers[var_id]) {
+      const InstructionBase* reader_instr = instrs[reader].get();
+      if (reader_instr->Name() == "builtin_combine_instruction") {
+        continue;
+      }
+      if (!IsPhiKernel(reader_instr) ||
+          &reader_instr->DeviceContext() != dev_ctx ||
+          position[reader] <= position[producer]) {
+        return false;
+      }
+      // the buffer may be shared into an output that is not checked
+      for (auto& output : reader_instr->Outputs()) {
+        for (auto output_var_id : output.second) {
+          if (!var_list[output_var_id]->IsType<phi::DenseTensor>()) {
+            return false;
+          }
+        }
+      }
+      *last = std::max(*last, position[reader]);
+    }
+    for (auto op_id : live_iter->second) {
+      *last = std::max(*last, position[op_id]);
+    }
+    planned_dev_ctx = dev_ctx;
+    return true;
+  };
+
+  for (auto instr_id : execute_order) {
+    for (auto& item : instrs[instr_id]->Outputs()) {
+      for (auto var_id : item.second) {
+        size_t last = 0;
+        if (var_to_buffer_.count(var_id) ||
+            !is_plannable(var_id, instr_id, &last)) {
+          continue;
+        }
+        var_to_buffer_[var_id] = buffers_.size();
+        produced_buffers_[instr_id].push_back(buffers_.size());
+        buffers_.push_back(Buffer{
+            static_cast<size_t>(var_id), instr_id, position[instr_id], last});
+      }
+    }
+  }
+  VLOG(4) << "StaticMemoryPlanner: " << buffers_.size()
+          << " tensors can be planned, " << input_var_ids_.size()
+          << " inputs select the bucket";
+}
+
+void StaticMemoryPlanner::BeginRun() {
+  current_plan_ = nullptr;
+  recording_ = false;
+  if (buffers_.empty()) {
+    return;
+  }
+
+  std::vector<int64_t> key;
+  for (auto var_id : input_var_ids_) {
+    const auto& tensor = (*var_list_)[var_id]->Get<phi::DenseTensor>();
+    if (!tensor.IsInitialized()) {
+      key.push_back(-1);
+      continue;
+    }
+    key.push_back(static_cast<int64_t>(tensor.dtype()));
+    key.push_back(tensor.dims().size());
+    for (int i = 0; i < tensor.dims().size(); ++i) {
+      key.push_back(tensor.dims()[i]);
+    }
+  }
+
+  auto iter = plans_.find(key);
+  if (iter != plans_.end()) {
+    current_plan_ = &(iter->second);
+  } else if (plans_.size() < max_buckets_) {
+    VLOG(4) << "StaticMemoryPlanner: record a new bucket";
+    recording_ = true;
+    recording_key_ = std::move(key);
+    recorded_bytes_.assign(buffers_.size(), 0);
+  }
+}
+
+void StaticMemoryPlanner::BeforeRunInstruction(const InstructionBase* instr) {
+  if (current_plan_ == nullptr) {
+    return;
+  }
+  for (auto& bind : current_plan_->binds[instr->Id()]) {
+    auto* tensor = (*var_list_)[buffers_[bind.first].var_id]
+                       ->GetMutable<phi::DenseTensor>();
+    // a tensor not released by GC keeps its buffer
+    if (!tensor->IsInitialized()) {
+      tensor->ResetHolder(bind.second);
+    }
+  }
+}
+
+void StaticMemoryPlanner::AfterRunInstruction(const InstructionBase* instr) {
+  if (!recording_) {
+    return;
+  }
+  for (auto buffer_id : produced_buffers_[instr->Id()]) {
+    const auto& tensor =
+        (*var_list_)[buffers_[buffer_id].var_id]->Get<phi::DenseTensor>();
+    if (tensor.IsInitialized() && tensor.place() == place_ &&
+        tensor.meta().offset == 0 && tensor.numel() > 0) {
+      recorded_bytes_[buffer_id] =
+          static_cast<size_t>(tensor.numel()) * phi::SizeOf(tensor.dtype());
+    }
+  }
+
+  // drop the buffers shared between the inputs and outputs, such as the ones
+  // of a view or an inplace kernel
+  std::vector<std::pair<const phi::Allocation*, size_t>> holders;
+  for (auto* vars : {&instr->Inputs(), &instr->Outputs()}) {
+    for (auto& item : *vars) {
+      for (auto var_id : item.second) {
+        const phi::Allocation* holder = HolderOf((*var_list_)[var_id]);
+        if (holder != nullptr) {
+          holders.emplace_back(holder, static_cast<size_t>(var_id));
+        }
+      }
+    }
+  }
+  std::sort(holders.begin(), holders.end());
+  holders.erase(std::unique(holders.begin(), holders.end()), holders.end());
+  for (size_t i = 0; i < holders.size(); ++i) {
+    bool shared = (i > 0 && holders[i - 1].first == holders[i].first) ||
+                  (i + 1 < holders.size() &&
+                   holders[i + 1].first == holders[i].first);
+    auto iter = var_to_buffer_.find(holders[i].second);
+    if (shared && iter != var_to_buffer_.end()) {
+      recorded_bytes_[iter->second] = 0;
+    }
+  }
+}
+
+void StaticMemoryPlanner::EndRun() {
+  if (recording_) {
+    BucketPlan plan;
+    BuildPlan(&plan);
+    current_plan_ = &(plans_[std::move(recording_key_)] = std::move(plan));
+    recording_ = false;
+  }
+}
+
+size_t StaticMemoryPlanner::ArenaSize() const {
+  return current_plan_ != nullptr && current_plan_->arena != nullptr
+             ? current_plan_->arena->size()
+             : 0;
+}
+
+void StaticMemoryPlanner::BuildPlan(BucketPlan* plan) const {
+  plan->binds.assign(produced_buffers_.size(), {});
+
+  std::vector<size_t> sizes(buffers_.size(), 0);
+  std::vector<size_t> order;
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    if (recorded_bytes_[i] > 0) {
+      sizes[i] = (recorded_bytes_[i] + kArenaAlignment - 1) / kArenaAlignment *
+                 kArenaAlignment;
+      total_bytes += sizes[i];
+      order.push_back(i);
+    }
+  }
+  if (order.empty()) {
+    return;
+  }
+
+  // Greedy by size: the larger buffers are placed first, each one at the
+  // lowest offset that does not overlap the placed buffers live at the same
+  // time as it.
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    if (sizes[lhs] != sizes[rhs]) {
+      return sizes[lhs] > sizes[rhs];
+    }
+    return buffers_[lhs].first < buffers_[rhs].first;
+  });
+  std::vector<size_t> offsets(buffers_.size(), 0);
+  std::vector<size_t> placed;
+  size_t arena_size = 0;
+  for (auto id : order) {
+    std::vector<size_t> conflicts;
+    for (auto other : placed) {
+      if (buffers_[id].first <= buffers_[other].last &&
+          buffers_[other].first <= buffers_[id].last) {
+        conflicts.push_back(other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [&](size_t lhs, size_t rhs) {
+      return offsets[lhs] < offsets[rhs];
+    });
+    size_t offset = 0;
+    for (auto other : conflicts) {
+      if (offset + sizes[id] <= offsets[other]) {
+        break;
+      }
+      offset = std::max(offset, offsets[other] + sizes[other]);
+    }
+    offsets[id] = offset;
+    arena_size = std::max(arena_size, offset + sizes[id]);
+    placed.push_back(id);
+  }
+
+  plan->arena = memory::AllocShared(place_, arena_size);
+  for (auto id : order) {
+    plan->binds[buffers_[id].producer].emplace_back(
+        id,
+        std::make_shared<ArenaSliceAllocation>(
+            plan->arena, offsets[id], recorded_bytes_[id]));
+  }
+  VLOG(4) << "StaticMemoryPlanner: plan " << order.size()
+          << " tensors of " << total_bytes << " bytes into an arena of "
+          << arena_size << " bytes";
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/allocator.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// Plans the intermediate dense tensors of an instruction list run in a fixed
+// order into one preallocated arena per shape bucket of the inputs of the
+// list. The first run of a bucket goes through the allocator and records the
+// size of every buffer, the buffers are then placed into the arena by a
+// greedy interval coloring over their live ranges. Later runs of the bucket
+// bind the slices of the arena to the tensors before their producers run, so
+// the kernels find their output already allocated.
+//
+// Only the dense tensors produced by exactly one phi kernel and read only by
+// phi kernels on the same device context are planned, and the ones sharing
+// their buffer with another tensor are dropped. A kernel that needs more than
+// the planned size, e.g. for a data dependent shape, still allocates by
+// itself.
+class StaticMemoryPlanner final {
+ public:
+  StaticMemoryPlanner(const phi::Place& place, size_t max_buckets);
+
+  // Finds the tensors that can be planned. execute_order is the order the
+  // instructions always run in, last_live_ops is the one computed for GC.
+  void Analyze(const std::vector<std::unique_ptr<InstructionBase>>& instrs,
+               const std::vector<size_t>& execute_order,
+               const std::map<size_t, std::set<size_t>>& last_live_ops,
+               const std::vector<Variable*>& var_list,
+               const std::unordered_set<size_t>& parameter_var_ids,
+               const std::unordered_set<size_t>& skip_gc_var_ids);
+
+  // Selects the arena for the shapes of the current inputs, or starts to
+  // record the bucket if it has not been planned.
+  void BeginRun();
+
+  void BeforeRunInstruction(const InstructionBase* instr);
+
+  void AfterRunInstruction(const InstructionBase* instr);
+
+  // Builds the arena of the recorded bucket. Not called if the run failed.
+  void EndRun();
+
+  size_t NumPlannedTensors() const { return buffers_.size(); }
+
+  // Bytes of the arena of the current bucket, 0 if it is not planned.
+  size_t ArenaSize() const;
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(StaticMemoryPlanner);
+
+  struct Buffer {
+    size_t var_id;
+    size_t producer;
+    // positions in the execute order of the producer and the last reader
+    size_t first;
+    size_t last;
+  };
+
+  struct BucketPlan {
+    std::shared_ptr<phi::Allocation> arena;
+    // instruction id -> (buffer index, slice of the arena)
+    std::vector<
+        std::vector<std::pair<size_t, std::shared_ptr<phi::Allocation>>>>
+        binds;
+  };
+
+  void BuildPlan(BucketPlan* plan) const;
+
+  const phi::Place place_;
+  const size_t max_buckets_;
+  const std::vector<Variable*>* var_list_{nullptr};
+
+  std::vector<Buffer> buffers_;
+  // var id -> buffer index
+  std::unordered_map<size_t, size_t> var_to_buffer_;
+  // instruction id -> buffers produced by it
+  std::vector<std::vector<size_t>> produced_buffers_;
+  // vars read but not produced by the instructions, their shapes select the
+  // bucket
+  std::vector<size_t> input_var_ids_;
+
+  std::map<std::vector<int64_t>, BucketPlan> plans_;
+  BucketPlan* current_plan_{nullptr};
+
+  // the bucket being recorded, and the bytes of each buffer in it, 0 for the
+  // buffers that can not be planned in the bucket
+  bool recording_{false};
+  std::vector<int64_t> recording_key_;
+  std::vector<size_t> recorded_bytes_;
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -17,16 +17,18 @@
 #include <future>
 #include <unordered_set>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
+#include "paddle/phi/backends/device_ext.h"
 #include "paddle/phi/core/platform/device_context.h"
 #if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
-#include "paddle/common/flags.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/distributed/nccl_comm_context.h"
 #include "paddle/phi/core/platform/collective_helper.h"
 COMMON_DECLARE_bool(dynamic_static_unified_comm);
 #endif
+COMMON_DECLARE_bool(xpu_enable_multi_stream);
 
 namespace paddle::framework::interpreter {
 
@@ -332,15 +334,21 @@ template <typename T>
 DownstreamRunType analyse_run_type_for_two_instructions(T* cur_instr,
                                                         T* next_instr,
                                                         const Place& place) {
-  // xpu&ipu memcpy kerenl is synchronous.
-  if (phi::is_ipu_place(place) || phi::is_xpu_place(place)) {
+  // xpu&ipu memcpy kerenl is synchronous. With FLAGS_xpu_enable_multi_stream,
+  // the xpu instructions in other streams wait for events as the gpu ones.
+  if (phi::is_ipu_place(place) ||
+      (phi::is_xpu_place(place) && !FLAGS_xpu_enable_multi_stream)) {
     return DownstreamRunType::kDirectRun;
   }
 
-  // npu d2h kernel is asynchronous.
+  // npu d2h kernel is asynchronous. The h2d copies are taken as synchronous
+  // unless the device reports the asynchronous copies, then they wait for
+  // events as the other kernels.
   if (phi::is_custom_place(place)) {
     if (phi::is_cpu_place(cur_instr->DeviceContext().GetPlace()) ||
-        interpreter::IsMemcpyH2D(next_instr)) {
+        (interpreter::IsMemcpyH2D(next_instr) &&
+         !HasCustomDeviceCapability(place,
+                                    C_DEVICE_CAPABILITY_ASYNC_MEMCPY))) {
       return DownstreamRunType::kDirectRun;
     }
   }
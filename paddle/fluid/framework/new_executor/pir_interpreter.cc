@@ -14,7 +14,12 @@
 
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <exception>
+#include <thread>
+#include <tuple>
 #include <unordered_set>
 
 #include "paddle/common/flags.h"
@@ -26,11 +31,14 @@
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/kernel_context.h"
+#include "paddle/phi/core/memory/allocation_trace.h"
+#include "paddle/phi/core/memory/managed_memory_advisor.h"
 #include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
 #include "paddle/phi/core/sparse_csr_tensor.h"
+#include "paddle/phi/core/tensor_utils.h"
 
 #ifdef PADDLE_WITH_DNNL
 #include "paddle/fluid/framework/new_executor/instruction/onednn/onednn_instruction.h"
@@ -81,6 +89,9 @@
 #include "paddle/phi/core/distributed/nccl_comm_context.h"
 COMMON_DECLARE_bool(dynamic_static_unified_comm);
 #endif
+#ifdef PADDLE_WITH_XPU
+#include "paddle/phi/backends/xpu/xpu_context.h"
+#endif
 #include "paddle/fluid/framework/new_executor/collect_shape_manager.h"
 #include "paddle/fluid/framework/new_executor/nan_inf_utils.h"
 
@@ -88,6 +99,12 @@ COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
 COMMON_DECLARE_bool(enable_collect_shape);
 COMMON_DECLARE_int32(low_precision_op_list);
+COMMON_DECLARE_int32(pir_static_memory_plan_buckets);
+COMMON_DECLARE_int32(pir_managed_prefetch_lookahead);
+COMMON_DECLARE_bool(pir_critical_path_scheduling);
+COMMON_DECLARE_bool(xpu_enable_multi_stream);
+COMMON_DECLARE_int32(pir_auto_cuda_graph_max_graphs);
+COMMON_DECLARE_int32(pir_build_instruction_threads);
 
 #define CREATE_INSTR(instr_name)                                   \
   vec_instruction_base_.emplace_back(std::make_unique<instr_name>( \
@@ -195,6 +212,10 @@ PirInterpreter::PirInterpreter(const phi::Place& place,
     SchedulingPriority rhs_scheduling_priority =
         vec_instruction_base_[rhs]->GetSchedulingPriority();
     if (lhs_scheduling_priority == rhs_scheduling_priority) {
+      if (!instr_bottom_levels_.empty() &&
+          instr_bottom_levels_[lhs] != instr_bottom_levels_[rhs]) {
+        return instr_bottom_levels_[lhs] < instr_bottom_levels_[rhs];
+      }
       return lhs > rhs;
     }
     return lhs_scheduling_priority > rhs_scheduling_priority;
@@ -286,6 +307,10 @@ PirInterpreter::PirInterpreter(
     SchedulingPriority rhs_scheduling_priority =
         vec_instruction_base_[rhs]->GetSchedulingPriority();
     if (lhs_scheduling_priority == rhs_scheduling_priority) {
+      if (!instr_bottom_levels_.empty() &&
+          instr_bottom_levels_[lhs] != instr_bottom_levels_[rhs]) {
+        return instr_bottom_levels_[lhs] < instr_bottom_levels_[rhs];
+      }
       return lhs > rhs;
     }
     return lhs_scheduling_priority > rhs_scheduling_priority;
@@ -300,8 +325,22 @@ PirInterpreter::PirInterpreter(
 }
 
 PirInterpreter::~PirInterpreter() {
+  ReleaseCUDAGraphs(0);
   // cancel gc's thread
   gc_.reset(nullptr);
+  if (VLOG_IS_ON(4) && async_work_queue_ != nullptr &&
+      async_work_queue_.use_count() == 1) {
+    auto host_stats = async_work_queue_->QueueThreadStats(0);
+    for (size_t i = 0; i < host_stats.size(); ++i) {
+      VLOG(4) << "HostTasks thread " << i
+              << ": numa_node=" << host_stats[i].numa_node
+              << ", cpu=" << host_stats[i].cpu
+              << ", own_tasks=" << host_stats[i].own_tasks
+              << ", local_steals=" << host_stats[i].local_steals
+              << ", global_steals=" << host_stats[i].global_steals
+              << ", idle_waits=" << host_stats[i].idle_waits;
+    }
+  }
   async_work_queue_.reset();
   VLOG(4) << "~PirInterpreter(): " << this << " on " << place_;
 
@@ -477,6 +516,154 @@ void PirInterpreter::CheckCUDAGraphBeforeRun(
 #endif
 }
 
+bool PirInterpreter::RunByCUDAGraph(
+    const std::vector<std::string>& feed_names) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!auto_cuda_graph_enabled_ || platform::IsCUDAGraphCapturing()) {
+    return false;
+  }
+
+  std::vector<int64_t> feed_key;
+  std::vector<phi::DenseTensor*> feed_tensors;
+  for (auto& feed_name : feed_names) {
+    auto* feed_var = InnerScope()->FindVar(feed_name);
+    if (feed_var == nullptr || !feed_var->IsType<phi::DenseTensor>()) {
+      return false;
+    }
+    auto* feed_tensor = feed_var->GetMutable<phi::DenseTensor>();
+    if (!feed_tensor->initialized() || feed_tensor->place() != place_) {
+      VLOG(4) << "Run without CUDA Graph since feed " << feed_name
+              << " is not on " << place_;
+      return false;
+    }
+    feed_key.push_back(static_cast<int64_t>(feed_tensor->dtype()));
+    feed_key.push_back(feed_tensor->dims().size());
+    for (int i = 0; i < feed_tensor->dims().size(); ++i) {
+      feed_key.push_back(feed_tensor->dims()[i]);
+    }
+    feed_tensors.push_back(feed_tensor);
+  }
+
+  // The addresses of the feeds are captured into the graph, so the feeds are
+  // copied into the same buffers before every replay.
+  auto* dev_ctx = phi::DeviceContextPool::Instance().Get(place_);
+  auto ShareFeedBuffers = [&](std::vector<phi::DenseTensor>* feed_buffers) {
+    for (size_t i = 0; i < feed_tensors.size(); ++i) {
+      phi::Copy(
+          *dev_ctx, *feed_tensors[i], place_, false, &(feed_buffers->at(i)));
+      feed_tensors[i]->ShareDataWith(feed_buffers->at(i));
+    }
+  };
+
+  auto iter = std::find_if(
+      cuda_graphs_.begin(),
+      cuda_graphs_.end(),
+      [&](const CUDAGraphEntry& entry) { return entry.feed_key == feed_key; });
+  if (iter != cuda_graphs_.end()) {
+    cuda_graphs_.splice(cuda_graphs_.begin(), cuda_graphs_, iter);
+    ShareFeedBuffers(&(iter->feed_buffers));
+    for (size_t i = 0; i < fetch_var_names_.size(); ++i) {
+      auto* fetch_var = InnerScope()->FindVar(fetch_var_names_[i]);
+      if (fetch_var != nullptr && iter->fetch_bindings[i].initialized()) {
+        fetch_var->GetMutable<phi::DenseTensor>()->ShareDataWith(
+            iter->fetch_bindings[i]);
+      }
+    }
+    VLOG(4) << "Replay the CUDA Graph of " << cuda_graphs_.size() << " graphs";
+    iter->graph->Replay();
+    return true;
+  }
+
+  // the first run of the feed shapes warms up the kernels and the allocator
+  if (cuda_graph_warmed_up_keys_.insert(feed_key).second) {
+    return false;
+  }
+  cuda_graph_warmed_up_keys_.erase(feed_key);
+
+  ReleaseCUDAGraphs(
+      static_cast<size_t>(FLAGS_pir_auto_cuda_graph_max_graphs - 1));
+  // The outputs still hold the memory of the last run, which may be the pool
+  // of another graph. The new graph allocates them from its own pool, so it
+  // does not replay into the memory of a graph dropped later.
+  ClearInstructionOutputs();
+
+  CUDAGraphEntry entry;
+  entry.feed_key = feed_key;
+  entry.feed_buffers.resize(feed_tensors.size());
+  ShareFeedBuffers(&(entry.feed_buffers));
+  dev_ctx->Wait();
+
+  VLOG(4) << "Capture a CUDA Graph";
+  try {
+    platform::BeginCUDAGraphCapture(phi::GPUPlace(place_.GetDeviceId()),
+                                    phi::gpuStreamCaptureModeRelaxed);
+    if (UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+      TraceRunImpl();
+    } else {
+      MultiThreadRunImpl();
+    }
+    entry.graph = platform::EndCUDAGraphCapture();
+  } catch (std::exception& ex) {
+    if (platform::IsCUDAGraphCapturing()) {
+      try {
+        platform::EndCUDAGraphCapture();
+      } catch (...) {
+      }
+    }
+    LOG(WARNING) << "Failed to capture the CUDA Graph, the instructions run "
+                    "without CUDA Graph from now on: "
+                 << ex.what();
+    auto_cuda_graph_enabled_ = false;
+    ReleaseCUDAGraphs(0);
+    return false;
+  }
+  for (auto& fetch_var_name : fetch_var_names_) {
+    auto* fetch_var = InnerScope()->FindVar(fetch_var_name);
+    entry.fetch_bindings.emplace_back();
+    if (fetch_var != nullptr && fetch_var->IsType<phi::DenseTensor>()) {
+      entry.fetch_bindings.back().ShareDataWith(
+          fetch_var->Get<phi::DenseTensor>());
+    }
+  }
+  // nothing is run during the capture
+  entry.graph->Replay();
+  cuda_graphs_.push_front(std::move(entry));
+  return true;
+#else
+  return false;
+#endif
+}
+
+void PirInterpreter::ReleaseCUDAGraphs(size_t num_kept) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (cuda_graphs_.size() <= num_kept) {
+    return;
+  }
+  // The outputs of the instructions may still hold the memory pool of a
+  // graph, they are allocated again by the next run.
+  ClearInstructionOutputs();
+  while (cuda_graphs_.size() > num_kept) {
+    cuda_graphs_.pop_back();
+  }
+#endif
+}
+
+void PirInterpreter::ClearInstructionOutputs() {
+  for (auto& instr : vec_instruction_base_) {
+    for (auto& item : instr->Outputs()) {
+      for (auto var_id : item.second) {
+        if (parameter_var_names_.count(value_exe_info_->GetNameById(var_id))) {
+          continue;
+        }
+        auto* var = value_exe_info_->GetVarList()[var_id];
+        if (var->IsType<phi::DenseTensor>()) {
+          var->GetMutable<phi::DenseTensor>()->clear();
+        }
+      }
+    }
+  }
+}
+
 void PirInterpreter::ClearLoDTensorArrayInLocalScope() {
   auto vars = local_scope_->LocalVars();
   for (auto var : vars) {
@@ -805,6 +992,9 @@ void PirInterpreter::BuildInstruction() {
   VLOG(6) << "Build Instructions for pir ... ";
   vec_instruction_base_.clear();
   size_t op_idx = 0;
+  // (slot, id, op) of the phi kernel instructions built after the loop
+  bool build_phi_kernel_later = FLAGS_pir_build_instruction_threads > 1;
+  std::vector<std::tuple<size_t, size_t, pir::Operation*>> phi_kernel_ops;
   for (auto& op : *ir_block_) {
     VLOG(6) << "Build Instruction for op: " << op_idx;
     if (op.dialect()->name() == "builtin") {
@@ -927,6 +1117,10 @@ void PirInterpreter::BuildInstruction() {
 
       if (op.isa<paddle::dialect::LegacyKernelOp>()) {  // NOLINT
         CREATE_INSTR(LegacyKernelInstruction);
+      } else if (build_phi_kernel_later) {
+        phi_kernel_ops.emplace_back(
+            vec_instruction_base_.size(), op_idx++, &op);
+        vec_instruction_base_.emplace_back(nullptr);
       } else {
         CREATE_INSTR(PhiKernelInstruction);
       }
@@ -960,6 +1154,53 @@ void PirInterpreter::BuildInstruction() {
           "and cinn dialect."));
     }
   }
+  BuildPhiKernelInstructions(phi_kernel_ops);
+}
+
+void PirInterpreter::BuildPhiKernelInstructions(
+    const std::vector<std::tuple<size_t, size_t, pir::Operation*>>& ops) {
+  // NOTE: The phi kernel instructions, the most of a large program, only
+  // read the program and the scope when they are built, so they are built
+  // on several threads, each into its own slot. The errors are thrown in the
+  // order of the ops, as on one thread.
+  if (ops.empty()) {
+    return;
+  }
+  size_t num_threads = std::min(
+      static_cast<size_t>(std::max(FLAGS_pir_build_instruction_threads, 1)),
+      ops.size());
+  std::atomic<size_t> next_op{0};
+  std::vector<std::exception_ptr> errors(ops.size());
+  auto build = [&](bool set_device) {
+    for (size_t i = next_op++; i < ops.size(); i = next_op++) {
+      auto [slot, id, op] = ops[i];
+      try {
+        if (set_device) {
+          SetDeviceId(place_);
+          set_device = false;
+        }
+        vec_instruction_base_[slot] = std::make_unique<PhiKernelInstruction>(
+            id, place_, op, value_exe_info_.get());
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers.emplace_back(build, true);
+  }
+  build(false);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  VLOG(6) << "Build " << ops.size() << " phi kernel instructions on "
+          << num_threads << " threads";
 }
 
 std::string PirInterpreter::DebugInstructions() {
@@ -1145,9 +1386,24 @@ void PirInterpreter::RecordMemcpyD2H(InstructionBase* instr_node) {
 }
 
 void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
-#if !defined(PADDLE_WITH_CUDA) && !defined(PADDLE_WITH_HIP)
+#if !defined(PADDLE_WITH_CUDA) && !defined(PADDLE_WITH_HIP) && \
+    !defined(PADDLE_WITH_XPU)
   PADDLE_THROW(common::errors::Unimplemented(
-      "RecordStreamForGC is only implemented when compiled with GPU."));
+      "RecordStreamForGC is only implemented when compiled with GPU or XPU."));
+#else
+#if defined(PADDLE_WITH_XPU)
+  // the XPU always uses the fast GC, and runs on one stream unless
+  // FLAGS_xpu_enable_multi_stream
+  if (!FLAGS_xpu_enable_multi_stream ||
+      instr->KernelType() != OpFuncType::kGpuAsync ||
+      !phi::is_xpu_place(instr->DeviceContext().GetPlace())) {
+    return;
+  }
+  phi::RecordEvent record(
+      "RecordStreamForGC", phi::TracerEventType::UserDefined, 10);
+
+  XPUStream stream =
+      reinterpret_cast<const phi::XPUContext&>(instr->DeviceContext()).stream();
 #else
   if (!IsInterpretercoreFastGCEnabled() ||
       instr->KernelType() != OpFuncType::kGpuAsync) {
@@ -1184,6 +1440,7 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
       }
     }
   }
+#endif
 #endif
   auto TensorRecordStream = [&stream](phi::DenseTensor& tensor) {
     auto allocation = tensor.Holder();
@@ -1192,7 +1449,7 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
     }
 
     const phi::Place& place = allocation->place();
-    if (phi::is_gpu_place(place)) {
+    if (phi::is_gpu_place(place) || phi::is_xpu_place(place)) {
       memory::RecordStream(allocation, stream);
     } else if (phi::is_cuda_pinned_place(place)) {
       // TODO(Ruibiao): Here should do something to make sure that the tensor
@@ -1208,6 +1465,34 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
     }
   };
 
+  RecordStreamForGCVars(instr, TensorRecordStream);
+#endif
+}
+
+void PirInterpreter::RecordCustomStreamForGC(InstructionBase* instr) {
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+  if (!custom_device_fast_gc_ ||
+      instr->KernelType() != OpFuncType::kGpuAsync ||
+      !phi::is_custom_place(instr->DeviceContext().GetPlace())) {
+    return;
+  }
+  phi::RecordEvent record(
+      "RecordCustomStreamForGC", phi::TracerEventType::UserDefined, 10);
+
+  phi::stream::stream_t stream =
+      static_cast<const phi::CustomContext&>(instr->DeviceContext()).stream();
+  RecordStreamForGCVars(instr, [stream](phi::DenseTensor& tensor) {
+    auto allocation = tensor.Holder();
+    if (allocation != nullptr && phi::is_custom_place(allocation->place())) {
+      memory::RecordStream(allocation, stream);
+    }
+  });
+#endif
+}
+
+void PirInterpreter::RecordStreamForGCVars(
+    InstructionBase* instr,
+    const std::function<void(phi::DenseTensor&)>& tensor_record_stream) {
   /* NOTE(Ruibiao)：Cross-stream tensor synchronization is required only when
    * all the following conditions are satisfied:
    * 1. The tensor will be GC after running the instruction, i.e., in
@@ -1245,31 +1530,31 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
     }
 
     if (var->IsType<phi::DenseTensor>()) {
-      TensorRecordStream(*(var->GetMutable<phi::DenseTensor>()));
+      tensor_record_stream(*(var->GetMutable<phi::DenseTensor>()));
     } else if (
         var->IsType<
             operators::reader::
                 OrderedMultiDeviceLoDTensorBlockingQueueHolder>()) {  // NOLINT
       // do nothing
     } else if (var->IsType<phi::SelectedRows>()) {
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SelectedRows>()->mutable_value()));
     } else if (var->IsType<phi::TensorArray>()) {
       auto* tensor_arr = var->GetMutable<phi::TensorArray>();
       for (auto& tensor : *tensor_arr) {
-        TensorRecordStream(tensor);
+        tensor_record_stream(tensor);
       }
     } else if (var->IsType<phi::SparseCooTensor>()) {
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SparseCooTensor>()->mutable_indices()));
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SparseCooTensor>()->mutable_values()));
     } else if (var->IsType<phi::SparseCsrTensor>()) {
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SparseCsrTensor>()->mutable_cols()));
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SparseCsrTensor>()->mutable_crows()));
-      TensorRecordStream(
+      tensor_record_stream(
           *(var->GetMutable<phi::SparseCsrTensor>()->mutable_values()));
     } else if (var->IsType<std::vector<Scope*>>()) {
       // do nothing
@@ -1279,15 +1564,18 @@ void PirInterpreter::RecordStreamForGC(InstructionBase* instr) {
           framework::ToTypeName(var->Type())));
     }
   }
-#endif
 }
 
 void PirInterpreter::CheckGC(InstructionBase* instr) {
   phi::RecordEvent record("CheckGC", phi::TracerEventType::UserDefined, 10);
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP) || \
+    defined(PADDLE_WITH_XPU)
   RecordStreamForGC(instr);
 #endif
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+  RecordCustomStreamForGC(instr);
+#endif
 
   for (auto var_id : instr->GCCheckVars()) {
     VLOG(4) << "GC:" << value_exe_info_->GetNameById(static_cast<int>(var_id))
@@ -1432,6 +1720,33 @@ void PirInterpreter::CalculateLastLiveOps() {
   VLOG(4) << "done CalculateLastLiveOps";
 }
 
+void PirInterpreter::UpdateCriticalPathPriority(
+    const std::vector<double>& latency) {
+  const std::map<size_t, std::set<size_t>>& downstream_map =
+      ir_dependency_builder_.OpDownstreamMap();
+  instr_bottom_levels_.assign(vec_instruction_base_.size(), 0.0);
+  // the downstream instructions always come after in vec_instruction_base_
+  for (size_t instr_id = vec_instruction_base_.size(); instr_id-- > 0;) {
+    double longest_downstream = 0.0;
+    auto iter = downstream_map.find(instr_id);
+    if (iter != downstream_map.end()) {
+      for (size_t next_instr_id : iter->second) {
+        longest_downstream =
+            std::max(longest_downstream, instr_bottom_levels_[next_instr_id]);
+      }
+    }
+    instr_bottom_levels_[instr_id] = latency[instr_id] + longest_downstream;
+  }
+  if (VLOG_IS_ON(6)) {
+    for (size_t instr_id = 0; instr_id < instr_bottom_levels_.size();
+         ++instr_id) {
+      VLOG(6) << "bottom level of " << instr_id << "["
+              << vec_instruction_base_[instr_id]->Name()
+              << "]: " << instr_bottom_levels_[instr_id];
+    }
+  }
+}
+
 void PirInterpreter::ConstructEventForJitInput() {
   for (size_t i = 0; i < dependency_count_->size(); ++i) {
     if ((*dependency_count_)[i] == 0) {
@@ -1488,6 +1803,7 @@ paddle::framework::FetchList PirInterpreter::Run(
 
   FeedInput();
 
+  bool run_by_cuda_graph = false;
   if (!is_build_ || switch_stream) {
     LOG_FIRST_N(INFO, 1) << "New Executor is Running ...";
     VLOG(4) << DebugValueInfo();
@@ -1520,10 +1836,13 @@ paddle::framework::FetchList PirInterpreter::Run(
     is_build_ = true;
     is_shared_results_build_ = true;
   } else {
-    if (UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
-      TraceRunImpl();
-    } else {
-      MultiThreadRunImpl();
+    run_by_cuda_graph = RunByCUDAGraph(feed_names);
+    if (!run_by_cuda_graph) {
+      if (UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+        TraceRunImpl();
+      } else {
+        MultiThreadRunImpl();
+      }
     }
   }
 
@@ -1538,7 +1857,18 @@ paddle::framework::FetchList PirInterpreter::Run(
     for (auto& var_name : fetch_var_names_) {
       auto* var = inner_scope->FindVar(var_name);
       VLOG(4) << "fetch " << var_name << "[" << var << "]";
-      fetch_res.push_back(var->Get<phi::DenseTensor>());
+      if (run_by_cuda_graph) {
+        // the fetch is overwritten by the next replay
+        phi::DenseTensor fetch_tensor;
+        phi::Copy(*phi::DeviceContextPool::Instance().Get(place_),
+                  var->Get<phi::DenseTensor>(),
+                  place_,
+                  false,
+                  &fetch_tensor);
+        fetch_res.push_back(fetch_tensor);
+      } else {
+        fetch_res.push_back(var->Get<phi::DenseTensor>());
+      }
     }
   }
 
@@ -1566,6 +1896,7 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
   platform::RegisterModelLayout(ir_block_, place_);
 #endif
 
+  bool run_by_cuda_graph = false;
   if (!is_build_ || switch_stream) {
     LOG_FIRST_N(INFO, 1) << "New Executor is Running ...";
     VLOG(4) << DebugValueInfo();
@@ -1599,10 +1930,13 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
     is_build_ = true;
     is_shared_results_build_ = true;
   } else {
-    if (UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
-      TraceRunImpl();
-    } else {
-      MultiThreadRunImpl();
+    run_by_cuda_graph = RunByCUDAGraph(feed_names);
+    if (!run_by_cuda_graph) {
+      if (UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+        TraceRunImpl();
+      } else {
+        MultiThreadRunImpl();
+      }
     }
   }
 
@@ -1618,7 +1952,18 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
     for (auto& var_name : fetch_var_names_) {
       auto* var = inner_scope->FindVar(var_name);
       VLOG(4) << "fetch " << var_name << "[" << var << "]";
-      fetch_res.push_back(var->Get<phi::DenseTensor>());
+      if (run_by_cuda_graph) {
+        // the fetch is overwritten by the next replay
+        phi::DenseTensor fetch_tensor;
+        phi::Copy(*phi::DeviceContextPool::Instance().Get(place_),
+                  var->Get<phi::DenseTensor>(),
+                  place_,
+                  false,
+                  &fetch_tensor);
+        fetch_res.push_back(fetch_tensor);
+      } else {
+        fetch_res.push_back(var->Get<phi::DenseTensor>());
+      }
     }
 
     VLOG(4) << "get fetch list size: " << fetch_res.size();
@@ -1630,13 +1975,23 @@ void PirInterpreter::TraceRunImpl() {
   // lazy initialization of gc, do not create gc is the program only run once
   if (!gc_) {
     gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_base_);
+    custom_device_fast_gc_ = IsCustomDeviceFastGCEnabled(place_);
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
   VLOG(4) << "Tracing Instruction List";
 
+  if (memory_planner_) {
+    memory_planner_->BeginRun();
+  }
+  if (managed_prefetcher_) {
+    managed_prefetcher_->BeginRun();
+  }
   TraceRunInstructionList(vec_instruction_base_);
   VLOG(4) << "Done TraceRunInstructionList";
+  if (memory_planner_) {
+    memory_planner_->EndRun();
+  }
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
   if (phi::is_custom_place(place_)) {
     phi::DeviceContextPool::Instance().Get(place_)->Wait();
@@ -1648,14 +2003,31 @@ void PirInterpreter::MultiThreadRunImpl() {
   // lazy initialization of gc, do not create gc is the program only run once
   if (!gc_) {
     gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_base_);
+    custom_device_fast_gc_ = IsCustomDeviceFastGCEnabled(place_);
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
   VLOG(4) << "Multi Thread Run Instruction List";
 
   async_work_queue_ = GetWorkQueue();
+  if (runs_before_latency_profile_ == 0) {
+    instr_latency_us_.assign(vec_instruction_base_.size(), 0.0);
+    profile_instr_latency_ = true;
+  }
   MultiThreadRunInstructionList(vec_instruction_base_);
   VLOG(4) << "Done MultiThreadRunInstructionList";
+  if (profile_instr_latency_) {
+    profile_instr_latency_ = false;
+    // 1us for the dispatch of an instruction
+    for (auto& latency : instr_latency_us_) {
+      latency += 1.0;
+    }
+    UpdateCriticalPathPriority(instr_latency_us_);
+    VLOG(4) << "Update critical path priority by the profiled latency";
+  }
+  if (runs_before_latency_profile_ >= 0) {
+    --runs_before_latency_profile_;
+  }
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
   if (phi::is_custom_place(place_)) {
     phi::DeviceContextPool::Instance().Get(place_)->Wait();
@@ -1744,16 +2116,28 @@ void PirInterpreter::MultiThreadRunInstructionList(
     }
   }
 
+  std::vector<size_t> root_instr_ids;
   for (size_t i = 0; i < dependency_count_->size(); ++i) {
     if ((*dependency_count_)[i] == 0) {
-      // NOTE(zhiqiu): hot fix for jit input var
-      RecordMemcpyD2H(vec_instr.at(i).get());
-      if (FLAGS_new_executor_serial_run) {
-        RunInstructionBaseAsync(i);
-      } else {
-        async_work_queue_->AddTask(vec_instr.at(i)->KernelType(),
-                                   [this, i] { RunInstructionBaseAsync(i); });
-      }
+      root_instr_ids.push_back(i);
+    }
+  }
+  if (!instr_bottom_levels_.empty()) {
+    // dispatch the ones on the critical path first
+    std::sort(root_instr_ids.begin(),
+              root_instr_ids.end(),
+              [this](size_t lhs, size_t rhs) {
+                return ir_instruction_scheduling_priority_less(rhs, lhs);
+              });
+  }
+  for (size_t i : root_instr_ids) {
+    // NOTE(zhiqiu): hot fix for jit input var
+    RecordMemcpyD2H(vec_instr.at(i).get());
+    if (FLAGS_new_executor_serial_run) {
+      RunInstructionBaseAsync(i);
+    } else {
+      async_work_queue_->AddTask(vec_instr.at(i)->KernelType(),
+                                 [this, i] { RunInstructionBaseAsync(i); });
     }
   }
 
@@ -1860,8 +2244,30 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
     return deps_[next_id]->CheckAndDecrease();
   };
 
-  for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
-    if (IsReady(next_instr_id)) {
+  if (instr_bottom_levels_.empty()) {
+    for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+      if (IsReady(next_instr_id)) {
+        async_work_queue_->AddTask(
+            vec_instruction_base_[next_instr_id]->KernelType(),
+            [this, next_instr_id]() {
+              RunInstructionBaseAsync(next_instr_id);
+            });
+      }
+    }
+  } else {
+    // dispatch the ones on the critical path first
+    std::vector<size_t> ready_instr_ids;
+    for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+      if (IsReady(next_instr_id)) {
+        ready_instr_ids.push_back(next_instr_id);
+      }
+    }
+    std::sort(ready_instr_ids.begin(),
+              ready_instr_ids.end(),
+              [this](size_t lhs, size_t rhs) {
+                return ir_instruction_scheduling_priority_less(rhs, lhs);
+              });
+    for (size_t next_instr_id : ready_instr_ids) {
       async_work_queue_->AddTask(
           vec_instruction_base_[next_instr_id]->KernelType(),
           [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
@@ -1921,10 +2327,27 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
     }
 
     if (!instr_node->IsArtificial()) {
+      memory::AllocationTraceOpGuard trace_op_guard(instr_node->Name());
       {
         phi::RecordEvent record(
             "InstrRun", phi::TracerEventType::UserDefined, 10);
-        instr_node->Run();
+        if (memory_planner_) {
+          memory_planner_->BeforeRunInstruction(instr_node);
+        }
+        if (managed_prefetcher_) {
+          managed_prefetcher_->BeforeRunInstruction(instr_node);
+        }
+        if (UNLIKELY(profile_instr_latency_)) {
+          auto start = std::chrono::steady_clock::now();
+          instr_node->Run();
+          instr_node->DeviceContext().Wait();
+          instr_latency_us_[instr_node->Id()] =
+              std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+        } else {
+          instr_node->Run();
+        }
       }
 
       if (instr_node->IsSyncAfterLaunch()) {
@@ -1938,6 +2361,9 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
       if (FLAGS_check_nan_inf) {
         CheckTensorHasNanOrInf(instr_node, scope_, value_exe_info_.get());
       }
+      if (memory_planner_) {
+        memory_planner_->AfterRunInstruction(instr_node);
+      }
       VLOG(2) << "\ndone: " << __func__ << " OP id:" << instr_node->Id()
               << " name:" << instr_node->Name() << " type:"
               << (instr_node->KernelType() == OpFuncType::kCpuSync
@@ -2007,6 +2433,14 @@ void PirInterpreter::PreAnalysis() {
   BuildInstructionDependences();
   VLOG(4) << "Done BuildInstructionDependences";
 
+  if (FLAGS_pir_critical_path_scheduling) {
+    // every instruction costs the same before its latency is profiled
+    UpdateCriticalPathPriority(
+        std::vector<double>(vec_instruction_base_.size(), 1.0));
+    runs_before_latency_profile_ = 1;
+    VLOG(4) << "Done UpdateCriticalPathPriority";
+  }
+
   ir_stream_analyzer_.SetForceEventsToWaitInfo(force_events_to_wait_);
   ir_stream_analyzer_.ConstructEvents(vec_instruction_base_);
   VLOG(4) << "Done ConstructEvents";
@@ -2041,6 +2475,77 @@ void PirInterpreter::PreAnalysis() {
 
   UpdateOneDNNOpNum();
   VLOG(4) << "Done UpdateOneDNNOpNum";
+
+  if (FLAGS_pir_static_memory_plan_buckets > 0 &&
+      UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+    std::unordered_set<size_t> parameter_var_ids;
+    for (auto& name : parameter_var_names_) {
+      int var_id = value_exe_info_->GetIdByName(name);
+      if (var_id != -1) {
+        parameter_var_ids.insert(var_id);
+      }
+    }
+    std::unordered_set<size_t> skip_gc_var_ids;
+    for (auto& name : execution_config_.skip_gc_vars) {
+      int var_id = value_exe_info_->GetIdByName(name);
+      if (var_id != -1) {
+        skip_gc_var_ids.insert(var_id);
+      }
+    }
+    memory_planner_ = std::make_unique<interpreter::StaticMemoryPlanner>(
+        place_, FLAGS_pir_static_memory_plan_buckets);
+    memory_planner_->Analyze(vec_instruction_base_,
+                             trace_execute_order_,
+                             last_live_ops_,
+                             value_exe_info_->GetVarList(),
+                             parameter_var_ids,
+                             skip_gc_var_ids);
+    VLOG(4) << "Done StaticMemoryPlanner Analyze";
+  }
+
+  // The tensors are placed in managed memory before the program is built,
+  // e.g. the parameters after the startup program.
+  if (FLAGS_pir_managed_prefetch_lookahead > 0 && phi::is_gpu_place(place_) &&
+      memory::ManagedMemoryAdvisor::Instance().enabled() &&
+      UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+    managed_prefetcher_ =
+        std::make_unique<interpreter::ManagedMemoryPrefetcher>(
+            FLAGS_pir_managed_prefetch_lookahead);
+    managed_prefetcher_->Analyze(vec_instruction_base_,
+                                 trace_execute_order_,
+                                 value_exe_info_->GetVarList());
+    VLOG(4) << "Done ManagedMemoryPrefetcher Analyze";
+  }
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // Only the instructions launching on the stream of the capture can be
+  // replayed, the host part of the others would run only once.
+  auto_cuda_graph_enabled_ = FLAGS_pir_auto_cuda_graph_max_graphs > 0 &&
+                             phi::is_gpu_place(place_) &&
+                             !FLAGS_new_executor_use_cuda_graph &&
+                             IsInterpretercoreFastGCEnabled() &&
+                             memory_planner_ == nullptr &&
+                             managed_prefetcher_ == nullptr;
+  const phi::DeviceContext* capture_dev_ctx =
+      auto_cuda_graph_enabled_ ? phi::DeviceContextPool::Instance().Get(place_)
+                               : nullptr;
+  for (auto& instr : vec_instruction_base_) {
+    if (!auto_cuda_graph_enabled_) {
+      break;
+    }
+    if (instr->Name() == "builtin_combine_instruction") {
+      continue;
+    }
+    if (instr->KernelType() != OpFuncType::kGpuAsync ||
+        &instr->DeviceContext() != capture_dev_ctx ||
+        instr->IsSyncAfterLaunch()) {
+      VLOG(4) << "Run without CUDA Graph since " << instr->Name()
+              << " can not be captured";
+      auto_cuda_graph_enabled_ = false;
+    }
+  }
+  VLOG(4) << "Done analyze auto CUDA Graph: " << auto_cuda_graph_enabled_;
+#endif
 }
 
 ::pir::Value PirInterpreter::GetValueByName(const std::string& var_name) {
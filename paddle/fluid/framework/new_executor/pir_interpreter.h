@@ -13,12 +13,18 @@
 // limitations under the License.
 
 #pragma once
+#include <functional>
+#include <list>
 #include <memory>
+#include <tuple>
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/managed_memory_prefetcher.h"
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
 #include "paddle/fluid/framework/new_executor/interpreter_base_impl.h"
 #include "paddle/pir/include/core/value.h"
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/core/platform/cuda_graph_with_memory_pool.h"
 #include "paddle/phi/kernels/autotune/gpu_timer.h"
 #endif
 
@@ -94,6 +100,11 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   Scope* InnerScope() const;
 
+  // nullptr if the static memory plan is not enabled.
+  const interpreter::StaticMemoryPlanner* MemoryPlanner() const {
+    return memory_planner_.get();
+  }
+
   const phi::Place& GetPlace() const override { return place_; }
 
   void SetOutputHooks(const std::vector<HookFunc>& hookfuncs) override {}
@@ -136,12 +147,23 @@ class PirInterpreter : public InterpreterBaseImpl {
   void AnalyzeForceSyncOps();
   void ConstructEventForJitInput();
   void CalculateLastLiveOps();
+  // Sets the bottom level of every instruction, i.e. the sum of latency on
+  // its longest path to a sink, used to break the ties of the scheduling
+  // priority.
+  void UpdateCriticalPathPriority(const std::vector<double>& latency);
 
   // gc
   void ClearLoDTensorArrayInLocalScope();
 
   // cuda graph
   void CheckCUDAGraphBeforeRun(const std::vector<std::string>& feed_names);
+  // Runs the instructions by the CUDA Graph of the feed shapes when
+  // FLAGS_pir_auto_cuda_graph_max_graphs > 0, returns false if they are not.
+  bool RunByCUDAGraph(const std::vector<std::string>& feed_names);
+  // Keeps the num_kept most recently used CUDA Graphs.
+  void ReleaseCUDAGraphs(size_t num_kept);
+  // Clears the outputs of the instructions except the parameters.
+  void ClearInstructionOutputs();
   void PrepareForCUDAGraphCapture();
 
   void Build(const std::vector<std::string>& feed_names,
@@ -188,6 +210,7 @@ class PirInterpreter : public InterpreterBaseImpl {
   std::shared_ptr<EventsWaiter::EventNotifier> completion_notifier_{nullptr};
 
   std::unique_ptr<InterpreterCoreGarbageCollector> gc_;
+  bool custom_device_fast_gc_{false};
 
   // last_live_ops_[i] contains the id of operators that last access the i-th
   // var
@@ -224,6 +247,11 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void BuildInstruction();
 
+  // Builds the phi kernel instructions of the (slot, id, op) into their slots
+  // of vec_instruction_base_ on FLAGS_pir_build_instruction_threads threads.
+  void BuildPhiKernelInstructions(
+      const std::vector<std::tuple<size_t, size_t, pir::Operation*>>& ops);
+
   void BuildInstructionDependences();
 
   void TraceRunImpl();
@@ -251,6 +279,14 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void RecordStreamForGC(InstructionBase* instr);
 
+  // Records the stream of a custom device instruction on the vars it frees,
+  // for the fast GC of the custom devices ordering their streams by events.
+  void RecordCustomStreamForGC(InstructionBase* instr);
+
+  void RecordStreamForGCVars(
+      InstructionBase* instr,
+      const std::function<void(phi::DenseTensor&)>& tensor_record_stream);
+
   void SolvePersistableVarNames();
 
   const interpreter::PirDependencyBuilder& GetPirDependencyBuilder() const;
@@ -259,6 +295,13 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   InstructionSchedulingPriorityLess ir_instruction_scheduling_priority_less;
 
+  // Only filled when FLAGS_pir_critical_path_scheduling is set, the latency
+  // of the instructions is profiled in the run after the build one.
+  std::vector<double> instr_bottom_levels_;
+  std::vector<double> instr_latency_us_;
+  int runs_before_latency_profile_{-1};
+  bool profile_instr_latency_{false};
+
   const ::pir::Block* ir_block_{nullptr};
 
   std::unordered_map<::pir::Block*, PirInterpreter*> sub_blocks_;  // Not owned
@@ -280,8 +323,32 @@ class PirInterpreter : public InterpreterBaseImpl {
   // belongs to a parameter and cannot GC.
   std::unordered_set<std::string> parameter_var_names_;
 
+  // Only created when FLAGS_pir_static_memory_plan_buckets > 0 and the
+  // instructions run in trace mode.
+  std::unique_ptr<interpreter::StaticMemoryPlanner> memory_planner_;
+
+  // Only created when FLAGS_pir_managed_prefetch_lookahead > 0 and the
+  // instructions run in trace mode on GPU.
+  std::unique_ptr<interpreter::ManagedMemoryPrefetcher> managed_prefetcher_;
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   std::unique_ptr<phi::CalculateStreamTimer> calculate_stream_timer_;
+
+  struct CUDAGraphEntry {
+    // dtype, rank and dims of every feed
+    std::vector<int64_t> feed_key;
+    // the feeds are copied into them before a replay
+    std::vector<phi::DenseTensor> feed_buffers;
+    // the fetches written by the graph, which are shared by the fetch vars
+    // again before a replay since another graph may have rebound them
+    std::vector<phi::DenseTensor> fetch_bindings;
+    std::unique_ptr<platform::CUDAGraph> graph;
+  };
+  bool auto_cuda_graph_enabled_{false};
+  // the feed keys which have been run once without CUDA Graph
+  std::set<std::vector<int64_t>> cuda_graph_warmed_up_keys_;
+  // the most recently used first
+  std::list<CUDAGraphEntry> cuda_graphs_;
 #endif
   size_t last_calculate_instr_id_;
   bool enable_job_schedule_profiler_;
@@ -22,6 +22,7 @@
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/kernel_context.h"
+#include "paddle/phi/core/memory/allocation_trace.h"
 #include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
@@ -1176,6 +1177,8 @@ void ProgramInterpreter::RunInstruction(const Instruction& instr_node) {
 #endif
 
     if (!instr_node.IsArtificial()) {
+      memory::AllocationTraceOpGuard trace_op_guard(
+          instr_node.OpBase()->Type());
       RunOperator(instr_node);
       CheckGC(instr_node);
       if (FLAGS_log_memory_stats) {
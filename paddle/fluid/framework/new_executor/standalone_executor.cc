@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "paddle/fluid/framework/new_executor/standalone_executor.h"
 #include "paddle/common/flags.h"
+#include "paddle/fluid/framework/details/nan_inf_utils_detail.h"
 #include "paddle/fluid/framework/feed_hook.h"
 #include "paddle/fluid/framework/new_executor/feed_fetch_utils.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
@@ -24,6 +25,8 @@
 
 #include "paddle/fluid/ir_adaptor/translator/translate.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/remove_redundant_transfer_pass.h"
+#include "paddle/fluid/pir/transforms/general/while_loop_invariant_code_motion_pass.h"
 #include "paddle/pir/include/core/program.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_manager.h"
@@ -31,6 +34,8 @@
 COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_api);
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_remove_redundant_transfer);
+COMMON_DECLARE_bool(pir_while_hoist_invariant);
 
 namespace paddle::framework {
 StandaloneExecutor::StandaloneExecutor(const phi::Place& place,
@@ -116,6 +121,18 @@ StandaloneExecutor::StandaloneExecutor(const phi::Place& place,
       std::shared_ptr<pir::Program> shared_program = std::move(kernel_program);
       plan_.SetIrProgram("job_" + std::to_string(job_idx), shared_program);
 
+      if (FLAGS_pir_while_hoist_invariant) {
+        pir::PassManager pm(pir::IrContext::Instance(), 3);
+        pm.AddPass(pir::CreateWhileLoopInvariantCodeMotionPass());
+        pm.Run(shared_program.get());
+      }
+
+      if (FLAGS_pir_remove_redundant_transfer) {
+        pir::PassManager pm(pir::IrContext::Instance(), 3);
+        pm.AddPass(pir::CreateRemoveRedundantTransferPass());
+        pm.Run(shared_program.get());
+      }
+
       if (FLAGS_pir_apply_inplace_pass) {
         pir::PassManager pm(pir::IrContext::Instance(), 3);
         pm.AddPass(pir::CreateInplacePass());
@@ -267,6 +284,8 @@ paddle::framework::FetchList StandaloneExecutor::Run(
   }
 #endif
 
+  details::StepDeferredNanInf();
+
   // return Fetch Tensors
   if (FLAGS_enable_pir_in_executor) {
     framework::FetchList fetch_res;
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
 #include <vector>
@@ -17,6 +18,8 @@
 #include "paddle/fluid/framework/new_executor/workqueue/event_count.h"
 #include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
 
@@ -33,6 +36,8 @@ class ThreadPoolTempl {
                   int num_threads,
                   bool allow_spinning,
                   bool always_spinning,
+                  bool numa_aware = false,
+                  bool bind_threads = false,
                   Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
@@ -60,6 +65,11 @@ class ThreadPoolTempl {
     }
     for (int i = 0; i < num_threads_; i++) {
       SetStealPartition(i, EncodePartition(0, num_threads_));
+    }
+    if (numa_aware || bind_threads) {
+      PlaceThreads(numa_aware, bind_threads);
+    }
+    for (int i = 0; i < num_threads_; i++) {
       thread_data_[i].thread.reset(
           env_.CreateThread([this, i]() { WorkerLoop(i); }));
     }
@@ -156,6 +166,21 @@ class ThreadPoolTempl {
 
   size_t NumThreads() const { return num_threads_; }
 
+  std::vector<WorkQueueThreadStats> GetThreadStats() const {
+    std::vector<WorkQueueThreadStats> stats(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+      const ThreadData& td = thread_data_[i];
+      stats[i].numa_node = td.numa_node;
+      stats[i].cpu = td.cpus.size() == 1 ? td.cpus[0] : -1;
+      stats[i].own_tasks = td.own_tasks.load(std::memory_order_relaxed);
+      stats[i].local_steals = td.local_steals.load(std::memory_order_relaxed);
+      stats[i].global_steals =
+          td.global_steals.load(std::memory_order_relaxed);
+      stats[i].idle_waits = td.idle_waits.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
   int CurrentThreadId() const {
     const PerThread* pt = const_cast<ThreadPoolTempl*>(this)->GetPerThread();
     if (pt->pool == this) {
@@ -226,12 +251,62 @@ class ThreadPoolTempl {
   };
 
   struct ThreadData {
-    constexpr ThreadData() : thread(), steal_partition(0), queue() {}
+    ThreadData() : thread(), steal_partition(0), queue() {}
     std::unique_ptr<Thread> thread;
     std::atomic<unsigned> steal_partition;
     Queue queue;
+    // Placement, fixed before the thread starts.
+    int numa_node{-1};
+    std::vector<int> cpus;
+    // Scheduling counters, only written by the owner thread.
+    std::atomic<uint64_t> own_tasks{0};
+    std::atomic<uint64_t> local_steals{0};
+    std::atomic<uint64_t> global_steals{0};
+    std::atomic<uint64_t> idle_waits{0};
   };
 
+  static inline void IncreaseCounter(std::atomic<uint64_t>* counter) {
+    counter->store(counter->load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+  }
+
+  // Assign threads to NUMA nodes and cores. Threads of the same node get
+  // contiguous ids, so that a node maps to one steal partition and
+  // LocalSteal() only touches queues of the local node.
+  void PlaceThreads(bool numa_aware, bool bind_threads) {
+    const std::vector<std::vector<int>>& nodes = GetNumaNodeCpus();
+    if (numa_aware && nodes.size() > 1) {
+      const int num_nodes = static_cast<int>(nodes.size());
+      // Never create more groups than threads.
+      const int num_groups = std::min(num_nodes, num_threads_);
+      for (int group = 0; group < num_groups; ++group) {
+        unsigned start = group * num_threads_ / num_groups;
+        unsigned limit = (group + 1) * num_threads_ / num_groups;
+        for (unsigned i = start; i < limit; ++i) {
+          const std::vector<int>& node_cpus = nodes[group];
+          thread_data_[i].numa_node = group;
+          if (bind_threads) {
+            thread_data_[i].cpus = {node_cpus[(i - start) % node_cpus.size()]};
+          } else {
+            thread_data_[i].cpus = node_cpus;
+          }
+          SetStealPartition(i, EncodePartition(start, limit));
+        }
+      }
+      VLOG(1) << name_ << " places " << num_threads_ << " threads on "
+              << num_groups << " NUMA nodes";
+    } else if (bind_threads) {
+      std::vector<int> all_cpus;
+      for (const auto& node_cpus : nodes) {
+        all_cpus.insert(all_cpus.end(), node_cpus.begin(), node_cpus.end());
+      }
+      for (int i = 0; i < num_threads_; ++i) {
+        thread_data_[i].numa_node = numa_aware ? 0 : -1;
+        thread_data_[i].cpus = {all_cpus[i % all_cpus.size()]};
+      }
+    }
+  }
+
   Environment env_;
   const bool allow_spinning_;
   const bool always_spinning_;
@@ -250,11 +325,15 @@ class ThreadPoolTempl {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     phi::SetCurrentThreadName(thr_name);
+    ThreadData& td = thread_data_[thread_id];
+    if (!td.cpus.empty() && !BindCurrentThreadToCpus(td.cpus)) {
+      LOG(WARNING) << thr_name << " failed to set CPU affinity";
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
     pt->thread_id = thread_id;
-    Queue& q = thread_data_[thread_id].queue;
+    Queue& q = td.queue;
     EventCount::Waiter* waiter = ec_.GetWaiter(thread_id);
     // TODO(dvyukov,rmlarsen): The time spent in NonEmptyQueueIndex() is
     // proportional to num_threads_ and we assume that new work is scheduled at
@@ -282,21 +361,30 @@ class ThreadPoolTempl {
           }
         }
         if (t.f) {
+          IncreaseCounter(&td.own_tasks);
           env_.ExecuteTask(t);
         }
       }
     } else {
       while (!cancelled_) {
         Task t = q.PopFront();
-        if (!t.f) {
+        if (t.f) {
+          IncreaseCounter(&td.own_tasks);
+        } else {
           t = LocalSteal();
-          if (!t.f) {
+          if (t.f) {
+            IncreaseCounter(&td.local_steals);
+          } else {
             t = GlobalSteal();
             if (!t.f) {
               if (allow_spinning_) {
                 for (int i = 0; i < spin_count && !t.f; i++) {
                   if (!cancelled_.load(std::memory_order_relaxed)) {
-                    t = GlobalSteal();
+                    // Prefer the local node while spinning as well.
+                    t = LocalSteal();
+                    if (!t.f) {
+                      t = GlobalSteal();
+                    }
                   } else {
                     return;
                   }
@@ -308,6 +396,9 @@ class ThreadPoolTempl {
                 }
               }
             }
+            if (t.f) {
+              IncreaseCounter(&td.global_steals);
+            }
           }
         }
         if (t.f) {
@@ -423,6 +514,7 @@ class ThreadPoolTempl {
     // Wait for work
     phi::RecordEvent record(
         "WaitForWork", phi::TracerEventType::UserDefined, 10);
+    IncreaseCounter(&thread_data_[GetPerThread()->thread_id].idle_waits);
     ec_.CommitWait(waiter);
     blocked_--;
     return true;
@@ -50,7 +50,9 @@ class WorkQueueImpl : public WorkQueue {
     queue_ = new NonblockingThreadPool(options_.name,
                                        static_cast<int>(options_.num_threads),
                                        options_.allow_spinning,
-                                       options_.always_spinning);
+                                       options_.always_spinning,
+                                       options_.numa_aware,
+                                       options_.bind_threads);
   }
 
   ~WorkQueueImpl() override {
@@ -81,6 +83,10 @@ class WorkQueueImpl : public WorkQueue {
 
   size_t NumThreads() const override { return queue_->NumThreads(); }
 
+  std::vector<WorkQueueThreadStats> ThreadStats() const override {
+    return queue_->GetThreadStats();
+  }
+
  private:
   NonblockingThreadPool* queue_{nullptr};
   TaskTracker* tracker_{nullptr};
@@ -101,6 +107,9 @@ class WorkQueueGroupImpl : public WorkQueueGroup {
 
   size_t QueueGroupNumThreads() const override;
 
+  std::vector<WorkQueueThreadStats> QueueThreadStats(
+      size_t queue_idx) const override;
+
   void Cancel() override;
 
  private:
@@ -142,7 +151,9 @@ WorkQueueGroupImpl::WorkQueueGroupImpl(
         NonblockingThreadPool(options.name,
                               static_cast<int>(options.num_threads),
                               options.allow_spinning,
-                              options.always_spinning);
+                              options.always_spinning,
+                              options.numa_aware,
+                              options.bind_threads);
   }
 }
 
@@ -193,6 +204,15 @@ size_t WorkQueueGroupImpl::QueueGroupNumThreads() const {
   return total_num;
 }
 
+std::vector<WorkQueueThreadStats> WorkQueueGroupImpl::QueueThreadStats(
+    size_t queue_idx) const {
+  assert(queue_idx < queues_.size());
+  if (!queues_.at(queue_idx)) {
+    return {};
+  }
+  return queues_.at(queue_idx)->GetThreadStats();
+}
+
 void WorkQueueGroupImpl::Cancel() {
   for (auto queue : queues_) {
     if (queue) {
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
@@ -102,6 +103,31 @@ struct WorkQueueOptions {
   // false and set events_waiter.
   bool detached{true};
   EventsWaiter* events_waiter{nullptr};  // not owned
+  // If numa_aware is set, worker threads are split into per-NUMA-node groups
+  // (contiguous thread ids per node), each group is restricted to the CPUs of
+  // its node, and idle threads steal from queues of the same node before
+  // falling back to remote nodes. It is a no-op on single-node machines.
+  bool numa_aware{false};
+  // Pin every worker thread to a single core. Combined with numa_aware, the
+  // cores are chosen round-robin among the CPUs of the thread's node.
+  bool bind_threads{false};
+};
+
+// Scheduling counters of one worker thread, used to check how well the
+// work-stealing and the topology-aware placement behave.
+struct WorkQueueThreadStats {
+  // NUMA node the thread is placed on, -1 if placement is not enabled.
+  int numa_node{-1};
+  // Core the thread is pinned to, -1 if the thread is not pinned to a core.
+  int cpu{-1};
+  // Tasks popped from the thread's own queue.
+  uint64_t own_tasks{0};
+  // Tasks stolen from threads of the same steal partition (NUMA node).
+  uint64_t local_steals{0};
+  // Tasks stolen from any thread of the pool after the local steal failed.
+  uint64_t global_steals{0};
+  // Number of times the thread blocked waiting for new work.
+  uint64_t idle_waits{0};
 };
 
 class WorkQueue {
@@ -136,6 +162,9 @@ class WorkQueue {
 
   virtual size_t NumThreads() const = 0;
 
+  // Snapshot of the per-thread scheduling counters, indexed by thread id.
+  virtual std::vector<WorkQueueThreadStats> ThreadStats() const = 0;
+
   virtual void Cancel() = 0;
 
  protected:
@@ -178,6 +207,10 @@ class WorkQueueGroup {
 
   virtual size_t QueueGroupNumThreads() const = 0;
 
+  // See WorkQueue::ThreadStats, empty for an uninitialized queue.
+  virtual std::vector<WorkQueueThreadStats> QueueThreadStats(
+      size_t queue_idx) const = 0;
+
   virtual void Cancel() = 0;
 
  protected:
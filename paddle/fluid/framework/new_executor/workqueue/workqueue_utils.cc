@@ -14,8 +14,21 @@
 
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "glog/logging.h"
 
 namespace paddle::framework {
 
@@ -55,4 +68,107 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+namespace {
+
+// Parse a sysfs cpulist such as "0-15,32-47".
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    try {
+      if (dash == std::string::npos) {
+        cpus.push_back(std::stoi(range));
+      } else {
+        int first = std::stoi(range.substr(0, dash));
+        int last = std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      }
+    } catch (const std::exception&) {
+      // ignore the trailing newline and malformed entries
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+std::vector<std::vector<int>> DetectNumaNodeCpus() {
+  std::vector<std::vector<int>> nodes;
+#if defined(__linux__)
+  const std::string node_root = "/sys/devices/system/node";
+  std::vector<int> node_ids;
+  DIR* dir = opendir(node_root.c_str());
+  if (dir != nullptr) {
+    while (struct dirent* entry = readdir(dir)) {
+      std::string name(entry->d_name);
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+          name.find_first_not_of("0123456789", 4) == std::string::npos) {
+        node_ids.push_back(std::stoi(name.substr(4)));
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(node_ids.begin(), node_ids.end());
+  for (int node_id : node_ids) {
+    std::ifstream fin(node_root + "/node" + std::to_string(node_id) +
+                      "/cpulist");
+    std::string list;
+    if (!fin.is_open() || !std::getline(fin, list)) {
+      continue;
+    }
+    std::vector<int> cpus = ParseCpuList(list);
+    if (!cpus.empty()) {
+      nodes.emplace_back(std::move(cpus));
+    }
+  }
+#endif
+  if (nodes.empty()) {
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < std::max(num_cpus, 1); ++cpu) {
+      cpus.push_back(cpu);
+    }
+    nodes.emplace_back(std::move(cpus));
+  }
+  VLOG(1) << "Detected " << nodes.size() << " NUMA node(s) for WorkQueue";
+  return nodes;
+}
+
+}  // namespace
+
+const std::vector<std::vector<int>>& GetNumaNodeCpus() {
+  static const std::vector<std::vector<int>> nodes = DetectNumaNodeCpus();
+  return nodes;
+}
+
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+  if (ret != 0) {
+    VLOG(1) << "pthread_setaffinity_np failed with error " << ret;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
 }  // namespace paddle::framework
@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -69,6 +70,15 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// CPU ids of every online NUMA node, ordered by node id. Nodes without CPUs
+// are skipped. Falls back to a single node holding all hardware threads when
+// the topology is not available (non-Linux or no sysfs).
+const std::vector<std::vector<int>>& GetNumaNodeCpus();
+
+// Restrict the calling thread to the given CPUs. Returns false if the
+// platform does not support it or the call fails.
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus);
+
 template <typename Notifier>
 class TaskTracker {
  public:
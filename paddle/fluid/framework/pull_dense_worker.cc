@@ -40,6 +40,10 @@ void PullDenseWorker::Initialize(const TrainerDesc& param) {
   threshold_ = param_.threshold();
   thread_num_ = param_.device_num();
   sleep_time_ms_ = param_.sleep_time_ms();
+#if !defined(PADDLE_WITH_CUDA) && !defined(PADDLE_WITH_HIP) && \
+    !defined(PADDLE_WITH_XPU)
+  double_buffer_ = param_.double_buffer();
+#endif
   for (int i = 0; i < dwp_param_.program_config(0).pull_dense_table_id_size();
        ++i) {
     uint64_t tid = static_cast<uint64_t>(
@@ -103,9 +107,41 @@ void PullDenseWorker::CreatePinVar() {
 #endif
     }
   }
+#else
+  if (!double_buffer_) {
+    return;
+  }
+  // the back buffers of the dense params on cpu
+  for (int i = 0; i < dwp_param_.program_config(0).pull_dense_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        dwp_param_.program_config(0).pull_dense_table_id(i));
+    for (auto& name : dense_value_names_[tid]) {
+      Variable* var = root_scope_->FindVar(name);
+      phi::DenseTensor* tensor = var->GetMutable<phi::DenseTensor>();
+      auto* ptr = root_scope_->Var(name + "pin");
+      InitializeVariable(ptr, proto::VarType::LOD_TENSOR);
+      phi::DenseTensor* pin_tensor = ptr->GetMutable<phi::DenseTensor>();
+      pin_tensor->mutable_data<float>(tensor->dims(), phi::CPUPlace());
+    }
+  }
 #endif
 }
 
+void PullDenseWorker::SwapDenseBuffer(uint64_t table_id) {
+  for (auto& name : dense_value_names_[table_id]) {
+    phi::DenseTensor* tensor =
+        root_scope_->FindVar(name)->GetMutable<phi::DenseTensor>();
+    phi::DenseTensor* pin_tensor =
+        root_scope_->FindVar(name + "pin")->GetMutable<phi::DenseTensor>();
+    // the ops running on the params keep reading the old buffer, which is
+    // pulled into next time
+    auto holder = tensor->MoveMemoryHolder();
+    tensor->ResetHolder(pin_tensor->MoveMemoryHolder());
+    pin_tensor->ResetHolder(holder);
+  }
+}
+
 void PullDenseWorker::Wait(std::vector<::std::future<int32_t>>* status_vec) {
   for (auto& t : *status_vec) {
     t.wait();
@@ -188,20 +224,29 @@ void PullDenseWorker::PullDense(bool force_update) {
                                      tid,
                                      dense_value_names_[tid],
                                      &pull_dense_status_,
-                                     true);
+                                     !double_buffer_);
 #else
       fleet_ptr_->PullDenseVarsAsync(*root_scope_,
                                      tid,
                                      dense_value_names_[tid],
                                      &pull_dense_status_,
-                                     true);
+                                     !double_buffer_);
 #endif
+      pulled_tables_.push_back(tid);
       ResetThreadVersion(tid);
     }
   }
   if (!pull_dense_status_.empty()) {
+    uint32_t fail_times = pull_dense_fail_times_;
     Wait(&pull_dense_status_);
+    // the params of a failed pull are not swapped in
+    if (double_buffer_ && pull_dense_fail_times_ == fail_times) {
+      for (auto tid : pulled_tables_) {
+        SwapDenseBuffer(tid);
+      }
+    }
   }
+  pulled_tables_.clear();
 }
 
 int PullDenseWorker::Start() {
@@ -807,6 +807,8 @@ phi::DataType GetDstPtrByDLDataType(DLDataType type) {
       if (type.code == kDLBool) return phi::DataType::BOOL;
       if (type.code == kDLInt) return phi::DataType::INT8;
       if (type.code == kDLUInt) return phi::DataType::UINT8;
+      if (type.code == kDLFloat8E4M3FN) return phi::DataType::FLOAT8_E4M3FN;
+      if (type.code == kDLFloat8E5M2) return phi::DataType::FLOAT8_E5M2;
       PADDLE_THROW(common::errors::Unimplemented(
           "DLDataType code <%d> is illegal when DLDataType.bits is <%d>.",
           type.code,
@@ -918,15 +920,21 @@ phi::DenseTensor TensorFromDLPack(DLManagedTensor* src, Deleter deleter) {
     place = phi::GPUPlace(src->dl_tensor.device.device_id);
   } else if (src->dl_tensor.device.device_type == kDLCUDAHost) {
     place = phi::GPUPinnedPlace();
+  } else if (src->dl_tensor.device.device_type == kDLROCM) {
+    place = phi::GPUPlace(src->dl_tensor.device.device_id);
+  } else if (src->dl_tensor.device.device_type == kDLROCMHost) {
+    place = phi::GPUPinnedPlace();
   } else {
     PADDLE_THROW(common::errors::Unimplemented("Given Place is not supported"));
   }
 
   ::DLDataType type = src->dl_tensor.dtype;
   auto dtype = GetDstPtrByDLDataType(type);
+  void* data =
+      static_cast<char*>(src->dl_tensor.data) + src->dl_tensor.byte_offset;
   if (!src->dl_tensor.strides) {
     return from_blob(
-        src->dl_tensor.data,
+        data,
         src,
         common::make_ddim(shape_vec),
         phi::DenseTensorMeta::calc_strides(common::make_ddim(shape_vec)),
@@ -938,7 +946,7 @@ phi::DenseTensor TensorFromDLPack(DLManagedTensor* src, Deleter deleter) {
     std::copy(src->dl_tensor.strides,
               src->dl_tensor.strides + src->dl_tensor.ndim,
               std::back_inserter(strides_vec));
-    return from_blob(src->dl_tensor.data,
+    return from_blob(data,
                      src,
                      common::make_ddim(shape_vec),
                      common::make_ddim(strides_vec),
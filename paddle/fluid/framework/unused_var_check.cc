@@ -69,6 +69,7 @@ static const std::unordered_set<std::string> &GetOpWithUnusedVarAllowSet() {
       "nce_grad",                           // 1
       "precision_recall",                   // 1
       "fusion_seqpool_cvm_concat",          // 2
+      "fusion_emb_seqpool_cvm_concat",      // 2
       "fused_batch_norm_act",               // 2
       "fused_batch_norm_act_grad",          // 2
       "data_norm",                          // 0
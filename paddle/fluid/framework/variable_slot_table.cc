@@ -0,0 +1,74 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/variable_slot_table.h"
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+
+namespace paddle::framework {
+
+VariableSlotTable::VariableSlotTable(const Scope& scope,
+                                     const std::vector<std::string>& names)
+    : scope_(&scope) {
+  slots_.reserve(names.size());
+  vars_.reserve(names.size());
+  for (const auto& name : names) {
+    Resolve(name);
+  }
+  VLOG(4) << "Resolve " << vars_.size() << " of " << names.size()
+          << " variables to slots in scope " << scope_;
+}
+
+int VariableSlotTable::Resolve(const std::string& name) {
+  PADDLE_ENFORCE_NOT_NULL(
+      scope_,
+      common::errors::PreconditionNotMet(
+          "The variable slot table should be built for a scope before "
+          "resolving variable %s.",
+          name));
+  auto it = slots_.find(name);
+  if (it != slots_.end()) {
+    return it->second;
+  }
+  Variable* var = scope_->FindVar(name);
+  if (var == nullptr) {
+    return kInvalidSlot;
+  }
+  return Bind(name, var);
+}
+
+int VariableSlotTable::Bind(const std::string& name, Variable* var) {
+  PADDLE_ENFORCE_NOT_NULL(
+      var,
+      common::errors::InvalidArgument(
+          "The variable %s bound to a slot should not be null.", name));
+  auto it = slots_.find(name);
+  if (it != slots_.end()) {
+    vars_[it->second] = var;
+    return it->second;
+  }
+  int slot = static_cast<int>(vars_.size());
+  vars_.push_back(var);
+  slots_.emplace(name, slot);
+  return slot;
+}
+
+void VariableSlotTable::Clear() {
+  scope_ = nullptr;
+  slots_.clear();
+  vars_.clear();
+}
+
+}  // namespace paddle::framework
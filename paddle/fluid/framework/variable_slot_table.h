@@ -0,0 +1,90 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace framework {
+
+class Variable;
+
+/**
+ * @brief The variables of a scope resolved to dense slots once.
+ *
+ * Scope::FindVar hashes the name and walks the ancestor scopes under their
+ * locks on every call. The hot paths that look up the same variables on
+ * every run resolve them to slots when a program is prepared, and then load
+ * the variables by slot index.
+ *
+ * The slots stay valid while the variables stay in the scope, so the table
+ * is rebuilt when the scope changes or its variables are erased.
+ */
+class TEST_API VariableSlotTable {
+ public:
+  static constexpr int kInvalidSlot = -1;
+
+  VariableSlotTable() = default;
+
+  /// Resolve the names in scope or any of its ancestors to the slots
+  /// 0, 1, ... in order. The names not found take no slot.
+  VariableSlotTable(const Scope& scope, const std::vector<std::string>& names);
+
+  /// Return the slot of name, resolving it in the scope if it has no slot
+  /// yet. Return kInvalidSlot if the scope has no such variable.
+  int Resolve(const std::string& name);
+
+  /// Give name the slot of var, which the caller found or created in the
+  /// scope. Return the slot.
+  int Bind(const std::string& name, Variable* var);
+
+  /// Return the slot of name, or kInvalidSlot if it has no slot.
+  int Slot(const std::string& name) const {
+    auto it = slots_.find(name);
+    return it == slots_.end() ? kInvalidSlot : it->second;
+  }
+
+  Variable* Var(int slot) const { return vars_[slot]; }
+
+  /// Return the variable of name if it has a slot, or nullptr.
+  Variable* FindVar(const std::string& name) const {
+    int slot = Slot(name);
+    return slot == kInvalidSlot ? nullptr : vars_[slot];
+  }
+
+  const Scope* scope() const { return scope_; }
+
+  /// Whether the slots are resolved in scope.
+  bool IsBuiltFor(const Scope* scope) const {
+    return scope_ != nullptr && scope_ == scope;
+  }
+
+  size_t size() const { return vars_.size(); }
+
+  void Clear();
+
+ private:
+  const Scope* scope_{nullptr};
+  std::unordered_map<std::string, int> slots_;
+  std::vector<Variable*> vars_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -17,12 +17,15 @@
 #include <memory>
 #include <string>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/eager_tensor.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 #include "paddle/fluid/imperative/var_helper.h"
 
+COMMON_DECLARE_bool(eager_amp_cast_cache);
+
 namespace paddle::imperative {
 
 class VarBase;
@@ -87,7 +90,8 @@ OpSupportedInfos(const std::string& place,
     }
   }
 
-  auto phi_kernels = phi::KernelFactory::Instance().kernels();
+  const phi::KernelFactory& kernel_factory = phi::KernelFactory::Instance();
+  const auto& phi_kernels = kernel_factory.kernels();
   for (auto& kernel_pair : phi_kernels) {
     auto op_type = phi::TransToFluidOpName(kernel_pair.first);
     for (auto& info_pair : kernel_pair.second) {
@@ -129,6 +133,69 @@ AutoCastGuard::~AutoCastGuard() {  // NOLINT
   state_->SetAmpLevel(pre_amp_level_);
 }
 
+AmpCastCache& AmpCastCache::Instance() {
+  static thread_local AmpCastCache cache;
+  return cache;
+}
+
+bool AmpCastCache::Enabled() { return FLAGS_eager_amp_cast_cache; }
+
+paddle::Tensor AmpCastCache::Get(const paddle::Tensor& input,
+                                 phi::DataType dst_dtype,
+                                 bool trace_backward) {
+  auto it = entries_.find(input.impl().get());
+  if (it != entries_.end()) {
+    // the versions are read from copies as they are not const
+    uint32_t input_version = paddle::Tensor(input).current_inplace_version();
+    for (auto& entry : it->second) {
+      if (entry.dst_dtype != dst_dtype ||
+          entry.trace_backward != trace_backward) {
+        continue;
+      }
+      // the address may be of a new tensor, or the tensors changed in place
+      if (entry.input.lock() != input.impl() ||
+          entry.input_version != input_version ||
+          entry.output_version != entry.output.current_inplace_version()) {
+        break;
+      }
+      ++hits_;
+      return entry.output;
+    }
+  }
+  ++misses_;
+  return paddle::Tensor();
+}
+
+void AmpCastCache::Set(const paddle::Tensor& input,
+                       phi::DataType dst_dtype,
+                       bool trace_backward,
+                       const paddle::Tensor& output) {
+  if (!input.is_dense_tensor() || !output.is_dense_tensor()) return;
+  auto& entries = entries_[input.impl().get()];
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (it->dst_dtype == dst_dtype && it->trace_backward == trace_backward) {
+      entries.erase(it);
+      --size_;
+      break;
+    }
+  }
+  paddle::Tensor casted = output;
+  entries.push_back(Entry{input.impl(),
+                          paddle::Tensor(input).current_inplace_version(),
+                          dst_dtype,
+                          trace_backward,
+                          casted,
+                          casted.current_inplace_version()});
+  ++size_;
+}
+
+void AmpCastCache::Clear() {
+  VLOG(5) << "Clear the AMP cast cache of " << size_ << " casts, " << hits_
+          << " hits and " << misses_ << " misses";
+  entries_.clear();
+  size_ = 0;
+}
+
 AmpOperators::AmpOperators()
     : allow_ops_(new std::unordered_set<std::string>()),
       block_ops_(new std::unordered_set<std::string>()),
@@ -17,10 +17,13 @@
 #include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/phi/api/include/tensor.h"
 
 namespace paddle {
 namespace imperative {
@@ -102,6 +105,50 @@ class AmpAttrs {
   static thread_local phi::DataType amp_dtype_;
 };
 
+// The casts of the inputs made by the auto cast of the eager mode, so that a
+// tensor is cast to a dtype at most once while neither it nor its cast is
+// changed in place. Enabled by FLAGS_eager_amp_cast_cache, it is per thread as
+// AmpAttrs, and cleared when the outermost amp guard exits.
+class AmpCastCache {
+ public:
+  static AmpCastCache& Instance();
+
+  static bool Enabled();
+
+  // Returns an uninitialized tensor if not found.
+  paddle::Tensor Get(const paddle::Tensor& input,
+                     phi::DataType dst_dtype,
+                     bool trace_backward);
+
+  void Set(const paddle::Tensor& input,
+           phi::DataType dst_dtype,
+           bool trace_backward,
+           const paddle::Tensor& output);
+
+  void Clear();
+
+  size_t Size() const { return size_; }
+  int64_t Hits() const { return hits_; }
+  int64_t Misses() const { return misses_; }
+
+ private:
+  struct Entry {
+    std::weak_ptr<phi::TensorBase> input;
+    uint32_t input_version;
+    phi::DataType dst_dtype;
+    bool trace_backward;
+    paddle::Tensor output;
+    uint32_t output_version;
+  };
+
+  AmpCastCache() = default;
+
+  std::unordered_map<const phi::TensorBase*, std::vector<Entry>> entries_;
+  size_t size_{0};
+  int64_t hits_{0};
+  int64_t misses_{0};
+};
+
 // NOTE(zhiqiu): AutoCastGuard is used for RAII.
 class AutoCastGuard {
  public:
@@ -242,6 +242,24 @@ static inline paddle::Tensor Cast(const paddle::Tensor& input,
     }
   }
 }
+
+// Reuses the cast of the input to dst_dtype made by another op before, if
+// FLAGS_eager_amp_cast_cache is set.
+static inline paddle::Tensor CachedCast(const paddle::Tensor& input,
+                                        const phi::DataType& dst_dtype,
+                                        const bool trace_backward = true) {
+  if (!AmpCastCache::Enabled() || !input.is_dense_tensor()) {
+    return Cast(input, dst_dtype, trace_backward);
+  }
+  bool with_grad = trace_backward && egr::Controller::Instance().HasGrad();
+  auto& cache = AmpCastCache::Instance();
+  auto output = cache.Get(input, dst_dtype, with_grad);
+  if (!output.initialized()) {
+    output = Cast(input, dst_dtype, trace_backward);
+    cache.Set(input, dst_dtype, with_grad, output);
+  }
+  return output;
+}
 #endif
 
 static inline pir::Value Cast(const pir::Value& input,
@@ -253,6 +271,12 @@ static inline pir::Value Cast(const pir::Value& input,
   return paddle::dialect::cast(input, dst_dtype);
 }
 
+static inline pir::Value CachedCast(const pir::Value& input,
+                                    const phi::DataType& dst_dtype,
+                                    const bool trace_backward = true) {
+  return Cast(input, dst_dtype, trace_backward);
+}
+
 template <class T>
 inline std::vector<T> AmpAutoCasts(const std::string& inputs_name,
                                    const std::vector<T>& inputs,
@@ -265,7 +289,7 @@ inline std::vector<T> AmpAutoCasts(const std::string& inputs_name,
   std::vector<T> inputs_casted;
   for (auto& input : inputs) {
     if (NeedCast(input, dst_dtype)) {
-      inputs_casted.emplace_back(std::move(Cast(input, dst_dtype)));
+      inputs_casted.emplace_back(std::move(CachedCast(input, dst_dtype)));
     } else {
       inputs_casted.emplace_back(input);
     }
@@ -313,7 +337,7 @@ inline T AmpAutoCast(const std::string& input_name,
   }
   if (NeedCast(input, dst_dtype)) {
     VLOG(6) << "Input : " << input.impl() << "NeedCast";
-    return Cast(input, dst_dtype, trace_backward);
+    return CachedCast(input, dst_dtype, trace_backward);
   }
   return input;
 }
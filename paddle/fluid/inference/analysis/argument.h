@@ -164,6 +164,7 @@ struct Argument {
   DECL_ARGUMENT_FIELD(model_program_path, ModelProgramPath, std::string);
   DECL_ARGUMENT_FIELD(model_params_path, ModelParamsPath, std::string);
   DECL_ARGUMENT_FIELD(model_from_memory, ModelFromMemory, bool);
+  DECL_ARGUMENT_FIELD(use_mmap_params, UseMmapParams, bool);
   DECL_ARGUMENT_FIELD(save_optimized_model, SaveOptimizedModel, bool);
   DECL_ARGUMENT_FIELD(optimized_model_save_path,
                       OptimizedModelSavePath,
@@ -292,6 +293,13 @@ struct Argument {
   DECL_ARGUMENT_FIELD(tensorrt_inspector_serialize,
                       TensorRtInspectorSerialize,
                       bool);
+  DECL_ARGUMENT_FIELD(tensorrt_refit, TensorRtRefit, bool);
+  DECL_ARGUMENT_FIELD(tensorrt_activation_range_path,
+                      TensorRtActivationRangePath,
+                      std::string);
+  DECL_ARGUMENT_FIELD(tensorrt_activation_range_percentile,
+                      TensorRtActivationRangePercentile,
+                      float);
   DECL_ARGUMENT_FIELD(tensorrt_use_explicit_quantization,
                       TensorRtUseExplicitQuantization,
                       bool);
@@ -350,6 +358,10 @@ struct Argument {
 
   // Memory optimized related.
   DECL_ARGUMENT_FIELD(enable_memory_optim, EnableMemoryOptim, bool);
+  DECL_ARGUMENT_FIELD(memory_optim_workspace, MemoryOptimWorkspace, bool);
+  DECL_ARGUMENT_FIELD(memory_optim_shape_range_info_path,
+                      MemoryOptimShapeRangeInfoPath,
+                      std::string);
   DECL_ARGUMENT_FIELD(trt_engine_memory_sharing, TrtEngineMemorySharing, bool);
 
   // Indicate which kind of sort algorithm is used for operators, the memory
@@ -243,6 +243,11 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("use_inspector", new bool(argument->tensorrt_use_inspector()));
       pass->Set("inspector_serialize",
                 new bool(argument->tensorrt_inspector_serialize()));
+      pass->Set("refit", new bool(argument->tensorrt_refit()));
+      pass->Set("trt_activation_range_path",
+                new std::string(argument->tensorrt_activation_range_path()));
+      pass->Set("trt_activation_range_percentile",
+                new float(argument->tensorrt_activation_range_percentile()));
       pass->Set("trt_ops_run_float",
                 new std::unordered_set<std::string>(
                     argument->tensorrt_ops_run_float()));
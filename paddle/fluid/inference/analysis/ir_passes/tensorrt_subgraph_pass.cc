@@ -20,6 +20,7 @@
 #include <string>
 #include <unordered_set>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
@@ -34,10 +35,13 @@
 #include "paddle/fluid/inference/tensorrt/engine.h"
 #include "paddle/fluid/inference/tensorrt/op_teller.h"
 #include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
+#include "paddle/fluid/inference/utils/activation_range.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/phi/common/backend.h"
 #include "paddle/phi/common/data_type.h"
 
+COMMON_DECLARE_bool(trt_async_engine_build);
+
 namespace paddle {
 namespace inference {
 namespace analysis {
@@ -267,6 +271,7 @@ std::string GenerateEngineKey(const std::set<std::string> &engine_inputs,
                               const std::string &max_batch_size,
                               const std::string &precision,
                               bool use_cuda_graph,
+                              bool refit,
                               const bool for_calibration) {
   std::string engine_hash_key = "";
   for (auto name : engine_inputs) {
@@ -287,6 +292,10 @@ std::string GenerateEngineKey(const std::set<std::string> &engine_inputs,
 
   engine_hash_key += "#";
   engine_hash_key += std::to_string(use_cuda_graph);
+  // keep the keys of the engines cached before the refit is introduced
+  if (refit) {
+    engine_hash_key += "#refit";
+  }
 
   auto engine_key = std::to_string(std::hash<std::string>()(engine_hash_key));
   VLOG(2) << "TRT engine hash key: " << engine_hash_key;
@@ -537,6 +546,9 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
   auto shape_range_info_path = Get<std::string>("trt_shape_range_info_path");
   auto trt_tuned_dynamic_shape = Get<bool>("trt_tuned_dynamic_shape");
   int max_batch_size = Get<int>("max_batch_size");
+  std::vector<std::map<std::string, std::vector<int>>> bucket_max_input_shape;
+  std::vector<std::map<std::string, std::vector<int>>>
+      bucket_optim_input_shape;
   if (trt_tuned_dynamic_shape) {
     if (!shape_range_info_path.empty()) {
       VLOG(1) << "trt dynamic_shape deserialize from " << shape_range_info_path;
@@ -547,6 +559,9 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
                                            &min_shape_tensor,
                                            &max_shape_tensor,
                                            &optim_shape_tensor);
+      inference::DeserializeShapeRangeBuckets(shape_range_info_path,
+                                              &bucket_max_input_shape,
+                                              &bucket_optim_input_shape);
     } else {
       shape_range_info_path = Get<std::string>("model_opt_cache_dir") + "/" +
                               "shape_range_info.pbtxt";
@@ -560,6 +575,9 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
                                              &min_shape_tensor,
                                              &max_shape_tensor,
                                              &optim_shape_tensor);
+        inference::DeserializeShapeRangeBuckets(shape_range_info_path,
+                                                &bucket_max_input_shape,
+                                                &bucket_optim_input_shape);
       } else {
         int fd = open(shape_range_info_path.c_str(), O_WRONLY | O_CREAT, 0644);
         close(fd);
@@ -644,6 +662,7 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
   auto dla_core = Get<int>("trt_dla_core");
   auto use_inspector = Get<bool>("use_inspector");
   auto inspector_serialize = Get<bool>("inspector_serialize");
+  auto refit = Has("refit") && Get<bool>("refit");
   auto disable_trt_plugin_fp16 = Get<bool>("disable_trt_plugin_fp16");
   auto context_memory_sharing = Get<bool>("context_memory_sharing");
   if (context_memory_sharing && TRT_VERSION < 7200) {
@@ -739,6 +758,7 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
                         std::to_string(max_batch_size),
                         std::to_string(static_cast<int>(precision_mode)),
                         use_cuda_graph,
+                        refit,
                         false);
   auto calibration_engine_key =
       GenerateEngineKey(input_names_with_id,
@@ -747,6 +767,7 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
                         std::to_string(max_batch_size),
                         std::to_string(static_cast<int>(precision_mode)),
                         use_cuda_graph,
+                        refit,
                         true);
   auto predictor_id = Get<int>("predictor_id");
 
@@ -783,6 +804,31 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
     LOG(INFO) << "Serialize engine info to " << engine_info_path;
   }
   op_desc->SetAttr("use_inspector", use_inspector);
+  op_desc->SetAttr("refit", refit);
+
+  // The int8 dynamic ranges collected by the native forwards, of the tensors
+  // renamed in the subgraph.
+  std::vector<std::string> activation_range_names;
+  std::vector<float> activation_range_values;
+  if (enable_int8 && Has("trt_activation_range_path") &&
+      !Get<std::string>("trt_activation_range_path").empty()) {
+    auto ranges = inference::DeserializeActivationRange(
+        Get<std::string>("trt_activation_range_path"),
+        Get<float>("trt_activation_range_percentile"));
+    for (auto &var : block_desc.Proto()->vars()) {
+      auto origin_name = var.name().substr(0, var.name().rfind("_subgraph_"));
+      auto it = ranges.find(origin_name);
+      if (it != ranges.end()) {
+        activation_range_names.push_back(var.name());
+        activation_range_values.push_back(it->second);
+      }
+    }
+    LOG(INFO) << "Set the int8 dynamic ranges of "
+              << activation_range_names.size()
+              << " tensors by the activation ranges.";
+  }
+  op_desc->SetAttr("activation_range_names", activation_range_names);
+  op_desc->SetAttr("activation_range_values", activation_range_values);
   op_desc->SetAttr("engine_info_path", engine_info_path);
   op_desc->Flush();
 
@@ -801,9 +847,15 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
     return calibration_engine_key;
   }
 
-  std::copy(params_not_shared.begin(),
-            params_not_shared.end(),
-            std::back_inserter(*repetitive_params));
+  // The native kernels run the subgraph with the parameters before the engine
+  // built in the background is ready.
+  const bool async_engine_build = FLAGS_trt_async_engine_build;
+  op_desc->SetAttr("async_engine_build", async_engine_build);
+  if (!async_engine_build) {
+    std::copy(params_not_shared.begin(),
+              params_not_shared.end(),
+              std::back_inserter(*repetitive_params));
+  }
 
   // Check trt version for dynamic shape input.
 
@@ -849,6 +901,8 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
   params.min_shape_tensor = min_shape_tensor;
   params.max_shape_tensor = max_shape_tensor;
   params.optim_shape_tensor = optim_shape_tensor;
+  params.bucket_max_input_shape = bucket_max_input_shape;
+  params.bucket_optim_input_shape = bucket_optim_input_shape;
   params.disable_trt_plugin_fp16 = disable_trt_plugin_fp16;
   params.precision = precision_mode;
   params.use_varseqlen = use_varseqlen;
@@ -860,6 +914,11 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
   params.context_memory_sharing = context_memory_sharing;
   params.use_inspector = use_inspector;
   params.engine_info_path = engine_info_path;
+  params.refittable = refit;
+  for (size_t i = 0; i < activation_range_names.size(); ++i) {
+    params.activation_ranges[activation_range_names[i]] =
+        activation_range_values[i];
+  }
   params.enable_low_precision_io = enable_low_precision_io;
   params.optimization_level = optimization_level;
   params.use_explicit_quantization = use_explicit_quantization;
@@ -899,6 +958,13 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
     return engine_key + std::to_string(predictor_id);
   }
 
+  // The tensorrt_engine op builds the engine at its first run.
+  if (async_engine_build) {
+    LOG(INFO) << "Defer the TRT engine build of " << engine_key
+              << " to the background.";
+    return engine_key + std::to_string(predictor_id);
+  }
+
   // the following code will NOT run in following situation:
   // 1. calibration mode (generate trt int8 calibration table data)
   // 2. already load serialized trt engine info.
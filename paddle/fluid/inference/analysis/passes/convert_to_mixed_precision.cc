@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/ir/auto_mixed_precision_pass.h"
 #include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include "paddle/fluid/framework/ir/fp8_gemm_quant_pass.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/identity_op_clean_pass.h"
 #include "paddle/fluid/inference/io.h"
@@ -48,10 +49,11 @@ ConvertToMixedPrecisionPass::ConvertToMixedPrecisionPass(
   switch (backend_) {
     case phi::Backend::GPU:
       PADDLE_ENFORCE(mixed_precision_ == phi::DataType::FLOAT16 ||
-                         mixed_precision_ == phi::DataType::BFLOAT16,
+                         mixed_precision_ == phi::DataType::BFLOAT16 ||
+                         mixed_precision_ == phi::DataType::FLOAT8_E4M3FN,
                      common::errors::InvalidArgument(
-                         "mixed_precision of %s currently only supported fp16 "
-                         "and bf16, not support %s.",
+                         "mixed_precision of %s currently only supported fp16, "
+                         "bf16 and fp8, not support %s.",
                          experimental::BackendToString(backend_),
                          phi::DataTypeToString(mixed_precision_)));
       break;
@@ -92,9 +94,13 @@ void ConvertToMixedPrecisionPass::Run() {
   framework::ir::ConstantFoldingPass constant_folding_pass;
   constant_folding_pass.Apply(main_graph_.get());
 
+  // fp8 runs the gemms of the fp16 model with fp8 weights
+  const bool use_fp8_gemm = mixed_precision_ == phi::DataType::FLOAT8_E4M3FN;
+  const phi::DataType mixed_precision =
+      use_fp8_gemm ? phi::DataType::FLOAT16 : mixed_precision_;
   framework::ir::AutoMixedPrecisionPass auto_mixed_precision_pass;
   auto_mixed_precision_pass.Set("mixed_precision_mode",
-                                new int{static_cast<int>(mixed_precision_)});
+                                new int{static_cast<int>(mixed_precision)});
   if (backend_ == phi::Backend::GPU) {
     auto_mixed_precision_pass.Set("enable_gpu_mixed", new bool{true});
   } else if (backend_ == phi::Backend::XPU) {
@@ -110,6 +116,11 @@ void ConvertToMixedPrecisionPass::Run() {
                                 new bool{!keep_io_types_});
   auto_mixed_precision_pass.Apply(main_graph_.get());
 
+  if (use_fp8_gemm) {
+    framework::ir::Fp8GemmQuantPass fp8_gemm_quant_pass;
+    fp8_gemm_quant_pass.Apply(main_graph_.get());
+  }
+
   framework::ir::IdentityOpCleanPass identity_op_clean_pass;
   identity_op_clean_pass.Apply(main_graph_.get());
 
@@ -50,13 +50,32 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
     argument->SetMainProgram(program.release());
   } else if (argument->model_program_path_valid() &&
              argument->model_params_path_valid()) {
-    auto program = LoadModel(
-        argument->model_program_path(),
-        argument->model_params_path(),
-        argument->scope_ptr(),
-        place,
-        argument->model_from_memory_valid() && argument->model_from_memory(),
-        argument->skip_load_params());
+    bool model_from_memory =
+        argument->model_from_memory_valid() && argument->model_from_memory();
+    bool skip_load_params = argument->skip_load_params();
+    bool use_mmap_params = !model_from_memory && !skip_load_params &&
+                           argument->use_mmap_params_valid() &&
+                           argument->use_mmap_params();
+    auto program = LoadModel(argument->model_program_path(),
+                             argument->model_params_path(),
+                             argument->scope_ptr(),
+                             place,
+                             model_from_memory,
+                             skip_load_params || use_mmap_params);
+    if (use_mmap_params &&
+        !LoadPersistablesWithMmap(*program,
+                                  argument->model_params_path(),
+                                  argument->scope_ptr(),
+                                  place)) {
+      // fall back to load_combine
+      framework::Executor exe(place);
+      LoadPersistables(&exe,
+                       argument->scope_ptr(),
+                       *program,
+                       "",
+                       argument->model_params_path(),
+                       false /* model_from_memory */);
+    }
     argument->SetMainProgram(program.release());
   } else {
     PADDLE_THROW(common::errors::PreconditionNotMet(
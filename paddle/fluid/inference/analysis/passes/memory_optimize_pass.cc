@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/inference/analysis/passes/memory_optimize_pass.h"
 
+#include <algorithm>
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -21,7 +23,9 @@
 
 #include "glog/logging.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/analysis/pass_result_info.h"
+#include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -202,6 +206,183 @@ void MemoryOptimizePass::CollectVarMemorySize(
   }
 }
 
+void MemoryOptimizePass::ExtendViewLifeCycle(
+    Graph* graph,
+    std::unordered_map<std::string, lifecycle_t>* lifecycles) const {
+  // The outputs of these ops may be the views of their inputs.
+  const std::unordered_set<std::string> view_ops = {"reshape",
+                                                    "reshape2",
+                                                    "squeeze",
+                                                    "squeeze2",
+                                                    "unsqueeze",
+                                                    "unsqueeze2",
+                                                    "flatten",
+                                                    "flatten2",
+                                                    "flatten_contiguous_range",
+                                                    "transpose",
+                                                    "transpose2",
+                                                    "slice",
+                                                    "split",
+                                                    "unbind",
+                                                    "share_data"};
+  std::vector<std::pair<std::string, std::string>> views;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || !node->Op() || !view_ops.count(node->Op()->Type())) {
+      continue;
+    }
+    for (auto* in : node->inputs) {
+      if (!lifecycles->count(in->Name())) continue;
+      for (auto* out : node->outputs) {
+        if (lifecycles->count(out->Name())) {
+          views.emplace_back(in->Name(), out->Name());
+        }
+      }
+    }
+  }
+  // the views of views extend the lifecycles too
+  bool changed = true;
+  for (size_t i = 0; changed && i <= views.size(); ++i) {
+    changed = false;
+    for (auto& view : views) {
+      auto& in_lifecycle = lifecycles->at(view.first);
+      const auto& out_lifecycle = lifecycles->at(view.second);
+      if (out_lifecycle.second > in_lifecycle.second) {
+        in_lifecycle.second = out_lifecycle.second;
+        changed = true;
+      }
+    }
+  }
+}
+
+void MemoryOptimizePass::CollectVarMaxMemorySize(
+    Graph* graph,
+    const std::string& shape_range_info_path,
+    const space_table_t& space_table,
+    space_table_t* max_space_table) const {
+  std::map<std::string, std::vector<int32_t>> min_shape, max_shape, opt_shape;
+  std::map<std::string, std::vector<int32_t>> min_value, max_value, opt_value;
+  if (!shape_range_info_path.empty() && FileExists(shape_range_info_path)) {
+    DeserializeShapeRangeInfo(shape_range_info_path,
+                              &min_shape,
+                              &max_shape,
+                              &opt_shape,
+                              &min_value,
+                              &max_value,
+                              &opt_value);
+  }
+
+  // The communication ops run on their own stream unless use_calc_stream is
+  // set, so the tensors they touch may be used after their lifecycles on the
+  // compute stream.
+  std::unordered_set<std::string> other_stream_vars;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || !node->Op() || !node->Op()->HasAttr("ring_id")) {
+      continue;
+    }
+    if (node->Op()->HasAttr("use_calc_stream") &&
+        PADDLE_GET_CONST(bool, node->Op()->GetAttr("use_calc_stream"))) {
+      continue;
+    }
+    for (auto* var : node->inputs) other_stream_vars.insert(var->Name());
+    for (auto* var : node->outputs) other_stream_vars.insert(var->Name());
+  }
+
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar() || !node->Var()) continue;
+    const std::string& name = node->Var()->Name();
+    if (!space_table.count(name) || max_space_table->count(name) ||
+        other_stream_vars.count(name)) {
+      continue;
+    }
+    std::vector<int64_t> shape;
+    if (max_shape.count(name)) {
+      shape.assign(max_shape.at(name).begin(), max_shape.at(name).end());
+    } else {
+      shape = node->Var()->GetShape();
+    }
+    if (std::any_of(
+            shape.begin(), shape.end(), [](int64_t v) { return v < 0; })) {
+      continue;
+    }
+    const int64_t numel = std::accumulate(
+        shape.begin(), shape.end(), int64_t{1}, std::multiplies<>());
+    const size_t size =
+        numel * paddle::framework::SizeOfType(node->Var()->GetDataType());
+    if (size > 0) {
+      (*max_space_table)[name] = size;
+    }
+  }
+}
+
+// Places the tensors at the byte offsets of a shared workspace, where the
+// tensors with overlapped lifecycles do not overlap. The larger tensors are
+// placed first, each in the smallest gap that holds it.
+void MakeWorkspaceReusePlan(
+    const std::unordered_map<std::string, std::pair<int, int>>& lifecycles,
+    const std::unordered_map<std::string, size_t>& max_space_table,
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>>*
+        workspace_plan) {
+  constexpr int64_t kAlignment = 256;
+  struct Block {
+    std::string name;
+    int64_t size;
+    std::pair<int, int> lifetime;
+    int64_t offset;
+  };
+  std::vector<Block> blocks;
+  for (auto& data : max_space_table) {
+    // the feed vars live through the whole run
+    if (!lifecycles.count(data.first) ||
+        lifecycles.at(data.first).second == std::numeric_limits<int>::max()) {
+      continue;
+    }
+    int64_t size = static_cast<int64_t>(data.second);
+    size = (size + kAlignment - 1) / kAlignment * kAlignment;
+    blocks.push_back({data.first, size, lifecycles.at(data.first), 0});
+  }
+  std::sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+    if (a.size != b.size) return a.size > b.size;
+    if (a.lifetime != b.lifetime) return a.lifetime < b.lifetime;
+    return a.name < b.name;
+  });
+
+  auto overlap = [](std::pair<int, int> a, std::pair<int, int> b) -> bool {
+    return b.second >= a.first && a.second >= b.first;
+  };
+  int64_t workspace_size = 0;
+  int64_t total_size = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    std::vector<std::pair<int64_t, int64_t>> used;
+    for (size_t j = 0; j < i; ++j) {
+      if (overlap(blocks[i].lifetime, blocks[j].lifetime)) {
+        used.emplace_back(blocks[j].offset, blocks[j].offset + blocks[j].size);
+      }
+    }
+    std::sort(used.begin(), used.end());
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t end = 0;
+    for (auto& range : used) {
+      const int64_t gap = range.first - end;
+      if (gap >= blocks[i].size && gap < best_gap) {
+        best_gap = gap;
+        best_offset = end;
+      }
+      end = std::max(end, range.second);
+    }
+    blocks[i].offset = best_offset >= 0 ? best_offset : end;
+    (*workspace_plan)[blocks[i].name] =
+        std::make_pair(blocks[i].offset, blocks[i].size);
+    workspace_size =
+        std::max(workspace_size, blocks[i].offset + blocks[i].size);
+    total_size += blocks[i].size;
+  }
+  LOG(INFO) << "Place " << blocks.size() << " tensors of "
+            << (static_cast<double>(total_size) / (1 << 20))
+            << "MB in the workspace of "
+            << (static_cast<double>(workspace_size) / (1 << 20)) << "MB";
+}
+
 void MakeSimpleReusePlan(
     const std::unordered_map<std::string, std::pair<int, int>>& lifecycles,
     const std::unordered_map<std::string, size_t>& space_table,
@@ -283,14 +464,34 @@ void MemoryOptimizePass::RunImpl(Argument* argument) {
   space_table_t space_table;
   std::unordered_map<std::string, std::string> node2cluster;
   std::unordered_map<std::string, int> cluster_size;
+  std::unordered_map<std::string, std::pair<int64_t, int64_t>> workspace_plan;
 
   CollectLifeCycle(graph, &lifecycles, sort_kind);
   CollectVarMemorySize(graph, &space_table);
+  if (argument->memory_optim_workspace_valid() &&
+      argument->memory_optim_workspace()) {
+    ExtendViewLifeCycle(graph, &lifecycles);
+    space_table_t max_space_table;
+    CollectVarMaxMemorySize(
+        graph,
+        argument->memory_optim_shape_range_info_path_valid()
+            ? argument->memory_optim_shape_range_info_path()
+            : "",
+        space_table,
+        &max_space_table);
+    MakeWorkspaceReusePlan(lifecycles, max_space_table, &workspace_plan);
+    for (auto& it : workspace_plan) {
+      space_table.erase(it.first);
+    }
+  }
   MakeSimpleReusePlan(lifecycles, space_table, &node2cluster, &cluster_size);
 
   auto* pass_res_info = PassResultInfoForRuntime::Instance();
   pass_res_info->Set(
       argument->root_predictor_id(), "memory_optimize_pass", node2cluster);
+  pass_res_info->Set(argument->root_predictor_id(),
+                     "memory_optimize_pass_workspace",
+                     workspace_plan);
 
   return;
 }
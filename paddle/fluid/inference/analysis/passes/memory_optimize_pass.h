@@ -41,6 +41,10 @@ namespace analysis {
  * current name of var.
  * 3. Perform reuse plan: Replace all var's name in the model according to the
  * mapping table.
+ *
+ * With the memory optim workspace enabled, the vars of known max sizes are
+ * instead placed at the byte offsets of one shared workspace by best-fit
+ * packing of their lifetimes, and only the others are reused by name.
  */
 class MemoryOptimizePass : public AnalysisPass {
  public:
@@ -61,6 +65,20 @@ class MemoryOptimizePass : public AnalysisPass {
   void CollectVarMemorySize(framework::ir::Graph *graph,
                             space_table_t *space_table) const;
 
+  // Extends the lifecycles of the inputs of the view ops to the ones of their
+  // outputs, which may share the memory of the inputs.
+  void ExtendViewLifeCycle(
+      framework::ir::Graph *graph,
+      std::unordered_map<std::string, lifecycle_t> *lifecycles) const;
+
+  // Collects the max bytes of the tensors in space_table whose max shapes are
+  // known from the shape range info or their static shapes, and which are
+  // only used on the compute stream.
+  void CollectVarMaxMemorySize(framework::ir::Graph *graph,
+                               const std::string &shape_range_info_path,
+                               const space_table_t &space_table,
+                               space_table_t *max_space_table) const;
+
  public:
   std::string repr() const override;
 };
@@ -473,6 +473,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
   CP_MEMBER(save_optimized_model_);
+  CP_MEMBER(use_mmap_params_);
   CP_MEMBER(opt_cache_dir_);
   CP_MEMBER(prog_file_);
   CP_MEMBER(params_file_);
@@ -495,6 +496,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(enable_low_precision_io_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(memory_optim_workspace_);
+  CP_MEMBER(memory_optim_shape_range_info_path_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -521,8 +524,28 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(trt_allow_build_at_runtime_);
   CP_MEMBER(collect_shape_range_info_);
   CP_MEMBER(shape_range_info_path_);
+  CP_MEMBER(shape_bucket_num_);
+  CP_MEMBER(collect_shape_range_info_online_);
+  CP_MEMBER(shape_range_sample_interval_);
+  CP_MEMBER(shape_range_save_interval_);
   CP_MEMBER(trt_use_inspector_);
   CP_MEMBER(trt_inspector_serialize_);
+  CP_MEMBER(trt_refit_);
+  CP_MEMBER(trt_activation_range_path_);
+  CP_MEMBER(trt_activation_range_percentile_);
+  CP_MEMBER(collect_activation_range_);
+  CP_MEMBER(activation_range_path_);
+  CP_MEMBER(activation_range_num_bins_);
+  CP_MEMBER(enable_run_statistics_);
+  CP_MEMBER(run_statistics_op_sample_interval_);
+  CP_MEMBER(enable_colocation_);
+  CP_MEMBER(colocation_weight_);
+  CP_MEMBER(colocation_memory_quota_);
+  CP_MEMBER(enable_memory_compaction_);
+  CP_MEMBER(memory_compaction_idle_ms_);
+  CP_MEMBER(enable_cuda_malloc_async_allocator_);
+  CP_MEMBER(cuda_malloc_async_release_threshold_mb_);
+  CP_MEMBER(cuda_malloc_async_peer_access_);
   CP_MEMBER(trt_use_explicit_quantization_);
   CP_MEMBER(trt_engine_memory_sharing_);
   CP_MEMBER(trt_engine_memory_sharing_identifier_);
@@ -533,6 +556,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(use_mkldnn_);
   CP_MEMBER(mkldnn_enabled_op_types_);
   CP_MEMBER(mkldnn_cache_capacity_);
+  CP_MEMBER(onednn_primitive_cache_warmup_path_);
   // Bfloat16 related.
   CP_MEMBER(use_mkldnn_bfloat16_);
   CP_MEMBER(bfloat16_enabled_op_types_);
@@ -564,8 +588,11 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(use_optimized_model_);
+  CP_MEMBER(use_lowered_program_cache_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(use_gemm_weight_prepack_);
+  CP_MEMBER(cpu_weight_only_algo_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -682,6 +709,17 @@ void AnalysisConfig::SetMkldnnCacheCapacity(int capacity) {
 #endif
 }
 
+void AnalysisConfig::WarmupOneDNNPrimitiveCache(
+    const std::string &shape_range_info_path) {
+#ifdef PADDLE_WITH_DNNL
+  onednn_primitive_cache_warmup_path_ = shape_range_info_path;
+#else
+  LOG(ERROR) << "Please compile with MKLDNN first to warm up the OneDNN "
+                "primitive cache";
+  onednn_primitive_cache_warmup_path_.clear();
+#endif
+}
+
 void AnalysisConfig::EnableMkldnnBfloat16() {
 #ifdef PADDLE_WITH_DNNL
   if (phi::backends::cpu::MayIUse(phi::backends::cpu::cpu_isa_t::avx512_core)) {
@@ -827,6 +865,24 @@ void AnalysisConfig::EnableTensorRtInspector(bool inspector_serialize) {
   trt_inspector_serialize_ = inspector_serialize;
 }
 
+void AnalysisConfig::EnableTensorRtRefit(bool refit) { trt_refit_ = refit; }
+
+void AnalysisConfig::EnableTensorRtActivationRange(
+    const std::string &activation_range_path, float percentile) {
+  PADDLE_ENFORCE_EQ(activation_range_path.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The activation_range_path should not be empty, "
+                        "please re-check the argument."));
+  PADDLE_ENFORCE_EQ(percentile > 0.f && percentile <= 100.f,
+                    true,
+                    common::errors::InvalidArgument(
+                        "The percentile should be in (0, 100], but got %f.",
+                        percentile));
+  trt_activation_range_path_ = activation_range_path;
+  trt_activation_range_percentile_ = percentile;
+}
+
 void AnalysisConfig::EnableTensorRtExplicitQuantization() {
   trt_use_explicit_quantization_ = true;
   Update();
@@ -1072,6 +1128,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << prog_file_;
   ss << params_file_;
   ss << save_optimized_model_;
+  ss << use_mmap_params_;
 
   ss << use_gpu_;
   ss << enable_gpu_mixed_;
@@ -1102,12 +1159,18 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << trt_use_dla_;
   ss << trt_dla_core_;
+  ss << trt_refit_;
+  ss << trt_activation_range_path_;
+  ss << trt_activation_range_percentile_;
 
   ss << enable_memory_optim_;
+  ss << memory_optim_workspace_;
+  ss << memory_optim_shape_range_info_path_;
   ss << trt_engine_memory_sharing_;
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
+  ss << onednn_primitive_cache_warmup_path_;
   for (auto &item : mkldnn_enabled_op_types_) ss << item;
   ss << ";";
 
@@ -1127,9 +1190,12 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << ir_debug_;
 
   ss << use_optimized_model_;
+  ss << use_lowered_program_cache_;
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << use_gemm_weight_prepack_;
+  ss << cpu_weight_only_algo_;
 
   ss << use_xpu_;
   ss << xpu_config_.device_id;
@@ -1176,6 +1242,19 @@ std::string AnalysisConfig::SerializeInfoCache() {
   return ss.str();
 }
 
+void AnalysisConfig::EnableCpuWeightOnlyQuantize(const std::string &algo) {
+  PADDLE_ENFORCE_EQ(
+      algo == "weight_only_int8" || algo == "weight_only_int4",
+      true,
+      common::errors::InvalidArgument(
+          "The CPU weight only quantization must be weight_only_int8 or "
+          "weight_only_int4, but got %s.",
+          algo));
+  cpu_weight_only_algo_ = algo;
+
+  Update();
+}
+
 void AnalysisConfig::SetCpuMathLibraryNumThreads(
     int cpu_math_library_num_threads) {
   cpu_math_library_num_threads_ = cpu_math_library_num_threads;
@@ -1214,6 +1293,13 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableMemoryOptimWorkspace(
+    const std::string &shape_range_info_path) {
+  memory_optim_workspace_ = true;
+  memory_optim_shape_range_info_path_ = shape_range_info_path;
+  EnableMemoryOptim(true);
+}
+
 bool AnalysisConfig::trt_engine_memory_sharing() const {
   return trt_engine_memory_sharing_;
 }
@@ -1278,6 +1364,11 @@ std::string AnalysisConfig::Summary() {
   // cpu info
   os.InsertRow(
       {"cpu_math_thread", std::to_string(cpu_math_library_num_threads_)});
+  os.InsertRow({"gemm_weight_prepack",
+                use_gemm_weight_prepack_ ? "true" : "false"});
+  if (!cpu_weight_only_algo_.empty()) {
+    os.InsertRow({"cpu_weight_only_algo", cpu_weight_only_algo_});
+  }
   os.InsertRow({"enable_mkldnn", use_mkldnn_ ? "true" : "false"});
   os.InsertRow(
       {"mkldnn_cache_capacity", std::to_string(mkldnn_cache_capacity_)});
@@ -1354,6 +1445,10 @@ std::string AnalysisConfig::Summary() {
       os.InsertRow({"trt_mark_output", trt_mark_output_ ? "true" : "false"});
       os.InsertRow(
           {"trt_forbid_dynamic_op", trt_forbid_dynamic_op_ ? "true" : "false"});
+      os.InsertRow({"trt_refit", trt_refit_ ? "true" : "false"});
+      if (!trt_activation_range_path_.empty()) {
+        os.InsertRow({"trt_activation_range", trt_activation_range_path_});
+      }
 #endif
     }
   }
@@ -1419,21 +1514,65 @@ std::string AnalysisConfig::Summary() {
   // ir info
   os.InsertRow(
       {"save_optimized_model", save_optimized_model_ ? "true" : "false"});
+  os.InsertRow({"use_mmap_params", use_mmap_params_ ? "true" : "false"});
   os.InsertRow({"ir_optim", enable_ir_optim_ ? "true" : "false"});
   os.InsertRow({"ir_debug", ir_debug_ ? "true" : "false"});
   os.InsertRow(
       {"use_optimized_model", use_optimized_model_ ? "true" : "false"});
+  os.InsertRow({"use_lowered_program_cache",
+                use_lowered_program_cache_ ? "true" : "false"});
   os.InsertRow({"memory_optim", enable_memory_optim_ ? "true" : "false"});
+  if (enable_memory_optim_) {
+    os.InsertRow({"memory_optim_workspace",
+                  memory_optim_workspace_ ? "true" : "false"});
+  }
   os.InsertRow({"enable_profile", with_profile_ ? "true" : "false"});
   os.InsertRow({"enable_log", with_glog_info_ ? "true" : "false"});
   os.InsertRow({"collect_shape_range_info",
                 collect_shape_range_info_ ? shape_range_info_path_ : "false"});
+  os.InsertRow(
+      {"collect_shape_range_info_online",
+       collect_shape_range_info_online_ ? shape_range_info_path_ : "false"});
+  if (collect_shape_range_info_online_) {
+    os.InsertRow({"shape_range_sample_interval",
+                  std::to_string(shape_range_sample_interval_)});
+    os.InsertRow({"shape_range_save_interval",
+                  std::to_string(shape_range_save_interval_)});
+  }
+  os.InsertRow({"collect_activation_range",
+                collect_activation_range_ ? activation_range_path_ : "false"});
+  os.InsertRow({"enable_run_statistics",
+                enable_run_statistics_ ? "true" : "false"});
+  if (enable_run_statistics_) {
+    os.InsertRow({"run_statistics_op_sample_interval",
+                  std::to_string(run_statistics_op_sample_interval_)});
+  }
+  if (use_gpu_) {
+    os.InsertRow({"enable_colocation", enable_colocation_ ? "true" : "false"});
+    if (enable_colocation_) {
+      os.InsertRow({"colocation_weight", std::to_string(colocation_weight_)});
+      os.InsertRow({"colocation_memory_quota",
+                    std::to_string(colocation_memory_quota_)});
+    }
+    os.InsertRow({"enable_memory_compaction",
+                  enable_memory_compaction_
+                      ? std::to_string(memory_compaction_idle_ms_) + "ms"
+                      : "false"});
+    os.InsertRow({"enable_cuda_malloc_async_allocator",
+                  enable_cuda_malloc_async_allocator_ ? "true" : "false"});
+    if (enable_cuda_malloc_async_allocator_) {
+      os.InsertRow({"cuda_malloc_async_release_threshold_mb",
+                    std::to_string(cuda_malloc_async_release_threshold_mb_)});
+      os.InsertRow({"cuda_malloc_async_peer_access",
+                    cuda_malloc_async_peer_access_ ? "true" : "false"});
+    }
+  }
 
   return os.PrintTable();
 }
 
 void AnalysisConfig::CollectShapeRangeInfo(
-    const std::string &shape_range_info_path) {
+    const std::string &shape_range_info_path, int shape_bucket_num) {
   LOG(INFO) << "In CollectShapeInfo mode, we will disable optimizations and "
                "collect the shape information of "
             << "all intermediate tensors in the compute graph and calculate "
@@ -1444,7 +1583,14 @@ void AnalysisConfig::CollectShapeRangeInfo(
                     common::errors::InvalidArgument(
                         "The shape_range_info_path should not be empty, please "
                         "re-check the argument."));
+  PADDLE_ENFORCE_GE(shape_bucket_num,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The shape_bucket_num should be at least 1, but got "
+                        "%d.",
+                        shape_bucket_num));
   shape_range_info_path_ = shape_range_info_path;
+  shape_bucket_num_ = shape_bucket_num;
 }
 
 const std::string &AnalysisConfig::shape_range_info_path() const {
@@ -1455,6 +1601,100 @@ bool AnalysisConfig::shape_range_info_collected() const {
   return collect_shape_range_info_;
 }
 
+void AnalysisConfig::CollectShapeRangeInfoOnline(
+    const std::string &shape_range_info_path,
+    int sample_interval,
+    int save_interval) {
+  PADDLE_ENFORCE_EQ(shape_range_info_path.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The shape_range_info_path should not be empty, please "
+                        "re-check the argument."));
+  PADDLE_ENFORCE_GE(sample_interval,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The sample_interval should be at least 1, but got "
+                        "%d.",
+                        sample_interval));
+  PADDLE_ENFORCE_GE(save_interval,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The save_interval should not be negative, but got "
+                        "%d.",
+                        save_interval));
+  collect_shape_range_info_online_ = true;
+  shape_range_info_path_ = shape_range_info_path;
+  shape_range_sample_interval_ = sample_interval;
+  shape_range_save_interval_ = save_interval;
+}
+
+void AnalysisConfig::CollectActivationRange(
+    const std::string &activation_range_path, int num_bins) {
+  LOG(INFO) << "In CollectActivationRange mode, we will disable optimizations "
+               "and collect the histograms of all float activations in the "
+               "compute graph.";
+  PADDLE_ENFORCE_EQ(activation_range_path.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The activation_range_path should not be empty, "
+                        "please re-check the argument."));
+  PADDLE_ENFORCE_GE(num_bins,
+                    2,
+                    common::errors::InvalidArgument(
+                        "The num_bins should be at least 2, but got %d.",
+                        num_bins));
+  collect_activation_range_ = true;
+  activation_range_path_ = activation_range_path;
+  activation_range_num_bins_ = num_bins;
+}
+
+void AnalysisConfig::EnableRunStatistics(int op_sample_interval) {
+  PADDLE_ENFORCE_GE(op_sample_interval,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The op_sample_interval should not be negative, but "
+                        "got %d.",
+                        op_sample_interval));
+  enable_run_statistics_ = true;
+  run_statistics_op_sample_interval_ = op_sample_interval;
+}
+
+void AnalysisConfig::EnableColocation(int weight, size_t memory_quota) {
+  PADDLE_ENFORCE_GE(weight,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The weight should be at least 1, but got %d.",
+                        weight));
+  enable_colocation_ = true;
+  colocation_weight_ = weight;
+  colocation_memory_quota_ = memory_quota;
+}
+
+void AnalysisConfig::EnableMemoryCompaction(int idle_ms) {
+  PADDLE_ENFORCE_GT(idle_ms,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The idle time should be greater than 0, but got %d.",
+                        idle_ms));
+  enable_memory_compaction_ = true;
+  memory_compaction_idle_ms_ = idle_ms;
+}
+
+void AnalysisConfig::EnableCudaMallocAsyncAllocator(
+    int64_t release_threshold_mb, bool peer_access, int idle_trim_ms) {
+  PADDLE_ENFORCE_GE(idle_trim_ms,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The idle time should not be negative, but got %d.",
+                        idle_trim_ms));
+  enable_cuda_malloc_async_allocator_ = true;
+  cuda_malloc_async_release_threshold_mb_ = release_threshold_mb;
+  cuda_malloc_async_peer_access_ = peer_access;
+  if (idle_trim_ms > 0) {
+    EnableMemoryCompaction(idle_trim_ms);
+  }
+}
+
 void AnalysisConfig::EnableTunedTensorRtDynamicShape(
     const std::string &shape_range_info_path, bool allow_build_at_runtime) {
   shape_range_info_path_ = shape_range_info_path;
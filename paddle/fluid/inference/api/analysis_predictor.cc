@@ -17,25 +17,34 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <iterator>
 #include <set>
+#include <sstream>
+#include <thread>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "paddle/common/enforce.h"
+#include "paddle/common/stable_hash.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/feed_hook.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
@@ -49,6 +58,7 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/inference/utils/model_utils.h"
 #include "paddle/fluid/inference/utils/singleton.h"
@@ -60,7 +70,9 @@
 #include "paddle/phi/common/backend.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/common/place.h"
+#include "paddle/phi/core/memory/malloc.h"
 #include "paddle/phi/core/memory/memcpy.h"
+#include "paddle/phi/core/memory/stats.h"
 #include "paddle/phi/core/platform/cpu_helper.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_types.h"
@@ -69,7 +81,9 @@
 
 #include "paddle/phi/core/generator.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
 #include "paddle/utils/string/split.h"
+#include "paddle/utils/string/string_helper.h"
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
 #include "paddle/fluid/distributed/fleet_executor/fleet_executor.h"
@@ -81,12 +95,17 @@
 #include "paddle/phi/backends/dynload/mklml.h"
 #endif
 
+#ifdef PADDLE_WITH_DNNL
+#include "paddle/phi/backends/onednn/onednn_primitive_cache.h"
+#endif
+
 #ifdef PADDLE_WITH_ONNXRUNTIME
 #include "paddle/fluid/inference/api/onnxruntime_predictor.h"
 #endif
 
 #ifdef PADDLE_WITH_TENSORRT
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/engine.h"
 #include "paddle/fluid/inference/tensorrt/helper.h"
 #include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
 #endif
@@ -112,6 +131,8 @@
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/ir_adaptor/translator/translate.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
@@ -121,8 +142,10 @@
 #include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
 #include "paddle/fluid/pir/transforms/general/params_sync_among_devices_pass.h"
+#include "paddle/fluid/pir/transforms/general/remove_redundant_transfer_pass.h"
 #include "paddle/fluid/pir/transforms/general/remove_shadow_feed_pass.h"
 #include "paddle/fluid/pir/transforms/general/replace_fetch_with_shadow_output_pass.h"
+#include "paddle/fluid/pir/transforms/general/while_loop_invariant_code_motion_pass.h"
 #include "paddle/fluid/pir/transforms/passes.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/fluid/pir/utils/general_functions.h"
@@ -135,6 +158,8 @@
 #include "paddle/pir/include/pass/pass_registry.h"
 
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_remove_redundant_transfer);
+COMMON_DECLARE_bool(pir_while_hoist_invariant);
 COMMON_DECLARE_bool(enable_pir_api);
 
 namespace paddle {
@@ -223,10 +248,12 @@ phi::DataType ConvertPrecision(AnalysisConfig::Precision precision) {
       return phi::DataType::BFLOAT16;
     case AnalysisConfig::Precision::kInt8:
       return phi::DataType::INT8;
+    case AnalysisConfig::Precision::kFp8:
+      return phi::DataType::FLOAT8_E4M3FN;
     default:
       PADDLE_THROW(common::errors::InvalidArgument(
           "Paddle Inference not support precision. We now only support "
-          "Float32, Half, Bfloat16 and Int8"));
+          "Float32, Half, Bfloat16, Int8 and Float8"));
       return phi::DataType::FLOAT32;
   }
 }
@@ -252,6 +279,32 @@ phi::Backend ConvertBackend(paddle_infer::PlaceType backend) {
   }
 }
 
+void WriteNameAndShape(std::ostream &os,
+                       size_t idx,
+                       const std::string &name,
+                       const std::vector<int64_t> &shape) {
+  os << idx << " " << name << " " << shape.size();
+  for (auto dim : shape) {
+    os << " " << dim;
+  }
+  os << "\n";
+}
+
+bool ReadNameAndShape(std::istream &is,
+                      size_t *idx,
+                      std::string *name,
+                      std::vector<int64_t> *shape) {
+  size_t rank = 0;
+  if (!(is >> *idx >> *name >> rank)) {
+    return false;
+  }
+  shape->resize(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    is >> (*shape)[i];
+  }
+  return static_cast<bool>(is);
+}
+
 bool PaddleTensorToDenseTensor(const PaddleTensor &pt,
                                phi::DenseTensor *t,
                                const phi::Place &place) {
@@ -366,6 +419,14 @@ bool PaddleTensorToDenseTensor(const PaddleTensor &pt,
   t->set_lod(lod);
   return true;
 }
+
+#ifdef PADDLE_WITH_DNNL
+template <typename T>
+void FillZeros(ZeroCopyTensor *tensor, int64_t numel) {
+  std::vector<T> zeros(numel, static_cast<T>(0));
+  tensor->copy_from_cpu(zeros.data());
+}
+#endif
 }  // namespace
 
 AnalysisPredictor::AnalysisPredictor(const AnalysisConfig &config)
@@ -383,7 +444,8 @@ AnalysisPredictor::AnalysisPredictor(const AnalysisConfig &config)
       shape_info_(),
       shape_tensor_value_(),
       device_contexts_() {
-  if (config_.shape_range_info_collected()) {
+  if (config_.shape_range_info_collected() ||
+      config_.activation_range_collected()) {
     config_.SwitchIrOptim(false);
   }
   if (FLAGS_enable_pir_api) {
@@ -438,6 +500,9 @@ bool AnalysisPredictor::Init(
 
   if (!status_is_cloned_) {
     root_predictor_id_ = predictor_id_;
+    // the clones share the primitives of the root predictor
+    onednn_primitive_cache_scope_ =
+        "P" + std::to_string(inference::GetUniqueId());
   }
 
   // no matter with or without OneDNN
@@ -516,11 +581,12 @@ bool AnalysisPredictor::Init(
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // TODO(inference): Now only gpu with external stream support private
   // device_context.
-  if (config_.use_gpu_ && config_.use_external_stream_) {
+  if (config_.use_gpu_ &&
+      (config_.use_external_stream_ || config_.colocation_enabled())) {
     private_context_ = true;
   }
   if (private_context_) {
-    if (!status_is_cloned_) {
+    if (!status_is_cloned_ && config_.use_external_stream_) {
       predictor_stream_ = config_.GetExecStream();
     }
     // NOTE: If the external_stream equals to global_device_contexts's stream,
@@ -549,7 +615,27 @@ bool AnalysisPredictor::Init(
   }
 #endif
 
+  if (config_.activation_range_collected()) {
+    HookCollectActivationRange();
+  }
+  if (config_.run_statistics_enabled() &&
+      config_.run_statistics_op_sample_interval() > 0) {
+    HookRunStatistics();
+  }
+
+#ifdef PADDLE_WITH_DNNL
+  if (config_.use_mkldnn_ && !status_is_cloned_ &&
+      !config_.onednn_primitive_cache_warmup_path().empty()) {
+    WarmupOneDNNPrimitiveCache();
+  }
+#endif
+
   TryShrinkMemory();
+  if (config_.memory_compaction_enabled() && config_.use_gpu()) {
+    idle_compactor_ = std::make_unique<inference::IdleCompactor>(
+        config_.memory_compaction_idle_ms(),
+        [this] { return CompactMemoryImpl(); });
+  }
 
   inference::DisplayMemoryInfo(place_, "Init predictor");
   return true;
@@ -622,6 +708,55 @@ std::string AnalysisPredictor::GetOptimizedModelPath() {
   return model_opt_cache_dir;
 }
 
+std::string AnalysisPredictor::LoweredProgramCacheKey() {
+  // The jit kernels of CINN can not be serialized, and the models in memory
+  // have no cheap identity.
+  if (config_.model_from_memory() || config_.cinn_enabled() ||
+      config_.prog_file().empty()) {
+    return "";
+  }
+  std::ifstream fin(config_.prog_file(), std::ios::binary);
+  if (!fin) {
+    return "";
+  }
+  std::string model((std::istreambuf_iterator<char>(fin)),
+                    std::istreambuf_iterator<char>());
+
+  std::ostringstream os;
+  os << "lowered_program_cache_v1\n" << paddle::get_version() << "\n";
+  os << "model: " << common::StableHash(model) << " " << model.size()
+     << "\n";
+  // The params are too large to be hashed at every startup, they are
+  // identified by their size and modification time.
+  struct stat params_stat;
+  if (!config_.params_file().empty() &&
+      stat(config_.params_file().c_str(), &params_stat) == 0) {
+    os << "params: " << params_stat.st_size << " " << params_stat.st_mtime
+       << "\n";
+  }
+  os << "config: " << config_.SerializeInfoCache() << "\n";
+  os << "passes: " << config_.pm_opt_level_ << " " << config_.custom_pass_only_
+     << " " << config_.use_cutlass_;
+  for (const auto &pass : config_.custom_passes_) os << " " << pass;
+  os << ";";
+  for (const auto &pass : config_.deleted_passes_) os << " " << pass;
+  os << ";";
+  os << " " << static_cast<int>(config_.mixed_precision_mode_) << " "
+     << config_.enable_low_precision_io_ << " "
+     << FLAGS_pir_apply_inplace_pass << " "
+     << FLAGS_pir_remove_redundant_transfer << " "
+     << FLAGS_pir_while_hoist_invariant << " "
+     << paddle::prim::PrimCommonUtils::IsFwdPrimEnabled() << "\n";
+  os << "place: " << place_ << "\n";
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(place_)) {
+    os << "compute capability: "
+       << platform::GetGPUComputeCapability(place_.GetDeviceId()) << "\n";
+  }
+#endif
+  return os.str();
+}
+
 void AnalysisPredictor::ClearExtraParams() {
   auto var_names = scope_->LocalVarNames();
   std::vector<std::string> trt_repetitive_params;
@@ -629,8 +764,14 @@ void AnalysisPredictor::ClearExtraParams() {
     if (op_desc->Type() == "tensorrt_engine") {
       auto trt_params = PADDLE_GET_CONST(std::vector<std::string>,
                                          op_desc->GetAttr("parameters"));
-      trt_repetitive_params.insert(
-          trt_repetitive_params.end(), trt_params.begin(), trt_params.end());
+      // the native kernels use the parameters before the engine is built
+      bool async_engine_build =
+          op_desc->HasAttr("async_engine_build") &&
+          PADDLE_GET_CONST(bool, op_desc->GetAttr("async_engine_build"));
+      if (!async_engine_build) {
+        trt_repetitive_params.insert(
+            trt_repetitive_params.end(), trt_params.begin(), trt_params.end());
+      }
       // NOTE(ming1753): This is a trick solution to the problem of possible
       // absolute paths in the model_opt_cache_dir and shape_range_info_path
       // attributes in tensorrt_engine op.
@@ -670,11 +811,24 @@ void AnalysisPredictor::ClearExtraParams() {
   }
 
   scope_->EraseVars(extra_params);
+  if (executor_) {
+    executor_->ClearVarSlots();
+  }
   VLOG(1) << "Clear " << extra_params.size() << " extra params.";
 }
 
 void AnalysisPredictor::InitResourceManager(void *stream) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (stream == nullptr && config_.colocation_enabled()) {
+    int num_streams =
+        inference::ColocationDevice::Get(place_.GetDeviceId()).num_streams();
+    if (num_streams > 0) {
+      predictor_stream_ = ResourceManager::Instance().InitPooledGPUResource(
+          place_, num_streams, this);
+      pooled_gpu_resource_ = true;
+      return;
+    }
+  }
   predictor_stream_ =
       ResourceManager::Instance().InitGPUResource(place_, stream);
 #endif
@@ -684,12 +838,26 @@ void AnalysisPredictor::InitDeviceContexts() {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // Init GPUContext.
   if (place_.GetType() == phi::AllocationType::GPU) {
+    if (config_.colocation_enabled()) {
+      auto &device = inference::ColocationDevice::Get(place_.GetDeviceId());
+      colocation_allocator_ = device.CreateAllocator(
+          memory::allocation::AllocatorFacade::Instance().GetAllocator(
+              place_, static_cast<gpuStream_t>(predictor_stream_)),
+          config_.colocation_memory_quota());
+      colocation_scheduler_ = device.scheduler();
+    }
     device_contexts_.emplace(
         place_, std::async(std::launch::deferred, [=] {
           auto *gpu_resource =
-              ResourceManager::Instance().GetGPUResource(predictor_stream_);
+              pooled_gpu_resource_
+                  ? ResourceManager::Instance().GetPooledGPUResource(this)
+                  : ResourceManager::Instance().GetGPUResource(
+                        predictor_stream_);
           auto *gpu_context = new InferGPUContext(place_);
           UpdatePrivateDeviceContext(gpu_context, gpu_resource, place_);
+          if (colocation_allocator_ != nullptr) {
+            gpu_context->SetAllocator(colocation_allocator_);
+          }
           return std::unique_ptr<phi::DeviceContext>(gpu_context);
         }));
   }
@@ -936,6 +1104,10 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
           }
         }
       }
+      if (!config_.cpu_weight_only_algo().empty()) {
+        pass_pm.AddPass(
+            pir::PassRegistry::Instance().Get("cpu_weight_only_linear_pass"));
+      }
     }
 
     // set attr
@@ -947,6 +1119,10 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
           pass->name() == "conv2d_add_fuse_pass") {
         pass->Set("use_cutlass", new bool(config_.use_cutlass_));
       }
+      if (pass->name() == "cpu_weight_only_linear_pass") {
+        pass->Set("weight_only_algo",
+                  new std::string(config_.cpu_weight_only_algo()));
+      }
     }
 
     if (!config_.glog_info_disabled()) {
@@ -1062,6 +1238,24 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
     remove_shadow_feed_pass->Set("used_for_inference", new bool(true));
     lowered_pm.AddPass(std::move(remove_shadow_feed_pass));
   }
+  if (FLAGS_pir_while_hoist_invariant) {
+    auto while_hoist_pass = ::pir::CreateWhileLoopInvariantCodeMotionPass();
+    if (std::find(config_.deleted_passes_.begin(),
+                  config_.deleted_passes_.end(),
+                  while_hoist_pass->name()) == config_.deleted_passes_.end()) {
+      lowered_pm.AddPass(std::move(while_hoist_pass));
+    }
+  }
+  if (FLAGS_pir_remove_redundant_transfer) {
+    auto remove_redundant_transfer_pass =
+        ::pir::CreateRemoveRedundantTransferPass();
+    if (std::find(config_.deleted_passes_.begin(),
+                  config_.deleted_passes_.end(),
+                  remove_redundant_transfer_pass->name()) ==
+        config_.deleted_passes_.end()) {
+      lowered_pm.AddPass(std::move(remove_redundant_transfer_pass));
+    }
+  }
   if (FLAGS_pir_apply_inplace_pass) {
     auto inplace_pass = ::pir::CreateInplacePass();
     if (std::find(config_.deleted_passes_.begin(),
@@ -1080,6 +1274,9 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
   }
   lowered_pm.Run(pir_program_.get());
 
+  if (config_.lowered_program_cache_enabled()) {
+    SaveLoweredProgramCache();
+  }
   LOG(INFO) << "======= pir optimization completed =======";
 }
 
@@ -1177,6 +1374,210 @@ bool AnalysisPredictor::SaveOrLoadPirParameters(bool for_save) {
   return true;
 }
 
+bool AnalysisPredictor::LoadLoweredProgramCache() {
+  lowered_program_cache_key_ = LoweredProgramCacheKey();
+  if (lowered_program_cache_key_.empty()) {
+    return false;
+  }
+  std::ostringstream path;
+  path << GetOptimizedModelPath() << "/_lowered_program_cache/" << std::hex
+       << common::StableHash(lowered_program_cache_key_);
+  // The meta file is renamed last when saving, so the others are complete
+  // if it exists.
+  std::ifstream meta(path.str() + ".meta");
+  if (!meta) {
+    VLOG(3) << "Lowered program cache " << path.str() << " is not found";
+    return false;
+  }
+  size_t key_size = 0;
+  meta >> key_size;
+  meta.get();
+  std::string key(key_size, '\0');
+  meta.read(&key[0], static_cast<std::streamsize>(key_size));
+  if (!meta || key != lowered_program_cache_key_) {
+    VLOG(3) << "Lowered program cache " << path.str()
+            << " belongs to another model or config";
+    return false;
+  }
+
+  std::map<size_t, std::string> idx2feeds;
+  std::map<std::string, std::vector<int64_t>> feed_name2shapes;
+  std::map<size_t, std::string> idx2fetches;
+  std::map<std::string, std::vector<int64_t>> fetch_name2shapes;
+  std::vector<std::pair<std::string, bool>> params;
+  size_t num = 0;
+  size_t idx = 0;
+  std::string name;
+  std::vector<int64_t> shape;
+  meta >> num;
+  for (size_t i = 0; i < num && ReadNameAndShape(meta, &idx, &name, &shape);
+       ++i) {
+    idx2feeds[idx] = name;
+    feed_name2shapes[name] = shape;
+  }
+  meta >> num;
+  for (size_t i = 0; i < num && ReadNameAndShape(meta, &idx, &name, &shape);
+       ++i) {
+    idx2fetches[idx] = name;
+    fetch_name2shapes[name] = shape;
+  }
+  meta >> num;
+  for (size_t i = 0; i < num; ++i) {
+    bool on_device = false;
+    meta >> name >> on_device;
+    params.emplace_back(name, on_device);
+  }
+  if (!meta) {
+    LOG(WARNING) << "Lowered program cache " << path.str() << " is broken";
+    return false;
+  }
+
+  try {
+    pir::IrContext *ctx = pir::IrContext::Instance();
+    ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+    ctx->GetOrRegisterDialect<paddle::dialect::KernelDialect>();
+    ctx->GetOrRegisterDialect<paddle::dialect::CustomKernelDialect>();
+#ifdef PADDLE_WITH_DNNL
+    ctx->GetOrRegisterDialect<paddle::dialect::OneDNNKernelDialect>();
+#endif
+    auto program = std::make_shared<pir::Program>(ctx);
+    pir::ReadModule(path.str() + ".pir", program.get(), 1 /*pir_version*/);
+
+    std::ifstream fin(path.str() + ".pdiparams", std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
+                      true,
+                      common::errors::Unavailable(
+                          "Cannot open %s to load the lowered program params.",
+                          path.str() + ".pdiparams"));
+    phi::DeviceContextPool &pool = phi::DeviceContextPool::Instance();
+    for (const auto &[param_name, on_device] : params) {
+      auto *tensor =
+          sub_scope_->Var(param_name)->GetMutable<phi::DenseTensor>();
+      framework::DeserializeFromStream(
+          fin, tensor, *pool.Get(on_device ? place_ : phi::CPUPlace()));
+    }
+    pir_program_ = program;
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to load lowered program cache " << path.str()
+                 << ": " << e.what();
+    return false;
+  }
+
+  if (load_pir_model_) {
+    idx2feeds_ = idx2feeds;
+    feed_name2shapes_ = feed_name2shapes;
+    idx2fetches_ = idx2fetches;
+    fetch_name2shapes_ = fetch_name2shapes;
+    feed_names_.clear();
+    for (const auto &[feed_idx, feed_name] : idx2feeds_) {
+      feed_names_[feed_name] = feed_idx;
+    }
+    // Only the numbers of the feeds and fetches are used, their ops are not
+    // kept after lowering.
+    pir_feeds_.assign(idx2feeds_.size(), nullptr);
+    pir_fetches_.assign(idx2fetches_.size(), nullptr);
+  }
+  LOG(INFO) << "Load lowered program from " << path.str() << ".pir";
+  return true;
+}
+
+void AnalysisPredictor::SaveLoweredProgramCache() {
+  if (lowered_program_cache_key_.empty()) {
+    return;
+  }
+  std::vector<std::string> param_names;
+  for (auto op : pir_program_->block()->ops()) {
+    if (op->isa<::pir::ParameterOp>()) {
+      param_names.emplace_back(op->dyn_cast<::pir::ParameterOp>().param_name());
+    } else if (op->isa<::pir::ConstantTensorOp>()) {
+      param_names.emplace_back(
+          op->dyn_cast<::pir::ConstantTensorOp>().tensor_name());
+    }
+  }
+
+  std::ostringstream path;
+  path << GetOptimizedModelPath() << "/_lowered_program_cache/" << std::hex
+       << common::StableHash(lowered_program_cache_key_);
+  // Write temporary files and rename them, so that the predictors sharing the
+  // cache never see partial files.
+  std::ostringstream suffix;
+  suffix << ".tmp." << predictor_id_ << "."
+         << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+         << std::chrono::steady_clock::now().time_since_epoch().count();
+  const std::vector<std::string> exts = {".pir", ".pdiparams", ".meta"};
+  try {
+    inference::analysis::MakeDirIfNotExists(GetOptimizedModelPath() +
+                                            "/_lowered_program_cache");
+    std::ostringstream meta;
+    meta << lowered_program_cache_key_.size() << "\n"
+         << lowered_program_cache_key_ << "\n";
+    meta << idx2feeds_.size() << "\n";
+    for (const auto &[idx, name] : idx2feeds_) {
+      WriteNameAndShape(meta, idx, name, feed_name2shapes_[name]);
+    }
+    meta << idx2fetches_.size() << "\n";
+    for (const auto &[idx, name] : idx2fetches_) {
+      WriteNameAndShape(meta, idx, name, fetch_name2shapes_[name]);
+    }
+    meta << param_names.size() << "\n";
+
+    std::ofstream params(path.str() + exts[1] + suffix.str(),
+                         std::ios::binary);
+    phi::DeviceContextPool &pool = phi::DeviceContextPool::Instance();
+    for (const auto &name : param_names) {
+      auto *var = sub_scope_->FindVar(name);
+      PADDLE_ENFORCE_EQ(
+          var != nullptr && var->IsType<phi::DenseTensor>() &&
+              var->Get<phi::DenseTensor>().IsInitialized(),
+          true,
+          common::errors::Unavailable(
+              "Only the initialized DenseTensor params can be cached, %s is "
+              "not.",
+              name));
+      const auto &tensor = var->Get<phi::DenseTensor>();
+      bool on_device = !phi::is_cpu_place(tensor.place());
+      framework::SerializeToStream(params, tensor, *pool.Get(tensor.place()));
+      meta << name << " " << on_device << "\n";
+    }
+    params.close();
+    PADDLE_ENFORCE_EQ(static_cast<bool>(params),
+                      true,
+                      common::errors::Unavailable(
+                          "Failed to write %s.", path.str() + exts[1]));
+
+    pir::WriteModule(*pir_program_,
+                     path.str() + exts[0] + suffix.str(),
+                     1 /*pir_version*/,
+                     true /*overwrite*/,
+                     false /*readable*/,
+                     true /*trainable*/,
+                     true /*binary*/);
+    std::ofstream meta_file(path.str() + exts[2] + suffix.str());
+    meta_file << meta.str();
+    meta_file.close();
+    PADDLE_ENFORCE_EQ(static_cast<bool>(meta_file),
+                      true,
+                      common::errors::Unavailable(
+                          "Failed to write %s.", path.str() + exts[2]));
+    for (const auto &ext : exts) {
+      PADDLE_ENFORCE_EQ(
+          std::rename((path.str() + ext + suffix.str()).c_str(),
+                      (path.str() + ext).c_str()),
+          0,
+          common::errors::Unavailable("Failed to rename %s.",
+                                      path.str() + ext + suffix.str()));
+    }
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to save lowered program cache " << path.str()
+                 << ": " << e.what();
+    for (const auto &ext : exts) {
+      std::remove((path.str() + ext + suffix.str()).c_str());
+    }
+    return;
+  }
+  LOG(INFO) << "Lowered program saved to " << path.str() << ".pir";
+}
+
 bool AnalysisPredictor::PreparePirProgram() {
   pir::IrContext *ctx = pir::IrContext::Instance();
   ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
@@ -1186,6 +1587,10 @@ bool AnalysisPredictor::PreparePirProgram() {
       nullptr,
       common::errors::Fatal("Here, pir_program must be a nullptr!"));
 
+  if (config_.lowered_program_cache_enabled() && LoadLoweredProgramCache()) {
+    return true;
+  }
+
   pir_program_ = std::make_shared<pir::Program>(pir::IrContext::Instance());
   pir::ReadModule(config_.prog_file(), pir_program_.get(), 1 /*pir_version*/);
   if (!SaveOrLoadPirParameters(false)) {
@@ -1197,6 +1602,18 @@ bool AnalysisPredictor::PreparePirProgram() {
 
 bool AnalysisPredictor::PrepareProgram(
     const std::shared_ptr<framework::ProgramDesc> &program) {
+  if (config_.new_ir_enabled()) {
+    PADDLE_ENFORCE_EQ(
+        pir_program_,
+        nullptr,
+        common::errors::Fatal("Here, pir_program must be a nullptr!"));
+  }
+  // On a hit, the pir program and all the params it uses come from the
+  // lowered program cache, so the program is neither analyzed nor translated
+  // and only its feeds and fetches are used.
+  const bool lowered_program_cached = config_.new_ir_enabled() &&
+                                      config_.lowered_program_cache_enabled() &&
+                                      LoadLoweredProgramCache();
   if (!program) {
     if (!LoadProgramDesc()) return false;
     // If not cloned, the parameters should be loaded.
@@ -1221,7 +1638,10 @@ bool AnalysisPredictor::PrepareProgram(
               << inference::tensorrt::TensorRTEngine::predictor_id_per_thread;
     }
 #endif
-    if (config_.use_optimized_model_) {
+    if (lowered_program_cached) {
+      VLOG(3) << "Skip the analysis of the program with the lowered program "
+                 "cache.";
+    } else if (config_.use_optimized_model_) {
       LoadParameters();
       ClearExtraParams();
 #ifdef PADDLE_WITH_CUDA
@@ -1236,7 +1656,7 @@ bool AnalysisPredictor::PrepareProgram(
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
     inference_program_ = program;
-    if (config_.apply_optim_) {
+    if (config_.apply_optim_ && !lowered_program_cached) {
       VLOG(3)
           << "apply_optim is enabled, will call OptimizeInferenceProgram().";
       OptimizeInferenceProgram();
@@ -1245,11 +1665,7 @@ bool AnalysisPredictor::PrepareProgram(
 
   executor_->CreateVariables(*inference_program_, 0, false, sub_scope_);
 
-  if (config_.new_ir_enabled()) {
-    PADDLE_ENFORCE_EQ(
-        pir_program_,
-        nullptr,
-        common::errors::Fatal("Here, pir_program must be a nullptr!"));
+  if (config_.new_ir_enabled() && !lowered_program_cached) {
     pir_program_ = paddle::TranslateLegacyProgramToProgram(*inference_program_);
     OptimizeInferencePirProgram();
   }
@@ -1300,6 +1716,61 @@ static void DisablePrepareDataOpt(
   }
 }
 
+void AnalysisPredictor::PrepackGemmWeights() {
+  // The name of the constant weight defining value, or "" if it is computed.
+  auto weight_name = [](pir::Value value) -> std::string {
+    auto *op = value.defining_op();
+    if (op == nullptr) return "";
+    if (op->isa<::pir::ParameterOp>()) {
+      return op->dyn_cast<::pir::ParameterOp>().param_name();
+    } else if (op->isa<::pir::ConstantTensorOp>()) {
+      return op->dyn_cast<::pir::ConstantTensorOp>().tensor_name();
+    }
+    return "";
+  };
+
+  const auto &dev_ctx = *static_cast<const phi::CPUContext *>(
+      phi::DeviceContextPool::Instance().Get(place_));
+  int packed_count = 0;
+  for (auto *op : pir_program_->block()->ops()) {
+    if (!op->isa<paddle::dialect::PhiKernelOp>()) continue;
+    auto kernel_op = op->dyn_cast<paddle::dialect::PhiKernelOp>();
+    auto kernel_key = kernel_op.kernel_key();
+    if (kernel_key.backend() != phi::Backend::CPU ||
+        kernel_key.dtype() != phi::DataType::FLOAT32) {
+      continue;
+    }
+    // The GEMMs of the weights: the operand, as the A matrix or the B one,
+    // and transposed or not.
+    const std::string op_name = kernel_op.op_name();
+    size_t operand = 1;
+    bool is_a_matrix = false, trans = false;
+    if (op_name == "pd_op.fc") {
+      if (op->attribute<pir::BoolAttribute>("padding_weights").data()) {
+        continue;
+      }
+    } else if (op_name == "pd_op.matmul") {
+      trans = op->attribute<pir::BoolAttribute>("transpose_y").data();
+    } else if (op_name == "pd_op.conv2d") {
+      if (op->attribute<pir::Int32Attribute>("groups").data() != 1) continue;
+      is_a_matrix = true;
+    } else {
+      continue;
+    }
+    const std::string name = weight_name(op->operand_source(operand));
+    auto *var = name.empty() ? nullptr : sub_scope_->FindVar(name);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) continue;
+    if (phi::funcs::PackGemmWeight<float>(
+            dev_ctx,
+            is_a_matrix,
+            trans,
+            var->GetMutable<phi::DenseTensor>())) {
+      ++packed_count;
+    }
+  }
+  LOG(INFO) << "Pre-pack " << packed_count << " weights of the CPU GEMMs.";
+}
+
 bool AnalysisPredictor::PrepareExecutor() {
   PADDLE_ENFORCE_NOT_NULL(sub_scope_,
                           common::errors::PreconditionNotMet(
@@ -1317,6 +1788,9 @@ bool AnalysisPredictor::PrepareExecutor() {
   }
 
   if (config_.new_ir_enabled()) {
+    if (config_.gemm_weight_prepack_enabled() && phi::is_cpu_place(place_)) {
+      PrepackGemmWeights();
+    }
     executor_->Prepare(sub_scope_);
   } else {
     DisablePrepareDataOpt(inference_program_, 0, false);
@@ -1353,6 +1827,10 @@ bool AnalysisPredictor::PrepareExecutor() {
         pass_res_info->Get<std::unordered_map<std::string, std::string>>(
             root_predictor_id_, "memory_optimize_pass");
     executor_->MakeReusePlan(reuse_table);
+    executor_->MakeWorkspacePlan(
+        pass_res_info
+            ->Get<std::unordered_map<std::string, std::pair<int64_t, int64_t>>>(
+                root_predictor_id_, "memory_optimize_pass_workspace"));
   }
   return true;
 }
@@ -1687,12 +2165,15 @@ void AnalysisPredictor::MkldnnPreSet(
   }
   phi::OneDNNContext::tls().set_cur_input_shape_cache_capacity(
       config_.mkldnn_cache_capacity_);
+  phi::OneDNNContext::tls().set_primitive_cache_scope(
+      onednn_primitive_cache_scope_);
 
 #endif
 }
 
 void AnalysisPredictor::MkldnnPostReset() {
 #ifdef PADDLE_WITH_DNNL
+  phi::OneDNNContext::tls().set_primitive_cache_scope("");
   // In cache clearing mode.
   if (config_.mkldnn_cache_capacity_ > 0 &&
       static_cast<phi::OneDNNContext *>(
@@ -1716,6 +2197,73 @@ void AnalysisPredictor::MkldnnPostReset() {
 #endif
 }
 
+void AnalysisPredictor::WarmupOneDNNPrimitiveCache() {
+#ifdef PADDLE_WITH_DNNL
+  const auto &path = config_.onednn_primitive_cache_warmup_path();
+  if (!phi::OneDNNPrimitiveCache::Enabled()) {
+    LOG(WARNING) << "The OneDNN primitive cache is not warmed up, please set "
+                    "FLAGS_onednn_primitive_cache_capacity to enable it.";
+    return;
+  }
+  std::map<std::string, std::vector<int32_t>> min_shape, max_shape, opt_shape;
+  std::map<std::string, std::vector<int32_t>> min_value, max_value, opt_value;
+  inference::DeserializeShapeRangeInfo(path,
+                                       &min_shape,
+                                       &max_shape,
+                                       &opt_shape,
+                                       &min_value,
+                                       &max_value,
+                                       &opt_value);
+  auto dtypes = GetInputTypes();
+  for (const auto *shapes : {&min_shape, &opt_shape, &max_shape}) {
+    for (const auto &name : GetInputNames()) {
+      auto it = shapes->find(name);
+      if (it == shapes->end()) {
+        LOG(WARNING) << "The OneDNN primitive cache is not warmed up, the "
+                        "shape of the input "
+                     << name << " is not in " << path;
+        return;
+      }
+      auto tensor = GetInputTensor(name);
+      tensor->Reshape(std::vector<int>(it->second.begin(), it->second.end()));
+      int64_t numel = 1;
+      for (auto dim : it->second) numel *= dim;
+      switch (dtypes[name]) {
+        case paddle_infer::DataType::FLOAT32:
+          FillZeros<float>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::FLOAT64:
+          FillZeros<double>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::INT64:
+          FillZeros<int64_t>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::INT32:
+          FillZeros<int32_t>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::UINT8:
+          FillZeros<uint8_t>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::INT8:
+          FillZeros<int8_t>(tensor.get(), numel);
+          break;
+        case paddle_infer::DataType::BOOL:
+          FillZeros<bool>(tensor.get(), numel);
+          break;
+        default:
+          LOG(WARNING) << "The OneDNN primitive cache is not warmed up, the "
+                          "dtype of the input "
+                       << name << " is not supported.";
+          return;
+      }
+    }
+    ZeroCopyRun();
+  }
+  VLOG(3) << "The OneDNN primitive cache is warmed up by " << path
+          << ", size: " << phi::OneDNNPrimitiveCache::Instance().Size();
+#endif
+}
+
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
@@ -1724,6 +2272,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
   VLOG(3) << "Predictor::predict";
+  inference::ScopedCompactionRun compaction_run(idle_compactor_.get());
   // set feed variable
   framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
   PADDLE_ENFORCE_NOT_NULL(
@@ -1745,8 +2294,9 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   if (config_.new_ir_enabled()) {
     ::paddle::framework::RunFeedHooks(*pir_program_, *scope);
   }
-  if (config_.shape_range_info_collected()) {
-    HookCollectShapeRangeInfo();
+  if (config_.shape_range_info_collected() ||
+      config_.shape_range_info_collected_online()) {
+    BeginShapeRangeCollection();
   }
 
   if (config_.new_executor_enabled()) {  // NOLINT
@@ -1801,6 +2351,12 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
   VLOG(3) << "predict start";
+  inference::ScopedScheduledRun scheduled_run(
+      colocation_scheduler_.get(), this, config_.colocation_weight());
+  inference::ScopedCompactionRun compaction_run(idle_compactor_.get());
+  const bool run_stats = config_.run_statistics_enabled();
+  if (run_stats) BeginRunStatistics();
+  const auto run_start = std::chrono::steady_clock::now();
   // set feed variable
   framework::Scope *scope{nullptr};
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -1819,6 +2375,8 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  auto phase_start = run_start;
+  if (run_stats) phase_start = RecordRunLatency("feed", phase_start);
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled()) {
     inference::tensorrt::TensorRTEngine::predictor_id_per_thread =
@@ -1831,8 +2389,9 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   if (config_.new_ir_enabled()) {
     ::paddle::framework::RunFeedHooks(*pir_program_, *scope);
   }
-  if (config_.shape_range_info_collected()) {
-    HookCollectShapeRangeInfo();
+  if (config_.shape_range_info_collected() ||
+      config_.shape_range_info_collected_online()) {
+    BeginShapeRangeCollection();
   }
 #ifdef PADDLE_WITH_XPU
   InferXPUContext *infer_xpu_ctx = nullptr;
@@ -1859,6 +2418,7 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   }
 #endif
 
+  if (run_stats) RecordRunEvent(true);
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   if (config_.dist_config().use_dist_model()) {  // NOLINT
     VLOG(3) << "ZeroCopyRun will use the fleet executor.";
@@ -1879,6 +2439,10 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
     executor_->Run();
   }
 #endif
+  if (run_stats) {
+    phase_start = RecordRunLatency("executor", phase_start);
+    RecordRunEvent(false);
+  }
 
   inference::DisplayMemoryInfo(place_, "after run");
 #ifdef PADDLE_WITH_XPU
@@ -1891,6 +2455,13 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
+  if (run_stats) {
+    RecordRunLatency("fetch", phase_start);
+    RecordRunLatency("run", run_start);
+  }
+  if (colocation_scheduler_) {
+    phi::DeviceContextPool::Instance().Get(place_)->Wait();
+  }
 
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
@@ -2096,7 +2667,16 @@ void AnalysisPredictor::PrepareArgument() {
   argument_->SetGPUDeviceId(config_.gpu_device_id());
   argument_->SetEnableIrOptim(config_.enable_ir_optim_);
   argument_->SetEnableMemoryOptim(config_.enable_memory_optim());
+  argument_->SetMemoryOptimWorkspace(config_.memory_optim_workspace_);
+  if (!config_.memory_optim_shape_range_info_path_.empty()) {
+    argument_->SetMemoryOptimShapeRangeInfoPath(
+        config_.memory_optim_shape_range_info_path_);
+  } else if (config_.trt_tuned_dynamic_shape_) {
+    argument_->SetMemoryOptimShapeRangeInfoPath(
+        config_.shape_range_info_path_);
+  }
   argument_->SetModelFromMemory(config_.model_from_memory_);
+  argument_->SetUseMmapParams(config_.use_mmap_params_);
   argument_->SetUsePIR(config_.new_ir_enabled());
   // Analyze inference_program
   argument_->SetPredictorID(predictor_id_);
@@ -2148,7 +2728,11 @@ void AnalysisPredictor::PrepareArgument() {
     argument_->SetTensorRtUseDLA(config_.trt_use_dla_);
     argument_->SetTensorRtDLACore(config_.trt_dla_core_);
     argument_->SetTensorRtUseStaticEngine(config_.trt_use_static_engine_);
-    argument_->SetTensorRtUseCalibMode(config_.trt_use_calib_mode_);
+    // The activation ranges collected natively replace the TensorRT
+    // calibration.
+    argument_->SetTensorRtUseCalibMode(
+        config_.trt_use_calib_mode_ &&
+        config_.trt_activation_range_path_.empty());
     argument_->SetTensorRtUseCudaGraph(config_.trt_use_cuda_graph_);
     argument_->SetCloseTrtPluginFp16(config_.disable_trt_plugin_fp16_);
     argument_->SetTensorRtShapeRangeInfoPath(config_.shape_range_info_path());
@@ -2156,6 +2740,11 @@ void AnalysisPredictor::PrepareArgument() {
         config_.trt_allow_build_at_runtime());
     argument_->SetTensorRtUseInspector(config_.trt_use_inspector_);
     argument_->SetTensorRtInspectorSerialize(config_.trt_inspector_serialize_);
+    argument_->SetTensorRtRefit(config_.trt_refit_);
+    argument_->SetTensorRtActivationRangePath(
+        config_.trt_activation_range_path_);
+    argument_->SetTensorRtActivationRangePercentile(
+        config_.trt_activation_range_percentile_);
     argument_->SetTensorRtUseExplicitQuantization(
         config_.trt_use_explicit_quantization_);
     argument_->SetTrtEngineMemorySharing(config_.trt_engine_memory_sharing());
@@ -2457,6 +3046,17 @@ CreatePaddlePredictor<AnalysisConfig, PaddleEngineKind::kAnalysis>(
 
         // TODO(Shixiaowei02): Add a mandatory scheme to use the thread local
         // allocator when multi-stream is enabled.
+        if (config.cuda_malloc_async_allocator_enabled()) {
+          SetGflag("use_cuda_malloc_async_allocator", "true");
+          std::string threshold =
+              std::to_string(config.cuda_malloc_async_release_threshold_mb());
+          SetGflag("cuda_malloc_async_pool_release_threshold_mb",
+                   threshold.data());
+          if (config.cuda_malloc_async_peer_access()) {
+            SetGflag("cuda_malloc_async_pool_peer_access", "true");
+          }
+        }
+
         if (config.thread_local_stream_enabled()) {
           SetGflag("allocator_strategy", "thread_local");
           process_level_allocator_enabled = false;
@@ -2764,6 +3364,12 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
     pool.SyncDeviceContext(place_);
   }
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  inference::ScopedScheduledRun scheduled_run(
+      colocation_scheduler_.get(), this, config_.colocation_weight());
+  inference::ScopedCompactionRun compaction_run(idle_compactor_.get());
+  const bool run_stats = config_.run_statistics_enabled();
+  if (run_stats) BeginRunStatistics();
+  const auto run_start = std::chrono::steady_clock::now();
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) {
     std::vector<std::vector<int>> shape_vector;
@@ -2791,8 +3397,9 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
       ::paddle::framework::RunFeedHooks(*pir_program_, *scope);
     }
   }
-  if (config_.shape_range_info_collected()) {
-    HookCollectShapeRangeInfo();
+  if (config_.shape_range_info_collected() ||
+      config_.shape_range_info_collected_online()) {
+    BeginShapeRangeCollection();
   }
 #ifdef PADDLE_WITH_XPU
   InferXPUContext *infer_xpu_ctx = nullptr;
@@ -2819,11 +3426,23 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   }
 #endif
 
+  if (!output_bindings_.empty()) {
+    ApplyOutputBindings();
+  }
+  const auto executor_start = std::chrono::steady_clock::now();
+  if (run_stats) RecordRunEvent(true);
   if (config_.new_executor_enabled()) {  // NOLINT
     executor_->RunInterpreterCore({}, false, switch_stream);
   } else {
     executor_->Run();
   }
+  if (run_stats) {
+    RecordRunLatency("executor", executor_start);
+    RecordRunEvent(false);
+  }
+  if (!output_bindings_.empty()) {
+    SyncOutputBindings();
+  }
   inference::DisplayMemoryInfo(place_, "after run");
 
 #ifdef PADDLE_WITH_XPU
@@ -2848,6 +3467,11 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
+  if (run_stats) RecordRunLatency("run", run_start);
+  // The scheduled run holds the GPU until its kernels are done.
+  if (colocation_scheduler_) {
+    phi::DeviceContextPool::Instance().Get(place_)->Wait();
+  }
 
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
@@ -2884,6 +3508,11 @@ bool AnalysisPredictor::ExpRunWithExternalStream(const gpuStream_t stream) {
     ResourceManager::Instance().GpuResourceSwitchStream(predictor_stream_,
                                                         stream);
     predictor_stream_ = stream;
+    // The resource of the external stream is shared as usual.
+    if (pooled_gpu_resource_) {
+      ResourceManager::Instance().DestroyPooledGPUResource(this);
+      pooled_gpu_resource_ = false;
+    }
 
     auto *dev_ctxs = const_cast<
         std::map<phi::Place,
@@ -2918,6 +3547,7 @@ void AnalysisPredictor::HookCollectShapeRangeInfo() {
   auto hook = [&](const std::string &op_type,
                   const std::string &input_name,
                   const paddle::Tensor &input_tensor) -> void {
+    if (!sample_shape_range_) return;
     phi::DeviceContextPool &pool = phi::DeviceContextPool::Instance();
     if (config_.use_gpu()) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -2939,7 +3569,7 @@ void AnalysisPredictor::HookCollectShapeRangeInfo() {
     for (int i = 0; i < static_cast<int>(shape.size()); ++i)
       shape[i] = static_cast<int32_t>(dim[i]);
     if (!shape.empty()) {
-      shape_info_[input_name].emplace_back(shape);
+      ++shape_info_[input_name][shape];
     } else if (tensor->numel() > 0) {
       // This must be a zero dimension tensor.
       PADDLE_ENFORCE_EQ(tensor->numel(),
@@ -2948,7 +3578,7 @@ void AnalysisPredictor::HookCollectShapeRangeInfo() {
                             "This tensor must have one element, but got %ld.",
                             tensor->numel()));
       std::vector<int32_t> zero_shape(1, 1);
-      shape_info_[input_name].emplace_back(zero_shape);
+      ++shape_info_[input_name][zero_shape];
     }
 
     // We need collect value range for shape tensor for Paddle-TRT's use.
@@ -2994,12 +3624,201 @@ void AnalysisPredictor::HookCollectShapeRangeInfo() {
                              nullptr);
 #endif
       }
-      shape_tensor_value_[input_name].emplace_back(int32_host);
+      ++shape_tensor_value_[input_name][int32_host];
     }
   };
   RegisterInputHook(hook);
 }
 
+void AnalysisPredictor::BeginShapeRangeCollection() {
+  std::call_once(shape_range_hook_flag_,
+                 [this] { HookCollectShapeRangeInfo(); });
+  if (!config_.shape_range_info_collected_online()) return;
+  const int save_interval = config_.shape_range_save_interval();
+  if (save_interval > 0 && shape_range_num_runs_ > 0 &&
+      shape_range_num_runs_ % save_interval == 0) {
+    StatisticShapeRangeInfo();
+  }
+  sample_shape_range_ =
+      shape_range_num_runs_ % config_.shape_range_sample_interval() == 0;
+  ++shape_range_num_runs_;
+}
+
+void AnalysisPredictor::HookCollectActivationRange() {
+  activation_range_collector_ = inference::ActivationRangeCollector::Get(
+      config_.activation_range_path(), config_.activation_range_num_bins());
+  auto hook = [this](const std::string &op_type,
+                     const std::string &input_name,
+                     const paddle::Tensor &input_tensor) -> void {
+    if (!input_tensor.is_dense_tensor()) return;
+    auto tensor =
+        std::dynamic_pointer_cast<phi::DenseTensor>(input_tensor.impl()).get();
+    if (tensor->dtype() != phi::DataType::FLOAT32 || tensor->numel() == 0) {
+      return;
+    }
+    // The parameters in the root scope are not activations.
+    if (sub_scope_ && scope_->FindLocalVar(input_name)) return;
+    phi::DenseTensor cpu_tensor;
+    if (phi::is_cpu_place(tensor->place())) {
+      cpu_tensor.ShareDataWith(*tensor);
+    } else {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+      auto *dev_ctx = static_cast<phi::GPUContext *>(
+          phi::DeviceContextPool::Instance().Get(place_));
+#ifdef PADDLE_WITH_HIP
+      hipStreamSynchronize(dev_ctx->stream());
+#else
+      cudaStreamSynchronize(dev_ctx->stream());
+#endif
+#endif
+      framework::TensorCopySync(*tensor, phi::CPUPlace(), &cpu_tensor);
+    }
+    activation_range_collector_->Collect(
+        input_name, cpu_tensor.data<float>(), cpu_tensor.numel());
+  };
+  RegisterInputHook(hook);
+}
+
+void AnalysisPredictor::HookRunStatistics() {
+  // The ops run by the control flow ops are timed within them, so the starts
+  // are kept in a stack.
+  auto start = [this]() {
+    if (!sample_op_latency_) return;
+    phi::DeviceContextPool::Instance().Get(place_)->Wait();
+    op_starts_.push_back(std::chrono::steady_clock::now());
+  };
+  auto end = [this](const std::string &op_type) {
+    if (!sample_op_latency_ || op_starts_.empty()) return;
+    phi::DeviceContextPool::Instance().Get(place_)->Wait();
+    std::chrono::duration<double, std::micro> latency =
+        std::chrono::steady_clock::now() - op_starts_.back();
+    op_starts_.pop_back();
+    std::lock_guard<std::mutex> lock(run_stats_mutex_);
+    op_latency_[op_type].Record(latency.count());
+  };
+  if (config_.new_ir_enabled()) {
+    executor_->RegisterInputHook(
+        [start](framework::InstructionBase *,
+                framework::ValueExecutionInfo *,
+                framework::Scope *) { start(); });
+    executor_->RegisterOutputHook(
+        [end](framework::InstructionBase *instr,
+              framework::ValueExecutionInfo *,
+              framework::Scope *) { end(instr->Name()); });
+  } else {
+    executor_->RegisterInputHook(
+        [start](framework::OperatorBase *, framework::Scope *) { start(); });
+    executor_->RegisterOutputHook(
+        [end](framework::OperatorBase *op, framework::Scope *) {
+          end(op->Type());
+        });
+  }
+}
+
+void AnalysisPredictor::BeginRunStatistics() {
+  const int interval = config_.run_statistics_op_sample_interval();
+  sample_op_latency_ = interval > 0 && run_stats_num_runs_ % interval == 0;
+  ++run_stats_num_runs_;
+  op_starts_.clear();
+}
+
+std::chrono::steady_clock::time_point AnalysisPredictor::RecordRunLatency(
+    const std::string &phase, std::chrono::steady_clock::time_point start) {
+  const auto now = std::chrono::steady_clock::now();
+  if (!sample_op_latency_) {
+    std::chrono::duration<double, std::micro> latency = now - start;
+    std::lock_guard<std::mutex> lock(run_stats_mutex_);
+    run_latency_[phase].Record(latency.count());
+  }
+  return now;
+}
+
+void AnalysisPredictor::RecordRunEvent(bool start) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!phi::is_gpu_place(place_) || sample_op_latency_) return;
+  auto stream = static_cast<phi::GPUContext *>(
+                    phi::DeviceContextPool::Instance().Get(place_))
+                    ->stream();
+  std::lock_guard<std::mutex> lock(run_stats_mutex_);
+  if (start) {
+    // Collects the done runs first, so that their events are reused.
+    CollectRunEvents(false);
+    RunEvents events;
+    for (auto *event : {&events.start, &events.end}) {
+      if (free_run_events_.empty()) {
+        *event = std::make_unique<phi::CudaEvent>();
+      } else {
+        *event = std::move(free_run_events_.back());
+        free_run_events_.pop_back();
+      }
+    }
+    events.start->Record(stream);
+    pending_run_events_.push_back(std::move(events));
+  } else if (!pending_run_events_.empty() &&
+             !pending_run_events_.back().recorded) {
+    pending_run_events_.back().end->Record(stream);
+    pending_run_events_.back().recorded = true;
+  }
+#endif
+}
+
+void AnalysisPredictor::CollectRunEvents(bool wait) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  while (!pending_run_events_.empty()) {
+    auto &events = pending_run_events_.front();
+    if (!events.recorded) {
+      // The run is still launching its ops.
+      break;
+    }
+    if (!wait && !events.end->Query()) {
+      break;
+    }
+    // ElapsedTime waits for the end event.
+    run_latency_["sync"].Record(
+        events.start->ElapsedTime(events.end.get()) * 1000.);
+    free_run_events_.push_back(std::move(events.start));
+    free_run_events_.push_back(std::move(events.end));
+    pending_run_events_.pop_front();
+  }
+#endif
+}
+
+PaddleRunStats AnalysisPredictor::GetRunStats() {
+  auto to_stats = [](const inference::LatencyHistogram &histogram) {
+    PaddleLatencyStats stats;
+    stats.count = histogram.count();
+    stats.avg = histogram.avg();
+    stats.p50 = histogram.Percentile(50.);
+    stats.p99 = histogram.Percentile(99.);
+    stats.max = histogram.max();
+    return stats;
+  };
+  std::lock_guard<std::mutex> lock(run_stats_mutex_);
+  CollectRunEvents(true);
+  PaddleRunStats stats;
+  auto phase_stats = [&](const std::string &phase) {
+    auto it = run_latency_.find(phase);
+    return it == run_latency_.end() ? PaddleLatencyStats()
+                                    : to_stats(it->second);
+  };
+  stats.run = phase_stats("run");
+  stats.feed = phase_stats("feed");
+  stats.executor = phase_stats("executor");
+  stats.sync = phase_stats("sync");
+  stats.fetch = phase_stats("fetch");
+  for (auto &item : op_latency_) {
+    stats.ops[item.first] = to_stats(item.second);
+  }
+  return stats;
+}
+
+void AnalysisPredictor::ResetRunStats() {
+  std::lock_guard<std::mutex> lock(run_stats_mutex_);
+  CollectRunEvents(true);
+  run_latency_.clear();
+  op_latency_.clear();
+}
+
 bool AnalysisPredictor::ExpRunWithRuntimeConfig(void *config) {
 #ifdef PADDLE_WITH_XPU
   auto xpu_runtime_config =
@@ -3046,29 +3865,31 @@ void AnalysisPredictor::StatisticShapeRangeInfo() {
          decltype(shape_info_) shape_data) {
         for (auto const &it : shape_data) {
           auto name = it.first;
-          auto shapes = it.second;
+          const auto &shapes = it.second;
+          const auto &first_shape = shapes.begin()->first;
 
-          std::vector<int32_t> min_shape(shapes[0].begin(), shapes[0].end());
-          std::vector<int32_t> max_shape(shapes[0].begin(), shapes[0].end());
-          std::vector<int32_t> opt_shape(shapes[0].begin(), shapes[0].end());
+          std::vector<int32_t> min_shape(first_shape);
+          std::vector<int32_t> max_shape(first_shape);
+          std::vector<int32_t> opt_shape(first_shape);
 
           auto ShapeMaxFreq =
-              [](const std::map<int32_t, int32_t> &m) -> int32_t {
-            std::vector<std::pair<int32_t, int32_t>> counter;
+              [](const std::map<int32_t, int64_t> &m) -> int32_t {
+            std::vector<std::pair<int32_t, int64_t>> counter;
             for (auto &it : m) counter.emplace_back(it);
             std::sort(counter.begin(),
                       counter.end(),
-                      [](std::pair<int32_t, int32_t> &a,
-                         std::pair<int32_t, int32_t> &b) {
+                      [](std::pair<int32_t, int64_t> &a,
+                         std::pair<int32_t, int64_t> &b) {
                         return a.second > b.second;
                       });
             return counter[0].first;
           };
 
-          for (size_t d = 0; d < shapes[0].size(); ++d) {
-            std::map<int32_t, int32_t> counter;
-            for (auto &shape : shapes) {
-              counter[shape[d]] += 1;
+          for (size_t d = 0; d < first_shape.size(); ++d) {
+            std::map<int32_t, int64_t> counter;
+            for (auto &shape_count : shapes) {
+              const auto &shape = shape_count.first;
+              counter[shape[d]] += shape_count.second;
               if (shape[d] < min_shape[d]) min_shape[d] = shape[d];
               if (shape[d] > max_shape[d]) max_shape[d] = shape[d];
             }
@@ -3090,6 +3911,63 @@ void AnalysisPredictor::StatisticShapeRangeInfo() {
                                      min_values,
                                      max_values,
                                      opt_values);
+
+  // The shape bucket b holds the smallest (b + 1) / shape_bucket_num of the
+  // shapes of each tensor, and the last bucket is the whole range above.
+  const int bucket_num = config_.shape_bucket_num();
+  if (bucket_num <= 1) return;
+  std::vector<std::map<std::string, std::vector<int32_t>>> bucket_max_shapes(
+      bucket_num - 1);
+  std::vector<std::map<std::string, std::vector<int32_t>>> bucket_opt_shapes(
+      bucket_num - 1);
+  auto less_freq = [](const std::pair<const int32_t, int64_t> &x,
+                      const std::pair<const int32_t, int64_t> &y) {
+    return x.second < y.second;
+  };
+  for (auto const &it : shape_info_) {
+    // The shapes in the order of their numels, each the samples [first[i],
+    // first[i] + count) of all the samples in the order.
+    std::vector<std::pair<int64_t, const std::vector<int32_t> *>> order;
+    for (auto const &shape_count : it.second) {
+      int64_t numel = 1;
+      for (auto d : shape_count.first) numel *= d;
+      order.emplace_back(numel, &shape_count.first);
+    }
+    std::sort(order.begin(), order.end(), [](const auto &x, const auto &y) {
+      return x.first != y.first ? x.first < y.first : *x.second < *y.second;
+    });
+    std::vector<int64_t> first(order.size() + 1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+      first[i + 1] = first[i] + it.second.at(*order[i].second);
+    }
+    const int64_t num_samples = first.back();
+
+    int64_t begin = 0;
+    std::vector<int32_t> max_shape(*order[0].second);
+    for (int b = 0; b < bucket_num - 1; ++b) {
+      int64_t end = std::max<int64_t>(num_samples * (b + 1) / bucket_num, 1);
+      begin = std::min(begin, end - 1);
+      std::vector<int32_t> opt_shape(max_shape.size());
+      for (size_t d = 0; d < max_shape.size(); ++d) {
+        std::map<int32_t, int64_t> counter;
+        for (size_t i = 0; i < order.size(); ++i) {
+          const int64_t samples = std::min(first[i + 1], end) -
+                                  std::max(first[i], begin);
+          if (samples <= 0) continue;
+          const auto &shape = *order[i].second;
+          max_shape[d] = std::max(max_shape[d], shape[d]);
+          counter[shape[d]] += samples;
+        }
+        opt_shape[d] =
+            std::max_element(counter.begin(), counter.end(), less_freq)->first;
+      }
+      bucket_max_shapes[b][it.first] = max_shape;
+      bucket_opt_shapes[b][it.first] = opt_shape;
+      begin = end;
+    }
+  }
+  inference::SerializeShapeRangeBuckets(
+      config_.shape_range_info_path(), bucket_max_shapes, bucket_opt_shapes);
 }
 
 bool AnalysisPredictor::LoadProgramDesc() {
@@ -3141,7 +4019,7 @@ bool AnalysisPredictor::LoadProgramDesc() {
   return true;
 }
 
-bool AnalysisPredictor::LoadParameters() {
+bool AnalysisPredictor::LoadParameters(const std::string &params_file) {
   PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
                           common::errors::PreconditionNotMet(
                               "The inference program should be loaded first."));
@@ -3166,7 +4044,7 @@ bool AnalysisPredictor::LoadParameters() {
       new_var->SetLoDLevel(var->GetLoDLevel());
       new_var->SetPersistable(true);
 
-      if (!config_.params_file().empty()) {
+      if (!params_file.empty()) {
         params.push_back(new_var->Name());
       } else {
         // append_op
@@ -3179,14 +4057,23 @@ bool AnalysisPredictor::LoadParameters() {
     }
   }
 
-  if (!config_.params_file().empty()) {
+  if (!params_file.empty() && config_.use_mmap_params_ &&
+      !config_.model_from_memory() &&
+      inference::LoadPersistablesWithMmap(
+          *inference_program_, params_file, scope_.get(), place_)) {
+    VLOG(3) << "get " << scope_->LocalVarNames().size()
+            << " vars after load with mmap";
+    return true;
+  }
+
+  if (!params_file.empty()) {
     // sort paramlist to have consistent ordering
     std::sort(params.begin(), params.end());
     // append just the load_combine op
     framework::OpDesc *op = load_block->AppendOp();
     op->SetType("load_combine");
     op->SetOutput("Out", params);
-    op->SetAttr("file_path", {config_.params_file()});
+    op->SetAttr("file_path", {params_file});
     op->CheckAttrs();
   }
 
@@ -3208,6 +4095,238 @@ uint64_t AnalysisPredictor::TryShrinkMemory() {
   return paddle::memory::Release(place_);
 }
 
+uint64_t AnalysisPredictor::CompactMemory() {
+  if (idle_compactor_) {
+    return idle_compactor_->Compact();
+  }
+  return CompactMemoryImpl();
+}
+
+uint64_t AnalysisPredictor::CompactMemoryImpl() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // The captured CUDA graphs keep the addresses of the tensors, and without a
+  // sub scope the intermediate tensors are mixed with the parameters.
+  if (!phi::is_gpu_place(place_) || config_.trt_use_cuda_graph_ ||
+      sub_scope_ == nullptr) {
+    return TryShrinkMemory();
+  }
+  if (private_context_) {
+    phi::DeviceContextPool::SetDeviceContexts(&device_contexts_);
+  }
+  auto *dev_ctx = phi::DeviceContextPool::Instance().Get(place_);
+  dev_ctx->Wait();
+  // The cudaMallocAsync pool is not split into chunks, so trimming its unused
+  // memory is enough.
+  if (memory::allocation::AllocatorFacade::Instance()
+          .IsCUDAMallocAsyncAllocatorUsed()) {
+    return memory::Release(place_, predictor_stream_);
+  }
+  const int dev_id = place_.GetDeviceId();
+  int64_t reserved = memory::DeviceMemoryStatCurrentValue("Reserved", dev_id);
+
+  // The intermediate tensors keep their data between the runs, e.g. the
+  // outputs not fetched yet, so they are moved through the host memory: all
+  // of them are freed first, so the free blocks coalesce and the idle chunks
+  // are released, and then allocated again from the largest one.
+  std::unordered_map<phi::Allocation *, std::vector<phi::DenseTensor *>>
+      holder_tensors;
+  for (auto *var : sub_scope_->LocalVars()) {
+    if (!var->IsType<phi::DenseTensor>()) continue;
+    auto *tensor = var->GetMutable<phi::DenseTensor>();
+    const auto &holder = tensor->Holder();
+    if (holder == nullptr || holder->size() == 0 ||
+        holder->place() != place_) {
+      continue;
+    }
+    holder_tensors[holder.get()].push_back(tensor);
+  }
+  struct MovedHolder {
+    std::vector<phi::DenseTensor *> tensors;
+    std::shared_ptr<phi::Allocation> host_buffer;
+  };
+  std::vector<MovedHolder> moved_holders;
+  for (auto &item : holder_tensors) {
+    auto &tensors = item.second;
+    const auto &holder = tensors.front()->Holder();
+    // The holders kept by the others are not freed by moving the tensors,
+    // e.g. the bound outputs and the views of the workspace.
+    if (holder.use_count() != static_cast<int64_t>(tensors.size())) {
+      continue;
+    }
+    auto host_buffer = memory::AllocShared(phi::CPUPlace(), holder->size());
+    memory::Copy(phi::CPUPlace(),
+                 host_buffer->ptr(),
+                 place_,
+                 holder->ptr(),
+                 holder->size());
+    for (auto *tensor : tensors) {
+      tensor->ResetHolder(host_buffer);
+    }
+    moved_holders.push_back({std::move(tensors), std::move(host_buffer)});
+  }
+
+  TryShrinkMemory();
+  if (predictor_stream_ != nullptr) {
+    memory::Release(place_, static_cast<gpuStream_t>(predictor_stream_));
+  }
+
+  std::sort(moved_holders.begin(),
+            moved_holders.end(),
+            [](const MovedHolder &a, const MovedHolder &b) {
+              return a.host_buffer->size() > b.host_buffer->size();
+            });
+  for (auto &moved : moved_holders) {
+    size_t size = moved.host_buffer->size();
+    // Allocated by the context like the kernels, e.g. on its stream.
+    phi::DenseTensor buffer;
+    buffer.Resize({static_cast<int64_t>(size)});
+    void *ptr = dev_ctx->Alloc<uint8_t>(&buffer);
+    memory::Copy(place_, ptr, phi::CPUPlace(), moved.host_buffer->ptr(), size);
+    for (auto *tensor : moved.tensors) {
+      tensor->ResetHolder(buffer.Holder());
+    }
+  }
+  dev_ctx->Wait();
+  if (private_context_) {
+    phi::DeviceContextPool::SetDeviceContexts(nullptr);
+  }
+
+  int64_t released =
+      reserved - memory::DeviceMemoryStatCurrentValue("Reserved", dev_id);
+  VLOG(3) << "Moved " << moved_holders.size()
+          << " intermediate buffers, released " << released << " bytes";
+  return released > 0 ? released : 0;
+#else
+  return TryShrinkMemory();
+#endif
+}
+
+bool AnalysisPredictor::RefitTensorRTEngines(const std::string &params_file) {
+#ifdef PADDLE_WITH_TENSORRT
+  PADDLE_ENFORCE_EQ(
+      config_.tensorrt_engine_enabled() && config_.tensorrt_refit_enabled(),
+      true,
+      common::errors::PreconditionNotMet(
+          "The TensorRT engines should be built refittable by "
+          "AnalysisConfig::EnableTensorRtRefit to refit them."));
+  PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
+                          common::errors::PreconditionNotMet(
+                              "The inference program should be loaded first."));
+  PADDLE_ENFORCE_EQ(params_file.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The parameters file to refit the TensorRT engines "
+                        "should not be empty."));
+  inference::tensorrt::TensorRTEngine::predictor_id_per_thread = predictor_id_;
+  if (!LoadParameters(params_file)) {
+    return false;
+  }
+
+  auto &engine_manager =
+      inference::Singleton<inference::tensorrt::TRTEngineManager>::Global();
+  int refit_num = 0;
+  for (auto &op_desc : inference_program_->Block(0).AllOps()) {
+    if (op_desc->Type() != "tensorrt_engine") continue;
+    std::string engine_name =
+        PADDLE_GET_CONST(std::string, op_desc->GetAttr("engine_key")) +
+        std::to_string(PADDLE_GET_CONST(int, op_desc->GetAttr("predictor_id")));
+    // the engines not built yet are built by the loaded parameters
+    if (!engine_manager.Has(engine_name) ||
+        engine_manager.Get(engine_name)->engine() == nullptr) {
+      continue;
+    }
+    engine_manager.Get(engine_name)->Refit(*scope_);
+    ++refit_num;
+  }
+  VLOG(1) << "Refit " << refit_num << " TensorRT engines by " << params_file;
+
+  ClearExtraParams();
+#ifdef PADDLE_WITH_CUDA
+  if (config_.use_gpu()) {
+    paddle::platform::EmptyCache();
+  }
+#endif
+  return true;
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Please compile with TensorRT to refit the TensorRT engines."));
+#endif
+}
+
+bool AnalysisPredictor::BindOutput(const std::string &name,
+                                   void *data,
+                                   size_t size,
+                                   PaddlePlace place) {
+  auto output_names = GetOutputNames();
+  PADDLE_ENFORCE_NE(
+      std::find(output_names.begin(), output_names.end(), name),
+      output_names.end(),
+      common::errors::InvalidArgument("%s is not an output of the model.",
+                                      name));
+  if (data == nullptr) {
+    output_bindings_.erase(name);
+    return true;
+  }
+  phi::Place buffer_place;
+  if (place == PaddlePlace::kCPU) {
+    buffer_place = phi::CPUPlace();
+  } else {
+    PADDLE_ENFORCE_EQ(
+        (place == PaddlePlace::kGPU && phi::is_gpu_place(place_)) ||
+            (place == PaddlePlace::kXPU && phi::is_xpu_place(place_)) ||
+            (place == PaddlePlace::kCUSTOM && phi::is_custom_place(place_)),
+        true,
+        common::errors::InvalidArgument(
+            "The buffer bound to %s should be on the host or the device of "
+            "the predictor.",
+            name));
+    buffer_place = place_;
+  }
+  output_bindings_[name] =
+      std::make_shared<phi::Allocation>(data, size, buffer_place);
+  return true;
+}
+
+void AnalysisPredictor::ApplyOutputBindings() {
+  auto *scope = executor_->GetScope();
+  for (auto &binding : output_bindings_) {
+    auto &buffer = binding.second;
+    // The outputs on the device are copied to the buffers of the host.
+    if (buffer->place() != place_) continue;
+    auto *var = scope->FindVar(binding.first);
+    if (var == nullptr) continue;
+    auto *tensor = var->GetMutable<phi::DenseTensor>();
+    // The kernels allocate the outputs from the buffers large enough.
+    if (tensor->Holder() != buffer) {
+      tensor->clear();
+      tensor->ResetHolder(buffer);
+    }
+  }
+}
+
+void AnalysisPredictor::SyncOutputBindings() {
+  auto *scope = executor_->GetScope();
+  for (auto &binding : output_bindings_) {
+    auto &buffer = binding.second;
+    auto *var = scope->FindVar(binding.first);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) continue;
+    auto &tensor = var->Get<phi::DenseTensor>();
+    if (!tensor.initialized() || tensor.Holder() == buffer) continue;
+    size_t bytes = tensor.numel() * phi::SizeOf(tensor.dtype());
+    PADDLE_ENFORCE_LE(
+        bytes,
+        buffer->size(),
+        common::errors::OutOfRange(
+            "The output %s of %d bytes exceeds the %d bytes of its buffer.",
+            binding.first,
+            bytes,
+            buffer->size()));
+    VLOG(3) << "Copy the output " << binding.first << " to its buffer.";
+    phi::DenseTensor out(buffer, tensor.meta());
+    framework::TensorCopySync(tensor, buffer->place(), &out);
+  }
+}
+
 void AnalysisPredictor::ClearIntermediateTensor() {
   PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
                           common::errors::PreconditionNotMet(
@@ -3284,6 +4403,8 @@ bool AnalysisPredictor::SaveTrtCalibToDisk() {
 #endif
 
 AnalysisPredictor::~AnalysisPredictor() {  // NOLINT
+  // Stops the compactions before the scopes are deleted.
+  idle_compactor_.reset();
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled() &&
       config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
@@ -3309,10 +4430,24 @@ AnalysisPredictor::~AnalysisPredictor() {  // NOLINT
     scope_->DeleteScope(sub_scope_);
   }
 
-  if (config_.shape_range_info_collected()) {
+  if (config_.shape_range_info_collected() ||
+      config_.shape_range_info_collected_online()) {
     StatisticShapeRangeInfo();
   }
+  if (activation_range_collector_) {
+    activation_range_collector_->Serialize();
+  }
+  if (colocation_scheduler_) {
+    colocation_scheduler_->Remove(this);
+  }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (colocation_allocator_ != nullptr) {
+    inference::ColocationDevice::Get(place_.GetDeviceId())
+        .ReleaseAllocator(colocation_allocator_);
+  }
+  if (pooled_gpu_resource_) {
+    ResourceManager::Instance().DestroyPooledGPUResource(this);
+  }
   if (predictor_stream_ != nullptr) {
     ResourceManager::Instance().DestroyGPUResource(predictor_stream_);
   }
@@ -3337,6 +4472,7 @@ std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone(void *stream) {
   auto *x = new AnalysisPredictor(config_);
   x->status_is_cloned_ = true;
   x->root_predictor_id_ = this->root_predictor_id_;
+  x->onednn_primitive_cache_scope_ = this->onednn_primitive_cache_scope_;
   x->config_.apply_optim_ = false;
   if (config_.use_external_stream_ && stream == nullptr) {
     PADDLE_THROW(common::errors::InvalidArgument(
@@ -3753,6 +4889,15 @@ void Predictor::ClearIntermediateTensor() {
 
 uint64_t Predictor::TryShrinkMemory() { return predictor_->TryShrinkMemory(); }
 
+uint64_t Predictor::CompactMemory() { return predictor_->CompactMemory(); }
+
+bool Predictor::BindOutput(const std::string &name,
+                           void *data,
+                           size_t size,
+                           PlaceType place) {
+  return predictor_->BindOutput(name, data, size, place);
+}
+
 void Predictor::RegisterOutputHook(const OutputTensorHookFunc &hookfunc) {
   predictor_->RegisterOutputHook(hookfunc);
 }
@@ -3760,6 +4905,10 @@ void Predictor::RegisterInputHook(const InputTensorHookFunc &hookfunc) {
   predictor_->RegisterInputHook(hookfunc);
 }
 
+RunStats Predictor::GetRunStats() { return predictor_->GetRunStats(); }
+
+void Predictor::ResetRunStats() { predictor_->ResetRunStats(); }
+
 void *Predictor::GetExecStream() const { return predictor_->GetExecStream(); }
 
 int GetNumBytesOfDataType(DataType dtype) {
@@ -3831,6 +4980,11 @@ std::shared_ptr<Predictor> CreatePredictor(const Config &config) {  // NOLINT
 }
 
 namespace services {
+void SetColocationOptions(int device_id, const ColocationOptions &options) {
+  paddle::inference::ColocationDevice::Get(device_id).SetOptions(
+      options.memory_cap, options.num_streams, options.max_concurrent_runs);
+}
+
 PredictorPool::PredictorPool(const Config &config, size_t size) : preds_() {
   PADDLE_ENFORCE_GE(
       size,
@@ -3863,6 +5017,527 @@ Predictor *PredictorPool::Retrieve(size_t idx) {
   }
   return preds_[idx - 1].get();
 }
+
+struct AsyncPredictorPool::Impl {
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    Task task;
+    std::promise<bool> promise;
+    Clock::time_point submit_time;
+  };
+
+  std::shared_ptr<Predictor> main_pred;
+  std::vector<std::unique_ptr<Predictor>> preds;
+  std::vector<std::thread> workers;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Request> requests;
+  bool stop{false};
+
+  // guarded by mutex
+  AsyncPredictorPoolStats stats;
+  double total_queue_time{0.};
+  double total_run_time{0.};
+
+  void WorkerLoop(size_t idx) {
+    Predictor* pred = idx == 0 ? main_pred.get() : preds[idx - 1].get();
+    while (true) {
+      Request request;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return stop || !requests.empty(); });
+        // the submitted requests are finished before stopping
+        if (requests.empty()) {
+          return;
+        }
+        request = std::move(requests.front());
+        requests.pop_front();
+      }
+      auto start_time = Clock::now();
+      bool ok = false;
+      try {
+        ok = request.task(pred);
+        request.promise.set_value(ok);
+      } catch (...) {
+        request.promise.set_exception(std::current_exception());
+      }
+      auto end_time = Clock::now();
+      double queue_time = std::chrono::duration<double, std::micro>(
+                              start_time - request.submit_time)
+                              .count();
+      double run_time =
+          std::chrono::duration<double, std::micro>(end_time - start_time)
+              .count();
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.num_finished;
+      if (!ok) {
+        ++stats.num_failed;
+      }
+      ++stats.num_runs[idx];
+      total_queue_time += queue_time;
+      total_run_time += run_time;
+      stats.max_queue_time = std::max(stats.max_queue_time, queue_time);
+      stats.max_run_time = std::max(stats.max_run_time, run_time);
+    }
+  }
+};
+
+AsyncPredictorPool::AsyncPredictorPool(const Config &config,
+                                       size_t size,
+                                       const std::vector<void *> &streams)
+    : impl_(new Impl) {
+  PADDLE_ENFORCE_GE(
+      size,
+      1UL,
+      common::errors::InvalidArgument(
+          "The predictor pool size should be greater than 1, but it's (%d)",
+          size));
+  PADDLE_ENFORCE_EQ(
+      streams.empty() || streams.size() == size,
+      true,
+      common::errors::InvalidArgument(
+          "One stream should be given for each of the (%d) predictors of the "
+          "pool, but (%d) streams are given.",
+          size,
+          streams.size()));
+  Config main_config(config);
+  if (!streams.empty()) {
+    main_config.SetExecStream(streams[0]);
+  }
+  impl_->main_pred = std::make_shared<Predictor>(main_config);
+  for (size_t i = 1; i < size; ++i) {
+    impl_->preds.emplace_back(
+        impl_->main_pred->Clone(streams.empty() ? nullptr : streams[i]));
+  }
+  impl_->stats.num_runs.assign(size, 0);
+  for (size_t i = 0; i < size; ++i) {
+    impl_->workers.emplace_back([this, i] { impl_->WorkerLoop(i); });
+  }
+}
+
+AsyncPredictorPool::~AsyncPredictorPool() {
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->stop = true;
+  }
+  impl_->cv.notify_all();
+  for (auto &worker : impl_->workers) {
+    worker.join();
+  }
+}
+
+std::future<bool> AsyncPredictorPool::Submit(Task task) {
+  Impl::Request request;
+  request.task = std::move(task);
+  request.submit_time = Impl::Clock::now();
+  auto future = request.promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    PADDLE_ENFORCE_EQ(impl_->stop,
+                      false,
+                      common::errors::PreconditionNotMet(
+                          "Cannot submit to a stopped AsyncPredictorPool."));
+    impl_->requests.emplace_back(std::move(request));
+  }
+  impl_->cv.notify_one();
+  return future;
+}
+
+std::future<bool> AsyncPredictorPool::Run(
+    std::vector<paddle::Tensor> inputs, std::vector<paddle::Tensor> *outputs) {
+  auto shared_inputs =
+      std::make_shared<std::vector<paddle::Tensor>>(std::move(inputs));
+  return Submit([shared_inputs, outputs](Predictor *pred) {
+    return pred->Run(*shared_inputs, outputs);
+  });
+}
+
+AsyncPredictorPoolStats AsyncPredictorPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  AsyncPredictorPoolStats stats = impl_->stats;
+  stats.num_pending = impl_->requests.size();
+  if (stats.num_finished > 0) {
+    stats.avg_queue_time =
+        impl_->total_queue_time / static_cast<double>(stats.num_finished);
+    stats.avg_run_time =
+        impl_->total_run_time / static_cast<double>(stats.num_finished);
+  }
+  return stats;
+}
+
+void AsyncPredictorPool::ResetStats() {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  size_t size = impl_->stats.num_runs.size();
+  impl_->stats = AsyncPredictorPoolStats();
+  impl_->stats.num_runs.assign(size, 0);
+  impl_->total_queue_time = 0.;
+  impl_->total_run_time = 0.;
+}
+
+size_t AsyncPredictorPool::size() const { return impl_->workers.size(); }
+
+namespace {
+
+phi::DenseTensor *GetDenseTensor(const paddle::Tensor &tensor) {
+  auto *dense_tensor = dynamic_cast<phi::DenseTensor *>(tensor.impl().get());
+  PADDLE_ENFORCE_NOT_NULL(
+      dense_tensor,
+      common::errors::InvalidArgument(
+          "DynamicBatcher only supports DenseTensor, but %s is not.",
+          tensor.name()));
+  return dense_tensor;
+}
+
+// Copy src to the rows starting at begin of the allocated dst.
+void CopyRows(const phi::DenseTensor &src,
+              int64_t begin,
+              phi::DenseTensor *dst) {
+  phi::DenseTensor dst_rows = dst->Slice(begin, begin + src.dims()[0]);
+  framework::TensorCopySync(src, dst->place(), &dst_rows);
+}
+
+}  // namespace
+
+struct DynamicBatcher::Impl {
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    std::vector<paddle::Tensor> inputs;
+    int64_t batch_size{0};
+    std::promise<std::vector<paddle::Tensor>> promise;
+    Clock::time_point submit_time;
+  };
+
+  DynamicBatcherConfig config;
+  std::vector<int> batch_sizes;
+  // the outputs whose first dimension is declared as -1 by the model
+  std::unordered_set<std::string> batched_outputs;
+  std::shared_ptr<Predictor> pred;
+  std::thread worker;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::unique_ptr<Request>> requests;
+  bool stop{false};
+  DynamicBatcherStats stats;
+
+  static bool Batchable(const Request &a, const Request &b) {
+    if (a.inputs.size() != b.inputs.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.inputs.size(); ++i) {
+      const auto &x = a.inputs[i];
+      const auto &y = b.inputs[i];
+      if (x.dtype() != y.dtype() || x.place() != y.place() ||
+          x.dims().size() != y.dims().size()) {
+        return false;
+      }
+      for (int d = 1; d < x.dims().size(); ++d) {
+        if (x.dims()[d] != y.dims()[d]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  int64_t PaddedBatchSize(int64_t batch_size) const {
+    for (int size : batch_sizes) {
+      if (size >= batch_size) {
+        return size;
+      }
+    }
+    return batch_size;
+  }
+
+  // number of samples which can be batched with the first request, until
+  // max_batch_size
+  int64_t NumBatchable() const {
+    int64_t num = 0;
+    for (auto &request : requests) {
+      if (num >= config.max_batch_size) {
+        break;
+      }
+      if (Batchable(*requests.front(), *request)) {
+        num += request->batch_size;
+      }
+    }
+    return num;
+  }
+
+  void TakeBatch(std::vector<std::unique_ptr<Request>> *batch) {
+    int64_t num = 0;
+    for (auto it = requests.begin(); it != requests.end();) {
+      bool take = batch->empty() ||
+                  (Batchable(*batch->front(), **it) &&
+                   num + (*it)->batch_size <= config.max_batch_size);
+      if (take) {
+        num += (*it)->batch_size;
+        batch->emplace_back(std::move(*it));
+        it = requests.erase(it);
+      } else {
+        ++it;
+      }
+      if (num >= config.max_batch_size) {
+        break;
+      }
+    }
+  }
+
+  void WorkerLoop() {
+    while (true) {
+      std::vector<std::unique_ptr<Request>> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return stop || !requests.empty(); });
+        // the submitted requests are run before stopping
+        if (requests.empty()) {
+          return;
+        }
+        auto deadline = requests.front()->submit_time +
+                        std::chrono::microseconds(config.max_wait_us);
+        cv.wait_until(lock, deadline, [this] {
+          return stop || NumBatchable() >= config.max_batch_size;
+        });
+        TakeBatch(&batch);
+      }
+      RunBatch(&batch);
+    }
+  }
+
+  void RunBatch(std::vector<std::unique_ptr<Request>> *batch) {
+    int64_t num_samples = 0;
+    for (auto &request : *batch) {
+      num_samples += request->batch_size;
+    }
+    int64_t padded_size = PaddedBatchSize(num_samples);
+    try {
+      std::vector<paddle::Tensor> batched_inputs;
+      auto &first_inputs = batch->front()->inputs;
+      for (size_t i = 0; i < first_inputs.size(); ++i) {
+        auto *first = GetDenseTensor(first_inputs[i]);
+        auto batched = std::make_shared<phi::DenseTensor>();
+        auto dims = first->dims();
+        dims[0] = padded_size;
+        batched->Resize(dims);
+        batched->mutable_data(first->place(), first->dtype());
+        int64_t offset = 0;
+        for (auto &request : *batch) {
+          CopyRows(*GetDenseTensor(request->inputs[i]), offset, batched.get());
+          offset += request->batch_size;
+        }
+        // repeat the last sample, which keeps the padding numerically sane
+        for (; offset < padded_size; ++offset) {
+          CopyRows(batched->Slice(num_samples - 1, num_samples),
+                   offset,
+                   batched.get());
+        }
+        batched_inputs.emplace_back(batched, first_inputs[i].name());
+      }
+
+      std::vector<paddle::Tensor> outputs;
+      PADDLE_ENFORCE_EQ(
+          pred->Run(batched_inputs, &outputs),
+          true,
+          common::errors::Fatal("DynamicBatcher failed to run a batch of %d "
+                                "requests.",
+                                batch->size()));
+
+      std::vector<std::vector<paddle::Tensor>> results(batch->size());
+      for (auto &output : outputs) {
+        auto *batched = GetDenseTensor(output);
+        // the outputs not in batch, e.g. scalars, are given to every request
+        bool in_batch = batched_outputs.count(output.name()) > 0;
+        if (in_batch) {
+          PADDLE_ENFORCE_EQ(
+              batched->dims().size() > 0 && batched->dims()[0] == padded_size,
+              true,
+              common::errors::PreconditionNotMet(
+                  "The output %s is declared in batch, but its dims [%s] do "
+                  "not start with the batch size %d.",
+                  output.name(),
+                  batched->dims(),
+                  padded_size));
+        }
+        int64_t offset = 0;
+        for (size_t r = 0; r < batch->size(); ++r) {
+          int64_t size = (*batch)[r]->batch_size;
+          auto part = std::make_shared<phi::DenseTensor>();
+          if (in_batch) {
+            framework::TensorCopySync(batched->Slice(offset, offset + size),
+                                      batched->place(),
+                                      part.get());
+          } else {
+            framework::TensorCopySync(*batched, batched->place(), part.get());
+          }
+          results[r].emplace_back(part, output.name());
+          offset += size;
+        }
+      }
+      for (size_t r = 0; r < batch->size(); ++r) {
+        (*batch)[r]->promise.set_value(std::move(results[r]));
+      }
+    } catch (...) {
+      for (auto &request : *batch) {
+        request->promise.set_exception(std::current_exception());
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.num_failed_batches;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.num_requests += batch->size();
+    ++stats.num_batches;
+    stats.num_samples += num_samples;
+    stats.num_padded_samples += padded_size - num_samples;
+  }
+};
+
+DynamicBatcher::DynamicBatcher(const Config &config,
+                               const DynamicBatcherConfig &batcher_config)
+    : impl_(new Impl) {
+  PADDLE_ENFORCE_GE(batcher_config.max_batch_size,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The max batch size of DynamicBatcher should be "
+                        "greater than 0, but it's (%d)",
+                        batcher_config.max_batch_size));
+  impl_->config = batcher_config;
+  impl_->pred = std::make_shared<Predictor>(config);
+
+  int max_batch_size = batcher_config.max_batch_size;
+  std::vector<int> batch_sizes = batcher_config.batch_sizes;
+  if (batch_sizes.empty()) {
+    for (int size = 1; size < max_batch_size; size *= 2) {
+      batch_sizes.push_back(size);
+    }
+  }
+  int min_batch_size = 1;
+  if (!batcher_config.shape_range_info_path.empty()) {
+    std::map<std::string, std::vector<int32_t>> min_shape, max_shape,
+        opt_shape, min_value, max_value, opt_value;
+    inference::DeserializeShapeRangeInfo(batcher_config.shape_range_info_path,
+                                         &min_shape,
+                                         &max_shape,
+                                         &opt_shape,
+                                         &min_value,
+                                         &max_value,
+                                         &opt_value);
+    for (auto &name : impl_->pred->GetInputNames()) {
+      if (min_shape.count(name) == 0 || min_shape[name].empty()) {
+        continue;
+      }
+      min_batch_size = std::max(min_batch_size, min_shape[name][0]);
+      max_batch_size = std::min(max_batch_size, max_shape[name][0]);
+      batch_sizes.push_back(opt_shape[name][0]);
+    }
+    PADDLE_ENFORCE_LE(
+        min_batch_size,
+        max_batch_size,
+        common::errors::InvalidArgument(
+            "The batch sizes in %s are in [%d, %d], which does not intersect "
+            "[1, %d] of the max batch size.",
+            batcher_config.shape_range_info_path,
+            min_batch_size,
+            max_batch_size,
+            batcher_config.max_batch_size));
+    impl_->config.max_batch_size = max_batch_size;
+  }
+  batch_sizes.push_back(max_batch_size);
+  for (int size : batch_sizes) {
+    if (size >= min_batch_size && size <= max_batch_size) {
+      impl_->batch_sizes.push_back(size);
+    }
+  }
+  impl_->batch_sizes.push_back(min_batch_size);
+  std::sort(impl_->batch_sizes.begin(), impl_->batch_sizes.end());
+  impl_->batch_sizes.erase(
+      std::unique(impl_->batch_sizes.begin(), impl_->batch_sizes.end()),
+      impl_->batch_sizes.end());
+  for (auto &item : impl_->pred->GetOutputTensorShape()) {
+    if (!item.second.empty() && item.second[0] < 0) {
+      impl_->batched_outputs.insert(item.first);
+    }
+  }
+  VLOG(3) << "DynamicBatcher batch sizes: "
+          << paddle::string::join_strings(impl_->batch_sizes, ',');
+
+  impl_->worker = std::thread([this] { impl_->WorkerLoop(); });
+}
+
+DynamicBatcher::~DynamicBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->stop = true;
+  }
+  impl_->cv.notify_all();
+  impl_->worker.join();
+}
+
+std::future<std::vector<paddle::Tensor>> DynamicBatcher::Submit(
+    std::vector<paddle::Tensor> inputs) {
+  PADDLE_ENFORCE_EQ(inputs.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The inputs of a request should not be empty."));
+  auto request = std::make_unique<Impl::Request>();
+  for (auto &input : inputs) {
+    PADDLE_ENFORCE_GE(input.dims().size(),
+                      1,
+                      common::errors::InvalidArgument(
+                          "The input %s of a request should have at least "
+                          "one dimension to be batched.",
+                          input.name()));
+    if (request->batch_size == 0) {
+      request->batch_size = input.dims()[0];
+    }
+    PADDLE_ENFORCE_EQ(input.dims()[0],
+                      request->batch_size,
+                      common::errors::InvalidArgument(
+                          "The inputs of a request should have the same first "
+                          "dimension, but input %s has %d while others have "
+                          "%d.",
+                          input.name(),
+                          input.dims()[0],
+                          request->batch_size));
+  }
+  PADDLE_ENFORCE_GT(request->batch_size,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The batch size of a request should be positive."));
+  // the batches, and so the engine profiles, never exceed max_batch_size
+  PADDLE_ENFORCE_LE(request->batch_size,
+                    impl_->config.max_batch_size,
+                    common::errors::InvalidArgument(
+                        "The batch size of a request should not be greater "
+                        "than the max batch size (%d) of DynamicBatcher, but "
+                        "it's (%d).",
+                        impl_->config.max_batch_size,
+                        request->batch_size));
+  request->inputs = std::move(inputs);
+  request->submit_time = Impl::Clock::now();
+  auto future = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    PADDLE_ENFORCE_EQ(impl_->stop,
+                      false,
+                      common::errors::PreconditionNotMet(
+                          "Cannot submit to a stopped DynamicBatcher."));
+    impl_->requests.emplace_back(std::move(request));
+  }
+  impl_->cv.notify_one();
+  return future;
+}
+
+const std::vector<int> &DynamicBatcher::batch_sizes() const {
+  return impl_->batch_sizes;
+}
+
+DynamicBatcherStats DynamicBatcher::GetStats() const {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->stats;
+}
 }  // namespace services
 
 namespace experimental {
@@ -3919,6 +5594,24 @@ void InternalUtils::DisableTensorRtHalfOps(
 #endif
 }
 
+void InternalUtils::WaitTensorRtEngineBuilds() {
+#ifdef PADDLE_WITH_TENSORRT
+  paddle::inference::Singleton<
+      paddle::inference::tensorrt::TRTEngineManager>::Global()
+      .WaitAsyncBuilds();
+#endif
+}
+
+int64_t InternalUtils::TensorRtEngineRunCount() {
+#ifdef PADDLE_WITH_TENSORRT
+  return paddle::inference::Singleton<
+             paddle::inference::tensorrt::TRTEngineManager>::Global()
+      .NumEngineRuns();
+#else
+  return 0;
+#endif
+}
+
 void InternalUtils::SyncStream(paddle_infer::Predictor *p) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(p->predictor_.get());
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
@@ -28,6 +30,11 @@
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/utils/activation_range.h"
+#include "paddle/fluid/inference/utils/colocation.h"
+#include "paddle/fluid/inference/utils/idle_compactor.h"
+#include "paddle/fluid/inference/utils/latency_histogram.h"
+#include "paddle/phi/api/profiler/event.h"
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_types.h"
@@ -277,6 +284,48 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   uint64_t TryShrinkMemory() override;
 
+  ///
+  /// \brief Compact the memory pool: the intermediate tensors kept between
+  /// the runs are moved through the host memory, so their free blocks
+  /// coalesce and the idle chunks are released, like TryShrinkMemory does.
+  /// It is also done in the background once the predictor is idle, see
+  /// Config::EnableMemoryCompaction.
+  ///
+  /// \return Number of bytes released.
+  ///
+  uint64_t CompactMemory() override;
+
+  ///
+  /// \brief Bind a buffer to an output, which every later ZeroCopyRun writes
+  /// the output to.
+  ///
+  /// \param name the output name.
+  /// \param data the buffer, nullptr unbinds the output.
+  /// \param size the bytes of the buffer, the upper bound of the output.
+  /// \param place the place of the buffer.
+  /// \return Whether the output is bound.
+  ///
+  bool BindOutput(const std::string &name,
+                  void *data,
+                  size_t size,
+                  PaddlePlace place) override;
+
+  ///
+  /// \brief Load the parameters of params_file, and refit the built TensorRT
+  /// engines of the predictor by them without a rebuild. The parameters
+  /// should be combined in the format of the optimized program of the
+  /// predictor, which is saved to the optimization cache dir, and have the
+  /// same shapes and data types as the ones the engines are built with. The
+  /// engines should be built with AnalysisConfig::EnableTensorRtRefit, and it
+  /// should not run together with the predictor or its clones sharing the
+  /// engines.
+  ///
+  /// \param params_file The combined parameters file to load.
+  ///
+  /// \return Whether the function executed successfully
+  ///
+  bool RefitTensorRTEngines(const std::string &params_file);
+
   ///
   /// \brief Get the argument used by predictor
   ///
@@ -329,6 +378,17 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \brief Same as RegisterOutputHook
   void RegisterInputHook(const InputTensorHookFunc &hookfunc) override;
 
+  ///
+  /// \brief Get the latency breakdown of the runs recorded since the
+  /// statistics are enabled or reset.
+  ///
+  /// \return the latencies of the runs and of the sampled ops.
+  ///
+  PaddleRunStats GetRunStats() override;
+
+  /// \brief Clear the latencies recorded so far.
+  void ResetRunStats() override;
+
   ///
   /// \brief Initialize onednn quantizer and execute onednn quantization pass
   ///
@@ -371,6 +431,12 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool PrepareExecutor();
+  ///
+  /// \brief Pack the constant weights of the CPU GEMMs of the kernel
+  /// program once, for the fc, matmul and conv2d kernels running the GEMMs
+  /// on them in each call.
+  ///
+  void PrepackGemmWeights();
 
   ///
   /// \brief Load model program.
@@ -383,7 +449,14 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   /// \return Whether the function executed successfully
   ///
-  bool LoadParameters();
+  bool LoadParameters() { return LoadParameters(config_.params_file()); }
+  ///
+  /// \brief Load model parameters from params_file, or from the separate
+  /// files in the model dir if it is empty.
+  ///
+  /// \return Whether the function executed successfully
+  ///
+  bool LoadParameters(const std::string &params_file);
 
   ///
   /// \brief Save or Load pir model parameters.
@@ -392,6 +465,20 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   bool SaveOrLoadPirParameters(bool for_save);
 
+  ///
+  /// \brief Load the lowered pir program and the parameters it uses from the
+  /// lowered program cache, instead of optimizing the model.
+  ///
+  /// \return Whether the cache is hit
+  ///
+  bool LoadLoweredProgramCache();
+
+  ///
+  /// \brief Save the lowered pir program and the parameters it uses into the
+  /// lowered program cache. Failures only cause a warning.
+  ///
+  void SaveLoweredProgramCache();
+
   ///
   /// \brief Prepare input data, only used in Run()
   ///
@@ -475,6 +562,13 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   void MkldnnPostReset();
 
+  ///
+  /// \brief Run the predictor on the shapes of the shape range info of
+  /// WarmupOneDNNPrimitiveCache, to create the primitives in the process-wide
+  /// OneDNN primitive cache. Only the root predictor runs it.
+  ///
+  void WarmupOneDNNPrimitiveCache();
+
 #ifdef PADDLE_WITH_TENSORRT
   ///
   /// \brief save calibration table
@@ -507,10 +601,38 @@ class AnalysisPredictor : public PaddlePredictor {
  private:
   void StatisticShapeRangeInfo();
   void HookCollectShapeRangeInfo();
+  // Registers the shape hook at the first run, and in the online mode saves
+  // the shape info every save_interval runs and samples the run.
+  void BeginShapeRangeCollection();
+  void HookCollectActivationRange();
+  // Times the ops of the sampled runs by the hooks of the executor.
+  void HookRunStatistics();
+  // Samples the ops of every op_sample_interval runs.
+  void BeginRunStatistics();
+  // Records the latency of the phase of a run since start, and returns now.
+  std::chrono::steady_clock::time_point RecordRunLatency(
+      const std::string &phase, std::chrono::steady_clock::time_point start);
+  // Records an event on the stream of the predictor before the ops of a run
+  // are launched if start is true, and after them otherwise. The device time
+  // between them is the sync phase, read when the stats are polled, so that
+  // the run does not wait for the stream.
+  void RecordRunEvent(bool start);
+  // Records the sync latency of the runs whose events are done, or of all the
+  // runs waiting for their events if wait is true. Requires run_stats_mutex_.
+  void CollectRunEvents(bool wait);
+  // Lets the outputs be computed into their bound buffers of the device.
+  void ApplyOutputBindings();
+  // Moves the intermediate tensors to compact the memory pool.
+  uint64_t CompactMemoryImpl();
+  // Copies the outputs not computed into their bound buffers to them.
+  void SyncOutputBindings();
   void InitPlace();
   void InitDeviceContexts();
   void InitResourceManager(void *stream);
   std::string GetOptimizedModelPath();
+  // The model, config, device and version the lowered pir program depends
+  // on, empty if the lowered program cache does not apply.
+  std::string LoweredProgramCacheKey();
   void ClearExtraParams();
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -583,6 +705,7 @@ class AnalysisPredictor : public PaddlePredictor {
   std::vector<pir::Operation *> pir_fetches_;
   std::map<size_t, std::string> idx2fetches_;
   std::map<std::string, std::vector<int64_t>> fetch_name2shapes_;
+  std::string lowered_program_cache_key_;
 
   phi::DataType model_precision_{phi::DataType::FLOAT32};
 
@@ -596,6 +719,8 @@ class AnalysisPredictor : public PaddlePredictor {
 
   int predictor_id_;
   int root_predictor_id_{-1};
+  // the scope of the OneDNN primitive cache, shared by the clones
+  std::string onednn_primitive_cache_scope_;
 
  private:
   std::once_flag register_input_hook_flag_;
@@ -605,8 +730,46 @@ class AnalysisPredictor : public PaddlePredictor {
   // Some status here that help to determine the status inside the predictor.
   bool status_is_cloned_{false};
 
-  std::map<std::string, std::vector<std::vector<int32_t>>> shape_info_;
-  std::map<std::string, std::vector<std::vector<int32_t>>> shape_tensor_value_;
+  // The number of times each shape, or value of a shape tensor, is seen.
+  using ShapeHistogram = std::map<std::vector<int32_t>, int64_t>;
+  std::map<std::string, ShapeHistogram> shape_info_;
+  std::map<std::string, ShapeHistogram> shape_tensor_value_;
+  std::once_flag shape_range_hook_flag_;
+  uint64_t shape_range_num_runs_{0};
+  bool sample_shape_range_{true};
+  std::shared_ptr<inference::ActivationRangeCollector>
+      activation_range_collector_;
+  // The buffers bound to the outputs by BindOutput.
+  std::map<std::string, std::shared_ptr<phi::Allocation>> output_bindings_;
+  // The latencies of the phases of the runs and of the sampled ops. The runs
+  // whose ops are sampled are left out of the phases, since the ops
+  // synchronize the stream.
+  std::mutex run_stats_mutex_;
+  std::map<std::string, inference::LatencyHistogram> run_latency_;
+  std::map<std::string, inference::LatencyHistogram> op_latency_;
+  uint64_t run_stats_num_runs_{0};
+  bool sample_op_latency_{false};
+  std::vector<std::chrono::steady_clock::time_point> op_starts_;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  struct RunEvents {
+    std::unique_ptr<phi::CudaEvent> start;
+    std::unique_ptr<phi::CudaEvent> end;
+    bool recorded{false};
+  };
+  // The events of the runs whose sync latency is not recorded yet, from the
+  // earliest one.
+  std::deque<RunEvents> pending_run_events_;
+  std::vector<std::unique_ptr<phi::CudaEvent>> free_run_events_;
+#endif
+  // The scheduler of the runs and the allocator within the memory quota of
+  // the model colocated on its GPU.
+  std::shared_ptr<inference::WeightedFairScheduler> colocation_scheduler_;
+  memory::allocation::Allocator *colocation_allocator_{nullptr};
+  // Whether the predictor runs on a stream of the pool of its GPU, with a
+  // GPUContextResource of its own.
+  bool pooled_gpu_resource_{false};
+  // Compacts the memory once the predictor is idle.
+  std::unique_ptr<inference::IdleCompactor> idle_compactor_;
 
   bool private_context_{false};
   void *predictor_stream_{nullptr};
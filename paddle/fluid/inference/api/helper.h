@@ -493,6 +493,8 @@ static std::string Precision2String(AnalysisConfig::Precision precision) {
     return "int8";
   else if (precision == AnalysisConfig::Precision::kBf16)
     return "bf16";
+  else if (precision == AnalysisConfig::Precision::kFp8)
+    return "fp8";
   else
     return "none";
 }
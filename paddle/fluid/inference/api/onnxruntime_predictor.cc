@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -60,6 +61,18 @@ paddle_infer::DataType ConvertONNXType(ONNXTensorElementDataType type) {
   }
 }
 
+std::shared_ptr<Ort::Env> GetSharedOrtEnv() {
+  static std::mutex mutex;
+  static std::weak_ptr<Ort::Env> shared_env;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto env = shared_env.lock();
+  if (!env) {
+    env = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "paddle-ort");
+    shared_env = env;
+  }
+  return env;
+}
+
 bool CheckConvertToONNX(const AnalysisConfig &config) {
   if (!config.model_dir().empty()) {
     LOG(ERROR) << "Paddle2ONNX not support model_dir config";
@@ -97,6 +110,7 @@ bool ONNXRuntimePredictor::InitBinding() {
   scope_.reset(new paddle::framework::Scope());
 
   binding_ = std::make_shared<Ort::IoBinding>(*session_);
+  run_options_.SetRunTag(std::to_string(predictor_id_).c_str());
   Ort::MemoryInfo memory_info(
       device_name, OrtDeviceAllocator, place_.GetDeviceId(), OrtMemTypeDefault);
   Ort::Allocator allocator(*session_, memory_info);
@@ -112,6 +126,7 @@ bool ONNXRuntimePredictor::InitBinding() {
     ONNXTensorElementDataType data_type =
         type_info.GetTensorTypeAndShapeInfo().GetElementType();
     input_desc_.emplace_back(ONNXDesc{input_name, shape, data_type});
+    bound_inputs_.emplace_back(nullptr, std::vector<int64_t>());
 
     auto *ptr = scope_->Var(input_name);
     framework::InitializeVariable(ptr, proto_type);
@@ -336,11 +351,16 @@ bool ONNXRuntimePredictor::Run(const std::vector<PaddleTensor> &inputs,
 bool ONNXRuntimePredictor::ZeroCopyRun(bool switch_stream) {
   try {
     const char *device_name = phi::is_cpu_place(place_) ? "Cpu" : "Cuda";
-    std::vector<Ort::Value> inputs;
-    inputs.reserve(input_desc_.size());
-    for (auto desc : input_desc_) {
-      inputs.push_back(GetOrtValue(desc, device_name));
-      binding_->BindInput(desc.name.c_str(), inputs.back());
+    // the bound values refer to the memory of the input tensors
+    for (size_t i = 0; i < input_desc_.size(); ++i) {
+      const auto &desc = input_desc_[i];
+      auto *tensor = scope_->FindVar(desc.name)->GetMutable<phi::DenseTensor>();
+      std::pair<const void *, std::vector<int64_t>> input(
+          tensor->data(), common::vectorize<int64_t>(tensor->dims()));
+      if (input != bound_inputs_[i]) {
+        binding_->BindInput(desc.name.c_str(), GetOrtValue(desc, device_name));
+        bound_inputs_[i] = std::move(input);
+      }
     }
     for (auto output : output_desc_) {
       Ort::MemoryInfo out_memory_info(device_name,
@@ -349,7 +369,7 @@ bool ONNXRuntimePredictor::ZeroCopyRun(bool switch_stream) {
                                       OrtMemTypeDefault);
       binding_->BindOutput(output.name.c_str(), out_memory_info);
     }
-    session_->Run({}, *(binding_.get()));
+    session_->Run(run_options_, *(binding_.get()));
   } catch (const std::exception &e) {
     LOG(ERROR) << e.what();
     return false;
@@ -17,6 +17,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "onnxruntime_c_api.h"    // NOLINT
@@ -49,6 +50,15 @@ namespace paddle {
 
 bool CheckConvertToONNX(const AnalysisConfig &config);
 
+///
+/// \brief Get the Ort::Env shared by all the ONNXRuntime predictors of the
+/// process, which is created by the first of them and destroyed with the
+/// last one.
+///
+/// \return the shared Ort::Env
+///
+std::shared_ptr<Ort::Env> GetSharedOrtEnv();
+
 struct ONNXDesc {
   std::string name;
   std::vector<int64_t> shape;
@@ -92,8 +102,7 @@ class ONNXRuntimePredictor : public PaddlePredictor {
   /// \param[in] AnalysisConfig config
   ///
   explicit ONNXRuntimePredictor(const AnalysisConfig &config)
-      : env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING,
-                                        "paddle-ort")),
+      : env_(GetSharedOrtEnv()),
         session_(nullptr),
         binding_(nullptr),
         config_(config) {
@@ -229,6 +238,12 @@ class ONNXRuntimePredictor : public PaddlePredictor {
   std::shared_ptr<Ort::Env> env_;
   std::shared_ptr<Ort::Session> session_{nullptr};
   std::shared_ptr<Ort::IoBinding> binding_;
+  // The options of the runs of this predictor, while the session is shared
+  // with its clones run by other threads.
+  Ort::RunOptions run_options_;
+  // The data and the shape of each input when it was bound, which is bound
+  // again only after its tensor has been reallocated or reshaped.
+  std::vector<std::pair<const void *, std::vector<int64_t>>> bound_inputs_;
 
   AnalysisConfig config_;
   std::mutex clone_mutex_;
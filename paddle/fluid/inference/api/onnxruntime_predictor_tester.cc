@@ -75,6 +75,14 @@ TEST(ONNXRuntimePredictor, onnxruntime_on) {
   ASSERT_TRUE(predictor->ZeroCopyRun());
   output_tensor->CopyToCpu(out_data.data());
 
+  // the input is still bound to the same memory for the second run
+  std::vector<float> second_out_data(1000);
+  input_tensor->CopyFromCpu(input_data.data());
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  output_tensor->CopyToCpu(second_out_data.data());
+  ASSERT_EQ(out_data, second_out_data);
+  ASSERT_EQ(predictor->env_, GetSharedOrtEnv());
+
   predictor->TryShrinkMemory();
 }
 
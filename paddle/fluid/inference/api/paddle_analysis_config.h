@@ -214,6 +214,7 @@ struct PD_INFER_DECL AnalysisConfig {
     kInt8,         ///< int8
     kHalf,         ///< fp16
     kBf16,         ///< bf16
+    kFp8,          ///< fp8 (e4m3)
   };
 
   ///
@@ -256,6 +257,24 @@ struct PD_INFER_DECL AnalysisConfig {
     save_optimized_model_ = save_optimized_model;
   }
   ///
+  /// \brief Load the combined params file by mapping it into memory. The
+  /// parameters on CPU share the pages of the file instead of being copied,
+  /// so that the peak host memory of loading is not doubled and the
+  /// predictors of several processes share one copy of the weights in the
+  /// page cache. The parameters on other devices are copied from the mapping.
+  /// It only applies when the params file is set and the model is not loaded
+  /// from memory.
+  ///
+  /// \param x whether to load params with mmap.
+  ///
+  void EnableMmapParams(bool x = true) { use_mmap_params_ = x; }
+  ///
+  /// \brief A boolean state telling whether params are loaded with mmap.
+  ///
+  /// \return bool Whether params are loaded with mmap.
+  ///
+  bool mmap_params_enabled() const { return use_mmap_params_; }
+  ///
   /// \brief Set the path of optimization cache directory.
   ///
   /// \param opt_cache_dir the path of optimization cache directory.
@@ -754,8 +773,19 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \brief Collect shape info of all tensors in compute graph.
   ///
   /// \param shape_range_info_path the path to save shape info.
+  /// \param shape_bucket_num the number of TensorRT optimization profiles
+  /// built from the shape info, each of which is tuned for the shapes between
+  /// two quantiles of the collected shapes.
+  ///
+  void CollectShapeRangeInfo(const std::string& shape_range_info_path,
+                             int shape_bucket_num = 1);
+
+  ///
+  /// \brief the number of shape buckets in CollectShapeInfo mode.
+  ///
+  /// \return the number of shape buckets.
   ///
-  void CollectShapeRangeInfo(const std::string& shape_range_info_path);
+  int shape_bucket_num() const { return shape_bucket_num_; }
 
   ///
   /// \brief the shape info path in CollectShapeInfo mode.
@@ -771,6 +801,209 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool shape_range_info_collected() const;
 
+  ///
+  /// \brief Collect the shape info of the tensors in the compute graph while
+  /// the predictor serves, with the optimizations on, unlike
+  /// CollectShapeRangeInfo. The shapes are recorded as a histogram in the
+  /// sampled runs only, because they synchronize the stream for each op, and
+  /// the shape info is saved periodically and as the predictor exits, so the
+  /// next predictor tuned by EnableTunedTensorRtDynamicShape on the path
+  /// builds its profiles for the live shapes.
+  ///
+  /// \param shape_range_info_path the path to save shape info.
+  /// \param sample_interval record the shapes every sample_interval runs.
+  /// \param save_interval save the shape info every save_interval runs, 0
+  /// saves it only as the predictor exits.
+  ///
+  void CollectShapeRangeInfoOnline(const std::string& shape_range_info_path,
+                                   int sample_interval = 100,
+                                   int save_interval = 1000);
+
+  ///
+  /// \brief A boolean state telling whether to collect shape info while the
+  /// predictor serves.
+  ///
+  /// \return bool Whether to collect shape info online.
+  ///
+  bool shape_range_info_collected_online() const {
+    return collect_shape_range_info_online_;
+  }
+
+  ///
+  /// \brief the interval of the runs whose shapes are recorded online.
+  ///
+  /// \return the interval.
+  ///
+  int shape_range_sample_interval() const {
+    return shape_range_sample_interval_;
+  }
+
+  ///
+  /// \brief the interval of the runs the online shape info is saved at.
+  ///
+  /// \return the interval, 0 if it is saved only as the predictor exits.
+  ///
+  int shape_range_save_interval() const { return shape_range_save_interval_; }
+
+  ///
+  /// \brief Collect the histograms of all the float activations in the
+  /// compute graph by the native forwards for the int8 calibration. The
+  /// predictors which collect to the same path in the process, such as the
+  /// clones run in several threads or the predictors on several devices,
+  /// share the histograms, which are saved as each of them exits.
+  ///
+  /// \param activation_range_path the path to save the activation ranges.
+  /// \param num_bins the number of the histogram bins.
+  ///
+  void CollectActivationRange(const std::string& activation_range_path,
+                              int num_bins = 2048);
+
+  ///
+  /// \brief the activation range path in CollectActivationRange mode.
+  ///
+  /// \return the activation range path.
+  ///
+  const std::string& activation_range_path() const {
+    return activation_range_path_;
+  }
+
+  ///
+  /// \brief the number of the histogram bins in CollectActivationRange mode.
+  ///
+  /// \return the number of the histogram bins.
+  ///
+  int activation_range_num_bins() const { return activation_range_num_bins_; }
+
+  ///
+  /// \brief A boolean state telling whether to collect activation ranges.
+  ///
+  /// \return bool Whether to collect activation ranges.
+  ///
+  bool activation_range_collected() const {
+    return collect_activation_range_;
+  }
+
+  ///
+  /// \brief Record the latency breakdown of every run of the predictor,
+  /// which is polled by Predictor::GetRunStats. The breakdown costs a few
+  /// clock reads per run, and on GPU two events recorded on the stream, whose
+  /// elapsed time is read when the stats are polled. The ops are timed in the
+  /// sampled runs only, because each sampled op synchronizes the stream before
+  /// and after it.
+  ///
+  /// \param op_sample_interval time the ops every op_sample_interval runs,
+  /// 0 never times the ops.
+  ///
+  void EnableRunStatistics(int op_sample_interval = 0);
+
+  ///
+  /// \brief A boolean state telling whether the run statistics are enabled.
+  ///
+  /// \return bool Whether the run statistics are enabled.
+  ///
+  bool run_statistics_enabled() const { return enable_run_statistics_; }
+
+  ///
+  /// \brief the interval of the runs whose ops are timed.
+  ///
+  /// \return the interval, 0 if the ops are never timed.
+  ///
+  int run_statistics_op_sample_interval() const {
+    return run_statistics_op_sample_interval_;
+  }
+
+  ///
+  /// \brief Colocate the predictor with the other models on its GPU, which
+  /// are configured by services::SetColocationOptions. The predictor runs
+  /// on a private context, whose stream is taken from the stream pool of the
+  /// GPU if there is one, and whose intermediate tensors are allocated
+  /// within the memory quota of the model and the memory cap of the GPU.
+  /// Its runs are scheduled by the weight when the models compete for the
+  /// concurrent runs of the GPU.
+  ///
+  /// \param weight the share of the GPU of the model against the others.
+  /// \param memory_quota the bytes the model may allocate, 0 is unlimited.
+  ///
+  void EnableColocation(int weight = 1, size_t memory_quota = 0);
+
+  ///
+  /// \brief A boolean state telling whether the predictor is colocated.
+  ///
+  /// \return bool Whether the predictor is colocated.
+  ///
+  bool colocation_enabled() const { return enable_colocation_; }
+
+  ///
+  /// \brief the weight of the model in colocation.
+  ///
+  int colocation_weight() const { return colocation_weight_; }
+
+  ///
+  /// \brief the memory quota in bytes of the model in colocation.
+  ///
+  size_t colocation_memory_quota() const { return colocation_memory_quota_; }
+
+  ///
+  /// \brief Compact the GPU memory of the predictor once it is idle, see
+  /// Predictor::CompactMemory. A background thread compacts the memory when
+  /// no run has started for idle_ms since the last one, and a run waits for
+  /// the compaction in progress.
+  ///
+  /// \param idle_ms the idle time in milliseconds before compacting.
+  ///
+  void EnableMemoryCompaction(int idle_ms = 1000);
+
+  ///
+  /// \brief A boolean state telling whether the idle memory is compacted.
+  ///
+  /// \return bool Whether the idle memory is compacted.
+  ///
+  bool memory_compaction_enabled() const { return enable_memory_compaction_; }
+
+  ///
+  /// \brief the idle time in milliseconds before compacting the memory.
+  ///
+  int memory_compaction_idle_ms() const { return memory_compaction_idle_ms_; }
+
+  ///
+  /// \brief Allocate the GPU memory by cudaMallocAsync from the pool of the
+  /// device, which is shared by all the predictors on the device. It takes
+  /// effect when the first GPU predictor of the process is created.
+  ///
+  /// \param release_threshold_mb the freed memory in MB the pool keeps
+  /// instead of returning it to the driver, a negative value leaves the
+  /// threshold unchanged.
+  /// \param peer_access whether to map the pool to the peer devices.
+  /// \param idle_trim_ms trim the pool once the predictor is idle for the
+  /// time in milliseconds, see EnableMemoryCompaction. 0 means not trimmed.
+  ///
+  void EnableCudaMallocAsyncAllocator(int64_t release_threshold_mb = -1,
+                                      bool peer_access = false,
+                                      int idle_trim_ms = 0);
+
+  ///
+  /// \brief A boolean state telling whether cudaMallocAsync is used.
+  ///
+  /// \return bool Whether cudaMallocAsync is used.
+  ///
+  bool cuda_malloc_async_allocator_enabled() const {
+    return enable_cuda_malloc_async_allocator_;
+  }
+
+  ///
+  /// \brief the release threshold in MB of the cudaMallocAsync pool.
+  ///
+  int64_t cuda_malloc_async_release_threshold_mb() const {
+    return cuda_malloc_async_release_threshold_mb_;
+  }
+
+  ///
+  /// \brief whether the cudaMallocAsync pool is mapped to the peer devices.
+  ///
+  bool cuda_malloc_async_peer_access() const {
+    return cuda_malloc_async_peer_access_;
+  }
+
   ///
   /// \brief Prevent ops running in Paddle-TRT
   /// NOTE: just experimental, not an official stable API, easy to be broken.
@@ -838,6 +1071,40 @@ struct PD_INFER_DECL AnalysisConfig {
   void EnableTensorRtInspector(bool inspector_serialize = false);
   bool tensorrt_inspector_enabled() { return trt_use_inspector_; }
 
+  ///
+  /// \brief Build the TensorRT engines refittable, so that their weights can
+  /// be updated by AnalysisPredictor::RefitTensorRTEngines without a rebuild.
+  ///
+  /// \param refit Whether to build the refittable TensorRT engines.
+  ///
+  void EnableTensorRtRefit(bool refit = true);
+  ///
+  /// \brief A boolean state telling whether the TensorRT engines are built
+  /// refittable.
+  ///
+  /// \return bool Whether the TensorRT engines are built refittable.
+  ///
+  bool tensorrt_refit_enabled() const { return trt_refit_; }
+
+  ///
+  /// \brief Build the TensorRT int8 engines by the activation ranges
+  /// collected in CollectActivationRange mode, instead of the TensorRT
+  /// calibration.
+  ///
+  /// \param activation_range_path the path to the activation ranges.
+  /// \param percentile the percentile of the activation values kept in the
+  /// range, 100 takes the abs max of them.
+  ///
+  void EnableTensorRtActivationRange(const std::string& activation_range_path,
+                                     float percentile = 99.99f);
+  ///
+  /// \brief The path to the activation ranges the TensorRT int8 engines are
+  /// built by, empty when they are calibrated by TensorRT.
+  ///
+  const std::string& tensorrt_activation_range_path() const {
+    return trt_activation_range_path_;
+  }
+
   ///
   /// \brief A boolean state telling whether to use TensorRT explicit
   /// quantization.
@@ -889,6 +1156,29 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   void UseOptimizedModel(bool x = true) { use_optimized_model_ = x; }
 
+  ///
+  /// \brief Control whether to cache the pir program after kernel selection.
+  /// The lowered program and the parameters it uses, including the ones
+  /// created by constant folding, are saved into the optimization cache
+  /// directory, keyed by the model, the config and the device. Later
+  /// predictors with the same key load them instead of running the pir
+  /// passes. It only applies in PIR mode, and not to the models loaded from
+  /// memory or compiled by CINN.
+  ///
+  /// \param x whether to cache the lowered pir program.
+  ///
+  void EnableLoweredProgramCache(bool x = true) {
+    use_lowered_program_cache_ = x;
+  }
+  ///
+  /// \brief A boolean state telling whether the lowered pir program is cached.
+  ///
+  /// \return bool Whether the lowered pir program is cached.
+  ///
+  bool lowered_program_cache_enabled() const {
+    return use_lowered_program_cache_;
+  }
+
   ///
   /// \brief Control whether to debug IR graph analysis phase.
   /// This will generate DOT files for visualizing the computation graph after
@@ -919,6 +1209,26 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \param capacity The cache capacity.
   ///
   void SetMkldnnCacheCapacity(int capacity);
+
+  ///
+  /// \brief Warm up the process-wide OneDNN primitive cache, which is enabled
+  /// by FLAGS_onednn_primitive_cache_capacity, when the predictor is created.
+  /// The predictor runs on the min, opt and max shapes of the inputs recorded
+  /// in the shape range info, e.g. the one of CollectShapeRangeInfo, so the
+  /// primitives of them are not created by the first requests. The clones
+  /// share the cache and do not run them again.
+  ///
+  /// \param shape_range_info_path The shape range info of the inputs.
+  ///
+  void WarmupOneDNNPrimitiveCache(const std::string& shape_range_info_path);
+  ///
+  /// \brief The shape range info to warm up the OneDNN primitive cache.
+  ///
+  /// \return const std::string& The shape range info, empty if not set.
+  ///
+  const std::string& onednn_primitive_cache_warmup_path() const {
+    return onednn_primitive_cache_warmup_path_;
+  }
   ///
   /// \brief A boolean state telling whether to use the OneDNN.
   ///
@@ -943,6 +1253,45 @@ struct PD_INFER_DECL AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  ///
+  /// \brief Control whether to pack the constant weights of the CPU GEMMs
+  /// once at the predictor initialization. The float weights of fc, matmul
+  /// and conv2d are packed into the layout of the BLAS library, which the
+  /// kernels use in each run instead of packing them again. It only applies
+  /// in PIR mode with MKL, to the ops not running on OneDNN.
+  ///
+  /// \param x whether to pack the weights of the CPU GEMMs.
+  ///
+  void EnableGemmWeightPrepack(bool x = true) { use_gemm_weight_prepack_ = x; }
+  ///
+  /// \brief A boolean state telling whether the weights of the CPU GEMMs are
+  /// packed at the predictor initialization.
+  ///
+  /// \return bool Whether the weights of the CPU GEMMs are packed.
+  ///
+  bool gemm_weight_prepack_enabled() const { return use_gemm_weight_prepack_; }
+
+  ///
+  /// \brief Quantize the float weights of the CPU linears to int8 or int4 at
+  /// the predictor initialization. The matmuls with a persistable 2-D weight,
+  /// and the adds of the bias after them, are replaced by weight_only_linear,
+  /// which dequantizes the weight in the GEMM with x. It only applies in PIR
+  /// mode, to the ops not running on OneDNN, and trades the accuracy of the
+  /// weights for the memory bandwidth of the small batches.
+  ///
+  /// \param algo The quantization, weight_only_int8 or weight_only_int4.
+  ///
+  void EnableCpuWeightOnlyQuantize(
+      const std::string& algo = "weight_only_int8");
+  ///
+  /// \brief The quantization of the weights of the CPU linears.
+  ///
+  /// \return const std::string& The quantization, empty if not enabled.
+  ///
+  const std::string& cpu_weight_only_algo() const {
+    return cpu_weight_only_algo_;
+  }
+
   ///
   /// \brief Transform the AnalysisConfig to NativeConfig.
   ///
@@ -1049,6 +1398,28 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool enable_memory_optim() const;
 
+  ///
+  /// \brief Turn on memory optimize, and place the tensors of known max sizes
+  /// in one shared workspace by their lifetimes instead of reusing them by
+  /// name. The max sizes come from the max shapes of the shape range info, or
+  /// the static shapes of the tensors.
+  ///
+  /// \param shape_range_info_path The shape range info file collected by
+  /// CollectShapeRangeInfo, or the one of EnableTunedTensorRtDynamicShape if
+  /// it is empty.
+  ///
+  void EnableMemoryOptimWorkspace(
+      const std::string& shape_range_info_path = "");
+  ///
+  /// \brief A boolean state telling whether the tensors are placed in a
+  /// shared workspace by the memory optimization.
+  ///
+  /// \return bool Whether the memory optim workspace is activated.
+  ///
+  bool memory_optim_workspace_enabled() const {
+    return memory_optim_workspace_;
+  }
+
   ///
   /// \brief Turn on profiling report.
   /// If not turned on, no profiling report will be generated.
@@ -1263,6 +1634,9 @@ struct PD_INFER_DECL AnalysisConfig {
   bool trt_tuned_dynamic_shape_{false};
   bool trt_use_inspector_{false};
   bool trt_inspector_serialize_{false};
+  bool trt_refit_{false};
+  std::string trt_activation_range_path_;
+  float trt_activation_range_percentile_{99.99f};
   bool trt_use_explicit_quantization_{false};
   int trt_optimization_level_{3};
 
@@ -1271,9 +1645,44 @@ struct PD_INFER_DECL AnalysisConfig {
   // min_shape, max_shape and opt_shape and save in shape_range_info_path_;
   bool collect_shape_range_info_{false};
   std::string shape_range_info_path_;
+  int shape_bucket_num_{1};
+
+  // In CollectShapeRangeInfoOnline mode, the shapes are recorded every
+  // shape_range_sample_interval_ runs and saved in shape_range_info_path_
+  // every shape_range_save_interval_ runs.
+  bool collect_shape_range_info_online_{false};
+  int shape_range_sample_interval_{1};
+  int shape_range_save_interval_{0};
+
+  // In CollectActivationRange mode, we will collect the histograms of the
+  // float activations and save them in activation_range_path_.
+  bool collect_activation_range_{false};
+  std::string activation_range_path_;
+  int activation_range_num_bins_{2048};
+
+  // The latency breakdown of the runs, with the ops timed every
+  // run_statistics_op_sample_interval_ runs.
+  bool enable_run_statistics_{false};
+  int run_statistics_op_sample_interval_{0};
+
+  // The model colocated with the others on its GPU.
+  bool enable_colocation_{false};
+  int colocation_weight_{1};
+  size_t colocation_memory_quota_{0};
+
+  // The memory compacted once the predictor is idle for the time.
+  bool enable_memory_compaction_{false};
+  int memory_compaction_idle_ms_{1000};
+
+  // The GPU memory allocated by cudaMallocAsync.
+  bool enable_cuda_malloc_async_allocator_{false};
+  int64_t cuda_malloc_async_release_threshold_mb_{-1};
+  bool cuda_malloc_async_peer_access_{false};
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool memory_optim_workspace_{false};
+  std::string memory_optim_shape_range_info_path_;
   bool trt_engine_memory_sharing_{true};
   int trt_engine_memory_sharing_identifier_{0};
 
@@ -1292,12 +1701,15 @@ struct PD_INFER_DECL AnalysisConfig {
   bool ir_debug_{false};
 
   bool use_optimized_model_{false};
+  bool use_lowered_program_cache_{false};
 
   bool use_new_executor_{false};
 
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  bool use_gemm_weight_prepack_{false};
+  std::string cpu_weight_only_algo_;
 
   bool with_profile_{false};
 
@@ -1317,6 +1729,7 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // onednn related.
   int mkldnn_cache_capacity_{10};
+  std::string onednn_primitive_cache_warmup_path_;
   bool use_mkldnn_bfloat16_{false};
   std::unordered_set<std::string> bfloat16_enabled_op_types_;
   bool use_mkldnn_int8_{false};
@@ -1362,6 +1775,7 @@ struct PD_INFER_DECL AnalysisConfig {
   // So we release the memory when the predictor is set up.
   mutable bool is_valid_{true};
   bool save_optimized_model_{false};
+  bool use_mmap_params_{false};
   std::string opt_cache_dir_;
   friend class paddle_infer::experimental::InternalUtils;
 
@@ -161,6 +161,35 @@ struct PD_INFER_DECL PaddleTensor {
   std::vector<std::vector<size_t>> lod;  ///<  Tensor+LoD equals LoDTensor
 };
 
+///
+/// \brief The latencies recorded since the statistics are enabled or reset,
+/// all in microseconds.
+///
+struct PD_INFER_DECL PaddleLatencyStats {
+  uint64_t count{0};
+  double avg{0.};
+  double p50{0.};
+  double p99{0.};
+  double max{0.};
+};
+
+///
+/// \brief The latency breakdown of the runs of a predictor, see
+/// AnalysisConfig::EnableRunStatistics.
+///
+struct PD_INFER_DECL PaddleRunStats {
+  PaddleLatencyStats run;       ///< the whole run on the host.
+  PaddleLatencyStats feed;      ///< the copy of the inputs of Run.
+  PaddleLatencyStats executor;  ///< the launch of the ops.
+  /// The device time of the ops on the stream of the GPU, timed by events and
+  /// read when the stats are polled, the runs do not wait for the stream.
+  PaddleLatencyStats sync;
+  PaddleLatencyStats fetch;  ///< the copy of the outputs of Run.
+  /// The ops of the sampled runs by their types, each with the stream
+  /// synchronized before and after it.
+  std::map<std::string, PaddleLatencyStats> ops;
+};
+
 /// \brief Represents an n-dimensional array of values.
 /// The ZeroCopyTensor is used to store the input or output of the network.
 /// Zero copy means that the tensor supports direct copy of host or device data
@@ -315,6 +344,34 @@ class PD_INFER_DECL PaddlePredictor {
   ///
   virtual uint64_t TryShrinkMemory() { return 0; }
 
+  ///
+  /// \brief Compact the memory pool by moving the intermediate tensors kept
+  /// between the runs, so the fragmented chunks are released as well.
+  ///
+  /// \return Number of bytes released.
+  ///
+  virtual uint64_t CompactMemory() { return TryShrinkMemory(); }
+
+  ///
+  /// \brief Bind a buffer to an output, which every later ZeroCopyRun writes
+  /// the output to, so that it needs neither the copy of Tensor::CopyToCpu
+  /// nor the per-run allocation. The outputs on the device of the predictor
+  /// are computed into the buffer of the device directly, and the others are
+  /// copied to the buffer after the run.
+  ///
+  /// \param name the output name.
+  /// \param data the buffer, nullptr unbinds the output.
+  /// \param size the bytes of the buffer, the upper bound of the output.
+  /// \param place the place of the buffer.
+  /// \return Whether the output is bound.
+  ///
+  virtual bool BindOutput(const std::string& name,
+                          void* data,
+                          size_t size,
+                          PaddlePlace place) {
+    return false;
+  }
+
   ///
   /// \brief Register a output hook function to operate the intermediate tensor
   /// of op output. when using this function, memory reuse should be turned off.
@@ -328,6 +385,15 @@ class PD_INFER_DECL PaddlePredictor {
   /// \brief Same as RegisterOutputHook
   virtual void RegisterInputHook(const InputTensorHookFunc& hookfunc) {}
 
+  ///
+  /// \brief Get the latency breakdown of the runs, which is empty unless
+  /// AnalysisConfig::EnableRunStatistics is called.
+  ///
+  virtual PaddleRunStats GetRunStats() { return PaddleRunStats(); }
+
+  /// \brief Clear the latencies recorded so far.
+  virtual void ResetRunStats() {}
+
   /// \brief Clone an existing predictor
   /// When using clone, the same network will be created,
   /// and the parameters between them are shared.
@@ -521,6 +587,12 @@ class PD_INFER_DECL InternalUtils {
   static void DisableTensorRtHalfOps(
       paddle_infer::Config* c, const std::unordered_set<std::string>& ops);
 
+  // Blocks until the TensorRT engines built in the background with
+  // FLAGS_trt_async_engine_build are ready.
+  static void WaitTensorRtEngineBuilds();
+  // Returns how many times the TensorRT engines of the process executed.
+  static int64_t TensorRtEngineRunCount();
+
   static void SyncStream(paddle_infer::Predictor* pred);
   static void SyncStream(cudaStream_t stream);
   static void SyncStream(hipStream_t stream);
@@ -22,6 +22,8 @@ limitations under the License. */
 #pragma once
 
 #include <cassert>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -48,6 +50,8 @@ using PrecisionType = paddle::AnalysisConfig::Precision;
 using Config = paddle::AnalysisConfig;
 using DistConfig = paddle::DistConfig;
 using XpuConfig = paddle::XpuConfig;
+using LatencyStats = paddle::PaddleLatencyStats;
+using RunStats = paddle::PaddleRunStats;
 
 ///
 /// \class Predictor
@@ -190,6 +194,14 @@ class PD_INFER_DECL Predictor {
   ///
   uint64_t TryShrinkMemory();
 
+  ///
+  /// \brief Compact the memory pool by moving the intermediate tensors kept
+  /// between the runs, so the fragmented chunks are released as well.
+  ///
+  /// \return Number of bytes released.
+  ///
+  uint64_t CompactMemory();
+
   ///
   /// \brief Register a output hook function to operate the intermediate tensor
   /// of op output. when using this function, memory reuse should be turned off.
@@ -200,9 +212,35 @@ class PD_INFER_DECL Predictor {
   ///
   void RegisterOutputHook(const OutputTensorHookFunc& hookfunc);
 
+  ///
+  /// \brief Bind a buffer to an output, which every later Run writes the
+  /// output to directly, the binding is not cloned by Clone.
+  ///
+  /// \param name the output name.
+  /// \param data the buffer, nullptr unbinds the output.
+  /// \param size the bytes of the buffer, the upper bound of the output.
+  /// \param place the place of the buffer.
+  /// \return Whether the output is bound.
+  ///
+  bool BindOutput(const std::string& name,
+                  void* data,
+                  size_t size,
+                  PlaceType place);
+
   /// The same as RegisterOutputHook.
   void RegisterInputHook(const InputTensorHookFunc& hookfunc);
 
+  ///
+  /// \brief Get the latency breakdown of the runs, which is recorded when
+  /// Config::EnableRunStatistics is called, in microseconds.
+  ///
+  /// \return the latencies of the runs and of the sampled ops.
+  ///
+  RunStats GetRunStats();
+
+  /// \brief Clear the latencies recorded so far.
+  void ResetRunStats();
+
   ///
   /// \brief Get the execution stream on devices with a concept of stream,
   /// otherwise returns nullptr.
@@ -273,6 +311,183 @@ class PD_INFER_DECL PredictorPool {
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
 };
+
+///
+/// \brief Statistics of an AsyncPredictorPool, the times are in microseconds.
+///
+struct PD_INFER_DECL AsyncPredictorPoolStats {
+  uint64_t num_finished{0};
+  uint64_t num_failed{0};
+  // submitted but not started yet
+  size_t num_pending{0};
+  // from Submit to the start of the run on a predictor
+  double avg_queue_time{0.};
+  double max_queue_time{0.};
+  double avg_run_time{0.};
+  double max_run_time{0.};
+  // number of runs executed by each predictor of the pool
+  std::vector<uint64_t> num_runs;
+};
+
+///
+/// \class AsyncPredictorPool
+///
+/// \brief AsyncPredictorPool runs the submitted requests on a fixed set of
+/// predictors. The predictors are clones of one predictor, so they share one
+/// copy of the weights, and each of them owns its intermediate tensors and
+/// runs on its own thread. A request is run by the first predictor that is
+/// free, in the order of submission.
+///
+/// To run the predictors on different streams, configure the config with an
+/// external stream and pass one stream per predictor.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// AsyncPredictorPool pool(config, 8);
+/// std::vector<paddle::Tensor> outputs;
+/// auto done = pool.Run(inputs, &outputs);
+/// done.get();
+/// \endcode
+///
+class PD_INFER_DECL AsyncPredictorPool {
+ public:
+  using Task = std::function<bool(Predictor*)>;
+
+  AsyncPredictorPool() = delete;
+  AsyncPredictorPool(const AsyncPredictorPool&) = delete;
+  AsyncPredictorPool& operator=(const AsyncPredictorPool&) = delete;
+
+  /// \brief Construct the pool with \param size predictors, the i-th of them
+  /// runs on \param streams[i] if \param streams is not empty.
+  AsyncPredictorPool(const Config& config,
+                     size_t size,
+                     const std::vector<void*>& streams = {});
+
+  /// \brief Wait for the submitted requests and stop the threads.
+  ~AsyncPredictorPool();
+
+  /// \brief Run \param task with a free predictor. The task may use the
+  /// input and output handles of the predictor and call Run() of it, the
+  /// returned future gets the result of the task.
+  std::future<bool> Submit(Task task);
+
+  /// \brief Run the predictor on \param inputs asynchronously, \param outputs
+  /// must stay valid until the returned future is ready.
+  std::future<bool> Run(std::vector<paddle::Tensor> inputs,
+                        std::vector<paddle::Tensor>* outputs);
+
+  AsyncPredictorPoolStats GetStats() const;
+
+  void ResetStats();
+
+  size_t size() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+///
+/// \brief Options of a DynamicBatcher.
+///
+struct PD_INFER_DECL DynamicBatcherConfig {
+  // a batch is run when it has max_batch_size samples, or when its first
+  // request has waited max_wait_us
+  int max_batch_size{32};
+  int64_t max_wait_us{1000};
+  // The batches are padded to the smallest of these sizes which is not
+  // smaller than them, by repeating their last sample. Empty means the
+  // powers of 2 up to max_batch_size, and max_batch_size.
+  std::vector<int> batch_sizes;
+  // The file written by Config::CollectShapeRangeInfo. The batch sizes are
+  // limited to the range of the first dimension of every input recorded in
+  // it, and the optimal batch sizes recorded are added to batch_sizes, so
+  // that the TensorRT engines built for the ranges are not rebuilt.
+  std::string shape_range_info_path;
+};
+
+///
+/// \brief Statistics of a DynamicBatcher.
+///
+struct PD_INFER_DECL DynamicBatcherStats {
+  uint64_t num_requests{0};
+  uint64_t num_batches{0};
+  // samples of the requests, and samples added by padding
+  uint64_t num_samples{0};
+  uint64_t num_padded_samples{0};
+  uint64_t num_failed_batches{0};
+};
+
+///
+/// \class DynamicBatcher
+///
+/// \brief DynamicBatcher runs a predictor on batches built from the requests
+/// submitted by several callers. The inputs of the requests of one batch are
+/// concatenated along their first dimension, and the outputs whose first
+/// dimension is declared as -1 by the model are split back to the requests,
+/// while the others are given to every request. Requests are batched together
+/// only if their inputs have the same types and the same dims except the
+/// first one, which should not exceed max_batch_size.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// DynamicBatcherConfig batcher_config;
+/// batcher_config.max_batch_size = 16;
+/// DynamicBatcher batcher(config, batcher_config);
+/// std::vector<paddle::Tensor> outputs = batcher.Submit(inputs).get();
+/// \endcode
+///
+class PD_INFER_DECL DynamicBatcher {
+ public:
+  DynamicBatcher() = delete;
+  DynamicBatcher(const DynamicBatcher&) = delete;
+  DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+  DynamicBatcher(const Config& config,
+                 const DynamicBatcherConfig& batcher_config);
+
+  /// \brief Run the submitted requests and stop the batching thread.
+  ~DynamicBatcher();
+
+  /// \brief Submit a request whose \param inputs are in the order of
+  /// Predictor::GetInputNames(). The future gets the outputs of the request,
+  /// or the exception of the failed batch.
+  std::future<std::vector<paddle::Tensor>> Submit(
+      std::vector<paddle::Tensor> inputs);
+
+  /// \brief The batch sizes batches are padded to.
+  const std::vector<int>& batch_sizes() const;
+
+  DynamicBatcherStats GetStats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+///
+/// \brief The options of the models colocated on a GPU by
+/// Config::EnableColocation.
+///
+struct PD_INFER_DECL ColocationOptions {
+  /// The bytes the colocated models may allocate together, 0 is unlimited.
+  size_t memory_cap{0};
+  /// The streams shared by the colocated models in turn, which share the
+  /// memory pools of the streams as well. 0 gives each predictor a stream.
+  int num_streams{0};
+  /// The runs of the colocated models at a time, which are scheduled by the
+  /// weights of the models. 0 leaves the runs unscheduled.
+  int max_concurrent_runs{0};
+};
+
+///
+/// \brief Set the options of the models colocated on the GPU of
+/// \param device_id, which apply to the predictors created after it.
+///
+PD_INFER_DECL void SetColocationOptions(int device_id,
+                                        const ColocationOptions& options);
 }  // namespace services
 
 }  // namespace paddle_infer
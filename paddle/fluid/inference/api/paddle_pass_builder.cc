@@ -225,6 +225,7 @@ const std::vector<std::string> CpuBasicPasses{
     "seqconv_eltadd_relu_fuse_pass",  //
     // "seqpool_concat_fuse_pass",    //
     "seqpool_cvm_concat_fuse_pass",  //
+    "embedding_seqpool_cvm_concat_fuse_pass",  //
     // "embedding_fc_lstm_fuse_pass", //
     // TODO(wilber): fix correctness problem.
     // "fc_lstm_fuse_pass",                    //
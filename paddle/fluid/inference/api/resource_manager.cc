@@ -416,6 +416,43 @@ void* ResourceManager::InitGPUResource(const phi::Place& place, void* stream) {
   }
 }
 
+void* ResourceManager::InitPooledGPUResource(const phi::Place& place,
+                                             int num_streams,
+                                             const void* owner) {
+  std::lock_guard<std::mutex> lock_guard(gpu_mutex_);
+  auto& pool = stream_pools_[place.GetDeviceId()];
+  void* stream = nullptr;
+  if (pool.size() < static_cast<size_t>(num_streams)) {
+    std::unique_ptr<GPUContextResource> resource{
+        new GPUContextResource(place, nullptr)};
+    stream = resource->GetStream();
+    // The reference of the pool.
+    ref_count_[stream] = 1;
+    gpu_resources_.emplace(stream, std::move(resource));
+    pool.push_back(stream);
+  } else {
+    stream = pool[next_pooled_stream_[place.GetDeviceId()]++ % pool.size()];
+  }
+  Increase(stream);
+  pooled_gpu_resources_[owner].reset(new GPUContextResource(place, stream));
+  return stream;
+}
+
+GPUContextResource* ResourceManager::GetPooledGPUResource(
+    const void* owner) const {
+  std::lock_guard<std::mutex> lock_guard(gpu_mutex_);
+  PADDLE_ENFORCE_EQ(pooled_gpu_resources_.count(owner),
+                    true,
+                    common::errors::InvalidArgument(
+                        "The pooled gpu resource of [%p] not found.", owner));
+  return pooled_gpu_resources_.at(owner).get();
+}
+
+void ResourceManager::DestroyPooledGPUResource(const void* owner) {
+  std::lock_guard<std::mutex> lock_guard(gpu_mutex_);
+  pooled_gpu_resources_.erase(owner);
+}
+
 void ResourceManager::DestroyGPUResource(void* stream) {
   PADDLE_ENFORCE_EQ(gpu_resources_.count(stream),
                     true,
@@ -18,6 +18,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "paddle/common/macros.h"
 #include "paddle/phi/api/include/tensor.h"
@@ -143,6 +144,15 @@ class ResourceManager {
   // GPU Resource
  public:
   void* InitGPUResource(const phi::Place& place, void* stream);
+  // Shares the num_streams streams of the pool of the device in turn, the
+  // pool keeps the streams when their predictors exit. The owner gets a
+  // GPUContextResource of its own on the stream, so the predictors sharing a
+  // stream do not share their handles across threads.
+  void* InitPooledGPUResource(const phi::Place& place,
+                              int num_streams,
+                              const void* owner);
+  TEST_API GPUContextResource* GetPooledGPUResource(const void* owner) const;
+  void DestroyPooledGPUResource(const void* owner);
   void DestroyGPUResource(void* stream);
   TEST_API GPUContextResource* GetGPUResource(void* stream) const;
   TEST_API int RefCount(void* stream) const;
@@ -153,11 +163,15 @@ class ResourceManager {
   void Increase(void* stream);
 
  private:
-  std::mutex gpu_mutex_;
+  mutable std::mutex gpu_mutex_;
   // a stream corresponding to a series of resource.
   std::map<void* /*stream*/, std::atomic<int>> ref_count_;
   std::map<void* /*stream*/, std::unique_ptr<GPUContextResource>>
       gpu_resources_;
+  std::map<int /*device_id*/, std::vector<void*>> stream_pools_;
+  std::map<int /*device_id*/, size_t> next_pooled_stream_;
+  std::map<const void* /*owner*/, std::unique_ptr<GPUContextResource>>
+      pooled_gpu_resources_;
 #endif
 
  private:
@@ -329,6 +329,17 @@ PD_Bool PD_ConfigShapeRangeInfoCollected(__pd_keep PD_Config* pd_config) {
   return config->shape_range_info_collected();  // NOLINT
 }
 
+void PD_ConfigEnableRunStatistics(__pd_keep PD_Config* pd_config,
+                                  int32_t op_sample_interval) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  config->EnableRunStatistics(op_sample_interval);
+}
+
+PD_Bool PD_ConfigRunStatisticsEnabled(__pd_keep PD_Config* pd_config) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  return config->run_statistics_enabled();  // NOLINT
+}
+
 void PD_ConfigDisableTensorRtOPs(__pd_keep PD_Config* pd_config,
                                  size_t ops_num,
                                  const char** ops_name) {
@@ -444,6 +444,25 @@ PADDLE_CAPI_EXPORT extern const char* PD_ConfigShapeRangeInfoPath(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigShapeRangeInfoCollected(
     __pd_keep PD_Config* pd_config);
 
+///
+/// \brief Record the latency breakdown of the runs, which is polled by
+/// PD_PredictorGetRunStats.
+///
+/// \param[in] pd_config config
+/// \param[in] op_sample_interval time the ops every op_sample_interval runs,
+/// 0 never times the ops.
+///
+PADDLE_CAPI_EXPORT extern void PD_ConfigEnableRunStatistics(
+    __pd_keep PD_Config* pd_config, int32_t op_sample_interval);
+
+///
+/// \brief A boolean state telling whether the run statistics are enabled.
+///
+/// \param[in] pd_config config
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigRunStatisticsEnabled(
+    __pd_keep PD_Config* pd_config);
+
 ///
 /// \brief Prevent ops running in Paddle-TRT
 /// NOTE: just experimental, not an official stable API, easy to be broken.
@@ -14,6 +14,13 @@
 
 #include "paddle/fluid/inference/capi_exp/pd_predictor.h"
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/capi_exp/pd_config.h"
 #include "paddle/fluid/inference/capi_exp/pd_types.h"
@@ -29,6 +36,91 @@
           "The pointer of paddle predictor shouldn't be nullptr")); \
   auto& predictor = pd_predictor->predictor
 
+namespace paddle_infer {
+
+// The completion thread of a predictor, which runs its queued runs one by one
+// and calls their callbacks. It runs the queued runs before it exits.
+class PredictorAsyncRunner {
+ public:
+  explicit PredictorAsyncRunner(PD_Predictor* pd_predictor)
+      : pd_predictor_(pd_predictor), thread_([this] { Loop(); }) {}
+
+  ~PredictorAsyncRunner() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  void Submit(PD_PredictorRunCallback callback, void* user_data) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      runs_.emplace_back(callback, user_data);
+      ++pending_;
+    }
+    cv_.notify_all();
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+ private:
+  void Loop() {
+    while (true) {
+      std::pair<PD_PredictorRunCallback, void*> run;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !runs_.empty(); });
+        if (runs_.empty()) return;
+        run = runs_.front();
+        runs_.pop_front();
+      }
+      PD_Bool success = FALSE;
+      try {
+        success = pd_predictor_->predictor->Run();
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "PD_PredictorRunAsync failed: " << e.what();
+      }
+      if (run.first != nullptr) {
+        run.first(pd_predictor_, success, run.second);
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --pending_;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  PD_Predictor* pd_predictor_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<PD_PredictorRunCallback, void*>> runs_;
+  size_t pending_{0};
+  bool stop_{false};
+  std::thread thread_;
+};
+
+// The async runner of the predictor, created by the first request when
+// `create` is set. The pointer is only accessed under the mutex, and the
+// returned copy keeps the runner alive while it is used.
+std::shared_ptr<PredictorAsyncRunner> GetAsyncRunner(PD_Predictor* pd_predictor,
+                                                     bool create) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!pd_predictor->async_runner && create) {
+    pd_predictor->async_runner =
+        std::make_shared<PredictorAsyncRunner>(pd_predictor);
+  }
+  return pd_predictor->async_runner;
+}
+
+}  // namespace paddle_infer
+
 extern "C" {
 __pd_give PD_Predictor* PD_PredictorCreate(__pd_take PD_Config* pd_config) {
   PADDLE_ENFORCE_NOT_NULL(
@@ -143,6 +235,72 @@ PD_Bool PD_PredictorRun(__pd_keep PD_Predictor* pd_predictor) {
   return predictor->Run();  // NOLINT
 }
 
+void PD_PredictorRunAsync(__pd_keep PD_Predictor* pd_predictor,
+                          PD_PredictorRunCallback callback,
+                          void* user_data) {
+  PADDLE_ENFORCE_NOT_NULL(
+      pd_predictor,
+      common::errors::InvalidArgument(
+          "The pointer of paddle predictor shouldn't be nullptr"));
+  paddle_infer::GetAsyncRunner(pd_predictor, true)->Submit(callback, user_data);
+}
+
+void PD_PredictorWaitAsync(__pd_keep PD_Predictor* pd_predictor) {
+  PADDLE_ENFORCE_NOT_NULL(
+      pd_predictor,
+      common::errors::InvalidArgument(
+          "The pointer of paddle predictor shouldn't be nullptr"));
+  auto async_runner = paddle_infer::GetAsyncRunner(pd_predictor, false);
+  if (async_runner) {
+    async_runner->Wait();
+  }
+}
+
+PD_Bool PD_PredictorBindOutput(__pd_keep PD_Predictor* pd_predictor,
+                               const char* name,
+                               void* data,
+                               size_t size,
+                               PD_PlaceType place) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  return predictor->BindOutput(
+      name, data, size, paddle_infer::CvtToCxxPlaceType(place));
+}
+
+__pd_give PD_RunStats* PD_PredictorGetRunStats(
+    __pd_keep PD_Predictor* pd_predictor) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  auto cvt_stats = [](const paddle_infer::LatencyStats& stats) {
+    PD_LatencyStats result;
+    result.count = stats.count;
+    result.avg = stats.avg;
+    result.p50 = stats.p50;
+    result.p99 = stats.p99;
+    result.max = stats.max;
+    return result;
+  };
+  paddle_infer::RunStats stats = predictor->GetRunStats();
+  PD_RunStats* run_stats = new PD_RunStats;
+  run_stats->run = cvt_stats(stats.run);
+  run_stats->feed = cvt_stats(stats.feed);
+  run_stats->executor = cvt_stats(stats.executor);
+  run_stats->sync = cvt_stats(stats.sync);
+  run_stats->fetch = cvt_stats(stats.fetch);
+  std::vector<std::string> op_types;
+  run_stats->ops =
+      stats.ops.empty() ? nullptr : new PD_LatencyStats[stats.ops.size()];
+  for (auto& item : stats.ops) {
+    run_stats->ops[op_types.size()] = cvt_stats(item.second);
+    op_types.push_back(item.first);
+  }
+  run_stats->op_types = paddle_infer::CvtVecToOneDimArrayCstr(op_types);
+  return run_stats;
+}
+
+void PD_PredictorResetRunStats(__pd_keep PD_Predictor* pd_predictor) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  predictor->ResetRunStats();
+}
+
 void PD_PredictorClearIntermediateTensor(__pd_keep PD_Predictor* pd_predictor) {
   CHECK_AND_CONVERT_PD_PREDICTOR;
   predictor->ClearIntermediateTensor();
@@ -31,6 +31,16 @@ typedef struct PD_Config PD_Config;
 typedef struct PD_Tensor PD_Tensor;
 typedef struct PD_OneDimArrayCstr PD_OneDimArrayCstr;
 typedef struct PD_IOInfos PD_IOInfos;
+typedef struct PD_RunStats PD_RunStats;
+
+///
+/// \brief The callback of PD_PredictorRunAsync, which is called by the
+/// completion thread of the predictor with whether the run succeeded and the
+/// user data of the run.
+///
+typedef void (*PD_PredictorRunCallback)(PD_Predictor* pd_predictor,
+                                        PD_Bool success,
+                                        void* user_data);
 
 #ifdef __cplusplus
 extern "C" {
@@ -131,6 +141,69 @@ PADDLE_CAPI_EXPORT extern __pd_give PD_Tensor* PD_PredictorGetOutputHandle(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_PredictorRun(
     __pd_keep PD_Predictor* pd_predictor);
 
+///
+/// \brief Run the prediction engine without blocking. The runs of a
+/// predictor are queued and run one by one by its completion thread, which
+/// calls the callback as each of them is done. The input and output tensors
+/// of the predictor should not be touched until the callback of the run, so
+/// requests are pipelined by the clones of the predictor. The callback should
+/// not destroy the predictor.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] callback the callback called as the run is done, can be NULL.
+/// \param[in] user_data the data passed to the callback.
+///
+PADDLE_CAPI_EXPORT extern void PD_PredictorRunAsync(
+    __pd_keep PD_Predictor* pd_predictor,
+    PD_PredictorRunCallback callback,
+    void* user_data);
+
+///
+/// \brief Wait until all the runs of PD_PredictorRunAsync are done.
+///
+/// \param[in] pd_predictor predictor
+///
+PADDLE_CAPI_EXPORT extern void PD_PredictorWaitAsync(
+    __pd_keep PD_Predictor* pd_predictor);
+
+///
+/// \brief Bind a buffer to an output, which every later run writes the
+/// output to directly, so that it needs neither the copy of
+/// PD_TensorCopyToCpu nor the per-run allocation.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] name the output name.
+/// \param[in] data the buffer, NULL unbinds the output.
+/// \param[in] size the bytes of the buffer, the upper bound of the output.
+/// \param[in] place the place of the buffer.
+/// \return Whether the output is bound.
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_PredictorBindOutput(
+    __pd_keep PD_Predictor* pd_predictor,
+    const char* name,
+    void* data,
+    size_t size,
+    PD_PlaceType place);
+
+///
+/// \brief Get the latency breakdown of the runs, which is recorded when
+/// PD_ConfigEnableRunStatistics is called.
+///
+/// \param[in] pd_predictor predictor
+/// \return the latencies of the runs and of the sampled ops, which should be
+/// destroyed by PD_RunStatsDestroy.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_RunStats* PD_PredictorGetRunStats(
+    __pd_keep PD_Predictor* pd_predictor);
+
+///
+/// \brief Clear the latencies recorded so far.
+///
+/// \param[in] pd_predictor predictor
+///
+PADDLE_CAPI_EXPORT extern void PD_PredictorResetRunStats(
+    __pd_keep PD_Predictor* pd_predictor);
+
 /// \brief Clear the intermediate tensors of the predictor
 ///
 /// \param[in] pd_predictor predictor
@@ -59,3 +59,21 @@ typedef struct PD_IOInfos {
   size_t size;
   PD_IOInfo** io_info;
 } PD_IOInfos;  // inputs or outputs info
+
+typedef struct PD_LatencyStats {
+  uint64_t count;
+  double avg;
+  double p50;
+  double p99;
+  double max;
+} PD_LatencyStats;  // latencies in microseconds
+
+typedef struct PD_RunStats {
+  PD_LatencyStats run;
+  PD_LatencyStats feed;
+  PD_LatencyStats executor;
+  PD_LatencyStats sync;
+  PD_LatencyStats fetch;
+  PD_OneDimArrayCstr* op_types;
+  PD_LatencyStats* ops;  // of the size of op_types
+} PD_RunStats;  // latency breakdown of the runs
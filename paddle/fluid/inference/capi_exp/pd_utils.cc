@@ -206,6 +206,16 @@ void PD_IOInfosDestroy(__pd_take PD_IOInfos* io_infos) {
   }
 }
 
+void PD_RunStatsDestroy(__pd_take PD_RunStats* run_stats) {
+  if (run_stats != nullptr) {
+    PD_OneDimArrayCstrDestroy(run_stats->op_types);
+    run_stats->op_types = nullptr;
+    delete[] run_stats->ops;
+    run_stats->ops = nullptr;
+    delete run_stats;
+  }
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -97,6 +97,14 @@ PADDLE_CAPI_EXPORT extern void PD_IOInfoDestroy(__pd_take PD_IOInfo* io_info);
 PADDLE_CAPI_EXPORT extern void PD_IOInfosDestroy(
     __pd_take PD_IOInfos* io_infos);
 
+///
+/// \brief Destroy the PD_RunStats object pointed to by the pointer.
+///
+/// \param[in] run_stats pointer to the PD_RunStats object.
+///
+PADDLE_CAPI_EXPORT extern void PD_RunStatsDestroy(
+    __pd_take PD_RunStats* run_stats);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -24,6 +24,12 @@ typedef struct PD_Tensor {
   std::unique_ptr<paddle_infer::Tensor> tensor;
 } PD_Tensor;
 
+namespace paddle_infer {
+class PredictorAsyncRunner;
+}  // namespace paddle_infer
+
 typedef struct PD_Predictor {
   std::shared_ptr<paddle_infer::Predictor> predictor;
+  // Runs the PD_PredictorRunAsync requests, created by the first of them.
+  std::shared_ptr<paddle_infer::PredictorAsyncRunner> async_runner;
 } PD_Predictor;
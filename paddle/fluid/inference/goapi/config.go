@@ -433,6 +433,24 @@ func (config *Config) CollectShapeRangeInfo(shapeRangeInfoPath string) {
 	defer C.free(unsafe.Pointer(cstr))
 }
 
+///
+/// \brief Record the latency breakdown of the runs, which is polled by
+/// Predictor.GetRunStats.
+///
+/// \param opSampleInterval time the ops every opSampleInterval runs, 0 never
+/// times the ops.
+///
+func (config *Config) EnableRunStatistics(opSampleInterval int32) {
+	C.PD_ConfigEnableRunStatistics(config.c, C.int32_t(opSampleInterval))
+}
+
+///
+/// \brief A boolean state telling whether the run statistics are enabled.
+///
+func (config *Config) RunStatisticsEnabled() bool {
+	return cvtPDBoolToGo(C.PD_ConfigRunStatisticsEnabled(config.c))
+}
+
 ///
 /// \brief the shape info path in CollectShapeInfo mode.
 /// Attention, Please release the string manually.
@@ -21,9 +21,11 @@ package paddle
 // #include "pd_utils.h"
 // #include <stdlib.h>
 // #include <string.h>
+// extern void goPredictorRunCallback(PD_Predictor*, PD_Bool, void*);
 import "C"
 import (
 	"runtime"
+	"sync"
 	"unsafe"
 )
 
@@ -145,6 +147,133 @@ func (p *Predictor) Run() {
 	C.PD_PredictorRun(p.c)
 }
 
+type asyncRun struct {
+	predictor *Predictor
+	done      chan bool
+}
+
+// The runs of RunAsync in flight by their keys passed as the user data, which
+// keep the predictors alive until the runs are done.
+var (
+	asyncRunsMutex sync.Mutex
+	asyncRuns      = make(map[uintptr]asyncRun)
+)
+
+//export goPredictorRunCallback
+func goPredictorRunCallback(cPredictor *C.PD_Predictor, success C.PD_Bool, userData unsafe.Pointer) {
+	asyncRunsMutex.Lock()
+	run := asyncRuns[uintptr(userData)]
+	delete(asyncRuns, uintptr(userData))
+	asyncRunsMutex.Unlock()
+	C.free(userData)
+	run.done <- success != 0
+}
+
+///
+/// \brief Run the prediction engine without blocking. The runs are queued
+/// and run one by one by the completion thread of the predictor, so the input
+/// and output tensors should not be touched until the run is done.
+///
+/// \return a channel receiving whether the run succeeded as it is done.
+///
+func (p *Predictor) RunAsync() <-chan bool {
+	done := make(chan bool, 1)
+	key := C.malloc(1)
+	asyncRunsMutex.Lock()
+	asyncRuns[uintptr(key)] = asyncRun{predictor: p, done: done}
+	asyncRunsMutex.Unlock()
+	C.PD_PredictorRunAsync(p.c, C.PD_PredictorRunCallback(C.goPredictorRunCallback), key)
+	return done
+}
+
+///
+/// \brief Bind a buffer to an output, which every later run writes the
+/// output to directly. The buffer is kept by the predictor, so it should be
+/// allocated by C or the device rather than Go.
+///
+/// \param[in] name the output name
+/// \param[in] data the buffer, nil unbinds the output
+/// \param[in] size the bytes of the buffer, the upper bound of the output
+/// \param[in] place the place of the buffer
+/// \return whether the output is bound
+///
+func (p *Predictor) BindOutput(name string, data unsafe.Pointer, size uint, place PlaceType) bool {
+	cName := C.CString(name)
+	defer C.free(unsafe.Pointer(cName))
+	return C.PD_PredictorBindOutput(p.c, cName, data, C.size_t(size), C.PD_PlaceType(place)) != 0
+}
+
+///
+/// \brief The latencies recorded since the statistics are enabled or reset,
+/// all in microseconds.
+///
+type LatencyStats struct {
+	Count uint64
+	Avg   float64
+	P50   float64
+	P99   float64
+	Max   float64
+}
+
+///
+/// \brief The latency breakdown of the runs of a predictor, see
+/// Config.EnableRunStatistics.
+///
+type RunStats struct {
+	Run      LatencyStats
+	Feed     LatencyStats
+	Executor LatencyStats
+	Sync     LatencyStats
+	Fetch    LatencyStats
+	// The ops of the sampled runs by their types.
+	Ops map[string]LatencyStats
+}
+
+func cvtToGoLatencyStats(stats *C.PD_LatencyStats) LatencyStats {
+	return LatencyStats{
+		Count: uint64(stats.count),
+		Avg:   float64(stats.avg),
+		P50:   float64(stats.p50),
+		P99:   float64(stats.p99),
+		Max:   float64(stats.max),
+	}
+}
+
+///
+/// \brief Get the latency breakdown of the runs, which is recorded when
+/// Config.EnableRunStatistics is called.
+///
+/// \return the latencies of the runs and of the sampled ops
+///
+func (p *Predictor) GetRunStats() RunStats {
+	cStats := C.PD_PredictorGetRunStats(p.c)
+	defer C.PD_RunStatsDestroy(cStats)
+	stats := RunStats{
+		Run:      cvtToGoLatencyStats(&cStats.run),
+		Feed:     cvtToGoLatencyStats(&cStats.feed),
+		Executor: cvtToGoLatencyStats(&cStats.executor),
+		Sync:     cvtToGoLatencyStats(&cStats.sync),
+		Fetch:    cvtToGoLatencyStats(&cStats.fetch),
+		Ops:      make(map[string]LatencyStats),
+	}
+	numOps := int(cStats.op_types.size)
+	opTypes := cvtToGoSliceString(numOps, cStats.op_types.data)
+	if numOps > 0 {
+		ops := (*[1 << 27]C.PD_LatencyStats)(unsafe.Pointer(cStats.ops))[:numOps:numOps]
+		for i, opType := range opTypes {
+			stats.Ops[opType] = cvtToGoLatencyStats(&ops[i])
+		}
+	}
+	return stats
+}
+
+///
+/// \brief Clear the latencies recorded so far.
+///
+func (p *Predictor) ResetRunStats() {
+	C.PD_PredictorResetRunStats(p.c)
+}
+
 ///
 /// \brief Clear the intermediate tensors of the predictor
 ///
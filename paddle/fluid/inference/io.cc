@@ -19,11 +19,14 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/pybind/pybind.h"
+#include "paddle/phi/core/memory/allocation/mmap_allocator.h"
 #include "paddle/phi/core/platform/cpu_helper.h"
 
 // phi
@@ -136,6 +139,170 @@ void LoadPersistables(framework::Executor* executor,
   delete load_program;
 }
 
+#ifndef _WIN32
+namespace {
+
+// Reads the tensors serialized by save_combine from a mapped file, see
+// DeserializeFromStream.
+class MappedParamsReader {
+ public:
+  explicit MappedParamsReader(
+      std::shared_ptr<memory::allocation::MemoryMapFileAllocation> file)
+      : file_(std::move(file)),
+        data_(static_cast<const char*>(file_->ptr())),
+        size_(file_->size()) {}
+
+  void ReadTensor(const std::string& name,
+                  const phi::Place& place,
+                  phi::DenseTensor* tensor) {
+    uint32_t version = Read<uint32_t>(name);
+    PADDLE_ENFORCE_EQ(
+        version,
+        0U,
+        common::errors::InvalidArgument(
+            "Deserialize to tensor %s failed, maybe the loaded file is not a "
+            "paddle model(expected file format: 0, but %u found).",
+            name,
+            version));
+    uint64_t lod_level = Read<uint64_t>(name);
+    auto& lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size = Read<uint64_t>(name);
+      lod[i].resize(size / sizeof(size_t));
+      memcpy(lod[i].data(), Skip(size, name), size);
+    }
+
+    version = Read<uint32_t>(name);
+    PADDLE_ENFORCE_EQ(
+        version,
+        0U,
+        common::errors::InvalidArgument(
+            "tensor version %u is not supported, Only version 0 is supported",
+            version));
+    int32_t desc_size = Read<int32_t>(name);
+    PADDLE_ENFORCE_GE(desc_size,
+                      0,
+                      common::errors::InvalidArgument(
+                          "phi::DenseTensor desc size should >= 0"));
+    framework::proto::VarType::TensorDesc desc;
+    PADDLE_ENFORCE_EQ(
+        desc.ParseFromArray(Skip(desc_size, name), desc_size),
+        true,
+        common::errors::InvalidArgument("Cannot parse tensor desc"));
+
+    std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+    tensor->Resize(common::make_ddim(dims));
+    auto dtype = framework::TransToPhiDataType(desc.data_type());
+    size_t type_size = framework::SizeOfType(desc.data_type());
+    size_t bytes = tensor->numel() * type_size;
+    size_t offset = offset_;
+    const char* src = Skip(bytes, name);
+
+    phi::DenseTensor mapped;
+    mapped.Resize(tensor->dims());
+    mapped.ResetHolderWithType(
+        std::make_shared<memory::allocation::MemoryMapSliceAllocation>(
+            file_, offset, bytes),
+        dtype);
+    if (phi::is_cpu_place(place) &&
+        reinterpret_cast<uintptr_t>(src) % type_size == 0) {
+      // alias the mapping, the tensor keeps it alive
+      tensor->ResetHolderWithType(mapped.Holder(), dtype);
+      ++num_aliased_;
+    } else {
+      // misaligned elements, or the tensor is not on CPU
+      framework::TensorCopySync(mapped, place, tensor);
+    }
+  }
+
+  // load_combine does not allow partial loading either
+  void CheckEnd() const {
+    PADDLE_ENFORCE_EQ(offset_,
+                      size_,
+                      common::errors::Unavailable(
+                          "Not allowed to load partial data of %s, %d bytes "
+                          "of %d are loaded.",
+                          file_->ipc_name(),
+                          offset_,
+                          size_));
+  }
+
+  size_t num_aliased() const { return num_aliased_; }
+
+ private:
+  template <typename T>
+  T Read(const std::string& name) {
+    T value;
+    memcpy(&value, Skip(sizeof(T), name), sizeof(T));
+    return value;
+  }
+
+  const char* Skip(size_t bytes, const std::string& name) {
+    PADDLE_ENFORCE_LE(
+        bytes,
+        size_ - offset_,
+        common::errors::OutOfRange(
+            "Unexpected end of %s when loading %s, %d bytes wanted at offset "
+            "%d, but the size is %d.",
+            file_->ipc_name(),
+            name,
+            bytes,
+            offset_,
+            size_));
+    const char* ptr = data_ + offset_;
+    offset_ += bytes;
+    return ptr;
+  }
+
+  std::shared_ptr<memory::allocation::MemoryMapFileAllocation> file_;
+  const char* data_;
+  size_t size_;
+  size_t offset_{0};
+  size_t num_aliased_{0};
+};
+
+}  // namespace
+#endif
+
+bool LoadPersistablesWithMmap(const framework::ProgramDesc& main_program,
+                              const std::string& param_filename,
+                              framework::Scope* scope,
+                              const phi::Place& place) {
+#ifdef _WIN32
+  LOG(WARNING) << "Loading parameters with mmap is not supported on Windows.";
+  return false;
+#else
+  const framework::BlockDesc& global_block = main_program.Block(0);
+  std::vector<std::string> param_list;
+  for (auto* var : global_block.AllVars()) {
+    if (!IsPersistable(var)) {
+      continue;
+    }
+    if (var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      VLOG(3) << "Cannot load persistable variable " << var->Name()
+              << " of type " << var->GetType() << " with mmap.";
+      return false;
+    }
+    param_list.push_back(var->Name());
+  }
+  // the same order as LoadPersistables
+  std::sort(param_list.begin(), param_list.end());
+
+  MappedParamsReader reader(
+      memory::allocation::AllocateMemoryMapFileAllocation(param_filename));
+  for (auto& name : param_list) {
+    auto* tensor = scope->Var(name)->GetMutable<phi::DenseTensor>();
+    reader.ReadTensor(name, place, tensor);
+  }
+  reader.CheckEnd();
+  VLOG(3) << "Load " << param_list.size() << " parameters from "
+          << param_filename << " with mmap, " << reader.num_aliased()
+          << " of them share the mapped pages.";
+  return true;
+#endif
+}
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname) {
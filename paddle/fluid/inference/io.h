@@ -35,6 +35,18 @@ void LoadPersistables(framework::Executor* executor,
                       const std::string& param_filename,
                       bool model_from_memory);
 
+// Load the persistable variables of main_program from the combined
+// parameters file param_filename by mapping the file into memory. The tensors
+// on CPU place share the pages of the mapping, and so the page cache with the
+// other processes loading the same file, the ones on other places are copied
+// from the mapping. Returns false, without loading anything, if the program
+// has persistable variables load_combine can load but this can not, e.g.
+// vocabularies.
+bool LoadPersistablesWithMmap(const framework::ProgramDesc& main_program,
+                              const std::string& param_filename,
+                              framework::Scope* scope,
+                              const phi::Place& place);
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname);
@@ -15,7 +15,11 @@ limitations under the License. */
 #include "paddle/fluid/inference/tensorrt/engine.h"
 #include <NvInfer.h>
 #include <glog/logging.h>
+#include <algorithm>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 
 #include "NvInferRuntimeCommon.h"
 #include "cuda_runtime_api.h"  // NOLINT
@@ -23,9 +27,20 @@ limitations under the License. */
 #include "paddle/fluid/inference/tensorrt/helper.h"
 #include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#include "paddle/phi/core/scope_guard.h"
+
+COMMON_DECLARE_int32(trt_cuda_graph_cache_capacity);
 
 namespace paddle::inference::tensorrt {
 
+namespace {
+size_t HashWeightValues(const nvinfer1::Weights &weight) {
+  return std::hash<std::string_view>()(
+      std::string_view(static_cast<const char *>(weight.values),
+                       weight.count * TrtDataTypeSize(weight.type)));
+}
+}  // namespace
+
 thread_local int TensorRTEngine::predictor_id_per_thread = 0;
 
 void TensorRTEngine::Weight::SetDataType(phi::DataType type) {
@@ -74,14 +89,23 @@ void TensorRTEngine::InitNetwork() {
   }
 #endif
   infer_builder_config_.reset(infer_builder_->createBuilderConfig());
-  optim_profiles_.resize(max_profile_num_);
-  for (int i = 0; i < max_profile_num_; i++)
+  optim_profiles_.resize(max_profile_num_ * shape_bucket_num());
+  for (size_t i = 0; i < optim_profiles_.size(); i++)
     optim_profiles_[i] = infer_builder_->createOptimizationProfile();
 }
 
 nvinfer1::IExecutionContext *TensorRTEngine::context() {
   std::unique_lock<std::mutex> lock(mutex_);
-  if (infer_context_.find(predictor_id_per_thread) == infer_context_.end()) {
+  auto &infer_contexts = infer_context_[predictor_id_per_thread];
+  if (infer_contexts.empty()) {
+    infer_contexts.resize(shape_bucket_num());
+    if (with_dynamic_shape()) {
+      profile_index_[predictor_id_per_thread] = cur_profile_num_;
+      ++cur_profile_num_;
+    }
+  }
+  const int bucket = GetShapeBucketIndex();
+  if (infer_contexts[bucket] == nullptr) {
     PADDLE_ENFORCE_NOT_NULL(
         infer_engine_,
         common::errors::InvalidArgument(
@@ -101,29 +125,61 @@ nvinfer1::IExecutionContext *TensorRTEngine::context() {
         common::errors::InvalidArgument(
             "TensorRT engine can not build execution context."));
     if (with_dynamic_shape()) {
+      // the profiles of a predictor are adjacent, one for each shape bucket
+      const int profile =
+          profile_index_[predictor_id_per_thread] * shape_bucket_num() +
+          bucket;
       // need new profile if it's not the first
-      if (cur_profile_num_ > 0) {
+      if (profile > 0) {
 #if IS_TRT_VERSION_GE(8600)
-        infer_context->setOptimizationProfileAsync(cur_profile_num_, nullptr);
+        infer_context->setOptimizationProfileAsync(profile, nullptr);
 #else
-        infer_context->setOptimizationProfile(cur_profile_num_);
+        infer_context->setOptimizationProfile(profile);
 #endif
       }
-      profile_index_[predictor_id_per_thread] = cur_profile_num_;
-      ++cur_profile_num_;
     }
-    infer_context_[predictor_id_per_thread].reset(infer_context);
+    infer_contexts[bucket].reset(infer_context);
+  }
+  return infer_contexts[bucket].get();
+}
+
+void TensorRTEngine::SelectShapeBucket(
+    const ShapeMapType &runtime_input_shape) {
+  if (shape_bucket_num() == 1) return;
+  int bucket = 0;
+  for (; bucket + 1 < shape_bucket_num(); ++bucket) {
+    const auto &max_input_shape = params_.bucket_max_input_shape[bucket];
+    bool fit = true;
+    for (const auto &it : runtime_input_shape) {
+      auto max_it = max_input_shape.find(it.first);
+      if (max_it == max_input_shape.end()) continue;
+      // the min shapes are the same for all the buckets
+      for (size_t d = 0; d < it.second.size() && d < max_it->second.size();
+           ++d) {
+        if (it.second[d] > max_it->second[d]) {
+          fit = false;
+          break;
+        }
+      }
+      if (!fit) break;
+    }
+    if (fit) break;
   }
-  return infer_context_[predictor_id_per_thread].get();
+  VLOG(4) << "TRT select shape bucket " << bucket << " of "
+          << shape_bucket_num();
+  std::unique_lock<std::mutex> lock(mutex_);
+  shape_bucket_index_[predictor_id_per_thread] = bucket;
 }
 
 void TensorRTEngine::Execute(int batch_size,
                              std::vector<void *> *buffers,
                              cudaStream_t stream) {
   FreshDeviceId();
+  inference::Singleton<inference::tensorrt::TRTEngineManager>::Global()
+      .AddEngineRun();
   auto infer_context = context();
+  void *context_memory{nullptr};
   if (params_.context_memory_sharing) {
-    void *context_memory{nullptr};
     context_memory =
         inference::Singleton<inference::tensorrt::TRTEngineManager>::Global()
             .GetContextMemory(
@@ -133,26 +189,147 @@ void TensorRTEngine::Execute(int batch_size,
     infer_context->setDeviceMemory(context_memory);
   }
 
-  // TODO(wilber): Is cudaGraph has conflict with memory sharing?
-  if (startup_with_cudagraph_ && !cudagraph_inited_) {
-    // Avoid capturing initialization calls by executing the enqueue function at
-    // least once before starting CUDA graph capture.
-    const auto ret = Enqueue(infer_context, buffers, batch_size, stream);
+  if (startup_with_cudagraph_ &&
+      ExecuteCudaGraph(
+          infer_context, context_memory, buffers, batch_size, stream)) {
+    return;
+  }
+  Enqueue(infer_context, buffers, batch_size, stream);
+}
+
+std::string TensorRTEngine::CudaGraphKey(nvinfer1::IExecutionContext *context,
+                                         const void *context_memory,
+                                         const std::vector<void *> &buffers,
+                                         int batch_size) {
+  std::ostringstream os;
+  os << context << "#" << context_memory << "#" << batch_size;
+  for (size_t j = 0; j < buffers.size(); ++j) {
+    if (buffers[j] == nullptr) continue;
+#if IS_TRT_VERSION_GE(8500)
+    auto name = infer_engine_->getIOTensorName(j);
+    if (name == nullptr ||
+        infer_engine_->getTensorIOMode(name) != nvinfer1::TensorIOMode::kINPUT)
+      continue;
+    auto dims = context->getTensorShape(name);
+#else
+    if (!infer_engine_->bindingIsInput(j)) continue;
+    auto dims = context->getBindingDimensions(j);
+#endif
+    os << "#" << j << ":";
+    for (int i = 0; i < dims.nbDims; ++i) {
+      os << dims.d[i] << ",";
+    }
+    // the values of the shape tensors decide the shapes of the outputs
+#if IS_TRT_VERSION_GE(8500)
+    if (infer_engine_->isShapeInferenceIO(name)) {
+      std::unique_lock<std::mutex> values_lock(shape_tensor_mutex_);
+      auto values = shape_tensor_values_.find(predictor_id_per_thread);
+      if (values != shape_tensor_values_.end()) {
+        auto value = values->second.find(name);
+        if (value != values->second.end()) {
+          for (auto v : value->second) os << "v" << v;
+        }
+      }
+    }
+#else
+    int64_t volume = 1;
+    for (int i = 0; i < dims.nbDims; ++i) volume *= dims.d[i];
+    if (infer_engine_->isShapeBinding(j) && volume > 0) {
+      std::vector<int32_t> values(volume);
+      if (context->getShapeBinding(j, values.data())) {
+        for (auto v : values) os << "v" << v;
+      }
+    }
+#endif
+  }
+  return os.str();
+}
+
+int64_t TensorRTEngine::IOTensorSize(nvinfer1::IExecutionContext *context,
+                                     int index,
+                                     int batch_size) {
+#if IS_TRT_VERSION_GE(8500)
+  auto name = infer_engine_->getIOTensorName(index);
+  auto dims = context->getTensorShape(name);
+  auto type = infer_engine_->getTensorDataType(name);
+#else
+  auto dims = context->getBindingDimensions(index);
+  auto type = infer_engine_->getBindingDataType(index);
+#endif
+  int64_t volume = 1;
+  for (int i = 0; i < dims.nbDims; ++i) {
+    if (dims.d[i] < 0) return -1;
+    volume *= dims.d[i];
+  }
+#if IS_TRT_VERSION_LT(8500)
+  // the dims of the implicit batch do not hold the batch
+  if (!with_dynamic_shape()) volume *= batch_size;
+#endif
+  return volume * static_cast<int64_t>(TrtDataTypeSize(type));
+}
+
+bool TensorRTEngine::ExecuteCudaGraph(nvinfer1::IExecutionContext *context,
+                                      const void *context_memory,
+                                      std::vector<void *> *buffers,
+                                      int batch_size,
+                                      cudaStream_t stream) {
+  std::unique_lock<std::mutex> lock(cuda_graph_mutex_);
+  const std::string key =
+      CudaGraphKey(context, context_memory, *buffers, batch_size);
+  auto it = cuda_graph_index_.find(key);
+  if (it != cuda_graph_index_.end()) {
+    cuda_graphs_.splice(cuda_graphs_.begin(), cuda_graphs_, it->second);
+  } else {
+    auto entry = std::make_unique<CudaGraphEntry>();
+    entry->buffers.resize(buffers->size(), nullptr);
+    entry->buffer_sizes.resize(buffers->size(), 0);
+    entry->is_input.resize(buffers->size(), false);
+    for (size_t j = 0; j < buffers->size(); ++j) {
+      if ((*buffers)[j] == nullptr) continue;
+#if IS_TRT_VERSION_GE(8500)
+      auto name = infer_engine_->getIOTensorName(j);
+      if (name == nullptr) continue;
+      entry->is_input[j] = infer_engine_->getTensorIOMode(name) ==
+                           nvinfer1::TensorIOMode::kINPUT;
+      // the shape tensors are read from the host at the capture
+      if (entry->is_input[j] && infer_engine_->isShapeInferenceIO(name)) {
+        entry->buffers[j] = (*buffers)[j];
+        continue;
+      }
+#else
+      entry->is_input[j] = infer_engine_->bindingIsInput(j);
+#endif
+      const int64_t size = IOTensorSize(context, j, batch_size);
+      if (size < 0) {
+        VLOG(3) << "The io tensor " << j << " has a data dependent shape, "
+                << "which is not captured by the CUDA graph.";
+        return false;
+      }
+      entry->allocations.emplace_back(memory::Alloc(
+          phi::GPUPlace(device_id()),
+          std::max<int64_t>(size, 1),
+          phi::Stream(reinterpret_cast<phi::StreamId>(stream))));
+      entry->buffers[j] = entry->allocations.back()->ptr();
+      entry->buffer_sizes[j] = size;
+    }
+
+    // Avoid capturing initialization calls by executing the enqueue function
+    // at least once before starting CUDA graph capture.
+    const auto ret = Enqueue(context, &entry->buffers, batch_size, stream);
     PADDLE_ENFORCE_EQ(
         ret,
         true,
         common::errors::PreconditionNotMet("Trt CudaGraph test run failed."));
     cudaStreamSynchronize(stream);
 
-    cuda_graph_.BeginCapture(stream);
+    entry->graph.BeginCapture(stream);
     // The built TRT engine may contain operations that are not permitted under
     // CUDA graph capture mode. When the stream is capturing, the call may
     // return false if the current CUDA graph capture fails.
-    if (Enqueue(infer_context, buffers, batch_size, stream)) {
-      cuda_graph_.EndCapture(stream);
-      cudagraph_inited_ = true;
+    if (Enqueue(context, &entry->buffers, batch_size, stream)) {
+      entry->graph.EndCapture(stream);
     } else {
-      cuda_graph_.EndCaptureOnError(stream);
+      entry->graph.EndCaptureOnError(stream);
       // Ensure any CUDA error has been cleaned up.
       PADDLE_ENFORCE_GPU_SUCCESS(cudaGetLastError());
       LOG(WARNING) << "The built TensorRT engine contains operations that are "
@@ -160,24 +337,53 @@ void TensorRTEngine::Execute(int batch_size,
                       "CUDA graph capture mode. The specified UseCudaGraph "
                       "flag has been ignored. The inference will be "
                       "launched without using CUDA graph launch.";
-      cudagraph_inited_ = false;
+      startup_with_cudagraph_ = false;
+      cuda_graph_index_.clear();
+      cuda_graphs_.clear();
+      return false;
+    }
+    VLOG(3) << "Capture the TRT CUDA graph of " << key;
+    ++cuda_graph_captures_;
+
+    cuda_graphs_.emplace_front(key, std::move(entry));
+    cuda_graph_index_[key] = cuda_graphs_.begin();
+    const size_t capacity =
+        std::max(FLAGS_trt_cuda_graph_cache_capacity, int32_t{1});
+    while (cuda_graphs_.size() > capacity) {
+      cuda_graph_index_.erase(cuda_graphs_.back().first);
+      cuda_graphs_.pop_back();
     }
-    startup_with_cudagraph_ = false;
   }
 
-  Enqueue(infer_context, buffers, batch_size, stream);
+  auto &entry = *cuda_graphs_.front().second;
+  for (size_t j = 0; j < entry.buffers.size(); ++j) {
+    if (entry.is_input[j] && entry.buffer_sizes[j] > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(entry.buffers[j],
+                                                 (*buffers)[j],
+                                                 entry.buffer_sizes[j],
+                                                 cudaMemcpyDeviceToDevice,
+                                                 stream));
+    }
+  }
+  VLOG(1) << "cuda_graph init success, so we will use cuda graph launch the "
+             "entire graph.";
+  const bool ret = entry.graph.Launch(stream);
+  for (size_t j = 0; j < entry.buffers.size(); ++j) {
+    if (!entry.is_input[j] && entry.buffer_sizes[j] > 0) {
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync((*buffers)[j],
+                                                 entry.buffers[j],
+                                                 entry.buffer_sizes[j],
+                                                 cudaMemcpyDeviceToDevice,
+                                                 stream));
+    }
+  }
+  return ret;
 }
 
 bool TensorRTEngine::Enqueue(nvinfer1::IExecutionContext *context,
                              std::vector<void *> *buffers,
                              int batch_size,
                              cudaStream_t stream) {
-  if (cudagraph_inited_) {
-    VLOG(1) << "cuda_graph init success, so we will use cuda graph launch the "
-               "entire graph.";
-    return cuda_graph_.Launch(stream);
-  }
-
 #if IS_TRT_VERSION_GE(8500)
   for (size_t j = 0; j < buffers->size(); ++j) {
     auto name = context->getEngine().getIOTensorName(j);
@@ -291,6 +497,12 @@ void TensorRTEngine::FreezeNetwork() {
       }
 
       for (auto &t : all_t) {
+        if (!quant_dynamic_range_.count(t) &&
+            params_.activation_ranges.count(t->getName())) {
+          float range = params_.activation_ranges.at(t->getName());
+          t->setDynamicRange(-range, range);
+          quant_dynamic_range_[t] = range;
+        }
         if (!quant_dynamic_range_.count(t)) {
           VLOG(3) << "We are in trt int8 mode(not calibration), scale not set"
                   << " for tensor " << t->getName()
@@ -326,8 +538,23 @@ void TensorRTEngine::FreezeNetwork() {
 
   if (with_dynamic_shape()) {
     LOG(INFO) << "Run Paddle-TRT Dynamic Shape mode.";
-    for (int i = 0; i < max_profile_num_; i++) {
+    const int bucket_num = shape_bucket_num();
+    for (int i = 0; i < max_profile_num_ * bucket_num; i++) {
+      // the bucket of the profile, or the whole range for the last one
+      const int bucket = i % bucket_num;
+      auto &bucket_max_input_shape =
+          bucket + 1 < bucket_num ? params_.bucket_max_input_shape[bucket]
+                                  : max_input_shape();
+      auto &bucket_optim_input_shape =
+          bucket + 1 < bucket_num ? params_.bucket_optim_input_shape[bucket]
+                                  : optim_input_shape();
       for (auto &input : min_input_shape()) {
+        auto &max_shape = bucket_max_input_shape.count(input.first)
+                              ? bucket_max_input_shape[input.first]
+                              : max_input_shape()[input.first];
+        auto &optim_shape = bucket_optim_input_shape.count(input.first)
+                                ? bucket_optim_input_shape[input.first]
+                                : optim_input_shape()[input.first];
 #if IS_TRT_VERSION_LT(7100)
         // trt6/trt7011 will check all_of input > 0
         if (!(std::all_of(input.second.begin(),
@@ -344,8 +571,8 @@ void TensorRTEngine::FreezeNetwork() {
 #endif
         VLOG(4) << "TRT dynamic_shape set " << input.first
                 << " min: " << Vec2Str(input.second)
-                << ", max: " << Vec2Str(max_input_shape()[input.first])
-                << ", opt: " << Vec2Str(optim_input_shape()[input.first]);
+                << ", max: " << Vec2Str(max_shape)
+                << ", opt: " << Vec2Str(optim_shape) << " in profile " << i;
 
         optim_profiles_[i]->setDimensions(
             input.first.c_str(),
@@ -354,11 +581,11 @@ void TensorRTEngine::FreezeNetwork() {
         optim_profiles_[i]->setDimensions(
             input.first.c_str(),
             nvinfer1::OptProfileSelector::kMAX,
-            Vec2TRT_Dims(max_input_shape()[input.first], input.first, true));
+            Vec2TRT_Dims(max_shape, input.first, true));
         optim_profiles_[i]->setDimensions(
             input.first.c_str(),
             nvinfer1::OptProfileSelector::kOPT,
-            Vec2TRT_Dims(optim_input_shape()[input.first], input.first, true));
+            Vec2TRT_Dims(optim_shape, input.first, true));
       }
 
       for (int input_id = 0; input_id < network()->getNbInputs(); input_id++) {
@@ -421,6 +648,16 @@ void TensorRTEngine::FreezeNetwork() {
   }
 #endif
 
+  if (params_.refittable) {
+#if IS_TRT_VERSION_GE(8500)
+    infer_builder_config_->setFlag(nvinfer1::BuilderFlag::kREFIT);
+    SetRefitWeightsName();
+#else
+    LOG(WARNING) << "Refitting the TRT engine needs TensorRT 8.5 or later, "
+                    "so the engine is built without refit.";
+#endif
+  }
+
 #if IS_TRT_VERSION_LT(8000)
   infer_engine_.reset(infer_builder_->buildEngineWithConfig(
       *network(), *infer_builder_config_));
@@ -454,10 +691,11 @@ void TensorRTEngine::FreezeNetwork() {
   binding_num_ = infer_engine_->getNbBindings();
 #endif
   // reset status for dynamic shape clone
-  if (max_profile_num_ > 1) {
+  if (max_profile_num_ > 1 || shape_bucket_num() > 1) {
     infer_context_.clear();
     cur_profile_num_ = 0;
   }
+  ClearCudaGraphs();
   // for engine context memory sharing
   if (params_.context_memory_sharing) {
     inference::Singleton<inference::tensorrt::TRTEngineManager>::Global()
@@ -671,6 +909,19 @@ void TensorRTEngine::Deserialize(const std::string &engine_serialized_data) {
 #else
   binding_num_ = infer_engine_->getNbBindings();
 #endif
+  ClearCudaGraphs();
+  // the cached engine may be built with other shape buckets
+  if (shape_bucket_num() > 1) {
+    PADDLE_ENFORCE_EQ(
+        infer_engine_->getNbOptimizationProfiles(),
+        max_profile_num_ * shape_bucket_num(),
+        common::errors::InvalidArgument(
+            "The serialized TRT engine has %d optimization profiles, but %d "
+            "are expected for %d shape buckets.",
+            infer_engine_->getNbOptimizationProfiles(),
+            max_profile_num_ * shape_bucket_num(),
+            shape_bucket_num()));
+  }
   // for engine context memory sharing
   if (params_.context_memory_sharing) {
     inference::Singleton<inference::tensorrt::TRTEngineManager>::Global()
@@ -751,6 +1002,7 @@ TensorRTEngine::Weight TensorRTEngine::GetFp16TrtWeight(
     weight.SetDataType(weight_tensor.dtype());
     weight.SetValues(weight_map[name_with_suffix]->data());
   }
+  RecordRefitWeight(name, "fp16", weight.get());
   name_suffix_counter += 1;
   return weight;
 }
@@ -824,6 +1076,7 @@ TensorRTEngine::Weight TensorRTEngine::GetFp32TrtWeight(
     weight.SetDataType(weight_tensor.dtype());
     weight.SetValues(weight_map[name_with_suffix]->data());
   }
+  RecordRefitWeight(name, "fp32", weight.get());
   name_suffix_counter += 1;
   return weight;
 }
@@ -892,10 +1145,145 @@ TensorRTEngine::Weight TensorRTEngine::GetTrtWeight(
     }
   }
 
+  RecordRefitWeight(name, "trt", weight.get());
   name_suffix_counter += 1;
   return weight;
 }
 
+void TensorRTEngine::RecordRefitWeight(const std::string &name,
+                                       const std::string &kind,
+                                       const nvinfer1::Weights &weight) {
+  if (!params_.refittable || weight.values == nullptr || weight.count <= 0) {
+    return;
+  }
+  refit_weights_.push_back({name, kind, weight, HashWeightValues(weight)});
+}
+
+void TensorRTEngine::SetRefitWeightsName() {
+#if IS_TRT_VERSION_GE(8500)
+  std::unordered_map<std::string, int> name_count;
+  std::unordered_set<const void *> named_values;
+  int named_num = 0;
+  for (auto &refit_weight : refit_weights_) {
+    // the weights changed by the converters can not be refit from the
+    // parameters, so they are left unnamed
+    if (HashWeightValues(refit_weight.weight) != refit_weight.hash ||
+        !named_values.insert(refit_weight.weight.values).second) {
+      continue;
+    }
+    const std::string key = refit_weight.name + "#" + refit_weight.kind;
+    const std::string trt_name = key + "#" + std::to_string(name_count[key]++);
+    // the weights only used by the plugins are not in the network
+    if (network()->setWeightsName(refit_weight.weight, trt_name.c_str())) {
+      ++named_num;
+    }
+  }
+  VLOG(3) << "Name " << named_num << " of the " << refit_weights_.size()
+          << " weights to refit in the TRT network.";
+#endif
+  refit_weights_.clear();
+}
+
+void TensorRTEngine::Refit(const framework::Scope &scope) {
+#if IS_TRT_VERSION_GE(8500)
+  PADDLE_ENFORCE_NOT_NULL(
+      infer_engine_,
+      common::errors::PreconditionNotMet(
+          "The TRT engine should be built before it is refit."));
+  PADDLE_ENFORCE_EQ(
+      params_.refittable && infer_engine_->isRefittable(),
+      true,
+      common::errors::PreconditionNotMet(
+          "The TRT engine is not refittable, please build it with "
+          "AnalysisConfig::EnableTensorRtRefit."));
+  infer_ptr<nvinfer1::IRefitter> refitter(
+      createInferRefitter(infer_engine_.get(), &logger_));
+  PADDLE_ENFORCE_NOT_NULL(
+      refitter,
+      common::errors::Fatal("Create the TRT refitter failed."));
+
+  const int weights_num = refitter->getAllWeights(0, nullptr);
+  std::vector<const char *> weights_names(weights_num);
+  refitter->getAllWeights(weights_num, weights_names.data());
+
+  // The weights converted for the refit are released after it, and the ones
+  // kept for the build are restored.
+  std::unordered_map<std::string, std::unique_ptr<phi::DenseTensor>>
+      build_weight_map;
+  weight_map.swap(build_weight_map);
+  DEFINE_PADDLE_SCOPE_GUARD([&] {
+    weight_map.swap(build_weight_map);
+    refit_weights_.clear();
+  });
+
+  int refit_num = 0;
+  for (auto *weights_name : weights_names) {
+    if (weights_name == nullptr) continue;
+    const std::string trt_name(weights_name);
+    // the names of the unnamed weights are given by TensorRT
+    auto index_pos = trt_name.rfind('#');
+    if (index_pos == std::string::npos || index_pos == 0) continue;
+    auto kind_pos = trt_name.rfind('#', index_pos - 1);
+    if (kind_pos == std::string::npos) continue;
+    const std::string name = trt_name.substr(0, kind_pos);
+    const std::string kind =
+        trt_name.substr(kind_pos + 1, index_pos - kind_pos - 1);
+
+    auto *var = scope.FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(
+        var,
+        common::errors::NotFound(
+            "The parameter %s to refit the TRT engine is not in the scope.",
+            name));
+    const auto &tensor = var->Get<phi::DenseTensor>();
+    Weight weight;
+    if (kind == "fp16") {
+      weight = GetFp16TrtWeight(name, tensor);
+    } else if (kind == "fp32") {
+      weight = GetFp32TrtWeight(name, tensor);
+    } else if (kind == "trt") {
+      weight = GetTrtWeight(name, tensor);
+    } else {
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(
+        refitter->setNamedWeights(trt_name.c_str(), weight.get()),
+        true,
+        common::errors::InvalidArgument(
+            "Refit the TRT weights %s failed, the parameter %s should have "
+            "the same shape and data type as the one the engine is built "
+            "with.",
+            trt_name,
+            name));
+    ++refit_num;
+  }
+
+  const int missing_num = refitter->getMissingWeights(0, nullptr);
+  if (missing_num > 0) {
+    std::vector<const char *> missing_names(missing_num);
+    refitter->getMissingWeights(missing_num, missing_names.data());
+    std::string missing;
+    for (auto *missing_name : missing_names) {
+      missing += std::string(missing_name == nullptr ? "" : missing_name) + " ";
+    }
+    PADDLE_THROW(common::errors::PreconditionNotMet(
+        "The TRT engine can not be refit without the weights [ %s], which "
+        "are not converted from the parameters.",
+        missing));
+  }
+  PADDLE_ENFORCE_EQ(
+      refitter->refitCudaEngine(),
+      true,
+      common::errors::Fatal("Refit the TRT engine failed."));
+  // the graphs may have captured the old weights
+  ClearCudaGraphs();
+  VLOG(1) << "Refit " << refit_num << " weights of the TRT engine.";
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Refitting the TRT engine needs TensorRT 8.5 or later."));
+#endif
+}
+
 nvinfer1::IPluginV2Layer *TensorRTEngine::AddPlugin(
     nvinfer1::ITensor *const *inputs,
     int num_inputs,
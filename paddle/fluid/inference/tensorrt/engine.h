@@ -14,7 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -67,7 +70,7 @@ class TrtCudaGraph {
   }
 
   bool Launch(cudaStream_t stream) {
-    return cudaGraphLaunch(cuda_graph_exec_, stream);
+    return cudaGraphLaunch(cuda_graph_exec_, stream) == cudaSuccess;
   }
 
   void EndCapture(cudaStream_t stream) {
@@ -152,10 +155,23 @@ class TensorRTEngine {
     ShapeMapType min_shape_tensor;
     ShapeMapType max_shape_tensor;
     ShapeMapType optim_shape_tensor;
+    // The max and opt input shapes of the optimization profiles tuned for the
+    // smaller inputs, which share the min input shapes and the shape tensor
+    // ranges above. The whole range is the profile after the last of them.
+    std::vector<ShapeMapType> bucket_max_input_shape;
+    std::vector<ShapeMapType> bucket_optim_input_shape;
 
     bool use_inspector{false};
     std::string engine_info_path{""};
 
+    // Build the engine with the weights named after the parameters, so that
+    // they can be refit from the scope later without a rebuild.
+    bool refittable{false};
+
+    // The int8 dynamic ranges of the tensors by name, which are collected by
+    // the native forwards instead of the TensorRT calibration.
+    std::unordered_map<std::string, float> activation_ranges;
+
     //
     // From tensorrt_subgraph_pass, only used for OpConverter.
     //
@@ -235,9 +251,28 @@ class TensorRTEngine {
   nvinfer1::IExecutionContext* context();
 
   int GetBindingsOffset() {
-    return (binding_num_ / max_profile_num_) * GetProfileIndex();
+#if IS_TRT_VERSION_GE(8500)
+    // The io tensors are bound by their names, which are shared by all the
+    // profiles.
+    return 0;
+#else
+    return (binding_num_ / (max_profile_num_ * shape_bucket_num())) *
+           GetProfileIndex();
+#endif
+  }
+
+  // The number of optimization profiles of each execution context, the last
+  // of which covers the whole dynamic shape range.
+  int shape_bucket_num() const {
+    return params_.with_dynamic_shape
+               ? static_cast<int>(params_.bucket_max_input_shape.size()) + 1
+               : 1;
   }
 
+  // Selects the first shape bucket whose range holds runtime_input_shape for
+  // the following context() of this thread, or the whole range if none does.
+  void SelectShapeBucket(const ShapeMapType& runtime_input_shape);
+
   int GetNbBindings() { return binding_num_; }
 
   void ResetContext() {
@@ -246,8 +281,14 @@ class TensorRTEngine {
         common::errors::InvalidArgument(
             "You should build engine first and then set the context."));
     std::unique_lock<std::mutex> lock(mutex_);
-    infer_context_[predictor_id_per_thread].reset(nullptr);
     infer_context_.erase(predictor_id_per_thread);
+    shape_bucket_index_.erase(predictor_id_per_thread);
+    {
+      std::unique_lock<std::mutex> values_lock(shape_tensor_mutex_);
+      shape_tensor_values_.erase(predictor_id_per_thread);
+    }
+    // the graphs are captured again for the new contexts
+    ClearCudaGraphs();
     cur_profile_num_ = 0;
   }
 
@@ -359,6 +400,13 @@ class TensorRTEngine {
     }
   }
 
+  bool refittable() const { return params_.refittable; }
+
+  // Refits the weights of the engine by the parameters of the same names in
+  // scope, which should have the same shapes and data types as the ones the
+  // engine is built with. It should not run together with Execute.
+  void Refit(const framework::Scope& scope);
+
   // NOTE: The func bellow was modified to adapt the dynamic shape.
   // Initialize the inference network, so that TensorRT layers can add to this
   // network.
@@ -551,15 +599,80 @@ class TensorRTEngine {
 
   int device_id() { return params_.device_id; }
 
+  // Records a weight converted from the parameter name by kind, which is
+  // named in the network by FreezeNetwork if it is still the same then.
+  void RecordRefitWeight(const std::string& name,
+                         const std::string& kind,
+                         const nvinfer1::Weights& weight);
+
+  // Names the recorded weights in the network as "name#kind#index".
+  void SetRefitWeightsName();
+
+  // Runs the context by the CUDA graph captured for its input shapes, and
+  // captures one if there is not. Returns false if the graph can not be used.
+  bool ExecuteCudaGraph(nvinfer1::IExecutionContext* context,
+                        const void* context_memory,
+                        std::vector<void*>* buffers,
+                        int batch_size,
+                        cudaStream_t stream);
+
+  // Keeps the values of the input shape tensor of name for the context of
+  // this thread, and returns their address to bind. TensorRT reads them from
+  // the host at the enqueue, so they must outlive the binding.
+  int32_t* SetShapeTensorValues(const std::string& name,
+                                const std::vector<int32_t>& values) {
+    std::unique_lock<std::mutex> lock(shape_tensor_mutex_);
+    auto& stored = shape_tensor_values_[predictor_id_per_thread][name];
+    stored = values;
+    return stored.data();
+  }
+
+  // The number of CUDA graphs captured so far, including the evicted ones.
+  int64_t CudaGraphCaptureNum() {
+    std::unique_lock<std::mutex> lock(cuda_graph_mutex_);
+    return cuda_graph_captures_;
+  }
+
+  size_t CudaGraphNum() {
+    std::unique_lock<std::mutex> lock(cuda_graph_mutex_);
+    return cuda_graphs_.size();
+  }
+
+  std::string CudaGraphKey(nvinfer1::IExecutionContext* context,
+                           const void* context_memory,
+                           const std::vector<void*>& buffers,
+                           int batch_size);
+
+  // The bytes of the io tensor of binding index, or -1 if its shape is not
+  // known yet.
+  int64_t IOTensorSize(nvinfer1::IExecutionContext* context,
+                       int index,
+                       int batch_size);
+
+  void ClearCudaGraphs() {
+    std::unique_lock<std::mutex> lock(cuda_graph_mutex_);
+    cuda_graph_index_.clear();
+    cuda_graphs_.clear();
+  }
+
   int GetProfileIndex() {
-    if (max_profile_num_ > 1) {
+    if (max_profile_num_ > 1 || shape_bucket_num() > 1) {
       std::unique_lock<std::mutex> lock(mutex_);
-      return profile_index_[predictor_id_per_thread];
+      int index =
+          max_profile_num_ > 1 ? profile_index_[predictor_id_per_thread] : 0;
+      return index * shape_bucket_num() + GetShapeBucketIndex();
     } else {
       return 0;
     }
   }
 
+  // Should be called with mutex_ held.
+  int GetShapeBucketIndex() {
+    auto it = shape_bucket_index_.find(predictor_id_per_thread);
+    return it == shape_bucket_index_.end() ? shape_bucket_num() - 1
+                                           : it->second;
+  }
+
  private:
   //
   // Construction parameters.
@@ -573,6 +686,7 @@ class TensorRTEngine {
   int max_profile_num_{1};
   int cur_profile_num_{0};
   std::unordered_map<PredictorID, int> profile_index_;
+  std::unordered_map<PredictorID, int> shape_bucket_index_;
 
   nvinfer1::ILogger& logger_;
 
@@ -589,15 +703,48 @@ class TensorRTEngine {
   infer_ptr<nvinfer1::INetworkDefinition> infer_network_;
   infer_ptr<nvinfer1::IRuntime> infer_runtime_;
   infer_ptr<nvinfer1::ICudaEngine> infer_engine_;
-  std::unordered_map<PredictorID, infer_ptr<nvinfer1::IExecutionContext>>
+  // The execution contexts of each predictor, one for each shape bucket.
+  std::unordered_map<PredictorID,
+                     std::vector<infer_ptr<nvinfer1::IExecutionContext>>>
       infer_context_;
   infer_ptr<nvinfer1::IHostMemory> ihost_memory_;
   std::unordered_map<nvinfer1::ITensor*, float> quant_dynamic_range_;
 
+  // The weights converted from the parameters for a refittable engine, with
+  // the hashes of their values when they are converted.
+  struct RefitWeight {
+    std::string name;
+    std::string kind;
+    nvinfer1::Weights weight;
+    size_t hash;
+  };
+  std::vector<RefitWeight> refit_weights_;
+
   // cudagraph related
-  TrtCudaGraph cuda_graph_;
-  bool cudagraph_inited_{false};
+  // A CUDA graph captured for the input shapes of a context, whose io tensors
+  // are bound to the buffers owned by it. The inputs are copied into the
+  // buffers before a launch and the outputs are copied out after it.
+  struct CudaGraphEntry {
+    TrtCudaGraph graph;
+    std::vector<void*> buffers;
+    std::vector<int64_t> buffer_sizes;
+    std::vector<bool> is_input;
+    std::vector<phi::Allocator::AllocationPtr> allocations;
+  };
+  using CudaGraphList =
+      std::list<std::pair<std::string, std::unique_ptr<CudaGraphEntry>>>;
+  // most recently used first, bounded by FLAGS_trt_cuda_graph_cache_capacity
+  CudaGraphList cuda_graphs_;
+  std::unordered_map<std::string, CudaGraphList::iterator> cuda_graph_index_;
+  std::mutex cuda_graph_mutex_;
+  int64_t cuda_graph_captures_{0};
   bool startup_with_cudagraph_{false};
+  // the values of the input shape tensors bound to the contexts of each
+  // predictor, which the CUDA graphs are keyed by.
+  std::unordered_map<PredictorID,
+                     std::unordered_map<std::string, std::vector<int32_t>>>
+      shape_tensor_values_;
+  std::mutex shape_tensor_mutex_;
 
   // Used for convert weight into Itensor
   const framework::Scope* scope_{nullptr};
@@ -726,6 +873,33 @@ class TRTEngineManager {
     }
   }
 
+  // Tracks the engines built in the background with
+  // FLAGS_trt_async_engine_build, so WaitAsyncBuilds blocks until all the
+  // started builds finished.
+  void BeginAsyncBuild() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_async_builds_;
+  }
+
+  void EndAsyncBuild() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --num_async_builds_;
+    }
+    async_builds_cv_.notify_all();
+  }
+
+  void WaitAsyncBuilds() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    async_builds_cv_.wait(lock, [this] { return num_async_builds_ == 0; });
+  }
+
+  // Counts the executions of all the engines, which tells whether a subgraph
+  // ran on TensorRT or on the native kernels.
+  void AddEngineRun() { ++num_engine_runs_; }
+
+  int64_t NumEngineRuns() const { return num_engine_runs_; }
+
  private:
   size_t GetAlignmentSize(const phi::GPUPlace& place) {
     const auto& prop = platform::GetDeviceProperties(place.GetDeviceId());
@@ -737,6 +911,9 @@ class TRTEngineManager {
   }
 
   mutable std::mutex mutex_;
+  std::condition_variable async_builds_cv_;
+  int num_async_builds_{0};
+  std::atomic<int64_t> num_engine_runs_{0};
   size_t max_ctx_mem_size_{0};
   std::unordered_map<PredictorID, AllocationPtr> context_memorys_;
   std::unordered_map<std::string, std::unique_ptr<TensorRTEngine>> engines_;
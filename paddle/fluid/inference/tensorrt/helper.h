@@ -72,6 +72,11 @@ static nvinfer1::IRuntime* createInferRuntime(nvinfer1::ILogger* logger) {
       dy::createInferRuntime_INTERNAL(logger, NV_TENSORRT_VERSION));
 }
 #if IS_TRT_VERSION_GE(6000)
+static nvinfer1::IRefitter* createInferRefitter(nvinfer1::ICudaEngine* engine,
+                                               nvinfer1::ILogger* logger) {
+  return static_cast<nvinfer1::IRefitter*>(dy::createInferRefitter_INTERNAL(
+      engine, logger, NV_TENSORRT_VERSION));
+}
 static nvinfer1::IPluginRegistry* GetPluginRegistry() {
   return static_cast<nvinfer1::IPluginRegistry*>(dy::getPluginRegistry());
 }
@@ -235,6 +240,33 @@ static inline nvinfer1::DataType PhiType2NvType(phi::DataType type) {
   return nv_type;
 }
 
+static inline size_t TrtDataTypeSize(nvinfer1::DataType type) {
+  switch (type) {
+    case nvinfer1::DataType::kFLOAT:
+    case nvinfer1::DataType::kINT32:
+      return 4;
+    case nvinfer1::DataType::kHALF:
+      return 2;
+    case nvinfer1::DataType::kINT8:
+#if IS_TRT_VERSION_GE(7000)
+    case nvinfer1::DataType::kBOOL:
+#endif
+      return 1;
+#if IS_TRT_VERSION_GE(9000)
+    case nvinfer1::DataType::kBF16:
+      return 2;
+#endif
+#if IS_TRT_VERSION_GE(10000)
+    case nvinfer1::DataType::kINT64:
+      return 8;
+#endif
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "The size of TensorRT data type %d is unknown.",
+          static_cast<int>(type)));
+  }
+}
+
 using FluidDT = paddle::framework::proto::VarType_Type;
 using TRT_DT = nvinfer1::DataType;
 static TRT_DT FluidDataType2TRT(FluidDT type) {
@@ -15,6 +15,7 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "paddle/common/flags.h"
 #include "paddle/common/layout.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
@@ -28,6 +29,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/phi/common/float16.h"
 
+COMMON_DECLARE_int32(trt_cuda_graph_cache_capacity);
+
 using float16 = phi::dtype::float16;
 namespace paddle::inference::tensorrt {
 
@@ -183,6 +186,87 @@ TEST_F(TensorRTDynamicShapeValueEngineTest, test_trt_dynamic_shape_value) {
   return;
 }
 
+TEST_F(TensorRTDynamicShapeValueEngineTest, test_trt_cuda_graph_per_shape) {
+  const int32_t capacity = FLAGS_trt_cuda_graph_cache_capacity;
+  FLAGS_trt_cuda_graph_cache_capacity = 2;
+  auto *x = engine_->DeclareInput(
+      "input", nvinfer1::DataType::kFLOAT, nvinfer1::Dims2{-1, 32});
+  nvinfer1::Dims shape_dim;
+  shape_dim.nbDims = 1;
+  shape_dim.d[0] = 3;
+  auto *shape =
+      engine_->DeclareInput("shape", nvinfer1::DataType::kINT32, shape_dim);
+  auto layer = engine_->network()->addShuffle(*x);
+  layer->setInput(1, *shape);
+  engine_->DeclareOutput(layer, 0, "y");
+  engine_->FreezeNetwork();
+  engine_->SetAllNodesLowerToTrt(true);
+
+  std::vector<float> x_v(8 * 32);
+  for (int i = 0; i < 8 * 32; i++) {
+    x_v[i] = i;
+  }
+  auto run = [&](const std::vector<int> &shape_v) {
+    std::vector<float> input(x_v);
+    // the inputs of each run differ, so a replay must read the new ones
+    input[0] = static_cast<float>(shape_v[1]);
+    PrepareInputOutput(input, shape_v);
+    PrepareShapeInput(shape_v);
+    std::vector<void *> buffers(3);
+    buffers[0] = input_.mutable_data<float>(ctx_->GetPlace());
+    buffers[1] = shape_.mutable_data<int>(ctx_->GetPlace());
+    buffers[2] = output_.mutable_data<float>(ctx_->GetPlace());
+#if IS_TRT_VERSION_GE(8500)
+    engine_->context()->setInputShape("input", nvinfer1::Dims2{8, 32});
+    // the values are copied, so the vector may go away before the run
+    engine_->context()->setTensorAddress(
+        "shape",
+        engine_->SetShapeTensorValues("shape", std::vector<int>(shape_v)));
+#else
+    engine_->context()->setBindingDimensions(0, nvinfer1::Dims2{8, 32});
+    engine_->context()->setBindingDimensions(1, shape_dim);
+    engine_->context()->setInputShapeBinding(1, shape_v.data());
+#endif
+    engine_->Execute(-1, &buffers, ctx_->stream());
+    cudaStreamSynchronize(ctx_->stream());
+
+    std::vector<float> y_cpu;
+    GetOutput(&y_cpu);
+    ASSERT_EQ(y_cpu.size(), x_v.size());
+    EXPECT_EQ(y_cpu[0], shape_v[1]);
+    EXPECT_EQ(y_cpu[255], 255);
+#if IS_TRT_VERSION_GE(8500)
+    auto dims = engine_->context()->getTensorShape("y");
+#else
+    auto dims = engine_->context()->getBindingDimensions(2);
+#endif
+    ASSERT_EQ(dims.nbDims, 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(dims.d[i], shape_v[i]);
+    }
+  };
+
+  run({8, 8, 4});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 1);
+  run({8, 8, 4});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 1);
+  // another shape value is captured into another graph
+  run({8, 4, 8});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 2);
+  EXPECT_EQ(engine_->CudaGraphNum(), 2UL);
+  // {8, 8, 4} is the most recently used now, so {8, 4, 8} is evicted
+  run({8, 8, 4});
+  run({4, 8, 8});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 3);
+  EXPECT_EQ(engine_->CudaGraphNum(), 2UL);
+  run({8, 8, 4});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 3);
+  run({8, 4, 8});
+  EXPECT_EQ(engine_->CudaGraphCaptureNum(), 4);
+  EXPECT_EQ(engine_->CudaGraphNum(), 2UL);
+  FLAGS_trt_cuda_graph_cache_capacity = capacity;
+}
+
 class TensorRTDynamicEngineTest : public ::testing::Test {
  protected:
   TensorRTDynamicEngineTest() : engine_(nullptr), ctx_(nullptr) {}
@@ -0,0 +1,592 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// paddle_infer_bench loads a model with the inference config and sweeps the
+// batch size, the CPU math threads and the number of the cloned predictors
+// running at once. For each case it reports the QPS, the p50/p90/p99 latency
+// of a run and the GPU memory, e.g.
+//
+//   paddle_infer_bench --model_file=inference.pdmodel
+//       --params_file=inference.pdiparams --batch_sizes=1,8,32
+//       --concurrency=1,4 --use_gpu --output_json=result.json
+//
+// The latency of a run is end to end, from the copy of the inputs to the
+// device to the copy of the outputs to the host.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/memory/stats.h"
+
+PD_DEFINE_string(model_dir, "", "The dir of the model, or use model_file");
+PD_DEFINE_string(model_file, "", "The program file of the model");
+PD_DEFINE_string(params_file, "", "The params file of the model");
+PD_DEFINE_string(batch_sizes, "1", "The batch sizes to sweep, e.g. 1,8,32");
+PD_DEFINE_string(threads, "1", "The CPU math threads to sweep, e.g. 1,4");
+PD_DEFINE_string(concurrency,
+                 "1",
+                 "The numbers of the predictors running at once to sweep, "
+                 "each one cloned from the first one, e.g. 1,2,4");
+PD_DEFINE_int32(warmup, 10, "The runs of each predictor before the timing");
+PD_DEFINE_int32(iterations, 100, "The timed runs of each predictor");
+PD_DEFINE_string(input_file,
+                 "",
+                 "The recorded inputs written by SerializePDTensorsToFile, "
+                 "the batch sizes are the recorded ones then. The inputs "
+                 "are synthetic if empty");
+PD_DEFINE_string(input_shapes,
+                 "",
+                 "The shapes of the synthetic inputs for the dims unknown "
+                 "in the model, e.g. x:-1x3x224x224;y:-1x16, -1 is the "
+                 "batch size. The unknown dims are 1 by default, but the "
+                 "first one being the batch size");
+PD_DEFINE_bool(use_gpu, false, "Run on the GPU");
+PD_DEFINE_int32(gpu_id, 0, "The GPU to run on");
+PD_DEFINE_int32(gpu_memory_mb, 256, "The initial GPU memory pool in MB");
+PD_DEFINE_bool(use_trt, false, "Run the subgraphs by TensorRT");
+PD_DEFINE_string(trt_precision,
+                 "fp32",
+                 "The TensorRT precision, fp32, fp16 or int8");
+PD_DEFINE_string(trt_shape_range_info,
+                 "",
+                 "The shape range info of the dynamic shape of TensorRT");
+PD_DEFINE_bool(use_onednn, false, "Run the CPU kernels by oneDNN");
+PD_DEFINE_bool(use_cinn, false, "Compile the model by CINN");
+PD_DEFINE_bool(ir_optim, true, "Optimize the program of the model");
+PD_DEFINE_string(output_json, "", "The file of the results in JSON");
+
+namespace paddle {
+namespace inference {
+namespace bench {
+
+using paddle_infer::Config;
+using paddle_infer::DataType;
+using paddle_infer::Predictor;
+
+// The host data of an input, copied to the predictor before each run.
+struct Input {
+  std::string name;
+  std::vector<int> shape;
+  DataType dtype{DataType::FLOAT32};
+  std::vector<char> data;
+};
+
+struct Case {
+  int batch_size{0};
+  int threads{0};
+  int concurrency{0};
+};
+
+struct Result {
+  Case config;
+  int64_t runs{0};
+  double seconds{0};
+  double qps{0};
+  double samples_per_second{0};
+  double mean_ms{0};
+  double p50_ms{0};
+  double p90_ms{0};
+  double p99_ms{0};
+  double max_ms{0};
+  int64_t gpu_allocated{0};
+  int64_t gpu_reserved{0};
+  int64_t gpu_peak_reserved{0};
+};
+
+void Fail(const std::string& message) {
+  std::cerr << "paddle_infer_bench: " << message << std::endl;
+  std::exit(1);
+}
+
+std::vector<int> ParseInts(const std::string& flag, const std::string& str) {
+  std::vector<int> values;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) continue;
+    int value = std::atoi(item.c_str());
+    if (value <= 0) Fail("invalid value " + item + " of --" + flag);
+    values.push_back(value);
+  }
+  if (values.empty()) Fail("--" + flag + " is empty");
+  return values;
+}
+
+// x:-1x3x224x224;y:-1x16
+std::map<std::string, std::vector<int64_t>> ParseShapes(
+    const std::string& str) {
+  std::map<std::string, std::vector<int64_t>> shapes;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ';')) {
+    if (item.empty()) continue;
+    auto pos = item.rfind(':');
+    if (pos == std::string::npos) Fail("invalid shape " + item);
+    std::vector<int64_t> shape;
+    std::stringstream dims(item.substr(pos + 1));
+    std::string dim;
+    while (std::getline(dims, dim, 'x')) {
+      shape.push_back(std::atoll(dim.c_str()));
+    }
+    shapes[item.substr(0, pos)] = shape;
+  }
+  return shapes;
+}
+
+size_t SizeOf(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT64:
+    case DataType::INT64:
+      return 8;
+    case DataType::FLOAT32:
+    case DataType::INT32:
+      return 4;
+    case DataType::FLOAT16:
+    case DataType::BFLOAT16:
+      return 2;
+    case DataType::UINT8:
+    case DataType::INT8:
+    case DataType::BOOL:
+      return 1;
+    default:
+      Fail("unsupported dtype " + std::to_string(dtype));
+  }
+  return 0;
+}
+
+// The float inputs are uniform in [0, 1), and the others are 0, which are
+// valid ids of the embeddings.
+template <typename T>
+void FillUniform(Input* input, int64_t numel) {
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  auto* data = reinterpret_cast<T*>(input->data.data());
+  for (int64_t i = 0; i < numel; ++i) data[i] = static_cast<T>(dist(engine));
+}
+
+std::vector<Input> SyntheticInputs(Predictor* predictor, int batch_size) {
+  auto overrides = ParseShapes(FLAGS_input_shapes);
+  auto model_shapes = predictor->GetInputTensorShape();
+  auto dtypes = predictor->GetInputTypes();
+  std::vector<Input> inputs;
+  for (const auto& name : predictor->GetInputNames()) {
+    auto it = overrides.find(name);
+    auto shape = it != overrides.end() ? it->second : model_shapes[name];
+    Input input;
+    input.name = name;
+    input.dtype = dtypes[name];
+    int64_t numel = 1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+      int64_t dim = shape[i];
+      if (dim < 0) {
+        // -1 of the overrides is the batch size, and of the model only the
+        // first one
+        bool is_batch = it != overrides.end() || i == 0;
+        dim = is_batch ? batch_size : 1;
+      }
+      input.shape.push_back(static_cast<int>(dim));
+      numel *= dim;
+    }
+    input.data.assign(numel * SizeOf(input.dtype), 0);
+    switch (input.dtype) {
+      case DataType::FLOAT32:
+        FillUniform<float>(&input, numel);
+        break;
+      case DataType::FLOAT64:
+        FillUniform<double>(&input, numel);
+        break;
+      case DataType::FLOAT16:
+        FillUniform<phi::dtype::float16>(&input, numel);
+        break;
+      case DataType::BFLOAT16:
+        FillUniform<phi::dtype::bfloat16>(&input, numel);
+        break;
+      default:
+        break;
+    }
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+template <typename T>
+void Read(std::istream& is, T* value) {
+  is.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+// Reads the tensors as DeserializePDTensorsToStream, which is not exported
+// by the inference library.
+std::vector<Input> RecordedInputs(const std::string& path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.is_open()) Fail("cannot open " + path);
+  uint32_t version = 0;
+  uint64_t num = 0;
+  Read(is, &version);
+  Read(is, &num);
+  std::vector<Input> inputs(num);
+  for (auto& input : inputs) {
+    uint64_t name_bytes = 0;
+    Read(is, &version);
+    Read(is, &name_bytes);
+    input.name.resize(name_bytes);
+    is.read(&input.name[0], static_cast<std::streamsize>(name_bytes));
+    uint64_t lod_level = 0;
+    Read(is, &lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size = 0;
+      Read(is, &size);
+      is.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+    }
+    size_t dims = 0;
+    Read(is, &dims);
+    input.shape.resize(dims);
+    is.read(reinterpret_cast<char*>(input.shape.data()),
+            static_cast<std::streamsize>(sizeof(int) * dims));
+    int32_t dtype = 0;
+    uint64_t length = 0;
+    Read(is, &dtype);
+    Read(is, &length);
+    input.dtype = static_cast<DataType>(dtype);
+    input.data.resize(length);
+    is.read(input.data.data(), static_cast<std::streamsize>(length));
+    if (!is) Fail("truncated inputs in " + path);
+  }
+  return inputs;
+}
+
+template <typename T>
+void CopyTo(paddle_infer::Tensor* tensor, const Input& input) {
+  tensor->CopyFromCpu(reinterpret_cast<const T*>(input.data.data()));
+}
+
+template <typename T>
+void CopyFrom(const paddle_infer::Tensor* tensor, std::vector<char>* output) {
+  tensor->CopyToCpu(reinterpret_cast<T*>(output->data()));
+}
+
+void RunOnce(Predictor* predictor,
+             const std::vector<Input>& inputs,
+             std::vector<std::vector<char>>* outputs) {
+  for (const auto& input : inputs) {
+    auto tensor = predictor->GetInputHandle(input.name);
+    tensor->Reshape(input.shape);
+    switch (input.dtype) {
+      case DataType::FLOAT32:
+        CopyTo<float>(tensor.get(), input);
+        break;
+      case DataType::FLOAT64:
+        CopyTo<double>(tensor.get(), input);
+        break;
+      case DataType::INT64:
+        CopyTo<int64_t>(tensor.get(), input);
+        break;
+      case DataType::INT32:
+        CopyTo<int32_t>(tensor.get(), input);
+        break;
+      case DataType::UINT8:
+        CopyTo<uint8_t>(tensor.get(), input);
+        break;
+      case DataType::INT8:
+        CopyTo<int8_t>(tensor.get(), input);
+        break;
+      case DataType::FLOAT16:
+        CopyTo<phi::dtype::float16>(tensor.get(), input);
+        break;
+      case DataType::BFLOAT16:
+        CopyTo<phi::dtype::bfloat16>(tensor.get(), input);
+        break;
+      case DataType::BOOL:
+        CopyTo<bool>(tensor.get(), input);
+        break;
+      default:
+        Fail("unsupported dtype of " + input.name);
+    }
+  }
+  if (!predictor->Run()) Fail("failed to run the predictor");
+
+  auto names = predictor->GetOutputNames();
+  outputs->resize(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto tensor = predictor->GetOutputHandle(names[i]);
+    int64_t numel = 1;
+    for (auto dim : tensor->shape()) numel *= dim;
+    auto& output = (*outputs)[i];
+    output.resize(numel * SizeOf(tensor->type()));
+    switch (tensor->type()) {
+      case DataType::FLOAT32:
+        CopyFrom<float>(tensor.get(), &output);
+        break;
+      case DataType::FLOAT64:
+        CopyFrom<double>(tensor.get(), &output);
+        break;
+      case DataType::INT64:
+        CopyFrom<int64_t>(tensor.get(), &output);
+        break;
+      case DataType::INT32:
+        CopyFrom<int32_t>(tensor.get(), &output);
+        break;
+      case DataType::UINT8:
+        CopyFrom<uint8_t>(tensor.get(), &output);
+        break;
+      case DataType::INT8:
+        CopyFrom<int8_t>(tensor.get(), &output);
+        break;
+      case DataType::FLOAT16:
+        CopyFrom<phi::dtype::float16>(tensor.get(), &output);
+        break;
+      case DataType::BFLOAT16:
+        CopyFrom<phi::dtype::bfloat16>(tensor.get(), &output);
+        break;
+      case DataType::BOOL:
+        CopyFrom<bool>(tensor.get(), &output);
+        break;
+      default:
+        Fail("unsupported dtype of " + names[i]);
+    }
+  }
+}
+
+Config MakeConfig(int threads, int max_batch_size) {
+  Config config;
+  if (!FLAGS_model_dir.empty()) {
+    config.SetModel(FLAGS_model_dir);
+  } else {
+    config.SetModel(FLAGS_model_file, FLAGS_params_file);
+  }
+  config.SwitchIrOptim(FLAGS_ir_optim);
+  config.EnableMemoryOptim();
+  config.SetCpuMathLibraryNumThreads(threads);
+  if (FLAGS_use_gpu) {
+    config.EnableUseGpu(FLAGS_gpu_memory_mb, FLAGS_gpu_id);
+    if (FLAGS_use_trt) {
+      auto precision = Config::Precision::kFloat32;
+      if (FLAGS_trt_precision == "fp16") {
+        precision = Config::Precision::kHalf;
+      } else if (FLAGS_trt_precision == "int8") {
+        precision = Config::Precision::kInt8;
+      } else if (FLAGS_trt_precision != "fp32") {
+        Fail("invalid --trt_precision " + FLAGS_trt_precision);
+      }
+      config.EnableTensorRtEngine(
+          1 << 30, max_batch_size, 3, precision, false, false);
+      if (!FLAGS_trt_shape_range_info.empty()) {
+        config.EnableTunedTensorRtDynamicShape(FLAGS_trt_shape_range_info);
+      }
+    }
+  } else if (FLAGS_use_onednn) {
+    config.EnableMKLDNN();
+  }
+  if (FLAGS_use_cinn) config.EnableCINN();
+  config.DisableGlogInfo();
+  return config;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+Result RunCase(const Case& config,
+               const std::vector<std::shared_ptr<Predictor>>& predictors,
+               const std::vector<Input>& inputs) {
+  int n = config.concurrency;
+  std::vector<std::vector<double>> latencies(n);
+  auto run = [&](int iterations, bool timed) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; ++i) {
+      workers.emplace_back([&, i] {
+        std::vector<std::vector<char>> outputs;
+        for (int it = 0; it < iterations; ++it) {
+          auto start = std::chrono::steady_clock::now();
+          RunOnce(predictors[i].get(), inputs, &outputs);
+          if (timed) {
+            latencies[i].push_back(
+                std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count());
+          }
+        }
+      });
+    }
+    for (auto& worker : workers) worker.join();
+  };
+  run(FLAGS_warmup, false);
+  auto start = std::chrono::steady_clock::now();
+  run(FLAGS_iterations, true);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  std::vector<double> all;
+  for (const auto& item : latencies) {
+    all.insert(all.end(), item.begin(), item.end());
+  }
+  std::sort(all.begin(), all.end());
+  Result result;
+  result.config = config;
+  result.runs = static_cast<int64_t>(all.size());
+  result.seconds = seconds;
+  if (!all.empty()) {
+    double sum = 0;
+    for (auto latency : all) sum += latency;
+    result.qps = seconds > 0 ? all.size() / seconds : 0;
+    result.samples_per_second = result.qps * config.batch_size;
+    result.mean_ms = sum / all.size();
+    result.p50_ms = Percentile(all, 0.5);
+    result.p90_ms = Percentile(all, 0.9);
+    result.p99_ms = Percentile(all, 0.99);
+    result.max_ms = all.back();
+  }
+  if (FLAGS_use_gpu) {
+    result.gpu_allocated =
+        paddle::memory::DeviceMemoryStatCurrentValue("Allocated", FLAGS_gpu_id);
+    result.gpu_reserved =
+        paddle::memory::DeviceMemoryStatCurrentValue("Reserved", FLAGS_gpu_id);
+    result.gpu_peak_reserved =
+        paddle::memory::DeviceMemoryStatPeakValue("Reserved", FLAGS_gpu_id);
+  }
+  return result;
+}
+
+void PrintHeader() {
+  std::cout << std::setw(6) << "batch" << std::setw(8) << "threads"
+            << std::setw(12) << "concurrency" << std::setw(12) << "qps"
+            << std::setw(12) << "mean(ms)" << std::setw(10) << "p50(ms)"
+            << std::setw(10) << "p90(ms)" << std::setw(10) << "p99(ms)"
+            << std::setw(14) << "gpu_mem(MB)" << std::endl;
+}
+
+void Print(const Result& result) {
+  std::cout << std::fixed << std::setprecision(2) << std::setw(6)
+            << result.config.batch_size << std::setw(8)
+            << result.config.threads << std::setw(12)
+            << result.config.concurrency << std::setw(12) << result.qps
+            << std::setw(12) << result.mean_ms << std::setw(10)
+            << result.p50_ms << std::setw(10) << result.p90_ms
+            << std::setw(10) << result.p99_ms << std::setw(14)
+            << result.gpu_peak_reserved / 1048576.0 << std::endl;
+}
+
+std::string ToJson(const std::vector<Result>& results) {
+  std::ostringstream out;
+  out << "{\n  \"version\": \"" << paddle_infer::GetVersion() << "\",\n"
+      << "  \"model\": \""
+      << (FLAGS_model_dir.empty() ? FLAGS_model_file : FLAGS_model_dir)
+      << "\",\n"
+      << "  \"device\": \"" << (FLAGS_use_gpu ? "gpu" : "cpu") << "\",\n"
+      << "  \"use_trt\": " << (FLAGS_use_trt ? "true" : "false") << ",\n"
+      << "  \"trt_precision\": \"" << FLAGS_trt_precision << "\",\n"
+      << "  \"use_onednn\": " << (FLAGS_use_onednn ? "true" : "false")
+      << ",\n"
+      << "  \"use_cinn\": " << (FLAGS_use_cinn ? "true" : "false") << ",\n"
+      << "  \"inputs\": \""
+      << (FLAGS_input_file.empty() ? "synthetic" : "recorded") << "\",\n"
+      << "  \"results\": [";
+  out << std::setprecision(6);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"batch_size\": "
+        << result.config.batch_size
+        << ", \"threads\": " << result.config.threads
+        << ", \"concurrency\": " << result.config.concurrency
+        << ", \"runs\": " << result.runs << ", \"seconds\": " << result.seconds
+        << ", \"qps\": " << result.qps
+        << ", \"samples_per_second\": " << result.samples_per_second
+        << ", \"latency_ms\": {\"mean\": " << result.mean_ms
+        << ", \"p50\": " << result.p50_ms << ", \"p90\": " << result.p90_ms
+        << ", \"p99\": " << result.p99_ms << ", \"max\": " << result.max_ms
+        << "}, \"gpu_memory\": {\"allocated\": " << result.gpu_allocated
+        << ", \"reserved\": " << result.gpu_reserved
+        << ", \"peak_reserved\": " << result.gpu_peak_reserved << "}}";
+  }
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+int Main() {
+  if (FLAGS_model_dir.empty() && FLAGS_model_file.empty()) {
+    Fail("--model_dir or --model_file is required");
+  }
+  if (FLAGS_iterations <= 0) Fail("--iterations must be positive");
+  std::vector<Input> recorded;
+  std::vector<int> batch_sizes;
+  if (!FLAGS_input_file.empty()) {
+    recorded = RecordedInputs(FLAGS_input_file);
+    if (recorded.empty()) Fail("no inputs in " + FLAGS_input_file);
+    int batch = recorded[0].shape.empty() ? 1 : recorded[0].shape[0];
+    batch_sizes.push_back(batch);
+  } else {
+    batch_sizes = ParseInts("batch_sizes", FLAGS_batch_sizes);
+  }
+  auto threads = ParseInts("threads", FLAGS_threads);
+  auto concurrency = ParseInts("concurrency", FLAGS_concurrency);
+  int max_batch_size =
+      *std::max_element(batch_sizes.begin(), batch_sizes.end());
+  int max_concurrency =
+      *std::max_element(concurrency.begin(), concurrency.end());
+
+  std::vector<Result> results;
+  PrintHeader();
+  for (int thread : threads) {
+    // the clones share the weights of the first predictor
+    std::vector<std::shared_ptr<Predictor>> predictors;
+    auto config = MakeConfig(thread, max_batch_size);
+    predictors.push_back(paddle_infer::CreatePredictor(config));
+    for (int i = 1; i < max_concurrency; ++i) {
+      predictors.push_back(predictors[0]->Clone());
+    }
+    for (int batch_size : batch_sizes) {
+      auto inputs = recorded.empty()
+                        ? SyntheticInputs(predictors[0].get(), batch_size)
+                        : recorded;
+      for (int n : concurrency) {
+        auto result = RunCase(Case{batch_size, thread, n}, predictors, inputs);
+        Print(result);
+        results.push_back(result);
+      }
+    }
+  }
+
+  if (!FLAGS_output_json.empty()) {
+    std::ofstream out(FLAGS_output_json);
+    if (!out.is_open()) Fail("cannot open " + FLAGS_output_json);
+    out << ToJson(results);
+  }
+  return 0;
+}
+
+}  // namespace bench
+}  // namespace inference
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  paddle::flags::ParseCommandLineFlags(&argc, &argv);
+  return paddle::inference::bench::Main();
+}
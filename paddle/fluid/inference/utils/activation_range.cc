@@ -0,0 +1,169 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/activation_range.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "paddle/common/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+void ActivationHistogram::Collect(const float* data, int64_t numel) {
+  const int64_t num_bins = static_cast<int64_t>(counts.size());
+  float batch_max = 0.f;
+  for (int64_t i = 0; i < numel; ++i) {
+    if (std::isfinite(data[i])) {
+      batch_max = std::max(batch_max, std::fabs(data[i]));
+    }
+  }
+  abs_max = std::max(abs_max, batch_max);
+  // All the values before the first nonzero one are zeros in the first bin.
+  if (bin_width == 0.f && abs_max > 0.f) {
+    bin_width = abs_max / num_bins;
+  }
+  while (bin_width > 0.f && abs_max > bin_width * num_bins) {
+    for (int64_t i = 0; i < num_bins; ++i) {
+      int64_t merged = 0;
+      if (2 * i < num_bins) merged += counts[2 * i];
+      if (2 * i + 1 < num_bins) merged += counts[2 * i + 1];
+      counts[i] = merged;
+    }
+    bin_width *= 2.f;
+  }
+  for (int64_t i = 0; i < numel; ++i) {
+    if (!std::isfinite(data[i])) continue;
+    int64_t bin = 0;
+    if (bin_width > 0.f) {
+      bin = std::min(static_cast<int64_t>(std::fabs(data[i]) / bin_width),
+                     num_bins - 1);
+    }
+    ++counts[bin];
+  }
+}
+
+float ActivationHistogram::Threshold(float percentile) const {
+  if (percentile >= 100.f || bin_width == 0.f) return abs_max;
+  int64_t total = 0;
+  for (auto count : counts) total += count;
+  const auto target =
+      static_cast<int64_t>(std::ceil(total * percentile / 100.0));
+  int64_t accumulated = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    accumulated += counts[i];
+    if (accumulated >= target) {
+      return std::min(bin_width * static_cast<float>(i + 1), abs_max);
+    }
+  }
+  return abs_max;
+}
+
+std::shared_ptr<ActivationRangeCollector> ActivationRangeCollector::Get(
+    const std::string& path, int num_bins) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string,
+                            std::weak_ptr<ActivationRangeCollector>>
+      collectors;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto collector = collectors[path].lock();
+  if (!collector) {
+    collector = std::make_shared<ActivationRangeCollector>(path, num_bins);
+    collectors[path] = collector;
+  }
+  return collector;
+}
+
+void ActivationRangeCollector::Collect(const std::string& name,
+                                       const float* data,
+                                       int64_t numel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& histogram = histograms_[name];
+  if (histogram.counts.empty()) {
+    histogram.counts.resize(num_bins_, 0);
+  }
+  histogram.Collect(data, numel);
+}
+
+void ActivationRangeCollector::Serialize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SerializeActivationRange(path_, histograms_);
+}
+
+void SerializeActivationRange(
+    const std::string& path,
+    const std::map<std::string, ActivationHistogram>& histograms) {
+  std::ofstream os(path);
+  PADDLE_ENFORCE_EQ(
+      os.is_open(),
+      true,
+      common::errors::Unavailable("Cannot open %s to save the activation "
+                                  "ranges.",
+                                  path));
+  os.precision(std::numeric_limits<float>::max_digits10);
+  os << "# name abs_max bin_width num_bins counts..." << std::endl;
+  for (auto& item : histograms) {
+    auto& histogram = item.second;
+    os << item.first << " " << histogram.abs_max << " " << histogram.bin_width
+       << " " << histogram.counts.size();
+    for (auto count : histogram.counts) os << " " << count;
+    os << std::endl;
+  }
+}
+
+void DeserializeActivationRange(
+    const std::string& path,
+    std::map<std::string, ActivationHistogram>* histograms) {
+  std::ifstream is(path);
+  PADDLE_ENFORCE_EQ(
+      is.is_open(),
+      true,
+      common::errors::NotFound("File [%s] is not found.", path));
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ss(line);
+    std::string name;
+    ActivationHistogram histogram;
+    size_t num_bins = 0;
+    ss >> name >> histogram.abs_max >> histogram.bin_width >> num_bins;
+    histogram.counts.resize(num_bins, 0);
+    for (auto& count : histogram.counts) ss >> count;
+    PADDLE_ENFORCE_EQ(
+        ss.fail(),
+        false,
+        common::errors::InvalidArgument(
+            "The activation range of %s in %s is broken.", name, path));
+    (*histograms)[name] = histogram;
+  }
+}
+
+std::unordered_map<std::string, float> DeserializeActivationRange(
+    const std::string& path, float percentile) {
+  std::map<std::string, ActivationHistogram> histograms;
+  DeserializeActivationRange(path, &histograms);
+  std::unordered_map<std::string, float> ranges;
+  for (auto& item : histograms) {
+    float range = item.second.Threshold(percentile);
+    if (range > 0.f) ranges[item.first] = range;
+  }
+  return ranges;
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,84 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+//
+// The histogram of the absolute values of an activation, whose bins cover
+// [0, bin_width * counts.size()). The bins are merged in pairs whenever a
+// larger value comes, so that it is built in a single pass of the batches.
+//
+struct ActivationHistogram {
+  float abs_max{0.f};
+  float bin_width{0.f};
+  std::vector<int64_t> counts;
+
+  void Collect(const float* data, int64_t numel);
+  // The value below which the percentile of the values fall, a percentile of
+  // 100 gives the abs max.
+  float Threshold(float percentile) const;
+};
+
+//
+// Collects the histograms of the activations run by the native predictors of
+// a calibration. The collector of a path is shared by all the predictors
+// which save to it, so the predictors running in several threads or on
+// several devices calibrate together, each of them only locks the collector
+// to add its own values.
+//
+class TEST_API ActivationRangeCollector {
+ public:
+  static std::shared_ptr<ActivationRangeCollector> Get(const std::string& path,
+                                                       int num_bins);
+
+  ActivationRangeCollector(const std::string& path, int num_bins)
+      : path_(path), num_bins_(num_bins) {}
+
+  void Collect(const std::string& name, const float* data, int64_t numel);
+  // Saves the histograms collected so far to the path, it is called as each
+  // predictor exits, and the last one saves all of them.
+  void Serialize();
+
+ private:
+  std::mutex mutex_;
+  std::string path_;
+  int num_bins_;
+  std::map<std::string, ActivationHistogram> histograms_;
+};
+
+TEST_API void SerializeActivationRange(
+    const std::string& path,
+    const std::map<std::string, ActivationHistogram>& histograms);
+TEST_API void DeserializeActivationRange(
+    const std::string& path,
+    std::map<std::string, ActivationHistogram>* histograms);
+// The dynamic ranges of the activations saved to the path at the percentile.
+TEST_API std::unordered_map<std::string, float> DeserializeActivationRange(
+    const std::string& path, float percentile);
+
+}  // namespace inference
+}  // namespace paddle
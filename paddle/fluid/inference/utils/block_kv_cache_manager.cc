@@ -0,0 +1,335 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/block_kv_cache_manager.h"
+
+#include <algorithm>
+
+#include "paddle/common/enforce.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/memory_utils.h"
+
+namespace paddle {
+namespace inference {
+
+BlockKVCacheManager::BlockKVCacheManager(int num_blocks, int block_size)
+    : num_blocks_(num_blocks), block_size_(block_size) {
+  PADDLE_ENFORCE_GT(num_blocks,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The num_blocks should be greater than 0, but got %d.",
+                        num_blocks));
+  PADDLE_ENFORCE_GT(block_size,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The block_size should be greater than 0, but got %d.",
+                        block_size));
+  ref_counts_.assign(num_blocks, 0);
+  free_blocks_.reserve(num_blocks);
+  // the blocks of low ids are taken first
+  for (int i = num_blocks - 1; i >= 0; --i) {
+    free_blocks_.push_back(i);
+  }
+}
+
+BlockKVCacheManager::~BlockKVCacheManager() = default;
+
+BlockKVCacheManager::Sequence& BlockKVCacheManager::GetSequence(
+    int64_t seq_id) {
+  auto it = sequences_.find(seq_id);
+  PADDLE_ENFORCE_NE(
+      it,
+      sequences_.end(),
+      common::errors::NotFound("The sequence %d is not found.", seq_id));
+  return it->second;
+}
+
+const BlockKVCacheManager::Sequence& BlockKVCacheManager::GetSequence(
+    int64_t seq_id) const {
+  auto it = sequences_.find(seq_id);
+  PADDLE_ENFORCE_NE(
+      it,
+      sequences_.end(),
+      common::errors::NotFound("The sequence %d is not found.", seq_id));
+  return it->second;
+}
+
+int BlockKVCacheManager::AllocateBlock() {
+  if (free_blocks_.empty() && !EvictBlock()) {
+    PADDLE_THROW(common::errors::ResourceExhausted(
+        "All the %d blocks of the kv cache are in use, free some sequences "
+        "or enlarge the cache.",
+        num_blocks_));
+  }
+  int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void BlockKVCacheManager::ReleaseBlock(int block) {
+  PADDLE_ENFORCE_GT(ref_counts_[block],
+                    0,
+                    common::errors::PreconditionNotMet(
+                        "The block %d of the kv cache is released twice.",
+                        block));
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+bool BlockKVCacheManager::EvictBlock() {
+  Node* victim = nullptr;
+  std::vector<Node*> stack;
+  for (auto& child : root_.children) {
+    stack.push_back(child.second.get());
+  }
+  while (!stack.empty()) {
+    Node* node = stack.back();
+    stack.pop_back();
+    if (node->children.empty()) {
+      if (ref_counts_[node->block] == 1 &&
+          (victim == nullptr || node->last_access < victim->last_access)) {
+        victim = node;
+      }
+    } else {
+      for (auto& child : node->children) {
+        stack.push_back(child.second.get());
+      }
+    }
+  }
+  if (victim == nullptr) {
+    return false;
+  }
+  ReleaseBlock(victim->block);
+  --num_cached_blocks_;
+  auto& siblings = victim->parent->children;
+  for (auto it = siblings.begin(); it != siblings.end(); ++it) {
+    if (it->second.get() == victim) {
+      siblings.erase(it);
+      break;
+    }
+  }
+  return true;
+}
+
+int BlockKVCacheManager::AddSequence(int64_t seq_id,
+                                     const std::vector<int64_t>& prompt) {
+  PADDLE_ENFORCE_EQ(
+      sequences_.count(seq_id),
+      0,
+      common::errors::AlreadyExists("The sequence %d already exists.", seq_id));
+  PADDLE_ENFORCE_EQ(
+      prompt.empty(),
+      false,
+      common::errors::InvalidArgument("The prompt should not be empty."));
+  const size_t len = prompt.size();
+  const size_t num_blocks = (len + block_size_ - 1) / block_size_;
+  // keeps the last token out of the cache, whose logits are to be computed
+  const size_t max_matched = (len - 1) / block_size_;
+
+  Sequence seq;
+  seq.blocks.reserve(num_blocks);
+  Node* node = &root_;
+  std::vector<int64_t> key(block_size_);
+  while (seq.blocks.size() < max_matched) {
+    auto begin = prompt.begin() + seq.blocks.size() * block_size_;
+    key.assign(begin, begin + block_size_);
+    auto it = node->children.find(key);
+    if (it == node->children.end()) {
+      break;
+    }
+    node = it->second.get();
+    node->last_access = ++clock_;
+    ++ref_counts_[node->block];
+    seq.blocks.push_back(node->block);
+  }
+  const int num_matched_tokens =
+      static_cast<int>(seq.blocks.size()) * block_size_;
+
+  try {
+    while (seq.blocks.size() < num_blocks) {
+      seq.blocks.push_back(AllocateBlock());
+    }
+  } catch (...) {
+    for (int block : seq.blocks) {
+      ReleaseBlock(block);
+    }
+    throw;
+  }
+  seq.tokens = prompt;
+  sequences_.emplace(seq_id, std::move(seq));
+  return num_matched_tokens;
+}
+
+void BlockKVCacheManager::AppendTokens(int64_t seq_id,
+                                       const std::vector<int64_t>& tokens) {
+  Sequence& seq = GetSequence(seq_id);
+  for (int64_t token : tokens) {
+    if (seq.tokens.size() % block_size_ == 0) {
+      seq.blocks.push_back(AllocateBlock());
+    } else if (ref_counts_[seq.blocks.back()] > 1) {
+      // the last block is shared with a forked sequence, copy on write
+      int src = seq.blocks.back();
+      int dst = AllocateBlock();
+      pending_copies_.emplace_back(src, dst);
+      ReleaseBlock(src);
+      seq.blocks.back() = dst;
+    }
+    seq.tokens.push_back(token);
+  }
+}
+
+void BlockKVCacheManager::ForkSequence(int64_t src_id, int64_t dst_id) {
+  PADDLE_ENFORCE_EQ(
+      sequences_.count(dst_id),
+      0,
+      common::errors::AlreadyExists("The sequence %d already exists.", dst_id));
+  Sequence seq = GetSequence(src_id);
+  for (int block : seq.blocks) {
+    ++ref_counts_[block];
+  }
+  sequences_.emplace(dst_id, std::move(seq));
+}
+
+void BlockKVCacheManager::CachePrefix(int64_t seq_id) {
+  Sequence& seq = GetSequence(seq_id);
+  const size_t num_full = seq.tokens.size() / block_size_;
+  Node* node = &root_;
+  std::vector<int64_t> key(block_size_);
+  for (size_t i = 0; i < num_full; ++i) {
+    auto begin = seq.tokens.begin() + i * block_size_;
+    key.assign(begin, begin + block_size_);
+    auto it = node->children.find(key);
+    if (it == node->children.end()) {
+      auto child = std::make_unique<Node>();
+      child->parent = node;
+      child->block = seq.blocks[i];
+      ++ref_counts_[child->block];
+      ++num_cached_blocks_;
+      it = node->children.emplace(key, std::move(child)).first;
+    } else if (it->second->block != seq.blocks[i]) {
+      // the same prefix was computed by another sequence, share its block
+      ++ref_counts_[it->second->block];
+      ReleaseBlock(seq.blocks[i]);
+      seq.blocks[i] = it->second->block;
+    }
+    node = it->second.get();
+    node->last_access = ++clock_;
+  }
+}
+
+void BlockKVCacheManager::TruncateSequence(int64_t seq_id, int length) {
+  Sequence& seq = GetSequence(seq_id);
+  PADDLE_ENFORCE_EQ(
+      length > 0 && static_cast<size_t>(length) <= seq.tokens.size(),
+      true,
+      common::errors::InvalidArgument(
+          "The sequence %d of %d tokens can not be truncated to %d tokens.",
+          seq_id,
+          seq.tokens.size(),
+          length));
+  // the kept last block may be cached, which AppendTokens copies on write
+  const size_t num_blocks = (length + block_size_ - 1) / block_size_;
+  for (size_t i = num_blocks; i < seq.blocks.size(); ++i) {
+    ReleaseBlock(seq.blocks[i]);
+  }
+  seq.blocks.resize(num_blocks);
+  seq.tokens.resize(length);
+}
+
+void BlockKVCacheManager::FreeSequence(int64_t seq_id) {
+  Sequence& seq = GetSequence(seq_id);
+  for (int block : seq.blocks) {
+    ReleaseBlock(block);
+  }
+  sequences_.erase(seq_id);
+}
+
+bool BlockKVCacheManager::HasSequence(int64_t seq_id) const {
+  return sequences_.count(seq_id) > 0;
+}
+
+int BlockKVCacheManager::SequenceLength(int64_t seq_id) const {
+  return static_cast<int>(GetSequence(seq_id).tokens.size());
+}
+
+const std::vector<int>& BlockKVCacheManager::BlockTable(
+    int64_t seq_id) const {
+  return GetSequence(seq_id).blocks;
+}
+
+void BlockKVCacheManager::FillBlockTables(const std::vector<int64_t>& seq_ids,
+                                          int max_blocks_per_seq,
+                                          int* block_tables) const {
+  for (size_t i = 0; i < seq_ids.size(); ++i) {
+    const auto& blocks = GetSequence(seq_ids[i]).blocks;
+    PADDLE_ENFORCE_LE(
+        blocks.size(),
+        static_cast<size_t>(max_blocks_per_seq),
+        common::errors::InvalidArgument(
+            "The sequence %d takes %d blocks, more than the max_blocks_per_seq "
+            "%d of the block_tables.",
+            seq_ids[i],
+            blocks.size(),
+            max_blocks_per_seq));
+    int* row = block_tables + i * max_blocks_per_seq;
+    std::copy(blocks.begin(), blocks.end(), row);
+    std::fill(row + blocks.size(), row + max_blocks_per_seq, -1);
+  }
+}
+
+std::vector<std::pair<int, int>> BlockKVCacheManager::TakePendingCopies() {
+  std::vector<std::pair<int, int>> copies;
+  copies.swap(pending_copies_);
+  return copies;
+}
+
+void CopyCacheBlocks(const std::vector<std::pair<int, int>>& copies,
+                     phi::DenseTensor* cache) {
+  if (copies.empty()) {
+    return;
+  }
+  PADDLE_ENFORCE_EQ(cache->dims().size(),
+                    4,
+                    common::errors::InvalidArgument(
+                        "The cache should be of shape [num_blocks, num_heads, "
+                        "block_size, head_size], but got %s.",
+                        cache->dims()));
+  const int64_t num_blocks = cache->dims()[0];
+  const size_t block_bytes =
+      cache->numel() / num_blocks * phi::SizeOf(cache->dtype());
+  auto* data = static_cast<uint8_t*>(cache->data());
+  const auto& place = cache->place();
+  for (const auto& copy : copies) {
+    PADDLE_ENFORCE_EQ(
+        copy.first >= 0 && copy.first < num_blocks && copy.second >= 0 &&
+            copy.second < num_blocks,
+        true,
+        common::errors::OutOfRange(
+            "The blocks (%d, %d) to copy are out of the %d blocks of the "
+            "cache.",
+            copy.first,
+            copy.second,
+            num_blocks));
+    phi::memory_utils::Copy(place,
+                            data + copy.second * block_bytes,
+                            place,
+                            data + copy.first * block_bytes,
+                            block_bytes);
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,133 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+//
+// Manages the blocks of the paged key_cache/value_cache of
+// block_multi_head_attention, which are of shape
+// [num_blocks, num_heads, block_size, head_size], and builds the
+// block_tables of the sequences on it.
+//
+// The blocks are reference counted, so that the sequences sharing a prompt
+// prefix share its blocks. The full blocks of a sequence are cached in a
+// prefix tree by CachePrefix(), whose edges are the tokens of a block, and
+// the sequences added later reuse the longest cached prefix of their prompt.
+// The cached blocks nobody else uses are evicted least recently used first
+// when the pool runs out of blocks. A partially filled block shared by
+// ForkSequence() is copied on write: the manager only records the copy, which
+// is to be done by CopyCacheBlocks() before the next step runs.
+//
+// The manager only hands out block ids, the caches themselves are allocated
+// by the caller, and it is not thread safe.
+//
+class TEST_API BlockKVCacheManager {
+ public:
+  BlockKVCacheManager(int num_blocks, int block_size);
+  ~BlockKVCacheManager();
+
+  // Adds a sequence of the prompt, allocating its blocks. Returns the number
+  // of the leading tokens whose keys and values are cached already, which
+  // the prefill does not need to compute. The last token is never taken from
+  // the cache.
+  int AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt);
+
+  // Appends the generated tokens to a sequence, allocating the new blocks.
+  void AppendTokens(int64_t seq_id, const std::vector<int64_t>& tokens);
+
+  // Adds the sequence dst_id sharing all the blocks of src_id, e.g. for beam
+  // search or for parallel sampling.
+  void ForkSequence(int64_t src_id, int64_t dst_id);
+
+  // Caches the full blocks of a sequence for the prefix matching, once their
+  // keys and values were written.
+  void CachePrefix(int64_t seq_id);
+
+  // Drops the tokens of a sequence after the first length ones and the
+  // blocks they take, e.g. the draft tokens rejected by speculative decoding.
+  void TruncateSequence(int64_t seq_id, int length);
+
+  void FreeSequence(int64_t seq_id);
+
+  bool HasSequence(int64_t seq_id) const;
+  int SequenceLength(int64_t seq_id) const;
+  const std::vector<int>& BlockTable(int64_t seq_id) const;
+
+  // Writes the block_tables of the sequences, a [seq_ids.size(),
+  // max_blocks_per_seq] int32 tensor padded with -1.
+  void FillBlockTables(const std::vector<int64_t>& seq_ids,
+                       int max_blocks_per_seq,
+                       int* block_tables) const;
+
+  // The (src, dst) blocks to copy since the last call.
+  std::vector<std::pair<int, int>> TakePendingCopies();
+
+  int NumFreeBlocks() const { return static_cast<int>(free_blocks_.size()); }
+  int NumCachedBlocks() const { return num_cached_blocks_; }
+  int num_blocks() const { return num_blocks_; }
+  int block_size() const { return block_size_; }
+
+ private:
+  struct Node {
+    Node* parent{nullptr};
+    int block{-1};
+    uint64_t last_access{0};
+    std::map<std::vector<int64_t>, std::unique_ptr<Node>> children;
+  };
+
+  struct Sequence {
+    std::vector<int64_t> tokens;
+    std::vector<int> blocks;
+  };
+
+  Sequence& GetSequence(int64_t seq_id);
+  const Sequence& GetSequence(int64_t seq_id) const;
+
+  // Takes a block of the pool, evicting a cached block if none is free.
+  int AllocateBlock();
+  void ReleaseBlock(int block);
+  // Evicts the least recently used cached block referenced by the prefix tree
+  // only. Returns false if there is none.
+  bool EvictBlock();
+
+  const int num_blocks_;
+  const int block_size_;
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::unordered_map<int64_t, Sequence> sequences_;
+  std::vector<std::pair<int, int>> pending_copies_;
+  Node root_;
+  int num_cached_blocks_{0};
+  uint64_t clock_{0};
+};
+
+// Does the copies of TakePendingCopies() in a key or value cache.
+TEST_API void CopyCacheBlocks(const std::vector<std::pair<int, int>>& copies,
+                              phi::DenseTensor* cache);
+
+}  // namespace inference
+}  // namespace paddle
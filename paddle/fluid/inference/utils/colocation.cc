@@ -0,0 +1,202 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/colocation.h"
+
+#include <algorithm>
+
+#include "paddle/common/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+bool MemoryBudget::Reserve(size_t size) {
+  size_t used = used_.load();
+  do {
+    if (limit_ > 0 && used + size > limit_) return false;
+  } while (!used_.compare_exchange_weak(used, used + size));
+  if (parent_ && !parent_->Reserve(size)) {
+    used_ -= size;
+    return false;
+  }
+  return true;
+}
+
+void MemoryBudget::Release(size_t size) {
+  used_ -= size;
+  if (parent_) parent_->Release(size);
+}
+
+void MemoryBudget::Adjust(int64_t delta) {
+  used_ += static_cast<size_t>(delta);
+  if (parent_) parent_->Adjust(delta);
+}
+
+phi::Allocation* BudgetAllocator::AllocateImpl(size_t size) {
+  PADDLE_ENFORCE_EQ(
+      budget_->Reserve(size),
+      true,
+      common::errors::ResourceExhausted(
+          "Cannot allocate %d bytes within the memory quota of the model, "
+          "whose %d of %d bytes are used, or the memory cap of its device.",
+          size,
+          budget_->used(),
+          budget_->limit()));
+  phi::Allocation* allocation = nullptr;
+  try {
+    allocation = underlying_->Allocate(size).release();
+  } catch (...) {
+    budget_->Release(size);
+    throw;
+  }
+  // The underlying allocator may round the size up.
+  budget_->Adjust(static_cast<int64_t>(allocation->size()) -
+                  static_cast<int64_t>(size));
+  return allocation;
+}
+
+void BudgetAllocator::FreeImpl(phi::Allocation* allocation) {
+  size_t size = allocation->size();
+  underlying_->Free(allocation);
+  budget_->Release(size);
+}
+
+void WeightedFairScheduler::Acquire(const void* client) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // An idle client starts from the current virtual time rather than from
+  // the service it missed.
+  const auto tag = std::make_pair(
+      std::max(finish_times_[client], virtual_time_), num_runs_++);
+  waiting_.insert(tag);
+  cv_.wait(lock,
+           [&] { return free_slots_ > 0 && *waiting_.begin() == tag; });
+  waiting_.erase(waiting_.begin());
+  --free_slots_;
+  virtual_time_ = std::max(virtual_time_, tag.first);
+  start_tags_[client] = tag.first;
+  // The next waiting run may take another free slot.
+  cv_.notify_all();
+}
+
+void WeightedFairScheduler::Release(const void* client,
+                                    int weight,
+                                    double latency) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finish_times_[client] =
+        start_tags_[client] + latency / std::max(weight, 1);
+    start_tags_.erase(client);
+    ++free_slots_;
+  }
+  cv_.notify_all();
+}
+
+void WeightedFairScheduler::Remove(const void* client) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  finish_times_.erase(client);
+  start_tags_.erase(client);
+}
+
+size_t WeightedFairScheduler::num_waiting() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return waiting_.size();
+}
+
+ColocationDevice& ColocationDevice::Get(int device_id) {
+  static std::mutex mutex;
+  static std::map<int, std::unique_ptr<ColocationDevice>> devices;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& device = devices[device_id];
+  if (!device) device = std::make_unique<ColocationDevice>();
+  return *device;
+}
+
+void ColocationDevice::SetOptions(size_t memory_cap,
+                                  int num_streams,
+                                  int max_concurrent_runs) {
+  PADDLE_ENFORCE_GE(num_streams,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The num_streams should not be negative, but got %d.",
+                        num_streams));
+  PADDLE_ENFORCE_GE(max_concurrent_runs,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The max_concurrent_runs should not be negative, but "
+                        "got %d.",
+                        max_concurrent_runs));
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_streams_ = num_streams;
+  memory_budget_ = std::make_shared<MemoryBudget>(memory_cap);
+  scheduler_ = nullptr;
+  if (max_concurrent_runs > 0) {
+    scheduler_ = std::make_shared<WeightedFairScheduler>(max_concurrent_runs);
+  }
+}
+
+int ColocationDevice::num_streams() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_streams_;
+}
+
+std::shared_ptr<MemoryBudget> ColocationDevice::memory_budget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_budget_;
+}
+
+std::shared_ptr<WeightedFairScheduler> ColocationDevice::scheduler() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return scheduler_;
+}
+
+memory::allocation::Allocator* ColocationDevice::CreateAllocator(
+    std::shared_ptr<memory::allocation::Allocator> underlying,
+    size_t memory_quota) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FreeIdleAllocators();
+  allocators_.emplace_back(std::make_unique<BudgetAllocator>(
+      std::move(underlying),
+      std::make_shared<MemoryBudget>(memory_quota, memory_budget_)));
+  return allocators_.back().get();
+}
+
+void ColocationDevice::ReleaseAllocator(
+    memory::allocation::Allocator* allocator) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(
+      allocators_.begin(), allocators_.end(), [&](const auto& item) {
+        return item.get() == allocator;
+      });
+  if (it != allocators_.end()) {
+    retired_allocators_.emplace_back(std::move(*it));
+    allocators_.erase(it);
+  }
+  FreeIdleAllocators();
+}
+
+size_t ColocationDevice::num_allocators() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocators_.size() + retired_allocators_.size();
+}
+
+void ColocationDevice::FreeIdleAllocators() {
+  retired_allocators_.erase(
+      std::remove_if(retired_allocators_.begin(),
+                     retired_allocators_.end(),
+                     [](const auto& item) { return item->used() == 0; }),
+      retired_allocators_.end());
+}
+
+}  // namespace inference
+}  // namespace paddle
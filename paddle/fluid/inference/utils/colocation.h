@@ -0,0 +1,195 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+//
+// The bytes a model, or all the models of a device, may allocate. A budget
+// reserves from its parent as well, so the quota of a model and the cap of
+// its device are both kept.
+//
+class TEST_API MemoryBudget {
+ public:
+  // A limit of 0 is unlimited.
+  explicit MemoryBudget(size_t limit,
+                        std::shared_ptr<MemoryBudget> parent = nullptr)
+      : limit_(limit), parent_(std::move(parent)) {}
+
+  // Reserves the size from the budget and its parents, all or nothing.
+  bool Reserve(size_t size);
+  void Release(size_t size);
+  // Adds the delta to the budget and its parents even beyond the limits.
+  void Adjust(int64_t delta);
+
+  size_t used() const { return used_; }
+  size_t limit() const { return limit_; }
+
+ private:
+  std::atomic<size_t> used_{0};
+  size_t limit_;
+  std::shared_ptr<MemoryBudget> parent_;
+};
+
+//
+// Allocates from the underlying allocator within the budget, the allocation
+// beyond it is ResourceExhausted.
+//
+class TEST_API BudgetAllocator : public memory::allocation::Allocator {
+ public:
+  BudgetAllocator(std::shared_ptr<memory::allocation::Allocator> underlying,
+                  std::shared_ptr<MemoryBudget> budget)
+      : underlying_(std::move(underlying)), budget_(std::move(budget)) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The bytes of the allocations alive.
+  size_t used() const { return budget_->used(); }
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const phi::Place& place) override {
+    return underlying_->Release(place);
+  }
+
+ private:
+  std::shared_ptr<memory::allocation::Allocator> underlying_;
+  std::shared_ptr<MemoryBudget> budget_;
+};
+
+//
+// Admits at most max_concurrent_runs runs of the models of a device at a
+// time. The models are served by weighted fair queueing: each run is tagged
+// with the virtual time its model has been served, which grows by the
+// latency of a run over the weight of the model, and the waiting run of the
+// least tag starts first. So the models share the device in proportion to
+// their weights when they compete, and an idle model does not save up.
+//
+class TEST_API WeightedFairScheduler {
+ public:
+  explicit WeightedFairScheduler(int max_concurrent_runs)
+      : free_slots_(max_concurrent_runs) {}
+
+  // Blocks until the run of the client may start.
+  void Acquire(const void* client);
+  // Charges the client by the latency of its run in microseconds.
+  void Release(const void* client, int weight, double latency);
+  // Forgets the client as it exits.
+  void Remove(const void* client);
+
+  size_t num_waiting() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  int free_slots_;
+  uint64_t num_runs_{0};
+  // The tag of the last run started.
+  double virtual_time_{0.};
+  // The tag and the order of the waiting runs.
+  std::set<std::pair<double, uint64_t>> waiting_;
+  // The virtual times of the clients, and the tags of their running runs.
+  std::map<const void*, double> finish_times_;
+  std::map<const void*, double> start_tags_;
+};
+
+//
+// Holds a slot of the scheduler for the scope of a run, a null scheduler
+// admits the run at once.
+//
+class ScopedScheduledRun {
+ public:
+  ScopedScheduledRun(WeightedFairScheduler* scheduler,
+                     const void* client,
+                     int weight)
+      : scheduler_(scheduler), client_(client), weight_(weight) {
+    if (scheduler_ == nullptr) return;
+    scheduler_->Acquire(client_);
+    start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedScheduledRun() {
+    if (scheduler_ == nullptr) return;
+    std::chrono::duration<double, std::micro> latency =
+        std::chrono::steady_clock::now() - start_;
+    scheduler_->Release(client_, weight_, latency.count());
+  }
+
+ private:
+  WeightedFairScheduler* scheduler_;
+  const void* client_;
+  int weight_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+//
+// The models colocated on a device: the cap of the memory they allocate
+// together, the number of the streams they share and the scheduler of their
+// runs. The options apply to the predictors created after they are set.
+//
+class TEST_API ColocationDevice {
+ public:
+  static ColocationDevice& Get(int device_id);
+
+  void SetOptions(size_t memory_cap, int num_streams, int max_concurrent_runs);
+
+  int num_streams() const;
+  std::shared_ptr<MemoryBudget> memory_budget() const;
+  std::shared_ptr<WeightedFairScheduler> scheduler() const;
+
+  // The allocator of a model within its quota and the cap of the device.
+  // The allocators are kept by the device, since the allocations may
+  // outlive the predictors.
+  memory::allocation::Allocator* CreateAllocator(
+      std::shared_ptr<memory::allocation::Allocator> underlying,
+      size_t memory_quota);
+  // Retires the allocator of an exiting model. It is freed once all its
+  // allocations are.
+  void ReleaseAllocator(memory::allocation::Allocator* allocator);
+
+  // The allocators in use or retired with allocations still alive.
+  size_t num_allocators() const;
+
+ private:
+  // Frees the retired allocators without allocations alive, with mutex_
+  // held.
+  void FreeIdleAllocators();
+
+  mutable std::mutex mutex_;
+  int num_streams_{0};
+  std::shared_ptr<MemoryBudget> memory_budget_{
+      std::make_shared<MemoryBudget>(0)};
+  std::shared_ptr<WeightedFairScheduler> scheduler_;
+  std::vector<std::unique_ptr<BudgetAllocator>> allocators_;
+  std::vector<std::unique_ptr<BudgetAllocator>> retired_allocators_;
+};
+
+}  // namespace inference
+}  // namespace paddle
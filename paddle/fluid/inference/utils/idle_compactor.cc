@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/idle_compactor.h"
+
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace inference {
+
+IdleCompactor::IdleCompactor(int idle_ms, std::function<uint64_t()> compact)
+    : idle_(idle_ms),
+      compact_(std::move(compact)),
+      run_lock_(mutex_, std::defer_lock),
+      thread_([this] { Loop(); }) {}
+
+IdleCompactor::~IdleCompactor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+uint64_t IdleCompactor::Compact() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  dirty_ = false;
+  ++num_compactions_;
+  return compact_();
+}
+
+void IdleCompactor::BeginRun() { run_lock_.lock(); }
+
+void IdleCompactor::EndRun() {
+  last_run_end_ = std::chrono::steady_clock::now();
+  dirty_ = true;
+  run_lock_.unlock();
+  cv_.notify_all();
+}
+
+int IdleCompactor::num_compactions() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return num_compactions_;
+}
+
+void IdleCompactor::Loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    if (!dirty_) {
+      cv_.wait(lock, [this] { return stop_ || dirty_; });
+      continue;
+    }
+    // A run finishing meanwhile moves the deadline.
+    auto deadline = last_run_end_ + idle_;
+    if (std::chrono::steady_clock::now() < deadline) {
+      cv_.wait_until(lock, deadline);
+      continue;
+    }
+    dirty_ = false;
+    ++num_compactions_;
+    uint64_t released = compact_();
+    VLOG(3) << "Compacted the memory of the idle predictor, released "
+            << released << " bytes";
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
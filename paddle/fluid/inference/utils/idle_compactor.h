@@ -0,0 +1,85 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+//
+// Compacts the memory of a predictor once it is idle: a background thread
+// calls the compaction when no run has started for idle_ms since the last
+// one finished. The runs and the compactions exclude each other, so a run
+// waits for the compaction in progress.
+//
+class TEST_API IdleCompactor {
+ public:
+  // The compaction returns the bytes it released.
+  IdleCompactor(int idle_ms, std::function<uint64_t()> compact);
+  ~IdleCompactor();
+
+  // Compacts at once, and returns the bytes released.
+  uint64_t Compact();
+
+  void BeginRun();
+  void EndRun();
+
+  int num_compactions() const;
+
+ private:
+  void Loop();
+
+  std::chrono::milliseconds idle_;
+  std::function<uint64_t()> compact_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  // Whether a run finished since the last compaction.
+  bool dirty_{false};
+  bool stop_{false};
+  int num_compactions_{0};
+  std::chrono::steady_clock::time_point last_run_end_;
+  // Held by the run in progress.
+  std::unique_lock<std::mutex> run_lock_;
+  std::thread thread_;
+};
+
+//
+// Holds off the compaction for the scope of a run, a null compactor does
+// nothing.
+//
+class ScopedCompactionRun {
+ public:
+  explicit ScopedCompactionRun(IdleCompactor* compactor)
+      : compactor_(compactor) {
+    if (compactor_ != nullptr) compactor_->BeginRun();
+  }
+  ~ScopedCompactionRun() {
+    if (compactor_ != nullptr) compactor_->EndRun();
+  }
+
+ private:
+  IdleCompactor* compactor_;
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -280,6 +280,64 @@ void DeserializeShapeRangeInfo(
   }
 }
 
+void SerializeShapeRangeBuckets(
+    const std::string &path,
+    const std::vector<std::map<std::string, std::vector<int32_t>>>
+        &bucket_max_shape,
+    const std::vector<std::map<std::string, std::vector<int32_t>>>
+        &bucket_opt_shape) {
+  PADDLE_ENFORCE_EQ(bucket_max_shape.size(),
+                    bucket_opt_shape.size(),
+                    common::errors::InvalidArgument(
+                        "The number of max shape buckets (%d) should be equal "
+                        "to the number of opt shape buckets (%d).",
+                        bucket_max_shape.size(),
+                        bucket_opt_shape.size()));
+  paddle::inference::proto::ShapeRangeInfos shape_range_infos;
+  DeserializeShapeRangeInfo(path, &shape_range_infos);
+  for (int i = 0; i < shape_range_infos.shape_range_info_size(); ++i) {
+    auto *info = shape_range_infos.mutable_shape_range_info(i);
+    info->clear_shape_bucket();
+    for (size_t b = 0; b < bucket_max_shape.size(); ++b) {
+      auto max_it = bucket_max_shape[b].find(info->name());
+      auto opt_it = bucket_opt_shape[b].find(info->name());
+      if (max_it == bucket_max_shape[b].end() ||
+          opt_it == bucket_opt_shape[b].end()) {
+        info->clear_shape_bucket();
+        break;
+      }
+      auto *bucket = info->add_shape_bucket();
+      for (auto shape : max_it->second) bucket->add_max_shape(shape);
+      for (auto shape : opt_it->second) bucket->add_opt_shape(shape);
+    }
+  }
+  inference::SerializeShapeRangeInfo(path, shape_range_infos);
+}
+
+void DeserializeShapeRangeBuckets(
+    const std::string &path,
+    std::vector<std::map<std::string, std::vector<int32_t>>> *bucket_max_shape,
+    std::vector<std::map<std::string, std::vector<int32_t>>>
+        *bucket_opt_shape) {
+  paddle::inference::proto::ShapeRangeInfos shape_range_infos;
+  DeserializeShapeRangeInfo(path, &shape_range_infos);
+  for (int i = 0; i < shape_range_infos.shape_range_info_size(); ++i) {
+    const auto &info = shape_range_infos.shape_range_info(i);
+    if (bucket_max_shape->size() <
+        static_cast<size_t>(info.shape_bucket_size())) {
+      bucket_max_shape->resize(info.shape_bucket_size());
+      bucket_opt_shape->resize(info.shape_bucket_size());
+    }
+    for (int b = 0; b < info.shape_bucket_size(); ++b) {
+      const auto &bucket = info.shape_bucket(b);
+      (*bucket_max_shape)[b][info.name()] = std::vector<int32_t>(
+          bucket.max_shape().begin(), bucket.max_shape().end());
+      (*bucket_opt_shape)[b][info.name()] = std::vector<int32_t>(
+          bucket.opt_shape().begin(), bucket.opt_shape().end());
+    }
+  }
+}
+
 void UpdateShapeRangeInfo(
     const std::string &path,
     const std::map<std::string, std::vector<int32_t>> &min_shape,
@@ -60,6 +60,19 @@ TEST_API void DeserializeShapeRangeInfo(
     std::map<std::string, std::vector<int32_t>>* min_value,
     std::map<std::string, std::vector<int32_t>>* max_value,
     std::map<std::string, std::vector<int32_t>>* opt_value);
+// The shape buckets hold the max and opt shapes of the tensors for each of
+// the optimization profiles tuned for the smaller inputs.
+TEST_API void SerializeShapeRangeBuckets(
+    const std::string& path,
+    const std::vector<std::map<std::string, std::vector<int32_t>>>&
+        bucket_max_shape,
+    const std::vector<std::map<std::string, std::vector<int32_t>>>&
+        bucket_opt_shape);
+TEST_API void DeserializeShapeRangeBuckets(
+    const std::string& path,
+    std::vector<std::map<std::string, std::vector<int32_t>>>* bucket_max_shape,
+    std::vector<std::map<std::string, std::vector<int32_t>>>*
+        bucket_opt_shape);
 TEST_API void UpdateShapeRangeInfo(
     const std::string& path,
     const std::map<std::string, std::vector<int32_t>>& min_shape,
@@ -0,0 +1,60 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace paddle {
+namespace inference {
+
+void LatencyHistogram::Record(double latency) {
+  latency = std::max(latency, 0.);
+  // The bucket i > 0 holds [2^((i - 1) / 4), 2^(i / 4)).
+  int bucket = 0;
+  if (latency >= 1.) {
+    bucket = static_cast<int>(std::log2(latency) * kBucketsPerOctave) + 1;
+    bucket = std::min(bucket, kNumBuckets - 1);
+  }
+  ++buckets_[bucket];
+  ++count_;
+  sum_ += latency;
+  max_ = std::max(max_, latency);
+}
+
+void LatencyHistogram::Clear() {
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  count_ = 0;
+  sum_ = 0.;
+  max_ = 0.;
+}
+
+double LatencyHistogram::Percentile(double percentile) const {
+  if (count_ == 0) return 0.;
+  const auto target = std::max<uint64_t>(
+      static_cast<uint64_t>(std::ceil(count_ * percentile / 100.)), 1);
+  uint64_t accumulated = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    accumulated += buckets_[i];
+    if (accumulated >= target && i + 1 < kNumBuckets) {
+      return std::min(std::exp2(static_cast<double>(i) / kBucketsPerOctave),
+                      max_);
+    }
+  }
+  return max_;
+}
+
+}  // namespace inference
+}  // namespace paddle
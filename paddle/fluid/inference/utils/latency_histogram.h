@@ -0,0 +1,55 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+//
+// The histogram of latencies in microseconds, whose buckets grow by 2^(1/4)
+// from 1us, so that a latency is recorded in constant time and memory, and a
+// percentile is off by at most 19%.
+//
+class TEST_API LatencyHistogram {
+ public:
+  static constexpr int kBucketsPerOctave = 4;
+  // The last bucket holds the latencies from 2^30us (about 18 minutes).
+  static constexpr int kNumBuckets = 30 * kBucketsPerOctave + 2;
+
+  LatencyHistogram() : buckets_(kNumBuckets, 0) {}
+
+  void Record(double latency);
+  void Clear();
+
+  uint64_t count() const { return count_; }
+  double avg() const { return count_ ? sum_ / count_ : 0.; }
+  double max() const { return max_; }
+  // The upper bound of the bucket of the percentile, no more than the max.
+  double Percentile(double percentile) const;
+
+ private:
+  std::vector<uint64_t> buckets_;
+  uint64_t count_{0};
+  double sum_{0.};
+  double max_{0.};
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,223 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/speculative_decoder.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "paddle/common/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+int64_t SampleToken(const float* probs, int vocab_size, std::mt19937_64* rng) {
+  double sum = 0;
+  for (int i = 0; i < vocab_size; ++i) {
+    sum += probs[i];
+  }
+  PADDLE_ENFORCE_GT(sum,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The probabilities to sample from sum up to %f.", sum));
+  double u = std::uniform_real_distribution<double>(0, sum)(*rng);
+  int last = 0;
+  for (int i = 0; i < vocab_size; ++i) {
+    if (probs[i] > 0) {
+      last = i;
+      u -= probs[i];
+      if (u < 0) {
+        return i;
+      }
+    }
+  }
+  // rounding errors
+  return last;
+}
+
+int VerifyDraftTokens(const std::vector<int64_t>& draft_tokens,
+                      const float* draft_probs,
+                      const float* target_probs,
+                      int vocab_size,
+                      std::mt19937_64* rng,
+                      int64_t* next_token) {
+  const int k = static_cast<int>(draft_tokens.size());
+  std::uniform_real_distribution<float> uniform(0, 1);
+  for (int i = 0; i < k; ++i) {
+    const float* q = draft_probs + i * vocab_size;
+    const float* p = target_probs + i * vocab_size;
+    const int64_t x = draft_tokens[i];
+    PADDLE_ENFORCE_EQ(
+        x >= 0 && x < vocab_size,
+        true,
+        common::errors::OutOfRange(
+            "The draft token %d is out of the vocab of size %d.",
+            x,
+            vocab_size));
+    // accepts x with the probability min(1, p(x) / q(x))
+    if (p[x] >= q[x] || uniform(*rng) * q[x] < p[x]) {
+      continue;
+    }
+    // resamples from the residual max(0, p - q) of the rejected token
+    std::vector<float> residual(vocab_size);
+    bool has_residual = false;
+    for (int j = 0; j < vocab_size; ++j) {
+      residual[j] = std::max(p[j] - q[j], 0.0f);
+      has_residual = has_residual || residual[j] > 0;
+    }
+    *next_token = has_residual ? SampleToken(residual.data(), vocab_size, rng)
+                               : SampleToken(p, vocab_size, rng);
+    return i;
+  }
+  *next_token = SampleToken(target_probs + k * vocab_size, vocab_size, rng);
+  return k;
+}
+
+SpeculativeDecoder::SpeculativeDecoder(ForwardFunc draft_forward,
+                                       ForwardFunc target_forward,
+                                       BlockKVCacheManager* draft_cache,
+                                       BlockKVCacheManager* target_cache,
+                                       int num_draft_tokens,
+                                       int vocab_size,
+                                       uint64_t seed)
+    : draft_forward_(std::move(draft_forward)),
+      target_forward_(std::move(target_forward)),
+      draft_cache_(draft_cache),
+      target_cache_(target_cache),
+      num_draft_tokens_(num_draft_tokens),
+      vocab_size_(vocab_size),
+      rng_(seed) {
+  PADDLE_ENFORCE_NOT_NULL(
+      draft_cache,
+      common::errors::InvalidArgument("The draft_cache should not be null."));
+  PADDLE_ENFORCE_NOT_NULL(
+      target_cache,
+      common::errors::InvalidArgument("The target_cache should not be null."));
+  PADDLE_ENFORCE_GT(
+      num_draft_tokens,
+      0,
+      common::errors::InvalidArgument(
+          "The num_draft_tokens should be greater than 0, but got %d.",
+          num_draft_tokens));
+  PADDLE_ENFORCE_GT(vocab_size,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The vocab_size should be greater than 0, but got %d.",
+                        vocab_size));
+}
+
+void SpeculativeDecoder::AddSequence(int64_t seq_id,
+                                     const std::vector<int64_t>& prompt) {
+  PADDLE_ENFORCE_EQ(
+      states_.count(seq_id),
+      0,
+      common::errors::AlreadyExists("The sequence %d already exists.", seq_id));
+  State state;
+  int num_cached = draft_cache_->AddSequence(seq_id, prompt);
+  state.draft_pending.assign(prompt.begin() + num_cached, prompt.end());
+  try {
+    num_cached = target_cache_->AddSequence(seq_id, prompt);
+  } catch (...) {
+    draft_cache_->FreeSequence(seq_id);
+    throw;
+  }
+  state.target_pending.assign(prompt.begin() + num_cached, prompt.end());
+  states_.emplace(seq_id, std::move(state));
+}
+
+std::vector<float> SpeculativeDecoder::Forward(
+    const ForwardFunc& forward,
+    int64_t seq_id,
+    const std::vector<int64_t>& tokens) {
+  std::vector<float> probs = forward(seq_id, tokens);
+  PADDLE_ENFORCE_EQ(
+      probs.size(),
+      tokens.size() * vocab_size_,
+      common::errors::InvalidArgument(
+          "The forward of %d tokens should give %d probabilities, but got %d.",
+          tokens.size(),
+          tokens.size() * vocab_size_,
+          probs.size()));
+  return probs;
+}
+
+std::vector<int64_t> SpeculativeDecoder::Step(int64_t seq_id) {
+  auto it = states_.find(seq_id);
+  PADDLE_ENFORCE_NE(
+      it,
+      states_.end(),
+      common::errors::NotFound("The sequence %d is not found.", seq_id));
+  State& state = it->second;
+  const int k = num_draft_tokens_;
+
+  // the draft model proposes the tokens one by one
+  std::vector<int64_t> draft_tokens(k);
+  std::vector<float> draft_probs(static_cast<size_t>(k) * vocab_size_);
+  for (int i = 0; i < k; ++i) {
+    std::vector<float> probs =
+        Forward(draft_forward_, seq_id, state.draft_pending);
+    const float* q =
+        probs.data() + (state.draft_pending.size() - 1) * vocab_size_;
+    std::copy(q, q + vocab_size_, draft_probs.data() + i * vocab_size_);
+    draft_tokens[i] = SampleToken(q, vocab_size_, &rng_);
+    draft_cache_->AppendTokens(seq_id, {draft_tokens[i]});
+    state.draft_pending.assign(1, draft_tokens[i]);
+  }
+
+  // the target model verifies them in one forward
+  target_cache_->AppendTokens(seq_id, draft_tokens);
+  state.target_pending.insert(
+      state.target_pending.end(), draft_tokens.begin(), draft_tokens.end());
+  std::vector<float> probs =
+      Forward(target_forward_, seq_id, state.target_pending);
+  const float* p =
+      probs.data() + (state.target_pending.size() - k - 1) * vocab_size_;
+  int64_t next_token = 0;
+  const int num_accepted = VerifyDraftTokens(
+      draft_tokens, draft_probs.data(), p, vocab_size_, &rng_, &next_token);
+  num_proposed_ += k;
+  num_accepted_ += num_accepted;
+
+  // rolls the caches back to the accepted tokens, the keys and values of the
+  // last draft token are not written by the draft model yet
+  const int num_rejected = k - num_accepted;
+  target_cache_->TruncateSequence(
+      seq_id, target_cache_->SequenceLength(seq_id) - num_rejected);
+  target_cache_->AppendTokens(seq_id, {next_token});
+  state.target_pending.assign(1, next_token);
+  draft_cache_->TruncateSequence(
+      seq_id, draft_cache_->SequenceLength(seq_id) - num_rejected);
+  if (num_rejected > 0) {
+    state.draft_pending.clear();
+  }
+  draft_cache_->AppendTokens(seq_id, {next_token});
+  state.draft_pending.push_back(next_token);
+
+  std::vector<int64_t> tokens(draft_tokens.begin(),
+                              draft_tokens.begin() + num_accepted);
+  tokens.push_back(next_token);
+  return tokens;
+}
+
+void SpeculativeDecoder::FreeSequence(int64_t seq_id) {
+  PADDLE_ENFORCE_EQ(
+      states_.erase(seq_id),
+      1,
+      common::errors::NotFound("The sequence %d is not found.", seq_id));
+  draft_cache_->FreeSequence(seq_id);
+  target_cache_->FreeSequence(seq_id);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/inference/utils/block_kv_cache_manager.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace inference {
+
+// Verifies the draft tokens proposed by a draft model with the
+// probabilities of the target model by speculative rejection sampling, so
+// that the tokens come out as if sampled from the target model alone.
+//
+// draft_probs is [k, vocab_size], the draft probabilities the k draft tokens
+// were sampled from, and target_probs is [k + 1, vocab_size], the target
+// probabilities after each of the tokens before them. Returns the number of
+// the accepted draft tokens, and writes the token sampled after them, which
+// replaces the first rejected one or follows all of them. One-hot
+// probabilities make it the greedy verification.
+TEST_API int VerifyDraftTokens(const std::vector<int64_t>& draft_tokens,
+                               const float* draft_probs,
+                               const float* target_probs,
+                               int vocab_size,
+                               std::mt19937_64* rng,
+                               int64_t* next_token);
+
+// Samples a token from the probabilities of vocab_size tokens.
+TEST_API int64_t SampleToken(const float* probs,
+                             int vocab_size,
+                             std::mt19937_64* rng);
+
+//
+// The speculative decoding loop of a draft model and a target model, whose
+// kv caches are managed by two BlockKVCacheManager.
+//
+// A step lets the draft model propose num_draft_tokens tokens one by one, the
+// target model verify them all in a single forward, and rolls the caches of
+// both models back to the accepted tokens. It gives 1 to num_draft_tokens + 1
+// tokens for a forward of the target model.
+//
+// The forwards are run by the callbacks, which get the tokens appended to the
+// sequence in their cache manager since their last forward, whose keys and
+// values they are to write to the blocks of BlockTable(), and return the
+// [tokens.size(), vocab_size] probabilities of the token after each of them,
+// e.g. by the top_p_sampling of the logits. Running the two predictors on
+// the same stream (Config::SetExecStream) keeps the steps free of syncs
+// between them.
+//
+class TEST_API SpeculativeDecoder {
+ public:
+  using ForwardFunc = std::function<std::vector<float>(
+      int64_t seq_id, const std::vector<int64_t>& tokens)>;
+
+  SpeculativeDecoder(ForwardFunc draft_forward,
+                     ForwardFunc target_forward,
+                     BlockKVCacheManager* draft_cache,
+                     BlockKVCacheManager* target_cache,
+                     int num_draft_tokens,
+                     int vocab_size,
+                     uint64_t seed = 0);
+
+  // Adds a sequence of the prompt to both caches, the tokens not in the
+  // caches are computed by the first Step().
+  void AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt);
+
+  // Decodes the next tokens of a sequence.
+  std::vector<int64_t> Step(int64_t seq_id);
+
+  void FreeSequence(int64_t seq_id);
+
+  // The ratio of the draft tokens accepted so far.
+  double AcceptanceRate() const {
+    return num_proposed_ == 0 ? 0.0
+                              : static_cast<double>(num_accepted_) /
+                                    static_cast<double>(num_proposed_);
+  }
+
+ private:
+  struct State {
+    // the tokens appended to the caches but not run by the models yet
+    std::vector<int64_t> draft_pending;
+    std::vector<int64_t> target_pending;
+  };
+
+  std::vector<float> Forward(const ForwardFunc& forward,
+                             int64_t seq_id,
+                             const std::vector<int64_t>& tokens);
+
+  ForwardFunc draft_forward_;
+  ForwardFunc target_forward_;
+  BlockKVCacheManager* draft_cache_;
+  BlockKVCacheManager* target_cache_;
+  const int num_draft_tokens_;
+  const int vocab_size_;
+  std::mt19937_64 rng_;
+  std::unordered_map<int64_t, State> states_;
+  int64_t num_proposed_{0};
+  int64_t num_accepted_{0};
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -16,6 +16,7 @@
 
 #include <set>
 
+#include "paddle/fluid/framework/io/param_file.h"
 #include "paddle/fluid/framework/var_desc.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/jit/engine/pir_interpreter_engine.h"
@@ -30,6 +31,7 @@
 
 COMMON_DECLARE_string(jit_engine_type);
 COMMON_DECLARE_bool(enable_pir_api);
+COMMON_DECLARE_int32(param_file_load_threads);
 namespace paddle {
 namespace jit {
 
@@ -128,6 +130,20 @@ void Deserializer::ReadTensorData(
     const phi::Place& place,
     std::shared_ptr<VariableMap> params_dict) const {
   VLOG(3) << "ReadTensorData from: " << file_name;
+  if (framework::IsParamFile(file_name)) {
+    framework::ParamFileReader reader(file_name);
+    std::vector<std::string> names(var_name.begin(), var_name.end());
+    std::vector<Variable> vars(names.size());
+    std::vector<DenseTensor*> tensors;
+    for (auto& v : vars) {
+      tensors.push_back(v.GetMutable<DenseTensor>());
+    }
+    reader.Read(names, place, tensors, FLAGS_param_file_load_threads);
+    for (size_t i = 0; i < names.size(); ++i) {
+      (*params_dict)[names[i]] = std::make_shared<Variable>(vars[i]);
+    }
+    return;
+  }
   std::ifstream fin(file_name, std::ios::binary);
   phi::DeviceContextPool& pool = phi::DeviceContextPool::Instance();
   auto& dev_ctx = *pool.Get(place);
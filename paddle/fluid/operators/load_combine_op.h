@@ -21,11 +21,14 @@ limitations under the License. */
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/io/param_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/phi/core/platform/device_context.h"
 #include "paddle/phi/core/vocab/string_array.h"
 
+COMMON_DECLARE_int32(param_file_load_threads);
+
 namespace paddle {
 namespace operators {
 template <typename T, typename DeviceContext>
@@ -44,7 +47,10 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "The number of variables to be loaded is %d, expect "
                           "it to be greater than 0.",
                           out_var_names.size()));
-    if (!model_from_memory) {
+    if (!model_from_memory && framework::IsParamFile(filename)) {
+      LoadParamsFromParamFile(
+          ctx, place, filename, load_as_fp16, out_var_names);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -67,6 +73,44 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     }
   }
 
+  void LoadParamsFromParamFile(
+      const framework::ExecutionContext &context,
+      const phi::Place &place,
+      const std::string &filename,
+      bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    auto out_vars = context.MultiOutputVar("Out");
+    std::vector<phi::DenseTensor *> tensors;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          common::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      tensors.push_back(out_vars[i]->GetMutable<phi::DenseTensor>());
+    }
+    framework::ParamFileReader reader(filename);
+    reader.Read(out_var_names, place, tensors, FLAGS_param_file_load_threads);
+    if (!load_as_fp16) {
+      return;
+    }
+    for (size_t i = 0; i < tensors.size(); i++) {
+      auto in_dtype = tensors[i]->dtype();
+      if (in_dtype == phi::DataType::FLOAT16) {
+        continue;
+      }
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type = phi::KernelKey(
+          place, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT16);
+      phi::DenseTensor fp16_tensor;
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, *tensors[i], &fp16_tensor);
+      out_vars[i]->Clear();
+      out_vars[i]->GetMutable<phi::DenseTensor>()->ShareDataWith(fp16_tensor);
+    }
+  }
+
   void LoadParamsFromBuffer(
       const framework::ExecutionContext &context,
       const phi::Place &place,
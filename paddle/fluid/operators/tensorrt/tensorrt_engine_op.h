@@ -15,7 +15,9 @@
 #pragma once
 
 #ifdef PADDLE_WITH_CUDA
+#include <chrono>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -29,6 +31,7 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/engine.h"
@@ -40,6 +43,7 @@
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/memory/memcpy.h"
+#include "paddle/phi/core/scope_guard.h"
 #include "paddle/phi/kernels/cast_kernel.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
 #include "paddle/utils/string/string_helper.h"
@@ -64,6 +68,7 @@ using inference::Singleton;
 using inference::tensorrt::TensorRTEngine;
 using inference::tensorrt::TRTCalibratorEngine;
 using inference::tensorrt::TRTCalibratorEngineManager;
+using inference::tensorrt::TRTEngineManager;
 using inference::tensorrt::TRTInt8Calibrator;
 
 static void RuntimeStaticShapeCheck(std::vector<int64_t> runtime_input_shape,
@@ -175,6 +180,17 @@ class TensorRTEngineOp : public framework::OperatorBase {
   std::string model_opt_cache_dir_;
   bool use_static_engine_;
   phi::DataType precision_mode_;
+  // The subgraph runs on the native kernels by RunNativeImpl until the engine
+  // built by async_engine_build_future_ is ready.
+  bool async_engine_build_{false};
+  mutable bool async_engine_ready_{false};
+  // RunNativeImpl keeps the intermediate variables in native_scope_, a child
+  // of native_parent_scope_, across the runs.
+  mutable const framework::Scope *native_parent_scope_{nullptr};
+  mutable framework::Scope *native_scope_{nullptr};
+  mutable std::unique_ptr<framework::ExecutorPrepareContext> native_ctx_;
+  // Declared last to wait for the build before the members it uses are gone.
+  mutable std::future<void> async_engine_build_future_;
 
  public:
   TensorRTEngineOp(const std::string &type,
@@ -200,6 +216,9 @@ class TensorRTEngineOp : public framework::OperatorBase {
     if (use_static_engine_) {
       model_opt_cache_dir_ = Attr<std::string>("model_opt_cache_dir");
     }
+    if (HasAttr("async_engine_build")) {
+      async_engine_build_ = Attr<bool>("async_engine_build");
+    }
 
     auto params = Attr<std::vector<std::string>>("parameters");
     for (const auto &param : params) {
@@ -254,14 +273,28 @@ class TensorRTEngineOp : public framework::OperatorBase {
   }
 
  protected:
+  // Runs the ops of the subgraph, whose intermediate variables are held by a
+  // child scope of scope across the runs.
   void RunNativeImpl(const framework::Scope &scope,
                      const phi::Place &dev_place) const {
     framework::Executor executor(dev_place);
-    auto *block = Attr<framework::BlockDesc *>("sub_block");
-    auto *program = block->Program();
-    auto &current_scope = scope.NewScope();
-    auto ctx = executor.Prepare(*program, block->ID());
-    executor.RunPreparedContext(ctx.get(), &current_scope, false, true, true);
+    if (native_parent_scope_ != &scope) {
+      auto *block = Attr<framework::BlockDesc *>("sub_block");
+      native_parent_scope_ = &scope;
+      native_scope_ = &scope.NewScope();
+      for (auto *op : block->AllOps()) {
+        for (auto &name : op->OutputArgumentNames()) {
+          if (scope.FindVar(name) == nullptr) {
+            framework::InitializeVariable(
+                native_scope_->Var(name),
+                framework::proto::VarType::LOD_TENSOR);
+          }
+        }
+      }
+      native_ctx_ = executor.Prepare(*block->Program(), block->ID());
+    }
+    executor.RunPreparedContext(
+        native_ctx_.get(), native_scope_, false, false, true);
   }
 
   void RunImpl(const framework::Scope &scope,
@@ -270,6 +303,10 @@ class TensorRTEngineOp : public framework::OperatorBase {
       RunCalibration(scope, dev_place);
       return;
     }
+    if (async_engine_build_ && !AsyncEngineReady(scope, dev_place)) {
+      RunNativeImpl(scope, dev_place);
+      return;
+    }
     auto *trt_engine = GetEngine(scope, dev_place);
     if (trt_engine->with_dynamic_shape()) {
       // get runtime input shapes and shape tensors.
@@ -399,40 +436,140 @@ class TensorRTEngineOp : public framework::OperatorBase {
           if (anc == nullptr) {
             anc = &scope;
           }
-          PrepareTRTEngine(*anc, trt_engine);
-          // update shape_range_info_pbtxt
-          if (!shape_range_info_path_.empty()) {
-            inference::UpdateShapeRangeInfo(shape_range_info_path_,
-                                            trt_engine->min_input_shape(),
-                                            trt_engine->max_input_shape(),
-                                            trt_engine->optim_input_shape(),
-                                            trt_engine->min_shape_tensor(),
-                                            trt_engine->max_shape_tensor(),
-                                            trt_engine->optim_shape_tensor(),
-                                            shape_changed_name,
-                                            tensor_changed_name);
-          }
-
-          if (use_static_engine_) {
-            nvinfer1::IHostMemory *serialized_engine_data =
-                trt_engine->Serialize();
-            std::string trt_engine_serialized_data =
-                std::string((const char *)serialized_engine_data->data(),
-                            serialized_engine_data->size());
-            inference::analysis::SaveTrtEngineSerializedDataToFile(
-                inference::analysis::GetTrtEngineSerializedPath(
-                    model_opt_cache_dir_, engine_key_),
-                trt_engine_serialized_data);
-            LOG(INFO) << "Save TRT Optimized Info to "
-                      << inference::analysis::GetTrtEngineSerializedPath(
-                             model_opt_cache_dir_, engine_key_);
+          if (async_engine_build_) {
+            RebuildEngineAsync(
+                *anc, dev_place, shape_changed_name, tensor_changed_name);
+            RunNativeImpl(scope, dev_place);
+            return;
           }
+          PrepareTRTEngine(*anc, trt_engine);
+          UpdateRebuiltEngine(
+              trt_engine, shape_changed_name, tensor_changed_name);
         }
       }
+      trt_engine->SelectShapeBucket(runtime_input_shape);
     }
     RunTrt(scope, dev_place, trt_engine);
   }
 
+  void SaveTRTEngine(TensorRTEngine *trt_engine) const {
+    nvinfer1::IHostMemory *serialized_engine_data = trt_engine->Serialize();
+    std::string trt_engine_serialized_data =
+        std::string((const char *)serialized_engine_data->data(),
+                    serialized_engine_data->size());
+    inference::analysis::SaveTrtEngineSerializedDataToFile(
+        inference::analysis::GetTrtEngineSerializedPath(model_opt_cache_dir_,
+                                                        engine_key_),
+        trt_engine_serialized_data);
+    LOG(INFO) << "Save TRT Optimized Info to "
+              << inference::analysis::GetTrtEngineSerializedPath(
+                     model_opt_cache_dir_, engine_key_);
+  }
+
+  // Saves the shape ranges and the engine rebuilt for the adjusted ranges.
+  void UpdateRebuiltEngine(
+      TensorRTEngine *trt_engine,
+      const std::vector<std::string> &shape_changed_name,
+      const std::vector<std::string> &tensor_changed_name) const {
+    // update shape_range_info_pbtxt
+    if (!shape_range_info_path_.empty()) {
+      inference::UpdateShapeRangeInfo(shape_range_info_path_,
+                                      trt_engine->min_input_shape(),
+                                      trt_engine->max_input_shape(),
+                                      trt_engine->optim_input_shape(),
+                                      trt_engine->min_shape_tensor(),
+                                      trt_engine->max_shape_tensor(),
+                                      trt_engine->optim_shape_tensor(),
+                                      shape_changed_name,
+                                      tensor_changed_name);
+    }
+
+    if (use_static_engine_) {
+      SaveTRTEngine(trt_engine);
+    }
+  }
+
+  // Rebuilds the engine for the shape ranges adjusted to the live shapes in
+  // the background, and the subgraph runs on the native kernels until
+  // AsyncEngineReady finds it ready, so the runs are not stalled by the build.
+  void RebuildEngineAsync(
+      const framework::Scope &root_scope,
+      const phi::Place &dev_place,
+      const std::vector<std::string> &shape_changed_name,
+      const std::vector<std::string> &tensor_changed_name) const {
+    const int predictor_id = TensorRTEngine::predictor_id_per_thread;
+    LOG(INFO) << "Rebuild TRT engine " << engine_key_
+              << " for the adjusted shape ranges in the background.";
+    async_engine_ready_ = false;
+    Singleton<TRTEngineManager>::Global().BeginAsyncBuild();
+    async_engine_build_future_ =
+        std::async(std::launch::async,
+                   [this,
+                    root_scope = &root_scope,
+                    dev_place,
+                    predictor_id,
+                    shape_changed_name,
+                    tensor_changed_name] {
+                     DEFINE_PADDLE_SCOPE_GUARD([] {
+                       Singleton<TRTEngineManager>::Global().EndAsyncBuild();
+                     });
+                     TensorRTEngine::predictor_id_per_thread = predictor_id;
+                     platform::SetDeviceId(dev_place.device);
+                     PrepareTRTEngine(*root_scope, trt_engine_);
+                     UpdateRebuiltEngine(
+                         trt_engine_, shape_changed_name, tensor_changed_name);
+                   });
+  }
+
+  // Starts building the engine in the background at the first call, and
+  // returns whether the engine is ready for the following runs.
+  bool AsyncEngineReady(const framework::Scope &scope,
+                        const phi::Place &dev_place) const {
+    if (async_engine_ready_) return true;
+    if (!async_engine_build_future_.valid()) {
+      if (trt_engine_ != nullptr && trt_engine_->engine() != nullptr) {
+        // the engine is loaded from the serialized cache
+        async_engine_ready_ = true;
+        return true;
+      }
+      const framework::Scope *root_scope = &scope;
+      while (root_scope->parent()) {
+        root_scope = root_scope->parent();
+      }
+      const int predictor_id = TensorRTEngine::predictor_id_per_thread;
+      LOG(INFO) << "Build TRT engine " << engine_key_
+                << " in the background, the subgraph runs on the native "
+                   "kernels until it is ready.";
+      Singleton<TRTEngineManager>::Global().BeginAsyncBuild();
+      async_engine_build_future_ = std::async(
+          std::launch::async, [this, root_scope, dev_place, predictor_id] {
+            DEFINE_PADDLE_SCOPE_GUARD([] {
+              Singleton<TRTEngineManager>::Global().EndAsyncBuild();
+            });
+            TensorRTEngine::predictor_id_per_thread = predictor_id;
+            platform::SetDeviceId(dev_place.device);
+            if (trt_engine_ == nullptr) {
+              GetEngine(*root_scope, dev_place);
+            } else {
+              PrepareTRTEngine(*root_scope, trt_engine_);
+            }
+            if (use_static_engine_) {
+              SaveTRTEngine(trt_engine_);
+            }
+          });
+      return false;
+    }
+    if (async_engine_build_future_.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return false;
+    }
+    // rethrows the error of the build
+    async_engine_build_future_.get();
+    async_engine_ready_ = true;
+    LOG(INFO) << "TRT engine " << engine_key_ << " is ready.";
+    return true;
+  }
+
   void RunCalibration(const framework::Scope &scope,
                       const phi::Place &dev_place) const {
     // This process will builds a 32-bit trt engine, runs it on the calibration
@@ -700,7 +837,8 @@ class TensorRTEngineOp : public framework::OperatorBase {
                                     int32_tensor->numel() * sizeof(int),
                                     nullptr);
           }
-          trt_context->setTensorAddress(x.c_str(), shape_v.data());
+          trt_context->setTensorAddress(
+              x.c_str(), engine->SetShapeTensorValues(x, shape_v));
         } else {
           trt_context->setInputShape(
               x.c_str(), inference::tensorrt::Vec2TRT_Dims(t_shape, x, true));
@@ -986,6 +1124,16 @@ class TensorRTEngineOp : public framework::OperatorBase {
       if (HasAttr("engine_info_path")) {
         params.engine_info_path = Attr<std::string>("engine_info_path");
       }
+      if (HasAttr("refit")) {
+        params.refittable = Attr<bool>("refit");
+      }
+      if (HasAttr("activation_range_names")) {
+        auto names = Attr<std::vector<std::string>>("activation_range_names");
+        auto values = Attr<std::vector<float>>("activation_range_values");
+        for (size_t i = 0; i < names.size(); ++i) {
+          params.activation_ranges[names[i]] = values[i];
+        }
+      }
       if (HasAttr("optimization_level")) {
         params.optimization_level = Attr<int>("optimization_level");
       }
@@ -997,6 +1145,10 @@ class TensorRTEngineOp : public framework::OperatorBase {
                                              &params.min_shape_tensor,
                                              &params.max_shape_tensor,
                                              &params.optim_shape_tensor);
+        inference::DeserializeShapeRangeBuckets(
+            shape_range_info_path_,
+            &params.bucket_max_input_shape,
+            &params.bucket_optim_input_shape);
       } else {
         if (HasAttr("dynamic_shape_names") &&
             HasAttr("min_input_shape_vector") &&
@@ -197,6 +197,7 @@ NO_NEED_GEN_STATIC_ONLY_APIS = [
     'fused_gate_attention',
     'fused_multi_transformer_int8',
     'fused_seqpool_cvm',
+    'fusion_emb_seqpool_cvm_concat',
     'fusion_group',
     'fusion_lstm',
     'fusion_seqpool_cvm_concat',
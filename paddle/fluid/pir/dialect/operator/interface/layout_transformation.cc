@@ -24,6 +24,32 @@
 
 namespace paddle::dialect {
 
+namespace {
+
+// The convolutions run in NHWC on the Tensor Cores for the dtypes of AMP.
+bool IsAmpDtype(pir::Type dtype) {
+  return dtype.isa<pir::Float16Type>() || dtype.isa<pir::BFloat16Type>();
+}
+
+// The NHWC kernels of cuDNN on the Tensor Cores need the input and output
+// channels, dims[1] and dims[0] of the filter, to be multiples of 8, or the
+// channels are padded on every call and the transposes do not pay off. The
+// unknown channels count as misaligned only when `strict` is set.
+bool HasMisalignedChannels(const common::DDim& filter_dims, bool strict) {
+  constexpr int64_t CUDNN_ALIGNMENT = 8;
+  if (filter_dims.size() != 4) {
+    return strict;
+  }
+  for (int i = 0; i < 2; ++i) {
+    if (filter_dims[i] < 0 ? strict : filter_dims[i] % CUDNN_ALIGNMENT != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 template <typename ConcreteOp>
 void RewriteByInfermeta(pir::Operation* op, common::DataLayout new_layout) {
   std::vector<pir::Type> new_outputs = ConcreteOp::InferMeta(
@@ -87,16 +113,11 @@ common::DataLayout PreferLayoutImpl<Conv2dOp>(pir::Operation* op) {
   }
 
   auto concrete_op = op->dyn_cast<Conv2dOp>();
-  if (auto in = concrete_op.input()) {
-    if (auto in_type = in.type()) {
-      if (in_type.isa<DenseTensorType>()) {
-        if (auto tensor_type = in_type.dyn_cast<DenseTensorType>()) {
-          if (tensor_type.dtype().isa<pir::Float16Type>()) {
-            return common::DataLayout::NHWC;
-          }
-        }
-      }
-    }
+  auto in_type = concrete_op.input().type().dyn_cast<DenseTensorType>();
+  auto filter_type = concrete_op.filter().type().dyn_cast<DenseTensorType>();
+  if (in_type && filter_type && IsAmpDtype(in_type.dtype()) &&
+      !HasMisalignedChannels(filter_type.dims(), false)) {
+    return common::DataLayout::NHWC;
   }
 
   return common::StringToDataLayout(data_format_attr.AsString());
@@ -144,7 +165,7 @@ common::DataLayout PreferLayoutImpl<FusedConv2dAddActOp>(pir::Operation* op) {
       if (in_type.isa<paddle::dialect::DenseTensorType>()) {
         if (auto tensor_type =
                 in_type.dyn_cast<paddle::dialect::DenseTensorType>()) {
-          if (!tensor_type.dtype().isa<pir::Float16Type>()) {
+          if (!IsAmpDtype(tensor_type.dtype())) {
             return original_layout;
           }
         }
@@ -152,18 +173,13 @@ common::DataLayout PreferLayoutImpl<FusedConv2dAddActOp>(pir::Operation* op) {
     }
   }
 
-  constexpr int CUDNN_ALIGNMENT = 8;
-
   if (auto filter = concrete_op.filter()) {
     if (auto filter_type = filter.type()) {
       if (filter_type.isa<DenseTensorType>()) {
         if (auto tensor_type = filter_type.dyn_cast<DenseTensorType>()) {
-          if (tensor_type.dtype().isa<pir::Float16Type>()) {
-            auto dims = tensor_type.dims();
-            if (dims.size() == 4 && (dims[0] % CUDNN_ALIGNMENT == 0) &&
-                (dims[1] % CUDNN_ALIGNMENT == 0)) {
-              return common::DataLayout::NHWC;
-            }
+          if (IsAmpDtype(tensor_type.dtype()) &&
+              !HasMisalignedChannels(tensor_type.dims(), true)) {
+            return common::DataLayout::NHWC;
           }
         }
       }
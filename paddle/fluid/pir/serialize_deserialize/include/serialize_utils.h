@@ -21,6 +21,9 @@
 #include "paddle/common/layout.h"
 #include "paddle/fluid/pir/dialect/distributed/ir/dist_attribute.h"
 #include "paddle/fluid/pir/dialect/distributed/ir/dist_type.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_attribute.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_attribute.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/schema.h"
@@ -56,6 +59,10 @@ class AttrTypeWriter {
   static Json WritePaddleDistAttr(const pir::Attribute& attr);
 
   static Json WriteControlFlowType(const pir::Type& type);
+
+  static Json WritePaddleKernelType(const pir::Type& type);
+
+  static Json WritePaddleKernelAttr(const pir::Attribute& attr);
 };
 /** serializeTypeToJson is a template function to serialize
  * a pir type to a json object. a pir type may have value or no value
@@ -218,16 +225,40 @@ Json serializeAttrToJson<paddle::dialect::ScalarAttribute>(
   return json_obj;
 }
 
+Json writePlace(const phi::Place& place) {
+  Json content = Json::array();
+  content.push_back(static_cast<int8_t>(place.GetType()));
+  content.push_back(place.GetDeviceId());    // int8_t
+  content.push_back(place.GetDeviceType());  // string
+  return content;
+}
+
 template <>
 Json serializeAttrToJson<paddle::dialect::PlaceAttribute>(
     const paddle::dialect::PlaceAttribute& attr) {
   Json json_obj;
   json_obj[ID] = COMPRESS_DIALECT_NAME(attr) + "." + attr.name();
+  json_obj[DATA] = writePlace(attr.data());
+  return json_obj;
+}
+
+// KernelKey includes: Backend backend, DataLayout layout, DataType dtype. The
+// backends of custom devices are saved by their device type, since their
+// enum values are assigned at runtime.
+template <>
+Json serializeAttrToJson<paddle::dialect::KernelAttribute>(
+    const paddle::dialect::KernelAttribute& attr) {
+  Json json_obj;
+  json_obj[ID] = COMPRESS_DIALECT_NAME(attr) + "." + attr.name();
   Json content = Json::array();
-  auto place = attr.data();
-  content.push_back(static_cast<int8_t>(place.GetType()));
-  content.push_back(place.GetDeviceId());    // int8_t
-  content.push_back(place.GetDeviceType());  // string
+  auto kernel_key = attr.data();
+  if (kernel_key.backend() < phi::Backend::NUM_BACKENDS) {
+    content.push_back(static_cast<int>(kernel_key.backend()));
+  } else {
+    content.push_back(phi::BackendToString(kernel_key.backend()));
+  }
+  content.push_back(DataLayoutToString(kernel_key.layout()));
+  content.push_back(phi::DataTypeToString(kernel_key.dtype()));
   json_obj[DATA] = content;
   return json_obj;
 }
@@ -251,6 +282,9 @@ Json writeType(const pir::Type& type) {
   } else if (type.dialect().name() == pir::ControlFlowDialect::name()) {
     VLOG(6) << "write ControlFlowDialect ... ";
     return AttrTypeWriter::WriteControlFlowType(type);
+  } else if (type.dialect().name() == paddle::dialect::KernelDialect::name()) {
+    VLOG(6) << "write PaddleKernelType ... ";
+    return AttrTypeWriter::WritePaddleKernelType(type);
   } else {
     PADDLE_ENFORCE(
         false,
@@ -274,6 +308,9 @@ Json writeAttr(const pir::Attribute& attr) {
   } else if (attr.dialect().name() == paddle::dialect::DistDialect::name()) {
     VLOG(8) << "write PaddleDistAttr ... ";
     return AttrTypeWriter::WritePaddleDistAttr(attr);
+  } else if (attr.dialect().name() == paddle::dialect::KernelDialect::name()) {
+    VLOG(8) << "write PaddleKernelAttr ... ";
+    return AttrTypeWriter::WritePaddleKernelAttr(attr);
   } else {
     PADDLE_ENFORCE(
         false,
@@ -556,6 +593,19 @@ Json serializeTypeToJsonIncludeWriteType<paddle::dialect::DistDenseTensorType>(
   return json_obj;
 }
 
+// The allocated types of kernel dialect include: phi::Place place, pir::Type
+// prim_type which is the type before lowering.
+template <typename T>
+Json serializeAllocatedTypeToJson(const T& type) {
+  Json json_obj;
+  json_obj[ID] = COMPRESS_DIALECT_NAME(type) + "." + type.name();
+  Json content = Json::array();
+  content.push_back(writePlace(type.place()));
+  content.push_back(writeType(T(type).prim_type()));
+  json_obj[DATA] = content;
+  return json_obj;
+}
+
 Json AttrTypeWriter::WriteBuiltInType(const pir::Type& type) {
   Json type_json = Json::object();
   if (type.isa<pir::BoolType>()) {
@@ -751,4 +801,41 @@ Json AttrTypeWriter::WriteControlFlowType(const pir::Type& type) {
   return type_json;
 }
 
+Json AttrTypeWriter::WritePaddleKernelType(const pir::Type& type) {
+  if (type.isa<paddle::dialect::AllocatedDenseTensorType>()) {
+    VLOG(8) << "Write AllocatedDenseTensorType ... ";
+    return pir::serializeAllocatedTypeToJson<
+        paddle::dialect::AllocatedDenseTensorType>(
+        type.dyn_cast<paddle::dialect::AllocatedDenseTensorType>());
+  } else if (type.isa<paddle::dialect::AllocatedSelectedRowsType>()) {
+    VLOG(8) << "Write AllocatedSelectedRowsType ... ";
+    return pir::serializeAllocatedTypeToJson<
+        paddle::dialect::AllocatedSelectedRowsType>(
+        type.dyn_cast<paddle::dialect::AllocatedSelectedRowsType>());
+  } else if (type.isa<paddle::dialect::AllocatedDenseTensorArrayType>()) {
+    VLOG(8) << "Write AllocatedDenseTensorArrayType ... ";
+    return pir::serializeAllocatedTypeToJson<
+        paddle::dialect::AllocatedDenseTensorArrayType>(
+        type.dyn_cast<paddle::dialect::AllocatedDenseTensorArrayType>());
+  } else {
+    PADDLE_ENFORCE(false,
+                   common::errors::InvalidArgument(
+                       "Unknown Type when write paddle.kerneldialect type"));
+    return Json::object();
+  }
+}
+
+Json AttrTypeWriter::WritePaddleKernelAttr(const pir::Attribute& attr) {
+  if (attr.isa<paddle::dialect::KernelAttribute>()) {
+    VLOG(8) << "write KernelAttribute .";
+    return pir::serializeAttrToJson<paddle::dialect::KernelAttribute>(
+        attr.dyn_cast<paddle::dialect::KernelAttribute>());
+  } else {
+    PADDLE_ENFORCE(false,
+                   common::errors::InvalidArgument(
+                       "Unknown Attr %s when write paddle.kerneldialect attr"));
+  }
+  return Json::object();
+}
+
 }  // namespace pir
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include <stdio.h>
+#include <iterator>
+#include <vector>
 #include "paddle/common/enforce.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
@@ -31,7 +33,8 @@ void WriteModule(const pir::Program& program,
                  uint64_t pir_version,
                  bool overwrite,
                  bool readable,
-                 bool trainable) {
+                 bool trainable,
+                 bool binary) {
   PADDLE_ENFORCE_EQ(
       FileExists(file_path) && !overwrite,
       false,
@@ -49,12 +52,6 @@ void WriteModule(const pir::Program& program,
   ProgramWriter writer(pir_version, trainable);
   // write program
   total[PROGRAM] = writer.GetProgramJson(&program);
-  std::string total_str;
-  if (readable) {
-    total_str = total.dump(4);
-  } else {
-    total_str = total.dump();
-  }
 
   MkDirRecursively(DirName(file_path).c_str());
   std::ofstream fout(file_path, std::ios::binary);
@@ -62,15 +59,37 @@ void WriteModule(const pir::Program& program,
                     true,
                     common::errors::Unavailable(
                         "Cannot open %s to save variables.", file_path));
-  fout << total_str;
+  if (binary) {
+    std::vector<uint8_t> total_bytes = Json::to_cbor(total);
+    fout.write(reinterpret_cast<const char*>(total_bytes.data()),
+               static_cast<std::streamsize>(total_bytes.size()));
+  } else if (readable) {
+    fout << total.dump(4);
+  } else {
+    fout << total.dump();
+  }
   fout.close();
 }
 
 bool ReadModule(const std::string& file_path,
                 pir::Program* program,
                 int64_t pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
+  std::ifstream f(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(f),
+                    true,
+                    common::errors::Unavailable(
+                        "Cannot open %s to load the program.", file_path));
+  // A json file starts with '{' after whitespaces, while the CBOR encoding
+  // of an object never starts with it.
+  f >> std::ws;
+  Json data;
+  if (f.peek() == '{') {
+    data = Json::parse(f);
+  } else {
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)),
+                               std::istreambuf_iterator<char>());
+    data = Json::from_cbor(bytes);
+  }
   if (pir_version < 0) {
     pir_version = DEVELOP_VERSION;
     VLOG(6) << "pir_version is null, get pir_version: " << pir_version;
@@ -14,11 +14,15 @@ limitations under the License. */
 #include <numeric>
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/io/param_file.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/phi/common/port.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
 
+COMMON_DECLARE_int32(param_file_load_threads);
+
 namespace pir {
 
 const phi::DeviceContext* GetDeviceContext(
@@ -191,6 +195,27 @@ void LoadCombineFunction(const std::string& file_path,
                          std::vector<phi::DenseTensor*>* out,
                          bool load_as_fp16,
                          phi::Place place) {
+  if (paddle::framework::IsParamFile(file_path)) {
+    PADDLE_ENFORCE_GT(out->size(),
+                      0UL,
+                      common::errors::InvalidArgument(
+                          "The number of variables to be loaded is %d, "
+                          "expect it to be greater than 0.",
+                          out->size()));
+    const phi::DeviceContext* dev_ctx = GetDeviceContext(*(out->at(0)), place);
+    paddle::framework::ParamFileReader reader(file_path);
+    reader.Read(
+        names, dev_ctx->GetPlace(), *out, FLAGS_param_file_load_threads);
+    if (load_as_fp16) {
+      for (auto* tensor : *out) {
+        if (tensor->dtype() != phi::DataType::FLOAT16) {
+          auto cast_in = *tensor;
+          *tensor = CastTensorType(dev_ctx, cast_in, phi::DataType::FLOAT16);
+        }
+      }
+    }
+    return;
+  }
   std::ifstream fin(file_path, std::ios::binary);
   PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
                     true,
@@ -55,6 +55,11 @@ DialectIdMap::DialectIdMap() {
   insert(pir::ControlFlowDialect::name(), "2");
   insert(paddle::dialect::CustomOpDialect::name(), "3");
   insert(paddle::dialect::DistDialect::name(), "4");
+  insert(paddle::dialect::KernelDialect::name(), "5");
+  insert(paddle::dialect::CustomKernelDialect::name(), "6");
+#ifdef PADDLE_WITH_DNNL
+  insert(paddle::dialect::OneDNNKernelDialect::name(), "7");
+#endif
   // TestDialect for test use
   insert(test::TestDialect::name(), "-1");
   insert(test1::Test1Dialect::name(), "-2");
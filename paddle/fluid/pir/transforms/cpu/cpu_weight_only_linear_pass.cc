@@ -0,0 +1,178 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/cpu/cpu_weight_only_linear_pass.h"
+
+#include <utility>
+
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/drr/include/drr_pattern_base.h"
+#include "paddle/fluid/pir/utils/general_functions.h"
+
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// NOTE: The weight is quantized by weight_quantize with arch 0, which is the
+// layout of the CPU kernel of weight_only_linear, and folded into a parameter
+// by constant_folding_pass.
+class CpuWeightOnlyLinearPattern : public paddle::drr::DrrPatternBase {
+ private:
+  bool with_bias_;
+  bool reverse_add_;
+  std::string algo_;
+
+ public:
+  CpuWeightOnlyLinearPattern(bool with_bias, bool reverse_add, std::string algo)
+      : with_bias_(with_bias),
+        reverse_add_(reverse_add),
+        algo_(std::move(algo)) {}
+
+  std::string name() const override {
+    return with_bias_ ? "CpuWeightOnlyLinearWithBiasPattern"
+                      : "CpuWeightOnlyLinearNoBiasPattern";
+  }
+
+  uint32_t benefit() const override { return with_bias_ ? 2 : 1; }
+
+  void operator()(paddle::drr::DrrPatternContext *ctx) const override {
+    //
+    // Source Pattern.
+    //
+    paddle::drr::SourcePattern src = ctx->SourcePattern();
+    const auto &matmul =
+        src.Op(paddle::dialect::MatmulOp::name(),
+               {{"transpose_x", src.Attr("matmul_transpose_x")},
+                {"transpose_y", src.Attr("matmul_transpose_y")}});
+    src.Tensor("matmul_out") = matmul(src.Tensor("x"), src.Tensor("w"));
+    if (with_bias_) {
+      const auto &add = src.Op(paddle::dialect::AddOp::name());
+      src.Tensor("add_out") =
+          reverse_add_ ? add(src.Tensor("matmul_out"), src.Tensor("bias"))
+                       : add(src.Tensor("bias"), src.Tensor("matmul_out"));
+    }
+
+    //
+    // Constraints.
+    //
+    bool with_bias = with_bias_;
+    bool is_int4 = algo_ == "weight_only_int4";
+    src.AddConstraint([=](const paddle::drr::MatchContext &match_ctx) -> bool {
+      if (!pir::ValueIsPersistable(match_ctx.Tensor("w"))) {
+        return false;
+      }
+      bool matmul_trans_x = match_ctx.Attr<bool>("matmul_transpose_x");
+      bool matmul_trans_y = match_ctx.Attr<bool>("matmul_transpose_y");
+      if (matmul_trans_x || matmul_trans_y) return false;
+
+      auto w_dtype = pir::GetDataTypeFromValue(match_ctx.Tensor("w"));
+      if (!w_dtype.isa<pir::Float32Type>() &&
+          !w_dtype.isa<pir::BFloat16Type>()) {
+        return false;
+      }
+
+      auto w_dims = pir::GetShapeFromValue(match_ctx.Tensor("w"));
+      auto x_dims = pir::GetShapeFromValue(match_ctx.Tensor("x"));
+      if (!(w_dims.size() == 2 && x_dims.size() >= 2)) return false;
+      if (with_bias) {
+        auto bias_dims = pir::GetShapeFromValue(match_ctx.Tensor("bias"));
+        if (!(bias_dims.size() == 1 && bias_dims.at(0) == w_dims.at(1))) {
+          return false;
+        }
+      }
+
+      // the int4 weight packs two output channels in a row of 16x
+      if (w_dims.at(0) % 64 != 0 || w_dims.at(1) % (is_int4 ? 32 : 16) != 0) {
+        return false;
+      }
+      if (x_dims.at(x_dims.size() - 1) != w_dims.at(0)) return false;
+
+      return true;
+    });
+    //
+    // Result Pattern.
+    //
+    paddle::drr::ResultPattern res = src.ResultPattern();
+
+    const auto &weight_quantize =
+        res.Op(paddle::dialect::WeightQuantizeOp::name(),
+               {{"algo", res.StrAttr(algo_)},
+                {"arch", res.Int32Attr(0)},
+                {"group_size", res.Int32Attr(-1)}});
+    weight_quantize({&res.Tensor("w")},
+                    {&res.Tensor("quanted_weight_tensor"),
+                     &res.Tensor("weight_scale_tensor")});
+
+    const auto &weight_only_linear =
+        res.Op(paddle::dialect::WeightOnlyLinearOp::name(),
+               {{"weight_dtype", res.StrAttr(is_int4 ? "int4" : "int8")},
+                {"arch", res.Int32Attr(0)},
+                {"group_size", res.Int32Attr(-1)}});
+    weight_only_linear(
+        {&res.Tensor("x"),
+         with_bias_ ? &res.Tensor("bias") : &res.InputNoneTensor(),
+         &res.Tensor("quanted_weight_tensor"),
+         &res.Tensor("weight_scale_tensor")},
+        {&res.Tensor(with_bias_ ? "add_out" : "matmul_out")});
+  }
+};
+
+class CpuWeightOnlyLinearPass : public pir::PatternRewritePass {
+ public:
+  CpuWeightOnlyLinearPass()
+      : pir::PatternRewritePass("cpu_weight_only_linear_pass", 4) {}
+
+  pir::RewritePatternSet InitializePatterns(pir::IrContext *context) override {
+    std::string algo = "weight_only_int8";
+    if (Has("weight_only_algo")) {
+      algo = Get<std::string>("weight_only_algo");
+    }
+    PADDLE_ENFORCE_EQ(algo == "weight_only_int8" || algo == "weight_only_int4",
+                      true,
+                      common::errors::InvalidArgument(
+                          "cpu_weight_only_linear_pass only support "
+                          "weight_only_int8 or weight_only_int4, but get %s.",
+                          algo));
+
+    pir::RewritePatternSet ps(context);
+    ps.Add(paddle::drr::Create<CpuWeightOnlyLinearPattern>(
+        context, true, true, algo));
+    ps.Add(paddle::drr::Create<CpuWeightOnlyLinearPattern>(
+        context, true, false, algo));
+    ps.Add(paddle::drr::Create<CpuWeightOnlyLinearPattern>(
+        context, false, false, algo));
+    return ps;
+  }
+
+  pir::GreedyRewriteConfig InitializeConfig() override {
+    pir::GreedyRewriteConfig config;
+
+    // NOTE: Ensure that WithBiasPattern is executed before NoBiasPattern.
+    config.use_top_down_traversal = false;
+
+    config.max_iterations = 10;
+    return config;
+  }
+};
+
+}  // namespace
+
+namespace pir {
+std::unique_ptr<Pass> CreateCpuWeightOnlyLinearPass() {
+  return std::make_unique<CpuWeightOnlyLinearPass>();
+}
+}  // namespace pir
+
+REGISTER_IR_PASS(cpu_weight_only_linear_pass, CpuWeightOnlyLinearPass);
@@ -0,0 +1,254 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/remove_redundant_transfer_pass.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// The transfer ops inserted by PdOpLowerToKernelPass, which only change the
+// place, the dtype or the layout of their input.
+const std::unordered_set<std::string> kTransferOps = {
+    "pd_op.memcpy_h2d",
+    "pd_op.memcpy_d2h",
+    "pd_op.cast",
+    "pd_op.onednn_to_paddle_layout",
+};
+
+// The attributes not taking part in the transfer.
+const std::unordered_set<std::string> kIgnoredAttributes = {
+    "origin_id",
+    "op_name",
+};
+
+std::string KernelOpName(const pir::Operation* op) {
+  if (!op || !op->isa<paddle::dialect::PhiKernelOp>()) return "";
+  return op->attributes()
+      .at("op_name")
+      .dyn_cast<pir::StrAttribute>()
+      .AsString();
+}
+
+bool IsTransferOp(const pir::Operation* op) {
+  return op->num_operands() == 1 && op->num_results() == 1 &&
+         kTransferOps.count(KernelOpName(op)) > 0;
+}
+
+bool IsInplaceOp(const pir::Operation* op) {
+  auto it = op->attributes().find("is_inplace");
+  return it != op->attributes().end() &&
+         it->second.dyn_cast<pir::BoolAttribute>().data();
+}
+
+// Whether the uses of value read it after the replacement the same as they
+// did before: no use writes to it, and no control flow op keeps it alive.
+bool IsReplaceable(pir::Value value) {
+  for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+    auto* user = it->owner();
+    if (IsInplaceOp(user) || user->isa<pir::YieldOp>() ||
+        user->isa<paddle::dialect::WhileOp>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsSameTransfer(const pir::Operation* lhs, const pir::Operation* rhs) {
+  if (KernelOpName(lhs) != KernelOpName(rhs) ||
+      lhs->result(0).type() != rhs->result(0).type()) {
+    return false;
+  }
+  auto same_attributes = [](const pir::Operation* a, const pir::Operation* b) {
+    for (const auto& [name, attr] : a->attributes()) {
+      if (kIgnoredAttributes.count(name)) continue;
+      auto it = b->attributes().find(name);
+      if (it == b->attributes().end() || it->second != attr) return false;
+    }
+    return true;
+  };
+  return same_attributes(lhs, rhs) && same_attributes(rhs, lhs);
+}
+
+phi::DataType DtypeOf(pir::Type type) {
+  if (!type.isa<paddle::dialect::AllocatedDenseTensorType>()) {
+    return phi::DataType::UNDEFINED;
+  }
+  return paddle::dialect::TransToPhiDataType(
+      type.dyn_cast<paddle::dialect::AllocatedDenseTensorType>().dtype());
+}
+
+// Whether every value of src is represented exactly in dst.
+bool IsLosslessCast(phi::DataType src, phi::DataType dst) {
+  using phi::DataType;
+  static const std::unordered_map<DataType, std::unordered_set<DataType>>
+      kWiderTypes = {
+          {DataType::FLOAT16, {DataType::FLOAT32, DataType::FLOAT64}},
+          {DataType::BFLOAT16, {DataType::FLOAT32, DataType::FLOAT64}},
+          {DataType::FLOAT32, {DataType::FLOAT64}},
+          {DataType::INT8,
+           {DataType::INT16, DataType::INT32, DataType::INT64}},
+          {DataType::UINT8,
+           {DataType::INT16, DataType::INT32, DataType::INT64}},
+          {DataType::INT16, {DataType::INT32, DataType::INT64}},
+          {DataType::INT32, {DataType::INT64}},
+      };
+  if (src == DataType::BOOL) return dst != DataType::UNDEFINED;
+  auto it = kWiderTypes.find(src);
+  return it != kWiderTypes.end() && it->second.count(dst) > 0;
+}
+
+// Whether second(first(x)) is x, with second taking the result of first.
+bool IsRoundTrip(const pir::Operation* first, const pir::Operation* second) {
+  pir::Value in = first->operand_source(0);
+  if (second->result(0).type() != in.type()) return false;
+  std::string first_name = KernelOpName(first);
+  std::string second_name = KernelOpName(second);
+  if ((first_name == "pd_op.memcpy_d2h" &&
+       second_name == "pd_op.memcpy_h2d") ||
+      (first_name == "pd_op.memcpy_h2d" &&
+       second_name == "pd_op.memcpy_d2h")) {
+    return true;
+  }
+  if (first_name == "pd_op.cast" && second_name == "pd_op.cast") {
+    return IsLosslessCast(DtypeOf(in.type()), DtypeOf(first->result(0).type()));
+  }
+  return false;
+}
+
+int64_t BytesOf(pir::Type type) {
+  if (!type.isa<paddle::dialect::AllocatedDenseTensorType>()) return 0;
+  auto tensor_type = type.dyn_cast<paddle::dialect::AllocatedDenseTensorType>();
+  int64_t numel = common::product(tensor_type.dims());
+  if (numel < 0) return 0;
+  return numel * static_cast<int64_t>(phi::SizeOf(DtypeOf(type)));
+}
+
+class RemoveRedundantTransferPass : public pir::Pass {
+ public:
+  RemoveRedundantTransferPass()
+      : pir::Pass("remove_redundant_transfer_pass", 0) {}
+
+  void Run(pir::Operation* op) override {
+    VLOG(6) << "apply remove_redundant_transfer_pass";
+    int64_t num_duplicates = 0;
+    int64_t num_round_trips = 0;
+    int64_t eliminated_bytes = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto& block : op->region(i)) {
+        RemoveInBlock(
+            &block, &num_duplicates, &num_round_trips, &eliminated_bytes);
+      }
+    }
+    // Recorded for the logs of the pass manager.
+    std::string log;
+    if (num_duplicates > 0 || num_round_trips > 0) {
+      log = "--- removed " + std::to_string(num_duplicates) +
+            " duplicated and " + std::to_string(num_round_trips) +
+            " round trip transfers of " + std::to_string(eliminated_bytes) +
+            " bytes!";
+    }
+    AddStatistics(log);
+  }
+
+ private:
+  void Erase(pir::Operation* op, int64_t* eliminated_bytes) {
+    *eliminated_bytes += BytesOf(op->result(0).type());
+    VLOG(4) << "erase transfer op: " << KernelOpName(op);
+    op->Erase();
+  }
+
+  void RemoveInBlock(pir::Block* block,
+                     int64_t* num_duplicates,
+                     int64_t* num_round_trips,
+                     int64_t* eliminated_bytes) {
+    std::vector<pir::Operation*> ops;
+    for (auto& op : *block) {
+      ops.push_back(&op);
+    }
+    // The transfers of each value in this block, in the order of the block.
+    std::unordered_map<pir::Value, std::vector<pir::Operation*>> transfers;
+    std::unordered_set<pir::Operation*> erased;
+    for (auto* op : ops) {
+      if (erased.count(op)) continue;
+      for (size_t i = 0; i < op->num_regions(); ++i) {
+        for (auto& inner_block : op->region(i)) {
+          RemoveInBlock(
+              &inner_block, num_duplicates, num_round_trips, eliminated_bytes);
+        }
+      }
+      if (!IsTransferOp(op)) continue;
+      pir::Value in = op->operand_source(0);
+      pir::Value out = op->result(0);
+      if (!IsReplaceable(in) || !IsReplaceable(out)) continue;
+
+      auto* in_op = in.defining_op();
+      if (in_op && IsTransferOp(in_op) && IsRoundTrip(in_op, op) &&
+          IsReplaceable(in_op->operand_source(0))) {
+        out.ReplaceAllUsesWith(in_op->operand_source(0));
+        Erase(op, eliminated_bytes);
+        ++*num_round_trips;
+        // The transfers of the other blocks are left to the dead code
+        // elimination.
+        if (in.use_empty() && in_op->GetParent() == block) {
+          erased.insert(in_op);
+          Erase(in_op, eliminated_bytes);
+        }
+        continue;
+      }
+
+      auto& value_transfers = transfers[in];
+      auto same = std::find_if(
+          value_transfers.begin(),
+          value_transfers.end(),
+          [&](pir::Operation* other) {
+            return !erased.count(other) && IsSameTransfer(other, op);
+          });
+      if (same != value_transfers.end()) {
+        out.ReplaceAllUsesWith((*same)->result(0));
+        Erase(op, eliminated_bytes);
+        ++*num_duplicates;
+        continue;
+      }
+      value_transfers.push_back(op);
+    }
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateRemoveRedundantTransferPass() {
+  return std::make_unique<RemoveRedundantTransferPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(remove_redundant_transfer_pass, RemoveRedundantTransferPass);
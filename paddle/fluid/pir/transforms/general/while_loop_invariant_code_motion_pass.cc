@@ -0,0 +1,260 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/while_loop_invariant_code_motion_pass.h"
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
+#include "paddle/fluid/pir/dialect/operator/utils/op_yaml_info_parser.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/block_argument.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/builtin_type.h"
+#include "paddle/pir/include/core/op_trait.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// The ops reading a state not in their operands, or whose order with the
+// ops of the other ranks matters.
+const std::unordered_set<std::string> kNotHoistedOps = {
+    "builtin.parameter",
+    "pd_op.data",
+    "pd_op.feed",
+    "pd_op.fetch",
+    "pd_op.print",
+    "pd_op.shadow_feed",
+};
+
+std::string OriginOpName(const pir::Operation* op) {
+  auto it = op->attributes().find("op_name");
+  if (it != op->attributes().end() && it->second.isa<pir::StrAttribute>()) {
+    return it->second.dyn_cast<pir::StrAttribute>().AsString();
+  }
+  return op->name();
+}
+
+bool HasSideEffect(pir::Operation* op) {
+  if (op->HasTrait<pir::SideEffectTrait>()) return true;
+  pir::OpInfo op_info =
+      pir::IrContext::Instance()->GetRegisteredOpInfo(OriginOpName(op));
+  return op_info && op_info.HasTrait<pir::SideEffectTrait>();
+}
+
+// The operands of op written by it, and the ones viewed by its results as
+// pairs of the result and the operand.
+void GetInplaceAndViewInfo(pir::Operation* op,
+                           std::unordered_set<size_t>* inplace_operands,
+                           std::map<size_t, size_t>* view_operands) {
+  std::string op_name = OriginOpName(op);
+  pir::OpInfo op_info =
+      pir::IrContext::Instance()->GetRegisteredOpInfo(op_name);
+  if (!op_info) return;
+  auto yaml_info_interface =
+      op_info.GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>();
+  if (!yaml_info_interface) return;
+  paddle::dialect::OpYamlInfoParser yaml_parser(
+      yaml_info_interface->get_op_info_(op_name),
+      paddle::dialect::IsLegacyOp(op_name));
+  const auto& output_names = yaml_parser.OutputNames();
+  for (size_t i = 0; i < op->num_results() && i < output_names.size(); ++i) {
+    const std::string& value_name = output_names[i];
+    if (yaml_parser.HasInplace(value_name)) {
+      inplace_operands->insert(
+          yaml_parser.InputName2Id().at(yaml_parser.InplaceName(value_name)));
+    }
+    if (yaml_parser.HasView(value_name)) {
+      (*view_operands)[i] =
+          yaml_parser.InputName2Id().at(yaml_parser.ViewName(value_name));
+    }
+  }
+}
+
+bool IsInplaceOp(pir::Operation* op) {
+  auto it = op->attributes().find("is_inplace");
+  if (it != op->attributes().end() &&
+      it->second.dyn_cast<pir::BoolAttribute>().data()) {
+    return true;
+  }
+  std::unordered_set<size_t> inplace_operands;
+  std::map<size_t, size_t> view_operands;
+  GetInplaceAndViewInfo(op, &inplace_operands, &view_operands);
+  return !inplace_operands.empty();
+}
+
+bool IsInside(const pir::Operation* op, const pir::Operation* while_op) {
+  for (auto* parent = op ? op->GetParentOp() : nullptr; parent;
+       parent = parent->GetParentOp()) {
+    if (parent == while_op) return true;
+  }
+  return false;
+}
+
+bool IsDefinedInside(pir::Value value, const pir::Operation* while_op) {
+  const pir::Operation* defining_op = nullptr;
+  if (value.isa<pir::BlockArgument>()) {
+    defining_op = value.dyn_cast<pir::BlockArgument>().owner()->GetParentOp();
+  } else {
+    defining_op = value.defining_op();
+  }
+  return defining_op == while_op || IsInside(defining_op, while_op);
+}
+
+// Whether an op inside while_op writes to value, or to a view of it, or
+// keeps it in a container.
+bool IsMutatedInside(pir::Value value, const pir::Operation* while_op) {
+  for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+    auto* user = it->owner();
+    if (!IsInside(user, while_op)) continue;
+    if (user->isa<pir::YieldOp>() || user->isa<pir::TuplePushOp>() ||
+        user->num_regions() > 0) {
+      return true;
+    }
+    std::unordered_set<size_t> inplace_operands;
+    std::map<size_t, size_t> view_operands;
+    GetInplaceAndViewInfo(user, &inplace_operands, &view_operands);
+    size_t index = it->index();
+    if (inplace_operands.count(index)) return true;
+    for (const auto& [result, operand] : view_operands) {
+      if (operand == index && IsMutatedInside(user->result(result), while_op)) {
+        return true;
+      }
+    }
+    // e.g. builtin.combine, the vector is written through its elements
+    if (!user->HasInterface<paddle::dialect::OpYamlInfoInterface>() &&
+        !user->attributes().count("op_name")) {
+      for (auto result : user->results()) {
+        if (IsMutatedInside(result, while_op)) return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool IsDenseTensorLike(pir::Type type) {
+  if (!type) return false;
+  if (type.isa<paddle::dialect::DenseTensorType>() ||
+      type.isa<paddle::dialect::AllocatedDenseTensorType>()) {
+    return true;
+  }
+  if (type.isa<pir::VectorType>()) {
+    for (auto element : type.dyn_cast<pir::VectorType>().data()) {
+      if (!IsDenseTensorLike(element)) return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool CanHoist(pir::Operation* op, const pir::Operation* while_op) {
+  if (op->num_regions() > 0 || op->num_results() == 0 ||
+      op->isa<pir::YieldOp>() || op->name().compare(0, 3, "cf.") == 0 ||
+      kNotHoistedOps.count(OriginOpName(op)) ||
+      op->attributes().count("ring_id") || HasSideEffect(op) ||
+      paddle::dialect::IsCustomOp(op) || IsInplaceOp(op)) {
+    return false;
+  }
+  for (auto operand : op->operands_source()) {
+    if (!operand) continue;
+    if (!IsDenseTensorLike(operand.type()) ||
+        IsDefinedInside(operand, while_op) ||
+        IsMutatedInside(operand, while_op)) {
+      return false;
+    }
+  }
+  for (auto result : op->results()) {
+    if (!IsDenseTensorLike(result.type()) ||
+        IsMutatedInside(result, while_op)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class WhileLoopInvariantCodeMotionPass : public pir::Pass {
+ public:
+  WhileLoopInvariantCodeMotionPass()
+      : pir::Pass("while_loop_invariant_code_motion_pass", 1) {}
+
+  void Run(pir::Operation* op) override {
+    VLOG(6) << "apply while_loop_invariant_code_motion_pass";
+    int64_t num_hoisted = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto& block : op->region(i)) {
+        HoistInBlock(&block, &num_hoisted);
+      }
+    }
+    AddStatistics(num_hoisted);
+  }
+
+ private:
+  // The inner loops first, so that their hoisted ops may be hoisted again
+  // out of the outer loops.
+  void HoistInBlock(pir::Block* block, int64_t* num_hoisted) {
+    std::vector<pir::Operation*> ops;
+    for (auto& op : *block) {
+      ops.push_back(&op);
+    }
+    for (auto* op : ops) {
+      for (size_t i = 0; i < op->num_regions(); ++i) {
+        for (auto& inner_block : op->region(i)) {
+          HoistInBlock(&inner_block, num_hoisted);
+        }
+      }
+      if (op->isa<paddle::dialect::WhileOp>()) {
+        HoistOutOfWhile(op, num_hoisted);
+      }
+    }
+  }
+
+  // In the order of the body, so an op is hoisted after the ones it uses.
+  void HoistOutOfWhile(pir::Operation* while_op, int64_t* num_hoisted) {
+    auto& body = while_op->dyn_cast<paddle::dialect::WhileOp>().body();
+    std::vector<pir::Operation*> ops;
+    for (auto& op : body) {
+      ops.push_back(&op);
+    }
+    for (auto* op : ops) {
+      if (!CanHoist(op, while_op)) continue;
+      VLOG(4) << "hoist " << OriginOpName(op) << " out of the while op";
+      op->MoveTo(while_op->GetParent(), *while_op);
+      ++*num_hoisted;
+    }
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateWhileLoopInvariantCodeMotionPass() {
+  return std::make_unique<WhileLoopInvariantCodeMotionPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(while_loop_invariant_code_motion_pass,
+                 WhileLoopInvariantCodeMotionPass);
@@ -280,8 +280,9 @@ static bool NeedFallBackFromGPUDNN2GPU(pir::Operation* op,
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   if (kernel_key.backend() == phi::Backend::GPUDNN) {
-    auto iter = phi::KernelFactory::Instance().kernels().find(kernel_name);
-    if (iter != phi::KernelFactory::Instance().kernels().end()) {
+    const phi::KernelFactory& kernel_factory = phi::KernelFactory::Instance();
+    auto iter = kernel_factory.kernels().find(kernel_name);
+    if (iter != kernel_factory.kernels().end()) {
       auto kernel_iter = iter->second.find({phi::Backend::GPUDNN,
                                             phi::DataLayout::ALL_LAYOUT,
                                             kernel_key.dtype()});
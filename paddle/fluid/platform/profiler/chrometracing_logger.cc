@@ -18,6 +18,7 @@ limitations under the License. */
 #include <ctime>
 #include <limits>
 #include <regex>
+#include <sstream>
 
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -150,6 +151,74 @@ void ChromeTracingLogger::LogMemTraceEventNode(
   pid_tid_set_.insert({mem_node.ProcessId(), mem_node.ThreadId()});
 }
 
+void ChromeTracingLogger::LogAllocationTrace(
+    const std::vector<memory::AllocationTraceEvent>& events) {
+  if (!output_file_stream_) {
+    return;
+  }
+  output_file_stream_ << std::string(
+      R"JSON(
+    "traceEvents": [
+  )JSON");
+  auto pid = phi::GetProcessId();
+  // The counter of a place is the bytes allocated minus the bytes freed by the
+  // traced events, since the oldest one kept.
+  std::map<std::string, int64_t> traced_bytes;
+  for (const auto& event : events) {
+    std::ostringstream place;
+    place << event.place;
+    bool is_alloc = event.type == memory::AllocationTraceEventType::kAlloc;
+    int64_t& bytes = traced_bytes[place.str()];
+    bytes += is_alloc ? static_cast<int64_t>(event.size)
+                      : -static_cast<int64_t>(event.size);
+    std::string stack =
+        std::regex_replace(event.stack, std::regex("\""), "\'");
+    stack = std::regex_replace(stack, std::regex("\n"), "\\n");
+    output_file_stream_ << string_format(
+        std::string(
+            R"JSON(
+  {
+    "name": "[traced memory] %s", "pid": %lld, "tid": "%lld(C++)",
+    "ts": %lld,
+    "ph": "C",
+    "args": {
+      "bytes": %lld
+    }
+  },
+  {
+    "name": "%s", "pid": %lld, "tid": "%lld(C++)",
+    "ts": %lld,
+    "ph": "i", "s": "t", "cat": "%s",
+    "args": {
+      "place": "%s",
+      "addr": "%p",
+      "size": %llu,
+      "stream": "%p",
+      "allocator": "%s",
+      "stack": "%s"
+    }
+  },
+  )JSON"),
+        place.str().c_str(),
+        pid,
+        event.thread_id,
+        nsToUs(event.timestamp_ns),
+        bytes,
+        event.op_name.empty() ? "[memory]" : event.op_name.c_str(),
+        pid,
+        event.thread_id,
+        nsToUs(event.timestamp_ns),
+        is_alloc ? "Allocate" : "Free",
+        place.str().c_str(),
+        event.ptr,
+        event.size,
+        event.stream,
+        event.allocator.c_str(),
+        stack.c_str());
+    pid_tid_set_.insert({pid, event.thread_id});
+  }
+}
+
 void ChromeTracingLogger::LogHostTraceEventNode(
     const HostTraceEventNode& host_node) {
   if (!output_file_stream_) {
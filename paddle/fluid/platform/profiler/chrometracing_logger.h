@@ -18,7 +18,9 @@ limitations under the License. */
 #include <set>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "paddle/phi/core/memory/allocation_trace.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/platform/profiler/output_logger.h"
 
@@ -41,6 +43,10 @@ class ChromeTracingLogger : public BaseLogger {
   void LogNodeTrees(const NodeTrees&) override;
   void LogExtraInfo(const std::unordered_map<std::string, std::string>);
   void LogMemTraceEventNode(const MemTraceEventNode&) override;
+  // Logs the events of the allocation trace as the timeline of the memory
+  // traced on each place, instead of LogNodeTrees.
+  void LogAllocationTrace(
+      const std::vector<memory::AllocationTraceEvent>& events);
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void LogDeviceProperty(
       const std::map<uint32_t, gpuDeviceProp>& device_property_map);
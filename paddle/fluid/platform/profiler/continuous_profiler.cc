@@ -0,0 +1,360 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/fluid/platform/profiler/event_python.h"
+#include "paddle/phi/core/os_info.h"
+#include "paddle/phi/core/platform/profiler.h"
+#include "paddle/phi/core/platform/profiler/extra_info.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+// The weight of a step in the baseline after the baseline steps, so the
+// baseline follows the slow drifts of the step time.
+constexpr double kBaselineDecay = 0.01;
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void HandleDumpSignal(int) { ContinuousProfiler::Instance().RequestDump(); }
+
+template <typename T>
+void AppendBounded(const std::list<T>& events,
+                   size_t capacity,
+                   std::deque<T>* buffer) {
+  size_t skip = events.size() > capacity ? events.size() - capacity : 0;
+  for (const auto& event : events) {
+    if (skip > 0) {
+      --skip;
+      continue;
+    }
+    buffer->push_back(event);
+  }
+  while (buffer->size() > capacity) {
+    buffer->pop_front();
+  }
+}
+
+}  // namespace
+
+void OpStatistics::Add(uint64_t duration_ns) {
+  ++count_;
+  total_ns_ += static_cast<double>(duration_ns);
+  max_ns_ = std::max(max_ns_, duration_ns);
+  int bucket = duration_ns == 0
+                   ? 0
+                   : static_cast<int>(std::log2(duration_ns) *
+                                      kBucketsPerOctave);
+  ++histogram_[std::min(bucket, kNumBuckets - 1)];
+}
+
+uint64_t OpStatistics::PercentileNs(double percentile) const {
+  if (count_ == 0) return 0;
+  auto rank = static_cast<int64_t>(std::ceil(percentile * count_));
+  int64_t seen = 0;
+  for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+    seen += histogram_[bucket];
+    if (seen >= rank) {
+      // The upper bound of the bucket.
+      auto upper = static_cast<uint64_t>(
+          std::exp2(static_cast<double>(bucket + 1) / kBucketsPerOctave));
+      return std::min(upper, max_ns_);
+    }
+  }
+  return max_ns_;
+}
+
+ContinuousProfiler& ContinuousProfiler::Instance() {
+  static ContinuousProfiler profiler;
+  return profiler;
+}
+
+void ContinuousProfiler::Start(const ContinuousProfilerOptions& options) {
+  PADDLE_ENFORCE_EQ(started_,
+                    false,
+                    common::errors::PreconditionNotMet(
+                        "The continuous profiler has already started."));
+  PADDLE_ENFORCE_GT(
+      options.sample_interval,
+      0,
+      common::errors::InvalidArgument(
+          "The sample interval of the continuous profiler should be "
+          "greater than 0, but received %d.",
+          options.sample_interval));
+  options_ = options;
+  step_ = 0;
+  baseline_ns_ = 0;
+  num_baseline_steps_ = 0;
+  num_sampled_steps_ = 0;
+  num_regressions_ = 0;
+  force_sample_ = false;
+  dump_after_sample_ = false;
+  dump_requested_.store(false);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    host_events_.clear();
+    runtime_events_.clear();
+    device_events_.clear();
+    mem_events_.clear();
+    statistics_.clear();
+  }
+  if (options_.dump_signal != 0) {
+    std::signal(options_.dump_signal, HandleDumpSignal);
+  }
+  started_ = true;
+  VLOG(1) << "Start the continuous profiler, sampling 1 in "
+          << options_.sample_interval << " steps";
+  BeginSample();
+  last_step_ns_ = NowNs();
+}
+
+void ContinuousProfiler::Stop() {
+  if (!started_) return;
+  EndSample();
+  if (options_.dump_signal != 0) {
+    std::signal(options_.dump_signal, SIG_DFL);
+  }
+  started_ = false;
+  VLOG(1) << "Stop the continuous profiler after " << step_ << " steps, "
+          << num_sampled_steps_ << " sampled";
+}
+
+void ContinuousProfiler::Step() {
+  if (!started_) return;
+  uint64_t step_ns = NowNs() - last_step_ns_;
+  bool sampled = profiler_ != nullptr;
+  EndSample();
+  ++step_;
+
+  bool regression = DetectRegression(step_ns);
+  if (regression) {
+    ++num_regressions_;
+    LOG(WARNING) << "Step " << step_ << " took " << step_ns / 1e6
+                 << " ms, over " << options_.regression_ratio
+                 << " times the baseline of " << baseline_ns_ / 1e6 << " ms";
+  }
+  std::string reason;
+  if (dump_requested_.exchange(false)) {
+    reason = "request";
+  }
+  if (sampled && (regression || dump_after_sample_)) {
+    reason = "regression";
+    dump_after_sample_ = false;
+  } else if (regression) {
+    // The slow step is not traced, so the next one is.
+    force_sample_ = true;
+    dump_after_sample_ = true;
+  }
+  if (!reason.empty()) {
+    Dump(reason);
+  }
+
+  if (force_sample_ || step_ % options_.sample_interval == 0) {
+    force_sample_ = false;
+    BeginSample();
+  }
+  // The time of the profiler itself is not counted in the steps.
+  last_step_ns_ = NowNs();
+}
+
+bool ContinuousProfiler::DetectRegression(uint64_t step_ns) {
+  if (options_.regression_ratio <= 0) return false;
+  auto ns = static_cast<double>(step_ns);
+  if (num_baseline_steps_ < options_.baseline_steps) {
+    ++num_baseline_steps_;
+    baseline_ns_ += (ns - baseline_ns_) / num_baseline_steps_;
+    return false;
+  }
+  if (ns > options_.regression_ratio * baseline_ns_) {
+    return true;
+  }
+  baseline_ns_ += kBaselineDecay * (ns - baseline_ns_);
+  return false;
+}
+
+void ContinuousProfiler::BeginSample() {
+  ProfilerOptions options;
+  options.trace_switch = options_.trace_switch;
+  options.trace_level = options_.trace_level;
+  profiler_ = Profiler::Create(options);
+  if (profiler_ == nullptr) {
+    VLOG(3) << "Skip the sample of step " << step_
+            << " since another profiler is running";
+    return;
+  }
+  EnableHostEventRecorder();
+  profiler_->Prepare();
+  profiler_->Start();
+}
+
+void ContinuousProfiler::EndSample() {
+  if (profiler_ == nullptr) return;
+  TraceEventCollector collector;
+  profiler_->StopAndCollect(&collector);
+  DisableHostEventRecorder();
+  profiler_.reset();
+  ++num_sampled_steps_;
+  Aggregate(collector);
+}
+
+void ContinuousProfiler::Aggregate(const TraceEventCollector& collector) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // The operators of each thread in the order of their start.
+  std::unordered_map<uint64_t, std::vector<const HostTraceEvent*>> thread_ops;
+  for (const auto& event : collector.HostEvents()) {
+    if (event.type != TracerEventType::Operator) continue;
+    statistics_[event.name].Add(event.end_ns - event.start_ns);
+    thread_ops[event.thread_id].push_back(&event);
+  }
+  for (auto& [thread_id, ops] : thread_ops) {
+    std::sort(ops.begin(), ops.end(), [](const auto* lhs, const auto* rhs) {
+      return lhs->start_ns < rhs->start_ns;
+    });
+  }
+  // The innermost operator running on a thread at a time.
+  auto FindOp = [&](uint64_t thread_id,
+                    uint64_t timestamp_ns) -> const HostTraceEvent* {
+    auto it = thread_ops.find(thread_id);
+    if (it == thread_ops.end()) return nullptr;
+    const auto& ops = it->second;
+    auto pos = std::upper_bound(
+        ops.begin(),
+        ops.end(),
+        timestamp_ns,
+        [](uint64_t ts, const HostTraceEvent* op) {
+          return ts < op->start_ns;
+        });
+    if (pos == ops.begin()) return nullptr;
+    const auto* op = *(pos - 1);
+    return timestamp_ns <= op->end_ns ? op : nullptr;
+  };
+
+  // The device time of an operator is of the kernels its runtime calls
+  // launched.
+  std::unordered_map<uint32_t, const HostTraceEvent*> op_of_correlation;
+  for (const auto& event : collector.RuntimeEvents()) {
+    const auto* op = FindOp(event.thread_id, event.start_ns);
+    if (op != nullptr) {
+      op_of_correlation[event.correlation_id] = op;
+    }
+  }
+  for (const auto& event : collector.DeviceEvents()) {
+    auto it = op_of_correlation.find(event.correlation_id);
+    if (it != op_of_correlation.end()) {
+      statistics_[it->second->name].AddDeviceNs(event.end_ns - event.start_ns);
+    }
+  }
+  for (const auto& event : collector.MemEvents()) {
+    if (event.type != TracerMemEventType::Allocate) continue;
+    const auto* op = FindOp(event.thread_id, event.timestamp_ns);
+    if (op != nullptr) {
+      statistics_[op->name].AddAllocatedBytes(event.increase_bytes);
+    }
+  }
+
+  AppendBounded(collector.HostEvents(), options_.max_events, &host_events_);
+  AppendBounded(
+      collector.RuntimeEvents(), options_.max_events, &runtime_events_);
+  AppendBounded(collector.DeviceEvents(), options_.max_events, &device_events_);
+  AppendBounded(collector.MemEvents(), options_.max_events, &mem_events_);
+}
+
+std::map<std::string, OpStatistics> ContinuousProfiler::Statistics() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return statistics_;
+}
+
+std::string ContinuousProfiler::Dump(const std::string& reason) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::ostringstream prefix;
+  prefix << options_.dump_dir << "/continuous_profile_" << phi::GetProcessId()
+         << "_step" << step_;
+
+  std::unique_ptr<NodeTrees> tree(new NodeTrees(
+      std::list<HostTraceEvent>(host_events_.begin(), host_events_.end()),
+      std::list<RuntimeTraceEvent>(runtime_events_.begin(),
+                                   runtime_events_.end()),
+      std::list<DeviceTraceEvent>(device_events_.begin(),
+                                  device_events_.end()),
+      std::list<MemTraceEvent>(mem_events_.begin(), mem_events_.end()),
+      std::list<OperatorSupplementEvent>()));
+  ExtraInfo extra_info;
+  extra_info.AddExtraInfo(
+      std::string("Dump Reason"), std::string("%s"), reason.c_str());
+  extra_info.AddExtraInfo(std::string("Sampled Steps"),
+                          std::string("%s"),
+                          std::to_string(num_sampled_steps_).c_str());
+  ProfilerResult result(std::move(tree), extra_info);
+  result.SetVersion(std::string(Profiler::version));
+  result.SetSpanIndx(0);
+  std::string trace_path = prefix.str() + ".json";
+  result.Save(trace_path, "json");
+
+  // The operators in the descending order of their total time.
+  std::vector<std::pair<std::string, const OpStatistics*>> ops;
+  for (const auto& [name, stats] : statistics_) {
+    ops.emplace_back(name, &stats);
+  }
+  std::sort(ops.begin(), ops.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second->MeanNs() * lhs.second->count() >
+           rhs.second->MeanNs() * rhs.second->count();
+  });
+  std::ofstream summary(prefix.str() + ".txt");
+  summary << "# reason: " << reason << ", step: " << step_
+          << ", sampled steps: " << num_sampled_steps_
+          << ", baseline step ms: " << baseline_ns_ / 1e6 << "\n";
+  summary << std::left << std::setw(40) << "op" << std::right << std::setw(10)
+          << "count" << std::setw(14) << "mean_us" << std::setw(14)
+          << "p99_us" << std::setw(14) << "max_us" << std::setw(14)
+          << "device_us" << std::setw(16) << "alloc_bytes"
+          << "\n";
+  summary << std::fixed << std::setprecision(2);
+  for (const auto& [name, stats] : ops) {
+    summary << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << stats->count() << std::setw(14)
+            << stats->MeanNs() / 1e3 << std::setw(14)
+            << stats->PercentileNs(0.99) / 1e3 << std::setw(14)
+            << stats->MaxNs() / 1e3 << std::setw(14)
+            << stats->MeanDeviceNs() / 1e3 << std::setw(16)
+            << stats->MeanAllocatedBytes() << "\n";
+  }
+  LOG(INFO) << "Dump the continuous profile of step " << step_ << " for "
+            << reason << " to " << trace_path;
+  return trace_path;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,151 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/platform/profiler/profiler.h"
+#include "paddle/fluid/platform/profiler/trace_event_collector.h"
+
+namespace paddle {
+namespace platform {
+
+struct ContinuousProfilerOptions {
+  // bit 0: cpu, bit 1: gpu, as ProfilerOptions::trace_switch
+  uint32_t trace_switch = 1 << kProfileCPUOptionBit;
+  uint32_t trace_level = FLAGS_host_trace_level;
+  // Trace 1 in sample_interval steps.
+  int64_t sample_interval = 100;
+  // The capacity of the ring buffer of each kind of trace event.
+  size_t max_events = 100000;
+  // A step slower than regression_ratio times the baseline step time
+  // triggers a dump, 0 disables the detection.
+  double regression_ratio = 0.0;
+  // The steps averaged for the baseline step time before the detection.
+  int64_t baseline_steps = 20;
+  // The signal triggering a dump, 0 installs no handler.
+  int dump_signal = 0;
+  std::string dump_dir = ".";
+};
+
+// The statistics of an operator over the sampled steps, aggregated online.
+class OpStatistics {
+ public:
+  void Add(uint64_t duration_ns);
+
+  int64_t count() const { return count_; }
+  double MeanNs() const { return count_ ? total_ns_ / count_ : 0.0; }
+  uint64_t MaxNs() const { return max_ns_; }
+  // Estimated from a histogram of 4 buckets per power of 2, so it is within
+  // about 19% of the exact percentile.
+  uint64_t PercentileNs(double percentile) const;
+  double MeanDeviceNs() const { return count_ ? device_ns_ / count_ : 0.0; }
+  double MeanAllocatedBytes() const {
+    return count_ ? static_cast<double>(allocated_bytes_) / count_ : 0.0;
+  }
+
+  void AddDeviceNs(uint64_t ns) { device_ns_ += static_cast<double>(ns); }
+  void AddAllocatedBytes(int64_t bytes) { allocated_bytes_ += bytes; }
+
+ private:
+  static constexpr int kBucketsPerOctave = 4;
+  static constexpr int kNumBuckets = 64 * kBucketsPerOctave;
+
+  int64_t count_{0};
+  double total_ns_{0};
+  uint64_t max_ns_{0};
+  double device_ns_{0};
+  int64_t allocated_bytes_{0};
+  std::array<int64_t, kNumBuckets> histogram_{};
+};
+
+//
+// A profiler left on for the whole job. It traces 1 in sample_interval
+// steps with the tracers of Profiler, keeps the events of the latest
+// samples in bounded ring buffers, aggregates the operators of the samples
+// online, and dumps them on a trigger: RequestDump, the dump signal, or a
+// step slower than the baseline.
+//
+// The steps not sampled only read the clock, so the overhead is a device
+// synchronization at the bounds of each sample.
+//
+class ContinuousProfiler {
+ public:
+  static ContinuousProfiler& Instance();
+
+  void Start(const ContinuousProfilerOptions& options);
+
+  void Stop();
+
+  bool IsStarted() const { return started_; }
+
+  // Mark the end of a step. The dumps requested are done here.
+  void Step();
+
+  // Request a dump at the end of the current step, which is safe to call in
+  // a signal handler.
+  void RequestDump() { dump_requested_.store(true); }
+
+  // Write the statistics and the buffered events to files in dump_dir, and
+  // return the path of the trace.
+  std::string Dump(const std::string& reason);
+
+  std::map<std::string, OpStatistics> Statistics() const;
+
+  int64_t num_sampled_steps() const { return num_sampled_steps_; }
+  int64_t num_regressions() const { return num_regressions_; }
+
+ private:
+  ContinuousProfiler() = default;
+  DISABLE_COPY_AND_ASSIGN(ContinuousProfiler);
+
+  void BeginSample();
+  void EndSample();
+  void Aggregate(const TraceEventCollector& collector);
+  // Whether the step of step_ns is a regression, updating the baseline.
+  bool DetectRegression(uint64_t step_ns);
+
+  ContinuousProfilerOptions options_;
+  bool started_{false};
+  std::unique_ptr<Profiler> profiler_;
+  int64_t step_{0};
+  uint64_t last_step_ns_{0};
+  double baseline_ns_{0};
+  int64_t num_baseline_steps_{0};
+  int64_t num_sampled_steps_{0};
+  int64_t num_regressions_{0};
+  // Sample the next step, and dump after it for the regression before it.
+  bool force_sample_{false};
+  bool dump_after_sample_{false};
+  std::atomic<bool> dump_requested_{false};
+
+  mutable std::mutex mutex_;
+  std::deque<HostTraceEvent> host_events_;
+  std::deque<RuntimeTraceEvent> runtime_events_;
+  std::deque<DeviceTraceEvent> device_events_;
+  std::deque<MemTraceEvent> mem_events_;
+  std::map<std::string, OpStatistics> statistics_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler/chrometracing_logger.h"
 #include "paddle/fluid/platform/profiler/dump/deserialization_reader.h"
 #include "paddle/fluid/platform/profiler/dump/serialization_logger.h"
+#include "paddle/fluid/platform/profiler/op_cost_estimator.h"
 #include "paddle/phi/core/platform/profiler/extra_info.h"
 
 namespace paddle::platform {
@@ -123,6 +124,13 @@ HostPythonNode* ProfilerResult::CopyTree(HostTraceEventNode* root) {
     host_python_node->callstack = op_supplement_node->CallStack();
     host_python_node->attributes = op_supplement_node->Attributes();
     host_python_node->op_id = op_supplement_node->OpId();
+    OpCost cost = OpCostEstimatorRegistry::Instance().Estimate(
+        op_supplement_node->Name(),
+        OpCostContext(host_python_node->input_shapes,
+                      host_python_node->dtypes,
+                      host_python_node->attributes));
+    host_python_node->flops = cost.flops;
+    host_python_node->bytes = cost.bytes;
   }
   return host_python_node;
 }
@@ -125,6 +125,9 @@ struct HostPythonNode {
   framework::AttributeMap attributes;
   // op id
   uint64_t op_id;
+  // estimated floating point operations and bytes accessed, 0 if unknown
+  int64_t flops = 0;
+  int64_t bytes = 0;
   // children node
   std::vector<HostPythonNode*> children_node_ptrs;
   // runtime node
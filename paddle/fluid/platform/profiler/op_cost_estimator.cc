@@ -0,0 +1,334 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/op_cost_estimator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+// The names of the inputs in the static graph and in the phi api.
+const std::vector<std::string> kX = {"X", "x", "Input", "input"};
+const std::vector<std::string> kY = {"Y", "y"};
+const std::vector<std::string> kFilter = {"Filter", "filter"};
+const std::vector<std::string> kIds = {"Ids", "ids", "x"};
+const std::vector<std::string> kTable = {"W", "weight"};
+
+int64_t ElementBytesOf(const std::string& dtype) {
+  static const std::unordered_map<std::string, int64_t> kBytes = {
+      {"BOOL", 1},
+      {"INT8", 1},
+      {"UINT8", 1},
+      {"INT16", 2},
+      {"FP16", 2},
+      {"BF16", 2},
+      {"INT32", 4},
+      {"FP32", 4},
+      {"INT64", 8},
+      {"FP64", 8},
+      {"COMPLEX64", 8},
+      {"COMPLEX128", 16},
+  };
+  auto it = kBytes.find(dtype);
+  return it == kBytes.end() ? 0 : it->second;
+}
+
+// The batch, m, k and n of a matmul, with x of [..., m, k] and y of
+// [..., k, n] after the transpositions.
+OpCost MatmulCost(const OpCostContext& ctx,
+                  const std::string& trans_x_name,
+                  const std::string& trans_y_name) {
+  const auto* x = ctx.InputShape(kX);
+  const auto* y = ctx.InputShape(kY);
+  if (x == nullptr || y == nullptr || x->empty() || y->empty()) return {};
+  std::vector<int64_t> x_shape = *x;
+  std::vector<int64_t> y_shape = *y;
+  if (x_shape.size() == 1) x_shape.insert(x_shape.begin(), 1);
+  if (y_shape.size() == 1) y_shape.push_back(1);
+  if (ctx.Attr<bool>(trans_x_name, false)) {
+    std::swap(x_shape[x_shape.size() - 1], x_shape[x_shape.size() - 2]);
+  }
+  if (ctx.Attr<bool>(trans_y_name, false)) {
+    std::swap(y_shape[y_shape.size() - 1], y_shape[y_shape.size() - 2]);
+  }
+  int64_t m = x_shape[x_shape.size() - 2];
+  int64_t k = x_shape.back();
+  int64_t n = y_shape.back();
+  int64_t batch = 1;
+  size_t x_batch_rank = x_shape.size() - 2;
+  size_t y_batch_rank = y_shape.size() - 2;
+  for (size_t i = 0; i < std::max(x_batch_rank, y_batch_rank); ++i) {
+    int64_t x_dim = i < x_batch_rank ? x_shape[x_batch_rank - 1 - i] : 1;
+    int64_t y_dim = i < y_batch_rank ? y_shape[y_batch_rank - 1 - i] : 1;
+    batch *= std::max(x_dim, y_dim);
+  }
+  OpCost cost;
+  cost.flops = 2 * batch * m * k * n;
+  cost.bytes = ctx.InputBytes(kX) + ctx.InputBytes(kY) +
+               batch * m * n * ctx.ElementBytes(kX);
+  return cost;
+}
+
+OpCost ConvCost(const OpCostContext& ctx) {
+  const auto* input = ctx.InputShape(kX);
+  const auto* filter = ctx.InputShape(kFilter);
+  if (input == nullptr || filter == nullptr || filter->size() < 3 ||
+      input->size() != filter->size()) {
+    return {};
+  }
+  size_t num_spatial = filter->size() - 2;
+  std::string data_format = ctx.Attr<std::string>("data_format", "NCHW");
+  bool channel_last = data_format == "NHWC" || data_format == "NDHWC";
+  size_t spatial_begin = channel_last ? 1 : 2;
+  std::string padding_algorithm =
+      ctx.Attr<std::string>("padding_algorithm", "EXPLICIT");
+  auto strides = ctx.Attr<std::vector<int>>("strides", {});
+  auto paddings = ctx.Attr<std::vector<int>>("paddings", {});
+  auto dilations = ctx.Attr<std::vector<int>>("dilations", {});
+  int64_t out_channels = (*filter)[0];
+  int64_t in_channels_per_group = (*filter)[1];
+  int64_t output_numel = (*input)[0] * out_channels;
+  int64_t kernel_numel = 1;
+  for (size_t i = 0; i < num_spatial; ++i) {
+    int64_t in_size = (*input)[spatial_begin + i];
+    int64_t kernel = (*filter)[2 + i];
+    int64_t stride = i < strides.size() ? std::max(strides[i], 1) : 1;
+    int64_t dilation = i < dilations.size() ? dilations[i] : 1;
+    int64_t out_size = 0;
+    if (padding_algorithm == "SAME") {
+      out_size = (in_size + stride - 1) / stride;
+    } else {
+      int64_t padding = 0;
+      if (padding_algorithm != "VALID") {
+        if (paddings.size() == 2 * num_spatial) {
+          padding = paddings[2 * i] + paddings[2 * i + 1];
+        } else if (i < paddings.size()) {
+          padding = 2 * paddings[i];
+        }
+      }
+      out_size =
+          (in_size + padding - (dilation * (kernel - 1) + 1)) / stride + 1;
+    }
+    output_numel *= std::max<int64_t>(out_size, 0);
+    kernel_numel *= kernel;
+  }
+  OpCost cost;
+  cost.flops = 2 * output_numel * in_channels_per_group * kernel_numel;
+  cost.bytes = ctx.InputBytes(kX) + ctx.InputBytes(kFilter) +
+               output_numel * ctx.ElementBytes(kX);
+  return cost;
+}
+
+// q of [batch, seq_len_q, num_heads, head_dim], and k and v of
+// [batch, seq_len_k, num_heads_k, head_dim].
+OpCost FlashAttnCost(const OpCostContext& ctx) {
+  const auto* q = ctx.InputShape({"q"});
+  const auto* k = ctx.InputShape({"k"});
+  const auto* v = ctx.InputShape({"v"});
+  if (q == nullptr || k == nullptr || v == nullptr || q->size() != 4 ||
+      k->size() != 4 || v->size() != 4) {
+    return {};
+  }
+  int64_t batch = (*q)[0];
+  int64_t seq_len_q = (*q)[1];
+  int64_t num_heads = (*q)[2];
+  int64_t head_dim = (*q)[3];
+  int64_t seq_len_k = (*k)[1];
+  int64_t head_dim_v = (*v)[3];
+  // Q * K^T and P * V.
+  int64_t flops =
+      2 * batch * num_heads * seq_len_q * seq_len_k * (head_dim + head_dim_v);
+  if (ctx.Attr<bool>("causal", false)) flops /= 2;
+  OpCost cost;
+  cost.flops = flops;
+  cost.bytes =
+      ctx.InputBytes({"q"}) + ctx.InputBytes({"k"}) + ctx.InputBytes({"v"}) +
+      batch * seq_len_q * num_heads * head_dim_v * ctx.ElementBytes({"q"});
+  return cost;
+}
+
+// The output is broadcast from x and y aligned to the trailing dimensions.
+OpCost ElementwiseCost(const OpCostContext& ctx) {
+  const auto* x = ctx.InputShape(kX);
+  const auto* y = ctx.InputShape(kY);
+  if (x == nullptr || y == nullptr) return {};
+  int64_t output_numel = 1;
+  for (size_t i = 0; i < std::max(x->size(), y->size()); ++i) {
+    int64_t x_dim = i < x->size() ? (*x)[x->size() - 1 - i] : 1;
+    int64_t y_dim = i < y->size() ? (*y)[y->size() - 1 - i] : 1;
+    output_numel *= std::max(x_dim, y_dim);
+  }
+  OpCost cost;
+  cost.flops = output_numel;
+  cost.bytes = ctx.InputBytes(kX) + ctx.InputBytes(kY) +
+               output_numel * ctx.ElementBytes(kX);
+  return cost;
+}
+
+// One operation per element reduced, and one more per output for a mean.
+OpCost ReduceCost(const OpCostContext& ctx, bool is_mean) {
+  const auto* x = ctx.InputShape(kX);
+  if (x == nullptr) return {};
+  int64_t input_numel = ShapeNumel(*x);
+  auto dims = ctx.Attr<std::vector<int>>("dim", {});
+  if (dims.empty()) dims = ctx.Attr<std::vector<int>>("axis", {});
+  int64_t output_numel = 1;
+  if (!ctx.Attr<bool>("reduce_all", false) && !dims.empty()) {
+    int64_t rank = static_cast<int64_t>(x->size());
+    std::vector<bool> reduced(x->size(), false);
+    for (int dim : dims) {
+      int64_t axis = dim < 0 ? dim + rank : dim;
+      if (axis >= 0 && axis < rank) reduced[axis] = true;
+    }
+    for (size_t i = 0; i < x->size(); ++i) {
+      if (!reduced[i]) output_numel *= (*x)[i];
+    }
+  }
+  OpCost cost;
+  cost.flops = input_numel + (is_mean ? output_numel : 0);
+  cost.bytes = ctx.InputBytes(kX) + output_numel * ctx.ElementBytes(kX);
+  return cost;
+}
+
+// A gather of the rows of the table, without floating point operations.
+OpCost EmbeddingCost(const OpCostContext& ctx) {
+  const auto* ids = ctx.InputShape(kIds);
+  const auto* table = ctx.InputShape(kTable);
+  if (ids == nullptr || table == nullptr || table->size() != 2) return {};
+  int64_t rows_bytes =
+      ShapeNumel(*ids) * (*table)[1] * ctx.ElementBytes(kTable);
+  OpCost cost;
+  cost.bytes = ShapeNumel(*ids) * ctx.ElementBytes(kIds, 8) + 2 * rows_bytes;
+  return cost;
+}
+
+}  // namespace
+
+int64_t ShapeNumel(const std::vector<int64_t>& shape) {
+  int64_t numel = 1;
+  for (int64_t dim : shape) {
+    numel *= dim;
+  }
+  return numel;
+}
+
+const std::vector<int64_t>* OpCostContext::InputShape(
+    const std::vector<std::string>& names, size_t idx) const {
+  for (const auto& name : names) {
+    auto it = input_shapes_.find(name);
+    if (it == input_shapes_.end()) continue;
+    return idx < it->second.size() ? &it->second[idx] : nullptr;
+  }
+  return nullptr;
+}
+
+int64_t OpCostContext::ElementBytes(const std::vector<std::string>& names,
+                                    int64_t default_bytes) const {
+  for (const auto& name : names) {
+    if (input_shapes_.count(name) == 0) continue;
+    auto it = dtypes_.find(name);
+    if (it == dtypes_.end() || it->second.empty()) return default_bytes;
+    int64_t bytes = ElementBytesOf(it->second[0]);
+    return bytes > 0 ? bytes : default_bytes;
+  }
+  return default_bytes;
+}
+
+int64_t OpCostContext::InputBytes(const std::vector<std::string>& names) const {
+  for (const auto& name : names) {
+    auto it = input_shapes_.find(name);
+    if (it == input_shapes_.end()) continue;
+    int64_t numel = 0;
+    for (const auto& shape : it->second) {
+      numel += ShapeNumel(shape);
+    }
+    return numel * ElementBytes({name});
+  }
+  return 0;
+}
+
+OpCostEstimatorRegistry& OpCostEstimatorRegistry::Instance() {
+  static OpCostEstimatorRegistry instance;
+  return instance;
+}
+
+OpCostEstimatorRegistry::OpCostEstimatorRegistry() {
+  Register("matmul", [](const OpCostContext& ctx) {
+    return MatmulCost(ctx, "transpose_X", "transpose_Y");
+  });
+  Register("matmul_v2", [](const OpCostContext& ctx) {
+    return MatmulCost(ctx, "trans_x", "trans_y");
+  });
+  for (const char* op_type : {"conv2d", "depthwise_conv2d", "conv3d"}) {
+    Register(op_type, ConvCost);
+  }
+  Register("flash_attn", FlashAttnCost);
+  for (const char* op_type : {"elementwise_add",
+                              "elementwise_sub",
+                              "elementwise_mul",
+                              "elementwise_div",
+                              "elementwise_max",
+                              "elementwise_min",
+                              "elementwise_pow",
+                              "add",
+                              "subtract",
+                              "multiply",
+                              "divide",
+                              "maximum",
+                              "minimum"}) {
+    Register(op_type, ElementwiseCost);
+  }
+  for (const char* op_type :
+       {"reduce_sum", "reduce_max", "reduce_min", "reduce_prod"}) {
+    Register(op_type, [](const OpCostContext& ctx) {
+      return ReduceCost(ctx, /*is_mean=*/false);
+    });
+  }
+  for (const char* op_type : {"reduce_mean", "mean"}) {
+    Register(op_type, [](const OpCostContext& ctx) {
+      return ReduceCost(ctx, /*is_mean=*/true);
+    });
+  }
+  for (const char* op_type : {"lookup_table", "lookup_table_v2", "embedding"}) {
+    Register(op_type, EmbeddingCost);
+  }
+}
+
+void OpCostEstimatorRegistry::Register(const std::string& op_type,
+                                       OpCostEstimator estimator) {
+  estimators_[op_type] = std::move(estimator);
+}
+
+OpCost OpCostEstimatorRegistry::Estimate(const std::string& op_type,
+                                         const OpCostContext& context) const {
+  auto it = estimators_.find(op_type);
+  if (it == estimators_.end()) return {};
+  for (const auto& input : context.input_shapes()) {
+    for (const auto& shape : input.second) {
+      if (std::any_of(shape.begin(), shape.end(), [](int64_t dim) {
+            return dim < 0;
+          })) {
+        return {};
+      }
+    }
+  }
+  return it->second(context);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace platform {
+
+// The work of an operator instance, for its place on the roofline.
+struct OpCost {
+  // The floating point operations.
+  int64_t flops = 0;
+  // The bytes read and written in the device memory.
+  int64_t bytes = 0;
+};
+
+// The inputs of an operator instance, as recorded by RecordOpInfoSupplement.
+class OpCostContext {
+ public:
+  using InputShapes = std::map<std::string, std::vector<std::vector<int64_t>>>;
+  using InputDtypes = std::map<std::string, std::vector<std::string>>;
+
+  OpCostContext(const InputShapes& input_shapes,
+                const InputDtypes& dtypes,
+                const framework::AttributeMap& attributes)
+      : input_shapes_(input_shapes), dtypes_(dtypes), attributes_(attributes) {}
+
+  // The shape of the idx-th tensor of the first input found of names, the
+  // names of an input differing between the static graph and the phi api.
+  const std::vector<int64_t>* InputShape(const std::vector<std::string>& names,
+                                         size_t idx = 0) const;
+
+  // The bytes of an element of the input of names. The static graph records
+  // the variable types of the inputs, in which case it is default_bytes.
+  int64_t ElementBytes(const std::vector<std::string>& names,
+                       int64_t default_bytes = 4) const;
+
+  // The bytes of all the tensors of the input of names.
+  int64_t InputBytes(const std::vector<std::string>& names) const;
+
+  template <typename T>
+  T Attr(const std::string& name, const T& default_value) const {
+    auto it = attributes_.find(name);
+    if (it == attributes_.end()) return default_value;
+    const T* value = paddle::get_if<T>(&it->second);
+    return value ? *value : default_value;
+  }
+
+  const InputShapes& input_shapes() const { return input_shapes_; }
+
+ private:
+  const InputShapes& input_shapes_;
+  const InputDtypes& dtypes_;
+  const framework::AttributeMap& attributes_;
+};
+
+// Returns the zero cost if the inputs it needs are not recorded.
+using OpCostEstimator = std::function<OpCost(const OpCostContext&)>;
+
+int64_t ShapeNumel(const std::vector<int64_t>& shape);
+
+//
+// The estimators of the FLOPs and bytes of operators by type, which cover
+// matmul, conv, attention, elementwise, reduction and embedding operators.
+// The estimators are registered before the profiling, and used to place each
+// operator instance profiled on the roofline of the device.
+//
+class OpCostEstimatorRegistry {
+ public:
+  static OpCostEstimatorRegistry& Instance();
+
+  // Register the estimator of op_type, replacing the existing one.
+  void Register(const std::string& op_type, OpCostEstimator estimator);
+
+  bool Has(const std::string& op_type) const {
+    return estimators_.count(op_type) > 0;
+  }
+
+  // The zero cost for the operators without an estimator or with a dynamic
+  // dimension in the shapes.
+  OpCost Estimate(const std::string& op_type,
+                  const OpCostContext& context) const;
+
+ private:
+  OpCostEstimatorRegistry();
+  DISABLE_COPY_AND_ASSIGN(OpCostEstimatorRegistry);
+
+  std::unordered_map<std::string, OpCostEstimator> estimators_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -181,5 +181,13 @@ std::unique_ptr<ProfilerResult> Profiler::Stop() {
   return std::unique_ptr<ProfilerResult>(profiler_result_ptr);
 }
 
+void Profiler::StopAndCollect(TraceEventCollector* collector) {
+  SynchronizeDevice();
+  for (auto& tracer : tracers_) {
+    tracer.Get().StopTracing();
+    tracer.Get().CollectTraceData(collector);
+  }
+}
+
 }  // namespace platform
 }  // namespace paddle
@@ -66,6 +66,10 @@ class Profiler {
 
   std::unique_ptr<ProfilerResult> Stop();
 
+  // Stop tracing and move the trace data to collector without building the
+  // event trees, for the samples of ContinuousProfiler.
+  void StopAndCollect(TraceEventCollector* collector);
+
   ~Profiler();
 
  private:
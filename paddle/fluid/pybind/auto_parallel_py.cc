@@ -41,6 +41,7 @@
 #include "paddle/phi/core/distributed/auto_parallel/reshard/nd_mesh_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/p_to_r_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/p_to_s_reshard_function.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/param_prefetcher.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/r_to_p_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/r_to_s_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/s_to_p_reshard_function.h"
@@ -757,6 +758,17 @@ void BindAutoParallel(py::module *m) {
       },
       py::return_value_policy::reference);
 
+  m->def("register_prefetch_param", [](py::handle py_tensor) {
+    auto tensor = CastPyArg2Tensor(py_tensor.ptr(), 0);
+    phi::distributed::ParamPrefetcher::Instance().Register(tensor.impl());
+  });
+
+  m->def("prefetch_next_step",
+         []() { phi::distributed::ParamPrefetcher::Instance().NextStep(); });
+
+  m->def("clear_prefetch_params",
+         []() { phi::distributed::ParamPrefetcher::Instance().Clear(); });
+
   // TODO(liuzhenhai): DistributedMapper is not used for now, but
   // dist_mapper_test need the symbols touch DistributedMapper to be linked,
   // remove it later
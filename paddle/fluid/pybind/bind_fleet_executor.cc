@@ -17,12 +17,15 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "paddle/fluid/distributed/fleet_executor/dist_model.h"
 #include "paddle/fluid/distributed/fleet_executor/dist_model_tensor_wrapper.h"
 #include "paddle/fluid/distributed/fleet_executor/fleet_executor.h"
+#include "paddle/fluid/distributed/fleet_executor/runtime_graph.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
@@ -72,6 +75,10 @@ using paddle::distributed::DistModelDataBuf;
 using paddle::distributed::DistModelDataType;
 using paddle::distributed::DistModelTensor;
 using paddle::distributed::FleetExecutor;
+using paddle::distributed::PipelineSchedule;
+using paddle::distributed::PipelineScheduleOptions;
+using paddle::distributed::PipelineStageOps;
+using paddle::distributed::RuntimeGraph;
 using paddle::distributed::TaskNode;
 using paddle::framework::OpDesc;
 using paddle::framework::ProgramDesc;
@@ -190,6 +197,60 @@ void BindFleetExecutor(py::module* m) {
       .def("init", [](TaskNode& self) { self.Init(); })
       .def("set_program", &TaskNode::SetProgram);
 
+  py::enum_<PipelineSchedule>(*m, "PipelineSchedule")
+      .value("ONE_F_ONE_B", PipelineSchedule::k1F1B)
+      .value("INTERLEAVED_1F1B", PipelineSchedule::kInterleaved1F1B)
+      .value("ZERO_BUBBLE", PipelineSchedule::kZeroBubble);
+
+  py::class_<RuntimeGraph>(*m, "RuntimeGraph")
+      .def(py::init<>())
+      .def(
+          "build_pipeline_graph",
+          [](RuntimeGraph& self,
+             PipelineSchedule schedule,
+             const std::vector<int64_t>& stage_ranks,
+             int64_t stage_id,
+             int64_t num_micro_batches,
+             int64_t num_virtual_stages,
+             const std::vector<OpDesc*>& lr_ops,
+             const std::vector<std::vector<OpDesc*>>& fwd_ops,
+             const std::vector<std::vector<OpDesc*>>& bwd_ops,
+             const std::vector<std::vector<OpDesc*>>& bwd_weight_ops,
+             const std::vector<OpDesc*>& opt_ops) {
+            PipelineScheduleOptions options;
+            options.schedule = schedule;
+            options.stage_ranks = stage_ranks;
+            options.stage_id = stage_id;
+            options.num_micro_batches = num_micro_batches;
+            options.num_virtual_stages = num_virtual_stages;
+            PipelineStageOps ops;
+            ops.lr = lr_ops;
+            ops.fwd = fwd_ops;
+            ops.bwd = bwd_ops;
+            ops.bwd_weight = bwd_weight_ops;
+            ops.opt = opt_ops;
+            self.BuildPipelineGraph(options, ops);
+          })
+      .def("task_nodes",
+           &RuntimeGraph::task_nodes,
+           py::return_value_policy::reference_internal)
+      .def("interceptor_id_to_rank", &RuntimeGraph::interceptor_id_to_rank)
+      .def("predicted_bubble_ratio", &RuntimeGraph::predicted_bubble_ratio)
+      .def_static("predict_bubble_ratio",
+                  [](PipelineSchedule schedule,
+                     int64_t num_stages,
+                     int64_t num_micro_batches,
+                     int64_t num_virtual_stages) {
+                    PipelineScheduleOptions options;
+                    options.schedule = schedule;
+                    // empty stage ranks are rejected by the check
+                    options.stage_ranks.resize(
+                        std::max<int64_t>(num_stages, 0));
+                    options.num_micro_batches = num_micro_batches;
+                    options.num_virtual_stages = num_virtual_stages;
+                    return RuntimeGraph::PredictBubbleRatio(options);
+                  });
+
   py::class_<DistModelConfig>(*m, "DistModelConfig")
       .def(py::init<>())
       .def_readwrite("model_dir", &DistModelConfig::model_dir)
@@ -213,7 +274,32 @@ void BindFleetExecutor(py::module* m) {
              std::vector<DistModelTensor> outputs;
              self.Run(inputs, &outputs);
              return outputs;
-           });
+           })
+      .def("run_async",
+           [](DistModel& self,
+              const std::vector<DistModelTensor>& inputs,
+              py::function callback) {
+             // the callback is called and released by the thread of the
+             // requests, which takes the GIL for it
+             std::shared_ptr<py::function> func(
+                 new py::function(std::move(callback)), [](py::function* f) {
+                   py::gil_scoped_acquire gil;
+                   delete f;
+                 });
+             self.RunAsync(inputs,
+                           [func](bool ok,
+                                  std::vector<DistModelTensor>* outputs) {
+                             py::gil_scoped_acquire gil;
+                             try {
+                               (*func)(ok, *outputs);
+                             } catch (py::error_already_set& e) {
+                               LOG(ERROR) << "The callback of DistModel "
+                                             "run_async failed: "
+                                          << e.what();
+                             }
+                           });
+           })
+      .def("wait", &DistModel::Wait, py::call_guard<py::gil_scoped_release>());
 
   py::class_<DistModelDataBuf>(*m, "DistModelDataBuf")
       .def(py::init<size_t>())
@@ -30,6 +30,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_feed.h"
 #include "paddle/fluid/framework/data_set.h"
 #include "paddle/fluid/framework/dataset_factory.h"
+#include "paddle/fluid/framework/io/slot_columnar_file.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/io.h"
 #include "paddle/phi/common/place.h"
@@ -397,6 +398,49 @@ void BindDataset(py::module *m) {
                     bool>())
       .def("_start", &IterableDatasetWrapper::Start)
       .def("_next", &IterableDatasetWrapper::Next);
+
+  py::class_<framework::SlotColumnarWriter>(*m, "SlotColumnarWriter")
+      .def(py::init([](const std::string &path,
+                       const std::vector<std::string> &slot_names,
+                       const std::vector<std::string> &slot_types,
+                       bool with_ins_id,
+                       int block_ins_num,
+                       int compress_level) {
+             PADDLE_ENFORCE_EQ(
+                 slot_names.size(),
+                 slot_types.size(),
+                 common::errors::InvalidArgument(
+                     "The number of slot names and slot types should be "
+                     "equal, but received %d and %d.",
+                     slot_names.size(),
+                     slot_types.size()));
+             std::vector<framework::SlotColumnarSlot> slots(slot_names.size());
+             for (size_t i = 0; i < slots.size(); ++i) {
+               slots[i].name = slot_names[i];
+               slots[i].type = slot_types[i];
+             }
+             return std::make_unique<framework::SlotColumnarWriter>(
+                 path, slots, with_ins_id, block_ins_num, compress_level);
+           }),
+           py::arg("path"),
+           py::arg("slot_names"),
+           py::arg("slot_types"),
+           py::arg("with_ins_id") = false,
+           py::arg("block_ins_num") = 4096,
+           py::arg("compress_level") = 1)
+      .def("add_text_line",
+           py::overload_cast<const std::string &>(
+               &framework::SlotColumnarWriter::AddTextLine),
+           py::call_guard<py::gil_scoped_release>())
+      .def("add_text_file",
+           &framework::SlotColumnarWriter::AddTextFile,
+           py::arg("path"),
+           py::arg("converter") = "",
+           py::call_guard<py::gil_scoped_release>())
+      .def("close",
+           &framework::SlotColumnarWriter::Close,
+           py::call_guard<py::gil_scoped_release>())
+      .def("ins_num", &framework::SlotColumnarWriter::ins_num);
 }
 
 }  // namespace paddle::pybind
@@ -66,14 +66,16 @@ std::shared_ptr<distributed::EagerReducer> CreateEagerReducer(
     const std::vector<bool> &is_sparse_gradient,
     std::shared_ptr<distributed::ProcessGroup> process_group,
     const std::vector<size_t> &group_size_limits,
-    bool find_unused_parameters) {
+    bool find_unused_parameters,
+    bool rebuild_groups) {
   auto params = CastPyArg2VectorOfTensor(py_tensors.ptr(), 0);
   return std::make_shared<distributed::EagerReducer>(params,
                                                      group_indices,
                                                      is_sparse_gradient,
                                                      process_group,
                                                      group_size_limits,
-                                                     find_unused_parameters);
+                                                     find_unused_parameters,
+                                                     rebuild_groups);
 }
 
 #if defined(PADDLE_WITH_GLOO)
@@ -1416,7 +1418,14 @@ void BindDistributed(py::module *m) {
   py::class_<distributed::EagerReducer,
              std::shared_ptr<distributed::EagerReducer>>(
       *m, "EagerReducer", R"DOC()DOC")
-      .def(py::init(&CreateEagerReducer))
+      .def(py::init(&CreateEagerReducer),
+           py::arg("tensors"),
+           py::arg("group_indices"),
+           py::arg("is_sparse_gradient"),
+           py::arg("process_group"),
+           py::arg("group_size_limits"),
+           py::arg("find_unused_parameters"),
+           py::arg("rebuild_groups") = false)
       .def(
           "prepare_for_backward",
           [](distributed::EagerReducer &self, py::handle py_tensors) {
@@ -1424,7 +1433,13 @@ void BindDistributed(py::module *m) {
             self.PrepareForBackward(params);
           },
           py::arg("tensors"),
-          py::call_guard<py::gil_scoped_release>());
+          py::call_guard<py::gil_scoped_release>())
+      .def("register_comm_hook",
+           &distributed::EagerReducer::RegisterCommHook,
+           py::arg("hook"),
+           py::arg("group_indices") = std::vector<size_t>{},
+           py::arg("options") = std::map<std::string, double>{},
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<distributed::ProcessGroupIdMap,
              std::shared_ptr<distributed::ProcessGroupIdMap>>(
@@ -146,6 +146,7 @@ static PyObject* eager_api_run_backward(PyObject* self,
                                         PyObject* args,
                                         PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   auto tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 0), 0);
   auto grad_tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 1), 1);
   bool retain_graph = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 2), 2);
@@ -166,6 +167,7 @@ static PyObject* eager_api_run_partial_grad(PyObject* self,
                                             PyObject* args,
                                             PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   auto tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 0), 0);
   auto inputs = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 1), 1);
   auto grad_tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 2), 2);
@@ -1310,6 +1312,66 @@ static PyObject* eager_api_to_uva_tensor(PyObject* self,
 }
 #endif
 
+static phi::DataType NumpyArrayToDataType(const py::array& array) {
+  if (py::isinstance<py::array_t<float>>(array)) {
+    return phi::DataType::FLOAT32;
+  } else if (py::isinstance<py::array_t<double>>(array)) {
+    return phi::DataType::FLOAT64;
+  } else if (py::isinstance<py::array_t<int32_t>>(array)) {
+    return phi::DataType::INT32;
+  } else if (py::isinstance<py::array_t<int64_t>>(array)) {
+    return phi::DataType::INT64;
+  } else if (py::isinstance<py::array_t<int16_t>>(array)) {
+    return phi::DataType::INT16;
+  } else if (py::isinstance<py::array_t<int8_t>>(array)) {
+    return phi::DataType::INT8;
+  } else if (py::isinstance<py::array_t<uint8_t>>(array)) {
+    return phi::DataType::UINT8;
+  } else if (py::isinstance<py::array_t<phi::dtype::float16>>(array)) {
+    return phi::DataType::FLOAT16;
+  } else if (py::isinstance<py::array_t<uint16_t>>(array)) {
+    // since there is still no support for bfloat16 in NumPy,
+    // uint16 is used for casting bfloat16
+    return phi::DataType::BFLOAT16;
+  } else if (py::isinstance<py::array_t<phi::dtype::complex<float>>>(array)) {
+    return phi::DataType::COMPLEX64;
+  } else if (py::isinstance<py::array_t<phi::dtype::complex<double>>>(array)) {
+    return phi::DataType::COMPLEX128;
+  } else if (py::isinstance<py::array_t<bool>>(array)) {
+    return phi::DataType::BOOL;
+  }
+  PADDLE_THROW(common::errors::InvalidArgument(
+      "Incompatible array data type. from_numpy supports array with bool, "
+      "float16, float32, float64, int8, int16, int32, int64, uint8, uint16, "
+      "complex64 or complex128."));
+}
+
+// Wraps the buffer of a C-contiguous numpy array in a CPU tensor without a
+// copy. The allocation keeps a reference to the array, so the tensor and the
+// array share the memory as long as either is alive.
+static PyObject* eager_api_from_numpy(PyObject* self,
+                                      PyObject* args,
+                                      PyObject* kwargs) {
+  EAGER_TRY
+  PyObject* obj = PyTuple_GET_ITEM(args, 0);
+  auto array = py::cast<py::array>(py::handle(obj));
+  PADDLE_ENFORCE_EQ(
+      array.flags() & py::array::c_style,
+      py::array::c_style,
+      common::errors::InvalidArgument(
+          "from_numpy needs a C-contiguous array to share its memory, use "
+          "numpy.ascontiguousarray to make one."));
+  auto dtype = NumpyArrayToDataType(array);
+  std::vector<int64_t> dims(array.shape(), array.shape() + array.ndim());
+  auto holder = std::make_shared<EagerNumpyAllocation>(array.ptr(), dtype);
+  auto dense_tensor = std::make_shared<phi::DenseTensor>(
+      holder, phi::DenseTensorMeta(dtype, common::make_ddim(dims)));
+  paddle::Tensor tensor(dense_tensor,
+                        egr::Controller::Instance().GenerateUniqueName());
+  return ToPyObject(tensor);
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
 static PyObject* eager_api__add_backward_final_hook(PyObject* self,
                                                     PyObject* args,
                                                     PyObject* kwargs) {
@@ -1362,6 +1424,15 @@ PyObject* eager__is_run_in_backward(PyObject* self,
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
 
+static PyObject* eager__sync_lazy_tensors(PyObject* self,
+                                          PyObject* args,
+                                          PyObject* kwargs) {
+  EAGER_TRY
+  SyncLazyTensors();
+  RETURN_PY_NONE
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
 PyMethodDef variable_functions[] = {  // NOLINT
     // TODO(jiabin): Remove scale when we have final state tests
     {"scale",
@@ -1389,6 +1460,10 @@ PyMethodDef variable_functions[] = {  // NOLINT
      (PyCFunction)(void (*)())eager_api_run_custom_op,
      METH_VARARGS | METH_KEYWORDS,
      nullptr},
+    {"from_numpy",
+     (PyCFunction)(void (*)())eager_api_from_numpy,
+     METH_VARARGS | METH_KEYWORDS,
+     nullptr},
     {"tensor_copy",
      (PyCFunction)(void (*)())eager_api_tensor_copy,
      METH_VARARGS | METH_KEYWORDS,
@@ -1439,6 +1514,10 @@ PyMethodDef variable_functions[] = {  // NOLINT
      (PyCFunction)(void (*)())eager__is_run_in_backward,
      METH_VARARGS | METH_KEYWORDS,
      nullptr},
+    {"_sync_lazy_tensors",
+     (PyCFunction)(void (*)())eager__sync_lazy_tensors,
+     METH_VARARGS | METH_KEYWORDS,
+     nullptr},
 /**sparse functions**/
 #if defined(PADDLE_WITH_CUDA)
     {"async_read",
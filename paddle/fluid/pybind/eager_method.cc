@@ -46,6 +46,7 @@ typedef SSIZE_T ssize_t;
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/memory/allocation/allocator.h"
 #include "paddle/phi/core/memory/memcpy.h"
+#include "paddle/phi/core/memory/tensor_evictor.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
 #include "paddle/phi/core/sparse_csr_tensor.h"
 #include "paddle/phi/core/vocab/string_array.h"
@@ -152,6 +153,7 @@ static PyObject* tensor_method_numpy(TensorObject* self,
                                      PyObject* args,
                                      PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   auto& api = pybind11::detail::npy_api::get();
   if (!self->tensor.impl()) {
     Py_intptr_t py_dims[phi::DDim::kMaxRank];     // NOLINT
@@ -557,6 +559,7 @@ static PyObject* tensor_method__is_initialized(TensorObject* self,
                                                PyObject* args,
                                                PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   return ToPyObject(self->tensor.initialized());
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
@@ -564,6 +567,7 @@ static PyObject* tensor_method__is_initialized(TensorObject* self,
 static PyObject* tensor_method__is_dense_tensor_hold_allocation(
     TensorObject* self, PyObject* args, PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   if (!self->tensor.defined()) {
     return ToPyObject(false);
   }
@@ -611,6 +615,7 @@ static PyObject* tensor_method__copy_to(TensorObject* self,
                                         PyObject* args,
                                         PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   auto place = CastPyArg2Place(PyTuple_GET_ITEM(args, 0), 0);
   bool blocking = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 1), 1);
   paddle::Tensor cp_tensor;
@@ -1527,6 +1532,7 @@ static PyObject* tensor__getitem_from_offset(TensorObject* self,
                                              PyObject* args,
                                              PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   phi::DenseTensor* ptr = nullptr;
   phi::DenseTensor tensor_after_reshard;
   if (self->tensor.is_selected_rows()) {
@@ -2147,6 +2153,18 @@ static PyObject* tensor__clear(TensorObject* self,
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
 
+static PyObject* tensor__set_evictable(TensorObject* self,
+                                       PyObject* args,
+                                       PyObject* kwargs) {
+  EAGER_TRY
+  if (self->tensor.is_dense_tensor()) {
+    paddle::memory::TensorEvictor::Instance().Register(
+        std::static_pointer_cast<phi::DenseTensor>(self->tensor.impl()));
+  }
+  RETURN_PY_NONE
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
 static PyObject* tensor__clear_dataptr(TensorObject* self,
                                        PyObject* args,
                                        PyObject* kwargs) {
@@ -3077,6 +3095,7 @@ static PyObject* tensor_data_ptr(TensorObject* self,
                                  PyObject* args,
                                  PyObject* kwargs) {
   EAGER_TRY
+  SyncLazyTensors();
   if (self->tensor.initialized() && self->tensor.is_dense_tensor()) {
     return ToPyObject(
         (int64_t)std::dynamic_pointer_cast<phi::DenseTensor>(  // NOLINT
@@ -3364,6 +3383,10 @@ PyMethodDef variable_methods[] = {  // NOLINT
      (PyCFunction)(void (*)())tensor__unsafe_share_buffer_to,
      METH_VARARGS | METH_KEYWORDS,
      nullptr},
+    {"_set_evictable",
+     (PyCFunction)(void (*)())tensor__set_evictable,
+     METH_VARARGS | METH_KEYWORDS,
+     nullptr},
     {"_is_shared_buffer_with",
      (PyCFunction)(void (*)())tensor__is_shared_buffer_with,
      METH_VARARGS | METH_KEYWORDS,
@@ -781,12 +781,14 @@ Examples:
 )DOC");
 PyObject* tensor_properties_get_place(TensorObject* self, void* closure) {
   EAGER_TRY
+  SyncLazyTensors();
   return ToPyObject(self->tensor.place());
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
 
 PyObject* tensor_properties_get_place_str(TensorObject* self, void* closure) {
   EAGER_TRY
+  SyncLazyTensors();
   std::stringstream ostr;
   ostr << self->tensor.place();
   return ToPyObject(ostr.str());
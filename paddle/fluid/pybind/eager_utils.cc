@@ -26,6 +26,7 @@ limitations under the License. */
 #include "paddle/fluid/eager/api/all.h"
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/hooks.h"
+#include "paddle/fluid/eager/lazy_recorder.h"
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/scope_guard.h"
@@ -319,6 +320,12 @@ void SetPythonStack() {
   }
 }
 
+void SyncLazyTensors() {
+  if (UNLIKELY(egr::LazyRecorder::IsActive())) {
+    egr::LazyRecorder::Instance().Flush();
+  }
+}
+
 std::shared_ptr<jit::Function> CastPyArg2JitFunction(PyObject* obj,
                                                      ssize_t arg_pos) {
   if (PyObject_TypeCheck(obj, g_jit_function_pytype)) {
@@ -119,6 +119,9 @@ std::vector<std::string> CastPyArg2VectorOfString(PyObject* obj,
 std::shared_ptr<jit::Function> CastPyArg2JitFunction(PyObject* obj,
                                                      ssize_t arg_pos);
 void SetPythonStack();
+// Runs the eager ops recorded by the lazy mode, before the buffers of the
+// tensors are read.
+void SyncLazyTensors();
 
 PyObject* ToPyObject(int value);
 PyObject* ToPyObject(uint32_t value);
@@ -452,7 +452,10 @@ void BindIndexSampler(py::module* m) {
       }))
       .def("init_layerwise_conf", &IndexSampler::init_layerwise_conf)
       .def("init_beamsearch_conf", &IndexSampler::init_beamsearch_conf)
-      .def("sample", &IndexSampler::sample);
+      .def("sample", &IndexSampler::sample)
+      .def("sample_batch",
+           &IndexSampler::sample_batch,
+           py::call_guard<py::gil_scoped_release>());
 }
 }  // end namespace pybind
 }  // namespace paddle
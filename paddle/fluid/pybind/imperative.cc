@@ -650,6 +650,12 @@ void BindImperative(py::module *m_ptr) {
         *(imperative::AmpOperators::Instance().GetMutableAllowOps()),
         *(imperative::AmpOperators::Instance().GetMutableBlockOps()));
   });
+  m.def("_clear_amp_cast_cache",
+        []() { imperative::AmpCastCache::Instance().Clear(); });
+  m.def("_get_amp_cast_cache_stats", []() {
+    auto &cache = imperative::AmpCastCache::Instance();
+    return std::make_tuple(cache.Size(), cache.Hits(), cache.Misses());
+  });
 
   py::enum_<paddle::imperative::AmpLevel>(m, "AmpLevel", py::arithmetic())
       .value("O0", paddle::imperative::AmpLevel::O0)
@@ -36,6 +36,8 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_pass_builder.h"
 #include "paddle/fluid/inference/api/paddle_tensor.h"
+#include "paddle/fluid/inference/utils/block_kv_cache_manager.h"
+#include "paddle/fluid/inference/utils/speculative_decoder.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/pybind/eager.h"
 #include "paddle/fluid/pybind/eager_utils.h"
@@ -113,6 +115,8 @@ void BindPaddleInferPredictor(py::module *m);
 void BindPaddleInferTensor(py::module *m);
 void BindPredictorPool(py::module *m);
 void BindInternalUtils(py::module *m);
+void BindBlockKVCacheManager(py::module *m);
+void BindSpeculativeDecoder(py::module *m);
 
 template <typename T>
 PaddleBuf PaddleBufCreate(py::array_t<T, py::array::c_style> data) {
@@ -521,6 +525,8 @@ void BindInferenceApi(py::module *m) {
   BindPaddlePassBuilder(m);
   BindPredictorPool(m);
   BindInternalUtils(m);
+  BindBlockKVCacheManager(m);
+  BindSpeculativeDecoder(m);
   m->def("create_paddle_predictor",
          &paddle::CreatePaddlePredictor<AnalysisConfig>,
          py::arg("config"));
@@ -768,6 +774,7 @@ void BindAnalysisConfig(py::module *m) {
       .value("Int8", AnalysisConfig::Precision::kInt8)
       .value("Half", AnalysisConfig::Precision::kHalf)
       .value("Bfloat16", AnalysisConfig::Precision::kBf16)
+      .value("Float8", AnalysisConfig::Precision::kFp8)
       .export_values();
 
   analysis_config.def(py::init<>())
@@ -865,9 +872,19 @@ void BindAnalysisConfig(py::module *m) {
       .def("use_optimized_model",
            &AnalysisConfig::UseOptimizedModel,
            py::arg("x") = true)
+      .def("enable_lowered_program_cache",
+           &AnalysisConfig::EnableLoweredProgramCache,
+           py::arg("x") = true)
+      .def("lowered_program_cache_enabled",
+           &AnalysisConfig::lowered_program_cache_enabled)
       .def("enable_memory_optim",
            &AnalysisConfig::EnableMemoryOptim,
            py::arg("x") = true)
+      .def("enable_memory_optim_workspace",
+           &AnalysisConfig::EnableMemoryOptimWorkspace,
+           py::arg("shape_range_info_path") = std::string())
+      .def("memory_optim_workspace_enabled",
+           &AnalysisConfig::memory_optim_workspace_enabled)
       .def("enable_new_executor",
            &AnalysisConfig::EnableNewExecutor,
            py::arg("x") = true)
@@ -879,6 +896,10 @@ void BindAnalysisConfig(py::module *m) {
       .def("enable_save_optim_model",
            &AnalysisConfig::EnableSaveOptimModel,
            py::arg("save_optimized_model") = false)
+      .def("enable_mmap_params",
+           &AnalysisConfig::EnableMmapParams,
+           py::arg("x") = true)
+      .def("mmap_params_enabled", &AnalysisConfig::mmap_params_enabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
       .def("switch_use_feed_fetch_ops",
            &AnalysisConfig::SwitchUseFeedFetchOps,
@@ -923,10 +944,48 @@ void BindAnalysisConfig(py::module *m) {
       .def("enable_tensorrt_varseqlen", &AnalysisConfig::EnableVarseqlen)
       .def("tensorrt_varseqlen_enabled",
            &AnalysisConfig::tensorrt_varseqlen_enabled)
-      .def("collect_shape_range_info", &AnalysisConfig::CollectShapeRangeInfo)
+      .def("collect_shape_range_info",
+           &AnalysisConfig::CollectShapeRangeInfo,
+           py::arg("shape_range_info_path"),
+           py::arg("shape_bucket_num") = 1)
       .def("shape_range_info_path", &AnalysisConfig::shape_range_info_path)
       .def("shape_range_info_collected",
            &AnalysisConfig::shape_range_info_collected)
+      .def("collect_shape_range_info_online",
+           &AnalysisConfig::CollectShapeRangeInfoOnline,
+           py::arg("shape_range_info_path"),
+           py::arg("sample_interval") = 100,
+           py::arg("save_interval") = 1000)
+      .def("shape_range_info_collected_online",
+           &AnalysisConfig::shape_range_info_collected_online)
+      .def("collect_activation_range",
+           &AnalysisConfig::CollectActivationRange,
+           py::arg("activation_range_path"),
+           py::arg("num_bins") = 2048)
+      .def("activation_range_path", &AnalysisConfig::activation_range_path)
+      .def("activation_range_collected",
+           &AnalysisConfig::activation_range_collected)
+      .def("enable_run_statistics",
+           &AnalysisConfig::EnableRunStatistics,
+           py::arg("op_sample_interval") = 0)
+      .def("run_statistics_enabled", &AnalysisConfig::run_statistics_enabled)
+      .def("enable_colocation",
+           &AnalysisConfig::EnableColocation,
+           py::arg("weight") = 1,
+           py::arg("memory_quota") = 0)
+      .def("colocation_enabled", &AnalysisConfig::colocation_enabled)
+      .def("enable_memory_compaction",
+           &AnalysisConfig::EnableMemoryCompaction,
+           py::arg("idle_ms") = 1000)
+      .def("memory_compaction_enabled",
+           &AnalysisConfig::memory_compaction_enabled)
+      .def("enable_cuda_malloc_async_allocator",
+           &AnalysisConfig::EnableCudaMallocAsyncAllocator,
+           py::arg("release_threshold_mb") = -1,
+           py::arg("peer_access") = false,
+           py::arg("idle_trim_ms") = 0)
+      .def("cuda_malloc_async_allocator_enabled",
+           &AnalysisConfig::cuda_malloc_async_allocator_enabled)
       .def("enable_tuned_tensorrt_dynamic_shape",
            &AnalysisConfig::EnableTunedTensorRtDynamicShape,
            py::arg("shape_range_info_path") = "",
@@ -952,6 +1011,16 @@ void BindAnalysisConfig(py::module *m) {
            py::arg("inspector_serialize") = false)
       .def("tensorrt_inspector_enabled",
            &AnalysisConfig::tensorrt_inspector_enabled)
+      .def("enable_tensorrt_refit",
+           &AnalysisConfig::EnableTensorRtRefit,
+           py::arg("refit") = true)
+      .def("tensorrt_refit_enabled", &AnalysisConfig::tensorrt_refit_enabled)
+      .def("enable_tensorrt_activation_range",
+           &AnalysisConfig::EnableTensorRtActivationRange,
+           py::arg("activation_range_path"),
+           py::arg("percentile") = 99.99f)
+      .def("tensorrt_activation_range_path",
+           &AnalysisConfig::tensorrt_activation_range_path)
       .def("enable_tensorrt_explicit_quantization",
            &AnalysisConfig::EnableTensorRtExplicitQuantization)
       .def("tensorrt_explicit_quantization_enabled",
@@ -973,12 +1042,24 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("enable_gemm_weight_prepack",
+           &AnalysisConfig::EnableGemmWeightPrepack,
+           py::arg("x") = true)
+      .def("gemm_weight_prepack_enabled",
+           &AnalysisConfig::gemm_weight_prepack_enabled)
+      .def("enable_cpu_weight_only_quantize",
+           &AnalysisConfig::EnableCpuWeightOnlyQuantize,
+           py::arg("algo") = "weight_only_int8")
+      .def("cpu_weight_only_algo", &AnalysisConfig::cpu_weight_only_algo)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_mkldnn_bfloat16", &AnalysisConfig::EnableMkldnnBfloat16)
 #ifdef PADDLE_WITH_DNNL
       .def("set_mkldnn_cache_capacity",
            &AnalysisConfig::SetMkldnnCacheCapacity,
            py::arg("capacity") = 0)
+      .def("warmup_onednn_primitive_cache",
+           &AnalysisConfig::WarmupOneDNNPrimitiveCache,
+           py::arg("shape_range_info_path"))
       .def("set_bfloat16_op", &AnalysisConfig::SetBfloat16Op)
       .def("enable_mkldnn_int8",
            &AnalysisConfig::EnableMkldnnInt8,
@@ -1097,6 +1178,8 @@ void BindAnalysisPredictor(py::module *m) {
       .def("clear_intermediate_tensor",
            &AnalysisPredictor::ClearIntermediateTensor)
       .def("try_shrink_memory", &AnalysisPredictor::TryShrinkMemory)
+      .def("compact_memory", &AnalysisPredictor::CompactMemory)
+      .def("refit_tensorrt_engines", &AnalysisPredictor::RefitTensorRTEngines)
       .def("create_feed_fetch_var", &AnalysisPredictor::CreateFeedFetchVar)
       .def("prepare_feed_fetch", &AnalysisPredictor::PrepareFeedFetch)
       .def("prepare_argument", &AnalysisPredictor::PrepareArgument)
@@ -1122,6 +1205,21 @@ void BindAnalysisPredictor(py::module *m) {
 }
 
 void BindPaddleInferPredictor(py::module *m) {
+  py::class_<paddle_infer::LatencyStats>(*m, "LatencyStats")
+      .def_readonly("count", &paddle_infer::LatencyStats::count)
+      .def_readonly("avg", &paddle_infer::LatencyStats::avg)
+      .def_readonly("p50", &paddle_infer::LatencyStats::p50)
+      .def_readonly("p99", &paddle_infer::LatencyStats::p99)
+      .def_readonly("max", &paddle_infer::LatencyStats::max);
+
+  py::class_<paddle_infer::RunStats>(*m, "RunStats")
+      .def_readonly("run", &paddle_infer::RunStats::run)
+      .def_readonly("feed", &paddle_infer::RunStats::feed)
+      .def_readonly("executor", &paddle_infer::RunStats::executor)
+      .def_readonly("sync", &paddle_infer::RunStats::sync)
+      .def_readonly("fetch", &paddle_infer::RunStats::fetch)
+      .def_readonly("ops", &paddle_infer::RunStats::ops);
+
   py::class_<paddle_infer::Predictor>(*m, "PaddleInferPredictor")
       .def(py::init<const paddle_infer::Config &>())
       .def("get_input_names", &paddle_infer::Predictor::GetInputNames)
@@ -1157,10 +1255,13 @@ void BindPaddleInferPredictor(py::module *m) {
            })
 #endif
       .def("try_shrink_memory", &paddle_infer::Predictor::TryShrinkMemory)
+      .def("compact_memory", &paddle_infer::Predictor::CompactMemory)
       .def("clear_intermediate_tensor",
            &paddle_infer::Predictor::ClearIntermediateTensor)
       .def("register_output_hook", &paddle_infer::Predictor::RegisterOutputHook)
-      .def("register_input_hook", &paddle_infer::Predictor::RegisterInputHook);
+      .def("register_input_hook", &paddle_infer::Predictor::RegisterInputHook)
+      .def("get_run_stats", &paddle_infer::Predictor::GetRunStats)
+      .def("reset_run_stats", &paddle_infer::Predictor::ResetRunStats);
 }
 
 void BindZeroCopyTensor(py::module *m) {
@@ -1225,6 +1326,131 @@ void BindPredictorPool(py::module *m) {
       .def("retrieve",
            &paddle_infer::services::PredictorPool::Retrieve,
            py::return_value_policy::reference);
+
+  py::class_<paddle_infer::services::ColocationOptions>(*m,
+                                                        "ColocationOptions")
+      .def(py::init<>())
+      .def_readwrite("memory_cap",
+                     &paddle_infer::services::ColocationOptions::memory_cap)
+      .def_readwrite("num_streams",
+                     &paddle_infer::services::ColocationOptions::num_streams)
+      .def_readwrite(
+          "max_concurrent_runs",
+          &paddle_infer::services::ColocationOptions::max_concurrent_runs);
+  m->def("set_colocation_options",
+         &paddle_infer::services::SetColocationOptions,
+         py::arg("device_id"),
+         py::arg("options"));
+
+  py::class_<paddle_infer::services::AsyncPredictorPoolStats>(
+      *m, "AsyncPredictorPoolStats")
+      .def_readonly("num_finished",
+                    &paddle_infer::services::AsyncPredictorPoolStats::
+                        num_finished)
+      .def_readonly(
+          "num_failed",
+          &paddle_infer::services::AsyncPredictorPoolStats::num_failed)
+      .def_readonly(
+          "num_pending",
+          &paddle_infer::services::AsyncPredictorPoolStats::num_pending)
+      .def_readonly(
+          "avg_queue_time",
+          &paddle_infer::services::AsyncPredictorPoolStats::avg_queue_time)
+      .def_readonly(
+          "max_queue_time",
+          &paddle_infer::services::AsyncPredictorPoolStats::max_queue_time)
+      .def_readonly(
+          "avg_run_time",
+          &paddle_infer::services::AsyncPredictorPoolStats::avg_run_time)
+      .def_readonly(
+          "max_run_time",
+          &paddle_infer::services::AsyncPredictorPoolStats::max_run_time)
+      .def_readonly(
+          "num_runs",
+          &paddle_infer::services::AsyncPredictorPoolStats::num_runs);
+
+  py::class_<paddle_infer::services::AsyncPredictorPool>(*m,
+                                                         "AsyncPredictorPool")
+      .def(py::init<const paddle_infer::Config &, size_t>())
+      .def(
+          "run",
+          [](paddle_infer::services::AsyncPredictorPool &self,
+             py::handle py_in_tensor_list) {
+            auto in_tensor_list =
+                CastPyArg2VectorOfTensor(py_in_tensor_list.ptr(), 0);
+            std::vector<paddle::Tensor> outputs;
+            bool ok = false;
+            {
+              // other python threads may submit meanwhile
+              pybind11::gil_scoped_release release;
+              ok = self.Run(std::move(in_tensor_list), &outputs).get();
+            }
+            PADDLE_ENFORCE_EQ(ok,
+                              true,
+                              common::errors::Fatal(
+                                  "AsyncPredictorPool failed to run."));
+            return py::handle(ToPyObject(outputs));
+          },
+          py::arg("inputs"))
+      .def("get_stats", &paddle_infer::services::AsyncPredictorPool::GetStats)
+      .def("reset_stats",
+           &paddle_infer::services::AsyncPredictorPool::ResetStats)
+      .def("size", &paddle_infer::services::AsyncPredictorPool::size);
+
+  py::class_<paddle_infer::services::DynamicBatcherConfig>(
+      *m, "DynamicBatcherConfig")
+      .def(py::init<>())
+      .def_readwrite(
+          "max_batch_size",
+          &paddle_infer::services::DynamicBatcherConfig::max_batch_size)
+      .def_readwrite(
+          "max_wait_us",
+          &paddle_infer::services::DynamicBatcherConfig::max_wait_us)
+      .def_readwrite(
+          "batch_sizes",
+          &paddle_infer::services::DynamicBatcherConfig::batch_sizes)
+      .def_readwrite("shape_range_info_path",
+                     &paddle_infer::services::DynamicBatcherConfig::
+                         shape_range_info_path);
+
+  py::class_<paddle_infer::services::DynamicBatcherStats>(
+      *m, "DynamicBatcherStats")
+      .def_readonly(
+          "num_requests",
+          &paddle_infer::services::DynamicBatcherStats::num_requests)
+      .def_readonly(
+          "num_batches",
+          &paddle_infer::services::DynamicBatcherStats::num_batches)
+      .def_readonly(
+          "num_samples",
+          &paddle_infer::services::DynamicBatcherStats::num_samples)
+      .def_readonly(
+          "num_padded_samples",
+          &paddle_infer::services::DynamicBatcherStats::num_padded_samples)
+      .def_readonly(
+          "num_failed_batches",
+          &paddle_infer::services::DynamicBatcherStats::num_failed_batches);
+
+  py::class_<paddle_infer::services::DynamicBatcher>(*m, "DynamicBatcher")
+      .def(py::init<const paddle_infer::Config &,
+                    const paddle_infer::services::DynamicBatcherConfig &>())
+      .def(
+          "run",
+          [](paddle_infer::services::DynamicBatcher &self,
+             py::handle py_in_tensor_list) {
+            auto in_tensor_list =
+                CastPyArg2VectorOfTensor(py_in_tensor_list.ptr(), 0);
+            std::vector<paddle::Tensor> outputs;
+            {
+              // the requests of other python threads join the batch
+              pybind11::gil_scoped_release release;
+              outputs = self.Submit(std::move(in_tensor_list)).get();
+            }
+            return py::handle(ToPyObject(outputs));
+          },
+          py::arg("inputs"))
+      .def("batch_sizes", &paddle_infer::services::DynamicBatcher::batch_sizes)
+      .def("get_stats", &paddle_infer::services::DynamicBatcher::GetStats);
 }
 
 void BindPaddlePassBuilder(py::module *m) {
@@ -1290,5 +1516,80 @@ void BindInternalUtils(py::module *m) {
                     InternalUtils::DisableTensorRtHalfOps(&config, ops);
                   });
 }
+
+void BindBlockKVCacheManager(py::module *m) {
+  using paddle::inference::BlockKVCacheManager;
+  py::class_<BlockKVCacheManager>(*m, "BlockKVCacheManager")
+      .def(py::init<int, int>(), py::arg("num_blocks"), py::arg("block_size"))
+      .def("add_sequence",
+           &BlockKVCacheManager::AddSequence,
+           py::arg("seq_id"),
+           py::arg("prompt"))
+      .def("append_tokens",
+           &BlockKVCacheManager::AppendTokens,
+           py::arg("seq_id"),
+           py::arg("tokens"))
+      .def("fork_sequence",
+           &BlockKVCacheManager::ForkSequence,
+           py::arg("src_id"),
+           py::arg("dst_id"))
+      .def("cache_prefix", &BlockKVCacheManager::CachePrefix)
+      .def("truncate_sequence",
+           &BlockKVCacheManager::TruncateSequence,
+           py::arg("seq_id"),
+           py::arg("length"))
+      .def("free_sequence", &BlockKVCacheManager::FreeSequence)
+      .def("has_sequence", &BlockKVCacheManager::HasSequence)
+      .def("sequence_length", &BlockKVCacheManager::SequenceLength)
+      .def("block_table", &BlockKVCacheManager::BlockTable)
+      .def(
+          "block_tables",
+          [](const BlockKVCacheManager &self,
+             const std::vector<int64_t> &seq_ids,
+             int max_blocks_per_seq) {
+            py::array_t<int32_t> block_tables(
+                {static_cast<py::ssize_t>(seq_ids.size()),
+                 static_cast<py::ssize_t>(max_blocks_per_seq)});
+            self.FillBlockTables(
+                seq_ids, max_blocks_per_seq, block_tables.mutable_data());
+            return block_tables;
+          },
+          py::arg("seq_ids"),
+          py::arg("max_blocks_per_seq"))
+      .def("take_pending_copies", &BlockKVCacheManager::TakePendingCopies)
+      .def("num_free_blocks", &BlockKVCacheManager::NumFreeBlocks)
+      .def("num_cached_blocks", &BlockKVCacheManager::NumCachedBlocks)
+      .def_property_readonly("num_blocks", &BlockKVCacheManager::num_blocks)
+      .def_property_readonly("block_size", &BlockKVCacheManager::block_size);
+}
+
+void BindSpeculativeDecoder(py::module *m) {
+  using paddle::inference::BlockKVCacheManager;
+  using paddle::inference::SpeculativeDecoder;
+  py::class_<SpeculativeDecoder>(*m, "SpeculativeDecoder")
+      .def(py::init<SpeculativeDecoder::ForwardFunc,
+                    SpeculativeDecoder::ForwardFunc,
+                    BlockKVCacheManager *,
+                    BlockKVCacheManager *,
+                    int,
+                    int,
+                    uint64_t>(),
+           py::arg("draft_forward"),
+           py::arg("target_forward"),
+           py::arg("draft_cache"),
+           py::arg("target_cache"),
+           py::arg("num_draft_tokens"),
+           py::arg("vocab_size"),
+           py::arg("seed") = 0,
+           py::keep_alive<1, 4>(),
+           py::keep_alive<1, 5>())
+      .def("add_sequence",
+           &SpeculativeDecoder::AddSequence,
+           py::arg("seq_id"),
+           py::arg("prompt"))
+      .def("step", &SpeculativeDecoder::Step, py::arg("seq_id"))
+      .def("free_sequence", &SpeculativeDecoder::FreeSequence)
+      .def("acceptance_rate", &SpeculativeDecoder::AcceptanceRate);
+}
 }  // namespace
 }  // namespace paddle::pybind
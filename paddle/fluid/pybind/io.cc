@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/pybind/io.h"
 
+#include "paddle/fluid/framework/io/async_checkpoint.h"
+#include "paddle/fluid/framework/io/param_file.h"
 #include "paddle/fluid/framework/io/save_load_tensor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/selected_rows_utils.h"
@@ -44,6 +46,47 @@ void Load(const std::string &file_path,
           const PlaceType place) {
   pir::LoadFunction(file_path, seek, shape, load_as_fp16, out, place);
 }
+template <typename PlaceType>
+void BindParamFileRead(py::class_<framework::ParamFileReader> *reader) {
+  reader
+      ->def(
+          "read",
+          [](const framework::ParamFileReader &self,
+             const std::vector<std::string> &names,
+             const PlaceType place,
+             int num_threads) {
+            std::vector<phi::DenseTensor> tensors(names.size());
+            std::vector<phi::DenseTensor *> out;
+            for (auto &tensor : tensors) {
+              out.push_back(&tensor);
+            }
+            self.Read(names, place, out, num_threads);
+            return tensors;
+          },
+          py::arg("names"),
+          py::arg("place"),
+          py::arg("num_threads") = 8,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "read_slice",
+          [](const framework::ParamFileReader &self,
+             const std::string &name,
+             int axis,
+             int64_t begin,
+             int64_t end,
+             const PlaceType place) {
+            phi::DenseTensor tensor;
+            self.ReadSlice(name, axis, begin, end, place, &tensor);
+            return tensor;
+          },
+          py::arg("name"),
+          py::arg("axis"),
+          py::arg("begin"),
+          py::arg("end"),
+          py::arg("place"),
+          py::call_guard<py::gil_scoped_release>());
+}
+
 void BindIO(pybind11::module *m) {
   m->def("save_lod_tensor",
          [](const phi::DenseTensor &tensor, const std::string &str_file_name) {
@@ -161,6 +204,60 @@ void BindIO(pybind11::module *m) {
   m->def("load_combine_func", &LoadCombine<phi::IPUPlace>);
   m->def("load_combine_func", &LoadCombine<phi::Place>);
 
+  py::class_<framework::AsyncCheckpointWriter>(*m, "AsyncCheckpointWriter")
+      .def(py::init<int>(), py::arg("num_threads") = 4)
+      .def(
+          "save",
+          [](framework::AsyncCheckpointWriter &self,
+             const std::vector<std::string> &names,
+             const std::vector<paddle::Tensor> &tensors,
+             const std::string &path,
+             bool dedup) {
+            std::vector<phi::DenseTensor> dense_tensors;
+            dense_tensors.reserve(tensors.size());
+            for (size_t i = 0; i < tensors.size(); ++i) {
+              PADDLE_ENFORCE_EQ(
+                  tensors[i].is_dense_tensor(),
+                  true,
+                  common::errors::InvalidArgument(
+                      "The tensor %s to save should be a DenseTensor.",
+                      names[i]));
+              dense_tensors.push_back(
+                  *std::static_pointer_cast<phi::DenseTensor>(
+                      tensors[i].impl()));
+            }
+            py::gil_scoped_release release;
+            self.Save(names, dense_tensors, path, dedup);
+          },
+          py::arg("names"),
+          py::arg("tensors"),
+          py::arg("path"),
+          py::arg("dedup") = false)
+      .def("wait",
+           &framework::AsyncCheckpointWriter::Wait,
+           py::call_guard<py::gil_scoped_release>());
+
+  m->def("is_async_checkpoint_file", &framework::IsAsyncCheckpointFile);
+
+  m->def("load_async_checkpoint", &framework::LoadAsyncCheckpoint);
+
+  m->def("save_param_file",
+         &framework::SaveParamFile,
+         py::arg("file_path"),
+         py::arg("names"),
+         py::arg("tensors"));
+
+  m->def("is_param_file", &framework::IsParamFile);
+
+  py::class_<framework::ParamFileReader> param_file_reader(*m,
+                                                          "ParamFileReader");
+  param_file_reader.def(py::init<const std::string &>())
+      .def("names", &framework::ParamFileReader::Names);
+  BindParamFileRead<phi::CPUPlace>(&param_file_reader);
+  BindParamFileRead<phi::GPUPinnedPlace>(&param_file_reader);
+  BindParamFileRead<phi::GPUPlace>(&param_file_reader);
+  BindParamFileRead<phi::Place>(&param_file_reader);
+
   m->def("serialize_pir_program",
          &pir::WriteModule,
          py::arg("program"),
@@ -168,7 +265,8 @@ void BindIO(pybind11::module *m) {
          py::arg("pir_version"),
          py::arg("overwrite") = true,
          py::arg("readable") = false,
-         py::arg("trainable") = true);
+         py::arg("trainable") = true,
+         py::arg("binary") = false);
   m->def("deserialize_pir_program",
          &pir::ReadModule,
          py::arg("file_path"),
@@ -68,6 +68,10 @@ void BindPSGPUWrapper(py::module* m) {
       .def("dump_to_mem",
            &framework::PSGPUWrapper::DumpToMem,
            py::call_guard<py::gil_scoped_release>())
+      .def("wait_end_pass",
+           &framework::PSGPUWrapper::WaitEndPass,
+           py::arg("release_values") = false,
+           py::call_guard<py::gil_scoped_release>())
       .def("load_into_memory",
            &framework::PSGPUWrapper::LoadIntoMemory,
            py::call_guard<py::gil_scoped_release>())
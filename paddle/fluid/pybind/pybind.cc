@@ -78,6 +78,8 @@ limitations under the License. */
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/framework/reader.h"
 #include "paddle/phi/core/memory/allocation/allocator_strategy.h"
+#include "paddle/phi/core/memory/allocation/step_replay_allocator.h"
+#include "paddle/phi/core/memory/allocation_trace.h"
 #include "paddle/phi/core/raw_tensor.h"
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 #include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator_v2.h"
@@ -89,6 +91,8 @@ limitations under the License. */
 #include "paddle/fluid/operators/py_func_op.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/profiler/chrometracing_logger.h"
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
 #include "paddle/fluid/platform/tensorrt/engine_params.h"
@@ -1353,7 +1357,9 @@ PYBIND11_MODULE(libpaddle, m) {
           }
         }
         if (lib == "phi" || lib == "all") {
-          auto phi_kernels = phi::KernelFactory::Instance().kernels();
+          const phi::KernelFactory &kernel_factory =
+              phi::KernelFactory::Instance();
+          const auto &phi_kernels = kernel_factory.kernels();
           for (auto &kernel_pair : phi_kernels) {
             auto op_type = phi::TransToFluidOpName(kernel_pair.first);
             std::vector<std::string> kernel_types;
@@ -1393,7 +1399,9 @@ PYBIND11_MODULE(libpaddle, m) {
       [](const std::string &kernel_registered_type) {
         std::unordered_map<std::string, std::vector<std::string>>
             all_kernels_info;
-        auto phi_kernels = phi::KernelFactory::Instance().kernels();
+        const phi::KernelFactory &kernel_factory =
+            phi::KernelFactory::Instance();
+        const auto &phi_kernels = kernel_factory.kernels();
         for (auto &kernel_pair : phi_kernels) {
           auto kernel_name = kernel_pair.first;
           std::vector<std::string> kernel_keys;
@@ -1445,7 +1453,10 @@ PYBIND11_MODULE(libpaddle, m) {
   // unloaded. We need manually clear symbols(may contain plugins' symbols)
   // stored in this static instance to avoid illegal memory access.
   m.def("clear_kernel_factory",
-        []() { phi::KernelFactory::Instance().kernels().clear(); });
+        []() {
+          phi::KernelFactory::Instance().kernels().clear();
+          phi::KernelFactory::Instance().BumpKernelsVersion();
+        });
   m.def("clear_device_manager", []() {
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
     platform::XCCLCommContext::Release();
@@ -2436,6 +2447,51 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("device_memory_stat_peak_value", memory::DeviceMemoryStatPeakValue);
   m.def("host_memory_stat_current_value", memory::HostMemoryStatCurrentValue);
   m.def("host_memory_stat_peak_value", memory::HostMemoryStatPeakValue);
+  m.def(
+      "set_allocator_replay",
+      [](bool enabled, int warmup_steps) {
+        memory::allocation::StepReplayAllocator::SetEnabled(enabled,
+                                                            warmup_steps);
+      },
+      py::arg("enabled"),
+      py::arg("warmup_steps") = 3);
+  m.def("is_allocator_replay_enabled",
+        memory::allocation::StepReplayAllocator::IsEnabled);
+  m.def("allocator_replay_mark_step",
+        memory::allocation::StepReplayAllocator::MarkStep);
+  m.def(
+      "enable_allocation_trace",
+      [](size_t capacity, int sample_interval, bool record_stack) {
+        auto &tracer = memory::AllocationTracer::Instance();
+        // The Python stack is collected only by the threads holding the GIL,
+        // and the others fall back to the C++ stack.
+        tracer.SetStackCollector([]() -> std::string {
+          if (!PyGILState_Check()) {
+            return "";
+          }
+          try {
+            auto traceback = py::module::import("traceback");
+            auto frames = traceback.attr("format_stack")();
+            return py::str("").attr("join")(frames).cast<std::string>();
+          } catch (py::error_already_set &) {
+            return "";
+          }
+        });
+        tracer.Enable(capacity, sample_interval, record_stack);
+      },
+      py::arg("capacity") = 100000,
+      py::arg("sample_interval") = 1,
+      py::arg("record_stack") = false);
+  m.def("disable_allocation_trace",
+        []() { memory::AllocationTracer::Instance().Disable(); });
+  m.def("dump_allocation_snapshot", [](const std::string &path) {
+    memory::AllocationTracer::Instance().DumpSnapshot(path);
+  });
+  m.def("export_allocation_trace", [](const std::string &path) {
+    platform::ChromeTracingLogger logger(path);
+    logger.LogAllocationTrace(memory::AllocationTracer::Instance().Events());
+    logger.LogExtraInfo({});
+  });
   m.def(
       "run_cmd",
       [](const std::string &cmd,
@@ -2894,6 +2950,8 @@ All parameter, weight, gradient are variables in Paddle.
       .def_readwrite("attributes",
                      &paddle::platform::HostPythonNode::attributes)
       .def_readwrite("op_id", &paddle::platform::HostPythonNode::op_id)
+      .def_readwrite("flops", &paddle::platform::HostPythonNode::flops)
+      .def_readwrite("bytes", &paddle::platform::HostPythonNode::bytes)
       .def_readwrite("children_node",
                      &paddle::platform::HostPythonNode::children_node_ptrs)
       .def_readwrite("runtime_node",
@@ -2943,6 +3001,36 @@ All parameter, weight, gradient are variables in Paddle.
       .def_readwrite("trace_switch",
                      &paddle::platform::ProfilerOptions::trace_switch);
 
+  using paddle::platform::ContinuousProfiler;
+  using paddle::platform::ContinuousProfilerOptions;
+  py::class_<ContinuousProfilerOptions>(m, "ContinuousProfilerOptions")
+      .def(py::init<>())
+      .def_readwrite("trace_switch", &ContinuousProfilerOptions::trace_switch)
+      .def_readwrite("trace_level", &ContinuousProfilerOptions::trace_level)
+      .def_readwrite("sample_interval",
+                     &ContinuousProfilerOptions::sample_interval)
+      .def_readwrite("max_events", &ContinuousProfilerOptions::max_events)
+      .def_readwrite("regression_ratio",
+                     &ContinuousProfilerOptions::regression_ratio)
+      .def_readwrite("baseline_steps",
+                     &ContinuousProfilerOptions::baseline_steps)
+      .def_readwrite("dump_signal", &ContinuousProfilerOptions::dump_signal)
+      .def_readwrite("dump_dir", &ContinuousProfilerOptions::dump_dir);
+
+  m.def("_continuous_profiler_start",
+        [](const ContinuousProfilerOptions &options) {
+          ContinuousProfiler::Instance().Start(options);
+        });
+  m.def("_continuous_profiler_stop",
+        [] { ContinuousProfiler::Instance().Stop(); });
+  m.def("_continuous_profiler_step",
+        [] { ContinuousProfiler::Instance().Step(); });
+  m.def("_continuous_profiler_request_dump",
+        [] { ContinuousProfiler::Instance().RequestDump(); });
+  m.def("_continuous_profiler_dump", [](const std::string &reason) {
+    return ContinuousProfiler::Instance().Dump(reason);
+  });
+
   py::class_<phi::RecordEvent>(m, "_RecordEvent")
       .def(py::init([](std::string name, phi::TracerEventType type) {
         return std::make_unique<phi::RecordEvent>(
@@ -3185,6 +3273,18 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("update_autotune_status",
         [] { return phi::autotune::AutoTuneStatus::Instance().Update(); });
 
+  m.def("save_autotune_cache", [](const std::string &path) {
+    return phi::autotune::AutoTuneCache::Instance().Save(path);
+  });
+
+  m.def("load_autotune_cache", [](const std::string &path) {
+    return phi::autotune::AutoTuneCache::Instance().Load(path);
+  });
+
+  m.def("save_autotune_cache_file", [] {
+    return phi::autotune::AutoTuneCache::Instance().SaveCacheFile();
+  });
+
   m.def("autotune_status", [] {
     py::dict res;
     phi::autotune::AutoTuneCache::Instance().UpdateStatus();
@@ -3211,6 +3311,9 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("set_nan_inf_debug_path",
         &paddle::framework::details::SetNanInfDebugPath);
 
+  m.def("check_deferred_nan_inf",
+        &paddle::framework::details::CheckDeferredNanInf);
+
   // Add check op lost
   m.def("set_checked_op_list",
         [](const std::string &op_list) { egr::SetCheckOpList(op_list); });
@@ -106,6 +106,7 @@ limitations under the License. */
 #include "paddle/phi/core/compat/convert_utils.h"
 #include "paddle/phi/core/lod_utils.h"
 #include "paddle/phi/core/memory/allocation/mmap_allocator.h"
+#include "paddle/phi/core/memory/managed_memory_advisor.h"
 #include "paddle/phi/core/platform/cpu_helper.h"
 #include "paddle/phi/core/platform/device/device_wrapper.h"
 #include "paddle/phi/core/platform/device_context.h"
@@ -432,7 +433,14 @@ void BindTensor(pybind11::module &m) {  // NOLINT
            )DOC")
       .def(
           "_to_dlpack",
-          [](phi::DenseTensor &self) {
+          [](phi::DenseTensor &self, py::object stream) {
+            // the stream of the consumer of __dlpack__
+            if (self.IsInitialized()) {
+              framework::DLPackStreamWait(
+                  self.place(),
+                  stream.is_none() ? framework::kDLPackDefaultStream
+                                   : stream.cast<int64_t>());
+            }
             DLManagedTensor *dlMTensor = framework::toDLPack(self);
             auto capsule = pybind11::capsule(
                 static_cast<void *>(dlMTensor), "dltensor", [](PyObject *data) {
@@ -445,7 +453,8 @@ void BindTensor(pybind11::module &m) {  // NOLINT
                   dlMTensor->deleter(dlMTensor);
                 });
             return capsule;
-          })
+          },
+          py::arg("stream") = py::none())
       .def("_set_float_element", TensorSetElement<float>)
       .def("_get_float_element", TensorGetElement<float>)
       .def("_set_double_element", TensorSetElement<double>)
@@ -870,6 +879,148 @@ void BindTensor(pybind11::module &m) {  // NOLINT
                     >>> metainfo = tensor.value().get_tensor()._share_cuda()
                     >>> tensor_from_shared = paddle.to_tensor(paddle.base.core.LoDTensor._new_shared_cuda(metainfo))
         )DOC")
+      .def("_share_cuda_arena",
+           [](phi::DenseTensor &self) -> py::object {
+             if (!self.IsInitialized() || self.numel() == 0)
+               throw std::runtime_error(
+                   "Tensor not initialized or numel is 0.  could not pass "
+                   "to shared memory. ");
+
+             auto holder = self.Holder();
+             PADDLE_ENFORCE_EQ(
+                 phi::is_gpu_place(holder->place()), true,
+                 common::errors::InvalidArgument(
+                     "Tensor is not on GPU. share_cuda_arena only support GPU "
+                     "Tensor, share_filename is for CPU tensor."));
+
+             const auto &device_id = paddle::platform::GetCurrentDeviceId();
+             auto *arena =
+                 memory::allocation::CudaIpcArena::Instance(device_id);
+             auto stream = paddle::platform::get_current_stream(device_id);
+             size_t data_size =
+                 self.numel() *
+                 framework::SizeOfType(
+                     framework::TransToProtoVarType(self.type()));
+             if (!arena->Contains(holder.get())) {
+               auto block = arena->Allocate(data_size);
+               if (block == nullptr) {
+                 // The arena is full, _share_cuda is used instead.
+                 return py::none();
+               }
+               memory::Copy(block->place(), block->ptr(), holder->place(),
+                            self.data(), data_size, stream->raw_stream());
+               self.set_offset(0);
+               self.ResetHolder(block);
+               holder = std::move(block);
+             }
+             // The receivers read the block on streams of other processes,
+             // which can not wait for an event of this one, so the pending
+             // writes to it are finished before the descriptor is sent.
+             stream->Synchronize();
+
+             auto slot_and_offset = arena->Export(holder);
+             size_t offset_bytes = slot_and_offset.second + self.offset();
+             int type_idx = static_cast<int>(self.type());
+             return py::make_tuple(py::bytes(arena->handle()),
+                                   arena->control_name(),
+                                   slot_and_offset.first,
+                                   offset_bytes,
+                                   data_size,
+                                   type_idx,
+                                   common::vectorize(self.dims()),
+                                   self.lod(),
+                                   device_id);
+           },
+           R"DOC(
+           Serialize GPU Tensor as a block of the CUDA IPC arena, which is
+           exported once, so the receivers open a single IPC handle for all
+           the tensors. The tensor is copied into the arena when it is not
+           allocated there yet, the arena is sized by
+           FLAGS_cuda_ipc_arena_size_mb.
+
+           Returns:
+               tuple: contrains arena handle, control segment name, block
+                      slot, offset, data size, data type, tensor dims, lod
+                      information, device index. None if the arena is full.
+
+           Examples:
+                .. code-block:: python
+
+                    >>> import paddle
+                    >>> paddle.set_flags({'FLAGS_cuda_ipc_arena_size_mb': 64})
+
+                    >>> tensor = paddle.ones([3,3])
+                    >>> metainfo = tensor.value().get_tensor()._share_cuda_arena()
+      )DOC")
+      .def("_new_shared_cuda_arena",
+           [](py::tuple t) {
+             if (t.size() != 9)
+               throw std::runtime_error(
+                   "Invalid Tensor meta info for shared cuda arena tensor!");
+
+             phi::DenseTensor tensor;
+             const std::string &handle = t[0].cast<std::string>();
+             const std::string &control_name = t[1].cast<std::string>();
+             int slot = t[2].cast<int>();
+             size_t offset_bytes = t[3].cast<size_t>();
+             size_t size = t[4].cast<size_t>();
+             auto device_id = t[8].cast<int>();
+
+             // Both are opened once for each arena of a sender.
+             auto base_ptr = memory::allocation::GetIpcBasePtr(handle);
+             auto control =
+                 memory::allocation::GetIpcArenaControl(control_name);
+             void *dev = reinterpret_cast<char *>(base_ptr.get()) +
+                         offset_bytes;
+             auto shared_reader_holder =
+                 std::make_shared<memory::allocation::CudaIpcArenaAllocation>(
+                     dev, size, device_id, std::move(base_ptr),
+                     std::move(control), slot);
+
+             tensor.ResetHolderWithType(
+                 shared_reader_holder,
+                 static_cast<phi::DataType>(t[5].cast<int>()));
+             tensor.Resize(common::make_ddim(t[6].cast<std::vector<int>>()));
+             tensor.set_lod(t[7].cast<phi::LoD>());
+
+             return tensor;
+           },
+           R"DOC(
+           Deserialize GPU lod tensor from a block of the CUDA IPC arena of
+           another process, the block is released to the sender when the
+           tensor is freed.
+
+           Params:
+               tuple: contrains arena handle, control segment name, block
+                      slot, offset, data size, data type, tensor dims, lod
+                      information, device index.
+
+           Examples:
+                .. code-block:: python
+
+                    >>> import paddle
+                    >>> paddle.set_flags({'FLAGS_cuda_ipc_arena_size_mb': 64})
+
+                    >>> tensor = paddle.ones([3,3])
+                    >>> metainfo = tensor.value().get_tensor()._share_cuda_arena()
+                    >>> # In another process
+                    >>> tensor_from_shared = paddle.to_tensor(paddle.base.core.LoDTensor._new_shared_cuda_arena(metainfo))
+        )DOC")
+      .def("_place_in_managed_memory",
+           [](phi::DenseTensor &self, int device_id, bool read_mostly) {
+             memory::ManagedMemoryAdvisor::Instance().Place(
+                 &self, device_id, read_mostly);
+           },
+           py::arg("device_id"), py::arg("read_mostly") = true,
+           R"DOC(
+           Move the data of the tensor to the CUDA managed memory of the
+           device, see ManagedMemoryAdvisor.
+
+           Params:
+               device_id: The GPU the tensor is moved to.
+               read_mostly: Whether the tensor is rarely written, e.g. an
+                            embedding table in inference.
+      )DOC")
 #endif
       .def("_share_filename",
            [](phi::DenseTensor &self, bool use_file_descriptor) {
@@ -905,8 +1056,12 @@ void BindTensor(pybind11::module &m) {  // NOLINT
                }
                std::string handle = memory::allocation::GetIPCName();
                int find_id = -1;
+               // the cached shm are of the size classes, to be reused by the
+               // batches of different sizes
+               size_t map_size = data_size;
                if (FLAGS_use_shm_cache) {
-                 find_id = memory::allocation::MemoryMapAllocationPool::Instance().FindFromCache(flags, data_size); // NOLINT
+                 map_size = memory::allocation::GetMemoryMapCacheSize(data_size); // NOLINT
+                 find_id = memory::allocation::MemoryMapAllocationPool::Instance().FindFromCache(flags, map_size); // NOLINT
                }
                if (find_id != -1) {
                  handle = memory::allocation::MemoryMapAllocationPool::Instance().GetById(find_id).file_name_; // NOLINT
@@ -914,7 +1069,7 @@ void BindTensor(pybind11::module &m) {  // NOLINT
                int shared_fd = -1;
                auto shared_holder =
                    memory::allocation::AllocateRefcountedMemoryMapAllocation(
-                       handle, shared_fd, flags, data_size, find_id);
+                       handle, shared_fd, flags, map_size, find_id);
 
                // copy data & reset holder
                if (phi::is_cuda_pinned_place(holder->place())) {
@@ -23,10 +23,12 @@ limitations under the License. */
 #include "paddle/phi/api/lib/utils/allocator.h"
 #include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/param_prefetcher.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_function_registry.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_utils.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/memory/tensor_evictor.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/core/visit_type.h"
 #include "paddle/phi/kernels/cast_kernel.h"
@@ -359,6 +361,14 @@ phi::DenseTensor TransformData(const phi::DenseTensor& tensor,
   return out;
 }
 
+// Pages the tensor back to the device if it is evicted by TensorEvictor.
+static inline void TouchEvictableTensor(phi::DenseTensor* tensor) {
+  auto& evictor = paddle::memory::TensorEvictor::Instance();
+  if (UNLIKELY(evictor.enabled())) {
+    evictor.Touch(tensor);
+  }
+}
+
 std::shared_ptr<phi::DenseTensor> PrepareData(
     const Tensor& input,
     const phi::TensorArgDef& target_args_def,
@@ -368,6 +378,7 @@ std::shared_ptr<phi::DenseTensor> PrepareData(
   if (tensor_in) {
     phi::DenseTensor& dense_tensor =
         *static_cast<phi::DenseTensor*>(tensor_in.get());
+    TouchEvictableTensor(&dense_tensor);
     if (!transform_flag.NeedTransform() || !dense_tensor.initialized() ||
         (!NeedTransformPlace(
              dense_tensor.place(), target_args_def.backend, transform_flag) &&
@@ -418,6 +429,9 @@ std::unique_ptr<std::vector<phi::DenseTensor>> PrepareData(
   for (const auto& input : inputs) {
     const auto& tensor_in = input.impl();
     auto dense_tensor = std::dynamic_pointer_cast<phi::DenseTensor>(tensor_in);
+    if (dense_tensor) {
+      TouchEvictableTensor(dense_tensor.get());
+    }
     if (!transform_flag.NeedTransform() || !tensor_in->initialized() ||
         (!NeedTransformPlace(
              tensor_in->place(), target_args_def.backend, transform_flag) &&
@@ -712,6 +726,11 @@ std::shared_ptr<phi::distributed::DistTensor> ReshardApiInputToKernelInput(
       auto tensor_name = (tensor.name().empty() ? "None" : tensor.name());
       VLOG(4) << "Reshard input: " << argument_name << "(" << tensor_name
               << ") " << ReshardDebugInfo(*dist_tensor, tensor_dist_attr);
+      auto prefetched = phi::distributed::ParamPrefetcher::Instance().Fetch(
+          dev_ctx, *dist_tensor, tensor_dist_attr);
+      if (prefetched) {
+        return prefetched;
+      }
       auto* func = phi::distributed::ChooseProperReshardFunction(
           *dist_tensor, tensor_dist_attr);
       return func->Eval(dev_ctx, *dist_tensor, tensor_dist_attr);
@@ -542,6 +542,17 @@ class CustomDevice : public DeviceInterface {
     return 0;
   }
 
+  size_t GetDeviceCapability(size_t dev_id) override {
+    const auto device = &devices_pool[dev_id];
+    size_t capability = C_DEVICE_CAPABILITY_NONE;
+    if (pimpl_->get_device_capability) {
+      PADDLE_ENFORCE_CUSTOM_DEVICE_SUCCESS(
+          pimpl_->get_device_capability(device, &capability));
+    }
+    VLOG(10) << Type() << " device capability " << capability;
+    return capability;
+  }
+
   size_t GetComputeCapability() override {
     size_t compute_capability = 0;
     if (pimpl_->get_compute_capability) {
@@ -1018,6 +1029,7 @@ bool ValidCustomCustomRuntimeParams(const CustomRuntimeParams* params) {
   CHECK_INTERFACE(get_compute_capability, false);
   CHECK_INTERFACE(get_runtime_version, false);
   CHECK_INTERFACE(get_driver_version, false);
+  CHECK_INTERFACE(get_device_capability, false);
 
   CHECK_INTERFACE(xccl_get_unique_id, false);
   CHECK_INTERFACE(xccl_get_unique_id_size, false);
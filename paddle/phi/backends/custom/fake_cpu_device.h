@@ -211,6 +211,12 @@ C_Status XcclRecv(void *recv_buf,
   return C_SUCCESS;
 }
 
+// every call runs to the end on the host, so the streams are always in order
+C_Status DeviceCapability(const C_Device device, size_t *capability) {
+  *capability = C_DEVICE_CAPABILITY_STREAM_EVENT;
+  return C_SUCCESS;
+}
+
 C_Status BlasAXPBY(const C_Device device,
                    C_Stream stream,
                    C_DataType dtype,
@@ -276,6 +282,7 @@ void InitFakeCPUDevice(CustomRuntimeParams *params) {
   params->interface->device_max_chunk_size = DeviceMaxChunkSize;
   params->interface->device_min_chunk_size = DeviceMinChunkSize;
   params->interface->device_max_alloc_size = DeviceMaxAllocSize;
+  params->interface->get_device_capability = DeviceCapability;
 
   params->interface->xccl_get_unique_id_size = XcclGetUniqueIdSize;
   params->interface->xccl_get_unique_id = XcclGetUniqueId;
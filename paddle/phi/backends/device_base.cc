@@ -267,6 +267,11 @@ size_t DeviceInterface::GetExtraPaddingSize(size_t dev_id) {
   return 0;
 }
 
+size_t DeviceInterface::GetDeviceCapability(size_t dev_id) {
+  VLOG(10) << Type() << " device capability " << 0;
+  return 0;
+}
+
 void DeviceInterface::CCLCommName(ccl::CCLComm ccl_comm, char* comm_name) {
   INTERFACE_UNIMPLEMENT;
 }
@@ -168,6 +168,9 @@ class DeviceInterface {  // Driver / Runtime
 
   virtual size_t GetExtraPaddingSize(size_t dev_id);
 
+  // ! A mask of C_DeviceCapability of the asynchronous paths of the device.
+  virtual size_t GetDeviceCapability(size_t dev_id);
+
   // CCL
   virtual void CCLCommName(ccl::CCLComm ccl_comm, char* comm_name);
 
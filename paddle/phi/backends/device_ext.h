@@ -64,6 +64,14 @@ typedef enum {
   C_INTERNAL_ERROR  // plugin error
 } C_Status;
 
+typedef enum {
+  C_DEVICE_CAPABILITY_NONE = 0,
+  // stream_wait_event orders the streams on the device, with no host sync
+  C_DEVICE_CAPABILITY_STREAM_EVENT = 1 << 0,
+  // async_memory_copy_h2d/d2h return before the copy is done
+  C_DEVICE_CAPABILITY_ASYNC_MEMCPY = 1 << 1,
+} C_DeviceCapability;
+
 typedef struct C_Device_st {
   int id;
 } * C_Device;
@@ -542,7 +550,15 @@ struct C_DeviceInterface {
    */
   C_Status (*get_driver_version)(size_t* version);
 
-  void* reserved_info_api[8];
+  /**
+   * @brief Get the capabilities of the device, a mask of C_DeviceCapability
+   *
+   * @param[C_Device]   device
+   * @param[size_t*]    capability
+   */
+  C_Status (*get_device_capability)(const C_Device device, size_t* capability);
+
+  void* reserved_info_api[7];
 
   //////////////
   // ccl api //
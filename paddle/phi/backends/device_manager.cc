@@ -467,6 +467,13 @@ size_t DeviceManager::GetExtraPaddingSize(const Place& place) {
   return dev_impl->GetExtraPaddingSize(device_id);
 }
 
+size_t DeviceManager::GetDeviceCapability(const Place& place) {
+  auto device_type = place.GetDeviceType();
+  auto device_id = place.GetDeviceId();
+  auto dev_impl = GetDeviceInterfaceWithType(device_type);
+  return dev_impl->GetDeviceCapability(device_id);
+}
+
 void DeviceManager::MemoryStats(const Place& place,
                                 size_t* total,
                                 size_t* free) {
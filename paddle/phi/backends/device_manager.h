@@ -168,6 +168,8 @@ class DeviceManager {
 
   static size_t GetExtraPaddingSize(const Place& place);
 
+  static size_t GetDeviceCapability(const Place& place);
+
   static void MemoryStats(const Place& place, size_t* total, size_t* free);
 
   static size_t GetDeviceCount(const std::string& device_type);
@@ -94,6 +94,7 @@ extern void* tensorrt_plugin_dso_handle;
 #define TENSORRT_RAND_ROUTINE_EACH_POINTER(__macro) \
   __macro(createInferBuilder_INTERNAL);             \
   __macro(createInferRuntime_INTERNAL);             \
+  __macro(createInferRefitter_INTERNAL);            \
   __macro(getPluginRegistry);
 #else
 #define TENSORRT_RAND_ROUTINE_EACH_POINTER(__macro) \
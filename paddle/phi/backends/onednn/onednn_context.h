@@ -50,6 +50,9 @@ class OneDNNContextThreadLocals {
     std::string key_suffix;  // Key identifying current Executor
     bool key_attach_thread_id = true;
     void* exec_ptr_ = nullptr;
+    // Key identifying the primitives shared in OneDNNPrimitiveCache, e.g. by
+    // a predictor and its clones
+    std::string primitive_cache_scope;
 
     Body();
     ~Body();
@@ -68,6 +71,12 @@ class OneDNNContextThreadLocals {
     bool is_tid_used_in_key(void) const { return key_attach_thread_id; }
     void set_curr_exec(void* exec_ptr) { exec_ptr_ = exec_ptr; }
     void* get_curr_exec(void) const { return exec_ptr_; }
+    void set_primitive_cache_scope(const std::string& scope) {
+      primitive_cache_scope = scope;
+    }
+    const std::string& get_primitive_cache_scope(void) const {
+      return primitive_cache_scope;
+    }
   };
   OneDNNContextThreadLocals() = default;
   OneDNNContextThreadLocals(const OneDNNContextThreadLocals& c) = delete;
@@ -0,0 +1,108 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/onednn/onednn_primitive_cache.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
+
+COMMON_DECLARE_int32(onednn_primitive_cache_capacity);
+
+namespace phi {
+
+OneDNNPrimitiveCache& OneDNNPrimitiveCache::Instance() {
+  static OneDNNPrimitiveCache cache;
+  return cache;
+}
+
+bool OneDNNPrimitiveCache::Enabled() {
+  return FLAGS_onednn_primitive_cache_capacity > 0;
+}
+
+std::string OneDNNPrimitiveCache::CanonicalKey(const std::string& key) {
+  const auto& tls = OneDNNContext::tls();
+  const auto& scope = tls.get_primitive_cache_scope().empty()
+                          ? tls.get_key_suffix()
+                          : tls.get_primitive_cache_scope();
+  return scope + "|" + key;
+}
+
+std::shared_ptr<void> OneDNNPrimitiveCache::Get(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  items_.splice(items_.begin(), items_, it->second);
+  return it->second->second;
+}
+
+void OneDNNPrimitiveCache::Set(const std::string& key,
+                               std::shared_ptr<void> data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // another thread has created it at the same time
+    it->second->second = std::move(data);
+    items_.splice(items_.begin(), items_, it->second);
+    return;
+  }
+  items_.emplace_front(key, std::move(data));
+  index_[key] = items_.begin();
+  Shrink();
+}
+
+void OneDNNPrimitiveCache::Shrink() {
+  auto capacity =
+      static_cast<size_t>(std::max(FLAGS_onednn_primitive_cache_capacity, 0));
+  while (items_.size() > capacity) {
+    VLOG(3) << "Evict the oneDNN primitive " << items_.back().first;
+    index_.erase(items_.back().first);
+    items_.pop_back();
+    ++evictions_;
+  }
+}
+
+void OneDNNPrimitiveCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  items_.clear();
+  index_.clear();
+}
+
+size_t OneDNNPrimitiveCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return items_.size();
+}
+
+int64_t OneDNNPrimitiveCache::Hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+int64_t OneDNNPrimitiveCache::Misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+int64_t OneDNNPrimitiveCache::Evictions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return evictions_;
+}
+
+}  // namespace phi
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_DNNL
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "paddle/utils/test_macros.h"
+
+namespace phi {
+
+// The process-wide cache of the oneDNN primitives and primitive descriptors
+// of OneDNNHandlerT, shared by all the threads and the predictors cloned from
+// the same one, and bounded by FLAGS_onednn_primitive_cache_capacity with the
+// least recently used ones evicted. The primitives are immutable and can be
+// executed by several threads at once, while the memory objects holding the
+// data stay in the per-thread blob map of OneDNNContext.
+class OneDNNPrimitiveCache {
+ public:
+  TEST_API static OneDNNPrimitiveCache& Instance();
+
+  // Whether FLAGS_onednn_primitive_cache_capacity is positive.
+  TEST_API static bool Enabled();
+
+  // The key shared by the threads for the key of a handler without the
+  // thread id: the cache scope of the thread, set by a predictor and its
+  // clones, or the executor otherwise, and the key whose input dims are the
+  // shape bucket of the primitive.
+  TEST_API static std::string CanonicalKey(const std::string& key);
+
+  // Returns nullptr if not found.
+  TEST_API std::shared_ptr<void> Get(const std::string& key);
+  TEST_API void Set(const std::string& key, std::shared_ptr<void> data);
+
+  TEST_API void Clear();
+
+  TEST_API size_t Size() const;
+  TEST_API int64_t Hits() const;
+  TEST_API int64_t Misses() const;
+  TEST_API int64_t Evictions() const;
+
+ private:
+  using Item = std::pair<std::string, std::shared_ptr<void>>;
+
+  OneDNNPrimitiveCache() = default;
+
+  // Evicts the least recently used ones down to the capacity.
+  void Shrink();
+
+  mutable std::mutex mutex_;
+  // the most recently used first
+  std::list<Item> items_;
+  std::unordered_map<std::string, std::list<Item>::iterator> index_;
+  int64_t hits_{0};
+  int64_t misses_{0};
+  int64_t evictions_{0};
+};
+
+}  // namespace phi
+#endif
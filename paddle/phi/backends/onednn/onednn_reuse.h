@@ -24,6 +24,7 @@ limitations under the License. */
 
 #include "paddle/phi/backends/onednn/onednn_context.h"
 #include "paddle/phi/backends/onednn/onednn_helper.h"
+#include "paddle/phi/backends/onednn/onednn_primitive_cache.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/common/int_array.h"
 #include "paddle/phi/common/place.h"
@@ -151,45 +152,48 @@ class OneDNNHandlerT {
         place_(cpu_place),
         key_common_(base_key),
         key_(ExtendKeyWithThreadInfoIfNeeded(dev_ctx, base_key)),
+        shared_key_(OneDNNPrimitiveCache::Enabled()
+                        ? OneDNNPrimitiveCache::CanonicalKey(base_key)
+                        : ""),
         fwd_pd_(nullptr),
         bwd_pd_(nullptr) {
     OneDNNContext::tls().log_lib_version();
   }
 
   std::shared_ptr<TForward> AcquireForwardPrimitive() {
-    const std::string key_p = key_ + "@fwd_p";
+    const std::string suffix = "@fwd_p";
     auto forward_p =
-        std::static_pointer_cast<TForward>(dev_ctx_.GetBlob(key_p));
+        std::static_pointer_cast<TForward>(GetPrimitiveBlob(suffix));
     if (forward_p == nullptr) {
       forward_p = std::make_shared<TForward>(*fwd_pd_);
-      dev_ctx_.SetBlob(key_p, forward_p);
+      SetPrimitiveBlob(suffix, forward_p);
     }
     return forward_p;
   }
 
   std::shared_ptr<TBackward> AcquireBackwardPrimitive() {
-    const std::string key_p = key_ + "@bwd_p";
+    const std::string suffix = "@bwd_p";
     auto backward_p =
-        std::static_pointer_cast<TBackward>(dev_ctx_.GetBlob(key_p));
+        std::static_pointer_cast<TBackward>(GetPrimitiveBlob(suffix));
     if (backward_p == nullptr) {
       backward_p = std::make_shared<TBackward>(*bwd_pd_);
-      dev_ctx_.SetBlob(key_p, backward_p);
+      SetPrimitiveBlob(suffix, backward_p);
     }
     return backward_p;
   }
 
   std::shared_ptr<TBackward_params> AcquireBackwardWeightsPrimitive() {
-    const std::string key_p = key_ + "@bwd_w_p";
+    const std::string suffix = "@bwd_w_p";
     auto backward_p =
-        std::static_pointer_cast<TBackward_params>(dev_ctx_.GetBlob(key_p));
+        std::static_pointer_cast<TBackward_params>(GetPrimitiveBlob(suffix));
     if (backward_p == nullptr) {
       PADDLE_ENFORCE_NOT_NULL(
           bwd_w_pd_,
           errors::Unavailable("BWD_PD should be set when "
                               "getting BWD prim witk key: %s .",
-                              key_p));
+                              key_ + suffix));
       backward_p = std::make_shared<TBackward_params>(*bwd_w_pd_);
-      dev_ctx_.SetBlob(key_p, backward_p);
+      SetPrimitiveBlob(suffix, backward_p);
     }
     return backward_p;
   }
@@ -260,33 +264,33 @@ class OneDNNHandlerT {
 
  protected:
   bool isCached() {
-    const std::string key_pd = key_ + "@fwd_pd";
+    const std::string suffix = "@fwd_pd";
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
-        dev_ctx_.GetBlob(key_pd));
+        GetPrimitiveBlob(suffix));
 
     return (fwd_pd_ != nullptr);
   }
 
   bool isBwdCached() {
-    const std::string key_pd = key_ + "@bwd_pd";
+    const std::string suffix = "@bwd_pd";
     bwd_pd_ = std::static_pointer_cast<typename TBackward::primitive_desc>(
-        dev_ctx_.GetBlob(key_pd));
+        GetPrimitiveBlob(suffix));
 
     if (bwd_pd_ == nullptr) {
       return false;
     } else {
       if (std::is_same<TBackward_params, onednn_dummy_primitive>::value ==
           false) {
-        const std::string key_bw_w_pd = key_ + "@bwd_w_pd";
+        const std::string bwd_w_suffix = "@bwd_w_pd";
         bwd_w_pd_ =
             std::static_pointer_cast<typename TBackward_params::primitive_desc>(
-                dev_ctx_.GetBlob(key_bw_w_pd));
+                GetPrimitiveBlob(bwd_w_suffix));
       }
 
       // When BWD is cached then still we need to Get FWD PD
-      const std::string key_fpd = key_ + "@fwd_pd";
+      const std::string fwd_suffix = "@fwd_pd";
       fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
-          dev_ctx_.GetBlob(key_fpd));
+          GetPrimitiveBlob(fwd_suffix));
       PADDLE_ENFORCE_NOT_NULL(
           fwd_pd_,
           errors::Unavailable(
@@ -303,12 +307,12 @@ class OneDNNHandlerT {
   void AcquireForwardPrimitiveDescriptor(Arg&& first_arg, Args&&... args) {
     // This is used when we can recreate FWD PD in BWD so
     // we do not need to pass FWD to BWD
-    const std::string key_pd = key_ + "@fwd_pd";
+    const std::string suffix = "@fwd_pd";
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
-        dev_ctx_.GetBlob(key_pd));
+        GetPrimitiveBlob(suffix));
     if (fwd_pd_ == nullptr) {
       CreateForwardPrimitiveDescriptor(first_arg, std::forward<Args>(args)...);
-      dev_ctx_.SetBlob(key_pd, fwd_pd_);
+      SetPrimitiveBlob(suffix, fwd_pd_);
     }
   }
 
@@ -338,13 +342,13 @@ class OneDNNHandlerT {
         fwd_pd_,
         errors::Unavailable("Get OneDNN Forward primitive %s failed.",
                             key_ + "@fwd_pd"));
-    const std::string key_pd = key_ + "@bwd_pd";
+    const std::string suffix = "@bwd_pd";
     bwd_pd_ = std::static_pointer_cast<typename TBackward::primitive_desc>(
-        dev_ctx_.GetBlob(key_pd));
+        GetPrimitiveBlob(suffix));
     if (bwd_pd_ == nullptr) {
       bwd_pd_ = std::make_shared<typename TBackward::primitive_desc>(
           engine_, std::forward<Args>(args)..., *fwd_pd_);
-      dev_ctx_.SetBlob(key_pd, bwd_pd_);
+      SetPrimitiveBlob(suffix, bwd_pd_);
     }
   }
 
@@ -356,14 +360,14 @@ class OneDNNHandlerT {
         fwd_pd_,
         errors::Unavailable("Get OneDNN Forward primitive %s failed.",
                             key_ + "@fwd_pd"));
-    const std::string key_pd = key_ + "@bwd_w_pd";
+    const std::string suffix = "@bwd_w_pd";
     bwd_w_pd_ =
         std::static_pointer_cast<typename TBackward_params::primitive_desc>(
-            dev_ctx_.GetBlob(key_pd));
+            GetPrimitiveBlob(suffix));
     if (bwd_w_pd_ == nullptr) {
       bwd_w_pd_ = std::make_shared<typename TBackward_params::primitive_desc>(
           engine_, std::forward<Args>(args)..., *fwd_pd_);
-      dev_ctx_.SetBlob(key_pd, bwd_w_pd_);
+      SetPrimitiveBlob(suffix, bwd_w_pd_);
     }
   }
 
@@ -509,11 +513,29 @@ class OneDNNHandlerT {
     return;
   }
 
+  // The primitives and the primitive descriptors are shared by the threads
+  // in OneDNNPrimitiveCache when it is enabled.
+  std::shared_ptr<void> GetPrimitiveBlob(const std::string& suffix) const {
+    if (shared_key_.empty()) return dev_ctx_.GetBlob(key_ + suffix);
+    return OneDNNPrimitiveCache::Instance().Get(shared_key_ + suffix);
+  }
+
+  void SetPrimitiveBlob(const std::string& suffix,
+                        std::shared_ptr<void> data) const {
+    if (shared_key_.empty()) {
+      dev_ctx_.SetBlob(key_ + suffix, data);
+    } else {
+      OneDNNPrimitiveCache::Instance().Set(shared_key_ + suffix, data);
+    }
+  }
+
   const OneDNNContext& dev_ctx_;
   dnnl::engine engine_;
   Place place_;
   std::string key_common_;
   std::string key_;
+  // the key in OneDNNPrimitiveCache, empty if it is disabled
+  std::string shared_key_;
   std::shared_ptr<typename TForward::primitive_desc> fwd_pd_;
   std::shared_ptr<typename TBackward::primitive_desc> bwd_pd_;
   std::shared_ptr<typename TBackward_params::primitive_desc> bwd_w_pd_;
@@ -169,6 +169,7 @@ void PD_RegisterPhiKernel(const char* kernel_name_cstr,
 
   args_def_fn_wrapper(kernel_key, &kernel);
   phi::KernelFactory::Instance().kernels()[kernel_name][kernel_key] = kernel;
+  phi::KernelFactory::Instance().BumpKernelsVersion();
 }
 
 PD_REGISTER_CAPI(kernel_registry);
@@ -60,6 +60,7 @@ void CustomKernelMap::RegisterCustomKernels() {
               << "] to Paddle. It will be used like native ones.";
     }
   }
+  KernelFactory::Instance().BumpKernelsVersion();
   LOG(INFO) << "Succeed in loading " << kernels_.size()
             << " custom kernel(s) from loaded lib(s), will be "
             << "used like native ones.";
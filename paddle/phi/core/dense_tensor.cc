@@ -297,6 +297,8 @@ const DeviceT& DenseTensor::storage_properties() const {
 }
 
 template const NPUStorageProperties& DenseTensor::storage_properties() const;
+template const CPUPackedGemmStorageProperties&
+DenseTensor::storage_properties() const;
 #ifdef PADDLE_WITH_DNNL
 template const OneDNNStorageProperties& DenseTensor::storage_properties() const;
 #endif
@@ -309,6 +311,9 @@ bool DenseTensor::storage_properties_initialized() const {
     return false;
   } else if (NPUStorageProperties::classof(storage_properties_.get())) {
     return place().GetType() == AllocationType::CUSTOM;
+  } else if (CPUPackedGemmStorageProperties::classof(
+                 storage_properties_.get())) {
+    return place().GetType() == AllocationType::CPU;
 #ifdef PADDLE_WITH_XPU
   } else if (XPUStorageProperties::classof(storage_properties_.get())) {
     return place().GetType() == AllocationType::XPU;
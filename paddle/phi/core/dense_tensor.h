@@ -185,6 +185,14 @@ class TEST_API DenseTensor : public TensorBase,
   template <typename DeviceT>
   const DeviceT& storage_properties() const;
 
+  /// \brief Get whether the storage_properties is of the type DeviceT.
+  /// \return Whether the storage_properties is of the type DeviceT.
+  template <typename DeviceT>
+  bool storage_properties_is() const {
+    return storage_properties_ != nullptr &&
+           DeviceT::classof(storage_properties_.get());
+  }
+
   /// \brief Sets the storage_properties of the tensor.
   /// \param storage_properties The storage_properties of the tensor.
   void set_storage_properties(
@@ -382,7 +382,10 @@ std::vector<DenseTensor> DenseTensor::Chunk(int64_t chunks,
 
 #ifdef PADDLE_WITH_DNNL
 const dnnl::memory::desc& DenseTensor::mem_desc() const {
-  if (storage_properties_ == nullptr) {
+  // The tensors of other storage properties, e.g. the weights packed for the
+  // CPU GEMMs, are plain tensors to OneDNN.
+  if (storage_properties_ == nullptr ||
+      !OneDNNStorageProperties::classof(storage_properties_.get())) {
     static dnnl::memory::desc undef_desc = dnnl::memory::desc();
     return undef_desc;
   }
@@ -0,0 +1,343 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/chunked_reshard_function.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_attr.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_utils.h"
+#include "paddle/phi/kernels/concat_kernel.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+#include "paddle/phi/api/profiler/event.h"
+#include "paddle/phi/core/distributed/nccl_comm_context.h"
+#endif
+
+COMMON_DECLARE_bool(enable_chunked_reshard);
+COMMON_DECLARE_int32(chunked_reshard_max_chunks);
+
+namespace phi::distributed {
+
+double ReshardChunkCostModel::EstimateTime(int64_t num_chunks,
+                                           int64_t comm_bytes,
+                                           int64_t relayout_bytes,
+                                           int64_t relayout_kernels) const {
+  // 1 GB/s moves 1e3 bytes in 1 us
+  double comm_us = comm_latency_us + static_cast<double>(comm_bytes) /
+                                         (comm_bandwidth * 1e3) / num_chunks;
+  double relayout_us =
+      relayout_kernels * kernel_latency_us +
+      2.0 * static_cast<double>(relayout_bytes) / (memory_bandwidth * 1e3) /
+          num_chunks;
+  return comm_us + relayout_us +
+         static_cast<double>(num_chunks - 1) * std::max(comm_us, relayout_us);
+}
+
+int64_t ReshardChunkCostModel::ChooseNumChunks(int64_t max_chunks,
+                                               int64_t comm_bytes,
+                                               int64_t relayout_bytes,
+                                               int64_t relayout_kernels) const {
+  int64_t best_num_chunks = 1;
+  double best_time =
+      EstimateTime(1, comm_bytes, relayout_bytes, relayout_kernels);
+  for (int64_t num_chunks = 2; num_chunks <= max_chunks; ++num_chunks) {
+    double time =
+        EstimateTime(num_chunks, comm_bytes, relayout_bytes, relayout_kernels);
+    if (time < best_time) {
+      best_time = time;
+      best_num_chunks = num_chunks;
+    }
+  }
+  return best_num_chunks;
+}
+
+namespace {
+
+bool IsChunkedReshardEnabled(const DistTensor& in) {
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  return FLAGS_enable_chunked_reshard && in.initialized() &&
+         in.place().GetType() == AllocationType::GPU;
+#else
+  return false;
+#endif
+}
+
+// The inputs of the cost model only depend on the local shape, which is the
+// same on all the ranks, so all the ranks choose the same number of chunks.
+int64_t SToRNumChunks(const DistTensor& in, int64_t num_of_process) {
+  int64_t in_bytes = common::product(in.local_dims()) *
+                     static_cast<int64_t>(phi::SizeOf(in.dtype()));
+  int64_t max_chunks = std::min<int64_t>(FLAGS_chunked_reshard_max_chunks,
+                                         in.local_dims()[0]);
+  // allgather sends (n - 1) / n of the output, which is concated once
+  return ReshardChunkCostModel().ChooseNumChunks(
+      max_chunks,
+      in_bytes * (num_of_process - 1),
+      in_bytes * num_of_process,
+      /*relayout_kernels*/ 1);
+}
+
+int64_t PToSNumChunks(const DistTensor& in, int64_t num_of_process) {
+  int64_t in_bytes = common::product(in.local_dims()) *
+                     static_cast<int64_t>(phi::SizeOf(in.dtype()));
+  int64_t max_chunks = std::min<int64_t>(FLAGS_chunked_reshard_max_chunks,
+                                         in.local_dims()[0]);
+  // reduce-scatter sends (n - 1) / n of the input, the input and the output
+  // are transposed
+  return ReshardChunkCostModel().ChooseNumChunks(
+      max_chunks,
+      in_bytes * (num_of_process - 1) / num_of_process,
+      in_bytes + in_bytes / num_of_process,
+      /*relayout_kernels*/ 2);
+}
+
+// The offsets of the chunks on axis 0, the first rows % num_chunks chunks
+// have one more row.
+std::vector<int64_t> ChunkOffsets(int64_t rows, int64_t num_chunks) {
+  std::vector<int64_t> offsets(num_chunks + 1, 0);
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    offsets[i + 1] =
+        offsets[i] + rows / num_chunks + (i < rows % num_chunks ? 1 : 0);
+  }
+  return offsets;
+}
+
+std::vector<int> SwapAxisPerm(int64_t ndim, int64_t axis) {
+  std::vector<int> perm(ndim);
+  for (int64_t i = 0; i < ndim; ++i) {
+    perm[i] = static_cast<int>(i);
+  }
+  std::swap(perm[0], perm[axis]);
+  return perm;
+}
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+// pre(i) and post(i) run on the calculation stream, comm(i) runs on the
+// stream of the comm context. The collective of chunk i + 1 is launched
+// before the calculation stream waits for chunk i, so it overlaps post(i).
+// All the tensors of the chunks must be alive until the calculation stream
+// has waited for the last chunk.
+void RunChunkPipeline(GPUContext* calc_ctx,
+                      NCCLCommContext* comm_ctx,
+                      int64_t num_chunks,
+                      const std::function<void(int64_t)>& pre,
+                      const std::function<void(int64_t, gpuStream_t)>& comm,
+                      const std::function<void(int64_t)>& post) {
+  auto* comm_dev_ctx = comm_ctx->GetDevContext();
+  phi::CudaEvent ready_event;
+  std::vector<std::unique_ptr<phi::CudaEvent>> done_events;
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    pre(i);
+    ready_event.Record(calc_ctx->stream());
+    comm_dev_ctx->WaitEvent(ready_event.GetRawCudaEvent());
+    comm(i, comm_dev_ctx->stream());
+    done_events.emplace_back(std::make_unique<phi::CudaEvent>());
+    done_events.back()->Record(comm_dev_ctx->stream());
+    if (i > 0) {
+      calc_ctx->WaitEvent(done_events[i - 1]->GetRawCudaEvent());
+      post(i - 1);
+    }
+  }
+  calc_ctx->WaitEvent(done_events.back()->GetRawCudaEvent());
+  post(num_chunks - 1);
+}
+#endif
+
+}  // namespace
+
+bool SToRChunkedReshardFunction::IsSuitable(
+    const DistTensor& in, const TensorDistAttr& out_dist_attr) {
+  RESHARD_SHORTCUT_IF_FALSE(IsChunkedReshardEnabled(in));
+
+  const auto& in_dist_attr = in.dist_attr();
+  RESHARD_SHORTCUT_IF_FALSE(in_dist_attr.is_shard());
+  RESHARD_SHORTCUT_IF_FALSE(out_dist_attr.is_replicated());
+
+  const auto& in_process_mesh = in_dist_attr.process_mesh();
+  const auto& out_process_mesh = out_dist_attr.process_mesh();
+  RESHARD_SHORTCUT_IF_FALSE(in_process_mesh.ndim() == 1);
+  RESHARD_SHORTCUT_IF_FALSE(out_process_mesh.ndim() == 1);
+  RESHARD_SHORTCUT_IF_FALSE(in_process_mesh == out_process_mesh);
+
+  // the output of allgather is already replicated when split on axis 0
+  int split_axis =
+      GetSplitAxisWithDimsMapping(in_dist_attr.dims_mapping()).begin()->first;
+  int64_t num_of_process = in_process_mesh.size();
+  RESHARD_SHORTCUT_IF_FALSE(split_axis != 0);
+  RESHARD_SHORTCUT_IF_FALSE(num_of_process > 1);
+  RESHARD_SHORTCUT_IF_FALSE(in.dims()[split_axis] % num_of_process == 0);
+
+  return SToRNumChunks(in, num_of_process) > 1;
+}
+
+void SToRChunkedReshardFunction::Eval(DeviceContext* dev_ctx,
+                                      const DistTensor& in,
+                                      const TensorDistAttr& out_dist_attr,
+                                      DistTensor* out) {
+  VLOG(3) << "Call " << Name();
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  const auto& in_dist_attr = in.dist_attr();
+  const auto& in_process_ids = in_dist_attr.process_mesh().process_ids();
+  int split_axis =
+      GetSplitAxisWithDimsMapping(in_dist_attr.dims_mapping()).begin()->first;
+  int64_t num_of_process = static_cast<int64_t>(in_process_ids.size());
+  int64_t num_chunks = SToRNumChunks(in, num_of_process);
+  VLOG(3) << "Reshard from shard to replicated in " << num_chunks
+          << " chunks";
+
+  auto* calc_ctx = static_cast<GPUContext*>(dev_ctx);
+  auto* comm_ctx = static_cast<NCCLCommContext*>(
+      CreateOrGetCommContext(*dev_ctx, in_process_ids));
+  const auto& in_value = in.value();
+  auto dtype = in.dtype();
+
+  DenseTensor* out_value = GetMutableTensor(out);
+  DDim out_dims = in_value.dims();
+  out_dims[split_axis] *= num_of_process;
+  out_value->Resize(out_dims);
+  dev_ctx->Alloc(out_value, dtype);
+
+  auto offsets = ChunkOffsets(in_value.dims()[0], num_chunks);
+  std::vector<DenseTensor> gathered(num_chunks);
+  RunChunkPipeline(
+      calc_ctx,
+      comm_ctx,
+      num_chunks,
+      [](int64_t) {},
+      [&](int64_t i, gpuStream_t stream) {
+        DenseTensor chunk = in_value.Slice(offsets[i], offsets[i + 1]);
+        DDim gathered_dims = chunk.dims();
+        gathered_dims[0] *= num_of_process;
+        gathered[i].Resize(gathered_dims);
+        dev_ctx->Alloc(&gathered[i], dtype);
+        comm_ctx->AllGather(&gathered[i], chunk, stream);
+      },
+      [&](int64_t i) {
+        // the pieces of the ranks are concated on the split axis into the
+        // rows of the chunk in the output
+        int64_t rows = offsets[i + 1] - offsets[i];
+        std::vector<DenseTensor> pieces;
+        pieces.reserve(num_of_process);
+        for (int64_t j = 0; j < num_of_process; ++j) {
+          pieces.emplace_back(gathered[i].Slice(j * rows, (j + 1) * rows));
+        }
+        std::vector<const DenseTensor*> concat_input_vec;
+        concat_input_vec.reserve(pieces.size());
+        for (const auto& piece : pieces) {
+          concat_input_vec.emplace_back(&piece);
+        }
+        DenseTensor out_chunk = out_value->Slice(offsets[i], offsets[i + 1]);
+        RESHARD_FUNCTOR(
+            dev_ctx, Concat, dtype, concat_input_vec, split_axis, &out_chunk);
+      });
+  SetDistProps(out, in.dims(), out_dist_attr);
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "%s is only supported with NCCL or RCCL.", Name()));
+#endif
+}
+
+bool PToSChunkedReshardFunction::IsSuitable(
+    const DistTensor& in, const TensorDistAttr& out_dist_attr) {
+  RESHARD_SHORTCUT_IF_FALSE(IsChunkedReshardEnabled(in));
+
+  const auto& in_dist_attr = in.dist_attr();
+  RESHARD_SHORTCUT_IF_FALSE(in_dist_attr.is_partial());
+  RESHARD_SHORTCUT_IF_FALSE(out_dist_attr.is_shard());
+  for (const auto& status : in_dist_attr.partial_status()) {
+    RESHARD_SHORTCUT_IF_FALSE(status.second == ReduceType::kRedSum);
+  }
+
+  const auto& in_process_mesh = in_dist_attr.process_mesh();
+  const auto& out_process_mesh = out_dist_attr.process_mesh();
+  RESHARD_SHORTCUT_IF_FALSE(in_process_mesh.ndim() == 1);
+  RESHARD_SHORTCUT_IF_FALSE(out_process_mesh.ndim() == 1);
+  RESHARD_SHORTCUT_IF_FALSE(in_process_mesh == out_process_mesh);
+
+  int split_axis =
+      GetSplitAxisWithDimsMapping(out_dist_attr.dims_mapping()).begin()->first;
+  int64_t num_of_process = in_process_mesh.size();
+  RESHARD_SHORTCUT_IF_FALSE(split_axis != 0);
+  RESHARD_SHORTCUT_IF_FALSE(num_of_process > 1);
+  RESHARD_SHORTCUT_IF_FALSE(in.dims()[split_axis] % num_of_process == 0);
+
+  return PToSNumChunks(in, num_of_process) > 1;
+}
+
+void PToSChunkedReshardFunction::Eval(DeviceContext* dev_ctx,
+                                      const DistTensor& in,
+                                      const TensorDistAttr& out_dist_attr,
+                                      DistTensor* out) {
+  VLOG(3) << "Call " << Name();
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  const auto& in_process_ids = in.dist_attr().process_mesh().process_ids();
+  int split_axis =
+      GetSplitAxisWithDimsMapping(out_dist_attr.dims_mapping()).begin()->first;
+  int64_t num_of_process = static_cast<int64_t>(in_process_ids.size());
+  int64_t num_chunks = PToSNumChunks(in, num_of_process);
+  VLOG(3) << "Reshard from partial to shard in " << num_chunks << " chunks";
+
+  auto* calc_ctx = static_cast<GPUContext*>(dev_ctx);
+  auto* comm_ctx = static_cast<NCCLCommContext*>(
+      CreateOrGetCommContext(*dev_ctx, in_process_ids));
+  const auto& in_value = in.value();
+  auto dtype = in.dtype();
+  // the split axis is swapped to axis 0 for reduce-scatter and back
+  auto perm = SwapAxisPerm(in_value.dims().size(), split_axis);
+
+  DenseTensor* out_value = GetMutableTensor(out);
+  DDim out_dims = in_value.dims();
+  out_dims[split_axis] /= num_of_process;
+  out_value->Resize(out_dims);
+  dev_ctx->Alloc(out_value, dtype);
+
+  auto offsets = ChunkOffsets(in_value.dims()[0], num_chunks);
+  std::vector<DenseTensor> transposed(num_chunks);
+  std::vector<DenseTensor> scattered(num_chunks);
+  RunChunkPipeline(
+      calc_ctx,
+      comm_ctx,
+      num_chunks,
+      [&](int64_t i) {
+        DenseTensor chunk = in_value.Slice(offsets[i], offsets[i + 1]);
+        RESHARD_FUNCTOR(dev_ctx, Transpose, dtype, chunk, perm, &transposed[i]);
+      },
+      [&](int64_t i, gpuStream_t stream) {
+        DDim scattered_dims = transposed[i].dims();
+        scattered_dims[0] /= num_of_process;
+        scattered[i].Resize(scattered_dims);
+        dev_ctx->Alloc(&scattered[i], dtype);
+        comm_ctx->ReduceScatter(&scattered[i], transposed[i], ncclSum, stream);
+      },
+      [&](int64_t i) {
+        DenseTensor out_chunk = out_value->Slice(offsets[i], offsets[i + 1]);
+        RESHARD_FUNCTOR(
+            dev_ctx, Transpose, dtype, scattered[i], perm, &out_chunk);
+      });
+  SetDistProps(out, in.dims(), out_dist_attr);
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "%s is only supported with NCCL or RCCL.", Name()));
+#endif
+}
+
+}  // namespace phi::distributed
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_function.h"
+
+namespace phi {
+namespace distributed {
+
+// Time model of resharding a tensor in chunks along its axis 0. The
+// collective of a chunk runs on the stream of the comm context, and overlaps
+// the relayout kernels of the previous chunk (the concat of allgather or the
+// transposes around reduce-scatter) on the calculation stream. With C and R
+// the time of the collective and the relayout of one chunk, k chunks take
+// about C + R + (k - 1) * max(C, R), while every chunk pays the latency of a
+// collective and of the kernel launches.
+struct ReshardChunkCostModel {
+  // latency of a collective in us
+  double comm_latency_us = 20.0;
+  // bus bandwidth of the collectives in GB/s
+  double comm_bandwidth = 20.0;
+  // latency of a kernel launch in us
+  double kernel_latency_us = 5.0;
+  // bandwidth of the device memory in GB/s, a relayout reads and writes the
+  // bytes once
+  double memory_bandwidth = 500.0;
+
+  double EstimateTime(int64_t num_chunks,
+                      int64_t comm_bytes,
+                      int64_t relayout_bytes,
+                      int64_t relayout_kernels) const;
+
+  // The number of chunks in [1, max_chunks] of the least time, 1 means that
+  // chunking does not pay off.
+  int64_t ChooseNumChunks(int64_t max_chunks,
+                          int64_t comm_bytes,
+                          int64_t relayout_bytes,
+                          int64_t relayout_kernels) const;
+};
+
+// Balanced shard to replicated on the same 1D mesh when the split axis is
+// not 0, the allgather of each chunk is followed by a concat on the split
+// axis. Only used on GPU when FLAGS_enable_chunked_reshard is set and the
+// cost model chooses more than one chunk.
+class SToRChunkedReshardFunction final : public ReshardFunction {
+ public:
+  bool IsSuitable(const DistTensor& in,
+                  const TensorDistAttr& out_dist_attr) override;
+
+  void Eval(DeviceContext* dev_ctx,
+            const DistTensor& in,
+            const TensorDistAttr& out_dist_attr,
+            DistTensor* out) override;
+
+  std::string Name() override { return "SToRChunkedReshard"; }
+};
+
+// Partial (sum) to balanced shard on the same 1D mesh when the split axis is
+// not 0, each chunk is transposed before and after its reduce-scatter.
+class PToSChunkedReshardFunction final : public ReshardFunction {
+ public:
+  bool IsSuitable(const DistTensor& in,
+                  const TensorDistAttr& out_dist_attr) override;
+
+  void Eval(DeviceContext* dev_ctx,
+            const DistTensor& in,
+            const TensorDistAttr& out_dist_attr,
+            DistTensor* out) override;
+
+  std::string Name() override { return "PToSChunkedReshard"; }
+};
+
+}  // namespace distributed
+}  // namespace phi
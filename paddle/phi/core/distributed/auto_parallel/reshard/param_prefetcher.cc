@@ -0,0 +1,194 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/param_prefetcher.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/device_context.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_function.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_function_registry.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_utils.h"
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+#include "paddle/phi/api/profiler/event.h"
+#include "paddle/phi/core/distributed/nccl_comm_context.h"
+#include "paddle/phi/core/memory/malloc.h"
+#endif
+
+COMMON_DECLARE_int32(param_prefetch_depth);
+COMMON_DECLARE_int64(param_prefetch_max_mb);
+
+namespace phi::distributed {
+
+struct ParamPrefetcher::Prefetch {
+  std::shared_ptr<DistTensor> out;
+  int64_t bytes = 0;
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  phi::CudaEvent done_event;
+#endif
+};
+
+ParamPrefetcher::ParamPrefetcher() = default;
+
+ParamPrefetcher::~ParamPrefetcher() = default;
+
+ParamPrefetcher& ParamPrefetcher::Instance() {
+  static ParamPrefetcher prefetcher;
+  return prefetcher;
+}
+
+void ParamPrefetcher::Register(const std::shared_ptr<TensorBase>& param) {
+  PADDLE_ENFORCE_EQ(
+      DistTensor::classof(param.get()),
+      true,
+      common::errors::InvalidArgument(
+          "Only the parameters of DistTensor can be prefetched."));
+  std::lock_guard<std::mutex> guard(mutex_);
+  params_[param.get()] = param;
+}
+
+void ParamPrefetcher::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  params_.clear();
+  order_.clear();
+  recording_.clear();
+  cursor_ = 0;
+  in_flight_.clear();
+  in_flight_bytes_ = 0;
+}
+
+void ParamPrefetcher::NextStep() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (recording_.empty()) {
+    // e.g. the update of another group of parameters
+    return;
+  }
+  VLOG(4) << "Recorded " << recording_.size() << " parameter reshards, "
+          << in_flight_.size() << " prefetches not used";
+  order_ = std::move(recording_);
+  recording_.clear();
+  cursor_ = 0;
+  in_flight_.clear();
+  in_flight_bytes_ = 0;
+}
+
+size_t ParamPrefetcher::Find(const TensorBase* key,
+                             const TensorDistAttr& dist_attr) const {
+  for (size_t i = cursor_; i < order_.size(); ++i) {
+    if (order_[i].key == key && order_[i].dist_attr == dist_attr) {
+      return i;
+    }
+  }
+  return order_.size();
+}
+
+std::shared_ptr<DistTensor> ParamPrefetcher::Fetch(
+    DeviceContext* dev_ctx,
+    const DistTensor& in,
+    const TensorDistAttr& dist_attr) {
+  if (FLAGS_param_prefetch_depth <= 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto param = params_.find(&in);
+  if (param == params_.end()) {
+    return nullptr;
+  }
+  recording_.push_back({param->second, &in, dist_attr});
+
+  size_t pos = Find(&in, dist_attr);
+  if (pos == order_.size()) {
+    // not in the order of the last step, the prefetches are kept for the
+    // uses after it
+    return nullptr;
+  }
+  // the prefetches skipped are not used in this step
+  for (auto it = in_flight_.begin(); it != in_flight_.end() && it->first < pos;
+       it = in_flight_.erase(it)) {
+    in_flight_bytes_ -= it->second->bytes;
+  }
+
+  std::shared_ptr<DistTensor> out;
+  auto it = in_flight_.find(pos);
+  if (it != in_flight_.end()) {
+    out = it->second->out;
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+    auto* calc_ctx = static_cast<GPUContext*>(dev_ctx);
+    calc_ctx->WaitEvent(it->second->done_event.GetRawCudaEvent());
+    // allocated on the comm stream, the memory is reused only after the
+    // kernels of the calculation stream are done with it
+    if (out->value().Holder()) {
+      paddle::memory::RecordStream(out->value().Holder(), calc_ctx->stream());
+    }
+#endif
+    in_flight_bytes_ -= it->second->bytes;
+    in_flight_.erase(it);
+    VLOG(4) << "Use the prefetched reshard " << pos;
+  }
+
+  cursor_ = pos + 1;
+  size_t depth = static_cast<size_t>(FLAGS_param_prefetch_depth);
+  size_t end = std::min(order_.size(), cursor_ + depth);
+  for (size_t i = cursor_; i < end; ++i) {
+    if (in_flight_.count(i) == 0 && !Launch(dev_ctx, i)) {
+      break;
+    }
+  }
+  return out;
+}
+
+bool ParamPrefetcher::Launch(DeviceContext* dev_ctx, size_t pos) {
+  const auto& use = order_[pos];
+  auto param = use.param.lock();
+  if (!param) {
+    return false;
+  }
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  if (!GPUContext::classof(dev_ctx)) {
+    return false;
+  }
+  const auto& in = static_cast<const DistTensor&>(*param);
+  int64_t bytes = in.numel() * static_cast<int64_t>(SizeOf(in.dtype()));
+  int64_t max_bytes = FLAGS_param_prefetch_max_mb << 20;
+  if (!in_flight_.empty() && in_flight_bytes_ + bytes > max_bytes) {
+    return false;
+  }
+
+  auto* calc_ctx = static_cast<GPUContext*>(dev_ctx);
+  auto* comm_ctx = static_cast<NCCLCommContext*>(
+      CreateOrGetCommContext(*dev_ctx, in.process_mesh().process_ids()));
+  auto* comm_dev_ctx = comm_ctx->GetDevContext();
+  // the parameter is read after its last update on the calculation stream
+  phi::CudaEvent ready_event;
+  ready_event.Record(calc_ctx->stream());
+  comm_dev_ctx->WaitEvent(ready_event.GetRawCudaEvent());
+
+  auto prefetch = std::make_unique<Prefetch>();
+  auto* func = ChooseProperReshardFunction(in, use.dist_attr);
+  prefetch->out = func->Eval(comm_dev_ctx, in, use.dist_attr);
+  prefetch->done_event.Record(comm_dev_ctx->stream());
+  prefetch->bytes = bytes;
+  in_flight_bytes_ += bytes;
+  in_flight_[pos] = std::move(prefetch);
+  VLOG(4) << "Prefetch the reshard " << pos << " with " << func->Name();
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace phi::distributed
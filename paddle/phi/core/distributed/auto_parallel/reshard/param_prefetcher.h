@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/core/distributed/auto_parallel/dist_attr.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
+
+namespace phi {
+class DeviceContext;
+namespace distributed {
+
+/**
+ * Prefetches the gathers of sharded parameters, e.g. of sharding stage 3.
+ *
+ * The reshards of the registered parameters to the inputs of the kernels
+ * are recorded in the order of a step, forward and backward. In the next
+ * step, when the reshard at position i of the order is asked for, the ones
+ * at i + 1 to i + FLAGS_param_prefetch_depth are launched on the stream of
+ * the comm context, so that the gathers overlap the compute of the layers
+ * before. The gathered tensors not used yet are bounded by
+ * FLAGS_param_prefetch_max_mb, and are dropped once used, so a gathered
+ * parameter lives until its kernel is done. Only used on GPU when the depth
+ * is positive.
+ **/
+class ParamPrefetcher {
+ public:
+  static ParamPrefetcher& Instance();
+
+  void Register(const std::shared_ptr<TensorBase>& param);
+  void Clear();
+
+  // The order recorded becomes the one prefetched, and the prefetches not
+  // used are dropped. Nothing changes if nothing was recorded.
+  void NextStep();
+
+  // The reshard of in to dist_attr if it was prefetched, else nullptr, and
+  // the reshards after it are prefetched.
+  std::shared_ptr<DistTensor> Fetch(DeviceContext* dev_ctx,
+                                    const DistTensor& in,
+                                    const TensorDistAttr& dist_attr);
+
+ private:
+  struct Use {
+    std::weak_ptr<TensorBase> param;
+    const TensorBase* key;
+    TensorDistAttr dist_attr;
+  };
+  struct Prefetch;
+
+  ParamPrefetcher();
+  ~ParamPrefetcher();
+
+  // The position of the use in the order at or after cursor_, or the size
+  // of the order.
+  size_t Find(const TensorBase* key, const TensorDistAttr& dist_attr) const;
+  bool Launch(DeviceContext* dev_ctx, size_t pos);
+
+  std::mutex mutex_;
+  std::unordered_map<const TensorBase*, std::weak_ptr<TensorBase>> params_;
+  std::vector<Use> order_;
+  std::vector<Use> recording_;
+  size_t cursor_ = 0;
+  std::map<size_t, std::unique_ptr<Prefetch>> in_flight_;
+  int64_t in_flight_bytes_ = 0;
+};
+
+}  // namespace distributed
+}  // namespace phi
@@ -17,6 +17,7 @@
 #include "glog/logging.h"
 
 #include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/chunked_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/global_and_sub_mesh_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/nd_mesh_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/p_to_r_reshard_function.h"
@@ -57,6 +58,7 @@ std::vector<std::unique_ptr<ReshardFunction>>& GetReshardFunctionList() {
 // which was registered earlier.
 // Reshard function with higher priority will be evoked
 // when more than one reshard function satisfy the request.
+REGISTER_RESHARD_FUNC(SToRChunkedReshardFunction);
 REGISTER_RESHARD_FUNC(SToRReshardFunction);
 REGISTER_RESHARD_FUNC(SToRReshardFunctionCrossMesh);
 REGISTER_RESHARD_FUNC(SToPReshardFunction);
@@ -67,6 +69,7 @@ REGISTER_RESHARD_FUNC(RToPReshardFunction);
 REGISTER_RESHARD_FUNC(RToPReshardFunctionCrossMesh);
 REGISTER_RESHARD_FUNC(PToRReshardFunction);
 REGISTER_RESHARD_FUNC(PToRReshardFunctionCrossMesh);
+REGISTER_RESHARD_FUNC(PToSChunkedReshardFunction);
 REGISTER_RESHARD_FUNC(PToSReshardFunction);
 REGISTER_RESHARD_FUNC(PToSReshardFunctionCrossMesh);
 REGISTER_RESHARD_FUNC(SToSReshardFunction);
@@ -0,0 +1,401 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/distributed/auto_parallel/sharding_planner.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_meta_tensor.h"
+#include "paddle/phi/core/distributed/auto_parallel/inferspmd_utils.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace phi::distributed {
+
+namespace {
+
+// The mesh dim state of a tensor, the axis sharded, or kReplicated or
+// kPartial.
+constexpr int64_t kReplicated = -1;
+constexpr int64_t kPartial = -2;
+
+int64_t MeshDimState(const TensorDistAttr& dist_attr, int64_t mesh_dim) {
+  if (dist_attr.is_partial(mesh_dim)) {
+    return kPartial;
+  }
+  const auto& dims_mapping = dist_attr.dims_mapping();
+  for (size_t axis = 0; axis < dims_mapping.size(); ++axis) {
+    if (dims_mapping[axis] == mesh_dim) {
+      return static_cast<int64_t>(axis);
+    }
+  }
+  return kReplicated;
+}
+
+int64_t LocalBytes(const std::vector<int64_t>& shape,
+                   DataType dtype,
+                   const TensorDistAttr& dist_attr) {
+  int64_t bytes = static_cast<int64_t>(SizeOf(dtype));
+  for (auto dim : shape) {
+    bytes *= dim;
+  }
+  const auto& mesh = dist_attr.process_mesh();
+  for (auto mesh_dim : dist_attr.dims_mapping()) {
+    if (mesh_dim >= 0) {
+      bytes /= mesh.dim_size(mesh_dim);
+    }
+  }
+  return bytes;
+}
+
+// 1 GB/s moves 1e3 bytes in 1 us
+double TransferTime(double bytes, double bandwidth) {
+  return bytes / (bandwidth * 1e3);
+}
+
+}  // namespace
+
+double ShardingCostModel::ComputeTime(double flops) const {
+  // 1 TFLOPS runs 1e6 flops in 1 us
+  return flops / (device_tflops * 1e6);
+}
+
+double ShardingCostModel::AllGatherTime(int64_t bytes, int64_t ranks) const {
+  if (ranks <= 1) {
+    return 0;
+  }
+  return comm_latency_us +
+         TransferTime(static_cast<double>(bytes) * (ranks - 1), comm_bandwidth);
+}
+
+double ShardingCostModel::AllReduceTime(int64_t bytes, int64_t ranks) const {
+  if (ranks <= 1) {
+    return 0;
+  }
+  return comm_latency_us +
+         TransferTime(2.0 * static_cast<double>(bytes) * (ranks - 1) / ranks,
+                      comm_bandwidth);
+}
+
+double ShardingCostModel::ReduceScatterTime(int64_t bytes,
+                                            int64_t ranks) const {
+  if (ranks <= 1) {
+    return 0;
+  }
+  return comm_latency_us +
+         TransferTime(static_cast<double>(bytes) * (ranks - 1) / ranks,
+                      comm_bandwidth);
+}
+
+double ShardingCostModel::AllToAllTime(int64_t bytes, int64_t ranks) const {
+  if (ranks <= 1) {
+    return 0;
+  }
+  return comm_latency_us +
+         TransferTime(static_cast<double>(bytes) * (ranks - 1) / ranks,
+                      comm_bandwidth);
+}
+
+double ShardingCostModel::ReshardTime(const std::vector<int64_t>& shape,
+                                      DataType dtype,
+                                      const TensorDistAttr& in,
+                                      const TensorDistAttr& out) const {
+  const auto& mesh = in.process_mesh();
+  int64_t bytes = LocalBytes(shape, dtype, in);
+  double time = 0;
+  for (int64_t mesh_dim = 0; mesh_dim < mesh.ndim(); ++mesh_dim) {
+    const int64_t ranks = mesh.dim_size(mesh_dim);
+    const int64_t in_state = MeshDimState(in, mesh_dim);
+    const int64_t out_state = MeshDimState(out, mesh_dim);
+    if (in_state == out_state) {
+      continue;
+    }
+    if (in_state == kPartial) {
+      if (out_state == kReplicated) {
+        time += AllReduceTime(bytes, ranks);
+      } else {
+        time += ReduceScatterTime(bytes, ranks);
+        bytes /= ranks;
+      }
+    } else if (in_state == kReplicated) {
+      // a slice, or zeros on the other ranks for partial
+      if (out_state >= 0) {
+        bytes /= ranks;
+      }
+    } else if (out_state >= 0) {
+      time += AllToAllTime(bytes, ranks);
+    } else {
+      // to partial through replicated
+      time += AllGatherTime(bytes, ranks);
+      bytes *= ranks;
+    }
+  }
+  return time;
+}
+
+ShardingPlanner::ShardingPlanner(const ProcessMesh& mesh,
+                                 const ShardingCostModel& cost_model,
+                                 int64_t beam_width)
+    : mesh_(mesh), cost_model_(cost_model), beam_width_(beam_width) {
+  PADDLE_ENFORCE_GE(beam_width,
+                    1,
+                    common::errors::InvalidArgument(
+                        "The beam width of the sharding planner should be at "
+                        "least 1, but got %d.",
+                        beam_width));
+}
+
+int64_t ShardingPlanner::AddTensor(const ShardingPlanTensor& tensor) {
+  tensors_.push_back(tensor);
+  return static_cast<int64_t>(tensors_.size()) - 1;
+}
+
+void ShardingPlanner::AddOp(const ShardingPlanOp& op) {
+  PADDLE_ENFORCE_EQ(
+      SpmdRuleFactory::Instance().ContainsSpmdRule(op.type),
+      true,
+      common::errors::NotFound("There is no spmd rule of op %s.", op.type));
+  for (auto tensor : op.inputs) {
+    PADDLE_ENFORCE_EQ(
+        tensor >= 0 && tensor < static_cast<int64_t>(tensors_.size()),
+        true,
+        common::errors::InvalidArgument(
+            "The input %d of op %s is not a tensor added.", tensor, op.type));
+  }
+  for (auto tensor : op.outputs) {
+    PADDLE_ENFORCE_EQ(
+        tensor >= 0 && tensor < static_cast<int64_t>(tensors_.size()) &&
+            !tensors_[tensor].is_parameter,
+        true,
+        common::errors::InvalidArgument(
+            "The output %d of op %s is not a tensor added, or is a "
+            "parameter.",
+            tensor,
+            op.type));
+  }
+  ops_.push_back(op);
+}
+
+TensorDistAttr ShardingPlanner::Replicated(int64_t tensor) const {
+  TensorDistAttr dist_attr(tensors_[tensor].shape);
+  dist_attr.set_process_mesh(mesh_);
+  return dist_attr;
+}
+
+std::vector<TensorDistAttr> ShardingPlanner::Candidates(int64_t tensor) const {
+  const auto& shape = tensors_[tensor].shape;
+  std::vector<TensorDistAttr> candidates;
+  std::vector<int64_t> dims_mapping(shape.size(), -1);
+  std::function<void(int64_t)> visit = [&](int64_t mesh_dim) {
+    if (mesh_dim == mesh_.ndim()) {
+      auto dist_attr = Replicated(tensor);
+      dist_attr.set_dims_mapping(dims_mapping);
+      candidates.push_back(dist_attr);
+      return;
+    }
+    visit(mesh_dim + 1);
+    const int64_t ranks = mesh_.dim_size(mesh_dim);
+    if (ranks <= 1) {
+      return;
+    }
+    for (size_t axis = 0; axis < shape.size(); ++axis) {
+      if (dims_mapping[axis] == -1 && shape[axis] > 0 &&
+          shape[axis] % ranks == 0) {
+        dims_mapping[axis] = mesh_dim;
+        visit(mesh_dim + 1);
+        dims_mapping[axis] = -1;
+      }
+    }
+  };
+  visit(0);
+  return candidates;
+}
+
+ShardingPlan ShardingPlanner::Evaluate(
+    const std::map<int64_t, TensorDistAttr>& param_dist_attrs) const {
+  ShardingPlan plan;
+  std::vector<TensorDistAttr> dist_attrs(tensors_.size());
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    const auto& tensor = tensors_[i];
+    if (tensor.is_parameter) {
+      auto it = param_dist_attrs.find(i);
+      dist_attrs[i] = it != param_dist_attrs.end() ? it->second : Replicated(i);
+      plan.param_dist_attrs[i] = dist_attrs[i];
+    } else {
+      dist_attrs[i] =
+          tensor.dist_attr.empty() ? Replicated(i) : tensor.dist_attr;
+    }
+  }
+
+  // the mesh dims over which the gradient of a parameter is partial
+  std::map<int64_t, std::set<int64_t>> grad_partial_dims;
+  double reshard_time = 0;
+  for (const auto& op : ops_) {
+    InferSpmdContext ctx;
+    for (auto input : op.inputs) {
+      ctx.EmplaceBackInput(DistMetaTensor(
+          common::make_ddim(tensors_[input].shape), dist_attrs[input]));
+    }
+    for (const auto& attr : op.attrs) {
+      ctx.EmplaceBackAttr(attr);
+    }
+    SpmdInfo spmd_info;
+    try {
+      spmd_info = SpmdRuleFactory::Instance().GetSpmdRule(op.type).InferForward(
+          ctx);
+    } catch (const std::exception& e) {
+      VLOG(4) << "The spmd rule of " << op.type
+              << " rejects the plan: " << e.what();
+      plan.valid = false;
+      return plan;
+    }
+
+    // the mesh dims dividing the compute of the op
+    std::set<int64_t> split_dims;
+    for (size_t k = 0; k < op.outputs.size(); ++k) {
+      const int64_t output = op.outputs[k];
+      if (k < spmd_info.second.size() &&
+          paddle::holds_alternative<TensorDistAttr>(spmd_info.second[k])) {
+        dist_attrs[output] =
+            paddle::get<TensorDistAttr>(spmd_info.second[k]);
+      } else {
+        dist_attrs[output] = Replicated(output);
+      }
+      for (auto mesh_dim : dist_attrs[output].dims_mapping()) {
+        if (mesh_dim >= 0) {
+          split_dims.insert(mesh_dim);
+        }
+      }
+      for (auto mesh_dim : dist_attrs[output].partial_dims()) {
+        split_dims.insert(mesh_dim);
+      }
+    }
+    for (size_t k = 0; k < op.inputs.size(); ++k) {
+      const int64_t input = op.inputs[k];
+      if (k >= spmd_info.first.size() ||
+          !paddle::holds_alternative<TensorDistAttr>(spmd_info.first[k])) {
+        continue;
+      }
+      const auto& wanted = paddle::get<TensorDistAttr>(spmd_info.first[k]);
+      const auto& tensor = tensors_[input];
+      reshard_time += cost_model_.ReshardTime(
+          tensor.shape, tensor.dtype, dist_attrs[input], wanted);
+      if (cost_model_.training) {
+        // the gradient goes back the other way
+        reshard_time += cost_model_.ReshardTime(
+            tensor.shape, tensor.dtype, wanted, dist_attrs[input]);
+      }
+      if (tensor.is_parameter) {
+        for (auto mesh_dim : split_dims) {
+          if (MeshDimState(wanted, mesh_dim) == kReplicated) {
+            grad_partial_dims[input].insert(mesh_dim);
+          }
+        }
+      }
+    }
+    int64_t split = 1;
+    for (auto mesh_dim : split_dims) {
+      split *= mesh_.dim_size(mesh_dim);
+    }
+    plan.compute_time += cost_model_.ComputeTime(op.flops / split);
+  }
+
+  plan.comm_time = reshard_time;
+  if (cost_model_.training) {
+    // the backward of an op costs about twice its forward
+    plan.compute_time *= 3;
+    for (const auto& item : grad_partial_dims) {
+      int64_t ranks = 1;
+      for (auto mesh_dim : item.second) {
+        ranks *= mesh_.dim_size(mesh_dim);
+      }
+      const auto& tensor = tensors_[item.first];
+      plan.comm_time += cost_model_.AllReduceTime(
+          LocalBytes(tensor.shape, tensor.dtype, dist_attrs[item.first]),
+          ranks);
+    }
+  }
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    const auto& tensor = tensors_[i];
+    double bytes = LocalBytes(tensor.shape, tensor.dtype, dist_attrs[i]);
+    if (tensor.is_parameter && cost_model_.training) {
+      bytes *= 1 + cost_model_.param_memory_factor;
+    }
+    plan.memory += static_cast<int64_t>(bytes);
+  }
+  return plan;
+}
+
+bool ShardingPlanner::Better(const ShardingPlan& lhs,
+                             const ShardingPlan& rhs) const {
+  if (lhs.valid != rhs.valid) {
+    return lhs.valid;
+  }
+  if (cost_model_.device_memory > 0) {
+    int64_t lhs_overflow =
+        std::max<int64_t>(lhs.memory - cost_model_.device_memory, 0);
+    int64_t rhs_overflow =
+        std::max<int64_t>(rhs.memory - cost_model_.device_memory, 0);
+    if (lhs_overflow != rhs_overflow) {
+      return lhs_overflow < rhs_overflow;
+    }
+  }
+  return lhs.Time() < rhs.Time();
+}
+
+ShardingPlan ShardingPlanner::Plan() const {
+  std::vector<int64_t> params;
+  std::vector<bool> seen(tensors_.size(), false);
+  auto visit = [&](int64_t tensor) {
+    if (tensors_[tensor].is_parameter && !seen[tensor]) {
+      seen[tensor] = true;
+      params.push_back(tensor);
+    }
+  };
+  for (const auto& op : ops_) {
+    std::for_each(op.inputs.begin(), op.inputs.end(), visit);
+  }
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    visit(i);
+  }
+
+  std::vector<ShardingPlan> beam = {Evaluate({})};
+  for (auto param : params) {
+    std::vector<ShardingPlan> next;
+    for (const auto& plan : beam) {
+      for (const auto& candidate : Candidates(param)) {
+        auto param_dist_attrs = plan.param_dist_attrs;
+        param_dist_attrs[param] = candidate;
+        next.push_back(Evaluate(param_dist_attrs));
+      }
+    }
+    std::stable_sort(next.begin(),
+                     next.end(),
+                     [this](const ShardingPlan& lhs, const ShardingPlan& rhs) {
+                       return Better(lhs, rhs);
+                     });
+    if (static_cast<int64_t>(next.size()) > beam_width_) {
+      next.resize(beam_width_);
+    }
+    beam.swap(next);
+    VLOG(4) << "Planned parameter " << param << ": "
+            << beam.front().param_dist_attrs[param].to_string()
+            << ", time " << beam.front().Time() << " us";
+  }
+  return beam.front();
+}
+
+}  // namespace phi::distributed
@@ -0,0 +1,138 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/attribute.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_attr.h"
+#include "paddle/phi/core/distributed/auto_parallel/process_mesh.h"
+
+namespace phi {
+namespace distributed {
+
+// Time model of a training step of a plan, in us. The collectives are ring
+// ones of a latency and a bus bandwidth, as in ReshardChunkCostModel, and the
+// compute of an op is divided by the mesh dims sharding its outputs or
+// leaving them partial.
+struct ShardingCostModel {
+  // compute throughput of a device in TFLOPS
+  double device_tflops = 100.0;
+  // latency of a collective in us
+  double comm_latency_us = 20.0;
+  // bus bandwidth of the collectives in GB/s
+  double comm_bandwidth = 20.0;
+  // memory of a device in bytes, 0 for no limit
+  int64_t device_memory = 0;
+  // the bytes of gradient and optimizer states per byte of parameter
+  double param_memory_factor = 3.0;
+  // with backward, the compute of the forward is paid twice more, the
+  // gradients are resharded back, and the gradients of the parameters are
+  // all-reduced
+  bool training = true;
+
+  double ComputeTime(double flops) const;
+  // The bytes are the ones of a rank before the collective.
+  double AllGatherTime(int64_t bytes, int64_t ranks) const;
+  double AllReduceTime(int64_t bytes, int64_t ranks) const;
+  double ReduceScatterTime(int64_t bytes, int64_t ranks) const;
+  double AllToAllTime(int64_t bytes, int64_t ranks) const;
+
+  // Time of resharding a tensor mesh dim by mesh dim.
+  double ReshardTime(const std::vector<int64_t>& shape,
+                     DataType dtype,
+                     const TensorDistAttr& in,
+                     const TensorDistAttr& out) const;
+};
+
+struct ShardingPlanTensor {
+  std::vector<int64_t> shape;
+  DataType dtype = DataType::FLOAT32;
+  // the placements of the parameters are planned
+  bool is_parameter = false;
+  // of the inputs that are not parameters, replicated if empty
+  TensorDistAttr dist_attr;
+};
+
+// An op of the graph, by the name of its spmd rule. Each input is one
+// tensor, and the attrs are the ones of the rule after its inputs.
+struct ShardingPlanOp {
+  std::string type;
+  std::vector<int64_t> inputs;
+  std::vector<int64_t> outputs;
+  std::vector<Attribute> attrs;
+  double flops = 0;
+};
+
+struct ShardingPlan {
+  // by the index of the parameter
+  std::map<int64_t, TensorDistAttr> param_dist_attrs;
+  double compute_time = 0;
+  double comm_time = 0;
+  // of a device, with the gradients and optimizer states if training
+  int64_t memory = 0;
+  // false if the spmd rules reject the placements
+  bool valid = true;
+
+  double Time() const { return compute_time + comm_time; }
+};
+
+/**
+ * Plans the placements of the parameters of a graph on a mesh.
+ *
+ * The candidates of a parameter are the ways of its axes to be sharded
+ * evenly by distinct mesh dims. A plan is propagated through the ops in the
+ * order they were added with their spmd rules, and the inputs an op wants
+ * in other placements are resharded. The parameters are decided in the
+ * order of their first use by a beam search keeping the beam_width best
+ * partial plans, the parameters not decided yet being replicated. Plans
+ * fitting the device memory go first, then the ones of less time.
+ **/
+class ShardingPlanner {
+ public:
+  ShardingPlanner(const ProcessMesh& mesh,
+                  const ShardingCostModel& cost_model,
+                  int64_t beam_width = 4);
+
+  // Returns the index of the tensor.
+  int64_t AddTensor(const ShardingPlanTensor& tensor);
+  // The inputs are added before, in topological order.
+  void AddOp(const ShardingPlanOp& op);
+
+  std::vector<TensorDistAttr> Candidates(int64_t tensor) const;
+
+  ShardingPlan Evaluate(
+      const std::map<int64_t, TensorDistAttr>& param_dist_attrs) const;
+
+  ShardingPlan Plan() const;
+
+ private:
+  TensorDistAttr Replicated(int64_t tensor) const;
+  bool Better(const ShardingPlan& lhs, const ShardingPlan& rhs) const;
+
+  ProcessMesh mesh_;
+  ShardingCostModel cost_model_;
+  int64_t beam_width_;
+  std::vector<ShardingPlanTensor> tensors_;
+  std::vector<ShardingPlanOp> ops_;
+};
+
+}  // namespace distributed
+}  // namespace phi
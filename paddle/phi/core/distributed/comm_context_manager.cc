@@ -37,7 +37,9 @@
 #elif defined(PADDLE_WITH_XPU_BKCL)
 #include "paddle/phi/backends/xpu/xpu_info.h"
 #include "paddle/phi/common/memory_utils.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/core/distributed/bkcl_comm_context.h"
+COMMON_DECLARE_bool(xpu_enable_multi_stream);
 #endif
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
 #include "paddle/phi/core/distributed/xccl_comm_context.h"
@@ -212,6 +214,10 @@ void CommContextManager::CreateBKCLCommContext(
   if (CommContextManager::device_id != -1) {
     std::unique_ptr<phi::XPUContext> dev_ctx(new phi::XPUContext(
         phi::XPUPlace(CommContextManager::device_id), true));
+    if (FLAGS_xpu_enable_multi_stream) {
+      // the communications overlap the computation on their own stream
+      dev_ctx->CreateStream();
+    }
     dev_ctx->SetAllocator(phi::memory_utils::GetAllocator(
         CommContextManager::device_id, dev_ctx->stream()));
     dev_ctx->SetHostAllocator(phi::memory_utils::GetHostAllocator());
@@ -33,6 +33,19 @@ namespace phi {
 namespace distributed {
 
 class Store;
+
+// Performance of a completed communication task. The timestamps are in
+// nanoseconds of the host clock, the same as the events of the profiler, and
+// the bandwidths are in GB/s.
+struct CommPerfRecord {
+  uint64_t enqueue_ns = 0;
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  int64_t bytes = 0;
+  double algbw = 0;
+  double busbw = 0;
+};
+
 class CommTask {
  public:
   CommTask(const std::string& backend = "",
@@ -149,6 +162,12 @@ class CommTask {
         common::errors::Unimplemented("%s is not implemented.", __func__));
     return;
   }
+  // Only valid for completed tasks, returns false if the task is not timed.
+  virtual bool GetPerfRecord(CommPerfRecord* record UNUSED) {
+    PADDLE_THROW(
+        common::errors::Unimplemented("%s is not implemented.", __func__));
+    return false;
+  }
 
  protected:
   std::string backend_;
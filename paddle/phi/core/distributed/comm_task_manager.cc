@@ -22,12 +22,18 @@
 
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 
+#include <algorithm>
 #include <future>
 #include <memory>
+#include <sstream>
 #include <string>
 
 #include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/api/profiler/common_event.h"
+#include "paddle/phi/api/profiler/event_tracing.h"
+#include "paddle/phi/api/profiler/host_event_recorder.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/distributed/store/store.h"
 #include "paddle/phi/core/enforce.h"
@@ -37,9 +43,19 @@
 #include "paddle/phi/core/distributed/nccl_comm_context.h"
 #endif
 
+COMMON_DECLARE_bool(enable_comm_perf_trace);
+COMMON_DECLARE_int32(comm_perf_trace_window);
+COMMON_DECLARE_double(comm_perf_straggler_ratio);
+
 namespace phi {
 namespace distributed {
 
+// The windows of a group are published to a ring of keys in the store, so
+// that the number of keys does not grow with the training.
+static const int64_t kCommPerfWindowSlots = 16;
+// A rank is reported after it is slow in so many consecutive windows.
+static const int kCommPerfStragglerWindows = 3;
+
 std::thread CommTaskManager::comm_task_loop_thread_;
 std::thread CommTaskManager::comm_task_clear_loop_thread_;
 const int64_t CommTaskManager::loop_thread_sleep_millis = 10000;
@@ -182,6 +198,7 @@ void CommTaskManager::CommTaskLoop() {
       } else {
         if (task->IsStarted()) {
           if (task->IsCompleted()) {
+            RecordCommPerf(task);
             CommTaskClearEnqueue(task);
             iter = comm_task_list_.erase(iter);
           } else {
@@ -211,6 +228,7 @@ void CommTaskManager::CommTaskLoop() {
          iter != start_comm_task_map_.end();) {
       auto task = iter->second;
       if (task->IsCompleted()) {
+        RecordCommPerf(task);
         CommTaskClearEnqueue(task);
         UpdateLastCommTask(task);
         iter = start_comm_task_map_.erase(iter);
@@ -226,6 +244,8 @@ void CommTaskManager::CommTaskLoop() {
     } else {
       done = false;
     }
+    lock.unlock();
+    ProcessCommPerf();
   }
 }
 
@@ -258,6 +278,164 @@ void CommTaskManager::CommTaskClearLoop() {
   }
 }
 
+void CommTaskManager::RecordCommPerf(const std::shared_ptr<CommTask>& task) {
+  if (!FLAGS_enable_comm_perf_trace) {
+    return;
+  }
+  // the events of the task are destroyed after it is enqueued to clear
+  CommPerfRecord record;
+  if (task->GetPerfRecord(&record)) {
+    comm_perf_records_.emplace_back(task, record);
+  }
+}
+
+void CommTaskManager::ProcessCommPerf() {
+  if (comm_perf_records_.empty()) {
+    return;
+  }
+  bool profiling = phi::RecordEvent::IsEnabled();
+  for (const auto& iter : comm_perf_records_) {
+    const auto& task = iter.first;
+    const auto& record = iter.second;
+    std::string name = CommTypeToString(task->GetCommType());
+    std::ostringstream attr;
+    attr << "group_key:" << task->GroupKey() << ",comm_count:"
+         << task->GetSeq() << ",bytes:" << record.bytes
+         << ",queue_us:" << (record.start_ns - record.enqueue_ns) / 1000
+         << ",algbw:" << record.algbw << ",busbw:" << record.busbw;
+    VLOG(3) << "comm perf: " << name << "," << attr.str()
+            << ",duration_us:" << (record.end_ns - record.start_ns) / 1000;
+    if (profiling) {
+      HostEventRecorder<CommonEvent>::GetInstance().RecordEvent(
+          name,
+          record.start_ns,
+          record.end_ns,
+          EventRole::kOrdinary,
+          TracerEventType::Communication,
+          attr.str());
+    }
+    // the sequence number of p2p is counted for each pair of ranks
+    if (task->GetCommType() != CommType::SEND &&
+        task->GetCommType() != CommType::RECV) {
+      UpdateCommPerfWindow(task, record);
+    }
+  }
+  comm_perf_records_.clear();
+  CheckCommStragglers();
+}
+
+void CommTaskManager::UpdateCommPerfWindow(
+    const std::shared_ptr<CommTask>& task, const CommPerfRecord& record) {
+  auto store = task->GetStore();
+  if (store == nullptr) {
+    return;
+  }
+  const int64_t window_size =
+      std::max<int64_t>(FLAGS_comm_perf_trace_window, 1);
+  const std::string& group_key = task->GroupKey();
+  // the sequence number starts from 1 and is the same on all ranks
+  int64_t window = static_cast<int64_t>(task->GetSeq() - 1) / window_size;
+  auto& state = comm_perf_windows_[group_key];
+  if (window < state.window) {
+    // a timeout task that completes late
+    return;
+  }
+  if (window > state.window) {
+    if (state.count > 0) {
+      double duration_us = state.duration_us / state.count;
+      double busbw = state.busbw / state.count;
+      std::string value = std::to_string(state.window) + " " +
+                          std::to_string(task->GetGlobalRank()) + " " +
+                          std::to_string(duration_us) + " " +
+                          std::to_string(busbw);
+      std::string key = "comm_perf/" + group_key + "/" +
+                        std::to_string(state.window % kCommPerfWindowSlots) +
+                        "/" + std::to_string(task->GetRank());
+      store->set(key, std::vector<uint8_t>(value.begin(), value.end()));
+      if (task->GetRank() == 0) {
+        comm_perf_pending_windows_[group_key] = {
+            state.window, task->GetSize(), store};
+      }
+    }
+    state = CommPerfWindow();
+    state.window = window;
+  }
+  state.count++;
+  state.duration_us += (record.end_ns - record.start_ns) / 1000.0;
+  state.busbw += record.busbw;
+}
+
+void CommTaskManager::CheckCommStragglers() {
+  for (auto iter = comm_perf_pending_windows_.begin();
+       iter != comm_perf_pending_windows_.end();) {
+    const std::string& group_key = iter->first;
+    const auto& pending = iter->second;
+    std::vector<int> global_ranks(pending.size);
+    std::vector<double> durations(pending.size);
+    std::vector<double> busbws(pending.size);
+    bool ready = true;
+    bool overwritten = false;
+    for (int rank = 0; rank < pending.size; ++rank) {
+      std::string key = "comm_perf/" + group_key + "/" +
+                        std::to_string(pending.window % kCommPerfWindowSlots) +
+                        "/" + std::to_string(rank);
+      if (!pending.store->check(key)) {
+        ready = false;
+        break;
+      }
+      auto value = pending.store->get(key);
+      std::istringstream is(std::string(value.begin(), value.end()));
+      int64_t window = -1;
+      is >> window >> global_ranks[rank] >> durations[rank] >> busbws[rank];
+      if (window != pending.window) {
+        ready = false;
+        overwritten = window > pending.window;
+        break;
+      }
+    }
+    if (!ready && !overwritten) {
+      ++iter;
+      continue;
+    }
+    if (ready) {
+      std::vector<double> sorted = durations;
+      std::sort(sorted.begin(), sorted.end());
+      double median = sorted[sorted.size() / 2];
+      auto& counts = comm_perf_straggler_count_[group_key];
+      counts.resize(pending.size, 0);
+      if (VLOG_IS_ON(1)) {
+        std::ostringstream msg;
+        for (int rank = 0; rank < pending.size; ++rank) {
+          msg << " global_rank:" << global_ranks[rank]
+              << ",duration_us:" << durations[rank]
+              << ",busbw:" << busbws[rank];
+        }
+        VLOG(1) << "comm perf window " << pending.window << " of group "
+                << group_key << ":" << msg.str();
+      }
+      // a straggler arrives late, so it waits less than the other ranks in
+      // the collectives
+      for (int rank = 0; rank < pending.size; ++rank) {
+        if (durations[rank] < FLAGS_comm_perf_straggler_ratio * median) {
+          counts[rank]++;
+        } else {
+          counts[rank] = 0;
+        }
+        if (counts[rank] > 0 && counts[rank] % kCommPerfStragglerWindows == 0) {
+          LOG(WARNING) << "Find straggler global_rank:" << global_ranks[rank]
+                       << " in group " << group_key << ", its mean collective "
+                       << "time " << durations[rank] << "us is less than "
+                       << FLAGS_comm_perf_straggler_ratio << " of the median "
+                       << median << "us in the last " << counts[rank]
+                       << " windows of " << FLAGS_comm_perf_trace_window
+                       << " collectives, it arrives late at the collectives.";
+        }
+      }
+    }
+    iter = comm_perf_pending_windows_.erase(iter);
+  }
+}
+
 void CommTaskManager::UpdateLastCommTask(std::shared_ptr<CommTask> task) {
   if (!task->IsUpdated()) {
     return;
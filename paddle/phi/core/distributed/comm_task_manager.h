@@ -22,6 +22,8 @@
 #include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "paddle/common/macros.h"
 #include "paddle/phi/core/distributed/comm_context.h"
@@ -56,6 +58,13 @@ class CommTaskManager {
   void CommTaskClearLoop();
   bool IsTimeout();
 
+  // collective performance trace, see FLAGS_enable_comm_perf_trace
+  void RecordCommPerf(const std::shared_ptr<CommTask>& task);
+  void ProcessCommPerf();
+  void UpdateCommPerfWindow(const std::shared_ptr<CommTask>& task,
+                            const CommPerfRecord& record);
+  void CheckCommStragglers();
+
   static std::thread comm_task_loop_thread_;
   static std::thread comm_task_clear_loop_thread_;
   static const int64_t loop_thread_sleep_millis;
@@ -83,6 +92,30 @@ class CommTaskManager {
   static std::chrono::time_point<std::chrono::steady_clock> last_update_time_;
   std::chrono::milliseconds timeout_;
   bool logged_ = false;
+
+  // mean performance of the collectives of a group in a window
+  struct CommPerfWindow {
+    int64_t window = -1;
+    int64_t count = 0;
+    double duration_us = 0;
+    double busbw = 0;
+  };
+  // the latest window published by all the ranks of a group, it is checked
+  // by the rank 0 of the group
+  struct CommPerfPendingWindow {
+    int64_t window = -1;
+    int size = 0;
+    std::shared_ptr<Store> store;
+  };
+  // records of the completed tasks, they are processed after the task list
+  // is unlocked since the store is accessed
+  std::vector<std::pair<std::shared_ptr<CommTask>, CommPerfRecord>>
+      comm_perf_records_;
+  std::unordered_map<std::string, CommPerfWindow> comm_perf_windows_;
+  std::unordered_map<std::string, CommPerfPendingWindow>
+      comm_perf_pending_windows_;
+  // number of consecutive windows in which each rank of a group is slow
+  std::unordered_map<std::string, std::vector<int>> comm_perf_straggler_count_;
 };
 
 }  // namespace distributed
@@ -14,15 +14,96 @@
 
 #include "paddle/phi/core/distributed/nccl_comm_task.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "gflags/gflags.h"
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/distributed/nccl_tools.h"
+#include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/utils/data_type.h"
 
+COMMON_DECLARE_bool(enable_comm_perf_trace);
+
 namespace phi::distributed {
 
+namespace {
+
+// The device time of a timing event is converted to the host time by its
+// elapsed time to a reference event of the device, whose host time is taken
+// when it is recorded on an idle stream. The reference event is recorded
+// again whenever a task completed after it, so the elapsed time is never
+// negative.
+struct DeviceClock {
+  gpuStream_t stream = nullptr;
+  gpuEvent_t event = nullptr;
+  uint64_t host_ns = 0;
+  std::chrono::time_point<std::chrono::steady_clock> calibrated_time;
+};
+
+std::mutex device_clock_mutex;
+std::unordered_map<int, DeviceClock> device_clocks;
+
+const DeviceClock& GetCalibratedDeviceClock(
+    int device,
+    std::chrono::time_point<std::chrono::steady_clock> completed_time) {
+  auto& clock = device_clocks[device];
+  if (clock.event != nullptr && clock.calibrated_time > completed_time) {
+    return clock;
+  }
+  if (clock.event == nullptr) {
+#ifdef PADDLE_WITH_CUDA
+    CUDA_CHECK(cudaStreamCreateWithFlags(&clock.stream, cudaStreamNonBlocking));
+    CUDA_CHECK(cudaEventCreateWithFlags(&clock.event, cudaEventDefault));
+#else  // PADDLE_WITH_HIP
+    HIP_CHECK(hipStreamCreateWithFlags(&clock.stream, hipStreamNonBlocking));
+    HIP_CHECK(hipEventCreateWithFlags(&clock.event, hipEventDefault));
+#endif
+  }
+  clock.calibrated_time = std::chrono::steady_clock::now();
+#ifdef PADDLE_WITH_CUDA
+  CUDA_CHECK(cudaEventRecord(clock.event, clock.stream));
+  CUDA_CHECK(cudaEventSynchronize(clock.event));
+#else  // PADDLE_WITH_HIP
+  HIP_CHECK(hipEventRecord(clock.event, clock.stream));
+  HIP_CHECK(hipEventSynchronize(clock.event));
+#endif
+  clock.host_ns = PosixInNsec();
+  return clock;
+}
+
+float ElapsedMillis(gpuEvent_t start, gpuEvent_t end) {
+  float ms = 0;
+#ifdef PADDLE_WITH_CUDA
+  CUDA_CHECK(cudaEventElapsedTime(&ms, start, end));
+#else  // PADDLE_WITH_HIP
+  HIP_CHECK(hipEventElapsedTime(&ms, start, end));
+#endif
+  return ms;
+}
+
+// The factors of nccl-tests, which make the bus bandwidth of all the
+// collectives comparable with the peak bandwidth of the hardware.
+double BusBandwidthFactor(CommType comm_type, int nranks) {
+  switch (comm_type) {
+    case CommType::ALLREDUCE:
+      return 2.0 * (nranks - 1) / nranks;
+    case CommType::ALLGATHER:
+    case CommType::REDUCE_SCATTER:
+    case CommType::ALLTOALL:
+    case CommType::GATHER:
+    case CommType::SCATTER:
+      return 1.0 * (nranks - 1) / nranks;
+    default:
+      return 1.0;
+  }
+}
+
+}  // namespace
+
 NCCLCommTask::NCCLCommTask(const phi::Place& place,
                            const std::string& group_key,
                            int rank,
@@ -35,7 +116,8 @@ NCCLCommTask::NCCLCommTask(const phi::Place& place,
                            ncclComm_t nccl_comm,
                            gpuStream_t stream,
                            CommType comm_type,
-                           int64_t timeout)
+                           int64_t timeout,
+                           phi::DataType dtype)
     : CommTask("NCCL",
                place,
                group_key,
@@ -50,8 +132,17 @@ NCCLCommTask::NCCLCommTask(const phi::Place& place,
       timeout_(std::chrono::milliseconds(timeout)),
       sync_op_(sync_op),
       use_calc_stream_(use_calc_stream),
+      dtype_(dtype),
+      timing_(FLAGS_enable_comm_perf_trace),
       nccl_start_event_(nullptr),
       nccl_end_event_(nullptr) {
+  if (timing_) {
+#ifdef PADDLE_WITH_CUDA
+    cuda_event_flags_ = cudaEventDefault;
+#else  // PADDLE_WITH_HIP
+    hip_event_flags_ = hipEventDefault;
+#endif
+  }
   start_trace_updated_ = false;
   start_event_created_ = false;
   end_event_created_ = false;
@@ -68,6 +159,9 @@ void NCCLCommTask::StartRecord() {
 #endif
     start_event_created_ = true;
   }
+  if (timing_) {
+    enqueue_ns_ = PosixInNsec();
+  }
 #ifdef PADDLE_WITH_CUDA
   CUDA_CHECK(cudaEventRecord(nccl_start_event_, nccl_stream_));
 #else  // PADDLE_WITH_HIP
@@ -223,10 +317,41 @@ bool NCCLCommTask::IsCompleted() {
   if (end_event_created_ && CudaEventQuery(nccl_end_event_)) {
     completed_ = true;
     updated_ = true;
+    completed_time_ = std::chrono::steady_clock::now();
   }
   return completed_;
 }
 
+bool NCCLCommTask::GetPerfRecord(CommPerfRecord* record) {
+  if (!timing_ || !completed_ || !start_event_created_ ||
+      !end_event_created_) {
+    return false;
+  }
+  backends::gpu::GPUDeviceGuard guard(place_.device);
+  std::lock_guard<std::mutex> lock(device_clock_mutex);
+  const auto& clock = GetCalibratedDeviceClock(place_.device, completed_time_);
+  auto to_host_ns = [&](gpuEvent_t event) {
+    return clock.host_ns -
+           static_cast<uint64_t>(ElapsedMillis(event, clock.event) * 1e6);
+  };
+  record->enqueue_ns = enqueue_ns_;
+  // the start event may be completed before the task is enqueued when the
+  // stream is idle, since the device clock is not exact
+  record->start_ns = std::max(to_host_ns(nccl_start_event_), enqueue_ns_);
+  record->end_ns = std::max(to_host_ns(nccl_end_event_), record->start_ns);
+
+  int64_t bytes = numel_ * static_cast<int64_t>(phi::SizeOf(dtype_));
+  // numel of allgather is the numel of the input
+  if (comm_type_ == CommType::ALLGATHER) {
+    bytes *= size_;
+  }
+  record->bytes = bytes;
+  double seconds = ElapsedMillis(nccl_start_event_, nccl_end_event_) / 1000.0;
+  record->algbw = seconds > 0 ? bytes / seconds / 1e9 : 0;
+  record->busbw = record->algbw * BusBandwidthFactor(comm_type_, size_);
+  return true;
+}
+
 void NCCLCommTask::SetUpdated(bool updated) { updated_ = updated; }
 
 bool NCCLCommTask::IsUpdated() { return updated_; }
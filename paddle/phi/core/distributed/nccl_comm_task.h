@@ -15,6 +15,7 @@
 
 #include "paddle/common/macros.h"
 #include "paddle/phi/backends/gpu/gpu_decls.h"
+#include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/distributed/comm_context.h"
 #include "paddle/phi/core/distributed/comm_task.h"
 #include "paddle/phi/core/distributed/utils.h"
@@ -45,7 +46,8 @@ class NCCLCommTask : public CommTask {
                ncclComm_t = nullptr,
                gpuStream_t = nullptr,
                CommType comm_type = CommType::UNKNOWN,
-               int64_t timeout = DefaultTimeout);
+               int64_t timeout = DefaultTimeout,
+               phi::DataType dtype = phi::DataType::UNDEFINED);
   ~NCCLCommTask() override = default;
 
   // check whether the nccl kernel started
@@ -63,6 +65,8 @@ class NCCLCommTask : public CommTask {
   void EndRecord() override;
   void ClearRecord() override;
 
+  bool GetPerfRecord(CommPerfRecord* record) override;
+
   bool CudaEventQuery(gpuEvent_t event);
 
  protected:
@@ -77,6 +81,12 @@ class NCCLCommTask : public CommTask {
 
   bool sync_op_;
   bool use_calc_stream_;
+  phi::DataType dtype_;
+
+  // timing events are used when FLAGS_enable_comm_perf_trace is set
+  bool timing_;
+  uint64_t enqueue_ns_{0};
+  std::chrono::time_point<std::chrono::steady_clock> completed_time_;
 
   bool start_event_created_;
   bool end_event_created_;
@@ -33,6 +33,20 @@ class Store {
   virtual void wait(const std::string& key);
   virtual void set(const std::string& key, const std::vector<uint8_t>& value);
 
+  // Batched get and set, which save the round trips of the keys. multi_get
+  // waits until all the keys are set, like get.
+  virtual std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys);
+  virtual void multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values);
+  // Set the key to desired_value if its value is expected_value, an empty
+  // expected_value matches a key that is not set. Returns the value of the key
+  // after the operation, which is empty if the key is still not set.
+  virtual std::vector<uint8_t> compare_set(
+      const std::string& key,
+      const std::vector<uint8_t>& expected_value,
+      const std::vector<uint8_t>& desired_value);
+
   virtual int timeout() { return _timeout; }
 
  protected:
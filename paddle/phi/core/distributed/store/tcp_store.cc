@@ -14,7 +14,13 @@
 
 #include "paddle/phi/core/distributed/store/tcp_store.h"
 
+#ifndef _WIN32
+#include <sys/epoll.h>
+#endif
+
+#include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <thread>
 
@@ -23,6 +29,8 @@
 #include "paddle/common/flags.h"
 #include "paddle/phi/core/distributed/store/tcp_utils.h"
 
+COMMON_DECLARE_int32(tcp_store_server_threads);
+
 namespace phi::distributed::detail {
 
 constexpr int INFTIME = 10000;  // 10 seconds
@@ -51,26 +59,126 @@ MasterDaemon::~MasterDaemon() {  // NOLINT
   CloseControlFd();
 }
 
+MasterDaemon::StoreShard& MasterDaemon::GetShard(const std::string& key) {
+  return _shards[std::hash<std::string>()(key) % kNumShards];
+}
+
+std::vector<uint8_t> MasterDaemon::GetValue(const std::string& key) {
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto iter = shard.store.find(key);
+  PADDLE_ENFORCE_NE(
+      iter,
+      shard.store.end(),
+      common::errors::InvalidArgument("Key %s not found in TCPStore.", key));
+  return iter->second;
+}
+
+void MasterDaemon::SetValue(const std::string& key,
+                            std::vector<uint8_t> value) {
+  auto& shard = GetShard(key);
+  std::vector<std::shared_ptr<Waiter>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.store[key] = std::move(value);
+    auto iter = shard.waiters.find(key);
+    if (iter != shard.waiters.end()) {
+      waiters = std::move(iter->second);
+      shard.waiters.erase(iter);
+    }
+  }
+  NotifyWaiters(waiters);
+}
+
+void MasterDaemon::WaitKeys(SocketType socket,
+                            Command command,
+                            std::vector<std::string> keys) {
+  auto waiter = std::make_shared<Waiter>();
+  waiter->socket = socket;
+  waiter->command = command;
+  waiter->keys = std::move(keys);
+  {
+    std::lock_guard<std::mutex> lock(_waiters_mutex);
+    _socket_waiters[socket] = waiter;
+  }
+  for (const auto& key : waiter->keys) {
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.store.find(key) == shard.store.end()) {
+      // The key can not be found in store currently. Record and check later.
+      ++waiter->remaining;
+      shard.waiters[key].emplace_back(waiter);
+    }
+  }
+  // the key may be set by other workers while the keys are checked
+  if (--waiter->remaining == 0) {
+    ReplyWaiter(waiter);
+  }
+}
+
+void MasterDaemon::NotifyWaiters(
+    const std::vector<std::shared_ptr<Waiter>>& waiters) {
+  for (const auto& waiter : waiters) {
+    if (--waiter->remaining == 0) {
+      ReplyWaiter(waiter);
+    }
+  }
+}
+
+void MasterDaemon::ReplyWaiter(const std::shared_ptr<Waiter>& waiter) {
+  std::lock_guard<std::mutex> lock(waiter->mutex);
+  if (waiter->cancelled) {
+    return;
+  }
+  VLOG(7) << "TCPStore: notify the socket: " << GetSockName(waiter->socket)
+          << " that " << waiter->keys.size() << " keys are ready.";
+  try {
+    if (waiter->command == Command::WAIT) {
+      tcputils::send_value<ReplyType>(waiter->socket, ReplyType::STOP_WAIT);
+    } else {
+      for (const auto& key : waiter->keys) {
+        tcputils::send_vector<uint8_t>(waiter->socket, GetValue(key));
+      }
+    }
+  } catch (const std::exception& ex) {
+    // the socket is closed by the worker that owns it
+    VLOG(5) << "Failed to notify the socket: " << ex.what();
+  }
+  std::lock_guard<std::mutex> waiters_lock(_waiters_mutex);
+  auto iter = _socket_waiters.find(waiter->socket);
+  if (iter != _socket_waiters.end() && iter->second == waiter) {
+    _socket_waiters.erase(iter);
+  }
+}
+
 void MasterDaemon::_do_add(SocketType socket) {
   int64_t new_value{};
   std::string key = tcputils::receive_string(socket);
   new_value = tcputils::receive_value<int64_t>(socket);
-  std::vector<uint8_t> old_value;
-  auto it = _store.find(key);
-  if (it != _store.end()) {
-    old_value = it->second;
-    char* buffer = reinterpret_cast<char*>(it->second.data());
-    size_t len = old_value.size();
-    new_value += std::stoll(std::string(buffer, len));
-  }
-
-  std::string new_value_str = std::to_string(new_value);
-  _store[key] =
-      std::vector<uint8_t>(new_value_str.begin(), new_value_str.end());
+  auto& shard = GetShard(key);
+  std::vector<std::shared_ptr<Waiter>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.store.find(key);
+    if (it != shard.store.end()) {
+      char* buffer = reinterpret_cast<char*>(it->second.data());
+      size_t len = it->second.size();
+      new_value += std::stoll(std::string(buffer, len));
+    }
+
+    std::string new_value_str = std::to_string(new_value);
+    shard.store[key] =
+        std::vector<uint8_t>(new_value_str.begin(), new_value_str.end());
+    auto iter = shard.waiters.find(key);
+    if (iter != shard.waiters.end()) {
+      waiters = std::move(iter->second);
+      shard.waiters.erase(iter);
+    }
+  }
   VLOG(8) << "TCPStore: new value (" << new_value << ") for key (" << key
           << ") " << GetSockName(socket);
   tcputils::send_value<int64_t>(socket, new_value);
-  _notify_waiting_sockets(key);
+  NotifyWaiters(waiters);
 }
 
 void MasterDaemon::_do_set(SocketType socket) {
@@ -78,33 +186,14 @@ void MasterDaemon::_do_set(SocketType socket) {
   VLOG(8) << "MasterDaemon::_do_set key(" << key << ") " << GetSockName(socket);
 
   auto value = tcputils::receive_vector<uint8_t>(socket);
-  _store[key] = value;
-  _notify_waiting_sockets(key);
-}
-
-void MasterDaemon::_notify_waiting_sockets(const std::string& key) {
-  if (_waiting_sockets.find(key) != _waiting_sockets.end()) {
-    for (auto waiting_socket : _waiting_sockets.at(key)) {
-      auto reply = ReplyType::STOP_WAIT;
-      VLOG(7) << "TCPStore: notify the socket: " << GetSockName(waiting_socket)
-              << " that key: " << key << " is ready.";
-      tcputils::send_value<ReplyType>(waiting_socket, reply);
-    }
-    _waiting_sockets.erase(key);
-  }
+  SetValue(key, std::move(value));
 }
 
 void MasterDaemon::_do_get(SocketType socket) {
   std::string key = tcputils::receive_string(socket);
   VLOG(8) << "MasterDaemon::_do_get key(" << key << ") " << GetSockName(socket);
 
-  auto iter = _store.find(key);
-  PADDLE_ENFORCE_NE(
-      iter,
-      _store.end(),
-      common::errors::InvalidArgument("Key %s not found in TCPStore.", key));
-  std::vector<uint8_t> value = iter->second;
-  tcputils::send_vector<uint8_t>(socket, value);
+  tcputils::send_vector<uint8_t>(socket, GetValue(key));
 }
 
 void MasterDaemon::_do_check(SocketType socket) {
@@ -112,12 +201,77 @@ void MasterDaemon::_do_check(SocketType socket) {
   VLOG(4) << "MasterDaemon::_do_check key(" << key << ") "
           << GetSockName(socket);
 
-  auto iter = _store.find(key);
-  if (iter != _store.end()) {
-    tcputils::send_value<ReplyType>(socket, ReplyType::READY);
-  } else {
-    tcputils::send_value<ReplyType>(socket, ReplyType::NOT_READY);
+  auto& shard = GetShard(key);
+  bool ready = false;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ready = shard.store.find(key) != shard.store.end();
+  }
+  tcputils::send_value<ReplyType>(
+      socket, ready ? ReplyType::READY : ReplyType::NOT_READY);
+}
+
+void MasterDaemon::_do_wait(SocketType socket) {
+  std::string key = tcputils::receive_string(socket);
+  VLOG(8) << "MasterDaemon::_do_wait key(" << key << ") "
+          << GetSockName(socket);
+
+  WaitKeys(socket, Command::WAIT, {key});
+}
+
+void MasterDaemon::_do_multi_get(SocketType socket) {
+  auto num_keys = tcputils::receive_value<size_t>(socket);
+  std::vector<std::string> keys(num_keys);
+  for (auto& key : keys) {
+    key = tcputils::receive_string(socket);
+  }
+  VLOG(8) << "MasterDaemon::_do_multi_get " << num_keys << " keys "
+          << GetSockName(socket);
+
+  // the values are replied when all the keys are set
+  WaitKeys(socket, Command::MULTI_GET, std::move(keys));
+}
+
+void MasterDaemon::_do_multi_set(SocketType socket) {
+  auto num_keys = tcputils::receive_value<size_t>(socket);
+  VLOG(8) << "MasterDaemon::_do_multi_set " << num_keys << " keys "
+          << GetSockName(socket);
+  for (size_t i = 0; i < num_keys; ++i) {
+    std::string key = tcputils::receive_string(socket);
+    auto value = tcputils::receive_vector<uint8_t>(socket);
+    SetValue(key, std::move(value));
+  }
+}
+
+void MasterDaemon::_do_compare_set(SocketType socket) {
+  std::string key = tcputils::receive_string(socket);
+  auto expected_value = tcputils::receive_vector<uint8_t>(socket);
+  auto desired_value = tcputils::receive_vector<uint8_t>(socket);
+  VLOG(8) << "MasterDaemon::_do_compare_set key(" << key << ") "
+          << GetSockName(socket);
+
+  auto& shard = GetShard(key);
+  std::vector<uint8_t> current_value;
+  std::vector<std::shared_ptr<Waiter>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.store.find(key);
+    bool matched = iter == shard.store.end() ? expected_value.empty()
+                                             : iter->second == expected_value;
+    if (matched) {
+      shard.store[key] = desired_value;
+      current_value = std::move(desired_value);
+      auto waiter_iter = shard.waiters.find(key);
+      if (waiter_iter != shard.waiters.end()) {
+        waiters = std::move(waiter_iter->second);
+        shard.waiters.erase(waiter_iter);
+      }
+    } else if (iter != shard.store.end()) {
+      current_value = iter->second;
+    }
   }
+  tcputils::send_vector<uint8_t>(socket, current_value);
+  NotifyWaiters(waiters);
 }
 
 #ifndef _WIN32
@@ -157,106 +311,111 @@ void MasterDaemon::CloseControlFd() { CloseHandle(ghStopEvent_); }
 void MasterDaemon::StopByControlFd() { SetEvent(ghStopEvent_); }
 #endif
 
-void MasterDaemon::_do_wait(SocketType socket) {
-  std::string key = tcputils::receive_string(socket);
-  VLOG(8) << "MasterDaemon::_do_wait key(" << key << ") "
-          << GetSockName(socket);
+void MasterDaemon::ProcessCommand(SocketType socket) {
+  VLOG(8) << "Plan to receive command from " << GetSockName(socket);
+  Command command = tcputils::receive_value<Command>(socket);
+  VLOG(7) << "TCPStore: recv command: " << static_cast<int>(command) << ".";
+
+  switch (command) {
+    case Command::ADD:
+      _do_add(socket);
+      break;
+    case Command::GET:
+      _do_get(socket);
+      break;
+    case Command::CHECK:
+      _do_check(socket);
+      break;
+    case Command::SET:
+      _do_set(socket);
+      break;
+    case Command::WAIT:
+      _do_wait(socket);
+      break;
+    case Command::MULTI_GET:
+      _do_multi_get(socket);
+      break;
+    case Command::MULTI_SET:
+      _do_multi_set(socket);
+      break;
+    case Command::COMPARE_SET:
+      _do_compare_set(socket);
+      break;
+    default:
+      VLOG(8) << "Unknown command: " << static_cast<int>(command)
+              << " from addr info:" << GetSockName(socket);
+  }
+}
 
-  auto iter = _store.find(key);
-  if (iter == _store.end()) {
-    // The key can not be found in store currently. Record and check later.
-    _waiting_sockets[key].emplace_back(socket);
+void MasterDaemon::CloseSocket(SocketType socket) {
+  std::shared_ptr<Waiter> waiter;
+  {
+    std::lock_guard<std::mutex> lock(_waiters_mutex);
+    auto iter = _socket_waiters.find(socket);
+    if (iter != _socket_waiters.end()) {
+      waiter = iter->second;
+      _socket_waiters.erase(iter);
+    }
+  }
+  if (waiter != nullptr) {
+    // a notifying worker either has replied or will skip the waiter, so the
+    // socket is not used after it is closed
+    std::lock_guard<std::mutex> lock(waiter->mutex);
+    waiter->cancelled = true;
+    for (const auto& key : waiter->keys) {
+      auto& shard = GetShard(key);
+      std::lock_guard<std::mutex> shard_lock(shard.mutex);
+      auto iter = shard.waiters.find(key);
+      if (iter == shard.waiters.end()) {
+        continue;
+      }
+      auto& waiters = iter->second;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter),
+                    waiters.end());
+      if (waiters.empty()) {
+        shard.waiters.erase(iter);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(_sockets_mutex);
+  auto iter = std::find(_sockets.begin(), _sockets.end(), socket);
+  if (iter != _sockets.end()) {
+    _sockets.erase(iter);
+  }
+  tcputils::close_socket(socket);
+}
+
+static void LogSocketException(const std::exception& ex) {
+  std::string s(ex.what());
+  if (s.find("TCP connection reset by peer") != std::string::npos) {
+    VLOG(5) << "TCP connection reset by peer";
   } else {
-    auto reply = ReplyType::STOP_WAIT;
-    VLOG(7) << "TCPStore: wait reply (" << static_cast<int>(reply)
-            << ") for key (" << key << ").";
-    tcputils::send_value<ReplyType>(socket, reply);
+    VLOG(5) << "Meet some exceptions during run:" << ex.what();
   }
 }
 
+#ifdef _WIN32
 void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds) {
   std::vector<struct pollfd>& fds = *p_fds;
-  // FIXME(gongwb): Don't loop all fds of set just the fds who have event.
-#ifdef _WIN32
   // 0: listen socket, so loop from 1.
   for (size_t i = 1; i < fds.size(); i++) {
-#else
-  // 0: listen socket, 1:controller pipe, so loop from 2.
-  for (uint i = 2; i < fds.size(); i++) {
-#endif
+    if (fds[i].revents == 0) {
+      continue;
+    }
     try {
-      if (fds[i].revents == 0) {
-        continue;
-      }
-
-      VLOG(8) << "Plan to receive command from " << GetSockName(fds[i].fd);
-      Command command = tcputils::receive_value<Command>(fds[i].fd);
-      VLOG(7) << "TCPStore: recv command: " << static_cast<int>(command) << ".";
-
-      switch (command) {
-        case Command::ADD:
-          _do_add(fds[i].fd);
-          break;
-        case Command::GET:
-          _do_get(fds[i].fd);
-          break;
-        case Command::CHECK:
-          _do_check(fds[i].fd);
-          break;
-        case Command::SET:
-          _do_set(fds[i].fd);
-          break;
-        case Command::WAIT:
-          _do_wait(fds[i].fd);
-          break;
-        default:
-          VLOG(8) << "Unknown command: " << static_cast<int>(command)
-                  << " from addr info:" << GetSockName(fds[i].fd);
-      }
+      ProcessCommand(fds[i].fd);
     } catch (const std::exception& ex) {
-      auto map_iter = _waiting_sockets.begin();
-      while (map_iter != _waiting_sockets.end()) {
-        auto vec_iter = map_iter->second.begin();
-        while (vec_iter != map_iter->second.end()) {
-          if (*vec_iter == fds[i].fd) {
-            vec_iter = map_iter->second.erase(vec_iter);
-          } else {
-            ++vec_iter;
-          }
-        }
-        if (map_iter->second.empty()) {
-          map_iter = _waiting_sockets.erase(map_iter);
-        } else {
-          ++map_iter;
-        }
-      }
-
-      tcputils::close_socket(fds[i].fd);
+      CloseSocket(fds[i].fd);
       fds.erase(fds.begin() + i);
-#ifdef _WIN32
-      _sockets.erase(_sockets.begin() + i - 1);
-#else
-      _sockets.erase(_sockets.begin() + i - 2);
-#endif
-      std::string s(ex.what());
-      if (s.find("TCP connection reset by peer") != std::string::npos) {
-        VLOG(5) << "TCP connection reset by peer";
-      } else {
-        VLOG(5) << "Meet some exceptions during run:" << ex.what();
-      }
+      LogSocketException(ex);
     }
   }
 }
 
 void MasterDaemon::run() {
   std::vector<struct pollfd> fds;
-#ifdef _WIN32
   fds.push_back({_listen_socket, POLLIN});
-#else
-  fds.push_back({.fd = _listen_socket, .events = POLLIN, .revents = 0});
-  fds.push_back(
-      {.fd = _control_fd[0], .events = POLLIN | POLLHUP, .revents = 0});
-#endif
 
   bool finished = false;
   while (!finished) {
@@ -266,7 +425,6 @@ void MasterDaemon::run() {
 
     VLOG(9) << "begin to poll fds_size:"
             << paddle::string::Sprintf("%d", fds.size());
-#ifdef _WIN32
     int res = ::WSAPoll(fds.data(), fds.size(), INFTIME);
     if (res == 0) {
       auto rv = WaitForSingleObject(ghStopEvent_, 0);
@@ -276,7 +434,79 @@ void MasterDaemon::run() {
       }
       continue;
     }
+
+    // accept connect request.
+    if (fds[0].revents != 0) {
+      auto socket = tcputils::tcp_accept(_listen_socket);
+      {
+        std::lock_guard<std::mutex> lock(_sockets_mutex);
+        _sockets.emplace_back(socket);
+      }
+      fds.push_back({socket, POLLIN});
+    }
+
+    ProcessCommands(&fds);
+  }
+}
 #else
+void MasterDaemon::WorkerLoop(int epoll_fd) {
+  constexpr int kMaxEvents = 64;
+  std::array<struct epoll_event, kMaxEvents> events;
+  while (true) {
+    int num_events = ::epoll_wait(epoll_fd, events.data(), kMaxEvents, INFTIME);
+    if (num_events < 0) {
+      PADDLE_ENFORCE_EQ(
+          errno,
+          EINTR,
+          common::errors::Fatal("epoll_wait of TCPStore failed errno:%d",
+                                errno));
+      continue;
+    }
+    for (int i = 0; i < num_events; ++i) {
+      SocketType socket = events[i].data.fd;
+      // The control pipe receive shutdown event.
+      if (socket == _control_fd[0]) {
+        return;
+      }
+      try {
+        ProcessCommand(socket);
+      } catch (const std::exception& ex) {
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+        CloseSocket(socket);
+        LogSocketException(ex);
+      }
+    }
+  }
+}
+
+void MasterDaemon::run() {
+  const int num_workers = std::max(FLAGS_tcp_store_server_threads, 1);
+  for (int i = 0; i < num_workers; ++i) {
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    PADDLE_ENFORCE_NE(
+        epoll_fd,
+        -1,
+        common::errors::Fatal("failed to create epoll errno:%d", errno));
+    // all the workers quit when the write end of the control pipe is closed
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLHUP;
+    event.data.fd = _control_fd[0];
+    PADDLE_ENFORCE_NE(
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, _control_fd[0], &event),
+        -1,
+        common::errors::Fatal("failed to add control pipe to epoll errno:%d",
+                              errno));
+    _worker_epoll_fds.push_back(epoll_fd);
+    _worker_threads.emplace_back(&MasterDaemon::WorkerLoop, this, epoll_fd);
+  }
+
+  std::array<struct pollfd, 2> fds;
+  fds[0] = {.fd = _listen_socket, .events = POLLIN, .revents = 0};
+  fds[1] = {.fd = _control_fd[0], .events = POLLIN | POLLHUP, .revents = 0};
+  size_t next_worker = 0;
+  while (true) {
+    fds[0].revents = 0;
+    fds[1].revents = 0;
     ::poll(fds.data(), fds.size(), INFTIME);
 
     VLOG(9) << "begin to fds[1].revents:"
@@ -289,25 +519,40 @@ void MasterDaemon::run() {
       }
       VLOG(0)
           << "receive shutdown event and so quit from MasterDaemon run loop";
-      finished = true;  // NOLINT
       break;
     }
-#endif
 
-    // accept connect request.
+    // accept connect request, the sockets are distributed to the workers in
+    // turn.
     if (fds[0].revents != 0) {
       auto socket = tcputils::tcp_accept(_listen_socket);
-      _sockets.emplace_back(socket);
-#ifdef _WIN32
-      fds.push_back({socket, POLLIN});
-#else
-      fds.push_back({.fd = socket, .events = POLLIN, .revents = 0});
-#endif
+      {
+        std::lock_guard<std::mutex> lock(_sockets_mutex);
+        _sockets.emplace_back(socket);
+      }
+      struct epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.fd = socket;
+      PADDLE_ENFORCE_NE(
+          ::epoll_ctl(_worker_epoll_fds[next_worker],
+                      EPOLL_CTL_ADD,
+                      socket,
+                      &event),
+          -1,
+          common::errors::Fatal("failed to add socket to epoll errno:%d",
+                                errno));
+      next_worker = (next_worker + 1) % _worker_epoll_fds.size();
     }
+  }
 
-    ProcessCommands(&fds);
+  for (auto& thread : _worker_threads) {
+    thread.join();
+  }
+  for (int epoll_fd : _worker_epoll_fds) {
+    ::close(epoll_fd);
   }
 }
+#endif
 
 std::unique_ptr<TCPServer> TCPServer::create(uint16_t port,
                                              int nranks,
@@ -333,6 +578,10 @@ void TCPClient::send_command_for_key(Command type, const std::string& key) {
   tcputils::send_string(_socket, key);
 }
 
+void TCPClient::send_string(const std::string& value) {
+  tcputils::send_string(_socket, value);
+}
+
 template <typename T>
 void TCPClient::send_value(const T& value) {
   tcputils::send_bytes<T>(_socket, &value, 1);
@@ -364,6 +613,8 @@ TCPStore::TCPStore(std::string host,
                    size_t num_workers,
                    int timeout)
     : Store(timeout),
+      _host(host),
+      _port(port),
       _is_master(is_master),
       _num_workers(static_cast<int>(num_workers)) {
   _timeout = timeout;
@@ -422,6 +673,7 @@ void TCPStore::waitWorkers() {
 
 int64_t TCPStore::add(const std::string& key, int64_t value) {
   VLOG(7) << "TCPStore add.";
+  std::lock_guard<std::mutex> lock(_client_mutex);
   _client->send_command_for_key(Command::ADD, _key_prefix + key);
   _client->send_value<std::int64_t>(value);
   return _client->receive_value<std::int64_t>();
@@ -429,18 +681,21 @@ int64_t TCPStore::add(const std::string& key, int64_t value) {
 
 void TCPStore::set(const std::string& key, const std::vector<uint8_t>& value) {
   VLOG(7) << "TCPStore set.";
+  std::lock_guard<std::mutex> lock(_client_mutex);
   _client->send_command_for_key(Command::SET, _key_prefix + key);
   _client->send_vector<uint8_t>(value);
 }
 
 std::vector<uint8_t> TCPStore::get(const std::string& key) {
   wait(key);
+  std::lock_guard<std::mutex> lock(_client_mutex);
   _client->send_command_for_key(Command::GET, _key_prefix + key);
   VLOG(7) << "TCPStore get.";
   return _client->receive_vector<uint8_t>();
 }
 
 bool TCPStore::check(const std::string& key) {
+  std::lock_guard<std::mutex> lock(_client_mutex);
   _client->send_command_for_key(Command::CHECK, _key_prefix + key);
   VLOG(3) << "TCPStore check.";
   auto response = _client->receive_value<ReplyType>();
@@ -451,11 +706,74 @@ bool TCPStore::check(const std::string& key) {
   }
 }
 
+std::vector<std::vector<uint8_t>> TCPStore::multi_get(
+    const std::vector<std::string>& keys) {
+  VLOG(7) << "TCPStore multi_get.";
+  std::lock_guard<std::mutex> lock(_client_mutex);
+  _client->send_command_for_key(Command::MULTI_GET, "");
+  _client->send_value<size_t>(keys.size());
+  for (const auto& key : keys) {
+    _client->send_string(_key_prefix + key);
+  }
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    values.emplace_back(_client->receive_vector<uint8_t>());
+  }
+  return values;
+}
+
+void TCPStore::multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values) {
+  PADDLE_ENFORCE_EQ(keys.size(),
+                    values.size(),
+                    common::errors::InvalidArgument(
+                        "The number of keys (%d) and values (%d) of multi_set "
+                        "must be the same.",
+                        keys.size(),
+                        values.size()));
+  VLOG(7) << "TCPStore multi_set.";
+  std::lock_guard<std::mutex> lock(_client_mutex);
+  _client->send_command_for_key(Command::MULTI_SET, "");
+  _client->send_value<size_t>(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    _client->send_string(_key_prefix + keys[i]);
+    _client->send_vector<uint8_t>(values[i]);
+  }
+}
+
+std::vector<uint8_t> TCPStore::compare_set(
+    const std::string& key,
+    const std::vector<uint8_t>& expected_value,
+    const std::vector<uint8_t>& desired_value) {
+  VLOG(7) << "TCPStore compare_set.";
+  std::lock_guard<std::mutex> lock(_client_mutex);
+  _client->send_command_for_key(Command::COMPARE_SET, _key_prefix + key);
+  _client->send_vector<uint8_t>(expected_value);
+  _client->send_vector<uint8_t>(desired_value);
+  return _client->receive_vector<uint8_t>();
+}
+
 void TCPStore::wait(const std::string& key) {
   ReplyType reply;  // NOLINT
   VLOG(7) << "TCPStore wait.";
-  _client->send_command_for_key(Command::WAIT, _key_prefix + key);
-  reply = _client->receive_value<ReplyType>();
+  std::unique_ptr<detail::TCPClient> wait_client;
+  {
+    std::lock_guard<std::mutex> lock(_wait_clients_mutex);
+    if (!_wait_clients.empty()) {
+      wait_client = std::move(_wait_clients.back());
+      _wait_clients.pop_back();
+    }
+  }
+  if (!wait_client) {
+    wait_client = detail::TCPClient::connect(_host, _port);
+  }
+  wait_client->send_command_for_key(Command::WAIT, _key_prefix + key);
+  reply = wait_client->receive_value<ReplyType>();
+  {
+    std::lock_guard<std::mutex> lock(_wait_clients_mutex);
+    _wait_clients.emplace_back(std::move(wait_client));
+  }
   PADDLE_ENFORCE_EQ(
       reply == ReplyType::STOP_WAIT,
       true,
@@ -24,11 +24,14 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "paddle/phi/core/distributed/store/socket.h"
 #include "paddle/phi/core/distributed/store/store.h"
@@ -38,10 +41,25 @@ namespace phi {
 namespace distributed {
 
 enum class ReplyType { WAITING, STOP_WAIT, READY, NOT_READY };
-enum class Command { ADD, GET, CHECK, SET, WAIT, STOP };
+enum class Command {
+  ADD,
+  GET,
+  CHECK,
+  SET,
+  WAIT,
+  STOP,
+  MULTI_GET,
+  MULTI_SET,
+  COMPARE_SET
+};
 
 namespace detail {
 
+// The master of TCPStore. On Linux, the listen socket is served by the
+// background thread and the connected sockets are distributed to
+// FLAGS_tcp_store_server_threads worker threads, each of which waits for
+// its sockets by epoll. The keys are sharded by hash, so that the workers
+// mostly lock different shards.
 class MasterDaemon {
  public:
   static std::unique_ptr<MasterDaemon> start(SocketType listen_socket,
@@ -54,22 +72,62 @@ class MasterDaemon {
   ~MasterDaemon();
 
  private:
+  // A socket that waits for some keys, it is replied when all the keys are
+  // set. A client sends one command at a time, so a socket has at most one
+  // waiter.
+  struct Waiter {
+    SocketType socket;
+    Command command;  // WAIT or MULTI_GET
+    std::vector<std::string> keys;
+    // the number of keys not set, plus one before all keys are checked
+    std::atomic<int> remaining{1};
+    std::mutex mutex;
+    bool cancelled = false;
+  };
+
+  struct StoreShard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<uint8_t>> store;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Waiter>>>
+        waiters;
+  };
+  static constexpr size_t kNumShards = 64;
+
   void run();
+  void ProcessCommand(SocketType socket);
+  void CloseSocket(SocketType socket);
+#ifdef _WIN32
   void ProcessCommands(std::vector<struct pollfd>* p_fds);
+#else
+  void WorkerLoop(int epoll_fd);
+#endif
   void _do_add(SocketType socket);
   void _do_wait(SocketType socket);
   void _do_get(SocketType socket);
   void _do_check(SocketType socket);
   void _do_set(SocketType socket);
-  void _notify_waiting_sockets(const std::string&);
+  void _do_multi_get(SocketType socket);
+  void _do_multi_set(SocketType socket);
+  void _do_compare_set(SocketType socket);
+
+  StoreShard& GetShard(const std::string& key);
+  std::vector<uint8_t> GetValue(const std::string& key);
+  void SetValue(const std::string& key, std::vector<uint8_t> value);
+  void WaitKeys(SocketType socket,
+                Command command,
+                std::vector<std::string> keys);
+  void NotifyWaiters(const std::vector<std::shared_ptr<Waiter>>& waiters);
+  void ReplyWaiter(const std::shared_ptr<Waiter>& waiter);
+
   SocketType _listen_socket;
+  std::mutex _sockets_mutex;
   std::vector<SocketType> _sockets;
-  std::unordered_map<std::string, std::vector<uint8_t>> _store;
+  std::array<StoreShard, kNumShards> _shards;
+  std::mutex _waiters_mutex;
+  std::unordered_map<SocketType, std::shared_ptr<Waiter>> _socket_waiters;
   std::thread _background_thread{};
   int _nranks = -1;
   int _timeout = 0;
-  std::unordered_map<std::string, std::vector<SocketType>>
-      _waiting_sockets;  // key -> list of waiting sockets
 
   void InitControlFd();
   void CloseControlFd();
@@ -78,6 +136,8 @@ class MasterDaemon {
   HANDLE ghStopEvent_{};
 #else
   std::array<int, 2> _control_fd{{-1, -1}};
+  std::vector<std::thread> _worker_threads;
+  std::vector<int> _worker_epoll_fds;
 #endif
 };
 
@@ -99,6 +159,7 @@ class TCPClient {
                                             uint16_t port);
   ~TCPClient() { tcputils::close_socket(_socket); }
   void send_command_for_key(Command type, const std::string& key);
+  void send_string(const std::string& value);
 
   template <typename T>
   void send_value(const T& value);
@@ -134,11 +195,29 @@ class TCPStore : public Store {
   bool check(const std::string& key) override;
   void wait(const std::string& key) override;
   void set(const std::string& key, const std::vector<uint8_t>& value) override;
+  std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys) override;
+  void multi_set(const std::vector<std::string>& keys,
+                 const std::vector<std::vector<uint8_t>>& values) override;
+  std::vector<uint8_t> compare_set(
+      const std::string& key,
+      const std::vector<uint8_t>& expected_value,
+      const std::vector<uint8_t>& desired_value) override;
 
  private:
   void waitWorkers();
   std::unique_ptr<detail::TCPServer> _server;
   std::unique_ptr<detail::TCPClient> _client;
+  // a command and its reply must not be interleaved with the ones of other
+  // threads on the same socket
+  std::mutex _client_mutex;
+  // wait blocks until the key is set, so every concurrent wait takes a
+  // connection of its own, which does not hold the other commands back, the
+  // idle ones are kept for the later waits
+  std::vector<std::unique_ptr<detail::TCPClient>> _wait_clients;
+  std::mutex _wait_clients_mutex;
+  std::string _host;
+  uint16_t _port;
 
   const std::string _init_key = "init/";
   const std::string _key_prefix = "/";
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <functional>
 #include <iterator>
 #include <utility>
 
@@ -153,6 +154,16 @@ class KernelContext {
   size_t OutputsSize() const { return outputs_.size(); }
   size_t AttrsSize() const { return attrs_.size(); }
 
+  /// \brief Makes the kernels called on the context bind their arguments
+  /// in the context into *call instead of running, so that *call runs the
+  /// kernel without unpacking the context again. *call is left empty by the
+  /// kernels whose arguments are not kept by the context, e.g. the optional
+  /// tensors, see KernelImpl::Bind. nullptr resets the context to run the
+  /// kernels.
+  void SetBindTarget(std::function<void()>* call) { bind_target_ = call; }
+
+  std::function<void()>* BindTarget() const { return bind_target_; }
+
   void ClearInputOutput() {
     inputs_.clear();
     input_range_.clear();
@@ -170,6 +181,8 @@ class KernelContext {
   paddle::small_vector<std::pair<int, int>, kInputSmallVectorSize> input_range_;
   paddle::small_vector<std::pair<int, int>, kOutputSmallVectorSize>
       output_range_;
+
+  std::function<void()>* bind_target_{nullptr};
 };
 
 }  // namespace phi
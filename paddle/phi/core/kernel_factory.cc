@@ -34,6 +34,7 @@ PHI_DEFINE_EXPORTED_bool(use_stride_kernel,
 
 COMMON_DECLARE_int32(low_precision_op_list);
 COMMON_DECLARE_bool(enable_api_kernel_fallback);
+COMMON_DECLARE_bool(enable_kernel_selection_cache);
 PD_DECLARE_bool(run_kp_kernel);
 namespace phi {
 
@@ -408,6 +409,41 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
   return {kernel_iter->second, false, false};
 }
 
+KernelResult KernelSelectionCache::Select(const char* kernel_name,
+                                          const KernelKey& kernel_key,
+                                          bool use_strided_kernel) {
+  auto& kernel_factory = KernelFactory::Instance();
+  if (!FLAGS_enable_kernel_selection_cache) {
+    return kernel_factory.SelectKernelOrThrowError(
+        kernel_name, kernel_key, use_strided_kernel);
+  }
+  uint64_t kernels_version = kernel_factory.kernels_version();
+  uint32_t selection_flags =
+      static_cast<uint32_t>(use_strided_kernel) |
+      static_cast<uint32_t>(FLAGS_use_stride_kernel) << 1 |
+      static_cast<uint32_t>(FLAGS_enable_api_kernel_fallback) << 2 |
+      static_cast<uint32_t>(FLAGS_run_kp_kernel) << 3;
+  for (const auto& entry : entries_) {
+    if (entry.kernels_version == kernels_version &&
+        entry.selection_flags == selection_flags &&
+        entry.kernel_key == kernel_key) {
+      return {*entry.kernel, entry.has_fallback_cpu, entry.is_stride_kernel};
+    }
+  }
+
+  KernelResult kernel_result = kernel_factory.SelectKernelOrThrowError(
+      kernel_name, kernel_key, use_strided_kernel);
+  Entry& entry = entries_[next_entry_];
+  next_entry_ = (next_entry_ + 1) % kNumEntries;
+  entry.kernel_key = kernel_key;
+  entry.selection_flags = selection_flags;
+  entry.kernels_version = kernels_version;
+  entry.kernel = &kernel_result.kernel;
+  entry.has_fallback_cpu = kernel_result.has_fallback_cpu;
+  entry.is_stride_kernel = kernel_result.is_stride_kernel;
+  return kernel_result;
+}
+
 const KernelArgsDef& KernelFactory::GetFirstKernelArgsDef(
     const std::string& kernel_name) const {
   auto iter = kernels_.find(kernel_name);
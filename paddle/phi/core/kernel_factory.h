@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <ostream>
 #include <unordered_map>
@@ -317,8 +319,20 @@ class KernelFactory {
  public:
   static KernelFactory& Instance();
 
+  // The caller changing the kernels calls BumpKernelsVersion after the
+  // change, which invalidates the kernels cached by KernelSelectionCache.
   KernelNameMap& kernels() { return kernels_; }
 
+  const KernelNameMap& kernels() const { return kernels_; }
+
+  void BumpKernelsVersion() {
+    kernels_version_.fetch_add(1, std::memory_order_release);
+  }
+
+  uint64_t kernels_version() const {
+    return kernels_version_.load(std::memory_order_acquire);
+  }
+
   bool HasCompatiblePhiKernel(const std::string& op_type) const;
 
   bool HasStructuredKernel(const std::string& op_type) const;
@@ -352,11 +366,45 @@ class KernelFactory {
   KernelFactory() = default;
 
   KernelNameMap kernels_;
+  std::atomic<uint64_t> kernels_version_{1};
 
   // Get the low precision kernel list of current module.
   std::map<const std::string, OpCount> low_precision_kernels_;
 };
 
+/**
+ * KernelSelectionCache memoizes KernelFactory::SelectKernelOrThrowError for
+ * one call site selecting the kernels of one name, e.g. a generated api, to
+ * skip the lookups by the kernel name and the kernel key when an op is called
+ * repeatedly with the same kernel key. It is meant to be thread local, so it
+ * is not guarded by a lock. The cached kernels are dropped once the kernels
+ * of KernelFactory or the flags affecting the selection are changed, see
+ * FLAGS_enable_kernel_selection_cache.
+ */
+class KernelSelectionCache {
+ public:
+  KernelResult Select(const char* kernel_name,
+                      const KernelKey& kernel_key,
+                      bool use_strided_kernel = false);
+
+ private:
+  struct Entry {
+    KernelKey kernel_key;
+    uint32_t selection_flags{0};
+    // 0 for an empty entry
+    uint64_t kernels_version{0};
+    const Kernel* kernel{nullptr};
+    bool has_fallback_cpu{false};
+    bool is_stride_kernel{false};
+  };
+
+  // The kernel keys seen by a call site are few, e.g. a float32 and a
+  // float16 one in amp training.
+  static constexpr size_t kNumEntries = 4;
+  std::array<Entry, kNumEntries> entries_;
+  size_t next_entry_{0};
+};
+
 inline std::ostream& operator<<(std::ostream& os, const KernelKey& kernel_key) {
   os << "(" << kernel_key.backend() << ", " << kernel_key.layout() << ", "
      << kernel_key.dtype() << ")";
@@ -14,6 +14,12 @@
 
 #pragma once
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/macros.h"
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/common/int_array.h"
 #include "paddle/phi/common/scalar.h"
@@ -278,6 +284,50 @@ namespace phi {
 template <typename T>
 struct TypeTag {};
 
+// The tag ending the arguments of the kernels bound to a KernelContext
+// instead of called on it.
+struct KernelBindTag {};
+
+// How the call of a kernel bound to a KernelContext keeps an argument: the
+// device context, the tensors and the attributes by their address in the
+// context, and the arguments built of the context by copy, e.g. the vectors
+// of the tensors and the outputs. The optional tensors are copies of the
+// tensors of the context, which are not bindable.
+template <typename T>
+struct KernelBoundArg {
+  static constexpr bool kBindable = true;
+  using Type = std::decay_t<T>;
+  static Type Bind(const Type& arg) { return arg; }
+  static const Type& Get(const Type& arg) { return arg; }
+};
+
+template <typename T>
+struct KernelBoundArg<const T&> {
+  static constexpr bool kBindable = true;
+  using Type = const T*;
+  static Type Bind(const T& arg) { return &arg; }
+  static const T& Get(Type arg) { return *arg; }
+};
+
+template <typename T>
+struct KernelBoundArg<const std::vector<const T*>&>
+    : KernelBoundArg<std::vector<const T*>> {};
+
+template <typename T>
+struct KernelBoundArg<const paddle::optional<T>&> {
+  static constexpr bool kBindable = false;
+};
+
+template <typename T>
+struct KernelBoundArg<const paddle::optional<std::vector<const T*>>&>
+    : KernelBoundArg<paddle::optional<std::vector<const T*>>> {};
+
+template <>
+struct KernelBoundArg<const Scalar&> : KernelBoundArg<Scalar> {};
+
+template <>
+struct KernelBoundArg<const IntArray&> : KernelBoundArg<IntArray> {};
+
 template <typename Fn, Fn fn>
 struct KernelImpl;
 
@@ -287,6 +337,10 @@ template <typename Return,
           Return (*kernel_fn)(DevCtx, Args...)>
 struct KernelImpl<Return (*)(DevCtx, Args...), kernel_fn> {
   static void Compute(KernelContext* ctx) {
+    if (UNLIKELY(ctx->BindTarget() != nullptr)) {
+      Bind(ctx);
+      return;
+    }
     KernelCallHelper<DevCtx, Args..., TypeTag<int>>::
         template Compute<0, 0, 0, 0>(ctx);
   }
@@ -296,6 +350,31 @@ struct KernelImpl<Return (*)(DevCtx, Args...), kernel_fn> {
   }
 
  private:
+  // Binds the arguments of the kernel in ctx into *ctx->BindTarget(), which
+  // is left empty if they are not bindable. See
+  // KernelContext::SetBindTarget.
+  static void Bind(KernelContext* ctx) {
+    if constexpr ((KernelBoundArg<Args>::kBindable && ...)) {
+      // The Scalar and the IntArray attributes of the tensors are read from
+      // the tensors by each call.
+      for (size_t i = 0; i < ctx->AttrsSize(); ++i) {
+        const Attribute& attr = ctx->AttrAt(i);
+        if (paddle::holds_alternative<TensorRef>(attr) ||
+            paddle::holds_alternative<std::vector<TensorRef>>(attr)) {
+          return;
+        }
+      }
+      KernelCallHelper<DevCtx, Args..., TypeTag<KernelBindTag>>::
+          template Compute<0, 0, 0, 0>(ctx);
+    }
+  }
+
+  template <typename Tuple, size_t... I>
+  static void CallBound(const Tuple& bound, std::index_sequence<I...>) {
+    kernel_fn(KernelBoundArg<DevCtx>::Get(std::get<0>(bound)),
+              KernelBoundArg<Args>::Get(std::get<I + 1>(bound))...);
+  }
+
   template <typename... RemainingArgs>
   struct KernelCallHelper;
 
@@ -399,7 +478,15 @@ struct KernelImpl<Return (*)(DevCtx, Args...), kernel_fn> {
                         Args&... args) {
       static_assert(dev_ctx_idx > 0,
                     "Kernel should pass DeviceContext as argument.");
-      return kernel_fn(dev_ctx, args...);
+      if constexpr (std::is_same<T, KernelBindTag>::value) {
+        *ctx->BindTarget() =
+            [bound = std::make_tuple(KernelBoundArg<DevCtx>::Bind(dev_ctx),
+                                     KernelBoundArg<Args>::Bind(args)...)]() {
+              CallBound(bound, std::index_sequence_for<Args...>());
+            };
+      } else {
+        return kernel_fn(dev_ctx, args...);
+      }
     }
   };
 };
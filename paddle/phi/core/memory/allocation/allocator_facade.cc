@@ -27,6 +27,7 @@
 #include "paddle/phi/core/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/phi/core/memory/allocation/retry_allocator.h"
 #include "paddle/phi/core/memory/allocation/stat_allocator.h"
+#include "paddle/phi/core/memory/allocation/step_replay_allocator.h"
 #include "paddle/phi/core/platform/device_context.h"
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -36,6 +37,9 @@
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/core/memory/allocation/cuda_allocator.h"
 #include "paddle/phi/core/memory/allocation/cuda_managed_allocator.h"
+#ifdef __linux__
+#include "paddle/phi/core/memory/allocation/numa_pinned_allocator.h"
+#endif
 #include "paddle/phi/core/memory/allocation/pinned_allocator.h"
 #include "paddle/phi/core/memory/allocation/stream_safe_cuda_allocator.h"
 #include "paddle/phi/core/memory/allocation/thread_local_allocator.h"
@@ -49,6 +53,7 @@
 
 #if CUDA_VERSION >= 10020
 #include "paddle/phi/backends/dynload/cuda_driver.h"
+#include "paddle/phi/core/memory/allocation/cuda_expandable_segment_allocator.h"
 #include "paddle/phi/core/memory/allocation/cuda_malloc_async_allocator.h"
 #include "paddle/phi/core/memory/allocation/cuda_virtual_mem_allocator.h"
 #include "paddle/phi/core/memory/allocation/virtual_memory_auto_growth_best_fit_allocator.h"
@@ -92,6 +97,37 @@ PHI_DEFINE_EXPORTED_bool(use_virtual_memory_auto_growth,
                          false,
                          "Use VirtualMemoryAutoGrowthBestFitAllocator.");
 
+PHI_DEFINE_EXPORTED_bool(
+    use_numa_pinned_allocator,
+    false,
+    "Whether to allocate the CUDA pinned memory from the NUMA node closest to "
+    "the current GPU, backed by huge pages of "
+    "FLAGS_pinned_huge_page_size_in_kb. Only available on Linux.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    pinned_huge_page_size_in_kb,
+    2048,
+    "The size of the huge pages backing the NUMA-aware pinned memory, e.g. "
+    "2048 for 2MB pages and 1048576 for 1GB pages, 0 for the normal pages. "
+    "The transparent huge pages are used if no huge page of the size is "
+    "reserved.");
+
+PHI_DEFINE_EXPORTED_bool(
+    use_expandable_segments,
+    false,
+    "Whether to allocate the GPU memory of each stream from an expandable "
+    "segment for auto_growth strategy, which maps and unmaps the pages of "
+    "one reserved virtual address range on demand to reduce the "
+    "fragmentation. The free tail of the segment beyond "
+    "FLAGS_auto_growth_chunk_size_in_mb is given back to the driver.");
+
+PHI_DEFINE_EXPORTED_bool(
+    use_step_replay_allocator,
+    false,
+    "Whether to put a StepReplayAllocator over the GPU allocators of "
+    "auto_growth strategy, which caches the buffers of the sizes repeated by "
+    "the training steps once paddle.device.set_allocator_replay enables it.");
+
 // NOTE(Ruibiao): This FLAGS is just to be compatible with
 // the old single-stream CUDA allocator. It will be removed
 // after StreamSafeCudaAllocator has been fully tested.
@@ -115,6 +151,7 @@ COMMON_DECLARE_string(allocator_strategy);
 COMMON_DECLARE_uint64(auto_growth_chunk_size_in_mb);
 COMMON_DECLARE_bool(use_auto_growth_pinned_allocator);
 COMMON_DECLARE_bool(use_cuda_malloc_async_allocator);
+COMMON_DECLARE_bool(cuda_graph_use_cuda_malloc_async_allocator);
 COMMON_DECLARE_bool(auto_free_cudagraph_allocations_on_launch);
 
 namespace paddle::memory::allocation {
@@ -196,7 +233,10 @@ class AllocatorFacadePrivate {
                std::map<phi::stream::stream_t, std::shared_ptr<Allocator>>>;
 #endif
 
-  explicit AllocatorFacadePrivate(bool allow_free_idle_chunk = true)
+  explicit AllocatorFacadePrivate(
+      bool allow_free_idle_chunk = true,
+      bool use_cuda_malloc_async_allocator =
+          FLAGS_use_cuda_malloc_async_allocator)
       :
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
         default_stream_safe_cuda_allocators_(),
@@ -265,7 +305,7 @@ class AllocatorFacadePrivate {
         // reasons. Since most Alloc calls are for default stream in
         // application, treating it separately can avoid lots of overhead of
         // acquiring default stream and applying read-write lock.
-        if (FLAGS_use_cuda_malloc_async_allocator) {
+        if (use_cuda_malloc_async_allocator) {
           PADDLE_ENFORCE_EQ(FLAGS_use_cuda_managed_memory,
                             false,
                             common::errors::InvalidArgument(
@@ -274,6 +314,9 @@ class AllocatorFacadePrivate {
           WrapCUDAMallocAsyncAllocatorForDefault();
           is_cuda_malloc_async_allocator_used_ = true;
         } else {
+          if (FLAGS_use_step_replay_allocator) {
+            WrapStepReplayAllocatorForDefault();
+          }
           if (FLAGS_use_stream_safe_cuda_allocator) {
             if (LIKELY(!IsCUDAGraphCapturing())) {
               WrapStreamSafeCUDAAllocatorForDefault();
@@ -833,6 +876,17 @@ class AllocatorFacadePrivate {
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
+#ifdef __linux__
+    if (FLAGS_use_numa_pinned_allocator) {
+      auto chunk_size = FLAGS_auto_growth_chunk_size_in_mb << 20;
+      allocators_[phi::GPUPinnedPlace()] =
+          std::make_shared<NUMAPinnedAllocator>(
+              chunk_size,
+              FLAGS_pinned_huge_page_size_in_kb << 10,
+              allow_free_idle_chunk_);
+      return;
+    }
+#endif
     if (FLAGS_use_auto_growth_pinned_allocator) {
       auto chunk_size = FLAGS_auto_growth_chunk_size_in_mb << 20;
       VLOG(4) << "FLAGS_auto_growth_chunk_size_in_mb is "
@@ -891,7 +945,7 @@ class AllocatorFacadePrivate {
             "Only support auto-growth strategy for StreamSafeCUDAAllocator, "
             "the allocator strategy %d is unsupported for multi-stream",
             static_cast<int>(strategy_)));
-    if (FLAGS_use_cuda_malloc_async_allocator) {
+    if (is_cuda_malloc_async_allocator_used_) {
       PADDLE_ENFORCE_EQ(
           FLAGS_use_cuda_managed_memory,
           false,
@@ -907,6 +961,9 @@ class AllocatorFacadePrivate {
         VLOG(8) << "Init CUDA allocator for stream " << stream << " in place "
                 << p;
         InitAutoGrowthCUDAAllocator(p, stream);
+        if (FLAGS_use_step_replay_allocator) {
+          WrapStepReplayAllocator(p, stream);
+        }
         WrapStreamSafeCUDAAllocator(p, stream);
         WrapCUDARetryAllocator(p, stream, FLAGS_gpu_allocator_retry_time);
         WrapStatAllocator(p, stream);
@@ -965,7 +1022,14 @@ class AllocatorFacadePrivate {
       val = 0;
     }
 
-    if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
+    if (val > 0 && FLAGS_use_expandable_segments) {
+      cuda_allocators_[p][stream] =
+          std::make_shared<CUDAExpandableSegmentAllocator>(
+              p,
+              platform::GpuMinChunkSize(),
+              /*retained_size=*/chunk_size,
+              allow_free_idle_chunk_);
+    } else if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
       auto cuda_allocator = std::make_shared<CUDAVirtualMemAllocator>(p);
       cuda_allocators_[p][stream] =
           std::make_shared<VirtualMemoryAutoGrowthBestFitAllocator>(
@@ -1081,7 +1145,13 @@ class AllocatorFacadePrivate {
       val = 0;
     }
 
-    if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
+    if (val > 0 && FLAGS_use_expandable_segments) {
+      allocators_[p] = std::make_shared<CUDAExpandableSegmentAllocator>(
+          p,
+          platform::GpuMinChunkSize(),
+          /*retained_size=*/chunk_size,
+          allow_free_idle_chunk);
+    } else if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
       auto cuda_allocator = std::make_shared<CUDAVirtualMemAllocator>(p);
       allocators_[p] =
           std::make_shared<VirtualMemoryAutoGrowthBestFitAllocator>(
@@ -1156,6 +1226,19 @@ class AllocatorFacadePrivate {
     allocators_[p] = std::make_shared<ThreadLocalCUDAAllocator>(p);
   }
 
+  void WrapStepReplayAllocator(phi::GPUPlace p, gpuStream_t stream) {
+    std::shared_ptr<Allocator>& allocator = cuda_allocators_[p][stream];
+    allocator = std::make_shared<StepReplayAllocator>(allocator);
+  }
+
+  void WrapStepReplayAllocatorForDefault() {
+    for (auto& pair : allocators_) {
+      if (phi::is_gpu_place(pair.first)) {
+        pair.second = std::make_shared<StepReplayAllocator>(pair.second);
+      }
+    }
+  }
+
   void WrapStreamSafeCUDAAllocator(phi::GPUPlace p, gpuStream_t stream) {
     VLOG(8) << "[StreamSafeCUDAAllocator] Init CUDA allocator for stream "
             << stream << " in place " << p;
@@ -1225,12 +1308,12 @@ class AllocatorFacadePrivate {
         common::errors::InvalidArgument(
             "Retry time should be larger than 0, but got %d", retry_time));
     std::shared_ptr<Allocator>& allocator = cuda_allocators_[p][stream];
-    allocator = std::make_shared<RetryAllocator>(allocator, retry_time);
+    allocator = std::make_shared<RetryAllocator>(allocator, retry_time, p);
   }
 
   void WrapStatAllocator(phi::GPUPlace p, gpuStream_t stream) {
     std::shared_ptr<Allocator>& allocator = cuda_allocators_[p][stream];
-    allocator = std::make_shared<StatAllocator>(allocator);
+    allocator = std::make_shared<StatAllocator>(allocator, stream);
   }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -1352,7 +1435,7 @@ class AllocatorFacadePrivate {
 
   void WrapStatAllocator(phi::XPUPlace p, XPUStream stream) {
     std::shared_ptr<Allocator>& allocator = xpu_allocators_[p][stream];
-    allocator = std::make_shared<StatAllocator>(allocator);
+    allocator = std::make_shared<StatAllocator>(allocator, stream);
   }
 
 #endif
@@ -1552,7 +1635,8 @@ class AllocatorFacadePrivate {
             "Retry time should be larger than 0, but got %d", retry_time));
     for (auto& pair : allocators_) {
       if (phi::is_gpu_place(pair.first) || phi::is_xpu_place(pair.first)) {
-        pair.second = std::make_shared<RetryAllocator>(pair.second, retry_time);
+        pair.second = std::make_shared<RetryAllocator>(
+            pair.second, retry_time, pair.first);
       }
     }
   }
@@ -1848,6 +1932,24 @@ void AllocatorFacade::PrepareMemoryPoolForCUDAGraph(int64_t id) {
 
   if (FLAGS_use_cuda_malloc_async_allocator) return;
   if (allocator.get() == nullptr) {
+#ifdef PADDLE_WITH_CUDA
+    if (FLAGS_cuda_graph_use_cuda_malloc_async_allocator) {
+      // The allocations become the memory nodes of the graph, which share
+      // the pool of the device instead of a private pool.
+      allocator = std::make_unique<AllocatorFacadePrivate>(
+          /*allow_free_idle_chunk=*/false,
+          /*use_cuda_malloc_async_allocator=*/true);
+      for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
+        phi::GPUPlace place(dev_id);
+        if (m_->IsStreamSafeCUDAAllocatorUsed()) {
+          allocator->SetDefaultStream(place, m_->GetDefaultStream(place));
+        }
+      }
+      VLOG(10) << "Create CUDAMallocAsyncAllocator for CUDA Graph with "
+               << "memory ID " << id;
+      return;
+    }
+#endif
     allocator = std::make_unique<AllocatorFacadePrivate>(
         /*allow_free_idle_chunk=*/false);
     VLOG(10) << "Create memory pool for CUDA Graph with memory ID " << id;
@@ -1899,6 +2001,16 @@ void AllocatorFacade::SetDefaultStream(const phi::XPUPlace& place,
     m_->SetDefaultStream(place, stream);
   }
 }
+
+void AllocatorFacade::RecordStream(std::shared_ptr<phi::Allocation> allocation,
+                                   XPUStream stream) {
+  GetPrivate()->RecordStream(allocation, stream);
+}
+
+XPUStream AllocatorFacade::GetStream(
+    const std::shared_ptr<phi::Allocation>& allocation) const {
+  return GetPrivate()->GetStream(allocation);
+}
 #endif
 
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
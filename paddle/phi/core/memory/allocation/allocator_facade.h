@@ -98,6 +98,8 @@ class AllocatorFacade {
   TEST_API const std::shared_ptr<Allocator>& GetAllocator(
       const phi::Place& place, XPUStream stream);
   void SetDefaultStream(const phi::XPUPlace& place, XPUStream stream);
+  void RecordStream(std::shared_ptr<Allocation> allocation, XPUStream stream);
+  XPUStream GetStream(const std::shared_ptr<Allocation>& allocation) const;
 #endif
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
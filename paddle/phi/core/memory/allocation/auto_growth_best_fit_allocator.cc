@@ -15,13 +15,16 @@
 #include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <utility>
 
 #include "paddle/common/flags.h"
 #include "paddle/phi/api/profiler/event_tracing.h"
 #include "paddle/phi/backends/device_manager.h"
 #include "paddle/phi/core/memory/allocation/aligned_allocator.h"
+#include "paddle/phi/core/memory/stats.h"
 
 PHI_DEFINE_EXPORTED_READONLY_bool(
     free_idle_chunk,
@@ -44,8 +47,65 @@ PHI_DEFINE_EXPORTED_READONLY_bool(print_allocator_trace_info,
                                   "print trace memory info");
 
 PHI_DEFINE_EXPORTED_READONLY_bool(dump_chunk_info, false, "dump chunk info");
+
+PHI_DEFINE_EXPORTED_uint64(
+    auto_growth_thread_cache_max_block_size,
+    0,
+    "The max block size (in bytes) served by the per-thread size-class cache "
+    "of AutoGrowthBestFitAllocator. 0 disables the thread cache. This flag "
+    "only works when FLAGS_allocator_strategy=auto_growth.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    auto_growth_thread_cache_capacity,
+    32 << 20,
+    "The max bytes each thread may keep in the size-class cache of one "
+    "AutoGrowthBestFitAllocator.");
+
 namespace paddle::memory::allocation {
 
+namespace {
+
+// Report thread cache hits and misses every kThreadCacheStatsInterval
+// requests, so that the stat update does not show up on the fast path.
+constexpr int64_t kThreadCacheStatsInterval = 256;
+
+std::atomic<uint64_t> g_allocator_id{0};
+
+// The caches of one thread keyed by the allocator id. The caches are marked
+// when the thread exits, so that the allocators do not pin their blocks.
+template <typename ThreadCache>
+struct ThreadCacheMap {
+  ~ThreadCacheMap() {
+    for (auto &pair : caches) {
+      pair.second->owner_exited.store(true, std::memory_order_release);
+    }
+  }
+
+  std::unordered_map<uint64_t, std::shared_ptr<ThreadCache>> caches;
+};
+
+inline size_t FloorLog2(size_t x) {
+  size_t r = 0;
+  while (x >>= 1) {
+    ++r;
+  }
+  return r;
+}
+
+void UpdateThreadCacheStats(const phi::Place &place,
+                            int64_t hits,
+                            int64_t misses) {
+  if (phi::is_cpu_place(place) || phi::is_cuda_pinned_place(place)) {
+    HOST_MEMORY_STAT_UPDATE(ThreadCacheHit, 0, hits);
+    HOST_MEMORY_STAT_UPDATE(ThreadCacheMiss, 0, misses);
+  } else {
+    DEVICE_MEMORY_STAT_UPDATE(ThreadCacheHit, place.GetDeviceId(), hits);
+    DEVICE_MEMORY_STAT_UPDATE(ThreadCacheMiss, place.GetDeviceId(), misses);
+  }
+}
+
+}  // namespace
+
 AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
     std::shared_ptr<Allocator> underlying_allocator,
     size_t alignment,
@@ -61,7 +121,188 @@ AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
   total_alloc_size_ = 0;
   total_free_times_ = 0;
   total_free_size_ = 0;
-  VLOG(4) << "chunk_size_:" << chunk_size_;
+  // Caching blocks in threads would keep chunks alive, so it is disabled when
+  // idle chunks must be freed eagerly.
+  thread_cache_max_block_size_ = FLAGS_auto_growth_thread_cache_max_block_size;
+  thread_cache_capacity_ = FLAGS_auto_growth_thread_cache_capacity;
+  use_thread_cache_ = thread_cache_max_block_size_ > 0 &&
+                      thread_cache_capacity_ > 0 && !FLAGS_free_idle_chunk;
+  if (use_thread_cache_) {
+    thread_cache_num_bins_ = 4 * (FloorLog2(thread_cache_max_block_size_) + 1);
+  }
+  allocator_id_ = g_allocator_id.fetch_add(1);
+  VLOG(4) << "chunk_size_:" << chunk_size_
+          << ", use_thread_cache_:" << use_thread_cache_;
+}
+
+AutoGrowthBestFitAllocator::~AutoGrowthBestFitAllocator() {
+  // The cached blocks belong to chunks_, which are released below. Only the
+  // bins need to be dropped, since a thread may still hold its cache.
+  std::lock_guard<SpinLock> guard(spinlock_);
+  for (auto &cache : thread_caches_) {
+    std::lock_guard<SpinLock> cache_guard(cache->lock);
+    for (auto &bin : cache->bins) {
+      bin.clear();
+    }
+    cache->cached_bytes = 0;
+    cache->allocator_destroyed.store(true, std::memory_order_release);
+  }
+  thread_caches_.clear();
+}
+
+bool AutoGrowthBestFitAllocator::GetSizeClass(size_t size,
+                                              size_t *class_size,
+                                              size_t *bin) const {
+  if (!use_thread_cache_ || size < 4 || size > thread_cache_max_block_size_) {
+    return false;
+  }
+  // Size classes are m * 2^e with m in [4, 8), i.e. four classes for each
+  // power of two, which bounds the internal fragmentation to 25%.
+  size_t e = FloorLog2(size) - 2;
+  size_t c = AlignedSize(size, static_cast<size_t>(1) << e);
+  size_t m = c >> e;
+  if (m == 8) {
+    e += 1;
+    m = 4;
+  }
+  if (c % alignment_ != 0 || c > thread_cache_max_block_size_) {
+    return false;
+  }
+  *class_size = c;
+  *bin = e * 4 + (m - 4);
+  return *bin < thread_cache_num_bins_;
+}
+
+AutoGrowthBestFitAllocator::ThreadCache *
+AutoGrowthBestFitAllocator::GetThreadCache() {
+  // Keyed by allocator_id_ instead of this, so that an allocator created at the
+  // address of a destroyed one never sees the stale cache.
+  thread_local ThreadCacheMap<ThreadCache> cache_map;
+  auto &caches = cache_map.caches;
+  auto iter = caches.find(allocator_id_);
+  if (iter != caches.end()) {
+    return iter->second.get();
+  }
+  // drop the caches of the destroyed allocators
+  for (auto it = caches.begin(); it != caches.end();) {
+    if (it->second->allocator_destroyed.load(std::memory_order_acquire)) {
+      it = caches.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto cache = std::make_shared<ThreadCache>(thread_cache_num_bins_);
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    // A new thread is a chance to take back the blocks of the exited ones.
+    PruneExitedThreadCaches();
+    thread_caches_.emplace_back(cache);
+  }
+  caches.emplace(allocator_id_, cache);
+  return cache.get();
+}
+
+phi::Allocation *AutoGrowthBestFitAllocator::AllocateFromThreadCache(
+    ThreadCache *cache, size_t bin) {
+  BlockIt block_it;
+  bool hit = false;
+  {
+    std::lock_guard<SpinLock> guard(cache->lock);
+    auto &blocks = cache->bins[bin];
+    if (!blocks.empty()) {
+      block_it = blocks.back();
+      blocks.pop_back();
+      cache->cached_bytes -= block_it->size_;
+      ++cache->pending_hits;
+      hit = true;
+    } else {
+      ++cache->pending_misses;
+    }
+  }
+  if (!hit) {
+    return nullptr;
+  }
+  ReportThreadCacheStats(cache, block_it->chunk_->allocation_->place());
+  VLOG(10) << "Alloc " << block_it->size_
+           << " bytes from thread cache, ptr = " << block_it->ptr_;
+  return new BlockAllocation(block_it);
+}
+
+bool AutoGrowthBestFitAllocator::FreeToThreadCache(ThreadCache *cache,
+                                                   size_t bin,
+                                                   BlockIt block_it) {
+  std::lock_guard<SpinLock> guard(cache->lock);
+  if (cache->cached_bytes + block_it->size_ > thread_cache_capacity_) {
+    return false;
+  }
+  cache->bins[bin].push_back(block_it);
+  cache->cached_bytes += block_it->size_;
+  return true;
+}
+
+void AutoGrowthBestFitAllocator::ReportThreadCacheStats(
+    ThreadCache *cache, const phi::Place &place) {
+  int64_t hits = 0, misses = 0;
+  {
+    std::lock_guard<SpinLock> guard(cache->lock);
+    if (cache->pending_hits + cache->pending_misses <
+        kThreadCacheStatsInterval) {
+      return;
+    }
+    std::swap(hits, cache->pending_hits);
+    std::swap(misses, cache->pending_misses);
+  }
+  UpdateThreadCacheStats(place, hits, misses);
+}
+
+uint64_t AutoGrowthBestFitAllocator::FlushThreadCaches() {
+  uint64_t bytes = 0;
+  for (auto &cache : thread_caches_) {
+    std::vector<std::vector<BlockIt>> bins;
+    {
+      std::lock_guard<SpinLock> guard(cache->lock);
+      if (cache->cached_bytes == 0) {
+        continue;
+      }
+      bins.resize(cache->bins.size());
+      bins.swap(cache->bins);
+      bytes += cache->cached_bytes;
+      cache->cached_bytes = 0;
+    }
+    for (auto &bin : bins) {
+      for (auto block_it : bin) {
+        FreeBlock(block_it);
+      }
+    }
+  }
+  if (bytes > 0) {
+    VLOG(2) << "Flush " << bytes << " bytes from thread caches";
+  }
+  PruneExitedThreadCaches();
+  return bytes;
+}
+
+void AutoGrowthBestFitAllocator::PruneExitedThreadCaches() {
+  auto first_exited =
+      std::stable_partition(thread_caches_.begin(),
+                            thread_caches_.end(),
+                            [](const std::shared_ptr<ThreadCache> &cache) {
+                              return !cache->owner_exited.load(
+                                  std::memory_order_acquire);
+                            });
+  for (auto it = first_exited; it != thread_caches_.end(); ++it) {
+    // the owner is gone, so nothing else touches the cache
+    for (auto &bin : (*it)->bins) {
+      for (auto block_it : bin) {
+        FreeBlock(block_it);
+      }
+    }
+  }
+  if (first_exited != thread_caches_.end()) {
+    VLOG(2) << "Drop " << thread_caches_.end() - first_exited
+            << " thread caches of exited threads";
+    thread_caches_.erase(first_exited, thread_caches_.end());
+  }
 }
 
 void AutoGrowthBestFitAllocator::DumpInfo() const {
@@ -96,6 +337,18 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
   VLOG(10) << "Allocate " << unaligned_size << " bytes, aligned to " << size
            << ", extra size " << extra_padding_size_;
 
+  size_t class_size = 0, bin = 0;
+  ThreadCache *cache = nullptr;
+  if (GetSizeClass(size, &class_size, &bin)) {
+    cache = GetThreadCache();
+    auto *allocation = AllocateFromThreadCache(cache, bin);
+    if (allocation != nullptr) {
+      return allocation;
+    }
+    // The block must be reusable by every request of its size class.
+    size = class_size;
+  }
+
   std::lock_guard<SpinLock> guard(spinlock_);
   auto iter = free_blocks_.lower_bound(std::make_pair(size, nullptr));
   BlockIt block_it;
@@ -126,6 +379,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
     }
 
     if (FLAGS_free_when_no_cache_hit) {
+      FlushThreadCaches();
       FreeIdleChunks();
     }
     size_t realloc_size = std::max(size, chunk_size_);
@@ -139,6 +393,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
         DumpInfo();
       }
       if (FLAGS_free_when_no_cache_hit) throw ex;
+      FlushThreadCaches();
       FreeIdleChunks();
       chunks_.emplace_back(static_unique_ptr_cast<Allocation>(
           underlying_allocator_->Allocate(realloc_size)));
@@ -167,7 +422,11 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
   ++total_alloc_times_;
   total_alloc_size_ += size;
   VLOG(10) << "Alloc " << block_it->size_ << " bytes, ptr = " << block_it->ptr_;
-  return new BlockAllocation(block_it);
+  auto *allocation = new BlockAllocation(block_it);
+  if (cache != nullptr) {
+    ReportThreadCacheStats(cache, allocation->place());
+  }
+  return allocation;
 }
 
 void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
@@ -176,13 +435,34 @@ void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
                           9 /*level*/);
   VLOG(10) << "Free " << allocation->size()
            << " bytes, ptr = " << allocation->ptr();
-  std::lock_guard<SpinLock> guard(spinlock_);
   auto block_it = static_cast<BlockAllocation *>(allocation)->block_it_;
-  auto &blocks = block_it->chunk_->blocks_;
 
+  // The block is owned by this allocation, so its size can be read without
+  // spinlock_.
+  size_t class_size = 0, bin = 0;
+  if (GetSizeClass(block_it->size_, &class_size, &bin) &&
+      class_size == block_it->size_ &&
+      FreeToThreadCache(GetThreadCache(), bin, block_it)) {
+    delete allocation;
+    return;
+  }
+
+  std::lock_guard<SpinLock> guard(spinlock_);
   total_free_times_ += 1;
   total_free_size_ += block_it->size_;
 
+  FreeBlock(block_it);
+
+  delete allocation;
+
+  if (FLAGS_free_idle_chunk) {
+    FreeIdleChunks();
+  }
+}
+
+void AutoGrowthBestFitAllocator::FreeBlock(BlockIt block_it) {
+  auto &blocks = block_it->chunk_->blocks_;
+
   block_it->is_free_ = true;
 
   if (block_it != blocks.begin()) {
@@ -208,12 +488,6 @@ void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
 
   free_blocks_.emplace(std::make_pair(block_it->size_, block_it->ptr_),
                        block_it);
-
-  delete allocation;
-
-  if (FLAGS_free_idle_chunk) {
-    FreeIdleChunks();
-  }
 }
 
 uint64_t AutoGrowthBestFitAllocator::FreeIdleChunks() {
@@ -14,11 +14,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "paddle/phi/core/memory/allocation/allocator.h"
 #include "paddle/phi/core/memory/allocation/spin_lock.h"
@@ -35,6 +37,8 @@ class AutoGrowthBestFitAllocator : public Allocator {
                              bool allow_free_idle_chunk = true,
                              int extra_padding_size = 0);
 
+  ~AutoGrowthBestFitAllocator() override;
+
   bool IsAllocThreadSafe() const override { return true; }
 
   void DumpInfo() const;
@@ -47,6 +51,7 @@ class AutoGrowthBestFitAllocator : public Allocator {
   // Release the memory block which is not used in pool.
   uint64_t ReleaseImpl(const phi::Place &place) override {
     std::lock_guard<SpinLock> guard(spinlock_);
+    FlushThreadCaches();
     return FreeIdleChunks();
   }
 
@@ -90,6 +95,56 @@ class AutoGrowthBestFitAllocator : public Allocator {
 
   using BlockIt = List<Block>::iterator;
 
+  // A per-thread segregated size-class cache in front of free_blocks_.
+  // Freed small blocks are kept in the bin of their size class, still marked
+  // as used in their chunk, so that the next allocation of the same class from
+  // this thread is served without spinlock_ and without the map lookup. Each
+  // cache has its own lock, which is only contended when the allocator flushes
+  // all caches back to free_blocks_ (out of memory or Release). Lock order is
+  // always spinlock_ -> ThreadCache::lock.
+  struct ThreadCache {
+    explicit ThreadCache(size_t num_bins) : bins(num_bins) {}
+
+    SpinLock lock;
+    std::vector<std::vector<BlockIt>> bins;
+    size_t cached_bytes{0};
+    // Hits and misses not yet reported to memory stats.
+    int64_t pending_hits{0};
+    int64_t pending_misses{0};
+    // Set when the owner thread exits, the allocator then flushes and drops
+    // the cache.
+    std::atomic<bool> owner_exited{false};
+    // Set when the allocator is destroyed, the owner thread then drops the
+    // cache.
+    std::atomic<bool> allocator_destroyed{false};
+  };
+
+  // Round size up to its size class. Returns false if the size is too large
+  // to be cached.
+  bool GetSizeClass(size_t size, size_t *class_size, size_t *bin) const;
+
+  ThreadCache *GetThreadCache();
+
+  // Try to serve an allocation of a size class from the thread cache.
+  phi::Allocation *AllocateFromThreadCache(ThreadCache *cache, size_t bin);
+
+  // Put block_it into the thread cache, returns false if the cache is full.
+  bool FreeToThreadCache(ThreadCache *cache, size_t bin, BlockIt block_it);
+
+  void ReportThreadCacheStats(ThreadCache *cache, const phi::Place &place);
+
+  // Return all blocks cached by threads to free_blocks_. spinlock_ must be
+  // held by the caller.
+  uint64_t FlushThreadCaches();
+
+  // Return the blocks cached by exited threads to free_blocks_ and drop their
+  // caches. spinlock_ must be held by the caller.
+  void PruneExitedThreadCaches();
+
+  // Mark block_it free and merge it with its free neighbours. spinlock_ must
+  // be held by the caller.
+  void FreeBlock(BlockIt block_it);
+
   std::shared_ptr<Allocator> underlying_allocator_;
   std::map<std::pair<size_t, void *>, BlockIt> free_blocks_;
   std::list<Chunk> chunks_;
@@ -98,6 +153,14 @@ class AutoGrowthBestFitAllocator : public Allocator {
   bool allow_free_idle_chunk_;
   int extra_padding_size_;
 
+  // thread cache, see ThreadCache
+  bool use_thread_cache_{false};
+  size_t thread_cache_max_block_size_{0};
+  size_t thread_cache_capacity_{0};
+  size_t thread_cache_num_bins_{0};
+  uint64_t allocator_id_{0};
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_;
+
   // stat info
   size_t total_alloc_times_;
   size_t total_alloc_size_;
@@ -41,7 +41,10 @@ AutoGrowthBestFitAllocatorV2::AutoGrowthBestFitAllocatorV2(
                                  chunk_size,
                                  true,
                                  extra_padding_size),
-      place_(place) {}
+      place_(place) {
+  // The strict matching of the warmup phase allocates without size classes.
+  use_thread_cache_ = false;
+}
 
 phi::Allocation *AutoGrowthBestFitAllocatorV2::AllocateImpl(
     size_t unaligned_size) {
@@ -0,0 +1,180 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/cuda_expandable_segment_allocator.h"
+
+#include <algorithm>
+#include <string>
+
+#include "paddle/phi/backends/dynload/cuda_driver.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/platform/cuda_device_guard.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+
+#if CUDA_VERSION >= 10020
+
+namespace paddle::memory::allocation {
+
+CUDAExpandableSegmentAllocator::CUDAExpandableSegmentAllocator(
+    const phi::GPUPlace& place,
+    size_t alignment,
+    size_t retained_size,
+    bool allow_free_tail)
+    : ExpandableSegmentAllocator(
+          phi::Place(place), alignment, retained_size, allow_free_tail),
+      place_(place),
+      virtual_mem_base_(0),
+      prop_{} {
+  // The pages are pinned device memory local to the device.
+  prop_.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  prop_.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  prop_.location.id = place.device;  // NOLINT
+
+  // The pages are visible to the device and its peers.
+  for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
+    if (place.device != dev_id) {
+      int capable = 0;
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          cudaDeviceCanAccessPeer(&capable, place.device, dev_id));
+      if (!capable) {
+        continue;
+      }
+    }
+    CUmemAccessDesc access_desc = {};
+    access_desc.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    access_desc.location.id = dev_id;
+    access_desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    access_desc_.push_back(access_desc);
+  }
+
+  // The page size is the max of the minimum granularity of the devices.
+  granularity_ = 0;
+  CUmemAllocationProp prop = prop_;
+  for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
+    size_t granularity;
+    prop.location.id = dev_id;
+    PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::cuMemGetAllocationGranularity(
+        &granularity, &prop, CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+    granularity_ = std::max(granularity, granularity_);
+  }
+
+  size_t actual_avail, actual_total;
+  paddle::platform::CUDADeviceGuard guard(place.device);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemGetInfo(&actual_avail, &actual_total));
+
+  // A stream can use at most the whole GPU memory, and the virtual address
+  // space is plenty for a segment of that size for each stream.
+  virtual_mem_size_ = AlignedSize(actual_total, granularity_);
+  PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::cuMemAddressReserve(
+      &virtual_mem_base_, virtual_mem_size_, 0, 0, 0));
+  InitSegment(reinterpret_cast<void*>(virtual_mem_base_),  // NOLINT
+              virtual_mem_size_,
+              granularity_);
+}
+
+CUDAExpandableSegmentAllocator::~CUDAExpandableSegmentAllocator() {
+  try {
+    if (!handles_.empty()) {
+      UnmapPages(0, handles_.size() * granularity_);
+    }
+    auto result =
+        phi::dynload::cuMemAddressFree(virtual_mem_base_, virtual_mem_size_);
+    if (result != CUDA_ERROR_DEINITIALIZED) {
+      PADDLE_ENFORCE_GPU_SUCCESS(result);
+    }
+  } catch (...) {
+    LOG(WARNING) << "Failed to free the expandable segment on " << place_;
+  }
+}
+
+void CUDAExpandableSegmentAllocator::MapPages(size_t offset, size_t size) {
+  paddle::platform::CUDADeviceGuard guard(place_.device);
+  CUdeviceptr ptr = virtual_mem_base_ + offset;
+  size_t num_pages = size / granularity_;
+  size_t num_mapped_pages = handles_.size();
+  auto rollback = [&] {
+    while (handles_.size() > num_mapped_pages) {
+      phi::dynload::cuMemUnmap(
+          virtual_mem_base_ + (handles_.size() - 1) * granularity_,
+          granularity_);
+      platform::RecordedGpuMemRelease(
+          handles_.back(), granularity_, place_.device);
+      handles_.pop_back();
+    }
+  };
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    CUmemGenericAllocationHandle handle;
+    auto result = platform::RecordedGpuMemCreate(
+        &handle, granularity_, &prop_, 0, place_.device);
+    if (result != CUDA_SUCCESS) {
+      rollback();
+      if (result == CUDA_ERROR_OUT_OF_MEMORY) {
+        size_t actual_avail, actual_total;
+        PADDLE_ENFORCE_GPU_SUCCESS(
+            cudaMemGetInfo(&actual_avail, &actual_total));
+        PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+            "\n\nOut of memory error on GPU %d. "
+            "Cannot map %s memory to the expandable segment on GPU %d, %s "
+            "memory has been allocated and available memory is only %s.\n\n"
+            "Please check whether there is any other process using GPU %d.\n"
+            "1. If yes, please stop them, or start PaddlePaddle on another "
+            "GPU.\n"
+            "2. If no, please decrease the batch size of your model.\n\n",
+            place_.device,
+            string::HumanReadableSize(size),
+            place_.device,
+            string::HumanReadableSize(actual_total - actual_avail),
+            string::HumanReadableSize(actual_avail),
+            place_.device));
+      }
+      PADDLE_ENFORCE_GPU_SUCCESS(result);
+    }
+    result = phi::dynload::cuMemMap(
+        ptr + i * granularity_, granularity_, 0, handle, 0);
+    if (result != CUDA_SUCCESS) {
+      platform::RecordedGpuMemRelease(handle, granularity_, place_.device);
+      rollback();
+      PADDLE_ENFORCE_GPU_SUCCESS(result);
+    }
+    handles_.push_back(handle);
+  }
+
+  auto result = phi::dynload::cuMemSetAccess(
+      ptr, size, access_desc_.data(), access_desc_.size());
+  if (result != CUDA_SUCCESS) {
+    rollback();
+    PADDLE_ENFORCE_GPU_SUCCESS(result);
+  }
+}
+
+void CUDAExpandableSegmentAllocator::UnmapPages(size_t offset, size_t size) {
+  paddle::platform::CUDADeviceGuard guard(place_.device);
+  // The pages are mapped one by one, so they are unmapped one by one.
+  while (handles_.size() > offset / granularity_) {
+    auto result = phi::dynload::cuMemUnmap(
+        virtual_mem_base_ + (handles_.size() - 1) * granularity_,
+        granularity_);
+    if (result != CUDA_ERROR_DEINITIALIZED) {
+      PADDLE_ENFORCE_GPU_SUCCESS(result);
+      PADDLE_ENFORCE_GPU_SUCCESS(platform::RecordedGpuMemRelease(
+          handles_.back(), granularity_, place_.device));
+    }
+    handles_.pop_back();
+  }
+}
+
+}  // namespace paddle::memory::allocation
+
+#endif
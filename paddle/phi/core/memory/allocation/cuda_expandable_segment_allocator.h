@@ -0,0 +1,66 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda.h>
+#include <cuda_runtime.h>
+#endif
+
+#include <vector>
+
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/memory/allocation/expandable_segment_allocator.h"
+
+#if CUDA_VERSION >= 10020
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Reserves the segment of an ExpandableSegmentAllocator as large as the GPU
+// memory, and maps it by pages of the allocation granularity, each created by
+// cuMemCreate, so that any page at the tail can be given back to the driver.
+class CUDAExpandableSegmentAllocator : public ExpandableSegmentAllocator {
+ public:
+  CUDAExpandableSegmentAllocator(const phi::GPUPlace& place,
+                                 size_t alignment,
+                                 size_t retained_size,
+                                 bool allow_free_tail);
+  ~CUDAExpandableSegmentAllocator() override;
+
+ protected:
+  void MapPages(size_t offset, size_t size) override;
+  void UnmapPages(size_t offset, size_t size) override;
+
+ private:
+  phi::GPUPlace place_;
+
+  CUdeviceptr virtual_mem_base_;
+  size_t virtual_mem_size_;
+  size_t granularity_;
+
+  CUmemAllocationProp prop_;
+  std::vector<CUmemAccessDesc> access_desc_;
+
+  // The handles of the mapped pages in order.
+  std::vector<CUmemGenericAllocationHandle> handles_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
+
+#endif
@@ -18,15 +18,24 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
 #include <cstdlib>
 
 #include <random>
 #include <string>
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/allocation/best_fit_allocator.h"
+#include "paddle/phi/core/memory/allocation/mmap_allocator.h"
 #include "paddle/phi/core/platform/cuda_device_guard.h"
 
+COMMON_DECLARE_uint64(cuda_ipc_arena_size_mb);
+
 namespace paddle::memory::allocation {
 
 namespace {
@@ -71,6 +80,235 @@ CudaIpcAllocation::~CudaIpcAllocation() {
           << "\t" << this->ptr();
 }
 
+CudaIpcArenaControl::CudaIpcArenaControl(std::string name, bool create)
+    : name_(std::move(name)), owner_(create) {
+  size_t size = kMaxSlots * sizeof(std::atomic<int32_t>);
+  int flags = create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR;
+  int fd = shm_open(name_.c_str(), flags, 0600);
+  PADDLE_ENFORCE_NE(fd,
+                    -1,
+                    common::errors::Unavailable(
+                        "Cannot open the control segment %s of the CUDA IPC "
+                        "arena, errno is %d.",
+                        name_,
+                        errno));
+  if (create) {
+    PADDLE_ENFORCE_EQ(ftruncate(fd, static_cast<off_t>(size)),
+                      0,
+                      common::errors::Unavailable(
+                          "Cannot resize the control segment %s of the CUDA "
+                          "IPC arena, errno is %d.",
+                          name_,
+                          errno));
+  }
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(ptr,
+                    MAP_FAILED,
+                    common::errors::Unavailable(
+                        "Cannot map the control segment %s of the CUDA IPC "
+                        "arena, errno is %d.",
+                        name_,
+                        errno));
+  // The new segment is filled with zeros, so every count starts at 0.
+  counts_ = static_cast<std::atomic<int32_t> *>(ptr);
+}
+
+CudaIpcArenaControl::~CudaIpcArenaControl() {
+  munmap(counts_, kMaxSlots * sizeof(std::atomic<int32_t>));
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+namespace {
+std::mutex control_mutex_;
+std::unordered_map<std::string, std::weak_ptr<CudaIpcArenaControl>>
+    name_to_control_;
+}  // namespace
+
+std::shared_ptr<CudaIpcArenaControl> GetIpcArenaControl(
+    const std::string &name) {
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  auto &cached = name_to_control_[name];
+  auto control = cached.lock();
+  if (control == nullptr) {
+    control = std::make_shared<CudaIpcArenaControl>(name, false);
+    cached = control;
+  }
+  return control;
+}
+
+// A block allocated from the arena by the sender.
+class CudaIpcArenaBlock : public Allocation {
+ public:
+  CudaIpcArenaBlock(CudaIpcArena *arena, AllocationPtr chunk, int slot)
+      : Allocation(chunk->ptr(), chunk->size(), chunk->place()),
+        arena_(arena),
+        chunk_(std::move(chunk)),
+        slot_(slot) {}
+
+  ~CudaIpcArenaBlock() override { arena_->FreeBlock(std::move(chunk_), slot_); }
+
+  CudaIpcArena *arena() const { return arena_; }
+
+  int slot() const { return slot_; }
+
+ private:
+  CudaIpcArena *arena_;
+  AllocationPtr chunk_;
+  int slot_;
+};
+
+CudaIpcArena::CudaIpcArena(int device_id, size_t size)
+    : device_id_(device_id) {
+  platform::CUDADeviceGuard guard(device_id);
+  void *ptr = nullptr;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMalloc(&ptr, size));
+  segment_ = std::make_unique<Allocation>(ptr, size, phi::GPUPlace(device_id));
+
+  cudaIpcMemHandle_t handle;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaIpcGetMemHandle(&handle, ptr));
+  handle_.assign(reinterpret_cast<char *>(&handle), CUDA_IPC_HANDLE_SIZE);
+  control_ = std::make_unique<CudaIpcArenaControl>(GetIPCName(), true);
+
+  best_fit_allocator_ = std::make_unique<BestFitAllocator>(segment_.get());
+  free_slots_.reserve(CudaIpcArenaControl::kMaxSlots);
+  for (int slot = CudaIpcArenaControl::kMaxSlots - 1; slot >= 0; --slot) {
+    free_slots_.push_back(slot);
+  }
+  VLOG(4) << "Create the CUDA IPC arena of " << size << " bytes on device "
+          << device_id;
+}
+
+CudaIpcArena::~CudaIpcArena() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exported_.clear();
+  }
+  best_fit_allocator_.reset();
+  platform::CUDADeviceGuard guard(device_id_);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(segment_->ptr()));
+}
+
+CudaIpcArena *CudaIpcArena::Instance(int device_id) {
+  static std::mutex mutex;
+  // The arenas live until the process exits, since the receivers may still
+  // use them, and device memory cannot be freed after the driver shuts down.
+  static auto *arenas = new std::unordered_map<int, CudaIpcArena *>();
+  // The control segments are unlinked at exit.
+  static std::unordered_map<int, std::string> control_names;
+  static struct Unlinker {
+    ~Unlinker() {
+      for (auto &item : control_names) {
+        shm_unlink(item.second.c_str());
+      }
+    }
+  } unlinker;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &arena = (*arenas)[device_id];
+  if (arena == nullptr) {
+    size_t size = FLAGS_cuda_ipc_arena_size_mb << 20;
+    PADDLE_ENFORCE_GT(size,
+                      0,
+                      common::errors::PreconditionNotMet(
+                          "The CUDA IPC arena is disabled, please set "
+                          "FLAGS_cuda_ipc_arena_size_mb to enable it."));
+    arena = new CudaIpcArena(device_id, size);
+    control_names[device_id] = arena->control_name();
+  }
+  return arena;
+}
+
+std::shared_ptr<phi::Allocation> CudaIpcArena::Allocate(size_t size) {
+  Collect();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_slots_.empty()) {
+    return nullptr;
+  }
+  // Keeps the next blocks aligned like the ones of cudaMalloc.
+  constexpr size_t kAlignment = 256;
+  size = (size + kAlignment - 1) / kAlignment * kAlignment;
+  AllocationPtr chunk;
+  try {
+    chunk = best_fit_allocator_->Allocate(size);
+  } catch (BadAlloc &) {
+    VLOG(4) << "The CUDA IPC arena of device " << device_id_
+            << " cannot allocate " << size << " bytes";
+    return nullptr;
+  }
+  int slot = free_slots_.back();
+  free_slots_.pop_back();
+  return std::make_shared<CudaIpcArenaBlock>(this, std::move(chunk), slot);
+}
+
+std::pair<int, size_t> CudaIpcArena::Export(
+    const std::shared_ptr<phi::Allocation> &block) {
+  auto *arena_block = dynamic_cast<CudaIpcArenaBlock *>(block.get());
+  PADDLE_ENFORCE_EQ(
+      arena_block != nullptr && arena_block->arena() == this,
+      true,
+      common::errors::InvalidArgument(
+          "Only the blocks of the CUDA IPC arena can be exported by it."));
+  int slot = arena_block->slot();
+  // Counted before the descriptor is sent, so the receiver cannot release
+  // it first.
+  control_->refcount(slot).fetch_add(1);
+  std::lock_guard<std::mutex> lock(mutex_);
+  exported_.emplace(slot, block);
+  size_t offset = static_cast<char *>(block->ptr()) -
+                  static_cast<char *>(segment_->ptr());
+  return {slot, offset};
+}
+
+size_t CudaIpcArena::Collect() {
+  std::vector<std::shared_ptr<phi::Allocation>> released;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = exported_.begin(); it != exported_.end();) {
+      if (control_->refcount(it->first).load() <= 0) {
+        released.emplace_back(std::move(it->second));
+        it = exported_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // Freed out of the lock, which FreeBlock takes.
+  size_t num_released = released.size();
+  released.clear();
+  return num_released;
+}
+
+bool CudaIpcArena::Contains(const phi::Allocation *allocation) const {
+  auto *arena_block = dynamic_cast<const CudaIpcArenaBlock *>(allocation);
+  return arena_block != nullptr && arena_block->arena() == this;
+}
+
+size_t CudaIpcArena::NumExported() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return exported_.size();
+}
+
+void CudaIpcArena::FreeBlock(AllocationPtr chunk, int slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  chunk.reset();
+  control_->refcount(slot).store(0);
+  free_slots_.push_back(slot);
+}
+
+CudaIpcArenaAllocation::~CudaIpcArenaAllocation() {
+  // The sender may reuse the block once it is released, so the kernels of
+  // the receiver reading it have to finish first.
+  auto *dev_ctx = static_cast<phi::GPUContext *>(
+      phi::DeviceContextPool::Instance().Get(place()));
+  dev_ctx->Wait();
+  control_->refcount(slot_).fetch_sub(1);
+  VLOG(6) << "Release the block of slot " << slot_ << " of the CUDA IPC arena "
+          << control_->name();
+}
+
 }  // namespace paddle::memory::allocation
 
 #endif
@@ -15,11 +15,14 @@
 #ifndef _WIN32
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/memory/allocation/allocator.h"
@@ -51,6 +54,110 @@ class CudaIpcAllocation : public Allocation {
   std::shared_ptr<void> shared_ptr_;
 };
 
+// The reference counts of the blocks of a CudaIpcArena, in a shared memory
+// segment mapped by the sender and by the receivers. Each block shared owns
+// a slot, counting the descriptors sent and not released yet.
+class CudaIpcArenaControl {
+ public:
+  static constexpr int kMaxSlots = 16384;
+
+  // The sender creates the segment, and unlinks it when destroyed. The
+  // receivers open the existing one.
+  CudaIpcArenaControl(std::string name, bool create);
+  ~CudaIpcArenaControl();
+
+  std::atomic<int32_t> &refcount(int slot) { return counts_[slot]; }
+
+  const std::string &name() const { return name_; }
+
+ private:
+  std::string name_;
+  bool owner_;
+  std::atomic<int32_t> *counts_{nullptr};
+};
+
+// Maps the control segment of a sender once per receiver.
+std::shared_ptr<CudaIpcArenaControl> GetIpcArenaControl(
+    const std::string &name);
+
+//
+// A device segment exported once by cudaIpcGetMemHandle. The tensors shared
+// through it are sent as (arena, offset, size) descriptors, so a receiver
+// opens the IPC handle of the arena only once instead of once per tensor.
+//
+// The blocks are freed across processes by the control segment: Export
+// counts one reference for each descriptor sent, the receivers release it
+// when their tensor is freed, and the sender keeps the block alive until no
+// reference is left. The released blocks are collected by the next
+// allocation of the sender.
+//
+class CudaIpcArena {
+ public:
+  CudaIpcArena(int device_id, size_t size);
+  ~CudaIpcArena();
+
+  // The arena of the device, sized by FLAGS_cuda_ipc_arena_size_mb.
+  static CudaIpcArena *Instance(int device_id);
+
+  // Returns nullptr when the arena is full.
+  std::shared_ptr<phi::Allocation> Allocate(size_t size);
+
+  // Counts one more receiver of the block, and returns its slot and its
+  // offset in the arena.
+  std::pair<int, size_t> Export(const std::shared_ptr<phi::Allocation> &block);
+
+  // Drops the exported blocks released by all their receivers, and returns
+  // the number of them.
+  size_t Collect();
+
+  bool Contains(const phi::Allocation *allocation) const;
+
+  size_t NumExported() const;
+
+  const std::string &handle() const { return handle_; }
+
+  const std::string &control_name() const { return control_->name(); }
+
+  int device_id() const { return device_id_; }
+
+ private:
+  friend class CudaIpcArenaBlock;
+
+  void FreeBlock(AllocationPtr chunk, int slot);
+
+  int device_id_;
+  std::unique_ptr<Allocation> segment_;
+  std::string handle_;
+  std::unique_ptr<CudaIpcArenaControl> control_;
+  mutable std::mutex mutex_;
+  std::unique_ptr<Allocator> best_fit_allocator_;
+  std::vector<int> free_slots_;
+  std::unordered_map<int, std::shared_ptr<phi::Allocation>> exported_;
+};
+
+// A block of the arena of another process, which releases its slot when
+// freed.
+class CudaIpcArenaAllocation : public Allocation {
+ public:
+  CudaIpcArenaAllocation(void *ptr,
+                         size_t size,
+                         int device_id,
+                         std::shared_ptr<void> base_ptr,
+                         std::shared_ptr<CudaIpcArenaControl> control,
+                         int slot)
+      : Allocation(ptr, size, phi::GPUPlace(device_id)),
+        base_ptr_(std::move(base_ptr)),
+        control_(std::move(control)),
+        slot_(slot) {}
+
+  ~CudaIpcArenaAllocation() override;
+
+ private:
+  std::shared_ptr<void> base_ptr_;
+  std::shared_ptr<CudaIpcArenaControl> control_;
+  int slot_;
+};
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
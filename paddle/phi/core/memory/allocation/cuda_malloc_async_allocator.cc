@@ -73,6 +73,8 @@
  * immediate deallocation.
  */
 COMMON_DECLARE_double(cuda_malloc_async_pool_memory_throttle_ratio);
+COMMON_DECLARE_int64(cuda_malloc_async_pool_release_threshold_mb);
+COMMON_DECLARE_bool(cuda_malloc_async_pool_peer_access);
 
 namespace paddle::memory::allocation {
 
@@ -145,15 +147,20 @@ CUDAMallocAsyncAllocator::CUDAMallocAsyncAllocator(
       current_allocated_size_(0),
       pending_release_size_(0),
       memory_throttle_ratio_(
-          FLAGS_cuda_malloc_async_pool_memory_throttle_ratio) {
+          FLAGS_cuda_malloc_async_pool_memory_throttle_ratio),
+      alive_(std::make_shared<bool>(true)) {
   // CUDA operations are not allowed here. The cuInit function must be called
   // after a new fork, and since this constructor is typically initialized
   // before cuInit, we should avoid calling any CUDA API here.
-  phi::backends::gpu::CUDAGraph::AddPreCaptureCallback([&]() {
-    VLOG(0) << "[Before capture callback] " << (this) << " "
-            << std::this_thread::get_id();
-    this->ClearFreeStream(true);
-  });
+  // The allocators of the CUDA Graph memory pools are destroyed with their
+  // graphs, so the callback checks that the allocator is still alive.
+  phi::backends::gpu::CUDAGraph::AddPreCaptureCallback(
+      [this, alive = std::weak_ptr<bool>(alive_)]() {
+        if (alive.expired()) return;
+        VLOG(0) << "[Before capture callback] " << (this) << " "
+                << std::this_thread::get_id();
+        this->ClearFreeStream(true);
+      });
 }
 
 uint64_t CUDAMallocAsyncAllocator::ReleaseImpl(const phi::Place& place) {
@@ -166,10 +173,63 @@ uint64_t CUDAMallocAsyncAllocator::ReleaseImpl(const phi::Place& place) {
   // we synchronize the event so all the block could be release.
   if (underlying_allocator_)
     released_size += underlying_allocator_->Release(place_);
+  // The blocks freed on the streams return to the pool once the streams
+  // reach the frees.
+  ClearFreeStream(true);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(default_stream_));
+  released_size += TrimTo(0);
   VLOG(8) << "Release " << released_size << " bytes memory from all streams";
   return released_size;
 }
 
+void CUDAMallocAsyncAllocator::SetReleaseThreshold(uint64_t threshold) {
+  LazyInitializeCudaFreeStream();
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolSetAttribute(
+      mempool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+  VLOG(4) << "[CUDAMallocAsyncAllocator] Set the release threshold of the "
+          << "pool of " << place_ << " to "
+          << string::HumanReadableSize(threshold);
+}
+
+uint64_t CUDAMallocAsyncAllocator::TrimTo(size_t bytes_to_keep) {
+  LazyInitializeCudaFreeStream();
+  uint64_t reserved_before = 0, reserved_after = 0;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolGetAttribute(
+      mempool_, cudaMemPoolAttrReservedMemCurrent, &reserved_before));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolTrimTo(mempool_, bytes_to_keep));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolGetAttribute(
+      mempool_, cudaMemPoolAttrReservedMemCurrent, &reserved_after));
+  uint64_t trimmed =
+      reserved_before > reserved_after ? reserved_before - reserved_after : 0;
+  VLOG(4) << "[CUDAMallocAsyncAllocator] Trim the pool of " << place_
+          << " by " << string::HumanReadableSize(trimmed);
+  return trimmed;
+}
+
+void CUDAMallocAsyncAllocator::EnablePeerAccess() {
+  int device_count = platform::GetGPUDeviceCount();
+  for (int peer = 0; peer < device_count; ++peer) {
+    if (peer == place_.device) {
+      continue;
+    }
+    int can_access = 0;
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaDeviceCanAccessPeer(&can_access, peer, place_.device));
+    if (!can_access) {
+      VLOG(4) << "[CUDAMallocAsyncAllocator] GPU " << peer
+              << " cannot access the pool of " << place_;
+      continue;
+    }
+    cudaMemAccessDesc desc = {};
+    desc.location.type = cudaMemLocationTypeDevice;
+    desc.location.id = peer;
+    desc.flags = cudaMemAccessFlagsProtReadWrite;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolSetAccess(mempool_, &desc, 1));
+    VLOG(4) << "[CUDAMallocAsyncAllocator] Map the pool of " << place_
+            << " to GPU " << peer;
+  }
+}
+
 void CUDAMallocAsyncAllocator::ClearFreeStream(bool sync) {
   LazyInitializeCudaFreeStream();
 
@@ -296,6 +356,15 @@ void CUDAMallocAsyncAllocator::LazyInitializeCudaFreeStream() {
     PADDLE_ENFORCE_GPU_SUCCESS(
         cudaStreamCreateWithPriority(&free_stream_, cudaStreamNonBlocking, 0));
     cudaDeviceGetDefaultMemPool(&mempool_, place_.device);
+    int64_t threshold_mb = FLAGS_cuda_malloc_async_pool_release_threshold_mb;
+    if (threshold_mb >= 0) {
+      uint64_t threshold = static_cast<uint64_t>(threshold_mb) << 20;
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolSetAttribute(
+          mempool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+    }
+    if (FLAGS_cuda_malloc_async_pool_peer_access) {
+      EnablePeerAccess();
+    }
 
     platform::SetDeviceId(place_.device);
   });
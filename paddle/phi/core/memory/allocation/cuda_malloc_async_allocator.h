@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_set>
 
@@ -82,6 +83,15 @@ class CUDAMallocAsyncAllocator : public Allocator {
   void SetDefaultStream(gpuStream_t stream);
   void ClearFreeStream(bool sync = false);
 
+  // Sets the bytes of the freed memory the pool of the device keeps at the
+  // synchronizations instead of returning them to the driver. The pool is
+  // shared by the allocators of all the streams and predictors on the device.
+  void SetReleaseThreshold(uint64_t threshold);
+
+  // Returns the unused memory of the pool beyond bytes_to_keep to the
+  // driver, and returns the bytes released.
+  uint64_t TrimTo(size_t bytes_to_keep);
+
  protected:
   void FreeImpl(phi::Allocation* allocation) override;
   phi::Allocation* AllocateImpl(size_t size) override;
@@ -89,6 +99,9 @@ class CUDAMallocAsyncAllocator : public Allocator {
 
  private:
   void LazyInitializeCudaFreeStream();
+  // Maps the pool to the peers of the device, see
+  // FLAGS_cuda_malloc_async_pool_peer_access.
+  void EnablePeerAccess();
   void MallocThrottling();
   void FreeAllocation(CUDAMallocAsyncAllocation* allocation);
 
@@ -109,6 +122,9 @@ class CUDAMallocAsyncAllocator : public Allocator {
 
   double memory_throttle_ratio_;
 
+  // Expires with the allocator, see the pre capture callback.
+  std::shared_ptr<bool> alive_;
+
   std::once_flag once_flag_;
 
   /*
@@ -0,0 +1,251 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/expandable_segment_allocator.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/stats.h"
+#include "paddle/utils/string/printf.h"
+
+namespace paddle::memory::allocation {
+
+// The stat of the largest free block of a device is the largest one of all
+// its segments, one per stream.
+static void UpdateDeviceLargestFreeBlock(int dev_id,
+                                         const void *segment,
+                                         size_t largest_free_block) {
+  static std::mutex mutex;
+  static std::map<int, std::map<const void *, size_t>> segments;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &blocks = segments[dev_id];
+  auto max_block = [&blocks] {
+    size_t max_size = 0;
+    for (auto &pair : blocks) max_size = std::max(max_size, pair.second);
+    return max_size;
+  };
+  size_t prev_max = max_block();
+  if (largest_free_block > 0) {
+    blocks[segment] = largest_free_block;
+  } else {
+    blocks.erase(segment);
+  }
+  size_t cur_max = max_block();
+  if (cur_max != prev_max) {
+    DEVICE_MEMORY_STAT_UPDATE(SegmentLargestFreeBlock,
+                              dev_id,
+                              static_cast<int64_t>(cur_max) -
+                                  static_cast<int64_t>(prev_max));
+  }
+}
+
+ExpandableSegmentAllocator::ExpandableSegmentAllocator(const phi::Place &place,
+                                                       size_t alignment,
+                                                       size_t retained_size,
+                                                       bool allow_free_tail)
+    : place_(place),
+      alignment_(alignment),
+      retained_size_(retained_size),
+      allow_free_tail_(allow_free_tail) {}
+
+void ExpandableSegmentAllocator::InitSegment(void *base,
+                                             size_t segment_size,
+                                             size_t page_size) {
+  base_ = static_cast<uint8_t *>(base);
+  segment_size_ = segment_size;
+  page_size_ = page_size;
+  retained_size_ = AlignedSize(retained_size_, page_size_);
+  VLOG(4) << "Reserve an expandable segment of " << segment_size
+          << " bytes at " << base << " with pages of " << page_size
+          << " bytes on " << place_;
+}
+
+size_t ExpandableSegmentAllocator::mapped_size() const {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return mapped_size_;
+}
+
+size_t ExpandableSegmentAllocator::allocated_size() const {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return allocated_size_;
+}
+
+size_t ExpandableSegmentAllocator::largest_free_block() const {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return free_blocks_.empty() ? 0 : free_blocks_.rbegin()->first;
+}
+
+phi::Allocation *ExpandableSegmentAllocator::AllocateImpl(size_t size) {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  size = AlignedSize(std::max<size_t>(size, 1), alignment_);
+  auto iter = free_blocks_.lower_bound(std::make_pair(size, size_t{0}));
+  size_t offset = 0;
+  if (iter != free_blocks_.end()) {
+    offset = iter->second;
+  } else {
+    offset = Expand(size);
+  }
+  auto *allocation = AllocFromBlock(offset, size);
+  UpdateStats();
+  return allocation;
+}
+
+void ExpandableSegmentAllocator::FreeImpl(phi::Allocation *allocation) {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  auto offset =
+      static_cast<size_t>(static_cast<uint8_t *>(allocation->ptr()) - base_);
+  auto block = blocks_.find(offset);
+  PADDLE_ENFORCE_EQ(
+      block != blocks_.end() && !block->second.is_free,
+      true,
+      common::errors::InvalidArgument(
+          "The address %p is not allocated from the expandable segment at %p.",
+          allocation->ptr(),
+          base_));
+  allocated_size_ -= block->second.size;
+  block->second.is_free = true;
+
+  auto next = std::next(block);
+  if (next != blocks_.end() && next->second.is_free) {
+    free_blocks_.erase(std::make_pair(next->second.size, next->first));
+    block->second.size += next->second.size;
+    blocks_.erase(next);
+  }
+  if (block != blocks_.begin()) {
+    auto prev = std::prev(block);
+    if (prev->second.is_free) {
+      free_blocks_.erase(std::make_pair(prev->second.size, prev->first));
+      prev->second.size += block->second.size;
+      blocks_.erase(block);
+      block = prev;
+    }
+  }
+  free_blocks_.emplace(block->second.size, block->first);
+
+  if (allow_free_tail_ && std::next(block) == blocks_.end()) {
+    ReleaseFreeTail(retained_size_);
+  }
+  UpdateStats();
+  delete allocation;
+}
+
+uint64_t ExpandableSegmentAllocator::ReleaseImpl(const phi::Place &place) {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  if (!allow_free_tail_) {
+    return 0;
+  }
+  size_t released = ReleaseFreeTail(0);
+  UpdateStats();
+  return released;
+}
+
+size_t ExpandableSegmentAllocator::Expand(size_t size) {
+  // The free tail, if any, is extended by the pages it lacks.
+  size_t offset = mapped_size_;
+  size_t tail_size = 0;
+  if (!blocks_.empty() && blocks_.rbegin()->second.is_free) {
+    offset = blocks_.rbegin()->first;
+    tail_size = blocks_.rbegin()->second.size;
+  }
+  size_t grow_size = AlignedSize(size - tail_size, page_size_);
+  if (mapped_size_ + grow_size > segment_size_) {
+    PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+        "\n\nOut of memory error on %s. Cannot allocate %s memory from the "
+        "expandable segment, whose %s memory is mapped, %s is allocated and "
+        "the largest free block is %s.\n\n"
+        "Please decrease the batch size of your model.\n\n",
+        place_,
+        string::HumanReadableSize(size),
+        string::HumanReadableSize(mapped_size_),
+        string::HumanReadableSize(allocated_size_),
+        string::HumanReadableSize(
+            free_blocks_.empty() ? 0 : free_blocks_.rbegin()->first)));
+  }
+  MapPages(mapped_size_, grow_size);
+  VLOG(10) << "Map " << grow_size << " bytes at offset " << mapped_size_
+           << " of the expandable segment at " << static_cast<void *>(base_);
+  mapped_size_ += grow_size;
+
+  if (tail_size > 0) {
+    free_blocks_.erase(std::make_pair(tail_size, offset));
+    blocks_[offset].size += grow_size;
+  } else {
+    blocks_.emplace(offset, Block{grow_size, true});
+  }
+  free_blocks_.emplace(blocks_[offset].size, offset);
+  return offset;
+}
+
+phi::Allocation *ExpandableSegmentAllocator::AllocFromBlock(size_t offset,
+                                                            size_t size) {
+  auto &block = blocks_[offset];
+  free_blocks_.erase(std::make_pair(block.size, offset));
+  if (block.size > size) {
+    blocks_.emplace(offset + size, Block{block.size - size, true});
+    free_blocks_.emplace(block.size - size, offset + size);
+    block.size = size;
+  }
+  block.is_free = false;
+  allocated_size_ += size;
+  return new Allocation(base_ + offset, size, place_);
+}
+
+size_t ExpandableSegmentAllocator::ReleaseFreeTail(size_t retained_size) {
+  if (blocks_.empty() || !blocks_.rbegin()->second.is_free) {
+    return 0;
+  }
+  auto tail = std::prev(blocks_.end());
+  // Only the whole pages of the tail beyond the retained size are unmapped.
+  size_t start = AlignedSize(tail->first, page_size_) + retained_size;
+  if (start >= mapped_size_) {
+    return 0;
+  }
+  size_t released = mapped_size_ - start;
+  UnmapPages(start, released);
+  VLOG(10) << "Unmap " << released << " bytes at offset " << start
+           << " of the expandable segment at " << static_cast<void *>(base_);
+
+  free_blocks_.erase(std::make_pair(tail->second.size, tail->first));
+  if (start == tail->first) {
+    blocks_.erase(tail);
+  } else {
+    tail->second.size = start - tail->first;
+    free_blocks_.emplace(tail->second.size, tail->first);
+  }
+  mapped_size_ = start;
+  return released;
+}
+
+void ExpandableSegmentAllocator::UpdateStats() {
+  if (!phi::is_gpu_place(place_)) {
+    return;
+  }
+  int dev_id = place_.GetDeviceId();
+  auto free_size = static_cast<int64_t>(mapped_size_ - allocated_size_);
+  if (free_size != reported_free_size_) {
+    DEVICE_MEMORY_STAT_UPDATE(
+        SegmentFree, dev_id, free_size - reported_free_size_);
+    reported_free_size_ = free_size;
+  }
+  size_t largest_free_block =
+      free_blocks_.empty() ? 0 : free_blocks_.rbegin()->first;
+  if (largest_free_block != reported_largest_free_block_) {
+    UpdateDeviceLargestFreeBlock(dev_id, this, largest_free_block);
+    reported_largest_free_block_ = largest_free_block;
+  }
+}
+
+}  // namespace paddle::memory::allocation
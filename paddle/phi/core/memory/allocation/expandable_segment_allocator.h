@@ -0,0 +1,109 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <utility>
+
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * ExpandableSegmentAllocator serves all the allocations of a stream from one
+ * segment, a range of virtual addresses reserved up front. Only the head of
+ * the segment is backed by physical pages: it grows by the pages a request
+ * lacks when no free block fits, and the pages of the free block at its tail
+ * are given back as blocks are freed. Since all the blocks lie in one range,
+ * the free neighbours always merge and a request may reuse the free tail,
+ * while AutoGrowthBestFitAllocator could only split the chunk a block was
+ * allocated from. So the memory does not fragment into chunks when the shapes
+ * vary.
+ *
+ * The subclasses reserve the segment and map and unmap its pages.
+ */
+class ExpandableSegmentAllocator : public Allocator {
+ public:
+  // The pages of the free tail beyond retained_size bytes are given back on
+  // free, and all of them by Release, only when allow_free_tail is true.
+  ExpandableSegmentAllocator(const phi::Place &place,
+                             size_t alignment,
+                             size_t retained_size,
+                             bool allow_free_tail);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The bytes backed by pages, the bytes allocated and the largest free block
+  // of the segment. The mapped minus the allocated bytes is the memory lost
+  // to the fragmentation.
+  size_t mapped_size() const;
+  size_t allocated_size() const;
+  size_t largest_free_block() const;
+
+ protected:
+  void InitSegment(void *base, size_t segment_size, size_t page_size);
+
+  // Backs [offset, offset + size) of the segment, which are whole pages right
+  // after the mapped ones, by physical pages. Throws BadAlloc when out of
+  // memory.
+  virtual void MapPages(size_t offset, size_t size) = 0;
+  virtual void UnmapPages(size_t offset, size_t size) = 0;
+
+  phi::Allocation *AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation *allocation) override;
+  uint64_t ReleaseImpl(const phi::Place &place) override;
+
+ private:
+  struct Block {
+    size_t size;
+    bool is_free;
+  };
+
+  size_t Expand(size_t size);
+  phi::Allocation *AllocFromBlock(size_t offset, size_t size);
+  size_t ReleaseFreeTail(size_t retained_size);
+  void UpdateStats();
+
+  phi::Place place_;
+  size_t alignment_;
+  size_t retained_size_;
+  bool allow_free_tail_;
+
+  uint8_t *base_{nullptr};
+  size_t segment_size_{0};
+  size_t page_size_{1};
+  size_t mapped_size_{0};
+  size_t allocated_size_{0};
+
+  // The blocks cover the mapped pages, keyed by their offsets.
+  std::map<size_t, Block> blocks_;
+  // The sizes and the offsets of the free blocks.
+  std::set<std::pair<size_t, size_t>> free_blocks_;
+
+  // The stats reported last, to update the stats of the device by the delta.
+  int64_t reported_free_size_{0};
+  size_t reported_largest_free_block_{0};
+
+  mutable SpinLock spinlock_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -18,8 +18,13 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 
+#include <algorithm>
 #include <atomic>
 #include <random>
 #include <string>
@@ -121,6 +126,16 @@ void AllocateMemoryMap(std::string filename,
   }
 }
 
+size_t GetMemoryMapCacheSize(size_t size) {
+  constexpr size_t kMinSize = 4096;
+  if (size <= kMinSize) {
+    return kMinSize;
+  }
+  size_t step = (static_cast<size_t>(1) << (63 - __builtin_clzll(size))) / 4;
+  step = std::max(step, kMinSize);
+  return (size + step - 1) / step * step;
+}
+
 std::shared_ptr<RefcountedMemoryMapAllocation>
 AllocateRefcountedMemoryMapAllocation(std::string filename,
                                       int shared_fd,
@@ -176,6 +191,52 @@ void MemoryMapAllocation::close() {
 
 MemoryMapAllocation::~MemoryMapAllocation() { close(); }  // NOLINT
 
+void MemoryMapFileAllocation::close() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (map_ptr_ != nullptr && map_size_ > 0) {
+    PADDLE_ENFORCE_NE(munmap(map_ptr_, map_size_),
+                      -1,
+                      common::errors::Unavailable(
+                          "munmap file %s failed, error: %s.",
+                          ipc_name_.c_str(),
+                          strerror(errno)));
+  }
+}
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(fd,
+                    -1,
+                    common::errors::NotFound("Cannot open file %s, error: %s.",
+                                             file_name.c_str(),
+                                             strerror(errno)));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    ::close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Cannot stat file %s, error: %s.", file_name.c_str(), strerror(errno)));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void *ptr = nullptr;
+  if (size > 0) {
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  // the mapping does not need the fd any more
+  ::close(fd);
+  PADDLE_ENFORCE_NE(ptr,
+                    MAP_FAILED,
+                    common::errors::Unavailable(
+                        "mmap file %s failed, error: %s.",
+                        file_name.c_str(),
+                        strerror(errno)));
+  VLOG(4) << "Map file " << file_name << " of " << size << " bytes at " << ptr;
+  return std::make_shared<MemoryMapFileAllocation>(ptr, size, file_name);
+}
+
 void RefcountedMemoryMapAllocation::incref() {
   CountInfo *info = static_cast<CountInfo *>(map_ptr_);
   ++info->refcount;
@@ -105,6 +105,12 @@ void AllocateMemoryMap(std::string filename,
                        size_t size,
                        void **base_ptr_);
 
+// The size of the shm created for size bytes when the shm are cached by
+// MemoryMapAllocationPool. The sizes are rounded up to 4 classes per power of
+// 2, so that a cached shm is reused by the batches of close sizes, such as
+// the batches of variable length sequences, wasting at most a quarter of it.
+size_t GetMemoryMapCacheSize(size_t size);
+
 std::shared_ptr<RefcountedMemoryMapAllocation>
 AllocateRefcountedMemoryMapAllocation(std::string filename,
                                       int shared_fd,
@@ -112,6 +118,39 @@ AllocateRefcountedMemoryMapAllocation(std::string filename,
                                       size_t size,
                                       int buffer_id = -1);
 
+// Read-only mapping of a regular file, e.g. a combined parameters file. The
+// mapping is private: the pages are shared with the page cache, and so with
+// the other processes mapping the same file, until they are written, and the
+// writes are never carried to the file.
+class MemoryMapFileAllocation : public MemoryMapAllocation {
+ public:
+  MemoryMapFileAllocation(void *ptr, size_t size, std::string file_name)
+      : MemoryMapAllocation(ptr, size, std::move(file_name), -1) {}
+
+  void close() override;
+
+  ~MemoryMapFileAllocation() override { close(); }
+};
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name);
+
+// A range of another allocation, which is kept alive as long as the range.
+// It lets tensors alias the data of a mapped file.
+class MemoryMapSliceAllocation : public Allocation {
+ public:
+  MemoryMapSliceAllocation(std::shared_ptr<Allocation> base,
+                           size_t offset,
+                           size_t size)
+      : Allocation(static_cast<char *>(base->ptr()) + offset,
+                   size,
+                   base->place()),
+        base_(std::move(base)) {}
+
+ private:
+  std::shared_ptr<Allocation> base_;
+};
+
 class MemoryMapWriterAllocation : public Allocation {
  public:
   explicit MemoryMapWriterAllocation(void *ptr,
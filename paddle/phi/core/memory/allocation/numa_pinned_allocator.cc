@@ -0,0 +1,221 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/numa_pinned_allocator.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_types.h"
+#include "paddle/phi/core/platform/profiler/mem_tracing.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace paddle::memory::allocation {
+
+// The memory policy of mbind, from numaif.h, which is not a dependency.
+constexpr int kMPolBind = 2;
+
+NUMAPinnedChunkAllocator::NUMAPinnedChunkAllocator(int numa_node,
+                                                   size_t huge_page_size)
+    : numa_node_(numa_node), huge_page_size_(huge_page_size) {
+  PADDLE_ENFORCE_EQ(
+      huge_page_size & (huge_page_size - 1),
+      0UL,
+      common::errors::InvalidArgument(
+          "The huge page size should be a power of 2, but received %d.",
+          huge_page_size));
+}
+
+phi::Allocation *NUMAPinnedChunkAllocator::AllocateImpl(size_t size) {
+  size_t page_size = huge_page_size_ > 0
+                         ? huge_page_size_
+                         : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size = AlignedSize(size, page_size);
+
+  void *ptr = MAP_FAILED;
+  if (huge_page_size_ > 0) {
+    int huge_page_shift = __builtin_ctzll(huge_page_size_);
+    ptr = mmap(nullptr,
+               size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                   (huge_page_shift << MAP_HUGE_SHIFT),
+               -1,
+               0);
+  }
+  if (ptr == MAP_FAILED) {
+    // No huge page of the size is reserved, so the transparent huge pages are
+    // the best effort.
+    ptr = mmap(nullptr,
+               size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS,
+               -1,
+               0);
+    if (ptr == MAP_FAILED) {
+      PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+          "Cannot map %d bytes of the pinned memory on NUMA node %d.",
+          size,
+          numa_node_));
+    }
+    if (huge_page_size_ > 0) {
+      madvise(ptr, size, MADV_HUGEPAGE);
+    }
+  }
+
+  // The pages are not faulted yet, so they are all placed on the node once
+  // they are pinned.
+  if (numa_node_ >= 0) {
+    constexpr size_t kBitsPerMask = 8 * sizeof(unsigned long);  // NOLINT
+    std::vector<unsigned long> node_mask(  // NOLINT
+        numa_node_ / kBitsPerMask + 1,
+        0);
+    node_mask[numa_node_ / kBitsPerMask] = 1UL << (numa_node_ % kBitsPerMask);
+    if (syscall(SYS_mbind,
+                ptr,
+                size,
+                kMPolBind,
+                node_mask.data(),
+                node_mask.size() * kBitsPerMask,
+                0) != 0) {
+      VLOG(4) << "Failed to bind the pinned memory to NUMA node "
+              << numa_node_ << ", errno: " << errno;
+    }
+  }
+
+#ifdef PADDLE_WITH_HIP
+  auto result = hipHostRegister(ptr, size, hipHostRegisterPortable);
+#else
+  auto result = cudaHostRegister(ptr, size, cudaHostRegisterPortable);
+#endif
+  if (result != gpuSuccess) {
+    munmap(ptr, size);
+    if (result == gpuErrorOutOfMemory) {
+      PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+          "Cannot pin %d bytes of the host memory on NUMA node %d.",
+          size,
+          numa_node_));
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(result);
+  }
+  VLOG(10) << "Pinned " << size << " bytes at " << ptr << " on NUMA node "
+           << numa_node_;
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+  platform::RecordMemEvent(ptr,
+                           phi::GPUPinnedPlace(),
+                           size,
+                           phi::TracerMemEventType::ReservedAllocate);
+  return new Allocation(ptr, size, phi::GPUPinnedPlace());
+}
+
+void NUMAPinnedChunkAllocator::FreeImpl(phi::Allocation *allocation) {
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipHostUnregister(allocation->ptr()));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaHostUnregister(allocation->ptr()));
+#endif
+  munmap(allocation->ptr(), allocation->size());
+  VLOG(10) << "Unpinned " << allocation->ptr();
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, -allocation->size());
+  platform::RecordMemEvent(allocation->ptr(),
+                           allocation->place(),
+                           allocation->size(),
+                           phi::TracerMemEventType::ReservedFree);
+  delete allocation;
+}
+
+NUMAPinnedAllocator::NUMAPinnedAllocator(size_t chunk_size,
+                                         size_t huge_page_size,
+                                         bool allow_free_idle_chunk) {
+  int device_count = platform::GetGPUDeviceCount();
+  for (int dev_id = 0; dev_id < device_count; ++dev_id) {
+    device_numa_nodes_.push_back(GetGPUNumaNode(dev_id));
+  }
+  // The memory of no GPU is left to the kernel to place.
+  device_numa_nodes_.push_back(-1);
+
+  size_t page_size = std::max<size_t>(huge_page_size, 1);
+  for (int node : device_numa_nodes_) {
+    if (node_allocators_.count(node)) {
+      continue;
+    }
+    VLOG(4) << "Pinned memory allocator of NUMA node " << node;
+    node_allocators_[node] = std::make_shared<AutoGrowthBestFitAllocator>(
+        std::make_shared<NUMAPinnedChunkAllocator>(node, huge_page_size),
+        phi::backends::cpu::CUDAPinnedMinChunkSize(),
+        AlignedSize(chunk_size, page_size),
+        allow_free_idle_chunk);
+  }
+}
+
+int NUMAPinnedAllocator::GetGPUNumaNode(int dev_id) {
+  char bus_id[32];
+#ifdef PADDLE_WITH_HIP
+  auto result = hipDeviceGetPCIBusId(bus_id, sizeof(bus_id), dev_id);
+#else
+  auto result = cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), dev_id);
+#endif
+  if (result != gpuSuccess) {
+    return -1;
+  }
+  // The driver reports the bus id in upper case, sysfs in lower case.
+  std::string pci_bus_id(bus_id);
+  std::transform(
+      pci_bus_id.begin(), pci_bus_id.end(), pci_bus_id.begin(), ::tolower);
+  std::ifstream ifs("/sys/bus/pci/devices/" + pci_bus_id + "/numa_node");
+  int node = -1;
+  if (!(ifs >> node)) {
+    return -1;
+  }
+  VLOG(4) << "GPU " << dev_id << " (" << pci_bus_id << ") is on NUMA node "
+          << node;
+  return node;
+}
+
+phi::Allocation *NUMAPinnedAllocator::AllocateImpl(size_t size) {
+  size_t dev_id = platform::GetCurrentDeviceId();
+  int node = dev_id < device_numa_nodes_.size() ? device_numa_nodes_[dev_id]
+                                                : -1;
+  return node_allocators_.at(node)->Allocate(size).release();
+}
+
+void NUMAPinnedAllocator::FreeImpl(phi::Allocation *allocation) {
+  // The allocation goes back to the allocator of the node that served it.
+  Allocator::AllocationDeleter(allocation);
+}
+
+uint64_t NUMAPinnedAllocator::ReleaseImpl(const phi::Place &place) {
+  uint64_t released_size = 0;
+  for (auto &item : node_allocators_) {
+    released_size += item.second->Release(place);
+  }
+  return released_size;
+}
+
+}  // namespace paddle::memory::allocation
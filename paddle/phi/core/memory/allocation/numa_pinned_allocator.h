@@ -0,0 +1,75 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Allocates the pinned host memory on a NUMA node: the pages are mapped by
+// mmap, backed by huge pages of huge_page_size bytes when the system has them
+// reserved, bound to the node by mbind, and then pinned by cudaHostRegister.
+// A node of -1 leaves the placement to the kernel.
+class NUMAPinnedChunkAllocator : public Allocator {
+ public:
+  NUMAPinnedChunkAllocator(int numa_node, size_t huge_page_size);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation *allocation) override;
+
+ private:
+  int numa_node_;
+  size_t huge_page_size_;
+};
+
+// Serves the pinned host memory from the NUMA node closest to the current
+// GPU, since the copies between a GPU and the pinned memory on the other
+// socket cross the inter-socket link at about half the bandwidth. Each node
+// has an AutoGrowthBestFitAllocator over a NUMAPinnedChunkAllocator, whose
+// chunks are whole huge pages.
+class NUMAPinnedAllocator : public Allocator {
+ public:
+  NUMAPinnedAllocator(size_t chunk_size,
+                      size_t huge_page_size,
+                      bool allow_free_idle_chunk);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // The NUMA node the PCI device of the GPU is attached to, -1 if unknown.
+  static int GetGPUNumaNode(int dev_id);
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation *allocation) override;
+  uint64_t ReleaseImpl(const phi::Place &place) override;
+
+ private:
+  // The node of each GPU, and the allocator of each node.
+  std::vector<int> device_numa_nodes_;
+  std::map<int, std::shared_ptr<Allocator>> node_allocators_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
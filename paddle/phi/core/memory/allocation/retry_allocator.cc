@@ -20,6 +20,19 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+static std::mutex memory_pressure_handler_mutex;
+static MemoryPressureHandler memory_pressure_handler;
+
+void SetMemoryPressureHandler(MemoryPressureHandler handler) {
+  std::lock_guard<std::mutex> guard(memory_pressure_handler_mutex);
+  memory_pressure_handler = std::move(handler);
+}
+
+static MemoryPressureHandler GetMemoryPressureHandler() {
+  std::lock_guard<std::mutex> guard(memory_pressure_handler_mutex);
+  return memory_pressure_handler;
+}
+
 class WaitedAllocateSizeGuard {
  public:
   WaitedAllocateSizeGuard(std::atomic<size_t>* waited_size,
@@ -61,6 +74,19 @@ phi::Allocation* RetryAllocator::AllocateImpl(size_t size) {
   try {
     return alloc_func();
   } catch (BadAlloc&) {
+    // Frees the memory held by the handler before waiting for the others.
+    if (place_.GetType() != phi::AllocationType::UNDEFINED) {
+      auto handler = GetMemoryPressureHandler();
+      while (handler && handler(place_, size) > 0) {
+        try {
+          return alloc_func();
+        } catch (BadAlloc&) {
+          VLOG(10) << "Allocation failed after the memory pressure handler "
+                      "freed memory when allocating "
+                   << size << " bytes.";
+        }
+      }
+    }
     {
       WaitedAllocateSizeGuard guard(&waited_allocate_size_, size);
       VLOG(10) << "Allocation failed when allocating " << size
@@ -17,6 +17,7 @@
 #include <atomic>              // NOLINT
 #include <chrono>              // NOLINT
 #include <condition_variable>  // NOLINT
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
@@ -28,10 +29,23 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+// Frees the memory of the place when an allocation of size bytes fails, e.g.
+// by evicting the tensors to the host, and returns the bytes freed.
+using MemoryPressureHandler =
+    std::function<size_t(const phi::Place& place, size_t size)>;
+
+// The handler is called by the RetryAllocator of the place before it waits
+// for the other threads to free the memory.
+TEST_API void SetMemoryPressureHandler(MemoryPressureHandler handler);
+
 class RetryAllocator : public Allocator {
  public:
-  RetryAllocator(std::shared_ptr<Allocator> allocator, size_t retry_ms)
-      : underlying_allocator_(std::move(allocator)), retry_time_(retry_ms) {
+  RetryAllocator(std::shared_ptr<Allocator> allocator,
+                 size_t retry_ms,
+                 const phi::Place& place = phi::Place())
+      : underlying_allocator_(std::move(allocator)),
+        retry_time_(retry_ms),
+        place_(place) {
     PADDLE_ENFORCE_NOT_NULL(
         underlying_allocator_,
         common::errors::InvalidArgument(
@@ -55,6 +69,8 @@ class RetryAllocator : public Allocator {
  private:
   std::shared_ptr<Allocator> underlying_allocator_;
   std::chrono::milliseconds retry_time_;
+  // The place whose memory pressure handler is called, undefined if none.
+  phi::Place place_;
   std::mutex mutex_;
   std::condition_variable cv_;
 
@@ -14,7 +14,12 @@
 
 #pragma once
 
+#include <string>
+#include <typeinfo>
+
+#include "paddle/common/enforce.h"
 #include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/allocation_trace.h"
 #include "paddle/phi/core/memory/stats.h"
 #include "paddle/phi/core/platform/profiler/mem_tracing.h"
 
@@ -24,8 +29,14 @@ namespace allocation {
 
 class StatAllocator : public Allocator {
  public:
-  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator)
-      : underlying_allocator_(std::move(underlying_allocator)) {}
+  // The stream is the one of the underlying allocator of a stream, which is
+  // recorded by the allocation trace.
+  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                         const void* stream = nullptr)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        stream_(stream),
+        underlying_allocator_name_(
+            common::demangle(typeid(*underlying_allocator_).name())) {}
 
   bool IsAllocThreadSafe() const override { return true; }
 
@@ -43,6 +54,10 @@ class StatAllocator : public Allocator {
                              allocation->place(),
                              allocation->size(),
                              phi::TracerMemEventType::Free);
+    auto& tracer = AllocationTracer::Instance();
+    if (UNLIKELY(tracer.enabled())) {
+      tracer.RecordFree(*allocation);
+    }
     underlying_allocator_->Free(allocation);
   }
 
@@ -62,6 +77,10 @@ class StatAllocator : public Allocator {
                              allocation->place(),
                              allocation->size(),
                              phi::TracerMemEventType::Allocate);
+    auto& tracer = AllocationTracer::Instance();
+    if (UNLIKELY(tracer.enabled())) {
+      tracer.RecordAlloc(*allocation, stream_, underlying_allocator_name_);
+    }
     return allocation.release();
   }
 
@@ -71,6 +90,8 @@ class StatAllocator : public Allocator {
 
  private:
   std::shared_ptr<Allocator> underlying_allocator_;
+  const void* stream_;
+  std::string underlying_allocator_name_;
 };
 
 }  // namespace allocation
@@ -0,0 +1,309 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/step_replay_allocator.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace paddle::memory::allocation {
+
+std::atomic<bool> StepReplayAllocator::enabled_{false};
+std::atomic<int> StepReplayAllocator::warmup_steps_{1};
+std::atomic<uint64_t> StepReplayAllocator::generation_counter_{0};
+std::atomic<uint64_t> StepReplayAllocator::step_counter_{0};
+
+StepReplayAllocator::StepReplayAllocator(
+    std::shared_ptr<Allocator> underlying_allocator)
+    : underlying_allocator_(std::move(underlying_allocator)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      common::errors::InvalidArgument(
+          "Underlying allocator of StepReplayAllocator is NULL"));
+}
+
+StepReplayAllocator::~StepReplayAllocator() { DrainPools(); }
+
+void StepReplayAllocator::SetEnabled(bool enabled, int warmup_steps) {
+  PADDLE_ENFORCE_GT(warmup_steps,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The warmup steps of the allocator replay should be "
+                        "greater than 0, but received %d.",
+                        warmup_steps));
+  warmup_steps_ = warmup_steps;
+  enabled_ = enabled;
+  ++generation_counter_;
+  VLOG(4) << (enabled ? "Enable" : "Disable") << " the allocator replay after "
+          << warmup_steps << " warmup steps";
+}
+
+bool StepReplayAllocator::IsEnabled() { return enabled_; }
+
+void StepReplayAllocator::MarkStep() {
+  if (enabled_.load(std::memory_order_relaxed)) {
+    step_counter_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+phi::Allocation* StepReplayAllocator::AllocateImpl(size_t size) {
+  if (!enabled_.load(std::memory_order_relaxed) &&
+      !active_.load(std::memory_order_relaxed)) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  SyncStep();
+  bool recording = false;
+  bool replayable = true;
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    if (!active_) {
+      replayable = false;
+    } else if (replaying_) {
+      auto it = pools_.find(size);
+      if (it == pools_.end()) {
+        // The size is not seen by the warmup steps.
+        replayable = false;
+      } else if (!it->second.free_allocations.empty()) {
+        auto& free_allocations = it->second.free_allocations;
+        StepReplayAllocation* allocation = free_allocations.back();
+        free_allocations.pop_back();
+        return allocation;
+      }
+    } else {
+      recording = true;
+    }
+  }
+  // The underlying allocator is called out of the lock, which may drain the
+  // pools.
+  if (!replayable) {
+    return AllocateUnderlying(size).release();
+  }
+  StepReplayAllocation* allocation = AllocateReplayable(size);
+  if (recording) {
+    // The warmup counts the allocations that succeed.
+    std::lock_guard<SpinLock> guard(spinlock_);
+    if (!replaying_) {
+      auto& pool = pools_[size];
+      pool.peak_alive = std::max(pool.peak_alive, ++pool.num_alive);
+      bytes_alive_ += size;
+      peak_bytes_ = std::max(peak_bytes_, bytes_alive_);
+    }
+  }
+  return allocation;
+}
+
+void StepReplayAllocator::FreeImpl(phi::Allocation* allocation) {
+  if (num_replayable_.load(std::memory_order_relaxed) == 0) {
+    underlying_allocator_->Free(allocation);
+    return;
+  }
+  auto* replay_allocation = dynamic_cast<StepReplayAllocation*>(allocation);
+  if (replay_allocation == nullptr) {
+    underlying_allocator_->Free(allocation);
+    return;
+  }
+  SyncStep();
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    auto it = pools_.find(replay_allocation->size());
+    if (it != pools_.end()) {
+      auto& pool = it->second;
+      if (pool.num_alive > 0) {
+        --pool.num_alive;
+        if (!replaying_) {
+          bytes_alive_ -= replay_allocation->size();
+        }
+      }
+      if (replaying_ && pool.free_allocations.size() < pool.capacity) {
+        pool.free_allocations.push_back(replay_allocation);
+        return;
+      }
+    }
+  }
+  DeleteReplayable(replay_allocation);
+}
+
+uint64_t StepReplayAllocator::ReleaseImpl(const phi::Place& place) {
+  // The capacities are kept, so the pools are refilled by the frees.
+  uint64_t released_size = DrainPools();
+  VLOG(4) << "Released " << released_size
+          << " bytes of the allocator replay buffers";
+  return underlying_allocator_->Release(place);
+}
+
+void StepReplayAllocator::SyncStep() {
+  if (generation_counter_.load(std::memory_order_relaxed) ==
+          generation_.load(std::memory_order_relaxed) &&
+      step_counter_.load(std::memory_order_relaxed) ==
+          step_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::vector<StepReplayAllocation*> cleared;
+  std::vector<std::pair<size_t, size_t>> plan;
+  uint64_t generation = generation_counter_.load();
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    if (generation != generation_) {
+      for (auto& item : pools_) {
+        auto& free_allocations = item.second.free_allocations;
+        cleared.insert(
+            cleared.end(), free_allocations.begin(), free_allocations.end());
+      }
+      pools_.clear();
+      replaying_ = false;
+      recorded_steps_ = 0;
+      bytes_alive_ = 0;
+      peak_bytes_ = 0;
+      generation_ = generation;
+      step_ = step_counter_.load();
+      active_ = enabled_.load();
+    } else {
+      uint64_t step = step_counter_.load();
+      if (active_ && !replaying_ && step != step_) {
+        recorded_steps_ += static_cast<int>(step - step_);
+        for (auto& item : pools_) {
+          auto& pool = item.second;
+          pool.capacity = std::max(pool.capacity, pool.peak_alive);
+          pool.peak_alive = pool.num_alive;
+        }
+        if (recorded_steps_ >= warmup_steps_.load()) {
+          replaying_ = true;
+          plan = PlanPrebuild();
+        }
+      }
+      step_ = step;
+    }
+  }
+  for (auto* allocation : cleared) {
+    DeleteReplayable(allocation);
+  }
+  if (!plan.empty()) {
+    Prebuild(plan, generation);
+  }
+}
+
+std::vector<std::pair<size_t, size_t>> StepReplayAllocator::PlanPrebuild()
+    const {
+  // The buffers alive come back to the pool when they are freed, and the
+  // buffers cached in all are bounded by the peak bytes of the warmup.
+  size_t cached_bytes = 0;
+  for (auto& item : pools_) {
+    cached_bytes += item.first * (item.second.num_alive +
+                                  item.second.free_allocations.size());
+  }
+  std::vector<std::pair<size_t, size_t>> plan;
+  for (auto& item : pools_) {
+    auto& pool = item.second;
+    size_t num_cached = pool.num_alive + pool.free_allocations.size();
+    if (pool.capacity <= num_cached || item.first == 0) {
+      continue;
+    }
+    size_t num_built = std::min(
+        pool.capacity - num_cached,
+        (peak_bytes_ - std::min(peak_bytes_, cached_bytes)) / item.first);
+    if (num_built > 0) {
+      plan.emplace_back(item.first, num_built);
+      cached_bytes += item.first * num_built;
+    }
+  }
+  return plan;
+}
+
+void StepReplayAllocator::Prebuild(
+    const std::vector<std::pair<size_t, size_t>>& plan, uint64_t generation) {
+  size_t num_allocations = 0;
+  for (auto& item : plan) {
+    std::vector<StepReplayAllocation*> built;
+    for (size_t i = 0; i < item.second; ++i) {
+      try {
+        built.push_back(AllocateReplayable(item.first));
+      } catch (BadAlloc&) {
+        // The pools are filled by the frees instead.
+        VLOG(4) << "Cannot prebuild the allocator replay buffers of "
+                << item.first << " bytes";
+        break;
+      }
+    }
+    {
+      std::lock_guard<SpinLock> guard(spinlock_);
+      auto it = pools_.find(item.first);
+      // The replay may be switched while the buffers are built.
+      while (!built.empty() && generation == generation_ && replaying_ &&
+             it != pools_.end() &&
+             it->second.free_allocations.size() < it->second.capacity) {
+        it->second.free_allocations.push_back(built.back());
+        built.pop_back();
+        ++num_allocations;
+      }
+    }
+    for (auto* allocation : built) {
+      DeleteReplayable(allocation);
+    }
+  }
+  VLOG(4) << "Replay the allocations of " << plan.size() << " sizes after "
+          << recorded_steps_ << " steps, prebuilt " << num_allocations
+          << " buffers";
+}
+
+uint64_t StepReplayAllocator::DrainPools() {
+  std::vector<StepReplayAllocation*> drained;
+  {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    for (auto& item : pools_) {
+      auto& free_allocations = item.second.free_allocations;
+      drained.insert(
+          drained.end(), free_allocations.begin(), free_allocations.end());
+      free_allocations.clear();
+    }
+  }
+  uint64_t drained_size = 0;
+  for (auto* allocation : drained) {
+    drained_size += allocation->size();
+    DeleteReplayable(allocation);
+  }
+  return drained_size;
+}
+
+AllocationPtr StepReplayAllocator::AllocateUnderlying(size_t size) {
+  try {
+    return underlying_allocator_->Allocate(size);
+  } catch (BadAlloc&) {
+    // The cached buffers are the first to give back on memory pressure.
+    uint64_t drained_size = DrainPools();
+    if (drained_size == 0) {
+      throw;
+    }
+    VLOG(4) << "Drained " << drained_size
+            << " bytes of the allocator replay buffers to allocate " << size
+            << " bytes";
+  }
+  return underlying_allocator_->Allocate(size);
+}
+
+StepReplayAllocation* StepReplayAllocator::AllocateReplayable(size_t size) {
+  auto* allocation = new StepReplayAllocation(
+      static_unique_ptr_cast<Allocation>(AllocateUnderlying(size)), size);
+  ++num_replayable_;
+  return allocation;
+}
+
+void StepReplayAllocator::DeleteReplayable(StepReplayAllocation* allocation) {
+  delete allocation;
+  --num_replayable_;
+}
+
+}  // namespace paddle::memory::allocation
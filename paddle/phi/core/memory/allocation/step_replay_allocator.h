@@ -0,0 +1,134 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The allocation served by StepReplayAllocator, which remembers the size it
+// was requested with, since the underlying allocation may be larger.
+class StepReplayAllocation : public Allocation {
+ public:
+  StepReplayAllocation(DecoratedAllocationPtr underlying_allocation,
+                       size_t size)
+      : Allocation(underlying_allocation->ptr(),
+                   underlying_allocation->base_ptr(),
+                   size,
+                   underlying_allocation->place()),
+        underlying_allocation_(std::move(underlying_allocation)) {}
+
+ private:
+  DecoratedAllocationPtr underlying_allocation_;
+};
+
+/**
+ * StepReplayAllocator caches the buffers of the sizes a training step keeps
+ * allocating. A dygraph step allocates and frees about the same sequence of
+ * sizes each iteration, so once replay is enabled, the allocator records the
+ * sizes requested during the first warmup steps, and how many buffers of each
+ * size are alive at most. It then prebuilds that many buffers per size, and
+ * the later steps take them from and give them back to a free list in O(1),
+ * skipping the best-fit search of the underlying allocator. The other sizes
+ * go to the underlying allocator as usual.
+ *
+ * The steps are delimited by MarkStep, which the eager backward calls when it
+ * finishes. The allocator sits under the StreamSafeCUDAAllocator, which
+ * only frees an allocation to it once the streams using it are done.
+ *
+ * The prebuilt buffers are bounded by the most bytes alive in a warmup step,
+ * since the peaks of the sizes do not all happen at once. When the
+ * underlying allocator runs out of memory, the cached buffers are given back
+ * to it before the allocation is retried.
+ */
+class StepReplayAllocator : public Allocator {
+ public:
+  explicit StepReplayAllocator(std::shared_ptr<Allocator> underlying_allocator);
+  ~StepReplayAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Enables or disables the replay of all the StepReplayAllocators. Enabling
+  // it restarts the warmup, disabling it drops the cached buffers.
+  TEST_API static void SetEnabled(bool enabled, int warmup_steps);
+  TEST_API static bool IsEnabled();
+  // Ends the current step.
+  TEST_API static void MarkStep();
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  struct SizePool {
+    // The most buffers of the size alive in a step, which are kept cached.
+    size_t capacity{0};
+    size_t num_alive{0};
+    size_t peak_alive{0};
+    std::vector<StepReplayAllocation*> free_allocations;
+  };
+
+  // Catches up with the steps and the switches since the last call. The
+  // cached buffers are built or freed out of the lock.
+  void SyncStep();
+  // Returns the number of buffers of each size to prebuild.
+  std::vector<std::pair<size_t, size_t>> PlanPrebuild() const;
+  void Prebuild(const std::vector<std::pair<size_t, size_t>>& plan,
+                uint64_t generation);
+  // Frees the cached buffers, and returns their bytes.
+  uint64_t DrainPools();
+  // Allocates from the underlying allocator, which is retried once the
+  // cached buffers are drained if it runs out of memory.
+  AllocationPtr AllocateUnderlying(size_t size);
+  StepReplayAllocation* AllocateReplayable(size_t size);
+  void DeleteReplayable(StepReplayAllocation* allocation);
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  SpinLock spinlock_;
+  std::unordered_map<size_t, SizePool> pools_;
+  bool replaying_{false};
+  // Whether the allocator records or caches anything, when it must lock.
+  std::atomic<bool> active_{false};
+  // The number of the StepReplayAllocations not destroyed, without which a
+  // free goes to the underlying allocator directly.
+  std::atomic<size_t> num_replayable_{0};
+  // The generation of SetEnabled and the step seen by this allocator.
+  std::atomic<uint64_t> generation_{0};
+  std::atomic<uint64_t> step_{0};
+  int recorded_steps_{0};
+  // The bytes of the recorded allocations alive, and the most of them.
+  size_t bytes_alive_{0};
+  size_t peak_bytes_{0};
+
+  static std::atomic<bool> enabled_;
+  static std::atomic<int> warmup_steps_;
+  static std::atomic<uint64_t> generation_counter_;
+  static std::atomic<uint64_t> step_counter_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
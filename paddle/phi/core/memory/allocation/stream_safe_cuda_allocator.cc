@@ -17,6 +17,7 @@
 
 #include "paddle/phi/api/profiler/event_tracing.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
+#include "paddle/phi/core/memory/stats.h"
 
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/backends/gpu/cuda/cuda_graph.h"
@@ -28,6 +29,43 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+static gpuEvent_t CreateEvent() {
+  gpuEvent_t event;
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      hipEventCreateWithFlags(&event, hipEventDisableTiming));
+#endif
+  VLOG(9) << "Create a new event " << event;
+  return event;
+}
+
+static void DestroyEvent(gpuEvent_t event) {
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(event));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(event));
+#endif
+}
+
+static bool IsEventCompleted(gpuEvent_t event) {
+#ifdef PADDLE_WITH_CUDA
+  gpuError_t err = cudaEventQuery(event);
+  if (err == cudaErrorNotReady) {
+    return false;
+  }
+#else
+  gpuError_t err = hipEventQuery(event);
+  if (err == hipErrorNotReady) {
+    return false;
+  }
+#endif
+  PADDLE_ENFORCE_GPU_SUCCESS(err);
+  return true;
+}
+
 StreamSafeCUDAAllocation::StreamSafeCUDAAllocation(
     DecoratedAllocationPtr underlying_allocation,
     gpuStream_t owning_stream,
@@ -38,6 +76,7 @@ StreamSafeCUDAAllocation::StreamSafeCUDAAllocation(
                  underlying_allocation->place()),
       underlying_allocation_(std::move(underlying_allocation)),
       owning_stream_(owning_stream),
+      owner_(allocator),
       allocator_(allocator->shared_from_this()) {}
 
 void StreamSafeCUDAAllocation::RecordStream(gpuStream_t stream) {
@@ -49,7 +88,7 @@ void StreamSafeCUDAAllocation::RecordStream(gpuStream_t stream) {
   std::call_once(once_flag_,
                  [this] { phi::backends::gpu::SetDeviceId(place_.device); });
 
-  std::lock_guard<SpinLock> lock_guard(outstanding_event_map_lock_);
+  std::lock_guard<SpinLock> lock_guard(outstanding_epoch_map_lock_);
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   if (UNLIKELY(phi::backends::gpu::CUDAGraph::IsThisThreadCapturing())) {
     graph_capturing_stream_set_.insert(stream);
@@ -63,25 +102,15 @@ void StreamSafeCUDAAllocation::RecordStream(gpuStream_t stream) {
 
 void StreamSafeCUDAAllocation::EraseStream(gpuStream_t stream) {
   VLOG(8) << "Try remove stream " << stream << " for address " << ptr();
-  std::lock_guard<SpinLock> lock_guard(outstanding_event_map_lock_);
-  auto it = outstanding_event_map_.find(stream);
-  if (it == outstanding_event_map_.end()) {
-    return;
-  }
-
-#ifdef PADDLE_WITH_CUDA
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(it->second));
-#else
-  PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(it->second));
-#endif
-  outstanding_event_map_.erase(it);
+  std::lock_guard<SpinLock> lock_guard(outstanding_epoch_map_lock_);
+  outstanding_epoch_map_.erase(stream);
 }
 
 bool StreamSafeCUDAAllocation::CanBeFreed() {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   if (UNLIKELY(phi::backends::gpu::CUDAGraph::IsThisThreadCapturing())) {
     return graph_capturing_stream_set_.empty() &&
-           outstanding_event_map_.empty();
+           outstanding_epoch_map_.empty();
   }
 #endif
 
@@ -89,35 +118,9 @@ bool StreamSafeCUDAAllocation::CanBeFreed() {
                  [this] { phi::backends::gpu::SetDeviceId(place_.device); });
 
   RecordGraphCapturingStreams();
-
-  for (auto it = outstanding_event_map_.begin();
-       it != outstanding_event_map_.end();
-       ++it) {
-    gpuEvent_t& event = it->second;
-#ifdef PADDLE_WITH_CUDA
-    gpuError_t err = cudaEventQuery(event);
-    if (err == cudaErrorNotReady) {
-      VLOG(9) << "Event " << event << " for " << ptr() << " is not completed";
-      // Erase the completed event before "it"
-      outstanding_event_map_.erase(outstanding_event_map_.begin(), it);
-      return false;
-    }
-    PADDLE_ENFORCE_GPU_SUCCESS(err);
-    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(event));
-#else
-    gpuError_t err = hipEventQuery(event);
-    if (err == hipErrorNotReady) {
-      VLOG(9) << "Event " << event << " for " << ptr() << " is not completed";
-      // Erase the completed event before "it"
-      outstanding_event_map_.erase(outstanding_event_map_.begin(), it);
-      return false;
-    }
-    PADDLE_ENFORCE_GPU_SUCCESS(err);
-    PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(event));
-#endif
-    VLOG(8) << "Destroy event " << event;
-  }
-  return true;
+  gpuStream_t stream;
+  uint64_t epoch;
+  return !GetPendingStream(&stream, &epoch);
 }
 
 gpuStream_t StreamSafeCUDAAllocation::GetOwningStream() const {
@@ -133,31 +136,24 @@ void StreamSafeCUDAAllocation::RecordGraphCapturingStreams() {
 
 void StreamSafeCUDAAllocation::RecordStreamWithNoGraphCapturing(
     gpuStream_t stream) {
-  gpuEvent_t record_event;
-  auto it = outstanding_event_map_.find(stream);
-  if (it == outstanding_event_map_.end()) {
-    gpuEvent_t new_event;
-#ifdef PADDLE_WITH_CUDA
-    PADDLE_ENFORCE_GPU_SUCCESS(
-        cudaEventCreateWithFlags(&new_event, cudaEventDisableTiming));
-#else
-    PADDLE_ENFORCE_GPU_SUCCESS(
-        hipEventCreateWithFlags(&new_event, hipEventDisableTiming));
-#endif
-    outstanding_event_map_[stream] = new_event;
-    record_event = new_event;
-    VLOG(9) << "Create a new event " << new_event;
-  } else {
-    record_event = it->second;
-    VLOG(9) << "Reuse event " << record_event;
-  }
+  // The later epoch covers the earlier one of the same stream.
+  outstanding_epoch_map_[stream] = owner_->RecordEpoch(stream);
+}
 
-#ifdef PADDLE_WITH_CUDA
-  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(record_event, stream));
-#else
-  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(record_event, stream));
-#endif
-  VLOG(8) << "Record event " << record_event << " to stream " << stream;
+bool StreamSafeCUDAAllocation::GetPendingStream(gpuStream_t* stream,
+                                                uint64_t* epoch) {
+  for (auto it = outstanding_epoch_map_.begin();
+       it != outstanding_epoch_map_.end();) {
+    if (owner_->CompletedEpoch(it->first) < it->second) {
+      VLOG(9) << "Epoch " << it->second << " of stream " << it->first
+              << " for " << ptr() << " is not completed";
+      *stream = it->first;
+      *epoch = it->second;
+      return true;
+    }
+    it = outstanding_epoch_map_.erase(it);
+  }
+  return false;
 }
 
 StreamSafeCUDAAllocator::StreamSafeCUDAAllocator(
@@ -182,6 +178,14 @@ StreamSafeCUDAAllocator::~StreamSafeCUDAAllocator() {
     allocators.erase(std::remove(allocators.begin(), allocators.end(), this),
                      allocators.end());
   }
+  for (auto& pair : timelines_) {
+    for (auto& pending_event : pair.second.pending_events) {
+      DestroyEvent(pending_event.second);
+    }
+  }
+  for (gpuEvent_t event : event_pool_) {
+    DestroyEvent(event);
+  }
 }
 
 bool StreamSafeCUDAAllocator::IsAllocThreadSafe() const { return true; }
@@ -238,9 +242,14 @@ void StreamSafeCUDAAllocator::FreeImpl(phi::Allocation* allocation) {
     VLOG(9) << "Directly delete allocation";
     delete stream_safe_cuda_allocation;
   } else {
-    VLOG(9) << "Put into unfreed_allocation list";
+    VLOG(9) << "Defer the allocation to the epoch it waits for";
     std::lock_guard<SpinLock> lock_guard(unfreed_allocation_lock_);
-    unfreed_allocations_.emplace_back(stream_safe_cuda_allocation);
+    DeferFree(stream_safe_cuda_allocation);
+    ++num_unfreed_allocations_;
+    DEVICE_MEMORY_STAT_UPDATE(
+        DeferredFree,
+        place_.device,
+        static_cast<int64_t>(stream_safe_cuda_allocation->size()));
   }
 }
 
@@ -260,23 +269,112 @@ uint64_t StreamSafeCUDAAllocator::ReleaseImpl(const phi::Place& place) {
   return released_size;
 }
 
+uint64_t StreamSafeCUDAAllocator::RecordEpoch(gpuStream_t stream) {
+  std::lock_guard<SpinLock> lock_guard(timeline_lock_);
+  StreamTimeline& timeline = timelines_[stream];
+  // Reclaims the completed events first, so that the timeline of a stream
+  // whose allocations are never deferred does not grow.
+  PollTimeline(&timeline);
+  gpuEvent_t event;
+  if (event_pool_.empty()) {
+    event = CreateEvent();
+  } else {
+    event = event_pool_.back();
+    event_pool_.pop_back();
+  }
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(event, stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(event, stream));
+#endif
+  timeline.pending_events.emplace_back(++timeline.recorded_epoch, event);
+  VLOG(8) << "Record event " << event << " of epoch "
+          << timeline.recorded_epoch << " to stream " << stream;
+  return timeline.recorded_epoch;
+}
+
+uint64_t StreamSafeCUDAAllocator::CompletedEpoch(gpuStream_t stream) {
+  std::lock_guard<SpinLock> lock_guard(timeline_lock_);
+  return PollTimeline(&timelines_[stream]);
+}
+
+uint64_t StreamSafeCUDAAllocator::PollTimeline(StreamTimeline* timeline) {
+  // The events of a stream complete in order, so the polling stops at the
+  // first one not completed.
+  int64_t num_polls = 0;
+  auto& pending_events = timeline->pending_events;
+  while (!pending_events.empty()) {
+    ++num_polls;
+    if (!IsEventCompleted(pending_events.front().second)) {
+      break;
+    }
+    timeline->completed_epoch = pending_events.front().first;
+    event_pool_.push_back(pending_events.front().second);
+    pending_events.pop_front();
+  }
+  if (num_polls > 0) {
+    DEVICE_MEMORY_STAT_UPDATE(EventPoll, place_.device, num_polls);
+  }
+  return timeline->completed_epoch;
+}
+
+void StreamSafeCUDAAllocator::DeferFree(StreamSafeCUDAAllocation* allocation) {
+  // The events can not be polled in CUDA Graph capturing.
+  gpuStream_t stream;
+  uint64_t epoch;
+  if (LIKELY(!phi::backends::gpu::CUDAGraph::IsThisThreadCapturing()) &&
+      allocation->GetPendingStream(&stream, &epoch)) {
+    unfreed_allocations_[stream][epoch].emplace_back(allocation);
+  } else {
+    capturing_unfreed_allocations_.emplace_back(allocation);
+  }
+}
+
 void StreamSafeCUDAAllocator::ProcessUnfreedAllocations() {
   // NOTE(Ruibiao): This condition is to reduce lock completion. It does not
   // need to be thread-safe since here occasional misjudgments are permissible.
-  if (unfreed_allocations_.empty()) {
+  if (num_unfreed_allocations_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  // No deferred allocation can be freed before the capturing ends, since
+  // the ones used on the other streams are not either.
+  if (UNLIKELY(phi::backends::gpu::CUDAGraph::IsThisThreadCapturing())) {
     return;
   }
 
   std::lock_guard<SpinLock> lock_guard(unfreed_allocation_lock_);
+  // Takes the buckets of the completed epochs of each stream as a whole.
+  std::vector<StreamSafeCUDAAllocation*> completed_allocations;
+  completed_allocations.swap(capturing_unfreed_allocations_);
   for (auto it = unfreed_allocations_.begin();
        it != unfreed_allocations_.end();) {
-    if ((*it)->CanBeFreed()) {
-      delete *it;
+    auto& buckets = it->second;
+    auto end = buckets.upper_bound(CompletedEpoch(it->first));
+    for (auto bucket = buckets.begin(); bucket != end; ++bucket) {
+      completed_allocations.insert(completed_allocations.end(),
+                                   bucket->second.begin(),
+                                   bucket->second.end());
+    }
+    buckets.erase(buckets.begin(), end);
+    if (buckets.empty()) {
       it = unfreed_allocations_.erase(it);
     } else {
       ++it;
     }
   }
+
+  // An allocation used on several streams waits for the next one of them.
+  for (StreamSafeCUDAAllocation* allocation : completed_allocations) {
+    if (allocation->CanBeFreed()) {
+      --num_unfreed_allocations_;
+      DEVICE_MEMORY_STAT_UPDATE(DeferredFree,
+                                place_.device,
+                                -static_cast<int64_t>(allocation->size()));
+      delete allocation;
+    } else {
+      DeferFree(allocation);
+    }
+  }
 }
 
 uint64_t StreamSafeCUDAAllocator::ProcessUnfreedAllocationsAndRelease() {
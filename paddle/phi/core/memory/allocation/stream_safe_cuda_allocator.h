@@ -14,9 +14,12 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <deque>
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/memory/allocation/allocator.h"
@@ -47,18 +50,33 @@ class StreamSafeCUDAAllocation : public Allocation {
 
  private:
   thread_local static std::once_flag once_flag_;
+  friend class StreamSafeCUDAAllocator;
   void RecordGraphCapturingStreams();
   void RecordStreamWithNoGraphCapturing(gpuStream_t stream);
+  // Finds a stream whose epoch of the allocation is not completed yet, and
+  // returns false if there is none.
+  bool GetPendingStream(gpuStream_t *stream, uint64_t *epoch);
   DecoratedAllocationPtr underlying_allocation_;
   std::set<gpuStream_t> graph_capturing_stream_set_;
-  std::map<gpuStream_t, gpuEvent_t> outstanding_event_map_;
+  // The epochs of the other streams the allocation was used on.
+  std::map<gpuStream_t, uint64_t> outstanding_epoch_map_;
   gpuStream_t owning_stream_;
-  SpinLock outstanding_event_map_lock_;
+  SpinLock outstanding_epoch_map_lock_;
+  StreamSafeCUDAAllocator *owner_;
   // To compatible with CUDA Graph, hold the allocator shared_ptr so that
   // Allocator will not deconstruct before Allocation
   std::shared_ptr<Allocator> allocator_;
 };
 
+// The allocations used on other streams are freed by epochs instead of
+// polling each of them. RecordStream records an event from a pool onto the
+// timeline of the stream, which numbers the events by epochs in order, and
+// the allocation keeps the epoch only. Since the events of a stream complete
+// in order, polling the oldest events of each timeline tells its completed
+// epoch, and the deferred allocations are kept in buckets by the stream and
+// the epoch they wait for, which are freed as a whole once completed. So the
+// cost of polling depends on the number of streams rather than the number of
+// deferred allocations.
 class StreamSafeCUDAAllocator
     : public Allocator,
       public std::enable_shared_from_this<StreamSafeCUDAAllocator> {
@@ -79,6 +97,21 @@ class StreamSafeCUDAAllocator
   uint64_t ReleaseImpl(const phi::Place &place) override;
 
  private:
+  friend class StreamSafeCUDAAllocation;
+
+  struct StreamTimeline {
+    uint64_t recorded_epoch{0};
+    uint64_t completed_epoch{0};
+    // The events of the epochs recorded but not known to be completed.
+    std::deque<std::pair<uint64_t, gpuEvent_t>> pending_events;
+  };
+
+  // Records an event onto the stream and returns its epoch.
+  uint64_t RecordEpoch(gpuStream_t stream);
+  // Polls the pending events of the stream and returns its completed epoch.
+  uint64_t CompletedEpoch(gpuStream_t stream);
+  uint64_t PollTimeline(StreamTimeline *timeline);
+  void DeferFree(StreamSafeCUDAAllocation *allocation);
   void ProcessUnfreedAllocations();
   uint64_t ProcessUnfreedAllocationsAndRelease();
 
@@ -89,7 +122,19 @@ class StreamSafeCUDAAllocator
   std::shared_ptr<Allocator> underlying_allocator_;
   phi::GPUPlace place_;
   gpuStream_t default_stream_;
-  std::list<StreamSafeCUDAAllocation *> unfreed_allocations_;
+
+  std::map<gpuStream_t, StreamTimeline> timelines_;
+  std::vector<gpuEvent_t> event_pool_;
+  SpinLock timeline_lock_;
+
+  // The deferred allocations by the stream and the epoch they wait for.
+  std::map<gpuStream_t,
+           std::map<uint64_t, std::vector<StreamSafeCUDAAllocation *>>>
+      unfreed_allocations_;
+  // The deferred allocations freed or used on the streams in CUDA Graph
+  // capturing, which have no epochs known until the capturing ends.
+  std::vector<StreamSafeCUDAAllocation *> capturing_unfreed_allocations_;
+  std::atomic<size_t> num_unfreed_allocations_{0};
   SpinLock unfreed_allocation_lock_;
 
   bool in_cuda_graph_capturing_;
@@ -57,6 +57,9 @@ bool StreamSafeXPUAllocation::CanBeFreed() {
        ++it) {
     XPUEvent& event = it->second;
 
+    // The memory is only reused by the kernels of the owning stream, so the
+    // stream waits for the use of the other streams instead of the host.
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_stream_wait_event(owning_stream_, event));
     PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_destroy(event));
     VLOG(8) << "Destroy event " << event;
   }
@@ -0,0 +1,323 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/os_info.h"
+
+PHI_DEFINE_EXPORTED_uint64(
+    allocation_trace_capacity,
+    0,
+    "The number of the recent allocations and frees to trace, 0 means the "
+    "allocation trace is disabled. It is also enabled by "
+    "paddle.base.core.enable_allocation_trace.");
+PHI_DEFINE_EXPORTED_int32(
+    allocation_trace_sample_interval,
+    1,
+    "Trace one in allocation_trace_sample_interval allocations and their "
+    "frees, which bounds the overhead of the allocation trace.");
+PHI_DEFINE_EXPORTED_bool(
+    allocation_trace_record_stack,
+    false,
+    "Whether to record the stack of the traced allocations, which is slow.");
+
+namespace paddle::memory {
+
+namespace {
+
+thread_local const std::string* current_op_name = nullptr;
+
+std::string EscapeJson(const std::string& str) {
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          result += buf;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result;
+}
+
+void WriteEvent(std::ostream& os, const AllocationTraceEvent& event) {
+  std::ostringstream place;
+  place << event.place;
+  os << "{\"type\": \""
+     << (event.type == AllocationTraceEventType::kAlloc ? "alloc" : "free")
+     << "\", \"timestamp_ns\": " << event.timestamp_ns
+     << ", \"thread_id\": " << event.thread_id << ", \"ptr\": \"" << event.ptr
+     << "\", \"size\": " << event.size << ", \"place\": \""
+     << EscapeJson(place.str()) << "\", \"stream\": \"" << event.stream
+     << "\", \"allocator\": \"" << EscapeJson(event.allocator)
+     << "\", \"op_name\": \"" << EscapeJson(event.op_name)
+     << "\", \"stack\": \"" << EscapeJson(event.stack) << "\"}";
+}
+
+}  // namespace
+
+AllocationTracer& AllocationTracer::Instance() {
+  static AllocationTracer tracer;
+  return tracer;
+}
+
+AllocationTracer::AllocationTracer() {
+  if (FLAGS_allocation_trace_capacity > 0) {
+    Enable(FLAGS_allocation_trace_capacity,
+           FLAGS_allocation_trace_sample_interval,
+           FLAGS_allocation_trace_record_stack);
+  }
+}
+
+void AllocationTracer::Enable(size_t capacity,
+                              int sample_interval,
+                              bool record_stack) {
+  PADDLE_ENFORCE_GT(capacity,
+                    0UL,
+                    common::errors::InvalidArgument(
+                        "The capacity of the allocation trace should be "
+                        "greater than 0, but received %d.",
+                        capacity));
+  PADDLE_ENFORCE_GT(sample_interval,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The sample interval of the allocation trace should "
+                        "be greater than 0, but received %d.",
+                        sample_interval));
+  std::lock_guard<std::mutex> guard(mutex_);
+  capacity_ = capacity;
+  sample_interval_ = sample_interval;
+  record_stack_ = record_stack;
+  events_.clear();
+  events_.reserve(capacity);
+  next_event_ = 0;
+  live_allocations_.clear();
+  num_allocs_ = 0;
+  enabled_ = true;
+}
+
+void AllocationTracer::Disable() {
+  // The events are kept to be dumped after the trace is disabled.
+  std::lock_guard<std::mutex> guard(mutex_);
+  enabled_ = false;
+  live_allocations_.clear();
+}
+
+void AllocationTracer::SetStackCollector(
+    std::function<std::string()> collector) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  stack_collector_ = std::move(collector);
+}
+
+std::string AllocationTracer::CollectStack() const {
+  std::function<std::string()> collector;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    collector = stack_collector_;
+  }
+  std::string stack;
+  if (collector) {
+    stack = collector();
+  }
+  return stack.empty() ? common::enforce::GetCurrentTraceBackString() : stack;
+}
+
+void AllocationTracer::RecordAlloc(const phi::Allocation& allocation,
+                                   const void* stream,
+                                   const std::string& allocator) {
+  if (num_allocs_.fetch_add(1, std::memory_order_relaxed) %
+          sample_interval_ !=
+      0) {
+    return;
+  }
+  AllocationTraceEvent event;
+  event.type = AllocationTraceEventType::kAlloc;
+  event.timestamp_ns = phi::PosixInNsec();
+  event.thread_id = phi::GetCurrentThreadSysId();
+  event.ptr = allocation.ptr();
+  event.size = allocation.size();
+  event.place = allocation.place();
+  event.stream = stream;
+  event.allocator = allocator;
+  if (current_op_name != nullptr) {
+    event.op_name = *current_op_name;
+  }
+  if (record_stack_) {
+    event.stack = CollectStack();
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!enabled_) {
+    return;
+  }
+  live_allocations_[event.ptr] = event;
+  PushEvent(std::move(event));
+}
+
+void AllocationTracer::RecordFree(const phi::Allocation& allocation) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = live_allocations_.find(allocation.ptr());
+  // Only the frees of the traced allocations are traced.
+  if (!enabled_ || it == live_allocations_.end()) {
+    return;
+  }
+  AllocationTraceEvent event = std::move(it->second);
+  live_allocations_.erase(it);
+  event.type = AllocationTraceEventType::kFree;
+  event.timestamp_ns = phi::PosixInNsec();
+  event.thread_id = phi::GetCurrentThreadSysId();
+  if (current_op_name != nullptr) {
+    event.op_name = *current_op_name;
+  }
+  // The stack of a free is the one of its allocation, which tells what held
+  // the memory.
+  PushEvent(std::move(event));
+}
+
+void AllocationTracer::PushEvent(AllocationTraceEvent&& event) {
+  if (events_.size() < capacity_) {
+    events_.emplace_back(std::move(event));
+  } else {
+    events_[next_event_] = std::move(event);
+    next_event_ = (next_event_ + 1) % capacity_;
+  }
+}
+
+std::vector<AllocationTraceEvent> AllocationTracer::Events() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<AllocationTraceEvent> events;
+  events.reserve(events_.size());
+  for (size_t i = 0; i < events_.size(); ++i) {
+    events.push_back(events_[(next_event_ + i) % events_.size()]);
+  }
+  return events;
+}
+
+std::vector<AllocationTraceEvent> AllocationTracer::LiveAllocations() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<AllocationTraceEvent> allocations;
+  allocations.reserve(live_allocations_.size());
+  for (auto& item : live_allocations_) {
+    allocations.push_back(item.second);
+  }
+  std::sort(allocations.begin(),
+            allocations.end(),
+            [](const AllocationTraceEvent& a, const AllocationTraceEvent& b) {
+              return a.timestamp_ns < b.timestamp_ns;
+            });
+  return allocations;
+}
+
+void AllocationTracer::DumpSnapshot(const std::string& path) const {
+  auto allocations = LiveAllocations();
+  auto events = Events();
+
+  std::set<int> devices;
+  for (auto& allocation : allocations) {
+    if (phi::is_gpu_place(allocation.place)) {
+      devices.insert(allocation.place.GetDeviceId());
+    }
+  }
+  for (auto& event : events) {
+    if (phi::is_gpu_place(event.place)) {
+      devices.insert(event.place.GetDeviceId());
+    }
+  }
+
+  std::ofstream ofs(path);
+  PADDLE_ENFORCE_EQ(
+      ofs.is_open(),
+      true,
+      common::errors::Unavailable(
+          "Failed to open %s to dump the allocation snapshot.", path));
+  // The segments of a device are summarized by the memory stats of its
+  // allocators, and the blocks are the traced allocations alive.
+  ofs << "{\n\"devices\": [";
+  const char* sep = "";
+  for (int dev_id : devices) {
+    ofs << sep << "\n{\"device\": " << dev_id
+        << ", \"allocated\": "
+        << DeviceMemoryStatCurrentValue("Allocated", dev_id)
+        << ", \"peak_allocated\": "
+        << DeviceMemoryStatPeakValue("Allocated", dev_id)
+        << ", \"reserved\": "
+        << DeviceMemoryStatCurrentValue("Reserved", dev_id)
+        << ", \"peak_reserved\": "
+        << DeviceMemoryStatPeakValue("Reserved", dev_id)
+        << ", \"segment_free\": "
+        << DeviceMemoryStatCurrentValue("SegmentFree", dev_id)
+        << ", \"segment_largest_free_block\": "
+        << DeviceMemoryStatCurrentValue("SegmentLargestFreeBlock", dev_id)
+        << ", \"deferred_free\": "
+        << DeviceMemoryStatCurrentValue("DeferredFree", dev_id) << "}";
+    sep = ",";
+  }
+  ofs << "],\n\"blocks\": [";
+  sep = "";
+  for (auto& allocation : allocations) {
+    ofs << sep << "\n";
+    WriteEvent(ofs, allocation);
+    sep = ",";
+  }
+  ofs << "],\n\"events\": [";
+  sep = "";
+  for (auto& event : events) {
+    ofs << sep << "\n";
+    WriteEvent(ofs, event);
+    sep = ",";
+  }
+  ofs << "]\n}\n";
+}
+
+AllocationTraceOpGuard::AllocationTraceOpGuard(const std::string& op_name)
+    : prev_op_name_(current_op_name) {
+  current_op_name = &op_name;
+}
+
+AllocationTraceOpGuard::~AllocationTraceOpGuard() {
+  current_op_name = prev_op_name_;
+}
+
+const std::string* AllocationTraceOpGuard::CurrentOp() {
+  return current_op_name;
+}
+
+}  // namespace paddle::memory
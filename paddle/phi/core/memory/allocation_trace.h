@@ -0,0 +1,116 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/allocator.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace memory {
+
+enum class AllocationTraceEventType { kAlloc, kFree };
+
+struct AllocationTraceEvent {
+  AllocationTraceEventType type;
+  uint64_t timestamp_ns;
+  uint64_t thread_id;
+  const void* ptr;
+  size_t size;
+  phi::Place place;
+  // The stream of the allocator, nullptr for the default one.
+  const void* stream;
+  // The type of the allocator that served the allocation.
+  std::string allocator;
+  // The op that allocated, and the stack of the allocation if recorded.
+  std::string op_name;
+  std::string stack;
+};
+
+/**
+ * AllocationTracer keeps the recent allocations and frees in a ring buffer,
+ * and the allocations alive, so that what held the memory can be seen when it
+ * runs out. One in sample_interval allocations is traced, together with its
+ * free, which bounds the overhead. It is off unless enabled, by
+ * FLAGS_allocation_trace_capacity or Enable.
+ */
+class TEST_API AllocationTracer {
+ public:
+  static AllocationTracer& Instance();
+
+  void Enable(size_t capacity, int sample_interval, bool record_stack);
+  void Disable();
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  void RecordAlloc(const phi::Allocation& allocation,
+                   const void* stream,
+                   const std::string& allocator);
+  void RecordFree(const phi::Allocation& allocation);
+
+  // The traced events from the oldest one, and the traced allocations alive.
+  std::vector<AllocationTraceEvent> Events() const;
+  std::vector<AllocationTraceEvent> LiveAllocations() const;
+
+  // Dumps the allocations alive and the segments of each device, as the
+  // memory stats of the allocators, into a json file.
+  void DumpSnapshot(const std::string& path) const;
+
+  // Collects the stack other than the C++ one, e.g. the Python one, which
+  // returns an empty string if there is none.
+  void SetStackCollector(std::function<std::string()> collector);
+
+ private:
+  AllocationTracer();
+  std::string CollectStack() const;
+  // Appends the event to the ring buffer, with mutex_ held.
+  void PushEvent(AllocationTraceEvent&& event);
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> num_allocs_{0};
+
+  mutable std::mutex mutex_;
+  size_t capacity_{0};
+  std::atomic<int> sample_interval_{1};
+  std::atomic<bool> record_stack_{false};
+  std::vector<AllocationTraceEvent> events_;
+  // The index of the oldest event once the ring buffer is full.
+  size_t next_event_{0};
+  std::unordered_map<const void*, AllocationTraceEvent> live_allocations_;
+  std::function<std::string()> stack_collector_;
+};
+
+// Names the allocations of the scope by the op, e.g. the instruction run by an
+// interpreter.
+class TEST_API AllocationTraceOpGuard {
+ public:
+  explicit AllocationTraceOpGuard(const std::string& op_name);
+  ~AllocationTraceOpGuard();
+
+  // The op of the innermost guard of the thread, nullptr if there is none.
+  static const std::string* CurrentOp();
+
+ private:
+  const std::string* prev_op_name_;
+};
+
+}  // namespace memory
+}  // namespace paddle
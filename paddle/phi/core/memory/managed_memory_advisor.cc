@@ -0,0 +1,174 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/managed_memory_advisor.h"
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/stats.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/platform/cuda_device_guard.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_uint64(managed_memory_prefetch_limit_mb);
+
+namespace paddle::memory {
+
+// The holder of a tensor placed in managed memory.
+class ManagedAllocation : public phi::Allocation {
+ public:
+  ManagedAllocation(void* ptr,
+                    size_t size,
+                    const phi::GPUPlace& place,
+                    bool prefer_device)
+      : phi::Allocation(ptr, size, place), prefer_device_(prefer_device) {}
+
+  ~ManagedAllocation() override {
+#ifdef PADDLE_WITH_CUDA
+    platform::RecordedGpuFree(ptr(), size(), place().GetDeviceId());
+#endif
+    ManagedMemoryAdvisor::Instance().Release(size(), place().GetDeviceId());
+  }
+
+  bool prefer_device() const { return prefer_device_; }
+
+ private:
+  bool prefer_device_;
+};
+
+ManagedMemoryAdvisor& ManagedMemoryAdvisor::Instance() {
+  static ManagedMemoryAdvisor advisor;
+  return advisor;
+}
+
+bool ManagedMemoryAdvisor::IsManaged(const phi::Allocation* allocation) {
+  return dynamic_cast<const ManagedAllocation*>(allocation) != nullptr;
+}
+
+void ManagedMemoryAdvisor::Place(phi::DenseTensor* tensor,
+                                 int device_id,
+                                 bool read_mostly) {
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_EQ(tensor->initialized(),
+                    true,
+                    common::errors::InvalidArgument(
+                        "The tensor placed in managed memory should be "
+                        "initialized."));
+  const auto& holder = tensor->Holder();
+  PADDLE_ENFORCE_EQ(
+      phi::is_cpu_place(holder->place()) || phi::is_gpu_place(holder->place()),
+      true,
+      common::errors::InvalidArgument(
+          "Only the CPU and GPU tensors can be placed in managed memory, but "
+          "received a tensor on %s.",
+          holder->place()));
+  if (IsManaged(holder.get())) {
+    return;
+  }
+  PADDLE_ENFORCE_EQ(platform::IsGPUManagedMemorySupported(device_id),
+                    true,
+                    common::errors::Unavailable(
+                        "GPU %d does not support managed memory.", device_id));
+
+  size_t size = holder->size();
+  platform::CUDADeviceGuard guard(device_id);
+  void* ptr = nullptr;
+  auto result = platform::RecordedGpuMalloc(&ptr,
+                                            size,
+                                            device_id,
+                                            /* malloc_managed_memory = */ true);
+  if (result != gpuSuccess) {
+    PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+        "Cannot allocate %s managed memory on GPU %d.",
+        string::HumanReadableSize(size),
+        device_id));
+  }
+
+  bool prefer_device = size <= (FLAGS_managed_memory_prefetch_limit_mb << 20);
+  if (read_mostly) {
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMemAdvise(ptr, size, cudaMemAdviseSetReadMostly, device_id));
+  }
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaMemAdvise(ptr,
+                    size,
+                    cudaMemAdviseSetPreferredLocation,
+                    prefer_device ? device_id : cudaCpuDeviceId));
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaMemAdvise(ptr, size, cudaMemAdviseSetAccessedBy, device_id));
+
+  // The kernels writing the tensor are done once the copy is.
+  phi::GPUPlace place(device_id);
+  auto stream = static_cast<phi::GPUContext*>(
+                    phi::DeviceContextPool::Instance().Get(place))
+                    ->stream();
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaMemcpyAsync(ptr, holder->ptr(), size, cudaMemcpyDefault, stream));
+  platform::GpuStreamSync(stream);
+  tensor->ResetHolder(
+      std::make_shared<ManagedAllocation>(ptr, size, place, prefer_device));
+
+  ++num_placed_;
+  DEVICE_MEMORY_STAT_UPDATE(Managed, device_id, size);
+  VLOG(4) << "Place " << size << " bytes of tensor in the managed memory of "
+          << place << (prefer_device ? ", preferred on the device" : "")
+          << (read_mostly ? ", read mostly" : "");
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Managed memory placement is only supported with CUDA."));
+#endif
+}
+
+#ifdef PADDLE_WITH_CUDA
+bool ManagedMemoryAdvisor::Prefetch(const phi::Allocation* allocation,
+                                    cudaStream_t stream) {
+  auto* managed = dynamic_cast<const ManagedAllocation*>(allocation);
+  if (managed == nullptr || !managed->prefer_device()) {
+    return false;
+  }
+  int device_id = managed->place().GetDeviceId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = side_streams_.find(device_id);
+  if (it == side_streams_.end()) {
+    platform::CUDADeviceGuard guard(device_id);
+    SideStream side_stream;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamCreateWithFlags(
+        &side_stream.stream, cudaStreamNonBlocking));
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventCreateWithFlags(
+        &side_stream.event, cudaEventDisableTiming));
+    it = side_streams_.emplace(device_id, side_stream).first;
+  }
+  // The pages migrate while the kernels before the wait run.
+  auto& side_stream = it->second;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPrefetchAsync(
+      managed->ptr(), managed->size(), device_id, side_stream.stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaEventRecord(side_stream.event, side_stream.stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamWaitEvent(stream, side_stream.event, 0));
+  DEVICE_MEMORY_STAT_UPDATE(Prefetched, device_id, managed->size());
+  return true;
+}
+#endif
+
+void ManagedMemoryAdvisor::Release(size_t size, int device_id) {
+  --num_placed_;
+  DEVICE_MEMORY_STAT_UPDATE(Managed, device_id, -static_cast<int64_t>(size));
+}
+
+}  // namespace paddle::memory
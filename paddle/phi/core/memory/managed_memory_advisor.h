@@ -0,0 +1,92 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/test_macros.h"
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+namespace paddle {
+namespace memory {
+
+/**
+ * ManagedMemoryAdvisor places the specified large tensors, e.g. the
+ * embedding tables and the KV caches, in the CUDA managed memory of a
+ * device, so they may be larger than the device memory. The other tensors
+ * still use the allocator of the device.
+ *
+ * A tensor up to FLAGS_managed_memory_prefetch_limit_mb is preferred on the
+ * device, and the executor prefetches it before the instructions reading it,
+ * see FLAGS_pir_managed_prefetch_lookahead. A larger one is preferred on the
+ * host and mapped by the device, so its pages are read remotely instead of
+ * thrashing the device memory, and a read mostly one gets copies of the pages
+ * read on the device.
+ */
+class ManagedMemoryAdvisor {
+ public:
+  TEST_API static ManagedMemoryAdvisor& Instance();
+
+  // Whether any tensor is placed, which is checked before Prefetch.
+  bool enabled() const {
+    return num_placed_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Moves the data of an initialized CPU or GPU tensor to the managed memory
+  // of the device, and the tensor to the device.
+  TEST_API void Place(phi::DenseTensor* tensor,
+                      int device_id,
+                      bool read_mostly);
+
+  TEST_API static bool IsManaged(const phi::Allocation* allocation);
+
+#ifdef PADDLE_WITH_CUDA
+  // Prefetches a managed allocation to its device on a side stream, and
+  // makes stream wait for it. Returns false if the allocation is not managed
+  // or is not preferred on the device.
+  TEST_API bool Prefetch(const phi::Allocation* allocation,
+                         cudaStream_t stream);
+#endif
+
+ private:
+  ManagedMemoryAdvisor() = default;
+  DISABLE_COPY_AND_ASSIGN(ManagedMemoryAdvisor);
+
+  void Release(size_t size, int device_id);
+
+#ifdef PADDLE_WITH_CUDA
+  struct SideStream {
+    cudaStream_t stream;
+    cudaEvent_t event;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<int, SideStream> side_streams_;
+#endif
+  std::atomic<int64_t> num_placed_{0};
+
+  friend class ManagedAllocation;
+};
+
+}  // namespace memory
+}  // namespace paddle
@@ -163,9 +163,20 @@ void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name) {
 int RegisterAllStats() {
   DEVICE_MEMORY_STAT_REGISTER(Allocated);
   DEVICE_MEMORY_STAT_REGISTER(Reserved);
+  DEVICE_MEMORY_STAT_REGISTER(ThreadCacheHit);
+  DEVICE_MEMORY_STAT_REGISTER(ThreadCacheMiss);
+  DEVICE_MEMORY_STAT_REGISTER(SegmentFree);
+  DEVICE_MEMORY_STAT_REGISTER(SegmentLargestFreeBlock);
+  DEVICE_MEMORY_STAT_REGISTER(DeferredFree);
+  DEVICE_MEMORY_STAT_REGISTER(EventPoll);
+  DEVICE_MEMORY_STAT_REGISTER(Evicted);
+  DEVICE_MEMORY_STAT_REGISTER(Managed);
+  DEVICE_MEMORY_STAT_REGISTER(Prefetched);
 
   HOST_MEMORY_STAT_REGISTER(Allocated);
   HOST_MEMORY_STAT_REGISTER(Reserved);
+  HOST_MEMORY_STAT_REGISTER(ThreadCacheHit);
+  HOST_MEMORY_STAT_REGISTER(ThreadCacheMiss);
   return 0;
 }
 
@@ -228,9 +228,29 @@ void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name);
 // To add a new STAT type, declare here and register in stats.cc
 DEVICE_MEMORY_STAT_DECLARE(Allocated);
 DEVICE_MEMORY_STAT_DECLARE(Reserved);
+// Hit and miss counts of the AutoGrowthBestFitAllocator thread cache
+DEVICE_MEMORY_STAT_DECLARE(ThreadCacheHit);
+DEVICE_MEMORY_STAT_DECLARE(ThreadCacheMiss);
+// The fragmentation of the ExpandableSegmentAllocator: the mapped but not
+// allocated bytes of the segments of a device, and the largest free block of
+// them
+DEVICE_MEMORY_STAT_DECLARE(SegmentFree);
+DEVICE_MEMORY_STAT_DECLARE(SegmentLargestFreeBlock);
+// The bytes of the StreamSafeCUDAAllocator deferred until the other streams
+// complete, and the number of the events it polled
+DEVICE_MEMORY_STAT_DECLARE(DeferredFree);
+DEVICE_MEMORY_STAT_DECLARE(EventPoll);
+// The bytes of the tensors of a device evicted to the host by TensorEvictor
+DEVICE_MEMORY_STAT_DECLARE(Evicted);
+// The bytes of the tensors of a device placed in managed memory by
+// ManagedMemoryAdvisor, and the bytes prefetched to the device
+DEVICE_MEMORY_STAT_DECLARE(Managed);
+DEVICE_MEMORY_STAT_DECLARE(Prefetched);
 
 HOST_MEMORY_STAT_DECLARE(Allocated);
 HOST_MEMORY_STAT_DECLARE(Reserved);
+HOST_MEMORY_STAT_DECLARE(ThreadCacheHit);
+HOST_MEMORY_STAT_DECLARE(ThreadCacheMiss);
 
 }  // namespace memory
 }  // namespace paddle
@@ -0,0 +1,269 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/tensor_evictor.h"
+
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/memory/allocation/retry_allocator.h"
+#include "paddle/phi/core/memory/malloc.h"
+#include "paddle/phi/core/memory/stats.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_bool(eager_evict_tensors_on_oom);
+
+namespace paddle::memory {
+
+namespace {
+
+struct ThreadPins {
+  // The number of the active PinScopes.
+  size_t depth = 0;
+  std::vector<const phi::DenseTensor*> tensors;
+};
+
+ThreadPins& GetThreadPins() {
+  static thread_local ThreadPins pins;
+  return pins;
+}
+
+}  // namespace
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+namespace {
+
+#ifdef PADDLE_WITH_HIP
+constexpr gpuMemcpyKind kDeviceToHost = hipMemcpyDeviceToHost;
+constexpr gpuMemcpyKind kHostToDevice = hipMemcpyHostToDevice;
+#else
+constexpr gpuMemcpyKind kDeviceToHost = cudaMemcpyDeviceToHost;
+constexpr gpuMemcpyKind kHostToDevice = cudaMemcpyHostToDevice;
+#endif
+
+// The holder of an evicted tensor: the pinned memory of its data, which
+// still claims the place of the tensor.
+class EvictedAllocation : public phi::Allocation {
+ public:
+  EvictedAllocation(std::shared_ptr<phi::Allocation> host_buffer,
+                    size_t size,
+                    const phi::Place& place)
+      : phi::Allocation(host_buffer->ptr(), size, place),
+        host_buffer_(std::move(host_buffer)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> host_buffer_;
+};
+
+gpuStream_t ComputeStream(const phi::Place& place) {
+  return static_cast<phi::GPUContext*>(
+             phi::DeviceContextPool::Instance().Get(place))
+      ->stream();
+}
+
+}  // namespace
+#endif
+
+TensorEvictor::PinScope::PinScope() {
+  auto& pins = GetThreadPins();
+  begin_ = pins.tensors.size();
+  ++pins.depth;
+}
+
+TensorEvictor::PinScope::~PinScope() {
+  auto& pins = GetThreadPins();
+  --pins.depth;
+  if (pins.tensors.size() > begin_) {
+    TensorEvictor::Instance().Unpin(begin_);
+  }
+}
+
+TensorEvictor& TensorEvictor::Instance() {
+  static TensorEvictor evictor;
+  return evictor;
+}
+
+TensorEvictor::TensorEvictor() {
+  if (FLAGS_eager_evict_tensors_on_oom) {
+    allocation::SetMemoryPressureHandler(
+        [this](const phi::Place& place, size_t size) {
+          return Evict(place, size);
+        });
+  }
+}
+
+void TensorEvictor::Register(const std::shared_ptr<phi::DenseTensor>& tensor) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!FLAGS_eager_evict_tensors_on_oom || !tensor->initialized() ||
+      !phi::is_gpu_place(tensor->place())) {
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto it = entries_.find(tensor.get());
+  if (it != entries_.end()) {
+    if (it->second->tensor.lock() == tensor) {
+      lru_.splice(lru_.end(), lru_, it->second);
+      return;
+    }
+    // A destroyed tensor was at the same address.
+    Erase(it->second);
+  }
+  lru_.push_back(Entry{tensor.get(), tensor, false, 0, tensor->place(), 0});
+  entries_[tensor.get()] = std::prev(lru_.end());
+  num_registered_ = lru_.size();
+#endif
+}
+
+void TensorEvictor::Touch(phi::DenseTensor* tensor) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto it = entries_.find(tensor);
+  if (it == entries_.end()) {
+    return;
+  }
+  auto entry_it = it->second;
+  if (entry_it->tensor.lock().get() != tensor) {
+    Erase(entry_it);
+    return;
+  }
+  lru_.splice(lru_.end(), lru_, entry_it);
+  auto& pins = GetThreadPins();
+  if (pins.depth > 0) {
+    ++entry_it->pins;
+    pins.tensors.push_back(tensor);
+  }
+  if (entry_it->evicted) {
+    PageIn(&(*entry_it), tensor);
+  }
+}
+
+size_t TensorEvictor::Evict(const phi::Place& place, size_t size) {
+  if (!phi::is_gpu_place(place)) {
+    return 0;
+  }
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  size_t evicted_size = 0;
+  for (auto it = lru_.begin(); it != lru_.end() && evicted_size < size;) {
+    std::shared_ptr<phi::DenseTensor> tensor = it->tensor.lock();
+    if (!tensor) {
+      auto expired = it++;
+      Erase(expired);
+      continue;
+    }
+    const auto& holder = tensor->Holder();
+    if (it->evicted || it->pins > 0 || !holder || holder->place() != place ||
+        holder.use_count() > 1) {
+      ++it;
+      continue;
+    }
+    size_t holder_size = holder->size();
+    try {
+      EvictTensor(&(*it), tensor.get());
+    } catch (allocation::BadAlloc&) {
+      VLOG(4) << "No pinned memory to evict the tensors to";
+      break;
+    }
+    evicted_size += holder_size;
+    ++it;
+  }
+  VLOG(4) << "Evicted " << evicted_size << " bytes of tensors on " << place
+          << " to allocate " << size << " bytes";
+  return evicted_size;
+}
+
+bool TensorEvictor::IsEvicted(const phi::DenseTensor* tensor) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto it = entries_.find(tensor);
+  return it != entries_.end() && it->second->evicted;
+}
+
+void TensorEvictor::EvictTensor(Entry* entry, phi::DenseTensor* tensor) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  const auto& holder = tensor->Holder();
+  phi::Place place = holder->place();
+  size_t size = holder->size();
+  auto host_buffer = AllocShared(phi::GPUPinnedPlace(), size);
+  // The kernels using the tensor are done once the copy is.
+  gpuStream_t stream = ComputeStream(place);
+  platform::GpuMemcpyAsync(
+      host_buffer->ptr(), holder->ptr(), size, kDeviceToHost, stream);
+  platform::GpuStreamSync(stream);
+  tensor->ResetHolder(
+      std::make_shared<EvictedAllocation>(std::move(host_buffer), size, place));
+  entry->evicted = true;
+  entry->place = place;
+  entry->size = size;
+  DEVICE_MEMORY_STAT_UPDATE(Evicted, place.GetDeviceId(), size);
+#endif
+}
+
+void TensorEvictor::PageIn(Entry* entry, phi::DenseTensor* tensor) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  const auto& holder = tensor->Holder();
+  // The holder is replaced since the eviction, e.g. the tensor is assigned.
+  if (dynamic_cast<EvictedAllocation*>(holder.get()) == nullptr) {
+    entry->evicted = false;
+    DEVICE_MEMORY_STAT_UPDATE(
+        Evicted, entry->place.GetDeviceId(), -entry->size);
+    return;
+  }
+  std::shared_ptr<phi::Allocation> device_buffer;
+  try {
+    // Allocating may evict the other tensors, but not this one.
+    device_buffer = AllocShared(entry->place, entry->size);
+  } catch (allocation::BadAlloc&) {
+    // The kernels read the pinned memory instead.
+    VLOG(4) << "No memory to page in " << entry->size << " bytes of tensor on "
+            << entry->place;
+    return;
+  }
+  gpuStream_t stream = ComputeStream(entry->place);
+  platform::GpuMemcpyAsync(
+      device_buffer->ptr(), holder->ptr(), entry->size, kHostToDevice, stream);
+  platform::GpuStreamSync(stream);
+  tensor->ResetHolder(device_buffer);
+  entry->evicted = false;
+  DEVICE_MEMORY_STAT_UPDATE(Evicted, entry->place.GetDeviceId(), -entry->size);
+  VLOG(6) << "Paged in " << entry->size << " bytes of tensor on "
+          << entry->place;
+#endif
+}
+
+void TensorEvictor::Erase(std::list<Entry>::iterator it) {
+  if (it->evicted) {
+    DEVICE_MEMORY_STAT_UPDATE(Evicted, it->place.GetDeviceId(), -it->size);
+  }
+  entries_.erase(it->key);
+  lru_.erase(it);
+  num_registered_ = lru_.size();
+}
+
+void TensorEvictor::Unpin(size_t begin) {
+  auto& tensors = GetThreadPins().tensors;
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  for (size_t i = begin; i < tensors.size(); ++i) {
+    auto it = entries_.find(tensors[i]);
+    // The tensor may be destroyed while it is pinned.
+    if (it != entries_.end() && it->second->pins > 0) {
+      --it->second->pins;
+    }
+  }
+  tensors.resize(begin);
+}
+
+}  // namespace paddle::memory
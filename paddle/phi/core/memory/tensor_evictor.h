@@ -0,0 +1,113 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/test_macros.h"
+
+namespace paddle {
+namespace memory {
+
+/**
+ * TensorEvictor moves the evictable tensors to pinned host memory when the
+ * GPU runs out of memory, see FLAGS_eager_evict_tensors_on_oom. The tensors
+ * are registered as evictable, e.g. the frozen parameters, the optimizer
+ * states and the activations saved for the backward, and the least recently
+ * used ones of the place are evicted by the RetryAllocator whose allocation
+ * fails, until enough memory is freed.
+ *
+ * An evicted tensor is paged back to the GPU by swapping its holder when a
+ * kernel takes it as an input, see PrepareData. Until then its holder is the
+ * pinned memory, which the device still reads by the unified addressing.
+ * A tensor sharing its holder with another one is not evicted, since that
+ * frees nothing. Neither is an input of a running kernel, which is pinned by
+ * the PinScope of its API while the kernel allocates its outputs.
+ */
+class TensorEvictor {
+ public:
+  // Pins the tensors touched on this thread until it is destroyed, so that
+  // they are not evicted by the allocations of the same kernel.
+  class PinScope {
+   public:
+    TEST_API PinScope();
+    TEST_API ~PinScope();
+
+   private:
+    DISABLE_COPY_AND_ASSIGN(PinScope);
+    // The number of the tensors pinned on this thread before the scope.
+    size_t begin_;
+  };
+
+  TEST_API static TensorEvictor& Instance();
+
+  // Whether any tensor is registered, which is checked before Touch.
+  bool enabled() const {
+    return num_registered_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Registers an initialized GPU tensor as evictable, it is dropped once the
+  // tensor is destroyed.
+  TEST_API void Register(const std::shared_ptr<phi::DenseTensor>& tensor);
+
+  // Marks the tensor as used, and pages it back if it is evicted. The tensor
+  // is pinned if a PinScope is active on this thread.
+  TEST_API void Touch(phi::DenseTensor* tensor);
+
+  // Evicts the least recently used tensors of the place until size bytes are
+  // freed, and returns the bytes freed.
+  TEST_API size_t Evict(const phi::Place& place, size_t size);
+
+  TEST_API bool IsEvicted(const phi::DenseTensor* tensor);
+
+ private:
+  struct Entry {
+    const phi::DenseTensor* key;
+    std::weak_ptr<phi::DenseTensor> tensor;
+    bool evicted;
+    // The number of the PinScopes pinning the tensor.
+    size_t pins;
+    // The place and the bytes of the evicted holder.
+    phi::Place place;
+    size_t size;
+  };
+
+  TensorEvictor();
+  DISABLE_COPY_AND_ASSIGN(TensorEvictor);
+
+  void EvictTensor(Entry* entry, phi::DenseTensor* tensor);
+  void PageIn(Entry* entry, phi::DenseTensor* tensor);
+  void Erase(std::list<Entry>::iterator it);
+  // Unpins the tensors pinned on this thread since the first begin ones.
+  void Unpin(size_t begin);
+
+  // Recursive since paging a tensor in may evict the others.
+  std::recursive_mutex mutex_;
+  // From the least recently used one.
+  std::list<Entry> lru_;
+  std::unordered_map<const phi::DenseTensor*, std::list<Entry>::iterator>
+      entries_;
+  std::atomic<size_t> num_registered_{0};
+};
+
+}  // namespace memory
+}  // namespace paddle
@@ -213,6 +213,11 @@ void BufferedReader::ReadAsync(size_t i) {
 
         phi::RecordEvent record_event(
             "BufferedReader:MemoryCopy", phi::TracerEventType::UserDefined, 1);
+        // the pinned staging buffers are kept until the copies of the whole
+        // batch are done, so that the stream is synchronized once per batch
+        // instead of once per tensor
+        std::vector<phi::DenseTensor> cuda_pinned_tensors;
+        cuda_pinned_tensors.reserve(cpu.size());
         for (size_t i = 0; i < cpu.size(); ++i) {
           auto cpu_place = cpu[i].place();
           auto cpu_ptr = cpu[i].data();
@@ -224,7 +229,8 @@ void BufferedReader::ReadAsync(size_t i) {
                 place_, gpu_ptr, cpu_place, cpu_ptr, size, stream_.get());
           } else {
             phi::GPUPinnedPlace cuda_pinned_place;
-            phi::DenseTensor cuda_pinned_tensor;
+            cuda_pinned_tensors.emplace_back();
+            phi::DenseTensor &cuda_pinned_tensor = cuda_pinned_tensors.back();
             cuda_pinned_tensor.Resize(cpu[i].dims());
             auto cuda_pinned_ptr =
                 dev_ctx_gpu->Alloc(&cuda_pinned_tensor,
@@ -239,8 +245,6 @@ void BufferedReader::ReadAsync(size_t i) {
                                     cuda_pinned_ptr,
                                     size,
                                     stream_.get());
-
-            phi::backends::gpu::GpuStreamSync(stream_.get());
           }
           cuda[i].set_lod(cpu[i].lod());
         }
@@ -0,0 +1,256 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_int32(intra_op_threadpool_size);
+
+namespace phi {
+
+namespace {
+
+// The chunks of a loop per thread, more than one to balance the threads
+// running the chunks of uneven iterations.
+constexpr int64_t kChunksPerThread = 4;
+
+thread_local int intra_op_num_threads = 1;
+thread_local bool in_parallel_region = false;
+
+// The threads shared by the parallel loops of all the CPU kernels. Each
+// thread owns a queue of tasks, runs the latest task of its own queue first,
+// and steals the oldest task of the others when its own queue is empty.
+class IntraOpThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit IntraOpThreadPool(int num_threads)
+      : queues_(num_threads), running_(true) {
+    threads_.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this, i] { TaskLoop(i); });
+    }
+  }
+
+  ~IntraOpThreadPool() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    scheduled_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  static IntraOpThreadPool* GetInstance() {
+    static std::once_flag init_flag;
+    static std::unique_ptr<IntraOpThreadPool> pool;
+    std::call_once(init_flag, [] {
+      int num_threads = FLAGS_intra_op_threadpool_size > 0
+                            ? FLAGS_intra_op_threadpool_size
+                            : static_cast<int>(
+                                  std::thread::hardware_concurrency());
+      // The thread starting a loop runs its chunks as well.
+      num_threads = std::max(num_threads - 1, 0);
+      VLOG(1) << "create the intra-op thread pool of " << num_threads
+              << " threads";
+      pool = std::make_unique<IntraOpThreadPool>(num_threads);
+    });
+    return pool.get();
+  }
+
+  int NumThreads() const { return static_cast<int>(threads_.size()); }
+
+  void Schedule(Task task) {
+    size_t idx = next_queue_.fetch_add(1) % queues_.size();
+    {
+      std::lock_guard<std::mutex> lock(queues_[idx].mutex);
+      queues_[idx].tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++num_pending_;
+    }
+    scheduled_.notify_one();
+  }
+
+ private:
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool PopOwn(size_t idx, Task* task) {
+    std::lock_guard<std::mutex> lock(queues_[idx].mutex);
+    if (queues_[idx].tasks.empty()) return false;
+    *task = std::move(queues_[idx].tasks.back());
+    queues_[idx].tasks.pop_back();
+    return true;
+  }
+
+  bool Steal(size_t idx, Task* task) {
+    std::lock_guard<std::mutex> lock(queues_[idx].mutex);
+    if (queues_[idx].tasks.empty()) return false;
+    *task = std::move(queues_[idx].tasks.front());
+    queues_[idx].tasks.pop_front();
+    return true;
+  }
+
+  void TaskLoop(size_t idx) {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        scheduled_.wait(lock, [this] { return num_pending_ > 0 || !running_; });
+        if (num_pending_ == 0) return;
+        // Reserve one of the tasks queued, which are never fewer than the
+        // tasks reserved, so the search below always ends with a task.
+        --num_pending_;
+      }
+      Task task;
+      for (size_t i = 0;; ++i) {
+        size_t victim = (idx + i) % queues_.size();
+        if (victim == idx ? PopOwn(idx, &task) : Steal(victim, &task)) break;
+      }
+      task();
+    }
+  }
+
+  std::vector<TaskQueue> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_queue_{0};
+
+  std::mutex mutex_;
+  std::condition_variable scheduled_;
+  int64_t num_pending_ = 0;
+  bool running_;
+};
+
+// The chunks of a loop, claimed by the thread starting it and the helpers
+// scheduled to the pool. It outlives the loop for the helpers starting after
+// all the chunks are done, which claim nothing and never touch fn.
+struct LoopState {
+  int64_t begin;
+  int64_t end;
+  int64_t chunk_size;
+  int64_t num_chunks;
+  const std::function<void(int64_t, int64_t)>* fn;
+
+  std::atomic<int64_t> next_chunk{0};
+  std::atomic<int64_t> num_done{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception;
+
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+void RunChunks(LoopState* state) {
+  bool prev_in_parallel_region = in_parallel_region;
+  in_parallel_region = true;
+  while (true) {
+    int64_t chunk = state->next_chunk.fetch_add(1);
+    if (chunk >= state->num_chunks) break;
+    // The chunks after a failure are skipped, but still counted as done.
+    if (!state->failed.load()) {
+      int64_t chunk_begin = state->begin + chunk * state->chunk_size;
+      int64_t chunk_end =
+          std::min(chunk_begin + state->chunk_size, state->end);
+      try {
+        (*state->fn)(chunk_begin, chunk_end);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->exception) state->exception = std::current_exception();
+        state->failed.store(true);
+      }
+    }
+    if (state->num_done.fetch_add(1) + 1 == state->num_chunks) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->done.notify_all();
+    }
+  }
+  in_parallel_region = prev_in_parallel_region;
+}
+
+}  // namespace
+
+void SetIntraOpNumThreads(int num_threads) {
+  intra_op_num_threads = std::max(num_threads, 1);
+}
+
+int GetIntraOpNumThreads() { return intra_op_num_threads; }
+
+bool InParallelRegion() { return in_parallel_region; }
+
+void ParallelFor(int64_t begin,
+                 int64_t end,
+                 int64_t grain_size,
+                 const std::function<void(int64_t, int64_t)>& fn) {
+  if (begin >= end) return;
+  grain_size = std::max<int64_t>(grain_size, 1);
+  int64_t range = end - begin;
+  int64_t max_chunks = (range + grain_size - 1) / grain_size;
+  int64_t num_threads =
+      in_parallel_region
+          ? 1
+          : std::min<int64_t>(intra_op_num_threads, max_chunks);
+  if (num_threads <= 1) {
+    fn(begin, end);
+    return;
+  }
+  auto* pool = IntraOpThreadPool::GetInstance();
+  num_threads = std::min<int64_t>(num_threads, pool->NumThreads() + 1);
+  if (num_threads <= 1) {
+    fn(begin, end);
+    return;
+  }
+
+  auto state = std::make_shared<LoopState>();
+  int64_t num_chunks =
+      std::min<int64_t>(max_chunks, num_threads * kChunksPerThread);
+  state->begin = begin;
+  state->end = end;
+  state->chunk_size = (range + num_chunks - 1) / num_chunks;
+  state->num_chunks = (range + state->chunk_size - 1) / state->chunk_size;
+  state->fn = &fn;
+
+  for (int64_t i = 1; i < num_threads; ++i) {
+    pool->Schedule([state] { RunChunks(state.get()); });
+  }
+  RunChunks(state.get());
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state] {
+      return state->num_done.load() == state->num_chunks;
+    });
+  }
+  if (state->exception) {
+    std::rethrow_exception(state->exception);
+  }
+}
+
+}  // namespace phi
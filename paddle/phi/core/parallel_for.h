@@ -0,0 +1,61 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "paddle/utils/test_macros.h"
+
+namespace phi {
+
+// The elements worth the scheduling of a chunk of a parallel loop.
+constexpr int64_t kParallelMinElements = 32768;
+
+// The grain size of a loop whose iterations process elements each, e.g. the
+// rows of a matrix.
+inline int64_t ParallelGrainSize(int64_t elements) {
+  return elements >= kParallelMinElements
+             ? 1
+             : kParallelMinElements / (elements > 0 ? elements : 1);
+}
+
+// The number of threads the parallel loops started by the calling thread may
+// use, the calling thread included. It is set by SetNumThreads of the
+// predictor or the trainer running on the thread, and is 1 by default, in
+// which case the loops run serially.
+TEST_API void SetIntraOpNumThreads(int num_threads);
+TEST_API int GetIntraOpNumThreads();
+
+// Whether the calling thread is running a chunk of a parallel loop.
+TEST_API bool InParallelRegion();
+
+// Runs fn(chunk_begin, chunk_end) over the disjoint chunks covering
+// [begin, end), on the calling thread and the intra-op thread pool shared by
+// all the CPU kernels. A chunk holds grain_size iterations at least, so that
+// grain_size is the number of iterations worth the scheduling of a task.
+//
+// The chunks are claimed by the threads as they become idle, and the tasks
+// of the pool are stolen by its idle threads, which balances the loops of
+// uneven iterations. The loop runs serially on the calling thread if its
+// budget is 1, the range holds a single chunk or it is nested in another
+// parallel loop. The first exception thrown by fn is rethrown after all the
+// chunks claimed are done.
+TEST_API void ParallelFor(int64_t begin,
+                          int64_t end,
+                          int64_t grain_size,
+                          const std::function<void(int64_t, int64_t)>& fn);
+
+}  // namespace phi
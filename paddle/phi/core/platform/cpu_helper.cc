@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/phi/core/platform/cpu_helper.h"
 
+#include "paddle/phi/core/parallel_for.h"
+
 #ifdef PADDLE_WITH_MKLML
 #include <omp.h>
 
@@ -30,6 +32,9 @@ namespace paddle {
 namespace platform {
 
 void SetNumThreads(int num_threads) {
+  // The parallel loops of the CPU kernels share the budget of the math
+  // library on this thread.
+  phi::SetIntraOpNumThreads(num_threads);
 #ifdef PADDLE_USE_OPENBLAS
 // windows has no support for openblas multi-thread
 // please refer to: https://github.com/PaddlePaddle/Paddle/issues/7234
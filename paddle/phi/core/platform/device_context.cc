@@ -113,6 +113,10 @@ inline std::unique_ptr<DeviceContext> CreateDeviceContext(
     if (!disable_setting_default_stream_for_allocator) {
       instance.SetDefaultStream(phi::XPUPlace(p.GetDeviceId()),
                                 xpu_ctx->stream());
+    } else {
+      // The contexts of the streams of the executor run on their own stream
+      // instead of the null stream of the default context.
+      xpu_ctx->CreateStream();
     }
     dev_ctx->SetAllocator(instance.GetAllocator(p, xpu_ctx->stream()).get());
     dev_ctx->SetGenerator(phi::DefaultXPUGenerator(p.GetDeviceId()).get());
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_XPU
+
+#include "paddle/phi/backends/xpu/enforce_xpu.h"
+#include "paddle/phi/backends/xpu/xpu_context.h"
+#include "paddle/phi/core/platform/device/xpu/xpu_resource_pool.h"
+#include "paddle/phi/core/platform/device_event_base.h"
+
+namespace paddle {
+namespace platform {
+struct XPUDeviceEventWrapper {
+  explicit XPUDeviceEventWrapper(const phi::Place& place) {
+    PADDLE_ENFORCE_EQ(
+        phi::is_xpu_place(place),
+        true,
+        common::errors::PreconditionNotMet(
+            "Required device shall be XPUPlace, but received %d. ", place));
+
+    device_id_ = place.device;  // NOLINT
+    PADDLE_ENFORCE_GT(
+        device_id_,
+        -1,
+        common::errors::PreconditionNotMet(
+            "Required DeviceOption.device_id > -1, but received %d. ",
+            device_id_));
+    inner_event_ = XpuEventResourcePool::Instance().New(device_id_);
+  }
+
+  std::shared_ptr<XpuEventObject> inner_event_;
+  // The XPU runtime can not wait for an event on the host, so the host waits
+  // for the stream it is recorded on.
+  XPUStream recorded_stream_{nullptr};
+  bool recorded_{false};
+  int device_id_;
+};
+
+void DeviceEventCreateXPU(DeviceEvent* event,
+                          const phi::Place& place,
+                          unsigned int) {
+  event->InitEvent(std::make_shared<XPUDeviceEventWrapper>(place));
+}
+
+void DeviceEventRecordXPU(DeviceEvent* event, const DeviceContext* context) {
+  auto* wrapper = static_cast<XPUDeviceEventWrapper*>(event->GetEvent().get());
+  auto* xpu_dev_ctx = dynamic_cast<const phi::XPUContext*>(context);
+  PADDLE_ENFORCE_NOT_NULL(
+      xpu_dev_ctx,
+      common::errors::PreconditionNotMet(
+          "Failed to dynamic_cast context into phi::XPUContext."));
+
+  phi::backends::xpu::XPUDeviceGuard guard(wrapper->device_id_);
+  PADDLE_ENFORCE_XRE_SUCCESS(
+      xpu_event_record(wrapper->inner_event_.get(), xpu_dev_ctx->stream()));
+  wrapper->recorded_stream_ = xpu_dev_ctx->stream();
+  wrapper->recorded_ = true;
+}
+
+void DeviceEventFinishXPU(const DeviceEvent* event) {
+  auto* wrapper = static_cast<XPUDeviceEventWrapper*>(event->GetEvent().get());
+  if (!wrapper->recorded_) {
+    return;
+  }
+  phi::backends::xpu::XPUDeviceGuard guard(wrapper->device_id_);
+  PADDLE_ENFORCE_XPU_SUCCESS(xpu_wait(wrapper->recorded_stream_));
+}
+
+bool DeviceEventQueryXPU(const DeviceEvent* event) {
+  auto* wrapper = static_cast<XPUDeviceEventWrapper*>(event->GetEvent().get());
+  PADDLE_ENFORCE_NOT_NULL(
+      wrapper,
+      common::errors::PreconditionNotMet(
+          "Failed to dynamic_cast event into XPUDeviceEventWrapper."));
+  // the XPU runtime has no query of an event, so it is waited for
+  DeviceEventFinishXPU(event);
+  return true;
+}
+
+void DeviceEventXPUWaitXPU(const DeviceEvent* event,
+                           const DeviceContext* context) {
+  auto* wrapper = static_cast<XPUDeviceEventWrapper*>(event->GetEvent().get());
+  auto* xpu_dev_ctx = dynamic_cast<const phi::XPUContext*>(context);
+  PADDLE_ENFORCE_NOT_NULL(
+      xpu_dev_ctx,
+      common::errors::PreconditionNotMet(
+          "Failed to dynamic_cast context into phi::XPUContext."));
+  // calling xpu_stream_wait_event(stream, event)
+  xpu_dev_ctx->StreamWaitEvent(wrapper->inner_event_.get(), 0);
+}
+
+void DeviceEventCPUWaitXPU(const DeviceEvent* event,
+                           const DeviceContext* context) {
+  DeviceEventFinishXPU(event);
+}
+
+void DeviceEventSetFinishedXPU(const DeviceEvent* event) {
+  // do nothing
+}
+
+void EventResetXPU(const DeviceEvent* event) {
+  // do nothing
+}
+
+}  // namespace platform
+}  // namespace paddle
+
+using ::paddle::platform::kCPU;
+using ::paddle::platform::kXPU;
+REGISTER_EVENT_CREATE_FUNCTION(kXPU, paddle::platform::DeviceEventCreateXPU)
+REGISTER_EVENT_RECORD_FUNCTION(kXPU, paddle::platform::DeviceEventRecordXPU)
+REGISTER_EVENT_QUERY_FUNCTION(kXPU, paddle::platform::DeviceEventQueryXPU)
+REGISTER_EVENT_FINISH_FUNCTION(kXPU, paddle::platform::DeviceEventFinishXPU)
+REGISTER_EVENT_SET_FINISHED_FUNCTION(
+    kXPU, paddle::platform::DeviceEventSetFinishedXPU)
+REGISTER_EVENT_WAIT_FUNCTION(kXPU,
+                             kXPU,
+                             paddle::platform::DeviceEventXPUWaitXPU)
+REGISTER_EVENT_WAIT_FUNCTION(kCPU,
+                             kXPU,
+                             paddle::platform::DeviceEventCPUWaitXPU)
+REGISTER_EVENT_RESET_FUNCTION(kXPU, paddle::platform::EventResetXPU)
+#endif
@@ -26,6 +26,9 @@ std::unique_ptr<StorageProperties> CopyStorageProperties(
       result->storage_dims =
           static_cast<NPUStorageProperties*>(sp.get())->storage_dims;
       return result;
+    } else if (CPUPackedGemmStorageProperties::classof(sp.get())) {
+      return std::make_unique<CPUPackedGemmStorageProperties>(
+          *static_cast<CPUPackedGemmStorageProperties*>(sp.get()));
 #ifdef PADDLE_WITH_DNNL
     } else if (OneDNNStorageProperties::classof(sp.get())) {
       auto result = std::make_unique<OneDNNStorageProperties>();
@@ -49,6 +49,31 @@ struct NPUStorageProperties
   DDim storage_dims;
 };
 
+// The weight of the CPU GEMMs packed once into the layout of the BLAS
+// library, e.g. by cblas_sgemm_pack of MKL, for the kernels running the
+// GEMMs on the weight in each call. See funcs/gemm_pack.h.
+struct CPUPackedGemmStorageProperties
+    : public StorageProperties,
+      public TypeInfoTraits<StorageProperties,
+                            CPUPackedGemmStorageProperties> {
+  virtual ~CPUPackedGemmStorageProperties() = default;
+  static const char* name() { return "CPUPackedGemmStorageProperties"; }
+
+  /// \brief the packed matrix, shared by the copies of the tensor and
+  /// released by the BLAS library.
+  std::shared_ptr<void> packed_data;
+
+  /// \brief the data and the dims of the tensor packed, which tell the
+  /// packed tensor from its views of other shapes sharing the properties.
+  const void* src{nullptr};
+  DDim src_dims;
+
+  /// \brief whether the tensor is packed as the A matrix of the GEMMs or the
+  /// B matrix, and is transposed in the GEMMs.
+  bool is_a_matrix{false};
+  bool trans{false};
+};
+
 #ifdef PADDLE_WITH_XPU
 struct XPUStorageProperties
     : public StorageProperties,
@@ -137,4 +137,32 @@ void TensorArray::emplace_back() {
   tensors_.emplace_back(t);
 }
 
+bool TensorArray::StackedView(DenseTensor* out) const {
+  if (!storage_ || tensors_.empty() || tensors_.size() > storage_->rows) {
+    return false;
+  }
+  const DenseTensor& buffer = storage_->buffer;
+  const DDim& buffer_dims = buffer.dims();
+  const size_t row_bytes =
+      (buffer.numel() / buffer_dims[0]) * phi::SizeOf(buffer.dtype());
+  const auto* base = static_cast<const uint8_t*>(buffer.data());
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    const DenseTensor& tensor = tensors_[i];
+    if (!tensor.IsSharedBufferWith(buffer) ||
+        tensor.data() != base + i * row_bytes ||
+        tensor.dtype() != buffer.dtype() || !tensor.lod().empty() ||
+        tensor.numel() * phi::SizeOf(tensor.dtype()) != row_bytes ||
+        tensor.dims().size() + 1 != buffer_dims.size()) {
+      return false;
+    }
+    for (int j = 0; j < tensor.dims().size(); ++j) {
+      if (tensor.dims()[j] != buffer_dims[j + 1]) {
+        return false;
+      }
+    }
+  }
+  out->ShareDataWith(buffer.Slice(0, static_cast<int64_t>(tensors_.size())));
+  return true;
+}
+
 }  // namespace phi
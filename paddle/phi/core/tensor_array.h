@@ -14,6 +14,8 @@ limitations under the License. */
 
 #pragma once
 
+#include <memory>
+
 #include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
@@ -25,6 +27,16 @@ namespace phi {
 class TensorArray : public TensorBase,
                     public TypeInfoTraits<TensorBase, TensorArray> {
  public:
+  /// \brief The buffer the tensors of the same dims appended by array_write
+  /// are written in, one row each, so that they are stacked by one copy.
+  /// It is shared by the shallow copies of the TensorArray, and rows is the
+  /// number of rows written, which only the array that wrote the last row
+  /// may append to.
+  struct Storage {
+    DenseTensor buffer;
+    size_t rows{0};
+  };
+
   /// \brief Construct a TensorArray.
   /// \param vec The vector DenseTensor used to init TensorArray.
   explicit TensorArray(const std::vector<DenseTensor>& vec);
@@ -140,10 +152,23 @@ class TensorArray : public TensorBase,
     return tensors_.end();
   }
 
+  const std::shared_ptr<Storage>& storage() const { return storage_; }
+
+  void set_storage(const std::shared_ptr<Storage>& storage) {
+    storage_ = storage;
+  }
+
+  /// \brief Shares the rows of the storage holding all the tensors, in order,
+  /// with out, whose dims are the dims of the tensors stacked on axis 0. out
+  /// aliases the tensors, so it is to be copied before it is written.
+  /// \return Whether all the tensors are still the rows of the storage.
+  TEST_API bool StackedView(DenseTensor* out) const;
+
  private:
   DataType dtype_{DataType::UNDEFINED};
   DataLayout layout_{DataLayout::NCHW};
   std::vector<DenseTensor> tensors_;
+  std::shared_ptr<Storage> storage_;
 };
 
 }  // namespace phi
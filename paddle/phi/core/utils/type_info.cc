@@ -83,5 +83,7 @@ template class TypeInfoTraits<phi::StorageProperties, XPUStorageProperties>;
 #endif
 
 template class TypeInfoTraits<phi::StorageProperties, NPUStorageProperties>;
+template class TypeInfoTraits<phi::StorageProperties,
+                              CPUPackedGemmStorageProperties>;
 
 }  // namespace phi
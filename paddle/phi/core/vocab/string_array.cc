@@ -21,6 +21,16 @@ namespace phi {
 
 std::wstring_convert<std::codecvt_utf8<wchar_t>> kConverter;
 
+std::shared_ptr<const VocabTrie> Vocab::trie() const {
+  auto trie = std::atomic_load(&trie_);
+  if (!trie) {
+    // a race only builds the same trie twice
+    trie = std::make_shared<const VocabTrie>(data_);
+    std::atomic_store(&trie_, trie);
+  }
+  return trie;
+}
+
 // Convert the std::string type to the std::wstring type.
 bool ConvertStrToWstr(const std::string& src, std::wstring* res) {
   try {
@@ -17,12 +17,14 @@
 #include <codecvt>
 #include <iostream>
 #include <locale>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/extended_tensor.h"
 #include "paddle/phi/core/vocab/phi_tensor_base_vector.h"
+#include "paddle/phi/core/vocab/vocab_trie.h"
 
 namespace phi {
 template <>
@@ -50,6 +52,7 @@ class Vocab : public phi::ExtendedTensor,
   Vocab& operator=(
       const std::unordered_map<std::wstring, std::int32_t>& other) {
     this->data_ = other;
+    ResetTrie();
     return *this;
   }
 
@@ -63,12 +66,20 @@ class Vocab : public phi::ExtendedTensor,
 
   size_t size() const { return data_.size(); }
 
-  void clear() { data_.clear(); }
+  void clear() {
+    data_.clear();
+    ResetTrie();
+  }
 
   void emplace(const std::wstring& key, std::int32_t value) {
     data_.emplace(key, value);
+    ResetTrie();
   }
 
+  /// \brief Returns the trie of the tokens, built when it is first used after
+  /// the tokens are changed by emplace, clear or an assignment of a map.
+  std::shared_ptr<const VocabTrie> trie() const;
+
   std::int32_t at(const std::wstring& key) { return data_.at(key); }
 
   std::int32_t at(const std::wstring& key) const { return data_.at(key); }
@@ -100,7 +111,13 @@ class Vocab : public phi::ExtendedTensor,
   }
 
  private:
+  void ResetTrie() {
+    std::atomic_store(&trie_, std::shared_ptr<const VocabTrie>());
+  }
+
   std::unordered_map<std::wstring, std::int32_t> data_;
+  // built lazily by the tokenizers, which may share the vocab across threads
+  mutable std::shared_ptr<const VocabTrie> trie_;
 };
 
 // Note(YuanRisheng): PhiVector is essentially a vector that only used for PHI
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/vocab/vocab_trie.h"
+
+#include <algorithm>
+
+namespace phi {
+
+namespace {
+
+bool LessChar(const std::pair<wchar_t, std::int32_t>& child, wchar_t ch) {
+  return child.first < ch;
+}
+
+}  // namespace
+
+VocabTrie::VocabTrie(
+    const std::unordered_map<std::wstring, std::int32_t>& tokens,
+    const std::wstring& continuing_prefix)
+    : nodes_(2) {
+  for (const auto& item : tokens) {
+    Insert(0, item.first, 0, item.second);
+    if (!continuing_prefix.empty() &&
+        item.first.size() > continuing_prefix.size() &&
+        item.first.compare(
+            0, continuing_prefix.size(), continuing_prefix) == 0) {
+      Insert(1, item.first, continuing_prefix.size(), item.second);
+    }
+  }
+}
+
+std::int32_t VocabTrie::Child(std::int32_t node, wchar_t ch) const {
+  const auto& children = nodes_[node].children;
+  auto it = std::lower_bound(children.begin(), children.end(), ch, LessChar);
+  return it != children.end() && it->first == ch ? it->second : -1;
+}
+
+void VocabTrie::Insert(std::int32_t root,
+                       const std::wstring& token,
+                       size_t start,
+                       std::int32_t id) {
+  std::int32_t node = root;
+  for (size_t i = start; i < token.size(); ++i) {
+    wchar_t ch = token[i];
+    auto& children = nodes_[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), ch, LessChar);
+    if (it != children.end() && it->first == ch) {
+      node = it->second;
+      continue;
+    }
+    auto child = static_cast<std::int32_t>(nodes_.size());
+    children.emplace(it, ch, child);
+    // the children are not referenced any more when nodes_ grows
+    nodes_.emplace_back();
+    node = child;
+  }
+  nodes_[node].id = id;
+  nodes_[node].is_token = true;
+}
+
+size_t VocabTrie::LongestMatch(const std::wstring& text,
+                               size_t start,
+                               bool continuing,
+                               std::int32_t* id) const {
+  size_t match = 0;
+  std::int32_t node = continuing ? 1 : 0;
+  for (size_t i = start; i < text.size(); ++i) {
+    node = Child(node, text[i]);
+    if (node < 0) break;
+    if (nodes_[node].is_token) {
+      match = i - start + 1;
+      *id = nodes_[node].id;
+    }
+  }
+  return match;
+}
+
+}  // namespace phi
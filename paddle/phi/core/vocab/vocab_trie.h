@@ -0,0 +1,61 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace phi {
+
+// A trie of the tokens of a vocab for the WordPiece tokenization, which finds
+// the longest token at a position of a word in one walk of its characters
+// instead of looking up every substring of the word in the vocab.
+class VocabTrie {
+ public:
+  explicit VocabTrie(
+      const std::unordered_map<std::wstring, std::int32_t>& tokens,
+      const std::wstring& continuing_prefix = L"##");
+
+  // Returns the length of the longest token at text[start], and its id in
+  // *id, or 0 if no token is there. A continuing piece of a word matches the
+  // tokens with the continuing prefix, whose length is not counted.
+  size_t LongestMatch(const std::wstring& text,
+                      size_t start,
+                      bool continuing,
+                      std::int32_t* id) const;
+
+ private:
+  struct Node {
+    // the children sorted by the character
+    std::vector<std::pair<wchar_t, std::int32_t>> children;
+    std::int32_t id{0};
+    bool is_token{false};
+  };
+
+  std::int32_t Child(std::int32_t node, wchar_t ch) const;
+
+  void Insert(std::int32_t root,
+              const std::wstring& token,
+              size_t start,
+              std::int32_t id);
+
+  // nodes_[0] is the root of the words, nodes_[1] of the continuing pieces
+  std::vector<Node> nodes_;
+};
+
+}  // namespace phi
@@ -4914,6 +4914,67 @@ void FusionSeqpoolCvmConcatInferMeta(const std::vector<const MetaTensor*>& x,
   out->set_dtype((*x[0]).dtype());
 }
 
+void FusionEmbSeqpoolCvmConcatInferMeta(
+    const std::vector<const MetaTensor*>& ids,
+    const MetaTensor& w,
+    const MetaTensor& cvm,
+    const std::string& pooltype,
+    bool use_cvm,
+    int axis,
+    int64_t padding_idx,
+    MetaTensor* out,
+    MetaConfig config) {
+  PADDLE_ENFORCE_GE(
+      ids.size(),
+      1UL,
+      common::errors::InvalidArgument(
+          "Inputs(Ids) of FusionEmbSeqPoolCVMConcatOp should not be empty."));
+  PADDLE_ENFORCE_NE(
+      out,
+      nullptr,
+      common::errors::InvalidArgument(
+          "Output(Out) of FusionEmbSeqPoolCVMConcatOp should not be null."));
+  PADDLE_ENFORCE_EQ(axis,
+                    1,
+                    common::errors::InvalidArgument(
+                        "FusionEmbSeqPoolCVMConcatOp only supports concat "
+                        "axis=1 yet, but received %d.",
+                        axis));
+  PADDLE_ENFORCE_EQ(use_cvm,
+                    true,
+                    common::errors::InvalidArgument(
+                        "FusionEmbSeqPoolCVMConcatOp only supports use_cvm is "
+                        "true yet, but received %d.",
+                        use_cvm));
+  PADDLE_ENFORCE_EQ(
+      pooltype == "SUM" || pooltype == "AVERAGE" || pooltype == "SQRT",
+      true,
+      common::errors::InvalidArgument(
+          "FusionEmbSeqPoolCVMConcatOp only supports SUM, AVERAGE and SQRT "
+          "pooltype, but received %s.",
+          pooltype));
+
+  const auto& w_dims = w.dims();
+  PADDLE_ENFORCE_EQ(
+      w_dims.size(),
+      2,
+      common::errors::InvalidArgument(
+          "The dims size of W should be 2, but received %d.", w_dims.size()));
+  if (w_dims[1] > 0) {
+    PADDLE_ENFORCE_GE(w_dims[1],
+                      2,
+                      common::errors::InvalidArgument(
+                          "The width of W should be at least 2 for cvm, but "
+                          "received %d.",
+                          w_dims[1]));
+  }
+  // The output height should be confirmed in Compute,
+  // since input lod is not accessible here.
+  out->set_dims(
+      common::make_ddim({-1, w_dims[1] * static_cast<int64_t>(ids.size())}));
+  out->set_dtype(w.dtype());
+}
+
 void FusedTokenPruneInferMeta(const MetaTensor& attn,
                               const MetaTensor& x,
                               const MetaTensor& mask,
@@ -5977,4 +6038,206 @@ void ResnetBasicBlockGradInferMeta(const MetaTensor& x,
   }
 }
 
+void MoeGroupedGemmInferMeta(const MetaTensor& x,
+                             const MetaTensor& weight,
+                             const MetaTensor& tokens_per_expert,
+                             MetaTensor* out) {
+  const auto& x_dims = x.dims();
+  const auto& w_dims = weight.dims();
+  PADDLE_ENFORCE_EQ(x_dims.size(),
+                    2,
+                    common::errors::InvalidArgument(
+                        "The Input(x) of moe_grouped_gemm should be 2-D "
+                        "[total_rows, k], but got %s.",
+                        x_dims));
+  PADDLE_ENFORCE_EQ(w_dims.size(),
+                    3,
+                    common::errors::InvalidArgument(
+                        "The Input(weight) of moe_grouped_gemm should be 3-D "
+                        "[num_experts, k, n], but got %s.",
+                        w_dims));
+  if (x_dims[1] > 0 && w_dims[1] > 0) {
+    PADDLE_ENFORCE_EQ(x_dims[1],
+                      w_dims[1],
+                      common::errors::InvalidArgument(
+                          "The k of Input(x) %s and Input(weight) %s of "
+                          "moe_grouped_gemm should be equal.",
+                          x_dims,
+                          w_dims));
+  }
+  PADDLE_ENFORCE_EQ(
+      tokens_per_expert.dtype() == DataType::INT32 ||
+          tokens_per_expert.dtype() == DataType::INT64,
+      true,
+      common::errors::InvalidArgument(
+          "The Input(tokens_per_expert) of moe_grouped_gemm should be of "
+          "int32 or int64, but got %s.",
+          tokens_per_expert.dtype()));
+  const auto& tokens_dims = tokens_per_expert.dims();
+  if (w_dims[0] > 0 && tokens_dims.size() == 1 && tokens_dims[0] > 0) {
+    PADDLE_ENFORCE_EQ(tokens_dims[0],
+                      w_dims[0],
+                      common::errors::InvalidArgument(
+                          "The Input(tokens_per_expert) of moe_grouped_gemm "
+                          "should hold the tokens of the %d experts, but got "
+                          "%s.",
+                          w_dims[0],
+                          tokens_dims));
+  }
+  out->set_dims({x_dims[0], w_dims[2]});
+  out->set_dtype(x.dtype());
+  out->set_layout(x.layout());
+}
+
+void FusedLinearCrossEntropyInferMeta(const MetaTensor& x,
+                                      const MetaTensor& weight,
+                                      const MetaTensor& label,
+                                      int64_t ignore_index,
+                                      int chunk_size,
+                                      int ring_id,
+                                      int rank,
+                                      int nranks,
+                                      MetaTensor* loss,
+                                      MetaTensor* lse) {
+  const auto& x_dims = x.dims();
+  const auto& w_dims = weight.dims();
+  const auto& label_dims = label.dims();
+  PADDLE_ENFORCE_GE(x_dims.size(),
+                    2,
+                    common::errors::InvalidArgument(
+                        "The Input(x) of fused_linear_cross_entropy should be "
+                        "at least 2-D [..., hidden], but got %s.",
+                        x_dims));
+  PADDLE_ENFORCE_EQ(w_dims.size(),
+                    2,
+                    common::errors::InvalidArgument(
+                        "The Input(weight) of fused_linear_cross_entropy "
+                        "should be 2-D [hidden, vocab], but got %s.",
+                        w_dims));
+  const int64_t hidden = x_dims[x_dims.size() - 1];
+  if (hidden > 0 && w_dims[0] > 0) {
+    PADDLE_ENFORCE_EQ(hidden,
+                      w_dims[0],
+                      common::errors::InvalidArgument(
+                          "The hidden of Input(x) %s and Input(weight) %s of "
+                          "fused_linear_cross_entropy should be equal.",
+                          x_dims,
+                          w_dims));
+  }
+  PADDLE_ENFORCE_EQ(
+      label.dtype() == DataType::INT32 || label.dtype() == DataType::INT64,
+      true,
+      common::errors::InvalidArgument(
+          "The Input(label) of fused_linear_cross_entropy should be of int32 "
+          "or int64, but got %s.",
+          label.dtype()));
+  const int64_t rows = common::product(x_dims) / std::max<int64_t>(hidden, 1);
+  if (rows > 0 && label.numel() > 0) {
+    PADDLE_ENFORCE_EQ(label.numel(),
+                      rows,
+                      common::errors::InvalidArgument(
+                          "The Input(label) %s of fused_linear_cross_entropy "
+                          "should hold a label of each row of Input(x) %s.",
+                          label_dims,
+                          x_dims));
+  }
+  PADDLE_ENFORCE_EQ(rank >= 0 && rank < std::max(nranks, 1),
+                    true,
+                    common::errors::InvalidArgument(
+                        "The rank (%d) of fused_linear_cross_entropy should "
+                        "be in [0, nranks (%d)).",
+                        rank,
+                        nranks));
+
+  auto loss_dims = common::vectorize(x_dims);
+  loss_dims.back() = 1;
+  loss->set_dims(common::make_ddim(loss_dims));
+  loss->set_dtype(DataType::FLOAT32);
+  loss->set_layout(x.layout());
+  lse->set_dims({rows});
+  lse->set_dtype(DataType::FLOAT32);
+  lse->set_layout(x.layout());
+}
+
+void FusedBeamSearchStepInferMeta(const MetaTensor& logits,
+                                  const MetaTensor& pre_scores,
+                                  const MetaTensor& pre_finished,
+                                  const MetaTensor& pre_lengths,
+                                  int64_t end_id,
+                                  float length_penalty,
+                                  MetaTensor* selected_ids,
+                                  MetaTensor* selected_scores,
+                                  MetaTensor* finished,
+                                  MetaTensor* lengths,
+                                  MetaTensor* parent_idx,
+                                  MetaTensor* cache_indices) {
+  const auto& logits_dims = logits.dims();
+  PADDLE_ENFORCE_EQ(logits_dims.size(),
+                    3,
+                    common::errors::InvalidArgument(
+                        "The Input(logits) of fused_beam_search_step should "
+                        "be 3-D [batch, beam, vocab], but got %s.",
+                        logits_dims));
+  const int64_t batch = logits_dims[0];
+  const int64_t beam = logits_dims[1];
+  const int64_t vocab = logits_dims[2];
+  if (beam > 0 && vocab > 0) {
+    PADDLE_ENFORCE_GE(vocab,
+                      beam,
+                      common::errors::InvalidArgument(
+                          "The vocab (%d) of fused_beam_search_step should be "
+                          "at least the beam size (%d).",
+                          vocab,
+                          beam));
+  }
+  auto check_beam_dims = [&](const MetaTensor& x, const char* name) {
+    const auto& dims = x.dims();
+    PADDLE_ENFORCE_EQ(
+        dims.size() == 2 && (batch < 0 || dims[0] < 0 || dims[0] == batch) &&
+            (beam < 0 || dims[1] < 0 || dims[1] == beam),
+        true,
+        common::errors::InvalidArgument(
+            "The Input(%s) %s of fused_beam_search_step should be [batch, "
+            "beam] of Input(logits) %s.",
+            name,
+            dims,
+            logits_dims));
+  };
+  check_beam_dims(pre_scores, "pre_scores");
+  check_beam_dims(pre_finished, "pre_finished");
+  check_beam_dims(pre_lengths, "pre_lengths");
+  PADDLE_ENFORCE_EQ(pre_scores.dtype(),
+                    DataType::FLOAT32,
+                    common::errors::InvalidArgument(
+                        "The Input(pre_scores) of fused_beam_search_step "
+                        "should be of float32, but got %s.",
+                        pre_scores.dtype()));
+  PADDLE_ENFORCE_EQ(pre_finished.dtype(),
+                    DataType::BOOL,
+                    common::errors::InvalidArgument(
+                        "The Input(pre_finished) of fused_beam_search_step "
+                        "should be of bool, but got %s.",
+                        pre_finished.dtype()));
+  PADDLE_ENFORCE_EQ(pre_lengths.dtype(),
+                    DataType::INT64,
+                    common::errors::InvalidArgument(
+                        "The Input(pre_lengths) of fused_beam_search_step "
+                        "should be of int64, but got %s.",
+                        pre_lengths.dtype()));
+
+  auto set_beam_output = [&](MetaTensor* out, DataType dtype) {
+    out->set_dims({batch, beam});
+    out->set_dtype(dtype);
+    out->set_layout(logits.layout());
+  };
+  set_beam_output(selected_ids, DataType::INT64);
+  set_beam_output(selected_scores, DataType::FLOAT32);
+  set_beam_output(finished, DataType::BOOL);
+  set_beam_output(lengths, DataType::INT64);
+  set_beam_output(parent_idx, DataType::INT64);
+  cache_indices->set_dims({batch < 0 || beam < 0 ? -1 : batch * beam});
+  cache_indices->set_dtype(DataType::INT64);
+  cache_indices->set_layout(logits.layout());
+}
+
 }  // namespace phi
@@ -1097,6 +1097,17 @@ void FusionLstmInferMeta(const MetaTensor& x,
                          MetaTensor* reordered_c0,
                          MetaTensor* checked_cell);
 
+void FusionEmbSeqpoolCvmConcatInferMeta(
+    const std::vector<const MetaTensor*>& ids,
+    const MetaTensor& w,
+    const MetaTensor& cvm,
+    const std::string& pooltype,
+    bool use_cvm,
+    int axis,
+    int64_t padding_idx,
+    MetaTensor* out,
+    MetaConfig config = MetaConfig());
+
 void FusionSeqpoolCvmConcatInferMeta(const std::vector<const MetaTensor*>& x,
                                      const MetaTensor& cvm,
                                      const std::string& pooltype,
@@ -1459,4 +1470,33 @@ void ResnetBasicBlockGradInferMeta(const MetaTensor& x,
                                    MetaTensor* bias3_grad,
                                    MetaConfig config = MetaConfig());
 
+void FusedLinearCrossEntropyInferMeta(const MetaTensor& x,
+                                      const MetaTensor& weight,
+                                      const MetaTensor& label,
+                                      int64_t ignore_index,
+                                      int chunk_size,
+                                      int ring_id,
+                                      int rank,
+                                      int nranks,
+                                      MetaTensor* loss,
+                                      MetaTensor* lse);
+
+void MoeGroupedGemmInferMeta(const MetaTensor& x,
+                             const MetaTensor& weight,
+                             const MetaTensor& tokens_per_expert,
+                             MetaTensor* out);
+
+void FusedBeamSearchStepInferMeta(const MetaTensor& logits,
+                                  const MetaTensor& pre_scores,
+                                  const MetaTensor& pre_finished,
+                                  const MetaTensor& pre_lengths,
+                                  int64_t end_id,
+                                  float length_penalty,
+                                  MetaTensor* selected_ids,
+                                  MetaTensor* selected_scores,
+                                  MetaTensor* finished,
+                                  MetaTensor* lengths,
+                                  MetaTensor* parent_idx,
+                                  MetaTensor* cache_indices);
+
 }  // namespace phi
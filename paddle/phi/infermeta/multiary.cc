@@ -27,6 +27,7 @@ limitations under the License. */
 #include "paddle/phi/core/utils/data_type.h"
 #include "paddle/phi/infermeta/binary.h"
 #include "paddle/phi/infermeta/nullary.h"
+#include "paddle/phi/infermeta/unary.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
 #include "paddle/phi/kernels/funcs/concat_funcs.h"
 
@@ -1706,6 +1707,23 @@ inline int ConvOutputSize(
   return output_size;
 }
 
+void DecodeJpegBatchInferMeta(const std::vector<const MetaTensor*>& x,
+                              const std::string& mode,
+                              std::vector<MetaTensor*> out) {
+  PADDLE_ENFORCE_EQ(
+      x.size(),
+      out.size(),
+      common::errors::InvalidArgument(
+          "The input(X) and output(Out) should have same size in "
+          "Operator(decode_jpeg_batch), size of input(X) is %d "
+          "and size of output(Out) is %d.",
+          x.size(),
+          out.size()));
+  for (size_t i = 0; i < x.size(); ++i) {
+    DecodeJpegInferMeta(*x[i], mode, out[i]);
+  }
+}
+
 void DeformableConvInferMeta(const MetaTensor& x,
                              const MetaTensor& offset,
                              const MetaTensor& filter,
@@ -350,6 +350,10 @@ void DecayedAdagradInferMeta(const MetaTensor& param,
                              MetaTensor* param_out,
                              MetaTensor* moment_out);
 
+void DecodeJpegBatchInferMeta(const std::vector<const MetaTensor*>& x,
+                              const std::string& mode,
+                              std::vector<MetaTensor*> out);
+
 void DeformableConvInferMeta(const MetaTensor& x,
                              const MetaTensor& offset,
                              const MetaTensor& filter,
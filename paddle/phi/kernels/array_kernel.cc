@@ -14,6 +14,9 @@
 
 #include "paddle/phi/kernels/array_kernel.h"
 
+#include <memory>
+
+#include "paddle/common/flags.h"
 #include "paddle/common/layout.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
@@ -21,7 +24,95 @@
 #include "paddle/phi/kernels/full_kernel.h"
 #include "paddle/phi/kernels/stack_kernel.h"
 
+COMMON_DECLARE_bool(tensor_array_contiguous_storage);
+
 namespace phi {
+
+namespace {
+
+// Whether x can be written as the next row of the storage of array.
+bool FitsStorage(const TensorArray& array,
+                 const DenseTensor& x,
+                 const Place& place) {
+  const auto& storage = array.storage();
+  if (!storage || storage->rows != array.size()) {
+    return false;
+  }
+  const DenseTensor& buffer = storage->buffer;
+  if (buffer.dtype() != x.dtype() || buffer.place() != place ||
+      buffer.dims().size() != x.dims().size() + 1) {
+    return false;
+  }
+  for (int i = 0; i < x.dims().size(); ++i) {
+    if (buffer.dims()[i + 1] != x.dims()[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The tensor of x.dims() on the row of the buffer.
+DenseTensor StorageRow(const DenseTensor& buffer,
+                       size_t row,
+                       const DDim& dims) {
+  DenseTensor tensor =
+      buffer.Slice(static_cast<int64_t>(row), static_cast<int64_t>(row) + 1);
+  tensor.Resize(dims);
+  return tensor;
+}
+
+// Appends x to out as the next row of its storage, doubling the storage when
+// it is full and starting one on the first write, so the tensors of a loop
+// are allocated O(log steps) times. out is empty or fits its storage.
+template <typename Context>
+void AppendToStorage(const Context& dev_ctx,
+                     const DenseTensor& x,
+                     TensorArray* out) {
+  const size_t rows = out->size();
+  std::shared_ptr<TensorArray::Storage> storage = out->storage();
+  if (rows == 0) {
+    storage = std::make_shared<TensorArray::Storage>();
+  }
+  const int64_t capacity = rows == 0 ? 0 : storage->buffer.dims()[0];
+  if (static_cast<int64_t>(rows) == capacity) {
+    auto dims = common::vectorize<int64_t>(x.dims());
+    dims.insert(dims.begin(), capacity == 0 ? 1 : capacity * 2);
+    auto grown = std::make_shared<TensorArray::Storage>();
+    grown->buffer.Resize(common::make_ddim(dims));
+    dev_ctx.Alloc(&grown->buffer, x.dtype());
+    if (rows > 0) {
+      DenseTensor old_rows =
+          storage->buffer.Slice(0, static_cast<int64_t>(rows));
+      DenseTensor new_rows =
+          grown->buffer.Slice(0, static_cast<int64_t>(rows));
+      phi::Copy(dev_ctx, old_rows, dev_ctx.GetPlace(), false, &new_rows);
+      // the tensors still on the old rows move with them
+      const auto* old_base =
+          static_cast<const uint8_t*>(storage->buffer.data());
+      const size_t row_bytes = x.numel() * phi::SizeOf(x.dtype());
+      for (size_t i = 0; i < rows; ++i) {
+        DenseTensor& tensor = out->at(i);
+        if (tensor.IsSharedBufferWith(storage->buffer) &&
+            tensor.data() == old_base + i * row_bytes) {
+          DenseTensor moved = StorageRow(grown->buffer, i, tensor.dims());
+          moved.set_lod(tensor.lod());
+          tensor = moved;
+        }
+      }
+    }
+    grown->rows = rows;
+    storage = grown;
+  }
+
+  DenseTensor tensor = StorageRow(storage->buffer, rows, x.dims());
+  phi::Copy(dev_ctx, x, dev_ctx.GetPlace(), false, &tensor);
+  tensor.set_lod(x.lod());
+  out->push_back(tensor);
+  storage->rows = rows + 1;
+  out->set_storage(storage);
+}
+
+}  // namespace
 template <typename T, typename Context>
 void CreateArrayKernel(const Context& dev_ctx,
                        DataType dtype,
@@ -72,10 +163,22 @@ void ArrayWriteKernel(const Context& dev_ctx,
                       const Scalar& i,
                       TensorArray* out) {
   size_t offset = i.to<int64_t>();
+  if (FLAGS_tensor_array_contiguous_storage && offset == out->size() &&
+      x.numel() > 0 && x.lod().empty() && x.meta().is_contiguous() &&
+      (offset == 0 || FitsStorage(*out, x, dev_ctx.GetPlace()))) {
+    AppendToStorage(dev_ctx, x, out);
+    return;
+  }
   if (offset >= out->size()) {
     out->resize(offset + 1);
   }
   auto* out_tensor = &out->at(offset);
+  // a tensor on a row of the storage is not written in place, as the rows
+  // may be shared by the shallow copies of the array
+  if (out->storage() &&
+      out_tensor->IsSharedBufferWith(out->storage()->buffer)) {
+    *out_tensor = DenseTensor();
+  }
   out_tensor->set_lod(x.lod());
   if (x.memory_size() > 0) {
     phi::Copy(dev_ctx, x, dev_ctx.GetPlace(), false, out_tensor);
@@ -111,7 +214,22 @@ void ArrayToTensorKernel(const Context& dev_ctx,
     indexs.push_back(&tmp_indexs[i]);
   }
 
-  if (use_stack) {
+  // the tensors on the rows of the storage are stacked on axis 0 already,
+  // and concatenated as well when they have dims, so they are copied at
+  // once. out does not share the rows, which an inplace op on out would
+  // overwrite.
+  DenseTensor view;
+  if (axis == 0 && (use_stack || x[0].dims().size() > 0) &&
+      x.StackedView(&view)) {
+    auto vec = common::vectorize<int64_t>(x[0].dims());
+    if (use_stack) {
+      vec.insert(vec.begin(), x.size());
+    } else {
+      vec[0] *= static_cast<int64_t>(x.size());
+    }
+    phi::Copy(dev_ctx, view, dev_ctx.GetPlace(), false, out);
+    out->Resize(common::make_ddim(vec));
+  } else if (use_stack) {
     auto vec = common::vectorize<int>(x[0].dims());
     vec.insert(vec.begin() + axis, x.size());  // NOLINT
     out->Resize(common::make_ddim(vec));
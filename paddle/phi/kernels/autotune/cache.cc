@@ -14,12 +14,94 @@
 
 #include "paddle/phi/kernels/autotune/cache.h"
 
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <random>
+#include <sstream>
 
 #include "glog/logging.h"
+#include "paddle/phi/core/distributed/store/store.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_string(autotune_cache_file);
+COMMON_DECLARE_bool(autotune_cache_read_only);
 
 namespace phi::autotune {
 
+namespace {
+
+constexpr char kCacheFileMagic[] = "paddle_autotune_cache";
+constexpr int kCacheFileVersion = 1;
+
+// The algorithms are only valid on the kind of device they were searched on.
+std::string DeviceFingerprint() {
+  std::ostringstream os;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  const int id = backends::gpu::GetCurrentDeviceId();
+  os << backends::gpu::GetDeviceProperties(id).name
+     << " sm:" << backends::gpu::GetGPUComputeCapability(id)
+     << " runtime:" << backends::gpu::GetGPURuntimeVersion(id)
+     << " dnn:" << backends::gpu::DnnVersion();
+#else
+  os << "cpu";
+#endif
+  return os.str();
+}
+
+template <typename T>
+void WriteVector(std::ostream& os, const std::vector<T>& vec) {
+  os << " " << vec.size();
+  for (const auto& v : vec) {
+    os << " " << v;
+  }
+}
+
+template <typename T>
+bool ReadVector(std::istream& is, std::vector<T>* vec) {
+  size_t size = 0;
+  if (!(is >> size)) {
+    return false;
+  }
+  vec->resize(size);
+  for (auto& v : *vec) {
+    if (!(is >> v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string ToHex(const std::string& bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(bytes.size() * 2);
+  for (unsigned char c : bytes) {
+    hex.push_back(kDigits[c >> 4]);
+    hex.push_back(kDigits[c & 0xf]);
+  }
+  return hex;
+}
+
+bool FromHex(const std::string& hex, std::string* bytes) {
+  if (hex.size() % 2 != 0) {
+    return false;
+  }
+  bytes->resize(hex.size() / 2);
+  for (size_t i = 0; i < bytes->size(); ++i) {
+    unsigned int c = 0;
+    if (std::sscanf(hex.c_str() + 2 * i, "%2x", &c) != 1) {
+      return false;
+    }
+    (*bytes)[i] = static_cast<char>(c);
+  }
+  return true;
+}
+
+}  // namespace
+
 size_t TransposeKey(const std::vector<int64_t>& x_dims,
                     const std::vector<int32_t>& perm,
                     phi::DataType dtype) {
@@ -115,4 +197,190 @@ void AutoTuneCache::UpdateStatus() {
   total_cache_misses_ = cache_misses;
 }
 
+// The cache is of a line per algorithm after the header, e.g.
+//   algo <algorithm type> <key> <kernel index>
+//   conv <algorithm type> <ConvCacheKey> <ConvAutoTuneResult>
+//   matmul <key> <kernel index>
+//   cublaslt <sub key> <hex of cublasLtMatmulAlgo_t>
+void AutoTuneCache::Serialize(std::ostream& os) {
+  os << kCacheFileMagic << " " << kCacheFileVersion << "\n"
+     << DeviceFingerprint() << "\n";
+  for (auto& v : auto_tune_map_) {
+    for (const auto& item : v.second.Items()) {
+      os << "algo " << v.first << " " << item.first << " " << item.second
+         << "\n";
+    }
+  }
+  for (auto& v : conv_auto_tune_map_) {
+    for (const auto& item : v.second.Items()) {
+      const ConvCacheKey& key = item.first;
+      os << "conv " << v.first;
+      WriteVector(os, key.x_dims);
+      WriteVector(os, key.w_dims);
+      WriteVector(os, key.strides);
+      WriteVector(os, key.paddings);
+      WriteVector(os, key.dilations);
+      os << " " << static_cast<int>(key.dtype) << " " << key.groups << " "
+         << key.data_layout << " " << item.second.algo << " "
+         << item.second.workspace_size << " "
+         << static_cast<int>(item.second.exhaustive_search) << "\n";
+    }
+  }
+  for (const auto& item : matmul_auto_tune_map_.Items()) {
+    os << "matmul " << item.first << " " << item.second << "\n";
+  }
+  for (const auto& item : matmul_auto_tune_map_.SubKeyAlgoItems()) {
+    os << "cublaslt " << item.first << " " << ToHex(item.second) << "\n";
+  }
+}
+
+bool AutoTuneCache::Deserialize(std::istream& is,
+                                const std::string& source,
+                                bool overwrite) {
+  std::string magic;
+  int version = 0;
+  std::string fingerprint;
+  is >> magic >> version;
+  std::getline(is, fingerprint);
+  std::getline(is, fingerprint);
+  if (magic != kCacheFileMagic || version != kCacheFileVersion) {
+    LOG(WARNING) << "Skip the autotune cache " << source
+                 << ", which is not of version " << kCacheFileVersion << ".";
+    return false;
+  }
+  if (fingerprint != DeviceFingerprint()) {
+    LOG(WARNING) << "Skip the autotune cache " << source
+                 << ", which was searched on " << fingerprint << " but runs on "
+                 << DeviceFingerprint() << ".";
+    return false;
+  }
+
+  auto set = [overwrite](auto* cache, const auto& key, const auto& algo) {
+    if (overwrite) {
+      cache->Set(key, algo);
+    } else {
+      cache->SetIfAbsent(key, algo);
+    }
+  };
+  int64_t num_loaded = 0;
+  std::string line;
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    std::string kind;
+    ls >> kind;
+    bool ok = false;
+    if (kind == "algo") {
+      int64_t type = 0;
+      size_t key = 0;
+      int64_t algo = 0;
+      ok = static_cast<bool>(ls >> type >> key >> algo) &&
+           auto_tune_map_.count(type) > 0;
+      if (ok) {
+        set(&auto_tune_map_[type], key, algo);
+      }
+    } else if (kind == "conv") {
+      int64_t type = 0;
+      ConvCacheKey key;
+      int dtype = 0;
+      ConvAutoTuneResult result;
+      int exhaustive_search = 0;
+      ok = static_cast<bool>(ls >> type) && ReadVector(ls, &key.x_dims) &&
+           ReadVector(ls, &key.w_dims) && ReadVector(ls, &key.strides) &&
+           ReadVector(ls, &key.paddings) && ReadVector(ls, &key.dilations) &&
+           static_cast<bool>(ls >> dtype >> key.groups >> key.data_layout >>
+                             result.algo >> result.workspace_size >>
+                             exhaustive_search) &&
+           conv_auto_tune_map_.count(type) > 0;
+      if (ok) {
+        key.dtype = static_cast<phi::DataType>(dtype);
+        result.exhaustive_search = exhaustive_search != 0;
+        set(&conv_auto_tune_map_[type], key, result);
+      }
+    } else if (kind == "matmul") {
+      size_t key = 0;
+      int64_t algo = 0;
+      ok = static_cast<bool>(ls >> key >> algo);
+      if (ok) {
+        set(&matmul_auto_tune_map_, key, algo);
+      }
+    } else if (kind == "cublaslt") {
+      size_t key = 0;
+      std::string hex;
+      std::string bytes;
+      ok = static_cast<bool>(ls >> key >> hex) && FromHex(hex, &bytes);
+      if (ok && (overwrite || !matmul_auto_tune_map_.FindSubKeyAlgo(key))) {
+        matmul_auto_tune_map_.SetSubKeyAlgo(key, bytes.data(), bytes.size());
+      }
+    }
+    if (ok) {
+      ++num_loaded;
+    } else if (!kind.empty()) {
+      VLOG(3) << "Skip the line of the autotune cache: " << line;
+    }
+  }
+  VLOG(3) << "Loaded " << num_loaded << " algorithms from the autotune cache "
+          << source;
+  return true;
+}
+
+void AutoTuneCache::Save(const std::string& path) {
+  // merges the algorithms saved by the other runs or ranks
+  Load(path, /*overwrite=*/false);
+  // writes a temporary file first, so that the processes loading the file
+  // never see a half written one, nor the ranks saving it at the same time
+  // mix their writes
+  const std::string tmp_path =
+      path + ".tmp" + std::to_string(std::random_device()());
+  std::ofstream os(tmp_path);
+  PADDLE_ENFORCE_EQ(os.is_open(),
+                    true,
+                    common::errors::Unavailable(
+                        "Failed to open the autotune cache file %s.", path));
+  Serialize(os);
+  os.close();
+  PADDLE_ENFORCE_EQ(
+      !os.fail() && std::rename(tmp_path.c_str(), path.c_str()) == 0,
+      true,
+      common::errors::Unavailable("Failed to write the autotune cache file %s.",
+                                  path));
+  VLOG(3) << "Saved the autotune cache to " << path;
+}
+
+bool AutoTuneCache::Load(const std::string& path, bool overwrite) {
+  std::ifstream is(path);
+  if (!is.is_open()) {
+    return false;
+  }
+  return Deserialize(is, "file " + path, overwrite);
+}
+
+void AutoTuneCache::LoadCacheFile() {
+  if (!FLAGS_autotune_cache_file.empty()) {
+    Load(FLAGS_autotune_cache_file);
+  }
+}
+
+void AutoTuneCache::SaveCacheFile() {
+  if (!FLAGS_autotune_cache_file.empty() && !FLAGS_autotune_cache_read_only) {
+    Save(FLAGS_autotune_cache_file);
+  }
+}
+
+void AutoTuneCache::Share(distributed::Store* store,
+                          const std::string& key,
+                          bool is_root) {
+  if (is_root) {
+    std::ostringstream os;
+    Serialize(os);
+    const std::string bytes = os.str();
+    store->set(key, std::vector<uint8_t>(bytes.begin(), bytes.end()));
+    VLOG(3) << "Shared the autotune cache of " << bytes.size()
+            << " bytes as " << key;
+  } else {
+    const auto bytes = store->get(key);
+    std::istringstream is(std::string(bytes.begin(), bytes.end()));
+    Deserialize(is, "of the root rank", /*overwrite=*/true);
+  }
+}
+
 }  // namespace phi::autotune
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <algorithm>
+#include <iosfwd>
 #include <numeric>
+#include <string>
 
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/kernels/autotune/cache_base.h"
@@ -23,6 +25,10 @@
 #include "paddle/phi/kernels/autotune/cache_cudnn_frontend.h"
 #endif
 namespace phi {
+namespace distributed {
+class Store;
+}  // namespace distributed
+
 namespace autotune {
 
 struct ConvAutoTuneResult {
@@ -151,6 +157,28 @@ class AutoTuneCache {
 
   void UpdateStatus();
 
+  // Saves the searched algorithms to a file, except the cudnn frontend
+  // plans, with the GPU model and the CUDA and cuDNN versions they were
+  // searched on. The algorithms already in the file and not in the cache,
+  // e.g. saved by another run or rank, are kept.
+  void Save(const std::string& path);
+
+  // Loads the algorithms saved by Save(), returns false if the file does not
+  // exist or was saved on another GPU model or CUDA or cuDNN version. The
+  // cached algorithms are replaced by the loaded ones only if overwrite.
+  bool Load(const std::string& path, bool overwrite = true);
+
+  // Loads FLAGS_autotune_cache_file if it is set.
+  void LoadCacheFile();
+
+  // Saves FLAGS_autotune_cache_file if it is set and not
+  // FLAGS_autotune_cache_read_only.
+  void SaveCacheFile();
+
+  // Makes the caches of all the ranks the algorithms of the root rank, which
+  // sets them to key of store and the other ranks wait for them.
+  void Share(distributed::Store* store, const std::string& key, bool is_root);
+
   // The number of total config cached
   int64_t Size() const { return total_size_; }
 
@@ -173,8 +201,15 @@ class AutoTuneCache {
     for (int i = 1; i < static_cast<int>(AlgorithmType::kAlgorithmCount); ++i) {
       Register(static_cast<AlgorithmType>(i));
     }
+    LoadCacheFile();
   }
 
+  void Serialize(std::ostream& os);
+  // source names where is comes from in the logs
+  bool Deserialize(std::istream& is,
+                   const std::string& source,
+                   bool overwrite);
+
   void Register(const AlgorithmType& algo_type) {
     std::lock_guard<std::mutex> lock(*autotune_cache_mutex_);
     if (algo_type == AlgorithmType::kConvForward ||
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/common/errors.h"
@@ -137,6 +139,13 @@ class AlgorithmsCache {
     hash_[key] = algo;
   }
 
+  // Sets the algorithm of key unless it is cached, unlike Find it does not
+  // count a hit or a miss.
+  void SetIfAbsent(const KeyT& key, AlgorithmT algo) {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    hash_.emplace(key, algo);
+  }
+
   int64_t CacheMisses() const { return cache_misses_; }
 
   int64_t CacheHits() const { return cache_hits_; }
@@ -153,6 +162,12 @@ class AlgorithmsCache {
 
   int64_t Size() const { return hash_.size(); }
 
+  std::vector<std::pair<KeyT, AlgorithmT>> Items() {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    return std::vector<std::pair<KeyT, AlgorithmT>>(hash_.begin(),
+                                                     hash_.end());
+  }
+
  protected:
   std::unordered_map<KeyT, AlgorithmT, HashT, KeyEqualT> hash_;
   std::shared_ptr<std::mutex> cache_mutex_;
@@ -213,8 +228,38 @@ class MatmulAlgorithmsCache : public AlgorithmsCache<KeyT, AlgorithmT> {
     return sub_hash_[sub_key];
   }
 
+  // The searched algorithms of the sub keys as raw bytes, which unlike the
+  // descriptors of sub_hash_ can be saved to and loaded from a file.
+  bool FindSubKeyAlgo(const KeyT& sub_key) {
+    std::lock_guard<std::mutex> lock(*(this->cache_mutex_));
+    return sub_algo_hash_.find(sub_key) != sub_algo_hash_.end();
+  }
+
+  void SetSubKeyAlgo(const KeyT& sub_key, const void* algo, size_t size) {
+    std::lock_guard<std::mutex> lock(*(this->cache_mutex_));
+    sub_algo_hash_[sub_key].assign(static_cast<const char*>(algo), size);
+  }
+
+  void GetSubKeyAlgo(const KeyT& sub_key, void* algo, size_t size) {
+    std::lock_guard<std::mutex> lock(*(this->cache_mutex_));
+    auto it = sub_algo_hash_.find(sub_key);
+    PADDLE_ENFORCE_EQ(
+        it != sub_algo_hash_.end() && it->second.size() == size,
+        true,
+        common::errors::PreconditionNotMet(
+            "The algorithm of %d bytes of the key does not exist.", size));
+    it->second.copy(static_cast<char*>(algo), size);
+  }
+
+  std::vector<std::pair<KeyT, std::string>> SubKeyAlgoItems() {
+    std::lock_guard<std::mutex> lock(*(this->cache_mutex_));
+    return std::vector<std::pair<KeyT, std::string>>(sub_algo_hash_.begin(),
+                                                     sub_algo_hash_.end());
+  }
+
  private:
   std::unordered_map<KeyT, void*> sub_hash_;
+  std::unordered_map<KeyT, std::string> sub_algo_hash_;
 };
 
 }  // namespace autotune
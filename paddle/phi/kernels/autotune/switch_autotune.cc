@@ -14,14 +14,30 @@
 
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
+#include <string>
+
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
+#include "paddle/phi/core/distributed/store/store_utils.h"
 
 COMMON_DECLARE_bool(use_autotune);
+COMMON_DECLARE_bool(autotune_cache_read_only);
+COMMON_DECLARE_bool(autotune_share_cache);
 
 namespace phi {
 namespace autotune {
 
+namespace {
+
+// Whether the algorithms are searched by rank 0 only, which shares them with
+// the other ranks.
+bool ShareCache() {
+  return FLAGS_autotune_share_cache && !FLAGS_autotune_cache_read_only &&
+         distributed::GetGlobalWorldSize() > 1;
+}
+
+}  // namespace
+
 void AutoTuneStatus::EnableAutoTune() {
   FLAGS_use_autotune = true;
   Init();
@@ -44,7 +60,11 @@ void AutoTuneStatus::Update() {
     use_autotune_ = false;
   } else if (current_steps_id_ + 1 >= start_step_id_ &&
              current_steps_id_ + 1 < stop_step_id_) {
-    use_autotune_ = true;
+    // only the cached algorithms are used in the read only mode and by the
+    // ranks taking the algorithms of rank 0
+    use_autotune_ =
+        !FLAGS_autotune_cache_read_only &&
+        !(ShareCache() && distributed::GetCurGlobalRank() != 0);
     AutoTuneCache::Instance().UpdateStatus();
     step_hit_rates_.push_back(StepHitRate());
     VLOG(3) << "Step ID: " << current_steps_id_
@@ -55,6 +75,9 @@ void AutoTuneStatus::Update() {
             << static_cast<int>(StepHitRate() * 100) << "%";
   } else {
     use_autotune_ = false;
+    if (current_steps_id_ + 1 == stop_step_id_) {
+      FinishTuning();
+    }
     // Set a small tolerance to avoid performance degradation
     // due to large cache size under dynamic shape.
     // TODO(limingshu): Currently works for conv op only, this
@@ -71,5 +94,16 @@ void AutoTuneStatus::Update() {
   }
 }
 
+void AutoTuneStatus::FinishTuning() {
+  if (ShareCache()) {
+    auto store = distributed::CreateOrGetGlobalTCPStore();
+    AutoTuneCache::Instance().Share(
+        store.get(),
+        "autotune_cache_" + std::to_string(num_shares_++),
+        distributed::GetCurGlobalRank() == 0);
+  }
+  AutoTuneCache::Instance().SaveCacheFile();
+}
+
 }  // namespace autotune
 }  // namespace phi
@@ -78,6 +78,10 @@ class AutoTuneStatus {
  private:
   AutoTuneStatus() = default;
 
+  // Called at the end of the tuning range, shares the searched algorithms
+  // with FLAGS_autotune_share_cache and saves them.
+  void FinishTuning();
+
   void Init() {
     use_autotune_ = false;
     current_steps_id_ = -1;
@@ -85,6 +89,7 @@ class AutoTuneStatus {
     previous_misses_ = 0;
     step_hit_rates_.clear();
     AutoTuneCache::Instance().Clean();
+    AutoTuneCache::Instance().LoadCacheFile();
   }
 
   bool use_autotune_{false};
@@ -95,6 +100,8 @@ class AutoTuneStatus {
   int64_t previous_misses_{0};
   float current_step_hit_rate_{0.f};
   std::vector<float> step_hit_rates_;
+  // the times the cache was shared, which make the keys of the store
+  int64_t num_shares_{0};
 };
 
 }  // namespace autotune
@@ -26,7 +26,19 @@ void DecodeJpegKernel(const Context& dev_ctx,
                       DenseTensor* out) {
   PADDLE_THROW(errors::Unimplemented("DecodeJpeg op only supports GPU now."));
 }
+
+template <typename T, typename Context>
+void DecodeJpegBatchKernel(const Context& dev_ctx,
+                           const std::vector<const DenseTensor*>& x,
+                           const std::string& mode,
+                           std::vector<DenseTensor*> out) {
+  PADDLE_THROW(
+      errors::Unimplemented("DecodeJpegBatch op only supports GPU now."));
+}
 }  // namespace phi
 
 PD_REGISTER_KERNEL(
     decode_jpeg, CPU, ALL_LAYOUT, phi::DecodeJpegKernel, uint8_t) {}
+
+PD_REGISTER_KERNEL(
+    decode_jpeg_batch, CPU, ALL_LAYOUT, phi::DecodeJpegBatchKernel, uint8_t) {}
@@ -63,6 +63,7 @@ class WordPieceTokenizer {
 
  private:
   const phi::Vocab* vocab_;
+  shared_ptr<const phi::VocabTrie> trie_;
   wstring unk_token_{L"[UNK]"};
   int64_t unk_token_id_;
   size_t max_input_chars_per_word_;
@@ -207,6 +208,7 @@ WordPieceTokenizer::WordPieceTokenizer(
     const wstring& unk_token /* = L"[UNK]"*/,
     const size_t max_input_chars_per_word /* = 100 */)
     : vocab_(vocab),
+      trie_(vocab->trie()),
       unk_token_(unk_token),
       max_input_chars_per_word_(max_input_chars_per_word) {
   unk_token_id_ = vocab_->at(unk_token_);
@@ -226,33 +228,18 @@ void WordPieceTokenizer::Tokenize(const wstring& text,
     return;
   }
 
+  // the longest token at each piece is found in one walk of the trie
   size_t start = 0;
   vector<int64_t> wordpiece_ids;
   while (start < len) {
-    size_t end = len;
-    std::wstring cur_substr;
-    int64_t cur_substr_id = 0;
-    while (start < end) {
-      std::wstring sub = text.substr(start, end - start);
-      if (start > 0) {
-        sub.insert(0, L"##");
-      }
-      auto it = vocab_->find(sub);
-      if (it != vocab_->end()) {
-        cur_substr = sub;
-        cur_substr_id = it->second;
-        break;
-      }
-      end -= 1;
-    }
-
-    if (cur_substr.empty()) {
+    std::int32_t cur_substr_id = 0;
+    size_t match = trie_->LongestMatch(text, start, start > 0, &cur_substr_id);
+    if (match == 0) {
       token_ids->emplace_back(unk_token_id_);
       return;
-    } else {
-      start = end;
-      wordpiece_ids.emplace_back(cur_substr_id);
     }
+    start += match;
+    wordpiece_ids.emplace_back(cur_substr_id);
   }
   for (auto& token_id : wordpiece_ids) {
     token_ids->emplace_back(token_id);
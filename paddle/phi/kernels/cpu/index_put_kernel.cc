@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/index_put_kernel.h"
+#include <algorithm>
 #include <array>
+#include <utility>
+#include <vector>
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cast_kernel.h"
@@ -21,6 +24,62 @@
 
 namespace phi {
 
+inline int64_t index_put_offset(const int64_t** indices,
+                                const phi::DDim& stride,
+                                const phi::DDim& shape,
+                                int64_t idx) {
+  int64_t offset = 0;
+  for (int i = 0; i < shape.size(); ++i) {
+    int64_t cur_ix = (static_cast<int64_t>(*(indices[i] + idx)));
+    if (cur_ix < 0) {
+      cur_ix += shape[i];
+    }
+    offset += stride[i] * cur_ix;
+  }
+  return offset;
+}
+
+// Sorts the (offset, idx) of the values, then adds the values of each offset
+// in the order of idx on one thread, so no element is written by two threads.
+template <typename T>
+void sorted_index_put_accumulate(const int64_t N,
+                                 const T* vals,
+                                 const int64_t** indices,
+                                 const phi::DDim& stride,
+                                 const phi::DDim& shape,
+                                 int64_t is_single_val_tensor,
+                                 T* out) {
+  std::vector<std::pair<int64_t, int64_t>> offsets(N);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t idx = 0; idx < N; ++idx) {
+    offsets[idx] = {index_put_offset(indices, stride, shape, idx), idx};
+  }
+  std::sort(offsets.begin(), offsets.end());
+
+  std::vector<int64_t> heads;
+  for (int64_t i = 0; i < N; ++i) {
+    if (i == 0 || offsets[i].first != offsets[i - 1].first) {
+      heads.push_back(i);
+    }
+  }
+  heads.push_back(N);
+
+  const int64_t num_segments = static_cast<int64_t>(heads.size()) - 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t s = 0; s < num_segments; ++s) {
+    T* dst = out + offsets[heads[s]].first;
+    T sum = *dst;
+    for (int64_t i = heads[s]; i < heads[s + 1]; ++i) {
+      sum += *(vals + (offsets[i].second & is_single_val_tensor));
+    }
+    *dst = sum;
+  }
+}
+
 template <typename T>
 void index_put_kernel(const int64_t N,
                       const T* x UNUSED,
@@ -31,26 +90,26 @@ void index_put_kernel(const int64_t N,
                       int64_t is_single_val_tensor,
                       bool accumulate,
                       T* out) {
+  if (accumulate) {
+    if (funcs::UseSortedIndexPut(N, common::product(shape))) {
+      sorted_index_put_accumulate<T>(
+          N, vals, indices, stride, shape, is_single_val_tensor, out);
+      return;
+    }
+    // the values of the same element may not be added on two threads
+    for (int64_t idx = 0; idx < N; ++idx) {
+      *(out + index_put_offset(indices, stride, shape, idx)) +=
+          *(vals + (idx & is_single_val_tensor));
+    }
+    return;
+  }
+
 #ifdef PADDLE_WITH_MKLML
 #pragma omp parallel for
 #endif
   for (int64_t idx = 0; idx < N; ++idx) {
-    int64_t cur_ix = 0;
-    int64_t offset = 0;
-
-    for (int i = 0; i < shape.size(); ++i) {
-      cur_ix = (static_cast<int64_t>(*(indices[i] + idx)));
-      if (cur_ix < 0) {
-        cur_ix += shape[i];
-      }
-      offset += stride[i] * cur_ix;
-    }
-
-    if (accumulate) {
-      *(out + offset) += *(vals + (idx & is_single_val_tensor));
-    } else {
-      *(out + offset) = *(vals + (idx & is_single_val_tensor));
-    }
+    *(out + index_put_offset(indices, stride, shape, idx)) =
+        *(vals + (idx & is_single_val_tensor));
   }
 }
 
@@ -22,6 +22,7 @@
 #endif
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/parallel_for.h"
 #include "paddle/phi/kernels/funcs/elementwise_base.h"
 #include "paddle/phi/kernels/funcs/elementwise_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -134,15 +135,26 @@ void LayerNormKernel(const Context& dev_ctx,
   auto ker =
       phi::jit::KernelFuncs<phi::jit::LayerNormTuple<T>, phi::CPUPlace>::Cache()
           .At(right);
-  ker(x_tmp.data<T>(),
-      out.data<T>(),
-      mean_tmp.data<T>(),
-      var_tmp.data<T>(),
-      scale ? scale->data<T>() : nullptr,
-      bias ? bias->data<T>() : nullptr,
-      static_cast<int>(left),
-      static_cast<float>(epsilon),
-      right);
+  T* x_data = x_tmp.data<T>();
+  T* out_data = out.data<T>();
+  T* mean_data = mean_tmp.data<T>();
+  T* var_data = var_tmp.data<T>();
+  const T* scale_data = scale ? scale->data<T>() : nullptr;
+  const T* bias_data = bias ? bias->data<T>() : nullptr;
+  // The rows are normalized independently, so that the kernel runs on the
+  // rows of each chunk.
+  phi::ParallelFor(
+      0, left, phi::ParallelGrainSize(right), [&](int64_t begin, int64_t end) {
+        ker(x_data + begin * right,
+            out_data + begin * right,
+            mean_data + begin,
+            var_data + begin,
+            scale_data,
+            bias_data,
+            static_cast<int>(end - begin),
+            static_cast<float>(epsilon),
+            right);
+      });
 #endif
 }
 
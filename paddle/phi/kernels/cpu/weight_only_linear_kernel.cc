@@ -0,0 +1,258 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/weight_only_linear_kernel.h"
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+namespace phi {
+
+namespace {
+
+// The rows of the weight dequantized at once for the GEMM, small enough to
+// stay in the L2 cache with the rows of x.
+constexpr int64_t kPanelRows = 64;
+// Up to the rows of x, e.g. the tokens of a decoding step, the products are
+// accumulated on the ints of the weight, which is read only once.
+constexpr int64_t kMaxDotRows = 4;
+
+// The weight is in the layout of weight_quantize with arch 0: the rows of
+// the output channels, [n, k] for int8, and [n / 2, k] for int4 with the
+// channels 2i and 2i + 1 in the low and high 4 bits of row i.
+template <int bits>
+struct WeightRow {
+  WeightRow(const int8_t* weight, int64_t k_size, int64_t n)
+      : data(weight + (bits == 8 ? n : n / 2) * k_size), high(n % 2 == 1) {}
+
+  float operator[](int64_t k) const {
+    if (bits == 8) return static_cast<float>(data[k]);
+    // shifts the 4 bits to the top and back to extend the sign
+    return high ? static_cast<float>(data[k] >> 4)
+                : static_cast<float>(static_cast<int8_t>(data[k] << 4) >> 4);
+  }
+
+  const int8_t* data;
+  bool high;
+};
+
+template <typename T>
+float ScaleOf(const T* scale,
+              int64_t n_size,
+              int64_t n,
+              int64_t k,
+              int32_t group_size) {
+  return static_cast<float>(
+      group_size == -1 ? scale[n] : scale[(k / group_size) * n_size + n]);
+}
+
+// out[m, n] = sum_k x[m, k] * w[n, k] * scale, fused on the ints of the
+// weight, for a few rows of x.
+template <typename T, int bits>
+void DotWeightOnly(const float* x,
+                   const int8_t* weight,
+                   const T* scale,
+                   int64_t m_size,
+                   int64_t n_size,
+                   int64_t k_size,
+                   int32_t group_size,
+                   float* out) {
+  int64_t group = group_size == -1 ? k_size : group_size;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t n = 0; n < n_size; ++n) {
+    WeightRow<bits> w(weight, k_size, n);
+    for (int64_t m = 0; m < m_size; ++m) {
+      const float* x_row = x + m * k_size;
+      float sum = 0.f;
+      for (int64_t k_begin = 0; k_begin < k_size; k_begin += group) {
+        int64_t k_end = std::min(k_begin + group, k_size);
+        float group_sum = 0.f;
+        for (int64_t k = k_begin; k < k_end; ++k) {
+          group_sum += x_row[k] * w[k];
+        }
+        sum += group_sum * ScaleOf(scale, n_size, n, k_begin, group_size);
+      }
+      out[m * n_size + n] = sum;
+    }
+  }
+}
+
+// Dequantizes the weight a panel of rows at a time, each multiplied by x in
+// a GEMM while it is in the cache, so the float weight is never stored.
+template <typename T, int bits>
+void GemmWeightOnly(const CPUContext& dev_ctx,
+                    const float* x,
+                    const int8_t* weight,
+                    const T* scale,
+                    int64_t m_size,
+                    int64_t n_size,
+                    int64_t k_size,
+                    int32_t group_size,
+                    float* out) {
+  auto blas = funcs::GetBlas<CPUContext, float>(dev_ctx);
+  std::vector<float> panel(kPanelRows * k_size);
+  for (int64_t n_begin = 0; n_begin < n_size; n_begin += kPanelRows) {
+    int64_t rows = std::min(kPanelRows, n_size - n_begin);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t r = 0; r < rows; ++r) {
+      int64_t n = n_begin + r;
+      WeightRow<bits> w(weight, k_size, n);
+      float* panel_row = panel.data() + r * k_size;
+      for (int64_t k = 0; k < k_size; ++k) {
+        panel_row[k] = w[k] * ScaleOf(scale, n_size, n, k, group_size);
+      }
+    }
+    blas.GEMM(false,
+              true,
+              static_cast<int>(m_size),
+              static_cast<int>(rows),
+              static_cast<int>(k_size),
+              1.f,
+              x,
+              static_cast<int>(k_size),
+              panel.data(),
+              static_cast<int>(k_size),
+              0.f,
+              out + n_begin,
+              static_cast<int>(n_size));
+  }
+}
+
+}  // namespace
+
+template <typename T, typename Context>
+void WeightOnlyLinearKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& weight,
+                            const paddle::optional<DenseTensor>& bias,
+                            const DenseTensor& weight_scale,
+                            const std::string& weight_dtype,
+                            const int32_t arch,
+                            const int32_t group_size,
+                            DenseTensor* out) {
+  PADDLE_ENFORCE_EQ(
+      arch,
+      0,
+      common::errors::InvalidArgument(
+          "The CPU kernel of weight_only_linear needs the weight quantized by "
+          "weight_quantize with arch 0, but got arch %d.",
+          arch));
+  dev_ctx.template Alloc<T>(out);
+  const int64_t k_size = x.dims()[x.dims().size() - 1];
+  const int64_t m_size = x.numel() / k_size;
+  const int64_t n_size = out->dims()[out->dims().size() - 1];
+  if (m_size == 0) return;
+
+  // the rows of x and out in float
+  std::vector<float> x_float;
+  const float* x_data = nullptr;
+  if (std::is_same<T, float>::value) {
+    x_data = reinterpret_cast<const float*>(x.data<T>());
+  } else {
+    x_float.assign(x.data<T>(), x.data<T>() + x.numel());
+    x_data = x_float.data();
+  }
+  std::vector<float> out_float;
+  float* out_data = nullptr;
+  if (std::is_same<T, float>::value) {
+    out_data = reinterpret_cast<float*>(out->data<T>());
+  } else {
+    out_float.resize(out->numel());
+    out_data = out_float.data();
+  }
+
+  const int8_t* weight_data = weight.data<int8_t>();
+  const T* scale_data = weight_scale.data<T>();
+  bool use_dot = m_size <= kMaxDotRows;
+  if (weight_dtype == "int8") {
+    if (use_dot) {
+      DotWeightOnly<T, 8>(x_data,
+                          weight_data,
+                          scale_data,
+                          m_size,
+                          n_size,
+                          k_size,
+                          group_size,
+                          out_data);
+    } else {
+      GemmWeightOnly<T, 8>(dev_ctx,
+                           x_data,
+                           weight_data,
+                           scale_data,
+                           m_size,
+                           n_size,
+                           k_size,
+                           group_size,
+                           out_data);
+    }
+  } else if (weight_dtype == "int4") {
+    if (use_dot) {
+      DotWeightOnly<T, 4>(x_data,
+                          weight_data,
+                          scale_data,
+                          m_size,
+                          n_size,
+                          k_size,
+                          group_size,
+                          out_data);
+    } else {
+      GemmWeightOnly<T, 4>(dev_ctx,
+                           x_data,
+                           weight_data,
+                           scale_data,
+                           m_size,
+                           n_size,
+                           k_size,
+                           group_size,
+                           out_data);
+    }
+  } else {
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "The weight_dtype must be int8 or int4, but got %s.", weight_dtype));
+  }
+
+  if (bias) {
+    const T* bias_data = bias->data<T>();
+    for (int64_t m = 0; m < m_size; ++m) {
+      for (int64_t n = 0; n < n_size; ++n) {
+        out_data[m * n_size + n] += static_cast<float>(bias_data[n]);
+      }
+    }
+  }
+  if (!std::is_same<T, float>::value) {
+    T* out_t = out->data<T>();
+    for (int64_t i = 0; i < out->numel(); ++i) {
+      out_t[i] = static_cast<T>(out_float[i]);
+    }
+  }
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(weight_only_linear,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::WeightOnlyLinearKernel,
+                   float,
+                   phi::dtype::bfloat16) {}
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/phi/kernels/weight_quantize_kernel.h"
+
+#include <algorithm>
+
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
@@ -36,11 +39,11 @@ void quant_compute(const DeviceContext& dev_ctx,
                    const int32_t group_size) {
 #ifndef PADDLE_WITH_HIP
   PADDLE_ENFORCE_EQ(
-      ((arch == 70) || (arch == 75) || (arch == 80) || (arch == 86) ||
-       (arch == 89) || (arch == 90)),
+      ((arch == 0) || (arch == 70) || (arch == 75) || (arch == 80) ||
+       (arch == 86) || (arch == 89) || (arch == 90)),
       true,
       common::errors::InvalidArgument(
-          "Currently, arch only support 70, 75, 80, 86, 89, 90."));
+          "Currently, arch only support 0 (CPU), 70, 75, 80, 86, 89, 90."));
 
 #endif
   const auto x_dims = x.dims();
@@ -62,8 +65,8 @@ void quant_compute(const DeviceContext& dev_ctx,
 #ifdef PADDLE_WITH_HIP
   x_int.Resize({static_cast<int64_t>(m), static_cast<int64_t>(n)});
 #else
-  if ((arch == 80) || (arch == 75) || (arch == 86) || (arch == 89) ||
-      (arch == 90)) {
+  if ((arch == 0) || (arch == 80) || (arch == 75) || (arch == 86) ||
+      (arch == 89) || (arch == 90)) {
     x_int.Resize({static_cast<int64_t>(m), static_cast<int64_t>(n)});
   } else {
     // phi::Copy may change tensor meta info, here we transpose the quanted
@@ -109,6 +112,22 @@ void quant_compute(const DeviceContext& dev_ctx,
     std::vector<int> axis = {1, 0};
     funcs::Transpose<DeviceContext, int8_t, 2> trans;
     trans(dev_ctx, x_int, out, axis);
+  } else if (arch == 0) {
+    // NOTE: The layout of the CPU kernel of weight_only_linear is the rows of
+    // the output channels, [n, m] for int8, and [n / 2, m] for int4 with the
+    // channels 2i and 2i + 1 in the low and high 4 bits of row i.
+    std::vector<int> axis = {1, 0};
+    funcs::Transpose<DeviceContext, int8_t, 2> trans;
+    if (bits == 8) {
+      trans(dev_ctx, x_int, out, axis);
+    } else {
+      DenseTensor x_int_packed(x_int.type());
+      x_int_packed.Resize(
+          {static_cast<int64_t>(m), static_cast<int64_t>(n / 2)});
+      D* x_int_packed_data = dev_ctx.template Alloc<D>(&x_int_packed);
+      std::copy(x_int_data, x_int_data + out->numel(), x_int_packed_data);
+      trans(dev_ctx, x_int_packed, out, axis);
+    }
   } else {
 #ifdef PADDLE_WITH_HIP
     if (bits == 8) {
@@ -182,5 +201,6 @@ PD_REGISTER_KERNEL(weight_quantize,
                    CPU,
                    ALL_LAYOUT,
                    phi::WeightQuantizeKernel,
+                   float,
                    phi::dtype::float16,
                    phi::dtype::bfloat16) {}
@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
@@ -23,4 +26,12 @@ void DecodeJpegKernel(const Context& dev_ctx,
                       const DenseTensor& x,
                       const std::string& mode,
                       DenseTensor* out);
+
+// Decodes a batch of JPEG images at once, each of x being the raw bytes of an
+// image in host memory.
+template <typename T, typename Context>
+void DecodeJpegBatchKernel(const Context& dev_ctx,
+                           const std::vector<const DenseTensor*>& x,
+                           const std::string& mode,
+                           std::vector<DenseTensor*> out);
 }  // namespace phi
@@ -487,6 +487,8 @@ struct CublasLtBase {
 
         auto& cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
         cache.SetSubKey(sub_key, reinterpret_cast<void*>(best_desc));
+        cache.SetSubKeyAlgo(
+            sub_key, best_desc->algo, sizeof(cublasLtMatmulAlgo_t));
       }
     }
 
@@ -680,6 +682,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
 
       auto& cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
       cache.SetSubKey(sub_key, reinterpret_cast<void*>(best_desc));
+      cache.SetSubKeyAlgo(
+          sub_key, best_desc->algo, sizeof(cublasLtMatmulAlgo_t));
     } else {
       workspace = GetWorkspace(ctx, workspace_size);
       if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune() &&
@@ -699,6 +703,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
 
         auto& cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
         cache.SetSubKey(sub_key, reinterpret_cast<void*>(best_desc));
+        cache.SetSubKeyAlgo(
+            sub_key, best_desc->algo, sizeof(cublasLtMatmulAlgo_t));
       }
     }
 
@@ -1008,16 +1014,38 @@ struct DescriptorSetter {
       sub_key = planner->GenSubKey();
     }
 
+    auto& matmul_cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
+    // the algorithms loaded from FLAGS_autotune_cache_file are used out of
+    // the tuning range too
+    const bool has_algo =
+        planner != nullptr && matmul_cache.FindSubKeyAlgo(sub_key);
     bool has_cache = false;
-    if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune()) {
-      auto& matmul_cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
+    if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune() || has_algo) {
       has_cache = matmul_cache.FindSubKey(sub_key);
     }
     if (has_cache) {
-      auto& matmul_cache = phi::autotune::AutoTuneCache::Instance().GetMatmul();
       desc = *(reinterpret_cast<DescT*>(matmul_cache.GetSubKey(sub_key)));
       desc.template SetFusedEpiloguePtr<DYT>(planner);
       VLOG(7) << "[Heap CublasltDescriptor] ";
+    } else if (has_algo) {
+      desc.template Create<T, DXT, DYT, TransX, TransY>(M,
+                                                        N,
+                                                        K,
+                                                        trans_x,
+                                                        trans_y,
+                                                        planner,
+                                                        batch_size,
+                                                        stride_x,
+                                                        stride_y,
+                                                        stride_out,
+                                                        grad_for_dx);
+      desc.ExchangeXYDesc(no_exchange);
+      matmul_cache.GetSubKeyAlgo(
+          sub_key, desc.SetAlgo(), sizeof(cublasLtMatmulAlgo_t));
+      matmul_cache.SetSubKey(sub_key,
+                             reinterpret_cast<void*>(new DescT(desc)));
+      desc.template SetFusedEpiloguePtr<DYT>(planner);
+      VLOG(7) << "[Loaded CublasltDescriptor] ";
     } else {
       desc.template Create<T, DXT, DYT, TransX, TransY>(M,
                                                         N,
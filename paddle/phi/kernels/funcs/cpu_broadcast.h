@@ -0,0 +1,315 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <type_traits>
+#include <vector>
+
+#include "paddle/common/array.h"
+#include "paddle/common/macros.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/parallel_for.h"
+#include "paddle/phi/kernels/funcs/cpu_vec.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+
+namespace phi {
+namespace funcs {
+
+// The broadcast of two inputs to the output on CPU, with the size-1 dims of
+// the output dropped and the sequential dims of the same broadcast pattern
+// merged. Example below :
+//   x.shape = [2, 3, 4, 5]       x.shape = [6, 20]
+//   y.shape = [1, 1, 4, 5]   ->  y.shape = [1, 20]
+//   out.shape = [2, 3, 4, 5]     out.shape = [6, 20]
+// so that the innermost dim of each input is contiguous or broadcast, or
+// has the stride of a view if the strides are given.
+struct CPUBroadcastDims {
+  // From the outermost dim to the innermost one.
+  std::vector<int64_t> out_dims;
+  // The strides of the inputs in each dim, 0 for the broadcast dims.
+  std::vector<int64_t> x_strides;
+  std::vector<int64_t> y_strides;
+
+  template <typename DimT>
+  CPUBroadcastDims(const DimT *x_dims_array,
+                   const DimT *y_dims_array,
+                   const DimT *out_dims_array,
+                   int max_dim) {
+    // Bit 0 for the dims of x, bit 1 for the dims of y.
+    std::vector<int> patterns;
+    for (int i = 0; i < max_dim; ++i) {
+      if (out_dims_array[i] == 1) continue;
+      int pattern = (x_dims_array[i] == 1 ? 0 : 1) |
+                    (y_dims_array[i] == 1 ? 0 : 2);
+      if (!patterns.empty() && patterns.back() == pattern) {
+        out_dims.back() *= out_dims_array[i];
+      } else {
+        patterns.push_back(pattern);
+        out_dims.push_back(out_dims_array[i]);
+      }
+    }
+    if (out_dims.empty()) {
+      patterns.push_back(3);
+      out_dims.push_back(1);
+    }
+    int rank = static_cast<int>(out_dims.size());
+    x_strides.resize(rank);
+    y_strides.resize(rank);
+    int64_t x_stride = 1, y_stride = 1;
+    for (int i = rank - 1; i >= 0; --i) {
+      x_strides[i] = (patterns[i] & 1) ? x_stride : 0;
+      y_strides[i] = (patterns[i] & 2) ? y_stride : 0;
+      if (patterns[i] & 1) x_stride *= out_dims[i];
+      if (patterns[i] & 2) y_stride *= out_dims[i];
+    }
+  }
+
+  // From the dims of out and the strides of the inputs in each dim of out,
+  // 0 for the broadcast dims, which are the strides of views for the
+  // strided inputs.
+  CPUBroadcastDims(const std::vector<int64_t> &out_dims_in,
+                   const std::vector<int64_t> &x_strides_in,
+                   const std::vector<int64_t> &y_strides_in) {
+    // Merges the dims from the innermost one, where the outer dim of each
+    // input steps over the whole inner dim.
+    for (int i = static_cast<int>(out_dims_in.size()) - 1; i >= 0; --i) {
+      if (out_dims_in[i] == 1) continue;
+      if (!out_dims.empty() &&
+          x_strides_in[i] == x_strides.back() * out_dims.back() &&
+          y_strides_in[i] == y_strides.back() * out_dims.back()) {
+        out_dims.back() *= out_dims_in[i];
+        continue;
+      }
+      out_dims.push_back(out_dims_in[i]);
+      x_strides.push_back(x_strides_in[i]);
+      y_strides.push_back(y_strides_in[i]);
+    }
+    if (out_dims.empty()) {
+      out_dims.push_back(1);
+      x_strides.push_back(1);
+      y_strides.push_back(1);
+    }
+    std::reverse(out_dims.begin(), out_dims.end());
+    std::reverse(x_strides.begin(), x_strides.end());
+    std::reverse(y_strides.begin(), y_strides.end());
+  }
+
+  int Rank() const { return static_cast<int>(out_dims.size()); }
+  int64_t Inner() const { return out_dims.back(); }
+};
+
+// Computes a contiguous row of the output with the SIMD kernels of cpu_vec.
+// Returns false if there is no such kernel for the functor.
+template <typename Functor, typename T, typename OutType>
+struct CPUBroadcastVecRow {
+  static bool Run(const T *x UNUSED,
+                  bool x_broadcast UNUSED,
+                  const T *y UNUSED,
+                  bool y_broadcast UNUSED,
+                  OutType *out UNUSED,
+                  int64_t n UNUSED) {
+    return false;
+  }
+};
+
+template <>
+struct CPUBroadcastVecRow<AddFunctor<float>, float, float> {
+  static bool Run(const float *x,
+                  bool x_broadcast,
+                  const float *y,
+                  bool y_broadcast,
+                  float *out,
+                  int64_t n) {
+    if (x_broadcast == y_broadcast || n > INT_MAX ||
+        !backends::cpu::MayIUse(backends::cpu::avx)) {
+      return false;
+    }
+    // The addition is commutative, so that the inputs may be swapped.
+    if (x_broadcast) {
+      vec_add_bias<float, backends::cpu::avx>(n, *x, y, out);
+    } else {
+      vec_add_bias<float, backends::cpu::avx>(n, *y, x, out);
+    }
+    return true;
+  }
+};
+
+template <>
+struct CPUBroadcastVecRow<MultiplyFunctor<float>, float, float> {
+  static bool Run(const float *x,
+                  bool x_broadcast,
+                  const float *y,
+                  bool y_broadcast,
+                  float *out,
+                  int64_t n) {
+    if ((x_broadcast && y_broadcast) || n > INT_MAX ||
+        !backends::cpu::MayIUse(backends::cpu::avx)) {
+      return false;
+    }
+    if (!x_broadcast && !y_broadcast) {
+      vec_mul<float, backends::cpu::avx>(n, x, y, out);
+    } else if (x_broadcast) {
+      vec_scal<float, backends::cpu::avx>(n, *x, y, out);
+    } else {
+      vec_scal<float, backends::cpu::avx>(n, *y, x, out);
+    }
+    return true;
+  }
+};
+
+// Computes a contiguous row of the output, whose inputs step by x_stride and
+// y_stride in the row, 0 for the broadcast inputs. The loops of the
+// contiguous and broadcast inputs are kept free of the index computation so
+// that the compiler vectorizes them.
+template <bool kSwap, typename Functor, typename T, typename OutType>
+inline void CPUBroadcastRow(Functor func,
+                            const T *x,
+                            int64_t x_stride,
+                            const T *y,
+                            int64_t y_stride,
+                            OutType *out,
+                            int64_t n) {
+  auto apply = [&func](const T &a, const T &b) {
+    return kSwap ? func(b, a) : func(a, b);
+  };
+  if (x_stride > 1 || y_stride > 1) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = apply(x[i * x_stride], y[i * y_stride]);
+    }
+    return;
+  }
+  const bool x_broadcast = x_stride == 0;
+  const bool y_broadcast = y_stride == 0;
+  if (CPUBroadcastVecRow<Functor, T, OutType>::Run(
+          x, x_broadcast, y, y_broadcast, out, n)) {
+    return;
+  }
+  if (!x_broadcast && !y_broadcast) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = apply(x[i], y[i]);
+    }
+  } else if (x_broadcast && !y_broadcast) {
+    const T a = *x;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = apply(a, y[i]);
+    }
+  } else if (!x_broadcast && y_broadcast) {
+    const T b = *y;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = apply(x[i], b);
+    }
+  } else {
+    const OutType value = apply(*x, *y);
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = value;
+    }
+  }
+}
+
+// Computes out = func(x, y) with the broadcast of x and y, or func(y, x) if
+// kSwap, row by row of the innermost dim of the simplified dims into the
+// contiguous out. The rows run in parallel, and the offsets of the inputs in
+// the outer dims are computed once per row.
+template <bool kSwap, typename Functor, typename T, typename OutType>
+void CPUBroadcast(const CPUBroadcastDims &dims,
+                  const T *x_data,
+                  const T *y_data,
+                  OutType *out_data,
+                  Functor func) {
+  const int outer_rank = dims.Rank() - 1;
+  const int64_t inner = dims.Inner();
+  const int64_t x_inner_stride = dims.x_strides[outer_rank];
+  const int64_t y_inner_stride = dims.y_strides[outer_rank];
+  int64_t rows = 1;
+  for (int i = 0; i < outer_rank; ++i) {
+    rows *= dims.out_dims[i];
+  }
+  phi::ParallelFor(
+      0, rows, phi::ParallelGrainSize(inner), [&](int64_t begin, int64_t end) {
+        // The index of each outer dim of the first row of the chunk.
+        std::vector<int64_t> index(outer_rank, 0);
+        int64_t x_offset = 0, y_offset = 0;
+        int64_t row = begin;
+        for (int i = outer_rank - 1; i >= 0; --i) {
+          index[i] = row % dims.out_dims[i];
+          row /= dims.out_dims[i];
+          x_offset += index[i] * dims.x_strides[i];
+          y_offset += index[i] * dims.y_strides[i];
+        }
+        for (int64_t r = begin; r < end; ++r) {
+          CPUBroadcastRow<kSwap>(func,
+                                 x_data + x_offset,
+                                 x_inner_stride,
+                                 y_data + y_offset,
+                                 y_inner_stride,
+                                 out_data + r * inner,
+                                 inner);
+          for (int i = outer_rank - 1; i >= 0; --i) {
+            x_offset += dims.x_strides[i];
+            y_offset += dims.y_strides[i];
+            if (++index[i] < dims.out_dims[i]) break;
+            x_offset -= dims.x_strides[i] * dims.out_dims[i];
+            y_offset -= dims.y_strides[i] * dims.out_dims[i];
+            index[i] = 0;
+          }
+        }
+      });
+}
+
+// Computes out = func(x, y) with the broadcast of x and y to out, or
+// func(y, x) if not is_xsize_larger, whose dims arrays are aligned to the
+// max_dim dims of out.
+template <typename Functor, typename T, typename OutType, typename DimT>
+void CPUBroadcastForward(const T *x_data,
+                         const T *y_data,
+                         OutType *out_data,
+                         const DimT *x_dims_array,
+                         const DimT *y_dims_array,
+                         const DimT *out_dims_array,
+                         int max_dim,
+                         Functor func,
+                         bool is_xsize_larger) {
+  CPUBroadcastDims dims(x_dims_array, y_dims_array, out_dims_array, max_dim);
+  if (is_xsize_larger) {
+    CPUBroadcast<false>(dims, x_data, y_data, out_data, func);
+  } else {
+    CPUBroadcast<true>(dims, x_data, y_data, out_data, func);
+  }
+}
+
+// Computes out = func(x) into the contiguous out, with x read through its
+// strides in each dim of out, e.g. a view of a transpose or a slice.
+template <typename Functor, typename T, typename OutType>
+void CPUStridedTransform(const T *x_data,
+                         const std::vector<int64_t> &dims,
+                         const std::vector<int64_t> &x_strides,
+                         OutType *out_data,
+                         Functor func) {
+  // The second input never moves, so that it is never read past x_data.
+  CPUBroadcastDims broadcast_dims(
+      dims, x_strides, std::vector<int64_t>(dims.size(), 0));
+  CPUBroadcast<false>(
+      broadcast_dims,
+      x_data,
+      x_data,
+      out_data,
+      [&func](const T &a, const T &b UNUSED) { return func(a); });
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,105 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/device_rng_state.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "paddle/phi/backends/gpu/cuda/cuda_graph_with_memory_pool.h"
+#include "paddle/phi/common/memory_utils.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/generator.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+__global__ void ResetDeviceRngStateKernel(DeviceRngState* state,
+                                          uint64_t seed,
+                                          uint64_t offset) {
+  state->seed = seed;
+  state->offset = offset;
+  state->num_blocks_done = 0;
+}
+
+class DeviceRngStates {
+ public:
+  static DeviceRngStates& Instance() {
+    static DeviceRngStates states;
+    return states;
+  }
+
+  DeviceRngState* Get(const phi::GPUContext& ctx, uint64_t increment) {
+    auto gen = ctx.GetGenerator();
+    bool capturing = phi::backends::gpu::IsCUDAGraphCapturing();
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto key = std::make_pair(ctx.GetPlace().GetDeviceId(), ctx.stream());
+    auto it = states_.find(key);
+    if (it == states_.end()) {
+      PADDLE_ENFORCE_EQ(
+          capturing,
+          false,
+          common::errors::PreconditionNotMet(
+              "The device RNG state of a stream is created out of the "
+              "capture of a CUDA graph, please run the captured step once "
+              "before the capture."));
+      Item item;
+      item.allocation =
+          phi::memory_utils::Alloc(ctx.GetPlace(), sizeof(DeviceRngState));
+      it = states_.emplace(key, std::move(item)).first;
+    }
+    auto* state =
+        reinterpret_cast<DeviceRngState*>(it->second.allocation->ptr());
+    if (!capturing) {
+      auto seed_offset = gen->IncrementOffset(increment);
+      if (!it->second.initialized || seed_offset.first != it->second.seed ||
+          seed_offset.second != it->second.offset) {
+        // in the order of the kernels on the stream, with no sync
+        ResetDeviceRngStateKernel<<<1, 1, 0, ctx.stream()>>>(
+            state, seed_offset.first, seed_offset.second);
+        it->second.initialized = true;
+        it->second.seed = seed_offset.first;
+      }
+      it->second.offset = seed_offset.second + increment;
+    }
+    return state;
+  }
+
+ private:
+  struct Item {
+    phi::Allocator::AllocationPtr allocation;
+    bool initialized{false};
+    // the seed and the offset of the generator the state follows
+    uint64_t seed{0};
+    uint64_t offset{0};
+  };
+
+  DeviceRngStates() = default;
+
+  std::mutex mutex_;
+  std::map<std::pair<int, gpuStream_t>, Item> states_;
+};
+
+}  // namespace
+
+DeviceRngState* GetDeviceRngState(const phi::GPUContext& ctx,
+                                  uint64_t increment) {
+  return DeviceRngStates::Instance().Get(ctx, increment);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,77 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#endif
+
+namespace phi {
+namespace funcs {
+
+// The seed and the offset of the Philox generator of a stream, kept in the
+// device memory and advanced by the kernels drawing from it. The host never
+// computes the offset of a kernel, so the kernels captured in a CUDA graph
+// draw new numbers on every replay.
+struct DeviceRngState {
+  uint64_t seed;
+  uint64_t offset;
+  unsigned int num_blocks_done;
+};
+
+#if defined(__NVCC__) || defined(__HIPCC__)
+// Reads the seed and the offset for all the threads of a block, and the last
+// block of the kernel advances the offset by the numbers a thread draws, so
+// the next kernel on the stream draws after this one. All the threads of all
+// the blocks of the kernel call it.
+__device__ __forceinline__ void ReadAndAdvanceDeviceRngState(
+    DeviceRngState* state,
+    const uint64_t increment,
+    uint64_t* seed,
+    uint64_t* offset) {
+  __shared__ uint64_t shared_seed;
+  __shared__ uint64_t shared_offset;
+  if (threadIdx.x == 0 && threadIdx.y == 0 && threadIdx.z == 0) {
+    shared_seed = state->seed;
+    shared_offset = state->offset;
+    // every block has read the offset when the last one gets here
+    __threadfence();
+    unsigned int num_blocks = gridDim.x * gridDim.y * gridDim.z;
+    if (atomicAdd(&state->num_blocks_done, 1u) == num_blocks - 1) {
+      state->offset = shared_offset + increment;
+      state->num_blocks_done = 0;
+    }
+  }
+  __syncthreads();
+  *seed = shared_seed;
+  *offset = shared_offset;
+}
+#endif
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// Returns the device state of the stream of ctx for a kernel drawing
+// increment numbers in a thread. Out of the capture of a CUDA graph, the
+// offset of the generator of ctx is advanced as well, and the state is reset
+// to the seed and the offset of the generator when they are not the ones the
+// state follows, e.g. after the generator is seeded. In a capture, only the
+// kernels advance the state, so every replay draws new numbers.
+DeviceRngState* GetDeviceRngState(const phi::GPUContext& ctx,
+                                  uint64_t increment);
+#endif
+
+}  // namespace funcs
+}  // namespace phi
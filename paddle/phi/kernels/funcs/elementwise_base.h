@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/empty_kernel.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
 #include "paddle/phi/kernels/funcs/elementwise_utils.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
@@ -281,7 +282,6 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
                                const CPUContext &ctx,
                                Functor func,
                                const bool is_xsize_larger = true) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   PADDLE_ENFORCE_NOT_NULL(
@@ -290,20 +290,15 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
       y_data, errors::InvalidArgument("The input Y should not be empty."));
   OutType *out_data = ctx.Alloc<OutType>(z);
 
-  const int out_size = std::accumulate(
-      out_dims_array, out_dims_array + max_dim, 1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (is_xsize_larger) {
-      out_data[out_index] = func(x_data[x_index], y_data[y_index]);
-    } else {
-      out_data[out_index] = func(y_data[y_index], x_data[x_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
-  }
+  CPUBroadcastForward(x_data,
+                      y_data,
+                      out_data,
+                      x_dims_array,
+                      y_dims_array,
+                      out_dims_array,
+                      max_dim,
+                      func,
+                      is_xsize_larger);
 }
 
 template <typename Functor, typename T, typename OutType = T>
@@ -379,10 +374,17 @@ void ElementwiseCompute(const CPUContext &dev_ctx,
     is_xsize_larger = false;
     max_dim = y_dims.size();
   }
-  TransformFunctor<Functor, T, CPUContext, OutType> functor(
-      x, y, z, dev_ctx, func, is_xsize_larger);
   if (x_dims == y_dims) {
-    functor.Run();
+    int64_t numel = x.numel();
+    CPUBroadcastForward(x.data<T>(),
+                        y.data<T>(),
+                        z->data<OutType>(),
+                        &numel,
+                        &numel,
+                        &numel,
+                        1,
+                        func,
+                        true);
     return;
   }
 
@@ -432,12 +434,30 @@ void ElementwiseCompute(const CPUContext &dev_ctx,
     return;
   }
 
-  if (post == 1) {
-    functor.RunRowWise(n);
-    return;
+  // The larger input is [pre, n, post], and the smaller one is [n], which is
+  // broadcast to the rows (post == 1) or the columns of the larger one.
+  const int large_dims[3] = {pre, n, post};
+  const int small_dims[3] = {1, n, 1};
+  if (is_xsize_larger) {
+    CPUBroadcastForward(x.data<T>(),
+                        y.data<T>(),
+                        z->data<OutType>(),
+                        large_dims,
+                        small_dims,
+                        large_dims,
+                        3,
+                        func,
+                        true);
   } else {
-    functor.RunMidWise(n, post);
-    return;
+    CPUBroadcastForward(y.data<T>(),
+                        x.data<T>(),
+                        z->data<OutType>(),
+                        large_dims,
+                        small_dims,
+                        large_dims,
+                        3,
+                        func,
+                        true);
   }
 }
 
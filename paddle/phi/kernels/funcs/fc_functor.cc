@@ -16,11 +16,40 @@ limitations under the License. */
 
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
 #include "paddle/phi/kernels/funcs/jit/kernels.h"
 
 namespace phi {
 namespace funcs {
 
+namespace {
+
+// Computes Y[i] = B + src[i], followed by relu if relu, for each row i of
+// the M rows of src stepping by ld.
+template <typename T>
+void FCAddBias(const int M,
+               const int N,
+               const T* src,
+               const int ld,
+               const T* B,
+               bool relu,
+               T* Y) {
+  auto compute = relu ? phi::jit::KernelFuncs<phi::jit::VAddReluTuple<T>,
+                                              phi::CPUPlace>::Cache()
+                            .At(N)
+                      : phi::jit::KernelFuncs<phi::jit::VAddTuple<T>,
+                                              phi::CPUPlace>::Cache()
+                            .At(N);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M; i++) {
+    compute(B, src + i * ld, Y + i * N, N);
+  }
+}
+
+}  // namespace
+
 template <typename DeviceContext, typename T>
 void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              const int M,
@@ -81,24 +110,57 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
         errors::PermissionDenied("When bias is NULL, relu can not be true."));
     return;
   }
-  auto compute = relu ? phi::jit::KernelFuncs<phi::jit::VAddReluTuple<T>,
-                                              phi::CPUPlace>::Cache()
-                            .At(N)
-                      : phi::jit::KernelFuncs<phi::jit::VAddTuple<T>,
-                                              phi::CPUPlace>::Cache()
-                            .At(N);
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < M; i++) {
-    T* dst = Y + i * N;
-    T* src = (padding_weights) ? Y1_data + i * (N + 4) : dst;
-    compute(B, src, dst, N);
-  }
+  FCAddBias(M,
+            N,
+            padding_weights ? Y1_data : Y,
+            padding_weights ? N + 4 : N,
+            B,
+            relu,
+            Y);
 }
 
 template class FCFunctor<CPUContext, float>;
 template class FCFunctor<CPUContext, double>;
 
+template <typename T>
+void PackedFCCompute(const CPUContext& context,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const T* X,
+                     const T* packed_W,
+                     T* Y,
+                     const T* B,
+                     bool relu) {
+  PackedGemm<T>(context, false, M, N, K, packed_W, X, Y);
+  if (B == nullptr) {
+    PADDLE_ENFORCE_EQ(
+        relu,
+        false,
+        errors::PermissionDenied("When bias is NULL, relu can not be true."));
+    return;
+  }
+  FCAddBias(M, N, Y, N, B, relu, Y);
+}
+
+template void PackedFCCompute<float>(const CPUContext&,
+                                     const int,
+                                     const int,
+                                     const int,
+                                     const float*,
+                                     const float*,
+                                     float*,
+                                     const float*,
+                                     bool);
+template void PackedFCCompute<double>(const CPUContext&,
+                                      const int,
+                                      const int,
+                                      const int,
+                                      const double*,
+                                      const double*,
+                                      double*,
+                                      const double*,
+                                      bool);
+
 }  // namespace funcs
 }  // namespace phi
@@ -57,5 +57,18 @@ class FCInt8Functor {
                   bool weight_pass = false);
 };
 
+// Computes Y = X * W + B of fc, followed by relu if relu, with packed_W the
+// weight W[K, N] packed by PackGemmWeight. See funcs/gemm_pack.h.
+template <typename T>
+void PackedFCCompute(const CPUContext& context,
+                     const int M,
+                     const int N,
+                     const int K,
+                     const T* X,
+                     const T* packed_W,
+                     T* Y,
+                     const T* B = nullptr,
+                     bool relu = false);
+
 }  // namespace funcs
 }  // namespace phi
@@ -12,12 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cmath>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "paddle/phi/kernels/funcs/fft.h"
 #include "paddle/phi/kernels/funcs/fft_cache.h"
 
 #include "paddle/common/ddim.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/kernels/assign_kernel.h"
 #include "paddle/phi/kernels/complex_kernel.h"
@@ -25,6 +30,8 @@
 #include "paddle/phi/kernels/scale_kernel.h"
 #include "paddle/phi/kernels/transpose_kernel.h"
 
+COMMON_DECLARE_bool(fft_plan_reuse_across_batch);
+
 namespace phi {
 namespace funcs {
 namespace detail {
@@ -89,6 +96,28 @@ bool has_large_prime_factor(int64_t n) {
   return n != 1;
 }
 
+// Splits a batch into the batches of powers of two, e.g. 13 into 8, 4 and 1,
+// so the plans of a signal are reused by all the batch sizes.
+static std::vector<int64_t> split_fft_batch(int64_t batch_size) {
+  std::vector<int64_t> batches;
+  for (int bit = 62; bit >= 0; --bit) {
+    int64_t batch = int64_t{1} << bit;
+    if (batch_size & batch) {
+      batches.push_back(batch);
+    }
+  }
+  return batches;
+}
+
+// The key of the same transform over another batch size.
+static FFTConfigKey rebatch_fft_configkey(FFTConfigKey key,
+                                          int64_t batch_size) {
+  key.sizes_[0] = batch_size;
+  key.input_shape_[0] = batch_size;
+  key.output_shape_[0] = batch_size;
+  return key;
+}
+
 #if defined(PADDLE_WITH_CUDA)
 inline bool use_cache(const int64_t* signal_size) {
   bool using_cache = true;
@@ -170,47 +199,90 @@ void exec_fft(const phi::GPUContext& ctx,
   FFTConfigKey key =
       create_fft_configkey(collapsed_input, collapsed_output, signal_ndim);
   int64_t device_id = ctx.GetPlace().GetDeviceId();
-  FFTConfig* config = nullptr;
+  // the plans with the batches they execute, one after another
+  std::vector<std::pair<FFTConfig*, int64_t>> plans;
   std::unique_ptr<FFTConfig> config_ = nullptr;
   bool using_cache = use_cache(key.sizes_);
+  // The cached plans are set to the stream and the workspace of this
+  // execution, so the cache is locked until they have been executed.
+  std::unique_lock<std::mutex> guard;
 
   if (using_cache) {
     FFTConfigCache& plan_cache = get_fft_plan_cache(device_id);
-    std::unique_lock<std::mutex> guard(plan_cache.mutex, std::defer_lock);
-    guard.lock();
-    config = &(plan_cache.lookup(key));
+    guard = std::unique_lock<std::mutex>(plan_cache.mutex);
+    std::vector<int64_t> batches = split_fft_batch(batch_size);
+    // a plan looked up could evict the ones before it from a small cache
+    if (FLAGS_fft_plan_reuse_across_batch &&
+        batches.size() <= plan_cache.max_size()) {
+      for (int64_t batch : batches) {
+        FFTConfigKey batch_key = rebatch_fft_configkey(key, batch);
+        plans.emplace_back(&(plan_cache.lookup(batch_key)), batch);
+      }
+    } else {
+      plans.emplace_back(&(plan_cache.lookup(key)), batch_size);
+    }
+    VLOG(4) << "FFT plan cache of device " << device_id
+            << ": size = " << plan_cache.size()
+            << ", hits = " << plan_cache.hits()
+            << ", misses = " << plan_cache.misses();
   } else {
     config_ = std::make_unique<FFTConfig>(key);
-    config = config_.get();
+    plans.emplace_back(config_.get(), batch_size);
   }
 
-  const int64_t workspace_size = static_cast<int64_t>(config->workspace_size());
-  DenseTensor workspace_tensor = Empty<uint8_t>(ctx, {workspace_size});
-
-  // prepare cufft for execution
-#if defined(PADDLE_WITH_CUDA)
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::cufftSetStream(config->plan(), ctx.stream()));
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::cufftSetWorkArea(config->plan(), workspace_tensor.data()));
-#elif defined(PADDLE_WITH_HIP)
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::hipfftSetStream(config->plan(), ctx.stream()));
-  PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::hipfftSetWorkArea(config->plan(), workspace_tensor.data()));
-#endif
+  // the plans are executed one by one, and share a workspace
+  size_t workspace_size = 0;
+  for (auto& plan : plans) {
+    workspace_size = std::max(workspace_size, plan.first->workspace_size());
+  }
+  DenseTensor workspace_tensor =
+      Empty<uint8_t>(ctx, {static_cast<int64_t>(workspace_size)});
+
+  // the elements of a batch of the input and the output
+  int64_t input_stride = 1;
+  int64_t output_stride = 1;
+  for (int i = 1; i <= signal_ndim; i++) {
+    input_stride *= collapsed_input_shape_[i];
+    output_stride *= collapsed_output_shape_[i];
+  }
 
   // execution of fft plan
-  const FFTTransformType fft_type = config->transform_type();
+  const FFTTransformType fft_type = key.fft_type_;
+  bool exec_forward = forward;
   if (fft_type == FFTTransformType::C2R && forward) {
     ConjKernel<Ti, phi::GPUContext>(ctx, collapsed_input, &collapsed_input);
-    exec_plan(*config, collapsed_input.data(), collapsed_output.data(), false);
+    exec_forward = false;
   } else if (fft_type == FFTTransformType::R2C && !forward) {
-    exec_plan(*config, collapsed_input.data(), collapsed_output.data(), true);
+    exec_forward = true;
+  }
+  Ti* input_data = collapsed_input.data<Ti>();
+  To* output_data = collapsed_output.data<To>();
+  int64_t batch_offset = 0;
+  for (auto& plan : plans) {
+    FFTConfig* config = plan.first;
+    // prepare cufft for execution
+#if defined(PADDLE_WITH_CUDA)
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        phi::dynload::cufftSetStream(config->plan(), ctx.stream()));
+    PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::cufftSetWorkArea(
+        config->plan(), workspace_tensor.data()));
+#elif defined(PADDLE_WITH_HIP)
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        phi::dynload::hipfftSetStream(config->plan(), ctx.stream()));
+    PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::hipfftSetWorkArea(
+        config->plan(), workspace_tensor.data()));
+#endif
+    exec_plan(*config,
+              input_data + batch_offset * input_stride,
+              output_data + batch_offset * output_stride,
+              exec_forward);
+    batch_offset += plan.second;
+  }
+  if (fft_type == FFTTransformType::R2C && !forward) {
     ConjKernel<To, phi::GPUContext>(ctx, collapsed_output, &collapsed_output);
-  } else {
-    exec_plan(
-        *config, collapsed_input.data(), collapsed_output.data(), forward);
+  }
+  if (guard.owns_lock()) {
+    guard.unlock();
   }
 
   // resize for the collapsed output
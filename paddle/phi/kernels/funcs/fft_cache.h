@@ -20,6 +20,7 @@
 #include <mutex>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/kernels/funcs/cufft_util.h"
@@ -71,12 +72,16 @@ class FFTConfigCache {
   FFTConfigCache(FFTConfigCache&& other) noexcept
       : _usage_list(std::move(other._usage_list)),
         _cache_map(std::move(other._cache_map)),
-        _max_size(other._max_size) {}
+        _max_size(other._max_size),
+        _hits(other._hits),
+        _misses(other._misses) {}
 
   FFTConfigCache& operator=(FFTConfigCache&& other) noexcept {
     _usage_list = std::move(other._usage_list);
     _cache_map = std::move(other._cache_map);
     _max_size = other._max_size;
+    _hits = other._hits;
+    _misses = other._misses;
     return *this;
   }
 
@@ -93,11 +98,13 @@ class FFTConfigCache {
     map_kkv_iter_t map_it = _cache_map.find(params);
     // Hit, put to list front
     if (map_it != _cache_map.end()) {
+      ++_hits;
       _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
       return map_it->second->second;
     }
 
     // Miss
+    ++_misses;
     // remove if needed
     if (_usage_list.size() >= _max_size) {
       auto last = _usage_list.end();
@@ -120,6 +127,8 @@ class FFTConfigCache {
   void clear() {
     _cache_map.clear();
     _usage_list.clear();
+    _hits = 0;
+    _misses = 0;
   }
 
   void resize(int64_t new_size) {
@@ -139,6 +148,10 @@ class FFTConfigCache {
 
   size_t max_size() const noexcept { return _max_size; }
 
+  // The lookups which found the plan in this cache, and which created it.
+  size_t hits() const noexcept { return _hits; }
+  size_t misses() const noexcept { return _misses; }
+
   std::mutex mutex;
 
  private:
@@ -166,12 +179,15 @@ class FFTConfigCache {
   std::list<kv_t> _usage_list;
   map_t _cache_map;
   size_t _max_size;
+  size_t _hits{0};
+  size_t _misses{0};
 };
 
-static std::vector<std::unique_ptr<FFTConfigCache>> plan_caches;
-static std::mutex plan_caches_mutex;
-
-static inline FFTConfigCache& get_fft_plan_cache(int64_t device_index) {
+// The caches of the devices are shared by all the translation units, and
+// each of them is locked by its own mutex.
+inline FFTConfigCache& get_fft_plan_cache(int64_t device_index) {
+  static std::vector<std::unique_ptr<FFTConfigCache>> plan_caches;
+  static std::mutex plan_caches_mutex;
   std::lock_guard<std::mutex> guard(plan_caches_mutex);
 
   if (device_index >= plan_caches.size()) {
@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/common/macros.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/parallel_for.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 namespace phi {
 namespace funcs {
@@ -72,29 +73,39 @@ void CPUGather(const phi::CPUContext& ctx UNUSED,
 
   const size_t slice_bytes = slice_size * sizeof(T);
 
-  for (int64_t i = 0; i < index_size; ++i) {
-    PADDLE_ENFORCE_LT(p_index[i],
-                      index_dim_size,
-                      common::errors::OutOfRange(
-                          "The element of Index must be less than the size of "
-                          "input dim size of axis which is %d, but received "
-                          "index element which is %d in the %d index.",
-                          index_dim_size,
-                          p_index[i],
-                          i));
-    PADDLE_ENFORCE_GE(
-        p_index[i],
-        -index_dim_size,
-        common::errors::OutOfRange(
-            "The element of Index must be greater than or equal "
-            "to %d, but received index element which is %d in the "
-            "%d index.",
-            -index_dim_size,
-            p_index[i],
-            i));
-    IndexT index_ = (p_index[i] < 0 ? p_index[i] + index_dim_size : p_index[i]);
-    memcpy(p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
-  }
+  phi::ParallelFor(
+      0,
+      index_size,
+      phi::ParallelGrainSize(slice_size),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          PADDLE_ENFORCE_LT(
+              p_index[i],
+              index_dim_size,
+              common::errors::OutOfRange(
+                  "The element of Index must be less than the size of "
+                  "input dim size of axis which is %d, but received "
+                  "index element which is %d in the %d index.",
+                  index_dim_size,
+                  p_index[i],
+                  i));
+          PADDLE_ENFORCE_GE(
+              p_index[i],
+              -index_dim_size,
+              common::errors::OutOfRange(
+                  "The element of Index must be greater than or equal "
+                  "to %d, but received index element which is %d in the "
+                  "%d index.",
+                  -index_dim_size,
+                  p_index[i],
+                  i));
+          IndexT index_ =
+              (p_index[i] < 0 ? p_index[i] + index_dim_size : p_index[i]);
+          memcpy(p_output + i * slice_size,
+                 p_src + index_ * slice_size,
+                 slice_bytes);
+        }
+      });
 }
 
 template <typename T, typename IndexT = int>
@@ -123,32 +134,40 @@ void CPUGatherNd(const phi::CPUContext& ctx UNUSED,
   }
   const size_t slice_bytes = slice_size * sizeof(T);
 
-  for (int64_t i = 0; i < remain_numel; ++i) {
-    int64_t index_ = 0;
-    int64_t temp = 1;
-    for (int64_t j = end_size - 1; j >= 0; --j) {
-      IndexT index_value = p_index[i * end_size + j];
-      PADDLE_ENFORCE_LT(
-          index_value,
-          input_dims[j],
-          common::errors::InvalidArgument(
-              "Input(index[-1)] has wrong value, it is [%d]", index_value));
-      PADDLE_ENFORCE_GE(
-          index_value,
-          -input_dims[j],
-          common::errors::InvalidArgument(
-              "The value of Input(index) must be no less than [%d]",
-              -input_dims[j]));
-      if (index_value < 0) {
-        index_value += input_dims[j];
-      }
-
-      index_ += (index_value * temp);
-      temp *= input_dims[j];
-    }
-    memcpy(
-        p_output + i * slice_size, p_input + index_ * slice_size, slice_bytes);
-  }
+  phi::ParallelFor(
+      0,
+      remain_numel,
+      phi::ParallelGrainSize(slice_size),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          int64_t index_ = 0;
+          int64_t temp = 1;
+          for (int64_t j = end_size - 1; j >= 0; --j) {
+            IndexT index_value = p_index[i * end_size + j];
+            PADDLE_ENFORCE_LT(
+                index_value,
+                input_dims[j],
+                common::errors::InvalidArgument(
+                    "Input(index[-1)] has wrong value, it is [%d]",
+                    index_value));
+            PADDLE_ENFORCE_GE(
+                index_value,
+                -input_dims[j],
+                common::errors::InvalidArgument(
+                    "The value of Input(index) must be no less than [%d]",
+                    -input_dims[j]));
+            if (index_value < 0) {
+              index_value += input_dims[j];
+            }
+
+            index_ += (index_value * temp);
+            temp *= input_dims[j];
+          }
+          memcpy(p_output + i * slice_size,
+                 p_input + index_ * slice_size,
+                 slice_bytes);
+        }
+      });
 }
 
 template <typename T, typename U>
@@ -0,0 +1,169 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
+
+#include <climits>
+#include <memory>
+
+#include "glog/logging.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/storage_properties.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The matrix of w in the GEMMs, [rows, cols] as stored.
+bool GemmMatrixOf(const DenseTensor& w,
+                  bool is_a_matrix,
+                  int64_t* rows,
+                  int64_t* cols) {
+  if (w.numel() <= 0 || w.dims().size() < 2 ||
+      (!is_a_matrix && w.dims().size() != 2)) {
+    return false;
+  }
+  *rows = w.dims()[0];
+  *cols = w.numel() / w.dims()[0];
+  return *rows <= INT_MAX && *cols <= INT_MAX;
+}
+
+}  // namespace
+
+template <typename T>
+bool PackGemmWeight(const CPUContext& dev_ctx,
+                    bool is_a_matrix,
+                    bool trans,
+                    DenseTensor* w) {
+#ifdef PADDLE_WITH_MKLML
+  int64_t rows = 0, cols = 0;
+  if (w->place().GetType() != AllocationType::CPU ||
+      w->dtype() != CppTypeToDataType<T>::Type() ||
+      !w->meta().is_contiguous() || w->storage_properties_initialized() ||
+      !GemmMatrixOf(*w, is_a_matrix, &rows, &cols)) {
+    return false;
+  }
+  // The M of the B matrix and the N of the A matrix are of the inputs, and
+  // the packed matrix serves all of them.
+  const int op_rows = static_cast<int>(trans ? cols : rows);
+  const int op_cols = static_cast<int>(trans ? rows : cols);
+  const int M = is_a_matrix ? op_rows : 1;
+  const int K = is_a_matrix ? op_cols : op_rows;
+  const int N = is_a_matrix ? 1 : op_cols;
+  const CBLAS_IDENTIFIER id = is_a_matrix ? CblasAMatrix : CblasBMatrix;
+
+  auto blas = GetBlas<CPUContext, T>(dev_ctx);
+  T* packed = blas.GEMM_ALLOC(id, M, N, K);
+  PADDLE_ENFORCE_NOT_NULL(
+      packed,
+      common::errors::ResourceExhausted(
+          "GEMM_ALLOC should not be null when packing the weight of [%s].",
+          w->dims()));
+  blas.GEMM_PACK(id,
+                 trans ? CblasTrans : CblasNoTrans,
+                 M,
+                 N,
+                 K,
+                 static_cast<T>(1),
+                 w->data<T>(),
+                 static_cast<int>(cols),
+                 packed);
+
+  auto properties = std::make_unique<CPUPackedGemmStorageProperties>();
+  properties->packed_data = std::shared_ptr<void>(
+      packed, [](void* data) { CBlas<T>::GEMM_FREE(static_cast<T*>(data)); });
+  properties->src = w->data();
+  properties->src_dims = w->dims();
+  properties->is_a_matrix = is_a_matrix;
+  properties->trans = trans;
+  w->set_storage_properties(std::move(properties));
+  VLOG(4) << "pack the weight of [" << w->dims() << "] as the "
+          << (is_a_matrix ? "A" : "B") << " matrix of the GEMMs";
+  return true;
+#else
+  return false;
+#endif
+}
+
+template <typename T>
+const T* GetPackedGemmWeight(const DenseTensor& w,
+                             bool is_a_matrix,
+                             bool trans) {
+  if (!w.initialized() ||
+      !w.storage_properties_is<CPUPackedGemmStorageProperties>()) {
+    return nullptr;
+  }
+  const auto& properties =
+      w.storage_properties<CPUPackedGemmStorageProperties>();
+  if (properties.src != w.data() || properties.src_dims != w.dims() ||
+      properties.is_a_matrix != is_a_matrix || properties.trans != trans ||
+      !w.meta().is_contiguous()) {
+    return nullptr;
+  }
+  return static_cast<const T*>(properties.packed_data.get());
+}
+
+template <typename T>
+void PackedGemm(const CPUContext& dev_ctx,
+                bool is_a_matrix,
+                int M,
+                int N,
+                int K,
+                const T* packed,
+                const T* x,
+                T* out) {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<CPUContext, T>(dev_ctx);
+  if (is_a_matrix) {
+    blas.GEMM_COMPUTE(
+        CblasPacked, CblasNoTrans, M, N, K, packed, K, x, N, T(0), out, N);
+  } else {
+    blas.GEMM_COMPUTE(
+        CblasNoTrans, CblasPacked, M, N, K, x, K, packed, N, T(0), out, N);
+  }
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "The packed GEMMs need Paddle compiled with MKL."));
+#endif
+}
+
+template bool PackGemmWeight<float>(const CPUContext&,
+                                    bool,
+                                    bool,
+                                    DenseTensor*);
+template bool PackGemmWeight<double>(const CPUContext&,
+                                     bool,
+                                     bool,
+                                     DenseTensor*);
+template const float* GetPackedGemmWeight<float>(const DenseTensor&,
+                                                 bool,
+                                                 bool);
+template const double* GetPackedGemmWeight<double>(const DenseTensor&,
+                                                   bool,
+                                                   bool);
+template void PackedGemm<float>(
+    const CPUContext&, bool, int, int, int, const float*, const float*, float*);
+template void PackedGemm<double>(const CPUContext&,
+                                 bool,
+                                 int,
+                                 int,
+                                 int,
+                                 const double*,
+                                 const double*,
+                                 double*);
+
+}  // namespace funcs
+}  // namespace phi
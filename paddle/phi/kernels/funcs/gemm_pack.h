@@ -0,0 +1,68 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <type_traits>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/utils/test_macros.h"
+
+namespace phi {
+namespace funcs {
+
+// The dtypes of the weights the BLAS library packs.
+template <typename T>
+constexpr bool IsGemmPackable() {
+  return std::is_same<T, float>::value || std::is_same<T, double>::value;
+}
+
+// Packs the constant weight w of the CPU GEMMs into the layout of the BLAS
+// library once, keeping the packed matrix in the storage properties of w.
+// w is packed as the A matrix of out = op(w) * x, e.g. the filter of conv2d
+// viewed as [dims[0], numel / dims[0]], or as the B matrix of
+// out = x * op(w), e.g. the 2-D weight of fc and matmul, with op transposing
+// w if trans. The data of w must never change afterwards.
+//
+// Returns false if the BLAS library does not pack the matrices, e.g. it is
+// not MKL, or w is not of a GEMM or is packed otherwise already.
+template <typename T>
+TEST_API bool PackGemmWeight(const CPUContext& dev_ctx,
+                             bool is_a_matrix,
+                             bool trans,
+                             DenseTensor* w);
+
+// The matrix packed by PackGemmWeight of w the same way, or nullptr, e.g.
+// for the views of w in other shapes sharing its storage properties.
+template <typename T>
+TEST_API const T* GetPackedGemmWeight(const DenseTensor& w,
+                                      bool is_a_matrix,
+                                      bool trans);
+
+// Computes out[M, N] = op(w) * x[K, N] with packed, the matrix packed of w
+// as the A matrix, or out[M, N] = x[M, K] * op(w) with w packed as the B
+// matrix.
+template <typename T>
+TEST_API void PackedGemm(const CPUContext& dev_ctx,
+                         bool is_a_matrix,
+                         int M,
+                         int N,
+                         int K,
+                         const T* packed,
+                         const T* x,
+                         T* out);
+
+}  // namespace funcs
+}  // namespace phi
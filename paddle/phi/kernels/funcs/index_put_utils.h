@@ -182,6 +182,19 @@ static phi::DDim BroadCastTensorsDims(
   return common::make_ddim(target_dims);
 }
 
+// The accumulating index_put sorts the offsets of the values and reduces the
+// values of each element at once, instead of adding them one by one, when
+// they are many and expected to land on the same elements often: at least
+// kSortedIndexPutMinValues values, one for every
+// kSortedIndexPutMaxElementsPerValue elements of x or more.
+constexpr int64_t kSortedIndexPutMinValues = 4096;
+constexpr int64_t kSortedIndexPutMaxElementsPerValue = 4;
+
+inline bool UseSortedIndexPut(int64_t num_values, int64_t numel) {
+  return num_values >= kSortedIndexPutMinValues &&
+         num_values * kSortedIndexPutMaxElementsPerValue >= numel;
+}
+
 template <typename T, typename Context>
 T** GetDevicePointerArray(const Context& ctx,
                           const std::vector<const DenseTensor*>& indices_v,
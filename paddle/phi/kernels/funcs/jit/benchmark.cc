@@ -18,6 +18,7 @@
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 #include "paddle/phi/api/profiler/device_tracer.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/enforce.h"
@@ -115,7 +116,16 @@ void BenchAllImpls(const typename KernelTuple::attr_type& attr, Args... args) {
   auto funcs = jit::GetAllCandidateFuncsWithTypes<KernelTuple, PlaceType>(attr);
   infos.reserve(funcs.size());
   for (auto const& f : funcs) {
-    infos.push_back(std::make_pair(f.first, benchmark(f.second, args...)));
+    std::string name = f.first;
+    if (name == "JitCode") {
+      // tell the generated code of different ISAs apart
+      auto gen = dynamic_cast<const jit::GenBase*>(
+          jit::GetJitCode<KernelTuple, PlaceType>(attr));
+      if (gen) {
+        name = gen->name();
+      }
+    }
+    infos.push_back(std::make_pair(name, benchmark(f.second, args...)));
   }
 
   // Test result from Get function
@@ -551,6 +561,10 @@ int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
             << " times.";
+  LOG(INFO) << "AVX512F is "
+            << (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)
+                    ? "used."
+                    : "not supported.");
 
   RUN_ALL_BENCHMARK();
 }
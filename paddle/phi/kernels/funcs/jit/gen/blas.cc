@@ -24,34 +24,33 @@ void VXXJitCode::genCode() {
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
   if (with_relu_) {
+    // the vex encoded xor clears the whole zmm as well
     vxorps(ymm_zero, ymm_zero, ymm_zero);
   }
   if (scalar_index_ == 1) {
-    vbroadcastss(ymm_src1, ptr[param1]);
-  } else if (scalar_index_ == 2) {
-    vbroadcastss(ymm_src2, ptr[param2]);
-  }
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
-    if (scalar_index_ != 1) {
-      vmovups(ymm_src1, ptr[param1 + offset]);
-    }
-    if (scalar_index_ != 2) {
-      vmovups(ymm_src2, ptr[param2 + offset]);
+    if (use_avx512_) {
+      vbroadcastss(zmm_src1, ptr[param1]);
+    } else {
+      vbroadcastss(ymm_src1, ptr[param1]);
     }
-    if (type_ == operand_type::MUL) {
-      vmulps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::ADD) {
-      vaddps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::SUB) {
-      vsubps(ymm_dst, ymm_src1, ymm_src2);
+  } else if (scalar_index_ == 2) {
+    if (use_avx512_) {
+      vbroadcastss(zmm_src2, ptr[param2]);
+    } else {
+      vbroadcastss(ymm_src2, ptr[param2]);
     }
-    if (with_relu_) {
-      vmaxps(ymm_dst, ymm_zero, ymm_dst);
+  }
+  int rest = num_;
+  if (use_avx512_) {
+    for (; rest >= ZMM_FLOAT_BLOCK; rest -= ZMM_FLOAT_BLOCK) {
+      compute_block<zmm_t>(offset);
+      offset += sizeof(float) * ZMM_FLOAT_BLOCK;
     }
-    vmovups(ptr[param3 + offset], ymm_dst);
+  }
+  for (; rest >= YMM_FLOAT_BLOCK; rest -= YMM_FLOAT_BLOCK) {
+    compute_block<ymm_t>(offset);
     offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
-  int rest = num_ % YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
@@ -37,7 +37,9 @@ class VXXJitCode : public JitCode {
         num_(d),
         type_(type),
         scalar_index_(scalar_index),
-        with_relu_(with_relu) {
+        with_relu_(with_relu),
+        use_avx512_(
+            phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
     if (!(type_ == operand_type::MUL || type_ == operand_type::ADD ||
           type_ == operand_type::SUB)) {
       PADDLE_THROW(common::errors::Unimplemented(
@@ -66,16 +68,44 @@ class VXXJitCode : public JitCode {
       base += "_Vec";
     }
     base += (with_relu_ ? "_Relu" : "");
+    base += (use_avx512_ ? "_AVX512" : "");
     base += "_D" + std::to_string(num_);
     return base;
   }
   void genCode() override;
 
  private:
+  // compute one block of JMM at offset, the scalar is broadcasted already
+  template <typename JMM>
+  void compute_block(int offset) {
+    JMM jmm_src1 = JMM(0);
+    JMM jmm_src2 = JMM(1);
+    JMM jmm_dst = JMM(2);
+    JMM jmm_zero = JMM(3);
+    if (scalar_index_ != 1) {
+      vmovups(jmm_src1, ptr[param1 + offset]);
+    }
+    if (scalar_index_ != 2) {
+      vmovups(jmm_src2, ptr[param2 + offset]);
+    }
+    if (type_ == operand_type::MUL) {
+      vmulps(jmm_dst, jmm_src1, jmm_src2);
+    } else if (type_ == operand_type::ADD) {
+      vaddps(jmm_dst, jmm_src1, jmm_src2);
+    } else if (type_ == operand_type::SUB) {
+      vsubps(jmm_dst, jmm_src1, jmm_src2);
+    }
+    if (with_relu_) {
+      vmaxps(jmm_dst, jmm_zero, jmm_dst);
+    }
+    vmovups(ptr[param3 + offset], jmm_dst);
+  }
+
   int num_;
   operand_type type_;
   int scalar_index_;
   bool with_relu_;
+  bool use_avx512_;
   reg64_t param1{abi_param1};
   reg64_t param2{abi_param2};
   reg64_t param3{abi_param3};
@@ -89,6 +119,9 @@ class VXXJitCode : public JitCode {
   ymm_t ymm_src2 = ymm_t(1);
   ymm_t ymm_dst = ymm_t(2);
   ymm_t ymm_zero = ymm_t(3);
+
+  zmm_t zmm_src1 = zmm_t(0);
+  zmm_t zmm_src2 = zmm_t(1);
 };
 
 #define DECLARE_BLAS_JITCODE(name, op_type, scalar_idx, with_relu)             \
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 
 #include "glog/logging.h"
@@ -31,7 +32,9 @@ class EmbSeqPoolJitCode : public JitCode {
                              void* code_ptr = nullptr)
       : JitCode(code_size, code_ptr),
         tbl_w_(attr.table_width),
-        type_(attr.pool_type) {
+        type_(attr.pool_type),
+        use_avx512_(
+            phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
     if (type_ != SeqPoolType::kSum) {
       PADDLE_THROW(
           common::errors::Unimplemented("Only supports sum pool yet."));
@@ -48,14 +51,101 @@ class EmbSeqPoolJitCode : public JitCode {
     } else if (type_ == SeqPoolType::kSqrt) {
       base += "_Sqrt";
     }
+    base += (use_avx512_ ? "_AVX512" : "");
     base += ("_W" + std::to_string(tbl_w_));
     return base;
   }
   void genCode() override;
 
  private:
+  // pool the blocks in the rest width of table, max_num_regs blocks a time, and
+  // return the width offset in byte after them
+  template <typename JMM>
+  size_t pool_width(size_t w_offset, int block, int max_num_regs, int* rest) {
+    const int num_block = *rest / block;
+    for (int i = 0; i < num_block; i += max_num_regs) {
+      const int num_regs = std::min(max_num_regs, num_block - i);
+      pool_group<JMM>(w_offset, block, num_regs);
+      w_offset += num_regs * block * sizeof(float);
+    }
+    *rest -= num_block * block;
+    return w_offset;
+  }
+
+  // pool num_regs blocks of all the indices, from w_offset of the table rows
+  template <typename JMM>
+  void pool_group(size_t w_offset, int block, int num_regs) {
+    const size_t block_size = sizeof(float) * block;
+    const size_t tbl_width_in_byte = sizeof(float) * tbl_w_;
+    Label l_next_idx_w, l_next_idx_h, l_save_now;
+    xor_(reg_idx_w_i_in_byte, reg_idx_w_i_in_byte);
+    mov(reg_ptr_dst_i, reg_ptr_param_dst);
+    add(reg_ptr_dst_i, w_offset);
+
+    L(l_next_idx_w);
+    {
+      // h == 0
+      mov(reg_ptr_idx_i, param_idx);
+      add(reg_ptr_idx_i, reg_idx_w_i_in_byte);
+      mov(reg_idx, qword[reg_ptr_idx_i]);
+      mov(rax, tbl_width_in_byte);
+      mul(reg_idx);
+      mov(reg_ptr_tbl_i, rax);        // reg is offset now
+      add(reg_ptr_tbl_i, param_tbl);  // reg is ptr_i now
+      size_t offset = 0;
+      for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+        vmovups(JMM(reg_i + num_regs), ptr[reg_ptr_tbl_i + offset]);
+        offset += block_size;
+      }
+      add(reg_ptr_idx_i, reg_idx_width_in_byte);
+
+      // end condition of idx h
+      mov(reg_idx_h_end, reg_idx_height);
+      mov(rax, reg_idx_width_in_byte);
+      mul(reg_idx_h_end);
+      mov(reg_idx_h_end, rax);
+      add(reg_idx_h_end, reg_idx_w_i_in_byte);
+      add(reg_idx_h_end, param_idx);
+
+      cmp(reg_ptr_idx_i, reg_idx_h_end);
+      jge(l_save_now, T_NEAR);
+      L(l_next_idx_h);
+      {
+        mov(reg_idx, qword[reg_ptr_idx_i]);
+        mov(reg_ptr_tbl_i, reg_idx);
+        mov(rax, tbl_width_in_byte);
+        mul(reg_idx);
+        mov(reg_ptr_tbl_i, rax);
+        add(reg_ptr_tbl_i, param_tbl);
+        size_t offset = 0;
+        for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+          vmovups(JMM(reg_i), ptr[reg_ptr_tbl_i + offset]);
+          vaddps(JMM(reg_i + num_regs), JMM(reg_i + num_regs), JMM(reg_i));
+          offset += block_size;
+        }
+        add(reg_ptr_idx_i, reg_idx_width_in_byte);
+        cmp(reg_ptr_idx_i, reg_idx_h_end);
+        jl(l_next_idx_h, T_NEAR);
+      }  // end of idx h
+      L(l_save_now);
+      // avg or sqrt here, if needed
+      offset = 0;
+      for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+        vmovups(ptr[reg_ptr_dst_i + offset], JMM(reg_i + num_regs));
+        offset += block_size;
+      }
+      add(reg_ptr_dst_i, tbl_width_in_byte);
+      add(reg_idx_w_i_in_byte, sizeof(int64_t));
+      cmp(reg_idx_w_i_in_byte, reg_idx_width_in_byte);
+      jl(l_next_idx_w, T_NEAR);
+    }  // end of idx w
+
+    add(param_tbl, num_regs * block_size);
+  }
+
   int tbl_w_;
   SeqPoolType type_;
+  bool use_avx512_;
   reg64_t param_tbl{abi_param1};
   reg64_t param_idx{abi_param2};
   reg64_t param_dst{abi_param3};
@@ -16,16 +16,12 @@
 
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/kernels/funcs/jit/gen/act.h"  // for exp_float_consts ones
+#include "paddle/phi/kernels/funcs/jit/macro.h"
 #include "paddle/phi/kernels/funcs/jit/registry.h"
 
 namespace phi::jit::gen {
 
 void SeqPoolJitCode::genCode() {
-  constexpr int block = YMM_FLOAT_BLOCK;
-  constexpr int max_num_regs = 8;
-  const int num_block = w_ / block;
-  const int num_groups = num_block / max_num_regs;
-  int rest_num_regs = num_block % max_num_regs;
   mov(reg32_int_h, dword[param_attr]);
   if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
     mov(reg_tmp, reinterpret_cast<size_t>(exp_float_consts));
@@ -40,17 +36,15 @@ void SeqPoolJitCode::genCode() {
     vdivps(xmm_t(1), xmm_t(1), xmm_t(0));
     vmovss(ptr[reg_tmp], xmm_t(1));
   }
-  const int group_len = max_num_regs * block * sizeof(float);
-  for (int g = 0; g < num_groups; ++g) {
-    pool_height<ymm_t>(g * group_len, block, max_num_regs);
-  }
-  if (rest_num_regs > 0) {
-    pool_height<ymm_t>(num_groups * group_len, block, rest_num_regs);
+  int w_offset = 0;
+  int rest = w_;
+  if (use_avx512_) {
+    // 16 zmm to accumulate and 16 zmm to load
+    w_offset = pool_width<zmm_t>(w_offset, ZMM_FLOAT_BLOCK, 16, &rest);
   }
+  w_offset = pool_width<ymm_t>(w_offset, YMM_FLOAT_BLOCK, 8, &rest);
   // part of rest_w * height
-  const int rest = w_ % block;
-  pool_height_of_rest_width(
-      rest, static_cast<int>((w_ - rest) * sizeof(float)), max_num_regs);
+  pool_height_of_rest_width(rest, w_offset, 8);
   ret();
 }
 
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 
 #include "glog/logging.h"
@@ -29,7 +30,11 @@ class SeqPoolJitCode : public JitCode {
   explicit SeqPoolJitCode(const seq_pool_attr_t& attr,
                           size_t code_size = 256 * 1024,
                           void* code_ptr = nullptr)
-      : JitCode(code_size, code_ptr), w_(attr.w), type_(attr.type) {
+      : JitCode(code_size, code_ptr),
+        w_(attr.w),
+        type_(attr.type),
+        use_avx512_(
+            phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
     if (!(type_ == SeqPoolType::kSum || type_ == SeqPoolType::kAvg ||
           type_ == SeqPoolType::kSqrt)) {
       PADDLE_THROW(common::errors::Unimplemented(
@@ -48,12 +53,27 @@ class SeqPoolJitCode : public JitCode {
     } else if (type_ == SeqPoolType::kSqrt) {
       base += "_Sqrt";
     }
+    base += (use_avx512_ ? "_AVX512" : "");
     base += ("_W" + std::to_string(w_));
     return base;
   }
   void genCode() override;
 
  protected:
+  // pool the blocks in the rest width, max_num_regs blocks a time, and
+  // return the width offset after them
+  template <typename JMM>
+  int pool_width(int w_offset, int block, int max_num_regs, int* rest) {
+    const int num_block = *rest / block;
+    for (int i = 0; i < num_block; i += max_num_regs) {
+      const int num_regs = std::min(max_num_regs, num_block - i);
+      pool_height<JMM>(w_offset, block, num_regs);
+      w_offset += static_cast<int>(num_regs * block * sizeof(float));
+    }
+    *rest -= num_block * block;
+    return w_offset;
+  }
+
   template <typename JMM>
   void pool_height(int w_offset, int block, int max_num_regs) {
     int offset = w_offset;
@@ -206,6 +226,7 @@ class SeqPoolJitCode : public JitCode {
   float ALIGN32_BEG fp_h_[1] ALIGN32_END;
   int w_;
   SeqPoolType type_;
+  bool use_avx512_;
   reg64_t param_src{abi_param1};
   reg64_t param_dst{abi_param2};
   reg64_t param_attr{abi_param3};
@@ -190,4 +190,12 @@ bool LayerNormKernel::CanBeUsed(const int& d) const {
 
 namespace intrinsic = phi::jit::more::intrinsic;
 
+#ifdef PADDLE_WITH_AVX512F
+// the avx512 one goes first to be preferred when the cpu supports it
+REGISTER_JITKERNEL_MORE(kLayerNorm,
+                        intrinsic,
+                        intrinsic::LayerNormAVX512Kernel,
+                        intrinsic::LayerNormKernel);
+#else
 REGISTER_JITKERNEL_MORE(kLayerNorm, intrinsic, intrinsic::LayerNormKernel);
+#endif
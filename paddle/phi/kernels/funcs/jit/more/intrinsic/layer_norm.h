@@ -41,6 +41,26 @@ class LayerNormKernel : public KernelMore<LayerNormTuple<float>> {
   const char* ImplType() const override { return "Intrinsic"; }
 };
 
+#ifdef PADDLE_WITH_AVX512F
+void LayerNormAVX512(float* x,
+                     float* out,
+                     float* mean,
+                     float* var,
+                     const float* scale,
+                     const float* bias,
+                     int height,
+                     const float epsilon,
+                     int right);
+
+class LayerNormAVX512Kernel : public KernelMore<LayerNormTuple<float>> {
+ public:
+  LayerNormAVX512Kernel() { this->func = LayerNormAVX512; }
+  bool CanBeUsed(
+      const typename LayerNormTuple<float>::attr_type&) const override;
+  const char* ImplType() const override { return "IntrinsicAVX512"; }
+};
+#endif
+
 }  // namespace intrinsic
 }  // namespace more
 }  // namespace jit
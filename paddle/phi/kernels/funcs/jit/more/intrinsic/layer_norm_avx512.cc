@@ -0,0 +1,107 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/jit/more/intrinsic/layer_norm.h"
+
+#ifdef PADDLE_WITH_AVX512F
+#include <immintrin.h>
+
+#include <cmath>
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+
+namespace phi {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+// This file is built with the avx512f flag, so it should only be called after
+// the cpu is checked to support avx512f.
+void LayerNormAVX512(float* x,
+                     float* out,
+                     float* mean,
+                     float* var,
+                     const float* scale,
+                     const float* bias,
+                     int height,
+                     const float epsilon,
+                     int right) {
+  constexpr int block = ZMM_FLOAT_BLOCK;
+  const int rest = right % block;
+  const int end = right - rest;
+  // the tail of a row is loaded and saved by mask
+  const __mmask16 rest_mask = static_cast<__mmask16>((1U << rest) - 1);
+  const float reverse_num = 1.f / static_cast<float>(right);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < height; ++i) {
+    const float* x_i = x + static_cast<size_t>(i) * right;
+    float* out_i = out + static_cast<size_t>(i) * right;
+
+    /* get mean */
+    __m512 sum = _mm512_setzero_ps();
+    for (int j = 0; j < end; j += block) {
+      sum = _mm512_add_ps(sum, _mm512_loadu_ps(x_i + j));
+    }
+    if (rest != 0) {
+      sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(rest_mask, x_i + end));
+    }
+    const float mean_i = _mm512_reduce_add_ps(sum) * reverse_num;
+    const __m512 mean_vec = _mm512_set1_ps(mean_i);
+
+    /* get variance */
+    sum = _mm512_setzero_ps();
+    for (int j = 0; j < end; j += block) {
+      __m512 tmp = _mm512_sub_ps(_mm512_loadu_ps(x_i + j), mean_vec);
+      sum = _mm512_add_ps(sum, _mm512_mul_ps(tmp, tmp));
+    }
+    if (rest != 0) {
+      __m512 tmp = _mm512_maskz_sub_ps(
+          rest_mask, _mm512_maskz_loadu_ps(rest_mask, x_i + end), mean_vec);
+      sum = _mm512_add_ps(sum, _mm512_mul_ps(tmp, tmp));
+    }
+    const float var_i = _mm512_reduce_add_ps(sum) * reverse_num;
+    mean[i] = mean_i;
+    var[i] = var_i;
+
+    /* get x_norm and calculate output, with scale and bias in the same pass */
+    const __m512 sqrt_var_vec = _mm512_set1_ps(std::sqrt(var_i + epsilon));
+    for (int j = 0; j < right; j += block) {
+      const __mmask16 mask =
+          j < end ? static_cast<__mmask16>(0xffff) : rest_mask;
+      __m512 tmp = _mm512_div_ps(
+          _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x_i + j), mean_vec),
+          sqrt_var_vec);
+      if (scale) {
+        tmp = _mm512_mul_ps(tmp, _mm512_maskz_loadu_ps(mask, scale + j));
+      }
+      if (bias) {
+        tmp = _mm512_add_ps(tmp, _mm512_maskz_loadu_ps(mask, bias + j));
+      }
+      _mm512_mask_storeu_ps(out_i + j, mask, tmp);
+    }
+  }
+}
+
+bool LayerNormAVX512Kernel::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+         d >= ZMM_FLOAT_BLOCK;
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace phi
+#endif
@@ -0,0 +1,222 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/nan_inf_recorder.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/memory_utils.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// A record is the sequence number of a check and the index of the name of
+// the tensor, so the min of the records is the first check.
+constexpr int kNameBits = 20;
+constexpr uint32_t kMaxNames = (1u << kNameBits) - 1;
+constexpr int kNumRecords = 1024;
+constexpr unsigned long long kNoRecord = ~0ULL;  // NOLINT
+constexpr int kThreads = 256;
+constexpr int kMaxBlocks = 128;
+
+struct DeviceRecords {
+  unsigned long long first;              // NOLINT
+  unsigned long long ring[kNumRecords];  // NOLINT
+};
+
+template <typename T>
+__global__ void RecordNanInfKernel(const T* value_ptr,
+                                   const int64_t numel,
+                                   const unsigned long long record,  // NOLINT
+                                   DeviceRecords* records) {
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  bool found = false;
+  for (int64_t i = threadIdx.x + static_cast<int64_t>(blockIdx.x) * blockDim.x;
+       i < numel;
+       i += static_cast<int64_t>(blockDim.x) * gridDim.x) {
+    MT value = static_cast<MT>(value_ptr[i]);
+    found = found || isnan(value) || isinf(value);
+  }
+  // the same record by all the blocks finding one
+  if (__syncthreads_or(found) && threadIdx.x == 0) {
+    atomicMin(&records->first, record);
+    records->ring[(record >> kNameBits) % kNumRecords] = record;
+  }
+}
+
+class NanInfRecorder {
+ public:
+  static NanInfRecorder& Instance() {
+    static NanInfRecorder recorder;
+    return recorder;
+  }
+
+  void Record(const phi::GPUContext& ctx,
+              const DenseTensor& tensor,
+              const std::string& op_type,
+              const std::string& var_name) {
+    if (tensor.numel() <= 0) return;
+    unsigned long long record = 0;  // NOLINT
+    DeviceRecords* records = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      record = (seq_++ << kNameBits) | NameIndex(op_type, var_name);
+      records = GetDeviceRecords(ctx);
+    }
+    int64_t blocks = std::min<int64_t>(
+        kMaxBlocks, (tensor.numel() + kThreads - 1) / kThreads);
+    switch (tensor.dtype()) {
+      case DataType::FLOAT32:
+        Launch<float>(ctx, tensor, blocks, record, records);
+        break;
+      case DataType::FLOAT64:
+        Launch<double>(ctx, tensor, blocks, record, records);
+        break;
+      case DataType::FLOAT16:
+        Launch<phi::dtype::float16>(ctx, tensor, blocks, record, records);
+        break;
+      case DataType::BFLOAT16:
+        Launch<phi::dtype::bfloat16>(ctx, tensor, blocks, record, records);
+        break;
+      default:
+        VLOG(10) << var_name << " is not checked for its dtype "
+                 << tensor.dtype();
+        break;
+    }
+  }
+
+  std::string Check() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::vector<unsigned long long> found;  // NOLINT
+    unsigned long long first = kNoRecord;   // NOLINT
+    DeviceRecords host_records;
+    for (auto& item : device_records_) {
+      phi::backends::gpu::GPUDeviceGuard device_guard(item.first);
+      // the records are written on any stream of the device
+      phi::backends::gpu::GpuDeviceSync();
+      auto* records = reinterpret_cast<DeviceRecords*>(item.second->ptr());
+      phi::backends::gpu::GpuMemcpySync(&host_records,
+                                        records,
+                                        sizeof(DeviceRecords),
+                                        phi::gpuMemcpyDeviceToHost);
+      ClearRecords(records);
+      if (host_records.first == kNoRecord) continue;
+      first = std::min(first, host_records.first);
+      for (auto record : host_records.ring) {
+        if (record != kNoRecord) found.push_back(record);
+      }
+    }
+    if (first == kNoRecord) return "";
+
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    std::ostringstream report;
+    report << "The first tensor holding NaN or Inf since the last check is "
+           << Describe(first) << ".";
+    if (found.size() > 1) {
+      report << " The recorded tensors holding NaN or Inf are:";
+      for (auto record : found) {
+        report << "\n  " << Describe(record);
+      }
+    }
+    return report.str();
+  }
+
+ private:
+  NanInfRecorder() = default;
+
+  template <typename T>
+  void Launch(const phi::GPUContext& ctx,
+              const DenseTensor& tensor,
+              int64_t blocks,
+              unsigned long long record,  // NOLINT
+              DeviceRecords* records) {
+    RecordNanInfKernel<T><<<blocks, kThreads, 0, ctx.stream()>>>(
+        tensor.data<T>(), tensor.numel(), record, records);
+  }
+
+  // the names more than kMaxNames share the last index
+  uint32_t NameIndex(const std::string& op_type, const std::string& var_name) {
+    std::string name = "op=" + op_type + ", tensor=" + var_name;
+    auto it = name_indices_.find(name);
+    if (it != name_indices_.end()) return it->second;
+    if (names_.size() >= kMaxNames) return kMaxNames;
+    name_indices_.emplace(name, names_.size());
+    names_.push_back(name);
+    return names_.size() - 1;
+  }
+
+  std::string Describe(unsigned long long record) {  // NOLINT
+    uint32_t index = record & kMaxNames;
+    std::ostringstream desc;
+    desc << "[" << (index < names_.size() ? names_[index] : "unknown")
+         << ", check " << (record >> kNameBits) << "]";
+    return desc.str();
+  }
+
+  void ClearRecords(DeviceRecords* records) {
+    std::vector<unsigned long long> init(  // NOLINT
+        sizeof(DeviceRecords) / sizeof(unsigned long long),  // NOLINT
+        kNoRecord);
+    phi::backends::gpu::GpuMemcpySync(records,
+                                      init.data(),
+                                      sizeof(DeviceRecords),
+                                      phi::gpuMemcpyHostToDevice);
+  }
+
+  DeviceRecords* GetDeviceRecords(const phi::GPUContext& ctx) {
+    int dev_id = ctx.GetPlace().GetDeviceId();
+    auto it = device_records_.find(dev_id);
+    if (it == device_records_.end()) {
+      auto allocation =
+          phi::memory_utils::Alloc(ctx.GetPlace(), sizeof(DeviceRecords));
+      ClearRecords(reinterpret_cast<DeviceRecords*>(allocation->ptr()));
+      it = device_records_.emplace(dev_id, std::move(allocation)).first;
+    }
+    return reinterpret_cast<DeviceRecords*>(it->second->ptr());
+  }
+
+  std::mutex mutex_;
+  unsigned long long seq_{0};  // NOLINT
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_indices_;
+  std::map<int, phi::Allocator::AllocationPtr> device_records_;
+};
+
+}  // namespace
+
+void RecordNanInf(const phi::GPUContext& ctx,
+                  const DenseTensor& tensor,
+                  const std::string& op_type,
+                  const std::string& var_name) {
+  NanInfRecorder::Instance().Record(ctx, tensor, op_type, var_name);
+}
+
+std::string CheckNanInfRecords() { return NanInfRecorder::Instance().Check(); }
+
+}  // namespace funcs
+}  // namespace phi
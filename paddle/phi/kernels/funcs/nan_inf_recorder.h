@@ -0,0 +1,42 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include <string>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#endif
+
+namespace phi {
+namespace funcs {
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// Records on the device of tensor whether it holds NaN or Inf, with no
+// sync of the device. The records are kept in a ring on each device, with
+// the first checked tensor holding NaN or Inf since the last check.
+void RecordNanInf(const phi::GPUContext& ctx,
+                  const DenseTensor& tensor,
+                  const std::string& op_type,
+                  const std::string& var_name);
+
+// Waits for the devices with records, clears the records and returns the
+// report of the tensors holding NaN or Inf, empty if there is none.
+std::string CheckNanInfRecords();
+#endif
+
+}  // namespace funcs
+}  // namespace phi
@@ -61,9 +61,11 @@ using dim3 = phi::kps::dim3;
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_utils.h"
+#include "paddle/phi/core/parallel_for.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/reduce_functor.h"
 namespace phi {
 namespace funcs {
 
@@ -1348,6 +1350,63 @@ void HandleLargeDim(const Context& dev_ctx,
   output->ResizeAndAllocate(output_dim);
 }
 
+////////////// RowwiseReduce
+
+// The functors reducing each row of a matrix independently of the others.
+template <typename Functor>
+struct IsRowwiseReduceFunctor
+    : std::integral_constant<bool,
+                             std::is_same<Functor, SumFunctor>::value ||
+                                 std::is_same<Functor, MeanFunctor>::value ||
+                                 std::is_same<Functor, MaxFunctor>::value ||
+                                 std::is_same<Functor, MinFunctor>::value ||
+                                 std::is_same<Functor, ProdFunctor>::value ||
+                                 std::is_same<Functor, AllFunctor>::value ||
+                                 std::is_same<Functor, AnyFunctor>::value> {};
+
+// The number of rows of the matrix whose rows are reduced if dims are the last
+// dims of input, otherwise 0.
+inline int64_t ReduceRowsOfTrailingDims(const DDim& input_dims,
+                                        const std::vector<int64_t>& dims) {
+  int ndim = input_dims.size();
+  std::set<int64_t> dims_set;
+  for (auto dim : dims) {
+    dims_set.insert(dim < 0 ? dim + ndim : dim);
+  }
+  if (dims_set.empty() || dims_set.size() != dims.size() ||
+      *dims_set.rbegin() != ndim - 1 ||
+      *dims_set.begin() != ndim - static_cast<int64_t>(dims_set.size())) {
+    return 0;
+  }
+  int64_t rows = 1;
+  for (int i = 0; i < *dims_set.begin(); ++i) {
+    rows *= input_dims[i];
+  }
+  return rows;
+}
+
+// Reduces the rows of the matrix in parallel.
+template <typename OutT, typename Functor>
+void RowwiseReduce(const phi::CPUContext& dev_ctx,
+                   const phi::DenseTensor& input,
+                   phi::DenseTensor* output,
+                   int64_t rows) {
+  int64_t cols = input.numel() / rows;
+  const OutT* x_data = input.data<OutT>();
+  OutT* out_data = output->data<OutT>();
+  auto& dev = *dev_ctx.eigen_device();
+  phi::ParallelFor(
+      0, rows, phi::ParallelGrainSize(cols), [&](int64_t begin, int64_t end) {
+        auto x = typename EigenTensor<OutT, 2>::ConstType(
+            x_data + begin * cols, end - begin, cols);
+        auto out =
+            typename EigenTensor<OutT, 1>::Type(out_data + begin, end - begin);
+        auto reduce_dim = Eigen::array<int, 1>({{1}});
+        Functor functor;
+        functor(dev, &x, &out, reduce_dim);
+      });
+}
+
 ////////////// ReduceKernel
 
 template <typename Context, typename T, typename OutT, typename Functor>
@@ -1374,6 +1433,14 @@ void ReduceKernelImpl(const Context& dev_ctx,
     Functor functor;
     functor(dev, &x, &out, reduce_dim);
   } else {
+    if constexpr (std::is_same<Context, phi::CPUContext>::value &&
+                  IsRowwiseReduceFunctor<Functor>::value) {
+      int64_t rows = ReduceRowsOfTrailingDims(input.dims(), dims);
+      if (rows > 1) {
+        RowwiseReduce<OutT, Functor>(dev_ctx, input, output, rows);
+        return;
+      }
+    }
     int ndim = input.dims().size();
     int rdim = dims.size();
     if (ndim > 6) {
@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/common/ddim.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/parallel_for.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 
@@ -127,36 +128,48 @@ void ScatterAssign(const phi::CPUContext& ctx UNUSED,
     for (int i = 0; i < src_dims.size(); ++i) slice_size *= src_dims[i];
   }
 
-  const size_t slice_bytes = slice_size * sizeof(T);
-
-  for (int64_t i = 0; i < index_size; ++i) {
-    IndexT index_ = p_index[i];
-    PADDLE_ENFORCE_GE(index_,
-                      -dst_dims[0],
-                      common::errors::OutOfRange(
-                          "The index is out of bounds, "
-                          "please check whether the dimensions of index and "
-                          "input meet the requirements. It should "
-                          "be greater than or equal to [%d], but received [%d]",
-                          -dst_dims[0],
-                          index_));
-
-    PADDLE_ENFORCE_LT(
-        index_,
-        dst_dims[0],
-        common::errors::OutOfRange(
-            "The index is out of bounds, "
-            "please check whether the values of index and "
-            "dimensions of input meet the requirements. each index should "
-            "be less than 1st-dim size (%d) of input, but received [%d]",
-            dst_dims[0],
-            index_));
-    if (index_ < 0) {
-      index_ += dst_dims[0];
-    }
-
-    memcpy(p_output + index_ * slice_size, p_src + i * slice_size, slice_bytes);
-  }
+  // The columns of the slices are split among the threads, each of which
+  // copies its columns of all the indices in order, so that the last of the
+  // duplicated indices still wins.
+  phi::ParallelFor(
+      0,
+      static_cast<int64_t>(slice_size),
+      phi::ParallelGrainSize(index_size),
+      [&](int64_t begin, int64_t end) {
+        const size_t bytes = (end - begin) * sizeof(T);
+        for (int64_t i = 0; i < index_size; ++i) {
+          IndexT index_ = p_index[i];
+          PADDLE_ENFORCE_GE(
+              index_,
+              -dst_dims[0],
+              common::errors::OutOfRange(
+                  "The index is out of bounds, "
+                  "please check whether the dimensions of index and "
+                  "input meet the requirements. It should "
+                  "be greater than or equal to [%d], but received [%d]",
+                  -dst_dims[0],
+                  index_));
+
+          PADDLE_ENFORCE_LT(
+              index_,
+              dst_dims[0],
+              common::errors::OutOfRange(
+                  "The index is out of bounds, "
+                  "please check whether the values of index and "
+                  "dimensions of input meet the requirements. each index "
+                  "should be less than 1st-dim size (%d) of input, but "
+                  "received [%d]",
+                  dst_dims[0],
+                  index_));
+          if (index_ < 0) {
+            index_ += dst_dims[0];
+          }
+
+          memcpy(p_output + index_ * slice_size + begin,
+                 p_src + i * slice_size + begin,
+                 bytes);
+        }
+      });
 }
 
 template <typename T, typename IndexT = int>
@@ -26,10 +26,6 @@ limitations under the License. */
 #include "paddle/phi/backends/xpu/enforce_xpu.h"
 #endif
 
-#ifdef PADDLE_WITH_DNNL
-#include "paddle/phi/backends/onednn/axpy_handler.h"
-#endif
-
 #include "glog/logging.h"
 
 namespace phi {
@@ -415,86 +411,115 @@ template struct SelectedRowsAddToTensor<phi::XPUContext, float>;
 // add or mul.
 namespace scatter {
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<!std::is_integral<T>::value>::type elementwise_add_to(
-    phi::funcs::BlasT<DeviceContext, T>* blas,
-    size_t data_len,
-    const T* in,
-    T* out) {
-  blas->AXPY(data_len, T(1.f), in, out);
-}
-
-template <typename T, typename DeviceContext>
-typename std::enable_if<std::is_integral<T>::value>::type elementwise_add_to(
-    phi::funcs::BlasT<DeviceContext, T>* blas UNUSED,
-    size_t data_len,
-    const T* in,
-    T* out) {
-  for (size_t i = 0; i < data_len; i++) {
-    out[i] += in[i];
+void SegmentRows(const std::vector<const phi::SelectedRows*>& inputs,
+                 RowSegments* segments) {
+  constexpr int kDigitBits = 8;
+  constexpr int kBuckets = 1 << kDigitBits;
+  constexpr int kDigits = 64 / kDigitBits;
+  size_t row_num = 0;
+  for (auto* input : inputs) {
+    row_num += input->rows().size();
+  }
+  segments->rows.clear();
+  segments->offsets.assign(1, 0);
+  if (row_num == 0) {
+    segments->positions.clear();
+    return;
   }
-}
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
-                  int64_t input_width,
-                  const DeviceContext& context,
-                  T* out_data) {
-#ifndef PADDLE_WITH_DNNL
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
-#endif
+  // the sign bit is flipped so that the negative rows are ordered first
+  std::vector<uint64_t> keys;
+  keys.reserve(row_num);
   for (auto* input : inputs) {
-    if (input->rows().empty()) {
+    for (int64_t row : input->rows()) {
+      keys.push_back(static_cast<uint64_t>(row) ^ (uint64_t{1} << 63));
+    }
+  }
+  std::vector<int64_t> positions(row_num);
+  for (size_t i = 0; i < row_num; ++i) {
+    positions[i] = static_cast<int64_t>(i);
+  }
+
+  std::vector<size_t> counts(kDigits * kBuckets, 0);
+  for (uint64_t key : keys) {
+    for (int d = 0; d < kDigits; ++d) {
+      ++counts[d * kBuckets + ((key >> (d * kDigitBits)) & (kBuckets - 1))];
+    }
+  }
+  std::vector<uint64_t> sorted_keys(row_num);
+  std::vector<int64_t> sorted_positions(row_num);
+  for (int d = 0; d < kDigits; ++d) {
+    int shift = d * kDigitBits;
+    size_t* count = counts.data() + d * kBuckets;
+    // the rows have the same digit, e.g. the high bytes of small ids, and
+    // the pass would leave them as they are
+    if (count[(keys[0] >> shift) & (kBuckets - 1)] == row_num) {
       continue;
     }
-    auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
-
-#ifdef PADDLE_WITH_DNNL
-    OneDNNContext onednn_context(context.GetPlace());
-    funcs::OneDNNAXPYHandler<T> axpy_handler(
-        input_width, T(1.f), onednn_context.GetEngine());
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      axpy_handler(&input_data[i * input_width],
-                   &out_data[out_i * input_width]);
-    }
-#else
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
+    size_t offset = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      size_t bucket_size = count[b];
+      count[b] = offset;
+      offset += bucket_size;
     }
-#endif
+    for (size_t i = 0; i < row_num; ++i) {
+      size_t dst = count[(keys[i] >> shift) & (kBuckets - 1)]++;
+      sorted_keys[dst] = keys[i];
+      sorted_positions[dst] = positions[i];
+    }
+    keys.swap(sorted_keys);
+    positions.swap(sorted_positions);
+  }
+
+  for (size_t i = 0; i < row_num; ++i) {
+    if (i > 0 && keys[i] == keys[i - 1]) {
+      continue;
+    }
+    if (i > 0) {
+      segments->offsets.push_back(static_cast<int64_t>(i));
+    }
+    segments->rows.push_back(
+        static_cast<int64_t>(keys[i] ^ (uint64_t{1} << 63)));
   }
+  segments->offsets.push_back(static_cast<int64_t>(row_num));
+  segments->positions = std::move(positions);
 }
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<!std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
-                  int64_t input_width,
-                  const DeviceContext& context,
-                  T* out_data) {
-  VLOG(4) << "[CPU] add_sparse_inputs <" << typeid(T).name();
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
+// Writes the sum of the values of each segment to a row of out. The
+// segments are summed in parallel, each in the order of the inputs, so the
+// result does not depend on the number of threads.
+template <typename T>
+void SumRowSegments(const std::vector<const phi::SelectedRows*>& inputs,
+                    const RowSegments& segments,
+                    int64_t input_width,
+                    T* out_data) {
+  std::vector<const T*> rows_data;
+  rows_data.reserve(segments.positions.size());
   for (auto* input : inputs) {
     if (input->rows().empty()) {
       continue;
     }
     auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
+    for (size_t i = 0; i < input->rows().size(); ++i) {
+      rows_data.push_back(input_data + i * input_width);
+    }
+  }
 
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
+  int64_t segment_num = static_cast<int64_t>(segments.rows.size());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < segment_num; ++i) {
+    T* out_row = out_data + i * input_width;
+    int64_t begin = segments.offsets[i];
+    int64_t end = segments.offsets[i + 1];
+    const T* first_row = rows_data[segments.positions[begin]];
+    std::copy(first_row, first_row + input_width, out_row);
+    for (int64_t j = begin + 1; j < end; ++j) {
+      const T* in_row = rows_data[segments.positions[j]];
+      for (int64_t k = 0; k < input_width; ++k) {
+        out_row[k] += in_row[k];
+      }
     }
   }
 }
@@ -540,7 +565,6 @@ struct MergeAddImpl {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().empty()) {
@@ -556,16 +580,17 @@ struct MergeAddImpl {
                         common::errors::InvalidArgument(
                             "All inputs should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowSegments segments;
+    SegmentRows(inputs, &segments);
 
     out.set_height(input_height);
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(segments.rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (segments.rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
       std::vector<int64_t> merge_rows;
       merge_rows.reserve(row_num);
@@ -589,25 +614,9 @@ struct MergeAddImpl {
         copied_numel += static_cast<int64_t>(in_numel);
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
-      out.set_rows(merge_rows);
-
-      phi::funcs::SetConstant<DeviceContext, T> constant_functor;
-      constant_functor(context, out.mutable_value(), static_cast<T>(0.f));
-
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
-      add_sparse_inputs<T, DeviceContext>(
-          inputs, rows_to_id, input_width, context, out_data);
+      // the rows of the segments are sorted
+      out.set_rows(segments.rows);
+      SumRowSegments<T>(inputs, segments, input_width, out_data);
     }
   }
 };
@@ -855,7 +864,6 @@ struct MergeAverage<phi::CPUContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     for (auto* input : inputs) {
       if (input->rows().empty()) {
         continue;
@@ -869,49 +877,23 @@ struct MergeAverage<phi::CPUContext, T> {
                         input->height(),
                         common::errors::InvalidArgument(
                             "All input should have same height."));
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowSegments segments;
+    SegmentRows(inputs, &segments);
 
     out.set_height(input_height);
 
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(segments.rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    std::sort(merge_rows.begin(), merge_rows.end());
-
-    out.set_rows(merge_rows);
-
-    phi::funcs::SetConstant<phi::CPUContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0.0));
-
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
-    }
+    out.set_rows(segments.rows);
+    SumRowSegments<T>(inputs, segments, input_width, out_data);
 
-    auto blas = phi::funcs::GetBlas<phi::CPUContext, T>(context);
-    for (auto* input : inputs) {
-      if (input->rows().empty()) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<T>(&blas,
-                              static_cast<size_t>(input_width),
-                              &input_data[i * input_width],
-                              &out_data[out_i * input_width]);
-      }
-    }
     size_t input_width_cast = static_cast<size_t>(input_width);
     T count = static_cast<T>(inputs.size());
-    for (size_t i = 0; i < merge_rows.size(); i++) {
+    for (size_t i = 0; i < segments.rows.size(); i++) {
       for (size_t j = 0; j < input_width_cast; j++) {
         out_data[i * input_width + j] = out_data[i * input_width + j] / count;
       }
@@ -12,14 +12,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <set>
 #include <vector>
 
 #include "glog/logging.h"
 
 #include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/common/amp_type_traits.h"
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/memory_utils.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/funcs/selected_rows_functor.h"
 
@@ -342,31 +343,25 @@ template struct SelectedRowsAddToTensor<phi::GPUContext,
 
 namespace scatter {
 
+// Sums the rows of a segment in a block, in the order of the inputs, so the
+// merged rows are deterministic without atomic adds.
 template <typename T, int block_size>
-__global__ void MergeAddKernel(const T* input,
-                               const int64_t* input_rows,
+__global__ void MergeAddKernel(const T* const* rows_data,
+                               const int64_t* offsets,
                                T* out,
-                               const int64_t* out_rows,
-                               size_t out_rows_size,
                                int64_t row_numel) {
-  const int ty = blockIdx.x;
-  int tid = threadIdx.x;
-  __shared__ size_t out_idx;
-
-  if (tid == 0) {
-    for (size_t i = 0; i < out_rows_size; i++) {
-      if (input_rows[ty] == out_rows[i]) {
-        out_idx = i;
-      }
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  const int64_t segment = blockIdx.x;
+  const int64_t begin = offsets[segment];
+  const int64_t end = offsets[segment + 1];
+
+  out += segment * row_numel;
+  for (int64_t index = threadIdx.x; index < row_numel; index += block_size) {
+    MT sum = static_cast<MT>(rows_data[begin][index]);
+    for (int64_t i = begin + 1; i < end; ++i) {
+      sum += static_cast<MT>(rows_data[i][index]);
     }
-  }
-
-  __syncthreads();
-
-  input += ty * row_numel;
-  out += out_idx * row_numel;
-  for (int index = tid; index < row_numel; index += block_size) {
-    phi::CudaAtomicAdd(out + index, input[index]);
+    out[index] = static_cast<T>(sum);
   }
 }
 
@@ -384,45 +379,9 @@ struct MergeAddImpl {
                   const phi::SelectedRows& input,
                   phi::SelectedRows* output,
                   const bool sorted_result = false) {
-    phi::Vector<int64_t> input_rows(input.rows());
-    if (input_rows.size() == 0) {
-      return;
-    }
-
-    phi::SelectedRows& out = *output;
-    std::set<int64_t> row_set(input_rows.begin(), input_rows.end());
-    std::vector<int64_t> merge_rows_cpu(row_set.begin(), row_set.end());
-    phi::Vector<int64_t> merge_rows(merge_rows_cpu);
-
-    auto input_width = input.value().dims()[1];
-
-    out.set_rows(merge_rows);
-    out.set_height(input.height());
-    DenseTensor* out_tensor = out.mutable_value();
-    out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merge_rows.size()), input_width}));
-    context.template Alloc<T>(out_tensor);
-
-    phi::funcs::SetConstant<DeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0));
-
-    auto* out_data = out.mutable_value()->data<T>();
-    auto* input_data = input.value().data<T>();
-
-    const int block_size = 256;
-    dim3 threads(block_size, 1);
-    dim3 grid1(input_rows.size(), 1);
-
-    phi::MixVector<int64_t> mix_vector_input(&input_rows);
-    phi::MixVector<int64_t> mix_vector_out(out.mutable_rows());
-    MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-        input_data,
-        mix_vector_input.CUDAData(context.GetPlace()),
-        out_data,
-        mix_vector_out.CUDAMutableData(context.GetPlace()),
-        out.rows().size(),
-        input_width);
-    mix_vector_out.CopyToCPU();
+    std::vector<const phi::SelectedRows*> inputs;
+    inputs.push_back(&input);
+    (*this)(context, inputs, output, sorted_result);
   }
 
   void operator()(const DeviceContext& context,
@@ -447,7 +406,8 @@ struct MergeAddImpl {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
+    // the values of the rows in the order of the inputs
+    std::vector<const T*> rows_data;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -461,47 +421,52 @@ struct MergeAddImpl {
                         input->height(),
                         common::errors::InvalidArgument(
                             "All input should have same height."));
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
+      auto* input_data = input->value().data<T>();
+      for (size_t i = 0; i < input->rows().size(); ++i) {
+        rows_data.push_back(input_data + i * input_width);
+      }
     }
-    std::vector<int64_t> merge_rows_cpu(merged_row_set.begin(),
-                                        merged_row_set.end());
-    phi::Vector<int64_t> merge_rows(merge_rows_cpu);
+    // the rows are grouped on the host, where they are kept
+    RowSegments segments;
+    SegmentRows(inputs, &segments);
 
-    out.set_rows(merge_rows);
+    out.set_rows(segments.rows);
     out.set_height(input_height);
 
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merge_rows.size()), input_width}));
+        {static_cast<int64_t>(segments.rows.size()), input_width}));
     context.template Alloc<T>(out_tensor);
+    auto* out_data = out_tensor->data<T>();
 
-    phi::funcs::SetConstant<DeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0));
-
-    auto* out_data = out.mutable_value()->data<T>();
+    std::vector<const T*> sorted_rows_data(rows_data.size());
+    for (size_t i = 0; i < rows_data.size(); ++i) {
+      sorted_rows_data[i] = rows_data[segments.positions[i]];
+    }
+    auto rows_data_holder = phi::memory_utils::Alloc(
+        context.GetPlace(),
+        sorted_rows_data.size() * sizeof(T*),
+        phi::Stream(reinterpret_cast<phi::StreamId>(context.stream())));
+    memory_utils::Copy(context.GetPlace(),
+                       rows_data_holder->ptr(),
+                       phi::CPUPlace(),
+                       sorted_rows_data.data(),
+                       sorted_rows_data.size() * sizeof(T*),
+                       context.stream());
 
     const int block_size = 256;
     dim3 threads(block_size, 1);
+    dim3 grid1(segments.rows.size(), 1);
 
-    for (auto* input : inputs) {
-      if (input->rows().size() == 0) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-      dim3 grid1(input_rows.size(), 1);
-
-      phi::MixVector<int64_t> mix_vector_input(&input_rows);
-      phi::MixVector<int64_t> mix_vector_out(out.mutable_rows());
-      MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-          input_data,
-          mix_vector_input.CUDAData(context.GetPlace()),
-          out_data,
-          mix_vector_out.CUDAMutableData(context.GetPlace()),
-          out.rows().size(),
-          input_width);
-      mix_vector_out.CopyToCPU();
-    }
+    phi::Vector<int64_t> offsets(segments.offsets);
+    phi::MixVector<int64_t> mix_vector_offsets(&offsets);
+    MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
+        reinterpret_cast<const T* const*>(rows_data_holder->ptr()),
+        mix_vector_offsets.CUDAData(context.GetPlace()),
+        out_data,
+        input_width);
+    // the host buffers are released after the copies and the kernel
+    context.Wait();
   }
 };
 
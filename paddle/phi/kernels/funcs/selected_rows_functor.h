@@ -77,6 +77,21 @@ struct SelectedRowsAddToTensor {
 };
 
 namespace scatter {
+// The rows of the inputs grouped for merging: rows are the unique rows in
+// ascending order, and the values of rows[i] are at positions[offsets[i]]
+// to positions[offsets[i + 1] - 1] of the rows of all the inputs one after
+// another, in the order of the inputs.
+struct RowSegments {
+  std::vector<int64_t> rows;
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> positions;
+};
+
+// Groups the rows of the inputs by a radix sort, which is linear in the
+// number of rows and stable, instead of hashing every row.
+void SegmentRows(const std::vector<const phi::SelectedRows*>& inputs,
+                 RowSegments* segments);
+
 // functors for manipulating SelectedRows data
 template <typename DeviceContext, typename T>
 struct MergeAdd {
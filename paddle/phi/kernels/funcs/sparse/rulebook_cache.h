@@ -0,0 +1,149 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/ddim.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+namespace sparse {
+
+// The rulebook of a conv, and what the conv computes with it.
+struct RulebookCacheEntry {
+  DenseTensor rulebook;
+  // on the host
+  DenseTensor counter;
+  // only for the convs not subm, the out indices of subm are the in indices
+  DenseTensor out_indices;
+  DenseTensor out_index;
+  DenseTensor unique_value;
+};
+
+// The rulebooks of the convs without a key, found by the allocation of the
+// indices and the config of a conv. An entry is kept with a weak pointer to
+// the allocation, so it is not found by an allocation at the same address
+// after the indices are freed.
+class RulebookCache {
+ public:
+  static RulebookCache& Instance() {
+    static RulebookCache cache;
+    return cache;
+  }
+
+  bool Get(const DenseTensor& indices,
+           const std::string& config,
+           RulebookCacheEntry* entry) {
+    if (!indices.Holder()) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(std::make_pair(indices.data(), config));
+    if (it == index_.end()) return false;
+    if (it->second->holder.lock() != indices.Holder()) {
+      items_.erase(it->second);
+      index_.erase(it);
+      return false;
+    }
+    items_.splice(items_.begin(), items_, it->second);
+    *entry = it->second->entry;
+    return true;
+  }
+
+  void Put(const DenseTensor& indices,
+           const std::string& config,
+           const RulebookCacheEntry& entry,
+           size_t capacity) {
+    if (!indices.Holder() || capacity == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the rulebooks of the freed indices are never found again
+    for (auto it = items_.begin(); it != items_.end();) {
+      if (it->holder.expired()) {
+        index_.erase(it->key);
+        it = items_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    Key key = std::make_pair(indices.data(), config);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      items_.erase(it->second);
+      index_.erase(it);
+    }
+    while (items_.size() >= capacity) {
+      index_.erase(items_.back().key);
+      items_.pop_back();
+    }
+    items_.push_front(Item{key, indices.Holder(), entry});
+    index_[key] = items_.begin();
+  }
+
+ private:
+  using Key = std::pair<const void*, std::string>;
+
+  struct Item {
+    Key key;
+    std::weak_ptr<phi::Allocation> holder;
+    RulebookCacheEntry entry;
+  };
+
+  RulebookCache() = default;
+
+  // the most recently used first
+  std::list<Item> items_;
+  std::map<Key, std::list<Item>::iterator> index_;
+  std::mutex mutex_;
+};
+
+// What the rulebook depends on besides the indices, the channels are not.
+template <typename IntT>
+inline std::string RulebookConfig(const phi::Place& place,
+                                  const DDim& x_dims,
+                                  const std::vector<int>& kernel_sizes,
+                                  const std::vector<int>& paddings,
+                                  const std::vector<int>& dilations,
+                                  const std::vector<int>& strides,
+                                  const bool subm) {
+  std::ostringstream config;
+  auto append = [&](const std::vector<int>& values, size_t size) {
+    for (size_t i = 0; i < size && i < values.size(); ++i) {
+      config << values[i] << ",";
+    }
+    config << ";";
+  };
+  config << place << ";" << sizeof(IntT) << ";" << subm << ";";
+  for (int i = 0; i < x_dims.size() - 1; ++i) {
+    config << x_dims[i] << ",";
+  }
+  config << ";";
+  append(kernel_sizes, x_dims.size() - 2);
+  append(paddings, paddings.size());
+  append(dilations, dilations.size());
+  append(strides, strides.size());
+  return config.str();
+}
+
+}  // namespace sparse
+}  // namespace funcs
+}  // namespace phi
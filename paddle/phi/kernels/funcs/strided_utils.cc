@@ -0,0 +1,40 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+
+#include <atomic>
+
+#include "glog/logging.h"
+
+namespace phi {
+
+namespace {
+
+std::atomic<int64_t> avoided_contiguous_bytes{0};
+
+}  // namespace
+
+void AddAvoidedContiguousBytes(int64_t bytes) {
+  if (bytes <= 0) return;
+  int64_t total = avoided_contiguous_bytes.fetch_add(bytes) + bytes;
+  VLOG(4) << "avoided the contiguous copy of " << bytes << " bytes, "
+          << total << " bytes in total";
+}
+
+int64_t GetAvoidedContiguousBytes() { return avoided_contiguous_bytes.load(); }
+
+void ResetAvoidedContiguousBytes() { avoided_contiguous_bytes.store(0); }
+
+}  // namespace phi
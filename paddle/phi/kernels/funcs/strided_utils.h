@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #pragma once
+#include <vector>
+
 #include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_factory.h"
@@ -20,8 +22,36 @@
 #include "paddle/phi/kernels/contiguous_kernel.h"
 #include "paddle/phi/kernels/fill_kernel.h"
 #include "paddle/phi/kernels/strided_copy_kernel.h"
+#include "paddle/utils/test_macros.h"
 
 namespace phi {
+
+// The bytes of the contiguous copies of the strided inputs, which the
+// strided kernels avoided by reading the inputs through their strides.
+TEST_API void AddAvoidedContiguousBytes(int64_t bytes);
+TEST_API int64_t GetAvoidedContiguousBytes();
+TEST_API void ResetAvoidedContiguousBytes();
+
+inline int64_t ContiguousBytes(const phi::DenseTensor& input) {
+  return input.meta().is_contiguous()
+             ? 0
+             : input.numel() * static_cast<int64_t>(SizeOf(input.dtype()));
+}
+
+// The strides of input in each dim of out_dims, which the dims of input are
+// broadcast to with the trailing dims aligned, 0 for the broadcast dims.
+inline std::vector<int64_t> BroadcastStrides(const phi::DenseTensor& input,
+                                             const phi::DDim& out_dims) {
+  std::vector<int64_t> strides(out_dims.size(), 0);
+  int offset = out_dims.size() - input.dims().size();
+  for (int i = 0; i < input.dims().size(); ++i) {
+    if (input.dims()[i] != 1) {
+      strides[i + offset] = input.strides()[i];
+    }
+  }
+  return strides;
+}
+
 template <typename T>
 inline void StridedTensorCopy(const phi::DenseTensor& input,
                               const std::vector<int64_t>& dims,
@@ -152,4 +182,17 @@ inline void StridedTensorContiguous(const phi::DenseTensor& input,
         "Place type is not supported when `contiguous` kernel is called."));
   }
 }
+
+// The input itself if it is contiguous, otherwise its contiguous copy, for
+// the strided kernels left to the contiguous ones.
+template <typename T>
+inline phi::DenseTensor CheckAndStridedTensorContiguous(
+    const phi::DenseTensor& input) {
+  if (input.meta().is_contiguous()) {
+    return input;
+  }
+  phi::DenseTensor out;
+  StridedTensorContiguous<T>(input, &out);
+  return out;
+}
 }  // namespace phi
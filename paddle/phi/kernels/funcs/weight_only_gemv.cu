@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 #include <cmath>
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/amp_type_traits.h"
@@ -612,8 +613,9 @@ struct WeightOnlyScaleLoader {
     }
   }
 
-  __device__ __forceinline__ void advance() {
-    _offset += BlockSize * Details::kElemsPerThread / Details::kInterleave;
+  __device__ __forceinline__ void advance(int steps = 1) {
+    _offset +=
+        steps * BlockSize * Details::kElemsPerThread / Details::kInterleave;
   }
 
   __device__ __forceinline__ int offset() { return _offset; }
@@ -904,8 +906,10 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
                                                     const T* scales,
                                                     const T* zeros,
                                                     T* out,
+                                                    float* split_k_out,
                                                     const int n,
-                                                    const int k) {
+                                                    const int k,
+                                                    const int k_steps) {
   static_assert(NPerBlock == 1 || (NPerBlock % 2 == 0),
                 "NPerBlock must be 1 or even in gemv multi warp kernel. ");
   using Details = WeightOnlyKernelDetails<QType>;
@@ -922,9 +926,14 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
   constexpr int Interleave = Details::kInterleave;
   constexpr int WarpSize = 32;
   constexpr int Num = Batch * NPerBlock;
+  constexpr int KStep = BlockSize * Details::kElemsPerThread;
   const int tid = threadIdx.x;
   const int bid = blockIdx.x;
   const int n_start_id = bid * NPerBlock * Interleave;
+  // With split-k, blockIdx.y runs the k_steps steps of the k loop from
+  // blockIdx.y * k_steps and writes its partial sums to split_k_out.
+  const int k_step_start = blockIdx.y * k_steps;
+  const int k_end = min(k * Interleave, (k_step_start + k_steps) * KStep);
   using HALF_2_TYPE = typename CUDA_HALF_2_TYPE_TARIS<T>::type;
   // Calculate the n-dimensional index of the data processed by the current
   // thread in the interleave tile
@@ -932,6 +941,7 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
 
   qweight += n_start_id * k / Details::kElemsPerByte;
   ScaleLoader scale_loader(scales, zeros, n_start_id + interleave_n_id, n);
+  scale_loader.advance(k_step_start);
 
   float(*sm)[Num * Interleave] =
       reinterpret_cast<float(*)[Num * Interleave]>(shmem);
@@ -944,8 +954,9 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
   }
 
   // Iteration in k dimensions
-  for (int local_k = tid * Details::kElemsPerThread; local_k < k * Interleave;
-       local_k += BlockSize * Details::kElemsPerThread) {
+  for (int local_k = k_step_start * KStep + tid * Details::kElemsPerThread;
+       local_k < k_end;
+       local_k += KStep) {
     T weights_f16[Details::kElemsPerThread * NPerBlock];
     T scale[NPerBlock], zero[NPerBlock];
 #pragma unroll
@@ -1033,6 +1044,12 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
     for (int j = 0; j < BlockSize / WarpSize; ++j) {
       v += sm[j][i];
     }
+    int b = i / NPerBlock / Interleave;
+    if (split_k_out != nullptr) {
+      // the bias and the activation are applied after the reduction
+      split_k_out[(blockIdx.y * Batch + b) * n + n_start_id + nid] = v;
+      continue;
+    }
     float bias_v = 0.f;
 #ifndef WIN32
     if constexpr (Bias) {
@@ -1041,12 +1058,114 @@ __global__ void weight_only_batched_gemv_multi_warp(const T* in,
 #endif
       bias_v = ConvertFloatFunc<T>::apply(bias[n_start_id + nid]);
     }
-    int b = i / NPerBlock / Interleave;
     out[b * n + n_start_id + nid] = ConvertDstFunc<T>::apply(
         GeluActivation<float, Gelu>::apply(v + bias_v));
   }
 }
+
+template <typename T, bool Gelu, bool Bias>
+__global__ void weight_only_gemv_split_k_reduce(const float* split_k_out,
+                                                const T* bias,
+                                                T* out,
+                                                const int m,
+                                                const int n,
+                                                const int split_k) {
+  const int mn = m * n;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < mn;
+       i += gridDim.x * blockDim.x) {
+    float v = 0.f;
+    for (int j = 0; j < split_k; ++j) {
+      v += split_k_out[j * mn + i];
+    }
+#ifndef WIN32
+    if constexpr (Bias) {
+#else
+    if (Bias) {
+#endif
+      v += ConvertFloatFunc<T>::apply(bias[i % n]);
+    }
+    out[i] = ConvertDstFunc<T>::apply(GeluActivation<float, Gelu>::apply(v));
+  }
+}
+
+constexpr int kMaxGemvSplitK = 16;
+
+// The gemv runs a block per NPerBlock * kInterleave columns of the output,
+// which leaves SMs idle for a small n. Then the k loop is split across about
+// two blocks per SM, each split running at least one step of it.
+int GetGemvSplitK(int num_blocks, int k_steps, int sm_count) {
+  if (num_blocks >= sm_count || k_steps < 2) {
+    return 1;
+  }
+  return std::min(
+      {(2 * sm_count + num_blocks - 1) / num_blocks, k_steps, kMaxGemvSplitK});
+}
+#endif
+
+template <typename T,
+          WeightOnlyQuantType QType,
+          typename WeightOnlyFlag,
+          bool Gelu,
+          bool Bias,
+          int NPerBlock,
+          int Batch,
+          int BlockSize>
+void launch_batched_gemv(const T* input,
+                         const int8_t* weight,
+                         const T* bias,
+                         const T* scales,
+                         const int m,
+                         const int n,
+                         const int k,
+                         T* output,
+                         const phi::GPUContext& dev_ctx) {
+#ifdef PADDLE_WITH_CUDA
+  static constexpr int kInterleave = WeightLayoutDetails<QType>::kInterleave;
+  static constexpr int kStep =
+      BlockSize * WeightOnlyKernelDetails<QType>::kElemsPerThread;
+  const int num_blocks = n / NPerBlock / kInterleave;
+  const int k_steps = (k * kInterleave + kStep - 1) / kStep;
+  int split_k = GetGemvSplitK(num_blocks, k_steps, dev_ctx.GetSMCount());
+  const int split_k_steps = (k_steps + split_k - 1) / split_k;
+  split_k = (k_steps + split_k_steps - 1) / split_k_steps;
+
+  DenseTensor split_k_workspace;
+  float* split_k_out = nullptr;
+  if (split_k > 1) {
+    split_k_workspace.Resize({split_k, m, n});
+    split_k_out = dev_ctx.template Alloc<float>(&split_k_workspace);
+  }
+  dim3 grid(num_blocks, split_k);
+  dim3 block(BlockSize);
+  int size = sizeof(float) * BlockSize / 32 * Batch * NPerBlock * kInterleave;
+  weight_only_batched_gemv_multi_warp<T,
+                                      QType,
+                                      WeightOnlyFlag,
+                                      Gelu,
+                                      false,
+                                      Bias,
+                                      NPerBlock,
+                                      Batch,
+                                      BlockSize>
+      <<<grid, block, size, dev_ctx.stream()>>>(input,
+                                                weight,
+                                                bias,
+                                                scales,
+                                                /*zeros*/ nullptr,
+                                                output,
+                                                split_k_out,
+                                                n,
+                                                k,
+                                                split_k_steps);
+  if (split_k > 1) {
+    constexpr int kReduceBlockSize = 256;
+    const int reduce_grid = (m * n + kReduceBlockSize - 1) / kReduceBlockSize;
+    weight_only_gemv_split_k_reduce<T, Gelu, Bias>
+        <<<reduce_grid, kReduceBlockSize, 0, dev_ctx.stream()>>>(
+            split_k_out, bias, output, m, n, split_k);
+  }
 #endif
+}
 
 template <typename T,
           WeightOnlyQuantType QType,
@@ -1063,37 +1182,29 @@ void select_activation_and_bias(const T* input,
                                 const int k,
                                 const std::string& act_method,
                                 T* output,
-                                cudaStream_t stream) {
+                                const phi::GPUContext& dev_ctx) {
 #ifdef PADDLE_WITH_CUDA
-  static constexpr int kInterleave = WeightLayoutDetails<QType>::kInterleave;
-  dim3 grid(n / NPerBlock / kInterleave);
-  dim3 block(BlockSize);
-  int size = sizeof(float) * BlockSize / 32 * Batch * NPerBlock * kInterleave;
   if (bias) {
     if (act_method == "gelu") {
-      weight_only_batched_gemv_multi_warp<T,
-                                          QType,
-                                          WeightOnlyFlag,
-                                          true,
-                                          false,
-                                          true,
-                                          NPerBlock,
-                                          Batch,
-                                          BlockSize>
-          <<<grid, block, size, stream>>>(
-              input, weight, bias, scales, /*zeros*/ nullptr, output, n, k);
+      launch_batched_gemv<T,
+                          QType,
+                          WeightOnlyFlag,
+                          true,
+                          true,
+                          NPerBlock,
+                          Batch,
+                          BlockSize>(
+          input, weight, bias, scales, m, n, k, output, dev_ctx);
     } else if (act_method == "None") {
-      weight_only_batched_gemv_multi_warp<T,
-                                          QType,
-                                          WeightOnlyFlag,
-                                          false,
-                                          false,
-                                          true,
-                                          NPerBlock,
-                                          Batch,
-                                          BlockSize>
-          <<<grid, block, size, stream>>>(
-              input, weight, bias, scales, /*zeros*/ nullptr, output, n, k);
+      launch_batched_gemv<T,
+                          QType,
+                          WeightOnlyFlag,
+                          false,
+                          true,
+                          NPerBlock,
+                          Batch,
+                          BlockSize>(
+          input, weight, bias, scales, m, n, k, output, dev_ctx);
     } else {
       PADDLE_THROW(
           errors::InvalidArgument("Currently, weightonly GEMV act_method "
@@ -1101,29 +1212,25 @@ void select_activation_and_bias(const T* input,
     }
   } else {
     if (act_method == "gelu") {
-      weight_only_batched_gemv_multi_warp<T,
-                                          QType,
-                                          WeightOnlyFlag,
-                                          true,
-                                          false,
-                                          false,
-                                          NPerBlock,
-                                          Batch,
-                                          BlockSize>
-          <<<grid, block, size, stream>>>(
-              input, weight, bias, scales, /*zeros*/ nullptr, output, n, k);
+      launch_batched_gemv<T,
+                          QType,
+                          WeightOnlyFlag,
+                          true,
+                          false,
+                          NPerBlock,
+                          Batch,
+                          BlockSize>(
+          input, weight, bias, scales, m, n, k, output, dev_ctx);
     } else if (act_method == "None") {
-      weight_only_batched_gemv_multi_warp<T,
-                                          QType,
-                                          WeightOnlyFlag,
-                                          false,
-                                          false,
-                                          false,
-                                          NPerBlock,
-                                          Batch,
-                                          BlockSize>
-          <<<grid, block, size, stream>>>(
-              input, weight, bias, scales, /*zeros*/ nullptr, output, n, k);
+      launch_batched_gemv<T,
+                          QType,
+                          WeightOnlyFlag,
+                          false,
+                          false,
+                          NPerBlock,
+                          Batch,
+                          BlockSize>(
+          input, weight, bias, scales, m, n, k, output, dev_ctx);
     } else {
       PADDLE_THROW(
           errors::InvalidArgument("Currently, weightonly GEMV act_method "
@@ -1145,7 +1252,7 @@ void weight_only_batched_gemv_launcher(
     const std::string& weight_only_quant_type,
     const std::string& act_method,
     T* output,
-    cudaStream_t stream) {
+    const phi::GPUContext& dev_ctx) {
 #ifdef PADDLE_WITH_CUDA
   if (weight_only_quant_type == "int4") {
     switch (m) {
@@ -1156,7 +1263,7 @@ void weight_only_batched_gemv_launcher(
                                    1,
                                    1,
                                    192>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 2: {
@@ -1166,7 +1273,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    2,
                                    128>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 3: {
@@ -1176,7 +1283,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    3,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 4: {
@@ -1186,7 +1293,7 @@ void weight_only_batched_gemv_launcher(
                                    4,
                                    4,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       default: {
@@ -1204,7 +1311,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    1,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 2: {
@@ -1214,7 +1321,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    2,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 3: {
@@ -1224,7 +1331,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    3,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       case 4: {
@@ -1234,7 +1341,7 @@ void weight_only_batched_gemv_launcher(
                                    2,
                                    4,
                                    256>(
-            input, weight, bias, scales, m, n, k, act_method, output, stream);
+            input, weight, bias, scales, m, n, k, act_method, output, dev_ctx);
         break;
       }
       default: {
@@ -1284,7 +1391,7 @@ void WeightOnlyGemvWrapper(const Context& dev_ctx,
         weight_only_quant_type,
         act_method,
         reinterpret_cast<DataType*>(output),
-        dev_ctx.stream());
+        dev_ctx);
   } else if (weight_only_type == "group_wise") {
     if (group_size == 64) {
       weight_only_batched_gemv_launcher<DataType, WeightOnlyGroupWise<64>>(
@@ -1298,7 +1405,7 @@ void WeightOnlyGemvWrapper(const Context& dev_ctx,
           weight_only_quant_type,
           act_method,
           reinterpret_cast<DataType*>(output),
-          dev_ctx.stream());
+          dev_ctx);
     } else if (group_size == 128) {
       weight_only_batched_gemv_launcher<DataType, WeightOnlyGroupWise<128>>(
           reinterpret_cast<const DataType*>(input),
@@ -1311,7 +1418,7 @@ void WeightOnlyGemvWrapper(const Context& dev_ctx,
           weight_only_quant_type,
           act_method,
           reinterpret_cast<DataType*>(output),
-          dev_ctx.stream());
+          dev_ctx);
     } else {
       PADDLE_THROW(common::errors::InvalidArgument(
           "WeightOnlyGemvKernel group_size only support 64 or 128."));
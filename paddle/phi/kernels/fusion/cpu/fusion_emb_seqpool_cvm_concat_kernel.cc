@@ -0,0 +1,157 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
+
+namespace phi {
+namespace fusion {
+
+// Rows of the output pooled a time, so that the output rows of all the slots
+// stay in cache from the pooling to the cvm.
+constexpr size_t kEmbSeqPoolBlockBytes = 64 * 1024;
+
+// Looks up the embedding rows of the ids of every slot, pools them per
+// sequence, applies cvm and concats the slots, without writing the looked up
+// rows and the pooled slots in between.
+template <typename T, typename Context>
+void FusionEmbSeqPoolCVMConcatKernel(const Context& dev_ctx,
+                                     const std::vector<const DenseTensor*>& ids,
+                                     const DenseTensor& w,
+                                     const DenseTensor& cvm UNUSED,
+                                     const std::string& pooltype,
+                                     bool use_cvm UNUSED,
+                                     int axis UNUSED,
+                                     int64_t padding_idx,
+                                     DenseTensor* out) {
+  const size_t n = ids.size();
+  PADDLE_ENFORCE_EQ(ids[0]->lod().empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The Input(Ids) of FusionEmbSeqPoolCVMConcatOp should "
+                        "have lod."));
+  const size_t bs = ids[0]->lod()[0].size() - 1;
+  const int64_t tbl_h = w.dims()[0];
+  const int64_t tbl_w = w.dims()[1];
+  const T* table = w.data<T>();
+
+  const size_t dst_step_size = n * tbl_w;
+  out->Resize({static_cast<int64_t>(bs), static_cast<int64_t>(dst_step_size)});
+  phi::LoD y_lod(1);
+  y_lod[0].resize(bs + 1);
+  for (size_t i = 0; i <= bs; ++i) {
+    y_lod[0][i] = i;
+  }
+  out->set_lod(y_lod);
+  T* y_data = dev_ctx.template Alloc<T>(out);
+
+  // the jitcode of EmbSeqPool does not check the ids
+  for (size_t i = 0; i < n; ++i) {
+    PADDLE_ENFORCE_EQ(ids[i]->lod().empty() ? 0 : ids[i]->lod()[0].size(),
+                      bs + 1,
+                      common::errors::InvalidArgument(
+                          "Batchsize of all inputs should be equal."));
+    const int64_t* ids_data = ids[i]->data<int64_t>();
+    const int64_t ids_num = ids[i]->numel();
+    PADDLE_ENFORCE_EQ(
+        static_cast<size_t>(ids_num),
+        ids[i]->lod()[0].back(),
+        common::errors::InvalidArgument(
+            "The numel of Ids %d should be equal to the last lod %d.",
+            ids_num,
+            ids[i]->lod()[0].back()));
+    for (int64_t k = 0; k < ids_num; ++k) {
+      const int64_t id = ids_data[k];
+      PADDLE_ENFORCE_EQ(
+          id == padding_idx || (id >= 0 && id < tbl_h),
+          true,
+          common::errors::InvalidArgument(
+              "The id should be in [0, %d) of the table height, but the %dth "
+              "id of the %dth input is %d.",
+              tbl_h,
+              k,
+              i,
+              id));
+    }
+  }
+
+  phi::jit::emb_seq_pool_attr_t attr(
+      tbl_h, tbl_w, 0, 1, tbl_w, phi::jit::SeqPoolType::kSum);
+  auto emb_seqpool = phi::jit::KernelFuncs<phi::jit::EmbSeqPoolTuple<T>,
+                                           phi::CPUPlace>::Cache()
+                         .At(attr);
+  const int d = static_cast<int>(tbl_w);
+  auto vadd =
+      phi::jit::KernelFuncs<phi::jit::VAddTuple<T>, phi::CPUPlace>::Cache().At(
+          d);
+  auto vscal =
+      phi::jit::KernelFuncs<phi::jit::VScalTuple<T>, phi::CPUPlace>::Cache()
+          .At(d);
+
+  const size_t block_rows =
+      std::max<size_t>(1, kEmbSeqPoolBlockBytes / (dst_step_size * sizeof(T)));
+  for (size_t b = 0; b < bs; b += block_rows) {
+    const size_t b_end = std::min(bs, b + block_rows);
+    for (size_t i = 0; i < n; ++i) {
+      const auto& lod = ids[i]->lod()[0];
+      const int64_t* ids_data = ids[i]->data<int64_t>();
+      for (size_t j = b; j < b_end; ++j) {
+        T* dst = y_data + j * dst_step_size + i * tbl_w;
+        const int64_t h = static_cast<int64_t>(lod[j + 1] - lod[j]);
+        const int64_t* seq_ids = ids_data + lod[j];
+        if (h == 0) {
+          std::memset(dst, 0, sizeof(T) * tbl_w);
+        } else if (padding_idx == -1) {
+          attr.index_height = h;
+          emb_seqpool(table, seq_ids, dst, &attr);
+        } else {
+          // the rows of padding_idx are zeros
+          std::memset(dst, 0, sizeof(T) * tbl_w);
+          for (int64_t k = 0; k < h; ++k) {
+            if (seq_ids[k] != padding_idx) {
+              vadd(dst, table + seq_ids[k] * tbl_w, dst, d);
+            }
+          }
+        }
+        if (h > 0 && pooltype != "SUM") {
+          T scalar = pooltype == "AVERAGE"
+                         ? static_cast<T>(1) / static_cast<T>(h)
+                         : static_cast<T>(1) / std::sqrt(static_cast<T>(h));
+          vscal(&scalar, dst, dst, d);
+        }
+        // Currently only use_cvm is true.
+        dst[0] = log(dst[0] + 1);
+        dst[1] = log(dst[1] + 1) - dst[0];
+      }
+    }
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fusion_emb_seqpool_cvm_concat,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusionEmbSeqPoolCVMConcatKernel,
+                   float,
+                   double) {}
@@ -0,0 +1,93 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/datatype_traits.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/fusion/cutlass/cutlass_kernels/moe_gemm/fused_moe_gemm_kernels.h"
+
+namespace phi {
+namespace fusion {
+
+// The tokens of the experts are a handful of numbers, a single thread scans
+// them into the end row of each expert, clamped to the rows of the input.
+template <typename IndexT>
+__global__ void TokensToTotalRowsBeforeExpertKernel(
+    const IndexT* tokens_per_expert,
+    const int num_experts,
+    const int64_t total_rows,
+    int64_t* total_rows_before_expert) {
+  int64_t end = 0;
+  for (int i = 0; i < num_experts; ++i) {
+    const int64_t tokens = static_cast<int64_t>(tokens_per_expert[i]);
+    end = min(end + max(tokens, static_cast<int64_t>(0)), total_rows);
+    total_rows_before_expert[i] = end;
+  }
+}
+
+// Computes out[rows of expert i] = x[rows of expert i] * weight[i] for all
+// the experts in a single grouped gemm launch. x is [total_rows, k] with the
+// rows sorted by expert, weight is [num_experts, k, n], and
+// total_rows_before_expert is the inclusive end row of each expert.
+template <typename T>
+void MoeGroupedGemm(const phi::GPUContext& dev_ctx,
+                    const DenseTensor& x,
+                    const DenseTensor& weight,
+                    const int64_t* total_rows_before_expert,
+                    DenseTensor* out) {
+  using NvT = typename phi::PDDataTypeTraits<T>::DataType;
+  const int64_t total_rows = x.dims()[0];
+  const int64_t gemm_k = x.dims()[1];
+  const int num_experts = static_cast<int>(weight.dims()[0]);
+  const int64_t gemm_n = weight.dims()[2];
+  if (total_rows == 0) {
+    return;
+  }
+  auto runner = MoeGemmRunner<NvT, NvT>();
+  runner.moe_gemm(reinterpret_cast<const NvT*>(x.data<T>()),
+                  reinterpret_cast<const NvT*>(weight.data<T>()),
+                  nullptr,
+                  reinterpret_cast<NvT*>(out->data<T>()),
+                  const_cast<int64_t*>(total_rows_before_expert),
+                  total_rows,
+                  gemm_n,
+                  gemm_k,
+                  num_experts,
+                  dev_ctx.stream());
+}
+
+// Fills the total_rows_before_expert of the grouped gemm from the tokens of
+// the experts.
+inline void ComputeTotalRowsBeforeExpert(
+    const phi::GPUContext& dev_ctx,
+    const DenseTensor& tokens_per_expert,
+    int64_t total_rows,
+    DenseTensor* total_rows_before_expert) {
+  const int num_experts = static_cast<int>(tokens_per_expert.numel());
+  total_rows_before_expert->Resize({num_experts});
+  auto* out = dev_ctx.Alloc<int64_t>(total_rows_before_expert);
+  if (tokens_per_expert.dtype() == DataType::INT32) {
+    TokensToTotalRowsBeforeExpertKernel<int><<<1, 1, 0, dev_ctx.stream()>>>(
+        tokens_per_expert.data<int>(), num_experts, total_rows, out);
+  } else {
+    TokensToTotalRowsBeforeExpertKernel<int64_t>
+        <<<1, 1, 0, dev_ctx.stream()>>>(
+            tokens_per_expert.data<int64_t>(), num_experts, total_rows, out);
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
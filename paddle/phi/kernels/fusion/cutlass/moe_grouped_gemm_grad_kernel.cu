@@ -0,0 +1,106 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_grouped_gemm_utils.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+
+namespace phi {
+namespace fusion {
+
+template <typename T, typename Context>
+void MoeGroupedGemmGradKernel(const Context& dev_ctx,
+                              const DenseTensor& x,
+                              const DenseTensor& weight,
+                              const DenseTensor& tokens_per_expert,
+                              const DenseTensor& out_grad,
+                              DenseTensor* x_grad,
+                              DenseTensor* weight_grad) {
+  const int64_t total_rows = x.dims()[0];
+  const int64_t gemm_k = x.dims()[1];
+  const int num_experts = static_cast<int>(weight.dims()[0]);
+  const int64_t gemm_n = weight.dims()[2];
+
+  DenseTensor total_rows_before_expert;
+  ComputeTotalRowsBeforeExpert(
+      dev_ctx, tokens_per_expert, total_rows, &total_rows_before_expert);
+
+  // x_grad of the rows of expert i is out_grad * weight[i]^T, which is the
+  // grouped gemm of the transposed weights
+  if (x_grad) {
+    dev_ctx.template Alloc<T>(x_grad);
+    DenseTensor weight_t = TransposeLast2Dim<T, Context>(dev_ctx, weight);
+    MoeGroupedGemm<T>(dev_ctx,
+                      out_grad,
+                      weight_t,
+                      total_rows_before_expert.data<int64_t>(),
+                      x_grad);
+  }
+
+  // weight_grad[i] is x^T * out_grad of the rows of expert i, whose gemm
+  // reduces over the rows, so they are run expert by expert
+  if (weight_grad) {
+    dev_ctx.template Alloc<T>(weight_grad);
+    funcs::SetConstant<Context, T>()(dev_ctx, weight_grad, static_cast<T>(0));
+    DenseTensor row_ends;
+    phi::Copy(dev_ctx, total_rows_before_expert, CPUPlace(), true, &row_ends);
+    const int64_t* ends = row_ends.data<int64_t>();
+    auto blas = funcs::GetBlas<Context, T>(dev_ctx);
+    const T* x_data = x.data<T>();
+    const T* dout_data = out_grad.data<T>();
+    T* dw_data = weight_grad->data<T>();
+    int64_t begin = 0;
+    for (int i = 0; i < num_experts; ++i) {
+      const int64_t rows = ends[i] - begin;
+      if (rows > 0) {
+        blas.GEMM(CblasTrans,
+                  CblasNoTrans,
+                  static_cast<int>(gemm_k),
+                  static_cast<int>(gemm_n),
+                  static_cast<int>(rows),
+                  static_cast<T>(1),
+                  x_data + begin * gemm_k,
+                  dout_data + begin * gemm_n,
+                  static_cast<T>(0),
+                  dw_data + i * gemm_k * gemm_n);
+      }
+      begin = ends[i];
+    }
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+#ifdef PADDLE_CUDA_BF16
+PD_REGISTER_KERNEL(moe_grouped_gemm_grad,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmGradKernel,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
+#else
+PD_REGISTER_KERNEL(moe_grouped_gemm_grad,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmGradKernel,
+                   phi::dtype::float16) {}
+#endif
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_grouped_gemm_utils.h"
+
+namespace phi {
+namespace fusion {
+
+template <typename T, typename Context>
+void MoeGroupedGemmKernel(const Context& dev_ctx,
+                          const DenseTensor& x,
+                          const DenseTensor& weight,
+                          const DenseTensor& tokens_per_expert,
+                          DenseTensor* out) {
+  const int64_t gemm_k = x.dims()[1];
+  const int64_t gemm_n = weight.dims()[2];
+  // the cutlass grouped gemm loads 128 bits of the rows at a time
+  PADDLE_ENFORCE_EQ(
+      gemm_k % 8 == 0 && gemm_n % 8 == 0,
+      true,
+      common::errors::InvalidArgument(
+          "The moe_grouped_gemm requires the K and N of the gemm to be "
+          "multiples of 8, but got K = %d and N = %d.",
+          gemm_k,
+          gemm_n));
+  dev_ctx.template Alloc<T>(out);
+
+  DenseTensor total_rows_before_expert;
+  ComputeTotalRowsBeforeExpert(
+      dev_ctx, tokens_per_expert, x.dims()[0], &total_rows_before_expert);
+  MoeGroupedGemm<T>(
+      dev_ctx, x, weight, total_rows_before_expert.data<int64_t>(), out);
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+#ifdef PADDLE_CUDA_BF16
+PD_REGISTER_KERNEL(moe_grouped_gemm,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmKernel,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
+#else
+PD_REGISTER_KERNEL(moe_grouped_gemm,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmKernel,
+                   phi::dtype::float16) {}
+#endif
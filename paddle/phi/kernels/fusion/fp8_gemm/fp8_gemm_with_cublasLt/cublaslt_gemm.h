@@ -302,7 +302,11 @@ void cublaslt_fp8_fp8_fp16_gemm(
     const float scale,  // only support per-tensor quantization
     const std::string& activation_type,
     DenseTensor* out) {
-  PADDLE_ENFORCE_EQ(x.dims().size() == y.dims().size(),
+  // a 2-D y, e.g. the weight of a linear layer, is shared by all the rows of
+  // x, whose leading dims are folded into m
+  const bool fold_x =
+      y.dims().size() == 2 && x.dims().size() > 2 && !transpose_x;
+  PADDLE_ENFORCE_EQ(x.dims().size() == y.dims().size() || fold_x,
                     true,
                     common::errors::InvalidArgument(
                         "FP8 gemm x_dims.size, must equal to y_dims.size,"
@@ -311,11 +315,15 @@ void cublaslt_fp8_fp8_fp16_gemm(
                         y.dims().size()));
 
   int rank = x.dims().size();
+  int y_rank = y.dims().size();
   int m = transpose_x ? x.dims()[rank - 1] : x.dims()[rank - 2];
-  int n = transpose_y ? y.dims()[rank - 2] : y.dims()[rank - 1];
+  int n = transpose_y ? y.dims()[y_rank - 2] : y.dims()[y_rank - 1];
   int k = transpose_x ? x.dims()[rank - 2] : x.dims()[rank - 1];
+  if (fold_x) {
+    m = x.numel() / k;
+  }
 
-  int y_k = transpose_y ? y.dims()[rank - 1] : y.dims()[rank - 2];
+  int y_k = transpose_y ? y.dims()[y_rank - 1] : y.dims()[y_rank - 2];
   PADDLE_ENFORCE_EQ(
       k == y_k,
       true,
@@ -341,7 +349,7 @@ void cublaslt_fp8_fp8_fp16_gemm(
 
   ctx.template Alloc<phi::dtype::float16>(out);
   int batch_count = 1;
-  for (size_t i = 0; i < rank - 2; ++i) {
+  for (size_t i = 0; !fold_x && i < rank - 2; ++i) {
     batch_count *= x.dims()[i];
   }
   CublasLtMatmulFP8<phi::dtype::float16>(
@@ -359,7 +367,11 @@ void cublaslt_fp8_fp8_bf16_gemm(
     const float scale,  // only support per-tensor quantization
     const std::string& activation_type,
     DenseTensor* out) {
-  PADDLE_ENFORCE_EQ(x.dims().size() == y.dims().size(),
+  // a 2-D y, e.g. the weight of a linear layer, is shared by all the rows of
+  // x, whose leading dims are folded into m
+  const bool fold_x =
+      y.dims().size() == 2 && x.dims().size() > 2 && !transpose_x;
+  PADDLE_ENFORCE_EQ(x.dims().size() == y.dims().size() || fold_x,
                     true,
                     common::errors::InvalidArgument(
                         "FP8 gemm x_dims.size, must equal to y_dims.size,"
@@ -368,11 +380,15 @@ void cublaslt_fp8_fp8_bf16_gemm(
                         y.dims().size()));
 
   int rank = x.dims().size();
+  int y_rank = y.dims().size();
   int m = transpose_x ? x.dims()[rank - 1] : x.dims()[rank - 2];
-  int n = transpose_y ? y.dims()[rank - 2] : y.dims()[rank - 1];
+  int n = transpose_y ? y.dims()[y_rank - 2] : y.dims()[y_rank - 1];
   int k = transpose_x ? x.dims()[rank - 2] : x.dims()[rank - 1];
+  if (fold_x) {
+    m = x.numel() / k;
+  }
 
-  int y_k = transpose_y ? y.dims()[rank - 1] : y.dims()[rank - 2];
+  int y_k = transpose_y ? y.dims()[y_rank - 1] : y.dims()[y_rank - 2];
   PADDLE_ENFORCE_EQ(
       k == y_k,
       true,
@@ -398,7 +414,7 @@ void cublaslt_fp8_fp8_bf16_gemm(
 
   ctx.template Alloc<phi::dtype::bfloat16>(out);
   int batch_count = 1;
-  for (size_t i = 0; i < rank - 2; ++i) {
+  for (size_t i = 0; !fold_x && i < rank - 2; ++i) {
     batch_count *= x.dims()[i];
   }
   CublasLtMatmulFP8<phi::dtype::bfloat16>(
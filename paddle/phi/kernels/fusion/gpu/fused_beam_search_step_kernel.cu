@@ -0,0 +1,337 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cfloat>
+#include <cstdint>
+#include <limits>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_device_function.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/funcs/math_cuda_utils.h"
+
+namespace phi {
+namespace fusion {
+
+// The candidates of a beam are kept in the registers of each thread.
+constexpr int kMaxBeamSize = 16;
+constexpr int kBlockSize = 256;
+constexpr int64_t kNoToken = std::numeric_limits<int64_t>::max();
+
+// The larger value, or the smaller id of the equal values.
+__device__ __forceinline__ bool IsBetter(float value,
+                                         int64_t id,
+                                         float other_value,
+                                         int64_t other_id) {
+  return value > other_value || (value == other_value && id < other_id);
+}
+
+__device__ __forceinline__ void WarpArgMax(float* value, int64_t* id) {
+  for (int mask = HALF_WARP; mask > 0; mask >>= 1) {
+    float other_value =
+        phi::backends::gpu::CudaShuffleXorSync(FINAL_MASK, *value, mask);
+    int64_t other_id =
+        phi::backends::gpu::CudaShuffleXorSync(FINAL_MASK, *id, mask);
+    if (IsBetter(other_value, other_id, *value, *id)) {
+      *value = other_value;
+      *id = other_id;
+    }
+  }
+}
+
+// The max of the block, given to all the threads.
+__device__ __forceinline__ void BlockArgMax(float* value, int64_t* id) {
+  __shared__ float shared_values[WARP_SIZE];
+  __shared__ int64_t shared_ids[WARP_SIZE];
+  const int lane = threadIdx.x & WARP_SIZE_WIDTH_MASK;
+  const int wid = threadIdx.x >> WARP_SIZE_WIDTH;
+  WarpArgMax(value, id);
+  __syncthreads();
+  if (lane == 0) {
+    shared_values[wid] = *value;
+    shared_ids[wid] = *id;
+  }
+  __syncthreads();
+  const int block_span = (blockDim.x + warpSize - 1) >> WARP_SIZE_WIDTH;
+  *value = lane < block_span ? shared_values[lane] : -INFINITY;
+  *id = lane < block_span ? shared_ids[lane] : kNoToken;
+  WarpArgMax(value, id);
+}
+
+// The beam_size best tokens of a beam, by the log-softmax of its logits
+// added to the score of the beam. A block runs a beam: the log-sum-exp of
+// the row is reduced first, each thread keeps the best tokens of its
+// strided part of the vocab, and the best of the block are taken one at a
+// time. A finished beam proposes end_id only, keeping its score.
+template <typename T, int MaxBeam>
+__global__ void BeamSearchCandidatesKernel(const T* logits,
+                                           const float* pre_scores,
+                                           const bool* pre_finished,
+                                           int64_t vocab,
+                                           int beam_size,
+                                           int64_t end_id,
+                                           float* cand_scores,
+                                           int64_t* cand_ids) {
+  const int64_t row = blockIdx.x;
+  float* row_scores = cand_scores + row * beam_size;
+  int64_t* row_ids = cand_ids + row * beam_size;
+  if (pre_finished[row]) {
+    for (int i = threadIdx.x; i < beam_size; i += blockDim.x) {
+      row_scores[i] = i == 0 ? pre_scores[row] : -INFINITY;
+      row_ids[i] = end_id;
+    }
+    return;
+  }
+
+  const T* row_logits = logits + row * vocab;
+  float max_value = -FLT_MAX;
+  for (int64_t i = threadIdx.x; i < vocab; i += blockDim.x) {
+    max_value = max(max_value, static_cast<float>(row_logits[i]));
+  }
+  max_value = funcs::BlockReduceMax<float>(max_value, FINAL_MASK);
+  __syncthreads();
+  float sum_value = 0.f;
+  for (int64_t i = threadIdx.x; i < vocab; i += blockDim.x) {
+    sum_value += __expf(static_cast<float>(row_logits[i]) - max_value);
+  }
+  sum_value = funcs::BlockReduceSum<float>(sum_value, FINAL_MASK);
+  const float log_sum_exp = max_value + __logf(sum_value);
+
+  // sorted descending, the ids ascending in a thread keep the ties stable
+  float values[MaxBeam];
+  int64_t ids[MaxBeam];
+  for (int k = 0; k < MaxBeam; ++k) {
+    values[k] = -INFINITY;
+    ids[k] = kNoToken;
+  }
+  for (int64_t i = threadIdx.x; i < vocab; i += blockDim.x) {
+    const float value = static_cast<float>(row_logits[i]);
+    if (!IsBetter(value, i, values[beam_size - 1], ids[beam_size - 1])) {
+      continue;
+    }
+    int k = beam_size - 1;
+    for (; k > 0 && IsBetter(value, i, values[k - 1], ids[k - 1]); --k) {
+      values[k] = values[k - 1];
+      ids[k] = ids[k - 1];
+    }
+    values[k] = value;
+    ids[k] = i;
+  }
+
+  const float pre_score = pre_scores[row];
+  int head = 0;
+  for (int k = 0; k < beam_size; ++k) {
+    float best_value = head < beam_size ? values[head] : -INFINITY;
+    int64_t best_id = head < beam_size ? ids[head] : kNoToken;
+    BlockArgMax(&best_value, &best_id);
+    if (best_id != kNoToken &&
+        threadIdx.x == static_cast<int>(best_id % blockDim.x)) {
+      ++head;
+    }
+    if (threadIdx.x == 0) {
+      row_scores[k] = best_id == kNoToken
+                          ? -INFINITY
+                          : pre_score + best_value - log_sum_exp;
+      row_ids[k] = best_id == kNoToken ? end_id : best_id;
+    }
+  }
+}
+
+__device__ __forceinline__ float LengthPenalty(int64_t length, float alpha) {
+  return alpha == 0.f ? 1.f : __powf((5.f + length) / 6.f, alpha);
+}
+
+// The beam_size best of the beam_size * beam_size candidates of a batch by
+// their scores divided by the length penalty. A thread runs a batch.
+template <int MaxBeam>
+__global__ void BeamSearchSelectKernel(const float* cand_scores,
+                                       const int64_t* cand_ids,
+                                       const bool* pre_finished,
+                                       const int64_t* pre_lengths,
+                                       int64_t batch,
+                                       int beam_size,
+                                       int64_t end_id,
+                                       float length_penalty,
+                                       int64_t* selected_ids,
+                                       float* selected_scores,
+                                       bool* finished,
+                                       int64_t* lengths,
+                                       int64_t* parent_idx,
+                                       int64_t* cache_indices) {
+  CUDA_KERNEL_LOOP_TYPE(b, batch, int64_t) {
+    const int num_cands = beam_size * beam_size;
+    const float* scores = cand_scores + b * num_cands;
+    const int64_t* ids = cand_ids + b * num_cands;
+    float normalized[MaxBeam * MaxBeam];
+    bool taken[MaxBeam * MaxBeam];
+    for (int c = 0; c < num_cands; ++c) {
+      const int64_t row = b * beam_size + c / beam_size;
+      const int64_t length = pre_lengths[row] + (pre_finished[row] ? 0 : 1);
+      normalized[c] = scores[c] / LengthPenalty(length, length_penalty);
+      taken[c] = false;
+    }
+    for (int k = 0; k < beam_size; ++k) {
+      int best = -1;
+      for (int c = 0; c < num_cands; ++c) {
+        if (!taken[c] && (best < 0 || normalized[c] > normalized[best])) {
+          best = c;
+        }
+      }
+      taken[best] = true;
+
+      const int64_t parent = best / beam_size;
+      const int64_t row = b * beam_size + parent;
+      const int64_t out = b * beam_size + k;
+      selected_ids[out] = ids[best];
+      selected_scores[out] = scores[best];
+      finished[out] = pre_finished[row] || ids[best] == end_id;
+      lengths[out] = pre_lengths[row] + (pre_finished[row] ? 0 : 1);
+      parent_idx[out] = parent;
+      cache_indices[out] = row;
+    }
+  }
+}
+
+template <typename T, int MaxBeam, typename Context>
+void LaunchBeamSearchStep(const Context& dev_ctx,
+                          const DenseTensor& logits,
+                          const DenseTensor& pre_scores,
+                          const DenseTensor& pre_finished,
+                          const DenseTensor& pre_lengths,
+                          int64_t end_id,
+                          float length_penalty,
+                          DenseTensor* selected_ids,
+                          DenseTensor* selected_scores,
+                          DenseTensor* finished,
+                          DenseTensor* lengths,
+                          DenseTensor* parent_idx,
+                          DenseTensor* cache_indices) {
+  const int64_t batch = logits.dims()[0];
+  const int beam_size = static_cast<int>(logits.dims()[1]);
+  const int64_t vocab = logits.dims()[2];
+  const int64_t rows = batch * beam_size;
+  auto stream = dev_ctx.stream();
+
+  DenseTensor cand_scores = Empty<float>(dev_ctx, {rows, beam_size});
+  DenseTensor cand_ids = Empty<int64_t>(dev_ctx, {rows, beam_size});
+  BeamSearchCandidatesKernel<T, MaxBeam>
+      <<<rows, kBlockSize, 0, stream>>>(logits.data<T>(),
+                                        pre_scores.data<float>(),
+                                        pre_finished.data<bool>(),
+                                        vocab,
+                                        beam_size,
+                                        end_id,
+                                        cand_scores.data<float>(),
+                                        cand_ids.data<int64_t>());
+
+  auto config = backends::gpu::GetGpuLaunchConfig1D(dev_ctx, batch);
+  BeamSearchSelectKernel<MaxBeam>
+      <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+          cand_scores.data<float>(),
+          cand_ids.data<int64_t>(),
+          pre_finished.data<bool>(),
+          pre_lengths.data<int64_t>(),
+          batch,
+          beam_size,
+          end_id,
+          length_penalty,
+          dev_ctx.template Alloc<int64_t>(selected_ids),
+          dev_ctx.template Alloc<float>(selected_scores),
+          dev_ctx.template Alloc<bool>(finished),
+          dev_ctx.template Alloc<int64_t>(lengths),
+          dev_ctx.template Alloc<int64_t>(parent_idx),
+          dev_ctx.template Alloc<int64_t>(cache_indices));
+}
+
+template <typename T, typename Context>
+void FusedBeamSearchStepKernel(const Context& dev_ctx,
+                               const DenseTensor& logits,
+                               const DenseTensor& pre_scores,
+                               const DenseTensor& pre_finished,
+                               const DenseTensor& pre_lengths,
+                               int64_t end_id,
+                               float length_penalty,
+                               DenseTensor* selected_ids,
+                               DenseTensor* selected_scores,
+                               DenseTensor* finished,
+                               DenseTensor* lengths,
+                               DenseTensor* parent_idx,
+                               DenseTensor* cache_indices) {
+  const int64_t beam_size = logits.dims()[1];
+  PADDLE_ENFORCE_EQ(
+      beam_size > 0 && beam_size <= kMaxBeamSize,
+      true,
+      common::errors::InvalidArgument(
+          "The beam size of fused_beam_search_step should be in [1, %d], "
+          "but got %d.",
+          kMaxBeamSize,
+          beam_size));
+  if (logits.numel() == 0) {
+    dev_ctx.template Alloc<int64_t>(selected_ids);
+    dev_ctx.template Alloc<float>(selected_scores);
+    dev_ctx.template Alloc<bool>(finished);
+    dev_ctx.template Alloc<int64_t>(lengths);
+    dev_ctx.template Alloc<int64_t>(parent_idx);
+    dev_ctx.template Alloc<int64_t>(cache_indices);
+    return;
+  }
+
+#define LAUNCH_BEAM_SEARCH_STEP(max_beam)                                 \
+  LaunchBeamSearchStep<T, max_beam>(dev_ctx,                              \
+                                    logits,                               \
+                                    pre_scores,                           \
+                                    pre_finished,                         \
+                                    pre_lengths,                          \
+                                    end_id,                               \
+                                    length_penalty,                       \
+                                    selected_ids,                         \
+                                    selected_scores,                      \
+                                    finished,                             \
+                                    lengths,                              \
+                                    parent_idx,                           \
+                                    cache_indices)
+  if (beam_size <= 4) {
+    LAUNCH_BEAM_SEARCH_STEP(4);
+  } else if (beam_size <= 8) {
+    LAUNCH_BEAM_SEARCH_STEP(8);
+  } else {
+    LAUNCH_BEAM_SEARCH_STEP(kMaxBeamSize);
+  }
+#undef LAUNCH_BEAM_SEARCH_STEP
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_beam_search_step,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedBeamSearchStepKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(1).SetDataType(phi::DataType::FLOAT32);
+  kernel->InputAt(2).SetDataType(phi::DataType::BOOL);
+  kernel->InputAt(3).SetDataType(phi::DataType::INT64);
+  kernel->OutputAt(0).SetDataType(phi::DataType::INT64);
+  kernel->OutputAt(1).SetDataType(phi::DataType::FLOAT32);
+  kernel->OutputAt(2).SetDataType(phi::DataType::BOOL);
+  kernel->OutputAt(3).SetDataType(phi::DataType::INT64);
+  kernel->OutputAt(4).SetDataType(phi::DataType::INT64);
+  kernel->OutputAt(5).SetDataType(phi::DataType::INT64);
+}
@@ -19,6 +19,8 @@
 #include "paddle/phi/kernels/funcs/layer_norm_impl.cu.h"
 #include "paddle/phi/kernels/fusion/gpu/fused_dropout_helper.h"
 
+COMMON_DECLARE_bool(use_device_rng_state_dropout);
+
 namespace phi {
 namespace fusion {
 template <typename T, typename Context>
@@ -80,6 +82,21 @@ void FusedBiasDropoutResidualLnKernel(
       fused_dropout_layernorm_helper(
           dev_ctx, bsz_seq, dim_embed, dropout_param, ln_epsilon);
   // output = layernorm(residual + dropout(input + bias))
+  if (FLAGS_use_device_rng_state_dropout) {
+    fused_dropout_layernorm_helper.LayernormResidualDropoutBiasWithDeviceRng(
+        dev_ctx,
+        x_data,
+        residual_data,
+        bias_data,
+        ln_scale_data,
+        ln_bias_data,
+        bias_dropout_residual_out_data,
+        dropout_mask_out_data,
+        y_data,
+        ln_mean_data,
+        ln_var_data);
+    return;
+  }
   fused_dropout_layernorm_helper.LayernormResidualDropoutBias(
       dev_ctx,
       x_data,
@@ -22,6 +22,7 @@
 
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/device_rng_state.h"
 #include "paddle/phi/kernels/funcs/dropout_impl_util.h"
 #include "paddle/phi/kernels/funcs/functors.h"
 #include "paddle/phi/kernels/fusion/gpu/fused_bias_act_utils.h"
@@ -488,6 +489,111 @@ class FusedDropoutLayerNormHelper
         this->residual_alpha_);
   }
 
+  // out = layernorm(residual + dropout(src + bias)), with the seed and the
+  // offset of the device RNG state of the stream, so it can be captured in
+  // a CUDA graph. The dropout with a fixed seed, or without random numbers,
+  // is the same as LayernormResidualDropoutBias.
+  template <typename P = phi::funcs::LayerNormParamType<T>,
+            bool is_same_type = false>
+  void LayernormResidualDropoutBiasWithDeviceRng(
+      const phi::GPUContext& ctx,
+      const T* src,
+      const T* residual,
+      const T* bias,
+      const P* gamma,
+      const P* beta,
+      T* dropout_out,
+      MaskType* mask,
+      T* out,
+      phi::funcs::LayerNormParamType<T>* mean,
+      phi::funcs::LayerNormParamType<T>* variance) {
+    const auto& param = this->dropout_param_;
+    if (param.fix_seed || param.tensor_seed != nullptr || param.is_test ||
+        param.dropout_prob == 0.0f ||
+        std::abs(param.dropout_prob - 1.0f) < 1e-5) {
+      LayernormResidualDropoutBias<P, is_same_type>(ctx,
+                                                    src,
+                                                    residual,
+                                                    bias,
+                                                    gamma,
+                                                    beta,
+                                                    dropout_out,
+                                                    mask,
+                                                    out,
+                                                    mean,
+                                                    variance);
+      return;
+    }
+    using U = phi::funcs::LayerNormParamType<T>;
+    constexpr int kVecSize = MAX_CACHE_BYTES / sizeof(T);
+    const int vec_size = this->cols_ % kVecSize == 0 ? kVecSize : 1;
+    int threads = phi::funcs::GetDesiredBlockDim(this->cols_ / vec_size);
+    // the numbers a thread draws, in the units of the Philox outputs
+    uint64_t increment =
+        ((this->cols_ - 1) / (threads * vec_size) + 1) * vec_size;
+    increment = (increment + 3) / 4 * 4;
+    auto* rng_state = phi::funcs::GetDeviceRngState(ctx, increment);
+    if (vec_size == kVecSize) {
+      LaunchFusedLayernormResidualDropoutBiasCUDAKernel<T,
+                                                        MaskType,
+                                                        kVecSize,
+                                                        U,
+                                                        is_same_type>(
+          this->rows_,
+          threads,
+          ctx.stream(),
+          this->rows_,
+          this->cols_,
+          0,
+          param.dropout_prob,
+          param.is_upscale_in_train,
+          param.is_test,
+          increment,
+          epsilon_,
+          src,
+          residual,
+          bias,
+          gamma,
+          beta,
+          mask,
+          dropout_out,
+          out,
+          mean,
+          variance,
+          this->residual_alpha_,
+          rng_state);
+    } else {
+      LaunchFusedLayernormResidualDropoutBiasCUDAKernel<T,
+                                                        MaskType,
+                                                        1,
+                                                        U,
+                                                        is_same_type>(
+          this->rows_,
+          threads,
+          ctx.stream(),
+          this->rows_,
+          this->cols_,
+          0,
+          param.dropout_prob,
+          param.is_upscale_in_train,
+          param.is_test,
+          increment,
+          epsilon_,
+          src,
+          residual,
+          bias,
+          gamma,
+          beta,
+          mask,
+          dropout_out,
+          out,
+          mean,
+          variance,
+          this->residual_alpha_,
+          rng_state);
+    }
+  }
+
   template <typename P = phi::funcs::LayerNormParamType<T>,
             bool is_same_type = false>
   void LayernormResidualDropoutBiasGrad(
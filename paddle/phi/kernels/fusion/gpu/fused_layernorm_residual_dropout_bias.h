@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include "glog/logging.h"
 
+#include "paddle/phi/kernels/funcs/device_rng_state.h"
 #include "paddle/phi/kernels/funcs/layer_norm_impl.cu.h"
 #include "paddle/phi/kernels/fusion/gpu/fused_residual_dropout_bias.h"
 
@@ -139,13 +140,20 @@ __global__ void FusedLayernormResidualDropoutBias(
     T *layernorm_dst,
     LayerNormParamType<T> *mean,
     LayerNormParamType<T> *var,
-    const float residual_alpha = 1.0) {
+    const float residual_alpha = 1.0,
+    phi::funcs::DeviceRngState *rng_state = nullptr) {
   int col_id = threadIdx.x;
   int row_id = blockIdx.x;
   int idx = row_id * cols + col_id;
   GPURAND(StatePhilox4_32_10_t) state;
   if (HasDropout) {
-    GPURAND(_init)(seed, idx, increment, &state);
+    uint64_t offset = increment;
+    // with a device state, increment is how many numbers a thread draws
+    if (rng_state != nullptr) {
+      phi::funcs::ReadAndAdvanceDeviceRngState(
+          rng_state, increment, &seed, &offset);
+    }
+    GPURAND(_init)(seed, idx, offset, &state);
   }
 
   T factor =
@@ -247,7 +255,8 @@ void LaunchFusedLayernormResidualDropoutBiasCUDAKernel(
     T *layernorm_dst,
     LayerNormParamType<T> *mean,
     LayerNormParamType<T> *var,
-    const float residual_alpha = 1.0) {
+    const float residual_alpha = 1.0,
+    phi::funcs::DeviceRngState *rng_state = nullptr) {
   if (dropout_prob != 0.0f) {
     FusedLayernormResidualDropoutBias<T,
                                       MaskType,
@@ -273,7 +282,8 @@ void LaunchFusedLayernormResidualDropoutBiasCUDAKernel(
                                              layernorm_dst,
                                              mean,
                                              var,
-                                             residual_alpha);
+                                             residual_alpha,
+                                             rng_state);
   } else {
     FusedLayernormResidualDropoutBias<T,
                                       MaskType,
@@ -0,0 +1,225 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/full_kernel.h"
+#include "paddle/phi/kernels/fusion/gpu/fused_linear_cross_entropy_utils.h"
+
+namespace phi {
+namespace fusion {
+
+// logits = (softmax(logits) - onehot(label)) * loss_grad in place, from the
+// log-sum-exp of the forward. Zero for the ignored rows.
+template <typename T, typename IndexT>
+__global__ void ChunkLogitsGradKernel(const float* lse,
+                                      const float* loss_grad,
+                                      const IndexT* label,
+                                      int64_t ignore_index,
+                                      int64_t rows,
+                                      int64_t chunk,
+                                      int64_t begin,
+                                      T* logits) {
+  CUDA_KERNEL_LOOP_TYPE(i, rows * chunk, int64_t) {
+    const int64_t row = i / chunk;
+    const int64_t real_label = static_cast<int64_t>(label[row]);
+    if (real_label == ignore_index) {
+      logits[i] = static_cast<T>(0);
+      continue;
+    }
+    float grad = __expf(static_cast<float>(logits[i]) - lse[row]);
+    if (real_label - begin == i % chunk) {
+      grad -= 1.f;
+    }
+    logits[i] = static_cast<T>(grad * loss_grad[row]);
+  }
+}
+
+template <typename T>
+__global__ void AccumulateXGradKernel(const T* chunk_grad,
+                                      int64_t numel,
+                                      float* x_grad) {
+  CUDA_KERNEL_LOOP_TYPE(i, numel, int64_t) {
+    x_grad[i] += static_cast<float>(chunk_grad[i]);
+  }
+}
+
+template <typename T>
+__global__ void CastXGradKernel(const float* in, int64_t numel, T* out) {
+  CUDA_KERNEL_LOOP_TYPE(i, numel, int64_t) { out[i] = static_cast<T>(in[i]); }
+}
+
+template <typename T, typename IndexT, typename Context>
+void FusedLinearCrossEntropyGradImpl(const Context& dev_ctx,
+                                     const DenseTensor& x,
+                                     const DenseTensor& weight,
+                                     const DenseTensor& label,
+                                     const DenseTensor& lse,
+                                     const DenseTensor& loss_grad,
+                                     int64_t ignore_index,
+                                     int chunk_size,
+                                     int rank,
+                                     DenseTensor* x_grad,
+                                     DenseTensor* weight_grad) {
+  const auto shape = GetLinearCrossEntropyShape(x, weight, chunk_size);
+  if (x_grad) {
+    dev_ctx.template Alloc<T>(x_grad);
+  }
+  if (weight_grad) {
+    dev_ctx.template Alloc<T>(weight_grad);
+  }
+  if (shape.rows == 0) {
+    if (weight_grad) {
+      Full<T, Context>(
+          dev_ctx, common::vectorize(weight.dims()), 0, weight_grad);
+    }
+    return;
+  }
+  const int64_t rows = shape.rows;
+  const int64_t x_numel = rows * shape.hidden;
+  DenseTensor logits =
+      Empty<T, Context>(dev_ctx, {rows, shape.vocab_chunk});
+  DenseTensor chunk_x_grad;
+  DenseTensor x_grad_fp32;
+  if (x_grad) {
+    chunk_x_grad = Empty<T, Context>(dev_ctx, {rows, shape.hidden});
+    x_grad_fp32 = Full<float, Context>(dev_ctx, {rows, shape.hidden}, 0.f);
+  }
+  const int64_t vocab_begin = static_cast<int64_t>(rank) * shape.vocab;
+  auto blas = funcs::GetBlas<Context, T>(dev_ctx);
+  auto stream = dev_ctx.stream();
+
+  for (int64_t begin = 0; begin < shape.vocab; begin += shape.vocab_chunk) {
+    const int64_t chunk = std::min(shape.vocab_chunk, shape.vocab - begin);
+    // the logits of the chunk are computed again rather than kept
+    LinearCrossEntropyChunkLogits<T>(dev_ctx,
+                                     shape,
+                                     x.data<T>(),
+                                     weight.data<T>(),
+                                     begin,
+                                     chunk,
+                                     logits.data<T>());
+    auto config = backends::gpu::GetGpuLaunchConfig1D(dev_ctx, rows * chunk);
+    ChunkLogitsGradKernel<T, IndexT>
+        <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+            lse.data<float>(),
+            loss_grad.data<float>(),
+            label.data<IndexT>(),
+            ignore_index,
+            rows,
+            chunk,
+            vocab_begin + begin,
+            logits.data<T>());
+
+    if (weight_grad) {
+      // weight_grad[:, begin : begin + chunk] = x^T * logits_grad
+      blas.GEMM(true,
+                false,
+                static_cast<int>(shape.hidden),
+                static_cast<int>(chunk),
+                static_cast<int>(rows),
+                static_cast<T>(1),
+                x.data<T>(),
+                static_cast<int>(shape.hidden),
+                logits.data<T>(),
+                static_cast<int>(chunk),
+                static_cast<T>(0),
+                weight_grad->data<T>() + begin,
+                static_cast<int>(shape.vocab));
+    }
+    if (x_grad) {
+      // x_grad += logits_grad * weight[:, begin : begin + chunk]^T
+      blas.GEMM(false,
+                true,
+                static_cast<int>(rows),
+                static_cast<int>(shape.hidden),
+                static_cast<int>(chunk),
+                static_cast<T>(1),
+                logits.data<T>(),
+                static_cast<int>(chunk),
+                weight.data<T>() + begin,
+                static_cast<int>(shape.vocab),
+                static_cast<T>(0),
+                chunk_x_grad.data<T>(),
+                static_cast<int>(shape.hidden));
+      auto x_config = backends::gpu::GetGpuLaunchConfig1D(dev_ctx, x_numel);
+      AccumulateXGradKernel<T>
+          <<<x_config.block_per_grid, x_config.thread_per_block, 0, stream>>>(
+              chunk_x_grad.data<T>(), x_numel, x_grad_fp32.data<float>());
+    }
+  }
+
+  if (x_grad) {
+    auto x_config = backends::gpu::GetGpuLaunchConfig1D(dev_ctx, x_numel);
+    CastXGradKernel<T>
+        <<<x_config.block_per_grid, x_config.thread_per_block, 0, stream>>>(
+            x_grad_fp32.data<float>(), x_numel, x_grad->data<T>());
+  }
+}
+
+template <typename T, typename Context>
+void FusedLinearCrossEntropyGradKernel(const Context& dev_ctx,
+                                       const DenseTensor& x,
+                                       const DenseTensor& weight,
+                                       const DenseTensor& label,
+                                       const DenseTensor& lse,
+                                       const DenseTensor& loss_grad,
+                                       int64_t ignore_index,
+                                       int chunk_size,
+                                       int ring_id UNUSED,
+                                       int rank,
+                                       int nranks UNUSED,
+                                       DenseTensor* x_grad,
+                                       DenseTensor* weight_grad) {
+  if (label.dtype() == DataType::INT32) {
+    FusedLinearCrossEntropyGradImpl<T, int32_t>(dev_ctx,
+                                                x,
+                                                weight,
+                                                label,
+                                                lse,
+                                                loss_grad,
+                                                ignore_index,
+                                                chunk_size,
+                                                rank,
+                                                x_grad,
+                                                weight_grad);
+  } else {
+    FusedLinearCrossEntropyGradImpl<T, int64_t>(dev_ctx,
+                                                x,
+                                                weight,
+                                                label,
+                                                lse,
+                                                loss_grad,
+                                                ignore_index,
+                                                chunk_size,
+                                                rank,
+                                                x_grad,
+                                                weight_grad);
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_linear_cross_entropy_grad,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedLinearCrossEntropyGradKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
@@ -0,0 +1,248 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cfloat>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/funcs/math_cuda_utils.h"
+#include "paddle/phi/kernels/fusion/gpu/fused_linear_cross_entropy_utils.h"
+
+namespace phi {
+namespace fusion {
+
+// Merges the logits of a vocab chunk into the running max and sum of exp of
+// each row, and takes the logit of the label if it is in the chunk. A block
+// runs a row.
+template <typename T, typename IndexT>
+__global__ void OnlineLogSumExpKernel(const T* logits,
+                                      const IndexT* label,
+                                      int64_t chunk,
+                                      int64_t begin,
+                                      bool first_chunk,
+                                      float* row_max,
+                                      float* row_sum,
+                                      float* target) {
+  const int64_t row = blockIdx.x;
+  const T* row_logits = logits + row * chunk;
+  float max_value = -FLT_MAX;
+  for (int64_t i = threadIdx.x; i < chunk; i += blockDim.x) {
+    max_value = max(max_value, static_cast<float>(row_logits[i]));
+  }
+  max_value = funcs::BlockReduceMax<float>(max_value, FINAL_MASK);
+  __syncthreads();
+  float sum_value = 0.f;
+  for (int64_t i = threadIdx.x; i < chunk; i += blockDim.x) {
+    sum_value += __expf(static_cast<float>(row_logits[i]) - max_value);
+  }
+  sum_value = funcs::BlockReduceSum<float>(sum_value, FINAL_MASK);
+
+  if (threadIdx.x == 0) {
+    if (first_chunk) {
+      row_max[row] = max_value;
+      row_sum[row] = sum_value;
+      target[row] = 0.f;
+    } else {
+      const float old_max = row_max[row];
+      const float new_max = max(old_max, max_value);
+      row_sum[row] = row_sum[row] * __expf(old_max - new_max) +
+                     sum_value * __expf(max_value - new_max);
+      row_max[row] = new_max;
+    }
+    const int64_t index = static_cast<int64_t>(label[row]) - begin;
+    if (index >= 0 && index < chunk) {
+      target[row] = static_cast<float>(row_logits[index]);
+    }
+  }
+}
+
+// Rescales the sums of exp of this rank to the max of all the ranks.
+__global__ void RescaleRowSumKernel(const float* local_max,
+                                    const float* global_max,
+                                    int64_t rows,
+                                    float* row_sum) {
+  CUDA_KERNEL_LOOP_TYPE(i, rows, int64_t) {
+    row_sum[i] *= __expf(local_max[i] - global_max[i]);
+  }
+}
+
+template <typename IndexT>
+__global__ void LinearCrossEntropyLossKernel(const float* row_max,
+                                             const float* row_sum,
+                                             const float* target,
+                                             const IndexT* label,
+                                             int64_t ignore_index,
+                                             int64_t num_classes,
+                                             int64_t rows,
+                                             float* lse,
+                                             float* loss) {
+  CUDA_KERNEL_LOOP_TYPE(i, rows, int64_t) {
+    const int64_t real_label = static_cast<int64_t>(label[i]);
+    PADDLE_ENFORCE((real_label >= 0 && real_label < num_classes) ||
+                       real_label == ignore_index,
+                   "The label of fused_linear_cross_entropy should be in "
+                   "[0, %ld) or equal to ignore_index %ld, but got %ld",
+                   num_classes,
+                   ignore_index,
+                   real_label);
+    lse[i] = row_max[i] + __logf(row_sum[i]);
+    loss[i] = real_label == ignore_index ? 0.f : lse[i] - target[i];
+  }
+}
+
+template <typename T, typename IndexT, typename Context>
+void FusedLinearCrossEntropyImpl(const Context& dev_ctx,
+                                 const DenseTensor& x,
+                                 const DenseTensor& weight,
+                                 const DenseTensor& label,
+                                 int64_t ignore_index,
+                                 int chunk_size,
+                                 int ring_id,
+                                 int rank,
+                                 int nranks,
+                                 DenseTensor* loss,
+                                 DenseTensor* lse) {
+  const auto shape = GetLinearCrossEntropyShape(x, weight, chunk_size);
+  float* loss_data = dev_ctx.template Alloc<float>(loss);
+  float* lse_data = dev_ctx.template Alloc<float>(lse);
+  if (shape.rows == 0) {
+    return;
+  }
+  const int64_t rows = shape.rows;
+  DenseTensor row_max = Empty<float, Context>(dev_ctx, {rows});
+  DenseTensor row_sum = Empty<float, Context>(dev_ctx, {rows});
+  DenseTensor target = Empty<float, Context>(dev_ctx, {rows});
+  DenseTensor logits =
+      Empty<T, Context>(dev_ctx, {rows, shape.vocab_chunk});
+  const int64_t vocab_begin = static_cast<int64_t>(rank) * shape.vocab;
+  const IndexT* label_data = label.data<IndexT>();
+  auto stream = dev_ctx.stream();
+
+  for (int64_t begin = 0; begin < shape.vocab; begin += shape.vocab_chunk) {
+    const int64_t chunk = std::min(shape.vocab_chunk, shape.vocab - begin);
+    LinearCrossEntropyChunkLogits<T>(dev_ctx,
+                                     shape,
+                                     x.data<T>(),
+                                     weight.data<T>(),
+                                     begin,
+                                     chunk,
+                                     logits.data<T>());
+    OnlineLogSumExpKernel<T, IndexT>
+        <<<rows, kLinearCrossEntropyThreads, 0, stream>>>(
+            logits.data<T>(),
+            label_data,
+            chunk,
+            vocab_begin + begin,
+            begin == 0,
+            row_max.data<float>(),
+            row_sum.data<float>(),
+            target.data<float>());
+  }
+
+  auto config = backends::gpu::GetGpuLaunchConfig1D(dev_ctx, rows);
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+  auto* comm_ctx = GetVocabParallelCommContext(ring_id, nranks);
+  if (comm_ctx) {
+    // the log-sum-exp over the whole vocab, from the max and the sum of exp
+    // of each rank, and the target logit of the rank owning the label
+    DenseTensor global_max = Empty<float, Context>(dev_ctx, {rows});
+    comm_ctx->AllReduce(&global_max, row_max, ncclMax, stream);
+    RescaleRowSumKernel<<<config.block_per_grid,
+                          config.thread_per_block,
+                          0,
+                          stream>>>(row_max.data<float>(),
+                                    global_max.data<float>(),
+                                    rows,
+                                    row_sum.data<float>());
+    comm_ctx->AllReduce(&row_sum, row_sum, ncclSum, stream);
+    comm_ctx->AllReduce(&target, target, ncclSum, stream);
+    row_max = global_max;
+  }
+#else
+  PADDLE_ENFORCE_LE(nranks,
+                    1,
+                    common::errors::Unavailable(
+                        "fused_linear_cross_entropy of several ranks needs "
+                        "PaddlePaddle compiled with NCCL or RCCL."));
+#endif
+
+  LinearCrossEntropyLossKernel<IndexT>
+      <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+          row_max.data<float>(),
+          row_sum.data<float>(),
+          target.data<float>(),
+          label_data,
+          ignore_index,
+          shape.vocab * std::max(nranks, 1),
+          rows,
+          lse_data,
+          loss_data);
+}
+
+template <typename T, typename Context>
+void FusedLinearCrossEntropyKernel(const Context& dev_ctx,
+                                   const DenseTensor& x,
+                                   const DenseTensor& weight,
+                                   const DenseTensor& label,
+                                   int64_t ignore_index,
+                                   int chunk_size,
+                                   int ring_id,
+                                   int rank,
+                                   int nranks,
+                                   DenseTensor* loss,
+                                   DenseTensor* lse) {
+  if (label.dtype() == DataType::INT32) {
+    FusedLinearCrossEntropyImpl<T, int32_t>(dev_ctx,
+                                            x,
+                                            weight,
+                                            label,
+                                            ignore_index,
+                                            chunk_size,
+                                            ring_id,
+                                            rank,
+                                            nranks,
+                                            loss,
+                                            lse);
+  } else {
+    FusedLinearCrossEntropyImpl<T, int64_t>(dev_ctx,
+                                            x,
+                                            weight,
+                                            label,
+                                            ignore_index,
+                                            chunk_size,
+                                            ring_id,
+                                            rank,
+                                            nranks,
+                                            loss,
+                                            lse);
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_linear_cross_entropy,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedLinearCrossEntropyKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::FLOAT32);
+  kernel->OutputAt(1).SetDataType(phi::DataType::FLOAT32);
+}
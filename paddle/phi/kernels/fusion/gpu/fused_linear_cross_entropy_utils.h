@@ -0,0 +1,103 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+#include "paddle/phi/core/distributed/comm_context_manager.h"
+#include "paddle/phi/core/distributed/nccl_comm_context.h"
+#endif
+
+namespace phi {
+namespace fusion {
+
+// The logits of x [rows, hidden] and weight [hidden, vocab] are computed
+// vocab_chunk columns at a time, so that only a [rows, vocab_chunk] block of
+// them is kept.
+static constexpr int kLinearCrossEntropyThreads = 256;
+
+struct LinearCrossEntropyShape {
+  int64_t rows;
+  int64_t hidden;
+  // the columns of weight on this rank
+  int64_t vocab;
+  int64_t vocab_chunk;
+};
+
+inline LinearCrossEntropyShape GetLinearCrossEntropyShape(
+    const DenseTensor& x, const DenseTensor& weight, int chunk_size) {
+  LinearCrossEntropyShape shape;
+  shape.hidden = x.dims()[x.dims().size() - 1];
+  shape.rows = shape.hidden == 0 ? 0 : x.numel() / shape.hidden;
+  shape.vocab = weight.dims()[1];
+  shape.vocab_chunk =
+      chunk_size > 0 ? std::min<int64_t>(chunk_size, shape.vocab) : shape.vocab;
+  return shape;
+}
+
+// logits[rows, chunk] = x * weight[:, begin : begin + chunk]
+template <typename T, typename Context>
+void LinearCrossEntropyChunkLogits(const Context& dev_ctx,
+                                   const LinearCrossEntropyShape& shape,
+                                   const T* x,
+                                   const T* weight,
+                                   int64_t begin,
+                                   int64_t chunk,
+                                   T* logits) {
+  auto blas = funcs::GetBlas<Context, T>(dev_ctx);
+  blas.GEMM(false,
+            false,
+            static_cast<int>(shape.rows),
+            static_cast<int>(chunk),
+            static_cast<int>(shape.hidden),
+            static_cast<T>(1),
+            x,
+            static_cast<int>(shape.hidden),
+            weight + begin,
+            static_cast<int>(shape.vocab),
+            static_cast<T>(0),
+            logits,
+            static_cast<int>(chunk));
+}
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+// The communicator of the ranks sharing the vocab, nullptr if nranks is 1.
+inline distributed::NCCLCommContext* GetVocabParallelCommContext(int ring_id,
+                                                                 int nranks) {
+  if (nranks <= 1) {
+    return nullptr;
+  }
+  const auto& comm_context_manager =
+      distributed::CommContextManager::GetInstance();
+  PADDLE_ENFORCE_EQ(comm_context_manager.Has(std::to_string(ring_id)),
+                    true,
+                    common::errors::InvalidArgument(
+                        "The ring_id (%d) of fused_linear_cross_entropy is "
+                        "not found in the comm_context_manager.",
+                        ring_id));
+  return static_cast<distributed::NCCLCommContext*>(
+      comm_context_manager.Get(std::to_string(ring_id)));
+}
+#endif
+
+}  // namespace fusion
+}  // namespace phi
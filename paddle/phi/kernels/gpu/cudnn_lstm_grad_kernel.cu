@@ -122,23 +122,22 @@ void CudnnLSTMGradKernel(
   size_t workspace_size;
   size_t reserve_size;
 
-  ScopedRNNBase rnn(seq_length,
-                    batch_size,
-                    input_size,
-                    hidden_size,
-                    num_layers,
-                    dropout_prob,
-                    seed,
-                    weight_numel,
-                    true,
-                    is_bidirec);
-
-  rnn.Create<T>(handle,
-                ctx.GetPlace(),
-                SequenceLength,
-                &workspace_size,
-                &reserve_size,
-                const_cast<phi::DenseTensor *>(&state_out));
+  // the descriptors of the forward with the same dropout state are reused
+  ScopedRNNBase &rnn =
+      *GetCachedRNN<T>(handle,
+                       ctx.GetPlace(),
+                       seq_length,
+                       batch_size,
+                       input_size,
+                       hidden_size,
+                       num_layers,
+                       dropout_prob,
+                       weight_numel,
+                       is_bidirec,
+                       SequenceLength,
+                       const_cast<phi::DenseTensor *>(&state_out),
+                       &workspace_size,
+                       &reserve_size);
 
   phi::DenseTensor workspace_data_;
   workspace_data_.Resize({static_cast<int64_t>(workspace_size)});
@@ -253,22 +253,44 @@ void CudnnLSTMKernel(
     w_data = const_cast<T *>(running_w->data<T>());
   }
 
-  ScopedRNNBase rnn(seq_length,
-                    batch_size,
-                    input_size,
-                    hidden_size,
-                    num_layers,
-                    dropout_prob,
-                    seed,
-                    weight_numel,
-                    state_initialized,
-                    is_bidirec);
-  rnn.Create<T>(handle,
-                ctx.GetPlace(),
-                SequenceLength,
-                &workspace_size,
-                &reserve_size,
-                state_out);
+  // the dropout state is initialized by the descriptors of the first call
+  std::unique_ptr<ScopedRNNBase> uncached_rnn;
+  ScopedRNNBase *rnn_ptr = nullptr;
+  if (state_initialized) {
+    rnn_ptr = GetCachedRNN<T>(handle,
+                              ctx.GetPlace(),
+                              seq_length,
+                              batch_size,
+                              input_size,
+                              hidden_size,
+                              num_layers,
+                              dropout_prob,
+                              weight_numel,
+                              is_bidirec,
+                              SequenceLength,
+                              state_out,
+                              &workspace_size,
+                              &reserve_size);
+  } else {
+    uncached_rnn = std::make_unique<ScopedRNNBase>(seq_length,
+                                                   batch_size,
+                                                   input_size,
+                                                   hidden_size,
+                                                   num_layers,
+                                                   dropout_prob,
+                                                   seed,
+                                                   weight_numel,
+                                                   state_initialized,
+                                                   is_bidirec);
+    uncached_rnn->Create<T>(handle,
+                            ctx.GetPlace(),
+                            SequenceLength,
+                            &workspace_size,
+                            &reserve_size,
+                            state_out);
+    rnn_ptr = uncached_rnn.get();
+  }
+  ScopedRNNBase &rnn = *rnn_ptr;
 
   phi::DenseTensor workspace_data_;
   workspace_data_.Resize({static_cast<int64_t>(workspace_size)});
@@ -281,7 +303,7 @@ void CudnnLSTMKernel(
     LSTMInferece<T>(has_seq_length,
                     handle,
                     seq_length,
-                    &rnn,
+                    rnn_ptr,
                     x_data,
                     init_h_data,
                     init_c_data,
@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <cstring>
+#include <map>
+#include <memory>
 #include <vector>
 
 #include "paddle/phi/common/memory_utils.h"
@@ -73,4 +76,82 @@ inline void weight_to_tensor(
   }
 }
 
+// The descriptors of cudnn_lstm created by a thread, reused by the forward
+// and the backward calls with the same shapes, sequence lengths and dropout
+// state instead of being set again for every batch.
+struct CachedRNN {
+  std::unique_ptr<ScopedRNNBase> rnn;
+  size_t workspace_size;
+  size_t reserve_size;
+};
+
+// Only the initialized dropout states are cached, whose descriptors are
+// restored from the state and do not depend on the seed.
+template <typename T, typename HandleT>
+ScopedRNNBase *GetCachedRNN(const HandleT &handle,
+                            const phi::Place &place,
+                            int seq_length,
+                            int batch_size,
+                            int input_size,
+                            int hidden_size,
+                            int num_layers,
+                            float dropout_prob,
+                            int weight_numel,
+                            bool is_bidirec,
+                            const std::vector<int> &sequence_length,
+                            phi::DenseTensor *dropout_state,
+                            size_t *workspace_size,
+                            size_t *reserve_size) {
+  constexpr size_t kMaxCachedRNNs = 16;
+  thread_local std::map<std::vector<int64_t>, CachedRNN> cached_rnns;
+
+  int dropout_bits = 0;
+  static_assert(sizeof(dropout_bits) == sizeof(dropout_prob),
+                "The bits of dropout_prob are a key of the descriptors");
+  memcpy(&dropout_bits, &dropout_prob, sizeof(dropout_prob));
+  std::vector<int64_t> key{
+      reinterpret_cast<int64_t>(handle),
+      static_cast<int64_t>(place.GetDeviceId()),
+      static_cast<int64_t>(sizeof(T)),
+      seq_length,
+      batch_size,
+      input_size,
+      hidden_size,
+      num_layers,
+      dropout_bits,
+      weight_numel,
+      is_bidirec,
+      reinterpret_cast<int64_t>(dropout_state->data<uint8_t>()),
+      dropout_state->numel()};
+  key.insert(key.end(), sequence_length.begin(), sequence_length.end());
+
+  auto it = cached_rnns.find(key);
+  if (it == cached_rnns.end()) {
+    if (cached_rnns.size() >= kMaxCachedRNNs) {
+      cached_rnns.clear();
+    }
+    CachedRNN cached;
+    cached.rnn = std::make_unique<ScopedRNNBase>(seq_length,
+                                                 batch_size,
+                                                 input_size,
+                                                 hidden_size,
+                                                 num_layers,
+                                                 dropout_prob,
+                                                 0,
+                                                 weight_numel,
+                                                 true,
+                                                 is_bidirec);
+    cached.rnn->Create<T>(handle,
+                          place,
+                          sequence_length,
+                          &cached.workspace_size,
+                          &cached.reserve_size,
+                          dropout_state);
+    it = cached_rnns.emplace(std::move(key), std::move(cached)).first;
+  }
+  *workspace_size = it->second.workspace_size;
+  *reserve_size = it->second.reserve_size;
+  return it->second.rnn.get();
+}
+
 }  // namespace phi
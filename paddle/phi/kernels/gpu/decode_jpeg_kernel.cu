@@ -16,6 +16,9 @@
 
 #include "paddle/phi/kernels/decode_jpeg_kernel.h"
 
+#include <mutex>
+#include <vector>
+
 #include "paddle/phi/backends/dynload/nvjpeg.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/backends/stream.h"
@@ -23,52 +26,72 @@
 
 namespace phi {
 
-static cudaStream_t nvjpeg_stream = nullptr;
-static nvjpegHandle_t nvjpeg_handle = nullptr;
-
-void InitNvjpegImage(nvjpegImage_t* img) {
-  for (int c = 0; c < NVJPEG_MAX_COMPONENT; c++) {
-    img->channel[c] = nullptr;
-    img->pitch[c] = 0;
-  }
-}
-
-template <typename T, typename Context>
-void DecodeJpegKernel(const Context& dev_ctx,
-                      const DenseTensor& x,
-                      const std::string& mode,
-                      DenseTensor* out) {
-  // Create nvJPEG handle
-  if (nvjpeg_handle == nullptr) {
+static nvjpegHandle_t GetNvjpegHandle() {
+  static nvjpegHandle_t nvjpeg_handle = nullptr;
+  static std::once_flag nvjpeg_handle_flag;
+  std::call_once(nvjpeg_handle_flag, []() {
     nvjpegStatus_t create_status =
         phi::dynload::nvjpegCreateSimple(&nvjpeg_handle);
-
     PADDLE_ENFORCE_EQ(
         create_status,
         NVJPEG_STATUS_SUCCESS,
         errors::Fatal("nvjpegCreateSimple failed: ", create_status));
+  });
+  return nvjpeg_handle;
+}
+
+// The decoding states are kept by the threads from call to call, a state
+// allocating its buffers for the sizes of the images it decodes.
+class NvjpegState {
+ public:
+  ~NvjpegState() {
+    if (state_ != nullptr) {
+      phi::dynload::nvjpegJpegStateDestroy(state_);
+    }
+  }
+
+  nvjpegJpegState_t Get() {
+    if (state_ == nullptr) {
+      nvjpegStatus_t state_status =
+          phi::dynload::nvjpegJpegStateCreate(GetNvjpegHandle(), &state_);
+      PADDLE_ENFORCE_EQ(
+          state_status,
+          NVJPEG_STATUS_SUCCESS,
+          errors::Fatal("nvjpegJpegStateCreate failed: ", state_status));
+    }
+    return state_;
   }
 
-  nvjpegJpegState_t nvjpeg_state;
-  nvjpegStatus_t state_status =
-      phi::dynload::nvjpegJpegStateCreate(nvjpeg_handle, &nvjpeg_state);
+ private:
+  nvjpegJpegState_t state_ = nullptr;
+};
 
-  PADDLE_ENFORCE_EQ(
-      state_status,
-      NVJPEG_STATUS_SUCCESS,
-      errors::Fatal("nvjpegJpegStateCreate failed: ", state_status));
+void InitNvjpegImage(nvjpegImage_t* img) {
+  for (int c = 0; c < NVJPEG_MAX_COMPONENT; c++) {
+    img->channel[c] = nullptr;
+    img->pitch[c] = 0;
+  }
+}
 
+// Gets the size of the image in data, allocates out for it and sets image to
+// decode into out.
+template <typename T, typename Context>
+void PrepareNvjpegImage(const Context& dev_ctx,
+                        const unsigned char* data,
+                        size_t length,
+                        const std::string& mode,
+                        DenseTensor* out,
+                        nvjpegOutputFormat_t* output_format,
+                        nvjpegImage_t* image) {
   int components;
   nvjpegChromaSubsampling_t subsampling;
   int widths[NVJPEG_MAX_COMPONENT];
   int heights[NVJPEG_MAX_COMPONENT];
 
-  auto* x_data = x.data<T>();
-
   nvjpegStatus_t info_status =
-      phi::dynload::nvjpegGetImageInfo(nvjpeg_handle,
-                                       x_data,
-                                       (std::size_t)x.numel(),
+      phi::dynload::nvjpegGetImageInfo(GetNvjpegHandle(),
+                                       data,
+                                       length,
                                        &components,
                                        &subsampling,
                                        widths,
@@ -80,60 +103,149 @@ void DecodeJpegKernel(const Context& dev_ctx,
   int width = widths[0];
   int height = heights[0];
 
-  nvjpegOutputFormat_t output_format;
   int output_components;
 
   if (mode == "unchanged") {
     if (components == 1) {
-      output_format = NVJPEG_OUTPUT_Y;
+      *output_format = NVJPEG_OUTPUT_Y;
       output_components = 1;
     } else if (components == 3) {
-      output_format = NVJPEG_OUTPUT_RGB;
+      *output_format = NVJPEG_OUTPUT_RGB;
       output_components = 3;
     } else {
-      phi::dynload::nvjpegJpegStateDestroy(nvjpeg_state);
       PADDLE_THROW(errors::Fatal(
           "The provided mode is not supported for JPEG files on GPU"));
     }
   } else if (mode == "gray") {
-    output_format = NVJPEG_OUTPUT_Y;
+    *output_format = NVJPEG_OUTPUT_Y;
     output_components = 1;
   } else if (mode == "rgb") {
-    output_format = NVJPEG_OUTPUT_RGB;
+    *output_format = NVJPEG_OUTPUT_RGB;
     output_components = 3;
   } else {
-    phi::dynload::nvjpegJpegStateDestroy(nvjpeg_state);
     PADDLE_THROW(errors::Fatal(
         "The provided mode is not supported for JPEG files on GPU"));
   }
 
-  nvjpegImage_t out_image;
-  InitNvjpegImage(&out_image);
-
-  // create nvjpeg stream
-  if (nvjpeg_stream == nullptr) {
-    cudaStreamCreateWithFlags(&nvjpeg_stream, cudaStreamNonBlocking);
-  }
+  InitNvjpegImage(image);
 
-  int sz = widths[0] * heights[0];
+  int sz = width * height;
 
   std::vector<int64_t> out_shape = {output_components, height, width};
   out->Resize(common::make_ddim(out_shape));
 
-  T* data = dev_ctx.template Alloc<T>(out);
+  T* out_data = dev_ctx.template Alloc<T>(out);
 
   for (int c = 0; c < output_components; c++) {
-    out_image.channel[c] = data + c * sz;
-    out_image.pitch[c] = width;
+    image->channel[c] = out_data + c * sz;
+    image->pitch[c] = width;
   }
+}
 
-  nvjpegStatus_t decode_status = phi::dynload::nvjpegDecode(nvjpeg_handle,
-                                                            nvjpeg_state,
-                                                            x_data,
-                                                            x.numel(),
-                                                            output_format,
-                                                            &out_image,
-                                                            nvjpeg_stream);
+template <typename T, typename Context>
+void DecodeJpegKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      const std::string& mode,
+                      DenseTensor* out) {
+  thread_local NvjpegState nvjpeg_state;
+
+  auto* x_data = x.data<T>();
+  nvjpegOutputFormat_t output_format;
+  nvjpegImage_t out_image;
+  PrepareNvjpegImage<T>(dev_ctx,
+                        x_data,
+                        static_cast<size_t>(x.numel()),
+                        mode,
+                        out,
+                        &output_format,
+                        &out_image);
+
+  // decode on the stream of the context, for the kernels using out
+  nvjpegStatus_t decode_status =
+      phi::dynload::nvjpegDecode(GetNvjpegHandle(),
+                                 nvjpeg_state.Get(),
+                                 x_data,
+                                 x.numel(),
+                                 output_format,
+                                 &out_image,
+                                 dev_ctx.stream());
+  PADDLE_ENFORCE_EQ(decode_status,
+                    NVJPEG_STATUS_SUCCESS,
+                    errors::Fatal("nvjpegDecode failed: ", decode_status));
+}
+
+template <typename T, typename Context>
+void DecodeJpegBatchKernel(const Context& dev_ctx,
+                           const std::vector<const DenseTensor*>& x,
+                           const std::string& mode,
+                           std::vector<DenseTensor*> out) {
+  thread_local NvjpegState nvjpeg_state;
+  thread_local NvjpegState nvjpeg_batched_state;
+
+  size_t batch_size = x.size();
+  std::vector<const unsigned char*> data(batch_size);
+  std::vector<size_t> lengths(batch_size);
+  std::vector<nvjpegOutputFormat_t> output_formats(batch_size);
+  std::vector<nvjpegImage_t> out_images(batch_size);
+  bool same_format = true;
+  for (size_t i = 0; i < batch_size; ++i) {
+    data[i] = x[i]->data<T>();
+    lengths[i] = static_cast<size_t>(x[i]->numel());
+    PrepareNvjpegImage<T>(dev_ctx,
+                          data[i],
+                          lengths[i],
+                          mode,
+                          out[i],
+                          &output_formats[i],
+                          &out_images[i]);
+    same_format = same_format && output_formats[i] == output_formats[0];
+  }
+  if (batch_size == 0) {
+    return;
+  }
+
+  if (batch_size > 1 && same_format) {
+    // the huffman decoding of the images is done by the cpu threads of
+    // nvjpeg, and the idct of all the images by the same kernels
+    nvjpegStatus_t init_status = phi::dynload::nvjpegDecodeBatchedInitialize(
+        GetNvjpegHandle(),
+        nvjpeg_batched_state.Get(),
+        static_cast<int>(batch_size),
+        1,
+        output_formats[0]);
+    PADDLE_ENFORCE_EQ(
+        init_status,
+        NVJPEG_STATUS_SUCCESS,
+        errors::Fatal("nvjpegDecodeBatchedInitialize failed: ", init_status));
+    nvjpegStatus_t decode_status =
+        phi::dynload::nvjpegDecodeBatched(GetNvjpegHandle(),
+                                          nvjpeg_batched_state.Get(),
+                                          data.data(),
+                                          lengths.data(),
+                                          out_images.data(),
+                                          dev_ctx.stream());
+    PADDLE_ENFORCE_EQ(
+        decode_status,
+        NVJPEG_STATUS_SUCCESS,
+        errors::Fatal("nvjpegDecodeBatched failed: ", decode_status));
+    return;
+  }
+
+  // the batched decoding needs a single output format, which the images of
+  // different components do not have in the unchanged mode
+  for (size_t i = 0; i < batch_size; ++i) {
+    nvjpegStatus_t decode_status =
+        phi::dynload::nvjpegDecode(GetNvjpegHandle(),
+                                   nvjpeg_state.Get(),
+                                   data[i],
+                                   lengths[i],
+                                   output_formats[i],
+                                   &out_images[i],
+                                   dev_ctx.stream());
+    PADDLE_ENFORCE_EQ(decode_status,
+                      NVJPEG_STATUS_SUCCESS,
+                      errors::Fatal("nvjpegDecode failed: ", decode_status));
+  }
 }
 }  // namespace phi
 
@@ -145,4 +257,12 @@ PD_REGISTER_KERNEL(decode_jpeg,  // cuda_only
   kernel->InputAt(0).SetBackend(phi::Backend::ALL_BACKEND);
 }
 
+PD_REGISTER_KERNEL(decode_jpeg_batch,  // cuda_only
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::DecodeJpegBatchKernel,
+                   uint8_t) {
+  kernel->InputAt(0).SetBackend(phi::Backend::ALL_BACKEND);
+}
+
 #endif
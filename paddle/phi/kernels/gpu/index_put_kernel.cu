@@ -13,14 +13,45 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/index_put_kernel.h"
+
+#include <thrust/execution_policy.h>
+#include <thrust/functional.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/common/memory_utils.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cast_kernel.h"
 #include "paddle/phi/kernels/funcs/index_put_utils.h"
 
 namespace phi {
 
+__device__ __forceinline__ int64_t
+IndexPutOffset(int64_t** indices,
+               const Array<int64_t, DDim::kMaxRank>& stride,
+               const Array<int64_t, DDim::kMaxRank>& shape,
+               const int rank,
+               const int64_t idx) {
+  int64_t offset = 0;
+#pragma unroll
+  for (int i = 0; i < DDim::kMaxRank; ++i) {
+    if (i >= rank) {
+      break;
+    }
+    int64_t cur_ix = (static_cast<int64_t>(*(indices[i] + idx)));
+    if (cur_ix < 0) {
+      cur_ix += shape[i];
+    }
+    offset += stride[i] * cur_ix;
+  }
+  return offset;
+}
+
 template <typename T>
 __global__ void IndexPutCudaKernel(const T* x,
                                    const T* vals,
@@ -35,31 +66,135 @@ __global__ void IndexPutCudaKernel(const T* x,
   int64_t idx =
       static_cast<int64_t>(threadIdx.x) +
       static_cast<int64_t>(blockDim.x) * static_cast<int64_t>(blockIdx.x);
-  int64_t cur_ix = 0;
 
   if (idx >= numel) {
     return;
   }
-  int64_t offset = 0;
-#pragma unroll
-  for (int i = 0; i < DDim::kMaxRank; ++i) {
-    if (i >= rank) {
-      break;
-    }
-    cur_ix = (static_cast<int64_t>(*(indices[i] + idx)));
-    if (cur_ix < 0) {
-      cur_ix += shape[i];
-    }
-    offset += stride[i] * cur_ix;
-  }
+  int64_t offset = IndexPutOffset(indices, stride, shape, rank, idx);
 
   if (accumulate) {
-    *(out + offset) += *(vals + (idx & is_single_val_tensor));
+    // the values of the same element may be added on several threads
+    phi::CudaAtomicAdd(out + offset, *(vals + (idx & is_single_val_tensor)));
   } else {
     *(out + offset) = *(vals + (idx & is_single_val_tensor));
   }
 }
 
+__global__ void IndexPutOffsetsCudaKernel(
+    int64_t** indices,
+    Array<int64_t, DDim::kMaxRank> stride,
+    Array<int64_t, DDim::kMaxRank> shape,
+    const int rank,
+    const int64_t numel,
+    int64_t* offsets,
+    int64_t* order) {
+  int64_t idx =
+      static_cast<int64_t>(threadIdx.x) +
+      static_cast<int64_t>(blockDim.x) * static_cast<int64_t>(blockIdx.x);
+  if (idx >= numel) {
+    return;
+  }
+  offsets[idx] = IndexPutOffset(indices, stride, shape, rank, idx);
+  order[idx] = idx;
+}
+
+template <typename T, typename MPType>
+struct IndexPutValueFunctor {
+  const T* vals;
+  int64_t is_single_val_tensor;
+
+  __device__ MPType operator()(int64_t idx) const {
+    return static_cast<MPType>(vals[idx & is_single_val_tensor]);
+  }
+};
+
+// Every offset is unique after the reduction, so each element is written by
+// one thread only.
+template <typename T, typename MPType>
+__global__ void IndexPutAddSegmentsCudaKernel(const int64_t* offsets,
+                                              const MPType* sums,
+                                              const int64_t num_segments,
+                                              T* out) {
+  int64_t idx =
+      static_cast<int64_t>(threadIdx.x) +
+      static_cast<int64_t>(blockDim.x) * static_cast<int64_t>(blockIdx.x);
+  if (idx >= num_segments) {
+    return;
+  }
+  T* dst = out + offsets[idx];
+  *dst = static_cast<T>(static_cast<MPType>(*dst) + sums[idx]);
+}
+
+// Sorts the offsets of the values with their positions, reduces the values
+// of each offset in the order of the positions, and adds the sums to out
+// without atomics.
+template <typename T, typename Context>
+void LaunchSortedIndexPutAccumulate(
+    const Context& dev_ctx,
+    const T* val_data,
+    int64_t** pd_indices,
+    const Array<int64_t, DDim::kMaxRank>& stride_array,
+    const Array<int64_t, DDim::kMaxRank>& shape_array,
+    const int rank,
+    const int64_t numel,
+    const int64_t is_single_val_tensor,
+    T* out_data) {
+  using MPType = typename phi::dtype::MPTypeTrait<T>::Type;
+
+  auto offsets_holder = phi::memory_utils::Alloc(
+      dev_ctx.GetPlace(),
+      3 * numel * sizeof(int64_t),
+      phi::Stream(reinterpret_cast<phi::StreamId>(dev_ctx.stream())));
+  auto sums_holder = phi::memory_utils::Alloc(
+      dev_ctx.GetPlace(),
+      numel * sizeof(MPType),
+      phi::Stream(reinterpret_cast<phi::StreamId>(dev_ctx.stream())));
+  int64_t* offsets = reinterpret_cast<int64_t*>(offsets_holder->ptr());
+  int64_t* order = offsets + numel;
+  int64_t* unique_offsets = order + numel;
+  MPType* sums = reinterpret_cast<MPType*>(sums_holder->ptr());
+
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, numel);
+  IndexPutOffsetsCudaKernel<<<config.block_per_grid,
+                              config.thread_per_block,
+                              0,
+                              dev_ctx.stream()>>>(pd_indices,
+                                                  stride_array,
+                                                  shape_array,
+                                                  rank,
+                                                  numel,
+                                                  offsets,
+                                                  order);
+
+#ifdef __HIPCC__
+  const auto& policy = thrust::hip::par.on(dev_ctx.stream());
+#else
+  phi::memory_utils::ThrustAllocator<cudaStream_t> allocator(
+      dev_ctx.GetPlace(), dev_ctx.stream());
+  const auto& policy = thrust::cuda::par(allocator).on(dev_ctx.stream());
+#endif
+  thrust::stable_sort_by_key(policy, offsets, offsets + numel, order);
+  auto values = thrust::make_transform_iterator(
+      order, IndexPutValueFunctor<T, MPType>{val_data, is_single_val_tensor});
+  auto ends = thrust::reduce_by_key(policy,
+                                    offsets,
+                                    offsets + numel,
+                                    values,
+                                    unique_offsets,
+                                    sums,
+                                    thrust::equal_to<int64_t>(),
+                                    thrust::plus<MPType>());
+  const int64_t num_segments = ends.first - unique_offsets;
+
+  auto add_config =
+      phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, num_segments);
+  IndexPutAddSegmentsCudaKernel<T, MPType>
+      <<<add_config.block_per_grid,
+         add_config.thread_per_block,
+         0,
+         dev_ctx.stream()>>>(unique_offsets, sums, num_segments, out_data);
+}
+
 template <typename T, typename Context>
 void LaunchIndexPutCudaKernel(const Context& dev_ctx,
                               const DenseTensor& x,
@@ -93,6 +228,19 @@ void LaunchIndexPutCudaKernel(const Context& dev_ctx,
   auto pd_indices =
       funcs::GetDevicePointerArray<int64_t, Context>(dev_ctx, indices, &holder);
 
+  if (accumulate && funcs::UseSortedIndexPut(numel, x.numel())) {
+    LaunchSortedIndexPutAccumulate<T, Context>(dev_ctx,
+                                               val_data,
+                                               pd_indices,
+                                               stride_array,
+                                               shape_array,
+                                               rank,
+                                               numel,
+                                               is_single_val_tensor,
+                                               out_data);
+    return;
+  }
+
   auto config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, numel);
   IndexPutCudaKernel<T>
       <<<config.block_per_grid, config.thread_per_block, 0, dev_ctx.stream()>>>(
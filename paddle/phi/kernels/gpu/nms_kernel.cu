@@ -21,6 +21,8 @@
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 static const int64_t threadsPerBlock = sizeof(int64_t) * 8;
+// The largest dynamic shared memory of a block without opting in.
+static const size_t kMaxSharedMemPerBlock = 48 * 1024;
 
 namespace phi {
 
@@ -53,6 +55,46 @@ static __global__ void NMS(const T* boxes_data,
   }
 }
 
+// Walks the boxes in order in a block, the threads or'ing the parts of the
+// masks of the kept boxes into the removed ones kept in the shared memory,
+// so only the number of the kept boxes is copied to the host.
+static __global__ void GatherKeepFromMask(const uint64_t* masks,
+                                          int64_t num_boxes,
+                                          int64_t* keep,
+                                          int64_t* num_keep) {
+  extern __shared__ uint64_t removed[];
+  const int64_t blocks_per_line = CeilDivide(num_boxes, threadsPerBlock);
+  for (int64_t i = threadIdx.x; i < blocks_per_line; i += blockDim.x) {
+    removed[i] = 0;
+  }
+  __syncthreads();
+
+  int64_t count = 0;
+  for (int64_t i = 0; i < num_boxes; ++i) {
+    const int64_t removed_element_id = i / threadsPerBlock;
+    const int64_t removed_bit_id = i % threadsPerBlock;
+    const bool is_removed =
+        removed[removed_element_id] & (1ULL << removed_bit_id);
+    // the mask of a box removes the box itself
+    __syncthreads();
+    if (!is_removed) {
+      if (threadIdx.x == 0) {
+        keep[count] = i;
+      }
+      ++count;
+      const uint64_t* current_mask = masks + i * blocks_per_line;
+      for (int64_t j = removed_element_id + threadIdx.x; j < blocks_per_line;
+           j += blockDim.x) {
+        removed[j] |= current_mask[j];
+      }
+      __syncthreads();
+    }
+  }
+  if (threadIdx.x == 0) {
+    *num_keep = count;
+  }
+}
+
 template <typename T, typename Context>
 void NMSKernel(const Context& dev_ctx,
                const DenseTensor& boxes,
@@ -71,6 +113,11 @@ void NMSKernel(const Context& dev_ctx,
                                       boxes.dims()));
 
   const int64_t num_boxes = boxes.dims()[0];
+  if (num_boxes == 0) {
+    output->Resize(common::make_ddim({0}));
+    dev_ctx.template Alloc<int64_t>(output);
+    return;
+  }
   const auto blocks_per_line = CeilDivide(num_boxes, threadsPerBlock);
   dim3 block(threadsPerBlock);
   dim3 grid(blocks_per_line, blocks_per_line);
@@ -81,6 +128,32 @@ void NMSKernel(const Context& dev_ctx,
   uint64_t* mask_dev = reinterpret_cast<uint64_t*>(mask_data->ptr());
   NMS<T><<<grid, block, 0, dev_ctx.stream()>>>(
       boxes.data<T>(), threshold, num_boxes, mask_dev);
+
+  const size_t removed_size = blocks_per_line * sizeof(uint64_t);
+  if (removed_size <= kMaxSharedMemPerBlock) {
+    // the indices are written to the output of all the boxes, then the
+    // output is shrunk to the boxes kept
+    output->Resize(common::make_ddim({num_boxes}));
+    auto* output_data = dev_ctx.template Alloc<int64_t>(output);
+    auto num_keep_data = phi::memory_utils::Alloc(
+        dev_ctx.GetPlace(),
+        sizeof(int64_t),
+        phi::Stream(reinterpret_cast<phi::StreamId>(dev_ctx.stream())));
+    int64_t* num_keep_dev = reinterpret_cast<int64_t*>(num_keep_data->ptr());
+    GatherKeepFromMask<<<1, 1024, removed_size, dev_ctx.stream()>>>(
+        mask_dev, num_boxes, output_data, num_keep_dev);
+    int64_t num_keep = 0;
+    memory_utils::Copy(phi::CPUPlace(),
+                       &num_keep,
+                       dev_ctx.GetPlace(),
+                       num_keep_dev,
+                       sizeof(int64_t),
+                       dev_ctx.stream());
+    dev_ctx.Wait();
+    output->Resize(common::make_ddim({num_keep}));
+    return;
+  }
+
   std::vector<uint64_t> mask_host(num_boxes * blocks_per_line);
   memory_utils::Copy(phi::CPUPlace(),
                      mask_host.data(),
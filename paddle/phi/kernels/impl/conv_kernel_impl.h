@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "paddle/phi/kernels/conv_kernel.h"
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
 #include "paddle/phi/kernels/funcs/im2col.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/funcs/vol2col.h"
@@ -137,6 +140,16 @@ void ConvKernelImpl(const Context& dev_ctx,
   phi::funcs::Im2ColFunctor<phi::funcs::ColFormat::kCFO, Context, T> im2col;
   phi::funcs::Vol2ColFunctor<Context, T> vol2col;
 
+  // The filter packed at the init of the predictor skips the packing of the
+  // GEMM in each call.
+  [[maybe_unused]] const T* packed_filter = nullptr;
+  if constexpr (std::is_same<Context, phi::CPUContext>::value &&
+                phi::funcs::IsGemmPackable<T>()) {
+    if (groups == 1) {
+      packed_filter = phi::funcs::GetPackedGemmWeight<T>(filter_t, true, false);
+    }
+  }
+
   auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
   for (int i = 0; i < batch_size; i++) {
     DenseTensor in_batch =
@@ -166,6 +179,20 @@ void ConvKernelImpl(const Context& dev_ctx,
 
       // gemm
       DenseTensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
+      if constexpr (std::is_same<Context, phi::CPUContext>::value &&
+                    phi::funcs::IsGemmPackable<T>()) {
+        if (packed_filter != nullptr) {
+          phi::funcs::PackedGemm<T>(dev_ctx,
+                                    true,
+                                    out_step,
+                                    static_cast<int>(col_matrix.dims()[1]),
+                                    static_cast<int>(col_matrix.dims()[0]),
+                                    packed_filter,
+                                    col_matrix.data<T>(),
+                                    out_slice.data<T>());
+          continue;
+        }
+      }
       DenseTensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
       blas.MatMul(
           filter_slice, false, col_matrix, false, T(1.0), &out_slice, T(0.0));
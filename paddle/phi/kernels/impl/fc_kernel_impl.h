@@ -15,11 +15,13 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
 #include "paddle/phi/kernels/funcs/fc_functor.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
 
 namespace phi {
 namespace fusion {
@@ -51,6 +53,27 @@ void FCKernel(const Context& dev_ctx,
   const T* w_data = w.data<T>();
   auto* output_data = dev_ctx.template Alloc<T>(out, out->numel() * sizeof(T));
 
+  // The weight packed at the init of the predictor skips the packing of the
+  // GEMM in each call.
+  if constexpr (std::is_same<Context, phi::CPUContext>::value &&
+                phi::funcs::IsGemmPackable<T>()) {
+    const T* packed_w =
+        padding_weights ? nullptr
+                        : phi::funcs::GetPackedGemmWeight<T>(w, false, false);
+    if (packed_w != nullptr) {
+      phi::funcs::PackedFCCompute<T>(dev_ctx,
+                                     M,
+                                     w_dims1,
+                                     w_dims0,
+                                     input_data,
+                                     packed_w,
+                                     output_data,
+                                     bias ? bias->data<T>() : NULL,
+                                     with_relu);
+      return;
+    }
+  }
+
   phi::funcs::FCFunctor<Context, T> fc;
   fc(dev_ctx,
      M,
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #pragma once
 
+#include <climits>
+#include <type_traits>
+
 #include "glog/logging.h"
 
 #include "paddle/phi/common/memory_utils.h"
@@ -27,6 +30,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blaslt_impl.cu.h"
 #endif
 #include "paddle/phi/kernels/funcs/complex_functors.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
 #include "paddle/phi/kernels/scale_kernel.h"
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/kernels/funcs/cublaslt.h"
@@ -1996,6 +2000,31 @@ void MatmulKernel(const Context& ctx,
                         "0, but received dims size is 0."));
   const std::vector<std::int64_t> x_dims = common::vectorize(x.dims());
   const std::vector<std::int64_t> y_dims = common::vectorize(y.dims());
+  // The weight y packed at the init of the predictor skips the packing of
+  // the GEMM in each call, with the batch dims of x folded into its rows.
+  if constexpr (std::is_same<Context, phi::CPUContext>::value &&
+                phi::funcs::IsGemmPackable<T>()) {
+    const T* packed_y =
+        transpose_x || x_dims.size() < 2
+            ? nullptr
+            : phi::funcs::GetPackedGemmWeight<T>(y, false, transpose_y);
+    // y is packed only if it is 2-D.
+    const int64_t K = packed_y != nullptr ? x_dims.back() : 1;
+    const int64_t M = x.numel() / K;
+    const int64_t N =
+        packed_y != nullptr ? (transpose_y ? y_dims[0] : y_dims[1]) : 1;
+    if (packed_y != nullptr && M <= INT_MAX && out->numel() == M * N) {
+      phi::funcs::PackedGemm<T>(ctx,
+                                false,
+                                static_cast<int>(M),
+                                static_cast<int>(N),
+                                static_cast<int>(K),
+                                packed_y,
+                                x.data<T>(),
+                                ctx.template Alloc<T>(out));
+      return;
+    }
+  }
   MatmulJudgeDtypeKernel<Context, T>(
       ctx, x, y, x_dims, y_dims, out, transpose_x, transpose_y);
 }
@@ -14,30 +14,291 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/sparse/matmul_kernel.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "paddle/common/ddim.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/meta_tensor.h"
+#include "paddle/phi/core/visit_type.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/sparse/empty_kernel.h"
+#include "paddle/phi/kernels/sparse/sparse_utils_kernel.h"
 
 namespace phi::sparse {
 
-// TODO(zhouwei25): implement CPU kernel of " CSR @ DENSE -> DENSE"
+namespace {
+
+// The rows of the sparse matrix are scheduled in blocks, as the rows of the
+// power-law graphs are far from balanced, and each row accumulates a block of
+// the dense columns at a time in the vector registers.
+constexpr int64_t kSpmmRowBlock = 16;
+constexpr int64_t kSpmmColBlock = 64;
+
+// Checks the shapes of x @ y and returns the dims of the output.
+DDim GetMatmulOutDims(const DDim& x_dims, const DDim& y_dims) {
+  const int x_ndims = x_dims.size();
+  const int y_ndims = y_dims.size();
+  PADDLE_ENFORCE_EQ(x_ndims,
+                    y_ndims,
+                    common::errors::PreconditionNotMet(
+                        "The dims size of Input(x) and Input(y) "
+                        "should be equal, But received X's "
+                        "dimensions=%d, Y's dimensions=%d.",
+                        x_ndims,
+                        y_ndims));
+  PADDLE_ENFORCE_EQ(
+      x_ndims == 2 || x_ndims == 3,
+      true,
+      common::errors::InvalidArgument(
+          "The dims size of Input(x) and Input(y) must be 2 or 3, but got %d.",
+          x_ndims));
+  if (x_ndims == 3) {
+    PADDLE_ENFORCE_EQ(x_dims[0],
+                      y_dims[0],
+                      common::errors::InvalidArgument(
+                          "The batch size of Input(x) and Input(y) must be "
+                          "equal, but got %d and %d.",
+                          x_dims[0],
+                          y_dims[0]));
+  }
+  PADDLE_ENFORCE_EQ(
+      x_dims[x_ndims - 1],
+      y_dims[y_ndims - 2],
+      common::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, x_dim[-1] must be equal to y_dim[-2]."));
+  std::vector<int64_t> out_dims = common::vectorize(y_dims);
+  out_dims[y_ndims - 2] = x_dims[x_ndims - 2];
+  return common::make_ddim(out_dims);
+}
+
+}  // namespace
+
+/* out[rows, n] = csr[rows, k] @ y[k, n] */
+template <typename T, typename IntT>
+void CsrDenseMatmul(const CPUContext& dev_ctx,
+                    const IntT* crows,
+                    const IntT* cols,
+                    const T* values,
+                    const T* y,
+                    int64_t rows,
+                    int64_t k,
+                    int64_t n,
+                    T* out) {
+  if (rows == 0 || n == 0) {
+    return;
+  }
+#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32)
+  const int64_t nnz = crows[rows];
+  constexpr int64_t kIntMax = std::numeric_limits<int>::max();
+  if (nnz <= kIntMax && rows * n <= kIntMax && k * n <= kIntMax) {
+    // the sparse BLAS of MKL takes 32-bit indices
+    std::vector<int> crows32(crows, crows + rows + 1);
+    std::vector<int> cols32(cols, cols + nnz);
+    const int m32 = static_cast<int>(rows);
+    const int n32 = static_cast<int>(n);
+    const int k32 = static_cast<int>(k);
+    const T alpha = static_cast<T>(1);
+    const T beta = static_cast<T>(0);
+    const char transa = 'N';
+    // general matrix with zero-based indices, whose dense matrices are row
+    // major
+    const char matdescra[] = {'G', 'X', 'X', 'C'};
+    auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
+    blas.CSRMM(&transa,
+               &m32,
+               &n32,
+               &k32,
+               &alpha,
+               matdescra,
+               values,
+               cols32.data(),
+               crows32.data(),
+               crows32.data() + 1,
+               y,
+               &n32,
+               &beta,
+               out,
+               &n32);
+    return;
+  }
+#endif
+  const int64_t num_row_blocks = (rows + kSpmmRowBlock - 1) / kSpmmRowBlock;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t block = 0; block < num_row_blocks; ++block) {
+    const int64_t row_end = std::min(rows, (block + 1) * kSpmmRowBlock);
+    T acc[kSpmmColBlock];
+    for (int64_t i = block * kSpmmRowBlock; i < row_end; ++i) {
+      for (int64_t col = 0; col < n; col += kSpmmColBlock) {
+        const int64_t len = std::min(kSpmmColBlock, n - col);
+        std::fill(acc, acc + len, static_cast<T>(0));
+        for (IntT j = crows[i]; j < crows[i + 1]; ++j) {
+          const T v = values[j];
+          const T* y_row = y + cols[j] * n + col;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp simd
+#endif
+          for (int64_t c = 0; c < len; ++c) {
+            acc[c] += v * y_row[c];
+          }
+        }
+        std::copy(acc, acc + len, out + i * n + col);
+      }
+    }
+  }
+}
+
+template <typename T, typename IntT>
+void MatmulCsrDenseCPUKernel(const CPUContext& dev_ctx,
+                             const SparseCsrTensor& x,
+                             const DenseTensor& y,
+                             DenseTensor* out) {
+  const DDim& x_dims = x.dims();
+  MetaTensor meta_out(out);
+  meta_out.set_dims(GetMatmulOutDims(x_dims, y.dims()));
+  meta_out.set_dtype(y.dtype());
+  T* out_data = dev_ctx.template Alloc<T>(out);
+
+  const int64_t batch = x_dims.size() == 2 ? 1 : x_dims[0];
+  const int64_t rows = x_dims[x_dims.size() - 2];
+  const int64_t k = x_dims[x_dims.size() - 1];
+  const int64_t n = y.dims()[y.dims().size() - 1];
+  const IntT* crows = x.crows().data<IntT>();
+  const IntT* cols = x.cols().data<IntT>();
+  const T* values = x.values().data<T>();
+  const T* y_data = y.data<T>();
+  // the crows of each batch start from 0, and its cols and values follow
+  // those of the previous batches
+  int64_t nnz_offset = 0;
+  for (int64_t b = 0; b < batch; ++b) {
+    const IntT* batch_crows = crows + b * (rows + 1);
+    CsrDenseMatmul<T, IntT>(dev_ctx,
+                            batch_crows,
+                            cols + nnz_offset,
+                            values + nnz_offset,
+                            y_data + b * k * n,
+                            rows,
+                            k,
+                            n,
+                            out_data + b * rows * n);
+    nnz_offset += batch_crows[rows];
+  }
+}
+
+/* CSR @ DENSE -> DENSE */
+template <typename T, typename Context>
+void MatmulCsrDenseKernel(const Context& dev_ctx,
+                          const SparseCsrTensor& x,
+                          const DenseTensor& y,
+                          DenseTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      x.crows().dtype(), "MatmulCsrDenseCPUKernel", ([&] {
+        MatmulCsrDenseCPUKernel<T, data_t>(dev_ctx, x, y, out);
+      }));
+}
+
+/* COO @ DENSE -> DENSE */
 template <typename T, typename Context>
-void MatmulCsrDenseKernel(const Context& dev_ctx UNUSED,
-                          const SparseCsrTensor& x UNUSED,
-                          const DenseTensor& y UNUSED,
-                          DenseTensor* out UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU kernel of 'sparse.matmul' now."));
+void MatmulCooDenseKernel(const Context& dev_ctx,
+                          const SparseCooTensor& x,
+                          const DenseTensor& y,
+                          DenseTensor* out) {
+  SparseCsrTensor csr = CooToCsr<T, Context>(dev_ctx, x);
+  MatmulCsrDenseKernel<T, Context>(dev_ctx, csr, y, out);
+}
+
+template <typename T, typename IntT>
+void MaskedMatmulCsrCPUKernel(const CPUContext& dev_ctx,
+                              const DenseTensor& x,
+                              const DenseTensor& y,
+                              const SparseCsrTensor& mask,
+                              SparseCsrTensor* out) {
+  const DDim& mask_dims = mask.dims();
+  const DDim out_dims = GetMatmulOutDims(x.dims(), y.dims());
+  PADDLE_ENFORCE_EQ(
+      mask_dims,
+      out_dims,
+      common::errors::PreconditionNotMet(
+          "The shape of Input(mask) must be equal to that of x @ y, i.e. "
+          "[%s], but got [%s].",
+          out_dims,
+          mask_dims));
+
+  // InferMeta of SparseCsrTensor 'out', CreateLikeInferMeta
+  EmptyLikeCsrKernel<T, CPUContext>(dev_ctx, mask, out);
+
+  const int64_t batch = mask_dims.size() == 2 ? 1 : mask_dims[0];
+  const int64_t rows = mask_dims[mask_dims.size() - 2];
+  const int64_t n = mask_dims[mask_dims.size() - 1];
+  const int64_t k = x.dims()[x.dims().size() - 1];
+  const IntT* crows = mask.crows().data<IntT>();
+  const IntT* cols = mask.cols().data<IntT>();
+  const T* x_data = x.data<T>();
+  const T* y_data = y.data<T>();
+  T* out_values = out->mutable_values()->data<T>();
+
+  // y is transposed to make its columns contiguous for the dot products
+  DenseTensor y_t = phi::Empty<T>(dev_ctx, {n, k});
+  T* y_t_data = y_t.data<T>();
+  int64_t nnz_offset = 0;
+  for (int64_t b = 0; b < batch; ++b) {
+    const T* batch_x = x_data + b * rows * k;
+    const T* batch_y = y_data + b * k * n;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t j = 0; j < n; ++j) {
+      for (int64_t i = 0; i < k; ++i) {
+        y_t_data[j * k + i] = batch_y[i * n + j];
+      }
+    }
+
+    const IntT* batch_crows = crows + b * (rows + 1);
+    const IntT* batch_cols = cols + nnz_offset;
+    T* batch_out = out_values + nnz_offset;
+    const int64_t num_row_blocks = (rows + kSpmmRowBlock - 1) / kSpmmRowBlock;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int64_t block = 0; block < num_row_blocks; ++block) {
+      const int64_t row_end = std::min(rows, (block + 1) * kSpmmRowBlock);
+      for (int64_t i = block * kSpmmRowBlock; i < row_end; ++i) {
+        const T* x_row = batch_x + i * k;
+        for (IntT j = batch_crows[i]; j < batch_crows[i + 1]; ++j) {
+          const T* y_col = y_t_data + batch_cols[j] * k;
+          T sum = static_cast<T>(0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp simd reduction(+ : sum)
+#endif
+          for (int64_t c = 0; c < k; ++c) {
+            sum += x_row[c] * y_col[c];
+          }
+          batch_out[j] = sum;
+        }
+      }
+    }
+    nnz_offset += batch_crows[rows];
+  }
 }
 
-// TODO(zhouwei25): implement CPU kernel of " DENSE @ DENSE * CSR_MASK -> CSR"
+/* DENSE @ DENSE * CSR_MASK -> CSR */
 template <typename T, typename Context>
-void MaskedMatmulCsrKernel(const Context& dev_ctx UNUSED,
-                           const DenseTensor& x UNUSED,
-                           const DenseTensor& y UNUSED,
-                           const SparseCsrTensor& mask UNUSED,
-                           SparseCsrTensor* out UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU kernel of 'sparse.masked_matmul' now."));
+void MaskedMatmulCsrKernel(const Context& dev_ctx,
+                           const DenseTensor& x,
+                           const DenseTensor& y,
+                           const SparseCsrTensor& mask,
+                           SparseCsrTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      mask.crows().dtype(), "MaskedMatmulCsrCPUKernel", ([&] {
+        MaskedMatmulCsrCPUKernel<T, data_t>(dev_ctx, x, y, mask, out);
+      }));
 }
 
 }  // namespace phi::sparse
@@ -51,6 +312,15 @@ PD_REGISTER_KERNEL(matmul_csr_dense,
   kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_CSR);
 }
 
+PD_REGISTER_KERNEL(matmul_coo_dense,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::MatmulCooDenseKernel,
+                   float,
+                   double) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_COO);
+}
+
 PD_REGISTER_KERNEL(masked_matmul_csr,
                    CPU,
                    ALL_LAYOUT,
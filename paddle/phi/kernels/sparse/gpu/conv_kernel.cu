@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/sparse/conv_kernel.h"
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_meta.h"
@@ -21,6 +22,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/cast_kernel.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/scatter.cu.h"
+#include "paddle/phi/kernels/funcs/sparse/rulebook_cache.h"
 #include "paddle/phi/kernels/funcs/sparse/scatter.cu.h"
 #include "paddle/phi/kernels/sparse/gpu/conv.cu.h"
 #if defined(PADDLE_WITH_CUTLASS) && SPCONV_WITH_CUTLASS
@@ -29,6 +31,8 @@ limitations under the License. */
 
 #include "glog/logging.h"
 
+COMMON_DECLARE_int32(sparse_conv_rulebook_cache_size);
+
 namespace phi {
 namespace sparse {
 
@@ -148,6 +152,53 @@ void Conv3dCooGPUKernel(const GPUContext& dev_ctx,
         &need_product_rulebook);
   }
 
+  // the convs without a key, on the indices of a former conv
+  const bool use_rulebook_cache =
+      key.empty() && FLAGS_sparse_conv_rulebook_cache_size > 0;
+  auto& rulebook_cache = phi::funcs::sparse::RulebookCache::Instance();
+  std::string rulebook_config;
+  phi::funcs::sparse::RulebookCacheEntry cached;
+  if (use_rulebook_cache) {
+    rulebook_config =
+        phi::funcs::sparse::RulebookConfig<IntT>(dev_ctx.GetPlace(),
+                                                 x_dims,
+                                                 kernel_sizes,
+                                                 subm_paddings,
+                                                 dilations,
+                                                 subm_strides,
+                                                 subm);
+    if (rulebook_cache.Get(x.indices(), rulebook_config, &cached)) {
+      VLOG(6) << "reuse the rulebook of the indices of x";
+      need_product_rulebook = false;
+      rulebook_ptr = cached.rulebook.data<IntT>();
+      rulebook_len = cached.rulebook.dims()[1];
+      memcpy(h_counter_ptr,
+             cached.counter.data<int>(),
+             kernel_size * sizeof(int));
+      phi::funcs::sparse::PrefixSum<int>(
+          h_counter_ptr, h_offsets_ptr, kernel_size);
+
+      const DenseTensor& indices = subm ? x.indices() : cached.out_indices;
+      DenseTensor out_indices = phi::EmptyLike<IntT>(dev_ctx, indices);
+      phi::Copy(dev_ctx, indices, dev_ctx.GetPlace(), false, &out_indices);
+      DenseTensor out_values =
+          phi::Empty<T>(dev_ctx, {out_indices.dims()[1], out_channels});
+      out->SetMember(out_indices, out_values, out_dims, false);
+      if (!subm) {
+        out_index = cached.out_index;
+        unique_value = cached.unique_value;
+      }
+      phi::funcs::sparse::SaveToTable(dev_ctx,
+                                      x,
+                                      key,
+                                      cached.rulebook,
+                                      cached.counter,
+                                      out,
+                                      rulebook,
+                                      counter);
+    }
+  }
+
   if (need_product_rulebook) {
     DenseTensor tmp_rulebook;
     rulebook_len = ProductRuleBook<T, GPUContext, IntT>(dev_ctx,
@@ -170,6 +221,28 @@ void Conv3dCooGPUKernel(const GPUContext& dev_ctx,
 
     phi::funcs::sparse::SaveToTable(
         dev_ctx, x, key, tmp_rulebook, h_counter, out, rulebook, counter);
+
+    if (use_rulebook_cache) {
+      cached.rulebook = tmp_rulebook;
+      cached.counter = h_counter;
+      if (!subm) {
+        cached.out_indices = out->indices();
+        cached.out_index = out_index;
+        cached.unique_value = unique_value;
+      }
+      rulebook_cache.Put(x.indices(),
+                         rulebook_config,
+                         cached,
+                         FLAGS_sparse_conv_rulebook_cache_size);
+    }
+  }
+  // the out of subm has the indices of x, so has the next subm of the same
+  // config
+  if (use_rulebook_cache && subm) {
+    rulebook_cache.Put(out->indices(),
+                       rulebook_config,
+                       cached,
+                       FLAGS_sparse_conv_rulebook_cache_size);
   }
 
 #if defined(PADDLE_WITH_CUTLASS) && SPCONV_WITH_CUTLASS
@@ -0,0 +1,74 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/assign_kernel.h"
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+
+COMMON_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+
+// Copies the strided x into the contiguous out at once, rather than into its
+// contiguous copy first and then into out.
+template <typename T, typename Context>
+void AssignStridedKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         DenseTensor* out) {
+  if (!FLAGS_use_stride_kernel) {
+    PADDLE_THROW(common::errors::Fatal(
+        "FLAGS_use_stride_kernel is closed. Strided kernel "
+        "be called, something wrong has happened!"));
+  }
+  if (!x.initialized() || x.meta().is_contiguous()) {
+    AssignKernel<Context>(dev_ctx, x, out);
+    return;
+  }
+  const T* x_data = x.data<T>();
+  DenseTensorMeta meta = x.meta();
+  meta.strides = DenseTensorMeta::calc_strides(meta.dims);
+  meta.offset = 0;
+  out->set_meta(meta);
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+  funcs::CPUStridedTransform(x_data,
+                             common::vectorize<int64_t>(x.dims()),
+                             common::vectorize<int64_t>(x.strides()),
+                             out_data,
+                             [](const T& a) { return a; });
+  AddAvoidedContiguousBytes(ContiguousBytes(x));
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(assign,
+                   CPU,
+                   STRIDED,
+                   phi::AssignStridedKernel,
+                   bool,
+                   uint8_t,
+                   int8_t,
+                   int16_t,
+                   int,
+                   int64_t,
+                   float,
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>) {}
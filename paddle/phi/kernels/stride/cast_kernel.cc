@@ -0,0 +1,81 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/cast_kernel.h"
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/visit_type.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+
+COMMON_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+
+template <typename InT, typename OutT>
+void CastStridedCompute(const CPUContext& dev_ctx,
+                        const DenseTensor& x,
+                        DenseTensor* out) {
+  const InT* x_data = x.data<InT>();
+  out->set_strides(DenseTensorMeta::calc_strides(out->dims()));
+  OutT* out_data = dev_ctx.template Alloc<OutT>(out);
+  if (out->numel() == 0) return;
+  funcs::CPUStridedTransform(x_data,
+                             common::vectorize<int64_t>(x.dims()),
+                             common::vectorize<int64_t>(x.strides()),
+                             out_data,
+                             [](const InT& a) { return static_cast<OutT>(a); });
+  AddAvoidedContiguousBytes(ContiguousBytes(x));
+}
+
+template <typename T, typename Context>
+void CastStridedKernel(const Context& dev_ctx,
+                       const DenseTensor& x,
+                       DataType out_dtype,
+                       DenseTensor* out) {
+  if (!FLAGS_use_stride_kernel) {
+    PADDLE_THROW(common::errors::Fatal(
+        "FLAGS_use_stride_kernel is closed. Strided kernel "
+        "be called, something wrong has happened!"));
+  }
+  if (x.meta().is_contiguous() || out->IsSharedWith(x)) {
+    CastKernel<T, Context>(
+        dev_ctx, CheckAndStridedTensorContiguous<T>(x), out_dtype, out);
+    return;
+  }
+  PD_VISIT_ALL_TYPES(out_dtype, "CastStridedCompute", ([&] {
+                       CastStridedCompute<T, data_t>(dev_ctx, x, out);
+                     }));
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(cast,
+                   CPU,
+                   STRIDED,
+                   phi::CastStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   int16_t,
+                   bool,
+                   int8_t,
+                   uint8_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::UNDEFINED);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/phi/kernels/elementwise_divide_kernel.h"
+#include "paddle/phi/kernels/elementwise_multiply_kernel.h"
+#include "paddle/phi/kernels/elementwise_subtract_kernel.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+
+COMMON_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+
+// Computes out = func(x, y) into the contiguous out, with x and y read
+// through their strides instead of their contiguous copies.
+template <typename T, typename Functor>
+void ElementwiseStridedCompute(const CPUContext& dev_ctx,
+                               const DenseTensor& x,
+                               const DenseTensor& y,
+                               DenseTensor* out) {
+  const DDim out_dims = out->dims();
+  std::vector<int64_t> x_strides = BroadcastStrides(x, out_dims);
+  std::vector<int64_t> y_strides = BroadcastStrides(y, out_dims);
+  const T* x_data = x.data<T>();
+  const T* y_data = y.data<T>();
+  out->set_strides(DenseTensorMeta::calc_strides(out_dims));
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return;
+
+  funcs::CPUBroadcastDims dims(
+      common::vectorize<int64_t>(out_dims), x_strides, y_strides);
+  funcs::CPUBroadcast<false>(dims, x_data, y_data, out_data, Functor());
+  AddAvoidedContiguousBytes(ContiguousBytes(x) + ContiguousBytes(y));
+}
+
+#define DEFINE_CPU_ELEMENTWISE_STRIDED_KERNEL(name, functor)             \
+  template <typename T, typename Context>                                \
+  void name##StridedKernel(const Context& dev_ctx,                       \
+                           const DenseTensor& x,                         \
+                           const DenseTensor& y,                         \
+                           DenseTensor* out) {                           \
+    if (!FLAGS_use_stride_kernel) {                                      \
+      PADDLE_THROW(common::errors::Fatal(                                \
+          "FLAGS_use_stride_kernel is closed. Strided kernel "           \
+          "be called, something wrong has happened!"));                  \
+    }                                                                    \
+    if (x.meta().is_contiguous() && y.meta().is_contiguous()) {          \
+      name##Kernel<T, Context>(dev_ctx, x, y, out);                      \
+      return;                                                            \
+    }                                                                    \
+    ElementwiseStridedCompute<T, funcs::functor<T>>(dev_ctx, x, y, out); \
+  }
+
+DEFINE_CPU_ELEMENTWISE_STRIDED_KERNEL(Add, AddFunctor)
+DEFINE_CPU_ELEMENTWISE_STRIDED_KERNEL(Subtract, SubtractFunctor)
+DEFINE_CPU_ELEMENTWISE_STRIDED_KERNEL(Multiply, MultiplyFunctor)
+DEFINE_CPU_ELEMENTWISE_STRIDED_KERNEL(Divide, DivideFunctor)
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(add,
+                   CPU,
+                   STRIDED,
+                   phi::AddStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t) {}
+
+PD_REGISTER_KERNEL(subtract,
+                   CPU,
+                   STRIDED,
+                   phi::SubtractStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t) {}
+
+PD_REGISTER_KERNEL(multiply,
+                   CPU,
+                   STRIDED,
+                   phi::MultiplyStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t) {}
+
+PD_REGISTER_KERNEL(divide,
+                   CPU,
+                   STRIDED,
+                   phi::DivideStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t) {}
@@ -0,0 +1,174 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/matmul_kernel.h"
+
+#include <climits>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+
+COMMON_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+
+namespace {
+
+// A strided matrix passed to GEMM as is, whose rows or columns are
+// contiguous and step by the leading dimension ld.
+struct StridedGemmOperand {
+  bool trans;
+  int64_t ld;
+};
+
+// The GEMM operand of the matrix of the last two dims of x, which is
+// transposed by the op if trans. Returns false if neither of the dims is
+// contiguous, e.g. the matrix of a slice with steps.
+bool ToGemmOperand(const DenseTensor& x, bool trans, StridedGemmOperand* op) {
+  const int rank = x.dims().size();
+  const int64_t rows = x.dims()[rank - 2];
+  const int64_t cols = x.dims()[rank - 1];
+  // The strides of the dims of size 1 are never used.
+  const int64_t row_stride = rows == 1 ? cols : x.strides()[rank - 2];
+  const int64_t col_stride = cols == 1 ? 1 : x.strides()[rank - 1];
+  if (col_stride == 1 && row_stride >= cols) {
+    *op = {trans, row_stride};
+  } else if (row_stride == 1 && col_stride >= rows) {
+    // The rows of the transposed matrix are contiguous.
+    *op = {!trans, col_stride};
+  } else {
+    return false;
+  }
+  return op->ld >= 1 && op->ld <= INT_MAX;
+}
+
+// The strides of the batch dims of x in the batch dims of out, 0 for the
+// broadcast dims.
+std::vector<int64_t> BatchStrides(const DenseTensor& x, const DDim& out_dims) {
+  const int batch_rank = out_dims.size() - 2;
+  const int x_batch_rank = x.dims().size() - 2;
+  std::vector<int64_t> strides(batch_rank, 0);
+  for (int i = 0; i < x_batch_rank; ++i) {
+    if (x.dims()[i] != 1) {
+      strides[i + batch_rank - x_batch_rank] = x.strides()[i];
+    }
+  }
+  return strides;
+}
+
+}  // namespace
+
+// Computes the batched matmul of the strided x and y into the contiguous out
+// by a GEMM per batch, with the leading dims of the strided matrices instead
+// of their contiguous copies. Returns false if the matrices of x or y are
+// not of a GEMM operand.
+template <typename T>
+bool MatmulStridedCompute(const CPUContext& dev_ctx,
+                          const DenseTensor& x,
+                          const DenseTensor& y,
+                          bool transpose_x,
+                          bool transpose_y,
+                          DenseTensor* out) {
+  const int x_rank = x.dims().size();
+  const int y_rank = y.dims().size();
+  const int out_rank = out->dims().size();
+  StridedGemmOperand x_op, y_op;
+  if (x_rank < 2 || y_rank < 2 || out_rank < 2 ||
+      !ToGemmOperand(x, transpose_x, &x_op) ||
+      !ToGemmOperand(y, transpose_y, &y_op)) {
+    return false;
+  }
+  const int64_t M = out->dims()[out_rank - 2];
+  const int64_t N = out->dims()[out_rank - 1];
+  const int64_t K = x.dims()[transpose_x ? x_rank - 2 : x_rank - 1];
+  if (M > INT_MAX || N > INT_MAX || K > INT_MAX) {
+    return false;
+  }
+
+  const std::vector<int64_t> batch_dims(
+      out->dims().Get(), out->dims().Get() + out_rank - 2);
+  const std::vector<int64_t> x_strides = BatchStrides(x, out->dims());
+  const std::vector<int64_t> y_strides = BatchStrides(y, out->dims());
+  int64_t batch_size = 1;
+  for (int64_t dim : batch_dims) {
+    batch_size *= dim;
+  }
+
+  const T* x_data = x.data<T>();
+  const T* y_data = y.data<T>();
+  out->set_strides(DenseTensorMeta::calc_strides(out->dims()));
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) return true;
+
+  auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
+  std::vector<int64_t> index(batch_dims.size(), 0);
+  int64_t x_offset = 0, y_offset = 0;
+  for (int64_t b = 0; b < batch_size; ++b) {
+    blas.GEMM(x_op.trans,
+              y_op.trans,
+              static_cast<int>(M),
+              static_cast<int>(N),
+              static_cast<int>(K),
+              static_cast<T>(1),
+              x_data + x_offset,
+              static_cast<int>(x_op.ld),
+              y_data + y_offset,
+              static_cast<int>(y_op.ld),
+              static_cast<T>(0),
+              out_data + b * M * N,
+              static_cast<int>(N));
+    for (int i = static_cast<int>(batch_dims.size()) - 1; i >= 0; --i) {
+      x_offset += x_strides[i];
+      y_offset += y_strides[i];
+      if (++index[i] < batch_dims[i]) break;
+      x_offset -= x_strides[i] * batch_dims[i];
+      y_offset -= y_strides[i] * batch_dims[i];
+      index[i] = 0;
+    }
+  }
+  AddAvoidedContiguousBytes(ContiguousBytes(x) + ContiguousBytes(y));
+  return true;
+}
+
+template <typename T, typename Context>
+void MatmulStridedKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const DenseTensor& y,
+                         bool transpose_x,
+                         bool transpose_y,
+                         DenseTensor* out) {
+  if (!FLAGS_use_stride_kernel) {
+    PADDLE_THROW(common::errors::Fatal(
+        "FLAGS_use_stride_kernel is closed. Strided kernel "
+        "be called, something wrong has happened!"));
+  }
+  if ((x.meta().is_contiguous() && y.meta().is_contiguous()) ||
+      !MatmulStridedCompute<T>(dev_ctx, x, y, transpose_x, transpose_y, out)) {
+    MatmulKernel<T, Context>(dev_ctx,
+                             CheckAndStridedTensorContiguous<T>(x),
+                             CheckAndStridedTensorContiguous<T>(y),
+                             transpose_x,
+                             transpose_y,
+                             out);
+  }
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(
+    matmul, CPU, STRIDED, phi::MatmulStridedKernel, float, double) {}
@@ -0,0 +1,243 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/parallel_for.h"
+#include "paddle/phi/kernels/funcs/strided_utils.h"
+#include "paddle/phi/kernels/reduce_max_kernel.h"
+#include "paddle/phi/kernels/reduce_mean_kernel.h"
+#include "paddle/phi/kernels/reduce_min_kernel.h"
+#include "paddle/phi/kernels/reduce_sum_kernel.h"
+
+COMMON_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+
+namespace {
+
+// The floating point sums accumulate in double over the strided elements,
+// which are added one by one rather than by the tree of Eigen.
+template <typename T>
+using StridedSumType =
+    std::conditional_t<std::is_floating_point<T>::value, double, T>;
+
+template <typename T>
+struct StridedSumReducer {
+  using AccT = StridedSumType<T>;
+  AccT Init() const { return static_cast<AccT>(0); }
+  void operator()(AccT* acc, AccT value) const { *acc += value; }
+  T Finalize(AccT acc, int64_t n UNUSED) const { return static_cast<T>(acc); }
+};
+
+template <typename T>
+struct StridedMeanReducer : StridedSumReducer<T> {
+  using AccT = StridedSumType<T>;
+  T Finalize(AccT acc, int64_t n) const {
+    return static_cast<T>(acc / static_cast<AccT>(n));
+  }
+};
+
+// The max and the min propagate NaN, the same as the contiguous kernels.
+template <typename T>
+struct StridedMaxReducer {
+  using AccT = T;
+  AccT Init() const {
+    return std::numeric_limits<T>::has_infinity
+               ? -std::numeric_limits<T>::infinity()
+               : std::numeric_limits<T>::lowest();
+  }
+  void operator()(AccT* acc, AccT value) const {
+    if (value > *acc || value != value) *acc = value;
+  }
+  T Finalize(AccT acc, int64_t n UNUSED) const { return acc; }
+};
+
+template <typename T>
+struct StridedMinReducer {
+  using AccT = T;
+  AccT Init() const {
+    return std::numeric_limits<T>::has_infinity
+               ? std::numeric_limits<T>::infinity()
+               : std::numeric_limits<T>::max();
+  }
+  void operator()(AccT* acc, AccT value) const {
+    if (value < *acc || value != value) *acc = value;
+  }
+  T Finalize(AccT acc, int64_t n UNUSED) const { return acc; }
+};
+
+}  // namespace
+
+// Reduces x over dims into the contiguous out, with x read through its
+// strides instead of its contiguous copy. The outputs run in parallel, and
+// the reduced dims are visited from the largest stride to the smallest one.
+template <typename T, typename Reducer>
+void ReduceStridedCompute(const CPUContext& dev_ctx,
+                          const DenseTensor& x,
+                          const IntArray& dims,
+                          Reducer reducer,
+                          DenseTensor* out) {
+  using AccT = typename Reducer::AccT;
+  const int rank = x.dims().size();
+  const bool reduce_all = recompute_reduce_all(x, dims);
+  std::vector<bool> is_reduced(rank, reduce_all);
+  if (!reduce_all) {
+    for (int64_t dim : dims.GetData()) {
+      is_reduced[dim < 0 ? dim + rank : dim] = true;
+    }
+  }
+
+  std::vector<int64_t> kept_dims, kept_strides;
+  std::vector<std::pair<int64_t, int64_t>> reduced;  // {stride, dim}
+  for (int i = 0; i < rank; ++i) {
+    if (x.dims()[i] == 1) continue;
+    if (is_reduced[i]) {
+      reduced.emplace_back(x.strides()[i], x.dims()[i]);
+    } else {
+      kept_dims.push_back(x.dims()[i]);
+      kept_strides.push_back(x.strides()[i]);
+    }
+  }
+  std::sort(reduced.begin(), reduced.end(), std::greater<>());
+  if (reduced.empty()) reduced.emplace_back(1, 1);
+  const int reduced_rank = static_cast<int>(reduced.size());
+  const int64_t inner = reduced.back().second;
+  const int64_t inner_stride = reduced.back().first;
+  const int64_t reduce_numel = std::accumulate(
+      reduced.begin(), reduced.end(), int64_t{1}, [](int64_t n, const auto& r) {
+        return n * r.second;
+      });
+  const int64_t out_numel = std::accumulate(
+      kept_dims.begin(), kept_dims.end(), int64_t{1}, std::multiplies<>());
+
+  const T* x_data = x.data<T>();
+  out->set_strides(DenseTensorMeta::calc_strides(out->dims()));
+  T* out_data = dev_ctx.template Alloc<T>(out);
+
+  phi::ParallelFor(
+      0,
+      out_numel,
+      phi::ParallelGrainSize(reduce_numel),
+      [&](int64_t begin, int64_t end) {
+        std::vector<int64_t> index(reduced_rank - 1);
+        for (int64_t o = begin; o < end; ++o) {
+          int64_t offset = 0;
+          int64_t rest = o;
+          for (int i = static_cast<int>(kept_dims.size()) - 1; i >= 0; --i) {
+            offset += rest % kept_dims[i] * kept_strides[i];
+            rest /= kept_dims[i];
+          }
+          AccT acc = reducer.Init();
+          std::fill(index.begin(), index.end(), 0);
+          for (int64_t row = 0; row < reduce_numel / inner; ++row) {
+            const T* row_data = x_data + offset;
+            for (int64_t j = 0; j < inner; ++j) {
+              reducer(&acc, static_cast<AccT>(row_data[j * inner_stride]));
+            }
+            for (int i = reduced_rank - 2; i >= 0; --i) {
+              offset += reduced[i].first;
+              if (++index[i] < reduced[i].second) break;
+              offset -= reduced[i].first * reduced[i].second;
+              index[i] = 0;
+            }
+          }
+          out_data[o] = reducer.Finalize(acc, reduce_numel);
+        }
+      });
+  AddAvoidedContiguousBytes(ContiguousBytes(x));
+}
+
+template <typename T, typename Context>
+void SumStridedKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      const IntArray& dims,
+                      DataType out_dtype,
+                      bool keep_dim,
+                      DenseTensor* out) {
+  if (!FLAGS_use_stride_kernel) {
+    PADDLE_THROW(common::errors::Fatal(
+        "FLAGS_use_stride_kernel is closed. Strided kernel "
+        "be called, something wrong has happened!"));
+  }
+  // The sums of another dtype are left to the contiguous kernel.
+  if (x.meta().is_contiguous() || x.numel() == 0 ||
+      out->dtype() != x.dtype()) {
+    SumKernel<T, Context>(dev_ctx,
+                          CheckAndStridedTensorContiguous<T>(x),
+                          dims,
+                          out_dtype,
+                          keep_dim,
+                          out);
+    return;
+  }
+  ReduceStridedCompute<T>(dev_ctx, x, dims, StridedSumReducer<T>(), out);
+}
+
+#define DEFINE_CPU_REDUCE_STRIDED_KERNEL(name, reducer)               \
+  template <typename T, typename Context>                             \
+  void name##StridedKernel(const Context& dev_ctx,                    \
+                           const DenseTensor& x,                      \
+                           const IntArray& dims,                      \
+                           bool keep_dim,                             \
+                           DenseTensor* out) {                        \
+    if (!FLAGS_use_stride_kernel) {                                   \
+      PADDLE_THROW(common::errors::Fatal(                             \
+          "FLAGS_use_stride_kernel is closed. Strided kernel "        \
+          "be called, something wrong has happened!"));               \
+    }                                                                 \
+    if (x.meta().is_contiguous() || x.numel() == 0) {                 \
+      name##Kernel<T, Context>(dev_ctx,                               \
+                               CheckAndStridedTensorContiguous<T>(x), \
+                               dims,                                  \
+                               keep_dim,                              \
+                               out);                                  \
+      return;                                                         \
+    }                                                                 \
+    ReduceStridedCompute<T>(dev_ctx, x, dims, reducer<T>(), out);     \
+  }
+
+DEFINE_CPU_REDUCE_STRIDED_KERNEL(Mean, StridedMeanReducer)
+DEFINE_CPU_REDUCE_STRIDED_KERNEL(Max, StridedMaxReducer)
+DEFINE_CPU_REDUCE_STRIDED_KERNEL(Min, StridedMinReducer)
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(sum,
+                   CPU,
+                   STRIDED,
+                   phi::SumStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::UNDEFINED);
+}
+
+PD_REGISTER_KERNEL(mean, CPU, STRIDED, phi::MeanStridedKernel, float, double) {
+}
+
+PD_REGISTER_KERNEL(
+    max, CPU, STRIDED, phi::MaxStridedKernel, float, double, int, int64_t) {}
+
+PD_REGISTER_KERNEL(
+    min, CPU, STRIDED, phi::MinStridedKernel, float, double, int, int64_t) {}
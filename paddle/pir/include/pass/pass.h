@@ -16,6 +16,7 @@
 
 #include <any>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -88,6 +89,18 @@ class IR_API Pass {
 
   const detail::PassInfo& pass_info() const { return pass_info_; }
 
+  // Whether the pass only rewrites the ops nested in the op it runs on, and
+  // of the values defined above that op only uses the ones already used in
+  // it. Such passes can run on the sibling ops of a block concurrently, see
+  // PassManager::EnableParallel.
+  virtual bool IsOpLocal() const { return false; }
+
+  // Creates an instance of the pass to run on another thread, which shares
+  // the attributes with this pass. By default a registered pass is created
+  // by the PassRegistry, the passes configured by their constructors must
+  // override it. Returns nullptr if the pass can not be cloned.
+  virtual std::unique_ptr<Pass> Clone() const;
+
   // Get a reference to the attributed previously set.
   template <typename AttrType>
   AttrType& Get(const std::string& attr_name) const {
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "paddle/pir/include/core/type_id.h"
+#include "paddle/pir/include/pattern_rewrite/pattern_rewrite_driver.h"
 
 namespace pir {
 
@@ -53,6 +54,12 @@ class PassInstrumentation {
   virtual void RunAfterAnalysis(const std::string& name,
                                 TypeId id,
                                 Operation* op) {}
+
+  // A callback to run after a PatternRewritePass is executed, with the
+  // profiles of its patterns.
+  virtual void RunAfterPatternRewrite(Pass* pass,
+                                      Operation* op,
+                                      const PatternStatisticsMap& statistics) {}
 };
 
 /// This class holds a collection of PassInstrumentation objects, and invokes
@@ -78,6 +85,10 @@ class IR_API PassInstrumentor {
 
   void RunAfterAnalysis(const std::string& name, TypeId id, Operation* op);
 
+  void RunAfterPatternRewrite(Pass* pass,
+                              Operation* op,
+                              const PatternStatisticsMap& statistics);
+
   // TODO(liuyuanle): Add other hooks.
 
  private:
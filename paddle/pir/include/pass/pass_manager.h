@@ -115,11 +115,24 @@ class IR_API PassManager {
 
   void AddInstrumentation(std::unique_ptr<PassInstrumentation> pi);
 
+  // Runs the pipeline on the sibling ops of a block on at most num_threads
+  // threads, when all the passes are op local and can be cloned. The ops
+  // whose nested ops use a common value defined above them run on the same
+  // thread. Instrumentations are not thread safe, the pipeline runs
+  // sequentially when any is added. Defaults to FLAGS_pir_pass_num_threads.
+  void EnableParallel(int num_threads) { num_threads_ = num_threads; }
+
+  int num_threads() const { return num_threads_; }
+
  private:
   bool Initialize(IrContext *context);
 
   bool Run(Operation *op);
 
+  // Creates the pass managers of the worker threads, returns false if the
+  // pipeline can not run in parallel.
+  bool InitializeWorkers();
+
  private:
   IrContext *context_;
 
@@ -135,6 +148,11 @@ class IR_API PassManager {
 
   std::unique_ptr<PassInstrumentor> instrumentor_;
 
+  int num_threads_;
+
+  // Clones of the pipeline, one for each thread running it in parallel.
+  std::vector<std::unique_ptr<PassManager>> workers_;
+
   // For access member of pass_adaptor_.
   friend class detail::PassAdaptor;
 };
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
 #include "paddle/pir/include/core/dll_decl.h"
 #include "paddle/pir/include/core/region.h"
 
@@ -21,6 +25,19 @@ namespace pir {
 
 class FrozenRewritePatternSet;
 
+/// The profile of a pattern during the greedy match and rewrite process.
+struct PatternStatistics {
+  /// The number of times the pattern is tried to match.
+  int64_t num_attempts = 0;
+  /// The number of times the pattern matches and rewrites the ir.
+  int64_t num_hits = 0;
+  /// The total time of the attempts in microseconds.
+  double time_us = 0.0;
+};
+
+/// Mapping between the debug name of the patterns and their profiles.
+using PatternStatisticsMap = std::unordered_map<std::string, PatternStatistics>;
+
 /// This enum will control which ops will be added to the worklist during the
 /// match rewrite process
 enum class IR_API GreedyRewriteStrictness {
@@ -38,10 +55,20 @@ class IR_API GreedyRewriteConfig {
   /// Control the way op is added to the worklist: bottom-up or top-down.
   bool use_top_down_traversal = false;
 
-  /// Control the maximum number of iterations in the process of applying the
-  /// pattern, use `kNolimit` to represent unlimited.
+  /// Control the maximum number of scans of the region, use `kNolimit` to
+  /// represent unlimited. The region is scanned again while a scan rewrites
+  /// something and `rescan_on_change` is set, or when the worklist stops at
+  /// `max_num_rewrites`.
   int64_t max_iterations = 10;
 
+  /// The ops whose operands or users are changed by the rewrites are
+  /// revisited through the worklist during a scan. By default the whole
+  /// region is still scanned again until no pattern applies, which also finds
+  /// the changes of the patterns not notified to the rewriter. Clear it to
+  /// stop once the worklist is drained, for the patterns notifying all their
+  /// changes.
+  bool rescan_on_change = true;
+
   /// Control the upper limit of rewrite times during each iteration, use
   /// kNoLimit to represent unlimited.
   int64_t max_num_rewrites = kNoLimit;
@@ -57,12 +84,21 @@ class IR_API GreedyRewriteConfig {
   /// - ExistingOps: only pre-existing ops are added to the worklist.
   GreedyRewriteStrictness strict_mode = GreedyRewriteStrictness::AnyOp;
 
+  /// Accumulate the profiles of the patterns into it if not null.
+  PatternStatisticsMap* pattern_statistics{nullptr};
+
   static constexpr int64_t kNoLimit = -1;
 };
 
 /// Perform the Match and Rewrite process in the specified region, greedily
-/// apply the Pattern with the highest benefit, and repeat this process until
-/// convergence or the upper limit of iterations.
+/// apply the Pattern with the highest benefit to the ops in a worklist, which
+/// starts with all the ops of the region and is fed with the ops affected by
+/// the rewrites, until it is empty or the upper limit of iterations.
+///
+/// Only the ops in the blocks directly owned by the region are visited. An
+/// affected op nested in the region of one of them, or outside the region,
+/// is not added to the worklist; the patterns of the parent op are expected
+/// to walk its nested regions if they need to.
 ///
 /// Returns pair<bool,int64_t>
 // the first is true if the iteration converges and no patterns can be applied.
@@ -16,13 +16,18 @@
 
 #include <glog/logging.h>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include "paddle/common/enforce.h"
 
 namespace pir {
 // This is a structure for creating, caching, and looking up Storage of
-// parametric types.
+// parametric types. The instances are sharded by hash value, each shard has
+// its own lock, so that the passes running on different threads rarely wait
+// for each other, and the lookup of an existing instance only takes a shared
+// lock.
 struct ParametricStorageManager {
   using StorageBase = StorageManager::StorageBase;
 
@@ -30,10 +35,12 @@ struct ParametricStorageManager {
       : destroy_(destroy) {}
 
   ~ParametricStorageManager() {  // NOLINT
-    for (const auto &instance : parametric_instances_) {
-      destroy_(instance.second);
+    for (auto &shard : shards_) {
+      for (const auto &instance : shard.instances) {
+        destroy_(instance.second);
+      }
+      shard.instances.clear();
     }
-    parametric_instances_.clear();
   }
 
   // Get the storage of parametric type, if not in the cache, create and
@@ -41,20 +48,20 @@ struct ParametricStorageManager {
   StorageBase *GetOrCreate(std::size_t hash_value,
                            std::function<bool(StorageBase *)> equal_func,
                            std::function<StorageBase *()> constructor) {
-    if (parametric_instances_.count(hash_value) != 0) {
-      auto pr = parametric_instances_.equal_range(hash_value);
-      while (pr.first != pr.second) {
-        if (equal_func(pr.first->second)) {
-          VLOG(10) << "Found a cached parametric storage of: [param_hash="
-                   << hash_value << ", storage_ptr=" << pr.first->second
-                   << "].";
-          return pr.first->second;
-        }
-        ++pr.first;
+    Shard &shard = shards_[(hash_value ^ (hash_value >> 16)) % kNumShards];
+    {
+      std::shared_lock<std::shared_mutex> guard(shard.mutex);
+      if (StorageBase *storage = Find(shard, hash_value, equal_func)) {
+        return storage;
       }
     }
+    std::unique_lock<std::shared_mutex> guard(shard.mutex);
+    // another thread may have created it after the shared lock is released
+    if (StorageBase *storage = Find(shard, hash_value, equal_func)) {
+      return storage;
+    }
     StorageBase *storage = constructor();
-    parametric_instances_.emplace(hash_value, storage);
+    shard.instances.emplace(hash_value, storage);
     VLOG(10) << "No cache found, construct and cache a new parametric storage "
                 "of: [param_hash="
              << hash_value << ", storage_ptr=" << storage << "].";
@@ -62,9 +69,31 @@ struct ParametricStorageManager {
   }
 
  private:
-  // In order to prevent hash conflicts, the unordered_multimap data structure
-  // is used for storage.
-  std::unordered_multimap<size_t, StorageBase *> parametric_instances_;
+  static constexpr size_t kNumShards = 16;
+
+  struct Shard {
+    std::shared_mutex mutex;
+    // In order to prevent hash conflicts, the unordered_multimap data
+    // structure is used for storage.
+    std::unordered_multimap<size_t, StorageBase *> instances;
+  };
+
+  static StorageBase *Find(
+      const Shard &shard,
+      std::size_t hash_value,
+      const std::function<bool(StorageBase *)> &equal_func) {
+    auto pr = shard.instances.equal_range(hash_value);
+    for (; pr.first != pr.second; ++pr.first) {
+      if (equal_func(pr.first->second)) {
+        VLOG(10) << "Found a cached parametric storage of: [param_hash="
+                 << hash_value << ", storage_ptr=" << pr.first->second << "].";
+        return pr.first->second;
+      }
+    }
+    return nullptr;
+  }
+
+  Shard shards_[kNumShards];
   std::function<void(StorageBase *)> destroy_;
 };
 
@@ -77,31 +106,36 @@ StorageManager::StorageBase *StorageManager::GetParametricStorageImpl(
     std::size_t hash_value,
     std::function<bool(const StorageBase *)> equal_func,
     std::function<StorageBase *()> constructor) {
-  std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
   VLOG(10) << "Try to get a parametric storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << ", param_hash=" << hash_value
            << "].";
-  if (parametric_instance_.find(type_id) == parametric_instance_.end()) {
-    IR_THROW("The input data pointer is null.");
+  ParametricStorageManager *parametric_storage = nullptr;
+  {
+    std::shared_lock<std::shared_mutex> guard(parametric_instance_lock_);
+    auto iter = parametric_instance_.find(type_id);
+    if (iter == parametric_instance_.end()) {
+      IR_THROW("The input data pointer is null.");
+    }
+    parametric_storage = iter->second.get();
   }
-  ParametricStorageManager &parametric_storage = *parametric_instance_[type_id];
-  return parametric_storage.GetOrCreate(hash_value, equal_func, constructor);
+  // the storage manager of a type is never removed
+  return parametric_storage->GetOrCreate(hash_value, equal_func, constructor);
 }
 
 StorageManager::StorageBase *StorageManager::GetParameterlessStorageImpl(
     TypeId type_id) {
-  std::lock_guard<pir::SpinLock> guard(parameterless_instance_lock_);
+  std::shared_lock<std::shared_mutex> guard(parameterless_instance_lock_);
   VLOG(10) << "Try to get a parameterless storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
-  if (parameterless_instance_.find(type_id) == parameterless_instance_.end())
+  auto iter = parameterless_instance_.find(type_id);
+  if (iter == parameterless_instance_.end())
     IR_THROW("TypeId not found in IrContext.");
-  StorageBase *parameterless_instance = parameterless_instance_[type_id];
-  return parameterless_instance;
+  return iter->second;
 }
 
 void StorageManager::RegisterParametricStorageImpl(
     TypeId type_id, std::function<void(StorageBase *)> destroy) {
-  std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
+  std::unique_lock<std::shared_mutex> guard(parametric_instance_lock_);
   VLOG(10) << "Register a parametric storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
   parametric_instance_.emplace(
@@ -110,7 +144,7 @@ void StorageManager::RegisterParametricStorageImpl(
 
 void StorageManager::RegisterParameterlessStorageImpl(
     TypeId type_id, std::function<StorageBase *()> constructor) {
-  std::lock_guard<pir::SpinLock> guard(parameterless_instance_lock_);
+  std::unique_lock<std::shared_mutex> guard(parameterless_instance_lock_);
   VLOG(10) << "Register a parameterless storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
   if (parameterless_instance_.find(type_id) != parameterless_instance_.end())
@@ -14,6 +14,16 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/common/flags.h"
+#include "paddle/pir/include/core/block_argument.h"
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/operation.h"
 #include "paddle/pir/include/core/program.h"
@@ -22,11 +32,14 @@
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_instrumentation.h"
 #include "paddle/pir/include/pass/pass_manager.h"
+#include "paddle/pir/include/pass/pass_registry.h"
 #include "paddle/pir/include/pattern_rewrite/pattern_match.h"
 #include "paddle/pir/src/pass/pass_adaptor.h"
 
 #include "paddle/common/enforce.h"
 
+COMMON_DECLARE_int32(pir_pass_num_threads);
+
 namespace pir {
 
 //===----------------------------------------------------------------------===//
@@ -44,6 +57,16 @@ Pass::~Pass() {
 
 bool Pass::CanApplyOn(Operation* op) const { return op->num_regions() > 0; }
 
+std::unique_ptr<Pass> Pass::Clone() const {
+  if (!PassRegistry::Instance().Has(name())) {
+    return nullptr;
+  }
+  auto pass = PassRegistry::Instance().Get(name());
+  // the attributes are owned by this pass
+  pass->attrs_ = attrs_;
+  return pass;
+}
+
 std::optional<detail::PassExecutionState>& Pass::pass_state() {
   return pass_state_;
 }
@@ -89,9 +112,17 @@ GreedyRewriteConfig PatternRewritePass::InitializeConfig() {
 
 void PatternRewritePass::Run(Operation* op) {
   VLOG(4) << "Run PatternRewritePass: " << name();
-  auto [_, num_rewrites] =
-      ApplyPatternsGreedily(op, patterns_, InitializeConfig());
+  GreedyRewriteConfig config = InitializeConfig();
+  PassInstrumentor* instrumentor =
+      pass_state().has_value() ? analysis_manager().GetPassInstrumentor()
+                               : nullptr;
+  PatternStatisticsMap pattern_statistics;
+  if (instrumentor) config.pattern_statistics = &pattern_statistics;
+  auto [_, num_rewrites] = ApplyPatternsGreedily(op, patterns_, config);
   AddStatistics(num_rewrites);
+  if (instrumentor) {
+    instrumentor->RunAfterPatternRewrite(this, op, pattern_statistics);
+  }
 }
 
 //----------------------------------------------------------------------------------------------//
@@ -109,6 +140,11 @@ void detail::PassAdaptor::RunImpl(Operation* op,
   for (size_t i = 0; i < op->num_regions(); ++i) {
     auto& region = op->region(i);
     for (auto& block : region) {
+      if (!pm_->workers_.empty() && block.size() > 1) {
+        if (!RunParallel(&block, last_am, opt_level, verify))
+          return SignalPassFailure();
+        continue;
+      }
       for (auto& op : block) {
         AnalysisManagerHolder am(&op, last_am.GetPassInstrumentor());
         if (!RunPipeline(*pm_, &op, am, opt_level, verify))
@@ -119,6 +155,115 @@ void detail::PassAdaptor::RunImpl(Operation* op,
   return;
 }
 
+namespace {
+// Groups the ops of the block into the sets that can run concurrently: the
+// ops nested in the ops of different sets use no common value defined above
+// them.
+std::vector<std::vector<Operation*>> GroupIndependentOps(Block* block) {
+  std::vector<Operation*> ops;
+  for (auto& op : *block) {
+    ops.push_back(&op);
+  }
+  std::vector<size_t> parents(ops.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  auto Find = [&parents](size_t i) {
+    while (parents[i] != i) {
+      parents[i] = parents[parents[i]];
+      i = parents[i];
+    }
+    return i;
+  };
+
+  std::unordered_map<Value, size_t> value_to_op;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (ops[i]->num_regions() == 0) {
+      continue;
+    }
+    std::unordered_set<Operation*> nested_ops{ops[i]};
+    ops[i]->Walk([&](Operation* op) { nested_ops.insert(op); });
+    auto IsDefinedAbove = [&](Value value) {
+      if (Operation* defining_op = value.defining_op()) {
+        return nested_ops.count(defining_op) == 0;
+      }
+      auto arg = value.dyn_cast<BlockArgument>();
+      return !arg || nested_ops.count(arg.owner()->GetParentOp()) == 0;
+    };
+    for (Operation* nested_op : nested_ops) {
+      if (nested_op == ops[i]) {
+        // not changed by the passes running on ops[i]
+        continue;
+      }
+      for (uint32_t j = 0; j < nested_op->num_operands(); ++j) {
+        Value value = nested_op->operand_source(j);
+        if (!value || !IsDefinedAbove(value)) {
+          continue;
+        }
+        auto iter = value_to_op.emplace(value, i).first;
+        parents[Find(i)] = Find(iter->second);
+      }
+    }
+  }
+
+  std::unordered_map<size_t, size_t> root_to_group;
+  std::vector<std::vector<Operation*>> groups;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto iter = root_to_group.emplace(Find(i), groups.size()).first;
+    if (iter->second == groups.size()) {
+      groups.emplace_back();
+    }
+    groups[iter->second].push_back(ops[i]);
+  }
+  return groups;
+}
+}  // namespace
+
+bool detail::PassAdaptor::RunParallel(Block* block,
+                                      AnalysisManager am,
+                                      uint8_t opt_level,
+                                      bool verify) {
+  auto groups = GroupIndependentOps(block);
+  size_t num_threads = std::min(pm_->workers_.size(), groups.size());
+  VLOG(4) << "Run the pipeline on " << block->size() << " ops in "
+          << groups.size() << " groups on " << num_threads << " threads";
+
+  std::atomic<size_t> next_group{0};
+  std::atomic<bool> failed{false};
+  std::vector<std::exception_ptr> exceptions(num_threads);
+  auto Worker = [&](size_t thread_id) {
+    const PassManager& pm = *pm_->workers_[thread_id];
+    try {
+      for (size_t i = next_group++; i < groups.size() && !failed;
+           i = next_group++) {
+        for (Operation* op : groups[i]) {
+          AnalysisManagerHolder op_am(op, am.GetPassInstrumentor());
+          if (!RunPipeline(pm, op, op_am, opt_level, verify)) {
+            failed = true;
+            break;
+          }
+        }
+      }
+    } catch (...) {
+      exceptions[thread_id] = std::current_exception();
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(Worker, i);
+  }
+  Worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+  return !failed;
+}
+
 bool detail::PassAdaptor::RunPipeline(const PassManager& pm,
                                       Operation* op,
                                       AnalysisManager am,
@@ -181,7 +326,9 @@ bool detail::PassAdaptor::RunPass(Pass* pass,
 // PassManager
 //----------------------------------------------------------------------------------------------//
 PassManager::PassManager(IrContext* context, uint8_t opt_level)
-    : context_(context), opt_level_(opt_level) {
+    : context_(context),
+      opt_level_(opt_level),
+      num_threads_(FLAGS_pir_pass_num_threads) {
   pass_adaptor_ = std::make_unique<detail::PassAdaptor>(this);
 }
 
@@ -189,9 +336,40 @@ bool PassManager::Run(Program* program) {
   if (!Initialize(context_)) {
     return false;
   }
+  InitializeWorkers();
   return Run(program->module_op());
 }
 
+bool PassManager::InitializeWorkers() {
+  workers_.clear();
+  if (num_threads_ <= 1 || passes_.empty() || instrumentor_) {
+    return false;
+  }
+  std::vector<std::unique_ptr<PassManager>> workers;
+  for (int i = 0; i < num_threads_; ++i) {
+    auto worker = std::make_unique<PassManager>(context_, opt_level_);
+    worker->num_threads_ = 1;
+    worker->verify_ = verify_;
+    worker->disable_log_ = disable_log_;
+    for (auto& pass : passes_) {
+      std::unique_ptr<Pass> clone = pass->IsOpLocal() ? pass->Clone() : nullptr;
+      if (!clone) {
+        VLOG(4) << "Pass " << pass->name()
+                << " is not op local or can not be cloned, run the pipeline "
+                   "sequentially";
+        return false;
+      }
+      worker->AddPass(std::move(clone));
+    }
+    if (!worker->Initialize(context_)) {
+      return false;
+    }
+    workers.push_back(std::move(worker));
+  }
+  workers_ = std::move(workers);
+  return true;
+}
+
 bool PassManager::Run(Operation* op) {
   // Construct a analysis manager for the pipeline.
   AnalysisManagerHolder am(op, instrumentor_.get());
@@ -280,6 +458,16 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
   }
 }
 
+void PassInstrumentor::RunAfterPatternRewrite(
+    Pass* pass, Operation* op, const PatternStatisticsMap& statistics) {
+  if (op->num_regions() == 0) return;
+  for (auto it = impl_->instrumentations.rbegin();
+       it != impl_->instrumentations.rend();
+       ++it) {
+    (*it)->RunAfterPatternRewrite(pass, op, statistics);
+  }
+}
+
 void PassInstrumentor::AddInstrumentation(
     std::unique_ptr<PassInstrumentation> pi) {
   impl_->instrumentations.emplace_back(std::move(pi));
@@ -18,6 +18,7 @@
 
 namespace pir {
 
+class Block;
 class Operation;
 class PassManager;
 
@@ -34,6 +35,12 @@ class PassAdaptor final : public Pass {
  private:
   void RunImpl(Operation* op, uint8_t opt_level, bool verify);
 
+  // Runs the pipeline on the ops of the block on the worker threads.
+  bool RunParallel(Block* block,
+                   AnalysisManager am,
+                   uint8_t opt_level,
+                   bool verify);
+
   static bool RunPass(Pass* pass,
                       Operation* op,
                       AnalysisManager am,
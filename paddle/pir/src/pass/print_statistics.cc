@@ -14,6 +14,9 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "paddle/common/macros.h"
 #include "paddle/pir/include/core/operation.h"
 #include "paddle/pir/include/pass/pass.h"
@@ -56,6 +59,21 @@ class PrintStatistics : public PassInstrumentation {
       }
     }
   }
+
+  void RunAfterPatternRewrite(Pass *pass,
+                              Operation *op,
+                              const PatternStatisticsMap &statistics) override {
+    std::vector<std::pair<std::string, PatternStatistics>> sorted(
+        statistics.begin(), statistics.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+      return a.second.time_us > b.second.time_us;
+    });
+    for (const auto &[name, pattern] : sorted) {
+      LOG(INFO) << "--- pattern [" << name << "]: " << pattern.num_hits
+                << " hits in " << pattern.num_attempts << " attempts, "
+                << pattern.time_us / 1000.0 << " ms";
+    }
+  }
 };
 
 void PassManager::EnablePrintStatistics() {
@@ -73,9 +73,10 @@ bool PatternApplicator::MatchAndRewrite(
     std::function<void(const Pattern&)> on_failure,
     std::function<bool(const Pattern&)> on_success) {
   // whether there are patterns matching this operation type.
-  std::vector<const RewritePattern*> op_patterns;
+  static const std::vector<const RewritePattern*> kEmptyPatterns;
   auto pattern_it = patterns_.find(op->info());
-  if (pattern_it != patterns_.end()) op_patterns = pattern_it->second;
+  const auto& op_patterns =
+      pattern_it != patterns_.end() ? pattern_it->second : kEmptyPatterns;
 
   unsigned op_it = 0, op_e = op_patterns.size();
   unsigned any_it = 0, any_e = any_op_patterns_.size();
@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
@@ -57,8 +58,8 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
 
   std::pair<bool, int64_t> Simplify() {
     int64_t sum_num_rewrites = 0;
-    int64_t num_rewrites = 0;
     int64_t iteration = 0;
+    bool converged = false;
     do {
       // Check if the iteration limit was reached.
       if (iteration++ >= config_.max_iterations &&
@@ -82,10 +83,13 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
         VLOG(6) << "worklist[" << i << "] is " << worklist_[i]->name();
       }
 
-      num_rewrites = ProcessWorklist();
+      int64_t num_rewrites = ProcessWorklist();
       sum_num_rewrites += num_rewrites;
-    } while (num_rewrites != 0);
-    bool converged = num_rewrites == 0;
+      // The ops affected by the rewrites have been revisited, another scan
+      // only finds the changes not notified to the rewriter.
+      converged = worklist_.empty() &&
+                  (num_rewrites == 0 || !config_.rescan_on_change);
+    } while (!converged);
     return std::make_pair(converged, sum_num_rewrites);
   }
 
@@ -107,14 +111,45 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
       // TODO(wilber): fold logical.
       // ...
 
-      bool match_result = matcher_.MatchAndRewrite(op, *this);
+      bool match_result = config_.pattern_statistics
+                              ? MatchAndRewriteWithStatistics(op)
+                              : matcher_.MatchAndRewrite(op, *this);
       if (match_result) {
         ++num_rewrites;
       }
     }
+    // Drop the erased ops left in the worklist.
+    while (!worklist_.empty() && worklist_.back() == nullptr) {
+      worklist_.pop_back();
+    }
     return num_rewrites;
   }
 
+  bool MatchAndRewriteWithStatistics(pir::Operation* op) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start;
+    auto Record = [&](const pir::Pattern& pattern, bool hit) {
+      auto& statistics = (*config_.pattern_statistics)[pattern.debug_name()];
+      ++statistics.num_attempts;
+      statistics.num_hits += hit;
+      statistics.time_us +=
+          std::chrono::duration<double, std::micro>(Clock::now() - start)
+              .count();
+    };
+    return matcher_.MatchAndRewrite(
+        op,
+        *this,
+        [&](const pir::Pattern&) {
+          start = Clock::now();
+          return true;
+        },
+        [&](const pir::Pattern& pattern) { Record(pattern, false); },
+        [&](const pir::Pattern& pattern) {
+          Record(pattern, true);
+          return true;
+        });
+  }
+
   void NotifyRootReplaced(pir::Operation* op,
                           const std::vector<pir::Value>& replacement) override {
     for (uint32_t i = 0; i < op->num_results(); ++i) {
@@ -125,7 +160,10 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     }
   }
 
-  void FinalizeRootUpdate(pir::Operation* op) override { AddToWorklist(op); }
+  void FinalizeRootUpdate(pir::Operation* op) override {
+    AddToWorklist(op);
+    AddProducersToWorklist(op);
+  }
 
   void NotifyOperationRemoved(pir::Operation* op) override {
     for (uint32_t i = 0; i < op->num_operands(); ++i) {
@@ -154,10 +192,25 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     if (config_.strict_mode == pir::GreedyRewriteStrictness::ExistingAndNewOps)
       strict_mode_filtered_ops_.insert(op);
     AddToWorklist(op);
+    AddProducersToWorklist(op);
+  }
+
+  /// Add the defining ops of the operands of the given operation, whose users
+  /// have changed, to the worklist.
+  void AddProducersToWorklist(pir::Operation* op) {
+    for (uint32_t i = 0; i < op->num_operands(); ++i) {
+      auto operand = op->operand_source(i);
+      if (!operand) continue;
+      if (auto* def_op = operand.defining_op()) AddToWorklist(def_op);
+    }
   }
 
   /// Add the given operation to the worklist.
   void AddToWorklist(pir::Operation* op) {
+    // Only the ops of the blocks directly owned by the region are rewritten,
+    // as the scans visit, so a rewrite in a nested region or outside the
+    // region does not bring its ops in.
+    if (!op->GetParent() || op->GetParent()->GetParent() != &region_) return;
     if (config_.strict_mode == pir::GreedyRewriteStrictness::AnyOp ||
         strict_mode_filtered_ops_.count(op)) {
       if (worklist_map_.count(op)) return;
@@ -0,0 +1,279 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Parsing of the numbers of the text data of the datasets, replacing
+// strtoull and strtof in the data feeds.
+//
+// The digits of an uint64 are converted 8 at a time within a 64-bit
+// register. A float with at most 7 significant digits and a decimal exponent
+// within [-10, 10], the common case of the feature values, is converted by a
+// single float multiplication or division, which is correctly rounded as
+// strtof is. Every other input falls back to strtoull or strtof, so the
+// results and the end pointers are always the ones of the C library.
+//
+// The loads of several bytes may read past the terminating '\0' but never
+// cross a page boundary, as done by the string functions of libc.
+
+#if defined(__SANITIZE_ADDRESS__)
+#define PADDLE_NUMBER_PARSER_NO_ASAN __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define PADDLE_NUMBER_PARSER_NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef PADDLE_NUMBER_PARSER_NO_ASAN
+#define PADDLE_NUMBER_PARSER_NO_ASAN
+#endif
+
+namespace paddle {
+namespace string {
+
+namespace detail {
+
+inline bool is_digit(char c) { return static_cast<unsigned>(c - '0') < 10; }
+
+// Whether len bytes from p are in the page of p.
+inline bool in_page(const char* p, size_t len) {
+  return (reinterpret_cast<uintptr_t>(p) & 4095) <= 4096 - len;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PADDLE_NUMBER_PARSER_SWAR 1
+
+PADDLE_NUMBER_PARSER_NO_ASAN inline uint64_t load8(const char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline bool is_eight_digits(uint64_t v) {
+  return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+           (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+          0x3333333333333333ULL);
+}
+
+// The value of the 8 digits in v, the first digit in the lowest byte.
+inline uint32_t parse_eight_digits(uint64_t v) {
+  const uint64_t mask = 0x000000FF000000FFULL;
+  const uint64_t mul1 = 0x000F424000000064ULL;  // 100 + (1000000 << 32)
+  const uint64_t mul2 = 0x0000271000000001ULL;  // 1 + (10000 << 32)
+  v -= 0x3030303030303030ULL;
+  v = (v * 10) + (v >> 8);
+  v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+  return static_cast<uint32_t>(v);
+}
+#endif
+
+}  // namespace detail
+
+// Same as strtoull(str, endptr, 10).
+inline uint64_t fast_strtoull(const char* str, char** endptr) {
+  const char* p = str;
+  while (*p == ' ' || *p == '\t') {
+    ++p;
+  }
+  if (!detail::is_digit(*p)) {
+    return strtoull(str, endptr, 10);
+  }
+  const char* begin = p;
+  uint64_t value = 0;
+#ifdef PADDLE_NUMBER_PARSER_SWAR
+  while (detail::in_page(p, 8)) {
+    uint64_t chunk = detail::load8(p);
+    if (!detail::is_eight_digits(chunk)) {
+      break;
+    }
+    value = value * 100000000ULL + detail::parse_eight_digits(chunk);
+    p += 8;
+  }
+#endif
+  while (detail::is_digit(*p)) {
+    value = value * 10 + static_cast<uint64_t>(*p - '0');
+    ++p;
+  }
+  // 20 digits may overflow
+  if (p - begin > 19) {
+    return strtoull(str, endptr, 10);
+  }
+  if (endptr != nullptr) {
+    *endptr = const_cast<char*>(p);
+  }
+  return value;
+}
+
+// Same as strtof(str, endptr).
+inline float fast_strtof(const char* str, char** endptr) {
+  static const float kPow10[] = {1e0f,
+                                 1e1f,
+                                 1e2f,
+                                 1e3f,
+                                 1e4f,
+                                 1e5f,
+                                 1e6f,
+                                 1e7f,
+                                 1e8f,
+                                 1e9f,
+                                 1e10f};
+  const char* p = str;
+  while (*p == ' ' || *p == '\t') {
+    ++p;
+  }
+  bool negative = false;
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool has_digit = false;
+  for (; detail::is_digit(*p); ++p) {
+    has_digit = true;
+    if (mantissa != 0 || *p != '0') {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      ++digits;
+    }
+  }
+  if (*p == '.') {
+    for (++p; detail::is_digit(*p); ++p) {
+      has_digit = true;
+      if (mantissa != 0 || *p != '0') {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        ++digits;
+      }
+      --exponent;
+    }
+  }
+  if (!has_digit || digits > 18) {
+    return strtof(str, endptr);
+  }
+  if (*p == 'e' || *p == 'E') {
+    const char* q = p + 1;
+    bool exp_negative = false;
+    if (*q == '-' || *q == '+') {
+      exp_negative = *q == '-';
+      ++q;
+    }
+    if (detail::is_digit(*q)) {
+      int exp = 0;
+      for (; detail::is_digit(*q); ++q) {
+        if (exp < 10000) {
+          exp = exp * 10 + (*q - '0');
+        }
+      }
+      exponent += exp_negative ? -exp : exp;
+      p = q;
+    }
+  }
+  // such as the hex floats, the infinities and the nans
+  if (*p == '.' || *p == 'x' || *p == 'X' || (*p | 0x20) == 'n' ||
+      (*p | 0x20) == 'i') {
+    return strtof(str, endptr);
+  }
+  if (mantissa > (1ULL << 24) || exponent < -10 || exponent > 10) {
+    if (mantissa != 0) {
+      return strtof(str, endptr);
+    }
+  }
+  float value = static_cast<float>(mantissa);
+  if (mantissa != 0) {
+    value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+  }
+  if (endptr != nullptr) {
+    *endptr = const_cast<char*>(p);
+  }
+  return negative ? -value : value;
+}
+
+// Returns the end of the n-th token of str, the tokens being separated by
+// spaces or tabs. Returns the end of str if it has less than n tokens, and str
+// if n is 0.
+PADDLE_NUMBER_PARSER_NO_ASAN inline const char* skip_tokens(const char* str,
+                                                           int n) {
+  const char* p = str;
+  if (n <= 0) {
+    return p;
+  }
+  // whether the char before p is a separator
+  bool prev_sep = true;
+#if defined(__AVX2__)
+  constexpr size_t kWidth = 32;
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i zero = _mm256_setzero_si256();
+  while (detail::in_page(p, kWidth)) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t ends_str =
+        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+    uint32_t sep = static_cast<uint32_t>(_mm256_movemask_epi8(
+                       _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                                       _mm256_cmpeq_epi8(v, tab)))) |
+                   ends_str;
+    uint64_t token_ends = sep & ~((sep << 1) | (prev_sep ? 1U : 0U));
+#elif defined(__SSE2__)
+  constexpr size_t kWidth = 16;
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i zero = _mm_setzero_si128();
+  while (detail::in_page(p, kWidth)) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    uint32_t ends_str =
+        static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+    uint32_t sep = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(
+                       _mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)))) |
+                   ends_str;
+    uint64_t token_ends = sep & ~((sep << 1) | (prev_sep ? 1U : 0U));
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    if (ends_str != 0) {
+      // only the tokens before the end of str
+      token_ends &= (ends_str ^ (ends_str - 1));
+    }
+    int count = __builtin_popcountll(token_ends);
+    if (count >= n) {
+      for (int i = 1; i < n; ++i) {
+        token_ends &= token_ends - 1;
+      }
+      return p + __builtin_ctzll(token_ends);
+    }
+    if (ends_str != 0) {
+      return p + __builtin_ctz(ends_str);
+    }
+    n -= count;
+    prev_sep = (sep >> (kWidth - 1)) & 1;
+    p += kWidth;
+  }
+#endif
+  for (; *p != '\0'; ++p) {
+    bool is_sep = *p == ' ' || *p == '\t';
+    if (is_sep && !prev_sep && --n == 0) {
+      return p;
+    }
+    prev_sep = is_sep;
+  }
+  return p;
+}
+
+}  // namespace string
+}  // namespace paddle
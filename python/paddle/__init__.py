@@ -198,6 +198,7 @@ from .tensor.creation import (
     empty,
     empty_like,
     eye,
+    from_numpy,
     full,
     full_like,
     geometric_,
@@ -869,6 +870,7 @@ __all__ = [
     'squeeze',
     'squeeze_',
     'to_tensor',
+    'from_numpy',
     'gather_nd',
     'isin',
     'isinf',
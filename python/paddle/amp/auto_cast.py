@@ -751,6 +751,9 @@ def amp_guard(
                 tracer._amp_dtype = original_amp_dtype
                 if amp_level == AMP_LEVEL.O2:
                     tracer._use_promote = original_use_promote
+                # the casts of the outermost guard are not reused after it
+                if original_amp_level == AMP_LEVEL.O0:
+                    core._clear_amp_cast_cache()
 
 
 class StateDictHook:
@@ -48,6 +48,8 @@ __all__ = [
     "collect_operator_stats",
     "enable_tensor_checker",
     "disable_tensor_checker",
+    "check_deferred_nan_inf",
+    "profile_amp_lists",
     "compare_accuracy",
     "check_layer_numerics",
 ]
@@ -724,3 +726,119 @@ def disable_tensor_checker() -> None:
 
     """
     paddle.set_flags({"FLAGS_check_nan_inf": 0})
+
+
+def check_deferred_nan_inf() -> None:
+    """
+    check_deferred_nan_inf() waits for the GPUs and reports the first Tensor holding NaN or Inf recorded since the last check, when FLAGS_check_nan_inf is set and FLAGS_check_nan_inf_deferred_steps > 0. It raises an error at FLAGS_check_nan_inf_level 0, and prints a warning at the other levels.
+
+    Note:
+        The Tensors on GPU are only recorded in this mode, with no sync of the device. Call it where the program syncs anyway, e.g. after the loss is all-reduced or fetched.
+
+    Examples:
+
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> paddle.device.set_device('gpu')
+
+            >>> paddle.set_flags({"FLAGS_check_nan_inf": 1, "FLAGS_check_nan_inf_level": 1, "FLAGS_check_nan_inf_deferred_steps": 100})
+            >>> x = paddle.to_tensor([1.0, 0.0, 3.0])
+            >>> y = paddle.log(x)
+            >>> paddle.amp.debugging.check_deferred_nan_inf()
+            >>> # The first tensor holding NaN or Inf since the last check is [op=log, tensor=..., check 0].
+    """
+    paddle.base.core.check_deferred_nan_inf()
+
+
+def _max_relative_error(output: Any, reference: Any) -> float:
+    outputs = paddle.utils.flatten(output)
+    references = paddle.utils.flatten(reference)
+    error = 0.0
+    for out, ref in zip(outputs, references):
+        out = out.astype("float32").numpy()
+        ref = ref.astype("float32").numpy()
+        if not np.all(np.isfinite(out)):
+            return float("inf")
+        scale = max(float(np.abs(ref).max(initial=0.0)), 1e-12)
+        diff = float(np.abs(out - ref).max(initial=0.0))
+        error = max(error, diff / scale)
+    return error
+
+
+def profile_amp_lists(
+    func: Callable[[int], Tensor | Sequence[Tensor]],
+    steps: int = 3,
+    dtype: str = "float16",
+    candidate_ops: Sequence[str] | None = None,
+    rtol: float = 1e-2,
+    seed: int = 2024,
+) -> tuple[set[str], set[str], dict[str, float]]:
+    """
+    Measures the numeric error of running each op at ``dtype`` with the
+    others at float32, and derives the lists of ``paddle.amp.auto_cast`` from
+    it. ``func(step)`` runs the forward of a step and returns the Tensors to
+    compare, which are run at float32 as the reference and once with each of
+    the candidate ops in the white list at level O1, with the same random seed
+    for a step.
+
+    Args:
+        func(Callable): The forward of a step, taking the step id.
+        steps(int, optional): The number of steps measured. Default is 3.
+        dtype(str, optional): ``float16`` or ``bfloat16``. Default is
+            ``float16``.
+        candidate_ops(Sequence[str]|None, optional): The ops measured, the
+            default white list of ``dtype`` if None. Default is None.
+        rtol(float, optional): The max relative error of the outputs for an
+            op kept in the white list. Default is 1e-2.
+        seed(int, optional): The random seed of the first step. Default is
+            2024.
+
+    Returns:
+        The ``custom_white_list`` and ``custom_black_list`` of
+        ``paddle.amp.auto_cast``, and the max relative error of each op over
+        the steps.
+
+    Examples:
+
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> paddle.device.set_device('gpu')
+
+            >>> linear = paddle.nn.Linear(16, 16)
+            >>> x = paddle.rand([4, 16])
+            >>> white, black, errors = paddle.amp.debugging.profile_amp_lists(
+            ...     lambda step: paddle.nn.functional.softmax(linear(x)),
+            ...     steps=1,
+            ...     candidate_ops=['matmul_v2', 'softmax'],
+            ... )
+            >>> with paddle.amp.auto_cast(
+            ...     custom_white_list=white, custom_black_list=black
+            ... ):
+            ...     out = paddle.nn.functional.softmax(linear(x))
+    """
+    if candidate_ops is None:
+        candidate_ops = sorted(paddle.amp.amp_lists.white_list()[dtype]["O1"])
+    candidates = set(candidate_ops)
+    errors = dict.fromkeys(candidates, 0.0)
+    with paddle.no_grad():
+        for step in range(steps):
+            paddle.seed(seed + step)
+            reference = func(step)
+            for op in candidates:
+                paddle.seed(seed + step)
+                with paddle.amp.auto_cast(
+                    custom_white_list={op},
+                    custom_black_list=candidates - {op},
+                    level="O1",
+                    dtype=dtype,
+                ):
+                    output = func(step)
+                errors[op] = max(
+                    errors[op], _max_relative_error(output, reference)
+                )
+    white = {op for op, error in errors.items() if error <= rtol}
+    return white, candidates - white, errors
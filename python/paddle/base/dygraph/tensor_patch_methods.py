@@ -43,6 +43,8 @@ from .base import switch_to_static_graph
 from .math_op_patch import monkey_patch_math_tensor
 
 if TYPE_CHECKING:
+    from typing_extensions import CapsuleType
+
     from paddle import Tensor
     from paddle._typing import DTypeLike, PlaceLike, TensorIndex
 
@@ -1330,6 +1332,51 @@ def monkey_patch_tensor():
             "version": 2,
         }
 
+    def __dlpack__(self, stream: int | None = None) -> CapsuleType:
+        """Exports the tensor as a DLPack capsule sharing its memory.
+
+        See:
+        https://data-apis.org/array-api/latest/API_specification/generated/array_api.array.__dlpack__.html
+
+        Args:
+            stream (int|None, optional): the stream the consumer uses the
+                capsule on, which waits for the work queued on the current
+                stream of the tensor. None for the default stream and -1 for
+                no synchronization. On CUDA 1 is the legacy default stream
+                and 2 the per-thread one. Default: None.
+        """
+        if self.is_sparse():
+            raise BufferError(
+                "Can't export a sparse tensor to DLPack. "
+                "Use Tensor.to_dense() to convert to a dense tensor first."
+            )
+        if stream is not None and not self.place.is_gpu_place():
+            if stream != -1:
+                raise BufferError(
+                    "The stream of __dlpack__ should be None for a tensor "
+                    f"not on GPU, but received {stream}."
+                )
+            stream = None
+        return self.value().get_tensor()._to_dlpack(stream)
+
+    def __dlpack_device__(self) -> tuple[int, int]:
+        """Returns the DLPack device type and id of the tensor."""
+        from paddle.utils.dlpack import DLDeviceType
+
+        place = self.place
+        is_rocm = paddle.is_compiled_with_rocm()
+        if place.is_gpu_place():
+            if is_rocm:
+                return (DLDeviceType.kDLROCM, place.gpu_device_id())
+            return (DLDeviceType.kDLCUDA, place.gpu_device_id())
+        if place.is_cuda_pinned_place():
+            if is_rocm:
+                return (DLDeviceType.kDLROCMHost, 0)
+            return (DLDeviceType.kDLCUDAHost, 0)
+        if place.is_cpu_place():
+            return (DLDeviceType.kDLCPU, 0)
+        raise BufferError(f"Can't export a tensor on {place} to DLPack.")
+
     if not hasattr(core, "eager"):
         return
 
@@ -1374,6 +1421,8 @@ def monkey_patch_tensor():
         ("_use_gpudnn", _use_gpudnn),
         ("_md5sum", _md5sum),
         ("__cuda_array_interface__", __cuda_array_interface__),
+        ("__dlpack__", __dlpack__),
+        ("__dlpack_device__", __dlpack_device__),
     ):
         setattr(core.eager.Tensor, method_name, method)
 
@@ -66,6 +66,7 @@ __all__ = [
     'set_stream',
     'stream_guard',
     'synchronize',
+    'set_allocator_replay',
 ]
 
 _cudnn_version = None
@@ -1066,3 +1067,43 @@ def synchronize(device: PlaceLike | None = None) -> None:
                 ",".join(paddle.device.get_all_custom_device_type())
             )
         )
+
+
+def set_allocator_replay(enable: bool, warmup_steps: int = 3) -> None:
+    """
+
+    Enable or disable the allocator replay of the GPU memory. A dygraph training step
+    allocates and frees about the same sequence of tensor sizes each iteration, so the
+    allocator records the sizes requested during the first ``warmup_steps`` steps, and then
+    serves them from prebuilt buffers of the same sizes, skipping the best-fit search of the
+    ``auto_growth`` allocator. It helps the small models whose training is bound by the
+    allocator calls on the CPU.
+
+    A step ends when ``loss.backward()`` finishes. The cached buffers are given back by
+    ``paddle.device.cuda.empty_cache()`` or when the GPU runs out of memory, and dropped
+    when the replay is disabled.
+
+    The replay needs the environment variable ``FLAGS_use_step_replay_allocator=1`` when
+    the process starts, otherwise the allocators are built without it and this is a no-op.
+
+    Args:
+        enable(bool): Whether to enable the allocator replay.
+        warmup_steps(int, optional): The number of steps to record the allocations of
+            before the replay. Default: 3.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> paddle.device.set_device('gpu')
+
+            >>> paddle.device.set_allocator_replay(True)
+            >>> linear = paddle.nn.Linear(16, 16)
+            >>> for _ in range(5):
+            ...     loss = linear(paddle.randn([4, 16])).mean()
+            ...     loss.backward()
+            >>> paddle.device.set_allocator_replay(False)
+
+    """
+    core.set_allocator_replay(enable, warmup_steps)
@@ -25,7 +25,7 @@ from paddle.utils import deprecated
 from .streams import Event, Stream
 
 if TYPE_CHECKING:
-    from paddle import CUDAPlace
+    from paddle import CUDAPlace, Tensor
     from paddle.base.libpaddle import _gpuDeviceProperties
 
     _CudaPlaceLike: TypeAlias = Union[
@@ -44,6 +44,7 @@ __all__ = [
     'max_memory_reserved',
     'memory_allocated',
     'memory_reserved',
+    'place_in_managed_memory',
     'stream_guard',
     'get_device_properties',
     'get_device_name',
@@ -366,6 +367,49 @@ def memory_reserved(device: _CudaPlaceLike | None = None) -> int:
     return core.device_memory_stat_current_value("Reserved", device_id)
 
 
+def place_in_managed_memory(
+    tensor: Tensor,
+    read_mostly: bool = True,
+    device: _CudaPlaceLike | None = None,
+) -> None:
+    '''
+    Move the data of a large tensor, e.g. an embedding table or a KV cache, to CUDA managed memory of the given device,
+    so it may be larger than the device memory.
+
+    The tensors up to FLAGS_managed_memory_prefetch_limit_mb are prefetched to the device before the instructions reading
+    them in static graph mode, see FLAGS_pir_managed_prefetch_lookahead. The larger ones stay on the host and are read
+    by the device remotely. The bytes placed and prefetched are reported by the ``Managed`` and ``Prefetched`` device
+    memory stats.
+
+    Args:
+        tensor(Tensor): The CPU or GPU tensor to move, it is on the device afterwards.
+        read_mostly(bool, optional): Whether the tensor is rarely written, its pages read by the device are then copied
+            to it. Default: True.
+        device(paddle.CUDAPlace|int|str|None, optional): The device, the id of the device or
+            the string name of device like 'gpu:x'. If device is None, the device is the current device.
+            Default: None.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> paddle.device.set_device('gpu')
+
+            >>> embedding = paddle.nn.Embedding(100000, 128)
+            >>> paddle.device.cuda.place_in_managed_memory(embedding.weight)
+    '''
+    name = "paddle.device.cuda.place_in_managed_memory"
+    if not core.is_compiled_with_cuda():
+        raise ValueError(
+            f"The API {name} is not supported in CPU-only PaddlePaddle. Please reinstall PaddlePaddle with GPU support to call this API."
+        )
+    device_id = extract_cuda_device_id(device, op_name=name)
+    if isinstance(tensor, core.eager.Tensor):
+        tensor = tensor.get_tensor()
+    tensor._place_in_managed_memory(device_id, read_mostly)
+
+
 def _set_current_stream(stream: Stream) -> core.CUDAStream:
     '''
     Set the current stream.
@@ -1137,6 +1137,8 @@ class _ShardOptimizer(Optimizer):
             # reset the parameter and grad to right placements
             for p, _ in parameters_and_grads['params']:
                 self._reset_placements(p)
+        if isinstance(self._shard_fn, ShardingStage3):
+            core.prefetch_next_step()
 
     def apply_gradients(self, params_grads):
         new_params_grads = []
@@ -1552,6 +1554,9 @@ class ShardingStage3(_ShardingStageBase):
             )
             # change the holder of param to new shard_param
             param.get_tensor()._share_data_with(shard_param.get_tensor())
+            # the gathers of param are prefetched with
+            # FLAGS_param_prefetch_depth
+            core.register_prefetch_param(param)
 
     def _unshard_parameter(self, param):
         if param.is_dist():
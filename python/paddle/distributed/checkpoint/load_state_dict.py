@@ -20,6 +20,7 @@ from dataclasses import dataclass
 from typing import TYPE_CHECKING
 
 import paddle
+from paddle.base import core
 from paddle.base.framework import (
     _current_expected_place,
 )
@@ -567,7 +568,18 @@ def load_state_dict(
 
         source_state_dict = {}
         for file in local_load_files:
-            if offload:
+            file_path = os.path.join(path, file)
+            if core.is_async_checkpoint_file(file_path):
+                place = (
+                    paddle.CPUPlace()
+                    if offload
+                    else _current_expected_place()
+                )
+                source_state_dict[file] = {
+                    key: core.eager.Tensor(value=value, place=place)
+                    for key, value in core.load_async_checkpoint(file_path)
+                }
+            elif offload:
                 state_dict_numpy = paddle.load(
                     os.path.join(path, file), return_numpy=True
                 )
@@ -13,12 +13,11 @@
 # limitations under the License.
 from __future__ import annotations
 
-import multiprocessing
 import os
-import time
 from typing import TYPE_CHECKING
 
 import paddle
+from paddle.base import core
 from paddle.distributed.communication.group import is_initialized
 from paddle.distributed.fleet.utils.log_util import logger
 
@@ -32,48 +31,22 @@ if TYPE_CHECKING:
     from paddle import Tensor
     from paddle.distributed.collective import Group
 
-async_save_queue = []
+_async_writer = None
 
 
-def check_exitcode(task):
-    exitcode = task.exitcode
-    if exitcode != 0:
-        logger.error(
-            f"Error: save ckpt process failed with exitcode {exitcode}!!!"
-        )
+def _get_async_writer():
+    global _async_writer
+    if _async_writer is None:
+        _async_writer = core.AsyncCheckpointWriter()
+    return _async_writer
 
 
 def clear_async_save_task_queue():
     """
     wait until all async save task to be done.
     """
-    while len(async_save_queue) > 0:
-        task = async_save_queue.pop()
-        if task and task.is_alive():
-            task.join(timeout=60)
-            if task.is_alive():
-                logger.error("Error: save ckpt process timeout!!!")
-                async_save_queue.append(task)
-            else:
-                check_exitcode(task)
-        else:
-            check_exitcode(task)
-
-
-def copy_dict_to_cpu(nested_dict):
-    """
-    Copy the paddle.Tensor objects in the nested dictionary to the CPU and return a new dict.
-    """
-    new_dict = {}
-    for key, value in nested_dict.items():
-        if isinstance(value, paddle.Tensor):
-            new_dict[key] = value.cpu()
-            paddle.device.synchronize()
-        elif isinstance(value, dict):
-            new_dict[key] = copy_dict_to_cpu(value)
-        else:
-            new_dict[key] = value
-    return new_dict
+    if _async_writer is not None:
+        _async_writer.wait()
 
 
 def check_file_name(file_name, process_group):
@@ -148,6 +121,7 @@ def save_state_dict(
     process_group: Group | None = None,
     coordinator_rank: int = 0,
     async_save: bool = False,
+    dedup: bool = False,
 ) -> None:
     """
     Save the state_dict of model to path.
@@ -157,7 +131,8 @@ def save_state_dict(
         path(str): The directory to save state_dict.
         process_group(paddle.distributed.collective.Group): ProcessGroup to be used for cross-rank synchronization. Use the default process group which contains all cards.
         coordinator_rank(int): The rank used to save non distributed values. Rank0 is used by default.
-        async_save(bool): Async save the state_dict, default is False.
+        async_save(bool): Async save the state_dict, default is False. The tensors are snapshotted to pinned memory and written by a background thread, so the training can go on at once. Call ``clear_async_save_task_queue`` to wait for the saves.
+        dedup(bool): With async_save, do not write again the tensors unchanged since the last save to the same path, and refer to the file of that save instead, default is False. The files of the earlier saves should then be kept.
 
     Examples:
         .. code-block:: python
@@ -186,6 +161,9 @@ def save_state_dict(
 
         if not os.path.exists(path):
             os.makedirs(path, exist_ok=True)
+        if async_save:
+            # the file of the last save is written before the name is chosen
+            clear_async_save_task_queue()
 
         use_dist = True if paddle.distributed.get_world_size() > 1 else False
 
@@ -282,30 +260,12 @@ def save_state_dict(
         )
 
         if async_save:
-            cpu_state_dict = copy_dict_to_cpu(local_state_dict)
-            clear_async_save_task_queue()
-
-            attempt = 0
-            ctx = multiprocessing.get_context("spawn")
-
-            def start_process():
-                nonlocal attempt
-                try:
-                    p = ctx.Process(
-                        target=paddle.save,
-                        args=(cpu_state_dict, os.path.join(path, file_name)),
-                    )
-                    p.start()
-                    return p
-                except Exception as e:
-                    logger.error(
-                        f"Attempt {attempt + 1} failed with error: {e}"
-                    )
-                    attempt += 1
-                    time.sleep(1)
-                    return start_process()
-
-            p = start_process()
-            async_save_queue.append(p)
+            names = list(local_state_dict.keys())
+            tensors = [
+                local_state_dict[name].contiguous() for name in names
+            ]
+            _get_async_writer().save(
+                names, tensors, os.path.join(path, file_name), dedup
+            )
         else:
             paddle.save(local_state_dict, os.path.join(path, file_name))
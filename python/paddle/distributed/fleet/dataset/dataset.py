@@ -54,6 +54,7 @@ if TYPE_CHECKING:
     class _InMemoryDatasetSettings(_DatasetBaseSettings):
         data_feed_type: NotRequired[str]
         queue_num: NotRequired[int]
+        data_format: NotRequired[Literal["text", "columnar"]]
 
     class _InMemoryDatasetFullSettings(
         _InMemoryDatasetDistributedSettings, _InMemoryDatasetSettings
@@ -200,6 +201,29 @@ class DatasetBase:
     def _set_input_type(self, input_type):
         self.proto_desc.input_type = input_type
 
+    def _set_data_format(self, data_format):
+        """
+        Set the format of the files, "text" for the text lines parsed by the
+        data feed, "columnar" for the files written by
+        convert_slot_text_to_columnar, which are loaded without parsing and
+        only supported by SlotRecordInMemoryDataFeed.
+
+        Examples:
+            .. code-block:: python
+
+                >>> import paddle
+                >>> dataset = paddle.distributed.fleet.DatasetBase()
+                >>> dataset._set_data_format("columnar")
+
+        Args:
+            data_format(str): "text" or "columnar"
+        """
+        if data_format not in ("text", "columnar"):
+            raise ValueError(
+                f"data_format should be 'text' or 'columnar', but received {data_format}"
+            )
+        self.proto_desc.data_format = data_format
+
     def _set_uid_slot(self, uid_slot):
         """
         Set user slot name.
@@ -633,6 +657,7 @@ class InMemoryDataset(DatasetBase):
             download_cmd(str): customized download command. default is "cat"
             data_feed_type(str): data feed type used in c++ code. default is "MultiSlotInMemoryDataFeed".
             queue_num(int): Dataset output queue num, training threads get data from queues. default is -1, which is set same as thread number in c++.
+            data_format(str): "text" or "columnar", the columnar files are written by convert_slot_text_to_columnar and read by SlotRecordInMemoryDataFeed without parsing. default is "text".
 
         Examples:
             .. code-block:: python
@@ -685,12 +710,14 @@ class InMemoryDataset(DatasetBase):
         fs_ugi = kwargs.get("fs_ugi", "")
         pipe_command = kwargs.get("pipe_command", "cat")
         download_cmd = kwargs.get("download_cmd", "cat")
+        data_format = kwargs.get("data_format", "text")
 
-        if self.use_ps_gpu:
+        if self.use_ps_gpu or data_format == "columnar":
             data_feed_type = "SlotRecordInMemoryDataFeed"
         else:
             data_feed_type = "MultiSlotInMemoryDataFeed"
         self._set_feed_type(data_feed_type)
+        self._set_data_format(data_format)
 
         super().init(
             batch_size=batch_size,
@@ -1780,3 +1807,73 @@ class BoxPSDataset(InMemoryDataset):
 
         """
         self.dataset.postprocess_instance()
+
+
+def convert_slot_text_to_columnar(
+    text_files: list[str],
+    output_file: str,
+    use_var: list[Tensor],
+    with_ins_id: bool = False,
+    block_ins_num: int = 4096,
+    compress_level: int = 1,
+    pipe_command: str = "",
+) -> int:
+    """
+    Converts the text files of slots into one columnar file, which is loaded by
+    InMemoryDataset with data_format="columnar" without parsing the text.
+
+    Every line of the text files is "1 <ins_id> " if with_ins_id, followed by
+    "<num> <value>..." for each variable of use_var, the same as the lines read
+    by SlotRecordInMemoryDataFeed. The broken lines are skipped with a warning.
+
+    Args:
+        text_files(list[str]): the text files, local or on hdfs.
+        output_file(str): the columnar file, local or on hdfs.
+        use_var(list[Tensor]): the variables of the slots in the order of the lines.
+        with_ins_id(bool): if the lines start with an ins_id. default is False.
+        block_ins_num(int): the number of instances per block. default is 4096.
+        compress_level(int): the zlib level to compress the blocks from 1 to 9,
+            0 for no compression. default is 1.
+        pipe_command(str): the command the text files are piped through. default is "".
+
+    Returns:
+        int, the number of the instances written.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +SKIP('No files to read')
+            >>> import paddle
+            >>> from paddle.distributed.fleet.dataset.dataset import convert_slot_text_to_columnar
+            >>> paddle.enable_static()
+
+            >>> slots_vars = [
+            ...     paddle.static.data(
+            ...         name=slot, shape=[None, 1], dtype="int64", lod_level=1)
+            ...     for slot in ["slot1", "slot2"]
+            ... ]
+            >>> convert_slot_text_to_columnar(
+            ...     ["part-00000"], "part-00000.col", slots_vars)
+    """
+    slot_types = []
+    for var in use_var:
+        if var.dtype == paddle.float32:
+            slot_types.append("float")
+        elif var.dtype == paddle.int64:
+            slot_types.append("uint64")
+        else:
+            raise ValueError(
+                "Currently, paddle.distributed.fleet.dataset only supports dtype=float32 and dtype=int64"
+            )
+    writer = core.SlotColumnarWriter(
+        output_file,
+        [var.name for var in use_var],
+        slot_types,
+        with_ins_id,
+        block_ins_num,
+        compress_level,
+    )
+    for text_file in text_files:
+        writer.add_text_file(text_file, pipe_command)
+    writer.close()
+    return writer.ins_num()
@@ -102,3 +102,26 @@ class TreeIndex(Index):
         return self._layerwise_sampler.sample(
             user_input, index_input, with_hierarchy
         )
+
+    def layerwise_sample_batch(
+        self,
+        user_input: list[list[int]],
+        index_input: list[int],
+        with_hierarchy: bool = False,
+        thread_num: int = 1,
+    ) -> list[list[int]]:
+        """
+        The same rows as layerwise_sample, sampled on thread_num threads.
+        """
+        if self._layerwise_sampler is None:
+            raise ValueError("please init layerwise_sampler first.")
+        flat_user_input = [id for user in user_input for id in user]
+        outputs = self._layerwise_sampler.sample_batch(
+            flat_user_input, index_input, with_hierarchy, thread_num
+        )
+        if len(index_input) == 0:
+            return []
+        row_size = len(flat_user_input) // len(index_input) + 2
+        return [
+            outputs[i : i + row_size] for i in range(0, len(outputs), row_size)
+        ]
@@ -413,6 +413,96 @@ class FleetExecutorUtils:
         }
 
 
+_PIPELINE_SCHEDULES = {
+    '1F1B': core.PipelineSchedule.ONE_F_ONE_B,
+    'Interleaved1F1B': core.PipelineSchedule.INTERLEAVED_1F1B,
+    'ZeroBubble': core.PipelineSchedule.ZERO_BUBBLE,
+}
+
+
+def _get_pipeline_schedule(scheduler):
+    assert (
+        scheduler in _PIPELINE_SCHEDULES
+    ), f"The pipeline scheduler must be one of {list(_PIPELINE_SCHEDULES)}, but received {scheduler}."
+    return _PIPELINE_SCHEDULES[scheduler]
+
+
+def predict_bubble_ratio(
+    scheduler, pp_degree, num_micro_batches, num_virtual_stages=1
+):
+    """
+    Predict the idle fraction of a pipeline stage, assuming the forward, the
+    backward of the inputs and the backward of the weights take the same time.
+    :param scheduler: One of 1F1B, Interleaved1F1B and ZeroBubble.
+    :param pp_degree: Number of pipeline stages.
+    :param num_micro_batches: Number of micro batches.
+    :param num_virtual_stages: Number of model chunks per stage.
+    :return: The predicted bubble ratio.
+    """
+    return core.RuntimeGraph.predict_bubble_ratio(
+        _get_pipeline_schedule(scheduler),
+        pp_degree,
+        num_micro_batches,
+        num_virtual_stages,
+    )
+
+
+def run_pipeline_schedule(
+    op_list_map,
+    rank,
+    max_run_times,
+    dist_opt,
+    scheduler='1F1B',
+    num_virtual_stages=1,
+):
+    """
+    Generate the task nodes of current rank with the scheduler on C++ side.
+    :param op_list_map: The op descs of current rank. "lr" and "opt" are lists
+        of op descs, "fwd" and "bwd" are lists with one list of op descs for
+        each model chunk. For ZeroBubble, "bwd" only computes the gradients of
+        the inputs and "bwd_weight" computes the gradients of the weights.
+    :param rank: Current rank (can be got from fleet.worker_index()).
+    :param max_run_times: Max run times for a micro batch. AKA number of micro steps.
+    :param dist_opt: The fleet_opt configured by user.
+    :param scheduler: One of 1F1B, Interleaved1F1B and ZeroBubble.
+    :param num_virtual_stages: Number of model chunks per stage.
+    :return:
+        task_nodes (list): task nodes for current rank
+        task_id_to_rank (dict): task nodes' ids of the pipeline to their ranks
+        runtime_graph (RuntimeGraph): owner of the task nodes, have to be held
+    """
+    coord_sys = CoordSys(dist_opt)
+    coord = coord_sys.rank_to_coord(rank)
+    stage_ranks = []
+    for pp_idx in range(coord_sys.pp_degree):
+        stage_coord = coord.copy()
+        stage_coord['pp_idx'] = pp_idx
+        stage_ranks.append(coord_sys.coord_to_rank(stage_coord))
+    runtime_graph = core.RuntimeGraph()
+    runtime_graph.build_pipeline_graph(
+        _get_pipeline_schedule(scheduler),
+        stage_ranks,
+        coord['pp_idx'],
+        max_run_times,
+        num_virtual_stages,
+        op_list_map.get("lr", []),
+        op_list_map["fwd"],
+        op_list_map["bwd"],
+        op_list_map.get("bwd_weight", []),
+        op_list_map.get("opt", []),
+    )
+    bubble_ratio = runtime_graph.predicted_bubble_ratio()
+    print(
+        f"fleet executor will use C++ side {scheduler} scheduler, "
+        f"the predicted bubble ratio is {bubble_ratio:.4f}."
+    )
+    return (
+        runtime_graph.task_nodes(),
+        runtime_graph.interceptor_id_to_rank(),
+        runtime_graph,
+    )
+
+
 def run1f1b(
     program,
     rank,
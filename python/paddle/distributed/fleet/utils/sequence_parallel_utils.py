@@ -138,6 +138,121 @@ class ReduceScatterOp(PyLayer):
         return all_gather(grad)
 
 
+def _ring_exchange(send_tensor, recv_tensor, group):
+    # send to the next rank of the ring and receive from the previous one
+    rank, nranks = group.rank, group.nranks
+    p2p_ops = [
+        dist.P2POp(
+            dist.isend, send_tensor, group.ranks[(rank + 1) % nranks], group
+        ),
+        dist.P2POp(
+            dist.irecv, recv_tensor, group.ranks[(rank - 1) % nranks], group
+        ),
+    ]
+    return dist.batch_isend_irecv(p2p_ops)
+
+
+def all_gather_matmul(input, weight, group, transpose_y=False):
+    """
+    matmul(all_gather(input), weight) with the first dim of input gathered
+    along a ring, the matmul of a chunk overlaps the send and recv of the
+    next one. Returns the output and all_gather(input).
+    """
+    rank, nranks = group.rank, group.nranks
+    outputs = [None] * nranks
+    chunks = [None] * nranks
+    chunk = input
+    src = rank
+    for step in range(nranks):
+        tasks = []
+        if step < nranks - 1:
+            recv = paddle.empty_like(chunk)
+            tasks = _ring_exchange(chunk, recv, group)
+        outputs[src] = paddle.matmul(chunk, weight, transpose_y=transpose_y)
+        chunks[src] = chunk
+        for task in tasks:
+            task.wait()
+        if step < nranks - 1:
+            chunk = recv
+            src = (src - 1) % nranks
+    return paddle.concat(outputs, axis=0), paddle.concat(chunks, axis=0)
+
+
+def matmul_reduce_scatter(input, weight, group, transpose_y=False):
+    """
+    reduce_scatter(matmul(input, weight)) along the first dim, the partial
+    sums of a chunk are passed along a ring while the matmul of the next
+    chunk runs. At step t rank r adds the chunk r - t - 1, so that it ends
+    with the sum of its own chunk.
+    """
+    rank, nranks = group.rank, group.nranks
+    chunks = paddle.split(input, nranks, axis=0)
+    acc = paddle.matmul(
+        chunks[(rank - 1) % nranks], weight, transpose_y=transpose_y
+    )
+    for step in range(1, nranks):
+        recv = paddle.empty_like(acc)
+        tasks = _ring_exchange(acc, recv, group)
+        partial = paddle.matmul(
+            chunks[(rank - step - 1) % nranks], weight, transpose_y=transpose_y
+        )
+        for task in tasks:
+            task.wait()
+        acc = recv + partial
+    return acc
+
+
+# matmul(all_gather(x), weight) during forward pass, with the allgather
+# overlapped by the matmul
+class AllGatherMatmulOp(PyLayer):
+    # input shape: [s/n, b, h], weight shape: [h, o/n]
+    # after forward shape: [s, b, o/n]
+    @staticmethod
+    def forward(ctx, input, weight, group):
+        output, input_parallel = all_gather_matmul(input, weight, group)
+        ctx.save_for_backward(input_parallel, weight)
+        ctx.group = group
+        return output
+
+    @staticmethod
+    def backward(ctx, grad):
+        input_parallel, weight = ctx.saved_tensor()
+        dinput = matmul_reduce_scatter(
+            grad, weight, ctx.group, transpose_y=True
+        )
+        dweight = paddle.matmul(
+            input_parallel.reshape([-1, input_parallel.shape[-1]]),
+            grad.reshape([-1, grad.shape[-1]]),
+            transpose_x=True,
+        )
+        return dinput, dweight
+
+
+# reduce_scatter(matmul(x, weight)) during forward pass, with the
+# reduce_scatter overlapped by the matmul
+class MatmulReduceScatterOp(PyLayer):
+    # input shape: [s, b, h/n], weight shape: [h/n, o]
+    # after forward shape: [s/n, b, o]
+    @staticmethod
+    def forward(ctx, input, weight, group):
+        ctx.save_for_backward(input, weight)
+        ctx.group = group
+        return matmul_reduce_scatter(input, weight, group)
+
+    @staticmethod
+    def backward(ctx, grad):
+        input, weight = ctx.saved_tensor()
+        dinput, grad_parallel = all_gather_matmul(
+            grad, weight, ctx.group, transpose_y=True
+        )
+        dweight = paddle.matmul(
+            input.reshape([-1, input.shape[-1]]),
+            grad_parallel.reshape([-1, grad_parallel.shape[-1]]),
+            transpose_x=True,
+        )
+        return dinput, dweight
+
+
 ###################################################
 #                                                 #
 #        Modified Parallel Linear Operator        #
@@ -520,6 +635,7 @@ class ColumnSequenceParallelLinear(Layer):
         ]
         self.mp_async_allreduce = mp_configs.mp_async_allreduce
         self.sp_async_reduce_scatter = mp_configs.sp_async_reduce_scatter
+        self.sp_collective_matmul = mp_configs.sp_collective_matmul
         self.recompute_allgather = mp_configs.recompute_allgather
 
         self.mp_fused_linear_param_grad_add = (
@@ -529,7 +645,13 @@ class ColumnSequenceParallelLinear(Layer):
 
     def forward(self, x):
         # sequence parallel is same as tensor parallel, if sequence parallel is true, input shape is [s, b, h], else input shape is [b, s, h]
-        if self.sp_async_reduce_scatter:
+        if self.is_mp and self.sp_collective_matmul:
+            output = AllGatherMatmulOp.apply(
+                x, self.weight, self.model_parallel_group
+            )
+            if self.bias is not None:
+                output = output + self.bias
+        elif self.sp_async_reduce_scatter:
             output = SPInnerOverlapLinear.apply(
                 x,
                 self.weight,
@@ -659,9 +781,21 @@ class RowSequenceParallelLinear(Layer):
             if self.is_mp and has_bias:
                 self.mp_scale = MPScale.apply
 
+        mp_configs = fleet.fleet._user_defined_strategy.hybrid_configs[
+            "mp_configs"
+        ]
+        self.sp_collective_matmul = mp_configs.sp_collective_matmul
+
     def forward(self, x):
         input_parallel = x
-        if self.is_mp:
+        if self.is_mp and self.sp_collective_matmul:
+            output = MatmulReduceScatterOp.apply(
+                input_parallel, self.weight, self.model_parallel_group
+            )
+            # the bias is all-reduced by the hook of sequence parallel
+            if self.bias is not None:
+                output = output + self.bias
+        elif self.is_mp:
             if self.mp_scale is not None:
                 bias = self.mp_scale(self.bias, self.world_size)
             else:
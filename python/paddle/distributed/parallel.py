@@ -257,6 +257,11 @@ class DataParallel(Layer):
                                                 will affect computing performance. Therefore, if all parameters
                                                 are sure to participate in the loss calculation and the
                                                 autograd graph construction, please set it False. Default: False.
+        rebuild_groups(bool, optional): Whether to rebuild the gradient buffers by the order in which the
+                                        gradients are ready in the first iteration, so that the communication
+                                        starts as early as possible in backward. The buffer size is fitted to
+                                        the measured allreduce latency and bandwidth, limited by comm_buffer_size.
+                                        It is ignored when find_unused_parameters is True. Default: False.
 
     Returns:
         Layer: The data paralleled module.
@@ -364,6 +369,7 @@ class DataParallel(Layer):
     """
 
     find_unused_parameters: bool
+    rebuild_groups: bool
     grad_need_sync: bool
     group: Group | None
     var_dtype: Tensor
@@ -378,6 +384,7 @@ class DataParallel(Layer):
         last_comm_buffer_size: float = 1,
         find_unused_parameters: bool = False,
         group: Group | None = None,
+        rebuild_groups: bool = False,
     ) -> None:
         super().__init__(layers.full_name() + "_data_parallel")
 
@@ -387,6 +394,7 @@ class DataParallel(Layer):
 
         self._layers = layers
         self.find_unused_parameters = find_unused_parameters
+        self.rebuild_groups = rebuild_groups
         self.grad_need_sync = True
         self.group = group
         self.var_dtype = core.eager.Tensor
@@ -501,6 +509,7 @@ class DataParallel(Layer):
                 self.group.process_group,
                 [self.last_comm_buffer_size, self.comm_buffer_size],
                 self.find_unused_parameters,
+                self.rebuild_groups,
             )
 
     def _find_tensor(self, obj):
@@ -557,6 +566,54 @@ class DataParallel(Layer):
         finally:
             self.grad_need_sync = tmp_grad_need_sync
 
+    def register_comm_hook(
+        self,
+        hook: str,
+        group_indices: list[int] | None = None,
+        **options: float,
+    ) -> None:
+        """
+        Replace the allreduce of the fused gradients with a communication hook,
+        which compresses the gradients to reduce the communication volume.
+
+        Args:
+            hook(str): The type of the hook, it can be
+
+                - ``'fp16'`` / ``'bf16'``: allreduce float32 gradients in float16 / bfloat16.
+                - ``'powersgd'``: PowerSGD low-rank compression with error feedback.
+                  Options: ``rank`` (default 1), the rank of the approximation;
+                  ``start_iter`` (default 10), the number of steps using plain
+                  allreduce before the compression starts.
+                - ``'topk'``: top-k sparsification with error feedback.
+                  Options: ``ratio`` (default 0.01), the ratio of the gradient
+                  elements sent by each rank.
+                - ``'allreduce'``: restore the default allreduce.
+
+            group_indices(list[int]|None, optional): The indices of the fused gradient
+                groups to register the hook, in the order of their communication.
+                None means all dense groups. Default: None.
+            **options: The options of the hook.
+
+        Examples:
+            .. code-block:: python
+
+                >>> # doctest: +REQUIRES(env:DISTRIBUTED)
+                >>> import paddle
+                >>> import paddle.distributed as dist
+
+                >>> dist.init_parallel_env()
+                >>> model = paddle.nn.Linear(1024, 1024)
+                >>> dp_model = paddle.DataParallel(model)
+                >>> dp_model.register_comm_hook('powersgd', rank=2, start_iter=100)
+
+        """
+        if self._strategy.nranks <= 1:
+            warnings.warn("The comm hook is ignored in single-card operation.")
+            return
+        self._reducer.register_comm_hook(
+            hook, [] if group_indices is None else group_indices, options
+        )
+
     def forward(self, *inputs: Any, **kwargs: Any) -> Tensor:
         outputs = self._layers(*inputs, **kwargs)
         if (
@@ -14,6 +14,7 @@
 
 from __future__ import annotations
 
+import atexit
 import json
 import warnings
 from typing import TYPE_CHECKING, TypedDict
@@ -27,6 +28,7 @@ if TYPE_CHECKING:
     class _Kernel(TypedDict):
         enable: bool
         tuning_range: list[int] | tuple[int, int]
+        cache_file: NotRequired[str]
 
     class _Layout(TypedDict):
         enable: bool
@@ -43,6 +45,8 @@ if TYPE_CHECKING:
 
 __all__ = ['set_config']
 
+_cache_file_saved_at_exit = False
+
 
 def set_config(config: _ConfigKernel | str | None = None) -> None:
     r"""
@@ -54,6 +58,12 @@ def set_config(config: _ConfigKernel | str | None = None) -> None:
 
     - enable(bool): Whether to enable kernel tuning.
     - tuning_range(list): Start and end iteration for auto-tuning. Default: [1, 10].
+    - cache_file(str): The file to load the tuned algorithms from, and to save
+      them to at the end of the tuning range and at exit, so that later runs on
+      the same GPU model, CUDA and cuDNN versions skip the tuning, e.g. an
+      inference predictor starting with the FLAGS_autotune_cache_file of it.
+      The algorithms already in the file are kept. With
+      FLAGS_autotune_cache_read_only the file is only loaded. Default: None.
 
     2. layout: When it is enabled, the best data layout such as NCHW or NHWC will be
     determined based on the device and data type. When the origin layout setting is
@@ -123,6 +133,23 @@ def set_config(config: _ConfigKernel | str | None = None) -> None:
 
     if "kernel" in config_dict:
         kernel_config = config_dict["kernel"]
+        if "cache_file" in kernel_config:
+            if isinstance(kernel_config['cache_file'], str):
+                paddle.set_flags(
+                    {'FLAGS_autotune_cache_file': kernel_config['cache_file']}
+                )
+                core.load_autotune_cache(kernel_config['cache_file'])
+                global _cache_file_saved_at_exit
+                if not _cache_file_saved_at_exit:
+                    # also keeps the algorithms searched after the tuning
+                    # range, e.g. by the cuDNN exhaustive search
+                    atexit.register(core.save_autotune_cache_file)
+                    _cache_file_saved_at_exit = True
+            else:
+                warnings.warn(
+                    "The auto-tuning configuration of the kernel is incorrect."
+                    "The `cache_file` should be str. Use default parameter instead."
+                )
         if "enable" in kernel_config:
             if isinstance(kernel_config['enable'], bool):
                 if kernel_config['enable']:
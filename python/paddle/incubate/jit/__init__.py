@@ -13,5 +13,6 @@
 # limitations under the License.
 
 from .inference_decorator import inference, is_inference_mode  # noqa: F401
+from .lazy_mode import lazy_guard, sync  # noqa: F401
 
 __all__ = []
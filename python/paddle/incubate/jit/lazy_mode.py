@@ -0,0 +1,81 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+import paddle
+from paddle.base import core
+from paddle.base.wrapped_decorator import signature_safe_contextmanager
+
+if TYPE_CHECKING:
+    from collections.abc import Generator
+
+__all__ = []
+
+
+def sync() -> None:
+    """
+    Runs the eager ops recorded by the lazy mode so far, so that the buffers
+    of their outputs are filled. It is done implicitly by ``Tensor.numpy()``,
+    the backward and the ops that are not recorded, and is only needed before
+    the buffers are read by other means, e.g. ``Tensor.data_ptr()`` passed to
+    a C extension.
+    """
+    core.eager._sync_lazy_tensors()
+
+
+@signature_safe_contextmanager
+def lazy_guard(max_ops: int | None = None) -> Generator[None, None, None]:
+    """
+    Records the eager ops without grad in the guard into PIR programs instead
+    of running them one by one. A program is compiled, cached by its
+    structure and run at the next sync point, e.g. ``Tensor.numpy()``, an op
+    that is not recorded, ``max_ops`` recorded ops or the exit of the guard.
+    The values of the tensors are the same as they would be in eager mode.
+
+    Only the elementwise ops, the activations, softmax and matmul of dense
+    tensors are recorded, when no AMP or grad applies to them.
+
+    Args:
+        max_ops (int|None, optional): The max number of ops recorded before
+            they are run. If None, FLAGS_eager_lazy_mode_max_ops is kept.
+            Default: None.
+
+    Examples:
+        .. code-block:: python
+
+            >>> import paddle
+            >>> from paddle.incubate.jit import lazy_guard
+
+            >>> x = paddle.rand([4, 16])
+            >>> w = paddle.rand([16, 16])
+            >>> with lazy_guard():
+            ...     y = paddle.nn.functional.relu(paddle.matmul(x, w) + x) * x
+            >>> print(y.shape)
+            [4, 16]
+    """
+    old_flags = paddle.get_flags(
+        ["FLAGS_eager_lazy_mode", "FLAGS_eager_lazy_mode_max_ops"]
+    )
+    new_flags = {"FLAGS_eager_lazy_mode": True}
+    if max_ops is not None:
+        new_flags["FLAGS_eager_lazy_mode_max_ops"] = max_ops
+    paddle.set_flags(new_flags)
+    try:
+        yield
+    finally:
+        paddle.set_flags(old_flags)
+        sync()
@@ -191,6 +191,36 @@ def _rebuild_cuda_tensor(
     return lodtensor
 
 
+def _rebuild_cuda_arena_tensor(
+    cls,
+    handle,
+    control_name,
+    slot,
+    offset_bytes,
+    size,
+    type_idx,
+    dims,
+    lod,
+    device_idx,
+):
+    # The arena is opened once for each sender in C++, and the received
+    # tensor is not cached, so its block goes back to the sender when it is
+    # freed.
+    return cls._new_shared_cuda_arena(
+        (
+            handle,
+            control_name,
+            slot,
+            offset_bytes,
+            size,
+            type_idx,
+            dims,
+            lod,
+            device_idx,
+        )
+    )
+
+
 def _rebuild_lodtensor_empty(cls):
     # TODO: check if tensor initialized
     # TODO: handle the dtype of empty tensor
@@ -224,8 +254,15 @@ def _reduce_lodtensor(lodtensor):
         lodtensor._shared_incref()
         # TODO, maintain reference for lodtensor
     elif lodtensor._place().is_gpu_place():
-        metadata = lodtensor._share_cuda()
-        rebuild = _rebuild_cuda_tensor
+        metadata = None
+        if paddle.base.core.globals()["FLAGS_cuda_ipc_arena_size_mb"] > 0:
+            # None when the arena is full.
+            metadata = lodtensor._share_cuda_arena()
+        if metadata is not None:
+            rebuild = _rebuild_cuda_arena_tensor
+        else:
+            metadata = lodtensor._share_cuda()
+            rebuild = _rebuild_cuda_tensor
     else:
         raise RuntimeError("We only support pass cpu/gpu lodtensor for now!")
 
@@ -17,6 +17,7 @@ from .block_multihead_attention import (
     block_multihead_attention,
     block_multihead_attention_xpu,  # noqa: F401
 )
+from .fused_beam_search_step import fused_beam_search_step
 from .fused_bias_act import fused_bias_act
 from .fused_dot_product_attention import (
     cudnn_flash_attention,  # noqa: F401
@@ -25,12 +26,13 @@ from .fused_dot_product_attention import (
 from .fused_dropout_add import fused_dropout_add
 from .fused_gate_attention import fused_gate_attention  # noqa: F401
 from .fused_layer_norm import fused_layer_norm
+from .fused_linear_cross_entropy import fused_linear_cross_entropy
 from .fused_matmul_bias import (
     fused_linear,
     fused_linear_activation,
     fused_matmul_bias,
 )
-from .fused_moe import fused_moe
+from .fused_moe import fused_moe, moe_grouped_gemm
 from .fused_rms_norm import fused_rms_norm
 from .fused_rotary_position_embedding import fused_rotary_position_embedding
 from .fused_transformer import (
@@ -52,8 +54,11 @@ __all__ = [
     'fused_matmul_bias',
     'fused_linear',
     'fused_linear_activation',
+    'fused_linear_cross_entropy',
+    'fused_beam_search_step',
     'fused_bias_dropout_residual_layer_norm',
     'fused_moe',
+    'moe_grouped_gemm',
     'fused_dropout_add',
     'fused_rotary_position_embedding',
     'variable_length_memory_efficient_attention',
@@ -0,0 +1,124 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from paddle import _C_ops
+from paddle.base.layer_helper import LayerHelper
+from paddle.framework import in_dynamic_or_pir_mode
+
+
+def fused_beam_search_step(
+    logits,
+    pre_scores,
+    pre_finished,
+    pre_lengths,
+    end_id,
+    length_penalty=0.0,
+    name=None,
+):
+    """
+    Runs a step of beam search on the GPU, with the beams of the batch in a
+    dense [batch, beam] layout instead of a LoD. The log-softmax of the
+    logits, the top ``beam`` tokens of each beam, and the top ``beam`` of the
+    ``beam * beam`` candidates of each batch are computed by the kernels of
+    the step, with no host side bookkeeping.
+
+    The candidates are ranked by their accumulated log probabilities divided
+    by the length penalty ``((5 + length) / 6) ** length_penalty``. A
+    finished beam only proposes ``end_id``, keeping its score and length.
+    In the first step, the beams of a batch are the same, so ``pre_scores``
+    should be 0 for the first beam and ``-inf`` for the others.
+
+    The selected beams of all the steps can be traced back with
+    :ref:`api_paddle_nn_functional_gather_tree` from ``selected_ids`` and
+    ``parent_idx``, and a cache of [batch * beam, ...] is reordered with
+    ``paddle.index_select(cache, cache_indices)``.
+
+    Args:
+        logits (Tensor): the logits of the next token. Its shape is [batch, beam, vocab], and its dtype is float32, float16 or bfloat16.
+        pre_scores (Tensor): the accumulated log probabilities of the beams. Its shape is [batch, beam], and its dtype is float32.
+        pre_finished (Tensor): whether the beams are finished. Its shape is [batch, beam], and its dtype is bool.
+        pre_lengths (Tensor): the lengths of the beams. Its shape is [batch, beam], and its dtype is int64.
+        end_id (int): the id of the end token.
+        length_penalty (float, optional): the exponent of the length penalty. Default: 0.0, no penalty.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        tuple: ``(selected_ids, selected_scores, finished, lengths, parent_idx, cache_indices)``. The first five are of [batch, beam]: the selected tokens of int64, their accumulated scores of float32, whether the beams are finished, their lengths of int64, and the beams in the batch they come from, of int64. ``cache_indices`` is ``batch_index * beam + parent_idx`` of [batch * beam], of int64.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.incubate.nn.functional import fused_beam_search_step
+
+            >>> paddle.set_device('gpu')
+            >>> batch, beam, vocab = 2, 4, 100
+            >>> logits = paddle.randn([batch, beam, vocab])
+            >>> scores = paddle.full([batch, beam], float('-inf'))
+            >>> scores[:, 0] = 0.0
+            >>> finished = paddle.zeros([batch, beam], dtype='bool')
+            >>> lengths = paddle.zeros([batch, beam], dtype='int64')
+            >>> ids, scores, finished, lengths, parents, cache_indices = (
+            ...     fused_beam_search_step(logits, scores, finished, lengths, 1)
+            ... )
+            >>> print(ids.shape, cache_indices.shape)
+            [2, 4] [8]
+
+    """
+    if in_dynamic_or_pir_mode():
+        return _C_ops.fused_beam_search_step(
+            logits,
+            pre_scores,
+            pre_finished,
+            pre_lengths,
+            end_id,
+            length_penalty,
+        )
+
+    helper = LayerHelper('fused_beam_search_step', **locals())
+    selected_ids = helper.create_variable_for_type_inference(dtype='int64')
+    selected_scores = helper.create_variable_for_type_inference(
+        dtype='float32'
+    )
+    finished = helper.create_variable_for_type_inference(dtype='bool')
+    lengths = helper.create_variable_for_type_inference(dtype='int64')
+    parent_idx = helper.create_variable_for_type_inference(dtype='int64')
+    cache_indices = helper.create_variable_for_type_inference(dtype='int64')
+    helper.append_op(
+        type='fused_beam_search_step',
+        inputs={
+            'logits': logits,
+            'pre_scores': pre_scores,
+            'pre_finished': pre_finished,
+            'pre_lengths': pre_lengths,
+        },
+        outputs={
+            'selected_ids': selected_ids,
+            'selected_scores': selected_scores,
+            'finished': finished,
+            'lengths': lengths,
+            'parent_idx': parent_idx,
+            'cache_indices': cache_indices,
+        },
+        attrs={'end_id': end_id, 'length_penalty': length_penalty},
+    )
+    return (
+        selected_ids,
+        selected_scores,
+        finished,
+        lengths,
+        parent_idx,
+        cache_indices,
+    )
@@ -0,0 +1,113 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from paddle import _C_ops
+from paddle.base.layer_helper import LayerHelper
+from paddle.framework import in_dynamic_or_pir_mode
+
+
+def fused_linear_cross_entropy(
+    x,
+    weight,
+    label,
+    ignore_index=-100,
+    chunk_size=8192,
+    reduction='mean',
+    group=None,
+    name=None,
+):
+    """
+    Computes the softmax cross entropy of the logits ``matmul(x, weight)``
+    without materializing them. The logits are computed ``chunk_size``
+    columns of the vocab at a time, merged into an online log-sum-exp, and
+    computed again in the backward, so that only a [rows, chunk_size] block
+    of them is ever kept instead of [rows, vocab].
+
+    With ``group``, ``weight`` is the shard [hidden, vocab / nranks] of the
+    vocab held by this rank, as in a column parallel linear, and ``label``
+    is the index in the whole vocab. The log-sum-exp of the ranks is reduced
+    over ``group``. The gradient of ``x`` is then the one of the local shard
+    only, so ``x`` is passed through ``_c_identity`` to all-reduce it.
+
+    Args:
+        x (Tensor): the hidden states. Its shape is [..., hidden], and its dtype is float32, float16 or bfloat16.
+        weight (Tensor): the weight of the output projection. Its shape is [hidden, vocab], and its dtype is the one of ``x``.
+        label (Tensor): the labels. Its shape is [...] or [..., 1], and its dtype is int32 or int64.
+        ignore_index (int, optional): the label whose loss and gradient are zero. Default: -100.
+        chunk_size (int, optional): the columns of the vocab computed at a time. Default: 8192.
+        reduction (str, optional): 'mean' over the labels not ignored, 'sum' or 'none'. Default: 'mean'.
+        group (Group, optional): the group of the ranks sharing the vocab. Default: None.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor: the loss, of float32. Its shape is [..., 1] if ``reduction`` is 'none', or [] otherwise.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.incubate.nn.functional import fused_linear_cross_entropy
+
+            >>> paddle.set_device('gpu')
+            >>> x = paddle.randn([4, 16, 64], dtype=paddle.float16)
+            >>> weight = paddle.randn([64, 1000], dtype=paddle.float16)
+            >>> label = paddle.randint(0, 1000, [4, 16])
+            >>> loss = fused_linear_cross_entropy(x, weight, label, chunk_size=256)
+            >>> print(loss.shape)
+            []
+
+    """
+    if reduction not in ['mean', 'sum', 'none']:
+        raise ValueError(
+            "The value of 'reduction' in fused_linear_cross_entropy should be "
+            f"'sum', 'mean' or 'none', but received {reduction}."
+        )
+    ring_id, rank, nranks = 0, 0, 1
+    if group is not None:
+        from paddle.distributed.fleet.layers.mpu import mp_ops
+
+        ring_id = group.id
+        rank = group.rank
+        nranks = group.nranks
+        x = mp_ops._c_identity(x, group=group)
+
+    if in_dynamic_or_pir_mode():
+        loss = _C_ops.fused_linear_cross_entropy(
+            x, weight, label, ignore_index, chunk_size, ring_id, rank, nranks
+        )
+    else:
+        helper = LayerHelper('fused_linear_cross_entropy', **locals())
+        loss = helper.create_variable_for_type_inference(dtype='float32')
+        lse = helper.create_variable_for_type_inference(dtype='float32')
+        helper.append_op(
+            type='fused_linear_cross_entropy',
+            inputs={'x': x, 'weight': weight, 'label': label},
+            outputs={'loss': loss, 'lse': lse},
+            attrs={
+                'ignore_index': ignore_index,
+                'chunk_size': chunk_size,
+                'ring_id': ring_id,
+                'rank': rank,
+                'nranks': nranks,
+            },
+        )
+
+    if reduction == 'none':
+        return loss
+    if reduction == 'sum':
+        return paddle.sum(loss)
+    count = paddle.sum(paddle.cast(label != ignore_index, 'float32'))
+    return paddle.sum(loss) / paddle.clip(count, min=1.0)
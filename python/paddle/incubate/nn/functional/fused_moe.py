@@ -116,3 +116,57 @@ def fused_moe(
             },
         )
         return final_out
+
+
+def moe_grouped_gemm(x, weight, tokens_per_expert, name=None):
+    """
+    Applies the matmul of every expert of a Mixture-of-Experts layer to its
+    tokens in a single grouped gemm launch, instead of a matmul per expert.
+    This method requires SM_ARCH in sm75, sm80, sm86.
+
+    The rows of ``x`` are the tokens permuted to be sorted by expert, e.g. by
+    the ``argsort`` of their expert ids, where the first
+    ``tokens_per_expert[0]`` rows go to expert 0, the next
+    ``tokens_per_expert[1]`` rows to expert 1, and so on. The out row of a
+    token is its row of ``x`` multiplied by the weight of its expert.
+
+    Args:
+        x (Tensor): the tokens sorted by expert. Its shape is [total_rows, k], and its dtype is float16 or bfloat16.
+        weight (Tensor): the weights of the experts. Its shape is [num_experts, k, n].
+        tokens_per_expert (Tensor): the number of the tokens of each expert, which sum up to total_rows. Its shape is [num_experts], and its dtype is int32 or int64.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor: the output Tensor. Its shape is [total_rows, n].
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.incubate.nn.functional import moe_grouped_gemm
+
+            >>> paddle.set_device('gpu')
+            >>> x = paddle.randn([10, 64], dtype=paddle.float16)
+            >>> weight = paddle.randn([4, 64, 128], dtype=paddle.float16)
+            >>> tokens_per_expert = paddle.to_tensor([3, 0, 5, 2], dtype=paddle.int64)
+            >>> out = moe_grouped_gemm(x, weight, tokens_per_expert)
+            >>> print(out.shape)
+            [10, 128]
+
+    """
+    if in_dynamic_or_pir_mode():
+        return _C_ops.moe_grouped_gemm(x, weight, tokens_per_expert)
+    else:
+        helper = LayerHelper('moe_grouped_gemm', **locals())
+        out = helper.create_variable_for_type_inference(dtype=x.dtype)
+        helper.append_op(
+            type='moe_grouped_gemm',
+            inputs={
+                'x': x,
+                'weight': weight,
+                'tokens_per_expert': tokens_per_expert,
+            },
+            outputs={'out': out},
+        )
+        return out
@@ -13,8 +13,10 @@
 # limitations under the License.
 
 from paddle.base.core import (
+    BlockKVCacheManager,
     InternalUtils,  # noqa: F401
     PredictorPool,
+    SpeculativeDecoder,
     XpuConfig,
     _get_phi_kernel_name,
     create_predictor,
@@ -50,4 +52,6 @@ __all__ = [
     'get_num_bytes_of_data_type',
     'PredictorPool',
     'XpuConfig',
+    'BlockKVCacheManager',
+    'SpeculativeDecoder',
 ]
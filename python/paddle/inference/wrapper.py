@@ -107,7 +107,8 @@ def convert_to_mixed_precision(
         params_file: fp32 params file, e.g. inference.pdiparams.
         mixed_model_file: The storage path of the converted mixed-precision model.
         mixed_params_file: The storage path of the converted mixed-precision params.
-        mixed_precision: The precision, e.g. PrecisionType.Half.
+        mixed_precision: The precision, e.g. PrecisionType.Half. PrecisionType.Float8
+            converts the model to fp16 and runs the gemms of its 2-D weights in fp8.
         backend: The backend, e.g. PlaceType.GPU.
         keep_io_types: Whether the model input and output dtype remains unchanged.
             Default is True.
@@ -22,6 +22,7 @@ from .dataloader import (
     Dataset,
     DistributedBatchSampler,
     IterableDataset,
+    PackedBatchSampler,
     RandomSampler,
     Sampler,
     SequenceSampler,
@@ -30,6 +31,7 @@ from .dataloader import (
     TensorDataset,
     WeightedRandomSampler,
     get_worker_info,
+    packed_collate_fn,
     random_split,
 )
 from .reader import DataLoader
@@ -42,6 +44,8 @@ __all__ = [
     'ChainDataset',
     'BatchSampler',
     'DistributedBatchSampler',
+    'PackedBatchSampler',
+    'packed_collate_fn',
     'DataLoader',
     'get_worker_info',
     'Sampler',
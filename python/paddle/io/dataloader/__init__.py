@@ -15,7 +15,9 @@
 from .batch_sampler import (  # noqa: F401
     BatchSampler,
     DistributedBatchSampler,
+    PackedBatchSampler,
 )
+from .collate import packed_collate_fn  # noqa: F401
 from .dataset import (  # noqa: F401
     ChainDataset,
     ComposeDataset,
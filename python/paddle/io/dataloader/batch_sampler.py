@@ -14,6 +14,7 @@
 
 from __future__ import annotations
 
+import bisect
 import math
 from typing import (
     Iterable,
@@ -406,3 +407,131 @@ class DistributedBatchSampler(BatchSampler):
                 ...     sampler.set_epoch(epoch)
         """
         self.epoch = epoch
+
+
+class PackedBatchSampler(Sampler[Sequence[int]]):
+    """
+    A batch sampler for the samples of sequences of different lengths, which
+    packs the samples into mini-batches of at most :attr:`max_tokens` tokens
+    instead of padding a fixed number of samples to the longest one.
+
+    The sample indices are taken :attr:`bucket_size` at a time, sorted by
+    length and packed best fit decreasing, so that the packed mini-batches are
+    nearly full while the order of the samples stays random across the
+    buckets. Use it with :ref:`api_paddle_io_packed_collate_fn`, whose
+    ``cu_seqlens`` and ``position_ids`` feed the varlen attention, e.g.
+    ``paddle.nn.functional.flash_attn_unpadded`` with :attr:`max_tokens` as
+    its max sequence length, and ``fused_rotary_position_embedding``.
+
+    Args:
+        lengths(Sequence[int]): the number of tokens of each sample of the
+            dataset, none of which may be more than :attr:`max_tokens`.
+        max_tokens(int): the most tokens of a mini-batch.
+        shuffle(bool, optional): whether to shuffle the samples and the
+            mini-batches of each epoch. Default False.
+        bucket_size(int, optional): the number of samples packed together.
+            Default 1024.
+        drop_last(bool, optional): whether to drop the least full mini-batch
+            of each bucket if it is less than half full. Default False.
+
+    Returns:
+        PackedBatchSampler: an iterable object for indices iterating
+
+    Examples:
+
+        .. code-block:: python
+
+            >>> from paddle.io import PackedBatchSampler
+
+            >>> lengths = [5, 3, 8, 2, 6, 4]
+            >>> bs = PackedBatchSampler(lengths, max_tokens=10)
+            >>> for batch_indices in bs:
+            ...     print(batch_indices)
+            [2, 3]
+            [4, 5]
+            [0, 1]
+    """
+
+    lengths: np.ndarray
+    max_tokens: int
+    shuffle: bool
+    bucket_size: int
+    drop_last: bool
+
+    def __init__(
+        self,
+        lengths: Sequence[int],
+        max_tokens: int,
+        shuffle: bool = False,
+        bucket_size: int = 1024,
+        drop_last: bool = False,
+    ) -> None:
+        assert (
+            isinstance(max_tokens, int) and max_tokens > 0
+        ), f"max_tokens should be a positive integer, but got {max_tokens}"
+        assert (
+            isinstance(bucket_size, int) and bucket_size > 0
+        ), f"bucket_size should be a positive integer, but got {bucket_size}"
+        self.lengths = np.asarray(lengths, dtype='int64')
+        assert self.lengths.ndim == 1, "lengths should be a 1-D sequence"
+        if len(self.lengths) > 0 and (
+            self.lengths.max() > max_tokens or self.lengths.min() < 1
+        ):
+            raise ValueError(
+                f"the lengths of the samples should be in [1, {max_tokens}], "
+                f"but got [{self.lengths.min()}, {self.lengths.max()}]"
+            )
+        self.max_tokens = max_tokens
+        self.shuffle = shuffle
+        self.bucket_size = bucket_size
+        self.drop_last = drop_last
+        # the mini-batches of the next epoch, so that __len__ matches them
+        self._batches = None
+
+    def _pack(self) -> list[list[int]]:
+        if self.shuffle:
+            indices = np.random.permutation(len(self.lengths))
+        else:
+            indices = np.arange(len(self.lengths))
+        batches = []
+        for begin in range(0, len(indices), self.bucket_size):
+            bucket = indices[begin : begin + self.bucket_size]
+            # stable, so that the order of the samples of a length is kept
+            bucket = bucket[
+                np.argsort(-self.lengths[bucket], kind='stable')
+            ].tolist()
+            bins = []
+            # the (free tokens, bin) of the bins, sorted
+            free = []
+            for idx in bucket:
+                length = int(self.lengths[idx])
+                pos = bisect.bisect_left(free, (length, -1))
+                if pos == len(free):
+                    bins.append([idx])
+                    bisect.insort(
+                        free, (self.max_tokens - length, len(bins) - 1)
+                    )
+                else:
+                    tokens, bin_id = free.pop(pos)
+                    bins[bin_id].append(idx)
+                    bisect.insort(free, (tokens - length, bin_id))
+            if self.drop_last and len(free) > 0 and free[-1][0] * 2 > (
+                self.max_tokens
+            ):
+                # the least full bin
+                bins.pop(free[-1][1])
+            batches.extend(bins)
+        if self.shuffle:
+            np.random.shuffle(batches)
+        return batches
+
+    def __iter__(self) -> Iterator[list[int]]:
+        if self._batches is None:
+            self._batches = self._pack()
+        batches, self._batches = self._batches, None
+        yield from batches
+
+    def __len__(self) -> int:
+        if self._batches is None:
+            self._batches = self._pack()
+        return len(self._batches)
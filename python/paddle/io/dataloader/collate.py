@@ -109,3 +109,69 @@ def default_convert_fn(batch):
         return [default_convert_fn(d) for d in batch]
     else:
         return batch
+
+
+def packed_collate_fn(batch):
+    """
+    Batch collating function for the mini-batches of
+    :ref:`api_paddle_io_PackedBatchSampler`, which concatenates the samples
+    of sequences into one sequence instead of padding and stacking them, so
+    that no token of the mini-batch is padding. Each sample should be a
+    dictionary or a list of numpy arrays whose first dimension is the length
+    of the sample, e.g. for following input data:
+
+    [{'input_ids': np.array(shape=[5]), 'labels': np.array(shape=[5])},
+     {'input_ids': np.array(shape=[3]), 'labels': np.array(shape=[3])}]
+
+    the fields are concatenated, and the int32 ``cu_seqlens`` of the offsets
+    of the samples and the int64 ``position_ids`` restarting at each sample
+    are added as follows:
+
+    {'input_ids': np.array(shape=[8]), 'labels': np.array(shape=[8]),
+     'cu_seqlens': np.array([0, 5, 8]),
+     'position_ids': np.array([0, 1, 2, 3, 4, 0, 1, 2])}
+
+    List samples get ``cu_seqlens`` and ``position_ids`` appended in this
+    order.
+
+    Args:
+        batch(list of sample data): batch should be a list of sample data.
+
+    Returns:
+        Packed data: the concatenated fields of the samples, with the
+                     ``cu_seqlens`` and ``position_ids`` of them.
+    """
+    sample = batch[0]
+    if isinstance(sample, Mapping):
+        fields = list(sample.keys())
+        columns = [[d[key] for d in batch] for key in fields]
+    elif isinstance(sample, Sequence):
+        if not all(len(d) == len(sample) for d in batch):
+            raise RuntimeError(
+                "fields number not same among samples in a batch"
+            )
+        columns = [list(c) for c in zip(*batch)]
+    else:
+        raise TypeError(
+            "packed batch data can only contain: dict and list of "
+            f"numpy.ndarray, but got {type(sample)}"
+        )
+    columns = [[np.asarray(v) for v in c] for c in columns]
+    lengths = np.array([len(v) for v in columns[0]], dtype='int64')
+    for c in columns[1:]:
+        if any(len(v) != n for v, n in zip(c, lengths)):
+            raise RuntimeError(
+                "the fields of a sample should be of the same length"
+            )
+    cu_seqlens = np.zeros([len(lengths) + 1], dtype='int32')
+    cu_seqlens[1:] = np.cumsum(lengths)
+    position_ids = np.arange(cu_seqlens[-1], dtype='int64') - np.repeat(
+        cu_seqlens[:-1].astype('int64'), lengths
+    )
+    packed = [np.concatenate(c, axis=0) for c in columns]
+    if isinstance(sample, Mapping):
+        result = dict(zip(fields, packed))
+        result['cu_seqlens'] = cu_seqlens
+        result['position_ids'] = position_ids
+        return result
+    return [*packed, cu_seqlens, position_ids]
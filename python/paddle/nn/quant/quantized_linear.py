@@ -48,9 +48,8 @@ def _get_arch_info():
         arch = int(major * 10 + minor)
         return arch
     else:
-        raise ValueError(
-            "Paddle is not compiled with CUDA, we cannot get SMVersion from device, please try to compile Paddle with CUDA"
-        )
+        # the layout of the CPU kernel of weight_only_linear
+        return 0
 
 
 def weight_quantize(
@@ -66,7 +65,7 @@ def weight_quantize(
         x (Tensor): The input Tensor to be quantized, the data type is float16 or bfloat16.
         algo (str): The algo that is x will be apply, must be one of 'weight_only_int8',
             'weight_only_int4' and 'llm.int8', default: 'weight_only_int8'.
-        arch (int): The compute arch for target device. For example, A100 is 80, v100 is 70, if you do not assign arch, we will get arch from your device, default: None.
+        arch (int): The compute arch for target device. For example, A100 is 80, v100 is 70, and CPU is 0, if you do not assign arch, we will get arch from your device, default: None.
         group_size (int): The group size for weight quantization. -1 stands for default per-channel mode. Currently only support 64 or 128.
 
     Returns:
@@ -91,14 +90,15 @@ def weight_quantize(
         arch = _get_arch_info()
 
     assert (
-        arch == 70
+        arch == 0
+        or arch == 70
         or arch == 75
         or arch == 80
         or arch == 86
         or arch == 89
         or arch == 90
         or paddle.is_compiled_with_rocm()
-    ), f"Currently weight_quantize only support SM70/75/80/86/89/90. but got {arch} "
+    ), f"Currently weight_quantize only support CPU(0) and SM70/75/80/86/89/90. but got {arch} "
 
     assert (
         group_size == -1 or group_size == 64 or group_size == 128
@@ -200,7 +200,7 @@ def weight_only_linear(
             be performed. Otherwise, The bias is added to the matrix multiplication result.
         weight_scale (Tensor|None): The input scale Tensor Provided to weight for dequantization. Its rank must be 1.
         weight_dtype(str): The dtype of  weight Tensor, must be one of 'int8', 'int4', Defaulted to 'int8'.
-        arch (int): The compute arch for target device. For example, A100 is 80, v100 is 70, if you do not assign arch, we will get arch from your device, default: None.
+        arch (int): The compute arch for target device. For example, A100 is 80, v100 is 70, and CPU is 0, if you do not assign arch, we will get arch from your device, default: None.
         group_size (int): The group size for weight quantization. -1 stands for default per-channel mode. Currently only support 64 or 128.
     Returns:
         Tensor: the output Tensor, the data type is the same as that of x.
@@ -225,13 +225,14 @@ def weight_only_linear(
         arch = _get_arch_info()
 
     assert (
-        arch == 70
+        arch == 0
+        or arch == 70
         or arch == 75
         or arch == 80
         or arch == 86
         or arch == 89
         or arch == 90
-    ), f"Currently weight_quantize only support SM70/75/80/86/89/90. but got {arch} "
+    ), f"Currently weight_quantize only support CPU(0) and SM70/75/80/86/89/90. but got {arch} "
     assert (
         group_size == -1 or group_size == 64 or group_size == 128
     ), f"Currently weight_quantize only support group size of -1, 64 or 128. but got {group_size} "
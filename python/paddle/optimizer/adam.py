@@ -54,6 +54,79 @@ if TYPE_CHECKING:
 
 __all__ = []
 
+# The number of elements a thread block of fused_adam_ updates.
+_FUSED_ADAM_CHUNK_SIZE = 32 * 2048
+
+
+def _param_lr_key(param):
+    # the parameters of the same learning rate ratio share the learning rate
+    attr = getattr(param, 'optimize_attr', None)
+    lr = 1.0 if attr is None else attr['learning_rate']
+    return lr if isinstance(lr, (int, float)) else id(lr)
+
+
+def _use_fused_adam(params):
+    return (
+        core.is_compiled_with_cuda()
+        and len(params) > 0
+        and params[0].place.is_gpu_place()
+    )
+
+
+def _append_fused_adam_ops(
+    params,
+    grads,
+    lrs,
+    moments1,
+    moments2,
+    beta1_pows,
+    beta2_pows,
+    master_weights,
+    beta1,
+    beta2,
+    epsilon,
+    weight_decays,
+    use_adamw,
+):
+    """
+    Updates the parameters by fused_adam_, which applies Adam to the chunks of
+    a list of tensors in one kernel launch, with a launch for each group of
+    the parameters sharing the learning rate, the weight decay and the beta
+    pows. fused_adam_ takes the beta pows of the first parameter for its whole
+    list, while those of a parameter lag behind when it misses the gradients
+    of some steps. The moments and the beta pows are of float32 for the
+    float16 and bfloat16 parameters.
+    """
+    groups = defaultdict(list)
+    for i, (param, decay) in enumerate(zip(params, weight_decays)):
+        # the beta pows are on the CPU, reading them does not sync the GPU
+        beta_pows = (float(beta1_pows[i]), float(beta2_pows[i]))
+        groups[(_param_lr_key(param), decay, beta_pows)].append(i)
+    for (_, decay, _), ids in groups.items():
+
+        def pick(tensors):
+            return [tensors[i] for i in ids]
+
+        _C_ops.fused_adam_(
+            pick(params),
+            pick(grads),
+            lrs[ids[0]],
+            pick(moments1),
+            pick(moments2),
+            pick(beta1_pows),
+            pick(beta2_pows),
+            None if master_weights is None else pick(master_weights),
+            None,
+            beta1,
+            beta2,
+            epsilon,
+            _FUSED_ADAM_CHUNK_SIZE,
+            decay,
+            use_adamw,
+            master_weights is not None,
+            False,
+        )
+
 
 class Adam(Optimizer):
     r"""
@@ -756,8 +829,27 @@ class Adam(Optimizer):
                             found_inf, (core.eager.Tensor, pir.Value)
                         ):
                             self._set_auxiliary_var('found_inf', False)
+                        params = self._param_dict[key][param_group_idx]
+                        if _use_fused_adam(params):
+                            # merged_adam_ launches kernels per parameter
+                            _append_fused_adam_ops(
+                                params,
+                                grad_dict[key],
+                                lr_dict[key],
+                                self._moment1_dict[key][param_group_idx],
+                                self._moment2_dict[key][param_group_idx],
+                                self._beta1_pow_acc_dict[key][param_group_idx],
+                                self._beta2_pow_acc_dict[key][param_group_idx],
+                                master_weight if find_master else None,
+                                _beta1,
+                                _beta2,
+                                self._epsilon,
+                                [0.0] * len(params),
+                                False,
+                            )
+                            continue
                         _, _, _, _, _, _ = _C_ops.merged_adam_(
-                            self._param_dict[key][param_group_idx],
+                            params,
                             grad_dict[key],
                             lr_dict[key],
                             self._moment1_dict[key][param_group_idx],
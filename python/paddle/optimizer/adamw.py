@@ -104,6 +104,8 @@ class AdamW(Optimizer):
             different semantics with the original Adam algorithm and may lead to different result.
             The default value is False.
         multi_precision (bool, optional): Whether to use multi-precision during weight updating. Default is false.
+        use_multi_tensor (bool, optional): Whether to use multi-tensor strategy to update all parameters at once in dygraph mode.
+            It can't be used together with ``lr_ratio``. Default is false.
         name (str|None, optional): Normally there is no need for user to set this property.
             For more information, please refer to :ref:`api_guide_Name`.
             The default value is None.
@@ -183,6 +185,7 @@ class AdamW(Optimizer):
         grad_clip: GradientClipBase | None = None,
         lazy_mode: bool = False,
         multi_precision: bool = False,
+        use_multi_tensor: bool = False,
         name: str | None = None,
     ) -> None:
         assert learning_rate is not None
@@ -208,6 +211,10 @@ class AdamW(Optimizer):
                 not in paddle.device.get_all_custom_device_type()
             ):
                 raise NotImplementedError("'lr_ratio' is unimplemented in CPU.")
+            if use_multi_tensor:
+                raise NotImplementedError(
+                    "'lr_ratio' is unimplemented with 'use_multi_tensor'."
+                )
 
         if parameters is not None:
             # paddle.Tensor is also iterable, so here we don't check whether
@@ -301,7 +308,13 @@ class AdamW(Optimizer):
         else:
             self._param_groups = self._parameter_list
 
-        self._use_multi_tensor = None
+        # NOTE: Multi Tensor: the parameters of the same data type, learning
+        # rate and weight decay are updated by a fused_adam_ op in dygraph mode.
+        self._use_multi_tensor = (
+            use_multi_tensor and framework.in_dygraph_mode()
+        )
+        if self._use_multi_tensor:
+            self._param_dict = self._create_multi_tensor_dict()
         self.regularization = None
         self._auxiliary_vars = {}
         self._already_create_accumulator = set()
@@ -433,6 +446,108 @@ class AdamW(Optimizer):
             self._add_moments_pows(p)
             self._already_create_accumulator.add(p.name)
 
+    def _multi_tensor_init(self, target_block, parameters, param_group_idx):
+        """
+        Groups the parameters by data type, whose accumulators are looked up
+        by name when they are updated.
+        """
+        self._create_accumulators(target_block, parameters)
+        for param in parameters:
+            if param.dtype == paddle.float32:
+                self._param_dict['FP32_LODTensor'][param_group_idx].append(
+                    param
+                )
+            elif self._is_dtype_fp16_or_bf16(param.dtype):
+                self._param_dict['FP16_LODTensor'][param_group_idx].append(
+                    param
+                )
+            else:
+                raise ValueError(
+                    "Now multi_tensor_adamw only support fp32, fp16 or bf16 parameters."
+                )
+
+    def _append_optimize_multi_tensor_op(
+        self,
+        target_block,
+        parameters_and_grads,
+        param_group_idx,
+    ):
+        """
+        For Multi Tensor, append fused_adam_ ops to update the parameters.
+        """
+        from .adam import _append_fused_adam_ops, _use_fused_adam
+
+        if isinstance(parameters_and_grads, dict):
+            self._update_param_group(parameters_and_grads)
+            parameters_and_grads = parameters_and_grads['params']
+        grads = {
+            param.name: grad
+            for param, grad in parameters_and_grads
+            if grad is not None
+        }
+        found_inf = self._get_auxiliary_var('found_inf')
+        if found_inf:
+            if isinstance(found_inf, core.eager.Tensor):
+                self._set_auxiliary_var('found_inf', True)
+            return
+        if isinstance(found_inf, core.eager.Tensor):
+            self._set_auxiliary_var('found_inf', False)
+
+        for key in ['FP32_LODTensor', 'FP16_LODTensor']:
+            params = [
+                param
+                for param in self._param_dict[key][param_group_idx]
+                if param.name in grads
+            ]
+            if len(params) == 0:
+                continue
+            if not _use_fused_adam(params):
+                raise NotImplementedError(
+                    "'use_multi_tensor' of AdamW is only supported on GPU."
+                )
+            find_master = self._multi_precision and key == 'FP16_LODTensor'
+            states = [
+                [
+                    self._get_accumulator_master(name, param)
+                    for param in params
+                ]
+                for name in [
+                    self._moment1_acc_str,
+                    self._moment2_acc_str,
+                    self._beta1_pow_acc_str,
+                    self._beta2_pow_acc_str,
+                ]
+            ]
+            weight_decays = []
+            for param in params:
+                with_decay = (
+                    self._apply_decay_param_fun is None
+                    or self._apply_decay_param_fun(param.name)
+                )
+                weight_decays.append(
+                    float(self._weight_decay) if with_decay else 0.0
+                )
+            _append_fused_adam_ops(
+                params,
+                [grads[param.name] for param in params],
+                [
+                    self._create_param_lr((param, grads[param.name]))
+                    for param in params
+                ],
+                *states,
+                (
+                    [self._master_weights[param.name] for param in params]
+                    if find_master
+                    else None
+                ),
+                self._beta1,
+                self._beta2,
+                self._epsilon,
+                weight_decays,
+                True,
+            )
+        return None
+
     def _append_optimize_op(self, block, param_and_grad):
         assert isinstance(block, (framework.Block, pir.Block))
         if isinstance(param_and_grad, dict):
@@ -1173,10 +1173,11 @@ class Optimizer:
 
         self._create_global_learning_rate()
 
-        # NOTE: Multi Tensor support [ Momentum, Adam ] for dygraph mode
+        # NOTE: Multi Tensor support [ Momentum, Adam, AdamW ] for dygraph mode
         if self._use_multi_tensor and self.__class__.__name__ in [
             'Momentum',
             'Adam',
+            'AdamW',
         ]:
             if (
                 len(self._param_dict['FP32_LODTensor'][param_group_idx]) == 0
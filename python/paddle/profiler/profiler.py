@@ -887,6 +887,8 @@ class Profiler:
         thread_sep: bool = False,
         time_unit: Literal['s', 'ms', 'us', 'ns'] = 'ms',
         views: SummaryView | list[SummaryView] | None = None,
+        peak_tflops: float | None = None,
+        peak_bandwidth: float | None = None,
     ) -> None:
         r"""
         Print the Summary table. Currently support overview, model, distributed, operator, memory manipulation and user-defined summary.
@@ -897,6 +899,8 @@ class Profiler:
             thread_sep(bool, optional): print op table each thread, default value is False.
             time_unit(str, optional): time unit for display, can be chosen from ['s', 'ms', 'us', 'ns'], default value is 'ms'.
             views(SummaryView|list[SummaryView], optional): summary tables to print, default to None means all views to be printed.
+            peak_tflops(float, optional): the peak TFLOPS of the device, to report the roofline efficiency of the operators, default value is None.
+            peak_bandwidth(float, optional): the peak memory bandwidth of the device in GB/s, to report the roofline efficiency of the operators, default value is None.
 
         Examples:
             .. code-block:: python
@@ -932,6 +936,8 @@ class Profiler:
                     thread_sep=thread_sep,
                     time_unit=time_unit,
                     views=views,
+                    peak_tflops=peak_tflops,
+                    peak_bandwidth=peak_bandwidth,
                 )
             )
 
@@ -105,16 +105,21 @@ class HostStatisticNode:
         self.general_gpu_time = 0  # besides kernel, include time of gpu events like memcpy and memset
         self.self_general_gpu_time = 0
         self.flops = 0
+        self.bytes = 0
 
     def cal_flops(self):
         if self.hostnode.type == TracerEventType.Operator:
-            if hasattr(self.hostnode, 'input_shapes'):
+            # prefer the estimate of the op cost estimators of the profiler
+            if getattr(self.hostnode, 'flops', 0) > 0:
+                self.flops = self.hostnode.flops
+            elif hasattr(self.hostnode, 'input_shapes'):
                 op_name = _nodename2opname(self.hostnode.name)
                 self.flops = flops(
                     op_name,
                     self.hostnode.input_shapes,
                     self.hostnode.attributes,
                 )
+            self.bytes = getattr(self.hostnode, 'bytes', 0)
 
     def cal_statistic(self):
         self.cpu_time = self.hostnode.end_ns - self.hostnode.start_ns
@@ -127,6 +132,7 @@ class HostStatisticNode:
             self.general_gpu_time += child.general_gpu_time
             self.self_cpu_time -= child.end_ns - child.start_ns
             self.flops += child.flops
+            self.bytes += child.bytes
 
         for rt in self.runtime_node:
             rt.cal_statistic()
@@ -521,11 +527,16 @@ class EventSummary:
             self.min_general_gpu_time = float('inf')
             self.max_general_gpu_time = 0
             self._flops = 0
+            self._bytes = 0
 
         @property
         def flops(self):
             return self._flops
 
+        @property
+        def bytes(self):
+            return self._bytes
+
         @property
         def avg_cpu_time(self):
             return self.cpu_time / self.call
@@ -565,6 +576,9 @@ class EventSummary:
         def add_flops(self, flops):
             self._flops += flops
 
+        def add_bytes(self, bytes):
+            self._bytes += bytes
+
         def add_item(self, node):
             raise NotImplementedError
 
@@ -580,6 +594,7 @@ class EventSummary:
             self.add_gpu_time(node.gpu_time)
             self.add_general_gpu_time(node.general_gpu_time)
             self.add_flops(node.flops)
+            self.add_bytes(node.bytes)
             for child in node.children_node:
                 if child.type != TracerEventType.Operator:
                     if child.name not in self.operator_inners:
@@ -602,6 +617,7 @@ class EventSummary:
             self.add_gpu_time(node.gpu_time)
             self.add_general_gpu_time(node.general_gpu_time)
             self.add_flops(node.flops)
+            self.add_bytes(node.bytes)
             for child in node.children_node:
                 if child.type != TracerEventType.Operator:
                     if child.name not in self.operator_inners:
@@ -880,6 +896,8 @@ def _build_table(
     row_limit=100,
     max_src_column_width=75,
     views=None,
+    peak_tflops=None,
+    peak_bandwidth=None,
 ):
     from .profiler import SummaryView
 
@@ -930,6 +948,34 @@ def _build_table(
         """
         return '{}{:.2f}'.format(' ' * indent, ratio * 100)
 
+    def format_roofline(item):
+        r"""
+        Transform the FLOPs and bytes of an item to its achieved TFLOPS and
+        GB/s, and its roofline efficiency, the ratio of the time bound by the
+        peak compute and bandwidth of the device to its time.
+        """
+        time = (
+            item.general_gpu_time
+            if item.general_gpu_time > 0
+            else item.cpu_time
+        )
+        if time == 0 or (item.flops == 0 and item.bytes == 0):
+            return '-', '-', '-'
+        tflops = float(item.flops) / time / 1e3
+        bandwidth = float(item.bytes) / time
+        if peak_tflops is None and peak_bandwidth is None:
+            return f'{tflops:.2f}', f'{bandwidth:.2f}', '-'
+        bound_time = 0.0
+        if peak_tflops:
+            bound_time = max(bound_time, item.flops / (peak_tflops * 1e3))
+        if peak_bandwidth:
+            bound_time = max(bound_time, item.bytes / peak_bandwidth)
+        return (
+            f'{tflops:.2f}',
+            f'{bandwidth:.2f}',
+            format_ratio(bound_time / time),
+        )
+
     total_time = statistic_data.time_range_summary.get_cpu_range_sum(
         TracerEventType.ProfileStep
     )
@@ -1396,6 +1442,7 @@ def _build_table(
                             format_ratio(gpu_ratio),
                         ),
                         item.flops,
+                        *format_roofline(item),
                     ]
                     all_row_values.append(row_values)
                     if op_detail:
@@ -1462,6 +1509,9 @@ def _build_table(
                                     format_ratio(gpu_ratio),
                                 ),
                                 '-',
+                                '-',
+                                '-',
+                                '-',
                             ]
                             all_row_values.append(row_values)
                             for (
@@ -1506,6 +1556,9 @@ def _build_table(
                                         format_ratio(gpu_ratio),
                                     ),
                                     '-',
+                                    '-',
+                                    '-',
+                                    '-',
                                 ]
                                 all_row_values.append(row_values)
                         for (
@@ -1544,6 +1597,9 @@ def _build_table(
                                     format_ratio(gpu_ratio),
                                 ),
                                 '-',
+                                '-',
+                                '-',
+                                '-',
                             ]
                             all_row_values.append(row_values)
             # Calculate the column width
@@ -1551,6 +1607,7 @@ def _build_table(
             cpu_data_description_width = 40
             gpu_data_description_width = 40
             flops_width = 10
+            roofline_width = 12
             for row_values in all_row_values:
                 if isinstance(row_values, str):
                     continue
@@ -1569,6 +1626,9 @@ def _build_table(
                 'CPU Total / Avg / Max / Min / Ratio(%)',
                 'GPU Total / Avg / Max / Min / Ratio(%)',
                 'FLOPs',
+                'TFLOPS',
+                'GB/s',
+                'Roofline(%)',
             ]
             row_format_list = [""]
             header_sep_list = [""]
@@ -1578,6 +1638,9 @@ def _build_table(
             add_column(cpu_data_description_width)
             add_column(gpu_data_description_width)
             add_column(flops_width)
+            add_column(roofline_width)
+            add_column(roofline_width)
+            add_column(roofline_width)
 
             row_format = row_format_list[0]
             header_sep = header_sep_list[0]
@@ -941,6 +941,46 @@ def to_tensor(
             return _to_tensor_static(data, dtype, stop_gradient)
 
 
+
+@dygraph_only
+def from_numpy(ndarray: npt.NDArray[Any]) -> paddle.Tensor:
+    r"""
+    Creates a CPU ``paddle.Tensor`` sharing the memory of ``ndarray``, without
+    a copy. Unlike :ref:`api_paddle_to_tensor`, changing the elements of one
+    changes the ones of the other, and the array is kept alive as long as the
+    tensor is.
+
+    The array of uint16 is taken as the one of bfloat16, as in
+    :ref:`api_paddle_to_tensor`.
+
+    Args:
+        ndarray(numpy\.ndarray): a C-contiguous array of bool, float16, float32,
+            float64, int8, int16, int32, int64, uint8, uint16, complex64 or
+            complex128.
+
+    Returns:
+        Tensor: A CPU Tensor of the shape and the dtype of ``ndarray``.
+
+    Examples:
+        .. code-block:: python
+
+            >>> import numpy as np
+            >>> import paddle
+
+            >>> a = np.array([1, 2, 3], dtype=np.int64)
+            >>> t = paddle.from_numpy(a)
+            >>> a[0] = 10
+            >>> print(t)
+            Tensor(shape=[3], dtype=int64, place=Place(cpu), stop_gradient=True,
+            [10, 2 , 3 ])
+    """
+    if not isinstance(ndarray, np.ndarray):
+        raise TypeError(
+            "The type of 'ndarray' in from_numpy must be numpy.ndarray, "
+            f"but received {type(ndarray)}."
+        )
+    return core.eager.from_numpy(ndarray)
+
 def full_like(
     x: paddle.Tensor,
     fill_value: bool | float,
@@ -59,6 +59,7 @@ class DLDeviceType(enum.IntEnum):
     kDLMetal = (8,)
     kDLVPI = (9,)
     kDLROCM = (10,)
+    kDLROCMHost = (11,)
     kDLExtDev = (12,)
     kDLOneAPI = (14,)
 
@@ -68,9 +69,9 @@ def to_dlpack(x: Tensor) -> CapsuleType:
     Encodes a tensor to DLPack.
 
     Args:
-        x (Tensor): The input tensor, and the data type can be ``bool``, ``float16``, ``float32``,
-            ``float64``, ``int8``, ``int16``, ``int32``, ``int64``, ``uint8``, ``complex64``,
-            ``complex128``.
+        x (Tensor): The input tensor, and the data type can be ``bool``, ``float16``, ``bfloat16``,
+            ``float32``, ``float64``, ``float8_e4m3fn``, ``float8_e5m2``, ``int8``, ``int16``,
+            ``int32``, ``int64``, ``uint8``, ``complex64``, ``complex128``.
 
     Returns:
         dltensor, and the data type is PyCapsule.
@@ -142,7 +143,9 @@ def from_dlpack(
 
     Returns:
         out (Tensor): A tensor decoded from DLPack. The data type of returned tensor
-            can be one of: ``int32``, ``int64``, ``float16``, ``float32`` and ``float64``.
+            can be one of: ``bool``, ``int8``, ``int16``, ``int32``, ``int64``, ``uint8``,
+            ``float16``, ``bfloat16``, ``float32``, ``float64``, ``float8_e4m3fn``,
+            ``float8_e5m2``, ``complex64`` and ``complex128``.
             The device of returned tensor can be one of: ``CPU``, ``CUDAPlace``, ``CUDAPinnedPlace``.
 
     Examples:
@@ -192,7 +195,7 @@ def from_dlpack(
         device = dlpack.__dlpack_device__()
         # device is CUDA, we need to pass the current
         # stream
-        if device[0] in (DLDeviceType.kDLCUDA,):
+        if device[0] in (DLDeviceType.kDLCUDA, DLDeviceType.kDLROCM):
             with warnings.catch_warnings():
                 # ignore deprecation warning
                 warnings.filterwarnings("ignore", category=UserWarning)
@@ -0,0 +1,79 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "AMP casts the inputs only on GPU"
+)
+class TestAmpCastCache(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_eager_amp_cast_cache': True})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_eager_amp_cast_cache': False})
+
+    def test_cast_once(self):
+        x = paddle.rand([4, 8])
+        w = paddle.rand([8, 8])
+        w.stop_gradient = False
+        with paddle.amp.auto_cast(level='O1'):
+            out1 = paddle.matmul(x, w)
+            out2 = paddle.matmul(x, w)
+            _, hits, _ = core._get_amp_cast_cache_stats()
+            self.assertGreaterEqual(hits, 2)
+            # the cast is made again after w is changed in place
+            w.scale_(2.0)
+            out3 = paddle.matmul(x, w)
+        np.testing.assert_equal(out1.numpy(), out2.numpy())
+        np.testing.assert_allclose(
+            out3.astype('float32').numpy(),
+            2 * out1.astype('float32').numpy(),
+            rtol=1e-3,
+        )
+        (out1 + out2).sum().backward()
+        np.testing.assert_allclose(
+            w.grad.numpy(),
+            2 * x.sum(axis=0, keepdim=True).T.expand([8, 8]).numpy(),
+            rtol=1e-2,
+        )
+        size, _, _ = core._get_amp_cast_cache_stats()
+        self.assertEqual(size, 0)
+
+    def test_profile_amp_lists(self):
+        w = paddle.rand([8, 8])
+
+        def profile(x):
+            return paddle.amp.debugging.profile_amp_lists(
+                lambda step: paddle.matmul(x, w),
+                steps=1,
+                candidate_ops=['matmul'],
+            )
+
+        white, black, errors = profile(paddle.rand([4, 8]))
+        self.assertEqual(white, {'matmul'})
+        self.assertLessEqual(errors['matmul'], 1e-2)
+        # overflows at float16
+        white, black, _ = profile(paddle.rand([4, 8]) * 1e5)
+        self.assertEqual(black, {'matmul'})
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -20,6 +20,7 @@ from semi_auto_parallel_dist_to_static_api import DemoNet, create_data_loader
 import paddle
 import paddle.distributed as dist
 from paddle import nn
+from paddle.base import core
 
 
 class TestSemiAutoParallelShardingStage3:
@@ -61,6 +62,25 @@ class TestSemiAutoParallelShardingStage3:
         self.check_tensor_eq(self.weight, linear.weight.numpy())
         self.check_tensor_eq(self.bias, linear.bias.numpy())
 
+    def test_sharding_stage_3_with_prefetch(self):
+        paddle.set_flags({"FLAGS_param_prefetch_depth": 2})
+        paddle.seed(self._seed)
+        linear = paddle.nn.Linear(10, 10)
+        batch = paddle.rand(shape=[10, 10])
+        batch = dist.shard_tensor(batch, self._mesh, [dist.Shard(0)])
+        opt = paddle.optimizer.AdamW(parameters=linear.parameters())
+        opt = dist.shard_optimizer(opt, dist.ShardingStage3(self._mesh))
+        # the gathers of the steps after the first one are prefetched
+        for _ in range(5):
+            loss = linear(batch)
+            loss.backward()
+            opt.step()
+            opt.clear_grad()
+        self.check_tensor_eq(self.weight, linear.weight.numpy())
+        self.check_tensor_eq(self.bias, linear.bias.numpy())
+        paddle.set_flags({"FLAGS_param_prefetch_depth": 0})
+        core.clear_prefetch_params()
+
     def test_sharding_stage_3_to_static(self):
         data_loader = create_data_loader()
         layer = DemoNet(self._mesh, "sharding_demonet")
@@ -93,6 +113,7 @@ class TestSemiAutoParallelShardingStage3:
 
         self.get_single_card_rst()
         self.test_pure_sharding_stage_3()
+        self.test_sharding_stage_3_with_prefetch()
         self.test_sharding_stage_3_to_static()
 
 
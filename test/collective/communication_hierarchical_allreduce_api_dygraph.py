@@ -0,0 +1,76 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+import legacy_test.test_collective_api_base as test_collective_base
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+
+
+class HierarchicalAllReduceTestCase:
+    def __init__(self):
+        self._dtype = os.getenv("dtype")
+        self._seeds = eval(os.getenv("seeds"))
+        self._local_size = int(os.getenv("local_size"))
+
+    def check_all_reduce(self, numel, reduce_op):
+        test_data_list = [
+            test_collective_base.create_test_data(
+                shape=(numel,), dtype=self._dtype, seed=seed
+            )
+            for seed in self._seeds
+        ]
+        tensor = paddle.to_tensor(test_data_list[dist.get_rank()])
+        dist.all_reduce(tensor, op=reduce_op)
+
+        if reduce_op == dist.ReduceOp.SUM:
+            result = np.sum(test_data_list, axis=0)
+            np.testing.assert_allclose(tensor, result, rtol=1e-05, atol=1e-05)
+        else:
+            result = np.max(test_data_list, axis=0)
+            np.testing.assert_array_equal(tensor, result)
+
+    def run_test_case(self):
+        # Split the ranks of this machine into nodes of local_size ranks.
+        paddle.set_flags(
+            {
+                "FLAGS_nccl_hierarchical_allreduce": True,
+                "FLAGS_nccl_hierarchical_allreduce_local_size": (
+                    self._local_size
+                ),
+                "FLAGS_nccl_hierarchical_allreduce_min_bytes": 1 << 20,
+                "FLAGS_nccl_hierarchical_allreduce_max_bytes": 8 << 20,
+            }
+        )
+        dist.init_parallel_env()
+
+        elem_size = np.dtype(self._dtype).itemsize
+        for reduce_op in [dist.ReduceOp.SUM, dist.ReduceOp.MAX]:
+            # below the min size, flat allreduce
+            self.check_all_reduce(1000, reduce_op)
+            # hierarchical allreduce, the count is divided by local_size
+            self.check_all_reduce((2 << 20) // elem_size, reduce_op)
+            # hierarchical allreduce with a remainder
+            self.check_all_reduce(
+                (1 << 20) // elem_size + self._local_size - 1, reduce_op
+            )
+            # above the max size, flat allreduce
+            self.check_all_reduce((9 << 20) // elem_size, reduce_op)
+
+
+if __name__ == "__main__":
+    HierarchicalAllReduceTestCase().run_test_case()
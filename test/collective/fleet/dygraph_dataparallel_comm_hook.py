@@ -0,0 +1,159 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle.nn import Linear, ReLU
+
+IN_SIZE = 32
+HIDDEN_SIZE = 64
+OUT_SIZE = 32
+BATCH_SIZE = 8
+
+
+class MLP(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+        # 64 * 64 elements without bias, so that powersgd views the fused
+        # gradient as a square matrix without padding.
+        self._linear1 = Linear(IN_SIZE, HIDDEN_SIZE, bias_attr=False)
+        self._relu = ReLU()
+        self._linear2 = Linear(HIDDEN_SIZE, OUT_SIZE, bias_attr=False)
+
+    def forward(self, x):
+        return self._linear2(self._relu(self._linear1(x)))
+
+
+def backward(model, x):
+    out = model(x)
+    loss = paddle.mean(out * out)
+    loss.backward()
+
+
+def local_grads(state_dict, x):
+    # The gradients of each rank without communication, gathered from all
+    # the ranks as numpy arrays of shape [nranks, ...].
+    model = MLP()
+    model.set_state_dict(state_dict)
+    backward(model, x)
+    grads = []
+    for param in model.parameters():
+        gathered = []
+        dist.all_gather(gathered, param.grad)
+        grads.append(np.stack([g.numpy() for g in gathered]))
+    return grads
+
+
+def hooked_grads(state_dict, x, hook, steps=1, **options):
+    # The gradients after `steps` backward passes of a DataParallel model
+    # using the hook, the gradients are cleared between the steps.
+    model = MLP()
+    model.set_state_dict(state_dict)
+    dp_model = paddle.DataParallel(model)
+    dp_model.register_comm_hook(hook, **options)
+    for _ in range(steps):
+        model.clear_gradients()
+        backward(dp_model, x)
+    return [param.grad.numpy() for param in model.parameters()]
+
+
+def flatten(grads):
+    return np.concatenate([g.reshape([-1]) for g in grads])
+
+
+def check_same_on_all_ranks(grads):
+    for grad in grads:
+        gathered = []
+        dist.all_gather(gathered, paddle.to_tensor(grad))
+        for other in gathered:
+            np.testing.assert_array_equal(other.numpy(), grad)
+
+
+def test_comm_hook():
+    dist.init_parallel_env()
+    rank = dist.get_rank()
+    nranks = dist.get_world_size()
+
+    paddle.seed(2024)
+    state_dict = MLP().state_dict()
+    # Each rank feeds different data.
+    np.random.seed(2024 + rank)
+    x = paddle.to_tensor(
+        np.random.randn(BATCH_SIZE, IN_SIZE).astype("float32")
+    )
+
+    # All the parameters fit in one fused group, so the hooks see the
+    # concatenation of all the gradients, whatever the order of the group.
+    per_rank = local_grads(state_dict, x)
+    expected = [g.mean(axis=0) for g in per_rank]
+
+    # fp16 allreduce, close to the float32 average.
+    grads = hooked_grads(state_dict, x, "fp16")
+    for grad, ref in zip(grads, expected):
+        np.testing.assert_allclose(grad, ref, rtol=1e-2, atol=1e-4)
+
+    # 'allreduce' restores the default communication.
+    model = MLP()
+    model.set_state_dict(state_dict)
+    dp_model = paddle.DataParallel(model)
+    dp_model.register_comm_hook("fp16")
+    dp_model.register_comm_hook("allreduce")
+    backward(dp_model, x)
+    for param, ref in zip(model.parameters(), expected):
+        np.testing.assert_allclose(
+            param.grad.numpy(), ref, rtol=1e-5, atol=1e-7
+        )
+
+    # powersgd uses plain allreduce during the warm-up.
+    grads = hooked_grads(state_dict, x, "powersgd", rank=1, start_iter=1)
+    for grad, ref in zip(grads, expected):
+        np.testing.assert_allclose(grad, ref, rtol=1e-5, atol=1e-7)
+
+    # The first compressed step has no error feedback yet, its gradient is
+    # the projection of the average gradient onto the span of P, so that
+    # <approx, average> == |approx|^2 and |approx| < |average|.
+    grads = hooked_grads(
+        state_dict, x, "powersgd", steps=2, rank=1, start_iter=1
+    )
+    check_same_on_all_ranks(grads)
+    approx = flatten(grads).astype("float64")
+    average = flatten(expected).astype("float64")
+    np.testing.assert_allclose(
+        np.dot(approx, average), np.dot(approx, approx), rtol=1e-3
+    )
+    assert 0 < np.linalg.norm(approx) < np.linalg.norm(average)
+
+    # topk keeps the k largest elements of each rank and sums them.
+    ratio = 0.05
+    grads = hooked_grads(state_dict, x, "topk", ratio=ratio)
+    check_same_on_all_ranks(grads)
+    numel = sum(g.size for g in expected)
+    k = max(1, int(numel * ratio))
+    dense = np.zeros([numel], dtype="float32")
+    for r in range(nranks):
+        grad = flatten([g[r] for g in per_rank]) / nranks
+        indices = np.argsort(-np.abs(grad))[:k]
+        dense[indices] += grad[indices]
+    np.testing.assert_allclose(flatten(grads), dense, rtol=1e-5, atol=1e-7)
+
+    # A ratio that does not reduce the traffic falls back to allreduce.
+    grads = hooked_grads(state_dict, x, "topk", ratio=1.0)
+    for grad, ref in zip(grads, expected):
+        np.testing.assert_allclose(grad, ref, rtol=1e-5, atol=1e-7)
+
+
+if __name__ == '__main__':
+    test_comm_hook()
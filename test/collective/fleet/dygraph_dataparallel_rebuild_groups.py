@@ -0,0 +1,113 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle.nn import Linear, ReLU
+
+LINEAR_SIZE = 512
+BATCH_SIZE = 16
+STEPS = 4
+
+
+class MLP(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+        # The layers are created in the reverse order of their use, so the
+        # gradients are ready in the order of the parameters, which differs
+        # from the order of the groups built at construction. Each layer has
+        # 1MB of parameters, so there are several groups.
+        self._linear4 = Linear(LINEAR_SIZE, 10)
+        self._linear3 = Linear(LINEAR_SIZE, LINEAR_SIZE)
+        self._linear2 = Linear(LINEAR_SIZE, LINEAR_SIZE)
+        self._linear1 = Linear(LINEAR_SIZE, LINEAR_SIZE)
+        self._relu = ReLU()
+
+    def forward(self, x):
+        x = self._relu(self._linear1(x))
+        x = self._relu(self._linear2(x))
+        x = self._relu(self._linear3(x))
+        return self._linear4(x)
+
+
+def train(state_dict, inputs, comm_hook=None, **kwargs):
+    model = MLP()
+    model.set_state_dict(state_dict)
+    dp_model = paddle.DataParallel(model, comm_buffer_size=2, **kwargs)
+    if comm_hook is not None:
+        dp_model.register_comm_hook(comm_hook)
+    optimizer = paddle.optimizer.SGD(
+        learning_rate=0.1, parameters=model.parameters()
+    )
+    losses = []
+    for x in inputs:
+        loss = paddle.mean(dp_model(x))
+        loss.backward()
+        optimizer.step()
+        optimizer.clear_grad()
+        losses.append(loss.item())
+    params = [p.numpy() for p in model.parameters()]
+    return losses, params
+
+
+def check_equal(result, expected):
+    np.testing.assert_array_equal(result[0], expected[0])
+    for param, ref in zip(result[1], expected[1]):
+        np.testing.assert_array_equal(param, ref)
+
+
+def test_rebuild_groups():
+    dist.init_parallel_env()
+    rank = dist.get_rank()
+
+    paddle.seed(2024)
+    state_dict = MLP().state_dict()
+    # Each rank feeds different data.
+    np.random.seed(2024 + rank)
+    inputs = [
+        paddle.to_tensor(
+            np.random.randn(BATCH_SIZE, LINEAR_SIZE).astype("float32")
+        )
+        for _ in range(STEPS)
+    ]
+
+    # The allreduce of two ranks is elementwise, the grouping of the
+    # gradients does not change the results.
+    expected = train(state_dict, inputs)
+    check_equal(train(state_dict, inputs, rebuild_groups=True), expected)
+    # The rebuilding is skipped with find_unused_parameters.
+    check_equal(
+        train(
+            state_dict,
+            inputs,
+            rebuild_groups=True,
+            find_unused_parameters=True,
+        ),
+        expected,
+    )
+
+    # The comm hooks registered to all the groups still apply to the
+    # rebuilt groups.
+    expected_fp16 = train(state_dict, inputs, comm_hook="fp16")
+    assert not np.array_equal(expected_fp16[1][0], expected[1][0])
+    check_equal(
+        train(state_dict, inputs, comm_hook="fp16", rebuild_groups=True),
+        expected_fp16,
+    )
+
+
+if __name__ == '__main__':
+    test_rebuild_groups()
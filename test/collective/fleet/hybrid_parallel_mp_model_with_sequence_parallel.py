@@ -498,6 +498,22 @@ class TestDistSPTrainingWithConfigs(TestDistSPTrainingBase):
         fleet.init(is_collective=True, strategy=strategy)
 
 
+class TestDistSPTrainingWithCollectiveMatmul(TestDistSPTrainingBase):
+    def setUp(self):
+        strategy = fleet.DistributedStrategy()
+        self.model_parallel_size = 2
+        self.data_parallel_size = 1
+        strategy.hybrid_configs = {
+            "dp_degree": self.data_parallel_size,
+            "mp_degree": self.model_parallel_size,
+            "pp_degree": 1,
+            "mp_configs": {
+                "sp_collective_matmul": True,
+            },
+        }
+        fleet.init(is_collective=True, strategy=strategy)
+
+
 class TestDistSPTrainingAmpWithConfigs(TestDistSPTrainingBase):
     def setUp(self):
         strategy = fleet.DistributedStrategy()
@@ -29,6 +29,18 @@ class TestTCPStore(unittest.TestCase):
         ret2 = store.get('my')
         self.assertEqual(ret1[0] + 3, ret2[0])
 
+    def test_tcp_store_batched(self):
+        dist_port = int(os.getenv("PADDLE_DIST_UT_PORT", 6170)) + 1
+        store = paddle.base.core.TCPStore("127.0.0.1", dist_port, True, 1, 1)
+        store.multi_set(["k0", "k1"], ["v0", "v1"])
+        self.assertEqual(store.multi_get(["k1", "k0"]), [b"v1", b"v0"])
+
+        self.assertEqual(store.compare_set("k2", "", "a"), b"a")
+        self.assertEqual(store.compare_set("k2", "b", "c"), b"a")
+        self.assertEqual(store.compare_set("k2", "a", "c"), b"c")
+        self.assertEqual(store.compare_set("k3", "a", "b"), b"")
+        self.assertEqual(store.get("k2"), b"c")
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -229,5 +229,68 @@ class TestProcessGroupFp32(unittest.TestCase):
         print("test gather api ok\n")
 
 
+class TestProcessGroupGlooPerfMode(unittest.TestCase):
+    shm = False
+    port = 6273
+    gid = 1
+
+    def setUp(self):
+        np.random.seed(2022)
+        paddle.set_flags(
+            {
+                'FLAGS_gloo_allreduce_threads': 4,
+                'FLAGS_gloo_shm_allreduce': self.shm,
+                'FLAGS_gloo_shm_buffer_mb': 1,
+            }
+        )
+
+    def tearDown(self):
+        paddle.set_flags(
+            {
+                'FLAGS_gloo_allreduce_threads': 1,
+                'FLAGS_gloo_shm_allreduce': False,
+                'FLAGS_gloo_shm_buffer_mb': 32,
+            }
+        )
+
+    def test_allreduce(self):
+        nranks = paddle.distributed.ParallelEnv().nranks
+        rank = paddle.distributed.ParallelEnv().local_rank
+        store = paddle.base.core.TCPStore(
+            "127.0.0.1", self.port, rank == 0, nranks, 30
+        )
+        pg = paddle.base.core.ProcessGroupGloo.create(
+            store, rank, nranks, self.gid
+        )
+        paddle.device.set_device('cpu')
+
+        # in 4 chunks of threads, and in pieces of the shared memory
+        for shape, dtype in [
+            ((1024, 1031), "float32"),
+            ((3, 5), "float32"),
+            ((512, 1024), "int64"),
+        ]:
+            xs = [
+                (np.random.random(shape) * 100).astype(dtype)
+                for _ in range(nranks)
+            ]
+            tensor = paddle.to_tensor(xs[rank])
+            pg.allreduce(tensor).wait()
+            np.testing.assert_allclose(
+                tensor.numpy(), np.sum(xs, axis=0), rtol=1e-5
+            )
+
+            tensor = paddle.to_tensor(xs[rank])
+            pg.allreduce(tensor, core.ReduceOp.MAX).wait()
+            np.testing.assert_array_equal(tensor.numpy(), np.max(xs, axis=0))
+        print("test allreduce of the perf mode ok")
+
+
+class TestProcessGroupGlooShm(TestProcessGroupGlooPerfMode):
+    shm = True
+    port = 6274
+    gid = 2
+
+
 if __name__ == "__main__":
     unittest.main()
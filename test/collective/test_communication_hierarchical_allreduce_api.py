@@ -0,0 +1,50 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import test_communication_api_base as test_base
+
+
+class TestCommunicationHierarchicalAllreduceAPI(
+    test_base.CommunicationTestDistBase
+):
+    def setUp(self):
+        super().setUp(num_of_devices=4, timeout=120)
+        self._default_envs = {
+            "seeds": str(self._seeds),
+        }
+        # local_size 3 gives nodes of different sizes, which fall back to
+        # the flat allreduce.
+        self._changeable_envs = {
+            "dtype": ["float32", "int64"],
+            "local_size": ["2", "3"],
+        }
+
+    def test_hierarchical_allreduce(self):
+        envs_list = test_base.gen_product_envs_list(
+            self._default_envs, self._changeable_envs
+        )
+        for envs in envs_list:
+            self.run_test_case(
+                "communication_hierarchical_allreduce_api_dygraph.py",
+                user_defined_envs=envs,
+            )
+
+    def tearDown(self):
+        super().tearDown()
+
+
+if __name__ == '__main__':
+    unittest.main()
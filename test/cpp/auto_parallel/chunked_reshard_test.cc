@@ -0,0 +1,47 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/chunked_reshard_function.h"
+
+#include "gtest/gtest.h"
+
+namespace phi {
+namespace distributed {
+namespace tests {
+
+TEST(ReshardChunkCostModel, EstimateTime) {
+  ReshardChunkCostModel cost_model;
+  // 100 us of communication and 1 us of relayout
+  EXPECT_DOUBLE_EQ(cost_model.EstimateTime(1, 2000000, 250000, 1), 126.0);
+  // (20 + 50) + (5 + 0.5) + 1 * max(70, 5.5)
+  EXPECT_DOUBLE_EQ(cost_model.EstimateTime(2, 2000000, 250000, 1), 145.5);
+}
+
+TEST(ReshardChunkCostModel, ChooseNumChunks) {
+  ReshardChunkCostModel cost_model;
+  int64_t large_bytes = 64 << 20;
+  int64_t small_bytes = 4 << 10;
+
+  EXPECT_GT(cost_model.ChooseNumChunks(8, large_bytes, large_bytes, 1), 1);
+  EXPECT_LE(cost_model.ChooseNumChunks(8, large_bytes, large_bytes, 1), 8);
+  // the latency of the chunks is not paid off
+  EXPECT_EQ(cost_model.ChooseNumChunks(8, small_bytes, small_bytes, 1), 1);
+  EXPECT_EQ(cost_model.ChooseNumChunks(1, large_bytes, large_bytes, 1), 1);
+  // nothing to overlap without relayout
+  EXPECT_EQ(cost_model.ChooseNumChunks(8, large_bytes, 0, 0), 1);
+}
+
+}  // namespace tests
+}  // namespace distributed
+}  // namespace phi
@@ -0,0 +1,114 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/core/distributed/auto_parallel/sharding_planner.h"
+
+#include "gtest/gtest.h"
+
+namespace phi {
+namespace distributed {
+namespace tests {
+
+TEST(ShardingCostModel, Collectives) {
+  ShardingCostModel cost_model;
+  // 20 us of latency and 20 GB/s
+  EXPECT_DOUBLE_EQ(cost_model.AllReduceTime(1000000, 4), 95.0);
+  EXPECT_DOUBLE_EQ(cost_model.AllGatherTime(1000000, 4), 170.0);
+  EXPECT_DOUBLE_EQ(cost_model.ReduceScatterTime(1000000, 4), 57.5);
+  EXPECT_DOUBLE_EQ(cost_model.AllReduceTime(1000000, 1), 0.0);
+  // 100 TFLOPS
+  EXPECT_DOUBLE_EQ(cost_model.ComputeTime(1e9), 10.0);
+}
+
+TEST(ShardingCostModel, ReshardTime) {
+  ShardingCostModel cost_model;
+  ProcessMesh mesh({4}, {0, 1, 2, 3}, {"x"});
+  std::vector<int64_t> shape = {1024, 1024};
+  TensorDistAttr replicated(shape);
+  replicated.set_process_mesh(mesh);
+  TensorDistAttr row = replicated;
+  row.set_dims_mapping({0, -1});
+  TensorDistAttr col = replicated;
+  col.set_dims_mapping({-1, 0});
+  TensorDistAttr partial = replicated;
+  partial.set_partial_status(std::vector<int64_t>({0}));
+
+  int64_t bytes = 1024 * 1024 * 4;
+  EXPECT_DOUBLE_EQ(
+      cost_model.ReshardTime(shape, DataType::FLOAT32, replicated, row), 0.0);
+  EXPECT_DOUBLE_EQ(
+      cost_model.ReshardTime(shape, DataType::FLOAT32, row, replicated),
+      cost_model.AllGatherTime(bytes / 4, 4));
+  EXPECT_DOUBLE_EQ(cost_model.ReshardTime(shape, DataType::FLOAT32, row, col),
+                   cost_model.AllToAllTime(bytes / 4, 4));
+  EXPECT_DOUBLE_EQ(
+      cost_model.ReshardTime(shape, DataType::FLOAT32, partial, replicated),
+      cost_model.AllReduceTime(bytes, 4));
+  EXPECT_DOUBLE_EQ(
+      cost_model.ReshardTime(shape, DataType::FLOAT32, partial, row),
+      cost_model.ReduceScatterTime(bytes, 4));
+}
+
+TEST(ShardingPlanner, Candidates) {
+  ProcessMesh mesh({2, 2}, {0, 1, 2, 3}, {"x", "y"});
+  ShardingPlanner planner(mesh, ShardingCostModel());
+  int64_t even = planner.AddTensor({{8, 6}, DataType::FLOAT32, true, {}});
+  int64_t odd = planner.AddTensor({{8, 3}, DataType::FLOAT32, true, {}});
+
+  // each mesh dim replicates or shards an axis not sharded yet
+  EXPECT_EQ(planner.Candidates(even).size(), 7UL);
+  EXPECT_EQ(planner.Candidates(odd).size(), 3UL);
+  for (const auto& dist_attr : planner.Candidates(odd)) {
+    EXPECT_EQ(dist_attr.dims_mapping()[1], -1);
+  }
+}
+
+TEST(ShardingPlanner, Mlp) {
+  ProcessMesh mesh({4}, {0, 1, 2, 3}, {"x"});
+  ShardingCostModel cost_model;
+  // less than the replicated weights with their gradients and optimizer
+  // states
+  cost_model.device_memory = 64 << 20;
+  ShardingPlanner planner(mesh, cost_model);
+
+  int64_t x = planner.AddTensor({{32, 1024}, DataType::FLOAT32, false, {}});
+  int64_t w1 = planner.AddTensor({{1024, 4096}, DataType::FLOAT32, true, {}});
+  int64_t h = planner.AddTensor({{32, 4096}, DataType::FLOAT32, false, {}});
+  int64_t w2 = planner.AddTensor({{4096, 1024}, DataType::FLOAT32, true, {}});
+  int64_t y = planner.AddTensor({{32, 1024}, DataType::FLOAT32, false, {}});
+  std::vector<Attribute> attrs = {false, false};
+  planner.AddOp({"matmul", {x, w1}, {h}, attrs, 2.0 * 32 * 1024 * 4096});
+  planner.AddOp({"matmul", {h, w2}, {y}, attrs, 2.0 * 32 * 4096 * 1024});
+
+  auto replicated = planner.Evaluate({});
+  EXPECT_TRUE(replicated.valid);
+  EXPECT_DOUBLE_EQ(replicated.comm_time, 0.0);
+  int64_t weight_bytes = 1024 * 4096 * 4;
+  int64_t activation_bytes = (32 * 1024 * 2 + 32 * 4096) * 4;
+  EXPECT_EQ(replicated.memory, 2 * weight_bytes * 4 + activation_bytes);
+
+  // column parallel, then row parallel, with no reshard of h
+  auto plan = planner.Plan();
+  EXPECT_TRUE(plan.valid);
+  EXPECT_EQ(plan.param_dist_attrs[w1].dims_mapping(),
+            std::vector<int64_t>({-1, 0}));
+  EXPECT_EQ(plan.param_dist_attrs[w2].dims_mapping(),
+            std::vector<int64_t>({0, -1}));
+  EXPECT_LE(plan.memory, cost_model.device_memory);
+  EXPECT_LT(plan.Time(), replicated.Time());
+}
+
+}  // namespace tests
+}  // namespace distributed
+}  // namespace phi
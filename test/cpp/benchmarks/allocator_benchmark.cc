@@ -0,0 +1,93 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The throughput of the alloc and the free of the allocators
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/aligned_allocator.h"
+#include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/phi/core/memory/allocation/cpu_allocator.h"
+#include "paddle/phi/core/memory/malloc.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/platform/device_context.h"
+#include "paddle/phi/core/stream.h"
+#endif
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+using ::paddle::benchmark::State;
+
+namespace {
+
+// The sizes of the allocations of a step, between 256B and max_size
+std::vector<size_t> RandomSizes(size_t num, size_t max_size) {
+  std::mt19937 rng(2024);
+  std::uniform_int_distribution<size_t> dist(256, max_size);
+  std::vector<size_t> sizes(num);
+  for (auto& size : sizes) size = dist(rng);
+  return sizes;
+}
+
+template <typename AllocFunc>
+void AllocFree(State* state, AllocFunc&& alloc) {
+  const size_t live = state->range(0);
+  const auto sizes = RandomSizes(live * 8, state->range(1));
+  std::vector<AllocationPtr> allocations(live);
+  size_t next = 0;
+  while (state->KeepRunning()) {
+    // the oldest allocation is freed first, as the tensors of a step
+    auto& slot = allocations[next % live];
+    slot.reset();
+    slot = alloc(sizes[next % sizes.size()]);
+    ++next;
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+}  // namespace
+
+// args: the number of the live allocations, the max size of an allocation
+PD_BENCHMARK_WITH_ARGS(AutoGrowthBestFitAllocatorCPU,
+                       {{1, 4096}, {64, 65536}, {1024, 1 << 20}}) {
+  auto underlying = std::make_shared<AlignedAllocator>(
+      std::make_shared<CPUAllocator>(), 64);
+  auto allocator = std::make_shared<AutoGrowthBestFitAllocator>(underlying, 64);
+  AllocFree(state, [&](size_t size) { return allocator->Allocate(size); });
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// The allocator of the facade on GPU, which is StreamSafeCUDAAllocator over
+// AutoGrowthBestFitAllocator with the default flags.
+PD_BENCHMARK_WITH_ARGS(StreamSafeCUDAAllocator,
+                       {{1, 4096}, {64, 65536}, {1024, 1 << 20}}) {
+  phi::GPUPlace place(0);
+  auto* ctx = static_cast<phi::GPUContext*>(
+      phi::DeviceContextPool::Instance().Get(place));
+  phi::Stream stream(reinterpret_cast<phi::StreamId>(ctx->stream()));
+  AllocFree(state, [&](size_t size) { return Alloc(place, size, stream); });
+  ctx->Wait();
+}
+#endif
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
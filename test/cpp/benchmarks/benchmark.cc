@@ -0,0 +1,284 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/cpp/benchmarks/benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
+
+PD_DEFINE_string(benchmark_filter, ".", "The regex of the benchmarks to run");
+PD_DEFINE_double(benchmark_min_time,
+                 0.5,
+                 "The min seconds of a benchmark, 0 runs one iteration");
+PD_DEFINE_string(benchmark_out, "", "The file of the results in JSON");
+PD_DEFINE_string(benchmark_format,
+                 "console",
+                 "The format of the results on stdout, console or json");
+
+namespace paddle {
+namespace benchmark {
+
+namespace {
+
+constexpr int64_t kMaxIterations = 1000000000;
+
+double CpuSeconds() {
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+struct Benchmark {
+  std::string name;
+  BenchmarkFunc func;
+  std::vector<int64_t> args;
+};
+
+struct Result {
+  std::string name;
+  int64_t iterations;
+  double real_ns;
+  double cpu_ns;
+  double items_per_second;
+  double bytes_per_second;
+  std::string label;
+  std::string error;
+};
+
+std::vector<Benchmark>& Benchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+std::string EscapeJson(const std::string& str) {
+  std::ostringstream out;
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+              << static_cast<int>(c) << std::dec;
+        } else {
+          out << c;
+        }
+    }
+  }
+  return out.str();
+}
+
+// The iterations grow until a run takes the min time, as Google Benchmark.
+Result Run(const Benchmark& benchmark) {
+  int64_t iterations = 1;
+  while (true) {
+    State state(iterations, benchmark.args);
+    benchmark.func(&state);
+    double seconds = state.real_seconds();
+    bool done = !state.error().empty() ||
+                seconds >= FLAGS_benchmark_min_time ||
+                iterations >= kMaxIterations;
+    if (done) {
+      Result result;
+      result.name = benchmark.name;
+      result.iterations = state.iterations();
+      int64_t n = std::max<int64_t>(state.iterations(), 1);
+      result.real_ns = seconds * 1e9 / n;
+      result.cpu_ns = state.cpu_seconds() * 1e9 / n;
+      result.items_per_second =
+          seconds > 0 ? state.items_processed() / seconds : 0;
+      result.bytes_per_second =
+          seconds > 0 ? state.bytes_processed() / seconds : 0;
+      result.label = state.label();
+      result.error = state.error();
+      return result;
+    }
+    double multiplier = seconds > 0 ? FLAGS_benchmark_min_time * 1.4 / seconds
+                                    : 10.0;
+    multiplier = std::min(std::max(multiplier, 1.0), 10.0);
+    iterations = std::min<int64_t>(
+        kMaxIterations,
+        std::max<int64_t>(iterations + 1,
+                          static_cast<int64_t>(iterations * multiplier)));
+  }
+}
+
+std::string ToJson(const std::vector<Result>& results) {
+  std::ostringstream out;
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(
+      date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+      << "    \"library_build_type\": \"release\"\n"
+#else
+      << "    \"library_build_type\": \"debug\"\n"
+#endif
+      << "  },\n  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\n"
+        << "      \"name\": \"" << EscapeJson(result.name) << "\",\n"
+        << "      \"run_name\": \"" << EscapeJson(result.name) << "\",\n"
+        << "      \"run_type\": \"iteration\",\n";
+    if (!result.error.empty()) {
+      out << "      \"error_occurred\": true,\n"
+          << "      \"error_message\": \"" << EscapeJson(result.error)
+          << "\",\n";
+    }
+    out << "      \"iterations\": " << result.iterations << ",\n"
+        << std::setprecision(10) << "      \"real_time\": " << result.real_ns
+        << ",\n"
+        << "      \"cpu_time\": " << result.cpu_ns << ",\n"
+        << "      \"time_unit\": \"ns\"";
+    if (result.items_per_second > 0) {
+      out << ",\n      \"items_per_second\": " << result.items_per_second;
+    }
+    if (result.bytes_per_second > 0) {
+      out << ",\n      \"bytes_per_second\": " << result.bytes_per_second;
+    }
+    if (!result.label.empty()) {
+      out << ",\n      \"label\": \"" << EscapeJson(result.label) << "\"";
+    }
+    out << "\n    }";
+  }
+  out << "\n  ]\n}\n";
+  return out.str();
+}
+
+void PrintConsole(const std::vector<Result>& results) {
+  std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+            << std::setw(16) << "Time(ns)" << std::setw(16) << "CPU(ns)"
+            << std::setw(14) << "Iterations" << "  Items/s" << std::endl;
+  for (const auto& result : results) {
+    std::cout << std::left << std::setw(48) << result.name << std::right;
+    if (!result.error.empty()) {
+      std::cout << "  ERROR: " << result.error << std::endl;
+      continue;
+    }
+    std::cout << std::fixed << std::setprecision(1) << std::setw(16)
+              << result.real_ns << std::setw(16) << result.cpu_ns
+              << std::setw(14) << result.iterations;
+    if (result.items_per_second > 0) {
+      std::cout << "  " << std::scientific << std::setprecision(3)
+                << result.items_per_second;
+    }
+    if (!result.label.empty()) std::cout << "  " << result.label;
+    std::cout << std::defaultfloat << std::endl;
+  }
+}
+
+}  // namespace
+
+bool State::KeepRunning() {
+  if (!started_) {
+    started_ = true;
+    StartTimer();
+  }
+  if (iterations_ < max_iterations_ && error_.empty()) {
+    ++iterations_;
+    return true;
+  }
+  if (running_) StopTimer();
+  return false;
+}
+
+void State::PauseTiming() {
+  if (running_) StopTimer();
+}
+
+void State::ResumeTiming() {
+  if (!running_) StartTimer();
+}
+
+int64_t State::range(size_t index) const {
+  return index < args_.size() ? args_[index] : 0;
+}
+
+void State::StartTimer() {
+  running_ = true;
+  real_start_ = std::chrono::steady_clock::now();
+  cpu_start_ = CpuSeconds();
+}
+
+void State::StopTimer() {
+  running_ = false;
+  real_seconds_ += std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - real_start_)
+                       .count();
+  cpu_seconds_ += CpuSeconds() - cpu_start_;
+}
+
+int RegisterBenchmark(const std::string& name,
+                      BenchmarkFunc func,
+                      const std::vector<std::vector<int64_t>>& args) {
+  if (args.empty()) {
+    Benchmarks().push_back(Benchmark{name, func, {}});
+  }
+  for (const auto& arg : args) {
+    std::string full_name = name;
+    for (auto value : arg) {
+      full_name += "/" + std::to_string(value);
+    }
+    Benchmarks().push_back(Benchmark{full_name, func, arg});
+  }
+  return 0;
+}
+
+int RunBenchmarks() {
+  std::regex filter(FLAGS_benchmark_filter);
+  std::vector<Result> results;
+  for (const auto& benchmark : Benchmarks()) {
+    if (!std::regex_search(benchmark.name, filter)) continue;
+    results.push_back(Run(benchmark));
+  }
+
+  if (FLAGS_benchmark_format == "json") {
+    std::cout << ToJson(results);
+  } else {
+    PrintConsole(results);
+  }
+  if (!FLAGS_benchmark_out.empty()) {
+    std::ofstream out(FLAGS_benchmark_out);
+    out << ToJson(results);
+  }
+  return std::count_if(results.begin(), results.end(), [](const Result& r) {
+    return !r.error.empty();
+  });
+}
+
+}  // namespace benchmark
+}  // namespace paddle
+
+TEST(Benchmark, Run) { EXPECT_EQ(paddle::benchmark::RunBenchmarks(), 0); }
@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "paddle/common/macros.h"
+
+// A small harness for the benchmarks of the hot paths, with the interface
+// and the JSON output of Google Benchmark, so the results of the releases
+// can be compared by the same tools. A benchmark is written as
+//
+//   PD_BENCHMARK(Name) {
+//     // set up
+//     while (state->KeepRunning()) {
+//       // measured
+//     }
+//     state->SetItemsProcessed(state->iterations());
+//   }
+//
+// and the binaries accept
+//   --benchmark_filter=<regex>     the benchmarks to run
+//   --benchmark_min_time=<second>  the min time of a benchmark, 0 runs once
+//   --benchmark_out=<file>         the file of the results in JSON
+//   --benchmark_format=console|json  the format of the results on stdout
+
+namespace paddle {
+namespace benchmark {
+
+class State {
+ public:
+  State(int64_t max_iterations, const std::vector<int64_t>& args)
+      : max_iterations_(max_iterations), args_(args) {}
+
+  // True for each of the iterations, the timer runs from the first call to
+  // the last one.
+  bool KeepRunning();
+
+  // The time between them is not measured, e.g. for the set up of an
+  // iteration.
+  void PauseTiming();
+  void ResumeTiming();
+
+  int64_t range(size_t index) const;
+  int64_t iterations() const { return iterations_; }
+
+  void SetItemsProcessed(int64_t items) { items_processed_ = items; }
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+  void SetLabel(const std::string& label) { label_ = label; }
+  // Stops the benchmark, which is reported with the error.
+  void SkipWithError(const std::string& error) { error_ = error; }
+
+  double real_seconds() const { return real_seconds_; }
+  double cpu_seconds() const { return cpu_seconds_; }
+  int64_t items_processed() const { return items_processed_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+  const std::string& label() const { return label_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  void StartTimer();
+  void StopTimer();
+
+  int64_t max_iterations_;
+  std::vector<int64_t> args_;
+  int64_t iterations_{0};
+  bool started_{false};
+  bool running_{false};
+  std::chrono::steady_clock::time_point real_start_;
+  double cpu_start_{0};
+  double real_seconds_{0};
+  double cpu_seconds_{0};
+  int64_t items_processed_{0};
+  int64_t bytes_processed_{0};
+  std::string label_;
+  std::string error_;
+};
+
+using BenchmarkFunc = std::function<void(State*)>;
+
+// Registers a benchmark, run once for each of args and named as
+// name/arg0/arg1... then, or once with no args if args is empty.
+int RegisterBenchmark(const std::string& name,
+                      BenchmarkFunc func,
+                      const std::vector<std::vector<int64_t>>& args = {});
+
+// Runs the registered benchmarks matching FLAGS_benchmark_filter, and
+// returns the number of the benchmarks with an error.
+int RunBenchmarks();
+
+}  // namespace benchmark
+}  // namespace paddle
+
+#define PD_BENCHMARK(name)                                 \
+  static void name(::paddle::benchmark::State* state);     \
+  static int name##_registered_ UNUSED =                   \
+      ::paddle::benchmark::RegisterBenchmark(#name, name); \
+  static void name(::paddle::benchmark::State* state)
+
+// e.g. PD_BENCHMARK_WITH_ARGS(Matmul, {{64, 64}, {1024, 1024}})
+#define PD_BENCHMARK_WITH_ARGS(name, ...)                               \
+  static void name(::paddle::benchmark::State* state);                  \
+  static int name##_registered_ UNUSED =                                \
+      ::paddle::benchmark::RegisterBenchmark(#name, name, __VA_ARGS__); \
+  static void name(::paddle::benchmark::State* state)
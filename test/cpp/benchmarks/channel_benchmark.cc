@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The throughput of ChannelObject between the producers and the consumers
+
+#include <thread>
+#include <vector>
+
+#include "paddle/fluid/framework/channel.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+namespace paddle {
+namespace framework {
+
+constexpr int64_t kBlockSize = 1024;
+
+// args: the number of the producers and the consumers, the number of the
+// shards, the capacity of the channel
+PD_BENCHMARK_WITH_ARGS(ChannelThroughput,
+                       {{1, 1, 4096},
+                        {1, 4, 4096},
+                        {4, 4, 4096},
+                        {4, 4, 65536}}) {
+  const int64_t threads = state->range(0);
+  const int64_t shards = state->range(1);
+  const int64_t capacity = state->range(2);
+  std::vector<int64_t> block(kBlockSize, 1);
+  int64_t items = 0;
+  while (state->KeepRunning()) {
+    Channel<int64_t> chan = MakeChannel<int64_t>(capacity, shards);
+    chan->SetBlockSize(kBlockSize);
+    std::vector<std::thread> workers;
+    for (int64_t i = 0; i < threads; ++i) {
+      workers.emplace_back([&chan, &block]() {
+        for (int j = 0; j < 64; ++j) {
+          chan->Write(block);
+        }
+      });
+    }
+    std::vector<int64_t> received(threads, 0);
+    std::vector<std::thread> readers;
+    for (int64_t i = 0; i < threads; ++i) {
+      readers.emplace_back([&chan, &received, i]() {
+        std::vector<int64_t> out;
+        while (chan->Read(out) != 0) {
+          received[i] += out.size();
+        }
+      });
+    }
+    for (auto& worker : workers) worker.join();
+    chan->Close();
+    for (auto& reader : readers) reader.join();
+    for (auto n : received) items += n;
+  }
+  state->SetItemsProcessed(items);
+  state->SetBytesProcessed(items * sizeof(int64_t));
+}
+
+// The Put and the Get of one item on one thread, the overhead of a call
+PD_BENCHMARK(ChannelPutGet) {
+  Channel<int64_t> chan = MakeChannel<int64_t>();
+  int64_t value = 0;
+  while (state->KeepRunning()) {
+    chan->Put(value);
+    chan->Get(value);
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+}  // namespace framework
+}  // namespace paddle
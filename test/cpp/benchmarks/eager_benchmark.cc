@@ -0,0 +1,79 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The dispatch latency of the eager ops on tiny tensors, which is mostly the
+// overhead of the framework
+
+#include "paddle/fluid/eager/api/all.h"
+#include "paddle/fluid/eager/api/generated/eager_generated/forwards/dygraph_functions.h"
+#include "paddle/fluid/eager/backward.h"
+#include "test/cpp/benchmarks/benchmark.h"
+#include "test/cpp/eager/test_utils.h"
+
+namespace egr {
+
+using ::paddle::benchmark::State;
+
+namespace {
+
+paddle::Tensor TinyTensor(float value, bool stop_gradient) {
+  return eager_test::CreateTensorWithValue(common::make_ddim({1}),
+                                           phi::CPUPlace(),
+                                           phi::DataType::FLOAT32,
+                                           phi::DataLayout::NCHW,
+                                           value,
+                                           !stop_gradient);
+}
+
+}  // namespace
+
+// The forward of an op without the autograd
+PD_BENCHMARK(EagerAddDispatch) {
+  eager_test::InitEnv(phi::CPUPlace());
+  Controller::Instance().SetHasGrad(false);
+  auto x = TinyTensor(1.0, true);
+  auto y = TinyTensor(2.0, true);
+  while (state->KeepRunning()) {
+    auto out = add_ad_func(x, y);
+  }
+  Controller::Instance().SetHasGrad(true);
+  state->SetItemsProcessed(state->iterations());
+}
+
+// The forward of an op recording its grad node
+PD_BENCHMARK(EagerAddDispatchWithGrad) {
+  eager_test::InitEnv(phi::CPUPlace());
+  auto x = TinyTensor(1.0, false);
+  auto y = TinyTensor(2.0, false);
+  while (state->KeepRunning()) {
+    auto out = add_ad_func(x, y);
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+// The forward and the backward of a chain of three ops
+PD_BENCHMARK(EagerTinyChainForwardBackward) {
+  eager_test::InitEnv(phi::CPUPlace());
+  auto x = TinyTensor(1.0, false);
+  auto y = TinyTensor(2.0, false);
+  while (state->KeepRunning()) {
+    auto out = add_ad_func(x, y);
+    out = relu_ad_func(out);
+    out = scale_ad_func(out, 2.0, 1.0, true);
+    Backward({out}, {});
+  }
+  state->SetItemsProcessed(state->iterations() * 3);
+}
+
+}  // namespace egr
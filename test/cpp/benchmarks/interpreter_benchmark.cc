@@ -0,0 +1,85 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The overhead of a step of PirInterpreter on the tiny programs, which is
+// mostly the scheduling of the ops
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+DECLARE_FILE_SYMBOLS(kernel_dialect);
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+
+namespace paddle {
+namespace framework {
+
+using ::paddle::benchmark::State;
+
+// args: the number of the adds in a chain, the number of the chains, which
+// may run in parallel
+PD_BENCHMARK_WITH_ARGS(PirInterpreterStep, {{1, 1}, {16, 1}, {16, 4}}) {
+  const int64_t num_ops = state->range(0);
+  const int64_t num_chains = state->range(1);
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder(ctx, program.block());
+
+  std::set<std::string> outs;
+  for (int64_t chain = 0; chain < num_chains; ++chain) {
+    auto x = builder
+                 .Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 2},
+                                                 1.0,
+                                                 phi::DataType::FLOAT32,
+                                                 phi::CPUPlace())
+                 ->result(0);
+    pir::Value out = x;
+    for (int64_t i = 0; i < num_ops; ++i) {
+      out = builder.Build<paddle::dialect::AddOp>(out, x)->result(0);
+    }
+    std::string name = "out_" + std::to_string(chain);
+    builder.Build<pir::ShadowOutputOp>(out, name);
+    outs.insert(name);
+  }
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+  Scope scope;
+  InterpreterCore core(phi::CPUPlace(), {}, kernel_program->block(), &scope);
+  core.SetSkipGcVars(outs);
+  // the first run builds the instructions
+  core.Run({}, /*need_fetch=*/false);
+
+  while (state->KeepRunning()) {
+    core.Run({}, /*need_fetch=*/false);
+  }
+  state->SetItemsProcessed(state->iterations() * num_chains * (num_ops + 1));
+}
+
+}  // namespace framework
+}  // namespace paddle
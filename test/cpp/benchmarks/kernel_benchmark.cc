@@ -0,0 +1,147 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The core kernels at the shapes of the common models, called by the API
+
+#include "paddle/phi/api/include/api.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(matmul, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(softmax, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(sum, CPU, ALL_LAYOUT);
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+PD_DECLARE_KERNEL(full, GPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(matmul, GPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, GPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(softmax, GPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(sum, GPU, ALL_LAYOUT);
+#endif
+
+namespace paddle {
+namespace tests {
+
+using ::paddle::benchmark::State;
+
+namespace {
+
+paddle::Tensor Full(const std::vector<int64_t>& shape, const phi::Place& p) {
+  return paddle::experimental::full(shape, 0.5, phi::DataType::FLOAT32, p);
+}
+
+void Wait(const phi::Place& place) {
+  phi::DeviceContextPool::Instance().Get(place)->Wait();
+}
+
+// args: m, n, k
+void Matmul(State* state, const phi::Place& place) {
+  const int64_t m = state->range(0);
+  const int64_t n = state->range(1);
+  const int64_t k = state->range(2);
+  auto x = Full({m, k}, place);
+  auto y = Full({k, n}, place);
+  while (state->KeepRunning()) {
+    auto out = paddle::experimental::matmul(x, y, false, false);
+    Wait(place);
+  }
+  state->SetItemsProcessed(state->iterations() * 2 * m * n * k);
+}
+
+// args: rows, cols
+void AddBroadcast(State* state, const phi::Place& place) {
+  const int64_t rows = state->range(0);
+  const int64_t cols = state->range(1);
+  auto x = Full({rows, cols}, place);
+  auto y = Full({cols}, place);
+  while (state->KeepRunning()) {
+    auto out = paddle::experimental::add(x, y);
+    Wait(place);
+  }
+  state->SetBytesProcessed(state->iterations() * rows * cols * 2 *
+                           sizeof(float));
+}
+
+void Softmax(State* state, const phi::Place& place) {
+  const int64_t rows = state->range(0);
+  const int64_t cols = state->range(1);
+  auto x = Full({rows, cols}, place);
+  while (state->KeepRunning()) {
+    auto out = paddle::experimental::softmax(x, -1);
+    Wait(place);
+  }
+  state->SetBytesProcessed(state->iterations() * rows * cols * 2 *
+                           sizeof(float));
+}
+
+void ReduceSum(State* state, const phi::Place& place) {
+  const int64_t rows = state->range(0);
+  const int64_t cols = state->range(1);
+  auto x = Full({rows, cols}, place);
+  while (state->KeepRunning()) {
+    auto out =
+        paddle::experimental::sum(x, {-1}, phi::DataType::UNDEFINED, false);
+    Wait(place);
+  }
+  state->SetBytesProcessed(state->iterations() * rows * cols * sizeof(float));
+}
+
+}  // namespace
+
+// the projections of a transformer with the hidden size of 1024
+PD_BENCHMARK_WITH_ARGS(MatmulCPU, {{128, 1024, 1024}, {128, 4096, 1024}}) {
+  Matmul(state, phi::CPUPlace());
+}
+
+PD_BENCHMARK_WITH_ARGS(AddBroadcastCPU, {{4096, 1024}}) {
+  AddBroadcast(state, phi::CPUPlace());
+}
+
+// the attention of 16 heads on the sequences of 128 and 512
+PD_BENCHMARK_WITH_ARGS(SoftmaxCPU, {{16 * 128, 128}, {16 * 512, 512}}) {
+  Softmax(state, phi::CPUPlace());
+}
+
+PD_BENCHMARK_WITH_ARGS(ReduceSumCPU, {{4096, 1024}}) {
+  ReduceSum(state, phi::CPUPlace());
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+PD_BENCHMARK_WITH_ARGS(MatmulGPU,
+                       {{4096, 1024, 1024},
+                        {4096, 4096, 1024},
+                        {4096, 1024, 4096}}) {
+  Matmul(state, phi::GPUPlace(0));
+}
+
+PD_BENCHMARK_WITH_ARGS(AddBroadcastGPU, {{4096, 1024}, {32768, 4096}}) {
+  AddBroadcast(state, phi::GPUPlace(0));
+}
+
+PD_BENCHMARK_WITH_ARGS(SoftmaxGPU,
+                       {{32 * 16 * 128, 128}, {8 * 16 * 512, 512}}) {
+  Softmax(state, phi::GPUPlace(0));
+}
+
+PD_BENCHMARK_WITH_ARGS(ReduceSumGPU, {{4096, 1024}, {32768, 4096}}) {
+  ReduceSum(state, phi::GPUPlace(0));
+}
+#endif
+
+}  // namespace tests
+}  // namespace paddle
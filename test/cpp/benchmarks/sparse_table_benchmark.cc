@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The pull and the push rates of MemorySparseTable of a server
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+namespace paddle {
+namespace distributed {
+
+using ::paddle::benchmark::State;
+
+namespace {
+
+constexpr int kEmbedxDim = 8;
+constexpr uint64_t kNumFeasigns = 1 << 20;
+
+Table* SparseTable() {
+  static std::unique_ptr<Table> table = [] {
+    TableParameter table_config;
+    table_config.set_table_class("MemorySparseTable");
+    table_config.set_shard_num(16);
+    FsClientParameter fs_config;
+    std::unique_ptr<Table> table(new MemorySparseTable());
+    table->SetShard(0, 1);
+
+    auto* accessor_config = table_config.mutable_accessor();
+    accessor_config->set_accessor_class("CtrCommonAccessor");
+    accessor_config->set_fea_dim(kEmbedxDim + 3);
+    accessor_config->set_embedx_dim(kEmbedxDim);
+    accessor_config->set_embedx_threshold(0);
+    accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+    accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+    for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                            accessor_config->mutable_embedx_sgd_param()}) {
+      sgd_param->set_name("SparseAdaGradSGDRule");
+      auto* adagrad_param = sgd_param->mutable_adagrad();
+      adagrad_param->set_learning_rate(0.05);
+      adagrad_param->set_initial_range(0.01);
+      adagrad_param->set_initial_g2sum(3.0);
+      adagrad_param->add_weight_bounds(-10.0);
+      adagrad_param->add_weight_bounds(10.0);
+    }
+    table->Initialize(table_config, fs_config);
+    return table;
+  }();
+  return table.get();
+}
+
+// The keys of a batch, of a zipf like distribution as the feasigns of CTR
+std::vector<uint64_t> BatchKeys(size_t num) {
+  std::mt19937_64 rng(2024);
+  std::uniform_real_distribution<double> dist(0, 1);
+  std::vector<uint64_t> keys(num);
+  for (auto& key : keys) {
+    key = static_cast<uint64_t>(std::pow(kNumFeasigns, dist(rng)));
+  }
+  return keys;
+}
+
+}  // namespace
+
+// args: the keys of a request
+PD_BENCHMARK_WITH_ARGS(MemorySparseTablePull, {{1024}, {16384}}) {
+  auto* table = SparseTable();
+  auto info = table->GetValueAccessor()->GetAccessorInfo();
+  auto keys = BatchKeys(state->range(0));
+  std::vector<uint32_t> freqs(keys.size(), 1);
+  std::vector<float> values(keys.size() * info.select_dim);
+  PullSparseValue pull_value(keys, freqs, kEmbedxDim);
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value = pull_value;
+  context.pull_context.values = values.data();
+  while (state->KeepRunning()) {
+    table->Pull(context);
+  }
+  state->SetItemsProcessed(state->iterations() * keys.size());
+  state->SetLabel("keys/s");
+}
+
+PD_BENCHMARK_WITH_ARGS(MemorySparseTablePush, {{1024}, {16384}}) {
+  auto* table = SparseTable();
+  auto info = table->GetValueAccessor()->GetAccessorInfo();
+  auto keys = BatchKeys(state->range(0));
+  std::vector<float> grads(keys.size() * info.update_dim, 0.01);
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  while (state->KeepRunning()) {
+    table->Push(context);
+  }
+  state->SetItemsProcessed(state->iterations() * keys.size());
+  state->SetLabel("keys/s");
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The latency of the ops of TCPStore on a master in the same process
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/distributed/store/tcp_store.h"
+#include "test/cpp/benchmarks/benchmark.h"
+
+PD_DEFINE_int32(benchmark_tcp_store_port,
+                6277,
+                "The port of the master of the TCPStore benchmarks");
+
+namespace phi {
+namespace distributed {
+
+namespace {
+
+TCPStore* MasterStore() {
+  static auto store = std::make_unique<TCPStore>(
+      "127.0.0.1",
+      static_cast<uint16_t>(FLAGS_benchmark_tcp_store_port),
+      /*is_master=*/true,
+      /*num_workers=*/1);
+  return store.get();
+}
+
+}  // namespace
+
+// args: the bytes of a value
+PD_BENCHMARK_WITH_ARGS(TCPStoreSet, {{8}, {4096}}) {
+  auto* store = MasterStore();
+  std::vector<uint8_t> value(state->range(0), 1);
+  while (state->KeepRunning()) {
+    store->set("benchmark_set", value);
+  }
+  state->SetItemsProcessed(state->iterations());
+  state->SetBytesProcessed(state->iterations() * value.size());
+}
+
+PD_BENCHMARK_WITH_ARGS(TCPStoreGet, {{8}, {4096}}) {
+  auto* store = MasterStore();
+  const std::string key = "benchmark_get_" + std::to_string(state->range(0));
+  store->set(key, std::vector<uint8_t>(state->range(0), 1));
+  while (state->KeepRunning()) {
+    auto value = store->get(key);
+  }
+  state->SetItemsProcessed(state->iterations());
+  state->SetBytesProcessed(state->iterations() * state->range(0));
+}
+
+PD_BENCHMARK(TCPStoreAdd) {
+  auto* store = MasterStore();
+  while (state->KeepRunning()) {
+    store->add("benchmark_add", 1);
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+PD_BENCHMARK(TCPStoreCheck) {
+  auto* store = MasterStore();
+  store->set("benchmark_check", std::vector<uint8_t>(1, 1));
+  while (state->KeepRunning()) {
+    store->check("benchmark_check");
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+}  // namespace distributed
+}  // namespace phi
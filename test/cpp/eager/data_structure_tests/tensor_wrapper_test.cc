@@ -16,9 +16,14 @@
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/accumulation/accumulation_node.h"
 #include "paddle/fluid/eager/utils.h"
+#include "paddle/phi/api/include/api.h"
 #include "test/cpp/eager/data_structure_tests/grad_node_test.h"
 
+COMMON_DECLARE_int64(eager_activation_offload_budget_mb);
+
 TEST(TensorWrapper, Basic) {
   VLOG(6) << "Test Full reserved";
   paddle::Tensor et1;
@@ -106,3 +111,89 @@ TEST(TensorWrapper, Basic) {
       common::errors::Fatal(
           "Variable `tw2` should not be initialized after recover"));
 }
+
+TEST(TensorWrapper, Recompute) {
+  phi::DenseTensorMeta meta =
+      phi::DenseTensorMeta(phi::DataType::FLOAT32, common::make_ddim({1, 2}));
+  auto make_tensor = [&meta](float value) {
+    std::shared_ptr<phi::DenseTensor> dt = std::make_shared<phi::DenseTensor>(
+        std::make_unique<paddle::experimental::DefaultAllocator>(
+            phi::CPUPlace())
+            .get(),
+        meta);
+    auto* dt_ptr = dt->mutable_data<float>(phi::CPUPlace());
+    dt_ptr[0] = value;
+    dt_ptr[1] = value;
+    paddle::Tensor tensor;
+    tensor.set_impl(dt);
+    return tensor;
+  };
+
+  paddle::Tensor et1 = make_tensor(5.0f);
+  auto tw1 = egr::TensorWrapper(et1, false);
+  int num_recomputed = 0;
+  tw1.SetRecomputeFunction([&]() {
+    ++num_recomputed;
+    return make_tensor(5.0f);
+  });
+  // The saved buffer is dropped, the one of et1 is untouched
+  PADDLE_ENFORCE_EQ(
+      tw1.get_intermidiate_tensor().impl().get() != et1.impl().get(),
+      true,
+      common::errors::Fatal("The buffer of `tw1` should be dropped."));
+
+  for (int i = 0; i < 2; ++i) {
+    auto recover_et1 = tw1.recover();
+    auto* data =
+        static_cast<phi::DenseTensor*>(recover_et1.impl().get())->data<float>();
+    PADDLE_ENFORCE_EQ(data[0] == 5.0f && data[1] == 5.0f,
+                      true,
+                      common::errors::Fatal(
+                          "The recovered tensor should be recomputed."));
+  }
+  PADDLE_ENFORCE_EQ(num_recomputed,
+                    1,
+                    common::errors::Fatal(
+                        "The tensor should be recomputed once, but received "
+                        "%d.",
+                        num_recomputed));
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+TEST(TensorWrapper, OffloadActivationsOnly) {
+  int64_t budget_mb = FLAGS_eager_activation_offload_budget_mb;
+  // Every saved activation is offloaded
+  FLAGS_eager_activation_offload_budget_mb = 0;
+  auto make_tensor = [](std::shared_ptr<egr::GradNodeBase> grad_node,
+                        bool persistable) {
+    paddle::Tensor tensor = paddle::experimental::full(
+        {2, 2}, 1.0, phi::DataType::FLOAT32, phi::GPUPlace(0));
+    auto autograd_meta =
+        std::make_shared<egr::AutogradMeta>(egr::Edge(grad_node, 0, 0));
+    autograd_meta->SetPersistable(persistable);
+    tensor.set_autograd_meta(autograd_meta);
+    return tensor;
+  };
+
+  paddle::Tensor activation = make_tensor(
+      std::make_shared<eager_test::GradTestNode>(/* val */ 5.0, 1, 1), false);
+  auto activation_wrapper = egr::TensorWrapper(activation);
+  EXPECT_NE(activation_wrapper.get_intermidiate_tensor().impl().get(),
+            activation.impl().get());
+
+  paddle::Tensor leaf =
+      make_tensor(std::make_shared<egr::GradNodeAccumulation>(nullptr), false);
+  auto leaf_wrapper = egr::TensorWrapper(leaf);
+  EXPECT_EQ(leaf_wrapper.get_intermidiate_tensor().impl().get(),
+            leaf.impl().get());
+
+  paddle::Tensor parameter = make_tensor(
+      std::make_shared<eager_test::GradTestNode>(/* val */ 5.0, 1, 1), true);
+  auto parameter_wrapper = egr::TensorWrapper(parameter);
+  EXPECT_EQ(parameter_wrapper.get_intermidiate_tensor().impl().get(),
+            parameter.impl().get());
+
+  egr::ActivationOffloader::Instance().Reset();
+  FLAGS_eager_activation_offload_budget_mb = budget_mb;
+}
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Eager Dygraph dispatch overhead of the ops on tiny tensors
+
+#include <chrono>
+#include <iostream>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/api/all.h"
+#include "paddle/fluid/eager/api/generated/eager_generated/forwards/dygraph_functions.h"
+#include "paddle/fluid/imperative/tracer.h"
+#include "test/cpp/eager/test_utils.h"
+
+COMMON_DECLARE_bool(enable_kernel_selection_cache);
+
+static size_t max_num_benchmark_runs = 100000;
+
+static double benchmark_eager_tiny_ops(const paddle::Tensor& x,
+                                       const paddle::Tensor& y) {
+  paddle::Tensor out;
+  auto t_start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < max_num_benchmark_runs; i++) {
+    out = add_ad_func(x, y);
+    out = relu_ad_func(out);
+    out = scale_ad_func(out, 2.0, 1.0, true);
+  }
+  auto t_end = std::chrono::high_resolution_clock::now();
+  double elapsed_time_s =
+      std::chrono::duration<double>(t_end - t_start).count();
+  eager_test::CompareTensorWithValue<float>(out, 7.0);
+  return 3 * max_num_benchmark_runs / elapsed_time_s;
+}
+
+TEST(Benchmark, EagerTinyOpsDispatchCPU) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(phi::CPUPlace());
+  // Only the forward dispatch is measured
+  egr::Controller::Instance().SetHasGrad(false);
+
+  phi::DDim ddim = common::make_ddim({1});
+  paddle::Tensor x = eager_test::CreateTensorWithValue(ddim,
+                                                       phi::CPUPlace(),
+                                                       phi::DataType::FLOAT32,
+                                                       phi::DataLayout::NCHW,
+                                                       1.0,
+                                                       false);
+  paddle::Tensor y = eager_test::CreateTensorWithValue(ddim,
+                                                       phi::CPUPlace(),
+                                                       phi::DataType::FLOAT32,
+                                                       phi::DataLayout::NCHW,
+                                                       2.0,
+                                                       false);
+
+  for (bool use_cache : {false, true}) {
+    FLAGS_enable_kernel_selection_cache = use_cache;
+    // Warm up
+    benchmark_eager_tiny_ops(x, y);
+    double ops_per_second = benchmark_eager_tiny_ops(x, y);
+    std::cout << "Kernel selection cache " << (use_cache ? "on" : "off")
+              << ": " << ops_per_second << " ops/s" << std::endl;
+  }
+
+  FLAGS_enable_kernel_selection_cache = true;
+  egr::Controller::Instance().SetHasGrad(true);
+}
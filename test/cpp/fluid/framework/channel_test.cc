@@ -0,0 +1,148 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(Channel, ShardedReadWrite) {
+  Channel<int> chan = MakeChannel<int>(
+      (std::numeric_limits<size_t>::max)(), /*shard_num=*/4);
+  EXPECT_EQ(chan->ShardNum(), 4UL);
+  std::vector<int> data(10);
+  std::iota(data.begin(), data.end(), 0);
+  EXPECT_EQ(chan->Write(data), 10UL);
+  EXPECT_EQ(chan->Size(), 10UL);
+
+  std::vector<int> out;
+  chan->SetBlockSize(4);
+  EXPECT_EQ(chan->Read(out), 4UL);
+  EXPECT_EQ(chan->ReadOnce(out, 100), 6UL);
+  EXPECT_TRUE(chan->Empty());
+
+  EXPECT_EQ(chan->Write(data), 10UL);
+  chan->Close();
+  EXPECT_EQ(chan->Write(data), 0UL);
+  EXPECT_EQ(chan->ReadAll(out), 10UL);
+  EXPECT_EQ(std::accumulate(out.begin(), out.end(), 0), 45);
+  EXPECT_EQ(chan->Read(out), 0UL);
+
+  Channel<int> other = MakeChannel<int>(chan);
+  EXPECT_EQ(other->ShardNum(), 4UL);
+  EXPECT_EQ(other->BlockSize(), 4UL);
+}
+
+TEST(Channel, ShardedGetData) {
+  Channel<int> chan = MakeChannel<int>(
+      (std::numeric_limits<size_t>::max)(), /*shard_num=*/4);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&chan, i]() { chan->Put(i); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  const std::deque<int>& data = chan->GetData();
+  EXPECT_EQ(data.size(), 4UL);
+  EXPECT_EQ(std::accumulate(data.begin(), data.end(), 0), 6);
+  EXPECT_EQ(chan->Size(), 4UL);
+  chan->Clear();
+  EXPECT_TRUE(chan->Empty());
+}
+
+// Loads with producer_num threads writing blocks while consumer_num threads
+// read blocks, as the readers and the consumers of the dataset channels, and
+// checks that every element is read once.
+static void RunChannel(size_t shard_num,
+                       size_t capacity,
+                       int producer_num,
+                       int consumer_num,
+                       int block_num) {
+  constexpr int kBlockSize = 1024;
+  Channel<int64_t> chan = MakeChannel<int64_t>(capacity, shard_num);
+  chan->SetBlockSize(kBlockSize);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int64_t> count{0};
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < consumer_num; ++i) {
+    consumers.emplace_back([&]() {
+      std::vector<int64_t> data;
+      int64_t local_sum = 0;
+      int64_t local_count = 0;
+      while (chan->Read(data) != 0) {
+        for (auto x : data) {
+          local_sum += x;
+        }
+        local_count += static_cast<int64_t>(data.size());
+      }
+      sum += local_sum;
+      count += local_count;
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < producer_num; ++i) {
+    producers.emplace_back([&]() {
+      std::vector<int64_t> block(kBlockSize);
+      for (int j = 0; j < block_num; ++j) {
+        std::iota(block.begin(), block.end(), 0);
+        chan->WriteMove(block.size(), &block[0]);
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  chan->Close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+  int64_t total = static_cast<int64_t>(producer_num) * block_num;
+  EXPECT_EQ(count.load(), total * kBlockSize);
+  EXPECT_EQ(sum.load(), total * kBlockSize * (kBlockSize - 1) / 2);
+}
+
+TEST(Channel, ShardedConcurrentReadWrite) {
+  struct Pattern {
+    size_t capacity;
+    int producer_num;
+    int consumer_num;
+  };
+  // the readers loading into the input channel of the dataset, and the
+  // records put back into the SlotObjPool by the trainer threads
+  std::vector<Pattern> patterns = {
+      {(std::numeric_limits<size_t>::max)(), 16, 16},
+      {(std::numeric_limits<size_t>::max)(), 16, 1},
+      {64 * 1024, 16, 16}};
+  for (auto& pattern : patterns) {
+    for (size_t shard_num : {1, 16}) {
+      RunChannel(shard_num,
+                 pattern.capacity,
+                 pattern.producer_num,
+                 pattern.consumer_num,
+                 64);
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
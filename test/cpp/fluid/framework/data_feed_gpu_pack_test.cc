@@ -0,0 +1,140 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+#if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
+namespace paddle {
+namespace framework {
+
+class GpuPackDataFeed : public SlotRecordInMemoryDataFeed {
+ public:
+  using SlotRecordInMemoryDataFeed::AssignFeedVar;
+  using SlotRecordInMemoryDataFeed::BuildSlotBatchGPU;
+  using SlotRecordInMemoryDataFeed::PackToScope;
+
+  const std::vector<UsedSlotInfo>& used_slots_info() const {
+    return used_slots_info_;
+  }
+};
+
+// Slot s of instance i holds (i + s) % 3 + 1 values, so every slot has
+// values and the offsets of the slots differ between instances.
+static size_t SlotLen(int ins, int slot) { return (ins + slot) % 3 + 1; }
+
+static uint64_t Uint64Value(int ins, int slot, size_t k) {
+  return static_cast<uint64_t>(ins) * 100 + slot * 10 + k;
+}
+
+static float FloatValue(int ins, int slot, size_t k) {
+  return static_cast<float>(ins) + 0.25f * slot + 0.5f * k;
+}
+
+TEST(DataFeed, GpuPackMatchesHostSlots) {
+  const std::vector<std::string> names = {"u0", "f0", "u1", "f1"};
+  DataFeedDesc desc;
+  desc.set_name("SlotRecordInMemoryDataFeed");
+  desc.set_batch_size(32);
+  for (auto& name : names) {
+    auto* slot = desc.mutable_multi_slot_desc()->add_slots();
+    slot->set_name(name);
+    slot->set_type(name[0] == 'u' ? "uint64" : "float");
+    slot->set_is_used(true);
+  }
+
+  phi::GPUPlace place(0);
+  GpuPackDataFeed feed;
+  feed.Init(desc);
+  feed.SetPlace(place);
+
+  Scope scope;
+  for (auto& name : names) {
+    scope.Var(name)->GetMutable<phi::DenseTensor>();
+  }
+  feed.AssignFeedVar(scope);
+
+  MiniBatchGpuPack* pack =
+      BatchGpuPackMgr().get(place, feed.used_slots_info());
+  // the batches grow and shrink through the same pack, so a copy that is
+  // not waited for would leave the values of the previous batch behind
+  for (int ins_num : {1, 5, 17, 3, 32, 2}) {
+    std::vector<SlotRecord> records;
+    SlotRecordPool().get(&records, ins_num);
+    for (int i = 0; i < ins_num; ++i) {
+      std::vector<std::vector<uint64_t>> uint64_feasigns(2);
+      std::vector<std::vector<float>> float_feasigns(2);
+      for (int s = 0; s < static_cast<int>(names.size()); ++s) {
+        for (size_t k = 0; k < SlotLen(i, s); ++k) {
+          if (names[s][0] == 'u') {
+            uint64_feasigns[s / 2].push_back(Uint64Value(i, s, k));
+          } else {
+            float_feasigns[s / 2].push_back(FloatValue(i, s, k));
+          }
+        }
+      }
+      records[i]->slot_uint64_feasigns_.clear(false);
+      records[i]->slot_uint64_feasigns_.add_slot_feasigns(
+          uint64_feasigns,
+          uint64_feasigns[0].size() + uint64_feasigns[1].size());
+      records[i]->slot_float_feasigns_.clear(false);
+      records[i]->slot_float_feasigns_.add_slot_feasigns(
+          float_feasigns, float_feasigns[0].size() + float_feasigns[1].size());
+    }
+
+    pack->pack_instance(records.data(), ins_num);
+    feed.BuildSlotBatchGPU(ins_num, pack);
+    feed.PackToScope(pack, &scope);
+
+    for (int s = 0; s < static_cast<int>(names.size()); ++s) {
+      const auto& tensor = scope.FindVar(names[s])->Get<phi::DenseTensor>();
+      phi::DenseTensor cpu_tensor;
+      TensorCopySync(tensor, phi::CPUPlace(), &cpu_tensor);
+
+      std::vector<size_t> lod = {0};
+      for (int i = 0; i < ins_num; ++i) {
+        lod.push_back(lod.back() + SlotLen(i, s));
+      }
+      ASSERT_EQ(tensor.lod().size(), 1UL);
+      EXPECT_EQ(std::vector<size_t>(tensor.lod()[0].begin(),
+                                    tensor.lod()[0].end()),
+                lod);
+      ASSERT_EQ(cpu_tensor.numel(), static_cast<int64_t>(lod.back()));
+
+      size_t pos = 0;
+      for (int i = 0; i < ins_num; ++i) {
+        for (size_t k = 0; k < SlotLen(i, s); ++k, ++pos) {
+          if (names[s][0] == 'u') {
+            EXPECT_EQ(static_cast<uint64_t>(cpu_tensor.data<int64_t>()[pos]),
+                      Uint64Value(i, s, k));
+          } else {
+            EXPECT_EQ(cpu_tensor.data<float>()[pos], FloatValue(i, s, k));
+          }
+        }
+      }
+    }
+    SlotRecordPool().put(&records);
+  }
+  pack->set_use_flag(false);
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/device_worker.h"
+
+COMMON_DECLARE_bool(downpour_lite_worker_sparse_prefetch);
+
+namespace paddle {
+namespace framework {
+
+// gives batches of 2 instances, whose ins ids are their batch indexes
+class FakeDataFeed : public DataFeed {
+ public:
+  explicit FakeDataFeed(int num_batches) : num_batches_(num_batches) {}
+  void Init(const DataFeedDesc& data_feed_desc UNUSED) override {}
+  bool Start() override { return true; }
+  int Next() override {
+    if (batch_idx_ == num_batches_) {
+      return 0;
+    }
+    batch_size_ = 2;
+    ins_id_vec_ = {std::to_string(batch_idx_), std::to_string(batch_idx_)};
+    ++batch_idx_;
+    return batch_size_;
+  }
+
+ private:
+  int num_batches_;
+  int batch_idx_ = 0;
+};
+
+TEST(DownpourLiteWorkerTest, ins_ids_of_prefetched_batch) {
+  FLAGS_downpour_lite_worker_sparse_prefetch = true;
+  FakeDataFeed data_feed(3);
+  Scope scope;
+  DownpourLiteWorker worker;
+  worker.SetNeedDumpField(false);
+  worker.SetPlace(phi::CPUPlace());
+  worker.SetDataFeed(&data_feed);
+  worker.thread_scope_ = &scope;
+  worker.InitSparsePrefetch();
+  ASSERT_TRUE(worker.sparse_prefetch_);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(worker.NextBatch(), 2);
+    // the reader moves on to the next batch meanwhile
+    worker.prefetch_future_.wait();
+    const std::string ins_id = std::to_string(i);
+    EXPECT_EQ(worker.batch_ins_ids_, std::vector<std::string>(2, ins_id));
+    EXPECT_EQ(worker.batch_size_, 2);
+  }
+  EXPECT_EQ(worker.NextBatch(), 0);
+  FLAGS_downpour_lite_worker_sparse_prefetch = false;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/box_wrapper.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#if defined(PADDLE_WITH_BOX_PS) && defined(PADDLE_WITH_CUDA)
+#include <cuda_runtime.h>
+
+#include "paddle/phi/core/memory/malloc.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(BoxWrapper, DedupKeys) {
+  phi::GPUPlace place(0);
+  BoxWrapper box_wrapper;
+  EXPECT_EQ(box_wrapper.DedupKeys(place, nullptr, nullptr, nullptr, 0), 0);
+
+  // the keys of the slots repeat, and the padded positions are the key 0
+  const int total_len = 10000;
+  std::mt19937_64 rng(2024);
+  std::uniform_int_distribution<uint64_t> dist(0, 999);
+  std::vector<uint64_t> keys(total_len);
+  for (auto& key : keys) {
+    key = dist(rng) * 1000003ULL;
+  }
+  std::set<uint64_t> distinct(keys.begin(), keys.end());
+
+  auto buf_keys = memory::Alloc(place, total_len * sizeof(uint64_t));
+  auto buf_unique_keys = memory::Alloc(place, total_len * sizeof(uint64_t));
+  auto buf_key_index = memory::Alloc(place, total_len * sizeof(int));
+  auto* gpu_keys = reinterpret_cast<uint64_t*>(buf_keys->ptr());
+  auto* gpu_unique_keys = reinterpret_cast<uint64_t*>(buf_unique_keys->ptr());
+  auto* gpu_key_index = reinterpret_cast<int*>(buf_key_index->ptr());
+  ASSERT_EQ(cudaMemcpy(gpu_keys,
+                       keys.data(),
+                       total_len * sizeof(uint64_t),
+                       cudaMemcpyHostToDevice),
+            cudaSuccess);
+
+  int unique_len = box_wrapper.DedupKeys(
+      place, gpu_keys, gpu_unique_keys, gpu_key_index, total_len);
+  ASSERT_EQ(unique_len, static_cast<int>(distinct.size()));
+
+  std::vector<uint64_t> unique_keys(unique_len);
+  std::vector<int> key_index(total_len);
+  ASSERT_EQ(cudaMemcpy(unique_keys.data(),
+                       gpu_unique_keys,
+                       unique_len * sizeof(uint64_t),
+                       cudaMemcpyDeviceToHost),
+            cudaSuccess);
+  ASSERT_EQ(cudaMemcpy(key_index.data(),
+                       gpu_key_index,
+                       total_len * sizeof(int),
+                       cudaMemcpyDeviceToHost),
+            cudaSuccess);
+
+  // the distinct keys are sorted, and every key finds itself by its index
+  EXPECT_EQ(unique_keys,
+            std::vector<uint64_t>(distinct.begin(), distinct.end()));
+  for (int i = 0; i < total_len; ++i) {
+    ASSERT_GE(key_index[i], 0);
+    ASSERT_LT(key_index[i], unique_len);
+    EXPECT_EQ(unique_keys[key_index[i]], keys[i]);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
@@ -0,0 +1,124 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/feasign_dedup.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(FeasignDedup, UniqueAndInverse) {
+  std::mt19937_64 rng(0);
+  FeasignDedup dedup;
+  for (size_t num : {0, 1, 7, 1000, 100000}) {
+    std::vector<uint64_t> keys(num);
+    for (auto& key : keys) {
+      // power-law like, with a few frequent keys
+      key = rng() % 4 == 0 ? rng() : rng() % 64;
+    }
+    dedup.Build(keys.data(), keys.size());
+    const auto& unique_keys = dedup.unique_keys();
+    const auto& inverse = dedup.inverse();
+    EXPECT_EQ(unique_keys.size(),
+              std::set<uint64_t>(keys.begin(), keys.end()).size());
+    ASSERT_EQ(inverse.size(), num);
+    for (size_t i = 0; i < num; ++i) {
+      EXPECT_EQ(unique_keys[inverse[i]], keys[i]);
+    }
+
+    // values pulled for the unique keys are copied to the duplicates
+    const size_t dim = 3;
+    std::vector<float> values(num * dim, 0);
+    std::vector<float*> value_ptrs(num);
+    for (size_t i = 0; i < num; ++i) {
+      value_ptrs[i] = values.data() + i * dim;
+    }
+    auto& unique_values = dedup.UniqueValues(value_ptrs.data());
+    ASSERT_EQ(unique_values.size(), unique_keys.size());
+    for (size_t i = 0; i < unique_keys.size(); ++i) {
+      for (size_t j = 0; j < dim; ++j) {
+        unique_values[i][j] = static_cast<float>(unique_keys[i] % 1000 + j);
+      }
+    }
+    dedup.CopyToDuplicates(value_ptrs.data(), dim);
+    for (size_t i = 0; i < num; ++i) {
+      for (size_t j = 0; j < dim; ++j) {
+        EXPECT_EQ(value_ptrs[i][j], static_cast<float>(keys[i] % 1000 + j));
+      }
+    }
+  }
+}
+
+TEST(FeasignDedup, Pull) {
+  // the ids of a batch as PullSparseToTensorSync sees them, where the
+  // padding id is skipped and keeps the value written for it
+  const uint64_t padding_id = 0;
+  const size_t dim = 4;
+  const float padding_value = -1.0f;
+  std::vector<uint64_t> ids = {5, 0, 9, 5, 5, 0, 7, 9, 11, 5};
+  std::vector<float> output(ids.size() * dim, padding_value);
+  std::vector<uint64_t> keys;
+  std::vector<float*> value_ptrs;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] == padding_id) {
+      continue;
+    }
+    keys.push_back(ids[i]);
+    value_ptrs.push_back(output.data() + i * dim);
+  }
+
+  size_t num_pulled = 0;
+  auto ret = FeasignDedup::Pull(
+      keys.data(),
+      value_ptrs.data(),
+      keys.size(),
+      dim,
+      [&](float** values, const uint64_t* unique_keys, size_t num) {
+        num_pulled += num;
+        for (size_t i = 0; i < num; ++i) {
+          for (size_t j = 0; j < dim; ++j) {
+            values[i][j] = static_cast<float>(unique_keys[i] * 10 + j);
+          }
+        }
+        return 0;
+      });
+  EXPECT_EQ(ret, 0);
+  // 5, 9, 7 and 11 are pulled once each
+  EXPECT_EQ(num_pulled, 4UL);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    for (size_t j = 0; j < dim; ++j) {
+      float expected = ids[i] == padding_id
+                           ? padding_value
+                           : static_cast<float>(ids[i] * 10 + j);
+      EXPECT_EQ(output[i * dim + j], expected);
+    }
+  }
+
+  // the status of the pull is returned
+  ret = FeasignDedup::Pull(
+      keys.data(),
+      value_ptrs.data(),
+      keys.size(),
+      dim,
+      [](float**, const uint64_t*, size_t) { return -1; });
+  EXPECT_EQ(ret, -1);
+}
+
+}  // namespace framework
+}  // namespace paddle
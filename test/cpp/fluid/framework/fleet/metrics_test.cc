@@ -0,0 +1,193 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/fleet/metrics.h"
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#if (defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_PSCORE)) && \
+    defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_GLOO)
+#include <cuda_runtime.h>
+
+namespace paddle {
+namespace framework {
+
+constexpr int kTableSize = 1000;
+
+struct MetricsData {
+  std::vector<float> pred;
+  std::vector<int64_t> label;
+  std::vector<int64_t> mask;
+  std::vector<int64_t> uid;
+};
+
+MetricsData MakeMetricsData(int num) {
+  MetricsData data;
+  std::mt19937 rng(2024);
+  std::uniform_real_distribution<float> uniform(0.0, 1.0);
+  for (int i = 0; i < num; ++i) {
+    // in the middle of a bucket, so the host and the device bucket it alike
+    float pred = (static_cast<int>(uniform(rng) * kTableSize) + 0.5f) /
+                 static_cast<float>(kTableSize);
+    data.pred.push_back(pred);
+    data.label.push_back(uniform(rng) < pred ? 1 : 0);
+    data.mask.push_back(i % 3 != 0);
+    data.uid.push_back(i % 97);
+  }
+  return data;
+}
+
+template <typename T>
+std::shared_ptr<T> ToDevice(const std::vector<T>& host) {
+  T* ptr = nullptr;
+  EXPECT_EQ(cudaMalloc(&ptr, sizeof(T) * host.size()), cudaSuccess);
+  EXPECT_EQ(cudaMemcpy(ptr,
+                       host.data(),
+                       sizeof(T) * host.size(),
+                       cudaMemcpyHostToDevice),
+            cudaSuccess);
+  return std::shared_ptr<T>(ptr, [](T* p) { cudaFree(p); });
+}
+
+void InitGloo() {
+  auto gloo = GlooWrapper::GetInstance();
+  if (gloo->IsInitialized()) {
+    return;
+  }
+  char dir_template[] = "/tmp/metrics_test_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  gloo->SetTimeoutSeconds(60, 60);
+  gloo->SetRank(0);
+  gloo->SetSize(1);
+  gloo->SetPrefix("metrics_test");
+  gloo->SetIface("lo");
+  gloo->SetHdfsStore(dir_template, "", "");
+  gloo->Init();
+}
+
+void ExpectSameMetrics(const BasicAucCalculator& expected,
+                       const BasicAucCalculator& actual) {
+  EXPECT_DOUBLE_EQ(actual.size(), expected.size());
+  EXPECT_NEAR(actual.auc(), expected.auc(), 1e-9);
+  EXPECT_NEAR(actual.mae(), expected.mae(), 1e-9);
+  EXPECT_NEAR(actual.rmse(), expected.rmse(), 1e-9);
+  EXPECT_NEAR(actual.actual_ctr(), expected.actual_ctr(), 1e-9);
+  EXPECT_NEAR(actual.predicted_ctr(), expected.predicted_ctr(), 1e-9);
+  EXPECT_NEAR(actual.bucket_error(), expected.bucket_error(), 1e-9);
+}
+
+TEST(BasicAucCalculator, DeviceData) {
+  InitGloo();
+  const int num = 20000;
+  const int half = num / 2;
+  MetricsData data = MakeMetricsData(num);
+  auto d_pred = ToDevice(data.pred);
+  auto d_label = ToDevice(data.label);
+  phi::CPUPlace cpu;
+  phi::GPUPlace gpu(0);
+
+  BasicAucCalculator host_calc;
+  host_calc.init(kTableSize);
+  host_calc.add_data(data.pred.data(), data.label.data(), half, cpu);
+  host_calc.add_data(
+      data.pred.data() + half, data.label.data() + half, num - half, cpu);
+  host_calc.compute();
+
+  // the batches stay on the GPU until compute
+  BasicAucCalculator device_calc;
+  device_calc.init(kTableSize);
+  device_calc.add_data(d_pred.get(), d_label.get(), half, gpu);
+  device_calc.add_data(
+      d_pred.get() + half, d_label.get() + half, num - half, gpu);
+  device_calc.compute();
+  EXPECT_DOUBLE_EQ(device_calc.size(), num);
+  ExpectSameMetrics(host_calc, device_calc);
+
+  // the data of the last compute is not added again
+  device_calc.reset();
+  device_calc.add_data(d_pred.get(), d_label.get(), half, gpu);
+  device_calc.compute();
+  EXPECT_DOUBLE_EQ(device_calc.size(), half);
+}
+
+TEST(BasicAucCalculator, DeviceMaskData) {
+  InitGloo();
+  const int num = 20000;
+  MetricsData data = MakeMetricsData(num);
+  auto d_pred = ToDevice(data.pred);
+  auto d_label = ToDevice(data.label);
+  auto d_mask = ToDevice(data.mask);
+
+  BasicAucCalculator host_calc;
+  host_calc.init(kTableSize);
+  host_calc.add_mask_data(data.pred.data(),
+                          data.label.data(),
+                          data.mask.data(),
+                          num,
+                          phi::CPUPlace());
+  host_calc.compute();
+
+  BasicAucCalculator device_calc;
+  device_calc.init(kTableSize);
+  device_calc.add_mask_data(
+      d_pred.get(), d_label.get(), d_mask.get(), num, phi::GPUPlace(0));
+  device_calc.compute();
+  EXPECT_LT(device_calc.size(), num);
+  ExpectSameMetrics(host_calc, device_calc);
+}
+
+TEST(BasicAucCalculator, DeviceUidData) {
+  InitGloo();
+  const int num = 20000;
+  const int half = num / 2;
+  MetricsData data = MakeMetricsData(num);
+  auto d_pred = ToDevice(data.pred);
+  auto d_label = ToDevice(data.label);
+  auto d_uid = ToDevice(data.uid);
+  phi::CPUPlace cpu;
+  phi::GPUPlace gpu(0);
+
+  BasicAucCalculator host_calc;
+  host_calc.init(kTableSize);
+  host_calc.reset_records();
+  host_calc.add_uid_data(
+      data.pred.data(), data.label.data(), data.uid.data(), num, cpu);
+  host_calc.computeWuAuc();
+
+  BasicAucCalculator device_calc;
+  device_calc.init(kTableSize);
+  device_calc.reset_records();
+  device_calc.add_uid_data(d_pred.get(), d_label.get(), d_uid.get(), half, gpu);
+  device_calc.add_uid_data(d_pred.get() + half,
+                           d_label.get() + half,
+                           d_uid.get() + half,
+                           num - half,
+                           gpu);
+  device_calc.computeWuAuc();
+
+  EXPECT_DOUBLE_EQ(device_calc.size(), host_calc.size());
+  EXPECT_DOUBLE_EQ(device_calc.user_cnt(), host_calc.user_cnt());
+  EXPECT_NEAR(device_calc.uauc(), host_calc.uauc(), 1e-9);
+  EXPECT_NEAR(device_calc.wuauc(), host_calc.wuauc(), 1e-9);
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
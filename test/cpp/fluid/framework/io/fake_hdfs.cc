@@ -0,0 +1,118 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A libhdfs over the local files for hdfs_native_test. The path of a file is
+// the local path after the name node of an hdfs url.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+extern "C" {
+
+struct hdfsBuilder {};
+
+struct hdfsFileInfo {
+  int mKind;
+  char* mName;
+  time_t mLastMod;
+  int64_t mSize;
+  int16_t mReplication;
+  int64_t mBlockSize;
+  char* mOwner;
+  char* mGroup;
+  int16_t mPermissions;
+  time_t mLastAccess;
+};
+
+static std::atomic<int> connects{0};
+static std::atomic<int> active_preads{0};
+static std::atomic<int> max_active_preads{0};
+static std::atomic<int64_t> fail_offset{-1};
+
+static const char* local_path(const char* path) {
+  const char* p = strstr(path, "://");
+  return p == nullptr ? path : strchr(p + 3, '/');
+}
+
+hdfsBuilder* hdfsNewBuilder() { return new hdfsBuilder(); }
+
+void hdfsBuilderSetNameNode(hdfsBuilder*, const char*) {}
+
+void hdfsBuilderSetUserName(hdfsBuilder*, const char*) {}
+
+int hdfsBuilderConfSetStr(hdfsBuilder*, const char*, const char*) {
+  return 0;
+}
+
+void* hdfsBuilderConnect(hdfsBuilder* builder) {
+  delete builder;
+  ++connects;
+  return reinterpret_cast<void*>(1);
+}
+
+void* hdfsOpenFile(void*, const char* path, int, int, int16_t, int32_t) {
+  int fd = open(local_path(path), O_RDONLY);
+  return fd < 0 ? nullptr : reinterpret_cast<void*>(intptr_t(fd) + 1);
+}
+
+int hdfsCloseFile(void*, void* file) {
+  return close(static_cast<int>(reinterpret_cast<intptr_t>(file) - 1));
+}
+
+int32_t hdfsPread(
+    void*, void* file, int64_t offset, void* buffer, int32_t length) {
+  int active = ++active_preads;
+  int max_active = max_active_preads;
+  while (active > max_active &&
+         !max_active_preads.compare_exchange_weak(max_active, active)) {
+  }
+  // give the other threads the time to overlap
+  usleep(1000);
+  int32_t ret = -1;
+  int64_t fail = fail_offset;
+  if (fail < 0 || offset < fail) {
+    ret = pread(static_cast<int>(reinterpret_cast<intptr_t>(file) - 1),
+                buffer,
+                length,
+                offset);
+  }
+  --active_preads;
+  return ret;
+}
+
+hdfsFileInfo* hdfsGetPathInfo(void*, const char* path) {
+  struct stat st;
+  if (stat(local_path(path), &st) != 0) {
+    return nullptr;
+  }
+  hdfsFileInfo* info = new hdfsFileInfo();
+  info->mSize = st.st_size;
+  return info;
+}
+
+void hdfsFreeFileInfo(hdfsFileInfo* info, int) { delete info; }
+
+// The hooks of the test.
+int fake_hdfs_connects() { return connects; }
+
+int fake_hdfs_max_active_preads() { return max_active_preads; }
+
+void fake_hdfs_fail_from(int64_t offset) { fail_offset = offset; }
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <dlfcn.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/io/hdfs_native.h"
+
+COMMON_DECLARE_bool(hdfs_native_read);
+COMMON_DECLARE_string(hdfs_native_lib);
+COMMON_DECLARE_int32(hdfs_native_read_thread_num);
+COMMON_DECLARE_int64(hdfs_native_read_chunk_size);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+const char kCommand[] =
+    "hadoop fs -Dfs.default.name=afs://nn:9902 -Dhadoop.job.ugi=user,passwd";
+
+// The library is loaded once per process, so every test uses the fake one.
+class HdfsNativeTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    FLAGS_hdfs_native_read = true;
+    FLAGS_hdfs_native_lib = FAKE_HDFS_LIB;
+    FLAGS_hdfs_native_read_thread_num = 4;
+    FLAGS_hdfs_native_read_chunk_size = 1000;
+    ASSERT_TRUE(hdfs_native_available());
+    lib_ = dlopen(FAKE_HDFS_LIB, RTLD_NOW | RTLD_NOLOAD);
+    ASSERT_NE(lib_, nullptr);
+
+    for (int i = 0; i < 100000; ++i) {
+      data_ += std::to_string(i) + "\n";
+    }
+    std::ofstream out(Path("hdfs_native_test.txt"));
+    out << data_;
+    out.close();
+    // two gzip members, as written by appending to a gzip file
+    size_t half = data_.size() / 2;
+    gzFile gz = gzopen(Path("hdfs_native_test.txt.gz").c_str(), "wb");
+    gzwrite(gz, data_.data(), half);
+    gzclose(gz);
+    gz = gzopen(Path("hdfs_native_test.txt.gz").c_str(), "ab");
+    gzwrite(gz, data_.data() + half, data_.size() - half);
+    gzclose(gz);
+    std::ofstream empty(Path("hdfs_native_test.empty"));
+  }
+
+  static void TearDownTestSuite() { FLAGS_hdfs_native_read = false; }
+
+  static std::string Path(const std::string& name) {
+    static std::string cwd = [] {
+      char buf[4096];
+      return std::string(getcwd(buf, sizeof(buf)));
+    }();
+    return cwd + "/" + name;
+  }
+
+  template <typename T>
+  static T Hook(const char* name) {
+    return reinterpret_cast<T>(dlsym(lib_, name));
+  }
+
+  static std::string ReadAll(FILE* fp, size_t step) {
+    std::string result;
+    std::vector<char> buf(step);
+    size_t n = 0;
+    while ((n = fread(buf.data(), 1, step, fp)) > 0) {
+      result.append(buf.data(), n);
+    }
+    return result;
+  }
+
+  static void* lib_;
+  static std::string data_;
+};
+
+void* HdfsNativeTest::lib_ = nullptr;
+std::string HdfsNativeTest::data_;  // NOLINT
+
+}  // namespace
+
+TEST_F(HdfsNativeTest, read_by_chunks) {
+  for (size_t step : {1, 7, 4096, 1 << 20}) {
+    int err_no = 0;
+    {
+      auto fp = hdfs_native_open_read(
+          Path("hdfs_native_test.txt"), kCommand, &err_no);
+      ASSERT_NE(fp, nullptr);
+      EXPECT_EQ(ReadAll(fp.get(), step), data_);
+    }
+    EXPECT_EQ(err_no, 0);
+    {
+      auto fp = hdfs_native_open_read(
+          "afs://nn:9902" + Path("hdfs_native_test.txt.gz"), kCommand, &err_no);
+      ASSERT_NE(fp, nullptr);
+      EXPECT_EQ(ReadAll(fp.get(), step), data_);
+    }
+    EXPECT_EQ(err_no, 0);
+  }
+  // the chunks are read in parallel on a single cached connection
+  EXPECT_GT(Hook<int (*)()>("fake_hdfs_max_active_preads")(), 1);
+  EXPECT_EQ(Hook<int (*)()>("fake_hdfs_connects")(), 1);
+}
+
+TEST_F(HdfsNativeTest, empty_missing_and_closed_early) {
+  int err_no = 0;
+  EXPECT_EQ(
+      hdfs_native_open_read(Path("hdfs_native_test.none"), kCommand, &err_no),
+      nullptr);
+  {
+    auto fp = hdfs_native_open_read(
+        Path("hdfs_native_test.empty"), kCommand, &err_no);
+    ASSERT_NE(fp, nullptr);
+    EXPECT_TRUE(ReadAll(fp.get(), 10).empty());
+  }
+  EXPECT_EQ(err_no, 0);
+  {
+    // the threads still fetching the chunks ahead are stopped on close
+    auto fp =
+        hdfs_native_open_read(Path("hdfs_native_test.txt"), kCommand, &err_no);
+    ASSERT_NE(fp, nullptr);
+    char buf[10];
+    EXPECT_EQ(fread(buf, 1, sizeof(buf), fp.get()), sizeof(buf));
+  }
+  EXPECT_EQ(err_no, 0);
+}
+
+TEST_F(HdfsNativeTest, failed_read) {
+  Hook<void (*)(int64_t)>("fake_hdfs_fail_from")(data_.size() / 2);
+  int err_no = 0;
+  {
+    auto fp =
+        hdfs_native_open_read(Path("hdfs_native_test.txt"), kCommand, &err_no);
+    ASSERT_NE(fp, nullptr);
+    EXPECT_LT(ReadAll(fp.get(), 4096).size(), data_.size());
+    EXPECT_TRUE(ferror(fp.get()));
+  }
+  EXPECT_EQ(err_no, -1);
+  Hook<void (*)(int64_t)>("fake_hdfs_fail_from")(-1);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/slot_columnar_file.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "paddle/fluid/framework/io/fs.h"
+
+#if defined _WIN32 || defined __APPLE__
+#else
+#define _LINUX
+#endif
+
+namespace paddle {
+namespace framework {
+
+static void TestSlotColumnarFile(int compress_level) {
+#ifdef _LINUX
+  std::string path = "slot_columnar_file_test.col";
+  std::vector<SlotColumnarSlot> slots = {
+      {"click", "uint64"}, {"dense", "float"}, {"query", "uint64"}};
+  {
+    SlotColumnarWriter writer(path, slots, true, 2, compress_level);
+    EXPECT_TRUE(writer.AddTextLine("1 ins_0 1 1 2 0.5 1.5 2 11 12"));
+    EXPECT_TRUE(writer.AddTextLine("1 ins_1 1 0 2 2.5 3.5 0"));
+    EXPECT_FALSE(writer.AddTextLine("1 ins_2 1 x"));
+    writer.AddInstance("ins_0", {{1}, {13, 14, 15}}, {{4.5, 5.5}});
+    EXPECT_EQ(writer.ins_num(), 3UL);
+  }
+
+  int err_no = 0;
+  SlotColumnarReader reader(fs_open_read(path, &err_no, "", true));
+  ASSERT_EQ(reader.slots().size(), slots.size());
+  for (size_t i = 0; i < slots.size(); ++i) {
+    EXPECT_EQ(reader.slots()[i].name, slots[i].name);
+    EXPECT_EQ(reader.slots()[i].type, slots[i].type);
+  }
+  EXPECT_TRUE(reader.with_ins_id());
+
+  std::vector<std::string> ins_ids;
+  std::vector<std::vector<uint64_t>> queries;
+  std::vector<float> dense;
+  while (reader.NextBlock()) {
+    for (size_t i = 0; i < reader.ins_num(); ++i) {
+      ins_ids.push_back(reader.ins_id_dict_entry(reader.ins_id_index(i)));
+      const uint32_t* offsets = reader.slot_offsets(2);
+      queries.emplace_back(reader.uint64_values(2) + offsets[i],
+                           reader.uint64_values(2) + offsets[i + 1]);
+      offsets = reader.slot_offsets(1);
+      dense.insert(dense.end(),
+                   reader.float_values(1) + offsets[i],
+                   reader.float_values(1) + offsets[i + 1]);
+    }
+  }
+  EXPECT_EQ(ins_ids, std::vector<std::string>({"ins_0", "ins_1", "ins_0"}));
+  EXPECT_EQ(queries,
+            std::vector<std::vector<uint64_t>>({{11, 12}, {}, {13, 14, 15}}));
+  EXPECT_EQ(dense, std::vector<float>({0.5, 1.5, 2.5, 3.5, 4.5, 5.5}));
+  localfs_remove(path);
+#endif
+}
+
+TEST(SlotColumnarFile, WriteAndRead) { TestSlotColumnarFile(0); }
+
+TEST(SlotColumnarFile, WriteAndReadCompressed) { TestSlotColumnarFile(1); }
+
+}  // namespace framework
+}  // namespace paddle
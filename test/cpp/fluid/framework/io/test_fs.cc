@@ -16,13 +16,18 @@
 
 #include <fstream>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/framework/io/hdfs_native.h"
 
 #if defined _WIN32 || defined __APPLE__
 #else
 #define _LINUX
 #endif
 
+COMMON_DECLARE_bool(hdfs_native_read);
+COMMON_DECLARE_string(hdfs_native_lib);
+
 TEST(FS, mv) {
 #ifdef _LINUX
   std::ofstream out("src.txt");
@@ -60,3 +65,23 @@ TEST(FS, mv) {
 
 #endif
 }
+
+TEST(FS, hdfs_native_read_fallback) {
+#ifdef _LINUX
+  FLAGS_hdfs_native_read = true;
+  FLAGS_hdfs_native_lib = "libhdfs_not_exist.so";
+  EXPECT_FALSE(paddle::framework::hdfs_native_available());
+  int err_no = 0;
+  EXPECT_EQ(paddle::framework::hdfs_native_open_read(
+                "afs:/none", "hadoop fs -Dhadoop.job.ugi=user,passwd", &err_no),
+            nullptr);
+  EXPECT_EQ(err_no, 0);
+  // falls back to the pipe of the hadoop command
+  try {
+    paddle::framework::hdfs_open_read("afs:/none", &err_no, "cat", true);
+  } catch (...) {
+    VLOG(3) << "test hdfs_open_read, catch expected errors of unknown path";
+  }
+  FLAGS_hdfs_native_read = false;
+#endif
+}
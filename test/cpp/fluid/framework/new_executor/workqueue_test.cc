@@ -203,3 +203,44 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueue, TestNumaAwareWorkQueue) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::GetNumaNodeCpus;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kExternalLoopNum = 100;
+  constexpr unsigned kLoopNum = 10000;
+  EXPECT_GE(GetNumaNodeCpus().size(), 1u);
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "NumaAwareWorkQueueForTesting",
+                           /*num_threads*/ 4,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  options.numa_aware = true;
+  options.bind_threads = true;
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  EXPECT_EQ(work_queue->NumThreads(), 4u);
+  for (unsigned i = 0; i < kExternalLoopNum; ++i) {
+    work_queue->AddTask([=, &counter]() {
+      for (unsigned i = 0; i < kLoopNum; ++i) {
+        ++counter;
+      }
+    });
+  }
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(counter.load(), kLoopNum * kExternalLoopNum);
+  auto stats = work_queue->ThreadStats();
+  ASSERT_EQ(stats.size(), 4u);
+  uint64_t executed = 0;
+  for (const auto& s : stats) {
+    EXPECT_GE(s.numa_node, 0);
+    EXPECT_GE(s.cpu, 0);
+    executed += s.own_tasks + s.local_steals + s.global_steals;
+  }
+  EXPECT_EQ(executed, kExternalLoopNum);
+}
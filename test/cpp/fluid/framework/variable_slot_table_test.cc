@@ -0,0 +1,64 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/variable_slot_table.h"
+
+#include "gtest/gtest.h"
+
+using paddle::framework::Scope;
+using paddle::framework::Variable;
+using paddle::framework::VariableSlotTable;
+
+TEST(VariableSlotTable, Resolve) {
+  Scope s;
+  Scope& ss = s.NewScope();
+  Variable* a = s.Var("a");
+  Variable* b = ss.Var("b");
+
+  VariableSlotTable table(ss, {"a", "b", "c"});
+  EXPECT_TRUE(table.IsBuiltFor(&ss));
+  EXPECT_FALSE(table.IsBuiltFor(&s));
+  EXPECT_EQ(table.size(), 2UL);
+  EXPECT_EQ(table.Slot("a"), 0);
+  EXPECT_EQ(table.Slot("b"), 1);
+  EXPECT_EQ(table.Slot("c"), VariableSlotTable::kInvalidSlot);
+  EXPECT_EQ(table.Var(0), a);
+  EXPECT_EQ(table.FindVar("b"), b);
+  EXPECT_EQ(table.FindVar("c"), nullptr);
+
+  // The variables created later are resolved on demand.
+  EXPECT_EQ(table.Resolve("c"), VariableSlotTable::kInvalidSlot);
+  Variable* c = ss.Var("c");
+  EXPECT_EQ(table.Resolve("c"), 2);
+  EXPECT_EQ(table.Var(2), c);
+  EXPECT_EQ(table.Resolve("a"), 0);
+}
+
+TEST(VariableSlotTable, Bind) {
+  Scope s;
+  Scope& ss = s.NewScope();
+  s.Var("a");
+
+  VariableSlotTable table(ss, {});
+  // A variable of the scope itself shadows the one of its parent.
+  Variable* local_a = ss.Var("a");
+  EXPECT_EQ(table.Bind("a", local_a), 0);
+  EXPECT_EQ(table.Resolve("a"), 0);
+  EXPECT_EQ(table.Var(0), local_a);
+
+  table.Clear();
+  EXPECT_FALSE(table.IsBuiltFor(&ss));
+  EXPECT_EQ(table.size(), 0UL);
+  EXPECT_EQ(table.Slot("a"), VariableSlotTable::kInvalidSlot);
+}
@@ -431,6 +431,42 @@ TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_large_rows) {
+  phi::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+  int64_t height = int64_t{1} << 40;
+  int64_t row_numel = 4;
+
+  // the rows differ in the low and the high bytes
+  std::vector<int64_t> rows{int64_t{1} << 33, 7, 300, 7, int64_t{1} << 33, 300};
+  std::unique_ptr<phi::SelectedRows> selected_rows{
+      new phi::SelectedRows(rows, height)};
+  auto* in_value = selected_rows->mutable_value();
+  auto* in_data = in_value->mutable_data<float>(
+      common::make_ddim({static_cast<int64_t>(rows.size()), row_numel}),
+      cpu_place);
+  for (int64_t i = 0; i < in_value->numel(); ++i) {
+    in_data[i] = static_cast<float>(i / row_numel + 1);
+  }
+
+  std::unique_ptr<phi::SelectedRows> output{new phi::SelectedRows()};
+  phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+  merge_add_functor(ctx, *selected_rows, output.get());
+
+  std::vector<int64_t> ret_rows{7, 300, int64_t{1} << 33};
+  EXPECT_EQ(output->rows(), ret_rows);
+  std::vector<float> ret_values{2 + 4, 3 + 6, 1 + 5};
+  auto* out_data = output->value().data<float>();
+  for (size_t i = 0; i < ret_rows.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], ret_values[i]);
+    }
+  }
+}
+
 TEST(selected_rows_functor, cpu_sum_to) {
   phi::CPUPlace cpu_place;
   phi::CPUContext ctx(cpu_place);
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation_trace.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+
+static std::vector<phi::Allocation> MakeAllocations(size_t num) {
+  static char buffer[1024];
+  std::vector<phi::Allocation> allocations;
+  for (size_t i = 0; i < num; ++i) {
+    allocations.emplace_back(buffer + i, i + 1, phi::CPUPlace());
+  }
+  return allocations;
+}
+
+TEST(AllocationTracer, ring_buffer) {
+  auto& tracer = AllocationTracer::Instance();
+  tracer.Enable(4, 1, false);
+  auto allocations = MakeAllocations(3);
+  for (auto& allocation : allocations) {
+    tracer.RecordAlloc(allocation, nullptr, "CPUAllocator");
+  }
+  tracer.RecordFree(allocations[0]);
+  tracer.RecordFree(allocations[1]);
+
+  // The oldest allocation is overwritten.
+  auto events = tracer.Events();
+  ASSERT_EQ(events.size(), 4UL);
+  EXPECT_EQ(events[0].ptr, allocations[1].ptr());
+  EXPECT_EQ(events[0].type, AllocationTraceEventType::kAlloc);
+  EXPECT_EQ(events[0].allocator, "CPUAllocator");
+  EXPECT_EQ(events[2].ptr, allocations[0].ptr());
+  EXPECT_EQ(events[2].type, AllocationTraceEventType::kFree);
+  EXPECT_EQ(events[3].ptr, allocations[1].ptr());
+  EXPECT_EQ(events[3].size, 2UL);
+
+  auto live_allocations = tracer.LiveAllocations();
+  ASSERT_EQ(live_allocations.size(), 1UL);
+  EXPECT_EQ(live_allocations[0].ptr, allocations[2].ptr());
+  tracer.Disable();
+}
+
+TEST(AllocationTracer, sample) {
+  auto& tracer = AllocationTracer::Instance();
+  tracer.Enable(100, 3, false);
+  auto allocations = MakeAllocations(7);
+  for (auto& allocation : allocations) {
+    tracer.RecordAlloc(allocation, nullptr, "CPUAllocator");
+  }
+  // Only the frees of the sampled allocations are traced.
+  for (auto& allocation : allocations) {
+    tracer.RecordFree(allocation);
+  }
+  auto events = tracer.Events();
+  ASSERT_EQ(events.size(), 6UL);
+  EXPECT_EQ(events[0].ptr, allocations[0].ptr());
+  EXPECT_EQ(events[1].ptr, allocations[3].ptr());
+  EXPECT_EQ(events[2].ptr, allocations[6].ptr());
+  EXPECT_EQ(events[3].type, AllocationTraceEventType::kFree);
+  EXPECT_TRUE(tracer.LiveAllocations().empty());
+
+  // Nothing is traced once disabled, but the events are kept.
+  tracer.Disable();
+  tracer.RecordAlloc(allocations[0], nullptr, "CPUAllocator");
+  EXPECT_EQ(tracer.Events().size(), 6UL);
+}
+
+TEST(AllocationTracer, op_guard_and_stack) {
+  auto& tracer = AllocationTracer::Instance();
+  tracer.Enable(10, 1, true);
+  tracer.SetStackCollector([]() -> std::string { return "stack of test"; });
+  auto allocations = MakeAllocations(2);
+  EXPECT_EQ(AllocationTraceOpGuard::CurrentOp(), nullptr);
+  {
+    std::string matmul("matmul");
+    AllocationTraceOpGuard matmul_guard(matmul);
+    tracer.RecordAlloc(allocations[0], nullptr, "CPUAllocator");
+    {
+      std::string add("add");
+      AllocationTraceOpGuard add_guard(add);
+      tracer.RecordAlloc(allocations[1], nullptr, "CPUAllocator");
+    }
+    EXPECT_EQ(*AllocationTraceOpGuard::CurrentOp(), "matmul");
+  }
+  EXPECT_EQ(AllocationTraceOpGuard::CurrentOp(), nullptr);
+
+  auto events = tracer.Events();
+  ASSERT_EQ(events.size(), 2UL);
+  EXPECT_EQ(events[0].op_name, "matmul");
+  EXPECT_EQ(events[1].op_name, "add");
+  EXPECT_EQ(events[1].stack, "stack of test");
+  tracer.SetStackCollector(nullptr);
+  tracer.Disable();
+}
+
+}  // namespace memory
+}  // namespace paddle
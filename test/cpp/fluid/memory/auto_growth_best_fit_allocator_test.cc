@@ -15,12 +15,14 @@
 #include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator.h"
 
 #include <cstdlib>
+#include <thread>
 
 #include "gtest/gtest.h"
 #include "paddle/phi/core/memory/allocation/aligned_allocator.h"
 
 PD_DECLARE_bool(free_idle_chunk);
 PD_DECLARE_bool(free_when_no_cache_hit);
+PD_DECLARE_uint64(auto_growth_thread_cache_max_block_size);
 
 namespace paddle {
 namespace memory {
@@ -171,6 +173,88 @@ TEST(test_auto_growth_allocator, test_free_when_no_cache_hit) {
   TestFreeWhenNoCacheHit(true);
 }
 
+TEST(test_auto_growth_allocator, test_thread_cache) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  FLAGS_auto_growth_thread_cache_max_block_size = 1 << 20;
+  auto recorded_allocator = std::make_shared<RecordedAllocator>();
+
+  size_t alignment = 256;
+  size_t chunk_size = 1 << 22;
+  auto underlying_allocator =
+      std::make_shared<AlignedAllocator>(recorded_allocator, alignment);
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      underlying_allocator, alignment, chunk_size);
+
+  // 1000 bytes are rounded up to the size class of 1024 bytes, so that the
+  // cached block is reused by all requests of the class.
+  void *ptr = nullptr;
+  {
+    auto allocation = ag_allocator->Allocate(1000);
+    ASSERT_EQ(allocation->size(), 1024UL);
+    ptr = allocation->ptr();
+  }
+  for (size_t size : {800, 900, 1024}) {
+    auto allocation = ag_allocator->Allocate(size);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), chunk_size + alignment);
+
+  // Blocks cached by other threads are flushed back on Release.
+  std::thread worker([&]() {
+    auto allocation = ag_allocator->Allocate(4096);
+    ASSERT_NE(allocation->ptr(), ptr);
+  });
+  worker.join();
+  ASSERT_EQ(ag_allocator->Release(phi::CPUPlace()), chunk_size);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 0UL);
+
+  FLAGS_auto_growth_thread_cache_max_block_size = 0;
+}
+
+class ThreadCacheInspectedAllocator : public AutoGrowthBestFitAllocator {
+ public:
+  using AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator;
+
+  size_t NumThreadCaches() {
+    std::lock_guard<SpinLock> guard(spinlock_);
+    return thread_caches_.size();
+  }
+};
+
+TEST(test_auto_growth_allocator, test_thread_cache_of_exited_threads) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  FLAGS_auto_growth_thread_cache_max_block_size = 1 << 20;
+  auto recorded_allocator = std::make_shared<RecordedAllocator>();
+
+  size_t alignment = 256;
+  size_t chunk_size = 1 << 22;
+  auto underlying_allocator =
+      std::make_shared<AlignedAllocator>(recorded_allocator, alignment);
+  auto ag_allocator = std::make_shared<ThreadCacheInspectedAllocator>(
+      underlying_allocator, alignment, chunk_size);
+
+  // Every short-lived thread caches its block. The caches of the exited
+  // threads are dropped, and their blocks freed, when the next thread
+  // registers its cache.
+  for (int i = 0; i < 16; ++i) {
+    std::thread worker([&]() {
+      auto allocation = ag_allocator->Allocate(4096);
+      ASSERT_NE(allocation->ptr(), nullptr);
+    });
+    worker.join();
+    ASSERT_LE(ag_allocator->NumThreadCaches(), 1UL);
+  }
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), chunk_size + alignment);
+
+  ASSERT_EQ(ag_allocator->Release(phi::CPUPlace()), chunk_size);
+  ASSERT_EQ(ag_allocator->NumThreadCaches(), 0UL);
+  ASSERT_EQ(recorded_allocator->AllocatedSize(), 0UL);
+
+  FLAGS_auto_growth_thread_cache_max_block_size = 0;
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
@@ -0,0 +1,68 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/memory/allocation/cuda_ipc_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(CudaIpcArena, FreeAfterReceiversRelease) {
+  CudaIpcArena arena(0, 1 << 20);
+  auto block = arena.Allocate(1000);
+  ASSERT_NE(block, nullptr);
+  EXPECT_TRUE(arena.Contains(block.get()));
+  void *ptr = block->ptr();
+
+  // Sent to two receivers.
+  auto slot_and_offset = arena.Export(block);
+  EXPECT_EQ(arena.Export(block), slot_and_offset);
+  EXPECT_EQ(arena.NumExported(), 1UL);
+
+  // The block is kept alive after the sender drops it.
+  block.reset();
+  EXPECT_EQ(arena.Collect(), 0UL);
+  auto other = arena.Allocate(1000);
+  ASSERT_NE(other, nullptr);
+  EXPECT_NE(other->ptr(), ptr);
+  other.reset();
+
+  // The receivers map the control segment by its name.
+  auto control = GetIpcArenaControl(arena.control_name());
+  EXPECT_EQ(control, GetIpcArenaControl(arena.control_name()));
+  control->refcount(slot_and_offset.first).fetch_sub(1);
+  EXPECT_EQ(arena.Collect(), 0UL);
+  control->refcount(slot_and_offset.first).fetch_sub(1);
+  EXPECT_EQ(arena.Collect(), 1UL);
+  EXPECT_EQ(arena.NumExported(), 0UL);
+
+  // The freed block is reused.
+  block = arena.Allocate(1000);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(block->ptr(), ptr);
+}
+
+TEST(CudaIpcArena, ReturnNullWhenFull) {
+  CudaIpcArena arena(0, 1 << 20);
+  EXPECT_EQ(arena.Allocate(2 << 20), nullptr);
+  auto block = arena.Allocate(1 << 20);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(arena.Allocate(256), nullptr);
+  EXPECT_FALSE(arena.Contains(nullptr));
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -156,6 +156,31 @@ TEST(CUDAMallocAsyncInterfaceTest, GetStreamInterfaceTest) {
   CheckMemLeak(place);
 }
 
+static uint64_t PoolReservedSize(const phi::GPUPlace &place) {
+  cudaMemPool_t mempool;
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cudaDeviceGetDefaultMemPool(&mempool, place.GetDeviceId()));
+  uint64_t reserved = 0;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolGetAttribute(
+      mempool, cudaMemPoolAttrReservedMemCurrent, &reserved));
+  return reserved;
+}
+
+TEST(CUDAMallocAsyncInterfaceTest, ReleaseTrimsPool) {
+  phi::GPUPlace place = phi::GPUPlace();
+  size_t alloc_size = 64 << 20;
+
+  // The release threshold of the test keeps the freed memory in the pool.
+  std::shared_ptr<Allocation> allocation = AllocShared(place, alloc_size);
+  allocation.reset();
+  platform::GpuDeviceSync();
+  EXPECT_GE(PoolReservedSize(place), alloc_size);
+
+  EXPECT_GE(Release(place), alloc_size);
+  EXPECT_LT(PoolReservedSize(place), alloc_size);
+  CheckMemLeak(place);
+}
+
 TEST(CUDAMallocAsyncRetryTest, RetryTest) {
   phi::GPUPlace place = phi::GPUPlace();
   gpuStream_t stream1, stream2;
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/expandable_segment_allocator.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr size_t kPageSize = 4096;
+constexpr size_t kNumPages = 16;
+
+// Backs the segment by a host buffer and records the mapped pages.
+class HostExpandableSegmentAllocator : public ExpandableSegmentAllocator {
+ public:
+  HostExpandableSegmentAllocator(size_t retained_size, bool allow_free_tail)
+      : ExpandableSegmentAllocator(
+            phi::CPUPlace(), 256, retained_size, allow_free_tail),
+        buffer_(kPageSize * kNumPages) {
+    InitSegment(buffer_.data(), buffer_.size(), kPageSize);
+  }
+
+  size_t num_mapped_pages() const { return num_mapped_pages_; }
+
+ protected:
+  void MapPages(size_t offset, size_t size) override {
+    EXPECT_EQ(offset, num_mapped_pages_ * kPageSize);
+    EXPECT_EQ(size % kPageSize, 0UL);
+    num_mapped_pages_ += size / kPageSize;
+  }
+
+  void UnmapPages(size_t offset, size_t size) override {
+    EXPECT_EQ(offset + size, num_mapped_pages_ * kPageSize);
+    EXPECT_EQ(size % kPageSize, 0UL);
+    num_mapped_pages_ -= size / kPageSize;
+  }
+
+ private:
+  std::vector<uint8_t> buffer_;
+  size_t num_mapped_pages_{0};
+};
+
+TEST(ExpandableSegmentAllocator, merge_and_reuse_tail) {
+  HostExpandableSegmentAllocator allocator(0, true);
+  auto a = allocator.Allocate(1000);
+  auto b = allocator.Allocate(kPageSize);
+  EXPECT_EQ(a->size(), 1024UL);
+  EXPECT_EQ(static_cast<uint8_t *>(b->ptr()),
+            static_cast<uint8_t *>(a->ptr()) + a->size());
+  EXPECT_EQ(allocator.num_mapped_pages(), 2UL);
+  EXPECT_EQ(allocator.mapped_size() - allocator.allocated_size(),
+            2 * kPageSize - 1024 - kPageSize);
+
+  // The free tail is extended by the pages it lacks only.
+  auto c = allocator.Allocate(4 * kPageSize);
+  EXPECT_EQ(static_cast<uint8_t *>(c->ptr()),
+            static_cast<uint8_t *>(b->ptr()) + b->size());
+  EXPECT_EQ(allocator.num_mapped_pages(), 6UL);
+
+  // The free neighbours merge into one block.
+  void *a_ptr = a->ptr();
+  a.reset();
+  b.reset();
+  EXPECT_EQ(allocator.largest_free_block(), 1024 + kPageSize);
+  auto d = allocator.Allocate(kPageSize + 1024);
+  EXPECT_EQ(d->ptr(), a_ptr);
+  EXPECT_EQ(allocator.largest_free_block(), kPageSize - 1024);
+}
+
+TEST(ExpandableSegmentAllocator, release_free_tail) {
+  HostExpandableSegmentAllocator allocator(kPageSize, true);
+  auto a = allocator.Allocate(kPageSize);
+  auto b = allocator.Allocate(4 * kPageSize);
+  EXPECT_EQ(allocator.num_mapped_pages(), 5UL);
+  // The retained page of the free tail is kept mapped on free.
+  b.reset();
+  EXPECT_EQ(allocator.num_mapped_pages(), 2UL);
+  EXPECT_EQ(allocator.Release(phi::CPUPlace()), kPageSize);
+  EXPECT_EQ(allocator.num_mapped_pages(), 1UL);
+  a.reset();
+  EXPECT_EQ(allocator.num_mapped_pages(), 1UL);
+  allocator.Release(phi::CPUPlace());
+  EXPECT_EQ(allocator.num_mapped_pages(), 0UL);
+  EXPECT_EQ(allocator.mapped_size(), 0UL);
+  EXPECT_EQ(allocator.largest_free_block(), 0UL);
+}
+
+TEST(ExpandableSegmentAllocator, keep_free_tail) {
+  HostExpandableSegmentAllocator allocator(0, false);
+  allocator.Allocate(3 * kPageSize).reset();
+  EXPECT_EQ(allocator.num_mapped_pages(), 3UL);
+  EXPECT_EQ(allocator.Release(phi::CPUPlace()), 0UL);
+  EXPECT_EQ(allocator.num_mapped_pages(), 3UL);
+}
+
+TEST(ExpandableSegmentAllocator, out_of_segment) {
+  HostExpandableSegmentAllocator allocator(0, true);
+  auto a = allocator.Allocate((kNumPages - 1) * kPageSize);
+  EXPECT_THROW(allocator.Allocate(2 * kPageSize), BadAlloc);
+  EXPECT_EQ(allocator.num_mapped_pages(), kNumPages - 1);
+  auto b = allocator.Allocate(kPageSize);
+  EXPECT_EQ(allocator.num_mapped_pages(), kNumPages);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
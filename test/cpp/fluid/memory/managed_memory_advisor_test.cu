@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/managed_memory_advisor.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/memory/malloc.h"
+#include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+
+COMMON_DECLARE_uint64(managed_memory_prefetch_limit_mb);
+
+namespace paddle {
+namespace memory {
+
+static phi::DenseTensor MakeCPUTensor(const std::vector<float>& data) {
+  phi::CPUPlace place;
+  size_t size = data.size() * sizeof(float);
+  phi::DenseTensor tensor(
+      AllocShared(place, size),
+      phi::DenseTensorMeta(
+          phi::DataType::FLOAT32,
+          common::make_ddim({static_cast<int64_t>(data.size())})));
+  std::copy(data.begin(), data.end(), tensor.data<float>());
+  return tensor;
+}
+
+static std::vector<float> Fetch(const phi::DenseTensor& tensor) {
+  std::vector<float> data(tensor.numel());
+  platform::GpuMemcpySync(data.data(),
+                          tensor.data(),
+                          data.size() * sizeof(float),
+                          cudaMemcpyDeviceToHost);
+  return data;
+}
+
+TEST(ManagedMemoryAdvisor, PlaceAndPrefetch) {
+  if (!platform::IsGPUManagedMemorySupported(0)) {
+    return;
+  }
+  std::vector<float> data(1 << 16);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  size_t size = data.size() * sizeof(float);
+  auto& advisor = ManagedMemoryAdvisor::Instance();
+  {
+    auto tensor = MakeCPUTensor(data);
+    advisor.Place(&tensor, 0, /* read_mostly = */ true);
+    EXPECT_TRUE(advisor.enabled());
+    EXPECT_TRUE(ManagedMemoryAdvisor::IsManaged(tensor.Holder().get()));
+    EXPECT_TRUE(phi::is_gpu_place(tensor.place()));
+    EXPECT_EQ(DeviceMemoryStatCurrentValue("Managed", 0),
+              static_cast<int64_t>(size));
+    EXPECT_EQ(Fetch(tensor), data);
+
+    int64_t prefetched = DeviceMemoryStatCurrentValue("Prefetched", 0);
+    EXPECT_TRUE(advisor.Prefetch(tensor.Holder().get(), nullptr));
+    EXPECT_EQ(DeviceMemoryStatCurrentValue("Prefetched", 0),
+              prefetched + static_cast<int64_t>(size));
+    platform::GpuDeviceSync();
+    EXPECT_EQ(Fetch(tensor), data);
+  }
+  EXPECT_FALSE(advisor.enabled());
+  EXPECT_EQ(DeviceMemoryStatCurrentValue("Managed", 0), 0);
+}
+
+TEST(ManagedMemoryAdvisor, LargeTensorNotPrefetched) {
+  if (!platform::IsGPUManagedMemorySupported(0)) {
+    return;
+  }
+  uint64_t limit_mb = FLAGS_managed_memory_prefetch_limit_mb;
+  FLAGS_managed_memory_prefetch_limit_mb = 0;
+  std::vector<float> data(1 << 10, 1.0f);
+  auto tensor = MakeCPUTensor(data);
+  auto& advisor = ManagedMemoryAdvisor::Instance();
+  advisor.Place(&tensor, 0, /* read_mostly = */ false);
+  FLAGS_managed_memory_prefetch_limit_mb = limit_mb;
+
+  // Preferred on the host, and read by the device remotely.
+  EXPECT_FALSE(advisor.Prefetch(tensor.Holder().get(), nullptr));
+  EXPECT_EQ(Fetch(tensor), data);
+
+  auto device_buffer = AllocShared(phi::GPUPlace(0), 256);
+  EXPECT_FALSE(ManagedMemoryAdvisor::IsManaged(device_buffer.get()));
+  EXPECT_FALSE(advisor.Prefetch(device_buffer.get(), nullptr));
+}
+
+}  // namespace memory
+}  // namespace paddle
@@ -16,6 +16,11 @@
 
 #include "paddle/phi/core/memory/allocation/mmap_allocator.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
 #include "gtest/gtest.h"
 
 namespace paddle {
@@ -46,6 +51,50 @@ TEST(MemoryMapAllocation, test_allocation_base) {
   }
 }
 
+TEST(MemoryMapFileAllocation, test_file_slice) {
+  std::string file_name = "./mmap_allocator_test_file";
+  {
+    std::ofstream fout(file_name, std::ios::out | std::ios::binary);
+    for (int32_t i = 0; i < 1024; ++i) {
+      fout.write(reinterpret_cast<const char*>(&i), sizeof(i));
+    }
+  }
+
+  std::shared_ptr<Allocation> slice;
+  {
+    auto file = AllocateMemoryMapFileAllocation(file_name);
+    ASSERT_EQ(file->size(), 1024 * sizeof(int32_t));
+    slice = std::make_shared<MemoryMapSliceAllocation>(
+        file, 16 * sizeof(int32_t), 8 * sizeof(int32_t));
+  }
+  // the slice keeps the mapping alive
+  auto* data = static_cast<int32_t*>(slice->ptr());
+  for (int32_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(data[i], 16 + i);
+  }
+  // private mapping, the file is not changed
+  data[0] = -1;
+  slice.reset();
+  auto file = AllocateMemoryMapFileAllocation(file_name);
+  ASSERT_EQ(static_cast<int32_t*>(file->ptr())[16], 16);
+  std::remove(file_name.c_str());
+}
+
+TEST(MemoryMapAllocationPool, test_cache_size) {
+  ASSERT_EQ(GetMemoryMapCacheSize(0), 4096UL);
+  ASSERT_EQ(GetMemoryMapCacheSize(4096), 4096UL);
+  ASSERT_EQ(GetMemoryMapCacheSize(4097), 8192UL);
+  ASSERT_EQ(GetMemoryMapCacheSize(1000000), 1048576UL);
+  ASSERT_EQ(GetMemoryMapCacheSize(1048577), 1310720UL);
+  for (size_t size = 1; size < (1UL << 30); size = size * 3 + 1) {
+    size_t cache_size = GetMemoryMapCacheSize(size);
+    ASSERT_GE(cache_size, size);
+    ASSERT_LE(cache_size, std::max<size_t>(4096, size + size / 4));
+    // the sizes of a class share the cached shm
+    ASSERT_EQ(GetMemoryMapCacheSize(cache_size), cache_size);
+  }
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
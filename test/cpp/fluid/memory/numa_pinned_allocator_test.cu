@@ -0,0 +1,78 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/numa_pinned_allocator.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The flags of get_mempolicy to query the node of the page at an address.
+constexpr int kMPolFNode = 1;
+constexpr int kMPolFAddr = 2;
+
+static void TestCopy(size_t huge_page_size) {
+  platform::SetDeviceId(0);
+  NUMAPinnedAllocator allocator(1 << 20, huge_page_size, true);
+  const size_t num = 1 << 18;
+  auto host = allocator.Allocate(num * sizeof(float));
+  float* data = static_cast<float*>(host->ptr());
+  for (size_t i = 0; i < num; ++i) {
+    data[i] = static_cast<float>(i);
+  }
+
+  int node = NUMAPinnedAllocator::GetGPUNumaNode(0);
+  if (node >= 0) {
+    int page_node = -1;
+    ASSERT_EQ(syscall(SYS_get_mempolicy,
+                      &page_node,
+                      nullptr,
+                      0,
+                      data,
+                      kMPolFNode | kMPolFAddr),
+              0);
+    EXPECT_EQ(page_node, node);
+  }
+
+  float* device = nullptr;
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMalloc(&device, num * sizeof(float)));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpy(
+      device, data, num * sizeof(float), cudaMemcpyHostToDevice));
+  std::vector<float> result(num);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpy(
+      result.data(), device, num * sizeof(float), cudaMemcpyDeviceToHost));
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(result[i], static_cast<float>(i));
+  }
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(device));
+
+  host.reset();
+  EXPECT_GT(allocator.Release(phi::GPUPinnedPlace()), 0UL);
+}
+
+TEST(NUMAPinnedAllocator, normal_pages) { TestCopy(0); }
+
+TEST(NUMAPinnedAllocator, huge_pages) { TestCopy(2 << 20); }
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
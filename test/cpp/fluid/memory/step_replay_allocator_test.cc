@@ -0,0 +1,175 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/step_replay_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class StubAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t GetAllocCount() const { return alloc_count_; }
+
+  size_t GetFreeCount() const { return free_count_; }
+
+  size_t GetAllocBytes() const { return alloc_bytes_; }
+
+  // The allocations beyond max_alive fail, like a device out of memory.
+  void SetMaxAlive(size_t max_alive) { max_alive_ = max_alive; }
+
+ protected:
+  void FreeImpl(phi::Allocation *allocation) override {
+    delete[] static_cast<uint8_t *>(allocation->ptr());
+    ++free_count_;
+    delete allocation;
+  }
+
+  phi::Allocation *AllocateImpl(size_t size) override {
+    if (alloc_count_ - free_count_ >= max_alive_) {
+      throw BadAlloc("Out of the stub memory", __FILE__, __LINE__);
+    }
+    ++alloc_count_;
+    alloc_bytes_ += size;
+    // The underlying allocation is larger than requested, like a block of
+    // the auto growth allocator.
+    return new Allocation(new uint8_t[size + 64], size + 64, phi::CPUPlace());
+  }
+
+ private:
+  size_t alloc_count_ = 0;
+  size_t free_count_ = 0;
+  size_t alloc_bytes_ = 0;
+  size_t max_alive_ = std::numeric_limits<size_t>::max();
+};
+
+// Allocates the sizes of one step, and frees them at its end.
+static void RunStep(Allocator *allocator, const std::vector<size_t> &sizes) {
+  std::vector<AllocationPtr> allocations;
+  for (size_t size : sizes) {
+    allocations.emplace_back(allocator->Allocate(size));
+    EXPECT_GE(allocations.back()->size(), size);
+  }
+  allocations.clear();
+  StepReplayAllocator::MarkStep();
+}
+
+TEST(StepReplayAllocator, ReplayAfterWarmup) {
+  auto stub_allocator = std::make_shared<StubAllocator>();
+  StepReplayAllocator allocator(stub_allocator);
+  const std::vector<size_t> sizes = {256, 1024, 256, 4096, 256};
+
+  StepReplayAllocator::SetEnabled(true, 2);
+  RunStep(&allocator, sizes);
+  RunStep(&allocator, sizes);
+  EXPECT_EQ(stub_allocator->GetAllocCount(), 2 * sizes.size());
+
+  // The first allocation after the warmup prebuilds the buffers.
+  RunStep(&allocator, sizes);
+  size_t alloc_count = stub_allocator->GetAllocCount();
+  EXPECT_EQ(alloc_count, 2 * sizes.size() + sizes.size());
+  for (int i = 0; i < 10; ++i) {
+    RunStep(&allocator, sizes);
+  }
+  EXPECT_EQ(stub_allocator->GetAllocCount(), alloc_count);
+  EXPECT_EQ(stub_allocator->GetFreeCount(), 2 * sizes.size());
+
+  // The sizes not seen by the warmup go to the underlying allocator.
+  RunStep(&allocator, {512});
+  EXPECT_EQ(stub_allocator->GetAllocCount(), alloc_count + 1);
+
+  allocator.Release(phi::CPUPlace());
+  EXPECT_EQ(stub_allocator->GetFreeCount(), alloc_count + 1);
+  StepReplayAllocator::SetEnabled(false, 2);
+}
+
+TEST(StepReplayAllocator, Disable) {
+  auto stub_allocator = std::make_shared<StubAllocator>();
+  StepReplayAllocator allocator(stub_allocator);
+  const std::vector<size_t> sizes = {128, 128, 2048};
+
+  StepReplayAllocator::SetEnabled(true, 1);
+  RunStep(&allocator, sizes);
+  RunStep(&allocator, sizes);
+  auto alive = allocator.Allocate(2048);
+
+  // Disabling it drops the cached buffers, and the allocation alive is
+  // freed to the underlying allocator.
+  StepReplayAllocator::SetEnabled(false, 1);
+  EXPECT_FALSE(StepReplayAllocator::IsEnabled());
+  RunStep(&allocator, sizes);
+  alive.reset();
+  EXPECT_EQ(stub_allocator->GetAllocCount(),
+            stub_allocator->GetFreeCount());
+}
+
+TEST(StepReplayAllocator, PrebuildBoundedByPeakBytes) {
+  auto stub_allocator = std::make_shared<StubAllocator>();
+  StepReplayAllocator allocator(stub_allocator);
+
+  StepReplayAllocator::SetEnabled(true, 1);
+  // The peaks of the two sizes are not at the same time, at most 2048 bytes
+  // are alive.
+  {
+    auto first = allocator.Allocate(1024);
+    auto second = allocator.Allocate(1024);
+  }
+  { auto third = allocator.Allocate(2048); }
+  StepReplayAllocator::MarkStep();
+
+  size_t alloc_bytes = stub_allocator->GetAllocBytes();
+  // An unseen size prebuilds the buffers first.
+  { auto unseen = allocator.Allocate(512); }
+  EXPECT_LE(stub_allocator->GetAllocBytes() - alloc_bytes, 2048 + 512);
+  EXPECT_GT(stub_allocator->GetAllocBytes() - alloc_bytes, 512);
+  StepReplayAllocator::SetEnabled(false, 1);
+}
+
+TEST(StepReplayAllocator, DrainOnMemoryPressure) {
+  auto stub_allocator = std::make_shared<StubAllocator>();
+  StepReplayAllocator allocator(stub_allocator);
+  const std::vector<size_t> sizes = {256, 256};
+
+  StepReplayAllocator::SetEnabled(true, 1);
+  RunStep(&allocator, sizes);
+  RunStep(&allocator, sizes);
+  // The two cached buffers are all of the memory.
+  EXPECT_EQ(stub_allocator->GetAllocCount() - stub_allocator->GetFreeCount(),
+            2UL);
+  stub_allocator->SetMaxAlive(2);
+
+  // The cached buffers are given back instead of failing.
+  auto allocation = allocator.Allocate(4096);
+  EXPECT_GE(allocation->size(), 4096UL);
+  EXPECT_EQ(stub_allocator->GetAllocCount() - stub_allocator->GetFreeCount(),
+            1UL);
+  allocation.reset();
+
+  // Nothing is left to drain.
+  auto first = allocator.Allocate(8192);
+  auto second = allocator.Allocate(8192);
+  EXPECT_THROW(allocator.Allocate(8192), BadAlloc);
+  StepReplayAllocator::SetEnabled(false, 1);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
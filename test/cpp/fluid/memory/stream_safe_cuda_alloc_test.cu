@@ -18,6 +18,7 @@
 #include "gtest/gtest.h"
 #include "paddle/phi/core/memory/allocation/allocator_facade.h"
 #include "paddle/phi/core/memory/memory.h"
+#include "paddle/phi/core/memory/stats.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/platform/device_context.h"
 #include "paddle/phi/core/stream.h"
@@ -192,6 +193,45 @@ TEST(StreamSafeCUDAAllocInterfaceTest, GetStreamInterfaceTest) {
   CheckMemLeak(place);
 }
 
+TEST(StreamSafeCUDAAllocInterfaceTest, DeferredFreeTest) {
+  RETURN_IF_NOT_ENABLED;
+
+  phi::GPUPlace place = phi::GPUPlace();
+  size_t alloc_size = 256;
+  int dev_id = place.GetDeviceId();
+
+  gpuStream_t other_stream;
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamCreate(&other_stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamCreate(&other_stream));
+#endif
+
+  int64_t num_polls = DeviceMemoryStatCurrentValue("EventPoll", dev_id);
+  std::shared_ptr<Allocation> allocation = AllocShared(place, alloc_size);
+  RecordStream(allocation, other_stream);
+  allocation.reset();
+  EXPECT_GT(DeviceMemoryStatCurrentValue("EventPoll", dev_id), num_polls);
+
+  // The deferred allocation is freed by the next allocation once the other
+  // stream completes.
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(other_stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamSynchronize(other_stream));
+#endif
+  AllocShared(place, alloc_size).reset();
+  EXPECT_EQ(DeviceMemoryStatCurrentValue("DeferredFree", dev_id), 0);
+
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamDestroy(other_stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamDestroy(other_stream));
+#endif
+  Release(place);
+  CheckMemLeak(place);
+}
+
 TEST(StreamSafeCUDAAllocRetryTest, RetryTest) {
   RETURN_IF_NOT_ENABLED;
 
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/tensor_evictor.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/memory/malloc.h"
+#include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/platform/device/gpu/gpu_info.h"
+
+namespace paddle {
+namespace memory {
+
+static std::shared_ptr<phi::DenseTensor> MakeTensor(
+    const std::vector<float>& data) {
+  phi::GPUPlace place(0);
+  size_t size = data.size() * sizeof(float);
+  auto tensor = std::make_shared<phi::DenseTensor>(
+      AllocShared(place, size),
+      phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                           common::make_ddim({static_cast<int64_t>(
+                               data.size())})));
+  platform::GpuMemcpySync(
+      tensor->data(), data.data(), size, cudaMemcpyHostToDevice);
+  return tensor;
+}
+
+static std::vector<float> Fetch(const phi::DenseTensor& tensor) {
+  std::vector<float> data(tensor.numel());
+  platform::GpuMemcpySync(data.data(),
+                          tensor.data(),
+                          data.size() * sizeof(float),
+                          cudaMemcpyDeviceToHost);
+  return data;
+}
+
+TEST(TensorEvictor, EvictAndPageIn) {
+  std::vector<float> data(1 << 16);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  auto tensor = MakeTensor(data);
+  auto& evictor = TensorEvictor::Instance();
+  evictor.Register(tensor);
+  EXPECT_TRUE(evictor.enabled());
+
+  EXPECT_EQ(evictor.Evict(phi::GPUPlace(0), 1), data.size() * sizeof(float));
+  EXPECT_TRUE(evictor.IsEvicted(tensor.get()));
+  EXPECT_TRUE(phi::is_gpu_place(tensor->place()));
+  EXPECT_EQ(DeviceMemoryStatCurrentValue("Evicted", 0),
+            static_cast<int64_t>(data.size() * sizeof(float)));
+  // The evicted tensor is still readable by the device.
+  EXPECT_EQ(Fetch(*tensor), data);
+
+  evictor.Touch(tensor.get());
+  EXPECT_FALSE(evictor.IsEvicted(tensor.get()));
+  EXPECT_EQ(DeviceMemoryStatCurrentValue("Evicted", 0), 0);
+  EXPECT_EQ(Fetch(*tensor), data);
+}
+
+TEST(TensorEvictor, LeastRecentlyUsedFirst) {
+  std::vector<float> data(1 << 10, 1.0f);
+  auto first = MakeTensor(data);
+  auto second = MakeTensor(data);
+  auto& evictor = TensorEvictor::Instance();
+  evictor.Register(first);
+  evictor.Register(second);
+  evictor.Touch(first.get());
+
+  evictor.Evict(phi::GPUPlace(0), 1);
+  EXPECT_TRUE(evictor.IsEvicted(second.get()));
+  EXPECT_FALSE(evictor.IsEvicted(first.get()));
+  evictor.Touch(second.get());
+}
+
+TEST(TensorEvictor, SharedHolderNotEvicted) {
+  std::vector<float> data(1 << 10, 1.0f);
+  auto tensor = MakeTensor(data);
+  phi::DenseTensor shared;
+  shared.ShareDataWith(*tensor);
+  auto& evictor = TensorEvictor::Instance();
+  evictor.Register(tensor);
+
+  EXPECT_EQ(evictor.Evict(phi::GPUPlace(0), 1), 0UL);
+  EXPECT_FALSE(evictor.IsEvicted(tensor.get()));
+}
+
+TEST(TensorEvictor, PinnedInputNotEvicted) {
+  std::vector<float> data(1 << 10, 1.0f);
+  auto input = MakeTensor(data);
+  auto& evictor = TensorEvictor::Instance();
+  evictor.Register(input);
+  {
+    // The inputs of a running kernel are touched in its PinScope.
+    TensorEvictor::PinScope pin_scope;
+    evictor.Touch(input.get());
+    {
+      TensorEvictor::PinScope nested_scope;
+    }
+    EXPECT_EQ(evictor.Evict(phi::GPUPlace(0), 1), 0UL);
+    EXPECT_FALSE(evictor.IsEvicted(input.get()));
+  }
+  EXPECT_EQ(evictor.Evict(phi::GPUPlace(0), 1), data.size() * sizeof(float));
+  EXPECT_TRUE(evictor.IsEvicted(input.get()));
+  evictor.Touch(input.get());
+}
+
+}  // namespace memory
+}  // namespace paddle
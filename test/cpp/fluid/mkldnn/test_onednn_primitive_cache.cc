@@ -0,0 +1,70 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
+#include "paddle/phi/backends/onednn/onednn_primitive_cache.h"
+
+COMMON_DECLARE_int32(onednn_primitive_cache_capacity);
+
+namespace phi {
+
+TEST(OneDNNPrimitiveCache, evict_least_recently_used) {
+  FLAGS_onednn_primitive_cache_capacity = 2;
+  auto& cache = OneDNNPrimitiveCache::Instance();
+  cache.Clear();
+  ASSERT_TRUE(OneDNNPrimitiveCache::Enabled());
+
+  cache.Set("a", std::make_shared<int>(1));
+  cache.Set("b", std::make_shared<int>(2));
+  // a is used after b, so b is evicted by c
+  ASSERT_NE(cache.Get("a"), nullptr);
+  cache.Set("c", std::make_shared<int>(3));
+
+  EXPECT_EQ(cache.Size(), 2UL);
+  EXPECT_EQ(*std::static_pointer_cast<int>(cache.Get("a")), 1);
+  EXPECT_EQ(cache.Get("b"), nullptr);
+  EXPECT_EQ(*std::static_pointer_cast<int>(cache.Get("c")), 3);
+  EXPECT_GE(cache.Evictions(), 1);
+
+  cache.Clear();
+  FLAGS_onednn_primitive_cache_capacity = 0;
+  EXPECT_FALSE(OneDNNPrimitiveCache::Enabled());
+}
+
+TEST(OneDNNPrimitiveCache, share_across_threads_of_a_scope) {
+  auto& tls = OneDNNContext::tls();
+  tls.set_primitive_cache_scope("P0");
+  std::string key = OneDNNPrimitiveCache::CanonicalKey("conv2d_0.tmp_0");
+
+  std::string other_thread_key;
+  std::thread thread([&other_thread_key] {
+    OneDNNContext::tls().set_primitive_cache_scope("P0");
+    other_thread_key = OneDNNPrimitiveCache::CanonicalKey("conv2d_0.tmp_0");
+  });
+  thread.join();
+  EXPECT_EQ(key, other_thread_key);
+
+  // the same names of another model are not shared
+  tls.set_primitive_cache_scope("P1");
+  EXPECT_NE(key, OneDNNPrimitiveCache::CanonicalKey("conv2d_0.tmp_0"));
+  tls.set_primitive_cache_scope("");
+}
+
+}  // namespace phi
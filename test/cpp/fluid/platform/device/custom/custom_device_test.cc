@@ -71,6 +71,9 @@ void TestDeviceInterface(const phi::Place& place) {
     phi::DeviceManager::SetDevice(place);
     auto dev_id = phi::DeviceManager::GetDevice(dev_type);
     EXPECT_EQ(dev_id, place.GetDeviceId());
+
+    EXPECT_EQ(phi::DeviceManager::GetDeviceCapability(place),
+              static_cast<size_t>(C_DEVICE_CAPABILITY_STREAM_EVENT));
   }
 }
 
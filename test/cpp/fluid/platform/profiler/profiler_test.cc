@@ -23,6 +23,7 @@
 #ifdef PADDLE_WITH_HIP
 #include <hip/hip_runtime.h>
 #endif
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
 #include "paddle/phi/common/place.h"
@@ -141,3 +142,45 @@ TEST(ProfilerTest, TestHostTracerForMem) {
   auto profiler_result = profiler->Stop();
   auto nodetree = profiler_result->GetNodeTrees();
 }
+
+TEST(ProfilerTest, TestContinuousProfiler) {
+  using paddle::platform::ContinuousProfiler;
+  using paddle::platform::ContinuousProfilerOptions;
+  using phi::RecordEvent;
+  using phi::TracerEventType;
+  ContinuousProfilerOptions options;
+  options.sample_interval = 4;
+  options.trace_level = 1;
+  options.dump_dir = "/tmp";
+  auto& profiler = ContinuousProfiler::Instance();
+  profiler.Start(options);
+  for (int step = 0; step < 8; ++step) {
+    RecordEvent op("TestContinuousProfiler_op", TracerEventType::Operator, 1);
+    op.End();
+    profiler.Step();
+  }
+  // Steps 0 and 4 are sampled, and the sample of step 8 is not ended.
+  EXPECT_EQ(profiler.num_sampled_steps(), 2);
+  auto statistics = profiler.Statistics();
+  ASSERT_EQ(statistics.count("TestContinuousProfiler_op"), 1u);
+  const auto& stats = statistics.at("TestContinuousProfiler_op");
+  EXPECT_EQ(stats.count(), 2);
+  EXPECT_GE(stats.PercentileNs(0.99), stats.MeanNs() / 2);
+  EXPECT_FALSE(profiler.Dump("test").empty());
+  profiler.Stop();
+  EXPECT_FALSE(profiler.IsStarted());
+  EXPECT_EQ(profiler.num_sampled_steps(), 3);
+}
+
+TEST(ProfilerTest, TestOpStatisticsPercentile) {
+  paddle::platform::OpStatistics stats;
+  for (uint64_t ns = 1; ns <= 1000; ++ns) {
+    stats.Add(ns * 1000);
+  }
+  EXPECT_EQ(stats.count(), 1000);
+  EXPECT_DOUBLE_EQ(stats.MeanNs(), 500500);
+  EXPECT_EQ(stats.MaxNs(), 1000000u);
+  // Within a bucket of 2^(1/4) of the exact p50 and p99.
+  EXPECT_NEAR(stats.PercentileNs(0.5), 500000, 500000 * 0.19);
+  EXPECT_NEAR(stats.PercentileNs(0.99), 990000, 990000 * 0.19);
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler/op_cost_estimator.h"
+
+using paddle::framework::AttributeMap;
+using paddle::platform::OpCost;
+using paddle::platform::OpCostContext;
+using paddle::platform::OpCostEstimatorRegistry;
+
+namespace {
+
+OpCost Estimate(const std::string& op_type,
+                const OpCostContext::InputShapes& input_shapes,
+                const AttributeMap& attributes = {},
+                const OpCostContext::InputDtypes& dtypes = {}) {
+  return OpCostEstimatorRegistry::Instance().Estimate(
+      op_type, OpCostContext(input_shapes, dtypes, attributes));
+}
+
+}  // namespace
+
+TEST(OpCostEstimatorTest, matmul) {
+  AttributeMap attributes;
+  attributes["trans_y"] = true;
+  OpCost cost = Estimate("matmul_v2",
+                         {{"X", {{4, 64, 32}}}, {"Y", {{128, 32}}}},
+                         attributes,
+                         {{"X", {"FP16"}}, {"Y", {"FP16"}}});
+  EXPECT_EQ(cost.flops, 2 * 4 * 64 * 32 * 128);
+  EXPECT_EQ(cost.bytes, (4 * 64 * 32 + 128 * 32 + 4 * 64 * 128) * 2);
+}
+
+TEST(OpCostEstimatorTest, conv2d) {
+  AttributeMap attributes;
+  attributes["strides"] = std::vector<int>{2, 2};
+  attributes["paddings"] = std::vector<int>{1, 1};
+  attributes["dilations"] = std::vector<int>{1, 1};
+  OpCost cost = Estimate(
+      "conv2d",
+      {{"Input", {{8, 16, 32, 32}}}, {"Filter", {{32, 16, 3, 3}}}},
+      attributes);
+  // The output is [8, 32, 16, 16].
+  EXPECT_EQ(cost.flops, 2 * 8 * 32 * 16 * 16 * 16 * 3 * 3);
+  EXPECT_EQ(cost.bytes,
+            (8 * 16 * 32 * 32 + 32 * 16 * 3 * 3 + 8 * 32 * 16 * 16) * 4);
+}
+
+TEST(OpCostEstimatorTest, flash_attn) {
+  AttributeMap attributes;
+  attributes["causal"] = true;
+  OpCost cost = Estimate("flash_attn",
+                         {{"q", {{2, 128, 8, 64}}},
+                          {"k", {{2, 256, 8, 64}}},
+                          {"v", {{2, 256, 8, 64}}}},
+                         attributes);
+  EXPECT_EQ(cost.flops, 2 * 2 * 8 * 128 * 256 * 128 / 2);
+  EXPECT_EQ(cost.bytes,
+            (2 * 128 * 8 * 64 * 2 + 2 * 256 * 8 * 64 * 2) * 4);
+}
+
+TEST(OpCostEstimatorTest, elementwise_and_reduce) {
+  OpCost add = Estimate("elementwise_add",
+                        {{"X", {{16, 1024}}}, {"Y", {{1024}}}});
+  EXPECT_EQ(add.flops, 16 * 1024);
+  EXPECT_EQ(add.bytes, (16 * 1024 * 2 + 1024) * 4);
+
+  AttributeMap attributes;
+  attributes["dim"] = std::vector<int>{-1};
+  OpCost mean = Estimate("reduce_mean", {{"X", {{16, 1024}}}}, attributes);
+  EXPECT_EQ(mean.flops, 16 * 1024 + 16);
+  EXPECT_EQ(mean.bytes, (16 * 1024 + 16) * 4);
+}
+
+TEST(OpCostEstimatorTest, embedding) {
+  OpCost cost =
+      Estimate("lookup_table_v2", {{"Ids", {{32, 8}}}, {"W", {{1000, 64}}}});
+  EXPECT_EQ(cost.flops, 0);
+  EXPECT_EQ(cost.bytes, 32 * 8 * 8 + 2 * 32 * 8 * 64 * 4);
+}
+
+TEST(OpCostEstimatorTest, unknown) {
+  EXPECT_FALSE(OpCostEstimatorRegistry::Instance().Has("unknown_op"));
+  OpCost cost = Estimate("unknown_op", {{"X", {{16}}}});
+  EXPECT_EQ(cost.flops, 0);
+  EXPECT_EQ(cost.bytes, 0);
+  // A dynamic dimension is not estimated.
+  cost = Estimate("elementwise_add", {{"X", {{-1, 16}}}, {"Y", {{16}}}});
+  EXPECT_EQ(cost.flops, 0);
+}
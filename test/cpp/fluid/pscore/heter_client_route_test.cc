@@ -0,0 +1,56 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/heter_client.h"
+
+namespace distributed = paddle::distributed;
+
+TEST(HeterClient, RouteMicroBatch) {
+  // the channels connect on the first call, so no server is needed
+  std::vector<std::string> endpoints{"127.0.0.1:8510", "127.0.0.1:8511"};
+  auto heter_client = distributed::HeterClient::GetInstance(endpoints, {}, 0);
+
+  // without service times the micro-batches are spread by their count
+  EXPECT_EQ(heter_client->RouteMicroBatch(0), 0);
+  EXPECT_EQ(heter_client->RouteMicroBatch(1), 1);
+  EXPECT_EQ(heter_client->RouteMicroBatch(2), 0);
+  // a micro-batch sent again before its backward is counted once
+  EXPECT_EQ(heter_client->RouteMicroBatch(2), 0);
+  EXPECT_EQ(heter_client->RouteMicroBatch(3), 1);
+  EXPECT_EQ(heter_client->RouteMicroBatch(4), 0);
+  for (int micro_id = 0; micro_id < 5; ++micro_id) {
+    heter_client->FinishMicroBatch(micro_id);
+  }
+  // an unknown or finished micro-batch is ignored
+  heter_client->FinishMicroBatch(4);
+  heter_client->FinishMicroBatch(99);
+
+  // a slow round trip makes its server expensive for the next micro-batches
+  int slow_server = heter_client->RouteMicroBatch(10);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  heter_client->FinishMicroBatch(10);
+  for (int micro_id = 11; micro_id < 15; ++micro_id) {
+    EXPECT_EQ(heter_client->RouteMicroBatch(micro_id), 1 - slow_server);
+  }
+  for (int micro_id = 11; micro_id < 15; ++micro_id) {
+    heter_client->FinishMicroBatch(micro_id);
+  }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/activation_range.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace paddle {
+namespace inference {
+
+TEST(ActivationHistogram, grow_range) {
+  ActivationHistogram histogram;
+  histogram.counts.resize(8, 0);
+  std::vector<float> zeros(4, 0.f);
+  histogram.Collect(zeros.data(), zeros.size());
+  EXPECT_EQ(histogram.abs_max, 0.f);
+  EXPECT_EQ(histogram.counts[0], 4);
+
+  std::vector<float> small{-1.f, 2.f, 3.f, -4.f};
+  histogram.Collect(small.data(), small.size());
+  EXPECT_FLOAT_EQ(histogram.bin_width, 0.5f);
+
+  // The range grows by 4 times for the larger values.
+  std::vector<float> large{16.f};
+  histogram.Collect(large.data(), large.size());
+  EXPECT_FLOAT_EQ(histogram.abs_max, 16.f);
+  EXPECT_FLOAT_EQ(histogram.bin_width, 2.f);
+  int64_t total = 0;
+  for (auto count : histogram.counts) total += count;
+  EXPECT_EQ(total, 9);
+  EXPECT_EQ(histogram.counts[7], 1);
+}
+
+TEST(ActivationHistogram, threshold) {
+  ActivationHistogram histogram;
+  histogram.counts.resize(100, 0);
+  std::vector<float> values;
+  for (int i = 1; i <= 1000; ++i) values.push_back(i * 0.01f);
+  values.push_back(100.f);
+  histogram.Collect(values.data(), values.size());
+  EXPECT_FLOAT_EQ(histogram.Threshold(100.f), 100.f);
+  // Only the outlier is clipped.
+  EXPECT_LE(histogram.Threshold(99.f), 11.f);
+}
+
+TEST(ActivationRangeCollector, serialize) {
+  std::string path = "activation_range_test.txt";
+  auto collector = ActivationRangeCollector::Get(path, 64);
+  EXPECT_EQ(ActivationRangeCollector::Get(path, 64), collector);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([=] {
+      std::vector<float> values{-0.5f * (t + 1), 0.25f};
+      for (int i = 0; i < 8; ++i) {
+        collector->Collect("x", values.data(), values.size());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  collector->Serialize();
+
+  std::map<std::string, ActivationHistogram> histograms;
+  DeserializeActivationRange(path, &histograms);
+  ASSERT_EQ(histograms.count("x"), 1UL);
+  int64_t total = 0;
+  for (auto count : histograms["x"].counts) total += count;
+  EXPECT_EQ(total, 64);
+  auto ranges = DeserializeActivationRange(path, 100.f);
+  EXPECT_FLOAT_EQ(ranges["x"], 2.f);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -112,6 +112,65 @@ void threads_run(int thread_num) {
 
 TEST(PD_Predictor, PD_multi_threads_run) { threads_run(10); }
 
+void fetch_output(PD_Predictor* predictor,
+                  PD_Bool success,
+                  void* user_data) {
+  ASSERT_TRUE(success);
+  auto* out_data = static_cast<std::vector<float>*>(user_data);
+  PD_OneDimArrayCstr* output_names = PD_PredictorGetOutputNames(predictor);
+  PD_Tensor* output_tensor =
+      PD_PredictorGetOutputHandle(predictor, output_names->data[0]);
+  PD_OneDimArrayInt32* output_shape = PD_TensorGetShape(output_tensor);
+  int32_t out_size = 1;
+  for (size_t index = 0; index < output_shape->size; ++index) {
+    out_size = out_size * output_shape->data[index];
+  }
+  PD_OneDimArrayInt32Destroy(output_shape);
+  out_data->resize(out_size);
+  PD_TensorCopyToCpuFloat(output_tensor, out_data->data());
+  PD_TensorDestroy(output_tensor);
+  PD_OneDimArrayCstrDestroy(output_names);
+}
+
+TEST(PD_Predictor, PD_run_async) {
+  auto model_dir = FLAGS_infer_model;
+  PD_Config* config = PD_ConfigCreate();
+  PD_ConfigSetModel(config,
+                    (model_dir + "/__model__").c_str(),
+                    (model_dir + "/__params__").c_str());
+  PD_Predictor* predictor = PD_PredictorCreate(config);
+
+  const int predictor_num = 4;
+  std::array<int32_t, 4> shapes = {1, 3, 224, 224};
+  std::vector<float> input(1 * 3 * 224 * 224, 0);
+  std::vector<PD_Predictor*> predictors(predictor_num);
+  std::vector<std::vector<float>> out_data(predictor_num);
+  for (int i = 0; i < predictor_num; ++i) {
+    predictors[i] = PD_PredictorClone(predictor);
+    PD_OneDimArrayCstr* input_names = PD_PredictorGetInputNames(predictors[i]);
+    PD_Tensor* tensor =
+        PD_PredictorGetInputHandle(predictors[i], input_names->data[0]);
+    PD_TensorReshape(tensor, shapes.size(), shapes.data());
+    PD_TensorCopyFromCpuFloat(tensor, input.data());
+    PD_TensorDestroy(tensor);
+    PD_OneDimArrayCstrDestroy(input_names);
+    // The clones run together without a thread of the caller for each.
+    PD_PredictorRunAsync(predictors[i], fetch_output, &out_data[i]);
+  }
+  for (int i = 0; i < predictor_num; ++i) {
+    PD_PredictorWaitAsync(predictors[i]);
+  }
+
+  ASSERT_GT(out_data[0].size(), 0UL);
+  for (int i = 1; i < predictor_num; ++i) {
+    ASSERT_EQ(out_data[i], out_data[0]);
+  }
+  for (int i = 0; i < predictor_num; ++i) {
+    PD_PredictorDestroy(predictors[i]);
+  }
+  PD_PredictorDestroy(predictor);
+}
+
 }  // namespace analysis
 }  // namespace inference
 }  // namespace paddle
@@ -134,6 +134,18 @@ TEST(Analyzer_Text_Classification, compare) {
       reinterpret_cast<const PaddlePredictor::Config *>(&cfg), input_slots_all);
 }
 
+// Compare result of NativeConfig and AnalysisConfig with the workspace
+TEST(Analyzer_Text_Classification, compare_memory_optim_workspace) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+  cfg.EnableMemoryOptimWorkspace();
+
+  std::vector<std::vector<PaddleTensor>> input_slots_all;
+  SetInput(&input_slots_all);
+  CompareNativeAndAnalysis(
+      reinterpret_cast<const PaddlePredictor::Config *>(&cfg), input_slots_all);
+}
+
 // Compare Deterministic result
 TEST(Analyzer_Text_Classification, compare_determine) {
   AnalysisConfig cfg;
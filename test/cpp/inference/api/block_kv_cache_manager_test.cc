@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/block_kv_cache_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace paddle {
+namespace inference {
+
+TEST(BlockKVCacheManager, allocate_and_free) {
+  BlockKVCacheManager manager(8, 4);
+  EXPECT_EQ(manager.AddSequence(0, {1, 2, 3, 4, 5, 6}), 0);
+  EXPECT_EQ(manager.BlockTable(0).size(), 2UL);
+  EXPECT_EQ(manager.NumFreeBlocks(), 6);
+
+  manager.AppendTokens(0, {7, 8, 9});
+  EXPECT_EQ(manager.SequenceLength(0), 9);
+  EXPECT_EQ(manager.BlockTable(0).size(), 3UL);
+
+  std::vector<int> tables(2 * 4);
+  manager.AddSequence(1, {1});
+  manager.FillBlockTables({0, 1}, 4, tables.data());
+  EXPECT_EQ(tables[3], -1);
+  EXPECT_EQ(tables[4], manager.BlockTable(1)[0]);
+  EXPECT_EQ(tables[5], -1);
+
+  manager.FreeSequence(0);
+  manager.FreeSequence(1);
+  EXPECT_EQ(manager.NumFreeBlocks(), 8);
+  EXPECT_FALSE(manager.HasSequence(0));
+}
+
+TEST(BlockKVCacheManager, prefix_sharing) {
+  BlockKVCacheManager manager(8, 4);
+  std::vector<int64_t> prompt = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  manager.AddSequence(0, prompt);
+  manager.CachePrefix(0);
+  EXPECT_EQ(manager.NumCachedBlocks(), 2);
+
+  // the two full blocks are shared, the last token is always computed
+  EXPECT_EQ(manager.AddSequence(1, prompt), 8);
+  EXPECT_EQ(manager.BlockTable(1)[0], manager.BlockTable(0)[0]);
+  EXPECT_EQ(manager.BlockTable(1)[1], manager.BlockTable(0)[1]);
+  EXPECT_NE(manager.BlockTable(1)[2], manager.BlockTable(0)[2]);
+
+  // a prompt of exactly the cached blocks keeps its last block computed
+  EXPECT_EQ(manager.AddSequence(2, {1, 2, 3, 4, 5, 6, 7, 8}), 4);
+  EXPECT_EQ(manager.AddSequence(3, {1, 2, 3, 5}), 0);
+
+  manager.FreeSequence(0);
+  manager.FreeSequence(1);
+  manager.FreeSequence(2);
+  manager.FreeSequence(3);
+  // the cached blocks stay until evicted
+  EXPECT_EQ(manager.NumFreeBlocks(), 6);
+  EXPECT_EQ(manager.AddSequence(4, prompt), 8);
+  manager.FreeSequence(4);
+}
+
+TEST(BlockKVCacheManager, copy_on_write) {
+  BlockKVCacheManager manager(8, 4);
+  manager.AddSequence(0, {1, 2, 3, 4, 5, 6});
+  manager.ForkSequence(0, 1);
+  EXPECT_EQ(manager.BlockTable(1), manager.BlockTable(0));
+  EXPECT_EQ(manager.NumFreeBlocks(), 6);
+
+  int shared = manager.BlockTable(0)[1];
+  manager.AppendTokens(1, {7});
+  auto copies = manager.TakePendingCopies();
+  ASSERT_EQ(copies.size(), 1UL);
+  EXPECT_EQ(copies[0].first, shared);
+  EXPECT_EQ(copies[0].second, manager.BlockTable(1)[1]);
+  EXPECT_EQ(manager.BlockTable(1)[0], manager.BlockTable(0)[0]);
+
+  // the block is not shared any more
+  manager.AppendTokens(0, {7});
+  EXPECT_EQ(manager.BlockTable(0)[1], shared);
+  EXPECT_TRUE(manager.TakePendingCopies().empty());
+}
+
+TEST(BlockKVCacheManager, eviction) {
+  BlockKVCacheManager manager(4, 2);
+  manager.AddSequence(0, {1, 2, 3, 4, 5});
+  manager.CachePrefix(0);
+  manager.FreeSequence(0);
+  EXPECT_EQ(manager.NumFreeBlocks(), 2);
+
+  // evicts the cached blocks, the leaf first
+  manager.AddSequence(1, {6, 7, 8});
+  EXPECT_EQ(manager.NumCachedBlocks(), 2);
+  manager.AppendTokens(1, {9, 10});
+  EXPECT_EQ(manager.NumCachedBlocks(), 1);
+  manager.FreeSequence(1);
+
+  EXPECT_EQ(manager.AddSequence(2, {1, 2, 3}), 2);
+  EXPECT_EQ(manager.NumFreeBlocks(), 2);
+  // the blocks of a sequence failing to be added are given back
+  EXPECT_ANY_THROW(manager.AddSequence(3, {1, 2, 3, 4, 5, 6, 7}));
+  EXPECT_FALSE(manager.HasSequence(3));
+  EXPECT_EQ(manager.NumFreeBlocks(), 2);
+  EXPECT_EQ(manager.AddSequence(3, {1, 2, 3}), 2);
+}
+
+}  // namespace inference
+}  // namespace paddle
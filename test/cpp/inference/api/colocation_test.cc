@@ -0,0 +1,112 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/colocation.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+#include "paddle/phi/core/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace inference {
+
+TEST(MemoryBudget, quota_and_cap) {
+  auto device = std::make_shared<MemoryBudget>(100);
+  MemoryBudget model_a(60, device);
+  MemoryBudget model_b(0, device);
+  EXPECT_TRUE(model_a.Reserve(50));
+  EXPECT_FALSE(model_a.Reserve(20));
+  // The cap of the device is kept for the unlimited model.
+  EXPECT_FALSE(model_b.Reserve(60));
+  EXPECT_EQ(model_b.used(), 0UL);
+  EXPECT_TRUE(model_b.Reserve(50));
+  EXPECT_EQ(device->used(), 100UL);
+  model_a.Release(50);
+  model_b.Adjust(-10);
+  EXPECT_EQ(device->used(), 40UL);
+  EXPECT_EQ(model_b.used(), 40UL);
+}
+
+TEST(BudgetAllocator, exhausted) {
+  auto budget = std::make_shared<MemoryBudget>(8192);
+  BudgetAllocator allocator(
+      std::make_shared<memory::allocation::CPUAllocator>(), budget);
+  {
+    auto allocation = allocator.Allocate(4096);
+    EXPECT_EQ(budget->used(), 4096UL);
+    EXPECT_THROW(allocator.Allocate(8192), common::enforce::EnforceNotMet);
+    EXPECT_EQ(budget->used(), 4096UL);
+  }
+  EXPECT_EQ(budget->used(), 0UL);
+}
+
+TEST(ColocationDevice, release_allocator) {
+  // a device id not used by the other tests
+  auto& device = ColocationDevice::Get(1000);
+  auto cpu_allocator = std::make_shared<memory::allocation::CPUAllocator>();
+  auto* allocator = device.CreateAllocator(cpu_allocator, 0);
+  auto allocation = allocator->Allocate(64);
+  EXPECT_EQ(device.num_allocators(), 1UL);
+  // The allocation outlives the model, so is its allocator.
+  device.ReleaseAllocator(allocator);
+  EXPECT_EQ(device.num_allocators(), 1UL);
+  allocation.reset();
+  auto* next_allocator = device.CreateAllocator(cpu_allocator, 0);
+  EXPECT_EQ(device.num_allocators(), 1UL);
+  device.ReleaseAllocator(next_allocator);
+  EXPECT_EQ(device.num_allocators(), 0UL);
+}
+
+TEST(WeightedFairScheduler, weights) {
+  WeightedFairScheduler scheduler(1);
+  int light = 0, heavy = 0;
+  // Both are served 30us, which is 30 for the light one and 10 for the heavy
+  // one of weight 3.
+  scheduler.Acquire(&light);
+  scheduler.Release(&light, 1, 30.);
+  scheduler.Acquire(&heavy);
+  scheduler.Release(&heavy, 3, 30.);
+
+  int other = 0;
+  scheduler.Acquire(&other);
+  std::vector<const void*> order;
+  std::mutex mutex;
+  std::vector<std::thread> threads;
+  for (const void* client : {static_cast<const void*>(&light),
+                             static_cast<const void*>(&heavy)}) {
+    threads.emplace_back([&, client] {
+      scheduler.Acquire(client);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(client);
+      }
+      scheduler.Release(client, 1, 1.);
+    });
+    while (scheduler.num_waiting() < threads.size()) {
+      std::this_thread::yield();
+    }
+  }
+  scheduler.Release(&other, 1, 1.);
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(order.size(), 2UL);
+  EXPECT_EQ(order[0], &heavy);
+  EXPECT_EQ(order[1], &light);
+}
+
+}  // namespace inference
+}  // namespace paddle
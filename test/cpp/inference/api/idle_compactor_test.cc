@@ -0,0 +1,71 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/idle_compactor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace paddle {
+namespace inference {
+
+TEST(IdleCompactor, compact_once_idle) {
+  std::atomic<int> num_compactions{0};
+  IdleCompactor compactor(20, [&]() -> uint64_t {
+    ++num_compactions;
+    return 1;
+  });
+  // Nothing is compacted before a run.
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  EXPECT_EQ(num_compactions, 0);
+
+  // The runs close to each other keep the predictor busy.
+  for (int i = 0; i < 10; ++i) {
+    ScopedCompactionRun run(&compactor);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(num_compactions, 1);
+  EXPECT_EQ(compactor.num_compactions(), 1);
+
+  // Compacted once for each idle phase.
+  { ScopedCompactionRun run(&compactor); }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(num_compactions, 2);
+  EXPECT_EQ(compactor.Compact(), 1UL);
+  EXPECT_EQ(num_compactions, 3);
+}
+
+TEST(IdleCompactor, run_excludes_compaction) {
+  std::atomic<bool> running{false};
+  std::atomic<bool> overlapped{false};
+  IdleCompactor compactor(1, [&]() -> uint64_t {
+    if (running) overlapped = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    return 0;
+  });
+  for (int i = 0; i < 50; ++i) {
+    ScopedCompactionRun run(&compactor);
+    running = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    running = false;
+  }
+  EXPECT_FALSE(overlapped);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,59 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/latency_histogram.h"
+
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace inference {
+
+TEST(LatencyHistogram, empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0UL);
+  EXPECT_EQ(histogram.avg(), 0.);
+  EXPECT_EQ(histogram.Percentile(50.), 0.);
+}
+
+TEST(LatencyHistogram, percentile) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; ++i) histogram.Record(i);
+  EXPECT_EQ(histogram.count(), 1000UL);
+  EXPECT_DOUBLE_EQ(histogram.avg(), 500.5);
+  EXPECT_DOUBLE_EQ(histogram.max(), 1000.);
+  // The percentiles are the upper bounds of their buckets.
+  EXPECT_GE(histogram.Percentile(50.), 500.);
+  EXPECT_LE(histogram.Percentile(50.), 500. * 1.19);
+  EXPECT_GE(histogram.Percentile(99.), 990.);
+  EXPECT_LE(histogram.Percentile(99.), 1000.);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(100.), 1000.);
+
+  histogram.Record(1e12);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(100.), 1e12);
+
+  histogram.Clear();
+  EXPECT_EQ(histogram.count(), 0UL);
+  EXPECT_EQ(histogram.max(), 0.);
+}
+
+TEST(LatencyHistogram, sub_microsecond) {
+  LatencyHistogram histogram;
+  histogram.Record(0.25);
+  histogram.Record(-1.);
+  EXPECT_EQ(histogram.count(), 2UL);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(100.), 0.25);
+}
+
+}  // namespace inference
+}  // namespace paddle
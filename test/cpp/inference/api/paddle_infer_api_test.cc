@@ -14,8 +14,14 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <filesystem>
+#include <future>
+#include <stdexcept>
 
 #include "paddle/common/flags.h"
+#include "paddle/fluid/inference/utils/io_utils.h"
 #include "test/cpp/inference/api/tester_helper.h"
 
 namespace paddle_infer {
@@ -58,6 +64,165 @@ TEST(Predictor, use_gpu) {
   predictor->ClearIntermediateTensor();
 }
 
+TEST(Predictor, run_stats) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableUseGpu(100, 0);
+  config.EnableRunStatistics(2);
+  ASSERT_TRUE(config.run_statistics_enabled());
+
+  auto predictor = CreatePredictor(config);
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(1 * 3 * 318 * 318, 0);
+  auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+  input_t->Reshape(in_shape);
+  input_t->CopyFromCpu(input.data());
+  for (int i = 0; i < 4; ++i) {
+    predictor->Run();
+  }
+
+  // The runs whose ops are sampled are left out of the breakdown.
+  RunStats stats = predictor->GetRunStats();
+  EXPECT_EQ(stats.run.count, 2UL);
+  EXPECT_EQ(stats.executor.count, 2UL);
+  EXPECT_EQ(stats.sync.count, 2UL);
+  EXPECT_EQ(stats.feed.count, 0UL);
+  EXPECT_LE(stats.run.p50, stats.run.max);
+  EXPECT_GE(stats.run.avg, stats.executor.avg);
+  ASSERT_FALSE(stats.ops.empty());
+  for (auto &item : stats.ops) {
+    EXPECT_GT(item.second.count, 0UL) << item.first;
+  }
+
+  predictor->ResetRunStats();
+  stats = predictor->GetRunStats();
+  EXPECT_EQ(stats.run.count, 0UL);
+  EXPECT_TRUE(stats.ops.empty());
+}
+
+TEST(Predictor, collect_shape_range_online) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  std::string shape_range = FLAGS_infer_model + "/online_shape_range.pbtxt";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableUseGpu(100, 0);
+  config.CollectShapeRangeInfoOnline(shape_range, 2, 2);
+  ASSERT_TRUE(config.shape_range_info_collected_online());
+  ASSERT_FALSE(config.shape_range_info_collected());
+
+  auto predictor = CreatePredictor(config);
+  const std::string input_name = predictor->GetInputNames()[0];
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(1 * 3 * 318 * 318, 0);
+  auto input_t = predictor->GetInputHandle(input_name);
+  input_t->Reshape(in_shape);
+  input_t->CopyFromCpu(input.data());
+  // the shapes of the first run are saved as the third one begins
+  for (int i = 0; i < 3; ++i) {
+    predictor->Run();
+  }
+
+  std::map<std::string, std::vector<int32_t>> min_shape, max_shape,
+      opt_shape, min_value, max_value, opt_value;
+  paddle::inference::DeserializeShapeRangeInfo(shape_range,
+                                               &min_shape,
+                                               &max_shape,
+                                               &opt_shape,
+                                               &min_value,
+                                               &max_value,
+                                               &opt_value);
+  ASSERT_EQ(min_shape.count(input_name), 1UL);
+  EXPECT_EQ(min_shape[input_name], std::vector<int32_t>({1, 3, 318, 318}));
+  EXPECT_EQ(max_shape[input_name], min_shape[input_name]);
+  EXPECT_EQ(opt_shape[input_name], min_shape[input_name]);
+}
+
+namespace {
+
+std::vector<float> RunZeros(Predictor *predictor) {
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(1 * 3 * 318 * 318, 0);
+  auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+  input_t->Reshape(in_shape);
+  input_t->CopyFromCpu(input.data());
+  EXPECT_TRUE(predictor->Run());
+  auto output_t = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+  std::vector<int> out_shape = output_t->shape();
+  std::vector<float> output(std::accumulate(
+      out_shape.begin(), out_shape.end(), 1, std::multiplies<int>()));
+  output_t->CopyToCpu(output.data());
+  return output;
+}
+
+}  // namespace
+
+TEST(Predictor, lowered_program_cache) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  std::string cache_dir = FLAGS_infer_model + "/lowered_program_cache_test";
+  std::filesystem::remove_all(cache_dir);
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableNewIR();
+  config.EnableNewExecutor();
+  config.SetOptimCacheDir(cache_dir);
+  config.EnableLoweredProgramCache();
+
+  std::vector<float> expected = RunZeros(CreatePredictor(config).get());
+  std::vector<std::filesystem::path> metas;
+  for (auto &entry : std::filesystem::directory_iterator(
+           cache_dir + "/_lowered_program_cache")) {
+    if (entry.path().extension() == ".meta") {
+      metas.push_back(entry.path());
+    }
+  }
+  ASSERT_EQ(metas.size(), 1UL);
+  struct stat saved;
+  ASSERT_EQ(stat(metas[0].c_str(), &saved), 0);
+
+  // the hit reads the cache, saving again would rename a new meta file over
+  std::vector<float> output = RunZeros(CreatePredictor(config).get());
+  struct stat loaded;
+  ASSERT_EQ(stat(metas[0].c_str(), &loaded), 0);
+  EXPECT_EQ(saved.st_ino, loaded.st_ino);
+  ASSERT_EQ(output.size(), expected.size());
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output[i], expected[i], 1e-6);
+  }
+  std::filesystem::remove_all(cache_dir);
+}
+
+TEST(Predictor, colocation) {
+  services::ColocationOptions options;
+  options.num_streams = 1;
+  options.max_concurrent_runs = 1;
+  services::SetColocationOptions(0, options);
+
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableUseGpu(100, 0);
+  config.EnableColocation(2);
+  auto predictor = CreatePredictor(config);
+  Config small_config(config);
+  small_config.EnableColocation(1, 1024);
+  auto small_predictor = CreatePredictor(small_config);
+  // The colocated models share the stream of the pool.
+  EXPECT_EQ(predictor->GetExecStream(), small_predictor->GetExecStream());
+
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(1 * 3 * 318 * 318, 0);
+  for (auto *pred : {predictor.get(), small_predictor.get()}) {
+    auto input_t = pred->GetInputHandle(pred->GetInputNames()[0]);
+    input_t->Reshape(in_shape);
+    input_t->CopyFromCpu(input.data());
+  }
+  ASSERT_TRUE(predictor->Run());
+  // The activations are beyond the quota of the small model.
+  EXPECT_ANY_THROW(small_predictor->Run());
+  services::SetColocationOptions(0, services::ColocationOptions());
+}
+
 TEST(PredictorPool, basic) {
   LOG(INFO) << GetVersion();
   UpdateDllFlag("conv_workspace_size_limit", "4000");
@@ -93,4 +258,172 @@ TEST(PredictorPool, basic) {
   }
 }
 
+namespace {
+
+paddle::Tensor MakeImages(int64_t batch_size, float value) {
+  auto images = std::make_shared<phi::DenseTensor>();
+  images->Resize(common::make_ddim({batch_size, 3, 318, 318}));
+  float *data = images->mutable_data<float>(phi::CPUPlace());
+  std::fill(data, data + images->numel(), value);
+  return paddle::Tensor(images);
+}
+
+std::vector<float> ToVector(const paddle::Tensor &tensor) {
+  auto &dense = *std::dynamic_pointer_cast<phi::DenseTensor>(tensor.impl());
+  const float *data = dense.data<float>();
+  return std::vector<float>(data, data + dense.numel());
+}
+
+}  // namespace
+
+TEST(AsyncPredictorPool, run) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  services::AsyncPredictorPool pool(config, 2);
+  EXPECT_EQ(pool.size(), 2UL);
+
+  const int num_requests = 6;
+  std::vector<std::vector<paddle::Tensor>> outputs(num_requests);
+  std::vector<std::future<bool>> futures;
+  for (int r = 0; r < num_requests; ++r) {
+    futures.emplace_back(pool.Run({MakeImages(1, 0.1f * r)}, &outputs[r]));
+  }
+
+  auto predictor = CreatePredictor(config);
+  for (int r = 0; r < num_requests; ++r) {
+    ASSERT_TRUE(futures[r].get());
+    std::vector<paddle::Tensor> expected;
+    ASSERT_TRUE(predictor->Run({MakeImages(1, 0.1f * r)}, &expected));
+    ASSERT_EQ(outputs[r].size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      std::vector<float> out = ToVector(outputs[r][i]);
+      std::vector<float> ref = ToVector(expected[i]);
+      ASSERT_EQ(out.size(), ref.size());
+      for (size_t j = 0; j < out.size(); ++j) {
+        EXPECT_NEAR(out[j], ref[j], 1e-5);
+      }
+    }
+  }
+
+  services::AsyncPredictorPoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_finished, static_cast<uint64_t>(num_requests));
+  EXPECT_EQ(stats.num_failed, 0UL);
+  EXPECT_EQ(stats.num_pending, 0UL);
+  ASSERT_EQ(stats.num_runs.size(), 2UL);
+  EXPECT_EQ(stats.num_runs[0] + stats.num_runs[1],
+            static_cast<uint64_t>(num_requests));
+  EXPECT_GE(stats.max_run_time, stats.avg_run_time);
+
+  pool.ResetStats();
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.num_finished, 0UL);
+  EXPECT_EQ(stats.num_runs, std::vector<uint64_t>({0, 0}));
+}
+
+TEST(AsyncPredictorPool, submit) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  services::AsyncPredictorPool pool(config, 2);
+
+  // both predictors run at the same time, each of them blocks until the
+  // other one has started
+  std::promise<void> started[2];
+  std::shared_future<void> all_started[2] = {started[0].get_future().share(),
+                                             started[1].get_future().share()};
+  std::vector<std::future<bool>> futures;
+  for (int r = 0; r < 2; ++r) {
+    futures.emplace_back(pool.Submit([&, r](Predictor *pred) {
+      started[r].set_value();
+      all_started[1 - r].wait();
+      return pred != nullptr;
+    }));
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+
+  // the result and the exception of a task go to its future
+  EXPECT_FALSE(pool.Submit([](Predictor *) { return false; }).get());
+  auto failed = pool.Submit([](Predictor *) -> bool {
+    throw std::runtime_error("task failed");
+  });
+  EXPECT_THROW(failed.get(), std::runtime_error);
+
+  services::AsyncPredictorPoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_finished, 4UL);
+  EXPECT_EQ(stats.num_failed, 2UL);
+  // each predictor ran one of the tasks waiting for each other
+  ASSERT_EQ(stats.num_runs.size(), 2UL);
+  EXPECT_GE(stats.num_runs[0], 1UL);
+  EXPECT_GE(stats.num_runs[1], 1UL);
+}
+
+TEST(DynamicBatcher, batch_and_split) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  services::DynamicBatcherConfig batcher_config;
+  batcher_config.max_batch_size = 4;
+  // the batch runs as soon as the 4 samples are queued
+  batcher_config.max_wait_us = 10 * 1000 * 1000;
+  services::DynamicBatcher batcher(config, batcher_config);
+  EXPECT_EQ(batcher.batch_sizes(), std::vector<int>({1, 2, 4}));
+
+  // a request larger than max_batch_size is rejected
+  EXPECT_ANY_THROW(batcher.Submit({MakeImages(5, 0.f)}));
+
+  std::vector<int64_t> sizes = {1, 2, 1};
+  std::vector<std::future<std::vector<paddle::Tensor>>> futures;
+  for (size_t r = 0; r < sizes.size(); ++r) {
+    futures.emplace_back(batcher.Submit({MakeImages(sizes[r], 0.1f * r)}));
+  }
+
+  auto predictor = CreatePredictor(config);
+  for (size_t r = 0; r < sizes.size(); ++r) {
+    std::vector<paddle::Tensor> outputs = futures[r].get();
+    std::vector<paddle::Tensor> expected;
+    ASSERT_TRUE(predictor->Run({MakeImages(sizes[r], 0.1f * r)}, &expected));
+    ASSERT_EQ(outputs.size(), expected.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      EXPECT_EQ(outputs[i].dims(), expected[i].dims());
+      EXPECT_EQ(outputs[i].dims()[0], sizes[r]);
+      std::vector<float> out = ToVector(outputs[i]);
+      std::vector<float> ref = ToVector(expected[i]);
+      ASSERT_EQ(out.size(), ref.size());
+      for (size_t j = 0; j < out.size(); ++j) {
+        EXPECT_NEAR(out[j], ref[j], 1e-5);
+      }
+    }
+  }
+
+  services::DynamicBatcherStats stats = batcher.GetStats();
+  EXPECT_EQ(stats.num_requests, 3UL);
+  EXPECT_EQ(stats.num_batches, 1UL);
+  EXPECT_EQ(stats.num_samples, 4UL);
+  EXPECT_EQ(stats.num_padded_samples, 0UL);
+  EXPECT_EQ(stats.num_failed_batches, 0UL);
+}
+
+TEST(DynamicBatcher, padding) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  services::DynamicBatcherConfig batcher_config;
+  batcher_config.max_batch_size = 4;
+  batcher_config.max_wait_us = 1000;
+  services::DynamicBatcher batcher(config, batcher_config);
+
+  // 3 samples are padded to the batch size 4
+  std::vector<paddle::Tensor> outputs =
+      batcher.Submit({MakeImages(3, 0.5f)}).get();
+  ASSERT_FALSE(outputs.empty());
+  EXPECT_EQ(outputs[0].dims()[0], 3);
+  services::DynamicBatcherStats stats = batcher.GetStats();
+  EXPECT_EQ(stats.num_batches, 1UL);
+  EXPECT_EQ(stats.num_samples, 3UL);
+  EXPECT_EQ(stats.num_padded_samples, 1UL);
+}
+
 }  // namespace paddle_infer
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/speculative_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+constexpr int kVocabSize = 8;
+
+// A toy model predicting the next token of t to be t + 1, or t + 2 after the
+// multiples of wrong_every if it is not 0.
+SpeculativeDecoder::ForwardFunc ToyModel(int wrong_every) {
+  return [=](int64_t, const std::vector<int64_t>& tokens) {
+    std::vector<float> probs(tokens.size() * kVocabSize, 0.0f);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      int64_t next = tokens[i] + 1;
+      if (wrong_every > 0 && tokens[i] % wrong_every == 0) {
+        ++next;
+      }
+      probs[i * kVocabSize + next % kVocabSize] = 1.0f;
+    }
+    return probs;
+  };
+}
+
+}  // namespace
+
+TEST(VerifyDraftTokens, greedy) {
+  std::mt19937_64 rng(0);
+  std::vector<float> draft(2 * kVocabSize, 0.0f);
+  std::vector<float> target(3 * kVocabSize, 0.0f);
+  draft[1] = draft[kVocabSize + 2] = 1.0f;
+  target[1] = target[kVocabSize + 3] = target[2 * kVocabSize + 4] = 1.0f;
+  int64_t next = -1;
+  EXPECT_EQ(VerifyDraftTokens(
+                {1, 2}, draft.data(), target.data(), kVocabSize, &rng, &next),
+            1);
+  EXPECT_EQ(next, 3);
+
+  target[kVocabSize + 3] = 0.0f;
+  target[kVocabSize + 2] = 1.0f;
+  EXPECT_EQ(VerifyDraftTokens(
+                {1, 2}, draft.data(), target.data(), kVocabSize, &rng, &next),
+            2);
+  EXPECT_EQ(next, 4);
+}
+
+TEST(VerifyDraftTokens, target_distribution) {
+  std::mt19937_64 rng(0);
+  std::vector<float> draft = {0.6f, 0.3f, 0.1f};
+  std::vector<float> target = {0.2f, 0.3f, 0.5f, 0.2f, 0.3f, 0.5f};
+  std::vector<int> counts(3, 0);
+  const int n = 100000;
+  for (int i = 0; i < n; ++i) {
+    int64_t x = SampleToken(draft.data(), 3, &rng);
+    int64_t next = -1;
+    int accepted =
+        VerifyDraftTokens({x}, draft.data(), target.data(), 3, &rng, &next);
+    ++counts[accepted == 1 ? x : next];
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(static_cast<double>(counts[i]) / n, target[i], 0.01);
+  }
+}
+
+TEST(SpeculativeDecoder, matches_target) {
+  BlockKVCacheManager draft_cache(16, 4);
+  BlockKVCacheManager target_cache(16, 4);
+  SpeculativeDecoder decoder(ToyModel(3),
+                             ToyModel(0),
+                             &draft_cache,
+                             &target_cache,
+                             3,
+                             kVocabSize);
+  decoder.AddSequence(0, {0, 1});
+  std::vector<int64_t> tokens = {0, 1};
+  int num_target_forwards = 0;
+  while (tokens.size() < 20) {
+    auto next = decoder.Step(0);
+    ASSERT_GE(next.size(), 1UL);
+    ASSERT_LE(next.size(), 4UL);
+    tokens.insert(tokens.end(), next.begin(), next.end());
+    ++num_target_forwards;
+  }
+  // the tokens of the target model alone
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens[i], (tokens[i - 1] + 1) % kVocabSize);
+  }
+  EXPECT_LT(num_target_forwards, 18);
+  EXPECT_GT(decoder.AcceptanceRate(), 0.0);
+  EXPECT_LT(decoder.AcceptanceRate(), 1.0);
+  // the caches hold the tokens, the last one is not run yet
+  EXPECT_EQ(target_cache.SequenceLength(0), static_cast<int>(tokens.size()));
+  EXPECT_EQ(draft_cache.SequenceLength(0), static_cast<int>(tokens.size()));
+  decoder.FreeSequence(0);
+  EXPECT_EQ(target_cache.NumFreeBlocks(), 16);
+  EXPECT_EQ(draft_cache.NumFreeBlocks(), 16);
+}
+
+}  // namespace inference
+}  // namespace paddle
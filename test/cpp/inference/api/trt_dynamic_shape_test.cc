@@ -12,12 +12,20 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cuda_runtime.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
 #include "paddle/common/flags.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "test/cpp/inference/api/trt_test_helper.h"
 
+COMMON_DECLARE_bool(trt_async_engine_build);
+
 namespace paddle {
 namespace inference {
 
@@ -85,12 +93,39 @@ void TestDynamic(bool with_dynamic = true,
   output_t->copy_to_cpu(out_data.data());
 }
 
-void TestDynamic2() {
+// Writes the params of src_file doubled to dst_file, in the same order.
+void WriteDoubledParams(const std::string &src_file,
+                        const std::string &dst_file) {
+  std::ifstream fin(src_file, std::ios::binary);
+  std::ofstream fout(dst_file, std::ios::binary);
+  ASSERT_TRUE(fin && fout);
+  while (fin.peek() != EOF) {
+    phi::DenseTensor tensor;
+    framework::DeserializeFromStream(fin, &tensor);
+    if (tensor.dtype() == phi::DataType::FLOAT32) {
+      float *data = tensor.data<float>();
+      for (int64_t i = 0; i < tensor.numel(); ++i) {
+        data[i] *= 2;
+      }
+    }
+    framework::SerializeToStream(fout, tensor);
+  }
+}
+
+void TestDynamic2(bool async_engine_build = false, bool refit = false) {
+  FLAGS_trt_async_engine_build = async_engine_build;
   std::string model_dir =
       FLAGS_infer_model + "/complex_model_dynamic/complex_model_dynamic2";
+  std::string opt_cache_dir = model_dir + "/refit_cache";
   AnalysisConfig config;
   config.EnableUseGpu(100, 0);
   config.SetModel(model_dir + "/model", model_dir + "/params");
+  if (refit) {
+    delete_cache_files(opt_cache_dir);
+    config.SetOptimCacheDir(opt_cache_dir);
+    config.EnableSaveOptimModel(true);
+    config.EnableTensorRtRefit();
+  }
   // Set the input's min, max, opt shape
   int batch_size = 1;
   std::map<std::string, std::vector<int>> min_input_shape = {
@@ -106,41 +141,141 @@ void TestDynamic2() {
       min_input_shape, max_input_shape, opt_input_shape);
 
   auto predictor = CreatePaddlePredictor(config);
-  int channels = 3;
-  int height = 5;
-  int width = 5;
-  int input_num = channels * height * width * 1;
+  using paddle_infer::experimental::InternalUtils;
+  const std::string params_file = opt_cache_dir + "/_optimized.pdiparams";
+  const std::string doubled_params_file = opt_cache_dir + "/doubled.pdiparams";
+  // the first run uses the native kernels while the engines are building,
+  // the refits use the doubled params and then the optimized ones again
+  const int run_num = async_engine_build ? 2 : (refit ? 3 : 1);
+  for (int run = 0; run < run_num; ++run) {
+    if (run > 0 && async_engine_build) {
+      InternalUtils::WaitTensorRtEngineBuilds();
+    }
+    const int64_t engine_runs = InternalUtils::TensorRtEngineRunCount();
+    if (run == 1 && refit) {
+      WriteDoubledParams(params_file, doubled_params_file);
+    }
+    if (run > 0 && refit) {
+      ASSERT_TRUE(static_cast<AnalysisPredictor *>(predictor.get())
+                      ->RefitTensorRTEngines(
+                          run == 1 ? doubled_params_file : params_file));
+    }
+    int channels = 3;
+    int height = 5;
+    int width = 5;
+    int input_num = channels * height * width * 1;
 
-  float *input = new float[input_num];
-  memset(input, 0, input_num * sizeof(float));
-  auto input_names = predictor->GetInputNames();
-  auto input_t = predictor->GetInputTensor(input_names[0]);
-  input_t->Reshape({batch_size, channels, height, width});
-  input_t->copy_from_cpu(input);
+    float *input = new float[input_num];
+    memset(input, 0, input_num * sizeof(float));
+    auto input_names = predictor->GetInputNames();
+    auto input_t = predictor->GetInputTensor(input_names[0]);
+    input_t->Reshape({batch_size, channels, height, width});
+    input_t->copy_from_cpu(input);
 
-  auto input_t1 = predictor->GetInputTensor(input_names[1]);
-  input_t1->Reshape({batch_size, 2, 1, 1});
-  std::vector<float> first;
-  for (int i = 0; i < batch_size * 2; i++) first.push_back(1.0);
-  input_t1->copy_from_cpu(first.data());
+    auto input_t1 = predictor->GetInputTensor(input_names[1]);
+    input_t1->Reshape({batch_size, 2, 1, 1});
+    std::vector<float> first;
+    for (int i = 0; i < batch_size * 2; i++) first.push_back(1.0);
+    input_t1->copy_from_cpu(first.data());
 
-  auto input_t2 = predictor->GetInputTensor(input_names[2]);
-  input_t2->Reshape({batch_size, 2, 1, 1});
-  input_t2->copy_from_cpu(first.data());
+    auto input_t2 = predictor->GetInputTensor(input_names[2]);
+    input_t2->Reshape({batch_size, 2, 1, 1});
+    input_t2->copy_from_cpu(first.data());
 
-  ASSERT_TRUE(predictor->ZeroCopyRun());
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+    if (async_engine_build) {
+      // the engines run once the builds are done
+      EXPECT_EQ(run > 0, InternalUtils::TensorRtEngineRunCount() > engine_runs);
+    }
 
-  std::vector<float> out_data;
+    std::vector<float> out_data;
+    auto output_names = predictor->GetOutputNames();
+    auto output_t = predictor->GetOutputTensor(output_names[0]);
+    std::vector<int> output_shape = output_t->shape();
+    int out_num = std::accumulate(
+        output_shape.begin(), output_shape.end(), 1, std::multiplies<int>());
+    out_data.resize(out_num);
+    output_t->copy_to_cpu(out_data.data());
+    std::vector<float> result = {0.617728, 1.63504, 2.15771, 0.535556};
+    if (run == 1 && refit) {
+      // the engines compute by the doubled params
+      float diff = 0;
+      for (size_t i = 0; i < out_data.size(); i++) {
+        diff = std::max(diff, std::abs(result[i] - out_data[i]));
+      }
+      EXPECT_GT(diff, 1e-3);
+      continue;
+    }
+    for (size_t i = 0; i < out_data.size(); i++) {
+      EXPECT_NEAR(result[i], out_data[i], 1e-5);
+    }
+  }
+  FLAGS_trt_async_engine_build = false;
+}
+
+void TestBindOutput(PaddlePlace place) {
+  std::string model_dir =
+      FLAGS_infer_model + "/complex_model_dynamic/complex_model_dynamic2";
+  AnalysisConfig config;
+  config.EnableUseGpu(100, 0);
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  std::map<std::string, std::vector<int>> min_input_shape = {
+      {"image", {1, 3, 3, 3}}, {"in1", {1, 2, 1, 1}}, {"in2", {1, 2, 1, 1}}};
+  std::map<std::string, std::vector<int>> max_input_shape = {
+      {"image", {1, 3, 10, 10}}, {"in1", {1, 2, 1, 1}}, {"in2", {1, 2, 1, 1}}};
+  std::map<std::string, std::vector<int>> opt_input_shape = {
+      {"image", {1, 3, 5, 5}}, {"in1", {1, 2, 1, 1}}, {"in2", {1, 2, 1, 1}}};
+  config.EnableTensorRtEngine(
+      1 << 30, 1, 0, AnalysisConfig::Precision::kFloat32, false, true);
+  config.SetTRTDynamicShapeInfo(
+      min_input_shape, max_input_shape, opt_input_shape);
+  auto predictor = CreatePaddlePredictor(config);
+
+  // The buffer is an upper bound of the output, larger than it.
+  const size_t buffer_size = 16 * sizeof(float);
+  void *buffer = nullptr;
+  std::vector<float> host_buffer(16);
+  if (place == PaddlePlace::kGPU) {
+    ASSERT_EQ(cudaMalloc(&buffer, buffer_size), cudaSuccess);
+  } else {
+    buffer = host_buffer.data();
+  }
   auto output_names = predictor->GetOutputNames();
-  auto output_t = predictor->GetOutputTensor(output_names[0]);
-  std::vector<int> output_shape = output_t->shape();
-  int out_num = std::accumulate(
-      output_shape.begin(), output_shape.end(), 1, std::multiplies<int>());
-  out_data.resize(out_num);
-  output_t->copy_to_cpu(out_data.data());
-  std::vector<float> result = {0.617728, 1.63504, 2.15771, 0.535556};
-  for (size_t i = 0; i < out_data.size(); i++) {
-    EXPECT_NEAR(result[i], out_data[i], 1e-5);
+  ASSERT_TRUE(
+      predictor->BindOutput(output_names[0], buffer, buffer_size, place));
+
+  std::vector<float> input(3 * 5 * 5, 0);
+  std::vector<float> first(2, 1.0);
+  for (int run = 0; run < 2; ++run) {
+    auto input_names = predictor->GetInputNames();
+    auto input_t = predictor->GetInputTensor(input_names[0]);
+    input_t->Reshape({1, 3, 5, 5});
+    input_t->copy_from_cpu(input.data());
+    auto input_t1 = predictor->GetInputTensor(input_names[1]);
+    input_t1->Reshape({1, 2, 1, 1});
+    input_t1->copy_from_cpu(first.data());
+    auto input_t2 = predictor->GetInputTensor(input_names[2]);
+    input_t2->Reshape({1, 2, 1, 1});
+    input_t2->copy_from_cpu(first.data());
+
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+
+    if (place == PaddlePlace::kGPU) {
+      ASSERT_EQ(cudaMemcpy(host_buffer.data(),
+                           buffer,
+                           buffer_size,
+                           cudaMemcpyDeviceToHost),
+                cudaSuccess);
+    }
+    std::vector<float> result = {0.617728, 1.63504, 2.15771, 0.535556};
+    for (size_t i = 0; i < result.size(); i++) {
+      EXPECT_NEAR(result[i], host_buffer[i], 1e-5);
+    }
+  }
+  ASSERT_TRUE(predictor->BindOutput(output_names[0], nullptr, 0, place));
+  if (place == PaddlePlace::kGPU) {
+    predictor.reset();
+    ASSERT_EQ(cudaFree(buffer), cudaSuccess);
   }
 }
 
@@ -207,6 +342,83 @@ void TestTunedDynamic() {
   check_func(test_predictor.get());
 }
 
+// The shapes of batch 1 and 2 are collected into 2 buckets, whose profiles
+// are selected by the runtime batch sizes.
+void TestTunedDynamicBuckets() {
+  std::string model_dir =
+      FLAGS_infer_model + "/complex_model_dynamic/complex_model_dynamic2";
+  AnalysisConfig config_tuned;
+  const std::string shape_range = "shape_range_buckets.pbtxt";
+  config_tuned.EnableUseGpu(100, 0);
+  config_tuned.SetModel(model_dir + "/model", model_dir + "/params");
+  config_tuned.CollectShapeRangeInfo(shape_range, 2);
+
+  int max_batch_size = 2;
+  auto predictor_tuned = CreatePaddlePredictor(config_tuned);
+
+  auto check_func = [](PaddlePredictor *predictor, int batch_size) {
+    int channels = 3;
+    int height = 5;
+    int width = 5;
+    std::vector<float> input(channels * height * width * batch_size, 0);
+    auto input_names = predictor->GetInputNames();
+    auto input_t = predictor->GetInputTensor(input_names[0]);
+    input_t->Reshape({batch_size, channels, height, width});
+    input_t->copy_from_cpu(input.data());
+
+    auto input_t1 = predictor->GetInputTensor(input_names[1]);
+    input_t1->Reshape({batch_size, 2, 1, 1});
+    std::vector<float> first(batch_size * 2, 1.0);
+    input_t1->copy_from_cpu(first.data());
+
+    auto input_t2 = predictor->GetInputTensor(input_names[2]);
+    input_t2->Reshape({batch_size, 2, 1, 1});
+    input_t2->copy_from_cpu(first.data());
+
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+
+    std::vector<float> out_data;
+    auto output_names = predictor->GetOutputNames();
+    auto output_t = predictor->GetOutputTensor(output_names[0]);
+    std::vector<int> output_shape = output_t->shape();
+    ASSERT_EQ(output_shape[0], batch_size);
+    int out_num = std::accumulate(
+        output_shape.begin(), output_shape.end(), 1, std::multiplies<int>());
+    out_data.resize(out_num);
+    output_t->copy_to_cpu(out_data.data());
+    return out_data;
+  };
+  std::vector<std::vector<float>> expected;
+  for (int batch_size = 1; batch_size <= max_batch_size; ++batch_size) {
+    expected.push_back(check_func(predictor_tuned.get(), batch_size));
+  }
+  predictor_tuned.reset(nullptr);
+
+  AnalysisConfig config;
+  config.EnableUseGpu(100, 0);
+  std::string cache_dir = "tuned_cache_buckets";
+  config.SetOptimCacheDir(cache_dir);
+  delete_cache_files(cache_dir);
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableTunedTensorRtDynamicShape(shape_range, true);
+  config.EnableTensorRtEngine(1 << 30,
+                              max_batch_size,
+                              0,
+                              AnalysisConfig::Precision::kFloat32,
+                              true,
+                              false);
+  auto test_predictor = CreatePaddlePredictor(config);
+  // switch from the profile of the larger bucket to the smaller one
+  for (int batch_size = max_batch_size; batch_size >= 1; --batch_size) {
+    std::vector<float> out_data = check_func(test_predictor.get(), batch_size);
+    const auto &ref = expected[batch_size - 1];
+    ASSERT_EQ(out_data.size(), ref.size());
+    for (size_t i = 0; i < out_data.size(); ++i) {
+      EXPECT_NEAR(out_data[i], ref[i], 1e-5);
+    }
+  }
+}
+
 void TestDynamicClone(bool with_dynamic = true,
                       bool delete_cache = true,
                       bool delete_conv_bn = false) {
@@ -298,8 +510,19 @@ TEST(AnalysisPredictor, trt_memory_serialize) {
   TestDynamic(true, false, true);
 }
 TEST(AnalysisPredictor, trt_dynamic2) { TestDynamic2(); }
+TEST(AnalysisPredictor, trt_dynamic2_async_build) { TestDynamic2(true); }
+TEST(AnalysisPredictor, trt_dynamic2_refit) { TestDynamic2(false, true); }
 
+TEST(AnalysisPredictor, trt_bind_output_gpu) {
+  TestBindOutput(PaddlePlace::kGPU);
+}
+TEST(AnalysisPredictor, trt_bind_output_cpu) {
+  TestBindOutput(PaddlePlace::kCPU);
+}
 TEST(AnalysisPredictor, trt_tuned_dynamic) { TestTunedDynamic(); }
+TEST(AnalysisPredictor, trt_tuned_dynamic_buckets) {
+  TestTunedDynamicBuckets();
+}
 TEST(AnalysisPredictor, trt_dynamic_clone) { TestDynamicClone(); }
 
 }  // namespace inference
@@ -19,9 +19,11 @@
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "paddle/phi/core/kernel_registry.h"
 
+#include "paddle/fluid/framework/executor_cache.h"
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 #include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
@@ -33,12 +35,20 @@
 
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 
+#include "paddle/common/flags.h"
 #include "paddle/common/macros.h"
 #include "paddle/pir/include/dialect/control_flow/ir/cf_dialect.h"
 #include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
 
 DECLARE_FILE_SYMBOLS(kernel_dialect);
 
+COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
+COMMON_DECLARE_int32(pir_static_memory_plan_buckets);
+COMMON_DECLARE_bool(pir_critical_path_scheduling);
+COMMON_DECLARE_bool(bind_kernel_call);
+COMMON_DECLARE_bool(pir_infermeta_cache);
+COMMON_DECLARE_int32(pir_build_instruction_threads);
+
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(full_int_array, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(uniform, CPU, ALL_LAYOUT);
@@ -218,6 +228,74 @@ TEST(StandaloneExecutor, run_feed_tensor) {
   EXPECT_EQ(res0, true);
 }
 
+TEST(StandaloneExecutor, run_with_infermeta_cache) {
+  FLAGS_pir_infermeta_cache = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program(ctx);
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  pir::OpInfo feed_op_info =
+      ctx->GetRegisteredOpInfo(paddle::dialect::FeedOp::name());
+
+  pir::Type dense_tensor_dtype =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            pir::Float32Type::get(ctx),
+                                            phi::DDim({-1}),
+                                            phi::DataLayout::NCHW,
+                                            phi::LoD(),
+                                            0);
+  std::vector<pir::Operation*> feed_ops;
+  for (const std::string& name : {"x", "y"}) {
+    pir::AttributeMap attr_map;
+    attr_map.insert(std::pair<std::string, pir::Attribute>(
+        "name", pir::StrAttribute::get(ctx, name)));
+    attr_map.insert(std::pair<std::string, pir::Attribute>(
+        "col", pir::Int32Attribute::get(ctx, 0)));
+    feed_ops.push_back(pir::Operation::Create(
+        {}, attr_map, {dense_tensor_dtype}, feed_op_info));
+    program.block()->push_back(feed_ops.back());
+  }
+  auto add_op = builder.Build<paddle::dialect::AddOp>(feed_ops[0]->result(0),
+                                                      feed_ops[1]->result(0));
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(add_op->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+  Scope scope;
+  InterpreterCore test_core(
+      phi::CPUPlace(), {}, kernel_program->block(), &scope);
+  test_core.SetSkipGcVars({out_name});
+  phi::DeviceContext* dev_ctx =
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+
+  // the shapes are repeated to replay the recorded infer meta
+  for (int64_t numel : {1, 3, 1, 3}) {
+    phi::DenseTensorMeta meta(phi::DataType::FLOAT32, phi::DDim({numel}));
+    phi::DenseTensor tensor_x, tensor_y;
+    tensor_x.set_meta(meta);
+    tensor_y.set_meta(meta);
+    dev_ctx->Alloc(&tensor_x, phi::DataType::FLOAT32);
+    dev_ctx->Alloc(&tensor_y, phi::DataType::FLOAT32);
+    for (int64_t i = 0; i < numel; ++i) {
+      tensor_x.data<float>()[i] = 1.0;
+      tensor_y.data<float>()[i] = static_cast<float>(numel);
+    }
+
+    test_core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    auto* out_scope = test_core.local_scope() == nullptr
+                          ? &scope
+                          : test_core.local_scope();
+    const auto& out_tensor =
+        out_scope->FindVar(out_name)->Get<phi::DenseTensor>();
+    EXPECT_EQ(out_tensor.dims(), phi::DDim({numel}));
+    for (int64_t i = 0; i < numel; ++i) {
+      EXPECT_EQ(out_tensor.data<float>()[i], numel + 1.0f);
+    }
+  }
+  FLAGS_pir_infermeta_cache = false;
+}
+
 TEST(StandaloneExecutor, run_inplace_sqrt) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   pir::Program program((ctx));
@@ -260,6 +338,160 @@ TEST(StandaloneExecutor, run_inplace_sqrt) {
   EXPECT_EQ(res3, true);
 }
 
+TEST(StandaloneExecutor, run_with_static_memory_plan) {
+  FLAGS_enable_pir_in_executor_trace_run = true;
+  FLAGS_pir_static_memory_plan_buckets = 1;
+
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  paddle::dialect::FullOp op1 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  paddle::dialect::FullOp op2 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto add_op =
+      builder.Build<paddle::dialect::AddOp>(op1->result(0), op2->result(0));
+  auto sqrt_op = builder.Build<paddle::dialect::SqrtOp>(add_op->result(0));
+  auto out_op =
+      builder.Build<paddle::dialect::AddOp>(sqrt_op->result(0), op1->result(0));
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(out_op->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // the first run records the bucket, the others run in the arena
+  for (int i = 0; i < 3; ++i) {
+    test_core.Run({});
+
+    // the outputs of the fulls, the add and the sqrt are planned, the one of
+    // the last add is kept for fetch. Each takes a slice of 256 bytes, and
+    // the sqrt reuses the slice of the second full, dead after the add.
+    auto* planner =
+        dynamic_cast<const PirInterpreter*>(test_core.Impl())->MemoryPlanner();
+    ASSERT_NE(planner, nullptr);
+    EXPECT_EQ(planner->NumPlannedTensors(), 4UL);
+    EXPECT_GT(planner->ArenaSize(), 0UL);
+    EXPECT_LT(planner->ArenaSize(), 4UL * 256);
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], std::sqrt(2.0f) + 1),
+                true);
+    }
+  }
+
+  FLAGS_enable_pir_in_executor_trace_run = false;
+  FLAGS_pir_static_memory_plan_buckets = 0;
+}
+
+TEST(StandaloneExecutor, run_with_critical_path_scheduling) {
+  FLAGS_pir_critical_path_scheduling = true;
+
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // a long branch of sqrt and a short one of add
+  paddle::dialect::FullOp op1 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 16.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  paddle::dialect::FullOp op2 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto short_op =
+      builder.Build<paddle::dialect::AddOp>(op2->result(0), op2->result(0));
+  pir::Value long_out = op1->result(0);
+  for (int i = 0; i < 2; ++i) {
+    long_out = builder.Build<paddle::dialect::SqrtOp>(long_out)->result(0);
+  }
+  auto out_op =
+      builder.Build<paddle::dialect::AddOp>(long_out, short_op->result(0));
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(out_op->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // the second run profiles the latency, the third one uses it
+  for (int i = 0; i < 3; ++i) {
+    test_core.Run({});
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], 4.0), true);
+    }
+  }
+
+  FLAGS_pir_critical_path_scheduling = false;
+}
+
+TEST(StandaloneExecutor, run_with_parallel_build) {
+  FLAGS_pir_build_instruction_threads = 4;
+
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // a chain of adds, more than the threads building them
+  paddle::dialect::FullOp op1 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  pir::Value out = op1->result(0);
+  for (int i = 0; i < 32; ++i) {
+    out = builder.Build<paddle::dialect::AddOp>(out, op1->result(0))->result(0);
+  }
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(out, out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  test_core.Run({});
+
+  auto out_tensor =
+      test_core.local_scope() == nullptr
+          ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+          : test_core.local_scope()->FindVar(out_name)->Get<phi::DenseTensor>();
+
+  for (int j = 0; j < 4; ++j) {
+    EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], 33.0), true);
+  }
+
+  FLAGS_pir_build_instruction_threads = 1;
+}
+
 TEST(StandaloneExecutor, if_op) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
@@ -385,5 +617,125 @@ TEST(StandaloneExecutor, while_op) {
   EXPECT_EQ(res0, true);
 }
 
+// Runs a chain of adds out = y + x + ... + x on feeds of every numel with one
+// interpreter, whose instructions are built by the first run and reused by
+// the others, and returns the outputs of the runs.
+std::vector<std::vector<float>> RunAddChain(
+    bool bind_kernel_call, const std::vector<int64_t>& numels) {
+  FLAGS_bind_kernel_call = bind_kernel_call;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program(ctx);
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  pir::OpInfo feed_op_info =
+      ctx->GetRegisteredOpInfo(paddle::dialect::FeedOp::name());
+
+  pir::Type dense_tensor_dtype =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            pir::Float32Type::get(ctx),
+                                            phi::DDim({-1}),
+                                            phi::DataLayout::NCHW,
+                                            phi::LoD(),
+                                            0);
+  std::vector<pir::Operation*> feed_ops;
+  for (const std::string& name : {"x", "y"}) {
+    pir::AttributeMap attr_map;
+    attr_map.insert(std::pair<std::string, pir::Attribute>(
+        "name", pir::StrAttribute::get(ctx, name)));
+    attr_map.insert(std::pair<std::string, pir::Attribute>(
+        "col", pir::Int32Attribute::get(ctx, 0)));
+    feed_ops.push_back(pir::Operation::Create(
+        {}, attr_map, {dense_tensor_dtype}, feed_op_info));
+    program.block()->push_back(feed_ops.back());
+  }
+  pir::Value x = feed_ops[0]->result(0);
+  pir::Value y = feed_ops[1]->result(0);
+  const int kChainLength = 8;
+  for (int i = 0; i < kChainLength; ++i) {
+    y = builder.Build<paddle::dialect::AddOp>(y, x).out();
+  }
+  std::string out_name = "add_chain_out";
+  builder.Build<pir::ShadowOutputOp>(y, out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+  Scope scope;
+  InterpreterCore test_core(
+      phi::CPUPlace(), {}, kernel_program->block(), &scope);
+  test_core.SetSkipGcVars({out_name});
+  phi::DeviceContext* dev_ctx =
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+
+  std::vector<std::vector<float>> outs;
+  for (int64_t numel : numels) {
+    phi::DenseTensorMeta meta(phi::DataType::FLOAT32, phi::DDim({numel}));
+    phi::DenseTensor tensor_x, tensor_y;
+    tensor_x.set_meta(meta);
+    tensor_y.set_meta(meta);
+    dev_ctx->Alloc(&tensor_x, phi::DataType::FLOAT32);
+    dev_ctx->Alloc(&tensor_y, phi::DataType::FLOAT32);
+    for (int64_t i = 0; i < numel; ++i) {
+      tensor_x.data<float>()[i] = static_cast<float>(i + 1);
+      tensor_y.data<float>()[i] = static_cast<float>(numel);
+    }
+
+    test_core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    auto* out_scope = test_core.local_scope() == nullptr
+                          ? &scope
+                          : test_core.local_scope();
+    const auto& out_tensor =
+        out_scope->FindVar(out_name)->Get<phi::DenseTensor>();
+    EXPECT_EQ(out_tensor.dims(), phi::DDim({numel}));
+    outs.emplace_back(out_tensor.data<float>(),
+                      out_tensor.data<float>() + out_tensor.numel());
+  }
+  FLAGS_bind_kernel_call = true;
+  return outs;
+}
+
+TEST(StandaloneExecutor, run_with_bound_kernel_call) {
+  // The shapes change between the runs, which the bound calls see through
+  // the tensors kept by their address.
+  std::vector<int64_t> numels = {2, 5, 2, 5, 1};
+  auto bound_outs = RunAddChain(true, numels);
+  auto unbound_outs = RunAddChain(false, numels);
+  ASSERT_EQ(bound_outs.size(), numels.size());
+  for (size_t run = 0; run < numels.size(); ++run) {
+    ASSERT_EQ(bound_outs[run].size(), static_cast<size_t>(numels[run]));
+    for (int64_t i = 0; i < numels[run]; ++i) {
+      EXPECT_EQ(bound_outs[run][i], numels[run] + 8.0f * (i + 1));
+    }
+    EXPECT_EQ(bound_outs[run], unbound_outs[run]);
+  }
+}
+
+std::unique_ptr<pir::Program> BuildUnaryProgram(
+    const std::vector<int64_t>& shape, bool use_add) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", shape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  pir::Value out =
+      use_add ? builder.Build<paddle::dialect::AddOp>(x, x).result(0)
+              : builder.Build<paddle::dialect::SqrtOp>(x).result(0);
+  builder.Build<pir::ShadowOutputOp>(out, "out");
+  return paddle::dialect::PdOpLowerToKernelPass(&program);
+}
+
+TEST(StandaloneExecutor, program_structure_hash) {
+  auto program = BuildUnaryProgram({2, 3}, false);
+  // the same program traced with another input shape
+  auto reshaped_program = BuildUnaryProgram({4, 3}, false);
+  auto other_program = BuildUnaryProgram({2, 3}, true);
+  EXPECT_EQ(ProgramStructureHash(*program),
+            ProgramStructureHash(*reshaped_program));
+  EXPECT_NE(ProgramStructureHash(*program),
+            ProgramStructureHash(*other_program));
+}
+
 }  // namespace framework
 }  // namespace paddle
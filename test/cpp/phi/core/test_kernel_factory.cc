@@ -12,10 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_factory.h"
@@ -48,6 +51,18 @@ TEST(KernelFactory, SelectedKernelMap) {
   }
 }
 
+TEST(KernelFactory, KernelsVersion) {
+  const phi::KernelFactory& kernel_factory = phi::KernelFactory::Instance();
+  uint64_t version = kernel_factory.kernels_version();
+  // reading the kernels keeps the kernels cached by KernelSelectionCache
+  EXPECT_NE(kernel_factory.kernels().find("scale"),
+            kernel_factory.kernels().end());
+  EXPECT_EQ(kernel_factory.kernels_version(), version);
+
+  phi::KernelFactory::Instance().BumpKernelsVersion();
+  EXPECT_EQ(kernel_factory.kernels_version(), version + 1);
+}
+
 template <typename T, typename Context>
 void TestKernel(const Context& dev_ctx,
                 const DenseTensor& x,
@@ -72,6 +87,87 @@ TEST(KernelRegistry, SetFP32Input) {
   EXPECT_EQ(output_defs.at(0).dtype, phi::DataType::FLOAT16);
 }
 
+template <typename T, typename Context>
+void BindTestKernel(const Context& dev_ctx,
+                    const DenseTensor& x,
+                    float scale,
+                    const std::vector<int>& offsets,
+                    DenseTensor* out) {
+  out->Resize(x.dims());
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    out_data[i] = x.data<T>()[i] * scale + offsets.at(i);
+  }
+}
+
+template <typename T, typename Context>
+void OptionalBindTestKernel(const Context& dev_ctx UNUSED,
+                            const DenseTensor& x UNUSED,
+                            const paddle::optional<DenseTensor>& y UNUSED,
+                            DenseTensor* out UNUSED) {}
+
+TEST(KernelImpl, BindKernelCall) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  DenseTensor x, out;
+  x.Resize({2});
+  dev_ctx->Alloc<float>(&x)[0] = 1.0f;
+  x.data<float>()[1] = 2.0f;
+
+  phi::KernelContext ctx(dev_ctx);
+  ctx.EmplaceBackInput(&x);
+  ctx.EmplaceBackAttr(2.0f);
+  ctx.EmplaceBackAttr(std::vector<int>{10, 20});
+  ctx.EmplaceBackOutput(&out);
+  phi::Kernel kernel(PHI_KERNEL(BindTestKernel<float, phi::CPUContext>),
+                     nullptr);
+
+  std::function<void()> call;
+  ctx.SetBindTarget(&call);
+  kernel(&ctx);
+  ctx.SetBindTarget(nullptr);
+  ASSERT_TRUE(static_cast<bool>(call));
+  // Binding runs no kernel.
+  EXPECT_FALSE(out.initialized());
+
+  // The bound call reads the tensors of the context as they are then.
+  x.Resize({2});
+  dev_ctx->Alloc<float>(&x)[0] = 3.0f;
+  x.data<float>()[1] = 4.0f;
+  call();
+  EXPECT_EQ(out.data<float>()[0], 16.0f);
+  EXPECT_EQ(out.data<float>()[1], 28.0f);
+
+  // The same as the call on the context.
+  DenseTensor expected;
+  phi::KernelContext run_ctx(dev_ctx);
+  run_ctx.EmplaceBackInput(&x);
+  run_ctx.EmplaceBackAttr(2.0f);
+  run_ctx.EmplaceBackAttr(std::vector<int>{10, 20});
+  run_ctx.EmplaceBackOutput(&expected);
+  kernel(&run_ctx);
+  EXPECT_EQ(expected.data<float>()[0], out.data<float>()[0]);
+  EXPECT_EQ(expected.data<float>()[1], out.data<float>()[1]);
+}
+
+TEST(KernelImpl, BindKernelCallOfOptionalInput) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  DenseTensor x, out;
+  phi::KernelContext ctx(dev_ctx);
+  ctx.EmplaceBackInput(&x);
+  ctx.EmplaceBackInput(nullptr);
+  ctx.EmplaceBackOutput(&out);
+  phi::Kernel kernel(
+      PHI_KERNEL(OptionalBindTestKernel<float, phi::CPUContext>), nullptr);
+
+  std::function<void()> call;
+  ctx.SetBindTarget(&call);
+  kernel(&ctx);
+  ctx.SetBindTarget(nullptr);
+  EXPECT_FALSE(static_cast<bool>(call));
+}
+
 TEST(AttributeType, OStream) {
   std::ostringstream oss;
   oss << phi::AttributeType::UNDEFINED;
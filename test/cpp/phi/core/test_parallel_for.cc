@@ -0,0 +1,104 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "paddle/phi/core/parallel_for.h"
+
+namespace phi {
+namespace tests {
+
+TEST(ParallelFor, cover_range_once) {
+  SetIntraOpNumThreads(4);
+  std::vector<int> visited(100003, 0);
+  ParallelFor(0, visited.size(), 7, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      ++visited[i];
+    }
+  });
+  for (int count : visited) {
+    EXPECT_EQ(count, 1);
+  }
+  SetIntraOpNumThreads(1);
+}
+
+TEST(ParallelFor, serial_with_budget_of_one) {
+  SetIntraOpNumThreads(1);
+  int num_chunks = 0;
+  ParallelFor(0, 1000, 1, [&](int64_t begin, int64_t end) {
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 1000);
+    ++num_chunks;
+  });
+  EXPECT_EQ(num_chunks, 1);
+}
+
+TEST(ParallelFor, serial_within_grain_size) {
+  SetIntraOpNumThreads(4);
+  int num_chunks = 0;
+  ParallelFor(10, 20, 10, [&](int64_t begin, int64_t end) {
+    EXPECT_EQ(begin, 10);
+    EXPECT_EQ(end, 20);
+    ++num_chunks;
+  });
+  EXPECT_EQ(num_chunks, 1);
+  ParallelFor(0, 0, 1, [&](int64_t, int64_t) { ++num_chunks; });
+  EXPECT_EQ(num_chunks, 1);
+  SetIntraOpNumThreads(1);
+}
+
+TEST(ParallelFor, nested_loop_runs_serially) {
+  SetIntraOpNumThreads(4);
+  std::atomic<int64_t> sum{0};
+  ParallelFor(0, 64, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      int num_inner_chunks = 0;
+      ParallelFor(0, 100, 1, [&](int64_t inner_begin, int64_t inner_end) {
+        ++num_inner_chunks;
+        sum += inner_end - inner_begin;
+      });
+      EXPECT_EQ(num_inner_chunks, 1);
+    }
+  });
+  EXPECT_FALSE(InParallelRegion());
+  EXPECT_EQ(sum.load(), 6400);
+  SetIntraOpNumThreads(1);
+}
+
+TEST(ParallelFor, rethrow_exception) {
+  SetIntraOpNumThreads(4);
+  EXPECT_THROW(ParallelFor(0,
+                           1000,
+                           1,
+                           [](int64_t begin, int64_t end) {
+                             if (begin <= 500 && 500 < end) {
+                               throw std::runtime_error("chunk failed");
+                             }
+                           }),
+               std::runtime_error);
+  // The pool keeps running the later loops.
+  std::atomic<int64_t> count{0};
+  ParallelFor(0, 1000, 1, [&](int64_t begin, int64_t end) {
+    count += end - begin;
+  });
+  EXPECT_EQ(count.load(), 1000);
+  SetIntraOpNumThreads(1);
+}
+
+}  // namespace tests
+}  // namespace phi
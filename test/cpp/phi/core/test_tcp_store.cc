@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <future>
+
 #include "gtest/gtest.h"
 #include "paddle/phi/core/distributed/store/tcp_store.h"
 #include "paddle/phi/core/distributed/store/tcp_utils.h"
@@ -37,6 +40,29 @@ TEST(MasterDaemon, init) {
   d.reset();
 }
 
+TEST(TCPStore, WaitDoesNotBlockOtherCommands) {
+  TCPStore store("127.0.0.1", 61711, true, 1, 100);
+  auto waiting =
+      std::async(std::launch::async, [&store]() { store.wait("late"); });
+  // The wait holds its own connection, the other commands go on meanwhile.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto other = std::async(std::launch::async, [&store]() {
+    store.set("other", {1, 2, 3});
+    return store.check("late");
+  });
+  ASSERT_EQ(other.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  EXPECT_FALSE(other.get());
+  EXPECT_EQ(store.get("other"), std::vector<uint8_t>({1, 2, 3}));
+  EXPECT_EQ(waiting.wait_for(std::chrono::milliseconds(0)),
+            std::future_status::timeout);
+
+  store.set("late", {4});
+  ASSERT_EQ(waiting.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  EXPECT_EQ(store.get("late"), std::vector<uint8_t>({4}));
+}
+
 /* now for only c compile test
 TEST(TCPStore, init) {
   TCPStore store("127.0.0.1", 6170, true, 1);
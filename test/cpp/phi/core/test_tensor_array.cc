@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -118,5 +119,35 @@ TEST(tensor_array, tensor_array_init) {
   EXPECT_TRUE(tensor_array.initialized());
 }
 
+TEST(tensor_array, tensor_array_stacked_view) {
+  const DDim dims({4, 2});
+  const DataType dtype{DataType::INT8};
+  const DataLayout layout{DataLayout::NCHW};
+  DenseTensorMeta meta(dtype, dims, layout);
+
+  auto fancy_allocator = std::unique_ptr<Allocator>(new FancyAllocator);
+  auto storage = std::make_shared<TensorArray::Storage>();
+  storage->buffer.set_meta(meta);
+  storage->buffer.AllocateFrom(fancy_allocator.get(), dtype);
+  storage->rows = 3;
+
+  TensorArray tensor_array;
+  for (int64_t i = 0; i < 3; ++i) {
+    DenseTensor row = storage->buffer.Slice(i, i + 1);
+    row.Resize({2});
+    tensor_array.push_back(row);
+  }
+  tensor_array.set_storage(storage);
+
+  DenseTensor view;
+  EXPECT_TRUE(tensor_array.StackedView(&view));
+  EXPECT_EQ(view.dims(), DDim({3, 2}));
+  EXPECT_EQ(view.data(), storage->buffer.data());
+
+  // the tensors are no longer the rows in order
+  tensor_array.pop(0);
+  EXPECT_FALSE(tensor_array.StackedView(&view));
+}
+
 }  // namespace tests
 }  // namespace phi
@@ -0,0 +1,61 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/vocab/string_array.h"
+#include "paddle/phi/core/vocab/vocab_trie.h"
+
+namespace phi {
+namespace tests {
+
+TEST(vocab_trie, longest_match) {
+  VocabTrie trie({{L"un", 0},
+                  {L"una", 1},
+                  {L"##aff", 2},
+                  {L"##affable", 3},
+                  {L"##able", 4},
+                  {L"##", 5}});
+  std::int32_t id = -1;
+  std::wstring word = L"unaffable";
+
+  EXPECT_EQ(trie.LongestMatch(word, 0, false, &id), 3UL);
+  EXPECT_EQ(id, 1);
+  EXPECT_EQ(trie.LongestMatch(word, 2, true, &id), 7UL);
+  EXPECT_EQ(id, 3);
+  EXPECT_EQ(trie.LongestMatch(word, 3, true, &id), 0UL);
+  // the words do not match the continuing pieces
+  EXPECT_EQ(trie.LongestMatch(word, 2, false, &id), 0UL);
+  EXPECT_EQ(trie.LongestMatch(L"##aff", 0, false, &id), 2UL);
+  EXPECT_EQ(id, 5);
+}
+
+TEST(vocab_trie, reset_by_vocab) {
+  Vocab vocab;
+  vocab.emplace(L"ab", 0);
+  std::int32_t id = -1;
+  EXPECT_EQ(vocab.trie()->LongestMatch(L"abc", 0, false, &id), 2UL);
+  EXPECT_EQ(vocab.trie(), vocab.trie());
+
+  vocab.emplace(L"abc", 1);
+  EXPECT_EQ(vocab.trie()->LongestMatch(L"abc", 0, false, &id), 3UL);
+  EXPECT_EQ(id, 1);
+
+  vocab.clear();
+  EXPECT_EQ(vocab.trie()->LongestMatch(L"abc", 0, false, &id), 0UL);
+}
+
+}  // namespace tests
+}  // namespace phi
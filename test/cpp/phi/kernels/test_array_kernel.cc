@@ -0,0 +1,103 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/tensor_array.h"
+#include "paddle/phi/kernels/array_kernel.h"
+
+COMMON_DECLARE_bool(tensor_array_contiguous_storage);
+
+namespace phi {
+namespace tests {
+
+namespace {
+
+DenseTensor MakeRow(const CPUContext& dev_ctx, float value) {
+  DenseTensor x;
+  x.Resize({2});
+  float* data = dev_ctx.template Alloc<float>(&x);
+  data[0] = value;
+  data[1] = value * 10;
+  return x;
+}
+
+}  // namespace
+
+TEST(DEV_API, array_write_contiguous_storage) {
+  FLAGS_tensor_array_contiguous_storage = true;
+  auto* dev_ctx = static_cast<CPUContext*>(
+      DeviceContextPool::Instance().Get(phi::CPUPlace()));
+
+  TensorArray array;
+  std::vector<int64_t> capacities;
+  for (int64_t i = 0; i < 5; ++i) {
+    ArrayWriteKernel<float, CPUContext>(
+        *dev_ctx, array, MakeRow(*dev_ctx, i), Scalar(i), &array);
+    capacities.push_back(array.storage()->buffer.dims()[0]);
+  }
+  // the storage doubles when it is full
+  EXPECT_EQ(capacities, std::vector<int64_t>({1, 2, 4, 4, 8}));
+  ASSERT_EQ(array.size(), 5UL);
+  EXPECT_EQ(array.storage()->rows, 5UL);
+
+  // the rows written before the storage grew moved with it
+  const DenseTensor& buffer = array.storage()->buffer;
+  for (size_t i = 0; i < array.size(); ++i) {
+    EXPECT_TRUE(array[i].IsSharedBufferWith(buffer));
+    EXPECT_EQ(array[i].dims(), DDim({2}));
+    EXPECT_EQ(array[i].data<float>()[0], static_cast<float>(i));
+    EXPECT_EQ(array[i].data<float>()[1], static_cast<float>(i * 10));
+  }
+
+  DenseTensor out;
+  DenseTensor out_index;
+  ArrayToTensorKernel<float, CPUContext>(
+      *dev_ctx, array, 0, true, &out, &out_index);
+  EXPECT_EQ(out.dims(), DDim({5, 2}));
+  EXPECT_FALSE(out.IsSharedBufferWith(buffer));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(out.data<float>()[i * 2], static_cast<float>(i));
+  }
+
+  // an inplace op on the output leaves the array unchanged
+  out.data<float>()[0] = -1.f;
+  DenseTensor read;
+  ArrayReadKernel<float, CPUContext>(*dev_ctx, array, Scalar(0), &read);
+  EXPECT_EQ(read.data<float>()[0], 0.f);
+
+  // an overwritten tensor leaves the storage, and the array is stacked
+  ArrayWriteKernel<float, CPUContext>(
+      *dev_ctx, array, MakeRow(*dev_ctx, 100.f), Scalar(1), &array);
+  EXPECT_FALSE(array[1].IsSharedBufferWith(buffer));
+  EXPECT_EQ(buffer.data<float>()[2], 1.f);
+  DenseTensor view;
+  EXPECT_FALSE(array.StackedView(&view));
+  ArrayToTensorKernel<float, CPUContext>(
+      *dev_ctx, array, 0, true, &out, &out_index);
+  EXPECT_EQ(out.dims(), DDim({5, 2}));
+  EXPECT_EQ(out.data<float>()[2], 100.f);
+  EXPECT_EQ(out.data<float>()[4], 2.f);
+
+  FLAGS_tensor_array_contiguous_storage = false;
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -15,8 +15,14 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <functional>
+#include <map>
+#include <string>
+#include <vector>
 
+#include "paddle/phi/core/distributed/store/store.h"
 #include "paddle/phi/kernels/autotune/cache.h"
 
 #include "glog/logging.h"
@@ -66,3 +72,111 @@ TEST(AlgosCache, AlgosCache) {
   EXPECT_EQ(autotune_cache.CacheMisses(), 2);
   EXPECT_LT(std::abs(cache_hit_rate - autotune_cache.CacheHitRate()), 1e-5);
 }
+
+TEST(AlgosCache, SaveLoad) {
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  autotune_cache.Clean();
+  auto& transpose_cache =
+      autotune_cache.Get(phi::autotune::AlgorithmType::kTranspose);
+  auto& conv_cache =
+      autotune_cache.GetConv(phi::autotune::AlgorithmType::kConvBackwardData);
+  auto& matmul_cache = autotune_cache.GetMatmul();
+
+  const size_t transpose_key = 12345;
+  transpose_cache.Set(transpose_key, 2);
+  phi::autotune::ConvCacheKey conv_key({4, 32, 32, 3},
+                                       {8, 3, 3, 3},
+                                       {1, 1},
+                                       {1, 1},
+                                       {1, 1},
+                                       phi::DataType::FLOAT16,
+                                       1,
+                                       1);
+  phi::autotune::ConvAutoTuneResult conv_result(
+      static_cast<int64_t>(ConvAlgos::CuDNNKernel_2), 1024, true);
+  conv_cache.Set(conv_key, conv_result);
+  const size_t matmul_key = 67890;
+  const std::string algo("\x00\x7f\xff\x10", 4);
+  matmul_cache.SetSubKeyAlgo(matmul_key, algo.data(), algo.size());
+
+  const std::string path = "test_autotune_cache_file";
+  autotune_cache.Save(path);
+  autotune_cache.Clean();
+  EXPECT_EQ(conv_cache.Find(conv_key), false);
+  EXPECT_EQ(autotune_cache.Load(path), true);
+
+  EXPECT_EQ(transpose_cache.Find(transpose_key), true);
+  EXPECT_EQ(transpose_cache.Get(transpose_key), 2);
+  EXPECT_EQ(conv_cache.Find(conv_key), true);
+  auto result = conv_cache.Get(conv_key);
+  EXPECT_EQ(result.algo, ConvAlgos::CuDNNKernel_2);
+  EXPECT_EQ(result.workspace_size, 1024UL);
+  EXPECT_EQ(result.exhaustive_search, true);
+  EXPECT_EQ(matmul_cache.FindSubKeyAlgo(matmul_key), true);
+  std::string loaded(algo.size(), '\0');
+  matmul_cache.GetSubKeyAlgo(matmul_key, &loaded[0], loaded.size());
+  EXPECT_EQ(loaded, algo);
+
+  // the algorithms searched on another device are not loaded
+  {
+    std::ofstream os(path);
+    os << "paddle_autotune_cache 1\nanother device\n"
+       << "algo " << static_cast<int>(phi::autotune::AlgorithmType::kTranspose)
+       << " 1 1\n";
+  }
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), false);
+  EXPECT_EQ(transpose_cache.Find(1), false);
+  EXPECT_EQ(autotune_cache.Load(path + "_not_exist"), false);
+  std::remove(path.c_str());
+}
+
+TEST(AlgosCache, SaveMerges) {
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  autotune_cache.Clean();
+  auto& transpose_cache =
+      autotune_cache.Get(phi::autotune::AlgorithmType::kTranspose);
+  const std::string path = "test_autotune_cache_merge";
+  transpose_cache.Set(1, 1);
+  transpose_cache.Set(2, 2);
+  autotune_cache.Save(path);
+
+  // the cached algorithms win over the saved ones
+  autotune_cache.Clean();
+  transpose_cache.Set(1, 3);
+  autotune_cache.Save(path);
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), true);
+  EXPECT_EQ(transpose_cache.Get(1), 3);
+  EXPECT_EQ(transpose_cache.Get(2), 2);
+  std::remove(path.c_str());
+}
+
+class MemoryStore : public phi::distributed::Store {
+ public:
+  std::vector<uint8_t> get(const std::string& key) override {
+    return values_.at(key);
+  }
+  void set(const std::string& key,
+           const std::vector<uint8_t>& value) override {
+    values_[key] = value;
+  }
+
+ private:
+  std::map<std::string, std::vector<uint8_t>> values_;
+};
+
+TEST(AlgosCache, Share) {
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  autotune_cache.Clean();
+  auto& transpose_cache =
+      autotune_cache.Get(phi::autotune::AlgorithmType::kTranspose);
+  MemoryStore store;
+  transpose_cache.Set(7, 2);
+  autotune_cache.Share(&store, "autotune_cache_0", /*is_root=*/true);
+
+  autotune_cache.Clean();
+  transpose_cache.Set(7, 1);
+  autotune_cache.Share(&store, "autotune_cache_0", /*is_root=*/false);
+  EXPECT_EQ(transpose_cache.Get(7), 2);
+}
@@ -0,0 +1,225 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/core/parallel_for.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+#include "paddle/phi/kernels/funcs/elementwise_utils.h"
+#include "test/cpp/phi/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+constexpr int repeat = 20;
+
+struct BroadcastCase {
+  std::string name;
+  std::vector<int> x_dims;
+  std::vector<int> y_dims;
+};
+
+// The common broadcast shapes of the elementwise operators.
+const std::vector<BroadcastCase> kCases = {
+    {"same", {64, 128, 256}, {64, 128, 256}},
+    {"row", {64, 128, 256}, {1, 1, 256}},
+    {"column", {64, 128, 256}, {64, 128, 1}},
+    {"scalar", {64, 128, 256}, {1, 1, 1}},
+    {"middle", {64, 128, 256}, {1, 128, 1}},
+    {"outer", {64, 1, 256}, {1, 128, 1}},
+};
+
+std::vector<int> OutDims(const BroadcastCase& c) {
+  std::vector<int> out_dims(c.x_dims.size());
+  for (size_t i = 0; i < out_dims.size(); ++i) {
+    out_dims[i] = std::max(c.x_dims[i], c.y_dims[i]);
+  }
+  return out_dims;
+}
+
+int64_t Numel(const std::vector<int>& dims) {
+  int64_t numel = 1;
+  for (auto dim : dims) numel *= dim;
+  return numel;
+}
+
+std::vector<float> RandomVec(int64_t n) {
+  static unsigned int seed = 100;
+  std::mt19937 rng(seed++);
+  std::uniform_real_distribution<float> uniform_dist(-1.f, 1.f);
+  std::vector<float> vec(n);
+  for (auto& v : vec) v = uniform_dist(rng);
+  return vec;
+}
+
+// The per-element index computation CommonForwardBroadcastCPU used to run.
+template <typename Functor>
+void RefBroadcast(const BroadcastCase& c,
+                  const float* x,
+                  const float* y,
+                  float* out,
+                  Functor func) {
+  std::vector<int> out_dims = OutDims(c);
+  int max_dim = static_cast<int>(out_dims.size());
+  std::vector<int> index_array(max_dim, 0);
+  int64_t out_size = Numel(out_dims);
+  for (int64_t i = 0; i < out_size; ++i) {
+    int x_index =
+        funcs::GetElementwiseIndex(c.x_dims.data(), max_dim, index_array.data());
+    int y_index =
+        funcs::GetElementwiseIndex(c.y_dims.data(), max_dim, index_array.data());
+    out[i] = func(x[x_index], y[y_index]);
+    funcs::UpdateElementwiseIndexArray(
+        out_dims.data(), max_dim, index_array.data());
+  }
+}
+
+template <typename Functor>
+void BenchmarkBroadcast(const std::string& op_name, Functor func) {
+  for (const auto& c : kCases) {
+    std::vector<int> out_dims = OutDims(c);
+    int max_dim = static_cast<int>(out_dims.size());
+    auto x = RandomVec(Numel(c.x_dims));
+    auto y = RandomVec(Numel(c.y_dims));
+    std::vector<float> ref(Numel(out_dims));
+    std::vector<float> out(Numel(out_dims));
+
+    phi::tests::Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat; ++i) {
+      RefBroadcast(c, x.data(), y.data(), ref.data(), func);
+    }
+    double ref_cost = timer.toc() / repeat;
+
+    timer.tic();
+    for (int i = 0; i < repeat; ++i) {
+      funcs::CPUBroadcastForward(x.data(),
+                                 y.data(),
+                                 out.data(),
+                                 c.x_dims.data(),
+                                 c.y_dims.data(),
+                                 out_dims.data(),
+                                 max_dim,
+                                 func,
+                                 true);
+    }
+    double cost = timer.toc() / repeat;
+
+    for (size_t i = 0; i < out.size(); ++i) {
+      ASSERT_FLOAT_EQ(out[i], ref[i]) << op_name << " " << c.name << " " << i;
+    }
+    LOG(INFO) << op_name << " broadcast of " << c.name << " with "
+              << phi::GetIntraOpNumThreads() << " threads: " << cost
+              << " ms, per-element index: " << ref_cost << " ms";
+  }
+}
+
+TEST(CPUBroadcast, add) {
+  BenchmarkBroadcast("add", funcs::AddFunctor<float>());
+}
+
+TEST(CPUBroadcast, multiply) {
+  BenchmarkBroadcast("multiply", funcs::MultiplyFunctor<float>());
+}
+
+TEST(CPUBroadcast, subtract) {
+  BenchmarkBroadcast("subtract", funcs::SubtractFunctor<float>());
+}
+
+TEST(CPUBroadcast, subtract_parallel) {
+  phi::SetIntraOpNumThreads(4);
+  BenchmarkBroadcast("subtract", funcs::SubtractFunctor<float>());
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(CPUBroadcast, swap_inputs) {
+  BroadcastCase c = {"column", {4, 8}, {4, 1}};
+  std::vector<int> out_dims = OutDims(c);
+  auto x = RandomVec(32);
+  auto y = RandomVec(4);
+  std::vector<float> out(32);
+  // The inputs are passed to the functor as (y, x).
+  funcs::CPUBroadcastForward(x.data(),
+                             y.data(),
+                             out.data(),
+                             c.x_dims.data(),
+                             c.y_dims.data(),
+                             out_dims.data(),
+                             2,
+                             funcs::SubtractFunctor<float>(),
+                             false);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      EXPECT_FLOAT_EQ(out[i * 8 + j], y[i] - x[i * 8 + j]);
+    }
+  }
+}
+
+TEST(CPUBroadcast, strided_inputs) {
+  // x is the transpose of a [8, 4] matrix, y is every other column of a
+  // [1, 16] row broadcast to the rows of out.
+  auto x = RandomVec(32);
+  auto y = RandomVec(16);
+  std::vector<float> out(32);
+  funcs::CPUBroadcastDims dims({4, 8}, {1, 4}, {0, 2});
+  funcs::CPUBroadcast<false>(
+      dims, x.data(), y.data(), out.data(), funcs::SubtractFunctor<float>());
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      EXPECT_FLOAT_EQ(out[i * 8 + j], x[j * 4 + i] - y[j * 2]);
+    }
+  }
+}
+
+TEST(CPUBroadcast, strided_dims_merged) {
+  funcs::CPUBroadcastDims dims({2, 3, 4, 5}, {60, 20, 5, 1}, {0, 0, 5, 1});
+  ASSERT_EQ(dims.Rank(), 2);
+  EXPECT_EQ(dims.out_dims, std::vector<int64_t>({6, 20}));
+  EXPECT_EQ(dims.x_strides, std::vector<int64_t>({20, 1}));
+  EXPECT_EQ(dims.y_strides, std::vector<int64_t>({0, 1}));
+
+  // The outermost dim of a slice with steps is never merged.
+  funcs::CPUBroadcastDims sliced({2, 3, 4, 5}, {120, 20, 5, 1}, {0, 0, 5, 1});
+  ASSERT_EQ(sliced.Rank(), 3);
+  EXPECT_EQ(sliced.out_dims, std::vector<int64_t>({2, 3, 20}));
+  EXPECT_EQ(sliced.x_strides, std::vector<int64_t>({120, 20, 1}));
+}
+
+TEST(CPUBroadcast, strided_transform) {
+  // The view of the columns 1 and 2 of each [3, 4] matrix of a [2, 3, 4]
+  // tensor.
+  auto x = RandomVec(24);
+  std::vector<double> out(12);
+  funcs::CPUStridedTransform(x.data() + 1,
+                             {2, 3, 2},
+                             {12, 4, 1},
+                             out.data(),
+                             [](const float& a) { return 2.0 * a; });
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 2; ++k) {
+        EXPECT_DOUBLE_EQ(out[(i * 3 + j) * 2 + k],
+                         2.0 * x[i * 12 + j * 4 + k + 1]);
+      }
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,187 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/cudnn_lstm_grad_kernel.h"
+#include "paddle/phi/kernels/cudnn_lstm_kernel.h"
+
+namespace phi {
+
+constexpr int kSeqLength = 6;
+constexpr int kInputSize = 8;
+constexpr int kHiddenSize = 8;
+constexpr int kWeightNumel =
+    4 * kHiddenSize * (kInputSize + kHiddenSize) + 8 * kHiddenSize;
+
+struct LSTMResult {
+  std::vector<float> out;
+  std::vector<float> last_h;
+  std::vector<float> last_c;
+  std::vector<float> x_grad;
+};
+
+DenseTensor ToTensor(const GPUContext &ctx,
+                     const std::vector<float> &data,
+                     const DDim &dims) {
+  DenseTensor tensor;
+  TensorFromVector(data, ctx, &tensor);
+  tensor.Resize(dims);
+  return tensor;
+}
+
+std::vector<float> ToVector(const GPUContext &ctx, const DenseTensor &tensor) {
+  std::vector<float> data;
+  TensorToVector(tensor, ctx, &data);
+  ctx.Wait();
+  return data;
+}
+
+// Runs the forward and the backward of a one layer LSTM, whose steps after
+// the sequence length of a batch are zero.
+LSTMResult RunLSTM(const GPUContext &ctx,
+                   const std::vector<int> &lengths,
+                   const DenseTensor &weight,
+                   DenseTensor *state_out) {
+  int batch_size = static_cast<int>(lengths.size());
+  std::mt19937 engine(batch_size);
+  std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+  std::vector<float> x_data(kSeqLength * batch_size * kInputSize);
+  for (int t = 0; t < kSeqLength; ++t) {
+    for (int b = 0; b < batch_size; ++b) {
+      for (int i = 0; i < kInputSize; ++i) {
+        x_data[(t * batch_size + b) * kInputSize + i] =
+            t < lengths[b] ? dist(engine) : 0.0f;
+      }
+    }
+  }
+  auto x = ToTensor(ctx, x_data, {kSeqLength, batch_size, kInputSize});
+  std::vector<float> zeros(batch_size * kHiddenSize, 0.0f);
+  auto init_h = ToTensor(ctx, zeros, {1, batch_size, kHiddenSize});
+  auto init_c = ToTensor(ctx, zeros, {1, batch_size, kHiddenSize});
+  DenseTensor sequence_length;
+  TensorFromVector(lengths, ctx, &sequence_length);
+  std::vector<const DenseTensor *> weight_list{&weight};
+
+  DenseTensor out, last_h, last_c, reserve;
+  out.Resize({kSeqLength, batch_size, kHiddenSize});
+  last_h.Resize({1, batch_size, kHiddenSize});
+  last_c.Resize({1, batch_size, kHiddenSize});
+  CudnnLSTMKernel<float, GPUContext>(ctx,
+                                     x,
+                                     init_h,
+                                     init_c,
+                                     paddle::none,
+                                     weight_list,
+                                     sequence_length,
+                                     0.0f,
+                                     false,
+                                     kHiddenSize,
+                                     1,
+                                     false,
+                                     0,
+                                     &out,
+                                     &last_h,
+                                     &last_c,
+                                     &reserve,
+                                     state_out);
+
+  std::vector<float> ones(out.numel(), 1.0f);
+  auto out_grad = ToTensor(ctx, ones, out.dims());
+  auto last_h_grad = ToTensor(ctx, zeros, last_h.dims());
+  auto last_c_grad = ToTensor(ctx, zeros, last_c.dims());
+  DenseTensor x_grad, init_h_grad, init_c_grad, weight_grad;
+  weight_grad.Resize(weight.dims());
+  CudnnLSTMGradKernel<float, GPUContext>(ctx,
+                                         x,
+                                         init_h,
+                                         init_c,
+                                         weight_list,
+                                         sequence_length,
+                                         out,
+                                         reserve,
+                                         *state_out,
+                                         out_grad,
+                                         last_h_grad,
+                                         last_c_grad,
+                                         0.0f,
+                                         false,
+                                         kHiddenSize,
+                                         1,
+                                         false,
+                                         0,
+                                         &x_grad,
+                                         &init_h_grad,
+                                         &init_c_grad,
+                                         {&weight_grad});
+
+  LSTMResult result;
+  result.out = ToVector(ctx, out);
+  result.last_h = ToVector(ctx, last_h);
+  result.last_c = ToVector(ctx, last_c);
+  result.x_grad = ToVector(ctx, x_grad);
+  return result;
+}
+
+void ExpectNear(const std::vector<float> &expected,
+                const std::vector<float> &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 1e-5) << "at " << i;
+  }
+}
+
+TEST(CudnnLSTMKernel, ReuseDescriptorsOfDropoutState) {
+  const auto &ctx = *static_cast<const GPUContext *>(
+      DeviceContextPool::Instance().Get(GPUPlace(0)));
+  std::mt19937 engine(2024);
+  std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+  std::vector<float> weight_data(kWeightNumel);
+  for (auto &value : weight_data) {
+    value = dist(engine);
+  }
+  auto weight = ToTensor(ctx, weight_data, {kWeightNumel});
+
+  // the same shape with other lengths, then another batch size
+  std::vector<std::vector<int>> cases{
+      {6, 5, 4, 3}, {6, 6, 6, 6}, {6, 2}, {6, 5, 4, 3}};
+  std::vector<LSTMResult> expected;
+  for (const auto &lengths : cases) {
+    // the descriptors of an uninitialized state are not cached
+    DenseTensor state_out;
+    expected.push_back(RunLSTM(ctx, lengths, weight, &state_out));
+  }
+
+  // the calls after the first one share the initialized state, and get
+  // the descriptors of their lengths from the cache
+  DenseTensor state_out;
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < cases.size(); ++i) {
+      auto result = RunLSTM(ctx, cases[i], weight, &state_out);
+      ASSERT_TRUE(state_out.initialized());
+      ExpectNear(expected[i].out, result.out);
+      ExpectNear(expected[i].last_h, result.last_h);
+      ExpectNear(expected[i].last_c, result.last_c);
+      ExpectNear(expected[i].x_grad, result.x_grad);
+    }
+  }
+}
+
+}  // namespace phi
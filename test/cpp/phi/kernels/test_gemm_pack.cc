@@ -0,0 +1,115 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/gemm_pack.h"
+
+namespace phi {
+namespace tests {
+
+DenseTensor MakeWeight(const CPUContext& dev_ctx, const DDim& dims) {
+  DenseTensor w;
+  w.Resize(dims);
+  float* data = dev_ctx.Alloc<float>(&w);
+  for (int64_t i = 0; i < w.numel(); ++i) {
+    data[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  return w;
+}
+
+const CPUContext& GetCPUContext() {
+  return *static_cast<const CPUContext*>(
+      DeviceContextPool::Instance().Get(CPUPlace()));
+}
+
+TEST(gemm_pack, packed_weight_lookup) {
+  const auto& dev_ctx = GetCPUContext();
+  DenseTensor w = MakeWeight(dev_ctx, {4, 3});
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(w, false, false), nullptr);
+
+  auto properties = std::make_unique<CPUPackedGemmStorageProperties>();
+  auto packed = std::make_shared<std::vector<float>>(12);
+  properties->packed_data = std::shared_ptr<void>(packed, packed->data());
+  properties->src = w.data();
+  properties->src_dims = w.dims();
+  w.set_storage_properties(std::move(properties));
+  EXPECT_TRUE(w.storage_properties_initialized());
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(w, false, false),
+            packed->data());
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(w, false, true), nullptr);
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(w, true, false), nullptr);
+
+  // The copies share the packed matrix, which serves the shape packed only.
+  DenseTensor copy = w;
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(copy, false, false),
+            packed->data());
+  copy.Resize({3, 4});
+  EXPECT_EQ(funcs::GetPackedGemmWeight<float>(copy, false, false), nullptr);
+}
+
+#ifdef PADDLE_WITH_MKLML
+TEST(gemm_pack, packed_gemm) {
+  const auto& dev_ctx = GetCPUContext();
+  const int M = 5, N = 6, K = 7;
+  DenseTensor x = MakeWeight(dev_ctx, {M, K});
+  const float* x_data = x.data<float>();
+  for (bool trans : {false, true}) {
+    // out = x * op(w) with w packed as the B matrix.
+    DenseTensor w = MakeWeight(dev_ctx, trans ? DDim{N, K} : DDim{K, N});
+    ASSERT_TRUE(funcs::PackGemmWeight<float>(dev_ctx, false, trans, &w));
+    EXPECT_FALSE(funcs::PackGemmWeight<float>(dev_ctx, false, trans, &w));
+    const float* packed = funcs::GetPackedGemmWeight<float>(w, false, trans);
+    ASSERT_NE(packed, nullptr);
+    std::vector<float> out(M * N);
+    funcs::PackedGemm<float>(
+        dev_ctx, false, M, N, K, packed, x_data, out.data());
+    const float* w_data = w.data<float>();
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < N; ++j) {
+        float expected = 0;
+        for (int k = 0; k < K; ++k) {
+          expected += x_data[i * K + k] *
+                      (trans ? w_data[j * K + k] : w_data[k * N + j]);
+        }
+        EXPECT_FLOAT_EQ(out[i * N + j], expected);
+      }
+    }
+  }
+
+  // out = w * x with the filter w of [N, ...] packed as the A matrix.
+  DenseTensor filter = MakeWeight(dev_ctx, {N, M, 1, 1});
+  ASSERT_TRUE(funcs::PackGemmWeight<float>(dev_ctx, true, false, &filter));
+  const float* packed = funcs::GetPackedGemmWeight<float>(filter, true, false);
+  ASSERT_NE(packed, nullptr);
+  std::vector<float> out(N * K);
+  funcs::PackedGemm<float>(dev_ctx, true, N, K, M, packed, x_data, out.data());
+  const float* filter_data = filter.data<float>();
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < K; ++j) {
+      float expected = 0;
+      for (int k = 0; k < M; ++k) {
+        expected += filter_data[i * M + k] * x_data[k * K + j];
+      }
+      EXPECT_FLOAT_EQ(out[i * K + j], expected);
+    }
+  }
+}
+#endif
+
+}  // namespace tests
+}  // namespace phi
@@ -14,6 +14,7 @@
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <filesystem>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -23,7 +24,9 @@
 #include "paddle/cinn/hlir/dialect/operator/ir/cinn_op.h"
 #include "paddle/cinn/hlir/dialect/operator/ir/op_attribute.h"
 #include "paddle/cinn/hlir/dialect/operator/ir/op_dialect.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
 #include "paddle/cinn/hlir/framework/pir/compilation_task.h"
+#include "paddle/cinn/hlir/framework/pir/fusion_info.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
@@ -33,8 +36,14 @@
 #include "paddle/pir/include/core/program.h"
 
 PD_DECLARE_bool(cinn_bucket_compile);
+PD_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(cinn_compile_cache_dir);
+PD_DECLARE_bool(cinn_async_compile);
 
+using cinn::hlir::framework::PersistentCompilationCache;
+using cinn::hlir::framework::PirCompiler;
 using cinn::hlir::framework::pir::CompatibleInfo;
+using cinn::hlir::framework::pir::FusionInfo;
 using cinn::hlir::framework::pir::OpLoweringGroup;
 using cinn::hlir::framework::pir::OpLoweringGroupPtr;
 
@@ -61,6 +70,75 @@ ProgramInfo BuildProgram(std::vector<int64_t> input_shape) {
   return {program, groups};
 }
 
+TEST(FusionInfo, Fingerprint) {
+  // the programs own the ops of the groups
+  auto prog_info_a = BuildProgram({64, 128});
+  auto prog_info_b = BuildProgram({64, 128});
+  auto prog_info_c = BuildProgram({32, 128});
+  auto groups_a = std::get<1>(prog_info_a);
+  auto groups_b = std::get<1>(prog_info_b);
+  auto groups_c = std::get<1>(prog_info_c);
+  ASSERT_EQ(groups_a.size(), 1u);
+
+  const std::string fingerprint_a = FusionInfo(*groups_a[0]).Fingerprint();
+  LOG(INFO) << fingerprint_a;
+  // same program built twice, the fingerprint doesn't depend on the addresses
+  // of the ops
+  EXPECT_EQ(fingerprint_a, FusionInfo(*groups_b[0]).Fingerprint());
+  EXPECT_NE(fingerprint_a, FusionInfo(*groups_c[0]).Fingerprint());
+}
+
+size_t NumCacheFiles(const std::string& dir) {
+  size_t num = 0;
+  for (const auto& file : std::filesystem::directory_iterator(dir)) {
+    num += file.path().extension() == ".cinn";
+  }
+  return num;
+}
+
+TEST(PersistentCompilationCache, SaveAndLoad) {
+  const std::string cache_dir = "./cinn_compile_cache_test";
+  std::filesystem::remove_all(cache_dir);
+  FLAGS_enable_cinn_compile_cache = true;
+  FLAGS_cinn_compile_cache_dir = cache_dir;
+  FLAGS_cinn_async_compile = false;
+  auto& cache = PersistentCompilationCache::Instance();
+  auto target = cinn::common::DefaultNVGPUTarget();
+
+  auto prog_info = BuildProgram({64, 128});
+  auto groups = std::get<1>(prog_info);
+  PirCompiler compiler(target);
+  auto kernel_infos = compiler.Build(groups);
+  ASSERT_EQ(kernel_infos.size(), 1u);
+  EXPECT_EQ(NumCacheFiles(cache_dir), 1u);
+
+  // as a new process, the same group built again is read from the file
+  cache.Clear();
+  auto same_prog_info = BuildProgram({64, 128});
+  auto same_groups = std::get<1>(same_prog_info);
+  auto result = cache.Load(FusionInfo(*same_groups[0]), target);
+  ASSERT_NE(result, nullptr);
+  auto kernel_info = result->GetKernelInfo();
+  EXPECT_EQ(kernel_info.fn_name, kernel_infos[0].fn_name);
+  EXPECT_NE(kernel_info.fn_ptr, nullptr);
+  EXPECT_NE(kernel_info.infer_shape_fn_ptr, nullptr);
+
+  auto other_prog_info = BuildProgram({32, 128});
+  auto other_groups = std::get<1>(other_prog_info);
+  EXPECT_EQ(cache.Load(FusionInfo(*other_groups[0]), target), nullptr);
+
+  // a truncated file is ignored, the group is compiled again
+  for (const auto& file : std::filesystem::directory_iterator(cache_dir)) {
+    std::filesystem::resize_file(file.path(), 16);
+  }
+  cache.Clear();
+  EXPECT_EQ(cache.Load(FusionInfo(*same_groups[0]), target), nullptr);
+
+  cache.Clear();
+  FLAGS_cinn_compile_cache_dir = "";
+  std::filesystem::remove_all(cache_dir);
+}
+
 // TODO(LiuYang): This test is temporarily
 // TEST(CompilationTask, Basic) {
 //   FLAGS_cinn_bucket_compile = true;
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/cinn/hlir/framework/pir/trivial_op_impl.h"
+#include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+
+namespace cinn {
+namespace ir {
+
+namespace {
+
+std::shared_ptr<FusionGroupInfo> MakeGroupInfo(
+    const std::vector<int64_t>& loop_ranges, bool can_apply_grid_reduce) {
+  auto group_info = std::make_shared<FusionGroupInfo>();
+  group_info->loop_ranges = loop_ranges;
+  group_info->loop_strides = std::vector<int64_t>(loop_ranges.size(), 1);
+  group_info->reduce_axis = {static_cast<int64_t>(loop_ranges.size()) - 1};
+  group_info->reduce_var_name = {"var_1"};
+  group_info->can_apply_grid_reduce = can_apply_grid_reduce;
+  return group_info;
+}
+
+const BucketInfo::Dimension& ReduceDim(const BucketInfo& bucket_info) {
+  return bucket_info.space.back();
+}
+
+}  // namespace
+
+TEST(DynamicReduceConfig, dynamic_spatial_and_reduce) {
+  // e.g. a layer norm over a dynamic batch and hidden size
+  auto configs = BuildScheduleConfig(MakeGroupInfo({-1, -1}, false),
+                                     common::DefaultNVGPUTarget());
+  ASSERT_EQ(configs.size(), 3UL);
+  for (const auto& [bucket_info, config] : configs) {
+    const auto& reduce_dim = ReduceDim(bucket_info);
+    EXPECT_EQ(reduce_dim.iter_type, "R");
+    EXPECT_TRUE(reduce_dim.is_dynamic);
+    const auto& method = config.tile_config.reduce_method;
+    if (reduce_dim.upper_bound <= 256) {
+      EXPECT_EQ(reduce_dim.lower_bound, 1);
+      EXPECT_TRUE(std::holds_alternative<WarpReduceMethod>(method));
+    } else {
+      EXPECT_TRUE(std::holds_alternative<BlockReduceMethod>(method));
+    }
+    EXPECT_EQ(config.tile_config.grid_reduce_num, 1);
+  }
+}
+
+TEST(DynamicReduceConfig, grid_reduce_for_few_rows) {
+  auto configs = BuildScheduleConfig(MakeGroupInfo({-1, -1}, true),
+                                     common::DefaultNVGPUTarget());
+  ASSERT_EQ(configs.size(), 5UL);
+  int num_grid_reduce = 0;
+  for (const auto& [bucket_info, config] : configs) {
+    if (config.tile_config.grid_reduce_num > 1) {
+      ++num_grid_reduce;
+      EXPECT_EQ(bucket_info.space.front().lower_bound, 1);
+      EXPECT_GT(ReduceDim(bucket_info).lower_bound, 2048);
+    }
+  }
+  EXPECT_EQ(num_grid_reduce, 1);
+
+  // Too many static rows to split the reduce of each to several blocks.
+  configs = BuildScheduleConfig(MakeGroupInfo({65536, -1}, true),
+                                common::DefaultNVGPUTarget());
+  ASSERT_EQ(configs.size(), 3UL);
+  for (const auto& [bucket_info, config] : configs) {
+    EXPECT_EQ(config.tile_config.grid_reduce_num, 1);
+  }
+}
+
+}  // namespace ir
+}  // namespace cinn
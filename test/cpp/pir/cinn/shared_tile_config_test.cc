@@ -0,0 +1,77 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/shared_database.h"
+
+namespace cinn {
+namespace ir {
+
+ScheduleConfig::TileConfig MakeTileConfig(int64_t warp_num,
+                                          int64_t tree_reduce_num,
+                                          int64_t spatial_inner_num) {
+  ScheduleConfig::TileConfig config;
+  config.warp_num = warp_num;
+  config.tree_reduce_num = tree_reduce_num;
+  config.spatial_inner_num = spatial_inner_num;
+  return config;
+}
+
+TEST(SharedTileConfigDatabase, merge_workers) {
+  const std::string root_dir = "./shared_tile_config_test";
+  std::system(("rm -rf " + root_dir).c_str());
+  auto target = common::DefaultTarget();
+  IterSpaceType iter_space_type = {{"S", "static"}, {"R", "static"}};
+  BucketInfo bucket_a{1024, 1024, 256, 256, false, false};
+  BucketInfo bucket_b{2048, 2048, 256, 256, false, false};
+
+  SharedTileConfigDatabase worker_0(root_dir, "v1", /* read_only = */ false);
+  SharedTileConfigDatabase worker_1(root_dir, "v1", /* read_only = */ false);
+  worker_0.AddConfig(target, bucket_a, MakeTileConfig(8, 32, 1), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  // The newer config of the same priority wins.
+  worker_1.AddConfig(target, bucket_a, MakeTileConfig(4, 32, 2), 1);
+  // The config of the lower priority value wins.
+  worker_1.AddConfig(target, bucket_b, MakeTileConfig(16, 64, 1), 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  worker_0.AddConfig(target, bucket_b, MakeTileConfig(2, 32, 1), 1);
+
+  SharedTileConfigDatabase production(root_dir, "v1", /* read_only = */ true);
+  TileConfigMap configs = production.GetConfigs(target, iter_space_type);
+  ASSERT_EQ(configs.size(), 2UL);
+  bucket_a.bucket_priority = 0;
+  bucket_b.bucket_priority = 0;
+  EXPECT_EQ(configs.at(bucket_a).warp_num, 4);
+  EXPECT_EQ(configs.at(bucket_a).spatial_inner_num, 2);
+  EXPECT_EQ(configs.at(bucket_b).warp_num, 16);
+
+  // The read only database drops the added configs.
+  production.AddConfig(target, bucket_a, MakeTileConfig(1, 32, 1), 0);
+  EXPECT_EQ(worker_0.GetConfigs(target, iter_space_type).at(bucket_a).warp_num,
+            4);
+
+  // The other versions are separated.
+  SharedTileConfigDatabase other_version(root_dir, "v2", true);
+  EXPECT_TRUE(other_version.GetConfigs(target, iter_space_type).empty());
+  std::system(("rm -rf " + root_dir).c_str());
+}
+
+}  // namespace ir
+}  // namespace cinn
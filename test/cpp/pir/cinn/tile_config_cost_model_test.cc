@@ -0,0 +1,106 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/cinn/ir/group_schedule/config/tile_config_cost_model.h"
+
+namespace cinn {
+namespace ir {
+
+ScheduleConfig::TileConfig MakeTileConfig(int64_t warp_num,
+                                          int64_t tree_reduce_num,
+                                          int64_t spatial_inner_num) {
+  ScheduleConfig::TileConfig config;
+  config.warp_num = warp_num;
+  config.tree_reduce_num = tree_reduce_num;
+  config.spatial_inner_num = spatial_inner_num;
+  return config;
+}
+
+TEST(TileConfigCostModel, candidates_are_valid) {
+  BucketInfo reduce_bucket{/* sp_lower_bound = */ 1024,
+                           /* sp_upper_bound = */ 1024,
+                           /* rb_lower_bound = */ 4096,
+                           /* rb_upper_bound = */ 4096,
+                           /* sp_is_dynamic = */ false,
+                           /* rb_is_dynamic = */ false};
+  auto candidates = GenerateTileConfigCandidates(reduce_bucket);
+  ASSERT_FALSE(candidates.empty());
+  for (const auto& config : candidates) {
+    EXPECT_LE(config.warp_num * 32, 1024);
+    EXPECT_GE(config.tree_reduce_num, 32);
+    EXPECT_EQ(config.warp_num * 32 % config.tree_reduce_num, 0);
+  }
+
+  BucketInfo spatial_bucket{/* sp_lower_bound = */ 1,
+                            /* sp_upper_bound = */ 1023,
+                            /* rb_lower_bound = */ 1,
+                            /* rb_upper_bound = */ 1,
+                            /* sp_is_dynamic = */ true,
+                            /* rb_is_dynamic = */ false};
+  for (const auto& config : GenerateTileConfigCandidates(spatial_bucket)) {
+    EXPECT_EQ(config.tree_reduce_num, 1);
+    EXPECT_TRUE(std::holds_alternative<NoneReduceMethod>(config.reduce_method));
+  }
+}
+
+TEST(TileConfigCostModel, analytical_parallelizes_large_reduce) {
+  AnalyticalTileConfigCostModel model{TileConfigDeviceSpec()};
+  BucketInfo bucket{/* sp_lower_bound = */ 1,
+                    /* sp_upper_bound = */ 1,
+                    /* rb_lower_bound = */ 65536,
+                    /* rb_upper_bound = */ 65536,
+                    /* sp_is_dynamic = */ false,
+                    /* rb_is_dynamic = */ false};
+  // A single block reduces all, so its threads should share the reduction.
+  EXPECT_LT(model.Predict(bucket, MakeTileConfig(32, 1024, 1)),
+            model.Predict(bucket, MakeTileConfig(1, 32, 1)));
+
+  auto candidates = GenerateTileConfigCandidates(bucket);
+  auto top = model.TopK(bucket, candidates, 3);
+  ASSERT_EQ(top.size(), 3UL);
+  EXPECT_LE(model.Predict(bucket, candidates[top[0]]),
+            model.Predict(bucket, candidates[top[1]]));
+  EXPECT_EQ(candidates[top[0]].tree_reduce_num, 1024);
+}
+
+TEST(TileConfigCostModel, online_learns_measurements) {
+  TileConfigDeviceSpec device;
+  AnalyticalTileConfigCostModel analytical{device};
+  OnlineTileConfigCostModel model{device};
+  BucketInfo bucket{/* sp_lower_bound = */ 4096,
+                    /* sp_upper_bound = */ 4096,
+                    /* rb_lower_bound = */ 1024,
+                    /* rb_upper_bound = */ 1024,
+                    /* sp_is_dynamic = */ false,
+                    /* rb_is_dynamic = */ false};
+  auto fast = MakeTileConfig(1, 32, 1);
+  auto slow = MakeTileConfig(32, 1024, 1);
+  // Predicts the analytical estimate before training.
+  EXPECT_NEAR(model.Predict(bucket, fast),
+              analytical.Predict(bucket, fast),
+              1e-6 * analytical.Predict(bucket, fast));
+
+  for (int i = 0; i < 20; ++i) {
+    model.Update(bucket, fast, 10.0);
+    model.Update(bucket, slow, 100.0);
+  }
+  EXPECT_EQ(model.num_samples(), 40);
+  EXPECT_LT(model.Predict(bucket, fast), model.Predict(bucket, slow));
+  EXPECT_NEAR(model.Predict(bucket, fast), 10.0, 1.0);
+}
+
+}  // namespace ir
+}  // namespace cinn
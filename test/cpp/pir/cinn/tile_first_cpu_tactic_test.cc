@@ -0,0 +1,150 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/tactic/tile_first_cpu_tactic.h"
+
+#include <gtest/gtest.h>
+
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/ir_printer.h"
+#include "paddle/cinn/ir/op/ir_operators.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_int32(cinn_cpu_vector_bits);
+
+namespace cinn {
+namespace ir {
+
+ScheduleContext CpuScheduleContext(int64_t data_rank,
+                                   const std::vector<int64_t>& reduce_axis,
+                                   const std::vector<int64_t>& loop_strides) {
+  ScheduleContext context;
+  context.target = common::DefaultHostTarget();
+  context.config.base_info = std::make_shared<ScheduleConfig::BaseInfo>();
+  context.config.base_info->data_rank = data_rank;
+  context.config.base_info->reduce_axis = reduce_axis;
+  context.config.base_info->loop_strides = loop_strides;
+  return context;
+}
+
+std::vector<ir::Expr> ApplyCpuTactic(ScheduleContext* context,
+                                     const std::vector<ir::Tensor>& tensors,
+                                     const ir::Tensor& output,
+                                     const std::string& block_id) {
+  ast_gen_ius::TensorGroup tensor_group(tensors);
+  auto func = lang::LowerToAst("cpu_tactic_test", {output}, &tensor_group);
+  ir::ModuleExpr mod_expr({func->body});
+  ir::IRSchedule ir_sch(mod_expr);
+
+  auto tactic = CreateTileFirstCpuTactic();
+  tactic->Init(context);
+  tactic->Apply(&ir_sch, block_id);
+  VLOG(6) << "After TileFirstCpuTactic: " << ir_sch.GetModule().GetExprs()[0];
+  return ir_sch.GetLoops(block_id);
+}
+
+int64_t Extent(const ir::Expr& loop) {
+  return loop.As<ir::For>()->extent.as_int64();
+}
+
+TEST(TileFirstCpuTactic, ParallelVectorizeElementwise) {
+  Context::Global().ResetNameId();
+  FLAGS_cinn_cpu_vector_bits = 256;
+
+  Placeholder<float> A("A", {Expr(64), Expr(128)});
+  ir::Tensor B = Compute(
+      {Expr(64), Expr(128)},
+      [&](Var i, Var j) { return lang::Exp(A(i, j)); },
+      "B");
+  auto context = CpuScheduleContext(2, {}, {});
+  auto loops = ApplyCpuTactic(&context, {A, B}, B, "B");
+
+  // [64, 128] => [8192] => [1024 parallel, 8 vectorized]
+  ASSERT_EQ(loops.size(), 2UL);
+  EXPECT_EQ(Extent(loops[0]), 1024);
+  EXPECT_TRUE(loops[0].As<ir::For>()->is_parallel());
+  EXPECT_EQ(Extent(loops[1]), 8);
+  EXPECT_TRUE(loops[1].As<ir::For>()->is_vectorized());
+  EXPECT_EQ(loops[1].As<ir::For>()->vectorize_info().factor, 8);
+  FLAGS_cinn_cpu_vector_bits = 0;
+}
+
+TEST(TileFirstCpuTactic, SerialSmallLoop) {
+  Context::Global().ResetNameId();
+  FLAGS_cinn_cpu_vector_bits = 128;
+
+  Placeholder<float> A("A", {Expr(4), Expr(16)});
+  ir::Tensor B = Compute(
+      {Expr(4), Expr(16)},
+      [&](Var i, Var j) { return lang::Exp(A(i, j)); },
+      "B");
+  auto context = CpuScheduleContext(2, {}, {});
+  auto loops = ApplyCpuTactic(&context, {A, B}, B, "B");
+
+  // too few elements to be worth the threads, still vectorized
+  ASSERT_EQ(loops.size(), 2UL);
+  EXPECT_EQ(Extent(loops[0]), 16);
+  EXPECT_FALSE(loops[0].As<ir::For>()->is_parallel());
+  EXPECT_EQ(Extent(loops[1]), 4);
+  EXPECT_TRUE(loops[1].As<ir::For>()->is_vectorized());
+  FLAGS_cinn_cpu_vector_bits = 0;
+}
+
+TEST(TileFirstCpuTactic, NotVectorizeIndivisibleLoop) {
+  Context::Global().ResetNameId();
+  FLAGS_cinn_cpu_vector_bits = 256;
+
+  Placeholder<float> A("A", {Expr(9), Expr(1001)});
+  ir::Tensor B = Compute(
+      {Expr(9), Expr(1001)},
+      [&](Var i, Var j) { return lang::Exp(A(i, j)); },
+      "B");
+  auto context = CpuScheduleContext(2, {}, {});
+  auto loops = ApplyCpuTactic(&context, {A, B}, B, "B");
+
+  ASSERT_EQ(loops.size(), 1UL);
+  EXPECT_EQ(Extent(loops[0]), 9009);
+  EXPECT_FALSE(loops[0].As<ir::For>()->is_vectorized());
+  EXPECT_TRUE(loops[0].As<ir::For>()->is_parallel());
+  FLAGS_cinn_cpu_vector_bits = 0;
+}
+
+TEST(TileFirstCpuTactic, TileDiscreteReduce) {
+  Context::Global().ResetNameId();
+
+  // reduces the columns of A, the spatial loop is the continuous one
+  Placeholder<float> A("A", {Expr(32), Expr(1024)});
+  Var reduce_k(32, "reduce_k");
+  ir::Tensor B = Compute(
+      {Expr(1024)},
+      [&](Var j) { return lang::ReduceSum(A(reduce_k, j), {reduce_k}); },
+      "B");
+  auto context = CpuScheduleContext(2, {1}, {1, 1024});
+  auto loops = ApplyCpuTactic(&context, {A, B}, B, "B");
+
+  // [1024, 32] => [64 parallel, 16 floats of a cache line, 32]
+  ASSERT_EQ(loops.size(), 3UL);
+  EXPECT_EQ(Extent(loops[0]), 64);
+  EXPECT_TRUE(loops[0].As<ir::For>()->is_parallel());
+  EXPECT_EQ(Extent(loops[1]), 16);
+  EXPECT_EQ(Extent(loops[2]), 32);
+  for (const auto& loop : loops) {
+    EXPECT_FALSE(loop.As<ir::For>()->is_vectorized());
+  }
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_attribute.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_attribute.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/pir/transforms/general/remove_redundant_transfer_pass.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/builtin_type.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/pass/pass_manager.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+
+using paddle::dialect::AllocatedDenseTensorType;
+
+namespace {
+
+// Appends a cast of in to dtype, as inserted by PdOpLowerToKernelPass.
+pir::Value AddCast(pir::Block* block, pir::Value in, phi::DataType dtype) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  auto in_type = in.type().dyn_cast<AllocatedDenseTensorType>();
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU,
+      phi::DataLayout::ALL_LAYOUT,
+      paddle::dialect::TransToPhiDataType(in_type.dtype()));
+  pir::AttributeMap attributes = {
+      {"op_name", pir::StrAttribute::get(ctx, "pd_op.cast")},
+      {"kernel_name", pir::StrAttribute::get(ctx, "cast")},
+      {"kernel_key", paddle::dialect::KernelAttribute::get(ctx, kernel_key)},
+      {"dtype", paddle::dialect::DataTypeAttribute::get(ctx, dtype)}};
+  auto out_type = AllocatedDenseTensorType::get(
+      ctx,
+      in_type.place(),
+      paddle::dialect::TransToIrDataType(dtype, ctx),
+      in_type.dims(),
+      in_type.data_layout(),
+      in_type.lod(),
+      in_type.offset());
+  pir::Operation* op = pir::Operation::Create(
+      {in},
+      attributes,
+      {out_type},
+      ctx->GetRegisteredOpInfo(paddle::dialect::PhiKernelOp::name()));
+  block->push_back(op);
+  return op->result(0);
+}
+
+size_t NumCasts(const pir::Block& block) {
+  size_t num_casts = 0;
+  for (const auto& op : block) {
+    if (op.isa<paddle::dialect::PhiKernelOp>() &&
+        op.attribute<pir::StrAttribute>("op_name").AsString() ==
+            "pd_op.cast") {
+      ++num_casts;
+    }
+  }
+  return num_casts;
+}
+
+}  // namespace
+
+TEST(remove_redundant_transfer_pass, duplicate_and_round_trip) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<paddle::dialect::KernelDialect>();
+
+  pir::Program program(ctx);
+  pir::Builder builder(ctx, program.block());
+  builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{4, 8}, 1.0, phi::DataType::FLOAT32);
+  auto kernel_program =
+      paddle::dialect::PdOpLowerToKernelPass(&program, phi::CPUPlace());
+
+  pir::Block* block = kernel_program->block();
+  pir::Value x = block->back().result(0);
+  pir::Value first = AddCast(block, x, phi::DataType::FLOAT64);
+  pir::Value second = AddCast(block, x, phi::DataType::FLOAT64);
+  pir::Value round_trip = AddCast(block, first, phi::DataType::FLOAT32);
+  // A lossy round trip is kept.
+  pir::Value half = AddCast(block, x, phi::DataType::FLOAT16);
+  pir::Value lossy = AddCast(block, half, phi::DataType::FLOAT32);
+  pir::Builder kernel_builder(ctx, block);
+  auto combine_op = kernel_builder.Build<pir::CombineOp>(
+      std::vector<pir::Value>{second, round_trip, lossy});
+  EXPECT_EQ(NumCasts(*block), 5u);
+
+  pir::PassManager pm(ctx);
+  pm.AddPass(pir::CreateRemoveRedundantTransferPass());
+  pm.Run(kernel_program.get());
+
+  EXPECT_EQ(NumCasts(*block), 3u);
+  EXPECT_EQ(combine_op->operand_source(0), first);
+  EXPECT_EQ(combine_op->operand_source(1), x);
+  EXPECT_EQ(combine_op->operand_source(2), lossy);
+}
@@ -56,6 +56,55 @@ TEST(layout_transformation_interface_test, operator) {
   EXPECT_EQ(layout_transformation_iface.RelevantOutputs(fused_conv).size(), 1u);
 }
 
+TEST(layout_transformation_interface_test, conv2d_amp) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Program program(ctx);
+  pir::Builder builder(ctx, program.block());
+
+  auto build_input_value = [&](std::vector<int64_t> shape,
+                               phi::DataType dtype) {
+    return builder
+        .Build<paddle::dialect::UniformOp>(
+            shape, dtype, 0.0, 1.0, 2, phi::CPUPlace())
+        .out();
+  };
+  auto prefer_conv_layout = [&](phi::DataType dtype,
+                                std::vector<int64_t> input_shape,
+                                std::vector<int64_t> filter_shape) {
+    auto conv = builder.Build<paddle::dialect::Conv2dOp>(
+        build_input_value(input_shape, dtype),
+        build_input_value(filter_shape, dtype));
+    auto iface =
+        conv->dyn_cast<paddle::dialect::LayoutTransformationInterface>();
+    return iface.PreferLayout(conv);
+  };
+
+  // the Tensor Cores take the channels aligned to 8 of both AMP dtypes
+  EXPECT_EQ(
+      prefer_conv_layout(phi::DataType::FLOAT16, {2, 8, 8, 8}, {16, 8, 3, 3}),
+      common::DataLayout::NHWC);
+  EXPECT_EQ(
+      prefer_conv_layout(phi::DataType::BFLOAT16, {2, 8, 8, 8}, {16, 8, 3, 3}),
+      common::DataLayout::NHWC);
+  EXPECT_EQ(
+      prefer_conv_layout(phi::DataType::FLOAT16, {2, 3, 8, 8}, {16, 3, 3, 3}),
+      common::DataLayout::NCHW);
+  EXPECT_EQ(
+      prefer_conv_layout(phi::DataType::FLOAT32, {2, 8, 8, 8}, {16, 8, 3, 3}),
+      common::DataLayout::NCHW);
+
+  auto fused_conv = builder.Build<paddle::dialect::FusedConv2dAddActOp>(
+      build_input_value({2, 8, 8, 8}, phi::DataType::BFLOAT16),
+      build_input_value({16, 8, 3, 3}, phi::DataType::BFLOAT16),
+      build_input_value({16}, phi::DataType::BFLOAT16),
+      build_input_value({2, 16, 6, 6}, phi::DataType::BFLOAT16));
+  auto fused_iface =
+      fused_conv->dyn_cast<paddle::dialect::LayoutTransformationInterface>();
+  EXPECT_EQ(fused_iface.PreferLayout(fused_conv), common::DataLayout::NHWC);
+}
+
 TEST(immutable_layout_trait_test, operator) {
   pir::IrContext *ctx = pir::IrContext::Instance();
   ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <thread>
 #include "glog/logging.h"
 
 // NOTE(zhangbo9674): File pd_op.h is generated by op_gen.py, see details in
@@ -25,6 +28,7 @@
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_dialect.h"
 #include "paddle/pir/include/core/builtin_op.h"
 #include "paddle/pir/include/core/builtin_type.h"
@@ -312,3 +316,74 @@ TEST(pass_manager, PassManager) {
       true,
       common::errors::InvalidArgument("Program not run. Expected run."));
 }
+
+struct ParallelPassState {
+  std::mutex mutex;
+  std::map<pir::Operation *, std::thread::id> threads;
+  int num_clones = 0;
+};
+
+class OpLocalTestPass : public pir::Pass {
+ public:
+  explicit OpLocalTestPass(ParallelPassState *state)
+      : pir::Pass("OpLocalTestPass", 1), state_(state) {}
+
+  bool IsOpLocal() const override { return true; }
+
+  std::unique_ptr<pir::Pass> Clone() const override {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    ++state_->num_clones;
+    return std::make_unique<OpLocalTestPass>(state_);
+  }
+
+  void Run(pir::Operation *op) override {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    EXPECT_EQ(state_->threads.count(op), 0u);
+    state_->threads[op] = std::this_thread::get_id();
+  }
+
+  bool CanApplyOn(pir::Operation *op) const override {
+    return op->isa<pir::GroupOp>();
+  }
+
+ private:
+  ParallelPassState *state_;
+};
+
+TEST(pass_manager, ParallelOpLocalPass) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // the first two groups use a common value defined above them
+  pir::Value shared_value =
+      builder
+          .Build<pir::ConstantOp>(pir::Int32Attribute::get(ctx, 0),
+                                  builder.int32_type())
+          .out();
+  constexpr size_t kNumGroups = 8;
+  std::vector<pir::Operation *> groups;
+  for (size_t i = 0; i < kNumGroups; ++i) {
+    builder.SetInsertionPointToBlockEnd(program.block());
+    auto group = builder.Build<pir::GroupOp>(std::vector<pir::Type>{});
+    groups.push_back(group.operation());
+    builder.SetInsertionPointToBlockEnd(group.block());
+    pir::Value input =
+        i < 2 ? shared_value
+              : builder
+                    .Build<pir::ConstantOp>(pir::Int32Attribute::get(ctx, 1),
+                                            builder.int32_type())
+                    .out();
+    builder.Build<pir::CombineOp>(std::vector<pir::Value>{input});
+  }
+
+  ParallelPassState state;
+  pir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<OpLocalTestPass>(&state));
+  pm.EnableParallel(4);
+  EXPECT_TRUE(pm.Run(&program));
+
+  EXPECT_EQ(state.num_clones, 4);
+  EXPECT_EQ(state.threads.size(), kNumGroups);
+  EXPECT_EQ(state.threads.at(groups[0]), state.threads.at(groups[1]));
+}
@@ -431,6 +431,50 @@ TEST(pattern_rewrite, Patterns) {
   EXPECT_EQ(program.block()->size(), 17u);
 }
 
+TEST(pattern_rewrite, WorklistStatistics) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  auto full_op =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 3, 4},
+                                             1.5,
+                                             phi::DataType::FLOAT32,
+                                             phi::CPUPlace());
+  auto transpose1_op = builder.Build<paddle::dialect::TransposeOp>(
+      full_op.out(), std::vector<int>{1, 2, 0});
+  auto transpose2_op = builder.Build<paddle::dialect::TransposeOp>(
+      transpose1_op.out(), std::vector<int>{2, 0, 1});
+  auto transpose3_op = builder.Build<paddle::dialect::TransposeOp>(
+      transpose2_op.out(), std::vector<int>{0, 2, 1});
+  auto fetch_op =
+      builder.Build<paddle::dialect::FetchOp>(transpose3_op.out(), "out", 0);
+
+  pir::RewritePatternSet ps(ctx);
+  ps.Add<RedundantTransposeFusePattern>(ctx);
+  pir::FrozenRewritePatternSet patterns(std::move(ps));
+  pir::PatternStatisticsMap statistics;
+  pir::GreedyRewriteConfig config;
+  config.use_top_down_traversal = true;
+  // the rewritten transposes are revisited without another scan
+  config.max_iterations = 1;
+  config.pattern_statistics = &statistics;
+  auto [converged, num_rewrites] =
+      pir::ApplyPatternsGreedily(program.module_op(), patterns, config);
+
+  EXPECT_TRUE(converged);
+  EXPECT_EQ(num_rewrites, 2);
+  auto fused_op = pir::GetDefiningOpForInput(fetch_op, 0)
+                      ->dyn_cast<paddle::dialect::TransposeOp>();
+  ASSERT_TRUE(fused_op);
+  EXPECT_EQ(pir::GetDefiningOpForInput(fused_op, 0), full_op.operation());
+  ASSERT_EQ(statistics.size(), 1u);
+  EXPECT_EQ(statistics.begin()->second.num_hits, 2);
+  EXPECT_GE(statistics.begin()->second.num_attempts, 4);
+}
+
 void BuildConstantFoldingProgram(pir::Program *program,
                                  pir::IrContext *ctx,
                                  paddle::framework::Scope *scope) {
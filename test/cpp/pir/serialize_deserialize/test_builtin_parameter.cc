@@ -16,9 +16,12 @@
 #include <gtest/gtest.h>
 #include <memory>
 
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/pir/include/core/builtin_dialect.h"
 #include "paddle/pir/include/core/operation.h"
 #include "paddle/pir/include/core/program.h"
@@ -60,3 +63,39 @@ TEST(SaveTest, uncompelteted_parameter) {
   EXPECT_EQ(new_op.attribute("stop_gradient").isa<pir::ArrayAttribute>(), true);
   EXPECT_EQ(new_op.attribute("trainable").isa<pir::ArrayAttribute>(), true);
 }
+
+TEST(SaveTest, lowered_program_binary) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<paddle::dialect::KernelDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  auto full_op = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.5, phi::DataType::FLOAT32, phi::CPUPlace());
+  builder.Build<paddle::dialect::ScaleOp>(full_op.out(), 2.0, 1.0, true);
+  auto kernel_program =
+      paddle::dialect::PdOpLowerToKernelPass(&program, phi::CPUPlace());
+
+  pir::WriteModule(*kernel_program,
+                   "./test_lowered_program",
+                   /*pir_version*/ 0,
+                   true,
+                   false,
+                   true,
+                   /*binary*/ true);
+
+  pir::Program new_program(ctx);
+  pir::ReadModule("./test_lowered_program", &new_program, /*pir_version*/ 0);
+
+  ASSERT_EQ(new_program.block()->size(), kernel_program->block()->size());
+  auto old_it = kernel_program->block()->begin();
+  for (auto& new_op : *new_program.block()) {
+    EXPECT_EQ(new_op.name(), old_it->name());
+    EXPECT_EQ(new_op.attribute("kernel_key"), old_it->attribute("kernel_key"));
+    EXPECT_EQ(new_op.result(0).type(), old_it->result(0).type());
+    EXPECT_TRUE(new_op.result(0)
+                    .type()
+                    .isa<paddle::dialect::AllocatedDenseTensorType>());
+    ++old_it;
+  }
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/utils/string/number_parser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// The inputs, copied at the end of a page as well to check the loads.
+class PageBuffer {
+ public:
+  PageBuffer() : buffer_(3 * 4096) {}
+
+  const char* Put(const std::string& str, bool at_page_end) {
+    char* page = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(buffer_.data()) + 4095) & ~4095ULL);
+    char* dst = at_page_end ? page + 4096 - str.size() - 1 : page;
+    memcpy(dst, str.c_str(), str.size() + 1);
+    return dst;
+  }
+
+ private:
+  std::vector<char> buffer_;
+};
+
+const char* SkipTokensReference(const char* p, int n) {
+  if (n <= 0) {
+    return p;
+  }
+  bool prev_sep = true;
+  for (; *p != '\0'; ++p) {
+    bool is_sep = *p == ' ' || *p == '\t';
+    if (is_sep && !prev_sep && --n == 0) {
+      return p;
+    }
+    prev_sep = is_sep;
+  }
+  return p;
+}
+
+std::vector<std::string> Inputs() {
+  std::vector<std::string> inputs = {
+      "0",     "1",     "12345678",   "123456789",       " 42 7",
+      "-1",    "+3",    "1.5",        "-0.125",          ".5",
+      "5.",    "1e-05", "3.4e38",     "1e39",            "1e-50",
+      "0x1F",  "inf",   "-nan",       "1e",              "1e+",
+      "abc",   "",      " ",          "\t9",             "00000000000000000001",
+      "18446744073709551615",         "18446744073709551616",
+      "99999999999999999999999",      "0.1234567890123456789",
+      "16777217",                     "1234.5678 9"};
+  std::mt19937_64 rng(0);
+  const char alphabet[] = "0123456789.-+eExn \t";
+  for (int i = 0; i < 20000; ++i) {
+    char buf[64];
+    switch (i % 4) {
+      case 0:
+        inputs.emplace_back(std::to_string(rng() >> (rng() % 64)));
+        break;
+      case 1:
+        snprintf(buf,
+                 sizeof(buf),
+                 "%.*g",
+                 static_cast<int>(rng() % 10) + 1,
+                 static_cast<double>(static_cast<int64_t>(rng())) /
+                     static_cast<double>(1ULL << (rng() % 62)));
+        inputs.emplace_back(buf);
+        break;
+      case 2:
+        snprintf(buf,
+                 sizeof(buf),
+                 "%.*f",
+                 static_cast<int>(rng() % 8),
+                 static_cast<double>(rng() % 100000000) /
+                     static_cast<double>(1 + rng() % 100000));
+        inputs.emplace_back(buf);
+        break;
+      default: {
+        std::string str;
+        for (size_t j = rng() % 24; j > 0; --j) {
+          str += alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        inputs.emplace_back(str);
+      }
+    }
+  }
+  return inputs;
+}
+
+}  // namespace
+
+TEST(NumberParser, MatchesStrtoull) {
+  PageBuffer buffer;
+  for (auto& input : Inputs()) {
+    for (bool at_page_end : {false, true}) {
+      const char* str = buffer.Put(input, at_page_end);
+      char* expected_end = nullptr;
+      char* end = nullptr;
+      uint64_t expected = strtoull(str, &expected_end, 10);
+      EXPECT_EQ(paddle::string::fast_strtoull(str, &end), expected) << input;
+      EXPECT_EQ(end, expected_end) << input;
+    }
+  }
+}
+
+TEST(NumberParser, MatchesStrtof) {
+  PageBuffer buffer;
+  for (auto& input : Inputs()) {
+    for (bool at_page_end : {false, true}) {
+      const char* str = buffer.Put(input, at_page_end);
+      char* expected_end = nullptr;
+      char* end = nullptr;
+      float expected = strtof(str, &expected_end);
+      float value = paddle::string::fast_strtof(str, &end);
+      if (expected != expected) {
+        EXPECT_NE(value, value) << input;
+      } else {
+        EXPECT_EQ(memcmp(&value, &expected, sizeof(float)), 0) << input;
+      }
+      EXPECT_EQ(end, expected_end) << input;
+    }
+  }
+}
+
+TEST(NumberParser, SkipTokens) {
+  PageBuffer buffer;
+  std::mt19937_64 rng(0);
+  std::vector<std::string> inputs = Inputs();
+  for (int i = 0; i < 2000; ++i) {
+    std::string str;
+    for (size_t j = rng() % 300; j > 0; --j) {
+      str += " \t0123456789"[rng() % (rng() % 2 ? 3 : 12)];
+    }
+    inputs.emplace_back(str);
+  }
+  for (auto& input : inputs) {
+    for (bool at_page_end : {false, true}) {
+      const char* str = buffer.Put(input, at_page_end);
+      for (int n = 0; n < 64; n += 3) {
+        EXPECT_EQ(paddle::string::skip_tokens(str, n),
+                  SkipTokensReference(str, n))
+            << input << " " << n;
+      }
+    }
+  }
+  const char* line = "3 1 22 333 1 4";
+  EXPECT_STREQ(paddle::string::skip_tokens(line + 1, 3), " 1 4");
+}
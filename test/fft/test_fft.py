@@ -1934,5 +1934,41 @@ class TestIfftShift(unittest.TestCase):
             )
 
 
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(), "the FFT plans are cached on GPU"
+)
+class TestFftPlanReuseAcrossBatch(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_fft_plan_reuse_across_batch': True})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_fft_plan_reuse_across_batch': False})
+
+    def test_batch_sizes(self):
+        # each batch of 13 is executed by the plans of 8, 4 and 1
+        for batch in [13, 8, 5]:
+            x = np.random.randn(batch, 16).astype('float64')
+            c = x + 1.0j * np.random.randn(batch, 16)
+            with paddle.base.dygraph.guard(paddle.CUDAPlace(0)):
+                np.testing.assert_allclose(
+                    paddle.fft.rfft(paddle.to_tensor(x)).numpy(),
+                    scipy.fft.rfft(x),
+                    rtol=RTOL['float64'],
+                    atol=ATOL['float64'],
+                )
+                np.testing.assert_allclose(
+                    paddle.fft.ifft(paddle.to_tensor(c)).numpy(),
+                    scipy.fft.ifft(c),
+                    rtol=RTOL['complex128'],
+                    atol=1e-12,
+                )
+                np.testing.assert_allclose(
+                    paddle.fft.irfft(paddle.to_tensor(c)).numpy(),
+                    scipy.fft.irfft(c),
+                    rtol=RTOL['complex128'],
+                    atol=1e-12,
+                )
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,68 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import sys
+import unittest
+from os.path import dirname
+
+import numpy as np
+
+# The dynamic dimensions of the buckets are also compiled for these values.
+os.environ['FLAGS_cinn_bucket_specialize_values'] = '128,1000'
+
+import paddle
+from paddle.static import InputSpec
+
+sys.path.append(dirname(dirname(__file__)))
+
+import utils
+
+
+class ExpSum(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, x, axis):
+        return paddle.sum(paddle.exp(x), axis=axis)
+
+
+class TestBucketSpecialize(unittest.TestCase):
+    def setUp(self):
+        paddle.seed(2024)
+        self.input_spec = [InputSpec(shape=[None, 256], dtype='float32')]
+        # the specialized values and the values of the generic buckets
+        self.rows = [128, 1000, 127, 129, 64, 4096]
+
+    def check(self, axis):
+        net = utils.apply_to_static(ExpSum(), True, self.input_spec)
+        net.eval()
+        for row in self.rows:
+            x = paddle.randn([row, 256], dtype='float32') * 0.1
+            cinn_out = net(x, axis)
+            dy_out = ExpSum()(x, axis)
+            np.testing.assert_allclose(
+                cinn_out.numpy(), dy_out.numpy(), atol=1e-4, rtol=1e-5
+            )
+        utils.check_jit_kernel_number(net.forward, 1)
+
+    def test_specialize_spatial(self):
+        self.check(axis=-1)
+
+    def test_specialize_reduce(self):
+        self.check(axis=0)
+
+
+if __name__ == '__main__':
+    unittest.main()
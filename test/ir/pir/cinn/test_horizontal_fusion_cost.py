@@ -0,0 +1,82 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+import utils
+
+import paddle
+
+# NOTE(SigureMo): Disable the CSE optimization to avoid op number change.
+paddle.set_flags({"FLAGS_enable_cse_in_dy2st": False})
+
+
+class IndependentReduceSubGraph(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, x):
+        tmp1 = paddle.sum(x, axis=-1)
+        tmp2 = paddle.sum(x * x, axis=-1)
+        return tmp1, tmp2
+
+
+class TestHorizontalFusionCost(unittest.TestCase):
+    def setUp(self):
+        paddle.seed(2024)
+        self.max_registers = paddle.get_flags(
+            "FLAGS_cinn_horizontal_fusion_max_registers"
+        )["FLAGS_cinn_horizontal_fusion_max_registers"]
+        self.x = paddle.randn([256, 128], dtype="float32")
+        self.x.stop_gradient = True
+
+    def tearDown(self):
+        paddle.set_flags(
+            {"FLAGS_cinn_horizontal_fusion_max_registers": self.max_registers}
+        )
+
+    def eval(self, use_cinn, kernel_number=None):
+        net = IndependentReduceSubGraph()
+        net.eval()
+        net = utils.apply_to_static(net, use_cinn)
+        out = net(self.x)
+        if use_cinn:
+            utils.check_jit_kernel_number(net.forward, kernel_number)
+        return out
+
+    def check_eval(self, kernel_number):
+        cinn_outs = self.eval(use_cinn=True, kernel_number=kernel_number)
+        dy_outs = self.eval(use_cinn=False)
+        for cinn_out, dy_out in zip(cinn_outs, dy_outs):
+            np.testing.assert_allclose(
+                cinn_out.numpy(), dy_out.numpy(), atol=1e-5, rtol=1e-5
+            )
+
+    def test_fuse_within_registers(self):
+        paddle.set_flags({"FLAGS_cinn_horizontal_fusion_max_registers": 128})
+        self.check_eval(kernel_number=1)
+
+    def test_not_fuse_above_registers(self):
+        # each reduction alone needs more than one register
+        paddle.set_flags({"FLAGS_cinn_horizontal_fusion_max_registers": 1})
+        self.check_eval(kernel_number=2)
+
+    def test_disable_estimate(self):
+        paddle.set_flags({"FLAGS_cinn_horizontal_fusion_max_registers": 0})
+        self.check_eval(kernel_number=1)
+
+
+if __name__ == '__main__':
+    unittest.main()
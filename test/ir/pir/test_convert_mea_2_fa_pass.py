@@ -108,5 +108,116 @@ class TestConvertMEA2FA(PassTest):
         self.places.append(paddle.CUDAPlace(0))
 
 
+@unittest.skipIf(
+    not is_flashattn_supported(),
+    "core is not compiled with CUDA and cuda version need larger than or equal to 11.4"
+    "and device's compute capability must be 8.x or 90",
+)
+class TestFoldScaleIntoMEA(PassTest):
+    r"""
+    The query scaled by 1 / sqrt(head_dim) outside of the attention, whose
+    scale is 1, is folded into the default scale and converted to flash
+    attention.
+    """
+
+    def is_program_valid(self, program=None):
+        return True
+
+    def sample_program(self):
+        with paddle.pir_utils.IrGuard():
+            main_prog = paddle.static.Program()
+            start_prog = paddle.static.Program()
+            with paddle.pir.core.program_guard(main_prog, start_prog):
+                q = paddle.static.data(
+                    name='q', shape=[2, 8, 32, 128], dtype="float16"
+                )
+                k = paddle.static.data(
+                    name='k', shape=[2, 8, 32, 128], dtype="float16"
+                )
+                v = paddle.static.data(
+                    name='v', shape=[2, 8, 32, 128], dtype="float16"
+                )
+
+                scaled_q = paddle.scale(q, scale=1.0 / np.sqrt(128))
+                out, _ = memory_efficient_attention(
+                    scaled_q, k, v, scale=1.0, training=False
+                )
+                self.pass_attr_list = [{'convert_MEA_to_FA': {}}]
+                self.feeds = {
+                    "q": np.random.random((2, 8, 32, 128)).astype("float16"),
+                    "k": np.random.random((2, 8, 32, 128)).astype("float16"),
+                    "v": np.random.random((2, 8, 32, 128)).astype("float16"),
+                }
+                self.fetch_list = [out]
+                self.valid_op_map = {
+                    "pd_op.scale": 0,
+                    "pd_op.memory_efficient_attention": 0,
+                    "pd_op.flash_attn": 1,
+                }
+                yield [main_prog, start_prog], False
+
+    def test_check_output(self):
+        if core.is_compiled_with_cuda():
+            self.check_pass_correct()
+
+    def setUp(self):
+        self.places.append(paddle.CUDAPlace(0))
+
+
+@unittest.skipIf(
+    not is_flashattn_supported(),
+    "core is not compiled with CUDA and cuda version need larger than or equal to 11.4"
+    "and device's compute capability must be 8.x or 90",
+)
+class TestFoldScaleIntoMEANonDefault(PassTest):
+    r"""
+    The scale of the key is folded into the attention, which keeps a scale
+    other than the default one and so is not converted to flash attention.
+    """
+
+    def is_program_valid(self, program=None):
+        return True
+
+    def sample_program(self):
+        with paddle.pir_utils.IrGuard():
+            main_prog = paddle.static.Program()
+            start_prog = paddle.static.Program()
+            with paddle.pir.core.program_guard(main_prog, start_prog):
+                q = paddle.static.data(
+                    name='q', shape=[2, 8, 32, 128], dtype="float16"
+                )
+                k = paddle.static.data(
+                    name='k', shape=[2, 8, 32, 128], dtype="float16"
+                )
+                v = paddle.static.data(
+                    name='v', shape=[2, 8, 32, 128], dtype="float16"
+                )
+
+                scaled_k = paddle.scale(k, scale=0.5)
+                out, _ = memory_efficient_attention(
+                    q, scaled_k, v, training=False
+                )
+                self.pass_attr_list = [{'convert_MEA_to_FA': {}}]
+                self.feeds = {
+                    "q": np.random.random((2, 8, 32, 128)).astype("float16"),
+                    "k": np.random.random((2, 8, 32, 128)).astype("float16"),
+                    "v": np.random.random((2, 8, 32, 128)).astype("float16"),
+                }
+                self.fetch_list = [out]
+                self.valid_op_map = {
+                    "pd_op.scale": 0,
+                    "pd_op.memory_efficient_attention": 1,
+                    "pd_op.flash_attn": 0,
+                }
+                yield [main_prog, start_prog], False
+
+    def test_check_output(self):
+        if core.is_compiled_with_cuda():
+            self.check_pass_correct()
+
+    def setUp(self):
+        self.places.append(paddle.CUDAPlace(0))
+
+
 if __name__ == "__main__":
     unittest.main()
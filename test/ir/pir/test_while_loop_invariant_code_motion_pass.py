@@ -0,0 +1,129 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+from contextlib import contextmanager
+
+import numpy as np
+
+import paddle
+from paddle import pir
+
+paddle.enable_static()
+
+
+@contextmanager
+def flags_guard(flags):
+    old_flags = paddle.get_flags(list(flags.keys()))
+    paddle.set_flags(flags)
+    try:
+        yield
+    finally:
+        paddle.set_flags(old_flags)
+
+
+def build_program():
+    main_program = paddle.static.Program()
+    startup_program = paddle.static.Program()
+    with paddle.static.program_guard(main_program, startup_program):
+        w = paddle.static.data("w", [8, 8], dtype="float32")
+        x = paddle.static.data("x", [4, 8], dtype="float32")
+        i = paddle.full([1], 0, dtype="int64")
+        n = paddle.full([1], 5, dtype="int64")
+
+        def cond(i, x):
+            return i < n
+
+        def body(i, x):
+            # the same in every iteration
+            scale = paddle.full([1], 0.5, dtype="float32")
+            ww = paddle.matmul(w, w) * scale
+            x = paddle.tanh(paddle.matmul(x, ww) + 1.0)
+            return [i + 1, x]
+
+        _, out = paddle.static.nn.while_loop(cond, body, [i, x])
+    return main_program, out
+
+
+def count_ops(block, op_name):
+    return len([op for op in block.ops if op.name() == op_name])
+
+
+class TestWhileLoopInvariantCodeMotionPass(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(2024)
+        self.w = np.random.uniform(-0.3, 0.3, [8, 8]).astype("float32")
+        self.x = np.random.uniform(-1, 1, [4, 8]).astype("float32")
+
+    def test_hoist(self):
+        main_program, _ = build_program()
+        block = main_program.global_block()
+        while_op = block.ops[-1]
+        body = while_op.as_while_op().body()
+        self.assertEqual(count_ops(body, "pd_op.matmul"), 2)
+
+        pm = pir.PassManager()
+        pm.add_pass("while_loop_invariant_code_motion_pass", {})
+        pm.run(main_program)
+
+        # the matmul of x is carried by the loop and stays in the body
+        self.assertEqual(count_ops(body, "pd_op.matmul"), 1)
+        self.assertEqual(count_ops(body, "pd_op.full"), 0)
+        self.assertEqual(count_ops(block, "pd_op.matmul"), 1)
+        self.assertEqual(count_ops(body, "pd_op.tanh"), 1)
+
+    def run_program(self, flags):
+        with flags_guard(flags):
+            main_program, out = build_program()
+            exe = paddle.static.Executor(paddle.CPUPlace())
+            (res,) = exe.run(
+                main_program,
+                feed={"w": self.w, "x": self.x},
+                fetch_list=[out],
+            )
+            # the buffers kept by the body are reused by another run
+            (res_again,) = exe.run(
+                main_program,
+                feed={"w": self.w, "x": self.x},
+                fetch_list=[out],
+            )
+        np.testing.assert_allclose(res, res_again, rtol=1e-6)
+        return res
+
+    def test_result(self):
+        expected = self.x
+        ww = self.w @ self.w * 0.5
+        for _ in range(5):
+            expected = np.tanh(expected @ ww + 1.0)
+
+        for flags in [
+            {
+                "FLAGS_pir_while_hoist_invariant": False,
+                "FLAGS_while_reuse_body_buffers": False,
+            },
+            {
+                "FLAGS_pir_while_hoist_invariant": True,
+                "FLAGS_while_reuse_body_buffers": False,
+            },
+            {
+                "FLAGS_pir_while_hoist_invariant": True,
+                "FLAGS_while_reuse_body_buffers": True,
+            },
+        ]:
+            res = self.run_program(flags)
+            np.testing.assert_allclose(res, expected, rtol=1e-5, atol=1e-6)
+
+
+if __name__ == "__main__":
+    unittest.main()
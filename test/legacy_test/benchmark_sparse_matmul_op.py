@@ -0,0 +1,118 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import time
+import unittest
+
+import numpy as np
+import scipy.sparse as sp
+
+import paddle
+
+# Benchmarks the cpu kernels of sparse.matmul (SpMM) and sparse.masked_matmul
+# (SDDMM) on the adjacency matrices of power-law graphs, whose row degrees
+# follow a zipf distribution as those of the social and the user-item graphs.
+
+
+def power_law_csr(rows, cols, avg_degree, alpha=2.0, seed=2024):
+    rng = np.random.default_rng(seed)
+    degrees = np.minimum(rng.zipf(alpha, rows), cols)
+    degrees = np.maximum(degrees * avg_degree // max(degrees.mean(), 1), 1)
+    degrees = np.minimum(degrees, cols).astype(np.int64)
+    indptr = np.concatenate([[0], np.cumsum(degrees)])
+    indices = np.concatenate(
+        [np.sort(rng.choice(cols, d, replace=False)) for d in degrees]
+    )
+    data = rng.random(indptr[-1], dtype=np.float32)
+    return sp.csr_matrix((data, indices, indptr), shape=(rows, cols))
+
+
+def to_paddle_csr(mat):
+    return paddle.sparse.sparse_csr_tensor(
+        mat.indptr.astype(np.int64),
+        mat.indices.astype(np.int64),
+        mat.data,
+        list(mat.shape),
+        stop_gradient=True,
+    )
+
+
+def timeit(func, iters):
+    func()
+    start = time.perf_counter()
+    for _ in range(iters):
+        func()
+    return (time.perf_counter() - start) / iters
+
+
+class BenchmarkSparseMatmulCPU(unittest.TestCase):
+    def setUp(self):
+        paddle.set_device('cpu')
+        self.iters = 20
+        # (rows, cols, average degree, dense columns)
+        self.cases = [
+            (10000, 10000, 16, 64),
+            (50000, 50000, 32, 128),
+            (100000, 20000, 8, 256),
+        ]
+
+    def test_spmm(self):
+        for rows, cols, degree, n in self.cases:
+            mat = power_law_csr(rows, cols, degree)
+            x = to_paddle_csr(mat)
+            np_y = np.random.rand(cols, n).astype(np.float32)
+            y = paddle.to_tensor(np_y)
+            np.testing.assert_allclose(
+                paddle.sparse.matmul(x, y).numpy(),
+                mat @ np_y,
+                rtol=1e-4,
+                atol=1e-4,
+            )
+            cost = timeit(lambda: paddle.sparse.matmul(x, y), self.iters)
+            print(
+                f"spmm [{rows}, {cols}] nnz {mat.nnz} @ [{cols}, {n}]: "
+                f"{cost * 1e3:.3f} ms, "
+                f"{2 * mat.nnz * n / cost * 1e-9:.2f} GFLOP/s"
+            )
+
+    def test_sddmm(self):
+        for rows, cols, degree, k in self.cases:
+            mat = power_law_csr(rows, cols, degree)
+            mask = to_paddle_csr(mat)
+            np_x = np.random.rand(rows, k).astype(np.float32)
+            np_y = np.random.rand(k, cols).astype(np.float32)
+            x = paddle.to_tensor(np_x)
+            y = paddle.to_tensor(np_y)
+            out = paddle.sparse.masked_matmul(x, y, mask)
+            # checks the first nonzeros only to bound the memory
+            num = min(mat.nnz, 10000)
+            rows_id = np.repeat(np.arange(rows), np.diff(mat.indptr))[:num]
+            expect = np.einsum(
+                'ij,ji->i', np_x[rows_id], np_y[:, mat.indices[:num]]
+            )
+            np.testing.assert_allclose(
+                out.values().numpy()[:num], expect, rtol=1e-4, atol=1e-4
+            )
+            cost = timeit(
+                lambda: paddle.sparse.masked_matmul(x, y, mask), self.iters
+            )
+            print(
+                f"sddmm [{rows}, {k}] @ [{k}, {cols}] nnz {mat.nnz}: "
+                f"{cost * 1e3:.3f} ms, "
+                f"{2 * mat.nnz * k / cost * 1e-9:.2f} GFLOP/s"
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
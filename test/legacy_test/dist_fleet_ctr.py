@@ -327,10 +327,19 @@ class TestDistCTR2x2(FleetDistRunnerBase):
         dataset.set_thread(2)
         dataset.set_filelist(filelist)
         dataset.set_pipe_command('python ctr_dataset_reader.py')
+        dataset.set_fleet_send_batch_size(
+            int(os.getenv("FLEET_SEND_BATCH_SIZE", "1024"))
+        )
         dataset.load_into_memory()
+        memory_data_size = dataset.get_memory_data_size(fleet)
 
         dataset.global_shuffle(fleet, 12)  # TODO: thread configure
         shuffle_data_size = dataset.get_shuffle_data_size(fleet)
+        # every record is received by exactly one trainer
+        assert shuffle_data_size == memory_data_size, (
+            f"global_shuffle changed the data size from {memory_data_size} "
+            f"to {shuffle_data_size}"
+        )
         local_data_size = dataset.get_shuffle_data_size()
         data_size_list = fleet.util.all_gather(local_data_size)
         print('after global_shuffle data_size_list: ', data_size_list)
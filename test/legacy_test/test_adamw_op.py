@@ -619,6 +619,110 @@ class TestAdamWOpMultiPrecision(unittest.TestCase):
                 self._test_adamw_op_dygraph_place_amp(place, use_amp)
 
 
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestMultiTensorAdamW(unittest.TestCase):
+    def _adamw_optimize_dygraph(
+        self, use_param_group=False, use_amp=False, use_multi_tensor=False
+    ):
+        paddle.disable_static()
+        paddle.seed(10)
+        paddle.set_device('gpu')
+
+        input = paddle.randn((5, 5))
+        model = paddle.nn.Sequential(
+            paddle.nn.Linear(5, 5),
+            paddle.nn.Linear(
+                5, 5, weight_attr=paddle.ParamAttr(learning_rate=0.5)
+            ),
+        )
+        parameters = list(model.parameters())
+        if use_param_group:
+            parameters = [
+                {
+                    'params': parameters[:2],
+                    'weight_decay': 0.001,
+                    'beta1': 0.1,
+                    'beta2': 0.99,
+                },
+                {'params': parameters[2:], 'learning_rate': 0.1},
+            ]
+        optimizer = paddle.optimizer.AdamW(
+            parameters=parameters,
+            apply_decay_param_fun=lambda name: 'b_' not in name,
+            multi_precision=use_amp,
+            use_multi_tensor=use_multi_tensor,
+        )
+        if use_amp:
+            model = paddle.amp.decorate(models=model, level='O2')
+            scaler = paddle.amp.GradScaler(init_loss_scaling=1024)
+
+        for _ in range(3):
+            if use_amp:
+                with paddle.amp.auto_cast(level='O2'):
+                    loss = paddle.mean(model(input))
+                scaler.scale(loss).backward()
+                scaler.step(optimizer)
+                scaler.update()
+            else:
+                loss = paddle.mean(model(input))
+                loss.backward()
+                optimizer.step()
+            optimizer.clear_grad()
+        return [param.astype('float32').numpy() for param in model.parameters()]
+
+    def test_main(self):
+        for use_param_group in [False, True]:
+            for use_amp in [False, True]:
+                expect = self._adamw_optimize_dygraph(use_param_group, use_amp)
+                actual = self._adamw_optimize_dygraph(
+                    use_param_group, use_amp, use_multi_tensor=True
+                )
+                for a, e in zip(actual, expect):
+                    np.testing.assert_allclose(a, e, rtol=1e-5, atol=1e-6)
+
+    def _adamw_skip_grads_dygraph(self, use_multi_tensor):
+        paddle.disable_static()
+        paddle.seed(10)
+        paddle.set_device('gpu')
+
+        input = paddle.randn((5, 5))
+        first = paddle.nn.Linear(5, 5)
+        second = paddle.nn.Linear(5, 5)
+        optimizer = paddle.optimizer.AdamW(
+            parameters=first.parameters() + second.parameters(),
+            use_multi_tensor=use_multi_tensor,
+        )
+        for step in range(3):
+            # the second layer has no gradient at the first step, so its beta
+            # pows lag behind the ones of the first layer
+            out = first(input)
+            if step > 0:
+                out = second(out)
+            paddle.mean(out).backward()
+            optimizer.step()
+            optimizer.clear_grad()
+        return [
+            param.numpy() for param in first.parameters() + second.parameters()
+        ]
+
+    def test_params_without_grads(self):
+        expect = self._adamw_skip_grads_dygraph(use_multi_tensor=False)
+        actual = self._adamw_skip_grads_dygraph(use_multi_tensor=True)
+        for a, e in zip(actual, expect):
+            np.testing.assert_allclose(a, e, rtol=1e-5, atol=1e-6)
+
+    def test_lr_ratio_error(self):
+        model = paddle.nn.Linear(5, 5)
+        with self.assertRaises(NotImplementedError):
+            paddle.optimizer.AdamW(
+                parameters=model.parameters(),
+                lr_ratio=lambda param: 1.0,
+                use_multi_tensor=True,
+            )
+
+
 class TestAdamWOpError(unittest.TestCase):
     def test_api_errors(self):
         def test_parameters_dtype1():
@@ -0,0 +1,89 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle.base import core
+from paddle.distributed.checkpoint.save_state_dict import (
+    clear_async_save_task_queue,
+)
+
+
+class TestAsyncCheckpoint(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.path = self.temp_dir.name
+
+    def tearDown(self):
+        self.temp_dir.cleanup()
+
+    def test_save_and_load(self):
+        w = paddle.rand([64, 32])
+        b = paddle.arange(32, dtype='int64')
+        state_dict = {"w": w, "b": b}
+        dist.save_state_dict(state_dict, self.path, async_save=True)
+        # the snapshot is taken, so the tensors may change at once
+        w.add_(paddle.ones_like(w))
+        clear_async_save_task_queue()
+
+        file_path = os.path.join(self.path, "0_0.distcp")
+        self.assertTrue(core.is_async_checkpoint_file(file_path))
+        load_state_dict = {
+            "w": paddle.zeros([64, 32]),
+            "b": paddle.zeros([32], dtype='int64'),
+        }
+        dist.load_state_dict(load_state_dict, self.path)
+        np.testing.assert_array_equal(
+            load_state_dict["w"].numpy(), (w - 1).numpy()
+        )
+        np.testing.assert_array_equal(load_state_dict["b"].numpy(), b.numpy())
+
+    def test_dedup(self):
+        writer = core.AsyncCheckpointWriter(2)
+        w = paddle.rand([256, 256])
+        b = paddle.rand([256])
+        first = os.path.join(self.path, "first.distcp")
+        second = os.path.join(self.path, "second.distcp")
+        writer.save(["w", "b"], [w, b], first, True)
+        b.add_(paddle.ones_like(b))
+        writer.save(["w", "b"], [w, b], second, True)
+        writer.wait()
+
+        # w is unchanged, so only b is in the second file
+        w_nbytes = 256 * 256 * 4
+        self.assertLess(
+            os.path.getsize(second), os.path.getsize(first) - w_nbytes + 64
+        )
+        loaded = dict(core.load_async_checkpoint(second))
+        np.testing.assert_array_equal(np.array(loaded["w"]), w.numpy())
+        np.testing.assert_array_equal(np.array(loaded["b"]), b.numpy())
+
+    def test_mismatched_names(self):
+        writer = core.AsyncCheckpointWriter(1)
+        with self.assertRaises(ValueError):
+            writer.save(
+                ["w", "b"],
+                [paddle.rand([2])],
+                os.path.join(self.path, "0.distcp"),
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
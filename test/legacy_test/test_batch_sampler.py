@@ -20,11 +20,13 @@ import numpy as np
 from paddle.io import (
     BatchSampler,
     Dataset,
+    PackedBatchSampler,
     RandomSampler,
     Sampler,
     SequenceSampler,
     SubsetRandomSampler,
     WeightedRandomSampler,
+    packed_collate_fn,
 )
 
 IMAGE_SIZE = 32
@@ -360,5 +362,55 @@ class TestWeightedRandomSampler(unittest.TestCase):
             self.assertTrue(True)
 
 
+class TestPackedBatchSampler(unittest.TestCase):
+    def test_main(self):
+        np.random.seed(2024)
+        lengths = np.random.randint(1, 513, [1000]).tolist()
+        for shuffle in [False, True]:
+            sampler = PackedBatchSampler(
+                lengths, max_tokens=1024, shuffle=shuffle, bucket_size=256
+            )
+            num_batches = len(sampler)
+            batches = list(iter(sampler))
+            self.assertEqual(len(batches), num_batches)
+            indices = sorted(i for batch in batches for i in batch)
+            self.assertEqual(indices, list(range(1000)))
+            tokens = [sum(lengths[i] for i in batch) for batch in batches]
+            self.assertLessEqual(max(tokens), 1024)
+            # nearly all the tokens of the mini-batches are the samples
+            self.assertGreater(sum(tokens) / (1024 * len(batches)), 0.9)
+
+    def test_drop_last(self):
+        sampler = PackedBatchSampler([8, 3, 1], max_tokens=10, drop_last=True)
+        self.assertEqual(list(iter(sampler)), [[0, 2]])
+
+    def test_too_long(self):
+        with self.assertRaises(ValueError):
+            PackedBatchSampler([4, 12], max_tokens=10)
+
+    def test_collate(self):
+        batch = [
+            {'input_ids': np.arange(5), 'labels': np.arange(5) + 1},
+            {'input_ids': np.arange(3), 'labels': np.arange(3) + 1},
+        ]
+        packed = packed_collate_fn(batch)
+        np.testing.assert_array_equal(
+            packed['input_ids'], [0, 1, 2, 3, 4, 0, 1, 2]
+        )
+        np.testing.assert_array_equal(packed['labels'], packed['input_ids'] + 1)
+        np.testing.assert_array_equal(packed['cu_seqlens'], [0, 5, 8])
+        self.assertEqual(packed['cu_seqlens'].dtype, np.int32)
+        np.testing.assert_array_equal(
+            packed['position_ids'], [0, 1, 2, 3, 4, 0, 1, 2]
+        )
+
+        input_ids, cu_seqlens, position_ids = packed_collate_fn(
+            [[np.arange(2)], [np.arange(1)]]
+        )
+        np.testing.assert_array_equal(input_ids, [0, 1, 0])
+        np.testing.assert_array_equal(cu_seqlens, [0, 2, 3])
+        np.testing.assert_array_equal(position_ids, [0, 1, 0])
+
+
 if __name__ == '__main__':
     unittest.main()
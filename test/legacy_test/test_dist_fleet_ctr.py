@@ -57,6 +57,23 @@ class TestDistMnistAsyncInMemoryDataset2x2(TestFleetBase):
         )
 
 
+class TestDistMnistAsyncInMemoryDatasetShuffleCredits2x2(
+    TestDistMnistAsyncInMemoryDataset2x2
+):
+    def test_dist_train(self):
+        # Small messages and one message in flight per trainer, so the
+        # shuffle threads wait for the credits of the trainers.
+        self.check_with_place(
+            "dist_fleet_ctr.py",
+            delta=1e-5,
+            check_error_log=False,
+            need_envs={
+                "FLAGS_dataset_global_shuffle_max_inflight_msgs": "1",
+                "FLEET_SEND_BATCH_SIZE": "8",
+            },
+        )
+
+
 class TestDistMnistAsync2x2(TestFleetBase):
     def _setup_config(self):
         self._mode = "async"
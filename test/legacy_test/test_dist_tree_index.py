@@ -114,6 +114,49 @@ class TestTreeIndex(unittest.TestCase):
         self.assertIn(all_leaf_ids[0], children_ids)
 
 
+    def test_layerwise_sample_batch(self):
+        path = download(
+            "https://paddlerec.bj.bcebos.com/tree-based/data/mini_tree.pb",
+            "tree_index_unittest",
+            "e2ba4561c2e9432b532df40546390efa",
+        )
+        tree = TreeIndex("demo_batch", path)
+        height = tree.height()
+        layer_counts = [1, 2, 1, 1]
+        tree.init_layerwise_sampler(layer_counts, 1, 0)
+        layer_ids = [
+            {node.id() for node in tree.get_nodes(tree.get_layer_codes(i))}
+            for i in range(height)
+        ]
+
+        all_leaf_ids = [node.id() for node in tree.get_all_leafs()]
+        targets = all_leaf_ids * 4
+        users = [
+            [all_leaf_ids[(i + 1) % len(all_leaf_ids)], all_leaf_ids[0]]
+            for i in range(len(targets))
+        ]
+        for with_hierarchy in [False, True]:
+            expected = tree.layerwise_sample(users, targets, with_hierarchy)
+            for thread_num in [1, 3]:
+                outputs = tree.layerwise_sample_batch(
+                    users, targets, with_hierarchy, thread_num
+                )
+                self.assertEqual(len(outputs), len(expected))
+                for row, expected_row in zip(outputs, expected):
+                    # the users and the positives are the same
+                    self.assertEqual(row[:2], expected_row[:2])
+                    self.assertEqual(row[3], expected_row[3])
+                    if row[3] == 1:
+                        self.assertEqual(row[2], expected_row[2])
+                        positive = row[2]
+                        level = [
+                            i for i in range(height) if positive in layer_ids[i]
+                        ][0]
+                    else:
+                        self.assertNotEqual(row[2], positive)
+                        self.assertIn(row[2], layer_ids[level])
+
+
 class TestIndexSampler(unittest.TestCase):
     def setUp(self):
         self.temp_dir = tempfile.TemporaryDirectory()
@@ -232,6 +232,87 @@ class TestDLPack(unittest.TestCase):
                     np.testing.assert_array_equal(x.numpy(), y.numpy())
 
 
+    def test_dlpack_protocol(self):
+        with dygraph_guard():
+            DLDeviceType = paddle.utils.dlpack.DLDeviceType
+            places = [(base.CPUPlace(), DLDeviceType.kDLCPU)]
+            if paddle.is_compiled_with_cuda():
+                places.append((base.CUDAPlace(0), DLDeviceType.kDLCUDA))
+                places.append(
+                    (base.CUDAPinnedPlace(), DLDeviceType.kDLCUDAHost)
+                )
+            for place, device_type in places:
+                x = paddle.rand([3, 5]).to(device=place)
+                self.assertEqual(x.__dlpack_device__()[0], device_type)
+                # from_dlpack passes the current stream for a GPU tensor
+                y = paddle.utils.dlpack.from_dlpack(x)
+                self.assertEqual(x.data_ptr(), y.data_ptr())
+                self.assertEqual(str(x.place), str(y.place))
+                np.testing.assert_array_equal(x.numpy(), y.numpy())
+
+    @unittest.skipIf(
+        not paddle.is_compiled_with_cuda(), "dlpack stream requires CUDA"
+    )
+    def test_dlpack_stream(self):
+        with dygraph_guard():
+            x = paddle.rand([64, 64]).to(device=base.CUDAPlace(0))
+            stream = paddle.device.cuda.Stream()
+            for consumer in [None, 1, 2, -1, stream.cuda_stream]:
+                y = paddle.utils.dlpack.from_dlpack(
+                    x.__dlpack__(stream=consumer)
+                )
+                np.testing.assert_array_equal(x.numpy(), y.numpy())
+            self.assertRaises(ValueError, x.__dlpack__, stream=0)
+            self.assertRaises(BufferError, x.cpu().__dlpack__, stream=1)
+
+    @unittest.skipIf(
+        not paddle.is_compiled_with_cuda(), "float8 tensors require CUDA"
+    )
+    def test_dlpack_float8(self):
+        with dygraph_guard():
+            data = paddle.to_tensor([[0.5, 1.0], [-2.0, 4.0]], place="gpu")
+            for dtype in ["float8_e4m3fn", "float8_e5m2"]:
+                x = data.astype(dtype)
+                y = paddle.utils.dlpack.from_dlpack(
+                    paddle.utils.dlpack.to_dlpack(x)
+                )
+                self.assertEqual(x.dtype, y.dtype)
+                self.assertEqual(x.data_ptr(), y.data_ptr())
+                np.testing.assert_array_equal(
+                    x.astype("float32").numpy(), y.astype("float32").numpy()
+                )
+
+
+class TestFromNumpy(unittest.TestCase):
+    def test_share_memory(self):
+        with dygraph_guard():
+            for dtype in ["bool", "float32", "float64", "int32", "int64"]:
+                x = np.ones([3, 4], dtype=dtype)
+                y = paddle.from_numpy(x)
+                self.assertEqual(
+                    x.__array_interface__['data'][0], y.data_ptr()
+                )
+                self.assertEqual(y.shape, [3, 4])
+                self.assertTrue(y.place.is_cpu_place())
+                np.testing.assert_array_equal(x, y.numpy())
+            x = np.zeros([2, 3], dtype="float32")
+            y = paddle.from_numpy(x)
+            x[1, 2] = 5.0
+            self.assertEqual(y[1, 2].item(), 5.0)
+
+    def test_keep_array_alive(self):
+        with dygraph_guard():
+            y = paddle.from_numpy(np.arange(6, dtype="int64").reshape([2, 3]))
+            np.testing.assert_array_equal(
+                y.numpy(), np.arange(6).reshape([2, 3])
+            )
+
+    def test_raise_error(self):
+        with dygraph_guard():
+            self.assertRaises(TypeError, paddle.from_numpy, [1, 2])
+            x = np.ones([4, 4], dtype="float32")[:, ::2]
+            self.assertRaises(ValueError, paddle.from_numpy, x)
+
 class TestRaiseError(unittest.TestCase):
     def test_to_dlpack_raise_type_error(self):
         self.assertRaises(TypeError, paddle.utils.dlpack.to_dlpack, np.zeros(5))
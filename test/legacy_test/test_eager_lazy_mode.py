@@ -0,0 +1,79 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.incubate.jit import lazy_guard, sync
+
+
+def mlp(x, w, b):
+    h = paddle.nn.functional.relu(paddle.matmul(x, w) + b)
+    return paddle.tanh(h) * paddle.exp(-h)
+
+
+class TestEagerLazyMode(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        paddle.seed(2024)
+        self.x = paddle.rand([8, 16])
+        self.w = paddle.rand([16, 32])
+        self.b = paddle.rand([32])
+
+    def test_same_values_as_eager(self):
+        expected = mlp(self.x, self.w, self.b).numpy()
+        with lazy_guard():
+            out = mlp(self.x, self.w, self.b)
+            self.assertEqual(out.shape, [8, 32])
+            np.testing.assert_allclose(out.numpy(), expected, rtol=1e-6)
+
+    def test_repeated_structure(self):
+        expected = [mlp(self.x * i, self.w, self.b).numpy() for i in range(3)]
+        with lazy_guard():
+            for i in range(3):
+                out = mlp(self.x * i, self.w, self.b)
+                np.testing.assert_allclose(
+                    out.numpy(), expected[i], rtol=1e-6
+                )
+
+    def test_max_ops(self):
+        expected = self.x.numpy()
+        with lazy_guard(max_ops=2):
+            y = self.x
+            for _ in range(5):
+                y = paddle.maximum(y, self.x)
+            sync()
+        np.testing.assert_allclose(y.numpy(), expected)
+
+    def test_grad_is_not_recorded(self):
+        x = self.x.clone()
+        x.stop_gradient = False
+        with lazy_guard():
+            y = paddle.sigmoid(x)
+            y.sum().backward()
+        s = paddle.nn.functional.sigmoid(self.x).numpy()
+        np.testing.assert_allclose(x.grad.numpy(), s * (1 - s), rtol=1e-6)
+
+    def test_dead_outputs(self):
+        with lazy_guard():
+            tmp = paddle.sqrt(self.x)
+            del tmp
+            out = paddle.abs(self.x - self.x)
+        np.testing.assert_allclose(out.numpy(), np.zeros([8, 16]))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -15,7 +15,11 @@
 import unittest
 
 import paddle
-from paddle.distributed.fleet.fleet_executor_utils import FleetExecutorUtils
+from paddle.distributed.fleet.fleet_executor_utils import (
+    FleetExecutorUtils,
+    predict_bubble_ratio,
+    run_pipeline_schedule,
+)
 
 paddle.enable_static()
 
@@ -43,6 +47,46 @@ class TestFleetExecutorUtils(unittest.TestCase):
             program_map
         )
 
+    def test_predict_bubble_ratio(self):
+        ratio_1f1b = predict_bubble_ratio('1F1B', 16, 32)
+        self.assertAlmostEqual(ratio_1f1b, 15 / 47)
+        ratio_interleaved = predict_bubble_ratio('Interleaved1F1B', 16, 32, 4)
+        self.assertAlmostEqual(ratio_interleaved, 15 / 143)
+        ratio_zero_bubble = predict_bubble_ratio('ZeroBubble', 16, 32)
+        self.assertAlmostEqual(ratio_zero_bubble, 15 / 111)
+        with self.assertRaises(ValueError):
+            predict_bubble_ratio('1F1B', 16, 32, 2)
+
+    def test_build_pipeline_graph(self):
+        dist_opt = {"pp_degree": 4}
+        tasks, task_id_to_rank, graph = run_pipeline_schedule(
+            {"fwd": [[], []], "bwd": [[], []]},
+            rank=1,
+            max_run_times=8,
+            dist_opt=dist_opt,
+            scheduler='Interleaved1F1B',
+            num_virtual_stages=2,
+        )
+        # lr, 2 fwd, 2 bwd and opt of each stage
+        self.assertEqual(len(tasks), 6)
+        task_ids = [task.task_id() for task in tasks]
+        self.assertEqual(task_ids, [6, 7, 8, 10, 9, 11])
+        self.assertEqual(len(task_id_to_rank), 24)
+        self.assertEqual(task_id_to_rank[18], 3)
+
+        dist_opt = {"pp_degree": 2, "dp_degree": 2}
+        tasks, task_id_to_rank, graph = run_pipeline_schedule(
+            {"fwd": [[]], "bwd": [[]], "bwd_weight": [[]]},
+            rank=3,
+            max_run_times=4,
+            dist_opt=dist_opt,
+            scheduler='ZeroBubble',
+        )
+        # lr, fwd, bwd, bwd_weight and opt of rank 2 and 3
+        task_ids = [task.task_id() for task in tasks]
+        self.assertEqual(task_ids, [15, 16, 17, 18, 19])
+        self.assertEqual(sorted(set(task_id_to_rank.values())), [2, 3])
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,140 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.incubate.nn.functional import fused_beam_search_step
+
+
+def beam_search_step_ref(
+    logits, pre_scores, pre_finished, pre_lengths, end_id, length_penalty
+):
+    batch, beam, vocab = logits.shape
+    logits = logits.astype("float64")
+    log_probs = logits - logits.max(axis=-1, keepdims=True)
+    log_probs -= np.log(np.exp(log_probs).sum(axis=-1, keepdims=True))
+    ids = np.zeros([batch, beam], "int64")
+    scores = np.zeros([batch, beam], "float32")
+    finished = np.zeros([batch, beam], "bool")
+    lengths = np.zeros([batch, beam], "int64")
+    parents = np.zeros([batch, beam], "int64")
+    for b in range(batch):
+        cands = []
+        for k in range(beam):
+            length = pre_lengths[b, k]
+            if pre_finished[b, k]:
+                cands.append((pre_scores[b, k], end_id, k, length))
+                cands += [(-np.inf, end_id, k, length)] * (beam - 1)
+                continue
+            # the larger logits first, the smaller ids of the equal ones
+            tokens = np.lexsort((np.arange(vocab), -logits[b, k]))[:beam]
+            for t in tokens:
+                score = pre_scores[b, k] + log_probs[b, k, t]
+                cands.append((score, t, k, length + 1))
+
+        def normalized(i):
+            score, _, _, length = cands[i]
+            return score / (((5.0 + length) / 6.0) ** length_penalty)
+
+        order = sorted(range(len(cands)), key=lambda i: (-normalized(i), i))
+        for k, i in enumerate(order[:beam]):
+            score, token, parent, length = cands[i]
+            ids[b, k] = token
+            scores[b, k] = score
+            finished[b, k] = pre_finished[b, parent] or token == end_id
+            lengths[b, k] = length
+            parents[b, k] = parent
+    cache_indices = (parents + np.arange(batch)[:, None] * beam).reshape([-1])
+    return ids, scores, finished, lengths, parents, cache_indices
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(),
+    "fused_beam_search_step requires CUDA",
+)
+class TestFusedBeamSearchStepOp(unittest.TestCase):
+    def setUp(self):
+        self.config()
+        paddle.disable_static(place=paddle.CUDAPlace(0))
+        np.random.seed(2024)
+        self.logits = np.random.uniform(
+            -4, 4, [self.batch, self.beam, self.vocab]
+        ).astype("float32")
+        self.pre_scores = np.random.uniform(
+            -3, 0, [self.batch, self.beam]
+        ).astype("float32")
+        self.pre_finished = np.random.rand(self.batch, self.beam) < 0.3
+        self.pre_lengths = np.random.randint(
+            1, 10, [self.batch, self.beam]
+        ).astype("int64")
+        self.end_id = 1
+        # the end token is likely to be selected
+        self.logits[:, :, self.end_id] += 4.0
+
+    def config(self):
+        self.batch = 3
+        self.beam = 4
+        self.vocab = 1000
+        self.length_penalty = 0.6
+
+    def check(self, pre_scores):
+        outs = fused_beam_search_step(
+            paddle.to_tensor(self.logits),
+            paddle.to_tensor(pre_scores),
+            paddle.to_tensor(self.pre_finished),
+            paddle.to_tensor(self.pre_lengths),
+            self.end_id,
+            self.length_penalty,
+        )
+        refs = beam_search_step_ref(
+            self.logits,
+            pre_scores,
+            self.pre_finished,
+            self.pre_lengths,
+            self.end_id,
+            self.length_penalty,
+        )
+        ids, scores, finished, lengths, parents, cache_indices = outs
+        ref_ids, ref_scores, *ref_others = refs
+        np.testing.assert_array_equal(ids.numpy(), ref_ids)
+        np.testing.assert_allclose(
+            scores.numpy(), ref_scores, rtol=1e-5, atol=1e-5
+        )
+        others = [finished, lengths, parents, cache_indices]
+        for out, ref in zip(others, ref_others):
+            np.testing.assert_array_equal(out.numpy(), ref)
+
+    def test_step(self):
+        self.check(self.pre_scores)
+
+    def test_first_step(self):
+        pre_scores = np.full([self.batch, self.beam], -np.inf, "float32")
+        pre_scores[:, 0] = 0.0
+        self.pre_finished[:] = False
+        self.check(pre_scores)
+
+
+class TestFusedBeamSearchStepOpLargeBeam(TestFusedBeamSearchStepOp):
+    def config(self):
+        self.batch = 2
+        self.beam = 12
+        self.vocab = 3000
+        self.length_penalty = 0.0
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -178,5 +178,33 @@ class TestFusedBiasDropoutResidualLayerNormOpFp16(
         self.atol = 1e-1
 
 
+class TestFusedBiasDropoutResidualLayerNormDeviceRng(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static(place=paddle.CUDAPlace(0))
+        self.x = paddle.rand([8, 64, 256])
+        self.residual = paddle.rand([8, 64, 256])
+        self.bias = paddle.rand([256])
+        paddle.set_flags({"FLAGS_use_device_rng_state_dropout": True})
+
+    def tearDown(self):
+        paddle.set_flags({"FLAGS_use_device_rng_state_dropout": False})
+
+    def run_op(self):
+        return incubate_f.fused_bias_dropout_residual_layer_norm(
+            self.x, self.residual, self.bias, dropout_rate=0.5
+        ).numpy()
+
+    def test_device_rng(self):
+        paddle.seed(2024)
+        out_1 = self.run_op()
+        out_2 = self.run_op()
+        # the offset on the device is advanced by the kernel
+        self.assertFalse(np.allclose(out_1, out_2))
+
+        paddle.seed(2024)
+        np.testing.assert_array_equal(out_1, self.run_op())
+        np.testing.assert_array_equal(out_2, self.run_op())
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,125 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+import paddle.nn.functional as F
+from paddle.incubate.nn.functional import fused_linear_cross_entropy
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(),
+    "fused_linear_cross_entropy requires CUDA",
+)
+class TestFusedLinearCrossEntropyOp(unittest.TestCase):
+    def setUp(self):
+        self.config()
+        paddle.disable_static(place=paddle.CUDAPlace(0))
+        np.random.seed(2024)
+        self.x_np = np.random.uniform(
+            -1, 1, [self.batch, self.seq_len, self.hidden]
+        ).astype("float32")
+        self.w_np = np.random.uniform(
+            -0.2, 0.2, [self.hidden, self.vocab]
+        ).astype("float32")
+        self.label_np = np.random.randint(
+            0, self.vocab, [self.batch, self.seq_len]
+        ).astype("int64")
+        # some ignored labels
+        self.label_np[0, :3] = -100
+
+    def config(self):
+        self.dtype = "float32"
+        self.batch = 2
+        self.seq_len = 12
+        self.hidden = 32
+        self.vocab = 1000
+        # the last chunk is a partial one
+        self.chunk_size = 384
+        self.rtol = 1e-4
+        self.atol = 1e-4
+
+    def check(self, reduction):
+        x = paddle.to_tensor(self.x_np, dtype=self.dtype, stop_gradient=False)
+        w = paddle.to_tensor(self.w_np, dtype=self.dtype, stop_gradient=False)
+        label = paddle.to_tensor(self.label_np)
+        loss = fused_linear_cross_entropy(
+            x, w, label, chunk_size=self.chunk_size, reduction=reduction
+        )
+        loss_grad = paddle.rand(loss.shape, dtype="float32")
+        x_grad, w_grad = paddle.grad([loss], [x, w], [loss_grad])
+
+        x_ref = paddle.to_tensor(self.x_np, stop_gradient=False)
+        w_ref = paddle.to_tensor(self.w_np, stop_gradient=False)
+        loss_ref = F.cross_entropy(
+            paddle.matmul(x_ref, w_ref),
+            label.unsqueeze(-1),
+            ignore_index=-100,
+            reduction=reduction,
+        )
+        x_grad_ref, w_grad_ref = paddle.grad(
+            [loss_ref], [x_ref, w_ref], [loss_grad]
+        )
+        for actual, expected in [
+            (loss, loss_ref),
+            (x_grad, x_grad_ref),
+            (w_grad, w_grad_ref),
+        ]:
+            np.testing.assert_allclose(
+                actual.astype("float32").numpy(),
+                expected.numpy(),
+                rtol=self.rtol,
+                atol=self.atol,
+            )
+
+    def test_mean(self):
+        self.check('mean')
+
+    def test_sum(self):
+        self.check('sum')
+
+    def test_none(self):
+        self.check('none')
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(),
+    "fused_linear_cross_entropy requires CUDA",
+)
+class TestFusedLinearCrossEntropyOpFP16(TestFusedLinearCrossEntropyOp):
+    def config(self):
+        super().config()
+        self.dtype = "float16"
+        self.rtol = 1e-2
+        self.atol = 1e-2
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda()
+    or not paddle.amp.is_bfloat16_supported(),
+    "fused_linear_cross_entropy of bfloat16 requires CUDA_ARCH >= 8",
+)
+class TestFusedLinearCrossEntropyOpBF16(TestFusedLinearCrossEntropyOp):
+    def config(self):
+        super().config()
+        self.dtype = "bfloat16"
+        self.rtol = 5e-2
+        self.atol = 5e-2
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,152 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import sys
+import unittest
+
+import numpy as np
+from op_test import OpTest
+
+import paddle
+
+sys.path.append("../sequence")
+from test_cvm_op import cvm_compute
+from test_sequence_pool import (
+    compute_seqpool_avg,
+    compute_seqpool_sqrt,
+    compute_seqpool_sum,
+)
+
+
+def convert_to_offset(lod):
+    offset = [[0] for i in lod]
+    for i, level in enumerate(lod):
+        for seq_len in level:
+            offset[i].append(offset[i][-1] + seq_len)
+    return offset
+
+
+def api_wrapper(
+    ids, w, cvm, pooltype="SUM", use_cvm=True, axis=1, padding_idx=-1
+):
+    if isinstance(ids, paddle.Tensor):
+        ids = [ids]
+    return paddle._C_ops.fusion_emb_seqpool_cvm_concat(
+        ids, w, cvm, pooltype, use_cvm, axis, padding_idx
+    )
+
+
+class TestFusionEmbSeqPoolCVMConcatOp(OpTest):
+    def setUp(self):
+        self.table_height = 20
+        self.w = 11
+        self.use_cvm = True
+        self.padding_idx = -1
+        self.lods = [[[2, 3, 5]], [[1, 5, 2]]]
+        self.set_conf()
+        self.set_pooltype()
+        self.op_type = 'fusion_emb_seqpool_cvm_concat'
+        self.python_api = api_wrapper
+        self.axis = 1
+        bs = len(self.lods[0][0])
+        table = np.random.uniform(
+            0.1, 1, [self.table_height, self.w]
+        ).astype('float32')
+        inputs = []
+        outs = []
+        # The cvm variable is not actually used.
+        cvm = np.array([[0.6, 0.4]]).astype("float32")
+        for i, lod in enumerate(self.lods):
+            assert bs == len(lod[0]), 'All lod size should be equal'
+            ids = np.random.randint(
+                0, self.table_height, [sum(lod[0]), 1]
+            ).astype('int64')
+            x = table[ids.flatten()]
+            if self.padding_idx != -1:
+                x[ids.flatten() == self.padding_idx] = 0
+            offset = convert_to_offset(lod)
+            out = np.zeros((bs, self.w)).astype('float32')
+            if self.pooltype == "SUM":
+                compute_seqpool_sum(x, offset, out)
+            elif self.pooltype == "AVERAGE":
+                compute_seqpool_avg(x, offset, out)
+            elif self.pooltype == "SQRT":
+                compute_seqpool_sqrt(x, offset, out)
+            else:
+                raise Exception("Unsupported pool type!")
+            out = cvm_compute(out, self.w, self.use_cvm)
+            inputs.append((f'ids_{i}', (ids, lod)))
+            outs.append(out)
+
+        self.inputs = {'Ids': inputs, 'W': table, 'CVM': cvm}
+        self.outputs = {'Out': np.concatenate(outs, axis=self.axis)}
+        self.attrs = {
+            'pooltype': self.pooltype,
+            'axis': self.axis,
+            'padding_idx': self.padding_idx,
+        }
+
+    def set_pooltype(self):
+        self.pooltype = "SUM"
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusionEmbSeqPoolCVMConcatOpCase1(TestFusionEmbSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[1]]]
+
+
+class TestFusionEmbSeqPoolCVMConcatOpCase2(TestFusionEmbSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[2, 13, 4]], [[1, 1, 1]], [[5, 3, 1]], [[9, 10, 3]]]
+        self.w = 16
+
+
+class TestFusionEmbSeqPoolCVMConcatOpPadding(TestFusionEmbSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.lods = [[[4, 12, 6]], [[7, 2, 9]]]
+        self.w = 8
+        self.table_height = 3
+        self.padding_idx = 1
+
+
+# test avg pool and sqrt
+def create_test_avg_sqrt_class(parent):
+    class TestSeqPoolAvgCase(parent):
+        def set_pooltype(self):
+            self.pooltype = "AVERAGE"
+
+    class TestSeqPoolSqrtCase(parent):
+        def set_pooltype(self):
+            self.pooltype = "SQRT"
+
+    cls_name_avg = "{}_{}".format(parent.__name__, "avg")
+    cls_name_sqrt = "{}_{}".format(parent.__name__, "sqrt")
+    TestSeqPoolAvgCase.__name__ = cls_name_avg
+    TestSeqPoolSqrtCase.__name__ = cls_name_sqrt
+    globals()[cls_name_avg] = TestSeqPoolAvgCase
+    globals()[cls_name_sqrt] = TestSeqPoolSqrtCase
+
+
+create_test_avg_sqrt_class(TestFusionEmbSeqPoolCVMConcatOp)
+create_test_avg_sqrt_class(TestFusionEmbSeqPoolCVMConcatOpCase2)
+create_test_avg_sqrt_class(TestFusionEmbSeqPoolCVMConcatOpPadding)
+
+if __name__ == '__main__':
+    unittest.main()
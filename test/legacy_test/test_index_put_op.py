@@ -1028,5 +1028,40 @@ class TestIndexPutAPIMixedIndices1(TestIndexPutAPIBase):
         self.index_type_pd1 = "bool"
 
 
+
+class TestIndexPutAccumulateDuplicateIndices(unittest.TestCase):
+    def setUp(self):
+        self.place = []
+        if (
+            os.environ.get('FLAGS_CI_both_cpu_and_gpu', 'False').lower()
+            in ['1', 'true', 'on']
+            or not paddle.is_compiled_with_cuda()
+        ):
+            self.place.append('cpu')
+        if paddle.is_compiled_with_cuda():
+            self.place.append('gpu')
+        self.x_np = np.random.random((16, 32)).astype(np.float64)
+        # more values than elements, so the values are sorted and reduced
+        self.indices_np = (
+            np.random.randint(0, 16, size=8192).astype(np.int64),
+            np.random.randint(0, 32, size=8192).astype(np.int64),
+        )
+        self.value_np = np.random.random(8192).astype(np.float64)
+
+    def test_dygraph_forward(self):
+        paddle.disable_static()
+        ref_res = self.x_np.copy()
+        np.add.at(ref_res, self.indices_np, self.value_np)
+        for place in self.place:
+            paddle.device.set_device(place)
+            x_pd = paddle.to_tensor(self.x_np)
+            indices_pd = tuple(
+                paddle.to_tensor(indice) for indice in self.indices_np
+            )
+            value_pd = paddle.to_tensor(self.value_np)
+            pd_res = paddle.index_put(x_pd, indices_pd, value_pd, True)
+            np.testing.assert_allclose(ref_res, pd_res.numpy(), rtol=1e-10)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,101 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+from test_sparse_attention_op import get_cuda_version
+
+import paddle
+from paddle.incubate.nn.functional import moe_grouped_gemm
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda()
+    or get_cuda_version() < 11030
+    or paddle.device.cuda.get_device_capability()[0] < 8,
+    "moe_grouped_gemm requires CUDA >= 11.2 and CUDA_ARCH >= 8",
+)
+class TestMoeGroupedGemmOp(unittest.TestCase):
+    def setUp(self):
+        self.config()
+        paddle.disable_static(place=paddle.CUDAPlace(0))
+        np.random.seed(2024)
+        self.x_np = np.random.uniform(
+            -1, 1, [sum(self.tokens_per_expert), self.k]
+        ).astype("float32")
+        self.w_np = np.random.uniform(
+            -1, 1, [len(self.tokens_per_expert), self.k, self.n]
+        ).astype("float32")
+
+    def config(self):
+        self.dtype = "float16"
+        self.k = 64
+        self.n = 128
+        self.tokens_per_expert = [7, 0, 21, 1, 35]
+        self.rtol = 1e-2
+        self.atol = 1e-2
+
+    def expert_loop(self, x, w):
+        outs = []
+        begin = 0
+        for i, tokens in enumerate(self.tokens_per_expert):
+            outs.append(paddle.matmul(x[begin : begin + tokens], w[i]))
+            begin += tokens
+        return paddle.concat(outs, axis=0)
+
+    def test_grouped_gemm(self):
+        x = paddle.to_tensor(self.x_np, dtype=self.dtype, stop_gradient=False)
+        w = paddle.to_tensor(self.w_np, dtype=self.dtype, stop_gradient=False)
+        tokens = paddle.to_tensor(self.tokens_per_expert, dtype="int64")
+        out = moe_grouped_gemm(x, w, tokens)
+        out_grad = paddle.randn(out.shape, dtype="float32").astype(self.dtype)
+        x_grad, w_grad = paddle.grad([out], [x, w], [out_grad])
+
+        x_ref = paddle.to_tensor(self.x_np, stop_gradient=False)
+        w_ref = paddle.to_tensor(self.w_np, stop_gradient=False)
+        out_ref = self.expert_loop(x_ref, w_ref)
+        x_grad_ref, w_grad_ref = paddle.grad(
+            [out_ref], [x_ref, w_ref], [out_grad.astype("float32")]
+        )
+        for actual, expected in [
+            (out, out_ref),
+            (x_grad, x_grad_ref),
+            (w_grad, w_grad_ref),
+        ]:
+            np.testing.assert_allclose(
+                actual.astype("float32").numpy(),
+                expected.numpy(),
+                rtol=self.rtol,
+                atol=self.atol,
+            )
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda()
+    or get_cuda_version() < 11030
+    or paddle.device.cuda.get_device_capability()[0] < 8
+    or not paddle.amp.is_bfloat16_supported(),
+    "moe_grouped_gemm requires CUDA >= 11.2 and CUDA_ARCH >= 8",
+)
+class TestMoeGroupedGemmOpBF16(TestMoeGroupedGemmOp):
+    def config(self):
+        super().config()
+        self.dtype = "bfloat16"
+        self.rtol = 5e-2
+        self.atol = 1e-1
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -277,6 +277,54 @@ class TestNanInfCheckResult(TestNanInfBase):
             )
 
 
+@unittest.skipIf(
+    not paddle.base.core.is_compiled_with_cuda(),
+    "the deferred check is only on GPU",
+)
+class TestDeferredNanInf(TestNanInfBase):
+    def run_log(self, level):
+        paddle.device.set_device("gpu:0")
+        paddle.set_flags(
+            {
+                "FLAGS_check_nan_inf": 1,
+                "FLAGS_check_nan_inf_level": level,
+                "FLAGS_check_nan_inf_deferred_steps": 1000,
+            }
+        )
+        try:
+            x = paddle.to_tensor(np.array([1.0, 0.0, 3.0], dtype="float32"))
+            # recorded, not raised by the ops
+            out = paddle.exp(paddle.log(x))
+            out = paddle.log(x) * 2
+            return out
+        finally:
+            paddle.set_flags(
+                {
+                    "FLAGS_check_nan_inf": 0,
+                    "FLAGS_check_nan_inf_level": 0,
+                }
+            )
+
+    def tearDown(self):
+        paddle.set_flags({"FLAGS_check_nan_inf_deferred_steps": 0})
+
+    def test_first_op(self):
+        self.run_log(level=0)
+        with self.assertRaisesRegex(Exception, "op=log"):
+            paddle.amp.debugging.check_deferred_nan_inf()
+        # the records are cleared by the check
+        paddle.amp.debugging.check_deferred_nan_inf()
+
+    def test_warning(self):
+        out = self.run_log(level=1)
+        paddle.set_flags({"FLAGS_check_nan_inf_level": 1})
+        try:
+            paddle.amp.debugging.check_deferred_nan_inf()
+        finally:
+            paddle.set_flags({"FLAGS_check_nan_inf_level": 0})
+        self.assertTrue(np.isinf(out.numpy()[1]))
+
+
 class TestCheckNumericsAPI(TestNanInfBase):
     def test_eager(self):
         shape = [8, 8]
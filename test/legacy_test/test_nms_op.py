@@ -74,8 +74,9 @@ class TestNMSOp(OpTest):
         self.op_type = 'nms'
         self.python_api = paddle.vision.ops.nms
         self.dtype = np.float64
+        self.num_boxes = 32
         self.init_dtype_type()
-        boxes = np.random.rand(32, 4).astype(self.dtype)
+        boxes = np.random.rand(self.num_boxes, 4).astype(self.dtype)
         boxes[:, 2] = boxes[:, 0] + boxes[:, 2]
         boxes[:, 3] = boxes[:, 1] + boxes[:, 3]
 
@@ -93,5 +94,11 @@ class TestNMSOp(OpTest):
         self.check_output(check_pir=True)
 
 
+class TestNMSOpManyBoxes(TestNMSOp):
+    def init_dtype_type(self):
+        # the masks of the boxes take several words
+        self.num_boxes = 300
+
+
 if __name__ == "__main__":
     unittest.main()
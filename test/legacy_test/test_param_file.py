@@ -0,0 +1,81 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+class TestParamFile(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.temp_dir.name, "model.pdiparams")
+        np.random.seed(2024)
+        self.params = {
+            "embedding": np.random.rand(100, 48).astype("float32"),
+            "linear.b": np.arange(7, dtype="int64"),
+            "scale": np.array(2.0, dtype="float32"),
+        }
+        self.names = sorted(self.params.keys())
+        tensors = [
+            paddle.to_tensor(self.params[name]).get_tensor()
+            for name in self.names
+        ]
+        core.save_param_file(self.path, self.names, tensors)
+
+    def tearDown(self):
+        self.temp_dir.cleanup()
+
+    def test_layout(self):
+        self.assertTrue(core.is_param_file(self.path))
+        reader = core.ParamFileReader(self.path)
+        self.assertEqual(reader.names(), self.names)
+        # each tensor starts at a multiple of 4 KB, and scale is the last one
+        self.assertEqual(os.path.getsize(self.path) % 4096, 4)
+
+    def test_read(self):
+        reader = core.ParamFileReader(self.path)
+        for num_threads in [1, 4]:
+            tensors = reader.read(self.names, core.CPUPlace(), num_threads)
+            for name, tensor in zip(self.names, tensors):
+                np.testing.assert_array_equal(
+                    np.array(tensor), self.params[name]
+                )
+
+    def test_read_slice(self):
+        reader = core.ParamFileReader(self.path)
+        embedding = self.params["embedding"]
+        rows = reader.read_slice("embedding", 0, 25, 50, core.CPUPlace())
+        np.testing.assert_array_equal(np.array(rows), embedding[25:50])
+        cols = reader.read_slice("embedding", 1, 12, 36, core.CPUPlace())
+        np.testing.assert_array_equal(np.array(cols), embedding[:, 12:36])
+        with self.assertRaises(ValueError):
+            reader.read_slice("embedding", 1, 12, 49, core.CPUPlace())
+
+    def test_load_combine(self):
+        tensors = [core.DenseTensor() for _ in self.names]
+        core.load_combine_func(
+            self.path, self.names, tensors, False, core.CPUPlace()
+        )
+        for name, tensor in zip(self.names, tensors):
+            np.testing.assert_array_equal(np.array(tensor), self.params[name])
+
+
+if __name__ == "__main__":
+    unittest.main()
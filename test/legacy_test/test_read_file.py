@@ -44,6 +44,17 @@ class TestReadFileWithDynamic(unittest.TestCase):
         img_cv2 = cv2.imread(self.img_path)
         np.testing.assert_equal(img.shape, img_cv2.transpose(2, 0, 1).shape)
 
+    def test_decode_jpeg_batch_dynamic(self):
+        if not paddle.is_compiled_with_cuda():
+            return
+        img_bytes = read_file(self.img_path)
+        for mode in ['unchanged', 'gray', 'rgb']:
+            img = decode_jpeg(img_bytes, mode=mode)
+            imgs = decode_jpeg([img_bytes, img_bytes, img_bytes], mode=mode)
+            self.assertEqual(len(imgs), 3)
+            for batch_img in imgs:
+                np.testing.assert_equal(batch_img.numpy(), img.numpy())
+
 
 class TestReadFileWithStatic(unittest.TestCase):
     def setUp(self):
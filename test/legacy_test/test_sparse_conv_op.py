@@ -316,6 +316,56 @@ class TestSparseConv(unittest.TestCase):
         )
 
 
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "the rulebook cache is only on GPU"
+)
+class TestSparseConvRulebookCache(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        np.random.seed(2024)
+        dense_x = np.random.uniform(-1, 1, [2, 8, 8, 8, 4]).astype('float32')
+        dense_x[np.random.uniform(0, 1, [2, 8, 8, 8]) < 0.8] = 0
+        self.dense_x = dense_x
+        self.weights = [
+            np.random.uniform(-1, 1, [3, 3, 3, 4, 8]).astype('float32'),
+            np.random.uniform(-1, 1, [3, 3, 3, 8, 8]).astype('float32'),
+            np.random.uniform(-1, 1, [3, 3, 3, 8, 16]).astype('float32'),
+        ]
+
+    def run_convs(self, cache_size):
+        paddle.set_flags({'FLAGS_sparse_conv_rulebook_cache_size': cache_size})
+        try:
+            x = paddle.to_tensor(self.dense_x).to_sparse_coo(4)
+            x.stop_gradient = False
+            weights = [
+                paddle.to_tensor(w, stop_gradient=False) for w in self.weights
+            ]
+            # the subm convs on the same indices, then a conv on them twice
+            y = sparse.nn.functional.subm_conv3d(x, weights[0], padding=1)
+            y = sparse.nn.functional.subm_conv3d(y, weights[1], padding=1)
+            z = sparse.nn.functional.subm_conv3d(y, weights[1], padding=1)
+            outs = [
+                sparse.nn.functional.conv3d(z, weights[2], stride=2)
+                for _ in range(2)
+            ]
+            loss = sum(out.values().sum() for out in outs)
+            loss.backward()
+            results = [out.indices().numpy() for out in outs]
+            results += [out.values().numpy() for out in outs]
+            results += [x.grad.values().numpy()]
+            results += [w.grad.numpy() for w in weights]
+            return results
+        finally:
+            paddle.set_flags({'FLAGS_sparse_conv_rulebook_cache_size': 0})
+
+    def test_result(self):
+        expected = self.run_convs(0)
+        for _ in range(2):
+            results = self.run_convs(16)
+            for result, value in zip(results, expected):
+                np.testing.assert_allclose(result, value, rtol=1e-4, atol=1e-4)
+
+
 class TestStatic(unittest.TestCase):
     @compare_legacy_with_pt
     def test(self):
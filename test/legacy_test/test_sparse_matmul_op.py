@@ -308,6 +308,70 @@ class TestMaskedMatmul(unittest.TestCase):
         )
 
 
+class TestMatmulSparseDenseCPU(unittest.TestCase):
+    # x: sparse, y: dense, out: dense, forward only on cpu
+    def setUp(self):
+        self.place = paddle.CPUPlace()
+
+    def check_result(self, x_shape, y_shape, format):
+        np_x = np.random.rand(*x_shape) * (np.random.rand(*x_shape) < 0.2)
+        np_y = np.random.rand(*y_shape)
+        x = paddle.to_tensor(np_x, place=self.place)
+        y = paddle.to_tensor(np_y, place=self.place)
+        if format == "coo":
+            sp_x = x.to_sparse_coo(len(x_shape))
+        else:
+            sp_x = x.to_sparse_csr()
+        sp_out = paddle.sparse.matmul(sp_x, y)
+        np.testing.assert_allclose(
+            sp_out.numpy(), np.matmul(np_x, np_y), rtol=1e-05
+        )
+
+    def test_matmul_2d(self):
+        self.check_result([16, 12], [12, 10], 'coo')
+        self.check_result([16, 12], [12, 10], 'csr')
+        # more dense columns than a block
+        self.check_result([40, 30], [30, 100], 'csr')
+
+    def test_matmul_3d(self):
+        self.check_result([8, 16, 12], [8, 12, 10], 'coo')
+        self.check_result([8, 16, 12], [8, 12, 10], 'csr')
+
+    def test_masked_matmul_2d(self):
+        np_mask = np.random.rand(10, 6) < 0.2
+        np_x = np.random.rand(10, 12)
+        np_y = np.random.rand(12, 6)
+        np_out = sp.csr_matrix(np.matmul(np_x, np_y) * np_mask)
+
+        x = paddle.to_tensor(np_x, place=self.place)
+        y = paddle.to_tensor(np_y, place=self.place)
+        mask = paddle.to_tensor(
+            np.ones([10, 6]) * np_mask, place=self.place
+        ).to_sparse_csr()
+        out = paddle.sparse.masked_matmul(x, y, mask)
+        np.testing.assert_allclose(np_out.indptr, out.crows().numpy())
+        np.testing.assert_allclose(np_out.indices, out.cols().numpy())
+        np.testing.assert_allclose(
+            np_out.data, out.values().numpy(), rtol=1e-05
+        )
+
+    def test_masked_matmul_3d(self):
+        np_mask = np.random.rand(4, 10, 6) < 0.3
+        np_x = np.random.rand(4, 10, 12)
+        np_y = np.random.rand(4, 12, 6)
+        x = paddle.to_tensor(np_x, place=self.place)
+        y = paddle.to_tensor(np_y, place=self.place)
+        mask = paddle.to_tensor(
+            np.ones([4, 10, 6]) * np_mask, place=self.place
+        ).to_sparse_csr()
+        out = paddle.sparse.masked_matmul(x, y, mask)
+        np.testing.assert_allclose(
+            out.to_dense().numpy(),
+            np.matmul(np_x, np_y) * np_mask,
+            rtol=1e-05,
+        )
+
+
 class TestMatmulSparseDenseStatic(unittest.TestCase):
     # x: sparse, y: dense, out: dense
     def check_result(self, x_shape, y_shape):
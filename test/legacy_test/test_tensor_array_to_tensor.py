@@ -212,6 +212,47 @@ class TestPirArrayOp(unittest.TestCase):
             fetched_out1, np.array([3, 3], dtype="int32")
         )
 
+    def test_array_contiguous_storage_inplace(self):
+        paddle.enable_static()
+        paddle.set_flags({'FLAGS_tensor_array_contiguous_storage': True})
+        with paddle.pir_utils.IrGuard():
+            main_program = paddle.static.Program()
+            with paddle.static.program_guard(main_program):
+                x = paddle.full(shape=[1, 3], fill_value=5, dtype="float32")
+                y = paddle.full(shape=[1, 3], fill_value=6, dtype="float32")
+                array = paddle.tensor.create_array(
+                    dtype="float32", initialized_list=[x, y]
+                )
+                (
+                    output,
+                    _,
+                ) = paddle.tensor.manipulation.tensor_array_to_tensor(
+                    input=array, axis=0, use_stack=True
+                )
+                # writes output in place, which must not change the array
+                zeros = paddle.zeros(shape=[2, 1, 3], dtype="float32")
+                paddle.assign(zeros, output)
+                zero = paddle.full(shape=[1], fill_value=0, dtype="int64")
+                read = paddle.tensor.array_read(array, zero)
+
+            place = (
+                paddle.base.CPUPlace()
+                if not paddle.base.core.is_compiled_with_cuda()
+                else paddle.base.CUDAPlace(0)
+            )
+            exe = paddle.base.Executor(place)
+            [fetched_out, fetched_read] = exe.run(
+                main_program, feed={}, fetch_list=[output, read]
+            )
+        paddle.set_flags({'FLAGS_tensor_array_contiguous_storage': False})
+
+        np.testing.assert_array_equal(
+            fetched_out, np.zeros([2, 1, 3], dtype="float32")
+        )
+        np.testing.assert_array_equal(
+            fetched_read, np.full([1, 3], 5.0, dtype="float32")
+        )
+
     def test_array_concat_backward(self):
         paddle.enable_static()
         main_program = paddle.static.Program()
@@ -614,6 +614,41 @@ class WeightOnlyLinearTestCase29(WeightOnlyLinearTestCase):
         self.group_size = 128
 
 
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or get_cuda_version() < 11020
+    or paddle.device.cuda.get_device_capability()[0] < 8,
+    "quantized_matmul requires CUDA >= 11.2 and CUDA_ARCH >= 8",
+)
+class WeightOnlyLinearTestCaseSplitK(WeightOnlyLinearTestCase):
+    # few output columns and long rows of weights run the split-k gemv
+    def config(self):
+        super().config()
+        self.dtype = 'float16'
+        self.weight_dtype = "int8"
+        self.atol = 2e-2
+        self.token = 1
+        self.in_features = 8192
+        self.out_features = 128
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or get_cuda_version() < 11020
+    or paddle.device.cuda.get_device_capability()[0] < 8,
+    "quantized_matmul requires CUDA >= 11.2 and CUDA_ARCH >= 8",
+)
+class WeightOnlyLinearTestCaseSplitK1(WeightOnlyLinearTestCase):
+    def config(self):
+        super().config()
+        self.dtype = 'bfloat16'
+        self.weight_dtype = "int4"
+        self.token = 3
+        self.in_features = 8192
+        self.out_features = 128
+        self.group_size = 128
+
+
 @unittest.skipIf(
     not core.is_compiled_with_cuda()
     or get_cuda_version() < 11020
@@ -879,5 +914,49 @@ class WeightOnlyLinearBackwardAndWeightDequantizeTestCase(unittest.TestCase):
             )
 
 
+class WeightOnlyLinearCPUTestCase(unittest.TestCase):
+    def dequantize(self, weight, scale, weight_dtype):
+        # weight_quantize with arch 0 keeps the rows of the output channels
+        weight = weight.numpy().astype(np.int32)
+        if weight_dtype == "int4":
+            low = ((weight & 0x0F) ^ 8) - 8
+            high = weight >> 4
+            weight = np.stack([low, high], axis=1).reshape(
+                [-1, weight.shape[1]]
+            )
+        return (weight * scale.numpy()[:, None]).T
+
+    def check(self, weight_dtype, token):
+        with paddle.base.dygraph.guard(paddle.CPUPlace()):
+            x = paddle.rand([token, 128], dtype='float32')
+            w = paddle.rand([128, 64], dtype='float32') - 0.5
+            bias = paddle.rand([64], dtype='float32')
+            qw, scale = Q.weight_quantize(
+                w, algo="weight_only_" + weight_dtype, arch=0
+            )
+            out = Q.weight_only_linear(
+                x, qw, bias, scale, weight_dtype=weight_dtype, arch=0
+            )
+            dequant = self.dequantize(qw, scale, weight_dtype)
+            np.testing.assert_allclose(
+                out.numpy(),
+                x.numpy() @ dequant + bias.numpy(),
+                rtol=1e-4,
+                atol=1e-4,
+            )
+            # the error of the quantization
+            atol = 0.5 / 127 if weight_dtype == "int8" else 0.5 / 7
+            np.testing.assert_allclose(dequant, w.numpy(), atol=atol)
+
+    def test_weight_only_linear_int8(self):
+        # the fused dot of a few rows and the GEMM of the panels
+        self.check("int8", 2)
+        self.check("int8", 16)
+
+    def test_weight_only_linear_int4(self):
+        self.check("int4", 2)
+        self.check("int4", 16)
+
+
 if __name__ == '__main__':
     unittest.main()
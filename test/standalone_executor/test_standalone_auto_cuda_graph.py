@@ -0,0 +1,102 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+paddle.enable_static()
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda() or paddle.is_compiled_with_rocm(),
+    "CUDA Graph is only supported on NVIDIA GPU",
+)
+class TestAutoCUDAGraphAlternateShapes(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_pir_auto_cuda_graph_max_graphs': 2})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_pir_auto_cuda_graph_max_graphs': 0})
+
+    def test_alternate_shapes(self):
+        main_program = paddle.static.Program()
+        startup_program = paddle.static.Program()
+        with paddle.static.program_guard(main_program, startup_program):
+            x = paddle.static.data('x', [-1, 4], 'float32')
+            out = paddle.nn.functional.relu(x * 2.0 - 1.0)
+
+        exe = paddle.static.Executor(paddle.CUDAPlace(0))
+        exe.run(startup_program)
+        # The runs of every shape warm up, capture and then replay, while
+        # the graphs of the two shapes are replayed alternately.
+        for step in range(8):
+            for batch_size in [2, 3]:
+                x_np = np.random.uniform(-1, 1, [batch_size, 4]).astype(
+                    'float32'
+                )
+                (out_np,) = exe.run(
+                    main_program, feed={'x': x_np}, fetch_list=[out]
+                )
+                self.assertEqual(out_np.shape, (batch_size, 4))
+                np.testing.assert_allclose(
+                    out_np, np.maximum(x_np * 2.0 - 1.0, 0), rtol=1e-6
+                )
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda() or paddle.is_compiled_with_rocm(),
+    "CUDA Graph is only supported on NVIDIA GPU",
+)
+class TestAutoCUDAGraphEviction(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_pir_auto_cuda_graph_max_graphs': 1})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_pir_auto_cuda_graph_max_graphs': 0})
+
+    def run_and_check(self, exe, main_program, out, batch_size):
+        x_np = np.random.uniform(-1, 1, [batch_size, 4]).astype('float32')
+        (out_np,) = exe.run(main_program, feed={'x': x_np}, fetch_list=[out])
+        self.assertEqual(out_np.shape, (batch_size, 4))
+        np.testing.assert_allclose(
+            out_np, np.maximum(x_np * 2.0 - 1.0, 0) + 1.0, rtol=1e-6
+        )
+
+    def test_replay_after_eviction(self):
+        main_program = paddle.static.Program()
+        startup_program = paddle.static.Program()
+        with paddle.static.program_guard(main_program, startup_program):
+            x = paddle.static.data('x', [-1, 4], 'float32')
+            out = paddle.nn.functional.relu(x * 2.0 - 1.0) + 1.0
+
+        exe = paddle.static.Executor(paddle.CUDAPlace(0))
+        exe.run(startup_program)
+        # The graph of the first shape is captured and then evicted by the
+        # capture of the second one, whose replays must not touch the freed
+        # memory pool of the first graph.
+        for batch_size in [4, 4, 4, 2, 2]:
+            self.run_and_check(exe, main_program, out, batch_size)
+        # allocate and write the memory given back by the first graph
+        with paddle.base.dygraph.guard(paddle.CUDAPlace(0)):
+            garbage = paddle.full([1024, 1024], 7.0)
+        for _ in range(4):
+            self.run_and_check(exe, main_program, out, 2)
+        del garbage
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -48,6 +48,9 @@ class TestCustomStream(unittest.TestCase):
     def setUp(self):
         self.steps = 3
 
+    def place(self):
+        return paddle.CUDAPlace(0)
+
     def set_custom_stream(self, prog):
         op_index_for_stream1 = [2, 4, 9]
         op_index_for_stream2 = [7, 8, 10, 11]
@@ -76,7 +79,7 @@ class TestCustomStream(unittest.TestCase):
             self.set_custom_stream(main_program)
 
         with paddle.static.program_guard(main_program, startup_program):
-            exe = paddle.static.Executor(paddle.CUDAPlace(0))
+            exe = paddle.static.Executor(self.place())
             scope = core.Scope()
             outs = []
             for i in range(self.steps):
@@ -96,5 +99,27 @@ class TestCustomStream(unittest.TestCase):
             self.assertEqual(bl[0], out[0])
 
 
+class TestXPUCustomStream(TestCustomStream):
+    def setUp(self):
+        self.steps = 3
+        paddle.set_flags({'FLAGS_xpu_enable_multi_stream': True})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_xpu_enable_multi_stream': False})
+
+    def place(self):
+        return paddle.XPUPlace(0)
+
+    @compare_legacy_with_pt
+    def test_result(self):
+        if not core.is_compiled_with_xpu():
+            return
+
+        baselines = self.run_program()
+        outs = self.run_program(apply_custom_stream=True)
+        for bl, out in zip(baselines, outs):
+            self.assertEqual(bl[0], out[0])
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -26,6 +26,7 @@ COMPILE_RUN_OP_WHITE_LIST = [
     'ctc_align',
     'fusion_seqpool_concat',
     'fusion_seqpool_cvm_concat',
+    'fusion_emb_seqpool_cvm_concat',
     'gru',
     'rpn_target_assign',
     'retinanet_target_assign',
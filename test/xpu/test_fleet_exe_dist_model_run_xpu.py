@@ -29,7 +29,7 @@ class TestDistModelRun(unittest.TestCase):
         self.temp_dir = tempfile.TemporaryDirectory()
 
     def tearDown(self):
-        # step 6: clean up the env, delete the saved model and params
+        # step 7: clean up the env, delete the saved model and params
         print('cleaned up the env')
         self.temp_dir.cleanup()
 
@@ -94,6 +94,21 @@ class TestDistModelRun(unittest.TestCase):
             # step 5: compare two results
             np.testing.assert_allclose(dist_model_rst, load_inference_model_rst)
 
+            # step 6: queue the requests to run them in the streaming mode
+            async_rsts = []
+            for _ in range(4):
+                dist.run_async(
+                    input_data,
+                    lambda ok, outputs: async_rsts.append(
+                        (ok, outputs[0].as_ndarray().ravel().tolist())
+                    ),
+                )
+            dist.wait()
+            self.assertEqual(len(async_rsts), 4)
+            for ok, rst in async_rsts:
+                self.assertTrue(ok)
+                np.testing.assert_allclose(rst, load_inference_model_rst)
+
 
 if __name__ == '__main__':
     unittest.main()